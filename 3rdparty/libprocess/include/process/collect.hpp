@@ -193,6 +193,23 @@ inline Future<std::list<T>> collect(
     return std::list<T>();
   }
 
+  // Avoid spawning a process if all of the futures are already ready.
+  bool ready = true;
+  foreach (const Future<T>& future, futures) {
+    if (!future.isReady()) {
+      ready = false;
+      break;
+    }
+  }
+
+  if (ready) {
+    std::list<T> values;
+    foreach (const Future<T>& future, futures) {
+      values.push_back(future.get());
+    }
+    return values;
+  }
+
   Promise<std::list<T>>* promise = new Promise<std::list<T>>();
   Future<std::list<T>> future = promise->future();
   spawn(new internal::CollectProcess<T>(futures, promise), true);
@@ -228,6 +245,19 @@ inline Future<std::list<Future<T>>> await(
     return futures;
   }
 
+  // Avoid spawning a process if all of the futures have completed.
+  bool completed = true;
+  foreach (const Future<T>& future, futures) {
+    if (future.isPending()) {
+      completed = false;
+      break;
+    }
+  }
+
+  if (completed) {
+    return futures;
+  }
+
   Promise<std::list<Future<T>>>* promise =
     new Promise<std::list<Future<T>>>();
   Future<std::list<Future<T>>> future = promise->future();
@@ -13,10 +13,16 @@
 #ifndef __PROCESS_DISPATCH_HPP__
 #define __PROCESS_DISPATCH_HPP__
 
-#include <functional>
-#include <memory> // TODO(benh): Replace shared_ptr with unique_ptr.
+#include <stddef.h>
+
 #include <string>
+#include <tuple>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
 
+#include <process/event.hpp>
+#include <process/future.hpp>
 #include <process/process.hpp>
 
 #include <stout/preprocessor.hpp>
@@ -53,18 +59,188 @@ namespace process {
 
 namespace internal {
 
-// The internal dispatch routine schedules a function to get invoked
-// within the context of the process associated with the specified pid
-// (first argument), unless that process is no longer valid. Note that
-// this routine does not expect anything in particular about the
-// specified function (second argument). The semantics are simple: the
-// function gets applied/invoked with the process as its first
-// argument. Currently we wrap the function in a shared_ptr but this
-// will probably change in the future to unique_ptr (or a variant).
-void dispatch(
+// The internal dispatch routine enqueues a dispatch event on the
+// process associated with the PID of the event, unless that process
+// is no longer valid (in which case the event is deleted). The event
+// (see `Dispatcher` below) invokes its function with the process as
+// its only argument.
+void dispatch(DispatchEvent* event);
+
+
+// A dispatch event that stores the function to get invoked in place.
+// Hence a dispatch allocates the event together with its function,
+// rather than a `std::function` (whose inline storage is too small
+// for most closures) and a `std::shared_ptr` to hold it.
+template <typename F>
+struct Dispatcher : DispatchEvent
+{
+  Dispatcher(
+      const UPID& pid,
+      F&& _f,
+      const Option<const std::type_info*>& functionType)
+    : DispatchEvent(pid, functionType),
+      f(std::move(_f)) {}
+
+  virtual void invoke(ProcessBase* process) const
+  {
+    f(process);
+  }
+
+  // The function is invoked at most once, so it is free to move out
+  // of its state (e.g., the arguments of a method).
+  mutable F f;
+};
+
+
+// Schedules the function, which takes the process as its argument, to
+// get invoked within the context of the process with the given PID.
+//
+// NOTE: This is not named `dispatch` since it would be ambiguous with
+// the public `dispatch(const UPID& pid, F&& f)` for calls from within
+// the `internal` namespace.
+template <typename F>
+void enqueue(
     const UPID& pid,
-    const std::shared_ptr<std::function<void(ProcessBase*)>>& f,
-    const Option<const std::type_info*>& functionType = None());
+    F&& f,
+    const Option<const std::type_info*>& functionType = None())
+{
+  dispatch(new Dispatcher<typename std::decay<F>::type>(
+      pid, std::forward<F>(f), functionType));
+}
+
+
+// Compile time sequence of indices, used to unpack the arguments
+// stored in an `Invocation` (`std::index_sequence` is C++14).
+template <size_t...>
+struct Indices {};
+
+
+template <size_t N, size_t... I>
+struct MakeIndices : MakeIndices<N - 1, N - 1, I...> {};
+
+
+template <size_t... I>
+struct MakeIndices<0, I...>
+{
+  typedef Indices<I...> type;
+};
+
+
+// Invokes a method returning `R` on a process of type `T`. The
+// arguments are moved into the invocation when dispatching and moved
+// into the method when it gets invoked (a C++11 lambda can only copy
+// them), which also allows for move-only arguments.
+template <typename R, typename T, typename Method, typename... A>
+class Invocation
+{
+public:
+  template <typename... B>
+  explicit Invocation(Method _method, B&&... b)
+    : method(_method), args(std::forward<B>(b)...) {}
+
+  R operator()(ProcessBase* process)
+  {
+    return invoke(process, typename MakeIndices<sizeof...(A)>::type());
+  }
+
+private:
+  template <size_t... I>
+  R invoke(ProcessBase* process, Indices<I...>)
+  {
+    assert(process != nullptr);
+    T* t = dynamic_cast<T*>(process);
+    assert(t != nullptr);
+    return (t->*method)(std::move(std::get<I>(args))...);
+  }
+
+  Method method;
+  std::tuple<A...> args;
+};
+
+
+template <typename R, typename T, typename Method, typename... A>
+Invocation<R, T, Method, typename std::decay<A>::type...> invocation(
+    Method method,
+    A&&... a)
+{
+  return Invocation<R, T, Method, typename std::decay<A>::type...>(
+      method, std::forward<A>(a)...);
+}
+
+
+// Invokes a callable object, ignoring the process it is invoked on.
+template <typename F>
+struct Call
+{
+  auto operator()(ProcessBase*) -> decltype(std::declval<F&>()())
+  {
+    return f();
+  }
+
+  F f;
+};
+
+
+// Invokes a function returning `Future<R>` and associates the
+// promise with the returned future.
+template <typename R, typename F>
+struct Associate
+{
+  void operator()(ProcessBase* process)
+  {
+    promise.associate(f(process));
+  }
+
+  Promise<R> promise;
+  F f;
+};
+
+
+// Invokes a function returning `R` and sets the promise to the
+// returned value.
+template <typename R, typename F>
+struct Set
+{
+  void operator()(ProcessBase* process)
+  {
+    promise.set(f(process));
+  }
+
+  Promise<R> promise;
+  F f;
+};
+
+
+// Dispatches a function returning `Future<R>` (see `Associate`).
+template <typename R, typename F>
+Future<R> associate(
+    const UPID& pid,
+    F&& f,
+    const Option<const std::type_info*>& functionType)
+{
+  Associate<R, typename std::decay<F>::type> dispatcher{
+    Promise<R>(), std::forward<F>(f)};
+
+  Future<R> future = dispatcher.promise.future();
+  enqueue(pid, std::move(dispatcher), functionType);
+  return future;
+}
+
+
+// Dispatches a function returning `R` (see `Set`).
+template <typename R, typename F>
+Future<R> set(
+    const UPID& pid,
+    F&& f,
+    const Option<const std::type_info*>& functionType)
+{
+  Set<R, typename std::decay<F>::type> dispatcher{
+    Promise<R>(), std::forward<F>(f)};
+
+  Future<R> future = dispatcher.promise.future();
+  enqueue(pid, std::move(dispatcher), functionType);
+  return future;
+}
 
 
 // NOTE: This struct is used by the public `dispatch(const UPID& pid, F&& f)`
@@ -83,13 +259,8 @@ struct Dispatch<void>
   template <typename F>
   void operator()(const UPID& pid, F&& f)
   {
-    std::shared_ptr<std::function<void(ProcessBase*)>> f_(
-        new std::function<void(ProcessBase*)>(
-            [=](ProcessBase*) {
-              f();
-            }));
-
-    internal::dispatch(pid, f_);
+    internal::enqueue(
+        pid, Call<typename std::decay<F>::type>{std::forward<F>(f)});
   }
 };
 
@@ -104,17 +275,8 @@ struct Dispatch<Future<R>>
   template <typename F>
   Future<R> operator()(const UPID& pid, F&& f)
   {
-    std::shared_ptr<Promise<R>> promise(new Promise<R>());
-
-    std::shared_ptr<std::function<void(ProcessBase*)>> f_(
-        new std::function<void(ProcessBase*)>(
-            [=](ProcessBase*) {
-              promise->associate(f());
-            }));
-
-    internal::dispatch(pid, f_);
-
-    return promise->future();
+    return associate<R>(
+        pid, Call<typename std::decay<F>::type>{std::forward<F>(f)}, None());
   }
 };
 
@@ -128,17 +290,8 @@ struct Dispatch
   template <typename F>
   Future<R> operator()(const UPID& pid, F&& f)
   {
-    std::shared_ptr<Promise<R>> promise(new Promise<R>());
-
-    std::shared_ptr<std::function<void(ProcessBase*)>> f_(
-        new std::function<void(ProcessBase*)>(
-            [=](ProcessBase*) {
-              promise->set(f());
-            }));
-
-    internal::dispatch(pid, f_);
-
-    return promise->future();
+    return set<R>(
+        pid, Call<typename std::decay<F>::type>{std::forward<F>(f)}, None());
   }
 };
 
@@ -156,16 +309,8 @@ struct Dispatch
 template <typename T>
 void dispatch(const PID<T>& pid, void (T::*method)())
 {
-  std::shared_ptr<std::function<void(ProcessBase*)>> f(
-      new std::function<void(ProcessBase*)>(
-          [=](ProcessBase* process) {
-            assert(process != nullptr);
-            T* t = dynamic_cast<T*>(process);
-            assert(t != nullptr);
-            (t->*method)();
-          }));
-
-  internal::dispatch(pid, f, &typeid(method));
+  internal::enqueue(
+      pid, internal::invocation<void, T>(method), &typeid(method));
 }
 
 template <typename T>
@@ -183,6 +328,10 @@ void dispatch(const Process<T>* process, void (T::*method)())
 // Due to a bug (http://gcc.gnu.org/bugzilla/show_bug.cgi?id=41933)
 // with variadic templates and lambdas, we still need to do
 // preprocessor expansions.
+//
+// The arguments are moved into the invocation, see `MOVE_A`.
+#define MOVE_A(Z, N, DATA) std::move(a ## N)
+
 #define TEMPLATE(Z, N, DATA)                                            \
   template <typename T,                                                 \
             ENUM_PARAMS(N, typename P),                                 \
@@ -192,16 +341,10 @@ void dispatch(const Process<T>* process, void (T::*method)())
       void (T::*method)(ENUM_PARAMS(N, P)),                             \
       ENUM_BINARY_PARAMS(N, A, a))                                      \
   {                                                                     \
-    std::shared_ptr<std::function<void(ProcessBase*)>> f(               \
-        new std::function<void(ProcessBase*)>(                          \
-            [=](ProcessBase* process) {                                 \
-              assert(process != nullptr);                               \
-              T* t = dynamic_cast<T*>(process);                         \
-              assert(t != nullptr);                                     \
-              (t->*method)(ENUM_PARAMS(N, a));                          \
-            }));                                                        \
-                                                                        \
-    internal::dispatch(pid, f, &typeid(method));                        \
+    internal::enqueue(                                                  \
+        pid,                                                            \
+        internal::invocation<void, T>(method, ENUM(N, MOVE_A, _)),      \
+        &typeid(method));                                               \
   }                                                                     \
                                                                         \
   template <typename T,                                                 \
@@ -235,20 +378,8 @@ void dispatch(const Process<T>* process, void (T::*method)())
 template <typename R, typename T>
 Future<R> dispatch(const PID<T>& pid, Future<R> (T::*method)())
 {
-  std::shared_ptr<Promise<R>> promise(new Promise<R>());
-
-  std::shared_ptr<std::function<void(ProcessBase*)>> f(
-      new std::function<void(ProcessBase*)>(
-          [=](ProcessBase* process) {
-            assert(process != nullptr);
-            T* t = dynamic_cast<T*>(process);
-            assert(t != nullptr);
-            promise->associate((t->*method)());
-          }));
-
-  internal::dispatch(pid, f, &typeid(method));
-
-  return promise->future();
+  return internal::associate<R>(
+      pid, internal::invocation<Future<R>, T>(method), &typeid(method));
 }
 
 template <typename R, typename T>
@@ -273,20 +404,10 @@ Future<R> dispatch(const Process<T>* process, Future<R> (T::*method)())
       Future<R> (T::*method)(ENUM_PARAMS(N, P)),                        \
       ENUM_BINARY_PARAMS(N, A, a))                                      \
   {                                                                     \
-    std::shared_ptr<Promise<R>> promise(new Promise<R>());              \
-                                                                        \
-    std::shared_ptr<std::function<void(ProcessBase*)>> f(               \
-        new std::function<void(ProcessBase*)>(                          \
-            [=](ProcessBase* process) {                                 \
-              assert(process != nullptr);                               \
-              T* t = dynamic_cast<T*>(process);                         \
-              assert(t != nullptr);                                     \
-              promise->associate((t->*method)(ENUM_PARAMS(N, a)));      \
-            }));                                                        \
-                                                                        \
-    internal::dispatch(pid, f, &typeid(method));                        \
-                                                                        \
-    return promise->future();                                           \
+    return internal::associate<R>(                                      \
+        pid,                                                            \
+        internal::invocation<Future<R>, T>(method, ENUM(N, MOVE_A, _)), \
+        &typeid(method));                                               \
   }                                                                     \
                                                                         \
   template <typename R,                                                 \
@@ -322,20 +443,8 @@ Future<R> dispatch(const Process<T>* process, Future<R> (T::*method)())
 template <typename R, typename T>
 Future<R> dispatch(const PID<T>& pid, R (T::*method)())
 {
-  std::shared_ptr<Promise<R>> promise(new Promise<R>());
-
-  std::shared_ptr<std::function<void(ProcessBase*)>> f(
-      new std::function<void(ProcessBase*)>(
-          [=](ProcessBase* process) {
-            assert(process != nullptr);
-            T* t = dynamic_cast<T*>(process);
-            assert(t != nullptr);
-            promise->set((t->*method)());
-          }));
-
-  internal::dispatch(pid, f, &typeid(method));
-
-  return promise->future();
+  return internal::set<R>(
+      pid, internal::invocation<R, T>(method), &typeid(method));
 }
 
 template <typename R, typename T>
@@ -360,20 +469,10 @@ Future<R> dispatch(const Process<T>* process, R (T::*method)())
       R (T::*method)(ENUM_PARAMS(N, P)),                                \
       ENUM_BINARY_PARAMS(N, A, a))                                      \
   {                                                                     \
-    std::shared_ptr<Promise<R>> promise(new Promise<R>());              \
-                                                                        \
-    std::shared_ptr<std::function<void(ProcessBase*)>> f(               \
-        new std::function<void(ProcessBase*)>(                          \
-            [=](ProcessBase* process) {                                 \
-              assert(process != nullptr);                               \
-              T* t = dynamic_cast<T*>(process);                         \
-              assert(t != nullptr);                                     \
-              promise->set((t->*method)(ENUM_PARAMS(N, a)));            \
-            }));                                                        \
-                                                                        \
-    internal::dispatch(pid, f, &typeid(method));                        \
-                                                                        \
-    return promise->future();                                           \
+    return internal::set<R>(                                            \
+        pid,                                                            \
+        internal::invocation<R, T>(method, ENUM(N, MOVE_A, _)),         \
+        &typeid(method));                                               \
   }                                                                     \
                                                                         \
   template <typename R,                                                 \
@@ -404,6 +503,9 @@ Future<R> dispatch(const Process<T>* process, R (T::*method)())
 #undef TEMPLATE
 
 
+#undef MOVE_A
+
+
 // We use partial specialization of
 //   - internal::Dispatch<void> vs
 //   - internal::Dispatch<Future<R>> vs
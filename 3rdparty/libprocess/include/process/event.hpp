@@ -13,6 +13,7 @@
 #ifndef __PROCESS_EVENT_HPP__
 #define __PROCESS_EVENT_HPP__
 
+#include <atomic>
 #include <memory> // TODO(benh): Replace shared_ptr with unique_ptr.
 
 #include <process/future.hpp>
@@ -26,6 +27,7 @@
 namespace process {
 
 // Forward declarations.
+class EventQueue;
 class ProcessBase;
 struct MessageEvent;
 struct DispatchEvent;
@@ -47,6 +49,11 @@ struct EventVisitor
 
 struct Event
 {
+  Event() : next(nullptr), enqueued(0) {}
+
+  // Copies are not linked into any queue.
+  Event(const Event&) : next(nullptr), enqueued(0) {}
+
   virtual ~Event() {}
 
   virtual void visit(EventVisitor* visitor) const = 0;
@@ -81,6 +88,19 @@ struct Event
     }
     return *result;
   }
+
+private:
+  friend class EventQueue;
+  friend class ProcessBase;
+  friend class ProcessManager;
+
+  // The event that follows in the `EventQueue` of the process that
+  // this event was enqueued to.
+  std::atomic<Event*> next;
+
+  // The time at which the event was enqueued, only set if event
+  // statistics are enabled (see `EventStatistics`).
+  int64_t enqueued;
 };
 
 
@@ -145,14 +165,14 @@ private:
 };
 
 
+// The function to get invoked as a result of a dispatch event is
+// stored in the event itself, see `internal::Dispatcher`.
 struct DispatchEvent : Event
 {
   DispatchEvent(
       const UPID& _pid,
-      const std::shared_ptr<lambda::function<void(ProcessBase*)>>& _f,
       const Option<const std::type_info*>& _functionType)
     : pid(_pid),
-      f(_f),
       functionType(_functionType)
   {}
 
@@ -161,12 +181,13 @@ struct DispatchEvent : Event
     visitor->visit(*this);
   }
 
+  // Invokes the function of this dispatch event on the process. This
+  // must be called at most once.
+  virtual void invoke(ProcessBase* process) const = 0;
+
   // PID receiving the dispatch.
   const UPID pid;
 
-  // Function to get invoked as a result of this dispatch event.
-  const std::shared_ptr<lambda::function<void(ProcessBase*)>> f;
-
   const Option<const std::type_info*> functionType;
 
 private:
@@ -333,11 +333,15 @@ public:
   // Installs callbacks that get executed when this future is ready
   // and associates the result of the callback with the future that is
   // returned to the caller (which may be of a different type).
+  //
+  // NOTE: The callback is taken by value and moved into the installed
+  // callbacks, so a temporary (e.g., a converted `defer`) is never
+  // copied.
   template <typename X>
-  Future<X> then(const lambda::function<Future<X>(const T&)>& f) const;
+  Future<X> then(lambda::function<Future<X>(const T&)> f) const;
 
   template <typename X>
-  Future<X> then(const lambda::function<X(const T&)>& f) const;
+  Future<X> then(lambda::function<X(const T&)> f) const;
 
   template <typename X>
   Future<X> then(const lambda::function<Future<X>()>& f) const
@@ -379,7 +383,7 @@ private:
   template <typename F, typename X = typename internal::unwrap<typename result_of<F(const T&)>::type>::type> // NOLINT(whitespace/line_length)
   Future<X> then(F&& f, Prefer) const
   {
-    return then<X>(std::function<Future<X>(const T&)>(f));
+    return then<X>(std::function<Future<X>(const T&)>(std::forward<F>(f)));
   }
 
   // Refer to the less preferred version of `onReady` for why these SFINAE
@@ -392,7 +396,7 @@ private:
               F>::type()>::type>::type>
   Future<X> then(F&& f, LessPrefer) const
   {
-    return then<X>(std::function<Future<X>()>(f));
+    return then<X>(std::function<Future<X>()>(std::forward<F>(f)));
   }
 
 public:
@@ -446,7 +450,11 @@ private:
     void clearAllCallbacks();
 
     std::atomic_flag lock = ATOMIC_FLAG_INIT;
-    State state;
+
+    // NOTE: The state is atomic so that it can be checked without the
+    // lock, which is safe once the future has completed since it will
+    // not change anymore (see e.g. 'Future::onAny').
+    std::atomic<State> state;
     bool discard;
     bool associated;
 
@@ -742,6 +750,19 @@ bool Promise<T>::associate(const Future<T>& future)
     // one direction.  In other words, calling 'set' or 'fail' on this
     // promise will not affect the result of the future that we
     // associated.
+    //
+    // If the future has already completed there is nothing to
+    // propagate so we complete 'f' directly instead of installing
+    // callbacks on 'future', which is the common case when chaining
+    // continuations that return ready futures.
+    if (future.isReady()) {
+      f.set(future.get());
+      return associated;
+    } else if (future.isFailed()) {
+      f.fail(future.failure());
+      return associated;
+    }
+
     f.onDiscard(lambda::bind(&internal::discard<T>, WeakFuture<T>(future)));
 
     // Need to disambiguate for the compiler.
@@ -919,41 +940,53 @@ void Future<T>::Data::clearAllCallbacks()
 }
 
 
+// NOTE: We use 'std::make_shared' so that the data and the reference
+// counts of a future take a single allocation. A future that is
+// constructed with a value or a failure can't have any callbacks yet
+// nor be shared with another thread, so we complete it directly
+// rather than taking the lock and running (no) callbacks.
 template <typename T>
 Future<T>::Future()
-  : data(new Data()) {}
+  : data(std::make_shared<Data>()) {}
 
 
 template <typename T>
 Future<T>::Future(const T& _t)
-  : data(new Data())
+  : data(std::make_shared<Data>())
 {
-  set(_t);
+  data->result = _t;
+  data->state = READY;
 }
 
 
 template <typename T>
 template <typename U>
 Future<T>::Future(const U& u)
-  : data(new Data())
+  : data(std::make_shared<Data>())
 {
-  set(u);
+  // NOTE: We must convert to `T` first, otherwise assigning, e.g.,
+  // `None` to the `Result<T>` would leave it in the NONE state
+  // rather than holding a `T` constructed from `None`.
+  data->result = T(u);
+  data->state = READY;
 }
 
 
 template <typename T>
 Future<T>::Future(const Failure& failure)
-  : data(new Data())
+  : data(std::make_shared<Data>())
 {
-  fail(failure.message);
+  data->result = Result<T>(Error(failure.message));
+  data->state = FAILED;
 }
 
 
 template <typename T>
 Future<T>::Future(const ErrnoFailure& failure)
-  : data(new Data())
+  : data(std::make_shared<Data>())
 {
-  fail(failure.message);
+  data->result = Result<T>(Error(failure.message));
+  data->state = FAILED;
 }
 
 
@@ -969,12 +1002,14 @@ Future<T>::Future(Future<T>&& that)
 
 template <typename T>
 Future<T>::Future(const Try<T>& t)
-  : data(new Data())
+  : data(std::make_shared<Data>())
 {
   if (t.isSome()){
-    set(t.get());
+    data->result = t.get();
+    data->state = READY;
   } else {
-    fail(t.error());
+    data->result = Result<T>(Error(t.error()));
+    data->state = FAILED;
   }
 }
 
@@ -1187,6 +1222,16 @@ const Future<T>& Future<T>::onDiscard(DiscardCallback&& callback) const
 template <typename T>
 const Future<T>& Future<T>::onReady(ReadyCallback&& callback) const
 {
+  // The state can't change once the future has completed, so we only
+  // need the lock if it's still pending.
+  const State state = data->state;
+  if (state != PENDING) {
+    if (state == READY) {
+      callback(data->result.get());
+    }
+    return *this;
+  }
+
   bool run = false;
 
   synchronized (data->lock) {
@@ -1209,6 +1254,16 @@ const Future<T>& Future<T>::onReady(ReadyCallback&& callback) const
 template <typename T>
 const Future<T>& Future<T>::onFailed(FailedCallback&& callback) const
 {
+  // The state can't change once the future has completed, so we only
+  // need the lock if it's still pending.
+  const State state = data->state;
+  if (state != PENDING) {
+    if (state == FAILED) {
+      callback(data->result.error());
+    }
+    return *this;
+  }
+
   bool run = false;
 
   synchronized (data->lock) {
@@ -1231,6 +1286,16 @@ const Future<T>& Future<T>::onFailed(FailedCallback&& callback) const
 template <typename T>
 const Future<T>& Future<T>::onDiscarded(DiscardedCallback&& callback) const
 {
+  // The state can't change once the future has completed, so we only
+  // need the lock if it's still pending.
+  const State state = data->state;
+  if (state != PENDING) {
+    if (state == DISCARDED) {
+      callback();
+    }
+    return *this;
+  }
+
   bool run = false;
 
   synchronized (data->lock) {
@@ -1253,6 +1318,13 @@ const Future<T>& Future<T>::onDiscarded(DiscardedCallback&& callback) const
 template <typename T>
 const Future<T>& Future<T>::onAny(AnyCallback&& callback) const
 {
+  // The state can't change once the future has completed, so we only
+  // need the lock if it's still pending.
+  if (data->state != PENDING) {
+    callback(*this);
+    return *this;
+  }
+
   bool run = false;
 
   synchronized (data->lock) {
@@ -1385,14 +1457,26 @@ void after(
 
 template <typename T>
 template <typename X>
-Future<X> Future<T>::then(const lambda::function<Future<X>(const T&)>& f) const
+Future<X> Future<T>::then(lambda::function<Future<X>(const T&)> f) const
 {
-  std::shared_ptr<Promise<X>> promise(new Promise<X>());
+  // If this future has already completed we can skip the promise and
+  // the callbacks, which is what we would have invoked immediately.
+  // Discarding the result of 'f' then discards the future returned
+  // by 'f' directly rather than through an associated promise.
+  if (isReady() && !hasDiscard()) {
+    return f(get());
+  } else if (isFailed()) {
+    return Future<X>::failed(failure());
+  }
+
+  // NOTE: We use `std::make_shared` to allocate the promise together
+  // with its reference count.
+  std::shared_ptr<Promise<X>> promise = std::make_shared<Promise<X>>();
 
   lambda::function<void(const Future<T>&)> thenf =
-    lambda::bind(&internal::thenf<T, X>, f, promise, lambda::_1);
+    lambda::bind(&internal::thenf<T, X>, std::move(f), promise, lambda::_1);
 
-  onAny(thenf);
+  onAny(std::move(thenf));
 
   // Propagate discarding up the chain. To avoid cyclic dependencies,
   // we keep a weak future in the callback.
@@ -1405,14 +1489,21 @@ Future<X> Future<T>::then(const lambda::function<Future<X>(const T&)>& f) const
 
 template <typename T>
 template <typename X>
-Future<X> Future<T>::then(const lambda::function<X(const T&)>& f) const
+Future<X> Future<T>::then(lambda::function<X(const T&)> f) const
 {
-  std::shared_ptr<Promise<X>> promise(new Promise<X>());
+  // See the comment above.
+  if (isReady() && !hasDiscard()) {
+    return f(get());
+  } else if (isFailed()) {
+    return Future<X>::failed(failure());
+  }
+
+  std::shared_ptr<Promise<X>> promise = std::make_shared<Promise<X>>();
 
   lambda::function<void(const Future<T>&)> then =
-    lambda::bind(&internal::then<T, X>, f, promise, lambda::_1);
+    lambda::bind(&internal::then<T, X>, std::move(f), promise, lambda::_1);
 
-  onAny(then);
+  onAny(std::move(then));
 
   // Propagate discarding up the chain. To avoid cyclic dependencies,
   // we keep a weak future in the callback.
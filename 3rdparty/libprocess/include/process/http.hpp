@@ -33,6 +33,7 @@
 #include <process/socket.hpp>
 
 #include <stout/error.hpp>
+#include <stout/gzip.hpp>
 #include <stout/hashmap.hpp>
 #include <stout/ip.hpp>
 #include <stout/json.hpp>
@@ -482,6 +483,7 @@ public:
   std::string& operator[](const std::string& key);
 
   void put(const std::string& key, const std::string& value);
+  void put(std::string&& key, std::string&& value);
 
   Option<std::string> get(const std::string& key) const;
 
@@ -619,8 +621,9 @@ struct Response
   // using 'type' below.
   //
   // BODY: Uses 'body' as the body of the response. These may be
-  // encoded using gzip for efficiency, if 'Content-Encoding' is not
-  // already specified.
+  // encoded using gzip or deflate for efficiency, if the request
+  // accepts the encoding and 'Content-Encoding' is not already
+  // specified.
   //
   // PATH: Attempts to perform a 'sendfile' operation on the file
   // found at 'path'.
@@ -957,6 +960,8 @@ private:
   friend Future<Connection> connect(
       const network::Address& address, Scheme scheme);
   friend Future<Connection> connect(const URL&);
+  friend Future<Connection> connect(
+      const network::Socket& socket, const network::Address& address);
 
   // Forward declaration.
   struct Data;
@@ -971,6 +976,17 @@ Future<Connection> connect(const network::Address& address, Scheme scheme);
 Future<Connection> connect(const URL& url);
 
 
+/**
+ * Connects the given (not yet connected) socket to the address. This
+ * allows for connecting sockets that were set up outside of
+ * libprocess, e.g., sockets created in another network namespace.
+ * The scheme is determined by the kind of the socket.
+ */
+Future<Connection> connect(
+    const network::Socket& socket,
+    const network::Address& address);
+
+
 namespace internal {
 
 Future<Nothing> serve(
@@ -1050,6 +1066,11 @@ Request createRequest(
  * Asynchronously sends an HTTP request to the process and
  * returns the HTTP response once the entire response is received.
  *
+ * Requests whose responses are not streamed are sent on a pooled
+ * keep-alive connection to the same scheme, host and port if one is
+ * available (see `LIBPROCESS_HTTP_MAX_IDLE_CONNECTIONS`), otherwise
+ * on a new connection. The request must not set 'keepAlive'.
+ *
  * @param streamedResponse Being true indicates the HTTP response will
  *     be 'PIPE' type, and caller must read the response body from the
  *     Pipe::Reader, otherwise, the HTTP response will be 'BODY' type.
@@ -1182,6 +1203,28 @@ Future<Response> post(
     const Option<std::string>& contentType = None(),
     const Option<std::string>& scheme = None());
 
+
+// Returns the read end of a pipe with the data read from 'reader'
+// compressed in the given format, e.g., for the body of a 'PIPE'
+// response with a 'Content-Encoding' of "gzip". Each chunk that is
+// read gets flushed, so that it can be decompressed right away. Only
+// a bounded amount of the data is buffered in between: it is read
+// from 'reader' as it is being compressed.
+//
+// A failure to read from 'reader' fails the returned pipe, and
+// closing the returned reader closes 'reader'.
+Pipe::Reader compress(
+    Pipe::Reader reader,
+    gzip::Format format = gzip::Format::GZIP);
+
+
+// Returns the read end of a pipe with the data read from 'reader'
+// decompressed, which is in the given format. The returned pipe fails
+// if the data cannot be decompressed, see 'compress' above.
+Pipe::Reader decompress(
+    Pipe::Reader reader,
+    gzip::Format format = gzip::Format::GZIP);
+
 } // namespace streaming {
 
 } // namespace http {
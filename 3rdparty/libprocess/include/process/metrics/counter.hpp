@@ -13,16 +13,26 @@
 #ifndef __PROCESS_METRICS_COUNTER_HPP__
 #define __PROCESS_METRICS_COUNTER_HPP__
 
+#include <stdint.h>
+
+#include <atomic>
 #include <memory>
 #include <string>
 
 #include <process/metrics/metric.hpp>
 
+#include <stout/thread_local.hpp>
+
 namespace process {
 namespace metrics {
 
 // A Metric that represents an integer value that can be incremented and
 // decremented.
+//
+// The value is sharded across threads so that threads incrementing
+// the same counter don't contend on a single cache line; reading the
+// value sums the shards. If the counter keeps a history (i.e., has a
+// 'window'), every update also reads the value to record it.
 class Counter : public Metric
 {
 public:
@@ -31,21 +41,26 @@ public:
   // 'window' is the amount of history to keep for this Metric.
   Counter(const std::string& name, const Option<Duration>& window = None())
     : Metric(name, window),
-      data(new Data())
+      data(new Data()),
+      history(window.isSome())
   {
-    push(data->value.load());
+    push(0);
   }
 
   virtual ~Counter() {}
 
   virtual Future<double> value() const
   {
-    return static_cast<double>(data->value.load());
+    return static_cast<double>(data->load());
   }
 
+  // NOTE: Updates that race with a reset may survive it.
   void reset()
   {
-    data->value.store(0);
+    for (size_t i = 0; i < Data::SHARDS; i++) {
+      data->shards[i].value.store(0, std::memory_order_relaxed);
+    }
+
     push(0);
   }
 
@@ -63,20 +78,64 @@ public:
 
   Counter& operator+=(int64_t v)
   {
-    int64_t prev = data->value.fetch_add(v);
-    push(prev + v);
+    data->shards[Data::shard()].value.fetch_add(v, std::memory_order_relaxed);
+
+    if (history) {
+      push(static_cast<double>(data->load()));
+    }
+
     return *this;
   }
 
 private:
   struct Data
   {
-    explicit Data() : value(0) {}
-
-    std::atomic<int64_t> value;
+    static const size_t SHARDS = 16;
+
+    explicit Data()
+    {
+      for (size_t i = 0; i < SHARDS; i++) {
+        shards[i].value.store(0, std::memory_order_relaxed);
+      }
+    }
+
+    int64_t load() const
+    {
+      int64_t value = 0;
+      for (size_t i = 0; i < SHARDS; i++) {
+        value += shards[i].value.load(std::memory_order_relaxed);
+      }
+      return value;
+    }
+
+    // Returns the shard of the calling thread. Threads are assigned
+    // to shards round robin when they first update any counter.
+    static size_t shard()
+    {
+      static std::atomic<size_t> next(0);
+      static THREAD_LOCAL size_t index = SHARDS;
+
+      if (index == SHARDS) {
+        index = next.fetch_add(1, std::memory_order_relaxed) % SHARDS;
+      }
+
+      return index;
+    }
+
+    // Padded to a cache line to avoid false sharing between shards.
+    struct Shard
+    {
+      std::atomic<int64_t> value;
+      char padding[64 - sizeof(std::atomic<int64_t>)];
+    };
+
+    Shard shards[SHARDS];
   };
 
   std::shared_ptr<Data> data;
+
+  // Whether the counter keeps a history, i.e., was given a 'window'.
+  bool history;
 };
 
 } // namespace metrics {
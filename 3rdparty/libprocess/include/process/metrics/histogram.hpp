@@ -0,0 +1,218 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License
+
+#ifndef __PROCESS_METRICS_HISTOGRAM_HPP__
+#define __PROCESS_METRICS_HISTOGRAM_HPP__
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <string>
+
+#include <process/future.hpp>
+#include <process/statistics.hpp>
+
+#include <process/metrics/metric.hpp>
+
+#include <stout/none.hpp>
+#include <stout/option.hpp>
+
+namespace process {
+namespace metrics {
+
+// A Metric that records a distribution of non-negative values (e.g.,
+// latencies or sizes) in log-linear buckets: each power of two is
+// split into 'SUB_BUCKETS' buckets of equal width, which bounds the
+// relative error of the percentiles to about 3%. Recording a value
+// does not take any locks or allocate, and the statistics are
+// computed from the buckets rather than by sorting a history of
+// values, so a Histogram is suitable for values that are recorded
+// often.
+//
+// Unlike the history of a metric with a 'window', the statistics
+// cover all the values recorded since the Histogram was created.
+// The value of the Histogram is the last recorded value.
+class Histogram : public Metric
+{
+public:
+  // Each power of two in [2^MIN_EXPONENT, 2^(MIN_EXPONENT+EXPONENTS))
+  // has its own buckets. Smaller values (including 0) are counted in
+  // the first bucket, and larger values in the last bucket.
+  static const int MIN_EXPONENT = -32;
+  static const int EXPONENTS = 96;
+  static const int SUB_BUCKETS = 16;
+  static const int BUCKETS = EXPONENTS * SUB_BUCKETS;
+
+  // 'name' is the unique name for the instance of Histogram being
+  // constructed. It will be the key exposed in the JSON endpoint.
+  explicit Histogram(const std::string& name)
+    : Metric(name, None()),
+      data(new Data()) {}
+
+  virtual ~Histogram() {}
+
+  virtual Future<double> value() const
+  {
+    const double value = data->last.load();
+
+    if (std::isnan(value)) {
+      return Failure("No value");
+    }
+
+    return value;
+  }
+
+  virtual Option<Statistics<double>> statistics() const
+  {
+    // NOTE: Values recorded while computing the statistics may only be
+    // partially accounted for, e.g., in the count but not the buckets.
+    uint64_t total = 0;
+    for (int i = 0; i < BUCKETS; i++) {
+      total += data->buckets[i].load(std::memory_order_relaxed);
+    }
+
+    // As with the history of a metric, we need at least 2 values to
+    // compute aggregates.
+    if (total < 2) {
+      return None();
+    }
+
+    Statistics<double> statistics;
+
+    statistics.count = total;
+    statistics.min = data->min.load();
+    statistics.max = data->max.load();
+
+    statistics.p50 = percentile(total, 0.5);
+    statistics.p90 = percentile(total, 0.90);
+    statistics.p95 = percentile(total, 0.95);
+    statistics.p99 = percentile(total, 0.99);
+    statistics.p999 = percentile(total, 0.999);
+    statistics.p9999 = percentile(total, 0.9999);
+
+    return statistics;
+  }
+
+  void record(double value)
+  {
+    if (std::isnan(value)) {
+      return;
+    }
+
+    value = std::max(value, 0.0);
+
+    data->buckets[bucket(value)].fetch_add(1, std::memory_order_relaxed);
+    data->last.store(value);
+
+    double min = data->min.load();
+    while (value < min && !data->min.compare_exchange_weak(min, value)) {}
+
+    double max = data->max.load();
+    while (value > max && !data->max.compare_exchange_weak(max, value)) {}
+  }
+
+  // Returns the bucket that counts the (non-negative) value.
+  static int bucket(double value)
+  {
+    int exponent;
+    const double mantissa = std::frexp(value, &exponent);
+
+    // NOTE: The mantissa of a positive value is in [0.5, 1).
+    if (value <= 0.0 || exponent <= MIN_EXPONENT) {
+      return 0;
+    }
+
+    if (exponent > MIN_EXPONENT + EXPONENTS) {
+      return BUCKETS - 1;
+    }
+
+    const int sub = std::min(
+        SUB_BUCKETS - 1,
+        static_cast<int>((mantissa - 0.5) * 2 * SUB_BUCKETS));
+
+    return (exponent - MIN_EXPONENT - 1) * SUB_BUCKETS + sub;
+  }
+
+  // Returns the lower bound of the values counted in the bucket.
+  static double lower(int bucket)
+  {
+    const int exponent = bucket / SUB_BUCKETS + MIN_EXPONENT + 1;
+    const int sub = bucket % SUB_BUCKETS;
+
+    return std::ldexp(0.5 + sub / (2.0 * SUB_BUCKETS), exponent);
+  }
+
+private:
+  // Returns the percentile (in the range [0, 1]) of the 'total' values
+  // counted in the buckets, interpolating linearly within the bucket
+  // of the percentile and clamping to the recorded minimum and
+  // maximum.
+  double percentile(uint64_t total, double p) const
+  {
+    // The (fractional) index of the percentile in the sorted values,
+    // as in 'Statistics::from'.
+    const double position = p * (total - 1);
+
+    const double min = data->min.load();
+    const double max = data->max.load();
+
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKETS; i++) {
+      const uint64_t count = data->buckets[i].load(std::memory_order_relaxed);
+
+      if (count > 0 && seen + count > position) {
+        const double lower = i == 0 ? 0.0 : Histogram::lower(i);
+        const double upper = i == BUCKETS - 1 ? max : Histogram::lower(i + 1);
+        const double fraction = (position - seen + 0.5) / count;
+
+        return std::min(
+            max, std::max(min, lower + fraction * (upper - lower)));
+      }
+
+      seen += count;
+    }
+
+    return max;
+  }
+
+  struct Data
+  {
+    Data()
+      : last(std::numeric_limits<double>::quiet_NaN()),
+        min(std::numeric_limits<double>::infinity()),
+        max(-std::numeric_limits<double>::infinity())
+    {
+      for (int i = 0; i < BUCKETS; i++) {
+        buckets[i].store(0, std::memory_order_relaxed);
+      }
+    }
+
+    std::atomic<uint64_t> buckets[BUCKETS];
+
+    // The last recorded value, or NaN if no value was recorded.
+    std::atomic<double> last;
+
+    std::atomic<double> min;
+    std::atomic<double> max;
+  };
+
+  std::shared_ptr<Data> data;
+};
+
+} // namespace metrics {
+} // namespace process {
+
+#endif // __PROCESS_METRICS_HISTOGRAM_HPP__
@@ -41,7 +41,8 @@ public:
     return data->name;
   }
 
-  Option<Statistics<double>> statistics() const
+  // Returns the statistics of the history of this metric, if any.
+  virtual Option<Statistics<double>> statistics() const
   {
     Option<Statistics<double>> statistics = None();
 
@@ -14,15 +14,18 @@
 #define __PROCESS_METRICS_METRICS_HPP__
 
 #include <string>
+#include <utility>
 
 #include <process/dispatch.hpp>
 #include <process/future.hpp>
 #include <process/limiter.hpp>
 #include <process/owned.hpp>
 #include <process/process.hpp>
+#include <process/time.hpp>
 
 #include <process/metrics/metric.hpp>
 
+#include <stout/duration.hpp>
 #include <stout/hashmap.hpp>
 #include <stout/nothing.hpp>
 #include <stout/option.hpp>
@@ -48,12 +51,15 @@ protected:
 
 private:
   static std::string help();
+  static std::string prometheusHelp();
 
   MetricsProcess(
       const Option<Owned<RateLimiter>>& _limiter,
+      const Option<Duration>& _cacheInterval,
       const Option<std::string>& _authenticationRealm)
     : ProcessBase("metrics"),
       limiter(_limiter),
+      cacheInterval(_cacheInterval),
       authenticationRealm(_authenticationRealm)
   {}
 
@@ -65,6 +71,15 @@ private:
       const http::Request& request,
       const Option<std::string>& /* principal */);
 
+  Future<http::Response> _prometheus(
+      const http::Request& request,
+      const Option<std::string>& /* principal */);
+
+  // Returns the snapshot for a request to one of the endpoints, which
+  // is either the cached snapshot or a new (rate limited) snapshot.
+  Future<hashmap<std::string, double>> cachedSnapshot(
+      const Option<Duration>& timeout);
+
   static std::list<Future<double>> _snapshotTimeout(
       const std::list<Future<double>>& futures);
 
@@ -79,6 +94,11 @@ private:
   // Used to rate limit the snapshot endpoint.
   Option<Owned<RateLimiter>> limiter;
 
+  // How long a snapshot is served to subsequent requests, if at all,
+  // and the latest snapshot along with the time it was started.
+  const Option<Duration> cacheInterval;
+  Option<std::pair<Time, Future<hashmap<std::string, double>>>> cache;
+
   // The authentication realm that metrics HTTP endpoints are installed into.
   const Option<std::string> authenticationRealm;
 };
@@ -13,7 +13,11 @@
 #ifndef __PROCESS_METRICS_TIMER_HPP__
 #define __PROCESS_METRICS_TIMER_HPP__
 
+#include <stdint.h>
+
 #include <atomic>
+#include <cmath>
+#include <limits>
 #include <memory>
 #include <string>
 
@@ -25,7 +29,6 @@
 #include <stout/duration.hpp>
 #include <stout/hashmap.hpp>
 #include <stout/option.hpp>
-#include <stout/synchronized.hpp>
 #include <stout/try.hpp>
 
 namespace process {
@@ -44,14 +47,10 @@ public:
 
   Future<double> value() const
   {
-    Future<double> value;
-
-    synchronized (data->lock) {
-      if (data->lastValue.isSome()) {
-        value = data->lastValue.get();
-      } else {
-        value = Failure("No value");
-      }
+    const double value = data->lastValue.load();
+
+    if (std::isnan(value)) {
+      return Failure("No value");
     }
 
     return value;
@@ -60,31 +59,32 @@ public:
   // Start the Timer.
   void start()
   {
-    synchronized (data->lock) {
-      data->start = Clock::now();
-    }
+    data->start.store(Clock::now().duration().ns());
   }
 
   // Stop the Timer.
   T stop()
   {
-    const Time stop = Clock::now();
+    const int64_t stop = Clock::now().duration().ns();
 
-    T t(0);
+    const T t(Nanoseconds(stop - data->start.load()));
 
-    double value = 0.0;
+    data->lastValue.store(t.value());
 
-    synchronized (data->lock) {
-      t = T(stop - data->start);
+    push(t.value());
 
-      data->lastValue = t.value();
+    return t;
+  }
 
-      value = data->lastValue.get();
-    }
+  // Record an event that was timed by the caller, e.g., the total
+  // time spent in a piece of code that is entered many times.
+  void record(const Duration& duration)
+  {
+    const T t(duration);
 
-    push(value);
+    data->lastValue.store(t.value());
 
-    return t;
+    push(t.value());
   }
 
   // Time an asynchronous event.
@@ -101,22 +101,24 @@ public:
 
 private:
   struct Data {
-    Data() = default;
-    std::atomic_flag lock = ATOMIC_FLAG_INIT;
-    Time start;
-    Option<double> lastValue;
+    Data()
+      : start(0),
+        lastValue(std::numeric_limits<double>::quiet_NaN()) {}
+
+    // The time the Timer was started, in nanoseconds since the epoch.
+    std::atomic<int64_t> start;
+
+    // The last value of the Timer, or NaN if it was never stopped.
+    std::atomic<double> lastValue;
   };
 
   static void _time(Time start, Timer that)
   {
     const Time stop = Clock::now();
 
-    double value;
+    const double value = T(stop - start).value();
 
-    synchronized (that.data->lock) {
-      that.data->lastValue = T(stop - start).value();
-      value = that.data->lastValue.get();
-    }
+    that.data->lastValue.store(value);
 
     that.push(value);
   }
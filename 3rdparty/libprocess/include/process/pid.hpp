@@ -16,6 +16,7 @@
 #include <stdint.h>
 
 #include <iosfwd>
+#include <memory>
 #include <string>
 
 #include <boost/functional/hash.hpp>
@@ -23,6 +24,7 @@
 #include <process/address.hpp>
 
 #include <stout/ip.hpp>
+#include <stout/option.hpp>
 
 namespace process {
 
@@ -41,7 +43,7 @@ struct UPID
   UPID() = default;
 
   UPID(const UPID& that)
-    : id(that.id), address(that.address) {}
+    : id(that.id), address(that.address), reference(that.reference) {}
 
   UPID(const char* id_, const net::IP& ip_, uint16_t port_)
     : id(id_), address(ip_, port_) {}
@@ -94,6 +96,14 @@ struct UPID
 
   std::string id;
   network::inet::Address address = network::inet::Address::ANY_ANY();
+
+  // A reference to the local process with this PID, if the PID was
+  // copied from a spawned process (e.g., via `ProcessBase::self`).
+  // This lets the `ProcessManager` find the process without looking
+  // it up in its table of processes (and taking the lock for it).
+  // The reference expires once the process has terminated, even if
+  // a new process with the same PID gets spawned.
+  Option<std::weak_ptr<ProcessBase*>> reference = None();
 };
 
 
@@ -141,6 +151,7 @@ struct PID : UPID
     PID<Base> pid;
     pid.id = id;
     pid.address = address;
+    pid.reference = reference;
     return pid;
   }
 };
@@ -18,6 +18,9 @@
 #endif // __linux__
 #include <sys/types.h>
 
+#include <spawn.h>
+#include <unistd.h>
+
 #include <string>
 
 #include <glog/logging.h>
@@ -33,6 +36,8 @@
 #include <stout/none.hpp>
 #include <stout/option.hpp>
 #include <stout/os.hpp>
+#include <stout/path.hpp>
+#include <stout/strings.hpp>
 #include <stout/try.hpp>
 #include <stout/unreachable.hpp>
 
@@ -227,6 +232,86 @@ inline int childMain(
 }
 
 
+// Returns the file that 'os::execvpe' would execute for the path in
+// the child, i.e., after searching the 'PATH' of the child's
+// environment, if the path does not contain a slash.
+inline Option<std::string> resolve(
+    const std::string& path,
+    const Option<std::map<std::string, std::string>>& environment)
+{
+  if (strings::contains(path, "/")) {
+    return path;
+  }
+
+  Option<std::string> paths = None();
+  if (environment.isNone()) {
+    paths = os::getenv("PATH");
+  } else if (environment->count("PATH") > 0) {
+    paths = environment->at("PATH");
+  }
+
+  // Leave the default search path of 'execvp' to the fork path.
+  if (paths.isNone()) {
+    return None();
+  }
+
+  foreach (const std::string& directory, strings::split(paths.get(), ":")) {
+    const std::string file =
+      directory.empty() ? path : ::path::join(directory, path);
+
+    if (::access(file.c_str(), X_OK) == 0) {
+      return file;
+    }
+  }
+
+  return None();
+}
+
+
+// Launches the child with 'posix_spawn', which (unlike 'fork') does
+// not need to copy the page tables of the parent and hence stays
+// cheap for a parent with a large resident set. This is only possible
+// if nothing needs to run between the clone and the exec, i.e., there
+// is no custom clone function and there are no hooks. The I/O is
+// redirected like in 'childMain'; the remaining file descriptors are
+// closed upon exec since they are all close-on-exec.
+//
+// Returns -1 if the child could not be spawned, including when the
+// file could not be executed, in which case the caller falls back to
+// 'fork' so that such errors surface as before.
+inline pid_t spawnChild(
+    const std::string& path,
+    char** argv,
+    char** envp,
+    const InputFileDescriptors& stdinfds,
+    const OutputFileDescriptors& stdoutfds,
+    const OutputFileDescriptors& stderrfds)
+{
+  posix_spawn_file_actions_t actions;
+  if (::posix_spawn_file_actions_init(&actions) != 0) {
+    return -1;
+  }
+
+  pid_t pid = -1;
+
+  if (::posix_spawn_file_actions_adddup2(
+          &actions, stdinfds.read, STDIN_FILENO) == 0 &&
+      ::posix_spawn_file_actions_adddup2(
+          &actions, stdoutfds.write, STDOUT_FILENO) == 0 &&
+      ::posix_spawn_file_actions_adddup2(
+          &actions, stderrfds.write, STDERR_FILENO) == 0) {
+    if (::posix_spawn(
+            &pid, path.c_str(), &actions, nullptr, argv, envp) != 0) {
+      pid = -1;
+    }
+  }
+
+  ::posix_spawn_file_actions_destroy(&actions);
+
+  return pid;
+}
+
+
 inline Try<pid_t> cloneChild(
     const std::string& path,
     std::vector<std::string> argv,
@@ -286,18 +371,30 @@ inline Try<pid_t> cloneChild(
     CHECK_SOME(os::pipe(pipes));
   }
 
-  // Now, clone the child process.
-  pid_t pid = clone(lambda::bind(
-      &childMain,
-      path,
-      _argv,
-      envp,
-      stdinfds,
-      stdoutfds,
-      stderrfds,
-      blocking,
-      pipes,
-      child_hooks));
+  pid_t pid = -1;
+
+  // Spawn the child if nothing needs to run in it before the exec.
+  if (_clone.isNone() && !blocking && child_hooks.empty()) {
+    Option<std::string> file = resolve(path, environment);
+    if (file.isSome()) {
+      pid = spawnChild(file.get(), _argv, envp, stdinfds, stdoutfds, stderrfds);
+    }
+  }
+
+  // Otherwise, clone the child process.
+  if (pid == -1) {
+    pid = clone(lambda::bind(
+        &childMain,
+        path,
+        _argv,
+        envp,
+        stdinfds,
+        stdoutfds,
+        stderrfds,
+        blocking,
+        pipes,
+        child_hooks));
+  }
 
   delete[] _argv;
 
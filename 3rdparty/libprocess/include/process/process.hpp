@@ -15,8 +15,11 @@
 
 #include <stdint.h>
 
+#include <atomic>
 #include <map>
+#include <memory>
 #include <queue>
+#include <type_traits>
 #include <vector>
 
 #include <process/address.hpp>
@@ -39,9 +42,14 @@
 namespace process {
 
 // Forward declaration.
+class EventQueue;
+class EventStatistics;
 class Logging;
 class Sequence;
 
+template <typename T>
+class RouteTrie;
+
 namespace firewall {
 
 /**
@@ -376,23 +384,16 @@ protected:
   template <typename T>
   size_t eventCount()
   {
-    size_t count = 0U;
-
-    synchronized (mutex) {
-      count = std::count_if(events.begin(), events.end(), isEventType<T>);
-    }
-
-    return count;
+    return eventCounts[eventType<T>()].load();
   }
 
 private:
   friend class SocketManager;
   friend class ProcessManager;
-  friend class ProcessReference;
   friend void* schedule(void*);
 
   // Process states.
-  enum
+  enum ProcessState
   {
     BOTTOM,
     READY,
@@ -400,21 +401,36 @@ private:
     BLOCKED,
     TERMINATING,
     TERMINATED
-  } state;
+  };
+
+  // Only the thread running the process moves it out of `READY` or
+  // `RUNNING`, the threads that enqueue events move it from `BLOCKED`
+  // to `READY`.
+  std::atomic<ProcessState> state;
 
+  // Index into `eventCounts` of each type of event.
   template <typename T>
-  static bool isEventType(const Event* event)
+  static constexpr size_t eventType()
   {
-    return event->is<T>();
+    return std::is_same<T, MessageEvent>::value ? 0 :
+           std::is_same<T, DispatchEvent>::value ? 1 :
+           std::is_same<T, HttpEvent>::value ? 2 :
+           std::is_same<T, ExitedEvent>::value ? 3 : 4;
   }
 
-  // Mutex protecting internals.
-  // TODO(benh): Consider replacing with a spinlock, on multi-core systems.
-  std::recursive_mutex mutex;
+  static size_t eventType(const Event& event);
 
   // Enqueue the specified message, request, or function call.
   void enqueue(Event* event, bool inject = false);
 
+  // Enqueue the specified events at once, in order, so that they are
+  // linked into the queue and the process is made runnable only once.
+  void enqueue(const std::vector<Event*>& events);
+
+  // Dequeue the next event, may only be called by the thread running
+  // the process.
+  Event* dequeue();
+
   // Delegates for messages.
   std::map<std::string, UPID> delegates;
 
@@ -444,7 +460,10 @@ private:
   // Handlers for messages and HTTP requests.
   struct {
     std::map<std::string, MessageHandler> message;
-    std::map<std::string, HttpEndpoint> http;
+
+    // The HTTP endpoints by their path relative to the process, e.g.,
+    // "a/b" for "/id/a/b". Initialized lazily by `route()`.
+    Owned<RouteTrie<HttpEndpoint>> http;
 
     // Used for delivering HTTP requests in the correct order.
     // Initialized lazily to avoid ProcessBase requiring
@@ -468,11 +487,23 @@ private:
   // Static assets(s) to provide.
   std::map<std::string, Asset> assets;
 
-  // Queue of received events, requires lock()ed access!
-  std::deque<Event*> events;
+  // Queue of received events.
+  std::unique_ptr<EventQueue> events;
+
+  // Number of events of each type in `events`, see `eventType()`.
+  std::atomic_size_t eventCounts[5];
+
+  // Statistics of the served events, if enabled.
+  std::unique_ptr<EventStatistics> statistics;
+
+  // The reference that is shared with all active references to the
+  // process (see `ProcessReference`). Set while the process is
+  // spawned, i.e., from `ProcessManager::spawn` until it gets reset
+  // by `ProcessManager::cleanup`, protected by the processes lock.
+  std::shared_ptr<ProcessBase*> reference;
 
-  // Active references.
-  std::atomic_long refs;
+  // Number of threads that are enqueueing an event.
+  std::atomic_long enqueuers;
 
   // Process PID.
   UPID pid;
@@ -43,6 +43,11 @@ protected:
             authenticationRealm.get(),
             STOP_HELP(),
             &Profiler::stop);
+
+      route("/flamegraph",
+            authenticationRealm.get(),
+            FLAMEGRAPH_HELP(),
+            &Profiler::flamegraph);
     } else {
       route("/start",
             START_HELP(),
@@ -55,12 +60,19 @@ protected:
             [this](const http::Request& request) {
               return Profiler::stop(request, None());
             });
+
+      route("/flamegraph",
+            FLAMEGRAPH_HELP(),
+            [this](const http::Request& request) {
+              return Profiler::flamegraph(request, None());
+            });
     }
   }
 
 private:
   static const std::string START_HELP();
   static const std::string STOP_HELP();
+  static const std::string FLAMEGRAPH_HELP();
 
   // HTTP endpoints.
 
@@ -76,6 +88,19 @@ private:
       const http::Request& request,
       const Option<std::string>& /* principal */);
 
+  // Samples the processes that are running for the requested duration,
+  // and returns the samples in folded stacks format. Unlike `start` and
+  // `stop`, this does not require perftools.
+  Future<http::Response> flamegraph(
+      const http::Request& request,
+      const Option<std::string>& /* principal */);
+
+  // Whether the perftools profiler is running.
+  bool started = false;
+
+  // Whether a `flamegraph` request is sampling.
+  bool sampling = false;
+
   // The authentication realm that the profiler's HTTP endpoints will be
   // installed into.
   Option<std::string> authenticationRealm;
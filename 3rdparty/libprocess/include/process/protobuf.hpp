@@ -18,7 +18,9 @@
 #include <google/protobuf/message.h>
 #include <google/protobuf/repeated_field.h>
 
+#include <memory>
 #include <set>
+#include <string>
 #include <vector>
 
 #include <process/defer.hpp>
@@ -138,6 +140,7 @@ protected:
     protobufHandlers[m->GetTypeName()] =
       lambda::bind(&handlerM<M>,
                    t, method,
+                   std::make_shared<PooledMessage<M>>(),
                    lambda::_1, lambda::_2);
     delete m;
   }
@@ -165,6 +168,7 @@ protected:
     protobufHandlers[m->GetTypeName()] =
       lambda::bind(&handler1<M, P1, P1C>,
                    t, method, param1,
+                   std::make_shared<PooledMessage<M>>(),
                    lambda::_1, lambda::_2);
     delete m;
   }
@@ -182,6 +186,7 @@ protected:
     protobufHandlers[m->GetTypeName()] =
       lambda::bind(&handler2<M, P1, P1C, P2, P2C>,
                    t, method, p1, p2,
+                   std::make_shared<PooledMessage<M>>(),
                    lambda::_1, lambda::_2);
     delete m;
   }
@@ -201,6 +206,7 @@ protected:
     protobufHandlers[m->GetTypeName()] =
       lambda::bind(&handler3<M, P1, P1C, P2, P2C, P3, P3C>,
                    t, method, p1, p2, p3,
+                   std::make_shared<PooledMessage<M>>(),
                    lambda::_1, lambda::_2);
     delete m;
   }
@@ -222,6 +228,7 @@ protected:
     protobufHandlers[m->GetTypeName()] =
       lambda::bind(&handler4<M, P1, P1C, P2, P2C, P3, P3C, P4, P4C>,
                    t, method, p1, p2, p3, p4,
+                   std::make_shared<PooledMessage<M>>(),
                    lambda::_1, lambda::_2);
     delete m;
   }
@@ -245,6 +252,7 @@ protected:
     protobufHandlers[m->GetTypeName()] =
       lambda::bind(&handler5<M, P1, P1C, P2, P2C, P3, P3C, P4, P4C, P5, P5C>,
                    t, method, p1, p2, p3, p4, p5,
+                   std::make_shared<PooledMessage<M>>(),
                    lambda::_1, lambda::_2);
     delete m;
   }
@@ -271,6 +279,7 @@ protected:
       lambda::bind(&handler6<M, P1, P1C, P2, P2C, P3, P3C,
                                 P4, P4C, P5, P5C, P6, P6C>,
                    t, method, p1, p2, p3, p4, p5, p6,
+                   std::make_shared<PooledMessage<M>>(),
                    lambda::_1, lambda::_2);
     delete m;
   }
@@ -300,6 +309,7 @@ protected:
       lambda::bind(&handler7<M, P1, P1C, P2, P2C, P3, P3C,
                                 P4, P4C, P5, P5C, P6, P6C, P7, P7C>,
                    t, method, p1, p2, p3, p4, p5, p6, p7,
+                   std::make_shared<PooledMessage<M>>(),
                    lambda::_1, lambda::_2);
     delete m;
   }
@@ -332,6 +342,7 @@ protected:
                                 P4, P4C, P5, P5C, P6, P6C,
                                 P7, P7C, P8, P8C>,
                    t, method, p1, p2, p3, p4, p5, p6, p7, p8,
+                   std::make_shared<PooledMessage<M>>(),
                    lambda::_1, lambda::_2);
     delete m;
   }
@@ -345,6 +356,7 @@ protected:
     protobufHandlers[m->GetTypeName()] =
       lambda::bind(&_handlerM<M>,
                    t, method,
+                   std::make_shared<PooledMessage<M>>(),
                    lambda::_1, lambda::_2);
     delete m;
   }
@@ -372,6 +384,7 @@ protected:
     protobufHandlers[m->GetTypeName()] =
       lambda::bind(&_handler1<M, P1, P1C>,
                    t, method, param1,
+                   std::make_shared<PooledMessage<M>>(),
                    lambda::_1, lambda::_2);
     delete m;
   }
@@ -389,6 +402,7 @@ protected:
     protobufHandlers[m->GetTypeName()] =
       lambda::bind(&_handler2<M, P1, P1C, P2, P2C>,
                    t, method, p1, p2,
+                   std::make_shared<PooledMessage<M>>(),
                    lambda::_1, lambda::_2);
     delete m;
   }
@@ -408,6 +422,7 @@ protected:
     protobufHandlers[m->GetTypeName()] =
       lambda::bind(&_handler3<M, P1, P1C, P2, P2C, P3, P3C>,
                    t, method, p1, p2, p3,
+                   std::make_shared<PooledMessage<M>>(),
                    lambda::_1, lambda::_2);
     delete m;
   }
@@ -429,6 +444,7 @@ protected:
     protobufHandlers[m->GetTypeName()] =
       lambda::bind(&_handler4<M, P1, P1C, P2, P2C, P3, P3C, P4, P4C>,
                    t, method, p1, p2, p3, p4,
+                   std::make_shared<PooledMessage<M>>(),
                    lambda::_1, lambda::_2);
     delete m;
   }
@@ -452,6 +468,7 @@ protected:
     protobufHandlers[m->GetTypeName()] =
       lambda::bind(&_handler5<M, P1, P1C, P2, P2C, P3, P3C, P4, P4C, P5, P5C>,
                    t, method, p1, p2, p3, p4, p5,
+                   std::make_shared<PooledMessage<M>>(),
                    lambda::_1, lambda::_2);
     delete m;
   }
@@ -478,6 +495,7 @@ protected:
       lambda::bind(&_handler6<M, P1, P1C, P2, P2C, P3, P3C,
                                  P4, P4C, P5, P5C, P6, P6C>,
                    t, method, p1, p2, p3, p4, p5, p6,
+                   std::make_shared<PooledMessage<M>>(),
                    lambda::_1, lambda::_2);
     delete m;
   }
@@ -506,6 +524,7 @@ protected:
       lambda::bind(&_handler7<M, P1, P1C, P2, P2C, P3, P3C,
                                  P4, P4C, P5, P5C, P6, P6C, P7, P7C>,
                    t, method, p1, p2, p3, p4, p5, p6, p7,
+                   std::make_shared<PooledMessage<M>>(),
                    lambda::_1, lambda::_2);
     delete m;
   }
@@ -513,16 +532,77 @@ protected:
   using process::Process<T>::install;
 
 private:
+  // A message reused by a handler for every event it handles, so that
+  // the (hot) handlers do not allocate and free the message and its
+  // fields each time: parsing into a message keeps the memory of its
+  // strings and repeated fields for the next one.
+  template <typename M>
+  struct PooledMessage
+  {
+    PooledMessage() : used(false) {}
+
+    M message;
+
+    // Whether the message is in use, i.e., the handler is being
+    // re-entered while handling an event.
+    bool used;
+  };
+
+  // Parses an event into the pooled message of a handler if possible,
+  // otherwise into a new message, e.g., if the handler is re-entered
+  // or if the event is too large to keep its memory around.
+  template <typename M>
+  class ParsedMessage
+  {
+  public:
+    ParsedMessage(
+        const std::shared_ptr<PooledMessage<M>>& _pool,
+        const std::string& data)
+    {
+      // Bounds the memory a pooled message keeps.
+      static const size_t MAX_POOLED_SIZE = 64 * 1024;
+
+      if (!_pool->used && data.size() <= MAX_POOLED_SIZE) {
+        pool = _pool;
+        pool->used = true;
+        message = &pool->message;
+      } else {
+        owned.reset(new M());
+        message = owned.get();
+      }
+
+      message->ParseFromString(data);
+    }
+
+    ~ParsedMessage()
+    {
+      if (pool) {
+        pool->used = false;
+      }
+    }
+
+    const M& get() const { return *message; }
+
+  private:
+    ParsedMessage(const ParsedMessage&) = delete;
+    ParsedMessage& operator=(const ParsedMessage&) = delete;
+
+    std::shared_ptr<PooledMessage<M>> pool;
+    std::unique_ptr<M> owned;
+    M* message;
+  };
+
   // Handlers that take the sender as the first argument.
   template <typename M>
   static void handlerM(
       T* t,
       void (T::*method)(const process::UPID&, const M&),
+      const std::shared_ptr<PooledMessage<M>>& pool,
       const process::UPID& sender,
       const std::string& data)
   {
-    M m;
-    m.ParseFromString(data);
+    ParsedMessage<M> parsed(pool, data);
+    const M& m = parsed.get();
     if (m.IsInitialized()) {
       (t->*method)(sender, m);
     } else {
@@ -546,11 +626,12 @@ private:
       T* t,
       void (T::*method)(const process::UPID&, P1C),
       P1 (M::*p1)() const,
+      const std::shared_ptr<PooledMessage<M>>& pool,
       const process::UPID& sender,
       const std::string& data)
   {
-    M m;
-    m.ParseFromString(data);
+    ParsedMessage<M> parsed(pool, data);
+    const M& m = parsed.get();
     if (m.IsInitialized()) {
       (t->*method)(sender, google::protobuf::convert((&m->*p1)()));
     } else {
@@ -567,11 +648,12 @@ private:
       void (T::*method)(const process::UPID&, P1C, P2C),
       P1 (M::*p1)() const,
       P2 (M::*p2)() const,
+      const std::shared_ptr<PooledMessage<M>>& pool,
       const process::UPID& sender,
       const std::string& data)
   {
-    M m;
-    m.ParseFromString(data);
+    ParsedMessage<M> parsed(pool, data);
+    const M& m = parsed.get();
     if (m.IsInitialized()) {
       (t->*method)(sender,
                    google::protobuf::convert((&m->*p1)()),
@@ -592,11 +674,12 @@ private:
       P1 (M::*p1)() const,
       P2 (M::*p2)() const,
       P3 (M::*p3)() const,
+      const std::shared_ptr<PooledMessage<M>>& pool,
       const process::UPID& sender,
       const std::string& data)
   {
-    M m;
-    m.ParseFromString(data);
+    ParsedMessage<M> parsed(pool, data);
+    const M& m = parsed.get();
     if (m.IsInitialized()) {
       (t->*method)(sender,
                    google::protobuf::convert((&m->*p1)()),
@@ -620,11 +703,12 @@ private:
       P2 (M::*p2)() const,
       P3 (M::*p3)() const,
       P4 (M::*p4)() const,
+      const std::shared_ptr<PooledMessage<M>>& pool,
       const process::UPID& sender,
       const std::string& data)
   {
-    M m;
-    m.ParseFromString(data);
+    ParsedMessage<M> parsed(pool, data);
+    const M& m = parsed.get();
     if (m.IsInitialized()) {
       (t->*method)(sender,
                    google::protobuf::convert((&m->*p1)()),
@@ -651,11 +735,12 @@ private:
       P3 (M::*p3)() const,
       P4 (M::*p4)() const,
       P5 (M::*p5)() const,
+      const std::shared_ptr<PooledMessage<M>>& pool,
       const process::UPID& sender,
       const std::string& data)
   {
-    M m;
-    m.ParseFromString(data);
+    ParsedMessage<M> parsed(pool, data);
+    const M& m = parsed.get();
     if (m.IsInitialized()) {
       (t->*method)(sender,
                    google::protobuf::convert((&m->*p1)()),
@@ -685,11 +770,12 @@ private:
       P4 (M::*p4)() const,
       P5 (M::*p5)() const,
       P6 (M::*p6)() const,
+      const std::shared_ptr<PooledMessage<M>>& pool,
       const process::UPID& sender,
       const std::string& data)
   {
-    M m;
-    m.ParseFromString(data);
+    ParsedMessage<M> parsed(pool, data);
+    const M& m = parsed.get();
     if (m.IsInitialized()) {
       (t->*method)(sender,
                    google::protobuf::convert((&m->*p1)()),
@@ -723,11 +809,12 @@ private:
       P5 (M::*p5)() const,
       P6 (M::*p6)() const,
       P7 (M::*p7)() const,
+      const std::shared_ptr<PooledMessage<M>>& pool,
       const process::UPID& sender,
       const std::string& data)
   {
-    M m;
-    m.ParseFromString(data);
+    ParsedMessage<M> parsed(pool, data);
+    const M& m = parsed.get();
     if (m.IsInitialized()) {
       (t->*method)(sender,
                    google::protobuf::convert((&m->*p1)()),
@@ -764,11 +851,12 @@ private:
       P6 (M::*p6)() const,
       P7 (M::*p7)() const,
       P8 (M::*p8)() const,
+      const std::shared_ptr<PooledMessage<M>>& pool,
       const process::UPID& sender,
       const std::string& data)
   {
-    M m;
-    m.ParseFromString(data);
+    ParsedMessage<M> parsed(pool, data);
+    const M& m = parsed.get();
     if (m.IsInitialized()) {
       (t->*method)(sender,
                    google::protobuf::convert((&m->*p1)()),
@@ -790,11 +878,12 @@ private:
   static void _handlerM(
       T* t,
       void (T::*method)(const M&),
+      const std::shared_ptr<PooledMessage<M>>& pool,
       const process::UPID&,
       const std::string& data)
   {
-    M m;
-    m.ParseFromString(data);
+    ParsedMessage<M> parsed(pool, data);
+    const M& m = parsed.get();
     if (m.IsInitialized()) {
       (t->*method)(m);
     } else {
@@ -818,11 +907,12 @@ private:
       T* t,
       void (T::*method)(P1C),
       P1 (M::*p1)() const,
+      const std::shared_ptr<PooledMessage<M>>& pool,
       const process::UPID&,
       const std::string& data)
   {
-    M m;
-    m.ParseFromString(data);
+    ParsedMessage<M> parsed(pool, data);
+    const M& m = parsed.get();
     if (m.IsInitialized()) {
       (t->*method)(google::protobuf::convert((&m->*p1)()));
     } else {
@@ -839,11 +929,12 @@ private:
       void (T::*method)(P1C, P2C),
       P1 (M::*p1)() const,
       P2 (M::*p2)() const,
+      const std::shared_ptr<PooledMessage<M>>& pool,
       const process::UPID&,
       const std::string& data)
   {
-    M m;
-    m.ParseFromString(data);
+    ParsedMessage<M> parsed(pool, data);
+    const M& m = parsed.get();
     if (m.IsInitialized()) {
       (t->*method)(google::protobuf::convert((&m->*p1)()),
                    google::protobuf::convert((&m->*p2)()));
@@ -863,11 +954,12 @@ private:
       P1 (M::*p1)() const,
       P2 (M::*p2)() const,
       P3 (M::*p3)() const,
+      const std::shared_ptr<PooledMessage<M>>& pool,
       const process::UPID&,
       const std::string& data)
   {
-    M m;
-    m.ParseFromString(data);
+    ParsedMessage<M> parsed(pool, data);
+    const M& m = parsed.get();
     if (m.IsInitialized()) {
       (t->*method)(google::protobuf::convert((&m->*p1)()),
                    google::protobuf::convert((&m->*p2)()),
@@ -890,11 +982,12 @@ private:
       P2 (M::*p2)() const,
       P3 (M::*p3)() const,
       P4 (M::*p4)() const,
+      const std::shared_ptr<PooledMessage<M>>& pool,
       const process::UPID&,
       const std::string& data)
   {
-    M m;
-    m.ParseFromString(data);
+    ParsedMessage<M> parsed(pool, data);
+    const M& m = parsed.get();
     if (m.IsInitialized()) {
       (t->*method)(google::protobuf::convert((&m->*p1)()),
                    google::protobuf::convert((&m->*p2)()),
@@ -920,11 +1013,12 @@ private:
       P3 (M::*p3)() const,
       P4 (M::*p4)() const,
       P5 (M::*p5)() const,
+      const std::shared_ptr<PooledMessage<M>>& pool,
       const process::UPID&,
       const std::string& data)
   {
-    M m;
-    m.ParseFromString(data);
+    ParsedMessage<M> parsed(pool, data);
+    const M& m = parsed.get();
     if (m.IsInitialized()) {
       (t->*method)(google::protobuf::convert((&m->*p1)()),
                    google::protobuf::convert((&m->*p2)()),
@@ -953,11 +1047,12 @@ private:
       P4 (M::*p4)() const,
       P5 (M::*p5)() const,
       P6 (M::*p6)() const,
+      const std::shared_ptr<PooledMessage<M>>& pool,
       const process::UPID&,
       const std::string& data)
   {
-    M m;
-    m.ParseFromString(data);
+    ParsedMessage<M> parsed(pool, data);
+    const M& m = parsed.get();
     if (m.IsInitialized()) {
       (t->*method)(google::protobuf::convert((&m->*p1)()),
                    google::protobuf::convert((&m->*p2)()),
@@ -989,11 +1084,12 @@ private:
       P5 (M::*p5)() const,
       P6 (M::*p6)() const,
       P7 (M::*p7)() const,
+      const std::shared_ptr<PooledMessage<M>>& pool,
       const process::UPID&,
       const std::string& data)
   {
-    M m;
-    m.ParseFromString(data);
+    ParsedMessage<M> parsed(pool, data);
+    const M& m = parsed.get();
     if (m.IsInitialized()) {
       (t->*method)(google::protobuf::convert((&m->*p1)()),
                    google::protobuf::convert((&m->*p2)()),
@@ -19,6 +19,7 @@
 #include <process/id.hpp>
 #include <process/process.hpp>
 
+#include <stout/hashmap.hpp>
 #include <stout/multihashmap.hpp>
 #include <stout/option.hpp>
 #include <stout/result.hpp>
@@ -47,7 +48,18 @@ protected:
 private:
   const Duration interval();
 
+  // Watches a child with a pidfd (on Linux), which becomes readable
+  // as soon as the child exits, so that the child does not need to
+  // be polled. Other pids are left to be polled.
+  void watch(pid_t pid);
+
+  // Invoked once the pidfd of a watched child is readable.
+  void exited(pid_t pid, const Future<short>& poll);
+
   multihashmap<pid_t, Owned<Promise<Option<int>>>> promises;
+
+  // The pidfds of the watched children, which are not polled.
+  hashmap<pid_t, int> pidfds;
 };
 
 
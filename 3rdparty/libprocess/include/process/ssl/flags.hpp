@@ -17,6 +17,7 @@
 
 #include <string>
 
+#include <stout/duration.hpp>
 #include <stout/flags.hpp>
 #include <stout/option.hpp>
 
@@ -49,6 +50,9 @@ public:
   bool enable_tls_v1_0;
   bool enable_tls_v1_1;
   bool enable_tls_v1_2;
+  unsigned int session_cache_size;
+  Duration session_timeout;
+  Option<std::string> session_ticket_key_file;
 };
 
 
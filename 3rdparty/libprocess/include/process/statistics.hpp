@@ -31,8 +31,9 @@ struct Statistics
 {
   // Returns Statistics for the given TimeSeries, or None() if the
   // TimeSeries is empty.
-  // TODO(dhamon): Consider adding a histogram abstraction for better
-  // performance.
+  // NOTE: This sorts all the values of the TimeSeries; see
+  // 'metrics::Histogram' for a metric whose statistics are computed
+  // from a fixed number of buckets instead.
   static Option<Statistics<T>> from(const TimeSeries<T>& timeseries)
   {
     std::vector<typename TimeSeries<T>::Value> values_ = timeseries.get();
@@ -234,6 +234,16 @@ public:
      */
     static ChildHook SUPERVISOR();
 
+    /**
+     * `ChildHook` for running the given function in the child.
+     *
+     * NOTE: The function has to be async signal safe. It may also
+     * exit the child rather than return (e.g., if the child was
+     * cloned with CLONE_VM and hands off its file descriptors instead
+     * of executing the new process).
+     */
+    static ChildHook CALL(const lambda::function<Try<Nothing>()>& f);
+
     Try<Nothing> operator()() const { return child_setup(); }
 
   private:
@@ -381,7 +391,10 @@ private:
  *     subprocess or if None (the default) then the new subprocess
  *     will inherit the environment of the current process.
  * @param clone Function to be invoked in order to fork/clone the
- *     subprocess.
+ *     subprocess. If None (the default) and there are no hooks, the
+ *     subprocess is launched with 'posix_spawn' on POSIX systems,
+ *     which is cheaper than forking a parent with a large memory
+ *     footprint.
  * @param parent_hooks Hooks that will be executed in the parent
  *     before the child execs.
  * @param child_hooks Hooks that will be executed in the child
@@ -419,7 +432,10 @@ Try<Subprocess> subprocess(
  *     subprocess or if None (the default) then the new subprocess
  *     will inherit the environment of the current process.
  * @param clone Function to be invoked in order to fork/clone the
- *     subprocess.
+ *     subprocess. If None (the default) and there are no hooks, the
+ *     subprocess is launched with 'posix_spawn' on POSIX systems,
+ *     which is cheaper than forking a parent with a large memory
+ *     footprint.
  * @param parent_hooks Hooks that will be executed in the parent
  *     before the child execs.
  * @param child_hooks Hooks that will be executed in the child
@@ -13,10 +13,11 @@
 #ifndef __PROCESS_TIMESERIES_HPP__
 #define __PROCESS_TIMESERIES_HPP__
 
-#include <algorithm> // For max.
-#include <map>
+#include <algorithm>
 #include <vector>
 
+#include <boost/circular_buffer.hpp>
+
 #include <process/clock.hpp>
 #include <process/time.hpp>
 
@@ -45,14 +46,14 @@ extern const size_t TIME_SERIES_CAPACITY;
 // total number of data points to keep around, which informs how
 // often to delete older data points, while still keeping a window
 // worth of data.
-// TODO(bmahler): Investigate using Google's btree implementation.
-// This provides better insertion and lookup performance for large
-// containers. This _should_ also provide significant memory
-// savings. These are true because we have the following properties:
-//   1. Our insertion order will mostly be in sorted order.
-//   2. Our keys (Seconds) have efficient comparison operators.
-// See: http://code.google.com/p/cpp-btree/
-//      http://code.google.com/p/cpp-btree/wiki/UsageInstructions
+//
+// The values are stored contiguously in a ring buffer bounded by the
+// capacity, rather than in a node per value, since there may be one
+// time series for each of thousands of metrics. The buffer only
+// grows to the capacity as values are set. Since values are mostly
+// set in time order, setting a value is O(1) except for the
+// sparsification, which shifts the (older) values preceding the one
+// it removes, i.e., at most half of the time series.
 template <typename T>
 struct TimeSeries
 {
@@ -60,7 +61,9 @@ struct TimeSeries
              size_t _capacity = TIME_SERIES_CAPACITY)
     : window(_window),
       // The truncation technique requires at least 3 elements.
-      capacity(std::max((size_t) 3, _capacity)) {}
+      capacity(std::max((size_t) 3, _capacity)),
+      // Leave room for the value set before sparsifying.
+      values(capacity + 1) {}
 
   struct Value
   {
@@ -73,16 +76,27 @@ struct TimeSeries
 
   void set(const T& value, const Time& time = Clock::now())
   {
-    // If we're not inserting at the end of the time series, then
-    // we have to reset the sparsification index. Given that
-    // out-of-order insertion is a rare use-case. This is a simple way
-    // to keep insertions O(log(n)). No need to figure out how to
-    // adjust the truncation index.
-    if (!values.empty() && time < values.rbegin()->first) {
-      index = None();
+    if (values.empty() || values.back().time < time) {
+      values.push_back(Value(time, value));
+    } else {
+      // If we're not inserting at the end of the time series, then
+      // we have to reset the sparsification index. Given that
+      // out-of-order insertion is a rare use-case. This is a simple
+      // way to keep insertions cheap. No need to figure out how to
+      // adjust the truncation index.
+      if (time < values.back().time) {
+        index = None();
+      }
+
+      typename Buffer::iterator position = lower(time);
+
+      if (position != values.end() && position->time == time) {
+        position->data = value;
+      } else {
+        values.insert(position, Value(time, value));
+      }
     }
 
-    values[time] = value;
     truncate();
     sparsify();
   }
@@ -97,18 +111,27 @@ struct TimeSeries
       return std::vector<Value>();
     }
 
-    typename std::map<Time, T>::const_iterator lower = values.lower_bound(
-        start.isSome() ? start.get() : Time::epoch());
+    typename Buffer::const_iterator lower = std::lower_bound(
+        values.begin(),
+        values.end(),
+        start.isSome() ? start.get() : Time::epoch(),
+        [](const Value& value, const Time& time) {
+          return value.time < time;
+        });
 
-    typename std::map<Time, T>::const_iterator upper = values.upper_bound(
-        stop.isSome() ? stop.get() : Time::max());
+    typename Buffer::const_iterator upper = std::upper_bound(
+        values.begin(),
+        values.end(),
+        stop.isSome() ? stop.get() : Time::max(),
+        [](const Time& time, const Value& value) {
+          return time < value.time;
+        });
 
-    std::vector<Value> values;
-    while (lower != upper) {
-      values.push_back(Value(lower->first, lower->second));
-      ++lower;
+    if (upper < lower) {
+      return std::vector<Value>();
     }
-    return values;
+
+    return std::vector<Value>(lower, upper);
   }
 
   Option<Value> latest() const
@@ -117,7 +140,7 @@ struct TimeSeries
       return None();
     }
 
-    return Value(values.rbegin()->first, values.rbegin()->second);
+    return values.back();
   }
 
   bool empty() const { return values.empty(); }
@@ -129,8 +152,13 @@ struct TimeSeries
   void truncate()
   {
     Time expired = Clock::now() - window;
-    typename std::map<Time, T>::iterator upper_bound =
-      values.upper_bound(expired);
+    typename Buffer::iterator upper_bound = std::upper_bound(
+        values.begin(),
+        values.end(),
+        expired,
+        [](const Time& time, const Value& value) {
+          return time < value.time;
+        });
 
     // Ensure at least 1 value remains.
     if (values.size() <= 1 || upper_bound == values.end()) {
@@ -165,17 +193,32 @@ struct TimeSeries
     //                               After truncating, we must
     //   After:          4 5 6 7 ... reset index to None().
     //   ----------------------------------------------------------
-    if (index.isSome() && upper_bound->first < next->first) {
-      size_t size = values.size();
-      values.erase(values.begin(), upper_bound);
-      index = index.get() - (size - values.size());
+    const size_t removed = upper_bound - values.begin();
+
+    if (index.isSome() && removed < index.get()) {
+      index = index.get() - removed;
     } else {
       index = None();
-      values.erase(values.begin(), upper_bound);
     }
+
+    values.rerase(values.begin(), upper_bound);
   }
 
 private:
+  typedef boost::circular_buffer_space_optimized<Value> Buffer;
+
+  // Returns the first value that is not before the specified time.
+  typename Buffer::iterator lower(const Time& time)
+  {
+    return std::lower_bound(
+        values.begin(),
+        values.end(),
+        time,
+        [](const Value& value, const Time& time) {
+          return value.time < time;
+        });
+  }
+
   // Performs "sparsification" to limit the size of the time series
   // to be within the capacity.
   //
@@ -222,13 +265,14 @@ private:
       // we set it back to the beginning.
       if (index.isNone() || index.get() > values.size() / 2) {
         // The second element is the initial deletion candidate.
-        next = values.begin();
-        ++next;
         index = 1;
       }
 
-      next = values.erase(next);
-      next++; // Skip one element.
+      // Since the candidate is in the older half, we remove it by
+      // shifting the values before it rather than the ones after.
+      values.rerase(values.begin() + index.get());
+
+      // Skip one element.
       index = index.get() + 1;
     }
   }
@@ -237,15 +281,12 @@ private:
   Duration window;
   size_t capacity;
 
-  // We use a map instead of a hashmap to store the values because
-  // that way we can retrieve a series in sorted order efficiently.
-  std::map<Time, T> values;
+  // The values in time order, which lets us retrieve a series in
+  // sorted order efficiently.
+  Buffer values;
 
-  // Next deletion candidate. We store both the iterator and index.
-  // The index is None initially, and whenever a value is appended
-  // out-of-order. This means 'next' is only valid when 'index' is
-  // Some.
-  typename std::map<Time, T>::iterator next;
+  // Index of the next deletion candidate. This is None initially,
+  // and whenever a value is appended out-of-order.
   Option<size_t> index;
 };
 
@@ -12,10 +12,13 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
+#include <atomic>
 #include <list>
 #include <map>
 #include <mutex>
 #include <set>
+#include <vector>
 
 #include <process/clock.hpp>
 #include <process/pid.hpp>
@@ -31,18 +34,20 @@
 #include <stout/unreachable.hpp>
 
 #include "event_loop.hpp"
+#include "timer_wheel.hpp"
 
 using std::list;
 using std::map;
 using std::recursive_mutex;
 using std::set;
+using std::vector;
 
 namespace process {
 
-// We store the timers in a map of lists indexed by the timeout of the
-// timer so that we can have two timers that have the same timeout. We
-// exploit that the map is SORTED!
-static map<Time, list<Timer>>* timers = new map<Time, list<Timer>>();
+// Protects the state of the clock below, i.e., whether it is paused,
+// the paused time and the scheduled 'ticks'. The timers themselves are
+// kept in shards with their own locks (see `clock::shards`), so that
+// timers can be created and canceled concurrently.
 static recursive_mutex* timers_mutex = new recursive_mutex();
 
 
@@ -59,7 +64,7 @@ Time* current = new Time(Time::epoch());
 
 Duration* advanced = new Duration(Duration::zero());
 
-bool paused = false;
+std::atomic_bool paused(false);
 
 // For supporting Clock::settled(), false if we're not currently
 // settling (or we're not paused), true if we're currently attempting
@@ -76,33 +81,73 @@ lambda::function<void(const list<Timer>&)>* callback =
 // scheduled 'ticks'.
 set<Time>* ticks = new set<Time>();
 
+// The time of the earliest scheduled 'tick' in nanoseconds, or the
+// maximum value if there is none. This lets `Clock::timer` skip
+// scheduling a 'tick' without taking the `timers_mutex` when a 'tick'
+// will fire before the new timer anyway.
+std::atomic<int64_t> earliest(Duration::max().ns());
 
-// Helper for determining the time when the next timer elapses,
-// or None if no timers are pending, or the clock is paused and no
-// timers are expired. Note that we don't manipulate 'timers' directly
-// so that it's clear from the callsite that the use of 'timers' is
-// within a 'synchronized' block.
+
+// The timers, sharded by the id of the timer.
+struct Shard
+{
+  std::mutex mutex;
+  TimerWheel wheel;
+};
+
+constexpr size_t SHARDS = 16;
+
+Shard* shards = new Shard[SHARDS];
+
+
+Shard& shard(uint64_t id)
+{
+  return shards[id % SHARDS];
+}
+
+
+// Updates `earliest` after changing 'ticks'. Note that we don't
+// manipulate 'ticks' directly so that it's clear from the callsite
+// that this needs to be called within a 'synchronized' block.
+void updateEarliest(const set<Time>& ticks)
+{
+  earliest.store(
+      ticks.empty() ? Duration::max().ns() : ticks.begin()->duration().ns());
+}
+
+
+// Helper for determining the time when the next 'tick' needs to
+// happen for the timers to elapse, or None if no timers are pending,
+// or the clock is paused and no timers are expired. Note that this
+// may be earlier than the next timer elapses, see
+// `TimerWheel::deadline()`.
 //
-// TODO(benh): Create a generic 'Timers' abstraction which hides this
-// and more away (i.e., all manipulations of 'timers' below).
-Option<Time> next(const map<Time, list<Timer>>& timers)
+// NOTE: This must be called within a 'synchronized (timers_mutex)'
+// block, so that 'ticks' are scheduled consistently.
+Option<Time> next()
 {
-  if (!timers.empty()) {
-    Time first = timers.begin()->first;
-
-    // If the clock is paused and no timers are expired, the
-    // timers cannot fire until the clock is advanced, so we
-    // return None() here. Note that we pass nullptr to ensure
-    // that this looks at the global clock, since this can be
-    // called from a Process context through Clock::timer.
-    if (Clock::paused() && first > Clock::now(nullptr)) {
-      return None();
+  Option<Time> first = None();
+
+  for (size_t i = 0; i < SHARDS; i++) {
+    synchronized (shards[i].mutex) {
+      Option<Time> deadline = shards[i].wheel.deadline();
+      if (deadline.isSome() &&
+          (first.isNone() || deadline.get() < first.get())) {
+        first = deadline;
+      }
     }
+  }
 
-    return first;
+  // If the clock is paused and no timers are expired, the
+  // timers cannot fire until the clock is advanced, so we
+  // return None() here. Note that we pass nullptr to ensure
+  // that this looks at the global clock, since this can be
+  // called from a Process context through Clock::timer.
+  if (first.isSome() && Clock::paused() && first.get() > Clock::now(nullptr)) {
+    return None();
   }
 
-  return None();
+  return first;
 }
 
 
@@ -111,21 +156,22 @@ void tick(const Time& time);
 
 
 // Helper for scheduling the next clock tick, if applicable. Note
-// that we don't manipulate 'timers' or 'ticks' directly so that
-// it's clear from the callsite that this needs to be called within
-// a 'synchronized' block.
+// that we don't manipulate 'ticks' directly so that it's clear from
+// the callsite that this needs to be called within a 'synchronized'
+// block.
 // TODO(bmahler): Consider taking an optional 'now' to avoid
 // excessive syscalls via Clock::now(nullptr).
-void scheduleTick(const map<Time, list<Timer>>& timers, set<Time>* ticks)
+void scheduleTick(set<Time>* ticks)
 {
   // Determine when the next 'tick' should fire.
-  const Option<Time> next = clock::next(timers);
+  const Option<Time> next = clock::next();
 
   if (next.isSome()) {
     // Don't schedule a 'tick' if there is a 'tick' scheduled for
     // an earlier time, to avoid excessive pending timers.
     if (ticks->empty() || next.get() < (*ticks->begin())) {
       ticks->insert(next.get());
+      updateEarliest(*ticks);
 
       // The delay can be negative if the timer is expired, this
       // is expected will result in a 'tick' firing immediately.
@@ -137,11 +183,12 @@ void scheduleTick(const map<Time, list<Timer>>& timers, set<Time>* ticks)
 
 
 // NOTE: This method must remain robust to arbitrary invocations.
-// i.e. `tick` should not make any assumptions of what is held in `timers`,
-// which can be empty or have timers that trigger later than the current time.
+// i.e. `tick` should not make any assumptions of what is held in the
+// timer shards, which can be empty or have timers that trigger later
+// than the current time.
 void tick(const Time& time)
 {
-  list<Timer> timedout;
+  vector<TimerWheel::Entry> expired;
 
   synchronized (timers_mutex) {
     // We pass nullptr to be explicit about the fact that we want the
@@ -151,36 +198,46 @@ void tick(const Time& time)
 
     VLOG(3) << "Handling timers up to " << now;
 
-    foreachkey (const Time& timeout, *timers) {
-      if (timeout > now) {
-        break;
-      }
-
-      VLOG(3) << "Have timeout(s) at " << timeout;
+    // Remove this tick from the scheduled 'ticks', it may have
+    // been removed already if the clock was paused / manipulated
+    // in the interim. This must happen before advancing the
+    // shards, so that `Clock::timer` does not rely on this tick
+    // for timers that are added after their shard was advanced.
+    ticks->erase(time);
+    updateEarliest(*ticks);
 
-      // Need to toggle 'settling' so that we don't prematurely say
-      // we're settled until after the timers are executed below,
-      // outside of the critical section.
-      if (clock::paused) {
-        clock::settling = true;
+    for (size_t i = 0; i < SHARDS; i++) {
+      synchronized (shards[i].mutex) {
+        shards[i].wheel.advance(now, &expired);
       }
-
-      timedout.splice(timedout.end(), (*timers)[timeout]);
     }
 
-    // Now erase the range of timers that timed out.
-    timers->erase(timers->begin(), timers->upper_bound(now));
+    // Need to toggle 'settling' so that we don't prematurely say
+    // we're settled until after the timers are executed below,
+    // outside of the critical section.
+    if (!expired.empty() && clock::paused) {
+      clock::settling = true;
+    }
 
-    // Okay, so the timeout for the next timer should not have fired.
-    CHECK(timers->empty() || (timers->begin()->first > now));
+    // Schedule another "tick" if necessary.
+    scheduleTick(ticks);
+  }
 
-    // Remove this tick from the scheduled 'ticks', it may have
-    // been removed already if the clock was paused / manipulated
-    // in the interim.
-    ticks->erase(time);
+  // Timers expire in the order of their timeouts, and timers with the
+  // same timeout in the order in which they were created.
+  std::sort(
+      expired.begin(),
+      expired.end(),
+      [](const TimerWheel::Entry& left, const TimerWheel::Entry& right) {
+        if (left.timer.timeout().time() != right.timer.timeout().time()) {
+          return left.timer.timeout().time() < right.timer.timeout().time();
+        }
+        return left.id < right.id;
+      });
 
-    // Schedule another "tick" if necessary.
-    scheduleTick(*timers, ticks);
+  list<Timer> timedout;
+  foreach (const TimerWheel::Entry& entry, expired) {
+    timedout.push_back(entry.timer);
   }
 
   (*clock::callback)(timedout);
@@ -189,9 +246,7 @@ void tick(const Time& time)
   // that will expire before the paused time and we've finished
   // executing expired timers.
   synchronized (timers_mutex) {
-    if (clock::paused &&
-        (timers->size() == 0 ||
-         timers->begin()->first > *clock::current)) {
+    if (clock::paused && clock::next().isNone()) {
       VLOG(3) << "Clock has settled";
       clock::settling = false;
     }
@@ -218,9 +273,14 @@ void Clock::finalize()
 
     // This, along with the `timers_mutex`, is all that is required to clean
     // up any pending timers.  Timers are triggered via "ticks".  However,
-    // we do not need to clear `ticks` because a "tick" with an empty `timers`
-    // map will effectively be a no-op.
-    timers->clear();
+    // we do not need to clear `ticks` because a "tick" with empty shards
+    // will effectively be a no-op.
+    for (size_t i = 0; i < clock::SHARDS; i++) {
+      vector<TimerWheel::Entry> cleared;
+      synchronized (clock::shards[i].mutex) {
+        cleared = clock::shards[i].wheel.clear();
+      }
+    }
   }
 }
 
@@ -233,16 +293,20 @@ Time Clock::now()
 
 Time Clock::now(ProcessBase* process)
 {
-  synchronized (timers_mutex) {
-    if (Clock::paused()) {
-      if (process != nullptr) {
-        if (clock::currents->count(process) != 0) {
-          return (*clock::currents)[process];
+  // NOTE: We only need to synchronize with the paused clock, the
+  // current time of the event loop is read without the lock.
+  if (Clock::paused()) {
+    synchronized (timers_mutex) {
+      if (Clock::paused()) {
+        if (process != nullptr) {
+          if (clock::currents->count(process) != 0) {
+            return (*clock::currents)[process];
+          } else {
+            return (*clock::currents)[process] = *clock::initial;
+          }
         } else {
-          return (*clock::currents)[process] = *clock::initial;
+          return *clock::current;
         }
-      } else {
-        return *clock::current;
       }
     }
   }
@@ -278,18 +342,16 @@ Timer Clock::timer(
           << " in the future (" << timeout.time() << ")";
 
   // Add the timer.
-  synchronized (timers_mutex) {
-    if (timers->size() == 0 ||
-        timer.timeout().time() < timers->begin()->first) {
-      // Need to interrupt the loop to update/set timer repeat.
-      (*timers)[timer.timeout().time()].push_back(timer);
+  synchronized (clock::shard(timer.id).mutex) {
+    clock::shard(timer.id).wheel.add(timer.id, timer);
+  }
 
-      // Schedule another "tick" if necessary.
-      clock::scheduleTick(*timers, clock::ticks);
-    } else {
-      // Timer repeat is adequate, just add the timeout.
-      CHECK(timers->size() >= 1);
-      (*timers)[timer.timeout().time()].push_back(timer);
+  // Schedule another "tick" if necessary, unless one is already
+  // scheduled to fire before the timer.
+  if (Clock::paused() ||
+      timer.timeout().time().duration().ns() < clock::earliest.load()) {
+    synchronized (timers_mutex) {
+      clock::scheduleTick(clock::ticks);
     }
   }
 
@@ -299,22 +361,15 @@ Timer Clock::timer(
 
 bool Clock::cancel(const Timer& timer)
 {
-  bool canceled = false;
-  synchronized (timers_mutex) {
-    // Check if the timeout is still pending, and if so, erase it. In
-    // addition, erase an empty list if we just removed the last
-    // timeout.
-    Time time = timer.timeout().time();
-    if (timers->count(time) > 0) {
-      canceled = true;
-      (*timers)[time].remove(timer);
-      if ((*timers)[time].empty()) {
-        timers->erase(time);
-      }
-    }
+  // NOTE: The removed timer is destroyed outside of the lock, since
+  // destroying its thunk might create or cancel timers.
+  Option<Timer> canceled = None();
+  synchronized (clock::shard(timer.id).mutex) {
+    // Erase the timer if it is still pending.
+    canceled = clock::shard(timer.id).wheel.remove(timer.id);
   }
 
-  return canceled;
+  return canceled.isSome();
 }
 
 
@@ -335,6 +390,7 @@ void Clock::pause()
       // that fire immediately will be scheduled while the clock
       // is paused.
       clock::ticks->clear();
+      clock::updateEarliest(*clock::ticks);
     }
   }
 
@@ -363,7 +419,7 @@ void Clock::resume()
       clock::currents->clear();
 
       // Schedule another "tick" if necessary.
-      clock::scheduleTick(*timers, clock::ticks);
+      clock::scheduleTick(clock::ticks);
     }
   }
 }
@@ -381,7 +437,7 @@ void Clock::advance(const Duration& duration)
       // Schedule another "tick" if necessary. Only "ticks" that
       // fire immediately will be scheduled here, since the clock
       // is paused.
-      clock::scheduleTick(*timers, clock::ticks);
+      clock::scheduleTick(clock::ticks);
     }
   }
 }
@@ -418,7 +474,7 @@ void Clock::update(const Time& time)
         // Schedule another "tick" if necessary. Only "ticks" that
         // fire immediately will be scheduled here, since the clock
         // is paused.
-        clock::scheduleTick(*timers, clock::ticks);
+        clock::scheduleTick(clock::ticks);
       }
     }
   }
@@ -458,8 +514,7 @@ bool Clock::settled()
     if (clock::settling) {
       VLOG(3) << "Clock still not settled";
       return false;
-    } else if (timers->size() == 0 ||
-               timers->begin()->first > *clock::current) {
+    } else if (clock::next().isNone()) {
       VLOG(3) << "Clock is settled";
       return true;
     }
@@ -17,16 +17,20 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
 #include <deque>
 #include <limits>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <process/http.hpp>
 
 #include <stout/foreach.hpp>
 #include <stout/gzip.hpp>
+#include <stout/lambda.hpp>
 #include <stout/option.hpp>
+#include <stout/stringify.hpp>
 #include <stout/try.hpp>
 
 
@@ -37,6 +41,95 @@
 
 namespace process {
 
+namespace internal {
+
+// A token of an HTTP request (e.g., a header field) that the parser
+// may deliver in pieces. As long as the token is contained in the
+// data being decoded it only refers to that data, and it is copied
+// into a string only if it continues in the next call to `decode`
+// (see `own`). This way most tokens are copied exactly once, i.e.,
+// into the request.
+class Slice
+{
+public:
+  Slice() : data_(nullptr), size_(0) {}
+
+  void append(const char* data, size_t size)
+  {
+    if (data_ == nullptr && buffer.empty()) {
+      data_ = data;
+      size_ = size;
+    } else {
+      own();
+      buffer.append(data, size);
+    }
+  }
+
+  // Copies the data that is referred to, which must be done before
+  // the data being decoded is reused.
+  void own()
+  {
+    if (data_ != nullptr) {
+      buffer.append(data_, size_);
+      data_ = nullptr;
+      size_ = 0;
+    }
+  }
+
+  const char* data() const
+  {
+    return data_ != nullptr ? data_ : buffer.data();
+  }
+
+  size_t size() const
+  {
+    return data_ != nullptr ? size_ : buffer.size();
+  }
+
+  // Returns the token and clears the slice.
+  std::string take()
+  {
+    std::string result =
+      data_ != nullptr ? std::string(data_, size_) : std::move(buffer);
+
+    clear();
+
+    return result;
+  }
+
+  void clear()
+  {
+    data_ = nullptr;
+    size_ = 0;
+    buffer.clear();
+  }
+
+private:
+  const char* data_;
+  size_t size_;
+  std::string buffer;
+};
+
+
+// The most we reserve for a body up front based on its
+// 'Content-Length', so that a bogus length can't exhaust memory.
+constexpr size_t MAX_RESERVED_BODY_SIZE = 1024 * 1024;
+
+
+inline void reserve(std::string* body, const http_parser& parser)
+{
+  // NOTE: The parser sets the content length to ULLONG_MAX if the
+  // request has no 'Content-Length'.
+  if (parser.content_length > 0 &&
+      parser.content_length != std::numeric_limits<uint64_t>::max()) {
+    body->reserve(std::min<uint64_t>(
+        parser.content_length, MAX_RESERVED_BODY_SIZE));
+  }
+}
+
+} // namespace internal {
+
+
 // TODO(benh): Make DataDecoder abstract and make RequestDecoder a
 // concrete subclass.
 class DataDecoder
@@ -80,6 +173,11 @@ public:
       failure = true;
     }
 
+    // The caller may reuse the data once we return.
+    field.own();
+    value.own();
+    url.own();
+
     if (!requests.empty()) {
       std::deque<http::Request*> result = requests;
       requests.clear();
@@ -144,9 +242,8 @@ private:
     CHECK_NOTNULL(decoder->request);
 
     if (decoder->header != HEADER_FIELD) {
-      decoder->request->headers[decoder->field] = decoder->value;
-      decoder->field.clear();
-      decoder->value.clear();
+      decoder->request->headers.put(
+          decoder->field.take(), decoder->value.take());
     }
 
     decoder->field.append(data, length);
@@ -171,15 +268,16 @@ private:
     CHECK_NOTNULL(decoder->request);
 
     // Add final header.
-    decoder->request->headers[decoder->field] = decoder->value;
-    decoder->field.clear();
-    decoder->value.clear();
+    decoder->request->headers.put(
+        decoder->field.take(), decoder->value.take());
 
     decoder->request->method =
       http_method_str((http_method) decoder->parser.method);
 
     decoder->request->keepAlive = http_should_keep_alive(&decoder->parser) != 0;
 
+    internal::reserve(&decoder->request->body, decoder->parser);
+
     return 0;
   }
 
@@ -244,13 +342,10 @@ private:
       if (decompressed.isError()) {
         return 1;
       }
-      decoder->request->body = decompressed.get();
-
-      CHECK_LE(static_cast<long>(decoder->request->body.length()),
-        std::numeric_limits<char>::max());
+      decoder->request->body = std::move(decompressed).get();
 
       decoder->request->headers["Content-Length"] =
-        static_cast<char>(decoder->request->body.length());
+        stringify(decoder->request->body.length());
     }
 
     decoder->requests.push_back(decoder->request);
@@ -269,10 +364,10 @@ private:
     HEADER_VALUE
   } header;
 
-  std::string field;
-  std::string value;
+  internal::Slice field;
+  internal::Slice value;
   std::string query;
-  std::string url;
+  internal::Slice url;
 
   http::Request* request;
 
@@ -439,22 +534,23 @@ private:
       return 1;
     }
 
-    // We can only provide the gzip encoding.
+    // We can only provide the gzip and deflate encodings.
     Option<std::string> encoding =
       decoder->response->headers.get("Content-Encoding");
-    if (encoding.isSome() && encoding.get() == "gzip") {
-      Try<std::string> decompressed = gzip::decompress(decoder->response->body);
+    if (encoding.isSome() &&
+        (encoding.get() == "gzip" || encoding.get() == "deflate")) {
+      Try<std::string> decompressed = gzip::decompress(
+          decoder->response->body,
+          encoding.get() == "gzip" ? gzip::Format::GZIP : gzip::Format::ZLIB);
+
       if (decompressed.isError()) {
         decoder->failure = true;
         return 1;
       }
-      decoder->response->body = decompressed.get();
-
-      CHECK_LE(static_cast<long>(decoder->response->body.length()),
-        std::numeric_limits<char>::max());
+      decoder->response->body = std::move(decompressed).get();
 
       decoder->response->headers["Content-Length"] =
-        static_cast<char>(decoder->response->body.length());
+        stringify(decoder->response->body.length());
     }
 
     decoder->responses.push_back(decoder->response);
@@ -743,11 +839,21 @@ private:
 // the request headers are received, but before the body data
 // is received. Callers are expected to read the body from the
 // Pipe::Reader in the request.
+//
+// Requests for which `buffered` returns true once their headers have
+// been decoded are instead returned as 'BODY' requests after their
+// body has been decoded, which avoids the pipe for requests that are
+// always consumed in full (e.g., libprocess messages).
 class StreamingRequestDecoder
 {
 public:
-  explicit StreamingRequestDecoder()
-    : failure(false), header(HEADER_FIELD), request(nullptr)
+  explicit StreamingRequestDecoder(
+      const lambda::function<bool(const http::Request&)>& _buffered =
+        nullptr)
+    : failure(false),
+      header(HEADER_FIELD),
+      request(nullptr),
+      buffered(_buffered)
   {
     http_parser_settings_init(&settings);
 
@@ -803,6 +909,11 @@ public:
       }
     }
 
+    // The caller may reuse the data once we return.
+    field.own();
+    value.own();
+    url.own();
+
     if (!requests.empty()) {
       std::deque<http::Request*> result = requests;
       requests.clear();
@@ -873,9 +984,8 @@ private:
     CHECK_NOTNULL(decoder->request);
 
     if (decoder->header != HEADER_FIELD) {
-      decoder->request->headers[decoder->field] = decoder->value;
-      decoder->field.clear();
-      decoder->value.clear();
+      decoder->request->headers.put(
+          decoder->field.take(), decoder->value.take());
     }
 
     decoder->field.append(data, length);
@@ -902,9 +1012,8 @@ private:
     CHECK_NOTNULL(decoder->request);
 
     // Add final header.
-    decoder->request->headers[decoder->field] = decoder->value;
-    decoder->field.clear();
-    decoder->value.clear();
+    decoder->request->headers.put(
+        decoder->field.take(), decoder->value.take());
 
     decoder->request->method =
       http_method_str((http_method) decoder->parser.method);
@@ -960,6 +1069,17 @@ private:
 
     CHECK_NONE(decoder->writer);
 
+    // Keep a buffered request until its body has been decoded.
+    if (decoder->buffered && decoder->buffered(*decoder->request)) {
+      decoder->request->type = http::Request::BODY;
+
+      if (decoder->decompressor.get() == nullptr) {
+        internal::reserve(&decoder->request->body, decoder->parser);
+      }
+
+      return 0;
+    }
+
     http::Pipe pipe;
     decoder->writer = pipe.writer();
     decoder->request->reader = pipe.reader();
@@ -976,6 +1096,24 @@ private:
   {
     StreamingRequestDecoder* decoder = (StreamingRequestDecoder*) p->data;
 
+    // Append the body of a buffered request directly.
+    if (decoder->request != nullptr) {
+      if (decoder->decompressor.get() != nullptr) {
+        Try<std::string> decompressed =
+          decoder->decompressor->decompress(std::string(data, length));
+
+        if (decompressed.isError()) {
+          return 1;
+        }
+
+        decoder->request->body.append(decompressed.get());
+      } else {
+        decoder->request->body.append(data, length);
+      }
+
+      return 0;
+    }
+
     CHECK_SOME(decoder->writer);
 
     http::Pipe::Writer writer = decoder->writer.get(); // Remove const.
@@ -1003,6 +1141,20 @@ private:
   {
     StreamingRequestDecoder* decoder = (StreamingRequestDecoder*) p->data;
 
+    if (decoder->request != nullptr) {
+      CHECK_EQ(http::Request::BODY, decoder->request->type);
+
+      if (decoder->decompressor.get() != nullptr &&
+          !decoder->decompressor->finished()) {
+        return 1;
+      }
+
+      decoder->requests.push_back(decoder->request);
+      decoder->request = nullptr;
+
+      return 0;
+    }
+
     CHECK_SOME(decoder->writer);
 
     http::Pipe::Writer writer = decoder->writer.get(); // Remove const.
@@ -1031,15 +1183,17 @@ private:
     HEADER_VALUE
   } header;
 
-  std::string field;
-  std::string value;
+  internal::Slice field;
+  internal::Slice value;
   std::string query;
-  std::string url;
+  internal::Slice url;
 
   http::Request* request;
   Option<http::Pipe::Writer> writer;
   Owned<gzip::Decompressor> decompressor;
 
+  const lambda::function<bool(const http::Request&)> buffered;
+
   std::deque<http::Request*> requests;
 };
 
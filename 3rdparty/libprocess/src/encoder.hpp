@@ -14,10 +14,13 @@
 #define __ENCODER_HPP__
 
 #include <stdint.h>
+#include <stdio.h>
 #include <time.h>
 
 #include <map>
 #include <sstream>
+#include <string>
+#include <utility>
 
 #include <process/http.hpp>
 #include <process/process.hpp>
@@ -26,6 +29,7 @@
 #include <stout/gzip.hpp>
 #include <stout/hashmap.hpp>
 #include <stout/numify.hpp>
+#include <stout/option.hpp>
 #include <stout/os.hpp>
 
 
@@ -33,6 +37,11 @@ namespace process {
 
 const uint32_t GZIP_MINIMUM_BODY_LENGTH = 1024;
 
+// Message bodies up to this length are copied after the header so
+// that the message can be sent at once, larger bodies are sent from
+// the message itself.
+const uint32_t MESSAGE_COPY_MAXIMUM_BODY_LENGTH = 4096;
+
 // Forward declarations.
 class Encoder;
 
@@ -61,8 +70,8 @@ public:
 class DataEncoder : public Encoder
 {
 public:
-  DataEncoder(const std::string& _data)
-    : data(_data), index(0) {}
+  DataEncoder(std::string _data)
+    : data(std::move(_data)), index(0) {}
 
   virtual ~DataEncoder() {}
 
@@ -101,7 +110,20 @@ class MessageEncoder : public DataEncoder
 {
 public:
   MessageEncoder(Message* _message)
-    : DataEncoder(encode(_message)), message(_message) {}
+    : DataEncoder(std::string()),
+      message(_message),
+      header(encodeHeader(_message)),
+      segment(HEADER),
+      index(0)
+  {
+    // Small bodies are sent along with the header.
+    if (message->body.size() <= MESSAGE_COPY_MAXIMUM_BODY_LENGTH) {
+      header.reserve(header.size() + message->body.size() + TRAILER_SIZE);
+      header.append(message->body);
+      header.append(trailer(message), trailerSize(message));
+      message->body.clear();
+    }
+  }
 
   virtual ~MessageEncoder()
   {
@@ -112,42 +134,162 @@ public:
 
   static std::string encode(Message* message)
   {
-    std::ostringstream out;
+    if (message == nullptr) {
+      return std::string();
+    }
 
-    if (message != nullptr) {
-      out << "POST ";
-      // Nothing keeps the 'id' component of a PID from being an empty
-      // string which would create a malformed path that has two
-      // '//' unless we check for it explicitly.
-      // TODO(benh): Make the 'id' part of a PID optional so when it's
-      // missing it's clear that we're simply addressing an ip:port.
-      if (message->to.id != "") {
-        out << "/" << message->to.id;
-      }
+    std::string out = encodeHeader(message);
 
-      out << "/" << message->name << " HTTP/1.1\r\n"
-          << "User-Agent: libprocess/" << message->from << "\r\n"
-          << "Libprocess-From: " << message->from << "\r\n"
-          << "Connection: Keep-Alive\r\n"
-          << "Host: \r\n";
-
-      if (message->body.size() > 0) {
-        out << "Transfer-Encoding: chunked\r\n\r\n"
-            << std::hex << message->body.size() << "\r\n";
-        out.write(message->body.data(), message->body.size());
-        out << "\r\n"
-            << "0\r\n"
-            << "\r\n";
-      } else {
-        out << "\r\n";
-      }
+    out.reserve(out.size() + message->body.size() + TRAILER_SIZE);
+    out.append(message->body);
+    out.append(trailer(message), trailerSize(message));
+
+    return out;
+  }
+
+  // Returns the rest of the current segment of the message, i.e., of
+  // the header, the body, or the trailer, which are sent separately
+  // so that large bodies are not copied.
+  virtual const char* next(size_t* length)
+  {
+    while (segment != DONE && index == segmentSize(segment)) {
+      segment = static_cast<Segment>(segment + 1);
+      index = 0;
     }
 
-    return out.str();
+    if (segment == DONE) {
+      *length = 0;
+      return nullptr;
+    }
+
+    const char* data = segmentData(segment) + index;
+    *length = segmentSize(segment) - index;
+    index = segmentSize(segment);
+    return data;
+  }
+
+  virtual void backup(size_t length)
+  {
+    if (segment != DONE && index >= length) {
+      index -= length;
+    }
+  }
+
+  virtual size_t remaining() const
+  {
+    if (segment == DONE) {
+      return 0;
+    }
+
+    size_t remaining = segmentSize(segment) - index;
+    for (int i = segment + 1; i < DONE; i++) {
+      remaining += segmentSize(static_cast<Segment>(i));
+    }
+
+    return remaining;
   }
 
 private:
+  enum Segment
+  {
+    HEADER,
+    BODY,
+    TRAILER,
+    DONE
+  };
+
+  // Length of the longest trailer, see `trailer()`.
+  static const size_t TRAILER_SIZE = 7;
+
+  // Returns the request line and headers, and the size of the first
+  // chunk if there is a body.
+  static std::string encodeHeader(const Message* message)
+  {
+    const std::string from = message->from;
+
+    std::string out;
+    out.reserve(
+        128 + message->to.id.size() + message->name.size() + from.size() * 2);
+
+    out.append("POST ");
+
+    // Nothing keeps the 'id' component of a PID from being an empty
+    // string which would create a malformed path that has two
+    // '//' unless we check for it explicitly.
+    // TODO(benh): Make the 'id' part of a PID optional so when it's
+    // missing it's clear that we're simply addressing an ip:port.
+    if (message->to.id != "") {
+      out.append("/");
+      out.append(message->to.id);
+    }
+
+    out.append("/");
+    out.append(message->name);
+    out.append(" HTTP/1.1\r\n");
+    out.append("User-Agent: libprocess/");
+    out.append(from);
+    out.append("\r\n");
+    out.append("Libprocess-From: ");
+    out.append(from);
+    out.append("\r\n");
+    out.append("Connection: Keep-Alive\r\n");
+    out.append("Host: \r\n");
+
+    if (message->body.size() > 0) {
+      char size[32];
+      snprintf(size, sizeof(size), "%zx\r\n", message->body.size());
+
+      out.append("Transfer-Encoding: chunked\r\n\r\n");
+      out.append(size);
+    } else {
+      out.append("\r\n");
+    }
+
+    return out;
+  }
+
+  // Returns the end of the chunk and the last chunk, if the message
+  // has a body.
+  static const char* trailer(const Message* message)
+  {
+    return message->body.size() > 0 ? "\r\n0\r\n\r\n" : "";
+  }
+
+  static size_t trailerSize(const Message* message)
+  {
+    return message->body.size() > 0 ? TRAILER_SIZE : 0;
+  }
+
+  const char* segmentData(Segment _segment) const
+  {
+    switch (_segment) {
+      case HEADER: return header.data();
+      case BODY: return message->body.data();
+      case TRAILER: return trailer(message);
+      case DONE: break;
+    }
+
+    return nullptr;
+  }
+
+  size_t segmentSize(Segment _segment) const
+  {
+    switch (_segment) {
+      case HEADER: return header.size();
+      case BODY: return message->body.size();
+      case TRAILER: return trailerSize(message);
+      case DONE: break;
+    }
+
+    return 0;
+  }
+
   Message* message;
+
+  std::string header;
+
+  Segment segment;
+  size_t index;
 };
 
 
@@ -189,20 +331,35 @@ public:
 
     headers["Date"] = date;
 
-    // Should we compress this response?
+    // Should we compress this response? We prefer gzip over deflate
+    // when the client accepts both.
     std::string body = response.body;
 
     if (response.type == http::Response::BODY &&
         response.body.length() >= GZIP_MINIMUM_BODY_LENGTH &&
-        !headers.contains("Content-Encoding") &&
-        request.acceptsEncoding("gzip")) {
-      Try<std::string> compressed = gzip::compress(body);
-      if (compressed.isError()) {
-        LOG(WARNING) << "Failed to gzip response body: " << compressed.error();
-      } else {
-        body = compressed.get();
-        headers["Content-Length"] = stringify(body.length());
-        headers["Content-Encoding"] = "gzip";
+        !headers.contains("Content-Encoding")) {
+      Option<std::string> encoding;
+      gzip::Format format = gzip::Format::GZIP;
+
+      if (request.acceptsEncoding("gzip")) {
+        encoding = "gzip";
+      } else if (request.acceptsEncoding("deflate")) {
+        encoding = "deflate";
+        format = gzip::Format::ZLIB;
+      }
+
+      if (encoding.isSome()) {
+        Try<std::string> compressed =
+          gzip::compress(body, Z_DEFAULT_COMPRESSION, format);
+
+        if (compressed.isError()) {
+          LOG(WARNING) << "Failed to " << encoding.get()
+                       << " response body: " << compressed.error();
+        } else {
+          body = std::move(compressed).get();
+          headers["Content-Length"] = stringify(body.length());
+          headers["Content-Encoding"] = encoding.get();
+        }
       }
     }
 
@@ -243,8 +400,9 @@ public:
 class FileEncoder : public Encoder
 {
 public:
-  FileEncoder(int _fd, size_t _size)
-    : fd(_fd), size(_size), index(0) {}
+  // Encodes the '_size' bytes of the file starting at '_offset'.
+  FileEncoder(int _fd, size_t _size, off_t _offset = 0)
+    : fd(_fd), size(_offset + _size), index(_offset) {}
 
   virtual ~FileEncoder()
   {
@@ -0,0 +1,317 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License
+
+#include <errno.h>
+#include <limits.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <process/io.hpp>
+
+#include <stout/duration.hpp>
+#include <stout/foreach.hpp>
+#include <stout/lambda.hpp>
+#include <stout/numify.hpp>
+#include <stout/option.hpp>
+#include <stout/os.hpp>
+#include <stout/synchronized.hpp>
+
+#include "epoll.hpp"
+#include "event_loop.hpp"
+
+using std::pair;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace process {
+
+std::vector<Reactor*>* reactors = new std::vector<Reactor*>();
+
+
+// The maximum number of events handled per call to `epoll_wait()`.
+static const int MAX_EVENTS = 256;
+
+
+// Converts epoll events to `io::READ` and `io::WRITE`. Like libev, we
+// report errors as both readable and writable, so that the owner of
+// the file descriptor finds out about the error when reading or
+// writing.
+static short convert(uint32_t events)
+{
+  short result = 0;
+
+  if (events & (EPOLLIN | EPOLLPRI | EPOLLRDHUP)) {
+    result |= io::READ;
+  }
+
+  if (events & EPOLLOUT) {
+    result |= io::WRITE;
+  }
+
+  if (events & (EPOLLERR | EPOLLHUP)) {
+    result |= io::READ | io::WRITE;
+  }
+
+  return result;
+}
+
+
+Reactor::Reactor()
+  : epfd(epoll_create1(EPOLL_CLOEXEC)),
+    efd(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)),
+    stopped(false)
+{
+  PCHECK(epfd >= 0) << "Failed to create epoll instance";
+  PCHECK(efd >= 0) << "Failed to create eventfd";
+
+  struct epoll_event event;
+  event.events = EPOLLIN;
+  event.data.fd = efd;
+
+  PCHECK(epoll_ctl(epfd, EPOLL_CTL_ADD, efd, &event) == 0)
+    << "Failed to add eventfd to epoll instance";
+}
+
+
+Reactor::~Reactor()
+{
+  ::close(efd);
+  ::close(epfd);
+}
+
+
+void Reactor::delay(double deadline, const lambda::function<void()>& function)
+{
+  bool earliest = false;
+
+  synchronized (mutex) {
+    auto timer = timers.emplace(deadline, function);
+    earliest = timer == timers.begin();
+  }
+
+  // Only an earliest deadline changes how long the reactor waits.
+  if (earliest) {
+    interrupt();
+  }
+}
+
+
+void Reactor::run()
+{
+  struct epoll_event events[MAX_EVENTS];
+
+  while (true) {
+    int timeout = -1;
+
+    synchronized (mutex) {
+      // Reset `stopped` so that the reactor can be run again, e.g.,
+      // when libprocess is reinitialized.
+      if (stopped) {
+        stopped = false;
+        break;
+      }
+
+      if (!timers.empty()) {
+        const double remaining = timers.begin()->first - EventLoop::time();
+        timeout = static_cast<int>(
+            std::min(std::max(ceil(remaining * 1000), 0.0), double(INT_MAX)));
+      }
+    }
+
+    const int count = epoll_wait(epfd, events, MAX_EVENTS, timeout);
+    if (count < 0) {
+      PCHECK(errno == EINTR) << "Failed to wait for epoll events";
+      continue;
+    }
+
+    vector<pair<shared_ptr<Poll>, short>> ready;
+    vector<lambda::function<void()>> expired;
+
+    synchronized (mutex) {
+      for (int i = 0; i < count; i++) {
+        const int fd = events[i].data.fd;
+
+        if (fd == efd) {
+          uint64_t value;
+          while (::read(efd, &value, sizeof(value)) > 0);
+          continue;
+        }
+
+        const short revents = convert(events[i].events);
+
+        if (polls.contains(fd)) {
+          std::list<shared_ptr<Poll>>& pending = polls.at(fd);
+
+          auto poll = pending.begin();
+          while (poll != pending.end()) {
+            if ((revents & (*poll)->events) != 0) {
+              ready.push_back({*poll, revents & (*poll)->events});
+              poll = pending.erase(poll);
+            } else {
+              ++poll;
+            }
+          }
+        }
+
+        // If the file descriptor can no longer be updated, e.g., it
+        // has been closed in the meantime, we complete the remaining
+        // polls so that their owners find out when doing the I/O.
+        if (update(fd).isError()) {
+          if (polls.contains(fd)) {
+            foreach (const shared_ptr<Poll>& poll, polls.at(fd)) {
+              ready.push_back({poll, poll->events});
+            }
+
+            polls.erase(fd);
+          }
+
+          registered.erase(fd);
+        }
+      }
+
+      const double now = EventLoop::time();
+
+      while (!timers.empty() && timers.begin()->first <= now) {
+        expired.push_back(std::move(timers.begin()->second));
+        timers.erase(timers.begin());
+      }
+    }
+
+    // Complete the polls and invoke the functions outside of the
+    // mutex, since they can poll again.
+    foreach (const auto& poll, ready) {
+      if (poll.first->promise.future().hasDiscard()) {
+        poll.first->promise.discard();
+      } else {
+        poll.first->promise.set(poll.second);
+      }
+    }
+
+    foreach (const lambda::function<void()>& function, expired) {
+      function();
+    }
+  }
+}
+
+
+void Reactor::stop()
+{
+  synchronized (mutex) {
+    stopped = true;
+  }
+
+  interrupt();
+}
+
+
+void Reactor::interrupt()
+{
+  const uint64_t value = 1;
+
+  // NOTE: The write can only fail if the counter would overflow, in
+  // which case the reactor is interrupted already.
+  ssize_t written = ::write(efd, &value, sizeof(value));
+  (void) written;
+}
+
+
+void EventLoop::initialize()
+{
+  // The reactors are kept when libprocess is reinitialized, along with
+  // the polls that are still pending.
+  if (!reactors->empty()) {
+    return;
+  }
+
+  // The number of reactors, which defaults to one per four CPUs, up
+  // to four reactors.
+  const long cpus = os::cpus().isSome() ? os::cpus().get() : 1;
+  long count = std::max(1L, std::min(4L, cpus / 4));
+
+  constexpr char env_var[] = "LIBPROCESS_NUM_EVENT_LOOP_THREADS";
+  Option<string> value = os::getenv(env_var);
+  if (value.isSome()) {
+    constexpr long maxval = 64;
+    Try<long> number = numify<long>(value.get().c_str());
+    if (number.isSome() && number.get() > 0L && number.get() <= maxval) {
+      VLOG(1) << "Overriding default number of event loop threads "
+              << count << ", using the value "
+              <<  env_var << "=" << number.get() << " instead";
+      count = number.get();
+    } else {
+      LOG(WARNING) << "Ignoring invalid value " << value.get()
+                   << " for " << env_var
+                   << ", using default value " << count
+                   << ". Valid values are integers in the range 1 to "
+                   << maxval;
+    }
+  }
+
+  for (long i = 0; i < count; i++) {
+    reactors->push_back(new Reactor());
+  }
+}
+
+
+void EventLoop::delay(
+    const Duration& duration,
+    const lambda::function<void()>& function)
+{
+  reactors->front()->delay(EventLoop::time() + duration.secs(), function);
+}
+
+
+double EventLoop::time()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+
+void EventLoop::run()
+{
+  // The first reactor runs on this thread, the others on their own.
+  vector<std::thread> threads;
+  for (size_t i = 1; i < reactors->size(); i++) {
+    threads.emplace_back(&Reactor::run, (*reactors)[i]);
+  }
+
+  reactors->front()->run();
+
+  foreach (std::thread& thread, threads) {
+    thread.join();
+  }
+}
+
+
+void EventLoop::stop()
+{
+  foreach (Reactor* reactor, *reactors) {
+    reactor->stop();
+  }
+}
+
+} // namespace process {
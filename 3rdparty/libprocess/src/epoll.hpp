@@ -0,0 +1,120 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License
+
+#ifndef __EPOLL_HPP__
+#define __EPOLL_HPP__
+
+#include <stdint.h>
+
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <process/future.hpp>
+
+#include <stout/error.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/lambda.hpp>
+#include <stout/nothing.hpp>
+#include <stout/try.hpp>
+
+namespace process {
+
+// A pending `io::poll` of a file descriptor.
+struct Poll
+{
+  explicit Poll(short _events) : events(_events) {}
+
+  // The `io::READ` and `io::WRITE` events to poll for.
+  const short events;
+
+  Promise<short> promise;
+};
+
+
+// An epoll instance along with the thread that waits for its events.
+// Every file descriptor is owned by one of the reactors (see
+// `reactor()`), which completes the polls of that file descriptor on
+// its own thread, so that the I/O of different sockets is spread
+// across the reactors.
+//
+// Polls are registered and discarded directly from the calling
+// thread, rather than by interrupting the reactor.
+class Reactor
+{
+public:
+  Reactor();
+  ~Reactor();
+
+  // May be called from any thread.
+  Future<short> poll(int fd, short events);
+
+  // Invokes the function on the thread of the reactor once
+  // `EventLoop::time()` has reached the deadline. May be called from
+  // any thread.
+  void delay(double deadline, const lambda::function<void()>& function);
+
+  // Waits for and handles events until the reactor is stopped.
+  void run();
+
+  // Asynchronously tells the reactor to stop and then returns.
+  void stop();
+
+private:
+  void discard(int fd, const std::weak_ptr<Poll>& poll);
+
+  // Registers the events that the polls of the file descriptor are
+  // waiting for with epoll, or removes the file descriptor from epoll
+  // if there are no polls. Unless `refresh` is set, epoll is only
+  // updated if the events changed. Must be called with the mutex held.
+  Try<Nothing, ErrnoError> update(int fd, bool refresh = false);
+
+  // Interrupts `epoll_wait()` on the thread of the reactor.
+  void interrupt();
+
+  const int epfd;
+
+  // An eventfd to interrupt the reactor.
+  const int efd;
+
+  // Protects the variables below.
+  std::mutex mutex;
+
+  // The pending polls of each file descriptor.
+  hashmap<int, std::list<std::shared_ptr<Poll>>> polls;
+
+  // The epoll events each file descriptor is registered for.
+  hashmap<int, uint32_t> registered;
+
+  // The delayed functions, indexed by their deadline.
+  std::multimap<double, lambda::function<void()>> timers;
+
+  bool stopped;
+};
+
+
+// The reactors, created by `EventLoop::initialize()`. The first
+// reactor runs on the thread that runs the event loop and also
+// invokes the delayed functions of the event loop.
+extern std::vector<Reactor*>* reactors;
+
+
+inline Reactor* reactor(int fd)
+{
+  return (*reactors)[static_cast<size_t>(fd) % reactors->size()];
+}
+
+} // namespace process {
+
+#endif // __EPOLL_HPP__
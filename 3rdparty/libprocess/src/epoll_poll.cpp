@@ -0,0 +1,192 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License
+
+#include <errno.h>
+
+#include <sys/epoll.h>
+
+#include <algorithm>
+#include <memory>
+
+#include <process/future.hpp>
+#include <process/io.hpp>
+#include <process/process.hpp> // For process::initialize.
+
+#include <stout/error.hpp>
+#include <stout/foreach.hpp>
+#include <stout/lambda.hpp>
+#include <stout/nothing.hpp>
+#include <stout/option.hpp>
+#include <stout/synchronized.hpp>
+#include <stout/try.hpp>
+
+#include "epoll.hpp"
+
+using std::shared_ptr;
+using std::weak_ptr;
+
+namespace process {
+
+Future<short> Reactor::poll(int fd, short events)
+{
+  shared_ptr<Poll> poll(new Poll(events));
+
+  // Get a copy of the future to avoid any races with the reactor.
+  Future<short> future = poll->promise.future();
+
+  synchronized (mutex) {
+    polls[fd].push_back(poll);
+
+    // NOTE: We refresh the registration even if the events did not
+    // change, since the file descriptor may have been closed (which
+    // removes it from epoll) and reused since it was registered.
+    Try<Nothing, ErrnoError> update = this->update(fd, true);
+    if (update.isError()) {
+      polls[fd].pop_back();
+      if (polls[fd].empty()) {
+        polls.erase(fd);
+      }
+
+      // Files that epoll does not support, e.g., regular files, are
+      // always ready for I/O.
+      if (update.error().code == EPERM) {
+        return events;
+      }
+
+      return Failure(update.error().message);
+    }
+  }
+
+  // Make sure we stop polling if a discard occurs on our future.
+  // Note that it's possible that we'll invoke 'discard' when someone
+  // does a discard even after the polling has already completed, in
+  // which case the poll is no longer pending and nothing happens.
+  future.onDiscard(
+      lambda::bind(&Reactor::discard, this, fd, weak_ptr<Poll>(poll)));
+
+  return future;
+}
+
+
+void Reactor::discard(int fd, const weak_ptr<Poll>& poll)
+{
+  shared_ptr<Poll> discarded = poll.lock();
+  if (!discarded) {
+    return;
+  }
+
+  bool pending = false;
+
+  synchronized (mutex) {
+    if (polls.contains(fd)) {
+      std::list<shared_ptr<Poll>>& waiting = polls.at(fd);
+
+      auto it = std::find(waiting.begin(), waiting.end(), discarded);
+      if (it != waiting.end()) {
+        pending = true;
+        waiting.erase(it);
+
+        // NOTE: We ignore failures here, the registration of a file
+        // descriptor that was closed has been removed by the kernel.
+        update(fd);
+      }
+    }
+  }
+
+  // Only a pending poll is discarded here, otherwise the reactor has
+  // completed it already.
+  if (pending) {
+    discarded->promise.discard();
+  }
+}
+
+
+Try<Nothing, ErrnoError> Reactor::update(int fd, bool refresh)
+{
+  uint32_t interest = 0;
+
+  if (polls.contains(fd)) {
+    foreach (const shared_ptr<Poll>& poll, polls.at(fd)) {
+      if (poll->events & io::READ) {
+        interest |= EPOLLIN | EPOLLRDHUP;
+      }
+
+      if (poll->events & io::WRITE) {
+        interest |= EPOLLOUT;
+      }
+    }
+
+    if (polls.at(fd).empty()) {
+      polls.erase(fd);
+    }
+  }
+
+  Option<uint32_t> current = registered.get(fd);
+
+  if (interest == 0) {
+    if (current.isSome()) {
+      registered.erase(fd);
+
+      // NOTE: Closing a file descriptor removes it from epoll already.
+      if (epoll_ctl(epfd, EPOLL_CTL_DEL, fd, nullptr) < 0 &&
+          errno != EBADF && errno != ENOENT) {
+        return ErrnoError("Failed to remove file descriptor from epoll");
+      }
+    }
+
+    return Nothing();
+  }
+
+  if (current == interest && !refresh) {
+    return Nothing();
+  }
+
+  struct epoll_event event;
+  event.events = interest;
+  event.data.fd = fd;
+
+  // The kernel removes closed file descriptors from epoll, in which
+  // case a file descriptor with the same number has to be added again.
+  int result = epoll_ctl(
+      epfd, current.isSome() ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, fd, &event);
+
+  if (result < 0 && current.isSome() && errno == ENOENT) {
+    result = epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &event);
+  } else if (result < 0 && current.isNone() && errno == EEXIST) {
+    result = epoll_ctl(epfd, EPOLL_CTL_MOD, fd, &event);
+  }
+
+  if (result < 0) {
+    ErrnoError error("Failed to add file descriptor to epoll");
+    registered.erase(fd);
+    return error;
+  }
+
+  registered[fd] = interest;
+
+  return Nothing();
+}
+
+
+namespace io {
+
+Future<short> poll(int fd, short events)
+{
+  process::initialize();
+
+  // TODO(benh): Check if the file descriptor is non-blocking?
+
+  return reactor(fd)->poll(fd, events);
+}
+
+} // namespace io {
+} // namespace process {
@@ -0,0 +1,156 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License
+
+#ifndef __EVENT_QUEUE_HPP__
+#define __EVENT_QUEUE_HPP__
+
+#include <atomic>
+
+#include <process/event.hpp>
+
+namespace process {
+
+// A lock-free queue of the events of a process, to which any thread
+// can enqueue, but from which only the thread that is running the
+// process can dequeue.
+//
+// Injected events are dequeued before all other events.
+class EventQueue
+{
+public:
+  // May be called from any thread.
+  void enqueue(Event* event) { events.enqueue(event); }
+  void inject(Event* event) { injected.enqueue(event); }
+
+  // Enqueues the events from `first` to `last`, already linked
+  // through `Event::next`, at once. May be called from any thread.
+  void enqueue(Event* first, Event* last) { events.enqueue(first, last); }
+
+  // May only be called from the thread running the process. Returns
+  // nullptr if the queue is empty.
+  //
+  // NOTE: An event that is still being enqueued by another thread may
+  // not be returned yet. The enqueueing thread is expected to notice
+  // that the process has been blocked in the meantime and to make it
+  // runnable again.
+  Event* dequeue()
+  {
+    Event* event = injected.dequeue();
+    return event != nullptr ? event : events.dequeue();
+  }
+
+  // May only be called from the thread running the process. Returns
+  // true if `dequeue()` would return nullptr.
+  bool empty() const
+  {
+    return injected.empty() && events.empty();
+  }
+
+private:
+  // An intrusive multi-producer single-consumer queue, linking events
+  // through `Event::next`. See Dmitry Vyukov's "Intrusive MPSC node
+  // based queue".
+  class Queue
+  {
+  public:
+    Queue() : back(&stub), front(&stub) {}
+
+    void enqueue(Event* event)
+    {
+      enqueue(event, event);
+    }
+
+    // The chain becomes visible to the consumer as a whole, and the
+    // producers contend on `back` only once for it.
+    void enqueue(Event* first, Event* last)
+    {
+      last->next.store(nullptr);
+      Event* previous = back.exchange(last);
+      previous->next.store(first);
+    }
+
+    Event* dequeue()
+    {
+      Event* event = front;
+      Event* next = event->next.load();
+
+      if (event == &stub) {
+        if (next == nullptr) {
+          return nullptr;
+        }
+
+        front = next;
+        event = next;
+        next = next->next.load();
+      }
+
+      if (next != nullptr) {
+        front = next;
+        return event;
+      }
+
+      // The last event can only be dequeued once another one follows
+      // it, there is none if an enqueue is still in progress.
+      if (event != back.load()) {
+        return nullptr;
+      }
+
+      enqueue(&stub);
+
+      next = event->next.load();
+      if (next != nullptr) {
+        front = next;
+        return event;
+      }
+
+      return nullptr;
+    }
+
+    bool empty() const
+    {
+      const Event* event = front;
+      const Event* next = event->next.load();
+
+      if (event == &stub) {
+        if (next == nullptr) {
+          return true;
+        }
+
+        event = next;
+        next = next->next.load();
+      }
+
+      return next == nullptr && event != back.load();
+    }
+
+  private:
+    // Placeholder that keeps the queue non-empty, so that producers
+    // never have to update `front`.
+    struct Stub : Event
+    {
+      virtual void visit(EventVisitor* visitor) const {}
+    } stub;
+
+    // The most recently enqueued event, updated by the producers.
+    std::atomic<Event*> back;
+
+    // The next event to dequeue, only accessed by the consumer.
+    Event* front;
+  };
+
+  Queue injected;
+  Queue events;
+};
+
+} // namespace process {
+
+#endif // __EVENT_QUEUE_HPP__
@@ -0,0 +1,311 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License
+
+#ifndef __WINDOWS__
+#include <cxxabi.h>
+#endif // __WINDOWS__
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <typeinfo>
+
+#include <process/defer.hpp>
+#include <process/event.hpp>
+#include <process/future.hpp>
+#include <process/http.hpp>
+#include <process/process.hpp>
+
+#include <process/metrics/gauge.hpp>
+#include <process/metrics/metrics.hpp>
+
+#include <stout/foreach.hpp>
+#include <stout/json.hpp>
+#include <stout/synchronized.hpp>
+
+#include "event_statistics.hpp"
+
+using std::string;
+
+namespace process {
+
+EventStatistics::Global* EventStatistics::global =
+  new EventStatistics::Global();
+
+
+uint64_t Histogram::percentile(double p) const
+{
+  uint64_t total = 0;
+  for (int i = 0; i < BUCKETS; i++) {
+    total += count(i);
+  }
+
+  if (total == 0) {
+    return 0;
+  }
+
+  // The rank of the percentile, counting from 1.
+  const uint64_t rank = std::max<uint64_t>(1, std::ceil(p * total));
+
+  uint64_t seen = 0;
+  for (int i = 0; i < BUCKETS - 1; i++) {
+    seen += count(i);
+    if (seen >= rank) {
+      return (uint64_t(1) << (i + 1)) - 1;
+    }
+  }
+
+  return UINT64_MAX;
+}
+
+
+JSON::Array Histogram::json() const
+{
+  int last = BUCKETS - 1;
+  while (last >= 0 && count(last) == 0) {
+    last--;
+  }
+
+  JSON::Array array;
+  for (int i = 0; i <= last; i++) {
+    array.values.push_back(count(i));
+  }
+
+  return array;
+}
+
+
+int64_t EventStatistics::now()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+void EventStatistics::record(
+    const Event& event,
+    size_t queued,
+    int64_t waited,
+    int64_t served)
+{
+  waited = std::max<int64_t>(waited, 0);
+  served = std::max<int64_t>(served, 0);
+
+  global->waited.add(waited);
+  global->served.add(served);
+
+  size_t max = global->queued.load();
+  while (queued > max && !global->queued.compare_exchange_weak(max, queued));
+
+  synchronized (mutex) {
+    maxQueued = std::max(maxQueued, queued);
+    this->queued.add(queued);
+    this->waited.add(waited);
+
+    struct HandlerVisitor : EventVisitor
+    {
+      explicit HandlerVisitor(EventStatistics* _statistics)
+        : statistics(_statistics), handler(nullptr) {}
+
+      virtual void visit(const MessageEvent& event)
+      {
+        handler = &statistics->messages[event.message->name];
+      }
+
+      virtual void visit(const DispatchEvent& event)
+      {
+        handler = &statistics->dispatches[
+            event.functionType.getOrElse(nullptr)];
+      }
+
+      virtual void visit(const HttpEvent& event)
+      {
+        handler = &statistics->requests[event.request->url.path];
+      }
+
+      virtual void visit(const ExitedEvent&)
+      {
+        handler = &statistics->exited;
+      }
+
+      virtual void visit(const TerminateEvent&)
+      {
+        handler = &statistics->terminated;
+      }
+
+      EventStatistics* statistics;
+      Handler* handler;
+    } visitor(this);
+
+    event.visit(&visitor);
+
+    if (visitor.handler != nullptr) {
+      visitor.handler->count++;
+      visitor.handler->total += served;
+      visitor.handler->served.add(served);
+    }
+  }
+}
+
+
+string demangle(const std::type_info* type)
+{
+  if (type == nullptr) {
+    return "unknown";
+  }
+
+#ifndef __WINDOWS__
+  int status = 0;
+  char* demangled =
+    abi::__cxa_demangle(type->name(), nullptr, nullptr, &status);
+  if (status == 0 && demangled != nullptr) {
+    const string result = demangled;
+    free(demangled);
+    return result;
+  }
+#endif // __WINDOWS__
+
+  return type->name();
+}
+
+
+JSON::Object EventStatistics::json() const
+{
+  JSON::Object object;
+  JSON::Array handlers;
+
+  auto add = [&handlers](
+      const string& type,
+      const Option<string>& name,
+      const Handler& handler) {
+    JSON::Object object;
+    object.values["type"] = type;
+    if (name.isSome()) {
+      object.values["name"] = name.get();
+    }
+    object.values["count"] = handler.count;
+    object.values["total_ns"] = handler.total;
+    object.values["served_ns"] = handler.served.json();
+    handlers.values.push_back(object);
+  };
+
+  synchronized (mutex) {
+    object.values["max_queued"] = maxQueued;
+    object.values["queued"] = queued.json();
+    object.values["waited_ns"] = waited.json();
+
+    foreachpair (const string& name, const Handler& handler, messages) {
+      add("MESSAGE", name, handler);
+    }
+
+    foreachpair (const std::type_info* type,
+                 const Handler& handler,
+                 dispatches) {
+      add("DISPATCH", demangle(type), handler);
+    }
+
+    foreachpair (const string& path, const Handler& handler, requests) {
+      add("HTTP", path, handler);
+    }
+
+    if (exited.count > 0) {
+      add("EXITED", None(), exited);
+    }
+
+    if (terminated.count > 0) {
+      add("TERMINATE", None(), terminated);
+    }
+  }
+
+  object.values["handlers"] = handlers;
+
+  return object;
+}
+
+
+// Provides the gauges of the statistics of all processes.
+class EventStatisticsProcess : public Process<EventStatisticsProcess>
+{
+public:
+  EventStatisticsProcess()
+    : ProcessBase("event_statistics"),
+      waited_p50_ms(
+          "libprocess/events/waited_p50_ms",
+          defer(self(), &Self::percentile, &global().waited, 0.5)),
+      waited_p99_ms(
+          "libprocess/events/waited_p99_ms",
+          defer(self(), &Self::percentile, &global().waited, 0.99)),
+      served_p50_ms(
+          "libprocess/events/served_p50_ms",
+          defer(self(), &Self::percentile, &global().served, 0.5)),
+      served_p99_ms(
+          "libprocess/events/served_p99_ms",
+          defer(self(), &Self::percentile, &global().served, 0.99)),
+      max_queued(
+          "libprocess/events/max_queued",
+          defer(self(), &Self::_max_queued)) {}
+
+  virtual ~EventStatisticsProcess() {}
+
+protected:
+  virtual void initialize()
+  {
+    metrics::add(waited_p50_ms);
+    metrics::add(waited_p99_ms);
+    metrics::add(served_p50_ms);
+    metrics::add(served_p99_ms);
+    metrics::add(max_queued);
+  }
+
+  virtual void finalize()
+  {
+    metrics::remove(waited_p50_ms);
+    metrics::remove(waited_p99_ms);
+    metrics::remove(served_p50_ms);
+    metrics::remove(served_p99_ms);
+    metrics::remove(max_queued);
+  }
+
+private:
+  static EventStatistics::Global& global()
+  {
+    return *EventStatistics::global;
+  }
+
+  Future<double> percentile(const Histogram* histogram, double p)
+  {
+    return histogram->percentile(p) / 1e6;
+  }
+
+  Future<double> _max_queued()
+  {
+    return static_cast<double>(global().queued.load());
+  }
+
+  metrics::Gauge waited_p50_ms;
+  metrics::Gauge waited_p99_ms;
+  metrics::Gauge served_p50_ms;
+  metrics::Gauge served_p99_ms;
+  metrics::Gauge max_queued;
+};
+
+
+void spawnEventStatistics()
+{
+  spawn(new EventStatisticsProcess(), true);
+}
+
+} // namespace process {
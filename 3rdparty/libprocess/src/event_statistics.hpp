@@ -0,0 +1,155 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License
+
+#ifndef __EVENT_STATISTICS_HPP__
+#define __EVENT_STATISTICS_HPP__
+
+#include <stdint.h>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <typeinfo>
+
+#include <process/event.hpp>
+
+#include <stout/hashmap.hpp>
+#include <stout/json.hpp>
+
+namespace process {
+
+// A histogram of non-negative values with power of two buckets:
+// bucket `i` counts the values in [2^i, 2^(i+1)), and bucket 0 also
+// counts 0. Buckets can be updated concurrently.
+class Histogram
+{
+public:
+  static const int BUCKETS = 64;
+
+  Histogram()
+  {
+    for (int i = 0; i < BUCKETS; i++) {
+      buckets[i].store(0);
+    }
+  }
+
+  void add(uint64_t value)
+  {
+    buckets[bucket(value)].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  uint64_t count(int bucket) const
+  {
+    return buckets[bucket].load(std::memory_order_relaxed);
+  }
+
+  // Returns the upper bound of the bucket that the percentile (in
+  // the range [0, 1]) of the values falls into, or 0 if there are no
+  // values.
+  uint64_t percentile(double p) const;
+
+  // Returns the counts of the buckets up to the last bucket that is
+  // not empty.
+  JSON::Array json() const;
+
+  static int bucket(uint64_t value)
+  {
+    int result = 0;
+    while (value > 1) {
+      value >>= 1;
+      result++;
+    }
+    return result;
+  }
+
+private:
+  std::atomic<uint64_t> buckets[BUCKETS];
+};
+
+
+// Statistics about the events served by a process, which are only
+// recorded if `LIBPROCESS_ENABLE_EVENT_STATISTICS` is set (see
+// `/__event_statistics__`).
+//
+// Times are in nanoseconds of a monotonic clock; the statistics are
+// not affected by pausing the libprocess clock.
+class EventStatistics
+{
+public:
+  // Returns the current time of the monotonic clock.
+  static int64_t now();
+
+  // Records an event after it has been served by the process, along
+  // with the number of events that were queued when it was dequeued
+  // (including the event itself), the time it spent in the queue and
+  // the time it took to serve it. Called by the thread running the
+  // process.
+  void record(
+      const Event& event,
+      size_t queued,
+      int64_t waited,
+      int64_t served);
+
+  JSON::Object json() const;
+
+  // The statistics of all processes, for `/metrics/snapshot`.
+  struct Global
+  {
+    Global() : queued(0) {}
+
+    Histogram waited;
+    Histogram served;
+
+    // The largest number of events that were queued for any process.
+    std::atomic_size_t queued;
+  };
+
+  static Global* global;
+
+private:
+  struct Handler
+  {
+    Handler() : count(0), total(0) {}
+
+    uint64_t count;
+    int64_t total;
+    Histogram served;
+  };
+
+  // Protects the variables below.
+  mutable std::mutex mutex;
+
+  size_t maxQueued = 0;
+  Histogram queued;
+  Histogram waited;
+
+  // The handlers of messages by name, of HTTP requests by path, and
+  // of dispatches by the type of the dispatched method.
+  hashmap<std::string, Handler> messages;
+  hashmap<std::string, Handler> requests;
+  hashmap<const std::type_info*, Handler> dispatches;
+  Handler exited;
+  Handler terminated;
+};
+
+
+// Returns the (demangled, if possible) name of the type, or "unknown"
+// for null, e.g., the type of a dispatched method.
+std::string demangle(const std::type_info* type);
+
+
+// Adds the gauges of `EventStatistics::global` to `/metrics/snapshot`.
+void spawnEventStatistics();
+
+} // namespace process {
+
+#endif // __EVENT_STATISTICS_HPP__
@@ -58,6 +58,7 @@
 
 #include "decoder.hpp"
 #include "encoder.hpp"
+#include "http_connection_pool.hpp"
 
 using std::deque;
 using std::istringstream;
@@ -668,6 +669,12 @@ void Headers::put(const string& key, const string& value)
 }
 
 
+void Headers::put(string&& key, string&& value)
+{
+  headers[std::move(key)] = std::move(value);
+}
+
+
 Option<string> Headers::get(const string& key) const
 {
   if (headers.contains(key)) {
@@ -1467,9 +1474,19 @@ Future<Connection> connect(const network::Address& address, Scheme scheme)
     return Failure("Failed to create socket: " + socket.error());
   }
 
-  return socket->connect(address)
-    .then([socket]() {
-      return Connection(socket.get());
+  return connect(socket.get(), address);
+}
+
+
+Future<Connection> connect(
+    const network::Socket& socket,
+    const network::Address& address)
+{
+  network::Socket _socket = socket;
+
+  return _socket.connect(address)
+    .then([_socket]() {
+      return Connection(_socket);
     });
 }
 
@@ -2015,9 +2032,21 @@ Request createRequest(
 
 Future<Response> request(const Request& request, bool streamedResponse)
 {
-  // We rely on the connection closing after the response.
+  // We rely on the connection closing after the response, unless we
+  // send the request on a pooled connection.
   CHECK(!request.keepAlive);
 
+  process::initialize();
+
+  // Responses that are streamed are read by the caller, so we only
+  // know when the connection could be reused for requests whose
+  // responses are not streamed.
+  if (internal::connectionPoolEnabled() &&
+      request.type == Request::BODY &&
+      !streamedResponse) {
+    return internal::pooledRequest(request);
+  }
+
   return http::connect(request.url)
     .then([=](Connection connection) {
       Future<Response> response = connection.send(request, streamedResponse);
@@ -2283,6 +2312,115 @@ Future<Response> post(
   return streaming::post(url, headers, body, contentType);
 }
 
+
+namespace internal {
+
+// Writes the data read from 'reader' into 'writer' after passing each
+// chunk through 'f', which is also called with an empty chunk
+// once 'reader' hits EOF, see 'compress' and 'decompress'.
+static void transform(
+    Pipe::Reader reader,
+    Pipe::Writer writer,
+    const std::function<Try<string>(const string&)>& f)
+{
+  // Stop reading once there is no one interested in the data anymore.
+  writer.readerClosed()
+    .onReady([reader]() mutable {
+      reader.close();
+    });
+
+  loop(
+      None(),
+      [=]() mutable {
+        return reader.read();
+      },
+      [=](const string& chunk) mutable -> ControlFlow<Nothing> {
+        Try<string> data = f(chunk);
+        if (data.isError()) {
+          writer.fail(data.error());
+          reader.close();
+          return Break();
+        }
+
+        // NOTE: Writing fails if the read end of 'writer' was closed.
+        if (!writer.write(data.get())) {
+          reader.close();
+          return Break();
+        }
+
+        if (chunk.empty()) { // EOF.
+          writer.close();
+          return Break();
+        }
+
+        return Continue();
+      })
+    .onAny([writer](const Future<Nothing>& future) mutable {
+      if (!future.isReady()) {
+        writer.fail(future.isFailed() ? future.failure() : "discarded");
+      }
+    });
+}
+
+} // namespace internal {
+
+
+Pipe::Reader compress(Pipe::Reader reader, gzip::Format format)
+{
+  std::shared_ptr<gzip::Compressor> compressor(
+      new gzip::Compressor(Z_DEFAULT_COMPRESSION, format));
+
+  Pipe pipe;
+
+  internal::transform(
+      reader,
+      pipe.writer(),
+      [compressor](const string& chunk) -> Try<string> {
+        if (chunk.empty()) { // EOF.
+          return compressor->finish();
+        }
+
+        Try<string> compressed = compressor->compress(chunk);
+        if (compressed.isError()) {
+          return compressed;
+        }
+
+        Try<string> flushed = compressor->flush();
+        if (flushed.isError()) {
+          return flushed;
+        }
+
+        return compressed.get() + flushed.get();
+      });
+
+  return pipe.reader();
+}
+
+
+Pipe::Reader decompress(Pipe::Reader reader, gzip::Format format)
+{
+  std::shared_ptr<gzip::Decompressor> decompressor(
+      new gzip::Decompressor(format));
+
+  Pipe pipe;
+
+  internal::transform(
+      reader,
+      pipe.writer(),
+      [decompressor](const string& chunk) -> Try<string> {
+        if (chunk.empty()) { // EOF.
+          if (!decompressor->finished()) {
+            return Error("More input is expected");
+          }
+          return string();
+        }
+
+        return decompressor->decompress(chunk);
+      });
+
+  return pipe.reader();
+}
+
 } // namespace streaming {
 
 } // namespace http {
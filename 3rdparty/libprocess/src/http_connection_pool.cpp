@@ -0,0 +1,331 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License
+
+#include <stdint.h>
+
+#include <list>
+#include <string>
+
+#include <process/defer.hpp>
+#include <process/delay.hpp>
+#include <process/dispatch.hpp>
+#include <process/future.hpp>
+#include <process/http.hpp>
+#include <process/id.hpp>
+#include <process/pid.hpp>
+#include <process/process.hpp>
+#include <process/timer.hpp>
+
+#include <process/metrics/counter.hpp>
+#include <process/metrics/metrics.hpp>
+#include <process/metrics/push_gauge.hpp>
+
+#include <stout/duration.hpp>
+#include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/option.hpp>
+#include <stout/stringify.hpp>
+
+#include "http_connection_pool.hpp"
+
+using std::list;
+using std::string;
+
+namespace process {
+namespace http {
+namespace internal {
+
+class ConnectionPoolProcess : public Process<ConnectionPoolProcess>
+{
+public:
+  ConnectionPoolProcess(
+      size_t _maxIdle,
+      size_t _maxPipelined,
+      const Duration& _idleTimeout)
+    : ProcessBase(ID::generate("__http_connection_pool__")),
+      maxIdle(_maxIdle),
+      maxPipelined(_maxPipelined),
+      idleTimeout(_idleTimeout),
+      nextId(0),
+      hits("libprocess/http/connection_pool/hits"),
+      misses("libprocess/http/connection_pool/misses"),
+      connections("libprocess/http/connection_pool/connections") {}
+
+  virtual ~ConnectionPoolProcess() {}
+
+  Future<Response> request(const Request& request)
+  {
+    const string key = this->key(request.url);
+
+    // Use the connection with the fewest outstanding requests.
+    Entry* best = nullptr;
+
+    if (pool.contains(key)) {
+      foreach (Entry& entry, pool.at(key)) {
+        if (entry.outstanding < maxPipelined &&
+            (best == nullptr || entry.outstanding < best->outstanding)) {
+          best = &entry;
+        }
+      }
+    }
+
+    if (best != nullptr) {
+      ++hits;
+
+      Future<Response> response = send(key, *best, request);
+
+      // The server may have closed the (idle) connection before it
+      // received the request, so we retry requests that are safe to
+      // retry once on a new connection.
+      if (request.method == "GET" || request.method == "HEAD") {
+        return response
+          .repair(defer(self(), [=](const Future<Response>&) {
+            return connect(key, request);
+          }));
+      }
+
+      return response;
+    }
+
+    ++misses;
+
+    return connect(key, request);
+  }
+
+protected:
+  virtual void initialize()
+  {
+    metrics::add(hits);
+    metrics::add(misses);
+    metrics::add(connections);
+  }
+
+  virtual void finalize()
+  {
+    metrics::remove(hits);
+    metrics::remove(misses);
+    metrics::remove(connections);
+  }
+
+private:
+  struct Entry
+  {
+    Entry(const Connection& _connection, uint64_t _id)
+      : connection(_connection), id(_id), outstanding(0) {}
+
+    Connection connection;
+    uint64_t id;
+
+    // The number of requests sent on the connection whose responses
+    // have not been received yet.
+    size_t outstanding;
+
+    // Expires the connection once it has been idle for 'idleTimeout'.
+    Option<Timer> timer;
+  };
+
+  // Returns the key of the connections that can be used to send a
+  // request to the URL.
+  static string key(const URL& url)
+  {
+    const string host =
+      url.ip.isSome() ? stringify(url.ip.get()) : url.domain.getOrElse("");
+
+    return url.scheme.getOrElse("http") + "://" + host + ":" +
+      (url.port.isSome() ? stringify(url.port.get()) : "");
+  }
+
+  Future<Response> connect(const string& key, const Request& request)
+  {
+    return http::connect(request.url)
+      .then(defer(self(), [=](const Connection& connection) {
+        return send(key, add(key, connection), request);
+      }));
+  }
+
+  Entry& add(const string& key, const Connection& connection)
+  {
+    const uint64_t id = nextId++;
+
+    pool[key].emplace_back(connection, id);
+    ++connections;
+
+    Connection(connection).disconnected()
+      .onAny(defer(self(), &Self::remove, key, id));
+
+    return pool[key].back();
+  }
+
+  Future<Response> send(
+      const string& key,
+      Entry& entry,
+      const Request& request)
+  {
+    entry.outstanding++;
+
+    if (entry.timer.isSome()) {
+      Clock::cancel(entry.timer.get());
+      entry.timer = None();
+    }
+
+    Request request_ = request;
+    request_.keepAlive = true;
+
+    const uint64_t id = entry.id;
+
+    return entry.connection.send(request_)
+      .onAny(defer(self(), &Self::completed, key, id, lambda::_1));
+  }
+
+  void completed(
+      const string& key,
+      uint64_t id,
+      const Future<Response>& response)
+  {
+    Entry* entry = find(key, id);
+    if (entry == nullptr) {
+      return;
+    }
+
+    entry->outstanding--;
+
+    // The connection can not be reused after a failure or if the
+    // server is closing it.
+    if (!response.isReady() ||
+        response->headers.get("Connection") == string("close")) {
+      remove(key, id);
+      return;
+    }
+
+    if (entry->outstanding > 0) {
+      return;
+    }
+
+    size_t idle = 0;
+    foreach (const Entry& entry, pool.at(key)) {
+      if (entry.outstanding == 0) {
+        idle++;
+      }
+    }
+
+    if (idle > maxIdle) {
+      remove(key, id);
+      return;
+    }
+
+    entry->timer = delay(idleTimeout, self(), &Self::expire, key, id);
+  }
+
+  void expire(const string& key, uint64_t id)
+  {
+    Entry* entry = find(key, id);
+    if (entry != nullptr && entry->outstanding == 0) {
+      remove(key, id);
+    }
+  }
+
+  // Removes the connection from the pool, which disconnects it once
+  // the outstanding responses (if any) have been received.
+  void remove(const string& key, uint64_t id)
+  {
+    if (!pool.contains(key)) {
+      return;
+    }
+
+    list<Entry>& entries = pool.at(key);
+
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+      if (it->id == id) {
+        if (it->timer.isSome()) {
+          Clock::cancel(it->timer.get());
+        }
+
+        entries.erase(it);
+        --connections;
+        break;
+      }
+    }
+
+    if (entries.empty()) {
+      pool.erase(key);
+    }
+  }
+
+  Entry* find(const string& key, uint64_t id)
+  {
+    if (pool.contains(key)) {
+      foreach (Entry& entry, pool.at(key)) {
+        if (entry.id == id) {
+          return &entry;
+        }
+      }
+    }
+
+    return nullptr;
+  }
+
+  const size_t maxIdle;
+  const size_t maxPipelined;
+  const Duration idleTimeout;
+
+  // The pooled connections (both idle and busy), by key.
+  hashmap<string, list<Entry>> pool;
+
+  uint64_t nextId;
+
+  // The number of requests sent on pooled and on new connections.
+  metrics::Counter hits;
+  metrics::Counter misses;
+
+  // The number of connections in the pool.
+  metrics::PushGauge connections;
+};
+
+
+static PID<ConnectionPoolProcess>* connection_pool = nullptr;
+
+
+void spawnConnectionPool(
+    size_t maxIdle,
+    size_t maxPipelined,
+    const Duration& idleTimeout)
+{
+  if (maxIdle == 0) {
+    return;
+  }
+
+  if (connection_pool == nullptr) {
+    connection_pool = new PID<ConnectionPoolProcess>();
+  }
+
+  *connection_pool = spawn(
+      new ConnectionPoolProcess(maxIdle, maxPipelined, idleTimeout),
+      true);
+}
+
+
+bool connectionPoolEnabled()
+{
+  return connection_pool != nullptr;
+}
+
+
+Future<Response> pooledRequest(const Request& request)
+{
+  CHECK_NOTNULL(connection_pool);
+
+  return dispatch(*connection_pool, &ConnectionPoolProcess::request, request);
+}
+
+} // namespace internal {
+} // namespace http {
+} // namespace process {
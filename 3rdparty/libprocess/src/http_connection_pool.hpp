@@ -0,0 +1,53 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License
+
+#ifndef __HTTP_CONNECTION_POOL_HPP__
+#define __HTTP_CONNECTION_POOL_HPP__
+
+#include <stddef.h>
+
+#include <process/future.hpp>
+#include <process/http.hpp>
+
+#include <stout/duration.hpp>
+
+namespace process {
+namespace http {
+namespace internal {
+
+// Spawns the pool of keep-alive connections used by `http::request`
+// to send requests that are not streamed, keeping up to 'maxIdle'
+// idle connections per scheme, host and port for up to 'idleTimeout',
+// and sending up to 'maxPipelined' requests at a time on each
+// connection. The pool is disabled if 'maxIdle' is 0.
+void spawnConnectionPool(
+    size_t maxIdle,
+    size_t maxPipelined,
+    const Duration& idleTimeout);
+
+
+// Returns whether the pool has been spawned, i.e., whether requests
+// can be sent through `pooledRequest`.
+bool connectionPoolEnabled();
+
+
+// Sends the request on a pooled connection to the host of its URL,
+// opening a new connection if no connection is available. The
+// request is sent with 'keepAlive' set, and the response body is
+// not streamed.
+Future<Response> pooledRequest(const Request& request);
+
+} // namespace internal {
+} // namespace http {
+} // namespace process {
+
+#endif // __HTTP_CONNECTION_POOL_HPP__
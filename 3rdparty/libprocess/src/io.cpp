@@ -28,6 +28,10 @@
 #include <stout/os/write.hpp>
 #include <stout/try.hpp>
 
+#ifdef USE_IO_URING
+#include "io_uring.hpp"
+#endif // USE_IO_URING
+
 using std::string;
 using std::vector;
 
@@ -43,6 +47,14 @@ Future<size_t> read(int fd, void* data, size_t size)
     return 0;
   }
 
+#ifdef USE_IO_URING
+  // Poll and read with a single submission if io_uring is available.
+  IoUring* ring = IoUring::instance();
+  if (ring != nullptr) {
+    return ring->read(fd, data, size);
+  }
+#endif // USE_IO_URING
+
   return loop(
       None(),
       [=]() -> Future<Option<size_t>> {
@@ -93,6 +105,14 @@ Future<size_t> write(int fd, const void* data, size_t size)
     return 0;
   }
 
+#ifdef USE_IO_URING
+  // Poll and write with a single submission if io_uring is available.
+  IoUring* ring = IoUring::instance();
+  if (ring != nullptr) {
+    return ring->write(fd, data, size);
+  }
+#endif // USE_IO_URING
+
   return loop(
       None(),
       [=]() -> Future<Option<size_t>> {
@@ -0,0 +1,612 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License
+
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+
+#include <process/future.hpp>
+
+#include <stout/error.hpp>
+#include <stout/foreach.hpp>
+#include <stout/lambda.hpp>
+#include <stout/option.hpp>
+#include <stout/synchronized.hpp>
+
+#include <stout/os/getenv.hpp>
+#include <stout/os/strerror.hpp>
+
+#include "io_uring.hpp"
+
+namespace process {
+
+// The number of entries of the submission queue. Every operation
+// takes two entries: a poll for the file descriptor to become ready,
+// linked to the I/O itself.
+static const uint32_t ENTRIES = 256;
+
+// The number of entries of the completion queue. Completions beyond
+// this number are buffered by the kernel (`IORING_FEAT_NODROP`).
+static const uint32_t COMPLETION_ENTRIES = 4096;
+
+// The maximum number of bytes read or written by an operation, which
+// bounds the buffer it copies the data to or from. Like a system call,
+// an operation may transfer fewer bytes than requested.
+static const size_t MAX_SIZE = 256 * 1024;
+
+
+// The `user_data` of a submission is the id of the operation followed
+// by two bits telling which of its submissions completed. The id 0 is
+// used for waking up the ring's thread.
+enum Kind : uint64_t
+{
+  OPERATION = 0,
+  POLL = 1,
+  CANCEL = 2,
+};
+
+static const uint64_t WAKEUP = 0;
+
+
+static uint64_t tag(uint64_t id, Kind kind)
+{
+  return (id << 2) | kind;
+}
+
+
+struct IoUring::Operation
+{
+  Operation(uint8_t _opcode, int _fd, uint32_t _events, size_t _size)
+    : id(0),
+      opcode(_opcode),
+      fd(_fd),
+      events(_events),
+      data(nullptr),
+      buffer(new char[std::min(_size, MAX_SIZE)]),
+      size(std::min(_size, MAX_SIZE)),
+      flags(0),
+      pending(0),
+      poll(0),
+      done(false) {}
+
+  uint64_t id;
+  const uint8_t opcode;
+  const int fd;
+
+  // The events to poll for before doing the I/O.
+  const uint32_t events;
+
+  // The memory of the caller that the data is read into.
+  void* data;
+
+  std::unique_ptr<char[]> buffer;
+  const size_t size;
+
+  // The flags of a send.
+  uint32_t flags;
+
+  Promise<size_t> promise;
+
+  // The number of completions that the kernel has yet to post.
+  int pending;
+
+  // The result of the last poll.
+  int32_t poll;
+
+  // Whether the promise has been completed.
+  bool done;
+};
+
+
+IoUring* IoUring::instance()
+{
+  static IoUring* ring = []() -> IoUring* {
+    Option<std::string> value = os::getenv("LIBPROCESS_IO_URING");
+    if (value.isSome() && (value.get() == "false" || value.get() == "0")) {
+      VLOG(1) << "Not using io_uring since LIBPROCESS_IO_URING="
+              << value.get();
+      return nullptr;
+    }
+
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_CQSIZE;
+    params.cq_entries = COMPLETION_ENTRIES;
+
+    const int fd = static_cast<int>(
+        syscall(__NR_io_uring_setup, ENTRIES, &params));
+
+    if (fd < 0) {
+      LOG(WARNING) << "Failed to create io_uring instance, falling back to "
+                   << "polling: " << os::strerror(errno);
+      return nullptr;
+    }
+
+    // Closes the ring and returns nullptr after logging the reason.
+    auto unsupported = [fd](const std::string& reason) -> IoUring* {
+      LOG(WARNING) << "Not using io_uring, falling back to polling: "
+                   << reason;
+      ::close(fd);
+      return nullptr;
+    };
+
+    if ((params.features & IORING_FEAT_NODROP) == 0) {
+      return unsupported("Completions may be dropped by the kernel");
+    }
+
+    // Check that the kernel supports all the operations we use.
+    const size_t length =
+      sizeof(io_uring_probe) + IORING_OP_LAST * sizeof(io_uring_probe_op);
+
+    std::unique_ptr<char[]> memory(new char[length]);
+    memset(memory.get(), 0, length);
+
+    io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(memory.get());
+
+    if (syscall(
+            __NR_io_uring_register,
+            fd,
+            IORING_REGISTER_PROBE,
+            probe,
+            IORING_OP_LAST) < 0) {
+      return unsupported(
+          "Failed to probe operations: " + os::strerror(errno));
+    }
+
+    const uint8_t opcodes[] = {
+      IORING_OP_POLL_ADD,
+      IORING_OP_ASYNC_CANCEL,
+      IORING_OP_READ,
+      IORING_OP_WRITE,
+      IORING_OP_SEND,
+    };
+
+    foreach (uint8_t opcode, opcodes) {
+      if (opcode > probe->last_op ||
+          (probe->ops[opcode].flags & IO_URING_OP_SUPPORTED) == 0) {
+        return unsupported(
+            "Operation " + std::to_string(opcode) + " is not supported");
+      }
+    }
+
+    size_t sqSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    size_t cqSize =
+      params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+    const bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single) {
+      sqSize = cqSize = std::max(sqSize, cqSize);
+    }
+
+    void* sq = mmap(
+        nullptr,
+        sqSize,
+        PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE,
+        fd,
+        IORING_OFF_SQ_RING);
+
+    if (sq == MAP_FAILED) {
+      return unsupported(
+          "Failed to map submission queue: " + os::strerror(errno));
+    }
+
+    void* cq = sq;
+    if (!single) {
+      cq = mmap(
+          nullptr,
+          cqSize,
+          PROT_READ | PROT_WRITE,
+          MAP_SHARED | MAP_POPULATE,
+          fd,
+          IORING_OFF_CQ_RING);
+
+      if (cq == MAP_FAILED) {
+        return unsupported(
+            "Failed to map completion queue: " + os::strerror(errno));
+      }
+    }
+
+    void* sqes = mmap(
+        nullptr,
+        params.sq_entries * sizeof(io_uring_sqe),
+        PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE,
+        fd,
+        IORING_OFF_SQES);
+
+    if (sqes == MAP_FAILED) {
+      return unsupported(
+          "Failed to map submission queue entries: " + os::strerror(errno));
+    }
+
+    const int efd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (efd < 0) {
+      return unsupported("Failed to create eventfd: " + os::strerror(errno));
+    }
+
+    // NOTE: The ring lives for as long as the process, like the event
+    // loop.
+    IoUring* ring = new IoUring(
+        fd, params, sq, cq, static_cast<io_uring_sqe*>(sqes), efd);
+
+    std::thread(&IoUring::run, ring).detach();
+
+    VLOG(1) << "Using io_uring with " << params.sq_entries
+            << " submission queue entries";
+
+    return ring;
+  }();
+
+  return ring;
+}
+
+
+IoUring::IoUring(
+    int _fd,
+    const io_uring_params& params,
+    void* sq,
+    void* cq,
+    io_uring_sqe* _sqes,
+    int _efd)
+  : fd(_fd),
+    sqHead(reinterpret_cast<uint32_t*>(
+        static_cast<char*>(sq) + params.sq_off.head)),
+    sqTail(reinterpret_cast<uint32_t*>(
+        static_cast<char*>(sq) + params.sq_off.tail)),
+    sqMask(*reinterpret_cast<uint32_t*>(
+        static_cast<char*>(sq) + params.sq_off.ring_mask)),
+    sqEntries(params.sq_entries),
+    sqArray(reinterpret_cast<uint32_t*>(
+        static_cast<char*>(sq) + params.sq_off.array)),
+    sqes(_sqes),
+    cqHead(reinterpret_cast<uint32_t*>(
+        static_cast<char*>(cq) + params.cq_off.head)),
+    cqTail(reinterpret_cast<uint32_t*>(
+        static_cast<char*>(cq) + params.cq_off.tail)),
+    cqMask(*reinterpret_cast<uint32_t*>(
+        static_cast<char*>(cq) + params.cq_off.ring_mask)),
+    cqes(reinterpret_cast<io_uring_cqe*>(
+        static_cast<char*>(cq) + params.cq_off.cqes)),
+    efd(_efd),
+    notified(false),
+    nextId(1),
+    armed(false),
+    tail(*sqTail),
+    queued(0) {}
+
+
+Future<size_t> IoUring::read(int fd, void* data, size_t size)
+{
+  Operation* operation = new Operation(IORING_OP_READ, fd, POLLIN, size);
+  operation->data = data;
+
+  return submit(operation);
+}
+
+
+Future<size_t> IoUring::write(int fd, const void* data, size_t size)
+{
+  Operation* operation = new Operation(IORING_OP_WRITE, fd, POLLOUT, size);
+  memcpy(operation->buffer.get(), data, operation->size);
+
+  return submit(operation);
+}
+
+
+Future<size_t> IoUring::send(int fd, const void* data, size_t size)
+{
+  Operation* operation = new Operation(IORING_OP_SEND, fd, POLLOUT, size);
+  memcpy(operation->buffer.get(), data, operation->size);
+  operation->flags = MSG_NOSIGNAL;
+
+  return submit(operation);
+}
+
+
+Future<size_t> IoUring::submit(Operation* operation)
+{
+  // Get a copy of the future before the operation is handed over to
+  // the ring's thread, which deletes it once it is done.
+  Future<size_t> future = operation->promise.future();
+
+  uint64_t id;
+
+  synchronized (mutex) {
+    id = operation->id = nextId++;
+    submitted.push_back(operation);
+  }
+
+  notify();
+
+  future.onDiscard(lambda::bind(&IoUring::cancel, this, id));
+
+  return future;
+}
+
+
+void IoUring::cancel(uint64_t id)
+{
+  synchronized (mutex) {
+    canceled.push_back(id);
+  }
+
+  notify();
+}
+
+
+void IoUring::notify()
+{
+  bool wakeup = false;
+
+  synchronized (mutex) {
+    if (!notified) {
+      notified = wakeup = true;
+    }
+  }
+
+  // NOTE: The write can only fail if the counter would overflow, in
+  // which case the ring's thread is woken up already.
+  if (wakeup) {
+    const uint64_t value = 1;
+    ssize_t written = ::write(efd, &value, sizeof(value));
+    (void) written;
+  }
+}
+
+
+void IoUring::run()
+{
+  // Name the thread so that it can be told apart, e.g., in `top -H`
+  // or by the tests.
+  pthread_setname_np(pthread_self(), "io_uring");
+
+  while (true) {
+    synchronized (mutex) {
+      backlog.insert(backlog.end(), submitted.begin(), submitted.end());
+      submitted.clear();
+
+      cancellations.insert(
+          cancellations.end(), canceled.begin(), canceled.end());
+      canceled.clear();
+
+      notified = false;
+    }
+
+    if (!armed) {
+      io_uring_sqe* sqe = entry();
+      if (sqe != nullptr) {
+        sqe->opcode = IORING_OP_POLL_ADD;
+        sqe->fd = efd;
+        sqe->poll32_events = POLLIN;
+        sqe->user_data = WAKEUP;
+        armed = true;
+      }
+    }
+
+    while (!cancellations.empty() && space() >= 2) {
+      const uint64_t id = cancellations.front();
+      cancellations.pop_front();
+
+      Option<Operation*> operation = operations.get(id);
+      if (operation.isNone() || operation.get()->pending == 0) {
+        // The operation is done or still in the backlog, in which case
+        // it is discarded when it is prepared.
+        continue;
+      }
+
+      // Canceling the poll cancels the linked I/O as well, unless the
+      // I/O has been started already.
+      const Kind kinds[] = {POLL, OPERATION};
+
+      foreach (Kind kind, kinds) {
+        io_uring_sqe* sqe = entry();
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->fd = -1;
+        sqe->addr = tag(id, kind);
+        sqe->user_data = tag(id, CANCEL);
+      }
+    }
+
+    while (!backlog.empty() && prepare(backlog.front())) {
+      backlog.pop_front();
+    }
+
+    // Pass all the new submissions to the kernel and wait for at least
+    // one completion.
+    __atomic_store_n(sqTail, tail, __ATOMIC_RELEASE);
+
+    const long submitted = syscall(
+        __NR_io_uring_enter,
+        fd,
+        queued,
+        1,
+        IORING_ENTER_GETEVENTS,
+        nullptr,
+        0);
+
+    if (submitted < 0) {
+      // The kernel asks us to reap completions first if it is busy.
+      PCHECK(errno == EINTR || errno == EBUSY || errno == EAGAIN)
+        << "Failed to enter io_uring";
+    } else {
+      queued -= static_cast<uint32_t>(submitted);
+    }
+
+    uint32_t head = *cqHead;
+
+    while (head != __atomic_load_n(cqTail, __ATOMIC_ACQUIRE)) {
+      const io_uring_cqe cqe = cqes[head & cqMask];
+
+      head++;
+      __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+
+      if (cqe.user_data == WAKEUP) {
+        // Reset the eventfd, the submissions are taken above.
+        uint64_t value;
+        while (::read(efd, &value, sizeof(value)) > 0);
+        armed = false;
+        continue;
+      }
+
+      const uint64_t id = cqe.user_data >> 2;
+      const Kind kind = static_cast<Kind>(cqe.user_data & 3);
+
+      if (kind == CANCEL) {
+        continue;
+      }
+
+      Option<Operation*> operation = operations.get(id);
+      CHECK_SOME(operation);
+
+      complete(operation.get(), kind == POLL, cqe.res);
+    }
+  }
+}
+
+
+uint32_t IoUring::space()
+{
+  const uint32_t head = __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+  return sqEntries - (tail - head);
+}
+
+
+io_uring_sqe* IoUring::entry()
+{
+  if (space() == 0) {
+    return nullptr;
+  }
+
+  const uint32_t index = tail & sqMask;
+  tail++;
+  queued++;
+
+  sqArray[index] = index;
+
+  io_uring_sqe* sqe = &sqes[index];
+  memset(sqe, 0, sizeof(*sqe));
+
+  return sqe;
+}
+
+
+bool IoUring::prepare(Operation* operation)
+{
+  // Drop operations which were discarded before being submitted.
+  if (operation->promise.future().hasDiscard()) {
+    operation->promise.discard();
+
+    if (operation->pending == 0) {
+      operations.erase(operation->id);
+      delete operation;
+    } else {
+      operation->done = true;
+    }
+
+    return true;
+  }
+
+  if (space() < 2) {
+    return false;
+  }
+
+  io_uring_sqe* poll = entry();
+  poll->opcode = IORING_OP_POLL_ADD;
+  poll->fd = operation->fd;
+  poll->poll32_events = operation->events;
+  poll->flags = IOSQE_IO_LINK;
+  poll->user_data = tag(operation->id, POLL);
+
+  io_uring_sqe* sqe = entry();
+  sqe->opcode = operation->opcode;
+  sqe->fd = operation->fd;
+  sqe->addr = reinterpret_cast<uint64_t>(operation->buffer.get());
+  sqe->len = static_cast<uint32_t>(operation->size);
+  sqe->user_data = tag(operation->id, OPERATION);
+
+  if (operation->opcode == IORING_OP_SEND) {
+    sqe->msg_flags = operation->flags;
+  } else {
+    // Use (and update) the current file position, if any.
+    sqe->off = static_cast<uint64_t>(-1);
+  }
+
+  operation->pending += 2;
+  operations[operation->id] = operation;
+
+  return true;
+}
+
+
+void IoUring::complete(Operation* operation, bool poll, int32_t result)
+{
+  CHECK_GT(operation->pending, 0);
+  operation->pending--;
+
+  if (poll) {
+    operation->poll = result;
+  } else {
+    Promise<size_t>& promise = operation->promise;
+    const bool discarded = promise.future().hasDiscard();
+
+    if (result >= 0) {
+      operation->done = true;
+
+      if (discarded) {
+        promise.discard();
+      } else {
+        if (operation->data != nullptr) {
+          memcpy(operation->data, operation->buffer.get(), result);
+        }
+        promise.set(static_cast<size_t>(result));
+      }
+    } else if (discarded) {
+      operation->done = true;
+      promise.discard();
+    } else if (result == -ECANCELED && operation->poll < 0) {
+      // The poll failed, e.g., because the file descriptor is invalid.
+      operation->done = true;
+      promise.fail(os::strerror(-operation->poll));
+    } else if (result == -EAGAIN ||
+               result == -EWOULDBLOCK ||
+               result == -EINTR ||
+               result == -ECANCELED) {
+      // Not ready (anymore) or interrupted, try again.
+      backlog.push_back(operation);
+    } else {
+      operation->done = true;
+      promise.fail(os::strerror(-result));
+    }
+  }
+
+  if (operation->done && operation->pending == 0) {
+    operations.erase(operation->id);
+    delete operation;
+  }
+}
+
+} // namespace process {
@@ -0,0 +1,148 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License
+
+#ifndef __IO_URING_HPP__
+#define __IO_URING_HPP__
+
+#include <stdint.h>
+
+#include <linux/io_uring.h>
+
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include <process/future.hpp>
+
+#include <stout/hashmap.hpp>
+
+namespace process {
+
+// Performs reads, writes and socket sends of non-blocking file
+// descriptors with io_uring, so that waiting for a file descriptor to
+// become ready and the I/O itself take a single submission, and all
+// submissions made while the ring's thread is busy are passed to the
+// kernel with a single system call.
+//
+// Operations are submitted by any thread and queued; the ring's own
+// thread moves them to the submission queue, enters the kernel and
+// completes the futures of the operations that finished.
+//
+// NOTE: Data is read into and written from a buffer owned by the
+// operation, so that a discarded operation which is still in the
+// kernel never touches the memory of the caller.
+class IoUring
+{
+public:
+  // Returns the ring, which is created on first use, or nullptr if
+  // io_uring is not supported by the kernel or is disabled by setting
+  // `LIBPROCESS_IO_URING=false`, in which case the caller should fall
+  // back to polling.
+  static IoUring* instance();
+
+  Future<size_t> read(int fd, void* data, size_t size);
+  Future<size_t> write(int fd, const void* data, size_t size);
+
+  // Like `write()` but for sockets, using `MSG_NOSIGNAL`.
+  Future<size_t> send(int fd, const void* data, size_t size);
+
+private:
+  struct Operation;
+
+  IoUring(
+      int fd,
+      const io_uring_params& params,
+      void* sq,
+      void* cq,
+      io_uring_sqe* sqes,
+      int efd);
+
+  Future<size_t> submit(Operation* operation);
+
+  // Asks the ring's thread to cancel the operation, if it is still
+  // in the kernel.
+  void cancel(uint64_t id);
+
+  // Wakes up the ring's thread, unless it has been woken up already.
+  void notify();
+
+  void run();
+
+  // The following are only called on the ring's thread.
+
+  // Returns the number of free submission queue entries.
+  uint32_t space();
+
+  // Returns a free submission queue entry or nullptr if the queue is
+  // full.
+  io_uring_sqe* entry();
+
+  // Moves the operation to the submission queue, or drops it if it
+  // has been discarded. Returns false if there is not enough room
+  // left.
+  bool prepare(Operation* operation);
+
+  // Handles a completion of the operation.
+  void complete(Operation* operation, bool poll, int32_t result);
+
+  const int fd;
+
+  // The submission and completion queues shared with the kernel.
+  uint32_t* sqHead;
+  uint32_t* sqTail;
+  uint32_t sqMask;
+  uint32_t sqEntries;
+  uint32_t* sqArray;
+  io_uring_sqe* sqes;
+
+  uint32_t* cqHead;
+  uint32_t* cqTail;
+  uint32_t cqMask;
+  io_uring_cqe* cqes;
+
+  // An eventfd which is polled by the ring to wake up its thread.
+  const int efd;
+
+  // Protects the variables below.
+  std::mutex mutex;
+
+  // The operations and cancellations that have not been taken by the
+  // ring's thread yet.
+  std::vector<Operation*> submitted;
+  std::vector<uint64_t> canceled;
+  bool notified;
+  uint64_t nextId;
+
+  // The following are only accessed by the ring's thread.
+
+  // Whether the ring waits for the eventfd.
+  bool armed;
+
+  // The tail of the submission queue, which is published to the
+  // kernel when entering it.
+  uint32_t tail;
+
+  // The operations that did not fit into the submission queue yet.
+  std::deque<Operation*> backlog;
+  std::deque<uint64_t> cancellations;
+
+  // The operations with pending completions, by their id.
+  hashmap<uint64_t, Operation*> operations;
+
+  // The number of entries in the submission queue that have not been
+  // passed to the kernel yet.
+  uint32_t queued;
+};
+
+} // namespace process {
+
+#endif // __IO_URING_HPP__
@@ -26,6 +26,7 @@
 #include <process/ssl/flags.hpp>
 
 #include <stout/net.hpp>
+#include <stout/stringify.hpp>
 #include <stout/synchronized.hpp>
 
 #include "libevent.hpp"
@@ -418,6 +419,11 @@ void LibeventSSLSocketImpl::event_callback(short events)
     Try<Nothing> verify = openssl::verify(ssl, peer_hostname, peer_ip);
     if (verify.isError()) {
       VLOG(1) << "Failed connect, verification error: " << verify.error();
+
+      if (session_key.isSome()) {
+        openssl::forget(session_key.get());
+      }
+
       SSL_free(ssl);
       bufferevent_free(bev);
       bev = nullptr;
@@ -425,6 +431,10 @@ void LibeventSSLSocketImpl::event_callback(short events)
       return;
     }
 
+    if (session_key.isSome()) {
+      openssl::remember(ssl, session_key.get());
+    }
+
     current_connect_request->promise.set(Nothing());
   } else if (events & BEV_EVENT_ERROR) {
     CHECK(EVUTIL_SOCKET_ERROR() != 0);
@@ -498,6 +508,11 @@ Future<Nothing> LibeventSSLSocketImpl::connect(const Address& address)
     return Failure("Failed to connect: SSL_new");
   }
 
+  // Resume the last session with the peer, if any, which spares both
+  // sides the expensive parts of the handshake when reconnecting.
+  session_key = stringify(address);
+  openssl::resume(ssl, session_key.get());
+
   // Construct the bufferevent in the connecting state.
   // We set 'BEV_OPT_DEFER_CALLBACKS' to avoid calling the
   // 'event_callback' before 'bufferevent_socket_connect' returns.
@@ -189,6 +189,10 @@ private:
 
   Option<std::string> peer_hostname;
   Option<net::IP> peer_ip;
+
+  // The key of the session cached for the peer we're connecting to,
+  // see `openssl::resume`.
+  Option<std::string> session_key;
 };
 
 } // namespace internal {
@@ -10,12 +10,20 @@
 // See the License for the specific language governing permissions and
 // limitations under the License
 
+#include <ctype.h>
+
 #include <glog/logging.h>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <list>
+#include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include <process/clock.hpp>
 #include <process/collect.hpp>
 #include <process/dispatch.hpp>
 #include <process/help.hpp>
@@ -33,6 +41,7 @@
 #include <stout/os.hpp>
 
 using std::list;
+using std::ostringstream;
 using std::string;
 using std::vector;
 
@@ -88,7 +97,24 @@ MetricsProcess* MetricsProcess::create(
     }
   }
 
-  return new MetricsProcess(limiter, authenticationRealm);
+  Option<string> interval =
+    os::getenv("LIBPROCESS_METRICS_SNAPSHOT_CACHE_INTERVAL");
+
+  Option<Duration> cacheInterval;
+
+  if (interval.isSome() && !interval->empty()) {
+    Try<Duration> duration = Duration::parse(interval.get());
+
+    if (duration.isError()) {
+      EXIT(EXIT_FAILURE)
+        << "Failed to parse LIBPROCESS_METRICS_SNAPSHOT_CACHE_INTERVAL "
+        << "'" << interval.get() << "': " << duration.error();
+    }
+
+    cacheInterval = duration.get();
+  }
+
+  return new MetricsProcess(limiter, cacheInterval, authenticationRealm);
 }
 
 
@@ -99,12 +125,23 @@ void MetricsProcess::initialize()
           authenticationRealm.get(),
           help(),
           &MetricsProcess::_snapshot);
+
+    route("/prometheus",
+          authenticationRealm.get(),
+          prometheusHelp(),
+          &MetricsProcess::_prometheus);
   } else {
     route("/snapshot",
           help(),
           [this](const http::Request& request) {
             return _snapshot(request, None());
           });
+
+    route("/prometheus",
+          prometheusHelp(),
+          [this](const http::Request& request) {
+            return _prometheus(request, None());
+          });
   }
 }
 
@@ -121,7 +158,28 @@ string MetricsProcess::help()
           "amount of time the endpoint will take to respond. If the timeout",
           "is exceeded, some metrics may not be included in the response.",
           "",
-          "The key is the metric name, and the value is a double-type."),
+          "The key is the metric name, and the value is a double-type.",
+          "",
+          "If LIBPROCESS_METRICS_SNAPSHOT_CACHE_INTERVAL is set, a snapshot",
+          "is also returned for the requests that arrive within that",
+          "interval after it was started (without being rate limited)."),
+      AUTHENTICATION(true));
+}
+
+
+string MetricsProcess::prometheusHelp()
+{
+  return HELP(
+      TLDR("Provides a snapshot of the current metrics for Prometheus."),
+      DESCRIPTION(
+          "This endpoint provides the same snapshot as /metrics/snapshot",
+          "in the Prometheus text exposition format, with every metric",
+          "exposed as an untyped sample. Characters of metric names that",
+          "are not valid in Prometheus (e.g., '/') are replaced by '_'.",
+          "",
+          "The optional query parameter 'timeout' determines the maximum",
+          "amount of time the endpoint will take to respond. If the timeout",
+          "is exceeded, some metrics may not be included in the response."),
       AUTHENTICATION(true));
 }
 
@@ -173,33 +231,75 @@ Future<hashmap<string, double>> MetricsProcess::snapshot(
 }
 
 
-Future<http::Response> MetricsProcess::_snapshot(
-    const http::Request& request,
-    const Option<string>& /* principal */)
+// Parses the 'timeout' parameter of a request to one of the endpoints.
+static Try<Option<Duration>> parseTimeout(const http::Request& request)
 {
-  // Parse the 'timeout' parameter.
-  Option<Duration> timeout;
+  if (!request.url.query.contains("timeout")) {
+    return None();
+  }
 
-  if (request.url.query.contains("timeout")) {
-    string parameter = request.url.query.get("timeout").get();
+  string parameter = request.url.query.get("timeout").get();
 
-    Try<Duration> duration = Duration::parse(parameter);
+  Try<Duration> duration = Duration::parse(parameter);
 
-    if (duration.isError()) {
-      return http::BadRequest(
-          "Invalid timeout '" + parameter + "': " + duration.error() + ".\n");
+  if (duration.isError()) {
+    return Error(
+        "Invalid timeout '" + parameter + "': " + duration.error() + ".\n");
+  }
+
+  return duration.get();
+}
+
+
+Future<hashmap<string, double>> MetricsProcess::cachedSnapshot(
+    const Option<Duration>& timeout)
+{
+  // NOTE: We serve the cached snapshot even if it is still being
+  // taken, so that concurrent requests share a single snapshot.
+  if (cacheInterval.isNone() ||
+      cache.isNone() ||
+      Clock::now() - cache->first >= cacheInterval.get()) {
+    Future<Nothing> acquire = Nothing();
+
+    if (limiter.isSome()) {
+      acquire = limiter.get()->acquire();
     }
 
-    timeout = duration.get();
+    Future<hashmap<string, double>> snapshot =
+      acquire.then(defer(self(), &Self::snapshot, timeout));
+
+    if (cacheInterval.isNone()) {
+      return snapshot;
+    }
+
+    cache = std::make_pair(Clock::now(), snapshot);
   }
 
-  Future<Nothing> acquire = Nothing();
+  // Give every request its own future so that discarding one (e.g.,
+  // when the client goes away) doesn't discard the cached snapshot.
+  Owned<Promise<hashmap<string, double>>> promise(
+      new Promise<hashmap<string, double>>());
 
-  if (limiter.isSome()) {
-    acquire = limiter.get()->acquire();
+  cache->second
+    .onAny([promise](const Future<hashmap<string, double>>& snapshot) {
+      promise->associate(snapshot);
+    });
+
+  return promise->future();
+}
+
+
+Future<http::Response> MetricsProcess::_snapshot(
+    const http::Request& request,
+    const Option<string>& /* principal */)
+{
+  Try<Option<Duration>> timeout = parseTimeout(request);
+
+  if (timeout.isError()) {
+    return http::BadRequest(timeout.error());
   }
 
-  return acquire.then(defer(self(), &Self::snapshot, timeout))
+  return cachedSnapshot(timeout.get())
       .then([request](const hashmap<string, double>& metrics)
             -> http::Response {
         return http::OK(jsonify(metrics), request.url.query.get("jsonp"));
@@ -207,6 +307,82 @@ Future<http::Response> MetricsProcess::_snapshot(
 }
 
 
+// Returns the name of a metric with the characters that are not valid
+// in a Prometheus metric name replaced by '_'.
+static string prometheusName(const string& name)
+{
+  string result = name;
+
+  for (size_t i = 0; i < result.size(); i++) {
+    const char c = result[i];
+    if (!isalnum(c) && c != '_' && c != ':') {
+      result[i] = '_';
+    }
+  }
+
+  if (!result.empty() && isdigit(result[0])) {
+    result = "_" + result;
+  }
+
+  return result;
+}
+
+
+// Formats a snapshot in the Prometheus text exposition format (see
+// https://prometheus.io/docs/instrumenting/exposition_formats).
+static string prometheus(const hashmap<string, double>& metrics)
+{
+  vector<string> names;
+  foreachkey (const string& name, metrics) {
+    names.push_back(name);
+  }
+
+  std::sort(names.begin(), names.end());
+
+  // Use the same precision as the JSON snapshot.
+  ostringstream out;
+  out.precision(std::numeric_limits<double>::digits10);
+
+  foreach (const string& name, names) {
+    const double value = metrics.at(name);
+    const string sample = prometheusName(name);
+
+    out << "# TYPE " << sample << " untyped\n" << sample << " ";
+
+    if (std::isnan(value)) {
+      out << "NaN";
+    } else if (std::isinf(value)) {
+      out << (value > 0 ? "+Inf" : "-Inf");
+    } else {
+      out << value;
+    }
+
+    out << "\n";
+  }
+
+  return out.str();
+}
+
+
+Future<http::Response> MetricsProcess::_prometheus(
+    const http::Request& request,
+    const Option<string>& /* principal */)
+{
+  Try<Option<Duration>> timeout = parseTimeout(request);
+
+  if (timeout.isError()) {
+    return http::BadRequest(timeout.error());
+  }
+
+  return cachedSnapshot(timeout.get())
+      .then([](const hashmap<string, double>& metrics) -> http::Response {
+        http::OK response(prometheus(metrics));
+        response.headers["Content-Type"] = "text/plain; version=0.0.4";
+        return response;
+      });
+}
+
+
 list<Future<double>> MetricsProcess::_snapshotTimeout(
     const list<Future<double>>& futures)
 {
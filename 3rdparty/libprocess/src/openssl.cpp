@@ -20,6 +20,7 @@
 #include <openssl/x509v3.h>
 
 #include <map>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
@@ -28,8 +29,10 @@
 
 #include <process/ssl/flags.hpp>
 
+#include <stout/cache.hpp>
 #include <stout/os.hpp>
 #include <stout/strings.hpp>
+#include <stout/synchronized.hpp>
 
 using std::map;
 using std::ostringstream;
@@ -52,6 +55,14 @@ namespace openssl {
 static SSL_CTX* ctx = nullptr;
 
 
+// The sessions of the connections established to peers, by the key of
+// the peer, which connections to the same peer try to resume. Reset
+// via 'initialize', and null if session caching is disabled.
+typedef Cache<string, std::shared_ptr<SSL_SESSION>> Sessions;
+static Sessions* sessions = nullptr;
+static std::mutex* sessions_mutex = new std::mutex();
+
+
 Flags::Flags()
 {
   add(&Flags::enabled,
@@ -138,6 +149,30 @@ Flags::Flags()
       "enable_tls_v1_2",
       "Enable SSLV1.2.",
       true);
+
+  add(&Flags::session_cache_size,
+      "session_cache_size",
+      "Maximum number of sessions that are cached for resumption, both "
+      "of the connections accepted and of the connections established to "
+      "peers. Resuming a session avoids the public key operations of a "
+      "full handshake when reconnecting. Set to 0 to disable session "
+      "resumption (including via session tickets).",
+      20480);
+
+  add(&Flags::session_timeout,
+      "session_timeout",
+      "Amount of time after which a cached session can no longer be "
+      "resumed.",
+      Minutes(5));
+
+  add(&Flags::session_ticket_key_file,
+      "session_ticket_key_file",
+      "Path to a file with the 48 byte key used to encrypt session "
+      "tickets. Components that share the key (e.g., all masters) accept "
+      "the session tickets issued by each other, so that connections can "
+      "be resumed after a failover. If not set, a random key is generated "
+      "at startup. The file must be kept secret, and should be rotated "
+      "regularly.");
 }
 
 
@@ -378,12 +413,59 @@ void reinitialize()
   CHECK(ctx) << "Failed to create SSL context: "
              << ERR_error_string(ERR_get_error(), nullptr);
 
-  // Disable SSL session caching.
-  SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_OFF);
+  // Release the read and write buffers of idle connections (which
+  // are the majority of the connections of a master with many agents)
+  // rather than keeping them allocated for every connection.
+  SSL_CTX_set_mode(ctx, SSL_MODE_RELEASE_BUFFERS);
+
+  // Cache the sessions of accepted connections so that they can be
+  // resumed, see 'resume' for connecting sockets.
+  synchronized (sessions_mutex) {
+    delete sessions;
+    sessions = nullptr;
+
+    if (ssl_flags->session_cache_size > 0) {
+      sessions = new Sessions(ssl_flags->session_cache_size);
+    }
+  }
+
+  if (ssl_flags->session_cache_size > 0) {
+    SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_SERVER);
+    SSL_CTX_sess_set_cache_size(ctx, ssl_flags->session_cache_size);
+    SSL_CTX_set_timeout(
+        ctx,
+        static_cast<long>(ssl_flags->session_timeout.secs()));
+  } else {
+    SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_OFF);
+  }
+
+  if (ssl_flags->session_ticket_key_file.isSome()) {
+    const string& path = ssl_flags->session_ticket_key_file.get();
 
-  // Set a session id to avoid connection termination upon
-  // re-connect. We can use something more relevant when we care
-  // about session caching.
+    Try<string> key = os::read(path);
+    if (key.isError()) {
+      EXIT(EXIT_FAILURE)
+        << "Failed to read session ticket key file '" << path << "': "
+        << key.error();
+    }
+
+    if (key->size() != 48) {
+      EXIT(EXIT_FAILURE)
+        << "Session ticket key file '" << path << "' must contain "
+        << "exactly 48 bytes, found " << key->size();
+    }
+
+    if (SSL_CTX_set_tlsext_ticket_keys(
+            ctx,
+            const_cast<char*>(key->data()),
+            key->size()) != 1) {
+      EXIT(EXIT_FAILURE) << "Failed to set session ticket key";
+    }
+  }
+
+  // Set a session id context, which must be the same for all
+  // components so that sessions can be resumed. OpenSSL refuses to
+  // resume sessions with peer certificates without one.
   const uint64_t session_ctx = 7;
 
   const unsigned char* session_id =
@@ -573,7 +655,8 @@ void reinitialize()
       SSL_OP_NO_SSLv3 |
       SSL_OP_NO_TLSv1 |
       SSL_OP_NO_TLSv1_1 |
-      SSL_OP_NO_TLSv1_2);
+      SSL_OP_NO_TLSv1_2 |
+      SSL_OP_NO_TICKET);
 
   // Use server preference for cipher.
   long ssl_options = SSL_OP_CIPHER_SERVER_PREFERENCE;
@@ -592,6 +675,9 @@ void reinitialize()
   // Disable TLSv1.2.
   if (!ssl_flags->enable_tls_v1_2) { ssl_options |= SSL_OP_NO_TLSv1_2; }
 
+  // Disable session tickets when session resumption is disabled.
+  if (ssl_flags->session_cache_size == 0) { ssl_options |= SSL_OP_NO_TICKET; }
+
   SSL_CTX_set_options(ctx, ssl_options);
 }
 
@@ -619,6 +705,52 @@ SSL_CTX* context()
 }
 
 
+void resume(SSL* ssl, const string& key)
+{
+  std::shared_ptr<SSL_SESSION> session;
+
+  synchronized (sessions_mutex) {
+    if (sessions == nullptr) {
+      return;
+    }
+
+    session = sessions->get(key).getOrElse(nullptr);
+  }
+
+  if (session != nullptr) {
+    // NOTE: 'SSL_set_session' takes its own reference to the session.
+    SSL_set_session(ssl, session.get());
+  }
+}
+
+
+void remember(SSL* ssl, const string& key)
+{
+  SSL_SESSION* session = SSL_get1_session(ssl);
+  if (session == nullptr) {
+    return;
+  }
+
+  std::shared_ptr<SSL_SESSION> shared(session, &SSL_SESSION_free);
+
+  synchronized (sessions_mutex) {
+    if (sessions != nullptr) {
+      sessions->put(key, shared);
+    }
+  }
+}
+
+
+void forget(const string& key)
+{
+  synchronized (sessions_mutex) {
+    if (sessions != nullptr) {
+      sessions->erase(key);
+    }
+  }
+}
+
+
 Try<Nothing> verify(
     const SSL* const ssl,
     const Option<string>& hostname,
@@ -45,6 +45,9 @@ namespace openssl {
 //    LIBPROCESS_SSL_ENABLE_TLS_V1_0=(false|0,true|1)
 //    LIBPROCESS_SSL_ENABLE_TLS_V1_1=(false|0,true|1)
 //    LIBPROCESS_SSL_ENABLE_TLS_V1_2=(false|0,true|1)
+//    LIBPROCESS_SSL_SESSION_CACHE_SIZE=(20480)
+//    LIBPROCESS_SSL_SESSION_TIMEOUT=(5mins)
+//    LIBPROCESS_SSL_SESSION_TICKET_KEY_FILE=(path to 48 byte key file)
 //
 // TODO(benh): When/If we need to support multiple contexts in the
 // same process, for example for Server Name Indication (SNI), then
@@ -56,6 +59,21 @@ void initialize();
 // Returns the _global_ OpenSSL context.
 SSL_CTX* context();
 
+// Sets the session that was last established with the peer identified
+// by 'key' (e.g., its address) on a connecting 'ssl', if there is one,
+// so that the connection can resume the session rather than perform a
+// full handshake. If the peer does not accept the session it falls
+// back to a full handshake.
+void resume(SSL* ssl, const std::string& key);
+
+// Remembers the session of the established connection 'ssl' to the
+// peer identified by 'key', see 'resume'.
+void remember(SSL* ssl, const std::string& key);
+
+// Forgets the session remembered for the peer identified by 'key',
+// e.g., because the peer could not be verified.
+void forget(const std::string& key);
+
 // Verify that the hostname is properly associated with the peer
 // certificate associated with the specified SSL connection.
 Try<Nothing> verify(
@@ -17,18 +17,28 @@
 #include <netinet/tcp.h>
 #endif // __WINDOWS__
 
+#include <vector>
+
 #include <process/io.hpp>
 #include <process/network.hpp>
 #include <process/socket.hpp>
 
+#include <stout/foreach.hpp>
+#include <stout/option.hpp>
 #include <stout/os/sendfile.hpp>
 #include <stout/os/strerror.hpp>
 #include <stout/os.hpp>
+#include <stout/synchronized.hpp>
 
 #include "config.hpp"
 #include "poll_socket.hpp"
 
+#ifdef USE_IO_URING
+#include "io_uring.hpp"
+#endif // USE_IO_URING
+
 using std::string;
+using std::vector;
 
 namespace process {
 namespace network {
@@ -51,11 +61,25 @@ Try<Nothing> PollSocketImpl::listen(int backlog)
 
 namespace internal {
 
-Future<int> accept(int fd)
+// The largest number of connections that `PollSocketImpl::_accept`
+// accepts at once, which bounds the time the event loop spends
+// accepting when many peers connect at once (e.g., after a failover).
+constexpr size_t MAX_ACCEPT_BATCH = 64;
+
+
+Try<int> accept(int fd)
 {
+#ifdef __linux__
+  // Creating the socket non-blocking and close-on-exec right away
+  // saves the two system calls that make it so afterwards.
+  int s = ::accept4(fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+  if (s < 0) {
+    return ErrnoError("Failed to accept");
+  }
+#else
   Try<int> accepted = network::accept(fd);
   if (accepted.isError()) {
-    return Failure(accepted.error());
+    return Error(accepted.error());
   }
 
   int s = accepted.get();
@@ -64,7 +88,7 @@ Future<int> accept(int fd)
     LOG_IF(INFO, VLOG_IS_ON(1)) << "Failed to accept, nonblock: "
                                 << nonblock.error();
     os::close(s);
-    return Failure("Failed to accept, nonblock: " + nonblock.error());
+    return Error("Failed to accept, nonblock: " + nonblock.error());
   }
 
   Try<Nothing> cloexec = os::cloexec(s);
@@ -72,15 +96,16 @@ Future<int> accept(int fd)
     LOG_IF(INFO, VLOG_IS_ON(1)) << "Failed to accept, cloexec: "
                                 << cloexec.error();
     os::close(s);
-    return Failure("Failed to accept, cloexec: " + cloexec.error());
+    return Error("Failed to accept, cloexec: " + cloexec.error());
   }
+#endif // __linux__
 
   Try<Address> address = network::address(s);
   if (address.isError()) {
     LOG_IF(INFO, VLOG_IS_ON(1)) << "Failed to get address: "
                                 << address.error();
     os::close(s);
-    return Failure("Failed to get address: " + address.error());
+    return Error("Failed to get address: " + address.error());
   }
 
   // Turn off Nagle (TCP_NODELAY) so pipelined requests don't wait.
@@ -97,7 +122,7 @@ Future<int> accept(int fd)
       const string error = os::strerror(errno);
       VLOG(1) << "Failed to turn off the Nagle algorithm: " << error;
       os::close(s);
-      return Failure(
+      return Error(
           "Failed to turn off the Nagle algorithm: " + stringify(error));
     }
   }
@@ -108,10 +133,31 @@ Future<int> accept(int fd)
 } // namespace internal {
 
 
+PollSocketImpl::~PollSocketImpl()
+{
+  // Close the connections that were accepted but never returned.
+  foreach (int s, accepted) {
+    os::close(s);
+  }
+}
+
+
 Future<std::shared_ptr<SocketImpl>> PollSocketImpl::accept()
 {
-  return io::poll(get(), io::READ)
-    .then(lambda::bind(&internal::accept, get()))
+  Option<int> queued;
+  synchronized (mutex) {
+    if (!accepted.empty()) {
+      queued = accepted.front();
+      accepted.pop_front();
+    }
+  }
+
+  Future<int> future = queued.isSome()
+    ? Future<int>(queued.get())
+    : io::poll(get(), io::READ)
+        .then(lambda::bind(&PollSocketImpl::_accept, shared(this)));
+
+  return future
     .then([](int s) -> Future<std::shared_ptr<SocketImpl>> {
       Try<std::shared_ptr<SocketImpl>> impl = create(s);
       if (impl.isError()) {
@@ -123,6 +169,37 @@ Future<std::shared_ptr<SocketImpl>> PollSocketImpl::accept()
 }
 
 
+Future<int> PollSocketImpl::_accept()
+{
+  Try<int> s = internal::accept(get());
+  if (s.isError()) {
+    return Failure(s.error());
+  }
+
+  // Accept the other pending connections as well rather than polling
+  // the socket again for each of them. This stops at the first error,
+  // which usually means that there are no more pending connections
+  // (i.e., `EAGAIN`); any other error shows up again after polling.
+  vector<int> pending;
+  while (pending.size() + 1 < internal::MAX_ACCEPT_BATCH) {
+    Try<int> next = internal::accept(get());
+    if (next.isError()) {
+      break;
+    }
+
+    pending.push_back(next.get());
+  }
+
+  if (!pending.empty()) {
+    synchronized (mutex) {
+      accepted.insert(accepted.end(), pending.begin(), pending.end());
+    }
+  }
+
+  return s.get();
+}
+
+
 namespace internal {
 
 Future<Nothing> connect(
@@ -267,6 +344,14 @@ Future<size_t> socket_send_file(
 
 Future<size_t> PollSocketImpl::send(const char* data, size_t size)
 {
+#ifdef USE_IO_URING
+  // Poll and send with a single submission if io_uring is available.
+  IoUring* ring = IoUring::instance();
+  if (ring != nullptr) {
+    return ring->send(get(), data, size);
+  }
+#endif // USE_IO_URING
+
   return io::poll(get(), io::WRITE)
     .then(lambda::bind(
         &internal::socket_send_data,
@@ -10,7 +10,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License
 
+#include <deque>
 #include <memory>
+#include <mutex>
 
 #include <process/socket.hpp>
 
@@ -27,7 +29,7 @@ public:
 
   PollSocketImpl(int s) : SocketImpl(s) {}
 
-  virtual ~PollSocketImpl() {}
+  virtual ~PollSocketImpl();
 
   // Implementation of the SocketImpl interface.
   virtual Try<Nothing> listen(int backlog);
@@ -37,6 +39,19 @@ public:
   virtual Future<size_t> send(const char* data, size_t size);
   virtual Future<size_t> sendfile(int fd, off_t offset, size_t size);
   virtual Kind kind() const { return SocketImpl::Kind::POLL; }
+
+private:
+  // Accepts the pending connections (up to a limit) once the socket
+  // is readable, returning the first one and queueing the others so
+  // that the next calls to `accept` return them right away.
+  Future<int> _accept();
+
+  // Protects `accepted`.
+  std::mutex mutex;
+
+  // The connections accepted by `_accept` that have not been
+  // returned yet.
+  std::deque<int> accepted;
 };
 
 } // namespace internal {
@@ -90,9 +90,11 @@
 
 #include <process/ssl/flags.hpp>
 
+#include <stout/bytes.hpp>
 #include <stout/duration.hpp>
 #include <stout/flags.hpp>
 #include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
 #include <stout/lambda.hpp>
 #include <stout/net.hpp>
 #include <stout/numify.hpp>
@@ -110,8 +112,13 @@
 #include "decoder.hpp"
 #include "encoder.hpp"
 #include "event_loop.hpp"
+#include "event_queue.hpp"
+#include "event_statistics.hpp"
 #include "gate.hpp"
+#include "http_connection_pool.hpp"
 #include "process_reference.hpp"
+#include "route_trie.hpp"
+#include "sampler.hpp"
 
 using process::wait; // Necessary on some OS's to disambiguate.
 
@@ -205,6 +212,112 @@ struct Flags : public virtual flags::FlagsBase
             }
           }
 
+          return None();
+        });
+
+    add(&Flags::enable_event_statistics,
+        "enable_event_statistics",
+        "Whether to record statistics about the events served by each\n"
+        "process: the number of queued events, the time events spend in\n"
+        "the queue and the time spent serving each type of message, HTTP\n"
+        "request and dispatch. The statistics are available through the\n"
+        "'/__event_statistics__' endpoint and '/metrics/snapshot'.",
+        false);
+
+    add(&Flags::http_max_idle_connections,
+        "http_max_idle_connections",
+        "The maximum number of idle connections that the HTTP client\n"
+        "helpers (e.g., 'http::get' and 'http::post') keep open to each\n"
+        "scheme, host and port in order to reuse them for subsequent\n"
+        "requests. Set to 0 to open a new connection for every request.",
+        4);
+
+    add(&Flags::http_max_pipelined_requests,
+        "http_max_pipelined_requests",
+        "The maximum number of requests that the HTTP client helpers\n"
+        "send on a pooled connection before receiving their responses.",
+        1,
+        [](const size_t& value) -> Option<Error> {
+          if (value == 0) {
+            return Error(
+                "LIBPROCESS_HTTP_MAX_PIPELINED_REQUESTS must be positive");
+          }
+
+          return None();
+        });
+
+    add(&Flags::http_idle_connection_timeout,
+        "http_idle_connection_timeout",
+        "The amount of time after which an idle pooled connection of the\n"
+        "HTTP client helpers is closed.",
+        Seconds(30));
+
+    add(&Flags::acceptors,
+        "acceptors",
+        "The number of server sockets that accept connections on the\n"
+        "address of libprocess. Each socket has its own accept queue, so\n"
+        "that more connections can be pending at once (e.g., when many\n"
+        "peers reconnect after a failover) before the kernel drops them.\n"
+        "More than one socket requires 'SO_REUSEPORT' (Linux).",
+        1,
+        [](const size_t& value) -> Option<Error> {
+          if (value == 0) {
+            return Error("LIBPROCESS_ACCEPTORS must be positive");
+          }
+
+#ifndef __linux__
+          if (value > 1) {
+            return Error(
+                "LIBPROCESS_ACCEPTORS greater than 1 is only supported"
+                " on Linux");
+          }
+#endif // __linux__
+
+          return None();
+        });
+
+    add(&Flags::link_keepalive_idle,
+        "link_keepalive_idle",
+        "If set, TCP keepalive probes are sent on the sockets of links to\n"
+        "remote processes once they have been idle for this amount of\n"
+        "time, so that a peer which went away without closing the\n"
+        "connection (e.g., a host that lost power or got partitioned)\n"
+        "is detected and the linkers get exited events. Otherwise such\n"
+        "a link is only found broken the next time a message is sent.",
+        [](const Option<Duration>& value) -> Option<Error> {
+          if (value.isSome() && value.get() < Seconds(1)) {
+            return Error(
+                "LIBPROCESS_LINK_KEEPALIVE_IDLE must be at least 1 second");
+          }
+
+          return None();
+        });
+
+    add(&Flags::link_keepalive_interval,
+        "link_keepalive_interval",
+        "The amount of time between the TCP keepalive probes of a link,\n"
+        "see 'LIBPROCESS_LINK_KEEPALIVE_IDLE'.",
+        Seconds(10),
+        [](const Duration& value) -> Option<Error> {
+          if (value < Seconds(1)) {
+            return Error(
+                "LIBPROCESS_LINK_KEEPALIVE_INTERVAL must be at least"
+                " 1 second");
+          }
+
+          return None();
+        });
+
+    add(&Flags::link_keepalive_count,
+        "link_keepalive_count",
+        "The number of unanswered TCP keepalive probes after which a\n"
+        "link is considered broken, see 'LIBPROCESS_LINK_KEEPALIVE_IDLE'.",
+        3,
+        [](const size_t& value) -> Option<Error> {
+          if (value == 0) {
+            return Error("LIBPROCESS_LINK_KEEPALIVE_COUNT must be positive");
+          }
+
           return None();
         });
   }
@@ -213,6 +326,24 @@ struct Flags : public virtual flags::FlagsBase
   Option<net::IP> advertise_ip;
   Option<int> port;
   Option<int> advertise_port;
+  bool enable_event_statistics;
+  size_t http_max_idle_connections;
+  size_t http_max_pipelined_requests;
+  Duration http_idle_connection_timeout;
+  size_t acceptors;
+  Option<Duration> link_keepalive_idle;
+  Duration link_keepalive_interval;
+  size_t link_keepalive_count;
+};
+
+
+// The TCP keepalive settings of the sockets of links, see
+// `LIBPROCESS_LINK_KEEPALIVE_IDLE`.
+struct LinkKeepalive
+{
+  Duration idle;
+  Duration interval;
+  size_t count;
 };
 
 } // namespace internal {
@@ -361,7 +492,7 @@ public:
   ~SocketManager();
 
   // Closes all managed sockets and clears any associated metadata.
-  // The `__s__` server socket must be closed and `ProcessManager`
+  // The `__s__` server sockets must be closed and `ProcessManager`
   // must be finalized before calling this.
   void finalize();
 
@@ -397,9 +528,17 @@ public:
   void exited(const Address& address);
   void exited(ProcessBase* process);
 
+  // The /__sockets__ route.
+  Future<Response> __sockets__(const Request&);
+
 private:
   // TODO(bmahler): Leverage a bidirectional multimap instead, or
   // hide the complexity of manipulating 'links' through methods.
+  //
+  // NOTE: The links are protected by 'links_mutex' rather than by
+  // 'mutex', so that processes exiting (and notifying their linkers)
+  // do not contend with the sockets being used. When both are needed,
+  // 'mutex' must be acquired first.
   struct
   {
     // For links, we maintain a bidirectional mapping between the
@@ -412,6 +551,8 @@ private:
     hashmap<Address, hashset<UPID>> remotes;
   } links;
 
+  std::mutex links_mutex;
+
   // Switch the underlying socket that a remote end is talking to.
   // This manipulates the data structures below by swapping all data
   // mapped to 'from' to being mapped to 'to'. This is useful for
@@ -453,7 +594,12 @@ private:
   hashmap<Address, int> persists;
 
   // Map from outbound socket to outgoing queue.
-  hashmap<int, queue<Encoder*>> outgoing;
+  hashmap<int, deque<Encoder*>> outgoing;
+
+  // Maximum number of bytes of queued data encoders that are combined
+  // into a single encoder by `next()`, so that many small messages to
+  // the same socket are sent with few writes. Zero disables batching.
+  size_t batch;
 
   // HTTP proxies.
   hashmap<int, HttpProxy*> proxies;
@@ -522,23 +668,50 @@ public:
   // The /__processes__ route.
   Future<Response> __processes__(const Request&);
 
+  // The /__event_statistics__ route.
+  Future<Response> __event_statistics__(const Request&);
+
 private:
   // Delegate process name to receive root HTTP requests.
   const Option<string> delegate;
 
   // Map of all local spawned and running processes.
-  map<string, ProcessBase*> processes;
+  hashmap<string, ProcessBase*> processes;
   std::recursive_mutex processes_mutex;
 
   // Gates for waiting threads (protected by processes_mutex).
   map<ProcessBase*, Gate*> gates;
 
-  // Queue of runnable processes (implemented using list).
-  list<ProcessBase*> runq;
-  std::recursive_mutex runq_mutex;
+  // Queue of runnable processes.
+  struct RunQueue
+  {
+    // Removes the process from the queue, returns false if it was not
+    // in the queue.
+    bool remove(ProcessBase* process);
+
+    std::deque<ProcessBase*> processes;
+    std::mutex mutex;
+  };
+
+  // Returns the process at the front of the queue, if any.
+  ProcessBase* dequeue(RunQueue* runq);
+
+  // The run queues of the processing threads. A processing thread
+  // adds the processes that it makes runnable to its own queue, so
+  // that they tend to be resumed on the same thread, and steals from
+  // the queues of the other processing threads when it runs out of
+  // processes to run. This avoids contention on a single queue.
+  vector<RunQueue*> runqs;
+
+  // Queue of the processes made runnable by any other thread (e.g.,
+  // the event loop or a thread that does not belong to libprocess).
+  RunQueue runq;
 
-  // Number of running processes, to support Clock::settle operation.
-  std::atomic_long running;
+  // Number of processes that are runnable or running, to support
+  // Clock::settle operation. A process is counted when it is enqueued
+  // rather than when it is dequeued, so that the count never drops to
+  // 0 while a running process is about to make another one runnable.
+  std::atomic_long runnable;
 
   // Stores the thread handles so that we can join during shutdown.
   vector<std::thread*> threads;
@@ -564,17 +737,18 @@ static std::atomic_bool initialize_complete(false);
 // Server socket listen backlog.
 static const int LISTEN_BACKLOG = 500000;
 
-// Local server socket.
-static Socket* __s__ = nullptr;
+// Local server sockets, i.e., one socket per acceptor (see
+// `LIBPROCESS_ACCEPTORS`), all bound to the same address.
+static vector<Socket>* __s__ = nullptr;
 
 // This mutex is only used to prevent a race between the `on_accept`
-// callback loop and closing/deleting `__s__` in `process::finalize`.
+// callback loops and closing/deleting `__s__` in `process::finalize`.
 static std::mutex* socket_mutex = new std::mutex();
 
-// The future returned by the last call to `__s__->accept()`.
-// This is used in `process::finalize` to explicitly terminate the
-// `__s__` socket's callback loop.
-static Future<Socket> future_accept;
+// The futures returned by the last call to `accept()` of each of the
+// `__s__` sockets. These are used in `process::finalize` to explicitly
+// terminate the callback loops of the `__s__` sockets.
+static vector<Future<Socket>> future_accepts;
 
 // Local socket address.
 static Address __address__ = Address::ANY_ANY();
@@ -597,6 +771,20 @@ static AuthorizationCallbacks* authorization_callbacks = nullptr;
 // Global route that returns process information.
 static Route* processes_route = nullptr;
 
+// Global route that returns the outgoing queues of the sockets.
+static Route* sockets_route = nullptr;
+
+// Global route that returns the event statistics of the processes.
+static Route* event_statistics_route = nullptr;
+
+// Whether processes record statistics about their events, see
+// `LIBPROCESS_ENABLE_EVENT_STATISTICS`.
+static bool event_statistics = false;
+
+// Whether (and how) the sockets of links send TCP keepalive probes,
+// see `LIBPROCESS_LINK_KEEPALIVE_IDLE`.
+static Option<internal::LinkKeepalive> link_keepalive = None();
+
 // Filter. Synchronized support for using the filterer needs to be
 // recursive in case a filterer wants to do anything fancy (which is
 // possible and likely given that filters will get used for testing).
@@ -618,6 +806,14 @@ THREAD_LOCAL ProcessBase* __process__ = nullptr;
 // Per thread executor pointer.
 THREAD_LOCAL Executor* _executor_ = nullptr;
 
+// Per thread index into the run queues of the processing threads, or
+// -1 if the thread is not a processing thread.
+static THREAD_LOCAL long __worker__ = -1;
+
+// Per thread number of processes dequeued, used to check the run queue
+// shared by all threads periodically (see `ProcessManager::dequeue`).
+static THREAD_LOCAL uint64_t __dequeued__ = 0;
+
 namespace metrics {
 namespace internal {
 
@@ -723,14 +919,14 @@ static void transport(Message* message, ProcessBase* sender = nullptr)
 // headers will be set), or a client that speaks the libprocess
 // protocol (i.e. only the "Libprocess-From" header will be set).
 // This function returns true for either case.
-static bool libprocess(Request* request)
+static bool libprocess(const Request& request)
 {
   return
-    (request->method == "POST" &&
-     request->headers.contains("User-Agent") &&
-     request->headers["User-Agent"].find("libprocess/") == 0) ||
-    (request->method == "POST" &&
-     request->headers.contains("Libprocess-From"));
+    (request.method == "POST" &&
+     request.headers.contains("User-Agent") &&
+     request.headers.at("User-Agent").find("libprocess/") == 0) ||
+    (request.method == "POST" &&
+     request.headers.contains("Libprocess-From"));
 }
 
 
@@ -753,7 +949,8 @@ static Future<Owned<Request>> convert(Owned<Request>&& pipeRequest)
 }
 
 
-static Future<Message*> parse(const Request& request)
+// NOTE: The body of a 'BODY' request is moved into the message.
+static Future<Message*> parse(Request* request)
 {
   // TODO(benh): Do better error handling (to deal with a malformed
   // libprocess message, malicious or otherwise).
@@ -761,11 +958,11 @@ static Future<Message*> parse(const Request& request)
   // First try and determine 'from'.
   Option<UPID> from = None();
 
-  if (request.headers.contains("Libprocess-From")) {
-    from = UPID(strings::trim(request.headers.at("Libprocess-From")));
+  if (request->headers.contains("Libprocess-From")) {
+    from = UPID(strings::trim(request->headers.at("Libprocess-From")));
   } else {
     // Try and get 'from' from the User-Agent.
-    const string& agent = request.headers.at("User-Agent");
+    const string& agent = request->headers.at("User-Agent");
     const string identifier = "libprocess/";
     size_t index = agent.find(identifier);
     if (index != string::npos) {
@@ -778,11 +975,11 @@ static Future<Message*> parse(const Request& request)
   }
 
   // Now determine 'to'.
-  size_t index = request.url.path.find('/', 1);
+  size_t index = request->url.path.find('/', 1);
   index = index != string::npos ? index - 1 : string::npos;
 
   // Decode possible percent-encoded 'to'.
-  Try<string> decode = http::decode(request.url.path.substr(1, index));
+  Try<string> decode = http::decode(request->url.path.substr(1, index));
 
   if (decode.isError()) {
     return Failure("Failed to decode URL path: " + decode.get());
@@ -791,14 +988,27 @@ static Future<Message*> parse(const Request& request)
   const UPID to(decode.get(), __address__);
 
   // And now determine 'name'.
-  index = index != string::npos ? index + 2: request.url.path.size();
-  const string name = request.url.path.substr(index);
+  index = index != string::npos ? index + 2: request->url.path.size();
+  const string name = request->url.path.substr(index);
 
   VLOG(2) << "Parsed message name '" << name
           << "' for " << to << " from " << from.get();
 
-  CHECK_SOME(request.reader);
-  http::Pipe::Reader reader = request.reader.get(); // Remove const.
+  // The decoder buffers the body of libprocess messages (see
+  // `on_accept`), so unless the request was decoded elsewhere we can
+  // hand the body over without copying it.
+  if (request->type == Request::BODY) {
+    Message* message = new Message();
+    message->name = name;
+    message->from = from.get();
+    message->to = to;
+    message->body = std::move(request->body);
+
+    return message;
+  }
+
+  CHECK_SOME(request->reader);
+  http::Pipe::Reader reader = request->reader.get();
 
   return reader.readAll()
     .then([from, name, to](const string& body) {
@@ -917,7 +1127,7 @@ void timedout(const list<Timer>& timers)
 
 namespace internal {
 
-void on_accept(const Future<Socket>& socket)
+void on_accept(const Future<Socket>& socket, size_t index)
 {
   if (socket.isReady()) {
     // Inform the socket manager for proper bookkeeping.
@@ -926,7 +1136,10 @@ void on_accept(const Future<Socket>& socket)
     const size_t size = 80 * 1024;
     char* data = new char[size];
 
-    StreamingRequestDecoder* decoder = new StreamingRequestDecoder();
+    // Libprocess messages are always read in full (see `parse`), so
+    // we let the decoder buffer their bodies rather than stream them.
+    StreamingRequestDecoder* decoder =
+      new StreamingRequestDecoder(&libprocess);
 
     socket.get().recv(data, size)
       .onAny(lambda::bind(
@@ -939,14 +1152,137 @@ void on_accept(const Future<Socket>& socket)
   }
 
   // NOTE: `__s__` may be cleaned up during `process::finalize`.
+  Option<Future<Socket>> accept;
   synchronized (socket_mutex) {
     if (__s__ != nullptr) {
-      future_accept = __s__->accept()
-        .onAny(lambda::bind(&on_accept, lambda::_1));
+      future_accepts[index] = __s__->at(index).accept();
+      accept = future_accepts[index];
     }
   }
+
+  // NOTE: The callback is set outside of the critical section since
+  // `accept()` returns a ready future for connections that were
+  // accepted in a batch, in which case the callback runs right away.
+  if (accept.isSome()) {
+    accept->onAny(lambda::bind(&on_accept, lambda::_1, index));
+  }
 }
 
+
+#ifdef __linux__
+// Provides the gauges that tell whether connections get dropped
+// because the accept queues overflow, e.g., when many agents and
+// schedulers reconnect at once after a failover.
+class AcceptStatisticsProcess : public Process<AcceptStatisticsProcess>
+{
+public:
+  AcceptStatisticsProcess()
+    : ProcessBase("accept_statistics"),
+      queued(
+          "libprocess/accept/queued",
+          defer(self(), &Self::_queued)),
+      overflows(
+          "libprocess/accept/listen_overflows",
+          defer(self(), &Self::netstat, "ListenOverflows")),
+      drops(
+          "libprocess/accept/listen_drops",
+          defer(self(), &Self::netstat, "ListenDrops")) {}
+
+  virtual ~AcceptStatisticsProcess() {}
+
+protected:
+  virtual void initialize()
+  {
+    metrics::add(queued);
+    metrics::add(overflows);
+    metrics::add(drops);
+  }
+
+  virtual void finalize()
+  {
+    metrics::remove(queued);
+    metrics::remove(overflows);
+    metrics::remove(drops);
+  }
+
+private:
+  // Returns the number of connections waiting in the accept queues of
+  // the server sockets, which the kernel reports for listening
+  // sockets as the unacknowledged segments of `TCP_INFO`.
+  Future<double> _queued()
+  {
+    double result = 0;
+
+    synchronized (socket_mutex) {
+      if (__s__ == nullptr) {
+        return Failure("The server sockets are closed");
+      }
+
+      foreach (const Socket& socket, *__s__) {
+        struct tcp_info info;
+        socklen_t length = sizeof(info);
+
+        if (::getsockopt(
+                socket.get(), SOL_TCP, TCP_INFO, &info, &length) < 0) {
+          return Failure(ErrnoError("Failed to get TCP_INFO").message);
+        }
+
+        result += info.tcpi_unacked;
+      }
+    }
+
+    return result;
+  }
+
+  // Returns the counter of the TCP extensions in '/proc/net/netstat'
+  // with the given name. These count the connections that the kernel
+  // dropped (on all sockets of the host) because an accept queue was
+  // full, and are the earliest sign that the queues are too short.
+  Future<double> netstat(const string& name)
+  {
+    Try<string> read = os::read("/proc/net/netstat");
+    if (read.isError()) {
+      return Failure("Failed to read '/proc/net/netstat': " + read.error());
+    }
+
+    // The counters come in pairs of lines, i.e., a line with the names
+    // followed by a line with the values, e.g.:
+    //
+    //   TcpExt: SyncookiesSent ... ListenOverflows ListenDrops ...
+    //   TcpExt: 0 ... 12 12 ...
+    vector<string> lines = strings::tokenize(read.get(), "\n");
+    for (size_t i = 0; i + 1 < lines.size(); i++) {
+      if (!strings::startsWith(lines[i], "TcpExt:")) {
+        continue;
+      }
+
+      vector<string> names = strings::tokenize(lines[i], " ");
+      vector<string> values = strings::tokenize(lines[i + 1], " ");
+
+      for (size_t j = 1; j < names.size() && j < values.size(); j++) {
+        if (names[j] == name) {
+          Try<uint64_t> value = numify<uint64_t>(values[j]);
+          if (value.isError()) {
+            return Failure(
+                "Failed to parse '" + name + "': " + value.error());
+          }
+
+          return static_cast<double>(value.get());
+        }
+      }
+
+      break;
+    }
+
+    return Failure("Failed to find '" + name + "' in '/proc/net/netstat'");
+  }
+
+  metrics::Gauge queued;
+  metrics::Gauge overflows;
+  metrics::Gauge drops;
+};
+#endif // __linux__
+
 } // namespace internal {
 
 
@@ -1104,32 +1440,64 @@ bool initialize(
     __address__.port = flags.port.get();
   }
 
-  // Create a "server" socket for communicating.
-  Try<Socket> create = Socket::create();
-  if (create.isError()) {
-    PLOG(FATAL) << "Failed to construct server socket:" << create.error();
-  }
-  __s__ = new Socket(create.get());
+  event_statistics = flags.enable_event_statistics;
 
-  // Allow address reuse.
-  // NOTE: We cast to `char*` here because the function prototypes on Windows
-  // use `char*` instead of `void*`.
-  int on = 1;
-  if (::setsockopt(
-          __s__->get(),
-          SOL_SOCKET,
-          SO_REUSEADDR,
-          reinterpret_cast<char*>(&on),
-          sizeof(on)) < 0) {
-    PLOG(FATAL) << "Failed to initialize, setsockopt(SO_REUSEADDR)";
+  if (flags.link_keepalive_idle.isSome()) {
+    link_keepalive = internal::LinkKeepalive{
+        flags.link_keepalive_idle.get(),
+        flags.link_keepalive_interval,
+        flags.link_keepalive_count};
   }
 
-  Try<Address> bind = __s__->bind(__address__);
-  if (bind.isError()) {
-    PLOG(FATAL) << "Failed to initialize: " << bind.error();
-  }
+  // Create the "server" sockets for communicating.
+  __s__ = new vector<Socket>();
+
+  for (size_t i = 0; i < flags.acceptors; i++) {
+    Try<Socket> create = Socket::create();
+    if (create.isError()) {
+      PLOG(FATAL) << "Failed to construct server socket:" << create.error();
+    }
+
+    Socket socket = create.get();
+
+    // Allow address reuse.
+    // NOTE: We cast to `char*` here because the function prototypes on
+    // Windows use `char*` instead of `void*`.
+    int on = 1;
+    if (::setsockopt(
+            socket.get(),
+            SOL_SOCKET,
+            SO_REUSEADDR,
+            reinterpret_cast<char*>(&on),
+            sizeof(on)) < 0) {
+      PLOG(FATAL) << "Failed to initialize, setsockopt(SO_REUSEADDR)";
+    }
 
-  __address__ = bind.get();
+#ifdef __linux__
+    // Let the sockets bind the same address, in which case the kernel
+    // spreads the incoming connections over their accept queues.
+    if (flags.acceptors > 1 &&
+        ::setsockopt(
+            socket.get(),
+            SOL_SOCKET,
+            SO_REUSEPORT,
+            reinterpret_cast<char*>(&on),
+            sizeof(on)) < 0) {
+      PLOG(FATAL) << "Failed to initialize, setsockopt(SO_REUSEPORT)";
+    }
+#endif // __linux__
+
+    // NOTE: If no port was specified the first socket binds a random
+    // port, which the other sockets then bind as well.
+    Try<Address> bind = socket.bind(__address__);
+    if (bind.isError()) {
+      PLOG(FATAL) << "Failed to initialize: " << bind.error();
+    }
+
+    __address__ = bind.get();
+
+    __s__->push_back(socket);
+  }
 
   // If advertised IP and port are present, use them instead.
   if (flags.advertise_ip.isSome()) {
@@ -1164,17 +1532,29 @@ bool initialize(
     __address__.ip = ip.get();
   }
 
-  Try<Nothing> listen = __s__->listen(LISTEN_BACKLOG);
-  if (listen.isError()) {
-    PLOG(FATAL) << "Failed to initialize: " << listen.error();
+  foreach (Socket& socket, *__s__) {
+    Try<Nothing> listen = socket.listen(LISTEN_BACKLOG);
+    if (listen.isError()) {
+      PLOG(FATAL) << "Failed to initialize: " << listen.error();
+    }
   }
 
   // Need to set `initialize_complete` here so that we can actually
   // invoke `accept()` and `spawn()` below.
   initialize_complete.store(true);
 
-  future_accept = __s__->accept()
-    .onAny(lambda::bind(&internal::on_accept, lambda::_1));
+  vector<Future<Socket>> accepts;
+  synchronized (socket_mutex) {
+    foreach (Socket& socket, *__s__) {
+      future_accepts.push_back(socket.accept());
+    }
+
+    accepts = future_accepts;
+  }
+
+  for (size_t i = 0; i < accepts.size(); i++) {
+    accepts[i].onAny(lambda::bind(&internal::on_accept, lambda::_1, i));
+  }
 
   // TODO(benh): Make sure creating the garbage collector, logging
   // process, and profiler always succeeds and use supervisors to make
@@ -1227,6 +1607,11 @@ bool initialize(
   // Create the global system statistics process.
   spawn(new System(), true);
 
+#ifdef __linux__
+  // Create the global process for the statistics of the accept queues.
+  spawn(new internal::AcceptStatisticsProcess(), true);
+#endif // __linux__
+
   // Create the global HTTP authentication router.
   authenticator_manager = new AuthenticatorManager();
 
@@ -1234,6 +1619,12 @@ bool initialize(
   process::internal::reaper =
     spawn(new process::internal::ReaperProcess(), true);
 
+  // Create the pool of connections of the HTTP client helpers.
+  http::internal::spawnConnectionPool(
+      flags.http_max_idle_connections,
+      flags.http_max_pipelined_requests,
+      flags.http_idle_connection_timeout);
+
   // Initialize the mime types.
   mime::initialize();
 
@@ -1243,6 +1634,27 @@ bool initialize(
 
   processes_route = new Route("/__processes__", None(), __processes__);
 
+  // Add a route for getting the outgoing queues of the sockets.
+  lambda::function<Future<Response>(const Request&)> __sockets__ =
+    lambda::bind(&SocketManager::__sockets__, socket_manager, lambda::_1);
+
+  sockets_route = new Route("/__sockets__", None(), __sockets__);
+
+  if (event_statistics) {
+    // Add a route for getting the event statistics of the processes.
+    lambda::function<Future<Response>(const Request&)> __event_statistics__ =
+      lambda::bind(
+          &ProcessManager::__event_statistics__,
+          process_manager,
+          lambda::_1);
+
+    event_statistics_route = new Route(
+        "/__event_statistics__", None(), __event_statistics__);
+
+    // Add the statistics of all processes to the metrics.
+    spawnEventStatistics();
+  }
+
   VLOG(1) << "libprocess is initialized on " << address() << " with "
           << num_worker_threads << " worker threads";
 
@@ -1267,13 +1679,23 @@ void finalize(bool finalize_wsa)
   delete processes_route;
   processes_route = nullptr;
 
-  // Close the server socket.
+  delete sockets_route;
+  sockets_route = nullptr;
+
+  delete event_statistics_route;
+  event_statistics_route = nullptr;
+
+  // Close the server sockets.
   // This will prevent any further connections managed by the `SocketManager`.
   synchronized (socket_mutex) {
-    // Explicitly terminate the callback loop used to accept incoming
-    // connections. This is necessary as the server socket ignores
+    // Explicitly terminate the callback loops used to accept incoming
+    // connections. This is necessary as the server sockets ignore
     // most errors, including when the server socket has been closed.
-    future_accept.discard();
+    foreach (Future<Socket>& future, future_accepts) {
+      future.discard();
+    }
+
+    future_accepts.clear();
 
     delete __s__;
     __s__ = nullptr;
@@ -1444,6 +1866,69 @@ void HttpProxy::waited(const Future<Response>& future)
 }
 
 
+// Parses the 'Range' header of a request for a file of the given size
+// into the offset and length of the range (RFC 7233). Only a single
+// range is supported (e.g., "bytes=0-99", "bytes=100-", "bytes=-100"),
+// anything else is ignored (i.e., returns None) so that the whole file
+// is sent. Returns an error if the range can not be satisfied.
+static Try<Option<pair<off_t, off_t>>> parseRange(
+    const string& range,
+    off_t size)
+{
+  if (!strings::startsWith(range, "bytes=")) {
+    return None();
+  }
+
+  const string spec = strings::trim(range.substr(strlen("bytes=")));
+
+  size_t dash = spec.find('-');
+  if (dash == string::npos || strings::contains(spec, ",")) {
+    return None();
+  }
+
+  const string first = strings::trim(spec.substr(0, dash));
+  const string last = strings::trim(spec.substr(dash + 1));
+
+  if (first.empty()) {
+    // A suffix range, i.e., the last 'N' bytes of the file.
+    Try<off_t> suffix = numify<off_t>(last);
+    if (suffix.isError() || suffix.get() < 0) {
+      return None();
+    }
+
+    if (suffix.get() == 0 || size == 0) {
+      return Error("Empty suffix range '" + range + "'");
+    }
+
+    off_t offset = std::max<off_t>(0, size - suffix.get());
+    return pair<off_t, off_t>(offset, size - offset);
+  }
+
+  Try<off_t> start = numify<off_t>(first);
+  if (start.isError() || start.get() < 0) {
+    return None();
+  }
+
+  off_t end = size - 1;
+  if (!last.empty()) {
+    Try<off_t> _end = numify<off_t>(last);
+    if (_end.isError() || _end.get() < start.get()) {
+      return None();
+    }
+
+    end = std::min(end, _end.get());
+  }
+
+  if (start.get() >= size) {
+    return Error(
+        "Range '" + range + "' starts beyond the end of the file"
+        " (" + stringify(size) + " bytes)");
+  }
+
+  return pair<off_t, off_t>(start.get(), end - start.get() + 1);
+}
+
+
 bool HttpProxy::process(const Future<Response>& future, const Request& request)
 {
   if (!future.isReady()) {
@@ -1494,18 +1979,59 @@ bool HttpProxy::process(const Future<Response>& future, const Request& request)
         VLOG(1) << "Returning '404 Not Found' for directory '" << path << "'";
         socket_manager->send(NotFound(), request, socket);
       } else {
+        // Serve only the requested byte range of the file (if any),
+        // which lets clients page through large files (e.g., sandbox
+        // logs) without downloading them in full.
+        off_t offset = 0;
+        off_t length = s.st_size;
+
+        response.headers["Accept-Ranges"] = "bytes";
+
+        Option<string> range = request.headers.get("Range");
+        if (range.isSome() && response.code == http::Status::OK) {
+          Try<Option<pair<off_t, off_t>>> bytes =
+            parseRange(range.get(), s.st_size);
+
+          if (bytes.isError()) {
+            VLOG(1) << "Returning '416 Requested Range Not Satisfiable' for"
+                    << " path '" << path << "': " << bytes.error();
+
+            os::close(fd);
+
+            Response unsatisfiable(
+                http::Status::REQUESTED_RANGE_NOT_SATISFIABLE);
+            unsatisfiable.headers["Content-Range"] =
+              "bytes */" + stringify(s.st_size);
+
+            socket_manager->send(unsatisfiable, request, socket);
+            return true; // All done, can process next request.
+          }
+
+          if (bytes->isSome()) {
+            offset = bytes->get().first;
+            length = bytes->get().second;
+
+            response.code = http::Status::PARTIAL_CONTENT;
+            response.status = http::Status::string(response.code);
+            response.headers["Content-Range"] =
+              "bytes " + stringify(offset) + "-" +
+              stringify(offset + length - 1) + "/" + stringify(s.st_size);
+          }
+        }
+
         // While the user is expected to properly set a 'Content-Type'
         // header, we fill in (or overwrite) 'Content-Length' header.
         stringstream out;
-        out << s.st_size;
+        out << length;
         response.headers["Content-Length"] = out.str();
 
-        if (s.st_size == 0) {
+        if (length == 0) {
           socket_manager->send(response, request, socket);
           return true; // All done, can process next request.
         }
 
-        VLOG(1) << "Sending file at '" << path << "' with length " << s.st_size;
+        VLOG(1) << "Sending file at '" << path << "' with length " << length
+                << " from offset " << offset;
 
         // TODO(benh): Consider a way to have the socket manager turn
         // on TCP_CORK for both sends and then turn it off.
@@ -1516,7 +2042,7 @@ bool HttpProxy::process(const Future<Response>& future, const Request& request)
 
         // Note the file descriptor gets closed by FileEncoder.
         socket_manager->send(
-            new FileEncoder(fd, s.st_size),
+            new FileEncoder(fd, length, offset),
             request.keepAlive,
             socket);
       }
@@ -1613,7 +2139,26 @@ void HttpProxy::stream(
 }
 
 
-SocketManager::SocketManager() {}
+SocketManager::SocketManager()
+  : batch(64 * 1024)
+{
+  constexpr char env_var[] = "LIBPROCESS_SEND_BATCH_SIZE";
+  Option<string> value = os::getenv(env_var);
+  if (value.isSome()) {
+    Try<Bytes> bytes = Bytes::parse(value.get());
+    if (bytes.isSome()) {
+      VLOG(1) << "Overriding default send batch size " << Bytes(batch)
+              << ", using the value " << env_var << "=" << bytes.get()
+              << " instead";
+      batch = bytes->bytes();
+    } else {
+      LOG(WARNING) << "Ignoring invalid value " << value.get()
+                   << " for " << env_var
+                   << ", using default value " << Bytes(batch)
+                   << ": " << bytes.error();
+    }
+  }
+}
 
 
 SocketManager::~SocketManager() {}
@@ -1621,8 +2166,8 @@ SocketManager::~SocketManager() {}
 
 void SocketManager::finalize()
 {
-  // We require the `SocketManager` to be finalized after the server socket
-  // has been closed. This means that no further incoming sockets will be
+  // We require the `SocketManager` to be finalized after the server sockets
+  // have been closed. This means that no further incoming sockets will be
   // given to the `SocketManager` at this point.
   CHECK(__s__ == nullptr);
 
@@ -1683,6 +2228,66 @@ void ignore_recv_data(
 }
 
 
+// Enables TCP keepalive probes on the socket of a link, after which
+// a peer that does not answer fails the pending `recv()` of
+// `ignore_recv_data` and thereby closes the link.
+Try<Nothing> keepalive(const Socket& socket, const LinkKeepalive& settings)
+{
+  auto set = [&socket](int level, int option, int value) -> Try<Nothing> {
+    // NOTE: We cast to `char*` here because the function prototypes
+    // on Windows use `char*` instead of `void*`.
+    if (::setsockopt(
+            socket.get(),
+            level,
+            option,
+            reinterpret_cast<char*>(&value),
+            sizeof(value)) < 0) {
+      return ErrnoError();
+    }
+
+    return Nothing();
+  };
+
+  Try<Nothing> result = set(SOL_SOCKET, SO_KEEPALIVE, 1);
+  if (result.isError()) {
+    return Error("Failed to set SO_KEEPALIVE: " + result.error());
+  }
+
+  // NOTE: Where the options are not available, the probes are sent
+  // according to the system wide settings.
+#ifdef TCP_KEEPIDLE
+  result = set(
+      IPPROTO_TCP,
+      TCP_KEEPIDLE,
+      static_cast<int>(settings.idle.secs()));
+
+  if (result.isError()) {
+    return Error("Failed to set TCP_KEEPIDLE: " + result.error());
+  }
+#endif // TCP_KEEPIDLE
+
+#ifdef TCP_KEEPINTVL
+  result = set(
+      IPPROTO_TCP,
+      TCP_KEEPINTVL,
+      static_cast<int>(settings.interval.secs()));
+
+  if (result.isError()) {
+    return Error("Failed to set TCP_KEEPINTVL: " + result.error());
+  }
+#endif // TCP_KEEPINTVL
+
+#ifdef TCP_KEEPCNT
+  result = set(IPPROTO_TCP, TCP_KEEPCNT, static_cast<int>(settings.count));
+  if (result.isError()) {
+    return Error("Failed to set TCP_KEEPCNT: " + result.error());
+  }
+#endif // TCP_KEEPCNT
+
+  return Nothing();
+}
+
+
 // Forward declaration.
 void send(Encoder* encoder, Socket socket);
 
@@ -1759,6 +2364,14 @@ void SocketManager::link_connect(
     return;
   }
 
+  if (link_keepalive.isSome()) {
+    Try<Nothing> keepalive = internal::keepalive(socket, link_keepalive.get());
+    if (keepalive.isError()) {
+      VLOG(1) << "Failed to enable keepalive on link to " << to << ": "
+              << keepalive.error();
+    }
+  }
+
   synchronized (mutex) {
     // It is possible that a prior call to `link()` with `RECONNECT`
     // semantics has swapped out this socket before we finished
@@ -1895,10 +2508,12 @@ void SocketManager::link(
       }
     }
 
-    links.linkers[to].insert(process);
-    links.linkees[process].insert(to);
-    if (to.address != __address__) {
-      links.remotes[to.address].insert(to);
+    synchronized (links_mutex) {
+      links.linkers[to].insert(process);
+      links.linkees[process].insert(to);
+      if (to.address != __address__) {
+        links.remotes[to.address].insert(to);
+      }
     }
   }
 
@@ -2068,7 +2683,7 @@ void SocketManager::send(Encoder* encoder, bool persist, const Socket& socket)
       }
 
       if (outgoing.count(socket) > 0) {
-        outgoing[socket].push(encoder);
+        outgoing[socket].push_back(encoder);
         encoder = nullptr;
       } else {
         // Initialize the outgoing queue.
@@ -2216,7 +2831,7 @@ void SocketManager::send(Message* message, const SocketImpl::Kind& kind)
       }
 
       if (outgoing.count(socket.get()) > 0) {
-        outgoing[socket.get()].push(new MessageEncoder(message));
+        outgoing[socket.get()].push_back(new MessageEncoder(message));
         return;
       } else {
         // Initialize the outgoing queue.
@@ -2291,11 +2906,58 @@ Encoder* SocketManager::next(int s)
     if (sockets.count(s) > 0) {
       CHECK(outgoing.count(s) > 0);
 
-      if (!outgoing[s].empty()) {
+      deque<Encoder*>& encoders = outgoing[s];
+
+      if (!encoders.empty()) {
         // More messages!
-        Encoder* encoder = outgoing[s].front();
-        outgoing[s].pop();
-        return encoder;
+        Encoder* encoder = encoders.front();
+        encoders.pop_front();
+
+        // Combine the data encoders that follow into a single one, as
+        // long as they fit into the batch. Without batching, every
+        // message is sent with separate writes.
+        if (encoder->kind() != Encoder::DATA) {
+          return encoder;
+        }
+
+        size_t size = encoder->remaining();
+        size_t count = 0;
+
+        foreach (Encoder* next, encoders) {
+          if (next->kind() != Encoder::DATA ||
+              size + next->remaining() > batch) {
+            break;
+          }
+
+          size += next->remaining();
+          count++;
+        }
+
+        if (count == 0) {
+          return encoder;
+        }
+
+        string data;
+        data.reserve(size);
+
+        for (size_t i = 0; i <= count; i++) {
+          if (i > 0) {
+            encoder = encoders.front();
+            encoders.pop_front();
+          }
+
+          DataEncoder* next = static_cast<DataEncoder*>(encoder);
+
+          while (next->remaining() > 0) {
+            size_t length;
+            const char* bytes = next->next(&length);
+            data.append(bytes, length);
+          }
+
+          delete encoder;
+        }
+
+        return new DataEncoder(std::move(data));
       } else {
         // No more messages ... erase the outgoing queue.
         outgoing.erase(s);
@@ -2368,7 +3030,7 @@ void SocketManager::close(int s)
         while (!outgoing[s].empty()) {
           Encoder* encoder = outgoing[s].front();
           delete encoder;
-          outgoing[s].pop();
+          outgoing[s].pop_front();
         }
 
         outgoing.erase(s);
@@ -2454,17 +3116,24 @@ void SocketManager::exited(const Address& address)
   // into ProcessManager ... then we wouldn't have to convince
   // ourselves that the accesses to each Process object will always be
   // valid.
-  synchronized (mutex) {
+  //
+  // NOTE: This is called from `close()` with 'mutex' held already.
+  synchronized (links_mutex) {
     if (!links.remotes.contains(address)) {
       return; // No linkees for this socket address!
     }
 
+    // The exited events of each linker, which are enqueued at once
+    // since a linker is often linked to many processes at an address
+    // (e.g., the master to all executors on an agent).
+    hashmap<ProcessBase*, vector<Event*>> events;
+
     foreach (const UPID& linkee, links.remotes[address]) {
-      // Find and notify the linkers.
+      // Find the linkers to notify.
       CHECK(links.linkers.contains(linkee));
 
       foreach (ProcessBase* linker, links.linkers[linkee]) {
-        linker->enqueue(new ExitedEvent(linkee));
+        events[linker].push_back(new ExitedEvent(linkee));
 
         // Remove the linkee pid from the linker.
         CHECK(links.linkees.contains(linker));
@@ -2479,6 +3148,13 @@ void SocketManager::exited(const Address& address)
     }
 
     links.remotes.erase(address);
+
+    // NOTE: The linkers are notified while holding 'links_mutex' so
+    // that they can not exit (and be deleted) in the meantime, see
+    // `exited(ProcessBase*)`.
+    foreachpair (ProcessBase* linker, const vector<Event*>& _events, events) {
+      linker->enqueue(_events);
+    }
   }
 }
 
@@ -2495,7 +3171,7 @@ void SocketManager::exited(ProcessBase* process)
   // can update the clocks of linked processes as appropriate.
   const Time time = Clock::now(process);
 
-  synchronized (mutex) {
+  synchronized (links_mutex) {
     // If this process had linked to anything, we need to clean
     // up any pointers to it. Also, if this process was the last
     // linker to a remote linkee, we must remove linkee from the
@@ -2547,6 +3223,38 @@ void SocketManager::exited(ProcessBase* process)
 }
 
 
+Future<Response> SocketManager::__sockets__(const Request&)
+{
+  JSON::Array array;
+
+  synchronized (mutex) {
+    foreachpair (int s, const deque<Encoder*>& encoders, outgoing) {
+      JSON::Object object;
+      object.values["socket"] = s;
+
+      Option<Address> address = addresses.get(s);
+      if (address.isSome()) {
+        object.values["address"] = stringify(address.get());
+      }
+
+      // NOTE: This excludes the encoder that is currently being sent,
+      // which is not queued anymore.
+      size_t bytes = 0;
+      foreach (const Encoder* encoder, encoders) {
+        bytes += encoder->remaining();
+      }
+
+      object.values["queued_encoders"] = encoders.size();
+      object.values["queued_bytes"] = bytes;
+
+      array.values.push_back(object);
+    }
+  }
+
+  return OK(array);
+}
+
+
 void SocketManager::swap_implementing_socket(
     const Socket& from, const Socket& to)
 {
@@ -2602,12 +3310,17 @@ void SocketManager::swap_implementing_socket(
 
 ProcessManager::ProcessManager(const Option<string>& _delegate)
   : delegate(_delegate),
-    running(0),
+    runnable(0),
     joining_threads(false),
     finalizing(false) {}
 
 
-ProcessManager::~ProcessManager() {}
+ProcessManager::~ProcessManager()
+{
+  foreach (RunQueue* runq, runqs) {
+    delete runq;
+  }
+}
 
 
 void ProcessManager::finalize()
@@ -2723,10 +3436,19 @@ long ProcessManager::init_threads()
 
   threads.reserve(num_worker_threads + 1);
 
+  // Create the run queues before any of the processing threads, since
+  // every processing thread may steal from every run queue.
+  runqs.reserve(num_worker_threads);
+  for (long i = 0; i < num_worker_threads; i++) {
+    runqs.push_back(new RunQueue());
+  }
+
   struct
   {
-    void operator()() const
+    void operator()(long worker) const
     {
+      __worker__ = worker;
+
       do {
         ProcessBase* process = process_manager->dequeue();
         if (process == nullptr) {
@@ -2759,7 +3481,7 @@ long ProcessManager::init_threads()
   // Create processing threads.
   for (long i = 0; i < num_worker_threads; i++) {
     // Retain the thread handles so that we can join when shutting down.
-    threads.emplace_back(new std::thread(worker));
+    threads.emplace_back(new std::thread(worker, i));
   }
 
   // Create a thread for the event loop.
@@ -2771,18 +3493,40 @@ long ProcessManager::init_threads()
 
 ProcessReference ProcessManager::use(const UPID& pid)
 {
-  if (pid.address == __address__) {
-    synchronized (processes_mutex) {
-      if (processes.count(pid.id) > 0) {
-        // Note that the ProcessReference constructor _must_ get
-        // called while holding the lock on processes so that waiting
-        // for references is atomic (i.e., race free).
-        return ProcessReference(processes[pid.id]);
-      }
+  if (pid.address != __address__) {
+    return ProcessReference();
+  }
+
+  // Use the reference of the process if the PID carries one, which
+  // avoids the lookup (and the lock). Locking the reference fails
+  // once the process is being cleaned up. Since the members of a PID
+  // can be changed after it got copied from the process, we only use
+  // the reference if the PID still has the ID of the process, and
+  // look the process up otherwise.
+  if (pid.reference.isSome()) {
+    std::shared_ptr<ProcessBase*> reference = pid.reference->lock();
+    if (!reference) {
+      return ProcessReference();
+    }
+
+    if ((*reference)->pid.id == pid.id) {
+      return ProcessReference(std::move(reference));
     }
   }
 
-  return ProcessReference(nullptr);
+  synchronized (processes_mutex) {
+    Option<ProcessBase*> process = processes.get(pid.id);
+    if (process.isSome()) {
+      // Note that the reference _must_ get copied while holding the
+      // lock on processes so that waiting for references is atomic
+      // (i.e., race free). It is reset once the process is being
+      // cleaned up.
+      return ProcessReference(
+          std::shared_ptr<ProcessBase*>(process.get()->reference));
+    }
+  }
+
+  return ProcessReference();
 }
 
 
@@ -2794,13 +3538,13 @@ void ProcessManager::handle(
 
   // Check if this is a libprocess request (i.e., 'User-Agent:
   // libprocess/id@ip:port') and if so, parse as a message.
-  if (libprocess(request)) {
+  if (libprocess(*request)) {
     // It is guaranteed that the continuation would run before the next
     // request arrives. Also, it's fine to pass the `this` pointer to the
     // continuation as this would get executed synchronously (if still pending)
     // from `SocketManager::finalize()` due to it closing all active sockets
     // during libprocess finalization.
-    parse(*request)
+    parse(request)
       .onAny([this, socket, request](const Future<Message*>& future) {
         // Get the HttpProxy pid for this socket.
         PID<HttpProxy> proxy = socket_manager->proxy(socket);
@@ -2883,22 +3627,30 @@ void ProcessManager::handle(
     return;
   }
 
-  // Split the path by '/'.
-  vector<string> tokens = strings::tokenize(request->url.path, "/");
+  // The first component of the path is the id of the receiver.
+  const string& path = request->url.path;
+  const size_t begin = path.find_first_not_of('/');
 
   // Try and determine a receiver, otherwise try and delegate.
   UPID receiver;
 
-  if (tokens.size() == 0 && delegate.isSome()) {
+  if (begin == string::npos && delegate.isSome()) {
     request->url.path = "/" + delegate.get();
     receiver = UPID(delegate.get(), __address__);
-  } else if (tokens.size() > 0) {
+  } else if (begin != string::npos) {
+    const string id =
+      path.substr(begin, std::min(path.find('/', begin), path.size()) - begin);
+
     // Decode possible percent-encoded path.
-    Try<string> decode = http::decode(tokens[0]);
-    if (!decode.isError()) {
-      receiver = UPID(decode.get(), __address__);
+    if (id.find_first_of("%+") == string::npos) {
+      receiver = UPID(id, __address__);
     } else {
-      VLOG(1) << "Failed to decode URL path: " << decode.error();
+      Try<string> decode = http::decode(id);
+      if (!decode.isError()) {
+        receiver = UPID(decode.get(), __address__);
+      } else {
+        VLOG(1) << "Failed to decode URL path: " << decode.error();
+      }
     }
   }
 
@@ -3035,6 +3787,13 @@ UPID ProcessManager::spawn(ProcessBase* process, bool manage)
       return UPID();
     } else {
       processes[process->pid.id] = process;
+
+      // NOTE: The reference is created here rather than when the
+      // process is constructed so that PIDs copied before the
+      // process got spawned don't carry a reference, and hence are
+      // looked up the same way as PIDs of remote processes.
+      process->reference = std::make_shared<ProcessBase*>(process);
+      process->pid.reference = process->reference;
     }
   }
 
@@ -3067,26 +3826,34 @@ void ProcessManager::resume(ProcessBase* process)
   bool terminate = false;
   bool blocked = false;
 
-  CHECK(process->state == ProcessBase::BOTTOM ||
-        process->state == ProcessBase::READY);
+  const ProcessBase::ProcessState state = process->state.load();
+
+  CHECK(state == ProcessBase::BOTTOM || state == ProcessBase::READY);
 
-  if (process->state == ProcessBase::BOTTOM) {
-    process->state = ProcessBase::RUNNING;
+  process->state.store(ProcessBase::RUNNING);
+
+  if (state == ProcessBase::BOTTOM) {
     try { process->initialize(); }
     catch (...) { terminate = true; }
   }
 
   while (!terminate && !blocked) {
-    Event* event = nullptr;
+    Event* event = process->dequeue();
 
-    synchronized (process->mutex) {
-      if (process->events.size() > 0) {
-        event = process->events.front();
-        process->events.pop_front();
-        process->state = ProcessBase::RUNNING;
-      } else {
-        process->state = ProcessBase::BLOCKED;
+    if (event == nullptr) {
+      // Block the process, unless an event was enqueued before the
+      // enqueueing thread could see that the process is blocked (in
+      // which case it would not have made the process runnable).
+      process->state.store(ProcessBase::BLOCKED);
+
+      if (process->events->empty()) {
         blocked = true;
+      } else {
+        // Keep running, unless the enqueueing thread has made the
+        // process runnable in the meantime.
+        ProcessBase::ProcessState expected = ProcessBase::BLOCKED;
+        blocked = !process->state.compare_exchange_strong(
+            expected, ProcessBase::RUNNING);
       }
     }
 
@@ -3136,6 +3903,21 @@ void ProcessManager::resume(ProcessBase* process)
       // Determine if we should terminate.
       terminate = event->is<TerminateEvent>();
 
+      size_t queued = 0;
+      int64_t started = 0;
+
+      if (process->statistics) {
+        // Include the event that is about to be served.
+        queued = 1;
+        foreach (const std::atomic_size_t& count, process->eventCounts) {
+          queued += count.load();
+        }
+
+        started = EventStatistics::now();
+      }
+
+      sampler::serving(process, *event);
+
       // Now service the event.
       try {
         process->serve(*event);
@@ -3150,6 +3932,16 @@ void ProcessManager::resume(ProcessBase* process)
         terminate = true;
       }
 
+      sampler::served();
+
+      if (process->statistics) {
+        process->statistics->record(
+            *event,
+            queued,
+            started - event->enqueued,
+            EventStatistics::now() - started);
+      }
+
       delete event;
 
       if (terminate) {
@@ -3160,8 +3952,8 @@ void ProcessManager::resume(ProcessBase* process)
 
   __process__ = nullptr;
 
-  CHECK_GE(running.load(), 1);
-  running.fetch_sub(1);
+  CHECK_GE(runnable.load(), 1);
+  runnable.fetch_sub(1);
 }
 
 
@@ -3179,18 +3971,11 @@ void ProcessManager::cleanup(ProcessBase* process)
   // the process we are cleaning up will get dropped (since it's
   // terminating) and eliminates the potential of enqueueing them on
   // another process that gets spawned with the same PID.
-  deque<Event*> events;
-
-  synchronized (process->mutex) {
-    process->state = ProcessBase::TERMINATING;
-    events = process->events;
-    process->events.clear();
-  }
+  process->state.store(ProcessBase::TERMINATING);
 
   // Delete pending events.
-  while (!events.empty()) {
-    Event* event = events.front();
-    events.pop_front();
+  Event* event = nullptr;
+  while ((event = process->dequeue()) != nullptr) {
     delete event;
   }
 
@@ -3200,32 +3985,46 @@ void ProcessManager::cleanup(ProcessBase* process)
   // Possible gate non-libprocess threads are waiting at.
   Gate* gate = nullptr;
 
+  // Events that were still being enqueued above.
+  deque<Event*> events;
+
   // Remove process.
   synchronized (processes_mutex) {
-    // Wait for all process references to get cleaned up.
-    while (process->refs.load() > 0) {
+    // Reset the reference of the process so that no more references
+    // can be obtained, neither from the PIDs carrying a reference nor
+    // by looking up the process (see `ProcessManager::use`).
+    std::weak_ptr<ProcessBase*> reference = process->reference;
+    process->reference.reset();
+
+    // Wait for all process references to get cleaned up, and for the
+    // threads that were enqueueing an event while we deleted the
+    // pending events, so that the events they enqueued can be found.
+    // Threads that enqueue after this see that we are terminating.
+    while (!reference.expired() || process->enqueuers.load() > 0) {
 #if defined(__i386__) || defined(__x86_64__)
       asm ("pause");
 #endif
     }
 
-    synchronized (process->mutex) {
-      CHECK(process->events.empty());
+    while ((event = process->dequeue()) != nullptr) {
+      events.push_back(event);
+    }
 
-      processes.erase(process->pid.id);
+    CHECK(process->events->empty());
 
-      // Lookup gate to wake up waiting threads.
-      map<ProcessBase*, Gate*>::iterator it = gates.find(process);
-      if (it != gates.end()) {
-        gate = it->second;
-        // N.B. The last thread that leaves the gate also free's it.
-        gates.erase(it);
-      }
+    processes.erase(process->pid.id);
 
-      CHECK(process->refs.load() == 0);
-      process->state = ProcessBase::TERMINATED;
+    // Lookup gate to wake up waiting threads.
+    map<ProcessBase*, Gate*>::iterator it = gates.find(process);
+    if (it != gates.end()) {
+      gate = it->second;
+      // N.B. The last thread that leaves the gate also free's it.
+      gates.erase(it);
     }
 
+    CHECK(reference.expired());
+    process->state.store(ProcessBase::TERMINATED);
+
     // Note that we don't remove the process from the clock during
     // cleanup, but rather the clock is reset for a process when it is
     // created (see ProcessBase::ProcessBase). We do this so that
@@ -3263,6 +4062,10 @@ void ProcessManager::cleanup(ProcessBase* process)
       gate->open();
     }
   }
+
+  foreach (Event* event, events) {
+    delete event;
+  }
 }
 
 
@@ -3341,23 +4144,18 @@ bool ProcessManager::wait(const UPID& pid)
       // Check if it is runnable in order to donate this thread.
       if (process->state == ProcessBase::BOTTOM ||
           process->state == ProcessBase::READY) {
-        synchronized (runq_mutex) {
-          list<ProcessBase*>::iterator it =
-            find(runq.begin(), runq.end(), process);
-          if (it != runq.end()) {
-            // Found it! Remove it from the run queue since we'll be
-            // donating our thread and also increment 'running' before
-            // leaving this 'runq' protected critical section so that
-            // everyone that is waiting for the processes to settle
-            // continue to wait (otherwise they could see nothing in
-            // 'runq' and 'running' equal to 0 between when we exit
-            // this critical section and increment 'running').
-            runq.erase(it);
-            running.fetch_add(1);
-          } else {
-            // Another thread has resumed the process ...
-            process = nullptr;
-          }
+        // Remove it from the run queue since we'll be donating our
+        // thread. Note that it remains counted in 'runnable', so that
+        // everyone that is waiting for the processes to settle
+        // continues to wait.
+        bool removed = runq.remove(process);
+        for (size_t i = 0; !removed && i < runqs.size(); i++) {
+          removed = runqs[i]->remove(process);
+        }
+
+        if (!removed) {
+          // Another thread has resumed the process ...
+          process = nullptr;
         }
       } else {
         // Process is not runnable, so no need to donate ...
@@ -3444,14 +4242,18 @@ void ProcessManager::enqueue(ProcessBase* process)
     return;
   }
 
-  // TODO(benh): Check and see if this process has its own thread. If
-  // it does, push it on that threads runq, and wake up that thread if
-  // it's not running. Otherwise, check and see which thread this
-  // process was last running on, and put it on that threads runq.
+  // Count the process before it can be dequeued, in order to support
+  // the Clock::settle() operation.
+  runnable.fetch_add(1);
+
+  // Processes made runnable by a processing thread are added to the
+  // run queue of that thread.
+  RunQueue* target = __worker__ >= 0 ? runqs[__worker__] : &runq;
 
-  synchronized (runq_mutex) {
-    CHECK(find(runq.begin(), runq.end(), process) == runq.end());
-    runq.push_back(process);
+  synchronized (target->mutex) {
+    CHECK(find(target->processes.begin(), target->processes.end(), process) ==
+          target->processes.end());
+    target->processes.push_back(process);
   }
 
   // Wake up the processing thread if necessary.
@@ -3459,22 +4261,29 @@ void ProcessManager::enqueue(ProcessBase* process)
 }
 
 
-ProcessBase* ProcessManager::dequeue()
+bool ProcessManager::RunQueue::remove(ProcessBase* process)
 {
-  // TODO(benh): Remove a process from this thread's runq. If there
-  // are no processes to run, and this is not a dedicated thread, then
-  // steal one from another threads runq.
+  synchronized (mutex) {
+    deque<ProcessBase*>::iterator it =
+      find(processes.begin(), processes.end(), process);
+    if (it != processes.end()) {
+      processes.erase(it);
+      return true;
+    }
+  }
+
+  return false;
+}
 
+
+ProcessBase* ProcessManager::dequeue(RunQueue* runq)
+{
   ProcessBase* process = nullptr;
 
-  synchronized (runq_mutex) {
-    if (!runq.empty()) {
-      process = runq.front();
-      runq.pop_front();
-      // Increment the running count of processes in order to support
-      // the Clock::settle() operation (this must be done atomically
-      // with removing the process from the runq).
-      running.fetch_add(1);
+  synchronized (runq->mutex) {
+    if (!runq->processes.empty()) {
+      process = runq->processes.front();
+      runq->processes.pop_front();
     }
   }
 
@@ -3482,27 +4291,58 @@ ProcessBase* ProcessManager::dequeue()
 }
 
 
+ProcessBase* ProcessManager::dequeue()
+{
+  CHECK_GE(__worker__, 0);
+
+  ProcessBase* process = nullptr;
+
+  // Check the shared run queue first every so often, so that the
+  // processes made runnable by the event loop are not starved by
+  // processing threads that keep making each other runnable.
+  if (++__dequeued__ % 61 == 0) {
+    process = dequeue(&runq);
+  }
+
+  if (process == nullptr) {
+    process = dequeue(runqs[__worker__]);
+  }
+
+  if (process == nullptr) {
+    process = dequeue(&runq);
+  }
+
+  // Steal from the other processing threads, starting with the next
+  // one so that the threads do not all steal from the same queue.
+  for (size_t i = 1; process == nullptr && i < runqs.size(); i++) {
+    process = dequeue(runqs[(__worker__ + i) % runqs.size()]);
+  }
+
+  return process;
+}
+
+
 void ProcessManager::settle()
 {
   bool done = true;
   do {
     done = true; // Assume to start that we are settled.
 
-    synchronized (runq_mutex) {
-      if (!runq.empty()) {
-        done = false;
-        continue;
-      }
+    if (runnable.load() > 0) {
+      done = false;
+      continue;
+    }
 
-      if (running.load() > 0) {
-        done = false;
-        continue;
-      }
+    if (!Clock::settled()) {
+      done = false;
+      continue;
+    }
 
-      if (!Clock::settled()) {
-        done = false;
-        continue;
-      }
+    // The timers that expired before the clock settled may have made
+    // processes runnable, check again now that they are done.
+    if (runnable.load() > 0) {
+      done = false;
+      continue;
     }
   } while (!done);
 }
@@ -3517,72 +4357,49 @@ Future<Response> ProcessManager::__processes__(const Request&)
       JSON::Object object;
       object.values["id"] = process->pid.id;
 
-      JSON::Array events;
-
-      struct JSONVisitor : EventVisitor
-      {
-        explicit JSONVisitor(JSON::Array* _events) : events(_events) {}
-
-        virtual void visit(const MessageEvent& event)
-        {
-          JSON::Object object;
-          object.values["type"] = "MESSAGE";
-
-          const Message& message = *event.message;
+      // NOTE: The events can only be inspected by the thread running
+      // the process, so we list the events by type, using the number
+      // of events of each type that are currently queued.
+      const pair<size_t, string> types[] = {
+        {ProcessBase::eventType<MessageEvent>(), "MESSAGE"},
+        {ProcessBase::eventType<HttpEvent>(), "HTTP"},
+        {ProcessBase::eventType<DispatchEvent>(), "DISPATCH"},
+        {ProcessBase::eventType<ExitedEvent>(), "EXITED"},
+        {ProcessBase::eventType<TerminateEvent>(), "TERMINATE"},
+      };
 
-          object.values["name"] = message.name;
-          object.values["from"] = string(message.from);
-          object.values["to"] = string(message.to);
-          object.values["body"] = message.body;
-
-          events->values.push_back(object);
-        }
-
-        virtual void visit(const HttpEvent& event)
-        {
-          JSON::Object object;
-          object.values["type"] = "HTTP";
-
-          const Request& request = *event.request;
+      JSON::Array events;
 
-          object.values["method"] = request.method;
-          object.values["url"] = stringify(request.url);
+      foreach (const auto& type, types) {
+        const size_t count = process->eventCounts[type.first].load();
 
-          events->values.push_back(object);
+        for (size_t i = 0; i < count; i++) {
+          JSON::Object event;
+          event.values["type"] = type.second;
+          events.values.push_back(event);
         }
+      }
 
-        virtual void visit(const DispatchEvent& event)
-        {
-          JSON::Object object;
-          object.values["type"] = "DISPATCH";
-          events->values.push_back(object);
-        }
+      object.values["events"] = events;
+      array.values.push_back(object);
+    }
+  }
 
-        virtual void visit(const ExitedEvent& event)
-        {
-          JSON::Object object;
-          object.values["type"] = "EXITED";
-          events->values.push_back(object);
-        }
+  return OK(array);
+}
 
-        virtual void visit(const TerminateEvent& event)
-        {
-          JSON::Object object;
-          object.values["type"] = "TERMINATE";
-          events->values.push_back(object);
-        }
 
-        JSON::Array* events;
-      } visitor(&events);
+Future<Response> ProcessManager::__event_statistics__(const Request&)
+{
+  JSON::Array array;
 
-      synchronized (process->mutex) {
-        foreach (Event* event, process->events) {
-          event->visit(&visitor);
-        }
+  synchronized (processes_mutex) {
+    foreachvalue (ProcessBase* process, process_manager->processes) {
+      if (process->statistics) {
+        JSON::Object object = process->statistics->json();
+        object.values["id"] = process->pid.id;
+        array.values.push_back(object);
       }
-
-      object.values["events"] = events;
-      array.values.push_back(object);
     }
   }
 
@@ -3596,7 +4413,17 @@ ProcessBase::ProcessBase(const string& id)
 
   state = ProcessBase::BOTTOM;
 
-  refs = 0;
+  events.reset(new EventQueue());
+
+  foreach (std::atomic_size_t& count, eventCounts) {
+    count.store(0);
+  }
+
+  if (event_statistics) {
+    statistics.reset(new EventStatistics());
+  }
+
+  enqueuers = 0;
 
   pid.id = id != "" ? id : ID::generate();
   pid.address = __address__;
@@ -3613,30 +4440,132 @@ ProcessBase::ProcessBase(const string& id)
 ProcessBase::~ProcessBase() {}
 
 
+size_t ProcessBase::eventType(const Event& event)
+{
+  struct TypeVisitor : EventVisitor
+  {
+    virtual void visit(const MessageEvent&)
+    {
+      type = ProcessBase::eventType<MessageEvent>();
+    }
+
+    virtual void visit(const DispatchEvent&)
+    {
+      type = ProcessBase::eventType<DispatchEvent>();
+    }
+
+    virtual void visit(const HttpEvent&)
+    {
+      type = ProcessBase::eventType<HttpEvent>();
+    }
+
+    virtual void visit(const ExitedEvent&)
+    {
+      type = ProcessBase::eventType<ExitedEvent>();
+    }
+
+    virtual void visit(const TerminateEvent&)
+    {
+      type = ProcessBase::eventType<TerminateEvent>();
+    }
+
+    size_t type = 0;
+  } visitor;
+
+  event.visit(&visitor);
+
+  return visitor.type;
+}
+
+
 void ProcessBase::enqueue(Event* event, bool inject)
 {
   CHECK(event != nullptr);
 
-  synchronized (mutex) {
-    if (state != TERMINATING && state != TERMINATED) {
-      if (!inject) {
-        events.push_back(event);
-      } else {
-        events.push_front(event);
+  // Announce the enqueue so that the process is not cleaned up before
+  // the event can be found (see `ProcessManager::cleanup`).
+  enqueuers.fetch_add(1);
+
+  const ProcessState current = state.load();
+  if (current != TERMINATING && current != TERMINATED) {
+    eventCounts[eventType(*event)].fetch_add(1);
+
+    if (statistics) {
+      event->enqueued = EventStatistics::now();
+    }
+
+    if (!inject) {
+      events->enqueue(event);
+    } else {
+      events->inject(event);
+    }
+
+    // Make the process runnable if it is blocked. Otherwise it is
+    // either runnable already, or the thread running it will dequeue
+    // the event.
+    ProcessState expected = BLOCKED;
+    if (state.compare_exchange_strong(expected, READY)) {
+      process_manager->enqueue(this);
+    }
+  } else {
+    delete event;
+  }
+
+  enqueuers.fetch_sub(1);
+}
+
+
+void ProcessBase::enqueue(const vector<Event*>& _events)
+{
+  if (_events.empty()) {
+    return;
+  }
+
+  enqueuers.fetch_add(1);
+
+  const ProcessState current = state.load();
+  if (current != TERMINATING && current != TERMINATED) {
+    const int64_t enqueued = statistics ? EventStatistics::now() : 0;
+
+    for (size_t i = 0; i < _events.size(); i++) {
+      Event* event = CHECK_NOTNULL(_events[i]);
+
+      eventCounts[eventType(*event)].fetch_add(1);
+
+      if (statistics) {
+        event->enqueued = enqueued;
       }
 
-      if (state == BLOCKED) {
-        state = READY;
-        process_manager->enqueue(this);
+      if (i + 1 < _events.size()) {
+        event->next.store(_events[i + 1]);
       }
+    }
 
-      CHECK(state == BOTTOM ||
-            state == READY ||
-            state == RUNNING);
-    } else {
+    events->enqueue(_events.front(), _events.back());
+
+    ProcessState expected = BLOCKED;
+    if (state.compare_exchange_strong(expected, READY)) {
+      process_manager->enqueue(this);
+    }
+  } else {
+    foreach (Event* event, _events) {
       delete event;
     }
   }
+
+  enqueuers.fetch_sub(1);
+}
+
+
+Event* ProcessBase::dequeue()
+{
+  Event* event = events->dequeue();
+
+  if (event != nullptr) {
+    eventCounts[eventType(*event)].fetch_sub(1);
+  }
+
+  return event;
 }
 
 
@@ -3688,7 +4617,7 @@ void ProcessBase::visit(const MessageEvent& event)
 
 void ProcessBase::visit(const DispatchEvent& event)
 {
-  (*event.f)(this);
+  event.invoke(this);
 }
 
 
@@ -3707,32 +4636,26 @@ void ProcessBase::visit(const HttpEvent& event)
 
   CHECK(path.find('/') == 0); // See ProcessManager::handle.
 
-  // Split the path by '/'.
-  vector<string> tokens = strings::tokenize(path, "/");
-  CHECK(!tokens.empty());
-
-  const string id = http::decode(tokens[0]).get();
-  CHECK_EQ(pid.id, id);
-
-  // First look to see if there is an HTTP handler that can handle the
-  // longest prefix of this path.
-
-  // Remove the `id` prefix from the path.
-  string name = strings::remove(
-      event.request->url.path, "/" + tokens[0], strings::PREFIX);
-  name = strings::trim(name, strings::PREFIX, "/");
-
-  // Look for an endpoint handler for this path. We begin with the full path,
-  // but if no handler is found and the path is nested, we shorten it and look
-  // again. For example: if the request is for '/a/b/c' and no handler is found,
-  // we will then check for '/a/b', and finally for '/a'.
-  while (Path(name).dirname() != name) {
-    if (handlers.http.count(name) == 0) {
-      name = Path(name).dirname();
-      continue;
-    }
+  // The path is the (possibly percent-encoded) id of this process
+  // followed by the path of the endpoint, find both without copying.
+  const size_t begin = path.find_first_not_of('/');
+  CHECK_NE(string::npos, begin);
+
+  const size_t end = std::min(path.find('/', begin), path.size());
+  DCHECK_EQ(pid.id, http::decode(path.substr(begin, end - begin)).get());
+
+  const size_t start = std::min(path.find_first_not_of('/', end), path.size());
+
+  // Look for the endpoint handler of the longest prefix of this path.
+  // For example: if the request is for '/a/b/c' and no handler is
+  // found, we check for '/a/b', and finally for '/a'.
+  const RouteTrie<HttpEndpoint>::Route* route = handlers.http.get() != nullptr
+    ? handlers.http->match(path.data() + start, path.size() - start)
+    : nullptr;
 
-    const HttpEndpoint& endpoint = handlers.http[name];
+  if (route != nullptr) {
+    const HttpEndpoint& endpoint = route->value;
+    const string& name = route->name;
 
     Owned<Request> request(new Request(*event.request));
     Future<Response> response;
@@ -3768,7 +4691,8 @@ void ProcessBase::visit(const HttpEvent& event)
   event.request->reader->readAll();
 
   // If no HTTP handler is found look in assets.
-  name = tokens.size() > 1 ? tokens[1] : "";
+  vector<string> tokens = strings::tokenize(path, "/");
+  const string name = tokens.size() > 1 ? tokens[1] : "";
 
   if (assets.count(name) > 0) {
     OK response;
@@ -3917,7 +4841,11 @@ void ProcessBase::route(
   endpoint.handler = handler;
   endpoint.options = options;
 
-  handlers.http[name.substr(1)] = endpoint;
+  if (handlers.http.get() == nullptr) {
+    handlers.http.reset(new RouteTrie<HttpEndpoint>());
+  }
+
+  handlers.http->add(name.substr(1), endpoint);
 
   dispatch(help, &Help::add, pid.id, name, help_);
 }
@@ -3938,7 +4866,11 @@ void ProcessBase::route(
   endpoint.authenticatedHandler = handler;
   endpoint.options = options;
 
-  handlers.http[name.substr(1)] = endpoint;
+  if (handlers.http.get() == nullptr) {
+    handlers.http.reset(new RouteTrie<HttpEndpoint>());
+  }
+
+  handlers.http->add(name.substr(1), endpoint);
 
   dispatch(help, &Help::add, pid.id, name, help_);
 }
@@ -4091,15 +5023,11 @@ bool exited(const UPID& from, const UPID& to)
 
 namespace internal {
 
-void dispatch(
-    const UPID& pid,
-    const std::shared_ptr<lambda::function<void(ProcessBase*)>>& f,
-    const Option<const std::type_info*>& functionType)
+void dispatch(DispatchEvent* event)
 {
   process::initialize();
 
-  DispatchEvent* event = new DispatchEvent(pid, f, functionType);
-  process_manager->deliver(pid, event, __process__);
+  process_manager->deliver(event->pid, event, __process__);
 }
 
 } // namespace internal {
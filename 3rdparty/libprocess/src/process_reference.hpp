@@ -13,82 +13,43 @@
 #ifndef __PROCESS_REFERENCE_HPP__
 #define __PROCESS_REFERENCE_HPP__
 
+#include <memory>
+
 #include <process/process.hpp>
 
 namespace process {
 
-// Provides reference counting semantics for a process pointer.
+// Provides reference counting semantics for a process pointer. The
+// references to a process share the `ProcessBase::reference` of the
+// process, so `ProcessManager::cleanup` can wait for all of them to
+// be released once it has reset that reference.
 class ProcessReference
 {
 public:
-  ProcessReference() : process(nullptr) {}
-
-  ~ProcessReference()
-  {
-    cleanup();
-  }
-
-  ProcessReference(const ProcessReference& that)
-  {
-    copy(that);
-  }
-
-  ProcessReference& operator=(const ProcessReference& that)
-  {
-    if (this != &that) {
-      cleanup();
-      copy(that);
-    }
-    return *this;
-  }
+  ProcessReference() = default;
 
   ProcessBase* operator->() const
   {
-    return process;
+    return *reference;
   }
 
   operator ProcessBase*() const
   {
-    return process;
+    return reference ? *reference : nullptr;
   }
 
   operator bool() const
   {
-    return process != nullptr;
+    return reference != nullptr;
   }
 
 private:
   friend class ProcessManager; // For ProcessManager::use.
 
-  explicit ProcessReference(ProcessBase* _process)
-    : process(_process)
-  {
-    if (process != nullptr) {
-      process->refs.fetch_add(1);
-    }
-  }
-
-  void copy(const ProcessReference& that)
-  {
-    process = that.process;
-
-    if (process != nullptr) {
-      // There should be at least one reference to the process, so
-      // we don't need to worry about checking if it's exiting or
-      // not, since we know we can always create another reference.
-      CHECK(process->refs.load() > 0);
-      process->refs.fetch_add(1);
-    }
-  }
-
-  void cleanup()
-  {
-    if (process != nullptr) {
-      process->refs.fetch_sub(1);
-    }
-  }
+  explicit ProcessReference(std::shared_ptr<ProcessBase*>&& _reference)
+    : reference(std::move(_reference)) {}
 
-  ProcessBase* process;
+  std::shared_ptr<ProcessBase*> reference;
 };
 
 } // namespace process {
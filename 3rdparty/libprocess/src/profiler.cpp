@@ -18,18 +18,31 @@
 #include <gperftools/profiler.h>
 #endif
 
+#include "process/defer.hpp"
 #include "process/future.hpp"
 #include "process/help.hpp"
 #include "process/http.hpp"
 #include "process/profiler.hpp"
 
+#include "stout/duration.hpp"
 #include "stout/format.hpp"
 #include "stout/option.hpp"
 #include "stout/os.hpp"
+#include "stout/stringify.hpp"
+#include "stout/try.hpp"
 #include "stout/os/strerror.hpp"
 
+#include "sampler.hpp"
+
 namespace process {
 
+namespace {
+// The interval at which `/profiler/flamegraph` samples, and the longest
+// duration that it samples for.
+const Duration SAMPLING_INTERVAL = Milliseconds(10);
+const Duration MAX_SAMPLING_DURATION = Minutes(5);
+} // namespace {
+
 #ifdef ENABLE_GPERFTOOLS
 namespace {
 constexpr char PROFILE_FILE[] = "perftools.out";
@@ -58,6 +71,33 @@ const std::string Profiler::STOP_HELP()
 }
 
 
+const std::string Profiler::FLAMEGRAPH_HELP()
+{
+  return HELP(
+    TLDR(
+        "Samples which processes are running, for flame graphs."),
+    DESCRIPTION(
+        "Samples which process, and which handler of the process, each",
+        "worker thread is running every " + stringify(SAMPLING_INTERVAL) +
+        " for the requested",
+        "duration, and returns the number of samples of each handler in",
+        "the \"folded stacks\" format of flame graph tools (one",
+        "`<process>;<handler> <count>` line per handler).",
+        "",
+        "Messages are reported by name, HTTP requests by path and",
+        "dispatches by the type of the dispatched method. Unlike",
+        "`/profiler/start`, this does not require perftools and can be",
+        "used at any time, as the overhead of sampling is low.",
+        "",
+        "Query parameters:",
+        "",
+        ">        duration=VALUE       Duration to sample for, at most " +
+        stringify(MAX_SAMPLING_DURATION),
+        ">                             (e.g., 10secs, 1mins, etc.)"),
+    AUTHENTICATION(true));
+}
+
+
 Future<http::Response> Profiler::start(
     const http::Request& request,
     const Option<std::string>& /* principal */)
@@ -132,4 +172,45 @@ Future<http::Response> Profiler::stop(
 #endif
 }
 
+
+
+Future<http::Response> Profiler::flamegraph(
+    const http::Request& request,
+    const Option<std::string>& /* principal */)
+{
+  Option<std::string> duration = request.url.query.get("duration");
+
+  if (duration.isNone()) {
+    return http::BadRequest("Expecting 'duration=value' in query.\n");
+  }
+
+  Try<Duration> d = Duration::parse(duration.get());
+
+  if (d.isError()) {
+    return http::BadRequest(d.error() + ".\n");
+  }
+
+  if (d.get() <= Duration::zero() || d.get() > MAX_SAMPLING_DURATION) {
+    return http::BadRequest(
+        "Invalid duration '" + duration.get() + "', expecting at most " +
+        stringify(MAX_SAMPLING_DURATION) + ".\n");
+  }
+
+  if (sampling) {
+    return http::BadRequest("Profiler already sampling.\n");
+  }
+
+  LOG(INFO) << "Sampling for " << d.get();
+
+  sampling = true;
+
+  return sampler::sample(d.get(), SAMPLING_INTERVAL)
+    .onAny(defer(self(), [this](const Future<std::string>&) {
+      sampling = false;
+    }))
+    .then([](const std::string& folded) -> http::Response {
+      return http::OK(folded, "text/plain");
+    });
+}
+
 } // namespace process {
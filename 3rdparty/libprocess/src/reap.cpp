@@ -13,13 +13,18 @@
 #include <glog/logging.h>
 
 #include <sys/types.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
 #ifndef __WINDOWS__
 #include <sys/wait.h>
 #endif
 
+#include <process/defer.hpp>
 #include <process/delay.hpp>
 #include <process/future.hpp>
 #include <process/id.hpp>
+#include <process/io.hpp>
 #include <process/once.hpp>
 #include <process/owned.hpp>
 #include <process/reap.hpp>
@@ -33,12 +38,20 @@
 #include <stout/result.hpp>
 #include <stout/try.hpp>
 
+// The number of the 'pidfd_open' system call (added in Linux 5.3)
+// is the same on all architectures, except alpha, but it might not
+// be known to older headers.
+#if defined(__linux__) && !defined(SYS_pidfd_open) && !defined(__alpha__)
+#define SYS_pidfd_open 434
+#endif
+
 namespace process {
 
 
-// TODO(bmahler): This can be optimized to use a thread per pid, where
-// each thread makes a blocking call to waitpid. This eliminates the
-// unfortunate poll delay.
+// NOTE: Children are watched with a pidfd where supported (see
+// `ReaperProcess::watch`), in which case they are reaped as soon as
+// they exit. The remaining pids (i.e., non-children and children on
+// older kernels) are polled, using a
 //
 // Simple bounded linear model for computing the poll interval.
 // Values were chosen such that at (50 pids, 100 ms) the CPU usage is
@@ -72,6 +85,11 @@ Future<Option<int>> ReaperProcess::reap(pid_t pid)
   if (os::exists(pid)) {
     Owned<Promise<Option<int>>> promise(new Promise<Option<int>>());
     promises.put(pid, promise);
+
+    if (!pidfds.contains(pid)) {
+      watch(pid);
+    }
+
     return promise->future();
   } else {
     return None();
@@ -98,6 +116,11 @@ void ReaperProcess::wait()
   // between waitpid and the (!exists) conditional it will still exist as a
   // zombie; it will be reaped by us on the next loop.
   foreach (pid_t pid, promises.keys()) {
+    // Watched children are reaped once they exit, see `exited`.
+    if (pidfds.contains(pid)) {
+      continue;
+    }
+
     int status;
     Result<pid_t> child_pid = os::waitpid(pid, &status, WNOHANG);
     if (child_pid.isSome()) {
@@ -128,9 +151,66 @@ void ReaperProcess::notify(pid_t pid, Result<int> status)
 }
 
 
+void ReaperProcess::watch(pid_t pid)
+{
+#if defined(__linux__) && defined(SYS_pidfd_open)
+  // Only children can be watched, since a pidfd becomes readable
+  // when the process exits rather than when it gets reaped, which is
+  // when we notify for a non-child. We use `waitid` with `WNOWAIT`
+  // to check for a child without reaping it.
+  siginfo_t info;
+  if (::waitid(P_PID, pid, &info, WEXITED | WNOHANG | WNOWAIT) != 0) {
+    return;
+  }
+
+  // NOTE: A pidfd is always close-on-exec.
+  int fd = ::syscall(SYS_pidfd_open, pid, 0);
+  if (fd < 0) {
+    return;
+  }
+
+  pidfds[pid] = fd;
+
+  io::poll(fd, io::READ)
+    .onAny(defer(self(), &ReaperProcess::exited, pid, lambda::_1));
+#endif // __linux__
+}
+
+
+void ReaperProcess::exited(pid_t pid, const Future<short>& poll)
+{
+  Option<int> fd = pidfds.get(pid);
+  CHECK_SOME(fd);
+
+  pidfds.erase(pid);
+  os::close(fd.get());
+
+  // Fall back to polling if the pidfd could not be polled.
+  if (!poll.isReady()) {
+    VLOG(1) << "Failed to poll the pidfd of child " << pid << ": "
+            << (poll.isFailed() ? poll.failure() : "discarded")
+            << "; falling back to polling the child";
+    return;
+  }
+
+  int status;
+  Result<pid_t> child_pid = os::waitpid(pid, &status, WNOHANG);
+  if (child_pid.isSome()) {
+    notify(pid, status);
+  } else if (!os::exists(pid)) {
+    // The child has been reaped by someone else (e.g., by a direct
+    // call to `waitpid`).
+    notify(pid, None());
+  }
+
+  // Otherwise, the child is polled from now on.
+}
+
+
 const Duration ReaperProcess::interval()
 {
-  size_t count = promises.size();
+  // Only the pids that are not watched are polled.
+  size_t count = promises.size() - pidfds.size();
 
   if (count <= LOW_PID_COUNT) {
     return MIN_REAP_INTERVAL();
@@ -0,0 +1,188 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License
+
+#ifndef __ROUTE_TRIE_HPP__
+#define __ROUTE_TRIE_HPP__
+
+#include <string.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace process {
+
+// Maps routes (e.g., "a/b" for the endpoint "/id/a/b" of a process)
+// to values, and finds the longest route that is a prefix of a path
+// without any allocations.
+//
+// A route matches a path if it is either equal to the path, or if it
+// does not end with a '/' and is followed in the path by a '/' and
+// then by more than just slashes. For example, the route "a/b"
+// matches the paths "a/b", "a/b/c" and "a/b//c", but neither "a/bc"
+// nor "a/b/", and the route "a/" only matches "a/". This is how
+// `ProcessBase` has looked up routes by repeatedly taking the dirname
+// of the path, which strips trailing slashes along with the last
+// component.
+template <typename T>
+class RouteTrie
+{
+public:
+  struct Route
+  {
+    std::string name;
+    T value;
+  };
+
+  // Adds or replaces the route.
+  void add(const std::string& name, const T& value)
+  {
+    Node* node = &root;
+
+    size_t start = 0;
+    while (!name.empty()) {
+      const size_t end = std::min(name.find('/', start), name.size());
+
+      node = node->child(name.data() + start, end - start, true);
+
+      if (end == name.size()) {
+        break;
+      }
+
+      start = end + 1;
+    }
+
+    node->route.reset(new Route{name, value});
+  }
+
+  // Returns the longest route that matches the path, or nullptr if no
+  // route matches the path.
+  const Route* match(const char* path, size_t length) const
+  {
+    const Node* node = &root;
+
+    // The route of the empty path only matches the empty path.
+    if (length == 0) {
+      return root.route.get();
+    }
+
+    const Route* result = nullptr;
+
+    // The length of the path without trailing slashes, any shorter
+    // route must be followed by a '/' and something before it.
+    size_t trimmed = length;
+    while (trimmed > 0 && path[trimmed - 1] == '/') {
+      --trimmed;
+    }
+
+    size_t start = 0;
+    while (true) {
+      const char* slash =
+        static_cast<const char*>(memchr(path + start, '/', length - start));
+
+      const size_t end = slash != nullptr ? slash - path : length;
+
+      node = node->child(path + start, end - start);
+      if (node == nullptr) {
+        break;
+      }
+
+      // A route followed by a '/' only matches if it does not end with
+      // a '/' itself, i.e., if its last component is not empty, and if
+      // the rest of the path is not only slashes.
+      if (node->route &&
+          (end == length || (end > start && end + 1 < trimmed))) {
+        result = node->route.get();
+      }
+
+      if (end == length) {
+        break;
+      }
+
+      start = end + 1;
+    }
+
+    return result;
+  }
+
+  const Route* match(const std::string& path) const
+  {
+    return match(path.data(), path.size());
+  }
+
+private:
+  struct Node
+  {
+    // Returns the child for the component, creating it if requested.
+    Node* child(const char* component, size_t length, bool create)
+    {
+      auto it = find(component, length);
+
+      if (it != children.end() &&
+          it->first.size() == length &&
+          memcmp(it->first.data(), component, length) == 0) {
+        return it->second.get();
+      }
+
+      if (!create) {
+        return nullptr;
+      }
+
+      it = children.emplace(
+          it,
+          std::string(component, length),
+          std::unique_ptr<Node>(new Node()));
+
+      return it->second.get();
+    }
+
+    const Node* child(const char* component, size_t length) const
+    {
+      return const_cast<Node*>(this)->child(component, length, false);
+    }
+
+    typedef std::vector<std::pair<std::string, std::unique_ptr<Node>>>
+      Children;
+
+    // Returns the first child that is not less than the component.
+    typename Children::iterator find(const char* component, size_t length)
+    {
+      return std::lower_bound(
+          children.begin(),
+          children.end(),
+          std::make_pair(component, length),
+          [](const typename Children::value_type& child,
+             const std::pair<const char*, size_t>& component) {
+            const int result = memcmp(
+                child.first.data(),
+                component.first,
+                std::min(child.first.size(), component.second));
+
+            return result < 0 ||
+              (result == 0 && child.first.size() < component.second);
+          });
+    }
+
+    // The children, sorted by their component.
+    Children children;
+
+    std::unique_ptr<Route> route;
+  };
+
+  Node root;
+};
+
+} // namespace process {
+
+#endif // __ROUTE_TRIE_HPP__
@@ -0,0 +1,221 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License
+
+
+#include <stdint.h>
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <typeinfo>
+#include <vector>
+
+#include <process/event.hpp>
+#include <process/future.hpp>
+#include <process/process.hpp>
+
+#include <stout/duration.hpp>
+#include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/stringify.hpp>
+#include <stout/synchronized.hpp>
+#include <stout/thread_local.hpp>
+
+#include "event_statistics.hpp"
+#include "sampler.hpp"
+
+using std::string;
+using std::vector;
+
+namespace process {
+namespace sampler {
+
+namespace {
+
+// What a worker thread is running, as published by the thread.
+struct Slot
+{
+  std::mutex mutex;
+
+  // Whether the thread is serving an event.
+  bool busy = false;
+
+  string process;
+
+  // The handler of the event, or for dispatches the type of the
+  // dispatched method, whose name is only looked up when reporting.
+  string handler;
+  const std::type_info* dispatch = nullptr;
+};
+
+
+// The number of sampling sessions in progress.
+std::atomic<int> sessions(0);
+
+
+// The slots of the worker threads that have published what they are
+// running. There is one slot per worker thread, so the slots are never
+// removed; like `EventStatistics::global`, these are never deleted to
+// avoid destruction order issues at exit.
+std::mutex* slotsMutex = new std::mutex();
+vector<Slot*>* slots = new vector<Slot*>();
+
+
+// The slot of the current thread, and whether the current thread has
+// published that it is serving an event.
+THREAD_LOCAL Slot* slot = nullptr;
+THREAD_LOCAL bool published = false;
+
+} // namespace {
+
+
+void serving(const ProcessBase* process, const Event& event)
+{
+  if (sessions.load(std::memory_order_relaxed) == 0) {
+    return;
+  }
+
+  if (slot == nullptr) {
+    slot = new Slot();
+
+    synchronized (slotsMutex) {
+      slots->push_back(slot);
+    }
+  }
+
+  struct HandlerVisitor : EventVisitor
+  {
+    explicit HandlerVisitor(Slot* _slot) : slot(_slot) {}
+
+    virtual void visit(const MessageEvent& event)
+    {
+      slot->handler = event.message->name;
+    }
+
+    virtual void visit(const DispatchEvent& event)
+    {
+      slot->dispatch = event.functionType.getOrElse(nullptr);
+    }
+
+    virtual void visit(const HttpEvent& event)
+    {
+      slot->handler = "HTTP " + event.request->url.path;
+    }
+
+    virtual void visit(const ExitedEvent&)
+    {
+      slot->handler = "EXITED";
+    }
+
+    virtual void visit(const TerminateEvent&)
+    {
+      slot->handler = "TERMINATE";
+    }
+
+    Slot* slot;
+  } visitor(slot);
+
+  synchronized (slot->mutex) {
+    slot->busy = true;
+    slot->process = process->self().id;
+    slot->handler.clear();
+    slot->dispatch = nullptr;
+
+    event.visit(&visitor);
+  }
+
+  published = true;
+}
+
+
+void served()
+{
+  // NOTE: This does not depend on whether a session is in progress, so
+  // that a thread never remains busy once the session it published for
+  // has ended.
+  if (published) {
+    synchronized (slot->mutex) {
+      slot->busy = false;
+    }
+
+    published = false;
+  }
+}
+
+
+Future<string> sample(const Duration& duration, const Duration& interval)
+{
+  std::shared_ptr<Promise<string>> promise(new Promise<string>());
+  Future<string> future = promise->future();
+
+  ++sessions;
+
+  // NOTE: The sampling thread is detached, as it ends the session on
+  // its own and only refers to the slots, which are never deleted.
+  std::thread([=]() {
+    // The samples by process and handler, and of dispatches by process
+    // and method type.
+    std::map<string, uint64_t> samples;
+    hashmap<string, hashmap<const std::type_info*, uint64_t>> dispatches;
+
+    const std::chrono::steady_clock::time_point deadline =
+      std::chrono::steady_clock::now() +
+      std::chrono::nanoseconds(duration.ns());
+
+    while (std::chrono::steady_clock::now() < deadline) {
+      vector<Slot*> _slots;
+      synchronized (slotsMutex) {
+        _slots = *slots;
+      }
+
+      foreach (Slot* slot, _slots) {
+        synchronized (slot->mutex) {
+          if (slot->busy) {
+            if (!slot->handler.empty()) {
+              samples[slot->process + ";" + slot->handler]++;
+            } else {
+              dispatches[slot->process][slot->dispatch]++;
+            }
+          }
+        }
+      }
+
+      std::this_thread::sleep_for(std::chrono::nanoseconds(interval.ns()));
+    }
+
+    --sessions;
+
+    foreachkey (const string& process, dispatches) {
+      foreachpair (const std::type_info* type,
+                   uint64_t count,
+                   dispatches.at(process)) {
+        samples[process + ";" + demangle(type)] += count;
+      }
+    }
+
+    string folded;
+    foreachpair (const string& stack, uint64_t count, samples) {
+      folded += stack + " " + stringify(count) + "\n";
+    }
+
+    promise->set(folded);
+  }).detach();
+
+  return future;
+}
+
+} // namespace sampler {
+} // namespace process {
@@ -0,0 +1,56 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License
+
+
+#ifndef __SAMPLER_HPP__
+#define __SAMPLER_HPP__
+
+#include <string>
+
+#include <process/event.hpp>
+#include <process/future.hpp>
+#include <process/process.hpp>
+
+#include <stout/duration.hpp>
+
+namespace process {
+namespace sampler {
+
+// A sampling profiler that attributes the time of the worker threads
+// to the process, and the handler of the process, that they are
+// running (see `/profiler/flamegraph`).
+//
+// While a sampling session is in progress, each worker thread
+// publishes the process and the event it is serving, and a dedicated
+// thread samples what every worker thread is running at a fixed
+// interval. This does not depend on the worker threads, so processes
+// that keep all worker threads busy are still sampled correctly. When
+// no session is in progress, the worker threads only check whether
+// one is, which keeps the sampler always available.
+
+// Called by the worker thread running `process` before it serves the
+// event, and after it has served it.
+void serving(const ProcessBase* process, const Event& event);
+void served();
+
+
+// Samples the worker threads every `interval` for `duration`, and
+// returns the number of samples in which a worker thread was serving
+// each handler of each process, in the "folded stacks" format used by
+// flame graph tools: one `<process>;<handler> <count>` line per
+// handler. Samples of idle worker threads are not reported.
+Future<std::string> sample(const Duration& duration, const Duration& interval);
+
+} // namespace sampler {
+} // namespace process {
+
+#endif // __SAMPLER_HPP__
@@ -139,6 +139,13 @@ inline void signalHandler(int signal)
 #endif // __linux__
 
 
+Subprocess::ChildHook Subprocess::ChildHook::CALL(
+    const lambda::function<Try<Nothing>()>& f)
+{
+  return Subprocess::ChildHook(f);
+}
+
+
 Subprocess::ChildHook Subprocess::ChildHook::SUPERVISOR()
 {
   return Subprocess::ChildHook([]() -> Try<Nothing> {
@@ -24,16 +24,31 @@
 #include <vector>
 
 #include <process/collect.hpp>
+#include <process/dispatch.hpp>
 #include <process/future.hpp>
 #include <process/gmock.hpp>
 #include <process/gtest.hpp>
 #include <process/owned.hpp>
 #include <process/process.hpp>
+#include <process/subprocess.hpp>
+#include <process/time.hpp>
+#include <process/timeseries.hpp>
 
+#include <stout/base64.hpp>
+#include <stout/bytes.hpp>
 #include <stout/duration.hpp>
+#include <stout/flat_hashmap.hpp>
 #include <stout/gtest.hpp>
+#include <stout/hashmap.hpp>
 #include <stout/hashset.hpp>
+#include <stout/json.hpp>
+#include <stout/os.hpp>
+#include <stout/nothing.hpp>
+#include <stout/recordio.hpp>
 #include <stout/stopwatch.hpp>
+#include <stout/stringify.hpp>
+
+#include "route_trie.hpp"
 
 namespace http = process::http;
 
@@ -42,6 +57,10 @@ using process::Owned;
 using process::Process;
 using process::ProcessBase;
 using process::Promise;
+using process::RouteTrie;
+using process::Subprocess;
+using process::Time;
+using process::TimeSeries;
 using process::UPID;
 
 using std::cout;
@@ -51,6 +70,8 @@ using std::ostringstream;
 using std::string;
 using std::vector;
 
+using testing::WithParamInterface;
+
 int main(int argc, char** argv)
 {
   // Initialize Google Mock/Test.
@@ -369,3 +390,699 @@ TEST(ProcessTest, Process_BENCHMARK_LargeNumberOfLinks)
     delete process;
   }
 }
+
+
+// Measures how quickly the endpoint of an HTTP request is found
+// among routes like those installed by the master.
+TEST(ProcessTest, Process_BENCHMARK_Routing)
+{
+  const string routes[] = {
+    "api/v1",
+    "api/v1/scheduler",
+    "create-volumes",
+    "destroy-volumes",
+    "files/browse",
+    "files/browse.json",
+    "files/debug",
+    "files/download",
+    "files/read",
+    "flags",
+    "frameworks",
+    "health",
+    "machine/down",
+    "machine/up",
+    "maintenance/schedule",
+    "maintenance/status",
+    "quota",
+    "redirect",
+    "reserve",
+    "roles",
+    "slaves",
+    "snapshot",
+    "state",
+    "state-summary",
+    "tasks",
+    "teardown",
+    "unreserve",
+    "weights"
+  };
+
+  const string paths[] = {
+    "api/v1",
+    "api/v1/scheduler",
+    "files/download",
+    "maintenance/status",
+    "snapshot",
+    "state",
+    "state-summary",
+    "tasks",
+    "unknown/endpoint"
+  };
+
+  RouteTrie<size_t> trie;
+
+  size_t index = 0;
+  foreach (const string& route, routes) {
+    trie.add(route, index++);
+  }
+
+  const size_t iterations = 10000000;
+  const size_t count = sizeof(paths) / sizeof(paths[0]);
+
+  size_t matches = 0;
+
+  Stopwatch watch;
+  watch.start();
+
+  for (size_t i = 0; i < iterations; i++) {
+    if (trie.match(paths[i % count]) != nullptr) {
+      matches++;
+    }
+  }
+
+  watch.stop();
+
+  EXPECT_EQ(iterations - iterations / count, matches);
+
+  cout << "Matched " << iterations << " paths in " << watch.elapsed()
+       << " (" << iterations / watch.elapsed().secs() << " paths/sec)"
+       << endl;
+}
+
+
+class CounterProcess : public Process<CounterProcess>
+{
+public:
+  CounterProcess() : count(0) {}
+
+  void add(const string& value) { count += value.size(); }
+
+  size_t get() { return count; }
+
+private:
+  size_t count;
+};
+
+
+// Measures the throughput of dispatching to a process, including the
+// time until the process has run all of the dispatches.
+TEST(ProcessTest, Process_BENCHMARK_Dispatch)
+{
+  const size_t iterations = 1000000;
+
+  CounterProcess process;
+  process::PID<CounterProcess> pid = process::spawn(process);
+
+  const string value(100, 'x');
+
+  Stopwatch watch;
+  watch.start();
+
+  for (size_t i = 0; i < iterations; i++) {
+    process::dispatch(pid, &CounterProcess::add, value);
+  }
+
+  Future<size_t> count = process::dispatch(pid, &CounterProcess::get);
+
+  AWAIT_READY(count);
+
+  watch.stop();
+
+  EXPECT_EQ(iterations * value.size(), count.get());
+
+  cout << "Dispatched " << iterations << " methods in " << watch.elapsed()
+       << endl;
+
+  process::terminate(pid);
+  process::wait(pid);
+}
+
+
+// Measures the throughput of chaining continuations on futures that
+// are already ready, which is common when a continuation returns a
+// value that is immediately available.
+TEST(FutureTest, Future_BENCHMARK_Then)
+{
+  const size_t iterations = 1000000;
+
+  Stopwatch watch;
+  watch.start();
+
+  Future<size_t> future = 0;
+  for (size_t i = 0; i < iterations; i++) {
+    future = future.then([](size_t value) { return value + 1; });
+  }
+
+  watch.stop();
+
+  ASSERT_TRUE(future.isReady());
+  EXPECT_EQ(iterations, future.get());
+
+  cout << "Chained " << iterations << " continuations in "
+       << watch.elapsed() << endl;
+
+  // Now chain continuations that return futures onto pending futures
+  // and then complete them. We use short chains since completing a
+  // future runs its continuations recursively.
+  const size_t length = 100;
+
+  watch.start();
+
+  for (size_t i = 0; i < iterations / length; i++) {
+    Promise<size_t> promise;
+    future = promise.future();
+
+    for (size_t j = 0; j < length; j++) {
+      future = future.then([](size_t value) -> Future<size_t> {
+        return value + 1;
+      });
+    }
+
+    promise.set(0);
+
+    ASSERT_TRUE(future.isReady());
+    EXPECT_EQ(length, future.get());
+  }
+
+  watch.stop();
+
+  cout << "Chained and completed " << iterations
+       << " pending continuations in " << watch.elapsed() << endl;
+}
+
+
+// Measures the throughput of installing callbacks on futures that
+// are ready and on futures that become ready later.
+TEST(FutureTest, Future_BENCHMARK_OnAny)
+{
+  const size_t iterations = 1000000;
+
+  size_t count = 0;
+  auto callback = [&count](const Future<Nothing>&) { count++; };
+
+  Future<Nothing> ready = Nothing();
+
+  Stopwatch watch;
+  watch.start();
+
+  for (size_t i = 0; i < iterations; i++) {
+    ready.onAny(callback);
+  }
+
+  watch.stop();
+
+  EXPECT_EQ(iterations, count);
+
+  cout << "Installed " << iterations << " callbacks on a ready future in "
+       << watch.elapsed() << endl;
+
+  count = 0;
+
+  watch.start();
+
+  for (size_t i = 0; i < iterations; i++) {
+    Promise<Nothing> promise;
+    promise.future().onAny(callback);
+    promise.set(Nothing());
+  }
+
+  watch.stop();
+
+  EXPECT_EQ(iterations, count);
+
+  cout << "Installed " << iterations << " callbacks on pending futures in "
+       << watch.elapsed() << endl;
+}
+
+
+// Measures the throughput of collecting futures that are already
+// ready and futures that become ready later.
+TEST(FutureTest, Future_BENCHMARK_Collect)
+{
+  const size_t futures = 100;
+  const size_t iterations = 10000;
+
+  list<Future<size_t>> ready;
+  for (size_t i = 0; i < futures; i++) {
+    ready.push_back(i);
+  }
+
+  Stopwatch watch;
+  watch.start();
+
+  for (size_t i = 0; i < iterations; i++) {
+    Future<list<size_t>> collected = collect(ready);
+    ASSERT_TRUE(collected.isReady());
+  }
+
+  watch.stop();
+
+  cout << "Collected " << iterations << " lists of " << futures
+       << " ready futures in " << watch.elapsed() << endl;
+
+  watch.start();
+
+  for (size_t i = 0; i < iterations / 10; i++) {
+    vector<Promise<size_t>> promises(futures);
+
+    list<Future<size_t>> pending;
+    foreach (const Promise<size_t>& promise, promises) {
+      pending.push_back(promise.future());
+    }
+
+    Future<list<size_t>> collected = collect(pending);
+
+    foreach (Promise<size_t>& promise, promises) {
+      promise.set(0);
+    }
+
+    AWAIT_READY(collected);
+  }
+
+  watch.stop();
+
+  cout << "Collected " << iterations / 10 << " lists of " << futures
+       << " pending futures in " << watch.elapsed() << endl;
+}
+
+
+// Inserts, looks up and erases the given keys in a map of the given
+// type and prints how long each phase took.
+template <typename Map>
+static void benchmarkMap(const string& name, const vector<string>& keys)
+{
+  const size_t lookups = 10;
+
+  Map map;
+
+  Stopwatch watch;
+  watch.start();
+
+  foreach (const string& key, keys) {
+    map.put(key, key.size());
+  }
+
+  watch.stop();
+
+  cout << "Inserted " << keys.size() << " keys into a " << name << " in "
+       << watch.elapsed() << endl;
+
+  size_t found = 0;
+
+  watch.start();
+
+  for (size_t i = 0; i < lookups; i++) {
+    foreach (const string& key, keys) {
+      found += map.count(key);
+    }
+  }
+
+  watch.stop();
+
+  EXPECT_EQ(keys.size() * lookups, found);
+
+  cout << "Looked up " << keys.size() * lookups << " keys in a " << name
+       << " in " << watch.elapsed() << endl;
+
+  watch.start();
+
+  foreach (const string& key, keys) {
+    map.erase(key);
+  }
+
+  watch.stop();
+
+  EXPECT_TRUE(map.empty());
+
+  cout << "Erased " << keys.size() << " keys from a " << name << " in "
+       << watch.elapsed() << endl;
+}
+
+
+// Compares the node-based 'hashmap' with the open-addressing
+// 'flat_hashmap' for keys that look like the IDs the master and the
+// allocator index by (e.g., framework and agent IDs).
+TEST(HashMapTest, HashMap_BENCHMARK_StringKeys)
+{
+  const size_t count = 1000000;
+
+  vector<string> keys;
+  keys.reserve(count);
+  for (size_t i = 0; i < count; i++) {
+    keys.push_back("ab2f4c4e-1d3c-4abd-a5c3-0e5a5c3e0c2a-S" + stringify(i));
+  }
+
+  benchmarkMap<hashmap<string, size_t>>("hashmap", keys);
+  benchmarkMap<flat_hashmap<string, size_t>>("flat_hashmap", keys);
+}
+
+
+// Measures parsing a large JSON document that looks like the output
+// of the master's '/state' endpoint, i.e., many tasks with strings,
+// numbers and nested objects and arrays.
+TEST(JsonTest, JSON_BENCHMARK_Parse)
+{
+  const size_t tasks = 50000;
+  const size_t iterations = 10;
+
+  JSON::Array array;
+  for (size_t i = 0; i < tasks; i++) {
+    JSON::Object resources;
+    resources.values["cpus"] = 0.1;
+    resources.values["mem"] = 32;
+    resources.values["ports"] = "[31000-31001]";
+
+    JSON::Object status;
+    status.values["state"] = "TASK_RUNNING";
+    status.values["timestamp"] = 1478606393.12345;
+
+    JSON::Array statuses;
+    statuses.values.push_back(status);
+
+    JSON::Object task;
+    task.values["id"] = "task-" + stringify(i);
+    task.values["name"] = "Task \"" + stringify(i) + "\"";
+    task.values["framework_id"] = "ab2f4c4e-1d3c-4abd-a5c3-0e5a5c3e0c2a-0000";
+    task.values["slave_id"] = "ab2f4c4e-1d3c-4abd-a5c3-0e5a5c3e0c2a-S1";
+    task.values["state"] = "TASK_RUNNING";
+    task.values["resources"] = resources;
+    task.values["statuses"] = statuses;
+
+    array.values.push_back(task);
+  }
+
+  JSON::Object object;
+  object.values["tasks"] = array;
+
+  const string json = stringify(object);
+
+  Stopwatch watch;
+  watch.start();
+
+  for (size_t i = 0; i < iterations; i++) {
+    Try<JSON::Object> parse = JSON::parse<JSON::Object>(json);
+    ASSERT_SOME(parse);
+  }
+
+  watch.stop();
+
+  cout << "Parsed " << iterations << " JSON documents of "
+       << Bytes(json.size()) << " in " << watch.elapsed() << endl;
+}
+
+
+TEST(Base64Test, BASE64_BENCHMARK_EncodeDecode)
+{
+  const size_t iterations = 10;
+
+  string data;
+  while (data.size() < 16 * 1024 * 1024) {
+    data += static_cast<char>(rand());
+  }
+
+  Stopwatch watch;
+  watch.start();
+
+  string encoded;
+  for (size_t i = 0; i < iterations; i++) {
+    encoded = base64::encode(data);
+  }
+
+  watch.stop();
+
+  cout << "Encoded " << iterations << " times " << Bytes(data.size())
+       << " in " << watch.elapsed() << endl;
+
+  watch.start();
+
+  for (size_t i = 0; i < iterations; i++) {
+    Try<string> decoded = base64::decode(encoded);
+    ASSERT_SOME_EQ(data, decoded);
+  }
+
+  watch.stop();
+
+  cout << "Decoded " << iterations << " times " << Bytes(encoded.size())
+       << " in " << watch.elapsed() << endl;
+}
+
+
+// Measures encoding many small records, like the events of the
+// scheduler and executor HTTP APIs, both into a string per record
+// and into a reused buffer.
+TEST(RecordIOTest, RECORDIO_BENCHMARK_Encode)
+{
+  const size_t records = 1000000;
+
+  recordio::Encoder<string> encoder([](const string& record) {
+    return record;
+  });
+
+  const string record(100, 'x');
+
+  Stopwatch watch;
+  watch.start();
+
+  size_t size = 0;
+  for (size_t i = 0; i < records; i++) {
+    size += encoder.encode(record).size();
+  }
+
+  watch.stop();
+
+  cout << "Encoded " << records << " records into " << Bytes(size)
+       << " in " << watch.elapsed() << endl;
+
+  // Encode batches of records into the same buffer, as if each batch
+  // was written at once.
+  const size_t batch = 100;
+  string buffer;
+
+  watch.start();
+
+  for (size_t i = 0; i < records; i++) {
+    if (i % batch == 0) {
+      buffer.clear();
+    }
+    encoder.encode(record, &buffer);
+  }
+
+  watch.stop();
+
+  cout << "Encoded " << records << " records in batches of " << batch
+       << " into a reused buffer in " << watch.elapsed() << endl;
+}
+
+
+// Measures setting values in time series, as the metrics do when
+// their history is enabled: first across many series that stay within
+// their capacity, and then in a single series that is sparsified on
+// every set once its capacity is reached.
+TEST(TimeSeriesTest, TIMESERIES_BENCHMARK_Set)
+{
+  const size_t series = 10000;
+  const size_t values = 100;
+  const size_t sets = 1000000;
+
+  Time now = process::Clock::now();
+
+  vector<TimeSeries<double>> timeseries(series);
+
+  Stopwatch watch;
+  watch.start();
+
+  for (size_t i = 0; i < values; i++) {
+    foreach (TimeSeries<double>& timeseries_, timeseries) {
+      timeseries_.set(i, now + Seconds(i));
+    }
+  }
+
+  watch.stop();
+
+  cout << "Set " << values << " values in each of " << series
+       << " time series in " << watch.elapsed() << endl;
+
+  TimeSeries<double> sparsified;
+
+  watch.start();
+
+  for (size_t i = 0; i < sets; i++) {
+    sparsified.set(i, now + Milliseconds(i));
+  }
+
+  watch.stop();
+
+  cout << "Set " << sets << " values in a time series of capacity "
+       << process::TIME_SERIES_CAPACITY << " in " << watch.elapsed()
+       << endl;
+
+  watch.start();
+
+  size_t count = 0;
+  for (size_t i = 0; i < values; i++) {
+    count += sparsified.get().size();
+  }
+
+  watch.stop();
+
+  EXPECT_EQ(values * process::TIME_SERIES_CAPACITY, count);
+
+  cout << "Got the time series " << values << " times in "
+       << watch.elapsed() << endl;
+}
+
+
+// Measures how fast a parent with a large resident set launches
+// subprocesses, both when they get spawned and when they need to be
+// forked (i.e., when there is a parent hook).
+TEST(SubprocessTest, SUBPROCESS_BENCHMARK_Launch)
+{
+  const size_t subprocesses = 100;
+
+  const vector<Bytes> sizes = {Bytes(0), Megabytes(256), Gigabytes(1)};
+
+  foreach (const Bytes& size, sizes) {
+    // Touch the memory so that it is resident.
+    const string ballast(size.bytes(), 'x');
+
+    const vector<bool> forks = {false, true};
+
+    foreach (bool fork, forks) {
+      vector<Subprocess::ParentHook> hooks;
+      if (fork) {
+        hooks.push_back(Subprocess::ParentHook([](pid_t) {
+          return Nothing();
+        }));
+      }
+
+      list<Future<Option<int>>> statuses;
+
+      Stopwatch watch;
+      watch.start();
+
+      for (size_t i = 0; i < subprocesses; i++) {
+        Try<Subprocess> s = process::subprocess(
+            "true",
+            {"true"},
+            Subprocess::FD(STDIN_FILENO),
+            Subprocess::FD(STDOUT_FILENO),
+            Subprocess::FD(STDERR_FILENO),
+            nullptr,
+            None(),
+            None(),
+            hooks);
+
+        ASSERT_SOME(s);
+        statuses.push_back(s->status());
+      }
+
+      watch.stop();
+
+      AWAIT_READY(process::collect(statuses));
+
+      cout << (fork ? "Forked " : "Spawned ") << subprocesses
+           << " subprocesses from a parent with " << size
+           << " of ballast in " << watch.elapsed() << endl;
+    }
+  }
+}
+
+
+// A process that plays a game of ping pong with a peer, sending the
+// next ping as soon as it receives a pong.
+class PingPongProcess : public Process<PingPongProcess>
+{
+public:
+  PingPongProcess() : remaining(0) {}
+
+  virtual ~PingPongProcess() {}
+
+  Future<Nothing> run(const UPID& peer, size_t pings)
+  {
+    remaining = pings;
+    send(peer, "ping");
+    return promise.future();
+  }
+
+protected:
+  virtual void initialize()
+  {
+    install("ping", &PingPongProcess::ping);
+    install("pong", &PingPongProcess::pong);
+  }
+
+private:
+  void ping(const UPID& from, const string& body)
+  {
+    send(from, "pong");
+  }
+
+  void pong(const UPID& from, const string& body)
+  {
+    if (--remaining == 0) {
+      promise.set(Nothing());
+    } else {
+      send(from, "ping");
+    }
+  }
+
+  size_t remaining;
+  Promise<Nothing> promise;
+};
+
+
+class Process_BENCHMARK_Test : public ::testing::Test,
+                               public WithParamInterface<size_t> {};
+
+
+// Number of concurrent ping pong games.
+INSTANTIATE_TEST_CASE_P(
+    Games,
+    Process_BENCHMARK_Test,
+    ::testing::Values(1U, 4U, 16U, 64U, 256U));
+
+
+// Measures the local message throughput of many processes that make
+// each other runnable, which is bounded by how well the processing
+// threads scale. Run with a different LIBPROCESS_NUM_WORKER_THREADS
+// to see how the throughput changes with the number of threads.
+TEST_P(Process_BENCHMARK_Test, PingPong)
+{
+  const size_t games = GetParam();
+  const size_t pings = 100000;
+
+  vector<Owned<PingPongProcess>> processes;
+  for (size_t i = 0; i < games * 2; i++) {
+    processes.push_back(Owned<PingPongProcess>(new PingPongProcess()));
+    spawn(processes.back().get());
+  }
+
+  Stopwatch watch;
+  watch.start();
+
+  list<Future<Nothing>> futures;
+  for (size_t i = 0; i < games; i++) {
+    futures.push_back(dispatch(
+        processes[i * 2]->self(),
+        &PingPongProcess::run,
+        processes[i * 2 + 1]->self(),
+        pings));
+  }
+
+  AWAIT_READY_FOR(collect(futures), Minutes(5));
+
+  Duration elapsed = watch.elapsed();
+
+  // Each ping is followed by a pong.
+  double throughput = (games * pings * 2) / elapsed.secs();
+
+  cout << games << " games with "
+       << os::getenv("LIBPROCESS_NUM_WORKER_THREADS").getOrElse("default")
+       << " worker threads took " << elapsed << " ("
+       << throughput << " messages / sec)" << endl;
+
+  foreach (const Owned<PingPongProcess>& process, processes) {
+    terminate(*process);
+    wait(*process);
+  }
+}
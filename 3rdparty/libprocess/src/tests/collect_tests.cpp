@@ -59,6 +59,12 @@ TEST(CollectTest, Ready)
   // We expect them to be returned in the same order as the
   // future list that was passed in.
   EXPECT_EQ(values, collect.get());
+
+  // Collecting futures that are all ready completes immediately.
+  collect = process::collect(futures);
+
+  ASSERT_TRUE(collect.isReady());
+  EXPECT_EQ(values, collect.get());
 }
 
 
@@ -19,6 +19,9 @@
 #include <process/owned.hpp>
 
 #include <stout/gtest.hpp>
+#include <stout/gzip.hpp>
+#include <stout/stringify.hpp>
+#include <stout/try.hpp>
 
 #include "decoder.hpp"
 
@@ -134,6 +137,116 @@ TYPED_TEST(RequestDecoderTest, HeaderCaseInsensitive)
 }
 
 
+// Tests that requests are decoded correctly if each call to `decode`
+// only provides a single byte.
+TYPED_TEST(RequestDecoderTest, Incremental)
+{
+  TypeParam decoder;
+
+  const string data =
+    "POST /path/file.json?key=value HTTP/1.1\r\n"
+    "Host: localhost\r\n"
+    "Content-Length: 4\r\n"
+    "\r\n"
+    "body";
+
+  deque<http::Request*> requests;
+  foreach (char c, data) {
+    // Copy each byte so that it doesn't outlive the call to `decode`.
+    Owned<char> byte(new char(c));
+
+    foreach (http::Request* request, decoder.decode(byte.get(), 1)) {
+      requests.push_back(request);
+    }
+
+    ASSERT_FALSE(decoder.failed());
+  }
+
+  ASSERT_EQ(1u, requests.size());
+
+  Owned<http::Request> request(requests[0]);
+  EXPECT_EQ("POST", request->method);
+  EXPECT_EQ("/path/file.json", request->url.path);
+  EXPECT_SOME_EQ("value", request->url.query.get("key"));
+
+  EXPECT_EQ(2u, request->headers.size());
+  EXPECT_SOME_EQ("localhost", request->headers.get("Host"));
+  EXPECT_SOME_EQ("4", request->headers.get("Content-Length"));
+}
+
+
+// Tests that the streaming decoder returns requests it is asked to
+// buffer once their body has been decoded.
+TEST(DecoderTest, StreamingRequestBuffered)
+{
+  StreamingRequestDecoder decoder([](const http::Request& request) {
+    return request.method == "POST";
+  });
+
+  const string data =
+    "POST /path HTTP/1.1\r\n"
+    "Content-Length: 4\r\n"
+    "\r\n"
+    "bo";
+
+  deque<http::Request*> requests = decoder.decode(data.data(), data.length());
+  ASSERT_FALSE(decoder.failed());
+  EXPECT_TRUE(requests.empty());
+
+  const string rest =
+    "dy"
+    "GET /path HTTP/1.1\r\n"
+    "\r\n";
+
+  requests = decoder.decode(rest.data(), rest.length());
+  ASSERT_FALSE(decoder.failed());
+  ASSERT_EQ(2u, requests.size());
+
+  Owned<http::Request> request(requests[0]);
+  EXPECT_EQ("POST", request->method);
+  EXPECT_EQ(http::Request::BODY, request->type);
+  EXPECT_EQ("body", request->body);
+  EXPECT_NONE(request->reader);
+
+  // Requests that are not buffered are still streamed.
+  request.reset(requests[1]);
+  EXPECT_EQ("GET", request->method);
+  EXPECT_EQ(http::Request::PIPE, request->type);
+  ASSERT_SOME(request->reader);
+  AWAIT_EXPECT_EQ(string(""), request->reader->readAll());
+}
+
+
+// Tests that gzip compressed request bodies are decompressed and
+// that 'Content-Length' reflects the decompressed body.
+TEST(DecoderTest, CompressedRequest)
+{
+  DataDecoder decoder;
+
+  const string body(4096, 'a');
+
+  Try<string> compressed = gzip::compress(body);
+  ASSERT_SOME(compressed);
+
+  const string data =
+    "POST /path HTTP/1.1\r\n"
+    "Content-Encoding: gzip\r\n"
+    "Content-Length: " + stringify(compressed->length()) + "\r\n"
+    "\r\n" +
+    compressed.get();
+
+  deque<http::Request*> requests = decoder.decode(data.data(), data.length());
+  ASSERT_FALSE(decoder.failed());
+  ASSERT_EQ(1u, requests.size());
+
+  Owned<http::Request> request(requests[0]);
+  EXPECT_EQ(body, request->body);
+  EXPECT_SOME_EQ(
+      stringify(body.length()),
+      request->headers.get("Content-Length"));
+}
+
+
 TEST(DecoderTest, Response)
 {
   ResponseDecoder decoder;
@@ -12,15 +12,20 @@
 
 #include <gmock/gmock.h>
 
+#include <algorithm>
 #include <deque>
 #include <string>
 #include <vector>
 
 #include <process/http.hpp>
+#include <process/message.hpp>
 #include <process/owned.hpp>
+#include <process/pid.hpp>
 #include <process/socket.hpp>
 
+#include <stout/foreach.hpp>
 #include <stout/gtest.hpp>
+#include <stout/hashmap.hpp>
 
 #include "encoder.hpp"
 #include "decoder.hpp"
@@ -28,7 +33,10 @@
 namespace http = process::http;
 
 using process::HttpResponseEncoder;
+using process::Message;
+using process::MessageEncoder;
 using process::Owned;
+using process::UPID;
 using process::ResponseDecoder;
 
 using std::deque;
@@ -69,6 +77,77 @@ TEST(EncoderTest, Response)
 }
 
 
+// Tests that large responses are compressed with the encoding the
+// request accepts, preferring gzip over deflate.
+TEST(EncoderTest, CompressedResponse)
+{
+  const http::OK response(string(4096, 'a'));
+
+  hashmap<string, string> encodings = {
+    {"gzip", "gzip"},
+    {"deflate", "deflate"},
+    {"deflate, gzip", "gzip"},
+    {"gzip;q=0.0, deflate", "deflate"}
+  };
+
+  foreachpair (const string& accept, const string& encoding, encodings) {
+    http::Request request;
+    request.headers["Accept-Encoding"] = accept;
+
+    const string encoded = HttpResponseEncoder::encode(response, request);
+
+    // The decoder decompresses the body.
+    ResponseDecoder decoder;
+    deque<http::Response*> responses =
+      decoder.decode(encoded.data(), encoded.length());
+
+    ASSERT_FALSE(decoder.failed());
+    ASSERT_EQ(1u, responses.size());
+
+    Owned<http::Response> decoded(responses[0]);
+    EXPECT_EQ(response.body, decoded->body);
+    EXPECT_SOME_EQ(
+        stringify(response.body.length()),
+        decoded->headers.get("Content-Length"));
+    EXPECT_SOME_EQ(encoding, decoded->headers.get("Content-Encoding"))
+      << "For 'Accept-Encoding: " << accept << "'";
+  }
+}
+
+
+// Tests that a message encoder produces the same data as the encoded
+// message, even when the data is only partially sent each time.
+TEST(EncoderTest, Message)
+{
+  foreach (size_t size, vector<size_t>({0, 16, 64 * 1024})) {
+    Message message;
+    message.name = "name";
+    message.from = UPID("from@127.0.0.1:5050");
+    message.to = UPID("to@127.0.0.1:5051");
+    message.body = string(size, 'a');
+
+    const string expected = MessageEncoder::encode(&message);
+
+    MessageEncoder encoder(new Message(message));
+    EXPECT_EQ(expected.size(), encoder.remaining());
+
+    string encoded;
+    while (encoder.remaining() > 0) {
+      size_t length;
+      const char* data = encoder.next(&length);
+      ASSERT_LT(0u, length);
+
+      // Only "send" up to 1000 bytes at a time.
+      const size_t sent = std::min<size_t>(length, 1000);
+      encoded.append(data, sent);
+      encoder.backup(length - sent);
+    }
+
+    EXPECT_EQ(expected, encoded) << "For a body of " << size << " bytes";
+  }
+}
+
+
 TEST(EncoderTest, AcceptableEncodings)
 {
   // Create requests that do not accept gzip encoding.
@@ -0,0 +1,276 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License
+
+#include <pthread.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sys/socket.h>
+
+#include <gmock/gmock.h>
+
+#include <string>
+#include <thread>
+
+#include <process/future.hpp>
+#include <process/gtest.hpp>
+#include <process/io.hpp>
+
+#include <stout/gtest.hpp>
+#include <stout/nothing.hpp>
+#include <stout/os.hpp>
+#include <stout/try.hpp>
+
+#include <stout/tests/utils.hpp>
+
+#include "epoll.hpp"
+#include "event_loop.hpp"
+
+namespace io = process::io;
+
+using process::EventLoop;
+using process::Future;
+using process::Promise;
+using process::Reactor;
+
+using std::string;
+
+
+// Runs a reactor of its own on a separate thread, so that the tests
+// do not depend on (or interfere with) the reactors of the event loop.
+class EpollTest : public TemporaryDirectoryTest
+{
+protected:
+  virtual void SetUp()
+  {
+    TemporaryDirectoryTest::SetUp();
+
+    thread = std::thread(&Reactor::run, &reactor);
+  }
+
+  virtual void TearDown()
+  {
+    reactor.stop();
+    thread.join();
+
+    TemporaryDirectoryTest::TearDown();
+  }
+
+  Reactor reactor;
+  std::thread thread;
+};
+
+
+TEST_F(EpollTest, Poll)
+{
+  int pipes[2];
+  ASSERT_NE(-1, ::pipe(pipes));
+  ASSERT_SOME(os::nonblock(pipes[0]));
+  ASSERT_SOME(os::nonblock(pipes[1]));
+
+  // A pipe with room is writable right away, but not readable.
+  AWAIT_EXPECT_EQ(io::WRITE, reactor.poll(pipes[1], io::WRITE));
+
+  Future<short> read = reactor.poll(pipes[0], io::READ);
+  EXPECT_TRUE(read.isPending());
+
+  ASSERT_EQ(1, ::write(pipes[1], "x", 1));
+  AWAIT_EXPECT_EQ(io::READ, read);
+
+  // Only the polls for the events that happened are completed.
+  int sockets[2];
+  ASSERT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM, 0, sockets));
+  ASSERT_SOME(os::nonblock(sockets[0]));
+
+  read = reactor.poll(sockets[0], io::READ);
+  Future<short> write = reactor.poll(sockets[0], io::WRITE);
+
+  AWAIT_EXPECT_EQ(io::WRITE, write);
+  EXPECT_TRUE(read.isPending());
+
+  ASSERT_EQ(1, ::write(sockets[1], "x", 1));
+  AWAIT_EXPECT_EQ(io::READ, read);
+
+  ASSERT_SOME(os::close(sockets[0]));
+  ASSERT_SOME(os::close(sockets[1]));
+  ASSERT_SOME(os::close(pipes[0]));
+  ASSERT_SOME(os::close(pipes[1]));
+}
+
+
+// Tests that a discarded poll is no longer completed, while the other
+// polls of the same file descriptor still are.
+TEST_F(EpollTest, Discard)
+{
+  int pipes[2];
+  ASSERT_NE(-1, ::pipe(pipes));
+  ASSERT_SOME(os::nonblock(pipes[0]));
+  ASSERT_SOME(os::nonblock(pipes[1]));
+
+  Future<short> discarded = reactor.poll(pipes[0], io::READ);
+  Future<short> read = reactor.poll(pipes[0], io::READ);
+
+  discarded.discard();
+  AWAIT_DISCARDED(discarded);
+  EXPECT_TRUE(read.isPending());
+
+  ASSERT_EQ(1, ::write(pipes[1], "x", 1));
+  AWAIT_EXPECT_EQ(io::READ, read);
+
+  // Discarding a completed poll does nothing.
+  read.discard();
+  EXPECT_TRUE(read.isReady());
+
+  ASSERT_SOME(os::close(pipes[0]));
+  ASSERT_SOME(os::close(pipes[1]));
+}
+
+
+// Tests that a file descriptor number can be polled again after the
+// file descriptor was closed while it was being polled, which removes
+// it from epoll without the reactor knowing.
+TEST_F(EpollTest, ReusedFileDescriptor)
+{
+  int pipes[2];
+  ASSERT_NE(-1, ::pipe(pipes));
+  ASSERT_SOME(os::nonblock(pipes[0]));
+  ASSERT_SOME(os::nonblock(pipes[1]));
+
+  Future<short> stale = reactor.poll(pipes[0], io::READ);
+  EXPECT_TRUE(stale.isPending());
+
+  const int fd = pipes[0];
+
+  ASSERT_SOME(os::close(pipes[0]));
+  ASSERT_SOME(os::close(pipes[1]));
+
+  // Make `fd` refer to the read end of a new pipe.
+  ASSERT_NE(-1, ::pipe(pipes));
+  ASSERT_NE(fd, pipes[1]);
+  ASSERT_EQ(fd, ::dup2(pipes[0], fd));
+  ASSERT_SOME(os::nonblock(fd));
+  ASSERT_SOME(os::nonblock(pipes[1]));
+
+  // The new poll uses the same events as the stale one, which the
+  // reactor believes are still registered.
+  Future<short> read = reactor.poll(fd, io::READ);
+
+  ASSERT_EQ(1, ::write(pipes[1], "x", 1));
+
+  // The poll of the new file descriptor completes. So does the stale
+  // one, since it is a poll of the same number, and its owner finds
+  // out what happened when doing the I/O.
+  AWAIT_EXPECT_EQ(io::READ, read);
+  AWAIT_READY(stale);
+
+  if (pipes[0] != fd) {
+    ASSERT_SOME(os::close(fd));
+  }
+
+  ASSERT_SOME(os::close(pipes[0]));
+  ASSERT_SOME(os::close(pipes[1]));
+}
+
+
+// Tests that files that can not be polled with epoll, such as regular
+// files, are reported to be ready right away.
+TEST_F(EpollTest, RegularFile)
+{
+  ASSERT_SOME(os::write("file", "data"));
+
+  Try<int> fd = os::open("file", O_RDONLY | O_CLOEXEC);
+  ASSERT_SOME(fd);
+
+  AWAIT_EXPECT_EQ(io::READ, reactor.poll(fd.get(), io::READ));
+
+  ASSERT_SOME(os::close(fd.get()));
+}
+
+
+// Tests that the delayed functions are invoked by the reactor once
+// their deadline is reached, earliest deadline first.
+TEST_F(EpollTest, Delay)
+{
+  Promise<Nothing> first;
+  Promise<Nothing> second;
+
+  const double now = EventLoop::time();
+
+  reactor.delay(now + 0.05, [&first, &second]() {
+    EXPECT_TRUE(first.future().isReady());
+    second.set(Nothing());
+  });
+
+  reactor.delay(now + 0.01, [&first]() {
+    first.set(Nothing());
+  });
+
+  AWAIT_READY(first.future());
+  AWAIT_READY(second.future());
+
+  EXPECT_LE(now + 0.05, EventLoop::time());
+}
+
+
+// Does nothing, but makes `epoll_wait()` fail with `EINTR` on the
+// thread that the signal is delivered to (since it is installed
+// without `SA_RESTART`).
+static void interrupted(int) {}
+
+
+// Tests that the reactor keeps waiting for events when `epoll_wait()`
+// fails with `EINTR`.
+TEST_F(EpollTest, Interrupted)
+{
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = interrupted;
+  sigemptyset(&action.sa_mask);
+
+  struct sigaction previous;
+  ASSERT_EQ(0, sigaction(SIGUSR1, &action, &previous));
+
+  int pipes[2];
+  ASSERT_NE(-1, ::pipe(pipes));
+  ASSERT_SOME(os::nonblock(pipes[0]));
+  ASSERT_SOME(os::nonblock(pipes[1]));
+
+  for (int i = 0; i < 10; i++) {
+    Future<short> read = reactor.poll(pipes[0], io::READ);
+
+    // Interrupt the reactor while it waits for the pipe, and while it
+    // waits for a timer.
+    Promise<Nothing> timer;
+    reactor.delay(EventLoop::time() + 0.01, [&timer]() {
+      timer.set(Nothing());
+    });
+
+    ASSERT_EQ(0, pthread_kill(thread.native_handle(), SIGUSR1));
+    os::sleep(Milliseconds(1));
+    ASSERT_EQ(0, pthread_kill(thread.native_handle(), SIGUSR1));
+
+    EXPECT_TRUE(read.isPending());
+
+    ASSERT_EQ(1, ::write(pipes[1], "x", 1));
+    AWAIT_EXPECT_EQ(io::READ, read);
+    AWAIT_READY(timer.future());
+
+    char data;
+    ASSERT_EQ(1, ::read(pipes[0], &data, 1));
+  }
+
+  ASSERT_EQ(0, sigaction(SIGUSR1, &previous, nullptr));
+
+  ASSERT_SOME(os::close(pipes[0]));
+  ASSERT_SOME(os::close(pipes[1]));
+}
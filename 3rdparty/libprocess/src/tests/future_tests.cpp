@@ -19,7 +19,11 @@
 #include <process/gtest.hpp>
 
 #include <stout/duration.hpp>
+#include <stout/gtest.hpp>
+#include <stout/none.hpp>
 #include <stout/nothing.hpp>
+#include <stout/option.hpp>
+#include <stout/stringify.hpp>
 #include <stout/try.hpp>
 
 using process::Clock;
@@ -131,6 +135,40 @@ TEST(FutureTest, Then)
 }
 
 
+// Checks that continuations of completed futures are invoked
+// immediately and that discards still propagate to the future
+// returned by the continuation.
+TEST(FutureTest, ThenCompleted)
+{
+  Future<int> ready = 42;
+
+  Future<string> future = ready
+    .then([](int i) { return stringify(i); });
+
+  ASSERT_TRUE(future.isReady());
+  EXPECT_EQ("42", future.get());
+
+  Future<int> failed = Failure("Failure");
+
+  future = failed
+    .then([](int i) { return stringify(i); });
+
+  ASSERT_TRUE(future.isFailed());
+  EXPECT_EQ("Failure", future.failure());
+
+  Promise<string> promise;
+
+  future = ready
+    .then([&promise](int) { return promise.future(); });
+
+  ASSERT_TRUE(future.isPending());
+
+  future.discard();
+
+  EXPECT_TRUE(promise.future().hasDiscard());
+}
+
+
 Future<int> repair(const Future<int>& future)
 {
   EXPECT_TRUE(future.isFailed());
@@ -538,6 +576,22 @@ TEST(FutureTest, FromTry)
 }
 
 
+// Checks that a future constructed from a value convertible to `T`
+// holds the converted value, e.g., `None` for a `Future<Option<T>>`.
+TEST(FutureTest, FromConvertible)
+{
+  Future<Option<int>> future = None();
+
+  ASSERT_TRUE(future.isReady());
+  EXPECT_NONE(future.get());
+
+  future = Some(1);
+
+  ASSERT_TRUE(future.isReady());
+  EXPECT_SOME_EQ(1, future.get());
+}
+
+
 TEST(FutureTest, ArrowOperator)
 {
   Future<string> s = string("hello");
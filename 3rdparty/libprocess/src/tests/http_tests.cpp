@@ -564,6 +564,85 @@ TEST_P(HTTPTest, PipeReaderCloses)
 }
 
 
+TEST(HTTPTest, PipeCompress)
+{
+  {
+    http::Pipe pipe;
+    http::Pipe::Writer writer = pipe.writer();
+
+    http::Pipe::Reader reader = http::streaming::compress(pipe.reader());
+
+    // Each chunk can be decompressed as soon as it is written.
+    gzip::Decompressor decompressor;
+
+    EXPECT_TRUE(writer.write("hello"));
+
+    Future<string> chunk = reader.read();
+    AWAIT_READY(chunk);
+    EXPECT_SOME_EQ("hello", decompressor.decompress(chunk.get()));
+
+    EXPECT_TRUE(writer.write("world"));
+
+    chunk = reader.read();
+    AWAIT_READY(chunk);
+    EXPECT_SOME_EQ("world", decompressor.decompress(chunk.get()));
+
+    EXPECT_FALSE(decompressor.finished());
+
+    EXPECT_TRUE(writer.close());
+
+    chunk = reader.readAll();
+    AWAIT_READY(chunk);
+    EXPECT_SOME_EQ("", decompressor.decompress(chunk.get()));
+
+    EXPECT_TRUE(decompressor.finished());
+  }
+
+  {
+    http::Pipe pipe;
+    http::Pipe::Writer writer = pipe.writer();
+
+    http::Pipe::Reader reader = http::streaming::decompress(
+        http::streaming::compress(pipe.reader(), gzip::Format::ZLIB),
+        gzip::Format::ZLIB);
+
+    Future<string> readAll = reader.readAll();
+
+    EXPECT_TRUE(writer.write("hello"));
+    EXPECT_TRUE(writer.write("world"));
+    EXPECT_TRUE(writer.close());
+
+    AWAIT_EXPECT_EQ("helloworld", readAll);
+  }
+
+  {
+    http::Pipe pipe;
+    http::Pipe::Writer writer = pipe.writer();
+
+    http::Pipe::Reader reader = http::streaming::decompress(pipe.reader());
+
+    // Data that cannot be decompressed fails the pipe.
+    EXPECT_TRUE(writer.write("hello"));
+
+    AWAIT_EXPECT_FAILED(reader.readAll());
+  }
+
+  {
+    http::Pipe pipe;
+    http::Pipe::Writer writer = pipe.writer();
+
+    http::Pipe::Reader reader = http::streaming::compress(pipe.reader());
+
+    // Closing the returned reader closes the read end of the pipe.
+    Future<Nothing> closed = writer.readerClosed();
+    EXPECT_TRUE(reader.close());
+
+    AWAIT_READY(closed);
+    EXPECT_FALSE(writer.write("hello"));
+  }
+}
+
+
 TEST_P(HTTPTest, Encode)
 {
   string unencoded = "a$&+,/:;=?@ \"<>#%{}|\\^~[]`\x19\x80\xFF";
@@ -687,6 +766,41 @@ TEST_P(HTTPTest, Get)
 }
 
 
+// Ensures that consecutive requests of the client helpers reuse the
+// same (pooled) connection.
+TEST_P(HTTPTest, PooledConnection)
+{
+  Http http;
+
+  Future<http::Request> request1;
+  Future<http::Request> request2;
+
+  EXPECT_CALL(*http.process, get(_))
+    .WillOnce(DoAll(FutureArg<0>(&request1), Return(http::OK())))
+    .WillOnce(DoAll(FutureArg<0>(&request2), Return(http::OK())));
+
+  Future<http::Response> response =
+    http::get(http.process->self(), "get", None(), None(), GetParam());
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(http::OK().status, response);
+
+  response =
+    http::get(http.process->self(), "get", None(), None(), GetParam());
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(http::OK().status, response);
+
+  AWAIT_READY(request1);
+  AWAIT_READY(request2);
+
+  EXPECT_TRUE(request1->keepAlive);
+
+  ASSERT_SOME(request1->client);
+  ASSERT_SOME(request2->client);
+  EXPECT_EQ(stringify(request1->client.get()),
+            stringify(request2->client.get()));
+}
+
+
 // TODO(hausdorff): Routing logic is broken on Windows. Fix and enable test. In
 // this case, the route '/a/b/c' exists and returns 200 ok, but '/a/b' does
 // not. See MESOS-5904.
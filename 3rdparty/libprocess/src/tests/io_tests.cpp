@@ -10,26 +10,39 @@
 // See the License for the specific language governing permissions and
 // limitations under the License
 
+#include <pthread.h>
+#include <signal.h>
+#include <string.h>
+
 #include <gmock/gmock.h>
 
+#include <atomic>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <process/future.hpp>
 #include <process/gtest.hpp>
 #include <process/io.hpp>
 
+#include <stout/bytes.hpp>
+#include <stout/foreach.hpp>
 #include <stout/gtest.hpp>
 #include <stout/os.hpp>
 
 #include <stout/tests/utils.hpp>
 
 #include "encoder.hpp"
+#include "event_loop.hpp"
 
 namespace io = process::io;
 
+using process::EventLoop;
 using process::Future;
+using process::Promise;
 
 using std::string;
+using std::vector;
 
 class IOTest: public TemporaryDirectoryTest {};
 
@@ -374,3 +387,177 @@ TEST_F(IOTest, Redirect)
   // accumulated in the redirect hook.
   EXPECT_EQ(data, accumulated);
 }
+
+
+TEST_F(IOTest, ShortRead)
+{
+  int pipes[2];
+  ASSERT_NE(-1, ::pipe(pipes));
+  ASSERT_SOME(os::nonblock(pipes[0]));
+  ASSERT_SOME(os::nonblock(pipes[1]));
+
+  // A read returns the data that is available, rather than waiting
+  // for all of the requested data.
+  ASSERT_EQ(5, ::write(pipes[1], "hello", 5));
+
+  char data[128];
+  AWAIT_EXPECT_EQ(5u, io::read(pipes[0], data, sizeof(data)));
+  EXPECT_EQ("hello", string(data, 5));
+
+  ASSERT_SOME(os::close(pipes[0]));
+  ASSERT_SOME(os::close(pipes[1]));
+}
+
+
+TEST_F(IOTest, ShortWrite)
+{
+  int pipes[2];
+  ASSERT_NE(-1, ::pipe(pipes));
+  ASSERT_SOME(os::nonblock(pipes[0]));
+  ASSERT_SOME(os::nonblock(pipes[1]));
+
+  // Writing more data than fits into the pipe only writes part of it,
+  // which is the data that is then read, in order.
+  string data;
+  while (Bytes(data.size()) < Megabytes(1)) {
+    data.push_back(static_cast<char>(data.size() % 251));
+  }
+
+  Future<size_t> write = io::write(pipes[1], data.data(), data.size());
+  AWAIT_READY(write);
+  EXPECT_LT(0u, write.get());
+  EXPECT_GT(data.size(), write.get());
+
+  string received;
+  char buffer[4096];
+
+  while (received.size() < write.get()) {
+    Future<size_t> read = io::read(pipes[0], buffer, sizeof(buffer));
+    AWAIT_READY(read);
+    ASSERT_LT(0u, read.get());
+    received.append(buffer, read.get());
+  }
+
+  EXPECT_EQ(data.substr(0, write.get()), received);
+
+  ASSERT_SOME(os::close(pipes[0]));
+  ASSERT_SOME(os::close(pipes[1]));
+}
+
+
+// Tests that many file descriptors can be polled at once, and that
+// discarding some of the polls does not affect the others, whichever
+// event loop thread handles them.
+TEST_F(IOTest, PollMany)
+{
+  const size_t count = 64;
+
+  vector<int> readers;
+  vector<int> writers;
+  vector<Future<short>> polls;
+
+  for (size_t i = 0; i < count; i++) {
+    int pipes[2];
+    ASSERT_NE(-1, ::pipe(pipes));
+    ASSERT_SOME(os::nonblock(pipes[0]));
+    ASSERT_SOME(os::nonblock(pipes[1]));
+
+    readers.push_back(pipes[0]);
+    writers.push_back(pipes[1]);
+    polls.push_back(io::poll(pipes[0], io::READ));
+  }
+
+  for (size_t i = 0; i < count; i += 2) {
+    polls[i].discard();
+  }
+
+  foreach (int writer, writers) {
+    ASSERT_EQ(1, ::write(writer, "x", 1));
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    if (i % 2 == 0) {
+      AWAIT_DISCARDED(polls[i]);
+    } else {
+      AWAIT_EXPECT_EQ(io::READ, polls[i]);
+    }
+  }
+
+  // The file descriptors of the discarded polls can be polled again.
+  for (size_t i = 0; i < count; i += 2) {
+    AWAIT_EXPECT_EQ(io::READ, io::poll(readers[i], io::READ));
+  }
+
+  foreach (int fd, readers) {
+    ASSERT_SOME(os::close(fd));
+  }
+
+  foreach (int fd, writers) {
+    ASSERT_SOME(os::close(fd));
+  }
+}
+
+
+// Does nothing, but unlike ignoring the signal, catching it makes the
+// blocking system calls of the thread that it is delivered to fail
+// with `EINTR` (since it is installed without `SA_RESTART`).
+static void interrupted(int) {}
+
+
+// Tests that the event loop keeps polling, reading and writing when
+// its thread is interrupted by signals, i.e., when it waits for
+// events and fails with `EINTR`.
+TEST_F(IOTest, EventLoopInterrupted)
+{
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = interrupted;
+  sigemptyset(&action.sa_mask);
+
+  struct sigaction previous;
+  ASSERT_EQ(0, sigaction(SIGUSR1, &action, &previous));
+
+  // Find out which thread runs the event loop.
+  Promise<pthread_t> loop;
+  EventLoop::delay(Duration::zero(), [&loop]() {
+    loop.set(pthread_self());
+  });
+
+  AWAIT_READY(loop.future());
+
+  const pthread_t thread = loop.future().get();
+
+  std::atomic_bool done(false);
+
+  std::thread signaler([thread, &done]() {
+    while (!done.load()) {
+      pthread_kill(thread, SIGUSR1);
+      os::sleep(Microseconds(100));
+    }
+  });
+
+  int pipes[2];
+  ASSERT_NE(-1, ::pipe(pipes));
+  ASSERT_SOME(os::nonblock(pipes[0]));
+  ASSERT_SOME(os::nonblock(pipes[1]));
+
+  char data[2];
+
+  for (int i = 0; i < 100; i++) {
+    Future<size_t> read = io::read(pipes[0], data, sizeof(data));
+
+    os::sleep(Microseconds(500));
+
+    AWAIT_EXPECT_EQ(2u, io::write(pipes[1], (void*) "hi", 2));
+    AWAIT_EXPECT_EQ(2u, read);
+    EXPECT_EQ("hi", string(data, 2));
+  }
+
+  done.store(true);
+  signaler.join();
+
+  ASSERT_EQ(0, sigaction(SIGUSR1, &previous, nullptr));
+
+  ASSERT_SOME(os::close(pipes[0]));
+  ASSERT_SOME(os::close(pipes[1]));
+}
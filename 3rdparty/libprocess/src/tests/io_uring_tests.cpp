@@ -0,0 +1,392 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License
+
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sys/socket.h>
+#include <sys/syscall.h>
+
+#include <gmock/gmock.h>
+
+#include <atomic>
+#include <list>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <process/future.hpp>
+#include <process/gtest.hpp>
+#include <process/io.hpp>
+
+#include <stout/foreach.hpp>
+#include <stout/gtest.hpp>
+#include <stout/numify.hpp>
+#include <stout/option.hpp>
+#include <stout/os.hpp>
+#include <stout/path.hpp>
+#include <stout/stringify.hpp>
+#include <stout/strings.hpp>
+#include <stout/try.hpp>
+
+#include <stout/os/getenv.hpp>
+#include <stout/os/ls.hpp>
+#include <stout/os/read.hpp>
+
+#include <stout/tests/utils.hpp>
+
+#include "io_uring.hpp"
+
+namespace io = process::io;
+
+using process::Future;
+using process::IoUring;
+
+using std::string;
+using std::vector;
+
+// The maximum number of bytes transferred by a single operation of
+// the ring (see `io_uring.cpp`).
+static const size_t MAX_SIZE = 256 * 1024;
+
+
+class IoUringTest : public TemporaryDirectoryTest
+{
+protected:
+  // Returns the ring, or nullptr if it is not used, in which case the
+  // tests of the ring itself pass trivially.
+  IoUring* ring()
+  {
+    IoUring* ring = IoUring::instance();
+
+    if (ring == nullptr) {
+      std::cerr << "io_uring is not available, not testing the ring"
+                << std::endl;
+    }
+
+    return ring;
+  }
+};
+
+
+// Returns the id of the ring's thread, which names itself "io_uring".
+static Option<pid_t> ringThread()
+{
+  Try<std::list<string>> tasks = os::ls("/proc/self/task");
+  if (tasks.isError()) {
+    return None();
+  }
+
+  foreach (const string& task, tasks.get()) {
+    Try<string> comm = os::read(path::join("/proc/self/task", task, "comm"));
+    if (comm.isSome() && strings::trim(comm.get()) == "io_uring") {
+      Try<pid_t> tid = numify<pid_t>(task);
+      if (tid.isSome()) {
+        return tid.get();
+      }
+    }
+  }
+
+  return None();
+}
+
+
+// Tests that the ring is not used when disabled with the environment
+// variable (as done by one of the CI configurations), and that I/O is
+// done by polling instead.
+TEST_F(IoUringTest, Fallback)
+{
+  Option<string> value = os::getenv("LIBPROCESS_IO_URING");
+  if (value.isSome() && (value.get() == "false" || value.get() == "0")) {
+    EXPECT_EQ(nullptr, IoUring::instance());
+    EXPECT_NONE(ringThread());
+  }
+
+  int pipes[2];
+  ASSERT_NE(-1, ::pipe(pipes));
+  ASSERT_SOME(os::nonblock(pipes[0]));
+  ASSERT_SOME(os::nonblock(pipes[1]));
+
+  char data[2];
+
+  Future<size_t> read = io::read(pipes[0], data, sizeof(data));
+  EXPECT_TRUE(read.isPending());
+
+  AWAIT_EXPECT_EQ(2u, io::write(pipes[1], (void*) "hi", 2));
+  AWAIT_EXPECT_EQ(2u, read);
+  EXPECT_EQ("hi", string(data, 2));
+
+  ASSERT_SOME(os::close(pipes[0]));
+  ASSERT_SOME(os::close(pipes[1]));
+}
+
+
+// Tests that reads are bounded by the buffer of an operation, and
+// advance the position of the file.
+TEST_F(IoUringTest, ReadFile)
+{
+  IoUring* ring = this->ring();
+  if (ring == nullptr) {
+    return;
+  }
+
+  string contents;
+  for (size_t i = 0; contents.size() < 3 * MAX_SIZE; i++) {
+    contents += stringify(i) + "\n";
+  }
+
+  ASSERT_SOME(os::write("file", contents));
+
+  Try<int> fd = os::open("file", O_RDONLY | O_CLOEXEC);
+  ASSERT_SOME(fd);
+
+  string result;
+  vector<char> data(contents.size() + 1);
+
+  while (true) {
+    Future<size_t> read = ring->read(fd.get(), data.data(), data.size());
+
+    AWAIT_READY(read);
+    EXPECT_GE(MAX_SIZE, read.get());
+
+    if (read.get() == 0) {
+      break;
+    }
+
+    result.append(data.data(), read.get());
+  }
+
+  EXPECT_EQ(contents, result);
+
+  ASSERT_SOME(os::close(fd.get()));
+}
+
+
+// Tests that a write to a pipe without enough room writes what fits,
+// like `write()` does for a non-blocking pipe.
+TEST_F(IoUringTest, ShortWrite)
+{
+  IoUring* ring = this->ring();
+  if (ring == nullptr) {
+    return;
+  }
+
+  int pipes[2];
+  ASSERT_NE(-1, ::pipe(pipes));
+  ASSERT_SOME(os::nonblock(pipes[0]));
+  ASSERT_SOME(os::nonblock(pipes[1]));
+
+  const string data(4 * MAX_SIZE, 'x');
+
+  Future<size_t> write = ring->write(pipes[1], data.data(), data.size());
+
+  AWAIT_READY(write);
+  EXPECT_LT(0u, write.get());
+  EXPECT_GE(MAX_SIZE, write.get());
+
+  vector<char> buffer(write.get());
+  ASSERT_EQ(
+      static_cast<ssize_t>(buffer.size()),
+      ::read(pipes[0], buffer.data(), buffer.size()));
+
+  EXPECT_EQ(
+      data.substr(0, buffer.size()),
+      string(buffer.data(), buffer.size()));
+
+  ASSERT_SOME(os::close(pipes[0]));
+  ASSERT_SOME(os::close(pipes[1]));
+}
+
+
+// Tests that a discarded read which is waiting for data is canceled
+// without touching the memory of the caller, and that the data is
+// left for later reads.
+TEST_F(IoUringTest, Discard)
+{
+  IoUring* ring = this->ring();
+  if (ring == nullptr) {
+    return;
+  }
+
+  int pipes[2];
+  ASSERT_NE(-1, ::pipe(pipes));
+  ASSERT_SOME(os::nonblock(pipes[0]));
+  ASSERT_SOME(os::nonblock(pipes[1]));
+
+  char data[2] = {'-', '-'};
+
+  Future<size_t> read = ring->read(pipes[0], data, sizeof(data));
+  EXPECT_TRUE(read.isPending());
+
+  read.discard();
+  AWAIT_DISCARDED(read);
+
+  ASSERT_EQ(2, ::write(pipes[1], "hi", 2));
+
+  // Give a read which was not canceled the chance to complete.
+  os::sleep(Milliseconds(10));
+
+  EXPECT_EQ("--", string(data, sizeof(data)));
+
+  read = ring->read(pipes[0], data, sizeof(data));
+  AWAIT_EXPECT_EQ(2u, read);
+  EXPECT_EQ("hi", string(data, sizeof(data)));
+
+  ASSERT_SOME(os::close(pipes[0]));
+  ASSERT_SOME(os::close(pipes[1]));
+}
+
+
+// Tests that discarding more operations than fit into the submission
+// queue at once cancels all of them, including those that are still
+// waiting to be submitted.
+TEST_F(IoUringTest, DiscardMany)
+{
+  IoUring* ring = this->ring();
+  if (ring == nullptr) {
+    return;
+  }
+
+  int pipes[2];
+  ASSERT_NE(-1, ::pipe(pipes));
+  ASSERT_SOME(os::nonblock(pipes[0]));
+  ASSERT_SOME(os::nonblock(pipes[1]));
+
+  char data[1];
+
+  vector<Future<size_t>> reads;
+  for (int i = 0; i < 1000; i++) {
+    reads.push_back(ring->read(pipes[0], data, sizeof(data)));
+  }
+
+  foreach (Future<size_t>& read, reads) {
+    read.discard();
+  }
+
+  foreach (const Future<size_t>& read, reads) {
+    AWAIT_DISCARDED(read);
+  }
+
+  ASSERT_EQ(1, ::write(pipes[1], "x", 1));
+
+  AWAIT_EXPECT_EQ(1u, ring->read(pipes[0], data, sizeof(data)));
+  EXPECT_EQ('x', data[0]);
+
+  ASSERT_SOME(os::close(pipes[0]));
+  ASSERT_SOME(os::close(pipes[1]));
+}
+
+
+// Tests that operations on invalid file descriptors fail instead of
+// waiting forever.
+TEST_F(IoUringTest, BadFileDescriptor)
+{
+  IoUring* ring = this->ring();
+  if (ring == nullptr) {
+    return;
+  }
+
+  int pipes[2];
+  ASSERT_NE(-1, ::pipe(pipes));
+  ASSERT_SOME(os::close(pipes[0]));
+  ASSERT_SOME(os::close(pipes[1]));
+
+  char data[1];
+
+  AWAIT_FAILED(ring->read(pipes[0], data, sizeof(data)));
+  AWAIT_FAILED(ring->write(pipes[1], "x", 1));
+}
+
+
+// Tests that a send to a socket whose peer is gone fails rather than
+// raising `SIGPIPE`, which would terminate the tests.
+TEST_F(IoUringTest, SendClosed)
+{
+  IoUring* ring = this->ring();
+  if (ring == nullptr) {
+    return;
+  }
+
+  int sockets[2];
+  ASSERT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM, 0, sockets));
+  ASSERT_SOME(os::nonblock(sockets[0]));
+  ASSERT_SOME(os::close(sockets[1]));
+
+  AWAIT_FAILED(ring->send(sockets[0], "x", 1));
+
+  ASSERT_SOME(os::close(sockets[0]));
+}
+
+
+// Does nothing, but makes `io_uring_enter()` fail with `EINTR` on the
+// thread that the signal is delivered to (since it is installed
+// without `SA_RESTART`).
+static void interrupted(int) {}
+
+
+// Tests that the ring keeps completing operations when waiting for
+// completions is interrupted by signals.
+TEST_F(IoUringTest, Interrupted)
+{
+  IoUring* ring = this->ring();
+  if (ring == nullptr) {
+    return;
+  }
+
+  Option<pid_t> tid = ringThread();
+  ASSERT_SOME(tid);
+
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = interrupted;
+  sigemptyset(&action.sa_mask);
+
+  struct sigaction previous;
+  ASSERT_EQ(0, sigaction(SIGUSR1, &action, &previous));
+
+  std::atomic_bool done(false);
+
+  const pid_t pid = ::getpid();
+
+  std::thread signaler([pid, &tid, &done]() {
+    while (!done.load()) {
+      ::syscall(SYS_tgkill, pid, tid.get(), SIGUSR1);
+      os::sleep(Microseconds(100));
+    }
+  });
+
+  int pipes[2];
+  ASSERT_NE(-1, ::pipe(pipes));
+  ASSERT_SOME(os::nonblock(pipes[0]));
+  ASSERT_SOME(os::nonblock(pipes[1]));
+
+  char data[2];
+
+  for (int i = 0; i < 100; i++) {
+    Future<size_t> read = ring->read(pipes[0], data, sizeof(data));
+
+    os::sleep(Microseconds(500));
+
+    AWAIT_EXPECT_EQ(2u, ring->write(pipes[1], "hi", 2));
+    AWAIT_EXPECT_EQ(2u, read);
+    EXPECT_EQ("hi", string(data, 2));
+  }
+
+  done.store(true);
+  signaler.join();
+
+  ASSERT_EQ(0, sigaction(SIGUSR1, &previous, nullptr));
+
+  ASSERT_SOME(os::close(pipes[0]));
+  ASSERT_SOME(os::close(pipes[1]));
+}
@@ -14,6 +14,8 @@
 
 #include <map>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <stout/base64.hpp>
 #include <stout/duration.hpp>
@@ -30,7 +32,9 @@
 
 #include <process/metrics/counter.hpp>
 #include <process/metrics/gauge.hpp>
+#include <process/metrics/histogram.hpp>
 #include <process/metrics/metrics.hpp>
+#include <process/metrics/push_gauge.hpp>
 #include <process/metrics/timer.hpp>
 
 namespace authentication = process::http::authentication;
@@ -47,6 +51,8 @@ using http::Unauthorized;
 
 using metrics::Counter;
 using metrics::Gauge;
+using metrics::Histogram;
+using metrics::PushGauge;
 using metrics::Timer;
 
 using process::Clock;
@@ -60,6 +66,7 @@ using process::UPID;
 
 using std::map;
 using std::string;
+using std::vector;
 
 class GaugeProcess : public Process<GaugeProcess>
 {
@@ -168,6 +175,40 @@ TEST_F_TEMP_DISABLED_ON_WINDOWS(MetricsTest, Gauge)
 }
 
 
+TEST_F(MetricsTest, PushGauge)
+{
+  PushGauge gauge("test/push_gauge");
+
+  AWAIT_READY(metrics::add(gauge));
+
+  // The value is available without dispatching anywhere.
+  Future<double> value = gauge.value();
+  ASSERT_TRUE(value.isReady());
+  EXPECT_EQ(0.0, value.get());
+
+  gauge = 42;
+  AWAIT_EXPECT_EQ(42.0, gauge.value());
+
+  ++gauge;
+  AWAIT_EXPECT_EQ(43.0, gauge.value());
+
+  gauge -= 0.5;
+  AWAIT_EXPECT_EQ(42.5, gauge.value());
+
+  --gauge;
+  AWAIT_EXPECT_EQ(41.5, gauge.value());
+
+  // Copies share the value.
+  PushGauge copy = gauge;
+  copy += 1;
+  AWAIT_EXPECT_EQ(42.5, gauge.value());
+
+  EXPECT_NONE(gauge.statistics());
+
+  AWAIT_READY(metrics::remove(gauge));
+}
+
+
 TEST_F(MetricsTest, Statistics)
 {
   Counter counter("test/counter", process::TIME_SERIES_WINDOW);
@@ -202,6 +243,82 @@ TEST_F(MetricsTest, Statistics)
 }
 
 
+// Ensures that no increments are lost when a counter is incremented
+// concurrently by multiple threads.
+TEST_F(MetricsTest, CounterConcurrent)
+{
+  Counter counter("test/counter");
+
+  AWAIT_READY(metrics::add(counter));
+
+  const size_t threads = 8;
+  const size_t increments = 10000;
+
+  vector<std::thread> workers;
+  for (size_t i = 0; i < threads; i++) {
+    workers.emplace_back([&counter, increments]() {
+      for (size_t j = 0; j < increments; j++) {
+        ++counter;
+      }
+    });
+  }
+
+  foreach (std::thread& worker, workers) {
+    worker.join();
+  }
+
+  AWAIT_EXPECT_EQ(static_cast<double>(threads * increments), counter.value());
+
+  AWAIT_READY(metrics::remove(counter));
+}
+
+
+TEST_F(MetricsTest, Histogram)
+{
+  Histogram histogram("test/histogram");
+
+  AWAIT_READY(metrics::add(histogram));
+
+  AWAIT_EXPECT_FAILED(histogram.value());
+  EXPECT_NONE(histogram.statistics());
+
+  for (int i = 1; i <= 1000; i++) {
+    histogram.record(i);
+  }
+
+  AWAIT_EXPECT_EQ(1000.0, histogram.value());
+
+  Option<Statistics<double>> statistics = histogram.statistics();
+  ASSERT_SOME(statistics);
+
+  EXPECT_EQ(1000u, statistics.get().count);
+
+  EXPECT_DOUBLE_EQ(1.0, statistics.get().min);
+  EXPECT_DOUBLE_EQ(1000.0, statistics.get().max);
+
+  // The percentiles are approximated by the buckets, see 'Histogram'.
+  EXPECT_NEAR(500.5, statistics.get().p50, 500.5 * 0.04);
+  EXPECT_NEAR(900.1, statistics.get().p90, 900.1 * 0.04);
+  EXPECT_NEAR(950.05, statistics.get().p95, 950.05 * 0.04);
+  EXPECT_NEAR(990.01, statistics.get().p99, 990.01 * 0.04);
+  EXPECT_LE(statistics.get().p999, 1000.0);
+  EXPECT_LE(statistics.get().p9999, 1000.0);
+
+  // Values below the smallest bucket are counted, as are negative
+  // values which are recorded as 0.
+  histogram.record(0);
+  histogram.record(-1);
+
+  statistics = histogram.statistics();
+  ASSERT_SOME(statistics);
+
+  EXPECT_EQ(1002u, statistics.get().count);
+  EXPECT_DOUBLE_EQ(0.0, statistics.get().min);
+
+  AWAIT_READY(metrics::remove(histogram));
+}
+
+
 // GTEST_IS_THREADSAFE is not defined on Windows. See MESOS-5903.
 TEST_F_TEMP_DISABLED_ON_WINDOWS(MetricsTest, Snapshot)
 {
@@ -275,6 +392,55 @@ TEST_F_TEMP_DISABLED_ON_WINDOWS(MetricsTest, Snapshot)
 }
 
 
+// GTEST_IS_THREADSAFE is not defined on Windows. See MESOS-5903.
+TEST_F_TEMP_DISABLED_ON_WINDOWS(MetricsTest, Prometheus)
+{
+  ASSERT_TRUE(GTEST_IS_THREADSAFE);
+
+  UPID upid("metrics", process::address());
+
+  Clock::pause();
+
+  PushGauge gauge("test/prometheus-gauge");
+  Counter counter("test/prometheus_counter");
+
+  AWAIT_READY(metrics::add(gauge));
+  AWAIT_READY(metrics::add(counter));
+
+  gauge = 0.25;
+  counter += 1234567;
+
+  // Advance the clock to avoid rate limit.
+  Clock::advance(Seconds(1));
+
+  Future<Response> response = http::get(upid, "prometheus");
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+  AWAIT_EXPECT_RESPONSE_HEADER_EQ(
+      "text/plain; version=0.0.4", "Content-Type", response);
+
+  const string& body = response->body;
+
+  EXPECT_NE(string::npos, body.find(
+      "# TYPE test_prometheus_gauge untyped\n"
+      "test_prometheus_gauge 0.25\n"));
+
+  EXPECT_NE(string::npos, body.find(
+      "# TYPE test_prometheus_counter untyped\n"
+      "test_prometheus_counter 1234567\n"));
+
+  // An invalid timeout is rejected.
+  Clock::advance(Seconds(1));
+
+  response = http::get(upid, "prometheus", "timeout=foobar");
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(BadRequest().status, response);
+
+  AWAIT_READY(metrics::remove(gauge));
+  AWAIT_READY(metrics::remove(counter));
+
+  Clock::resume();
+}
+
+
 // GTEST_IS_THREADSAFE is not defined on Windows. See MESOS-5903.
 TEST_F_TEMP_DISABLED_ON_WINDOWS(MetricsTest, SnapshotTimeout)
 {
@@ -475,6 +641,24 @@ TEST_F(MetricsTest, Timer)
 }
 
 
+TEST_F(MetricsTest, TimerRecord)
+{
+  metrics::Timer<Milliseconds> timer("test/timer");
+
+  AWAIT_READY(metrics::add(timer));
+
+  AWAIT_FAILED(timer.value());
+
+  timer.record(Microseconds(1500));
+
+  Future<double> value = timer.value();
+  AWAIT_READY(value);
+  EXPECT_FLOAT_EQ(1.5, value.get());
+
+  AWAIT_READY(metrics::remove(timer));
+}
+
+
 static Future<int> advanceAndReturn()
 {
   Clock::advance(Seconds(1));
@@ -25,6 +25,8 @@
 #endif // __WINDOWS__
 
 #include <atomic>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <tuple>
@@ -41,6 +43,7 @@
 #include <process/gc.hpp>
 #include <process/gmock.hpp>
 #include <process/gtest.hpp>
+#include <process/latch.hpp>
 #include <process/network.hpp>
 #include <process/owned.hpp>
 #include <process/process.hpp>
@@ -54,17 +57,21 @@
 #include <stout/gtest.hpp>
 #include <stout/hashmap.hpp>
 #include <stout/hashset.hpp>
+#include <stout/json.hpp>
 #include <stout/lambda.hpp>
 #include <stout/nothing.hpp>
 #include <stout/os.hpp>
 #include <stout/stopwatch.hpp>
 #include <stout/stringify.hpp>
+#include <stout/synchronized.hpp>
 #include <stout/try.hpp>
 
 #include <stout/os/killtree.hpp>
 #include <stout/os/write.hpp>
 
 #include "encoder.hpp"
+#include "event_statistics.hpp"
+#include "route_trie.hpp"
 
 namespace http = process::http;
 namespace inject = process::inject;
@@ -73,10 +80,15 @@ using process::async;
 using process::Clock;
 using process::defer;
 using process::Deferred;
+using process::DispatchEvent;
 using process::Event;
+using process::EventStatistics;
 using process::Executor;
 using process::ExitedEvent;
 using process::Future;
+using process::Histogram;
+using process::HttpEvent;
+using process::Latch;
 using process::Message;
 using process::MessageEncoder;
 using process::MessageEvent;
@@ -84,10 +96,12 @@ using process::Owned;
 using process::PID;
 using process::Process;
 using process::ProcessBase;
+using process::RouteTrie;
 using process::run;
 using process::Subprocess;
 using process::TerminateEvent;
 using process::Time;
+using process::Timer;
 using process::UPID;
 
 using process::firewall::DisabledEndpointsFirewallRule;
@@ -197,6 +211,69 @@ TEST_TEMP_DISABLED_ON_WINDOWS(ProcessTest, Dispatch)
 }
 
 
+class MoveOnlyProcess : public Process<MoveOnlyProcess>
+{
+public:
+  int take(std::unique_ptr<int> value) { return *value; }
+};
+
+
+// Checks that the arguments of a dispatch are moved rather than
+// copied, which allows for move-only arguments.
+TEST(ProcessTest, DispatchMoveOnly)
+{
+  MoveOnlyProcess process;
+
+  PID<MoveOnlyProcess> pid = spawn(&process);
+
+  ASSERT_FALSE(!pid);
+
+  Future<int> future = dispatch(
+      pid, &MoveOnlyProcess::take, std::unique_ptr<int>(new int(42)));
+
+  AWAIT_EXPECT_EQ(42, future);
+
+  terminate(pid);
+  wait(pid);
+}
+
+
+// Tests that a PID copied from a process does not reach the process
+// once its address or ID has been changed, even though it still
+// carries a reference to the process.
+TEST(ProcessTest, DispatchMismatchedPID)
+{
+  DispatchProcess process;
+
+  EXPECT_CALL(process, func0())
+    .Times(0);
+
+  EXPECT_CALL(process, func1(_))
+    .WillOnce(ReturnArg<0>());
+
+  PID<DispatchProcess> pid = spawn(&process);
+
+  ASSERT_FALSE(!pid);
+
+  PID<DispatchProcess> address = pid;
+  address.address.port = pid.address.port + 1;
+
+  dispatch(address, &DispatchProcess::func0);
+
+  PID<DispatchProcess> id = pid;
+  id.id = "unknown";
+
+  dispatch(id, &DispatchProcess::func0);
+
+  // Dispatches are processed in order, so any of the dispatches above
+  // would have been processed once this one is.
+  AWAIT_EXPECT_TRUE(dispatch(pid, &DispatchProcess::func1, true));
+
+  terminate(pid);
+  wait(pid);
+}
+
+
 // GTEST_IS_THREADSAFE is not defined on Windows. See MESOS-5903.
 TEST_TEMP_DISABLED_ON_WINDOWS(ProcessTest, Defer1)
 {
@@ -613,6 +690,130 @@ TEST_TEMP_DISABLED_ON_WINDOWS(ProcessTest, Delay)
 }
 
 
+// Checks that timers whose timeouts span several levels of the timer
+// wheel fire in the order of their timeouts, not before their timeouts
+// and not at all once they were canceled.
+TEST(ProcessTest, Timers)
+{
+  Clock::pause();
+
+  std::mutex mutex;
+  vector<size_t> fired;
+
+  const vector<Duration> durations = {
+    Days(3),
+    Seconds(5),
+    Milliseconds(1),
+    Minutes(2),
+    Weeks(200),
+    Milliseconds(1),
+    Hours(1),
+  };
+
+  vector<Timer> timers;
+  for (size_t i = 0; i < durations.size(); i++) {
+    timers.push_back(Clock::timer(durations[i], [&mutex, &fired, i]() {
+      synchronized (mutex) {
+        fired.push_back(i);
+      }
+    }));
+  }
+
+  EXPECT_TRUE(Clock::cancel(timers[3]));
+  EXPECT_FALSE(Clock::cancel(timers[3]));
+
+  Clock::advance(Milliseconds(1) - Nanoseconds(1));
+  Clock::settle();
+
+  synchronized (mutex) {
+    EXPECT_TRUE(fired.empty());
+  }
+
+  Clock::advance(Nanoseconds(1));
+  Clock::settle();
+
+  synchronized (mutex) {
+    EXPECT_EQ(vector<size_t>({2, 5}), fired);
+  }
+
+  Clock::advance(Days(3));
+  Clock::settle();
+
+  synchronized (mutex) {
+    EXPECT_EQ(vector<size_t>({2, 5, 1, 6, 0}), fired);
+  }
+
+  EXPECT_FALSE(Clock::cancel(timers[0]));
+  EXPECT_TRUE(Clock::cancel(timers[4]));
+
+  Clock::advance(Weeks(200));
+  Clock::settle();
+
+  synchronized (mutex) {
+    EXPECT_EQ(vector<size_t>({2, 5, 1, 6, 0}), fired);
+  }
+
+  Clock::resume();
+}
+
+
+// Tests that event statistics are recorded per handler, using power
+// of two buckets.
+TEST(ProcessTest, EventStatistics)
+{
+  EXPECT_EQ(0, Histogram::bucket(0));
+  EXPECT_EQ(0, Histogram::bucket(1));
+  EXPECT_EQ(1, Histogram::bucket(3));
+  EXPECT_EQ(10, Histogram::bucket(2000));
+  EXPECT_EQ(63, Histogram::bucket(UINT64_MAX));
+
+  Histogram histogram;
+  EXPECT_EQ(0u, histogram.percentile(0.5));
+
+  histogram.add(1);
+  histogram.add(2);
+  histogram.add(2000);
+  EXPECT_EQ(3u, histogram.percentile(0.5));
+  EXPECT_EQ(2047u, histogram.percentile(1.0));
+
+  EventStatistics statistics;
+
+  Message* message = new Message();
+  message->name = "message";
+
+  const MessageEvent event(message);
+
+  statistics.record(event, 3, 100, 2000);
+  statistics.record(event, 1, 100, 3000);
+  statistics.record(TerminateEvent(UPID()), 1, 0, 0);
+
+  Try<JSON::Value> expected = JSON::parse(
+      "{"
+      "  \"max_queued\": 3,"
+      "  \"queued\": [2, 1],"
+      "  \"waited_ns\": [1, 0, 0, 0, 0, 0, 2],"
+      "  \"handlers\": ["
+      "    {"
+      "      \"type\": \"MESSAGE\","
+      "      \"name\": \"message\","
+      "      \"count\": 2,"
+      "      \"total_ns\": 5000,"
+      "      \"served_ns\": [0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1]"
+      "    },"
+      "    {"
+      "      \"type\": \"TERMINATE\","
+      "      \"count\": 1,"
+      "      \"total_ns\": 0,"
+      "      \"served_ns\": [1]"
+      "    }"
+      "  ]"
+      "}");
+
+  ASSERT_SOME(expected);
+  EXPECT_EQ(expected.get(), JSON::Value(statistics.json()));
+}
+
+
 class OrderProcess : public Process<OrderProcess>
 {
 public:
@@ -695,6 +896,59 @@ TEST_TEMP_DISABLED_ON_WINDOWS(ProcessTest, Donate)
 }
 
 
+class EventCountProcess : public Process<EventCountProcess>
+{
+public:
+  void block(Latch* blocked, Latch* unblock)
+  {
+    blocked->trigger();
+    unblock->await();
+  }
+
+  Nothing noop() { return Nothing(); }
+
+  template <typename T>
+  size_t count()
+  {
+    return eventCount<T>();
+  }
+};
+
+
+// This test verifies that the number of queued events of each type
+// is tracked while the process is busy.
+TEST(ProcessTest, EventCount)
+{
+  EventCountProcess process;
+  spawn(process);
+
+  Latch blocked;
+  Latch unblock;
+
+  dispatch(process, &EventCountProcess::block, &blocked, &unblock);
+
+  blocked.await();
+
+  dispatch(process, &EventCountProcess::noop);
+  dispatch(process, &EventCountProcess::noop);
+  post(process.self(), "message");
+
+  EXPECT_EQ(2u, process.count<DispatchEvent>());
+  EXPECT_EQ(1u, process.count<MessageEvent>());
+  EXPECT_EQ(0u, process.count<HttpEvent>());
+
+  unblock.trigger();
+
+  AWAIT_READY(dispatch(process, &EventCountProcess::noop));
+
+  EXPECT_EQ(0u, process.count<DispatchEvent>());
+  EXPECT_EQ(0u, process.count<MessageEvent>());
+
+  terminate(process);
+  wait(process);
+}
+
+
 class ExitedProcess : public Process<ExitedProcess>
 {
 public:
@@ -857,6 +1111,60 @@ TEST_F_TEMP_DISABLED_ON_WINDOWS(ProcessRemoteLinkTest, RemoteLink)
 }
 
 
+class LinkManyProcess : public Process<LinkManyProcess>
+{
+public:
+  explicit LinkManyProcess(const vector<UPID>& _pids) : pids(_pids) {}
+
+  virtual void initialize()
+  {
+    foreach (const UPID& pid, pids) {
+      link(pid);
+    }
+  }
+
+  MOCK_METHOD1(exited, void(const UPID&));
+
+private:
+  const vector<UPID> pids;
+};
+
+
+// Verifies that a process linked to several processes at the same
+// remote address gets an `ExitedEvent` for each of them when the
+// connection to that address breaks.
+TEST_F_TEMP_DISABLED_ON_WINDOWS(ProcessRemoteLinkTest, RemoteLinkMany)
+{
+  // The other linkee does not need to exist, only the address of the
+  // link matters.
+  const UPID other("other", pid.address);
+
+  LinkManyProcess process({pid, other});
+
+  Future<UPID> exited1;
+  Future<UPID> exited2;
+  EXPECT_CALL(process, exited(_))
+    .WillOnce(FutureArg<0>(&exited1))
+    .WillOnce(FutureArg<0>(&exited2));
+
+  spawn(process);
+
+  os::killtree(linkee->pid(), SIGKILL);
+  reap_linkee();
+  linkee = None();
+
+  AWAIT_ASSERT_READY(exited1);
+  AWAIT_ASSERT_READY(exited2);
+
+  EXPECT_EQ(
+      (hashset<UPID>{pid, other}),
+      (hashset<UPID>{exited1.get(), exited2.get()}));
+
+  terminate(process);
+  wait(process);
+}
+
+
 class RemoteLinkTestProcess : public Process<RemoteLinkTestProcess>
 {
 public:
@@ -1344,6 +1652,19 @@ TEST_TEMP_DISABLED_ON_WINDOWS(ProcessTest, Remote)
 }
 
 
+// Checks that the outgoing queues of the sockets can be inspected.
+TEST_TEMP_DISABLED_ON_WINDOWS(ProcessTest, Sockets)
+{
+  Future<http::Response> response =
+    http::get(UPID("__sockets__", process::address()));
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(http::OK().status, response);
+
+  Try<JSON::Array> sockets = JSON::parse<JSON::Array>(response->body);
+  ASSERT_SOME(sockets);
+}
+
+
 // Like the 'remote' test but uses http::connect.
 // NOTE: GTEST_IS_THREADSAFE is not defined on Windows. See MESOS-5903.
 TEST_TEMP_DISABLED_ON_WINDOWS(ProcessTest, Http1)
@@ -1583,6 +1904,80 @@ TEST_TEMP_DISABLED_ON_WINDOWS(ProcessTest, Provide)
 }
 
 
+// Tests that a single byte range of a provided file can be requested.
+TEST_TEMP_DISABLED_ON_WINDOWS(ProcessTest, ProvideRange)
+{
+  const Try<string> mkdtemp = os::mkdtemp();
+  ASSERT_SOME(mkdtemp);
+
+  const string DIGITS = "0123456789";
+
+  const string path = path::join(mkdtemp.get(), "digits.txt");
+  ASSERT_SOME(os::write(path, DIGITS));
+
+  FileServer server(path);
+  PID<FileServer> pid = spawn(server);
+
+  {
+    http::Headers headers;
+    headers["Range"] = "bytes=2-5";
+
+    Future<http::Response> response = http::get(pid, None(), None(), headers);
+
+    AWAIT_EXPECT_RESPONSE_STATUS_EQ(
+        http::Status::string(http::Status::PARTIAL_CONTENT), response);
+    AWAIT_EXPECT_RESPONSE_HEADER_EQ("bytes 2-5/10", "Content-Range", response);
+    AWAIT_EXPECT_RESPONSE_BODY_EQ("2345", response);
+  }
+
+  {
+    http::Headers headers;
+    headers["Range"] = "bytes=-3";
+
+    Future<http::Response> response = http::get(pid, None(), None(), headers);
+
+    AWAIT_EXPECT_RESPONSE_BODY_EQ("789", response);
+  }
+
+  {
+    http::Headers headers;
+    headers["Range"] = "bytes=7-";
+
+    Future<http::Response> response = http::get(pid, None(), None(), headers);
+
+    AWAIT_EXPECT_RESPONSE_BODY_EQ("789", response);
+  }
+
+  {
+    http::Headers headers;
+    headers["Range"] = "bytes=10-";
+
+    Future<http::Response> response = http::get(pid, None(), None(), headers);
+
+    AWAIT_EXPECT_RESPONSE_STATUS_EQ(
+        http::Status::string(http::Status::REQUESTED_RANGE_NOT_SATISFIABLE),
+        response);
+    AWAIT_EXPECT_RESPONSE_HEADER_EQ("bytes */10", "Content-Range", response);
+  }
+
+  // Multiple ranges are not supported, the whole file is sent instead.
+  {
+    http::Headers headers;
+    headers["Range"] = "bytes=0-1,4-5";
+
+    Future<http::Response> response = http::get(pid, None(), None(), headers);
+
+    AWAIT_EXPECT_RESPONSE_STATUS_EQ(http::OK().status, response);
+    AWAIT_EXPECT_RESPONSE_BODY_EQ(DIGITS, response);
+  }
+
+  terminate(server);
+  wait(server);
+
+  ASSERT_SOME(os::rmdir(path));
+}
+
+
 static int baz(string s) { return 42; }
 
 
@@ -1918,6 +2313,63 @@ TEST_TEMP_DISABLED_ON_WINDOWS(ProcessTest, FirewallDisablePaths)
 }
 
 
+// Tests that routes match the longest prefix of a path on component
+// boundaries.
+TEST(ProcessTest, RouteTrie)
+{
+  RouteTrie<int> routes;
+
+  // Returns the value of the matching route, or -1 if none matches.
+  auto match = [&routes](const string& path) -> int {
+    const RouteTrie<int>::Route* route = routes.match(path);
+    return route != nullptr ? route->value : -1;
+  };
+
+  EXPECT_EQ(-1, match(""));
+  EXPECT_EQ(-1, match("a"));
+
+  routes.add("", 0);
+  routes.add("a", 1);
+  routes.add("a/b", 2);
+  routes.add("a/b/c", 3);
+  routes.add("b/", 4);
+  routes.add("ab", 5);
+
+  EXPECT_EQ(0, match(""));
+  EXPECT_EQ(1, match("a"));
+  EXPECT_EQ(1, match("a/x"));
+  EXPECT_EQ(2, match("a/b"));
+  EXPECT_EQ(2, match("a/b/x/c"));
+  EXPECT_EQ(2, match("a/b//c"));
+  EXPECT_EQ(3, match("a/b/c"));
+  EXPECT_EQ(3, match("a/b/c/d"));
+  EXPECT_EQ(5, match("ab"));
+  EXPECT_EQ(1, match("a/bc"));
+
+  // Trailing slashes are stripped along with the last component,
+  // like `Path::dirname` does.
+  EXPECT_EQ(-1, match("a/"));
+  EXPECT_EQ(-1, match("a//"));
+  EXPECT_EQ(1, match("a/b/"));
+  EXPECT_EQ(2, match("a/b/c//"));
+
+  // The root route only matches the empty path.
+  EXPECT_EQ(-1, match("x"));
+  EXPECT_EQ(-1, match("x/a"));
+
+  // A route ending with '/' only matches itself.
+  EXPECT_EQ(4, match("b/"));
+  EXPECT_EQ(-1, match("b"));
+  EXPECT_EQ(-1, match("b//"));
+  EXPECT_EQ(-1, match("b/x"));
+
+  // Routes can be replaced.
+  routes.add("a/b", 6);
+  EXPECT_EQ(6, match("a/b/x"));
+  EXPECT_EQ("a/b", routes.match("a/b/x")->name);
+}
+
+
 // Test that firewall rules can be changed by changing the vector.
 // An empty vector should allow all paths.
 // TODO(hausdorff): Routing logic is broken on Windows. Fix and enable test. In
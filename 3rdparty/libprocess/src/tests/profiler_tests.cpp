@@ -12,15 +12,21 @@
 
 #include <gtest/gtest.h>
 
+#include <chrono>
 #include <string>
 
 #include <stout/duration.hpp>
 #include <stout/gtest.hpp>
+#include <stout/nothing.hpp>
+#include <stout/stringify.hpp>
+#include <stout/strings.hpp>
 
 #include <process/authenticator.hpp>
+#include <process/dispatch.hpp>
 #include <process/future.hpp>
 #include <process/gtest.hpp>
 #include <process/http.hpp>
+#include <process/id.hpp>
 #include <process/process.hpp>
 #include <process/profiler.hpp>
 
@@ -36,6 +42,8 @@ using http::Response;
 using http::Unauthorized;
 
 using process::Future;
+using process::PID;
+using process::Process;
 using process::READWRITE_HTTP_AUTHENTICATION_REALM;
 using process::UPID;
 
@@ -134,3 +142,56 @@ TEST_F(ProfilerTest, StartAndStopAuthenticationEnabled)
   response = http::get(upid, "stop");
   AWAIT_EXPECT_RESPONSE_STATUS_EQ(Unauthorized({}).status, response);
 }
+
+
+class BusyProcess : public Process<BusyProcess>
+{
+public:
+  BusyProcess() : ProcessBase(process::ID::generate("busy")) {}
+
+  // Keeps the worker thread running the process busy, regardless of
+  // the libprocess clock.
+  Nothing spin(const Duration& duration)
+  {
+    const std::chrono::steady_clock::time_point deadline =
+      std::chrono::steady_clock::now() +
+      std::chrono::nanoseconds(duration.ns());
+
+    while (std::chrono::steady_clock::now() < deadline);
+
+    return Nothing();
+  }
+};
+
+
+// Tests that the flame graph endpoint attributes the samples to the
+// process that keeps a worker thread busy.
+TEST_F(ProfilerTest, Flamegraph)
+{
+  UPID upid("profiler", process::address());
+
+  Future<Response> response = http::get(upid, "flamegraph");
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(BadRequest().status, response);
+
+  response = http::get(upid, "flamegraph", "duration=0secs");
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(BadRequest().status, response);
+
+  BusyProcess process;
+  PID<BusyProcess> pid = spawn(process);
+
+  response = http::get(upid, "flamegraph", "duration=500ms");
+
+  // Keep the process busy until sampling ends. Worker threads only
+  // publish what they are running once a sampling session is in
+  // progress, so this uses many short dispatches.
+  while (response.isPending()) {
+    AWAIT_READY(dispatch(pid, &BusyProcess::spin, Milliseconds(10)));
+  }
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+  EXPECT_TRUE(strings::contains(response->body, stringify(pid.id) + ";"))
+    << response->body;
+
+  terminate(process);
+  wait(process);
+}
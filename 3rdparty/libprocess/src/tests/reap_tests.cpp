@@ -13,6 +13,9 @@
 #include <signal.h>
 #include <unistd.h>
 
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
 #include <sys/wait.h>
 
 #include <gtest/gtest.h>
@@ -177,3 +180,40 @@ TEST(ReapTest, TerminatedChildProcess)
 
   Clock::resume();
 }
+
+
+#if defined(__linux__) && defined(SYS_pidfd_open)
+// This test checks that a child process is reaped as soon as it
+// exits, i.e., without the reaper having to poll it, on kernels that
+// support pidfds.
+TEST(ReapTest, ChildProcessWithoutPolling)
+{
+  ASSERT_TRUE(GTEST_IS_THREADSAFE);
+
+  // Check whether the kernel supports pidfds.
+  int fd = ::syscall(SYS_pidfd_open, ::getpid(), 0);
+  if (fd < 0) {
+    LOG(WARNING) << "Skipping test since pidfds are not supported";
+    return;
+  }
+
+  ::close(fd);
+
+  Try<ProcessTree> tree = Fork(None(),
+                               Exec("sleep 10"))();
+
+  ASSERT_SOME(tree);
+  pid_t child = tree.get();
+
+  // Pause the clock so that the reaper does not poll.
+  Clock::pause();
+
+  Future<Option<int>> status = process::reap(child);
+
+  EXPECT_EQ(0, kill(child, SIGKILL));
+
+  AWAIT_EXPECT_WTERMSIG_EQ(SIGKILL, status);
+
+  Clock::resume();
+}
+#endif // __linux__ && SYS_pidfd_open
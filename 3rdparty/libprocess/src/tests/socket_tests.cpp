@@ -10,7 +10,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License
 
+#include <set>
 #include <string>
+#include <vector>
 
 #include <gmock/gmock.h>
 
@@ -37,8 +39,11 @@ using process::READWRITE_HTTP_AUTHENTICATION_REALM;
 
 using process::network::inet::Address;
 using process::network::inet::Socket;
+using process::network::internal::SocketImpl;
 
+using std::set;
 using std::string;
+using std::vector;
 
 using testing::WithParamInterface;
 
@@ -243,3 +248,53 @@ TEST_P(NetSocketTest, EOFAfterRecv)
   AWAIT_EXPECT_EQ(string(), receive);
 }
 #endif // __WINDOWS__
+
+
+// This test verifies that all the connections that are pending when
+// the server socket becomes readable get accepted, including those
+// that are accepted along with the first one and returned by the
+// later calls to `accept()`.
+TEST_F(SocketTest, AcceptPending)
+{
+  Try<Socket> server = Socket::create(SocketImpl::Kind::POLL);
+  ASSERT_SOME(server);
+
+  Try<Address> server_address = server->bind(Address::ANY_ANY());
+  ASSERT_SOME(server_address);
+
+  // More connections than are accepted at once.
+  const size_t count = 100;
+
+  ASSERT_SOME(server->listen(count));
+
+  set<uint16_t> ports;
+  vector<Socket> clients;
+
+  for (size_t i = 0; i < count; i++) {
+    Try<Socket> client = Socket::create(SocketImpl::Kind::POLL);
+    ASSERT_SOME(client);
+
+    // The connection is established by the kernel, i.e., before the
+    // server accepts it.
+    AWAIT_READY(
+        client->connect(Address(process::address().ip, server_address->port)));
+
+    Try<Address> address = client->address();
+    ASSERT_SOME(address);
+
+    ports.insert(address->port);
+    clients.push_back(client.get());
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    Future<Socket> accept = server->accept();
+    AWAIT_READY(accept);
+
+    Try<Address> peer = accept->peer();
+    ASSERT_SOME(peer);
+
+    EXPECT_EQ(1u, ports.erase(peer->port));
+  }
+
+  EXPECT_TRUE(ports.empty());
+}
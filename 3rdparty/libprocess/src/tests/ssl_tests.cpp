@@ -173,6 +173,53 @@ TEST_P(SSLTest, BasicSameProcess)
 }
 
 
+// Ensures that a reconnecting client resumes its previous session and
+// that the resumed connection is still verified.
+TEST_F(SSLTest, SessionResumption)
+{
+  os::setenv("LIBPROCESS_SSL_ENABLED", "true");
+  os::setenv("LIBPROCESS_SSL_KEY_FILE", key_path().string());
+  os::setenv("LIBPROCESS_SSL_CERT_FILE", certificate_path().string());
+  os::setenv("LIBPROCESS_SSL_REQUIRE_CERT", "true");
+  os::setenv("LIBPROCESS_SSL_CA_DIR", os::getcwd());
+  os::setenv("LIBPROCESS_SSL_CA_FILE", certificate_path().string());
+
+  openssl::reinitialize();
+
+  Try<Socket> server = Socket::create(SocketImpl::Kind::SSL);
+  ASSERT_SOME(server);
+
+  // We need to explicitly bind to the address advertised by libprocess so the
+  // certificate we create in this test fixture can be verified.
+  ASSERT_SOME(server->bind(Address(net::IP(process::address().ip), 0)));
+  ASSERT_SOME(server->listen(BACKLOG));
+
+  Try<Address> address = server->address();
+  ASSERT_SOME(address);
+
+  // NOTE: The client and the server share the global context, which
+  // counts the sessions resumed by the server.
+  const long hits = SSL_CTX_sess_hits(openssl::context());
+
+  for (int i = 0; i < 2; i++) {
+    Try<Socket> client = Socket::create(SocketImpl::Kind::SSL);
+    ASSERT_SOME(client);
+
+    Future<Socket> accept = server->accept();
+
+    AWAIT_ASSERT_READY(client->connect(address.get()));
+    AWAIT_ASSERT_READY(accept);
+
+    Socket socket = accept.get();
+
+    AWAIT_ASSERT_READY(client->send(data));
+    AWAIT_ASSERT_EQ(data, socket.recv(data.size()));
+  }
+
+  EXPECT_EQ(hits + 1, SSL_CTX_sess_hits(openssl::context()));
+}
+
+
 #ifndef __WINDOWS__
 TEST_P(SSLTest, BasicSameProcessUnix)
 {
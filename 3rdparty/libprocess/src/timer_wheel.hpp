@@ -0,0 +1,328 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License
+
+#ifndef __TIMER_WHEEL_HPP__
+#define __TIMER_WHEEL_HPP__
+
+#include <stdint.h>
+
+#include <iterator>
+#include <list>
+#include <vector>
+
+#include <process/time.hpp>
+#include <process/timer.hpp>
+
+#include <stout/check.hpp>
+#include <stout/duration.hpp>
+#include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/option.hpp>
+
+namespace process {
+
+// A hierarchical timing wheel (see Varghese and Lauck, "Hashed and
+// Hierarchical Timing Wheels"), which adds and removes timers in
+// constant time.
+//
+// The wheel divides time into ticks of `RESOLUTION`. Each level has
+// `SLOTS` slots, a slot on level `k` spans `SLOTS^k` ticks. Timers are
+// kept on the lowest level whose slots are not shared with the current
+// tick, and move to lower levels ("cascade") as time advances. The
+// resolution only determines how timers are grouped, timers are never
+// expired before their timeout.
+//
+// NOTE: The wheel is not thread-safe.
+class TimerWheel
+{
+public:
+  struct Entry
+  {
+    uint64_t id;
+    Timer timer;
+  };
+
+  TimerWheel() : cursor(0), occupied() {}
+
+  void add(uint64_t id, const Timer& timer)
+  {
+    CHECK(!index.contains(id));
+
+    std::list<Entry> added;
+    added.push_back({id, timer});
+
+    place(&added, added.begin());
+  }
+
+  // Returns the timer that was removed, if there was a timer with the
+  // id.
+  Option<Timer> remove(uint64_t id)
+  {
+    Option<Location> location = index.get(id);
+    if (location.isNone()) {
+      return None();
+    }
+
+    std::list<Entry>* entries = list(location->level, location->slot);
+
+    const Timer timer = location->entry->timer;
+    entries->erase(location->entry);
+
+    const int level = location->level;
+    if (entries->empty() && level >= 0 && level < LEVELS) {
+      occupied[level] &= ~(uint64_t(1) << location->slot);
+    }
+
+    index.erase(id);
+    return timer;
+  }
+
+  // Moves the wheel to `now`, appending the timers whose timeout is not
+  // after `now` to `expired`.
+  void advance(const Time& now, std::vector<Entry>* expired)
+  {
+    const int64_t target = tick(now);
+
+    while (cursor < target) {
+      Option<Event> event = next();
+      if (event.isNone() || event->tick > target) {
+        cursor = target;
+        break;
+      }
+
+      cursor = event->tick;
+
+      std::list<Entry> entries;
+      entries.swap(*list(event->level, event->slot));
+
+      if (event->level != OVERFLOW_LEVEL) {
+        occupied[event->level] &= ~(uint64_t(1) << event->slot);
+      }
+
+      while (!entries.empty()) {
+        place(&entries, entries.begin());
+      }
+    }
+
+    auto it = current.begin();
+    while (it != current.end()) {
+      if (it->timer.timeout().time() <= now) {
+        index.erase(it->id);
+        expired->push_back(std::move(*it));
+        it = current.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  // Returns the earliest time at which the wheel has to be advanced
+  // for timers to expire in time, which is the timeout of the next
+  // timer, or earlier if timers have to cascade first.
+  Option<Time> deadline() const
+  {
+    if (!current.empty()) {
+      return earliest(current);
+    }
+
+    Option<Event> event = next();
+    if (event.isNone()) {
+      return None();
+    }
+
+    if (event->level == 0) {
+      return earliest(slots[0][event->slot]);
+    }
+
+    return Time::epoch() + Nanoseconds(event->tick * RESOLUTION);
+  }
+
+  bool empty() const
+  {
+    return index.empty();
+  }
+
+  // Removes all timers and returns them, so that the caller can
+  // destroy them, e.g., outside of a lock.
+  std::vector<Entry> clear()
+  {
+    std::vector<Entry> result;
+
+    for (int level = 0; level < LEVELS; level++) {
+      for (int slot = 0; slot < SLOTS; slot++) {
+        drain(&slots[level][slot], &result);
+      }
+      occupied[level] = 0;
+    }
+
+    drain(&current, &result);
+    drain(&overflow, &result);
+
+    index.clear();
+
+    return result;
+  }
+
+private:
+  static constexpr int64_t RESOLUTION = 1000000; // 1ms in nanoseconds.
+  static constexpr int BITS = 6;
+  static constexpr int SLOTS = 1 << BITS;
+  static constexpr int LEVELS = 6;
+
+  // Pseudo levels of the lists that are not part of the slots:
+  // `current` holds the timers of ticks that have been reached, and
+  // `overflow` the timers that are beyond the span of all levels.
+  static constexpr int CURRENT_LEVEL = -1;
+  static constexpr int OVERFLOW_LEVEL = LEVELS;
+
+  struct Location
+  {
+    int level;
+    int slot;
+    std::list<Entry>::iterator entry;
+  };
+
+  // The next list to process when advancing the wheel.
+  struct Event
+  {
+    int64_t tick;
+    int level;
+    int slot;
+  };
+
+  static int64_t tick(const Time& time)
+  {
+    const int64_t ns = time.duration().ns();
+    return ns > 0 ? ns / RESOLUTION : 0;
+  }
+
+  // Returns the index of the lowest bit that is set in `bits`, which
+  // must not be zero.
+  static int lowest(uint64_t bits)
+  {
+    int result = 0;
+    for (int shift = 32; shift > 0; shift /= 2) {
+      if ((bits & ((uint64_t(1) << shift) - 1)) == 0) {
+        bits >>= shift;
+        result += shift;
+      }
+    }
+    return result;
+  }
+
+  static Time earliest(const std::list<Entry>& entries)
+  {
+    CHECK(!entries.empty());
+
+    Time result = entries.front().timer.timeout().time();
+    foreach (const Entry& entry, entries) {
+      if (entry.timer.timeout().time() < result) {
+        result = entry.timer.timeout().time();
+      }
+    }
+    return result;
+  }
+
+  static void drain(std::list<Entry>* entries, std::vector<Entry>* result)
+  {
+    foreach (Entry& entry, *entries) {
+      result->push_back(std::move(entry));
+    }
+    entries->clear();
+  }
+
+  std::list<Entry>* list(int level, int slot)
+  {
+    if (level == CURRENT_LEVEL) {
+      return &current;
+    } else if (level == OVERFLOW_LEVEL) {
+      return &overflow;
+    }
+    return &slots[level][slot];
+  }
+
+  // Moves the entry from `entries` to the list for its tick relative
+  // to the cursor.
+  void place(std::list<Entry>* entries, std::list<Entry>::iterator entry)
+  {
+    const int64_t ticks = tick(entry->timer.timeout().time());
+
+    int level = CURRENT_LEVEL;
+    int slot = 0;
+
+    if (ticks > cursor) {
+      // The level is the highest group of bits in which the tick
+      // differs from the cursor, the slot is the value of that group.
+      level = 0;
+      int64_t bits = (ticks ^ cursor) >> BITS;
+      while (bits != 0) {
+        level++;
+        bits >>= BITS;
+      }
+
+      if (level >= LEVELS) {
+        level = OVERFLOW_LEVEL;
+      } else {
+        slot = (ticks >> (BITS * level)) & (SLOTS - 1);
+        occupied[level] |= uint64_t(1) << slot;
+      }
+    }
+
+    std::list<Entry>* target = list(level, slot);
+    target->splice(target->end(), *entries, entry);
+
+    index[entry->id] = {level, slot, entry};
+  }
+
+  // Returns the list with the earliest ticks that has not been
+  // processed yet. Timers on lower levels always expire before the
+  // timers on higher levels, and all slots that are occupied come
+  // after the cursor on their level.
+  Option<Event> next() const
+  {
+    for (int level = 0; level < LEVELS; level++) {
+      if (occupied[level] != 0) {
+        const int slot = lowest(occupied[level]);
+        const int shift = BITS * (level + 1);
+
+        return Event{
+            ((cursor >> shift) << shift) |
+              (int64_t(slot) << (BITS * level)),
+            level,
+            slot};
+      }
+    }
+
+    if (!overflow.empty()) {
+      const int shift = BITS * LEVELS;
+      return Event{((cursor >> shift) + 1) << shift, OVERFLOW_LEVEL, 0};
+    }
+
+    return None();
+  }
+
+  // The tick that the wheel has been advanced to.
+  int64_t cursor;
+
+  std::list<Entry> slots[LEVELS][SLOTS];
+  std::list<Entry> current;
+  std::list<Entry> overflow;
+
+  // A bit per slot of each level, set if the slot has timers.
+  uint64_t occupied[LEVELS];
+
+  hashmap<uint64_t, Location> index;
+};
+
+} // namespace process {
+
+#endif // __TIMER_WHEEL_HPP__
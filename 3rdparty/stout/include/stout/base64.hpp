@@ -13,8 +13,9 @@
 #ifndef __STOUT_BASE64_HPP__
 #define __STOUT_BASE64_HPP__
 
-#include <cctype>
-#include <functional>
+#include <stddef.h>
+#include <stdint.h>
+
 #include <string>
 
 #include <stout/foreach.hpp>
@@ -23,70 +24,92 @@
 
 namespace base64 {
 
-// This slightly modified base64 implementation from
-// cplusplus.com answer by modoran can be found at:
-// http://www.cplusplus.com/forum/beginner/51572/
-
 static const std::string chars =
   "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
   "abcdefghijklmnopqrstuvwxyz"
   "0123456789+/";
 
+namespace internal {
 
-inline std::string encode(const std::string& s)
+// Maps every character to its value in the base64 alphabet, or to -1
+// if it is not part of the alphabet. This avoids searching through
+// the alphabet for every decoded character.
+struct DecodeTable
 {
-  std::string result;
-  int i = 0;
-  int j = 0;
-  unsigned char array3[3];
-  unsigned char array4[4];
-  const char* bytesToEncode = s.c_str();
-  size_t length = s.size();
-
-  while (length--) {
-    array3[i++] = *(bytesToEncode++);
-    if (i == 3) {
-      array4[0] = (array3[0] & 0xfc) >> 2;
-      array4[1] = ((array3[0] & 0x03) << 4) + ((array3[1] & 0xf0) >> 4);
-      array4[2] = ((array3[1] & 0x0f) << 2) + ((array3[2] & 0xc0) >> 6);
-      array4[3] = array3[2] & 0x3f;
-      for (i = 0; i < 4; i++) {
-        result += chars[array4[i]];
-      }
-      i = 0;
+  DecodeTable()
+  {
+    for (size_t i = 0; i < sizeof(values); i++) {
+      values[i] = -1;
     }
-  }
 
-  if (i != 0) {
-    for (j = i; j < 3; j++) {
-      array3[j] = '\0';
-    }
-    array4[0] = (array3[0] & 0xfc) >> 2;
-    array4[1] = ((array3[0] & 0x03) << 4) + ((array3[1] & 0xf0) >> 4);
-    array4[2] = ((array3[1] & 0x0f) << 2) + ((array3[2] & 0xc0) >> 6);
-    array4[3] = array3[2] & 0x3f;
-    for (j = 0; j < i + 1; j++) {
-      result += chars[array4[j]];
-    }
-    while (i++ < 3) {
-      result += '=';
+    const char alphabet[] =
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+      "abcdefghijklmnopqrstuvwxyz"
+      "0123456789+/";
+
+    for (size_t i = 0; i < sizeof(alphabet) - 1; i++) {
+      values[static_cast<unsigned char>(alphabet[i])] = static_cast<int8_t>(i);
     }
   }
 
+  int8_t values[256];
+};
+
+} // namespace internal {
+
+
+// Encodes three bytes at a time into four characters, straight into
+// a result that is allocated up front (including the padding).
+inline std::string encode(const std::string& s)
+{
+  const unsigned char* data =
+    reinterpret_cast<const unsigned char*>(s.data());
+  const size_t length = s.size();
+  const char* alphabet = chars.data();
+
+  std::string result(((length + 2) / 3) * 4, '=');
+  char* output = &result[0];
+
+  size_t i = 0;
+  for (; i + 3 <= length; i += 3) {
+    const uint32_t bits =
+      (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
+
+    *output++ = alphabet[(bits >> 18) & 0x3f];
+    *output++ = alphabet[(bits >> 12) & 0x3f];
+    *output++ = alphabet[(bits >> 6) & 0x3f];
+    *output++ = alphabet[bits & 0x3f];
+  }
+
+  // Encode the remaining one or two bytes, if any, which leaves the
+  // '=' padding in place.
+  if (i + 1 == length) {
+    const uint32_t bits = data[i] << 16;
+
+    *output++ = alphabet[(bits >> 18) & 0x3f];
+    *output++ = alphabet[(bits >> 12) & 0x3f];
+  } else if (i + 2 == length) {
+    const uint32_t bits = (data[i] << 16) | (data[i + 1] << 8);
+
+    *output++ = alphabet[(bits >> 18) & 0x3f];
+    *output++ = alphabet[(bits >> 12) & 0x3f];
+    *output++ = alphabet[(bits >> 6) & 0x3f];
+  }
+
   return result;
 }
 
 
 inline Try<std::string> decode(const std::string& s)
 {
-  auto isBase64 = [](unsigned char c) -> bool {
-    return (isalnum(c) || (c == '+') || (c == '/'));
-  };
+  static const internal::DecodeTable* table = new internal::DecodeTable();
 
-  size_t i = 0;
-  unsigned char array3[3];
-  unsigned char array4[4];
-  std::string result;
+  std::string result((s.size() / 4) * 3 + 2, '\0');
+  char* output = &result[0];
+
+  // The bits of the (up to four) characters of the current group.
+  uint32_t bits = 0;
+  size_t count = 0;
 
   foreach (unsigned char c, s) {
     if (c == '=') {
@@ -95,43 +118,33 @@ inline Try<std::string> decode(const std::string& s)
       break; // Reached the padding.
     }
 
-    if (!isBase64(c)) {
+    const int8_t value = table->values[c];
+    if (value < 0) {
       return Error("Invalid character '" + stringify(c) + "'");
     }
 
-    array4[i++] = c;
-
-    if (i == 4) {
-      for (i = 0; i < 4; i++) {
-        array4[i] = static_cast<unsigned char>(chars.find(array4[i]));
-      }
-      array3[0] = (array4[0] << 2) + ((array4[1] & 0x30) >> 4);
-      array3[1] = ((array4[1] & 0xf) << 4) + ((array4[2] & 0x3c) >> 2);
-      array3[2] = ((array4[2] & 0x3) << 6) + array4[3];
-      for (i = 0; i < 3; i++) {
-        result += array3[i];
-      }
-      i = 0;
+    bits = (bits << 6) | value;
+
+    if (++count == 4) {
+      *output++ = static_cast<char>(bits >> 16);
+      *output++ = static_cast<char>(bits >> 8);
+      *output++ = static_cast<char>(bits);
+      bits = 0;
+      count = 0;
     }
   }
 
-  if (i != 0) {
-    size_t j;
-
-    for (j = i; j < 4; j++) {
-      array4[j] = 0;
-    }
-    for (j = 0; j < 4; j++) {
-      array4[j] = static_cast<unsigned char>(chars.find(array4[j]));
-    }
-    array3[0] = (array4[0] << 2) + ((array4[1] & 0x30) >> 4);
-    array3[1] = ((array4[1] & 0xf) << 4) + ((array4[2] & 0x3c) >> 2);
-    array3[2] = ((array4[2] & 0x3) << 6) + array4[3];
-    for (j = 0; (j < i - 1); j++) {
-      result += array3[j];
-    }
+  // Decode the remaining two or three characters, if any. A single
+  // remaining character does not make up a whole byte.
+  if (count == 2) {
+    *output++ = static_cast<char>(bits >> 4);
+  } else if (count == 3) {
+    *output++ = static_cast<char>(bits >> 10);
+    *output++ = static_cast<char>(bits >> 2);
   }
 
+  result.resize(output - result.data());
+
   return result;
 }
 
@@ -0,0 +1,444 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __STOUT_FLAT_HASHMAP_HPP__
+#define __STOUT_FLAT_HASHMAP_HPP__
+
+#include <stddef.h>
+
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <list>
+#include <map>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "hashset.hpp"
+#include "option.hpp"
+
+
+// Provides a hash map with open addressing (i.e., linear probing)
+// that stores its entries in a single flat array, rather than in one
+// allocated node per entry like 'std::unordered_map' (and thus like
+// 'hashmap'). Lookups touch contiguous memory and inserting an entry
+// does not allocate unless the map needs to grow. The API mirrors the
+// one of 'hashmap'.
+//
+// NOTE: Unlike 'hashmap', inserting an entry may move the other
+// entries (when the map grows) and erasing an entry may move the
+// entries after it (to keep the probe sequences intact). Hence any
+// insertion or erasure invalidates all iterators, pointers and
+// references into the map.
+template <typename Key,
+          typename Value,
+          typename Hash = std::hash<Key>,
+          typename Equal = std::equal_to<Key>>
+class flat_hashmap
+{
+public:
+  typedef Key key_type;
+  typedef Value mapped_type;
+  typedef std::pair<const Key, Value> value_type;
+  typedef size_t size_type;
+
+private:
+  typedef Option<value_type> Slot;
+
+  template <typename Slots, typename Entry>
+  class Iterator
+    : public std::iterator<std::forward_iterator_tag, Entry>
+  {
+  public:
+    Iterator() : slots(nullptr), index(0) {}
+
+    // Allows converting an 'iterator' into a 'const_iterator'.
+    template <typename S, typename E>
+    Iterator(const Iterator<S, E>& that)
+      : slots(that.slots), index(that.index) {}
+
+    Entry& operator*() const { return slots->at(index).get(); }
+    Entry* operator->() const { return &slots->at(index).get(); }
+
+    Iterator& operator++()
+    {
+      index = next(*slots, index + 1);
+      return *this;
+    }
+
+    Iterator operator++(int)
+    {
+      Iterator result = *this;
+      ++(*this);
+      return result;
+    }
+
+    template <typename S, typename E>
+    bool operator==(const Iterator<S, E>& that) const
+    {
+      return index == that.index;
+    }
+
+    template <typename S, typename E>
+    bool operator!=(const Iterator<S, E>& that) const
+    {
+      return index != that.index;
+    }
+
+  private:
+    friend class flat_hashmap;
+    template <typename S, typename E> friend class Iterator;
+
+    Iterator(Slots* _slots, size_t _index) : slots(_slots), index(_index) {}
+
+    Slots* slots;
+    size_t index;
+  };
+
+public:
+  typedef Iterator<std::vector<Slot>, value_type> iterator;
+  typedef Iterator<const std::vector<Slot>, const value_type> const_iterator;
+
+  // An explicit default constructor is needed so
+  // 'const flat_hashmap<T> map;' is not an error.
+  flat_hashmap() : count_(0) {}
+
+  // An implicit constructor for converting from a std::map.
+  flat_hashmap(const std::map<Key, Value>& map) : count_(0)
+  {
+    reserve(map.size());
+
+    for (auto iterator = map.begin(); iterator != map.end(); ++iterator) {
+      insert(*iterator);
+    }
+  }
+
+  // Allow simple construction via initializer list.
+  flat_hashmap(std::initializer_list<std::pair<Key, Value>> list)
+    : count_(0)
+  {
+    reserve(list.size());
+
+    for (auto iterator = list.begin(); iterator != list.end(); ++iterator) {
+      insert(*iterator);
+    }
+  }
+
+  // Checks whether this map contains a binding for a key.
+  bool contains(const Key& key) const { return lookup(key).isSome(); }
+
+  // Checks whether there exists a bound key to this value.
+  bool containsValue(const Value& v) const
+  {
+    for (const value_type& entry : *this) {
+      if (entry.second == v) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Inserts a key, value pair into the map replacing an old value
+  // if the key is already present.
+  void put(const Key& key, Value&& value)
+  {
+    Option<size_t> index = lookup(key);
+    if (index.isSome()) {
+      slots[index.get()]->second = std::move(value);
+    } else {
+      emplace(key, std::move(value));
+    }
+  }
+
+  // Inserts a key, value pair into the map replacing an old value
+  // if the key is already present.
+  void put(const Key& key, const Value& value)
+  {
+    Option<size_t> index = lookup(key);
+    if (index.isSome()) {
+      slots[index.get()]->second = value;
+    } else {
+      emplace(key, value);
+    }
+  }
+
+  // Returns an Option for the binding to the key.
+  Option<Value> get(const Key& key) const
+  {
+    Option<size_t> index = lookup(key);
+    if (index.isNone()) {
+      return None();
+    }
+    return slots[index.get()]->second;
+  }
+
+  // Returns the set of keys in this map.
+  // TODO(vinod/bmahler): Should return a list instead.
+  hashset<Key, Hash, Equal> keys() const
+  {
+    hashset<Key, Hash, Equal> result;
+    for (const value_type& entry : *this) {
+      result.insert(entry.first);
+    }
+    return result;
+  }
+
+  // Returns the list of values in this map.
+  std::list<Value> values() const
+  {
+    std::list<Value> result;
+    for (const value_type& entry : *this) {
+      result.push_back(entry.second);
+    }
+    return result;
+  }
+
+  Value& operator[](const Key& key)
+  {
+    Option<size_t> index = lookup(key);
+    if (index.isNone()) {
+      index = emplace(key, Value());
+    }
+    return slots[index.get()]->second;
+  }
+
+  Value& at(const Key& key)
+  {
+    Option<size_t> index = lookup(key);
+    if (index.isNone()) {
+      throw std::out_of_range("flat_hashmap::at");
+    }
+    return slots[index.get()]->second;
+  }
+
+  const Value& at(const Key& key) const
+  {
+    Option<size_t> index = lookup(key);
+    if (index.isNone()) {
+      throw std::out_of_range("flat_hashmap::at");
+    }
+    return slots[index.get()]->second;
+  }
+
+  iterator find(const Key& key)
+  {
+    Option<size_t> index = lookup(key);
+    return index.isSome() ? iterator(&slots, index.get()) : end();
+  }
+
+  const_iterator find(const Key& key) const
+  {
+    Option<size_t> index = lookup(key);
+    return index.isSome() ? const_iterator(&slots, index.get()) : end();
+  }
+
+  size_t count(const Key& key) const { return contains(key) ? 1 : 0; }
+
+  std::pair<iterator, bool> insert(const std::pair<Key, Value>& entry)
+  {
+    Option<size_t> index = lookup(entry.first);
+    if (index.isSome()) {
+      return std::make_pair(iterator(&slots, index.get()), false);
+    }
+    index = emplace(entry.first, entry.second);
+    return std::make_pair(iterator(&slots, index.get()), true);
+  }
+
+  // Removes the binding for the key, if any, and returns the number
+  // of removed entries (i.e., 0 or 1).
+  size_t erase(const Key& key)
+  {
+    Option<size_t> index = lookup(key);
+    if (index.isNone()) {
+      return 0;
+    }
+    remove(index.get());
+    return 1;
+  }
+
+  // Removes the entry the iterator points to and returns an iterator
+  // to the entry that then takes its place in the iteration order.
+  //
+  // NOTE: Since erasing moves entries within the map, iterating while
+  // erasing (e.g., `it = map.erase(it)`) may visit an entry twice or
+  // skip it. Collect the keys to erase first instead.
+  iterator erase(const_iterator position)
+  {
+    size_t index = position.index;
+    remove(index);
+    return iterator(&slots, next(slots, index));
+  }
+
+  void clear()
+  {
+    slots.clear();
+    count_ = 0;
+  }
+
+  // Makes room for at least the given number of entries without
+  // growing the map any further.
+  void reserve(size_t size)
+  {
+    size_t capacity = slots.size();
+    if (capacity == 0) {
+      capacity = INITIAL_CAPACITY;
+    }
+
+    while (size * MAX_LOAD_DENOMINATOR > capacity * MAX_LOAD_NUMERATOR) {
+      capacity *= 2;
+    }
+
+    if (capacity > slots.size()) {
+      rehash(capacity);
+    }
+  }
+
+  size_t size() const { return count_; }
+  bool empty() const { return count_ == 0; }
+
+  iterator begin() { return iterator(&slots, next(slots, 0)); }
+  iterator end() { return iterator(&slots, slots.size()); }
+
+  const_iterator begin() const
+  {
+    return const_iterator(&slots, next(slots, 0));
+  }
+
+  const_iterator end() const { return const_iterator(&slots, slots.size()); }
+
+  bool operator==(const flat_hashmap& that) const
+  {
+    if (size() != that.size()) {
+      return false;
+    }
+
+    for (const value_type& entry : *this) {
+      Option<size_t> index = that.lookup(entry.first);
+      if (index.isNone()) {
+        return false;
+      }
+
+      if (!(that.slots[index.get()]->second == entry.second)) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  bool operator!=(const flat_hashmap& that) const { return !(*this == that); }
+
+private:
+  // The capacity is always a power of two, so that the ideal slot of
+  // a key can be computed with a mask rather than a modulo.
+  static const size_t INITIAL_CAPACITY = 8;
+
+  // The map grows once it is more than 3/4 full, which keeps the
+  // probe sequences short.
+  static const size_t MAX_LOAD_NUMERATOR = 3;
+  static const size_t MAX_LOAD_DENOMINATOR = 4;
+
+  // Returns the index of the first occupied slot at or after 'index',
+  // or the number of slots if there is none.
+  static size_t next(const std::vector<Slot>& slots, size_t index)
+  {
+    while (index < slots.size() && slots[index].isNone()) {
+      ++index;
+    }
+    return index;
+  }
+
+  size_t mask() const { return slots.size() - 1; }
+
+  size_t ideal(const Key& key) const { return hasher(key) & mask(); }
+
+  // Returns the index of the slot holding the key, if any.
+  Option<size_t> lookup(const Key& key) const
+  {
+    if (count_ == 0) {
+      return None();
+    }
+
+    for (size_t index = ideal(key);; index = (index + 1) & mask()) {
+      if (slots[index].isNone()) {
+        return None();
+      }
+
+      if (equal(slots[index]->first, key)) {
+        return index;
+      }
+    }
+  }
+
+  // Stores a new entry for a key that is not yet in the map and
+  // returns the index of its slot.
+  template <typename V>
+  size_t emplace(const Key& key, V&& value)
+  {
+    reserve(count_ + 1);
+
+    size_t index = ideal(key);
+    while (slots[index].isSome()) {
+      index = (index + 1) & mask();
+    }
+
+    slots[index] = value_type(key, std::forward<V>(value));
+    ++count_;
+
+    return index;
+  }
+
+  // Empties the slot at the given index. To keep the probe sequences
+  // intact (i.e., without leaving 'tombstones' behind), the following
+  // entries of the cluster are shifted back into the hole if it lies
+  // on the way from their ideal slot to their current slot.
+  void remove(size_t hole)
+  {
+    slots[hole] = None();
+    --count_;
+
+    for (size_t index = (hole + 1) & mask();
+         slots[index].isSome();
+         index = (index + 1) & mask()) {
+      size_t distance = (index - ideal(slots[index]->first)) & mask();
+      if (distance >= ((index - hole) & mask())) {
+        slots[hole] = std::move(slots[index]);
+        slots[index] = None();
+        hole = index;
+      }
+    }
+  }
+
+  void rehash(size_t capacity)
+  {
+    std::vector<Slot> previous(capacity);
+    std::swap(slots, previous);
+
+    for (size_t index = 0; index < previous.size(); ++index) {
+      if (previous[index].isSome()) {
+        size_t slot = ideal(previous[index]->first);
+        while (slots[slot].isSome()) {
+          slot = (slot + 1) & mask();
+        }
+        slots[slot] = std::move(previous[index]);
+      }
+    }
+  }
+
+  std::vector<Slot> slots;
+  size_t count_;
+  Hash hasher;
+  Equal equal;
+};
+
+#endif // __STOUT_FLAT_HASHMAP_HPP__
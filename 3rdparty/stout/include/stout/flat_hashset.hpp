@@ -0,0 +1,310 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __STOUT_FLAT_HASHSET_HPP__
+#define __STOUT_FLAT_HASHSET_HPP__
+
+#include <stddef.h>
+
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "option.hpp"
+
+
+// Provides a hash set with open addressing (i.e., linear probing)
+// that stores its elements in a single flat array, see 'flat_hashmap'.
+// The API mirrors the one of 'hashset'.
+//
+// NOTE: Unlike 'hashset', any insertion or erasure invalidates all
+// iterators, pointers and references into the set.
+template <typename Elem,
+          typename Hash = std::hash<Elem>,
+          typename Equal = std::equal_to<Elem>>
+class flat_hashset
+{
+public:
+  typedef Elem key_type;
+  typedef Elem value_type;
+  typedef size_t size_type;
+
+private:
+  typedef Option<Elem> Slot;
+
+public:
+  // Only constant iterators are provided since modifying an element
+  // in place would change its hash.
+  class const_iterator
+    : public std::iterator<std::forward_iterator_tag, const Elem>
+  {
+  public:
+    const_iterator() : slots(nullptr), index(0) {}
+
+    const Elem& operator*() const { return slots->at(index).get(); }
+    const Elem* operator->() const { return &slots->at(index).get(); }
+
+    const_iterator& operator++()
+    {
+      index = next(*slots, index + 1);
+      return *this;
+    }
+
+    const_iterator operator++(int)
+    {
+      const_iterator result = *this;
+      ++(*this);
+      return result;
+    }
+
+    bool operator==(const const_iterator& that) const
+    {
+      return index == that.index;
+    }
+
+    bool operator!=(const const_iterator& that) const
+    {
+      return index != that.index;
+    }
+
+  private:
+    friend class flat_hashset;
+
+    const_iterator(const std::vector<Slot>* _slots, size_t _index)
+      : slots(_slots), index(_index) {}
+
+    const std::vector<Slot>* slots;
+    size_t index;
+  };
+
+  typedef const_iterator iterator;
+
+  // An explicit default constructor is needed so
+  // 'const flat_hashset<T> set;' is not an error.
+  flat_hashset() : count_(0) {}
+
+  // An implicit constructor for converting from a std::set.
+  flat_hashset(const std::set<Elem>& set) : count_(0)
+  {
+    reserve(set.size());
+
+    for (auto iterator = set.begin(); iterator != set.end(); ++iterator) {
+      insert(*iterator);
+    }
+  }
+
+  // Allow simple construction via initializer list.
+  flat_hashset(std::initializer_list<Elem> list) : count_(0)
+  {
+    reserve(list.size());
+
+    for (auto iterator = list.begin(); iterator != list.end(); ++iterator) {
+      insert(*iterator);
+    }
+  }
+
+  // Checks whether this set contains the element.
+  bool contains(const Elem& elem) const { return lookup(elem).isSome(); }
+
+  // Checks whether this set is a superset of the given set.
+  bool contains(const flat_hashset& set) const
+  {
+    for (const Elem& elem : set) {
+      if (!contains(elem)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  std::pair<const_iterator, bool> insert(const Elem& elem)
+  {
+    Option<size_t> index = lookup(elem);
+    if (index.isSome()) {
+      return std::make_pair(const_iterator(&slots, index.get()), false);
+    }
+    index = emplace(elem);
+    return std::make_pair(const_iterator(&slots, index.get()), true);
+  }
+
+  std::pair<const_iterator, bool> insert(Elem&& elem)
+  {
+    Option<size_t> index = lookup(elem);
+    if (index.isSome()) {
+      return std::make_pair(const_iterator(&slots, index.get()), false);
+    }
+    index = emplace(std::move(elem));
+    return std::make_pair(const_iterator(&slots, index.get()), true);
+  }
+
+  const_iterator find(const Elem& elem) const
+  {
+    Option<size_t> index = lookup(elem);
+    return index.isSome() ? const_iterator(&slots, index.get()) : end();
+  }
+
+  size_t count(const Elem& elem) const { return contains(elem) ? 1 : 0; }
+
+  // Removes the element, if any, and returns the number of removed
+  // elements (i.e., 0 or 1).
+  size_t erase(const Elem& elem)
+  {
+    Option<size_t> index = lookup(elem);
+    if (index.isNone()) {
+      return 0;
+    }
+    remove(index.get());
+    return 1;
+  }
+
+  void clear()
+  {
+    slots.clear();
+    count_ = 0;
+  }
+
+  // Makes room for at least the given number of elements without
+  // growing the set any further.
+  void reserve(size_t size)
+  {
+    size_t capacity = slots.size();
+    if (capacity == 0) {
+      capacity = INITIAL_CAPACITY;
+    }
+
+    while (size * MAX_LOAD_DENOMINATOR > capacity * MAX_LOAD_NUMERATOR) {
+      capacity *= 2;
+    }
+
+    if (capacity > slots.size()) {
+      rehash(capacity);
+    }
+  }
+
+  size_t size() const { return count_; }
+  bool empty() const { return count_ == 0; }
+
+  const_iterator begin() const
+  {
+    return const_iterator(&slots, next(slots, 0));
+  }
+
+  const_iterator end() const { return const_iterator(&slots, slots.size()); }
+
+  bool operator==(const flat_hashset& that) const
+  {
+    return size() == that.size() && contains(that);
+  }
+
+  bool operator!=(const flat_hashset& that) const { return !(*this == that); }
+
+private:
+  // See 'flat_hashmap' for the meaning of these constants.
+  static const size_t INITIAL_CAPACITY = 8;
+  static const size_t MAX_LOAD_NUMERATOR = 3;
+  static const size_t MAX_LOAD_DENOMINATOR = 4;
+
+  // Returns the index of the first occupied slot at or after 'index',
+  // or the number of slots if there is none.
+  static size_t next(const std::vector<Slot>& slots, size_t index)
+  {
+    while (index < slots.size() && slots[index].isNone()) {
+      ++index;
+    }
+    return index;
+  }
+
+  size_t mask() const { return slots.size() - 1; }
+
+  size_t ideal(const Elem& elem) const { return hasher(elem) & mask(); }
+
+  // Returns the index of the slot holding the element, if any.
+  Option<size_t> lookup(const Elem& elem) const
+  {
+    if (count_ == 0) {
+      return None();
+    }
+
+    for (size_t index = ideal(elem);; index = (index + 1) & mask()) {
+      if (slots[index].isNone()) {
+        return None();
+      }
+
+      if (equal(slots[index].get(), elem)) {
+        return index;
+      }
+    }
+  }
+
+  // Stores an element that is not yet in the set and returns the
+  // index of its slot.
+  template <typename E>
+  size_t emplace(E&& elem)
+  {
+    reserve(count_ + 1);
+
+    size_t index = ideal(elem);
+    while (slots[index].isSome()) {
+      index = (index + 1) & mask();
+    }
+
+    slots[index] = Elem(std::forward<E>(elem));
+    ++count_;
+
+    return index;
+  }
+
+  // Empties the slot at the given index and shifts the following
+  // elements of the cluster back, see 'flat_hashmap::remove'.
+  void remove(size_t hole)
+  {
+    slots[hole] = None();
+    --count_;
+
+    for (size_t index = (hole + 1) & mask();
+         slots[index].isSome();
+         index = (index + 1) & mask()) {
+      size_t distance = (index - ideal(slots[index].get())) & mask();
+      if (distance >= ((index - hole) & mask())) {
+        slots[hole] = std::move(slots[index]);
+        slots[index] = None();
+        hole = index;
+      }
+    }
+  }
+
+  void rehash(size_t capacity)
+  {
+    std::vector<Slot> previous(capacity);
+    std::swap(slots, previous);
+
+    for (size_t index = 0; index < previous.size(); ++index) {
+      if (previous[index].isSome()) {
+        size_t slot = ideal(previous[index].get());
+        while (slots[slot].isSome()) {
+          slot = (slot + 1) & mask();
+        }
+        slots[slot] = std::move(previous[index]);
+      }
+    }
+  }
+
+  std::vector<Slot> slots;
+  size_t count_;
+  Hash hasher;
+  Equal equal;
+};
+
+#endif // __STOUT_FLAT_HASHSET_HPP__
@@ -19,21 +19,46 @@
 
 #include <stout/abort.hpp>
 #include <stout/error.hpp>
-#include <stout/os/strerror.hpp>
+#include <stout/nothing.hpp>
+#include <stout/result.hpp>
 #include <stout/stringify.hpp>
 #include <stout/try.hpp>
 
+#include <stout/os/read.hpp>
+#include <stout/os/strerror.hpp>
+#include <stout/os/write.hpp>
+
 
 // Compression utilities.
-// TODO(bmahler): Provide streaming compression as well.
 namespace gzip {
 
+// The format of the compressed data: either gzip (RFC 1952), as used by
+// the "gzip" HTTP content coding, or zlib (RFC 1950), as used by the
+// "deflate" HTTP content coding.
+enum class Format
+{
+  GZIP,
+  ZLIB
+};
+
 namespace internal {
 
 // We use a 16KB buffer with zlib compression / decompression.
 #define GZIP_BUFFER_SIZE 16384
 
 
+inline int windowBits(Format format)
+{
+  switch (format) {
+    // Zlib magic for gzip compression / decompression.
+    case Format::GZIP: return MAX_WBITS + 16;
+    case Format::ZLIB: return MAX_WBITS;
+  }
+
+  return MAX_WBITS + 16;
+}
+
+
 class GzipError : public Error
 {
 public:
@@ -88,7 +113,7 @@ private:
 class Decompressor
 {
 public:
-  Decompressor()
+  explicit Decompressor(Format format = Format::GZIP)
     : _finished(false)
   {
     stream.zalloc = Z_NULL;
@@ -97,9 +122,7 @@ public:
     stream.next_in = Z_NULL;
     stream.avail_in = 0;
 
-    int code = inflateInit2(
-        &stream,
-        MAX_WBITS + 16); // Zlib magic for gzip compression / decompression.
+    int code = inflateInit2(&stream, internal::windowBits(format));
 
     if (code != Z_OK) {
       Error error = internal::GzipError("Failed to inflateInit2", stream, code);
@@ -169,7 +192,127 @@ private:
 };
 
 
-// Returns a gzip compressed version of the provided string.
+// Provides the ability to incrementally compress
+// a stream of input data.
+class Compressor
+{
+public:
+  // The compression level must be within the range [-1, 9], see
+  // `compress` below.
+  explicit Compressor(
+      int level = Z_DEFAULT_COMPRESSION,
+      Format format = Format::GZIP)
+    : _finished(false)
+  {
+    stream.zalloc = Z_NULL;
+    stream.zfree = Z_NULL;
+    stream.opaque = Z_NULL;
+    stream.next_in = Z_NULL;
+    stream.avail_in = 0;
+
+    int code = deflateInit2(
+        &stream,
+        level,                        // Compression level.
+        Z_DEFLATED,                   // Compression method.
+        internal::windowBits(format), // Format of the compressed data.
+        8,                            // Default memLevel value.
+        Z_DEFAULT_STRATEGY);
+
+    if (code != Z_OK) {
+      Error error = internal::GzipError("Failed to deflateInit2", stream, code);
+      ABORT(error.message);
+    }
+  }
+
+  Compressor(const Compressor&) = delete;
+  Compressor& operator=(const Compressor&) = delete;
+
+  ~Compressor()
+  {
+    // NOTE: `deflateEnd` returns Z_DATA_ERROR if the stream was not
+    // finished, which is fine since it still frees the stream.
+    int code = deflateEnd(&stream);
+    if (code != Z_OK && code != Z_DATA_ERROR) {
+      ABORT("Failed to deflateEnd");
+    }
+  }
+
+  // Returns the next compressed chunk of data, or an Error if
+  // compression fails. Since the input gets buffered until there is
+  // enough to compress, the chunk may well be empty.
+  Try<std::string> compress(const std::string& decompressed)
+  {
+    return deflate(decompressed, Z_NO_FLUSH);
+  }
+
+  // Returns the remaining compressed data of all the input so far,
+  // so that the receiver can decompress all of it (e.g., for each
+  // chunk of a streaming response). Flushing too often degrades the
+  // compression.
+  Try<std::string> flush()
+  {
+    return deflate("", Z_SYNC_FLUSH);
+  }
+
+  // Returns the remaining compressed data and ends the compression
+  // stream, after which no more input can be compressed.
+  Try<std::string> finish()
+  {
+    return deflate("", Z_FINISH);
+  }
+
+  // Returns whether the compression stream is finished.
+  bool finished() const
+  {
+    return _finished;
+  }
+
+private:
+  Try<std::string> deflate(const std::string& decompressed, int flush)
+  {
+    if (_finished) {
+      return Error("Stream finished");
+    }
+
+    stream.next_in =
+      const_cast<Bytef*>(reinterpret_cast<const Bytef*>(decompressed.data()));
+    stream.avail_in = decompressed.length();
+
+    // Build up the compressed result. Once `deflate` leaves space in
+    // the buffer, it consumed all the input and flushed as requested.
+    Bytef buffer[GZIP_BUFFER_SIZE];
+    std::string result;
+
+    do {
+      stream.next_out = buffer;
+      stream.avail_out = GZIP_BUFFER_SIZE;
+
+      int code = ::deflate(&stream, flush);
+
+      _finished = code == Z_STREAM_END;
+
+      // NOTE: Z_BUF_ERROR only means that no progress was possible,
+      // e.g., when flushing without any new input.
+      if (code != Z_OK && code != Z_BUF_ERROR && !_finished) {
+        return internal::GzipError("Failed to deflate", stream, code);
+      }
+
+      // Consume output and reset the buffer.
+      result.append(
+          reinterpret_cast<char*>(buffer),
+          GZIP_BUFFER_SIZE - stream.avail_out);
+    } while (stream.avail_out == 0);
+
+    return result;
+  }
+
+  z_stream_s stream;
+  bool _finished;
+};
+
+
+// Returns a compressed version of the provided string, in the gzip
+// format unless otherwise specified.
 // The compression level should be within the range [-1, 9].
 // See zlib.h:
 //   #define Z_NO_COMPRESSION         0
@@ -178,7 +321,8 @@ private:
 //   #define Z_DEFAULT_COMPRESSION  (-1)
 inline Try<std::string> compress(
     const std::string& decompressed,
-    int level = Z_DEFAULT_COMPRESSION)
+    int level = Z_DEFAULT_COMPRESSION,
+    Format format = Format::GZIP)
 {
   // Verify the level is within range.
   if (!(level == Z_DEFAULT_COMPRESSION ||
@@ -186,63 +330,31 @@ inline Try<std::string> compress(
     return Error("Invalid compression level: " + stringify(level));
   }
 
-  z_stream_s stream;
-  stream.next_in =
-    const_cast<Bytef*>(reinterpret_cast<const Bytef*>(decompressed.data()));
-  stream.avail_in = decompressed.length();
-  stream.zalloc = Z_NULL;
-  stream.zfree = Z_NULL;
-  stream.opaque = Z_NULL;
-
-  int code = deflateInit2(
-      &stream,
-      level,          // Compression level.
-      Z_DEFLATED,     // Compression method.
-      MAX_WBITS + 16, // Zlib magic for gzip compression / decompression.
-      8,              // Default memLevel value.
-      Z_DEFAULT_STRATEGY);
-
-  if (code != Z_OK) {
-    Error error = internal::GzipError("Failed to deflateInit2", stream, code);
-    ABORT(error.message);
-  }
-
-  // Build up the compressed result.
-  Bytef buffer[GZIP_BUFFER_SIZE];
-  std::string result;
-  do {
-    stream.next_out = buffer;
-    stream.avail_out = GZIP_BUFFER_SIZE;
-    code = deflate(&stream, stream.avail_in > 0 ? Z_NO_FLUSH : Z_FINISH);
-
-    if (code != Z_OK && code != Z_STREAM_END) {
-      Error error = internal::GzipError("Failed to deflate", stream, code);
-      if (deflateEnd(&stream) != Z_OK) {
-        ABORT("Failed to deflateEnd");
-      }
-      return error;
-    }
+  Compressor compressor(level, format);
 
-    // Consume output and reset the buffer.
-    result.append(
-        reinterpret_cast<char*>(buffer),
-        GZIP_BUFFER_SIZE - stream.avail_out);
-    stream.next_out = buffer;
-    stream.avail_out = GZIP_BUFFER_SIZE;
-  } while (code != Z_STREAM_END);
+  Try<std::string> result = compressor.compress(decompressed);
+  if (result.isError()) {
+    return result;
+  }
 
-  if (deflateEnd(&stream) != Z_OK) {
-    ABORT("Failed to deflateEnd");
+  Try<std::string> remaining = compressor.finish();
+  if (remaining.isError()) {
+    return remaining;
   }
 
+  result->append(remaining.get());
+
   return result;
 }
 
 
-// Returns a gzip decompressed version of the provided string.
-inline Try<std::string> decompress(const std::string& compressed)
+// Returns a decompressed version of the provided string, which is in
+// the gzip format unless otherwise specified.
+inline Try<std::string> decompress(
+    const std::string& compressed,
+    Format format = Format::GZIP)
 {
-  Decompressor decompressor;
+  Decompressor decompressor(format);
   Try<std::string> decompressed = decompressor.decompress(compressed);
 
   // Ensure that the decompression stream does not expect more input.
@@ -253,6 +365,87 @@ inline Try<std::string> decompress(const std::string& compressed)
   return decompressed;
 }
 
+
+// Compresses the data read from the file descriptor 'in' until EOF
+// and writes it to the file descriptor 'out', in the gzip format
+// unless otherwise specified. Unlike compressing a string, this only
+// holds a bounded amount of the data in memory at any time.
+inline Try<Nothing> compress(
+    int in,
+    int out,
+    int level = Z_DEFAULT_COMPRESSION,
+    Format format = Format::GZIP)
+{
+  // Verify the level is within range.
+  if (!(level == Z_DEFAULT_COMPRESSION ||
+      (level >= Z_NO_COMPRESSION && level <= Z_BEST_COMPRESSION))) {
+    return Error("Invalid compression level: " + stringify(level));
+  }
+
+  Compressor compressor(level, format);
+
+  while (!compressor.finished()) {
+    Result<std::string> read = os::read(in, GZIP_BUFFER_SIZE);
+    if (read.isError()) {
+      return Error("Failed to read: " + read.error());
+    }
+
+    Try<std::string> compressed = read.isNone()
+      ? compressor.finish()
+      : compressor.compress(read.get());
+
+    if (compressed.isError()) {
+      return Error(compressed.error());
+    }
+
+    Try<Nothing> write = os::write(out, compressed.get());
+    if (write.isError()) {
+      return Error("Failed to write: " + write.error());
+    }
+  }
+
+  return Nothing();
+}
+
+
+// Decompresses the data read from the file descriptor 'in' until EOF,
+// which is in the gzip format unless otherwise specified, and writes
+// it to the file descriptor 'out'. Only a bounded amount of the
+// compressed data is held in memory at any time.
+inline Try<Nothing> decompress(
+    int in,
+    int out,
+    Format format = Format::GZIP)
+{
+  Decompressor decompressor(format);
+
+  while (true) {
+    Result<std::string> read = os::read(in, GZIP_BUFFER_SIZE);
+    if (read.isError()) {
+      return Error("Failed to read: " + read.error());
+    } else if (read.isNone()) {
+      break;
+    }
+
+    Try<std::string> decompressed = decompressor.decompress(read.get());
+    if (decompressed.isError()) {
+      return Error(decompressed.error());
+    }
+
+    Try<Nothing> write = os::write(out, decompressed.get());
+    if (write.isError()) {
+      return Error("Failed to write: " + write.error());
+    }
+  }
+
+  // Ensure that the decompression stream does not expect more input.
+  if (!decompressor.finished()) {
+    return Error("More input is expected");
+  }
+
+  return Nothing();
+}
+
 } // namespace gzip {
 
 #endif // __STOUT_GZIP_HPP__
@@ -13,15 +13,12 @@
 #ifndef __STOUT_JSON__
 #define __STOUT_JSON__
 
-// NOTE: This undef is necessary because we cannot reliably re-order the
-// include statements in all cases.  We define this flag globally since
-// PicoJson requires it before importing <inttypes.h>.  However, other
-// libraries may import <inttypes.h> before we import <picojson.h>.
-// Hence, we undefine the flag here to prevent the redefinition error.
-#undef __STDC_FORMAT_MACROS
-#include <picojson.h>
-#define __STDC_FORMAT_MACROS
+#include <errno.h>
+#include <stdint.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
 #include <iomanip>
 #include <iostream>
 #include <limits>
@@ -39,6 +36,7 @@
 #include <stout/jsonify.hpp>
 #include <stout/numify.hpp>
 #include <stout/result.hpp>
+#include <stout/stringify.hpp>
 #include <stout/strings.hpp>
 #include <stout/try.hpp>
 #include <stout/unreachable.hpp>
@@ -80,11 +78,11 @@ struct String
 };
 
 
-// NOTE: Due to how PicoJson parses unsigned integers, a roundtrip from Number
-// to JSON and back to Number will result in:
+// NOTE: Due to how `parse` parses unsigned integers (the same way as
+// PicoJson, which it used to be based on), a roundtrip from Number to
+// JSON and back to Number will result in:
 //   - a signed integer, if the value is less than or equal to INT64_MAX;
 //   - or a double, if the value is greater than INT64_MAX.
-// See: https://github.com/kazuho/picojson/blob/rel/v1.3.0/picojson.h#L777-L781
 struct Number
 {
   Number() : value(0) {}
@@ -728,65 +726,405 @@ inline std::ostream& operator<<(std::ostream& stream, const Null&)
 
 namespace internal {
 
-inline Value convert(const picojson::value& value)
-{
-  if (value.is<picojson::null>()) {
-    return Null();
-  } else if (value.is<bool>()) {
-    return Boolean(value.get<bool>());
-  } else if (value.is<picojson::value::object>()) {
-    Object object;
-    foreachpair (const std::string& name,
-                 const picojson::value& v,
-                 value.get<picojson::value::object>()) {
-      object.values[name] = convert(v);
-    }
-    return object;
-  } else if (value.is<picojson::value::array>()) {
-    Array array;
-    foreach (const picojson::value& v, value.get<picojson::value::array>()) {
-      array.values.push_back(convert(v));
-    }
-    return array;
-  } else if (value.is<int64_t>()) {
-    return Number(value.get<int64_t>());
-  } else if (value.is<double>()) {
-    return Number(value.get<double>());
-  } else if (value.is<std::string>()) {
-    return String(value.get<std::string>());
-  }
-  return Null();
-}
+// A recursive descent parser that builds the `Value` in a single
+// pass over the input: objects, arrays and strings are filled in
+// place rather than first parsed into an intermediate tree that is
+// then converted (i.e., copied) into a `Value`.
+//
+// NOTE: This accepts the same grammar as (and parses numbers like)
+// PicoJson, which we used to parse with: a number is parsed as a
+// signed integer if it fits into an `int64_t`, and as a double
+// otherwise.
+class Parser
+{
+public:
+  Parser(const char* _begin, const char* _end)
+    : begin(_begin), cursor(_begin), end(_end) {}
 
-} // namespace internal {
+  Try<Value> parse()
+  {
+    Value value;
 
+    if (!parse(&value)) {
+      return Error(error());
+    }
 
-inline Try<Value> parse(const std::string& s)
-{
-  const char* parseBegin = s.c_str();
-  picojson::value value;
-  std::string error;
+    skipWhitespace();
+
+    if (cursor != end) {
+      const char* last = end;
+      while (last != cursor && isWhitespace(*(last - 1))) {
+        --last;
+      }
+
+      return Error(
+          "Parsed JSON included non-whitespace trailing characters: " +
+          std::string(cursor, last));
+    }
+
+    return value;
+  }
+
+private:
+  static bool isWhitespace(char c)
+  {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+  }
+
+  void skipWhitespace()
+  {
+    while (cursor != end && isWhitespace(*cursor)) {
+      ++cursor;
+    }
+  }
+
+  // Skips any whitespace and then consumes the character if it
+  // matches the expected one.
+  bool consume(char c)
+  {
+    skipWhitespace();
+
+    if (cursor != end && *cursor == c) {
+      ++cursor;
+      return true;
+    }
+
+    return false;
+  }
+
+  bool consume(const char* literal)
+  {
+    for (; *literal != '\0'; ++literal, ++cursor) {
+      if (cursor == end || *cursor != *literal) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  // Returns the error for the current position, in the same format
+  // as PicoJson, e.g., 'syntax error at line 1 near: ...'.
+  std::string error() const
+  {
+    std::string result =
+      "syntax error at line " +
+      stringify(1 + std::count(begin, cursor, '\n')) + " near: ";
+
+    for (const char* c = cursor; c != end && *c != '\n'; ++c) {
+      if (static_cast<unsigned char>(*c) >= ' ') {
+        result.push_back(*c);
+      }
+    }
+
+    return result;
+  }
+
+  bool parse(Value* value)
+  {
+    skipWhitespace();
+
+    if (cursor == end) {
+      return false;
+    }
+
+    switch (*cursor) {
+      case 'n':
+        *value = Null();
+        return consume("null");
+      case 't':
+        *value = Boolean(true);
+        return consume("true");
+      case 'f':
+        *value = Boolean(false);
+        return consume("false");
+      case '"':
+        ++cursor;
+        *value = String();
+        return parse(&boost::get<String>(*value).value);
+      case '[':
+        ++cursor;
+        *value = Array();
+        return parse(&boost::get<Array>(*value));
+      case '{':
+        ++cursor;
+        *value = Object();
+        return parse(&boost::get<Object>(*value));
+      default:
+        if (*cursor == '-' || (*cursor >= '0' && *cursor <= '9')) {
+          Number number;
+          if (!parse(&number)) {
+            return false;
+          }
+          *value = number;
+          return true;
+        }
+        return false;
+    }
+  }
+
+  bool parse(Object* object)
+  {
+    if (consume('}')) {
+      return true;
+    }
+
+    std::string key;
+
+    do {
+      key.clear();
+
+      if (!consume('"') || !parse(&key) || !consume(':')) {
+        return false;
+      }
+
+      // NOTE: Like PicoJson, the last value wins for duplicate keys.
+      if (!parse(&object->values[key])) {
+        return false;
+      }
+    } while (consume(','));
+
+    return consume('}');
+  }
+
+  bool parse(Array* array)
+  {
+    if (consume(']')) {
+      return true;
+    }
+
+    do {
+      // Since `Value` is not nothrow move constructible, growing the
+      // vector would (deep) copy all of its elements, so we grow it
+      // ourselves by moving them instead.
+      std::vector<Value>& values = array->values;
+      if (values.size() == values.capacity()) {
+        std::vector<Value> grown;
+        grown.reserve(std::max<size_t>(4, 2 * values.capacity()));
+        for (Value& value : values) {
+          grown.push_back(std::move(value));
+        }
+        values.swap(grown);
+      }
+
+      values.emplace_back();
 
-  // Because PicoJson supports repeated parsing of multiple objects/arrays in a
-  // stream, it will quietly ignore trailing non-whitespace characters. We would
-  // rather throw an error, however, so use `last_char` to check for this.
-  const char* lastVisibleChar =
-    parseBegin + s.find_last_not_of(strings::WHITESPACE);
+      if (!parse(&values.back())) {
+        return false;
+      }
+    } while (consume(','));
+
+    return consume(']');
+  }
+
+  // Parses the rest of a string (i.e., after the opening quote).
+  bool parse(std::string* string)
+  {
+    while (cursor != end) {
+      // Append runs of unescaped characters at once.
+      const char* run = cursor;
+      while (cursor != end &&
+             *cursor != '"' &&
+             *cursor != '\\' &&
+             static_cast<unsigned char>(*cursor) >= ' ') {
+        ++cursor;
+      }
+
+      string->append(run, cursor);
+
+      if (cursor == end || static_cast<unsigned char>(*cursor) < ' ') {
+        return false;
+      }
+
+      if (*cursor++ == '"') {
+        return true;
+      }
+
+      if (cursor == end) {
+        return false;
+      }
+
+      switch (*cursor++) {
+        case '"':
+          string->push_back('"');
+          break;
+        case '\\':
+          string->push_back('\\');
+          break;
+        case '/':
+          string->push_back('/');
+          break;
+        case 'b':
+          string->push_back('\b');
+          break;
+        case 'f':
+          string->push_back('\f');
+          break;
+        case 'n':
+          string->push_back('\n');
+          break;
+        case 'r':
+          string->push_back('\r');
+          break;
+        case 't':
+          string->push_back('\t');
+          break;
+        case 'u':
+          if (!parseCodepoint(string)) {
+            return false;
+          }
+          break;
+        default:
+          return false;
+      }
+    }
+
+    return false;
+  }
+
+  // Parses the four hexadecimal digits of a '\u' escape, returning -1
+  // if they are invalid.
+  int parseHex()
+  {
+    int result = 0;
+
+    for (int i = 0; i < 4; i++, ++cursor) {
+      if (cursor == end) {
+        return -1;
+      }
+
+      const char c = *cursor;
+      if (c >= '0' && c <= '9') {
+        result = result * 16 + (c - '0');
+      } else if (c >= 'a' && c <= 'f') {
+        result = result * 16 + (c - 'a' + 10);
+      } else if (c >= 'A' && c <= 'F') {
+        result = result * 16 + (c - 'A' + 10);
+      } else {
+        return -1;
+      }
+    }
+
+    return result;
+  }
+
+  // Parses a '\u' escape (including the second half of a surrogate
+  // pair, if any) and appends the code point encoded as UTF-8.
+  bool parseCodepoint(std::string* string)
+  {
+    int codepoint = parseHex();
+    if (codepoint == -1) {
+      return false;
+    }
+
+    if (codepoint >= 0xd800 && codepoint <= 0xdfff) {
+      // A low surrogate must follow a high surrogate.
+      if (codepoint >= 0xdc00) {
+        return false;
+      }
 
-  // Parse the string, returning a pointer to the character
-  // immediately following the last one parsed.
-  const char* parseEnd =
-    picojson::parse(value, parseBegin, parseBegin + s.size(), &error);
+      if (!consume("\\u")) {
+        return false;
+      }
+
+      int low = parseHex();
+      if (low < 0xdc00 || low > 0xdfff) {
+        return false;
+      }
+
+      codepoint = 0x10000 + (((codepoint - 0xd800) << 10) | (low - 0xdc00));
+    }
+
+    if (codepoint < 0x80) {
+      string->push_back(static_cast<char>(codepoint));
+    } else if (codepoint < 0x800) {
+      string->push_back(static_cast<char>(0xc0 | (codepoint >> 6)));
+      string->push_back(static_cast<char>(0x80 | (codepoint & 0x3f)));
+    } else if (codepoint < 0x10000) {
+      string->push_back(static_cast<char>(0xe0 | (codepoint >> 12)));
+      string->push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3f)));
+      string->push_back(static_cast<char>(0x80 | (codepoint & 0x3f)));
+    } else {
+      string->push_back(static_cast<char>(0xf0 | (codepoint >> 18)));
+      string->push_back(static_cast<char>(0x80 | ((codepoint >> 12) & 0x3f)));
+      string->push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3f)));
+      string->push_back(static_cast<char>(0x80 | (codepoint & 0x3f)));
+    }
+
+    return true;
+  }
+
+  bool parse(Number* number)
+  {
+    const char* start = cursor;
+
+    // Like PicoJson, take all the characters that may be part of a
+    // number and let `strtoll` or `strtod` decide if they are valid.
+    bool integral = true;
+    for (; cursor != end; ++cursor) {
+      const char c = *cursor;
+      if (c >= '0' && c <= '9') {
+        continue;
+      } else if (c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E') {
+        integral = integral && c == '-' && cursor == start;
+      } else {
+        break;
+      }
+    }
+
+    const size_t length = cursor - start;
+
+    // Fast path for (the common case of) integers that cannot
+    // overflow, i.e., that have at most 18 digits.
+    const size_t digits = length - (*start == '-' ? 1 : 0);
+    if (integral && digits > 0 && digits <= 18) {
+      int64_t result = 0;
+      for (const char* c = start + length - digits; c != cursor; ++c) {
+        result = result * 10 + (*c - '0');
+      }
+      *number = Number(*start == '-' ? -result : result);
+      return true;
+    }
+
+    buffer.assign(start, length);
 
-  if (!error.empty()) {
-    return Error(error);
-  } else if (parseEnd != lastVisibleChar + 1) {
-    return Error(
-        "Parsed JSON included non-whitespace trailing characters: "
-        + s.substr(parseEnd - parseBegin, lastVisibleChar + 1 - parseEnd));
+    char* last = nullptr;
+
+    errno = 0;
+    long long integer = std::strtoll(buffer.c_str(), &last, 10);
+    if (errno == 0 && last == buffer.c_str() + buffer.size()) {
+      *number = Number(static_cast<int64_t>(integer));
+      return true;
+    }
+
+    // NOTE: Like PicoJson, we reject numbers that overflow a double,
+    // since infinity cannot be represented in JSON.
+    double floating = std::strtod(buffer.c_str(), &last);
+    if (last == buffer.c_str() + buffer.size() && std::isfinite(floating)) {
+      *number = Number(floating);
+      return true;
+    }
+
+    // Point the error at the beginning of the number.
+    cursor = start;
+    return false;
   }
 
-  return internal::convert(value);
+  const char* const begin;
+  const char* cursor;
+  const char* const end;
+
+  // Reused for the numbers that need to be parsed with `strtoll` or
+  // `strtod`, which expect a null-terminated string.
+  std::string buffer;
+};
+
+} // namespace internal {
+
+
+inline Try<Value> parse(const std::string& s)
+{
+  return internal::Parser(s.data(), s.data() + s.size()).parse();
 }
 
 
@@ -799,11 +1137,13 @@ Try<T> parse(const std::string& s)
     return Error(value.error());
   }
 
-  if (!value.get().is<T>()) {
+  T* t = boost::get<T>(&value.get());
+  if (t == nullptr) {
     return Error("Unexpected JSON type parsed");
   }
 
-  return value.get().as<T>();
+  // Move the parsed value out rather than copying it.
+  return std::move(*t);
 }
 
 
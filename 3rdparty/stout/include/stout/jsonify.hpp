@@ -439,6 +439,20 @@ public:
     ++count_;
   }
 
+  // Like `field`, but for a key that is already a JSON string, i.e.,
+  // the result of `jsonify(key)`. This allows writing the same keys
+  // over and over again (e.g., those of a protobuf message type)
+  // without escaping them each time.
+  template <typename T>
+  void jsonifiedField(const std::string& key, const T& value)
+  {
+    if (count_ > 0) {
+      *stream_ << ',';
+    }
+    *stream_ << key << ':' << jsonify(value);
+    ++count_;
+  }
+
 private:
   std::ostream* stream_;
   std::size_t count_;
@@ -84,6 +84,19 @@ Try<T> numify(const char* s)
 }
 
 
+// Parses the viewed characters without copying them into a string,
+// except to handle the hexadecimal and error cases above.
+template <typename T>
+Try<T> numify(const strings::View& s)
+{
+  try {
+    return boost::lexical_cast<T>(s.data(), s.size());
+  } catch (const boost::bad_lexical_cast&) {
+    return numify<T>(s.str());
+  }
+}
+
+
 template <typename T>
 Result<T> numify(const Option<std::string>& s)
 {
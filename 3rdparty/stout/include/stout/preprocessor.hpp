@@ -19,6 +19,7 @@
 
 #include <boost/preprocessor/facilities/intercept.hpp>
 
+#include <boost/preprocessor/repetition/enum.hpp>
 #include <boost/preprocessor/repetition/enum_binary_params.hpp>
 #include <boost/preprocessor/repetition/enum_params.hpp>
 #include <boost/preprocessor/repetition/enum_trailing_params.hpp>
@@ -32,6 +33,7 @@
 #define CAT BOOST_PP_CAT
 #define INC BOOST_PP_INC
 #define INTERCEPT BOOST_PP_INTERCEPT
+#define ENUM BOOST_PP_ENUM
 #define ENUM_PARAMS BOOST_PP_ENUM_PARAMS
 #define ENUM_BINARY_PARAMS BOOST_PP_ENUM_BINARY_PARAMS
 #define ENUM_TRAILING_PARAMS BOOST_PP_ENUM_TRAILING_PARAMS
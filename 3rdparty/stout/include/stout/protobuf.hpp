@@ -22,8 +22,11 @@
 
 #include <sys/types.h>
 
+#include <algorithm>
+#include <mutex>
 #include <string>
 #include <type_traits>
+#include <unordered_map>
 #include <vector>
 
 #include <google/protobuf/descriptor.h>
@@ -42,7 +45,9 @@
 #include <stout/representation.hpp>
 #include <stout/result.hpp>
 #include <stout/stringify.hpp>
+#include <stout/synchronized.hpp>
 #include <stout/try.hpp>
+#include <stout/unreachable.hpp>
 
 #include <stout/os/close.hpp>
 #include <stout/os/open.hpp>
@@ -326,6 +331,131 @@ struct Read<google::protobuf::RepeatedPtrField<T>>
 }  // namespace internal {
 
 
+// Reads the protobuf messages written by 'write' above one after the
+// other, like repeatedly invoking 'read<T>(fd, ignorePartial, true)'.
+// Rather than reading the size and the contents of every message
+// separately (i.e., with two system calls and an allocation per
+// message), the file is read in large blocks and the messages are
+// parsed off the buffered data.
+//
+// NOTE: Since it reads ahead, the file offset of 'fd' is unspecified
+// while messages are being read. Once 'read' returns None or an
+// error, the offset is moved back to right after the last message
+// that was read successfully (e.g., so that a partially written
+// message at the end of the file can be truncated).
+template <typename T>
+class Reader
+{
+public:
+  explicit Reader(int _fd, bool _ignorePartial = false)
+    : fd(_fd), ignorePartial(_ignorePartial), position(0) {}
+
+  // Returns the next message, or None if there are no more messages
+  // to read (or only a partial one, if 'ignorePartial' is true).
+  Result<T> read()
+  {
+    uint32_t size;
+
+    Try<bool> available = fill(sizeof(size));
+    if (available.isError()) {
+      return finish(Error("Failed to read size: " + available.error()));
+    } else if (!available.get()) {
+      if (position == buffer.size()) {
+        return finish(None()); // No more protobufs to read.
+      } else if (ignorePartial) {
+        return finish(None());
+      }
+      return finish(Error(
+          "Failed to read size: hit EOF unexpectedly, possible corruption"));
+    }
+
+    // Parse the size from the bytes.
+    memcpy((void*) &size, (void*) (buffer.data() + position), sizeof(size));
+
+    // NOTE: Like 'read', instead of specifically checking for
+    // corruption in 'size', we simply try to read 'size' bytes.
+    available = fill(sizeof(size) + size);
+    if (available.isError()) {
+      return finish(Error("Failed to read message: " + available.error()));
+    } else if (!available.get()) {
+      if (ignorePartial) {
+        return finish(None());
+      }
+      return finish(Error(
+          "Failed to read message of size " + stringify(size) +
+          " bytes: hit EOF unexpectedly, possible corruption"));
+    }
+
+    T message;
+    google::protobuf::io::ArrayInputStream stream(
+        buffer.data() + position + sizeof(size), size);
+
+    if (!message.ParseFromZeroCopyStream(&stream)) {
+      return finish(Error("Failed to deserialize message"));
+    }
+
+    position += sizeof(size) + size;
+
+    return message;
+  }
+
+private:
+  // Makes sure that at least 'size' bytes following 'position' are
+  // buffered. Returns false if EOF is hit before that.
+  Try<bool> fill(size_t size)
+  {
+    if (buffer.size() - position >= size) {
+      return true;
+    }
+
+    // Drop the messages that were already read.
+    buffer.erase(0, position);
+    position = 0;
+
+    const size_t blockSize = 64 * 1024;
+
+    while (buffer.size() < size) {
+      Result<std::string> data =
+        os::read(fd, std::max(blockSize, size - buffer.size()));
+
+      if (data.isError()) {
+        return Error(data.error());
+      } else if (data.isNone()) {
+        return false;
+      }
+
+      buffer.append(data.get());
+    }
+
+    return true;
+  }
+
+  // Moves the file offset back to right after the last message that
+  // was read, i.e., gives back the data that was read ahead.
+  Result<T> finish(const Result<T>& result)
+  {
+    const size_t unread = buffer.size() - position;
+
+    buffer.clear();
+    position = 0;
+
+    if (unread > 0 && lseek(fd, -((off_t) unread), SEEK_CUR) == -1) {
+      return ErrnoError("Failed to lseek to SEEK_CUR");
+    }
+
+    return result;
+  }
+
+  const int fd;
+  const bool ignorePartial;
+
+  // The data read from the file and the position of the next
+  // message in it.
+  std::string buffer;
+  size_t position;
+};
+
+
 // Reads the protobuf message(s) from a given fd based on the format
 // written by write() above. We use partial specialization of
 //   - internal::Read<T> vs
@@ -699,6 +829,80 @@ Try<T> parse(const JSON::Value& value)
 
 namespace JSON {
 
+namespace internal {
+
+// A field of a protobuf message type along with what is needed to
+// convert it into JSON, which is computed only once per type.
+struct ProtobufField
+{
+  const google::protobuf::FieldDescriptor* descriptor;
+
+  // The name of the field as a JSON string, i.e., `jsonify(name)`.
+  std::string key;
+
+  // Whether the field is output even when it is not set, which is
+  // the case for the optional fields with a default value.
+  bool defaulted;
+};
+
+
+// Returns the fields of the given message type. Since converting a
+// message into JSON is fairly common (e.g., for the HTTP endpoints)
+// and tends to involve lots of messages of the same few types, the
+// fields of the generated message types are cached. This is safe
+// because the descriptors of the generated message types live until
+// the program exits. The fields of any other (i.e., dynamic) message
+// type are computed into `storage` instead.
+inline const std::vector<ProtobufField>& protobufFields(
+    const google::protobuf::Descriptor* descriptor,
+    std::vector<ProtobufField>* storage)
+{
+  auto compute = [descriptor](std::vector<ProtobufField>* fields) {
+    fields->reserve(descriptor->field_count());
+    for (int i = 0; i < descriptor->field_count(); i++) {
+      const google::protobuf::FieldDescriptor* field = descriptor->field(i);
+      fields->push_back(ProtobufField{
+          field,
+          ::jsonify(field->name()),
+          !field->is_repeated() && field->has_default_value()});
+    }
+  };
+
+  if (descriptor->file()->pool() !=
+      google::protobuf::DescriptorPool::generated_pool()) {
+    compute(storage);
+    return *storage;
+  }
+
+  // NOTE: These are intentionally leaked so that messages can still
+  // be converted while static objects are destroyed at exit.
+  static std::mutex* mutex = new std::mutex();
+  static std::unordered_map<
+      const google::protobuf::Descriptor*,
+      std::vector<ProtobufField>>* cache =
+    new std::unordered_map<
+        const google::protobuf::Descriptor*,
+        std::vector<ProtobufField>>();
+
+  synchronized (mutex) {
+    auto iterator = cache->find(descriptor);
+    if (iterator == cache->end()) {
+      iterator = cache->emplace(
+          descriptor, std::vector<ProtobufField>()).first;
+      compute(&iterator->second);
+    }
+
+    // NOTE: References to the elements of an `unordered_map` remain
+    // valid when it rehashes, and the entries are never erased.
+    return iterator->second;
+  }
+
+  UNREACHABLE();
+}
+
+} // namespace internal {
+
+
 // The representation of generic protobuf => JSON,
 // e.g., `jsonify(JSON::Protobuf(message))`.
 struct Protobuf : Representation<google::protobuf::Message>
@@ -716,34 +920,27 @@ inline void json(ObjectWriter* writer, const Protobuf& protobuf)
 
   const google::protobuf::Message& message = protobuf;
 
-  const google::protobuf::Descriptor* descriptor = message.GetDescriptor();
   const google::protobuf::Reflection* reflection = message.GetReflection();
 
-  // We first look through all the possible fields to determine both the set
+  std::vector<internal::ProtobufField> storage;
+  const std::vector<internal::ProtobufField>& fields =
+    internal::protobufFields(message.GetDescriptor(), &storage);
+
+  // We look through all the possible fields to output both the set
   // fields __and__ the optional fields with a default that are not set.
   // `Reflection::ListFields()` alone will only include set fields and
   // is therefore insufficient.
-  int fieldCount = descriptor->field_count();
-  std::vector<const FieldDescriptor*> fields;
-  fields.reserve(fieldCount);
-  for (int i = 0; i < fieldCount; ++i) {
-    const FieldDescriptor* field = descriptor->field(i);
+  foreach (const internal::ProtobufField& entry, fields) {
+    const FieldDescriptor* field = entry.descriptor;
+
     if (field->is_repeated()) {
-      if (reflection->FieldSize(message, field) > 0) {
-        // Has repeated field with members, output as JSON.
-        fields.push_back(field);
+      // Only output repeated fields with members.
+      if (reflection->FieldSize(message, field) == 0) {
+        continue;
       }
-    } else if (reflection->HasField(message, field) ||
-               field->has_default_value()) {
-      // Field is set or has default, output as JSON.
-      fields.push_back(field);
-    }
-  }
 
-  foreach (const FieldDescriptor* field, fields) {
-    if (field->is_repeated()) {
-      writer->field(
-          field->name(),
+      writer->jsonifiedField(
+          entry.key,
           [&field, &reflection, &message](JSON::ArrayWriter* writer) {
             int fieldSize = reflection->FieldSize(message, field);
             for (int i = 0; i < fieldSize; ++i) {
@@ -796,213 +993,239 @@ inline void json(ObjectWriter* writer, const Protobuf& protobuf)
               }
             }
           });
-    } else {
-      switch (field->cpp_type()) {
-        case FieldDescriptor::CPPTYPE_BOOL:
-          writer->field(field->name(), reflection->GetBool(message, field));
-          break;
-        case FieldDescriptor::CPPTYPE_INT32:
-          writer->field(field->name(), reflection->GetInt32(message, field));
-          break;
-        case FieldDescriptor::CPPTYPE_INT64:
-          writer->field(field->name(), reflection->GetInt64(message, field));
-          break;
-        case FieldDescriptor::CPPTYPE_UINT32:
-          writer->field(field->name(), reflection->GetUInt32(message, field));
-          break;
-        case FieldDescriptor::CPPTYPE_UINT64:
-          writer->field(field->name(), reflection->GetUInt64(message, field));
-          break;
-        case FieldDescriptor::CPPTYPE_FLOAT:
-          writer->field(field->name(), reflection->GetFloat(message, field));
-          break;
-        case FieldDescriptor::CPPTYPE_DOUBLE:
-          writer->field(field->name(), reflection->GetDouble(message, field));
-          break;
-        case FieldDescriptor::CPPTYPE_MESSAGE:
-          writer->field(
-              field->name(), Protobuf(reflection->GetMessage(message, field)));
-          break;
-        case FieldDescriptor::CPPTYPE_ENUM:
-          writer->field(
-              field->name(), reflection->GetEnum(message, field)->name());
-          break;
-        case FieldDescriptor::CPPTYPE_STRING:
-          const std::string& s = reflection->GetStringReference(
-              message, field, nullptr);
-          if (field->type() == FieldDescriptor::TYPE_BYTES) {
-            writer->field(field->name(), base64::encode(s));
-          } else {
-            writer->field(field->name(), s);
-          }
-          break;
-      }
+      continue;
+    }
+
+    if (!entry.defaulted && !reflection->HasField(message, field)) {
+      continue;
+    }
+
+    const std::string& key = entry.key;
+
+    switch (field->cpp_type()) {
+      case FieldDescriptor::CPPTYPE_BOOL:
+        writer->jsonifiedField(key, reflection->GetBool(message, field));
+        break;
+      case FieldDescriptor::CPPTYPE_INT32:
+        writer->jsonifiedField(key, reflection->GetInt32(message, field));
+        break;
+      case FieldDescriptor::CPPTYPE_INT64:
+        writer->jsonifiedField(key, reflection->GetInt64(message, field));
+        break;
+      case FieldDescriptor::CPPTYPE_UINT32:
+        writer->jsonifiedField(key, reflection->GetUInt32(message, field));
+        break;
+      case FieldDescriptor::CPPTYPE_UINT64:
+        writer->jsonifiedField(key, reflection->GetUInt64(message, field));
+        break;
+      case FieldDescriptor::CPPTYPE_FLOAT:
+        writer->jsonifiedField(key, reflection->GetFloat(message, field));
+        break;
+      case FieldDescriptor::CPPTYPE_DOUBLE:
+        writer->jsonifiedField(key, reflection->GetDouble(message, field));
+        break;
+      case FieldDescriptor::CPPTYPE_MESSAGE:
+        writer->jsonifiedField(
+            key, Protobuf(reflection->GetMessage(message, field)));
+        break;
+      case FieldDescriptor::CPPTYPE_ENUM:
+        writer->jsonifiedField(
+            key, reflection->GetEnum(message, field)->name());
+        break;
+      case FieldDescriptor::CPPTYPE_STRING:
+        const std::string& s = reflection->GetStringReference(
+            message, field, nullptr);
+        if (field->type() == FieldDescriptor::TYPE_BYTES) {
+          writer->jsonifiedField(key, base64::encode(s));
+        } else {
+          writer->jsonifiedField(key, s);
+        }
+        break;
     }
   }
 }
 
 
-// TODO(bmahler): This currently uses the default value for optional
-// fields but we may want to revisit this decision.
-inline Object protobuf(const google::protobuf::Message& message)
+namespace internal {
+
+// Converts the message into the given (empty) object. The values are
+// constructed in place, rather than being copied into their parent,
+// which would copy every nested object and array over again.
+inline void protobuf(
+    const google::protobuf::Message& message,
+    Object* object)
 {
-  Object object;
+  using google::protobuf::FieldDescriptor;
 
-  const google::protobuf::Descriptor* descriptor = message.GetDescriptor();
   const google::protobuf::Reflection* reflection = message.GetReflection();
 
-  // We first look through all the possible fields to determine both
-  // the set fields _and_ the optional fields with a default that
-  // are not set. Reflection::ListFields() alone will only include
-  // set fields and is therefore insufficient.
-  std::vector<const google::protobuf::FieldDescriptor*> fields;
-  fields.reserve(descriptor->field_count());
-  for (int i = 0; i < descriptor->field_count(); i++) {
-    const google::protobuf::FieldDescriptor* field = descriptor->field(i);
-    if (field->is_repeated()) {
-      if (reflection->FieldSize(message, descriptor->field(i)) > 0) {
-        // Has repeated field with members, output as JSON.
-        fields.push_back(field);
-      }
-    } else if (reflection->HasField(message, field) ||
-               field->has_default_value()) {
-      // Field is set or has default, output as JSON.
-      fields.push_back(field);
-    }
-  }
+  std::vector<ProtobufField> storage;
+  const std::vector<ProtobufField>& fields =
+    protobufFields(message.GetDescriptor(), &storage);
+
+  // We look through all the possible fields to output both the set
+  // fields _and_ the optional fields with a default that are not
+  // set. Reflection::ListFields() alone will only include set fields
+  // and is therefore insufficient.
+  foreach (const ProtobufField& entry, fields) {
+    const FieldDescriptor* field = entry.descriptor;
 
-  foreach (const google::protobuf::FieldDescriptor* field, fields) {
     if (field->is_repeated()) {
-      JSON::Array array;
+      // Only output repeated fields with members.
       int fieldSize = reflection->FieldSize(message, field);
+      if (fieldSize == 0) {
+        continue;
+      }
+
+      Value& value = object->values[field->name()];
+      value = Array();
+
+      Array& array = boost::get<Array>(value);
       array.values.reserve(fieldSize);
       for (int i = 0; i < fieldSize; ++i) {
         switch (field->type()) {
-          case google::protobuf::FieldDescriptor::TYPE_DOUBLE:
+          case FieldDescriptor::TYPE_DOUBLE:
             array.values.push_back(JSON::Number(
                 reflection->GetRepeatedDouble(message, field, i)));
             break;
-          case google::protobuf::FieldDescriptor::TYPE_FLOAT:
+          case FieldDescriptor::TYPE_FLOAT:
             array.values.push_back(JSON::Number(
                 reflection->GetRepeatedFloat(message, field, i)));
             break;
-          case google::protobuf::FieldDescriptor::TYPE_INT64:
-          case google::protobuf::FieldDescriptor::TYPE_SINT64:
-          case google::protobuf::FieldDescriptor::TYPE_SFIXED64:
+          case FieldDescriptor::TYPE_INT64:
+          case FieldDescriptor::TYPE_SINT64:
+          case FieldDescriptor::TYPE_SFIXED64:
             array.values.push_back(JSON::Number(
                 reflection->GetRepeatedInt64(message, field, i)));
             break;
-          case google::protobuf::FieldDescriptor::TYPE_UINT64:
-          case google::protobuf::FieldDescriptor::TYPE_FIXED64:
+          case FieldDescriptor::TYPE_UINT64:
+          case FieldDescriptor::TYPE_FIXED64:
             array.values.push_back(JSON::Number(
                 reflection->GetRepeatedUInt64(message, field, i)));
             break;
-          case google::protobuf::FieldDescriptor::TYPE_INT32:
-          case google::protobuf::FieldDescriptor::TYPE_SINT32:
-          case google::protobuf::FieldDescriptor::TYPE_SFIXED32:
+          case FieldDescriptor::TYPE_INT32:
+          case FieldDescriptor::TYPE_SINT32:
+          case FieldDescriptor::TYPE_SFIXED32:
             array.values.push_back(JSON::Number(
                 reflection->GetRepeatedInt32(message, field, i)));
             break;
-          case google::protobuf::FieldDescriptor::TYPE_UINT32:
-          case google::protobuf::FieldDescriptor::TYPE_FIXED32:
+          case FieldDescriptor::TYPE_UINT32:
+          case FieldDescriptor::TYPE_FIXED32:
             array.values.push_back(JSON::Number(
                 reflection->GetRepeatedUInt32(message, field, i)));
             break;
-          case google::protobuf::FieldDescriptor::TYPE_BOOL:
+          case FieldDescriptor::TYPE_BOOL:
             if (reflection->GetRepeatedBool(message, field, i)) {
               array.values.push_back(JSON::True());
             } else {
               array.values.push_back(JSON::False());
             }
             break;
-          case google::protobuf::FieldDescriptor::TYPE_STRING:
+          case FieldDescriptor::TYPE_STRING:
             array.values.push_back(JSON::String(
-                reflection->GetRepeatedString(message, field, i)));
+                reflection->GetRepeatedStringReference(
+                    message, field, i, nullptr)));
             break;
-          case google::protobuf::FieldDescriptor::TYPE_BYTES:
+          case FieldDescriptor::TYPE_BYTES:
             array.values.push_back(JSON::String(base64::encode(
-                reflection->GetRepeatedString(message, field, i))));
+                reflection->GetRepeatedStringReference(
+                    message, field, i, nullptr))));
             break;
-          case google::protobuf::FieldDescriptor::TYPE_MESSAGE:
-            array.values.push_back(protobuf(
-                reflection->GetRepeatedMessage(message, field, i)));
+          case FieldDescriptor::TYPE_MESSAGE:
+            // NOTE: The elements are not moved since they have been
+            // reserved for above.
+            array.values.push_back(Object());
+            protobuf(
+                reflection->GetRepeatedMessage(message, field, i),
+                &boost::get<Object>(array.values.back()));
             break;
-          case google::protobuf::FieldDescriptor::TYPE_ENUM:
+          case FieldDescriptor::TYPE_ENUM:
             array.values.push_back(JSON::String(
                 reflection->GetRepeatedEnum(message, field, i)->name()));
             break;
-          case google::protobuf::FieldDescriptor::TYPE_GROUP:
+          case FieldDescriptor::TYPE_GROUP:
             // Deprecated! We abort here instead of using a Try as return value,
             // because we expect this code path to never be taken.
             ABORT("Unhandled protobuf field type: " +
                   stringify(field->type()));
         }
       }
-      object.values[field->name()] = array;
-    } else {
-      switch (field->type()) {
-        case google::protobuf::FieldDescriptor::TYPE_DOUBLE:
-          object.values[field->name()] =
-              JSON::Number(reflection->GetDouble(message, field));
-          break;
-        case google::protobuf::FieldDescriptor::TYPE_FLOAT:
-          object.values[field->name()] =
-              JSON::Number(reflection->GetFloat(message, field));
-          break;
-        case google::protobuf::FieldDescriptor::TYPE_INT64:
-        case google::protobuf::FieldDescriptor::TYPE_SINT64:
-        case google::protobuf::FieldDescriptor::TYPE_SFIXED64:
-          object.values[field->name()] =
-              JSON::Number(reflection->GetInt64(message, field));
-          break;
-        case google::protobuf::FieldDescriptor::TYPE_UINT64:
-        case google::protobuf::FieldDescriptor::TYPE_FIXED64:
-          object.values[field->name()] =
-              JSON::Number(reflection->GetUInt64(message, field));
-          break;
-        case google::protobuf::FieldDescriptor::TYPE_INT32:
-        case google::protobuf::FieldDescriptor::TYPE_SINT32:
-        case google::protobuf::FieldDescriptor::TYPE_SFIXED32:
-          object.values[field->name()] =
-              JSON::Number(reflection->GetInt32(message, field));
-          break;
-        case google::protobuf::FieldDescriptor::TYPE_UINT32:
-        case google::protobuf::FieldDescriptor::TYPE_FIXED32:
-          object.values[field->name()] =
-              JSON::Number(reflection->GetUInt32(message, field));
-          break;
-        case google::protobuf::FieldDescriptor::TYPE_BOOL:
-          if (reflection->GetBool(message, field)) {
-            object.values[field->name()] = JSON::True();
-          } else {
-            object.values[field->name()] = JSON::False();
-          }
-          break;
-        case google::protobuf::FieldDescriptor::TYPE_STRING:
-          object.values[field->name()] =
-              JSON::String(reflection->GetString(message, field));
-          break;
-        case google::protobuf::FieldDescriptor::TYPE_BYTES:
-          object.values[field->name()] = JSON::String(
-              base64::encode(reflection->GetString(message, field)));
-          break;
-        case google::protobuf::FieldDescriptor::TYPE_MESSAGE:
-          object.values[field->name()] =
-              protobuf(reflection->GetMessage(message, field));
-          break;
-        case google::protobuf::FieldDescriptor::TYPE_ENUM:
-          object.values[field->name()] =
-              JSON::String(reflection->GetEnum(message, field)->name());
-          break;
-        case google::protobuf::FieldDescriptor::TYPE_GROUP:
-          // Deprecated! We abort here instead of using a Try as return value,
-          // because we expect this code path to never be taken.
-          ABORT("Unhandled protobuf field type: " +
-                stringify(field->type()));
-      }
+      continue;
+    }
+
+    if (!entry.defaulted && !reflection->HasField(message, field)) {
+      continue;
+    }
+
+    Value& value = object->values[field->name()];
+
+    switch (field->type()) {
+      case FieldDescriptor::TYPE_DOUBLE:
+        value = JSON::Number(reflection->GetDouble(message, field));
+        break;
+      case FieldDescriptor::TYPE_FLOAT:
+        value = JSON::Number(reflection->GetFloat(message, field));
+        break;
+      case FieldDescriptor::TYPE_INT64:
+      case FieldDescriptor::TYPE_SINT64:
+      case FieldDescriptor::TYPE_SFIXED64:
+        value = JSON::Number(reflection->GetInt64(message, field));
+        break;
+      case FieldDescriptor::TYPE_UINT64:
+      case FieldDescriptor::TYPE_FIXED64:
+        value = JSON::Number(reflection->GetUInt64(message, field));
+        break;
+      case FieldDescriptor::TYPE_INT32:
+      case FieldDescriptor::TYPE_SINT32:
+      case FieldDescriptor::TYPE_SFIXED32:
+        value = JSON::Number(reflection->GetInt32(message, field));
+        break;
+      case FieldDescriptor::TYPE_UINT32:
+      case FieldDescriptor::TYPE_FIXED32:
+        value = JSON::Number(reflection->GetUInt32(message, field));
+        break;
+      case FieldDescriptor::TYPE_BOOL:
+        if (reflection->GetBool(message, field)) {
+          value = JSON::True();
+        } else {
+          value = JSON::False();
+        }
+        break;
+      case FieldDescriptor::TYPE_STRING:
+        value = JSON::String(
+            reflection->GetStringReference(message, field, nullptr));
+        break;
+      case FieldDescriptor::TYPE_BYTES:
+        value = JSON::String(base64::encode(
+            reflection->GetStringReference(message, field, nullptr)));
+        break;
+      case FieldDescriptor::TYPE_MESSAGE:
+        value = Object();
+        protobuf(
+            reflection->GetMessage(message, field),
+            &boost::get<Object>(value));
+        break;
+      case FieldDescriptor::TYPE_ENUM:
+        value = JSON::String(reflection->GetEnum(message, field)->name());
+        break;
+      case FieldDescriptor::TYPE_GROUP:
+        // Deprecated! We abort here instead of using a Try as return value,
+        // because we expect this code path to never be taken.
+        ABORT("Unhandled protobuf field type: " +
+              stringify(field->type()));
     }
   }
+}
 
+} // namespace internal {
+
+
+// TODO(bmahler): This currently uses the default value for optional
+// fields but we may want to revisit this decision.
+inline Object protobuf(const google::protobuf::Message& message)
+{
+  Object object;
+  internal::protobuf(message, &object);
   return object;
 }
 
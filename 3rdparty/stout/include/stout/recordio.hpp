@@ -15,15 +15,14 @@
 
 #include <stdlib.h>
 
+#include <algorithm>
 #include <deque>
 #include <functional>
 #include <string>
 
 #include <stout/check.hpp>
-#include <stout/foreach.hpp>
 #include <stout/numify.hpp>
 #include <stout/option.hpp>
-#include <stout/stringify.hpp>
 #include <stout/try.hpp>
 
 /**
@@ -49,6 +48,31 @@
  */
 namespace recordio {
 
+namespace internal {
+
+/**
+ * Appends the "Record-IO" header for a record of the given size.
+ * The digits are formatted directly rather than through a stream,
+ * since this is done for every record.
+ */
+inline void header(size_t size, std::string* output)
+{
+  // Enough for the digits of the largest 64 bit value.
+  char digits[20];
+  size_t count = 0;
+
+  do {
+    digits[sizeof(digits) - ++count] = static_cast<char>('0' + size % 10);
+    size /= 10;
+  } while (size > 0);
+
+  output->append(digits + sizeof(digits) - count, count);
+  output->push_back('\n');
+}
+
+} // namespace internal {
+
+
 /**
  * Given an encoding function for individual records, this
  * provides encoding from typed records into "Record-IO" data.
@@ -65,8 +89,26 @@ public:
    */
   std::string encode(const T& record) const
   {
-    std::string s = serialize(record);
-    return stringify(s.size()) + "\n" + s;
+    std::string result;
+    encode(record, &result);
+    return result;
+  }
+
+  /**
+   * Appends the "Record-IO" encoded record to 'output'. This allows
+   * encoding several records into a single buffer (e.g., to write
+   * them at once) and reusing the buffer's allocation.
+   */
+  void encode(const T& record, std::string* output) const
+  {
+    const std::string s = serialize(record);
+
+    // Make room for the longest possible header up front, so that
+    // appending the record does not reallocate.
+    output->reserve(output->size() + 21 + s.size());
+
+    internal::header(s.size(), output);
+    output->append(s);
   }
 
 private:
@@ -105,14 +147,21 @@ public:
 
     std::deque<Try<T>> records;
 
-    foreach (char c, data) {
+    size_t index = 0;
+
+    while (index < data.size()) {
       if (state == HEADER) {
         // Keep reading until we have the entire header.
-        if (c != '\n') {
-          buffer += c;
-          continue;
+        size_t newline = data.find('\n', index);
+
+        if (newline == std::string::npos) {
+          buffer.append(data, index, std::string::npos);
+          break;
         }
 
+        buffer.append(data, index, newline - index);
+        index = newline + 1;
+
         Try<size_t> numify = ::numify<size_t>(buffer);
 
         // If we were unable to decode the length header, do not
@@ -132,12 +181,21 @@ public:
         if (numify.get() <= 0) {
           records.push_back(deserialize(buffer));
           state = HEADER;
+        } else {
+          // Reserve the entire record up front, so that we don't
+          // reallocate the buffer as the record gets appended.
+          buffer.reserve(numify.get());
         }
       } else if (state == RECORD) {
         CHECK_SOME(length);
         CHECK_LT(buffer.size(), length.get());
 
-        buffer += c;
+        // Append as much of the record as is available at once.
+        size_t size =
+          std::min(length.get() - buffer.size(), data.size() - index);
+
+        buffer.append(data, index, size);
+        index += size;
 
         if (buffer.size() == length.get()) {
           records.push_back(deserialize(buffer));
@@ -58,8 +58,10 @@ public:
   Result(const T& _t)
     : data(Some(_t)) {}
 
+  // NOTE: We construct the `Option<T>` explicitly, wrapping the value
+  // in `Some` would copy it through `Try(const U&)`.
   Result(T&& _t)
-    : data(Some(std::move(_t))) {}
+    : data(Option<T>(std::move(_t))) {}
 
   template <
       typename U,
@@ -73,11 +75,19 @@ public:
            Try<Option<T>>(Some(option.get())) :
            Try<Option<T>>(None())) {}
 
+  Result(Option<T>&& option)
+    : data(std::move(option)) {}
+
   Result(const Try<T>& _t)
     : data(_t.isSome() ?
            Try<Option<T>>(Some(_t.get())) :
            Try<Option<T>>(Error(_t.error()))) {}
 
+  Result(Try<T>&& _t)
+    : data(_t.isSome() ?
+           Try<Option<T>>(Option<T>(std::move(_t).get())) :
+           Try<Option<T>>(Error(_t.error()))) {}
+
   Result(const None& none)
     : data(none) {}
 
@@ -99,6 +109,7 @@ public:
   // We don't need to implement these because we are leveraging
   // Try<Option<T>>.
   Result(const Result<T>& that) = default;
+  Result(Result<T>&& that) = default;
   ~Result() = default;
   Result<T>& operator=(const Result<T>& that) = default;
   Result<T>& operator=(Result<T>&& that) = default;
@@ -109,7 +120,25 @@ public:
   bool isNone() const { return data.isSome() && data.get().isNone(); }
   bool isError() const { return data.isError(); }
 
-  const T& get() const
+  const T& get() const & { assertSome(); return data.get().get(); }
+  T& get() & { assertSome(); return data.get().get(); }
+
+  // See 'Try::get() &&'.
+  T&& get() && { assertSome(); return std::move(data).get().get(); }
+
+  const T&& get() const &&
+  {
+    assertSome();
+    return std::move(data).get().get();
+  }
+
+  const T* operator->() const { return &get(); }
+  T* operator->() { return &get(); }
+
+  const std::string& error() const { assert(isError()); return data.error(); }
+
+private:
+  void assertSome() const
   {
     if (!isSome()) {
       std::string errorMessage = "Result::get() but state == ";
@@ -120,20 +149,8 @@ public:
       }
       ABORT(errorMessage);
     }
-    return data.get().get();
-  }
-
-  T& get()
-  {
-    return const_cast<T&>(static_cast<const Result&>(*this).get());
   }
 
-  const T* operator->() const { return &get(); }
-  T* operator->() { return &get(); }
-
-  const std::string& error() const { assert(isError()); return data.error(); }
-
-private:
   // We leverage Try<Option<T>> to avoid dynamic allocation of T. This
   // means we can take advantage of all the RAII features of 'Try' and
   // makes the implementation of this class much simpler!
@@ -13,8 +13,11 @@
 #ifndef __STOUT_STRINGS_HPP__
 #define __STOUT_STRINGS_HPP__
 
+#include <string.h>
+
 #include <algorithm>
 #include <map>
+#include <ostream>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -28,6 +31,86 @@ namespace strings {
 
 const std::string WHITESPACE = " \t\n\r";
 
+
+// A reference to a range of characters of a string that does not own
+// (or copy) them, e.g., a token returned by the `View` overloads of
+// `tokenize` and `split` below. These are meant for hot parsing paths
+// (e.g., stat files read periodically) where allocating a string per
+// token dominates. The referenced string must outlive the view.
+class View
+{
+public:
+  View() : data_(nullptr), size_(0) {}
+
+  View(const char* data, size_t size) : data_(data), size_(size) {}
+
+  explicit View(const std::string& s) : data_(s.data()), size_(s.size()) {}
+
+  const char* data() const { return data_; }
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  const char* begin() const { return data_; }
+  const char* end() const { return data_ + size_; }
+
+  char operator[](size_t i) const { return data_[i]; }
+
+  View substr(size_t pos, size_t count = std::string::npos) const
+  {
+    pos = std::min(pos, size_);
+    return View(data_ + pos, std::min(count, size_ - pos));
+  }
+
+  size_t find_first_of(const std::string& chars, size_t pos = 0) const
+  {
+    for (size_t i = pos; i < size_; i++) {
+      if (chars.find(data_[i]) != std::string::npos) {
+        return i;
+      }
+    }
+    return std::string::npos;
+  }
+
+  size_t find_first_not_of(const std::string& chars, size_t pos = 0) const
+  {
+    for (size_t i = pos; i < size_; i++) {
+      if (chars.find(data_[i]) == std::string::npos) {
+        return i;
+      }
+    }
+    return std::string::npos;
+  }
+
+  // Copies the referenced characters.
+  std::string str() const { return std::string(data_, size_); }
+
+  bool operator==(const View& that) const
+  {
+    return size_ == that.size_ &&
+      (size_ == 0 || ::memcmp(data_, that.data_, size_) == 0);
+  }
+
+  bool operator==(const std::string& s) const { return *this == View(s); }
+
+  bool operator==(const char* s) const
+  {
+    return *this == View(s, ::strlen(s));
+  }
+
+  template <typename T>
+  bool operator!=(const T& that) const { return !(*this == that); }
+
+private:
+  const char* data_;
+  size_t size_;
+};
+
+
+inline std::ostream& operator<<(std::ostream& stream, const View& view)
+{
+  return stream.write(view.data(), view.size());
+}
+
 // Flags indicating how 'remove' or 'trim' should operate.
 enum Mode
 {
@@ -166,6 +249,39 @@ inline std::vector<std::string> tokenize(
 }
 
 
+// Same as above, but returns views into the string instead of copies
+// of the tokens, see `View`.
+inline std::vector<View> tokenize(
+    const View& s,
+    const std::string& delims,
+    const Option<size_t>& maxTokens = None())
+{
+  size_t offset = 0;
+  std::vector<View> tokens;
+
+  while (maxTokens.isNone() || maxTokens.get() > 0) {
+    size_t nonDelim = s.find_first_not_of(delims, offset);
+
+    if (nonDelim == std::string::npos) {
+      break; // Nothing left
+    }
+
+    size_t delim = s.find_first_of(delims, nonDelim);
+
+    if (delim == std::string::npos ||
+        (maxTokens.isSome() && tokens.size() == maxTokens.get() - 1)) {
+      tokens.push_back(s.substr(nonDelim));
+      break;
+    }
+
+    tokens.push_back(s.substr(nonDelim, delim - nonDelim));
+    offset = delim;
+  }
+
+  return tokens;
+}
+
+
 // Splits the string using the provided delimiters.
 // The string is split each time at the first character
 // that matches any of the characters specified in delims.
@@ -199,6 +315,33 @@ inline std::vector<std::string> split(
 }
 
 
+// Same as above, but returns views into the string instead of copies
+// of the tokens, see `View`.
+inline std::vector<View> split(
+    const View& s,
+    const std::string& delims,
+    const Option<size_t>& maxTokens = None())
+{
+  size_t offset = 0;
+  std::vector<View> tokens;
+
+  while (maxTokens.isNone() || maxTokens.get() > 0) {
+    size_t next = s.find_first_of(delims, offset);
+
+    if (next == std::string::npos ||
+        (maxTokens.isSome() && tokens.size() == maxTokens.get() - 1)) {
+      tokens.push_back(s.substr(offset));
+      break;
+    }
+
+    tokens.push_back(s.substr(offset, next - offset));
+    offset = next + 1;
+  }
+
+  return tokens;
+}
+
+
 // Returns a map of strings to strings based on calling tokenize
 // twice. All non-pairs are discarded. For example:
 //
@@ -70,19 +70,13 @@ public:
   bool isSome() const { return data.isSome(); }
   bool isError() const { return data.isNone(); }
 
-  const T& get() const
-  {
-    if (!data.isSome()) {
-      assert(error_.isSome());
-      ABORT("Try::get() but state == ERROR: " + error_.get().message);
-    }
-    return data.get();
-  }
+  const T& get() const & { assertSome(); return data.get(); }
+  T& get() & { assertSome(); return data.get(); }
 
-  T& get()
-  {
-    return const_cast<T&>(static_cast<const Try&>(*this).get());
-  }
+  // Calling 'get' on an rvalue moves the value out, e.g.,
+  // `T t = std::move(result).get();` so that it need not be copied.
+  T&& get() && { assertSome(); return std::move(data).get(); }
+  const T&& get() const && { assertSome(); return std::move(data).get(); }
 
   const T* operator->() const { return &get(); }
   T* operator->() { return &get(); }
@@ -99,6 +93,14 @@ public:
   }
 
 private:
+  void assertSome() const
+  {
+    if (!data.isSome()) {
+      assert(error_.isSome());
+      ABORT("Try::get() but state == ERROR: " + error_.get().message);
+    }
+  }
+
   static const std::string& error_impl(const Error& err) { return err.message; }
 
   template <typename Err>
@@ -14,11 +14,13 @@
 #define __STOUT_UUID_HPP__
 
 #include <assert.h>
+#include <stdint.h>
+#include <string.h>
 
+#include <random>
 #include <stdexcept>
 #include <string>
 
-#include <boost/uuid/random_generator.hpp>
 #include <boost/uuid/string_generator.hpp>
 #include <boost/uuid/uuid.hpp>
 #include <boost/uuid/uuid_io.hpp>
@@ -38,18 +40,68 @@
 // change most of the callsites that use `UUID` to use `id::UUID` instead.
 namespace id {
 
+namespace internal {
+
+// Generates version 4 (random) UUIDs. A 64-bit Mersenne Twister
+// seeded from `std::random_device` fills a batch of UUIDs at a time,
+// which is considerably cheaper than `boost::uuids::random_generator`
+// producing each UUID through a distribution over a 32-bit engine.
+class RandomGenerator
+{
+public:
+  RandomGenerator() : next(BATCH_SIZE)
+  {
+    std::random_device device;
+    std::seed_seq seed{
+      device(), device(), device(), device(),
+      device(), device(), device(), device()};
+
+    engine.seed(seed);
+  }
+
+  void generate(boost::uuids::uuid* uuid)
+  {
+    if (next == BATCH_SIZE) {
+      for (size_t i = 0; i < sizeof(batch) / sizeof(batch[0]); i++) {
+        batch[i] = engine();
+      }
+      next = 0;
+    }
+
+    memcpy(uuid->data, &batch[next * 2], sizeof(uuid->data));
+    next++;
+
+    // Set the variant (RFC 4122) and the version (random), as done
+    // by `boost::uuids::random_generator`.
+    uuid->data[8] = (uuid->data[8] & 0xBF) | 0x80;
+    uuid->data[6] = (uuid->data[6] & 0x4F) | 0x40;
+  }
+
+private:
+  static constexpr size_t BATCH_SIZE = 64;
+
+  std::mt19937_64 engine;
+  uint64_t batch[BATCH_SIZE * 2];
+  size_t next;
+};
+
+} // namespace internal {
+
+
 struct UUID : boost::uuids::uuid
 {
 public:
   static UUID random()
   {
-    static THREAD_LOCAL boost::uuids::random_generator* generator = nullptr;
+    static THREAD_LOCAL internal::RandomGenerator* generator = nullptr;
 
     if (generator == nullptr) {
-      generator = new boost::uuids::random_generator();
+      generator = new internal::RandomGenerator();
     }
 
-    return UUID((*generator)());
+    boost::uuids::uuid uuid;
+    generator->generate(&uuid);
+    return UUID(uuid);
   }
 
   static Try<UUID> fromBytes(const std::string& s)
@@ -74,7 +126,7 @@ public:
   {
     try {
       // NOTE: We don't use THREAD_LOCAL for the `string_generator`
-      // (unlike for the `random_generator` above), because it is cheap
+      // (unlike for the `RandomGenerator` above), because it is cheap
       // to construct one each time.
       boost::uuids::string_generator gen;
       boost::uuids::uuid uuid = gen(s);
@@ -90,9 +142,35 @@ public:
     return std::string(reinterpret_cast<const char*>(data), sizeof(data));
   }
 
+  // Formats the UUID as `xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx`, the
+  // same as `boost::uuids::to_string` but with a single allocation.
   std::string toString() const
   {
-    return to_string(*this);
+    static const char digits[] = "0123456789abcdef";
+
+    std::string result(36, '-');
+
+    size_t j = 0;
+    for (size_t i = 0; i < sizeof(data); i++) {
+      if (i == 4 || i == 6 || i == 8 || i == 10) {
+        j++;
+      }
+
+      result[j++] = digits[(data[i] >> 4) & 0x0F];
+      result[j++] = digits[data[i] & 0x0F];
+    }
+
+    return result;
+  }
+
+  // Returns a hash folded from the bytes of the UUID. Since nearly all
+  // the bits of a UUID are random, this distributes as well as hashing
+  // every byte, at the cost of two loads.
+  size_t hash() const
+  {
+    uint64_t words[2];
+    memcpy(words, data, sizeof(words));
+    return static_cast<size_t>(words[0] ^ words[1]);
   }
 
 private:
@@ -116,7 +194,7 @@ struct hash<UUID>
 
   result_type operator()(const argument_type& uuid) const
   {
-    return boost::uuids::hash_value(uuid);
+    return uuid.hash();
   }
 };
 
@@ -10,15 +10,62 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <string>
+
 #include <gtest/gtest.h>
 
 #include <stout/base64.hpp>
 #include <stout/gtest.hpp>
 
+using std::string;
+
+
+// Returns a string with all 256 byte values in ascending order.
+static string bytes()
+{
+  string result;
+  for (int i = 0; i < 256; i++) {
+    result += static_cast<char>(i);
+  }
+  return result;
+}
+
 
 TEST(Base64Test, Encode)
 {
   EXPECT_EQ("dXNlcjpwYXNzd29yZA==", base64::encode("user:password"));
+
+  // The test vectors of RFC 4648.
+  EXPECT_EQ("", base64::encode(""));
+  EXPECT_EQ("Zg==", base64::encode("f"));
+  EXPECT_EQ("Zm8=", base64::encode("fo"));
+  EXPECT_EQ("Zm9v", base64::encode("foo"));
+  EXPECT_EQ("Zm9vYg==", base64::encode("foob"));
+  EXPECT_EQ("Zm9vYmE=", base64::encode("fooba"));
+  EXPECT_EQ("Zm9vYmFy", base64::encode("foobar"));
+
+  // All the characters of the alphabet.
+  EXPECT_EQ("AAECAwQFBgcICQoLDA0ODxAREhMUFRYXGBkaGxwdHh8gISIjJCUmJygpKiss"
+            "LS4vMDEyMzQ1Njc4OTo7PD0+P0BBQkNERUZHSElKS0xNTk9QUVJTVFVWV1hZ"
+            "WltcXV5fYGFiY2RlZmdoaWprbG1ub3BxcnN0dXZ3eHl6e3x9fn+AgYKDhIWG"
+            "h4iJiouMjY6PkJGSk5SVlpeYmZqbnJ2en6ChoqOkpaanqKmqq6ytrq+wsbKz"
+            "tLW2t7i5uru8vb6/wMHCw8TFxsfIycrLzM3Oz9DR0tPU1dbX2Nna29zd3t/g"
+            "4eLj5OXm5+jp6uvs7e7v8PHy8/T19vf4+fr7/P3+/w==",
+            base64::encode(bytes()));
+}
+
+
+TEST(Base64Test, EncodeDecode)
+{
+  // Make sure that all the bytes survive a roundtrip, no matter
+  // how many bytes are left over after the last group of three.
+  for (size_t i = 0; i <= 256; i++) {
+    const string prefix = bytes().substr(0, i);
+    EXPECT_SOME_EQ(prefix, base64::decode(base64::encode(prefix)));
+
+    const string suffix = bytes().substr(i);
+    EXPECT_SOME_EQ(suffix, base64::decode(base64::encode(suffix)));
+  }
 }
 
 
@@ -0,0 +1,198 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License
+
+#include <stdlib.h>
+
+#include <map>
+#include <stdexcept>
+#include <string>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <stout/flat_hashmap.hpp>
+#include <stout/foreach.hpp>
+#include <stout/gtest.hpp>
+#include <stout/stringify.hpp>
+
+using std::string;
+
+
+TEST(FlatHashMapTest, InitializerList)
+{
+  flat_hashmap<string, int> map{{"hello", 1}};
+  EXPECT_EQ(1u, map.size());
+
+  EXPECT_TRUE((flat_hashmap<int, int>{}.empty()));
+
+  flat_hashmap<int, int> map2{{1, 2}, {2, 3}, {3, 4}};
+  EXPECT_EQ(3u, map2.size());
+  EXPECT_SOME_EQ(2, map2.get(1));
+  EXPECT_SOME_EQ(3, map2.get(2));
+  EXPECT_SOME_EQ(4, map2.get(3));
+  EXPECT_NONE(map2.get(4));
+}
+
+
+TEST(FlatHashMapTest, FromStdMap)
+{
+  std::map<int, int> map1{{1, 2}, {2, 3}};
+
+  flat_hashmap<int, int> map2(map1);
+
+  EXPECT_EQ(2u, map2.size());
+  EXPECT_SOME_EQ(2, map2.get(1));
+  EXPECT_SOME_EQ(3, map2.get(2));
+}
+
+
+TEST(FlatHashMapTest, Insert)
+{
+  flat_hashmap<string, int> map;
+  map["abc"] = 1;
+  map.put("def", 2);
+
+  ASSERT_SOME_EQ(1, map.get("abc"));
+  ASSERT_SOME_EQ(2, map.get("def"));
+
+  map.put("def", 4);
+  ASSERT_SOME_EQ(4, map.get("def"));
+  ASSERT_EQ(2u, map.size());
+
+  EXPECT_FALSE(map.insert({"abc", 5}).second);
+  EXPECT_TRUE(map.insert({"ghi", 6}).second);
+  EXPECT_SOME_EQ(1, map.get("abc"));
+  EXPECT_SOME_EQ(6, map.get("ghi"));
+  EXPECT_EQ(3u, map.size());
+}
+
+
+TEST(FlatHashMapTest, Contains)
+{
+  flat_hashmap<string, int> map;
+  map["abc"] = 1;
+
+  ASSERT_TRUE(map.contains("abc"));
+  ASSERT_TRUE(map.containsValue(1));
+
+  ASSERT_FALSE(map.contains("def"));
+  ASSERT_FALSE(map.containsValue(2));
+
+  EXPECT_EQ(1, map.at("abc"));
+  EXPECT_THROW(map.at("def"), std::out_of_range);
+}
+
+
+TEST(FlatHashMapTest, KeysAndValues)
+{
+  flat_hashmap<int, int> map{{1, 10}, {2, 20}, {3, 30}};
+
+  EXPECT_EQ(hashset<int>({1, 2, 3}), map.keys());
+
+  int sum = 0;
+  foreach (int value, map.values()) {
+    sum += value;
+  }
+  EXPECT_EQ(60, sum);
+
+  sum = 0;
+  foreachpair (int key, int value, map) {
+    sum += key * value;
+  }
+  EXPECT_EQ(140, sum);
+}
+
+
+TEST(FlatHashMapTest, Erase)
+{
+  flat_hashmap<int, int> map{{1, 10}, {2, 20}, {3, 30}};
+
+  EXPECT_EQ(1u, map.erase(2));
+  EXPECT_EQ(0u, map.erase(2));
+  EXPECT_EQ(2u, map.size());
+  EXPECT_FALSE(map.contains(2));
+  EXPECT_SOME_EQ(10, map.get(1));
+  EXPECT_SOME_EQ(30, map.get(3));
+
+  map.erase(map.find(1));
+  EXPECT_EQ(1u, map.size());
+  EXPECT_TRUE(map.find(1) == map.end());
+
+  map.clear();
+  EXPECT_TRUE(map.empty());
+  EXPECT_TRUE(map.begin() == map.end());
+  EXPECT_NONE(map.get(3));
+}
+
+
+// Tests that lookups still find every key after erasing keys from
+// the middle of long probe sequences, i.e., that erasing shifts the
+// following entries back correctly (including across the end of the
+// underlying array).
+TEST(FlatHashMapTest, Collisions)
+{
+  struct BadHash
+  {
+    size_t operator()(int key) const { return key % 3; }
+  };
+
+  flat_hashmap<int, int, BadHash> map;
+  std::map<int, int> expected;
+
+  ::srand(0);
+
+  for (int i = 0; i < 10000; i++) {
+    int key = ::rand() % 64;
+
+    if (::rand() % 2 == 0) {
+      map.put(key, i);
+      expected[key] = i;
+    } else {
+      EXPECT_EQ(expected.erase(key), map.erase(key));
+    }
+
+    ASSERT_EQ(expected.size(), map.size());
+  }
+
+  foreachpair (int key, int value, expected) {
+    EXPECT_SOME_EQ(value, map.get(key));
+  }
+
+  size_t count = 0;
+  foreachpair (int key, int value, map) {
+    EXPECT_EQ(expected[key], value);
+    count++;
+  }
+  EXPECT_EQ(expected.size(), count);
+}
+
+
+TEST(FlatHashMapTest, Grow)
+{
+  flat_hashmap<string, int> map;
+
+  for (int i = 0; i < 1000; i++) {
+    map[stringify(i)] = i;
+  }
+
+  EXPECT_EQ(1000u, map.size());
+
+  for (int i = 0; i < 1000; i++) {
+    EXPECT_SOME_EQ(i, map.get(stringify(i)));
+  }
+
+  flat_hashmap<string, int> copy = map;
+  EXPECT_EQ(map, copy);
+
+  copy["0"] = 1;
+  EXPECT_NE(map, copy);
+}
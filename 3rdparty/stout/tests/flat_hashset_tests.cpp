@@ -0,0 +1,135 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License
+
+#include <stdlib.h>
+
+#include <set>
+#include <string>
+
+#include <stout/flat_hashset.hpp>
+#include <stout/foreach.hpp>
+
+#include <gtest/gtest.h>
+
+#include <gmock/gmock.h>
+
+using std::string;
+
+
+TEST(FlatHashsetTest, InitializerList)
+{
+  flat_hashset<string> set{"hello"};
+  EXPECT_EQ(1u, set.size());
+
+  EXPECT_TRUE((flat_hashset<int>{}.empty()));
+
+  flat_hashset<int> set1{1, 3, 5, 7, 11};
+  EXPECT_EQ(5u, set1.size());
+  EXPECT_TRUE(set1.contains(1));
+  EXPECT_TRUE(set1.contains(3));
+  EXPECT_TRUE(set1.contains(5));
+  EXPECT_TRUE(set1.contains(7));
+  EXPECT_TRUE(set1.contains(11));
+
+  EXPECT_FALSE(set1.contains(2));
+}
+
+
+TEST(FlatHashsetTest, FromStdSet)
+{
+  std::set<int> set1{1, 3, 5, 7};
+
+  flat_hashset<int> set2(set1);
+
+  EXPECT_EQ(4u, set2.size());
+
+  foreach (const auto set1_entry, set1) {
+    EXPECT_TRUE(set2.contains(set1_entry));
+  }
+}
+
+
+TEST(FlatHashsetTest, InsertAndErase)
+{
+  flat_hashset<string> set;
+
+  EXPECT_TRUE(set.insert("abc").second);
+  EXPECT_TRUE(set.insert("def").second);
+  EXPECT_FALSE(set.insert("abc").second);
+  EXPECT_EQ(2u, set.size());
+
+  EXPECT_EQ(1u, set.erase("abc"));
+  EXPECT_EQ(0u, set.erase("abc"));
+  EXPECT_EQ(1u, set.size());
+  EXPECT_FALSE(set.contains("abc"));
+  EXPECT_TRUE(set.contains("def"));
+  EXPECT_TRUE(set.find("abc") == set.end());
+  EXPECT_EQ("def", *set.find("def"));
+
+  set.clear();
+  EXPECT_TRUE(set.empty());
+  EXPECT_TRUE(set.begin() == set.end());
+}
+
+
+TEST(FlatHashsetTest, Equality)
+{
+  flat_hashset<int> set1{1, 2, 3};
+  flat_hashset<int> set2{3, 2, 1};
+
+  EXPECT_TRUE(set1 == set2);
+  EXPECT_TRUE(set1.contains(flat_hashset<int>{1, 3}));
+
+  set2.insert(4);
+  EXPECT_TRUE(set1 != set2);
+  EXPECT_FALSE(set1.contains(set2));
+}
+
+
+// Tests that lookups still find every element after erasing elements
+// from the middle of long probe sequences.
+TEST(FlatHashsetTest, Collisions)
+{
+  struct BadHash
+  {
+    size_t operator()(int elem) const { return elem % 3; }
+  };
+
+  flat_hashset<int, BadHash> set;
+  std::set<int> expected;
+
+  ::srand(0);
+
+  for (int i = 0; i < 10000; i++) {
+    int elem = ::rand() % 64;
+
+    if (::rand() % 2 == 0) {
+      set.insert(elem);
+      expected.insert(elem);
+    } else {
+      EXPECT_EQ(expected.erase(elem), set.erase(elem));
+    }
+
+    ASSERT_EQ(expected.size(), set.size());
+  }
+
+  foreach (int elem, expected) {
+    EXPECT_TRUE(set.contains(elem));
+  }
+
+  size_t count = 0;
+  foreach (int elem, set) {
+    EXPECT_EQ(1u, expected.count(elem));
+    count++;
+  }
+  EXPECT_EQ(expected.size(), count);
+}
@@ -18,6 +18,9 @@
 
 #include <stout/gtest.hpp>
 #include <stout/gzip.hpp>
+#include <stout/os.hpp>
+
+#include <stout/tests/utils.hpp>
 
 using std::string;
 
@@ -64,6 +67,26 @@ TEST(GzipTest, CompressDecompressString)
 }
 
 
+TEST(GzipTest, CompressDecompressZlib)
+{
+  string s =
+    "Lorem ipsum dolor sit amet, consectetur adipisicing elit, sed do "
+    "eiusmod tempor incididunt ut labore et dolore magna aliqua.";
+
+  Try<string> compressed =
+    gzip::compress(s, Z_DEFAULT_COMPRESSION, gzip::Format::ZLIB);
+  ASSERT_SOME(compressed);
+
+  // The zlib format is not the gzip format.
+  EXPECT_ERROR(gzip::decompress(compressed.get()));
+
+  Try<string> decompressed =
+    gzip::decompress(compressed.get(), gzip::Format::ZLIB);
+  ASSERT_SOME(decompressed);
+  ASSERT_EQ(s, decompressed.get());
+}
+
+
 TEST(GzipTest, Decompressor)
 {
   string s =
@@ -99,4 +122,112 @@ TEST(GzipTest, Decompressor)
 
   ASSERT_EQ(s, decompressed);
 }
+
+
+TEST(GzipTest, Compressor)
+{
+  string s;
+  while (s.length() < (1024 * 1024)) {
+    s.append(1, ' ' + (rand() % ('~' - ' ')));
+  }
+
+  gzip::Compressor compressor;
+  gzip::Decompressor decompressor;
+
+  // Compress 1KB at a time and make sure that each flushed chunk can
+  // be decompressed right away.
+  string decompressed;
+  for (size_t i = 0; i < s.size(); i += 1024) {
+    Try<string> compressed = compressor.compress(s.substr(i, 1024));
+    ASSERT_SOME(compressed);
+
+    Try<string> flushed = compressor.flush();
+    ASSERT_SOME(flushed);
+
+    Try<string> chunk =
+      decompressor.decompress(compressed.get() + flushed.get());
+    ASSERT_SOME(chunk);
+    decompressed += chunk.get();
+
+    EXPECT_EQ(s.substr(0, i + 1024), decompressed);
+  }
+
+  EXPECT_FALSE(compressor.finished());
+  EXPECT_FALSE(decompressor.finished());
+
+  Try<string> compressed = compressor.finish();
+  ASSERT_SOME(compressed);
+  EXPECT_TRUE(compressor.finished());
+  EXPECT_ERROR(compressor.compress(s));
+
+  Try<string> chunk = decompressor.decompress(compressed.get());
+  ASSERT_SOME(chunk);
+  EXPECT_TRUE(decompressor.finished());
+  EXPECT_EQ(s, decompressed + chunk.get());
+}
+
+
+class GzipFileTest : public TemporaryDirectoryTest {};
+
+
+TEST_F(GzipFileTest, CompressDecompressFile)
+{
+  string s;
+  while (s.length() < (1024 * 1024)) {
+    s.append(1, ' ' + (rand() % ('~' - ' ')));
+  }
+
+  ASSERT_SOME(os::write("file", s));
+
+  Try<int> in = os::open("file", O_RDONLY | O_CLOEXEC);
+  ASSERT_SOME(in);
+
+  Try<int> out = os::open(
+      "file.gz",
+      O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+      S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+  ASSERT_SOME(out);
+
+  EXPECT_SOME(gzip::compress(in.get(), out.get()));
+
+  os::close(in.get());
+  os::close(out.get());
+
+  Try<string> compressed = os::read("file.gz");
+  ASSERT_SOME(compressed);
+  EXPECT_SOME_EQ(s, gzip::decompress(compressed.get()));
+
+  in = os::open("file.gz", O_RDONLY | O_CLOEXEC);
+  ASSERT_SOME(in);
+
+  out = os::open(
+      "file.out",
+      O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+      S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+  ASSERT_SOME(out);
+
+  EXPECT_SOME(gzip::decompress(in.get(), out.get()));
+
+  os::close(in.get());
+  os::close(out.get());
+
+  EXPECT_SOME_EQ(s, os::read("file.out"));
+
+  // A truncated file cannot be decompressed.
+  ASSERT_SOME(os::write("file.gz", compressed->substr(0, 1024)));
+
+  in = os::open("file.gz", O_RDONLY | O_CLOEXEC);
+  ASSERT_SOME(in);
+
+  out = os::open(
+      "file.out",
+      O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+      S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+  ASSERT_SOME(out);
+
+  EXPECT_ERROR(gzip::decompress(in.get(), out.get()));
+
+  os::close(in.get());
+  os::close(out.get());
+}
 #endif // HAVE_LIBZ
@@ -14,6 +14,7 @@
 
 #include <sys/stat.h>
 
+#include <limits>
 #include <string>
 
 #include <gtest/gtest.h>
@@ -273,6 +274,88 @@ TEST(JsonTest, ParseError)
 }
 
 
+TEST(JsonTest, ParseNumber)
+{
+  Try<JSON::Array> array = JSON::parse<JSON::Array>(
+      "[0, -0, 42, -42, 9223372036854775807, -9223372036854775808,"
+      " 9223372036854775808, 1.5, -1.25e-3, 1E5]");
+
+  ASSERT_SOME(array);
+  ASSERT_EQ(10u, array->values.size());
+
+  const JSON::Number::Type types[] = {
+    JSON::Number::SIGNED_INTEGER,
+    JSON::Number::SIGNED_INTEGER,
+    JSON::Number::SIGNED_INTEGER,
+    JSON::Number::SIGNED_INTEGER,
+    JSON::Number::SIGNED_INTEGER,
+    JSON::Number::SIGNED_INTEGER,
+    JSON::Number::FLOATING,
+    JSON::Number::FLOATING,
+    JSON::Number::FLOATING,
+    JSON::Number::FLOATING
+  };
+
+  for (size_t i = 0; i < array->values.size(); i++) {
+    ASSERT_TRUE(array->values[i].is<JSON::Number>());
+    EXPECT_EQ(types[i], array->values[i].as<JSON::Number>().type);
+  }
+
+  EXPECT_EQ(42, array->values[2].as<JSON::Number>().as<int64_t>());
+  EXPECT_EQ(-42, array->values[3].as<JSON::Number>().as<int64_t>());
+
+  EXPECT_EQ(
+      std::numeric_limits<int64_t>::max(),
+      array->values[4].as<JSON::Number>().as<int64_t>());
+
+  EXPECT_EQ(
+      std::numeric_limits<int64_t>::min(),
+      array->values[5].as<JSON::Number>().as<int64_t>());
+
+  EXPECT_DOUBLE_EQ(1.5, array->values[7].as<JSON::Number>().as<double>());
+  EXPECT_DOUBLE_EQ(
+      -0.00125, array->values[8].as<JSON::Number>().as<double>());
+  EXPECT_DOUBLE_EQ(100000, array->values[9].as<JSON::Number>().as<double>());
+
+  // Top level numbers may be surrounded by whitespace too.
+  Try<JSON::Number> number = JSON::parse<JSON::Number>(" 7\n");
+  ASSERT_SOME(number);
+  EXPECT_EQ(7, number->as<int64_t>());
+
+  EXPECT_ERROR(JSON::parse("-"));
+  EXPECT_ERROR(JSON::parse("1e"));
+  EXPECT_ERROR(JSON::parse("1-2"));
+  EXPECT_ERROR(JSON::parse("7x"));
+
+  // Infinity cannot be represented in JSON.
+  EXPECT_ERROR(JSON::parse("1e400"));
+}
+
+
+TEST(JsonTest, ParseString)
+{
+  Try<JSON::String> string = JSON::parse<JSON::String>(
+      "\"\\\"\\\\\\/\\b\\f\\n\\r\\t\"");
+
+  ASSERT_SOME(string);
+  EXPECT_EQ("\"\\/\b\f\n\r\t", string->value);
+
+  // Code points are encoded as UTF-8, including the ones that are
+  // escaped as surrogate pairs.
+  string = JSON::parse<JSON::String>("\"\\u0041\\u00e9\\u4e2d\\ud83d\\ude00\"");
+
+  ASSERT_SOME(string);
+  EXPECT_EQ("A\xc3\xa9\xe4\xb8\xad\xf0\x9f\x98\x80", string->value);
+
+  EXPECT_ERROR(JSON::parse("\"unterminated"));
+  EXPECT_ERROR(JSON::parse("\"\\x\""));
+  EXPECT_ERROR(JSON::parse("\"\\u12\""));
+  EXPECT_ERROR(JSON::parse("\"\\ud800\""));
+  EXPECT_ERROR(JSON::parse("\"\\ude00\""));
+  EXPECT_ERROR(JSON::parse("\"control\x01\""));
+}
+
+
 TEST(JsonTest, Find)
 {
   Try<JSON::Value> value = JSON::parse(
@@ -10,10 +10,17 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <string>
+#include <vector>
+
 #include <gtest/gtest.h>
 
 #include <stout/gtest.hpp>
 #include <stout/numify.hpp>
+#include <stout/strings.hpp>
+
+using std::string;
+using std::vector;
 
 
 TEST(NumifyTest, DecNumberTest)
@@ -49,3 +56,21 @@ TEST(NumifyTest, HexNumberTest)
   EXPECT_ERROR(numify<double>("0x10.9"));
   EXPECT_ERROR(numify<double>("0x1p-5"));
 }
+
+
+TEST(NumifyTest, ViewTest)
+{
+  const string s = "total=123 avg10=0.12 mask=0x10 bad=12a";
+
+  const vector<strings::View> tokens =
+    strings::tokenize(strings::View(s), " ");
+  ASSERT_EQ(4u, tokens.size());
+
+  // The views are not null terminated, so this also verifies that
+  // only the viewed characters are parsed.
+  EXPECT_SOME_EQ(123u, numify<unsigned int>(tokens[0].substr(6)));
+  EXPECT_SOME_EQ(0.12, numify<double>(tokens[1].substr(6)));
+  EXPECT_SOME_EQ(16, numify<int>(tokens[2].substr(5)));
+  EXPECT_ERROR(numify<int>(tokens[3].substr(4)));
+  EXPECT_ERROR(numify<int>(strings::View()));
+}
@@ -89,6 +89,19 @@ TEST(RecordIOTest, Encoder)
       "13\n13 CHARACTERS",
       data);
 
+  // The records can also be appended to a buffer.
+  string buffer;
+
+  encoder.encode("hello!", &buffer);
+  encoder.encode("", &buffer);
+  encoder.encode(" ", &buffer);
+  encoder.encode("13 characters", &buffer);
+
+  EXPECT_EQ(data, buffer);
+
+  EXPECT_EQ("1234567\n" + string(1234567, 'A'),
+            encoder.encode(string(1234567, 'a')));
+
   // Make sure these can be decoded.
   recordio::Decoder<string> decoder(
       [=](const string& data) {
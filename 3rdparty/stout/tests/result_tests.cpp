@@ -10,16 +10,20 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <memory>
 #include <string>
+#include <utility>
 
 #include <gmock/gmock.h>
 
 #include <stout/error.hpp>
 #include <stout/gtest.hpp>
+#include <stout/option.hpp>
 #include <stout/result.hpp>
 #include <stout/try.hpp>
 
 using std::string;
+using std::unique_ptr;
 
 // Verify Try to Result conversion.
 TEST(ResultTest, TryToResultConversion)
@@ -57,3 +61,31 @@ TEST(ResultTest, ArrowOperator)
   s->clear();
   EXPECT_TRUE(s->empty());
 }
+
+
+TEST(ResultTest, MoveGet)
+{
+  Result<unique_ptr<int>> r = unique_ptr<int>(new int(42));
+
+  // Moving the result moves the value.
+  Result<unique_ptr<int>> moved = std::move(r);
+  ASSERT_SOME(moved);
+
+  unique_ptr<int> i = std::move(moved).get();
+  ASSERT_TRUE(i != nullptr);
+  EXPECT_EQ(42, *i);
+
+  // The value was moved out, not copied.
+  ASSERT_SOME(moved);
+  EXPECT_TRUE(moved.get() == nullptr);
+
+  // Move-only values can be converted from `Option` and `Try`.
+  Result<unique_ptr<int>> option = Option<unique_ptr<int>>(std::move(i));
+  ASSERT_SOME(option);
+  EXPECT_EQ(42, *option.get());
+
+  Result<unique_ptr<int>> t =
+    Try<unique_ptr<int>>(std::move(option).get());
+  ASSERT_SOME(t);
+  EXPECT_EQ(42, *t.get());
+}
@@ -103,6 +103,30 @@ TEST(StringsTest, Tokenize)
 }
 
 
+TEST(StringsTest, TokenizeView)
+{
+  const string s = "  hello world,  what's up?  ";
+
+  vector<strings::View> tokens = strings::tokenize(strings::View(s), " ");
+  ASSERT_EQ(4u, tokens.size());
+  EXPECT_EQ("hello",  tokens[0].str());
+  EXPECT_EQ("world,", tokens[1].str());
+  EXPECT_EQ("what's", tokens[2].str());
+  EXPECT_EQ("up?",    tokens[3].str());
+
+  // The tokens refer to the characters of the string.
+  EXPECT_EQ(s.data() + 2, tokens[0].data());
+
+  tokens = strings::tokenize(strings::View(s), " ", 2);
+  ASSERT_EQ(2u, tokens.size());
+  EXPECT_EQ("hello", tokens[0].str());
+  EXPECT_EQ("world,  what's up?  ", tokens[1].str());
+
+  EXPECT_TRUE(strings::tokenize(strings::View(), " ").empty());
+  EXPECT_TRUE(strings::tokenize(strings::View(s), " ", 0).empty());
+}
+
+
 TEST(StringsTest, TokenizeStringWithDelimsAtStart)
 {
   vector<string> tokens = strings::tokenize("  hello world,  what's up?", " ");
@@ -298,6 +322,28 @@ TEST(StringsTest, Split)
 }
 
 
+TEST(StringsTest, SplitView)
+{
+  const string s = "foo,bar,,baz=1";
+
+  vector<strings::View> tokens = strings::split(strings::View(s), ",");
+  ASSERT_EQ(4u, tokens.size());
+  EXPECT_TRUE(tokens[0] == "foo");
+  EXPECT_TRUE(tokens[1] == string("bar"));
+  EXPECT_TRUE(tokens[2].empty());
+  EXPECT_TRUE(tokens[3] != "baz");
+
+  vector<strings::View> pair = strings::split(tokens[3], "=", 2);
+  ASSERT_EQ(2u, pair.size());
+  EXPECT_EQ("baz", pair[0].str());
+  EXPECT_EQ("1", pair[1].str());
+
+  tokens = strings::split(strings::View(), ",");
+  ASSERT_EQ(1u, tokens.size());
+  EXPECT_TRUE(tokens[0].empty());
+}
+
+
 TEST(StringsTest, SplitStringWithDelimsAtStart)
 {
   vector<string> tokens = strings::split(",,foo,bar,,baz", ",");
@@ -10,13 +10,16 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <memory>
 #include <string>
+#include <utility>
 
 #include <gtest/gtest.h>
 
 #include <stout/try.hpp>
 
 using std::string;
+using std::unique_ptr;
 
 TEST(TryTest, ArrowOperator)
 {
@@ -26,3 +29,17 @@ TEST(TryTest, ArrowOperator)
   s->clear();
   EXPECT_TRUE(s->empty());
 }
+
+
+TEST(TryTest, MoveGet)
+{
+  Try<unique_ptr<int>> t = unique_ptr<int>(new int(42));
+
+  unique_ptr<int> i = std::move(t).get();
+  ASSERT_TRUE(i != nullptr);
+  EXPECT_EQ(42, *i);
+
+  // The value was moved out, not copied.
+  ASSERT_TRUE(t.isSome());
+  EXPECT_TRUE(t.get() == nullptr);
+}
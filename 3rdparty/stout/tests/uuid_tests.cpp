@@ -12,12 +12,15 @@
 
 #include <string>
 
+#include <boost/uuid/uuid_io.hpp>
+
 #include <gtest/gtest.h>
 
 #include <gmock/gmock.h>
 
 #include <stout/check.hpp>
 #include <stout/gtest.hpp>
+#include <stout/hashset.hpp>
 #include <stout/uuid.hpp>
 
 using std::string;
@@ -63,3 +66,22 @@ TEST(UUIDTest, MalformedUUID)
   EXPECT_SOME(UUID::fromString(UUID::random().toString()));
   EXPECT_ERROR(UUID::fromString("malformed-uuid"));
 }
+
+
+TEST(UUIDTest, Random)
+{
+  // Generate enough UUIDs to span several batches of the generator.
+  hashset<UUID> uuids;
+  for (int i = 0; i < 1000; i++) {
+    UUID uuid = UUID::random();
+
+    EXPECT_EQ(UUID::version_random_number_based, uuid.version());
+    EXPECT_EQ(UUID::variant_rfc_4122, uuid.variant());
+
+    EXPECT_EQ(boost::uuids::to_string(uuid), uuid.toString());
+    EXPECT_EQ(std::hash<UUID>()(uuid),
+              std::hash<UUID>()(UUID::fromBytes(uuid.toBytes()).get()));
+
+    EXPECT_TRUE(uuids.insert(uuid).second);
+  }
+}
@@ -49,6 +49,34 @@ option(
   "Use libevent instead of libev as the core event loop implementation"
   FALSE)
 
+option(
+  ENABLE_EPOLL
+  "Use a native epoll event loop instead of libev (Linux only)"
+  FALSE)
+
+if (ENABLE_EPOLL AND ENABLE_LIBEVENT)
+  message(
+    FATAL_ERROR
+    "`ENABLE_EPOLL` and `ENABLE_LIBEVENT` cannot both be set.")
+endif (ENABLE_EPOLL AND ENABLE_LIBEVENT)
+
+if (ENABLE_EPOLL AND (NOT CMAKE_SYSTEM_NAME STREQUAL "Linux"))
+  message(
+    FATAL_ERROR
+    "The epoll event loop (`ENABLE_EPOLL`) is only supported on Linux.")
+endif (ENABLE_EPOLL AND (NOT CMAKE_SYSTEM_NAME STREQUAL "Linux"))
+
+option(
+  ENABLE_IO_URING
+  "Use io_uring for libprocess I/O when supported by the kernel (Linux only)"
+  FALSE)
+
+if (ENABLE_IO_URING AND (NOT CMAKE_SYSTEM_NAME STREQUAL "Linux"))
+  message(
+    FATAL_ERROR
+    "io_uring (`ENABLE_IO_URING`) is only supported on Linux.")
+endif (ENABLE_IO_URING AND (NOT CMAKE_SYSTEM_NAME STREQUAL "Linux"))
+
 option(
   HAS_AUTHENTICATION
   "Build Mesos against authentication libraries"
@@ -247,6 +275,13 @@ if (HAS_AUTHENTICATION)
     )
 endif (HAS_AUTHENTICATION)
 
+if (ENABLE_IO_URING)
+  set(MESOS_CPPFLAGS
+    ${MESOS_CPPFLAGS}
+    -DUSE_IO_URING=1
+    )
+endif (ENABLE_IO_URING)
+
 # Enable the INT64 support for PicoJSON.
 # NOTE: PicoJson requires __STDC_FORMAT_MACROS to be defined before importing
 # 'inttypes.h'.  Since other libraries may also import this header, it must
@@ -157,6 +157,10 @@ set(
   MESOS_MASTER mesos-master
   CACHE STRING "Target for master")
 
+set(
+  MESOS_ALLOCATOR_REPLAY mesos-allocator-replay
+  CACHE STRING "Target for replaying allocator traces")
+
 set(
   MESOS_TCP_CONNECT mesos-tcp-connect
   CACHE STRING "Target for tcp-connect")
@@ -41,6 +41,33 @@
 namespace mesos {
 namespace allocator {
 
+/**
+ * Optional settings that tune how an allocator allocates, passed to
+ * `Allocator::initialize()`. Allocators may ignore the settings they
+ * do not support.
+ */
+struct Options
+{
+  /**
+   * Number of partitions of agents for which the allocator may compute
+   * offers in parallel.
+   */
+  Option<size_t> allocationPartitions;
+
+  /**
+   * If set, the allocator may only allocate agents and roles affected
+   * by events in between full allocations of all agents, which happen
+   * at this interval.
+   */
+  Option<Duration> allocationSweepInterval;
+
+  /**
+   * The order in which the allocator visits agents (e.g., `random` or
+   * `bin_packing`).
+   */
+  Option<std::string> agentOrdering;
+};
+
 /**
  * Basic model of an allocator: resources are allocated to a framework
  * in the form of offers. A framework can refuse some resources in
@@ -83,6 +110,10 @@ public:
    *     allocations from the frameworks.
    * @param weights Configured per-role weights. Any roles that do not
    *     appear in this map will be assigned the default weight of 1.
+   * @param fairnessExcludeResourceNames Names of resources that are
+   *     excluded from fair sharing calculations.
+   * @param options Optional settings that tune how the allocator
+   *     allocates, see `Options`.
    */
   virtual void initialize(
       const Duration& allocationInterval,
@@ -95,7 +126,8 @@ public:
         inverseOfferCallback,
       const hashmap<std::string, double>& weights,
       const Option<std::set<std::string>>&
-        fairnessExcludeResourceNames = None()) = 0;
+        fairnessExcludeResourceNames = None(),
+      const Options& options = Options()) = 0;
 
   /**
    * Informs the allocator of the recovered state from the master.
@@ -336,6 +368,23 @@ public:
       const Resources& resources,
       const Option<Filters>& filters) = 0;
 
+  /**
+   * Recovers the resources of a framework on many agents at once, e.g.,
+   * when all the offers of a framework are removed.
+   *
+   * The default implementation recovers the resources on each agent in
+   * turn; allocators can override it to update their state only once.
+   */
+  virtual void recoverResources(
+      const FrameworkID& frameworkId,
+      const hashmap<SlaveID, Resources>& resources,
+      const Option<Filters>& filters)
+  {
+    for (auto it = resources.begin(); it != resources.end(); ++it) {
+      recoverResources(frameworkId, it->first, it->second, filters);
+    }
+  }
+
   /**
    * Suppresses offers.
    *
@@ -39,6 +39,7 @@ namespace log {
 // Forward declarations.
 class LogProcess;
 class LogReaderProcess;
+class LogStreamProcess;
 class LogWriterProcess;
 
 } // namespace log {
@@ -54,6 +55,7 @@ class Log
 public:
   // Forward declarations.
   class Reader;
+  class Stream;
   class Writer;
 
   class Position
@@ -105,6 +107,7 @@ public:
     friend class Log;
     friend class Writer;
     friend class internal::log::LogReaderProcess;
+    friend class internal::log::LogStreamProcess;
     friend class internal::log::LogWriterProcess;
 
     /*implicit*/ Position(uint64_t _value) : value(_value) {}
@@ -148,10 +151,39 @@ public:
     // partitioned).
     process::Future<Position> ending();
 
+    // Returns the last position up to which the log can be read from
+    // the specified position, once the entry at that position has
+    // been learned by the local replica. This lets a reader wait for
+    // new entries instead of polling Reader::ending.
+    process::Future<Position> follow(const Position& from);
+
   private:
     internal::log::LogReaderProcess* process;
   };
 
+  class Stream
+  {
+  public:
+    // Creates a new stream that reads the log in order starting from
+    // the specified position, in chunks spanning at most `chunk`
+    // positions so that the memory used is bounded regardless of the
+    // size of the log. The next chunk is prefetched while the caller
+    // processes the current one. If `follow` is true, the stream
+    // waits for new entries once it has read the end of the log (see
+    // Reader::follow) rather than reporting the end.
+    Stream(Log* log, const Position& from, size_t chunk, bool follow = false);
+    ~Stream();
+
+    // Returns the next (non-empty) chunk of entries, or an empty list
+    // once the end of the log has been read, or an error if reading
+    // fails (e.g., the next position has been truncated). Only one
+    // read may be outstanding at a time.
+    process::Future<std::list<Entry>> read();
+
+  private:
+    internal::log::LogStreamProcess* process;
+  };
+
   class Writer
   {
   public:
@@ -135,6 +135,22 @@ public:
       SchedulerDriver* driver,
       const TaskStatus& status) = 0;
 
+  // Invoked instead of Scheduler::statusUpdate when the driver batches
+  // status updates (see the 'callback_batch_interval' flag of the
+  // scheduler driver). The same semantics as for statusUpdate apply
+  // to each of the status updates, i.e., if implicit acknowledgements
+  // are being used, returning from this callback acknowledges all of
+  // them. By default, this invokes Scheduler::statusUpdate for each
+  // status update in order.
+  virtual void statusUpdates(
+      SchedulerDriver* driver,
+      const std::vector<TaskStatus>& statuses)
+  {
+    for (size_t i = 0; i < statuses.size(); i++) {
+      statusUpdate(driver, statuses[i]);
+    }
+  }
+
   // Invoked when an executor sends a message. These messages are best
   // effort; do not expect a framework message to be retransmitted in
   // any reliable fashion.
@@ -24,6 +24,7 @@
 
 #include <process/future.hpp>
 
+#include <stout/bytes.hpp>
 #include <stout/lambda.hpp>
 #include <stout/option.hpp>
 #include <stout/protobuf.hpp>
@@ -69,8 +70,10 @@ private:
 class State : public mesos::state::State
 {
 public:
-  explicit State(mesos::state::Storage* storage)
-    : mesos::state::State(storage) {}
+  explicit State(
+      mesos::state::Storage* storage,
+      const Option<Bytes>& chunkSize = None())
+    : mesos::state::State(storage, chunkSize) {}
   virtual ~State() {}
 
   // Returns a variable from the state, creating a new one if one
@@ -84,6 +87,10 @@ public:
   template <typename T>
   process::Future<Option<Variable<T>>> store(const Variable<T>& variable);
 
+  // Returns true if the variable is the latest version in the state.
+  template <typename T>
+  process::Future<bool> latest(const Variable<T>& variable);
+
   // Expunges the variable from the state.
   template <typename T>
   process::Future<bool> expunge(const Variable<T>& variable);
@@ -152,6 +159,13 @@ process::Future<Option<Variable<T>>> State::_store(
 }
 
 
+template <typename T>
+process::Future<bool> State::latest(const Variable<T>& variable)
+{
+  return mesos::state::State::latest(variable.variable);
+}
+
+
 template <typename T>
 process::Future<bool> State::expunge(const Variable<T>& variable)
 {
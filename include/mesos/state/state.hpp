@@ -17,18 +17,30 @@
 #ifndef __MESOS_STATE_STATE_HPP__
 #define __MESOS_STATE_STATE_HPP__
 
+#include <stdint.h>
+
+#include <algorithm>
+#include <functional>
+#include <list>
+#include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
 #include <mesos/state/storage.hpp>
 
+#include <process/collect.hpp>
 #include <process/deferred.hpp> // TODO(benh): This is required by Clang.
 #include <process/future.hpp>
 
+#include <stout/bytes.hpp>
+#include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
 #include <stout/lambda.hpp>
 #include <stout/none.hpp>
 #include <stout/option.hpp>
 #include <stout/some.hpp>
+#include <stout/strings.hpp>
 #include <stout/try.hpp>
 #include <stout/uuid.hpp>
 
@@ -55,6 +67,14 @@ namespace state {
 //   std::string value = update(variable.value());
 //   variable = variable.mutate(value);
 //   state->store(variable);
+//
+// A state can also store large values in "chunks", each in its own
+// entry in the storage, to stay under the size limit of an entry
+// (e.g., 1 MB for ZooKeeper) and to only write the parts of a value
+// that changed since it was fetched. The entry of the variable then
+// just lists the entries of its chunks. Chunked variables can be
+// fetched by any state, but they are only stored in chunks by a state
+// created with a 'chunkSize'.
 
 // Forward declarations.
 class State;
@@ -84,13 +104,25 @@ private:
   {}
 
   internal::state::Entry entry; // Not const to keep Variable assignable.
+
+  // The entries of the chunks of the value as it was fetched (or
+  // stored), if it is stored in chunks.
+  std::shared_ptr<const std::vector<internal::state::Entry>> chunks;
 };
 
 
 class State
 {
 public:
-  explicit State(Storage* _storage) : storage(_storage) {}
+  // If 'chunkSize' is some, values larger than 4 times the chunk size
+  // are stored in chunks of about 'chunkSize' bytes (and at most 4
+  // times 'chunkSize').
+  explicit State(
+      Storage* _storage,
+      const Option<Bytes>& _chunkSize = None())
+    : storage(_storage),
+      chunkSize(_chunkSize) {}
+
   virtual ~State() {}
 
   // Returns a variable from the state, creating a new one if one
@@ -102,6 +134,11 @@ public:
   // was no longer valid, or an error if one occurs.
   process::Future<Option<Variable>> store(const Variable& variable);
 
+  // Returns true if the variable is the latest version in the state,
+  // i.e., it has not been stored by anybody else since it was fetched
+  // (or stored). This checks the version without writing the value.
+  process::Future<bool> latest(const Variable& variable);
+
   // Returns true if successfully expunged the variable from the state.
   process::Future<bool> expunge(const Variable& variable);
 
@@ -113,30 +150,87 @@ private:
   // these static members of State for friend access to Variable's
   // constructor.
   static process::Future<Variable> _fetch(
+      Storage* storage,
       const std::string& name,
       const Option<internal::state::Entry>& option);
 
+  static process::Future<Variable> __fetch(
+      const internal::state::Entry& entry,
+      const std::list<Option<internal::state::Entry>>& chunks);
+
   static process::Future<Option<Variable>> _store(
+      Storage* storage,
+      const Variable& variable,
+      const UUID& uuid,
+      const internal::state::Entry& entry,
+      const std::shared_ptr<const std::vector<internal::state::Entry>>& chunks,
+      const std::list<bool>& stored);
+
+  static process::Future<Option<Variable>> __store(
+      Storage* storage,
+      const Variable& variable,
       const internal::state::Entry& entry,
+      const std::shared_ptr<const std::vector<internal::state::Entry>>& chunks,
+      const bool& b); // TODO(benh): Remove 'const &' after fixing libprocess.
+
+  static process::Future<bool> _latest(
+      const Variable& variable,
+      const Option<internal::state::Entry>& option);
+
+  static process::Future<bool> _expunge(
+      Storage* storage,
+      const Variable& variable,
       const bool& b); // TODO(benh): Remove 'const &' after fixing libprocess.
 
+  static process::Future<std::set<std::string>> _names(
+      const std::set<std::string>& names);
+
+  // Splits the value into chunks of about 'size' bytes.
+  static std::vector<std::string> split(
+      const std::string& value,
+      const Bytes& size);
+
+  // Expunges the chunks (in the background) except for those that
+  // are in 'entry'.
+  static void expunge(
+      Storage* storage,
+      const std::vector<internal::state::Entry>& chunks,
+      const internal::state::Entry& entry);
+
+  // Returns whether the name is the name of the entry of a chunk.
+  static bool chunk(const std::string& name);
+
   Storage* storage;
+
+  const Option<Bytes> chunkSize;
 };
 
 
 inline process::Future<Variable> State::fetch(const std::string& name)
 {
   return storage->get(name)
-    .then(lambda::bind(&State::_fetch, name, lambda::_1));
+    .then(lambda::bind(&State::_fetch, storage, name, lambda::_1));
 }
 
 
 inline process::Future<Variable> State::_fetch(
+    Storage* storage,
     const std::string& name,
     const Option<internal::state::Entry>& option)
 {
   if (option.isSome()) {
-    return Variable(option.get());
+    if (option->chunks().size() == 0) {
+      return Variable(option.get());
+    }
+
+    // Fetch all the chunks in parallel.
+    std::list<process::Future<Option<internal::state::Entry>>> chunks;
+    foreach (const std::string& chunk, option->chunks()) {
+      chunks.push_back(storage->get(chunk));
+    }
+
+    return process::collect(chunks)
+      .then(lambda::bind(&State::__fetch, option.get(), lambda::_1));
   }
 
   // Otherwise, construct a Variable with a new Entry (with a random
@@ -149,6 +243,35 @@ inline process::Future<Variable> State::_fetch(
 }
 
 
+inline process::Future<Variable> State::__fetch(
+    const internal::state::Entry& entry,
+    const std::list<Option<internal::state::Entry>>& chunks)
+{
+  Variable variable(entry);
+
+  std::vector<internal::state::Entry> entries;
+  std::string value;
+
+  int index = 0;
+  foreach (const Option<internal::state::Entry>& chunk, chunks) {
+    if (chunk.isNone()) {
+      return process::Failure(
+          "Failed to fetch chunk '" + entry.chunks(index) +
+          "' of '" + entry.name() + "'");
+    }
+
+    value += chunk->value();
+    entries.push_back(chunk.get());
+    index++;
+  }
+
+  variable.entry.set_value(value);
+  variable.chunks.reset(new std::vector<internal::state::Entry>(entries));
+
+  return variable;
+}
+
+
 inline process::Future<Option<Variable>> State::store(const Variable& variable)
 {
   // Note that we try and swap an entry even if the value didn't change!
@@ -159,34 +282,272 @@ inline process::Future<Option<Variable>> State::store(const Variable& variable)
   internal::state::Entry entry;
   entry.set_name(variable.entry.name());
   entry.set_uuid(UUID::random().toBytes());
-  entry.set_value(variable.entry.value());
 
-  return storage->set(entry, uuid)
-    .then(lambda::bind(&State::_store, entry, lambda::_1));
+  const std::string& value = variable.entry.value();
+
+  if (chunkSize.isNone() || value.size() <= 4 * chunkSize->bytes()) {
+    entry.set_value(value);
+
+    return storage->set(entry, uuid)
+      .then(lambda::bind(
+          &State::__store,
+          storage,
+          variable,
+          entry,
+          nullptr,
+          lambda::_1));
+  }
+
+  entry.set_value("");
+
+  // The chunks that did not change since the variable was fetched
+  // (or stored) are reused, and only the other chunks are written,
+  // each to a new entry, so the chunks of the variable in the storage
+  // are not affected if the store fails.
+  hashmap<size_t, std::vector<const internal::state::Entry*>> existing;
+  if (variable.chunks) {
+    foreach (const internal::state::Entry& chunk, *variable.chunks) {
+      existing[std::hash<std::string>()(chunk.value())].push_back(&chunk);
+    }
+  }
+
+  std::vector<internal::state::Entry> chunks;
+  std::list<process::Future<bool>> stored;
+
+  foreach (const std::string& data, split(value, chunkSize.get())) {
+    const internal::state::Entry* reused = nullptr;
+
+    const size_t hash = std::hash<std::string>()(data);
+    if (existing.contains(hash)) {
+      foreach (const internal::state::Entry* chunk, existing.at(hash)) {
+        if (chunk->value() == data) {
+          reused = chunk;
+          break;
+        }
+      }
+    }
+
+    if (reused != nullptr) {
+      chunks.push_back(*reused);
+    } else {
+      internal::state::Entry chunk;
+      chunk.set_name(entry.name() + ".chunk." + UUID::random().toString());
+      chunk.set_uuid(UUID::random().toBytes());
+      chunk.set_value(data);
+
+      // NOTE: The entry doesn't exist, so the UUID doesn't matter.
+      stored.push_back(storage->set(chunk, UUID::random()));
+      chunks.push_back(chunk);
+    }
+
+    entry.add_chunks(chunks.back().name());
+  }
+
+  return process::collect(stored)
+    .then(lambda::bind(
+        &State::_store,
+        storage,
+        variable,
+        uuid,
+        entry,
+        std::make_shared<const std::vector<internal::state::Entry>>(chunks),
+        lambda::_1));
 }
 
 
 inline process::Future<Option<Variable>> State::_store(
+    Storage* storage,
+    const Variable& variable,
+    const UUID& uuid,
     const internal::state::Entry& entry,
+    const std::shared_ptr<const std::vector<internal::state::Entry>>& chunks,
+    const std::list<bool>& stored)
+{
+  foreach (bool b, stored) {
+    if (!b) {
+      return process::Failure(
+          "Failed to store a chunk of '" + entry.name() + "'");
+    }
+  }
+
+  return storage->set(entry, uuid)
+    .then(lambda::bind(
+        &State::__store,
+        storage,
+        variable,
+        entry,
+        chunks,
+        lambda::_1));
+}
+
+
+inline process::Future<Option<Variable>> State::__store(
+    Storage* storage,
+    const Variable& variable,
+    const internal::state::Entry& entry,
+    const std::shared_ptr<const std::vector<internal::state::Entry>>& chunks,
     const bool& b) // TODO(benh): Remove 'const &' after fixing libprocess.
 {
-  if (b) {
-    return Some(Variable(entry));
+  if (!b) {
+    // We wrote the new chunks, nobody else refers to them.
+    if (chunks) {
+      expunge(storage, *chunks, variable.entry);
+    }
+
+    return None();
   }
 
-  return None();
+  // The chunks of the previous value are no longer needed.
+  if (variable.chunks) {
+    expunge(storage, *variable.chunks, entry);
+  }
+
+  Variable stored(entry);
+  stored.entry.set_value(variable.entry.value());
+  stored.chunks = chunks;
+
+  return Some(stored);
+}
+
+
+inline process::Future<bool> State::latest(const Variable& variable)
+{
+  return storage->get(variable.entry.name())
+    .then(lambda::bind(&State::_latest, variable, lambda::_1));
+}
+
+
+inline process::Future<bool> State::_latest(
+    const Variable& variable,
+    const Option<internal::state::Entry>& option)
+{
+  return option.isSome() && option->uuid() == variable.entry.uuid();
 }
 
 
 inline process::Future<bool> State::expunge(const Variable& variable)
 {
-  return storage->expunge(variable.entry);
+  return storage->expunge(variable.entry)
+    .then(lambda::bind(&State::_expunge, storage, variable, lambda::_1));
+}
+
+
+inline process::Future<bool> State::_expunge(
+    Storage* storage,
+    const Variable& variable,
+    const bool& b) // TODO(benh): Remove 'const &' after fixing libprocess.
+{
+  if (b && variable.chunks) {
+    expunge(storage, *variable.chunks, internal::state::Entry());
+  }
+
+  return b;
 }
 
 
 inline process::Future<std::set<std::string>> State::names()
 {
-  return storage->names();
+  return storage->names()
+    .then(lambda::bind(&State::_names, lambda::_1));
+}
+
+
+inline process::Future<std::set<std::string>> State::_names(
+    const std::set<std::string>& names)
+{
+  std::set<std::string> result;
+  foreach (const std::string& name, names) {
+    if (!chunk(name)) {
+      result.insert(name);
+    }
+  }
+
+  return result;
+}
+
+
+inline std::vector<std::string> State::split(
+    const std::string& value,
+    const Bytes& size)
+{
+  // We use a "gear" rolling hash, which depends on the last 64 bytes,
+  // and end a chunk wherever its top 'bits' bits are zero. As the
+  // ends only depend on the bytes preceding them, changing a part of
+  // the value (including inserting or removing bytes) does not move
+  // the ends of the chunks that follow.
+  static const std::vector<uint64_t>* gear = []() {
+    std::vector<uint64_t>* gear = new std::vector<uint64_t>();
+
+    // Generate the table with "splitmix64", so that it is the same
+    // everywhere.
+    uint64_t x = 0;
+    for (int i = 0; i < 256; i++) {
+      uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+      z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+      z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+      gear->push_back(z ^ (z >> 31));
+    }
+
+    return gear;
+  }();
+
+  // Keep the chunks between a quarter and 4 times 'size'.
+  const size_t min = std::max<uint64_t>(size.bytes() / 4, 1);
+  const size_t max = std::max<uint64_t>(size.bytes() * 4, 1);
+
+  int bits = 0;
+  while (bits < 63 && (2ULL << bits) <= min * 3) {
+    bits++;
+  }
+
+  std::vector<std::string> chunks;
+
+  size_t begin = 0;
+  uint64_t hash = 0;
+
+  for (size_t i = 0; i < value.size(); i++) {
+    hash = (hash << 1) + (*gear)[static_cast<unsigned char>(value[i])];
+
+    const size_t length = i + 1 - begin;
+
+    if ((length >= min && (hash >> (64 - bits)) == 0) || length >= max) {
+      chunks.push_back(value.substr(begin, length));
+      begin = i + 1;
+    }
+  }
+
+  if (begin < value.size()) {
+    chunks.push_back(value.substr(begin));
+  }
+
+  return chunks;
+}
+
+
+inline void State::expunge(
+    Storage* storage,
+    const std::vector<internal::state::Entry>& chunks,
+    const internal::state::Entry& entry)
+{
+  std::set<std::string> keep(entry.chunks().begin(), entry.chunks().end());
+
+  // NOTE: This is best effort, a chunk that fails to be expunged is
+  // just left behind.
+  foreach (const internal::state::Entry& chunk, chunks) {
+    if (keep.count(chunk.name()) == 0) {
+      storage->expunge(chunk);
+    }
+  }
+}
+
+
+inline bool State::chunk(const std::string& name)
+{
+  // The name of the entry of a chunk ends with '.chunk.<UUID>'.
+  const size_t index = name.rfind(".chunk.");
+
+  return index != std::string::npos &&
+    UUID::fromString(name.substr(index + 7)).isSome();
 }
 
 } // namespace state {
@@ -33,6 +33,7 @@
 #include <stout/error.hpp>
 #include <stout/foreach.hpp>
 #include <stout/hashmap.hpp>
+#include <stout/interval.hpp>
 #include <stout/json.hpp>
 #include <stout/lambda.hpp>
 #include <stout/option.hpp>
@@ -82,6 +83,8 @@ private:
       if (resource.has_shared()) {
         sharedCount = 1;
       }
+
+      updateValue();
     }
 
     // By implicitly converting to Resource we are able to keep Resource_
@@ -110,6 +113,11 @@ private:
     // Checks if this Resource_ is a superset of the given Resource_.
     bool contains(const Resource_& that) const;
 
+    // Tests if the given Resource_ can be added to (or subtracted from)
+    // this Resource_ resulting in one valid Resource_ object.
+    bool addable(const Resource_& that) const;
+    bool subtractable(const Resource_& that) const;
+
     // The arithmetic operators, viz. += and -= assume that the corresponding
     // Resource objects are addable or subtractable already.
     Resource_& operator+=(const Resource_& that);
@@ -124,6 +132,11 @@ private:
         std::ostream& stream, const Resource_& resource_);
 
   private:
+    // Updates `scalar` and `ranges` from `resource`. This must be called
+    // whenever `resource` is modified other than through the operators
+    // above.
+    void updateValue();
+
     // The protobuf Resource that is being managed.
     Resource resource;
 
@@ -131,6 +144,21 @@ private:
     // 'resource' is non-shared. This is an int so as to support arithmetic
     // operations involving subtraction.
     Option<int> sharedCount;
+
+    // The fixed point value of `resource` if it is a plain scalar
+    // resource, i.e., one without any allocation, reservation, disk,
+    // revocable or shared info (e.g., "cpus(*):2"), or None otherwise.
+    // Most resources added, subtracted and compared in the master are
+    // of this kind, so we use this compact form to do arithmetic and
+    // comparisons on them without the generic protobuf logic.
+    Option<long long> scalar;
+
+    // The ranges of `resource` as an interval set if it is a non-shared
+    // ranges resource (e.g., "ports"), or None otherwise. Ports of busy
+    // agents are fragmented into many ranges, so we do the arithmetic
+    // and comparisons on this set, which stays sorted and merged, rather
+    // than sorting and merging the protobuf ranges on every operation.
+    Option<IntervalSet<uint64_t>> ranges;
   };
 
 public:
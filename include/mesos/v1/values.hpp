@@ -17,10 +17,13 @@
 #ifndef __MESOS_V1_VALUES_HPP__
 #define __MESOS_V1_VALUES_HPP__
 
+#include <stdint.h>
+
 #include <iosfwd>
 
 #include <mesos/v1/mesos.hpp>
 
+#include <stout/interval.hpp>
 #include <stout/try.hpp>
 
 namespace mesos {
@@ -58,6 +61,16 @@ namespace values {
 
 Try<Value> parse(const std::string& text);
 
+// Converts a scalar value to and from the fixed point representation
+// used for scalar arithmetic, which preserves three decimal digits.
+long long convertToFixed(double floatValue);
+double convertToFloating(long long fixedValue);
+
+// Converts a ranges value to and from the interval set representation
+// used for ranges arithmetic, which keeps the ranges sorted and merged.
+IntervalSet<uint64_t> rangesToIntervalSet(const Value::Ranges& ranges);
+Value::Ranges intervalSetToRanges(const IntervalSet<uint64_t>& set);
+
 } // namespace values {
 } // namespace internal {
 
@@ -183,6 +183,14 @@ public:
 
   static const Duration RETRY_INTERVAL;
 
+  // Helper function that returns a random delay between the given
+  // duration and twice the duration, which is how long the group
+  // waits before retrying after a retryable error. The random part
+  // ensures that the many groups (e.g., of the detectors of all
+  // agents and frameworks) which failed at the same time don't all
+  // retry at once.
+  static Duration jitter(const Duration& duration);
+
   // Helper function that returns the basename of the znode of
   // the membership.
   static std::string zkBasename(const Group::Membership& membership);
@@ -341,6 +349,13 @@ private:
   // cache and 'Some' represents a valid cache.
   Option<std::set<Group::Membership>> memberships;
 
+  // The data of the memberships keyed by their sequence numbers. The
+  // data of a membership never changes, hence we only get it from
+  // ZooKeeper once rather than after every change of the group (e.g.,
+  // when the watchers of the group re-fetch the data of the leader
+  // after a reconnection to ZooKeeper).
+  std::map<int32_t, std::string> datas;
+
   // A timer that controls when we should give up on waiting for the
   // current connection attempt to succeed and try to reconnect.
   Option<process::Timer> connectTimer;
@@ -304,6 +304,30 @@ public:
    */
   int set(const std::string& path, const std::string& data, int version);
 
+  /**
+   * \brief atomically performs multiple operations synchronously.
+   *
+   * Either all the operations succeed, or none of them are performed.
+   *
+   * \param ops the operations to perform, initialized with
+   *    `zoo_create_op_init`, `zoo_delete_op_init`, `zoo_set_op_init`
+   *    or `zoo_check_op_init`. The paths and data referenced by the
+   *    operations only need to remain valid until this call returns.
+   * \param results will hold the result of each operation on
+   *    return. If the transaction fails, the result of the operation
+   *    that caused the failure holds the error, and the other
+   *    operations hold either ZOK or ZRUNTIMEINCONSISTENCY.
+   * \return the return code for the function call.
+   * ZOK all the operations completed successfully
+   * ZBADARGUMENTS - invalid input parameters
+   * ZINVALIDSTATE - zhandle state is either ZOO_SESSION_EXPIRED_STATE or ZOO_AUTH_FAILED_STATE
+   * ZMARSHALLINGERROR - failed to marshall a request; possibly, out of memory
+   * or the return code of the first operation that failed.
+   */
+  int multi(
+      const std::vector<zoo_op_t>& ops,
+      std::vector<zoo_op_result_t>* results);
+
   /**
    * \brief return a message describing the return code.
    *
@@ -0,0 +1,159 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "authorizer/caching/authorizer.hpp"
+
+#include <string>
+
+#include <process/clock.hpp>
+#include <process/defer.hpp>
+#include <process/dispatch.hpp>
+#include <process/id.hpp>
+#include <process/process.hpp>
+#include <process/time.hpp>
+
+#include <process/metrics/counter.hpp>
+#include <process/metrics/metrics.hpp>
+
+#include <stout/cache.hpp>
+
+using std::string;
+
+using process::Clock;
+using process::Future;
+using process::Owned;
+using process::Process;
+using process::Time;
+
+namespace mesos {
+namespace internal {
+
+class CachingAuthorizerProcess : public Process<CachingAuthorizerProcess>
+{
+public:
+  CachingAuthorizerProcess(
+      Authorizer* _authorizer,
+      const Duration& _ttl,
+      size_t capacity)
+    : ProcessBase(process::ID::generate("caching-authorizer")),
+      authorizer(_authorizer),
+      ttl(_ttl),
+      decisions(capacity) {}
+
+  Future<bool> authorized(const authorization::Request& request)
+  {
+    // NOTE: The serialization of a message without map fields is
+    // deterministic, hence so is the key of a request.
+    const string key = request.SerializeAsString();
+
+    Option<Decision> decision = decisions.get(key);
+    if (decision.isSome() && Clock::now() < decision->expiry) {
+      ++metrics.hits;
+      return decision->authorized;
+    }
+
+    ++metrics.misses;
+
+    Future<bool> authorized = authorizer->authorized(request);
+    decisions.put(key, Decision{authorized, Clock::now() + ttl});
+
+    authorized
+      .onFailed(defer(self(), &Self::forget, key, authorized))
+      .onDiscarded(defer(self(), &Self::forget, key, authorized));
+
+    return authorized;
+  }
+
+private:
+  struct Decision
+  {
+    Future<bool> authorized;
+    Time expiry;
+  };
+
+  struct Metrics
+  {
+    Metrics()
+      : hits("authorizer/cache/hits"),
+        misses("authorizer/cache/misses")
+    {
+      process::metrics::add(hits);
+      process::metrics::add(misses);
+    }
+
+    ~Metrics()
+    {
+      process::metrics::remove(hits);
+      process::metrics::remove(misses);
+    }
+
+    process::metrics::Counter hits;
+    process::metrics::Counter misses;
+  };
+
+  // Removes the decision unless it has been replaced in the meantime.
+  void forget(const string& key, const Future<bool>& authorized)
+  {
+    Option<Decision> decision = decisions.get(key);
+    if (decision.isSome() && decision->authorized == authorized) {
+      decisions.erase(key);
+    }
+  }
+
+  Authorizer* authorizer;
+  const Duration ttl;
+  Cache<string, Decision> decisions;
+  Metrics metrics;
+};
+
+
+CachingAuthorizer::CachingAuthorizer(
+    Authorizer* _authorizer,
+    const Duration& ttl,
+    size_t capacity)
+  : authorizer(CHECK_NOTNULL(_authorizer)),
+    process(new CachingAuthorizerProcess(_authorizer, ttl, capacity))
+{
+  spawn(process.get());
+}
+
+
+CachingAuthorizer::~CachingAuthorizer()
+{
+  terminate(process.get());
+  wait(process.get());
+}
+
+
+Future<bool> CachingAuthorizer::authorized(
+    const authorization::Request& request)
+{
+  return dispatch(
+      process.get(),
+      &CachingAuthorizerProcess::authorized,
+      request);
+}
+
+
+Future<Owned<ObjectApprover>> CachingAuthorizer::getObjectApprover(
+    const Option<authorization::Subject>& subject,
+    const authorization::Action& action)
+{
+  return authorizer->getObjectApprover(subject, action);
+}
+
+} // namespace internal {
+} // namespace mesos {
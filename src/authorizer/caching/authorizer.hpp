@@ -0,0 +1,77 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __AUTHORIZER_CACHING_AUTHORIZER_HPP__
+#define __AUTHORIZER_CACHING_AUTHORIZER_HPP__
+
+#include <mesos/authorizer/authorizer.hpp>
+
+#include <process/future.hpp>
+#include <process/owned.hpp>
+
+#include <stout/duration.hpp>
+#include <stout/option.hpp>
+
+namespace mesos {
+namespace internal {
+
+// Forward declaration.
+class CachingAuthorizerProcess;
+
+
+// An authorizer which caches the decisions of another authorizer
+// (e.g., an authorizer module backed by a remote service) for a
+// bounded time. The decisions are keyed on the whole request, i.e.,
+// the subject, the action and the object, so a decision is only ever
+// reused for an identical request. Concurrent identical requests
+// share the pending decision. Failed decisions are not cached.
+//
+// The object approvers are not cached since they are already used
+// locally (and synchronously).
+//
+// The hits and misses of the cache are exported as the
+// 'authorizer/cache/hits' and 'authorizer/cache/misses' metrics.
+class CachingAuthorizer : public Authorizer
+{
+public:
+  // Takes ownership of the authorizer. At most `capacity` decisions
+  // are cached, the least recently used ones are evicted first.
+  CachingAuthorizer(
+      Authorizer* authorizer,
+      const Duration& ttl,
+      size_t capacity);
+
+  virtual ~CachingAuthorizer();
+
+  virtual process::Future<bool> authorized(
+      const authorization::Request& request);
+
+  virtual process::Future<process::Owned<ObjectApprover>> getObjectApprover(
+      const Option<authorization::Subject>& subject,
+      const authorization::Action& action);
+
+private:
+  CachingAuthorizer(const CachingAuthorizer&) = delete;
+  CachingAuthorizer& operator=(const CachingAuthorizer&) = delete;
+
+  process::Owned<Authorizer> authorizer;
+  process::Owned<CachingAuthorizerProcess> process;
+};
+
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __AUTHORIZER_CACHING_AUTHORIZER_HPP__
@@ -17,6 +17,7 @@
 #include "authorizer/local/authorizer.hpp"
 
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <mesos/mesos.hpp>
@@ -30,6 +31,7 @@
 #include <process/protobuf.hpp>
 
 #include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
 #include <stout/none.hpp>
 #include <stout/option.hpp>
 #include <stout/path.hpp>
@@ -199,20 +201,45 @@ public:
     : acls_(acls),
       subject_(subject),
       action_(action),
-      permissive_(permissive) {}
-
-  virtual Try<bool> approved(
-      const Option<ObjectApprover::Object>& object) const noexcept override
+      permissive_(permissive)
   {
     // Construct subject.
-    ACL::Entity aclSubject;
     if (subject_.isSome()) {
-      aclSubject.add_values(subject_->value());
-      aclSubject.set_type(mesos::ACL::Entity::SOME);
+      aclSubject_.add_values(subject_->value());
+      aclSubject_.set_type(mesos::ACL::Entity::SOME);
     } else {
-      aclSubject.set_type(mesos::ACL::Entity::ANY);
+      aclSubject_.set_type(mesos::ACL::Entity::ANY);
+    }
+
+    // Since the subject is the same for all objects, we only keep the
+    // ACLs which match the subject (in their order) and index them by
+    // the values of their objects. An approver is used to filter all
+    // the objects of a request (e.g., all the tasks in '/state'), so
+    // this turns the linear scan over the ACLs into a lookup.
+    foreach (const GenericACL& acl, acls_.acls) {
+      if (!matches(aclSubject_, acl.subjects)) {
+        continue;
+      }
+
+      const size_t index = candidates_.size();
+      candidates_.push_back(
+          std::make_pair(acl.objects, allows(aclSubject_, acl.subjects)));
+
+      if (acl.objects.type() == ACL::Entity::SOME) {
+        foreach (const string& value, acl.objects.values()) {
+          if (!first_.contains(value)) {
+            first_[value] = index;
+          }
+        }
+      } else if (wildcard_.isNone()) {
+        wildcard_ = index;
+      }
     }
+  }
 
+  virtual Try<bool> approved(
+      const Option<ObjectApprover::Object>& object) const noexcept override
+  {
     // Construct object.
     ACL::Entity aclObject;
 
@@ -390,7 +417,7 @@ public:
               aclObject.set_type(mesos::ACL::Entity::SOME);
 
               CHECK_SOME(acls_.set_quotas);
-              return approved(acls_.set_quotas.get(), aclSubject, aclObject);
+              return approved(acls_.set_quotas.get(), aclSubject_, aclObject);
             } else if (*object->value == "RemoveQuota") {
               if (object->quota_info->has_principal()) {
                 aclObject.add_values(object->quota_info->principal());
@@ -400,7 +427,8 @@ public:
               }
 
               CHECK_SOME(acls_.remove_quotas);
-              return approved(acls_.remove_quotas.get(), aclSubject, aclObject);
+              return approved(
+                  acls_.remove_quotas.get(), aclSubject_, aclObject);
             }
           }
 
@@ -515,10 +543,44 @@ public:
       }
     }
 
-    return approved(acls_.acls, aclSubject, aclObject);
+    return approved(aclObject);
   }
 
 private:
+  // Authorizes the object based on the ACLs that match the subject,
+  // see the constructor. This is equivalent to
+  // `approved(acls_.acls, aclSubject_, object)`.
+  bool approved(const ACL::Entity& object) const
+  {
+    // The objects of most of the actions have a single value, for
+    // which the first matching ACL is either the first one listing
+    // the value or the first one matching any value, whichever comes
+    // first.
+    if (object.type() == ACL::Entity::SOME && object.values_size() == 1) {
+      Option<size_t> index = wildcard_;
+
+      Option<size_t> listed = first_.get(object.values(0));
+      if (listed.isSome() && (index.isNone() || listed.get() < index.get())) {
+        index = listed;
+      }
+
+      if (index.isNone()) {
+        return permissive_; // None of the ACLs match.
+      }
+
+      const std::pair<ACL::Entity, bool>& candidate = candidates_[index.get()];
+      return candidate.second && allows(object, candidate.first);
+    }
+
+    foreach (const auto& candidate, candidates_) {
+      if (matches(object, candidate.first)) {
+        return candidate.second && allows(object, candidate.first);
+      }
+    }
+
+    return permissive_; // None of the ACLs match.
+  }
+
   bool approved(
       const vector<GenericACL>& acls,
       const ACL::Entity& subject,
@@ -538,6 +600,19 @@ private:
   const Option<authorization::Subject> subject_;
   const authorization::Action action_;
   const bool permissive_;
+
+  ACL::Entity aclSubject_;
+
+  // The objects of the ACLs that match the subject, in the order of
+  // the ACLs, along with whether the ACL allows the subject.
+  vector<std::pair<ACL::Entity, bool>> candidates_;
+
+  // The index of the first candidate listing each object value.
+  hashmap<string, size_t> first_;
+
+  // The index of the first candidate matching any object value, i.e.,
+  // whose objects are of type ANY or NONE.
+  Option<size_t> wildcard_;
 };
 
 
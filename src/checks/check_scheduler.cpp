@@ -0,0 +1,195 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "checks/check_scheduler.hpp"
+
+#include <stdlib.h>
+
+#include <deque>
+#include <utility>
+
+#include <process/dispatch.hpp>
+#include <process/id.hpp>
+#include <process/owned.hpp>
+#include <process/process.hpp>
+
+#include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/hashset.hpp>
+#include <stout/os.hpp>
+
+using process::Future;
+using process::Owned;
+using process::Process;
+using process::Promise;
+using process::UPID;
+
+using std::deque;
+using std::pair;
+
+namespace mesos {
+namespace internal {
+namespace checks {
+
+class CheckSchedulerProcess : public Process<CheckSchedulerProcess>
+{
+public:
+  explicit CheckSchedulerProcess(size_t _maxConcurrentChecks)
+    : ProcessBase(process::ID::generate("check-scheduler")),
+      maxConcurrentChecks(_maxConcurrentChecks),
+      running(0)
+  {
+    CHECK_GT(maxConcurrentChecks, 0u);
+  }
+
+  virtual ~CheckSchedulerProcess() {}
+
+  Future<Nothing> acquire(const UPID& checker)
+  {
+    if (!linked.contains(checker)) {
+      link(checker);
+      linked.insert(checker);
+    }
+
+    if (running < maxConcurrentChecks && pending.empty()) {
+      permits[checker]++;
+      running++;
+      return Nothing();
+    }
+
+    Owned<Promise<Nothing>> promise(new Promise<Nothing>());
+    pending.push_back(std::make_pair(checker, promise));
+    return promise->future();
+  }
+
+  void release(const UPID& checker)
+  {
+    if (permits.get(checker).getOrElse(0) == 0) {
+      return;
+    }
+
+    if (--permits[checker] == 0) {
+      permits.erase(checker);
+    }
+
+    running--;
+    grant();
+  }
+
+protected:
+  virtual void finalize()
+  {
+    foreach (auto& acquisition, pending) {
+      acquisition.second->discard();
+    }
+    pending.clear();
+  }
+
+  virtual void exited(const UPID& pid)
+  {
+    linked.erase(pid);
+
+    // Drop the pending acquisitions of the terminated checker.
+    deque<pair<UPID, Owned<Promise<Nothing>>>> remaining;
+    foreach (auto& acquisition, pending) {
+      if (acquisition.first == pid) {
+        acquisition.second->discard();
+      } else {
+        remaining.push_back(acquisition);
+      }
+    }
+    pending.swap(remaining);
+
+    // Release the permits the terminated checker still held, e.g.,
+    // because it got terminated while performing a check.
+    if (permits.contains(pid)) {
+      running -= permits[pid];
+      permits.erase(pid);
+    }
+
+    grant();
+  }
+
+private:
+  // Grants permits to the pending acquisitions, in the order they
+  // have been made, as long as fewer checks than allowed are running.
+  void grant()
+  {
+    while (running < maxConcurrentChecks && !pending.empty()) {
+      pair<UPID, Owned<Promise<Nothing>>> acquisition = pending.front();
+      pending.pop_front();
+
+      permits[acquisition.first]++;
+      running++;
+      acquisition.second->set(Nothing());
+    }
+  }
+
+  const size_t maxConcurrentChecks;
+
+  // The number of checks that are running, i.e., the number of
+  // permits that have been granted but not yet released.
+  size_t running;
+
+  hashmap<UPID, size_t> permits;
+  hashset<UPID> linked;
+  deque<pair<UPID, Owned<Promise<Nothing>>>> pending;
+};
+
+
+CheckScheduler::CheckScheduler(size_t maxConcurrentChecks, double jitter)
+  : jitter_(jitter)
+{
+  CHECK_GE(jitter_, 0.0);
+  CHECK_LE(jitter_, 1.0);
+
+  process = new CheckSchedulerProcess(maxConcurrentChecks);
+  spawn(process);
+}
+
+
+CheckScheduler::~CheckScheduler()
+{
+  terminate(process);
+  wait(process);
+  delete process;
+}
+
+
+Duration CheckScheduler::jitter(const Duration& duration) const
+{
+  // A random factor in [-1, 1].
+  const double random = 2.0 * os::random() / RAND_MAX - 1.0;
+
+  return duration * (1.0 + jitter_ * random);
+}
+
+
+Future<Nothing> CheckScheduler::acquire(const UPID& checker) const
+{
+  return dispatch(process, &CheckSchedulerProcess::acquire, checker);
+}
+
+
+void CheckScheduler::release(const UPID& checker) const
+{
+  dispatch(process, &CheckSchedulerProcess::release, checker);
+}
+
+} // namespace checks {
+} // namespace internal {
+} // namespace mesos {
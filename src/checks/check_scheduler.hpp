@@ -0,0 +1,86 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef __CHECK_SCHEDULER_HPP__
+#define __CHECK_SCHEDULER_HPP__
+
+#include <stddef.h>
+
+#include <process/future.hpp>
+#include <process/pid.hpp>
+
+#include <stout/duration.hpp>
+#include <stout/nothing.hpp>
+
+namespace mesos {
+namespace internal {
+namespace checks {
+
+// The maximum number of checks performed at a time by the checkers
+// that share a `CheckScheduler`.
+constexpr size_t DEFAULT_MAX_CONCURRENT_CHECKS = 8;
+
+// The fraction by which the interval between two consecutive checks
+// of a task is randomly jittered.
+constexpr double DEFAULT_CHECK_JITTER = 0.1;
+
+
+// Forward declaration.
+class CheckSchedulerProcess;
+
+
+// Schedules the checks of all the checkers of an executor (i.e., one
+// checker per task), so that the checks of different tasks do not
+// line up and cause periodic spikes: the intervals between checks
+// are randomly jittered, and at most `maxConcurrentChecks` checks are
+// performed at a time, with the others waiting for their turn.
+class CheckScheduler
+{
+public:
+  CheckScheduler(
+      size_t maxConcurrentChecks = DEFAULT_MAX_CONCURRENT_CHECKS,
+      double jitter = DEFAULT_CHECK_JITTER);
+
+  ~CheckScheduler();
+
+  // Returns the duration randomly jittered by up to the jitter
+  // fraction of it in either direction.
+  Duration jitter(const Duration& duration) const;
+
+  // Returns a future that becomes ready once the checker with the
+  // given pid may perform a check. The checker must `release()` the
+  // permit once the check has completed; permits (and pending
+  // acquisitions) of checkers that terminate are released
+  // automatically.
+  process::Future<Nothing> acquire(const process::UPID& checker) const;
+
+  void release(const process::UPID& checker) const;
+
+private:
+  CheckScheduler(const CheckScheduler&) = delete;
+  CheckScheduler& operator=(const CheckScheduler&) = delete;
+
+  const double jitter_;
+
+  CheckSchedulerProcess* process;
+};
+
+} // namespace checks {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __CHECK_SCHEDULER_HPP__
@@ -23,8 +23,10 @@
 #include <unistd.h>
 #endif // __WINDOWS__
 
+#include <algorithm>
 #include <iostream>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include <mesos/mesos.hpp>
@@ -34,9 +36,11 @@
 #include <process/dispatch.hpp>
 #include <process/http.hpp>
 #include <process/io.hpp>
+#include <process/socket.hpp>
 #include <process/subprocess.hpp>
 
 #include <stout/duration.hpp>
+#include <stout/ip.hpp>
 #include <stout/json.hpp>
 #include <stout/jsonify.hpp>
 #include <stout/option.hpp>
@@ -62,9 +66,18 @@ using process::Clock;
 using process::Failure;
 using process::Future;
 using process::Owned;
+using process::Shared;
 using process::Subprocess;
 using process::Time;
 
+using process::http::Connection;
+using process::http::Response;
+
+using process::network::Socket;
+using process::network::internal::SocketImpl;
+
+namespace inet = process::network::inet;
+
 using std::map;
 using std::string;
 using std::tuple;
@@ -75,10 +88,8 @@ namespace internal {
 namespace checks {
 
 #ifndef __WINDOWS__
-constexpr char TCP_CHECK_COMMAND[] = "mesos-tcp-connect";
 constexpr char HTTP_CHECK_COMMAND[] = "curl";
 #else
-constexpr char TCP_CHECK_COMMAND[] = "mesos-tcp-connect.exe";
 constexpr char HTTP_CHECK_COMMAND[] = "curl.exe";
 #endif // __WINDOWS__
 
@@ -125,7 +136,8 @@ Try<Owned<HealthChecker>> HealthChecker::create(
     const lambda::function<void(const TaskHealthStatus&)>& callback,
     const TaskID& taskId,
     Option<pid_t> taskPid,
-    const vector<string>& namespaces)
+    const vector<string>& namespaces,
+    const Option<Shared<CheckScheduler>>& scheduler)
 {
   // Validate the 'HealthCheck' protobuf.
   Option<Error> error = validation::healthCheck(check);
@@ -139,7 +151,8 @@ Try<Owned<HealthChecker>> HealthChecker::create(
       callback,
       taskId,
       taskPid,
-      namespaces));
+      namespaces,
+      scheduler));
 
   return Owned<HealthChecker>(new HealthChecker(process));
 }
@@ -174,7 +187,8 @@ HealthCheckerProcess::HealthCheckerProcess(
     const lambda::function<void(const TaskHealthStatus&)>& _callback,
     const TaskID& _taskId,
     Option<pid_t> _taskPid,
-    const vector<string>& _namespaces)
+    const vector<string>& _namespaces,
+    const Option<Shared<CheckScheduler>>& _scheduler)
   : ProcessBase(process::ID::generate("health-checker")),
     check(_check),
     launcherDir(_launcherDir),
@@ -182,6 +196,7 @@ HealthCheckerProcess::HealthCheckerProcess(
     taskId(_taskId),
     taskPid(_taskPid),
     namespaces(_namespaces),
+    scheduler(_scheduler),
     consecutiveFailures(0),
     initializing(true)
 {
@@ -211,6 +226,14 @@ HealthCheckerProcess::HealthCheckerProcess(
 }
 
 
+HealthCheckerProcess::~HealthCheckerProcess()
+{
+  if (netns.isSome()) {
+    os::close(netns.get());
+  }
+}
+
+
 void HealthCheckerProcess::initialize()
 {
   VLOG(1) << "Health check configuration:"
@@ -276,6 +299,20 @@ void HealthCheckerProcess::success()
 
 
 void HealthCheckerProcess::performSingleCheck()
+{
+  // Wait for our turn if the number of health checks performed at a
+  // time is limited.
+  if (scheduler.isSome()) {
+    scheduler.get()->acquire(self())
+      .onReady(defer(self(), &Self::_performSingleCheck));
+    return;
+  }
+
+  _performSingleCheck();
+}
+
+
+void HealthCheckerProcess::_performSingleCheck()
 {
   Future<Nothing> checkResult;
 
@@ -316,6 +353,10 @@ void HealthCheckerProcess::processCheckResult(
   VLOG(1) << "Performed " << HealthCheck::Type_Name(check.type())
           << " health check in " << stopwatch.elapsed();
 
+  if (scheduler.isSome()) {
+    scheduler.get()->release(self());
+  }
+
   if (future.isReady()) {
     success();
     return;
@@ -429,6 +470,73 @@ Future<Nothing> HealthCheckerProcess::httpHealthCheck()
   const string url = scheme + "://" + DEFAULT_DOMAIN + ":" +
                      stringify(http.port()) + path;
 
+  // We speak plain HTTP ourselves, but rely on curl for everything
+  // else (i.e., https), so that certificates are not validated.
+  if (scheme != DEFAULT_HTTP_SCHEME) {
+    return curlHealthCheck(url);
+  }
+
+  VLOG(1) << "Performing HTTP health check '" << url << "'";
+
+  Try<Socket> socket = createSocket();
+  if (socket.isError()) {
+    return Failure("Failed to create socket: " + socket.error());
+  }
+
+  Try<net::IP> ip = net::IP::parse(DEFAULT_DOMAIN, AF_INET);
+  CHECK_SOME(ip);
+
+  const inet::Address address(ip.get(), static_cast<uint16_t>(http.port()));
+
+  process::http::Request request;
+  request.method = "GET";
+  request.url = process::http::URL(scheme, DEFAULT_DOMAIN, address.port, path);
+  request.keepAlive = false;
+
+  const Duration timeout = checkTimeout;
+
+  return process::http::connect(socket.get(), address)
+    .then([request](Connection connection) {
+      Future<Response> response = connection.send(request);
+
+      // This is a non Keep-Alive request which means the connection
+      // will be closed when the response is received. Since the
+      // 'Connection' is reference-counted, we must maintain a copy
+      // until the disconnection occurs.
+      connection.disconnected()
+        .onAny([connection]() {});
+
+      return response;
+    })
+    .after(
+        timeout,
+        [timeout, socket](Future<Response> future) mutable {
+      future.discard();
+
+      // Shutting down the socket closes the connection (if any).
+      socket->shutdown(Socket::Shutdown::READ_WRITE);
+
+      return Failure(
+          "HTTP request has not returned after " + stringify(timeout) +
+          "; aborting");
+    })
+    .then([](const Response& response) -> Future<Nothing> {
+      // NOTE: Redirects are not followed, i.e., a 3xx response
+      // code is considered healthy.
+      if (response.code < process::http::Status::OK ||
+          response.code >= process::http::Status::BAD_REQUEST) {
+        return Failure(
+            "Unexpected HTTP response code: " +
+            process::http::Status::string(response.code));
+      }
+
+      return Nothing();
+    });
+}
+
+
+Future<Nothing> HealthCheckerProcess::curlHealthCheck(const string& url)
+{
   VLOG(1) << "Launching HTTP health check '" << url << "'";
 
   const vector<string> argv = {
@@ -485,11 +593,11 @@ Future<Nothing> HealthCheckerProcess::httpHealthCheck()
           string(HTTP_CHECK_COMMAND) + " has not returned after " +
           stringify(timeout) + "; aborting");
     })
-    .then(defer(self(), &Self::_httpHealthCheck, lambda::_1));
+    .then(defer(self(), &Self::_curlHealthCheck, lambda::_1));
 }
 
 
-Future<Nothing> HealthCheckerProcess::_httpHealthCheck(
+Future<Nothing> HealthCheckerProcess::_curlHealthCheck(
     const tuple<
         Future<Option<int>>,
         Future<string>,
@@ -553,110 +661,113 @@ Future<Nothing> HealthCheckerProcess::tcpHealthCheck()
   CHECK_EQ(HealthCheck::TCP, check.type());
   CHECK(check.has_tcp());
 
-  // TCP_CHECK_COMMAND should be reachable.
-  CHECK(os::exists(launcherDir));
-
   const HealthCheck::TCPCheckInfo& tcp = check.tcp();
 
-  VLOG(1) << "Launching TCP health check at port '" << tcp.port() << "'";
-
-  const string tcpConnectPath = path::join(launcherDir, TCP_CHECK_COMMAND);
-
-  const vector<string> tcpConnectArguments = {
-    tcpConnectPath,
-    "--ip=" + DEFAULT_DOMAIN,
-    "--port=" + stringify(tcp.port())
-  };
-
-  // TODO(alexr): Consider launching the helper binary once per task lifetime,
-  // see MESOS-6766.
-  Try<Subprocess> s = subprocess(
-      tcpConnectPath,
-      tcpConnectArguments,
-      Subprocess::PATH("/dev/null"),
-      Subprocess::PIPE(),
-      Subprocess::PIPE(),
-      nullptr,
-      None(),
-      clone);
+  VLOG(1) << "Performing TCP health check at port '" << tcp.port() << "'";
 
-  if (s.isError()) {
-    return Failure(
-        "Failed to create the " + string(TCP_CHECK_COMMAND) +
-        " subprocess: " + s.error());
+  Try<Socket> socket = createSocket();
+  if (socket.isError()) {
+    return Failure("Failed to create socket: " + socket.error());
   }
 
-  pid_t tcpConnectPid = s->pid();
+  Try<net::IP> ip = net::IP::parse(DEFAULT_DOMAIN, AF_INET);
+  CHECK_SOME(ip);
+
+  const inet::Address address(ip.get(), static_cast<uint16_t>(tcp.port()));
   const Duration timeout = checkTimeout;
 
-  return await(
-      s->status(),
-      process::io::read(s->out().get()),
-      process::io::read(s->err().get()))
+  // NOTE: The socket is closed once the last copy of it (i.e., the
+  // ones captured below) goes away.
+  return socket->connect(address)
     .after(
         timeout,
-        [timeout, tcpConnectPid](Future<tuple<Future<Option<int>>,
-                                              Future<string>,
-                                              Future<string>>> future) {
+        [timeout, socket, address](Future<Nothing> future) {
       future.discard();
 
-      if (tcpConnectPid != -1) {
-        // Cleanup the TCP_CHECK_COMMAND process.
-        VLOG(1) << "Killing the TCP health check process " << tcpConnectPid;
-
-        os::killtree(tcpConnectPid, SIGKILL);
-      }
-
       return Failure(
-          string(TCP_CHECK_COMMAND) + " has not returned after " +
-          stringify(timeout) + "; aborting");
+          "Connection to " + stringify(address) + " has not been"
+          " established after " + stringify(timeout) + "; aborting");
     })
-    .then(defer(self(), &Self::_tcpHealthCheck, lambda::_1));
+    .then([socket]() {
+      return Nothing();
+    });
 }
 
 
-Future<Nothing> HealthCheckerProcess::_tcpHealthCheck(
-    const tuple<
-        Future<Option<int>>,
-        Future<string>,
-        Future<string>>& t)
+Try<Socket> HealthCheckerProcess::createSocket()
 {
-  Future<Option<int>> status = std::get<0>(t);
-  if (!status.isReady()) {
-    return Failure(
-        "Failed to get the exit status of the " + string(TCP_CHECK_COMMAND) +
-        " process: " + (status.isFailed() ? status.failure() : "discarded"));
-  }
+#ifdef __linux__
+  if (taskPid.isSome() &&
+      std::find(namespaces.begin(), namespaces.end(), "net") !=
+        namespaces.end()) {
+    if (netns.isNone()) {
+      const string path =
+        path::join("/proc", stringify(taskPid.get()), "ns", "net");
+
+      Try<int> fd = os::open(path, O_RDONLY | O_CLOEXEC);
+      if (fd.isError()) {
+        return Error("Failed to open '" + path + "': " + fd.error());
+      }
 
-  if (status->isNone()) {
-    return Failure(
-        "Failed to reap the " + string(TCP_CHECK_COMMAND) + " process");
-  }
+      netns = fd.get();
+    }
 
-  int statusCode = status->get();
-  if (statusCode != 0) {
-    Future<string> error = std::get<2>(t);
-    if (!error.isReady()) {
-      return Failure(
-          string(TCP_CHECK_COMMAND) + " returned " +
-          WSTRINGIFY(statusCode) + "; reading stderr failed: " +
-          (error.isFailed() ? error.failure() : "discarded"));
+    // A socket stays in the network namespace it has been created in,
+    // hence only the creation of the socket needs to happen in the
+    // network namespace of the task, while connecting and all of the
+    // I/O happen on the libprocess event loop as usual. Since `setns`
+    // only affects the calling thread, we use a short-lived thread
+    // rather than entering the namespace from a libprocess worker
+    // thread (or forking a helper process).
+    Try<int> s = Error("Not created");
+
+    std::thread thread([&s, this]() {
+      if (::setns(netns.get(), CLONE_NEWNET) == -1) {
+        s = ErrnoError("Failed to enter the network namespace");
+        return;
+      }
+
+      int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+      if (fd == -1) {
+        s = ErrnoError("Failed to create socket");
+        return;
+      }
+
+      s = fd;
+    });
+
+    thread.join();
+
+    if (s.isError()) {
+      return Error(s.error());
     }
 
-    return Failure(
-        string(TCP_CHECK_COMMAND) + " returned " +
-        WSTRINGIFY(statusCode) + ": " + error.get());
+    Try<Socket> socket = Socket::create(s.get(), SocketImpl::Kind::POLL);
+    if (socket.isError()) {
+      os::close(s.get());
+      return Error(socket.error());
+    }
+
+    return socket.get();
   }
+#endif // __linux__
 
-  return Nothing();
+  return Socket::create(
+      process::network::Address::Family::INET,
+      SocketImpl::Kind::POLL);
 }
 
 
 void HealthCheckerProcess::scheduleNext(const Duration& duration)
 {
-  VLOG(1) << "Scheduling health check in " << duration;
+  // Jitter the delay, so that the health checks of different tasks
+  // do not line up.
+  const Duration jittered =
+    scheduler.isSome() ? scheduler.get()->jitter(duration) : duration;
+
+  VLOG(1) << "Scheduling health check in " << jittered;
 
-  delay(duration, self(), &Self::performSingleCheck);
+  delay(jittered, self(), &Self::performSingleCheck);
 }
 
 
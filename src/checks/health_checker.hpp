@@ -28,6 +28,8 @@
 #include <process/pid.hpp>
 #include <process/process.hpp>
 #include <process/protobuf.hpp>
+#include <process/shared.hpp>
+#include <process/socket.hpp>
 #include <process/time.hpp>
 
 #include <stout/duration.hpp>
@@ -35,6 +37,8 @@
 #include <stout/nothing.hpp>
 #include <stout/stopwatch.hpp>
 
+#include "checks/check_scheduler.hpp"
+
 #include "messages/messages.hpp"
 
 namespace mesos {
@@ -60,6 +64,9 @@ public:
    *     namespaces.
    * @param namespaces The namespaces to enter prior performing a single health
    *     check.
+   * @param scheduler The scheduler shared by the health checkers of all of the
+   *     executor's tasks, which jitters the health checks and limits the number
+   *     of health checks performed at a time.
    * @return A `HealthChecker` object or an error if `create` fails.
    *
    * @todo A better approach would be to return a stream of updates, e.g.,
@@ -71,7 +78,8 @@ public:
       const lambda::function<void(const TaskHealthStatus&)>& callback,
       const TaskID& taskId,
       Option<pid_t> taskPid,
-      const std::vector<std::string>& namespaces);
+      const std::vector<std::string>& namespaces,
+      const Option<process::Shared<CheckScheduler>>& scheduler = None());
 
   ~HealthChecker();
 
@@ -96,9 +104,10 @@ public:
       const lambda::function<void(const TaskHealthStatus&)>& _callback,
       const TaskID& _taskId,
       Option<pid_t> _taskPid,
-      const std::vector<std::string>& _namespaces);
+      const std::vector<std::string>& _namespaces,
+      const Option<process::Shared<CheckScheduler>>& _scheduler);
 
-  virtual ~HealthCheckerProcess() {}
+  virtual ~HealthCheckerProcess();
 
 protected:
   virtual void initialize() override;
@@ -108,6 +117,7 @@ private:
   void success();
 
   void performSingleCheck();
+  void _performSingleCheck();
   void processCheckResult(
       const Stopwatch& stopwatch,
       const process::Future<Nothing>& future);
@@ -116,7 +126,9 @@ private:
 
   process::Future<Nothing> httpHealthCheck();
 
-  process::Future<Nothing> _httpHealthCheck(
+  process::Future<Nothing> curlHealthCheck(const std::string& url);
+
+  process::Future<Nothing> _curlHealthCheck(
       const std::tuple<
           process::Future<Option<int>>,
           process::Future<std::string>,
@@ -124,11 +136,10 @@ private:
 
   process::Future<Nothing> tcpHealthCheck();
 
-  process::Future<Nothing> _tcpHealthCheck(
-      const std::tuple<
-          process::Future<Option<int>>,
-          process::Future<std::string>,
-          process::Future<std::string>>& t);
+  // Creates a TCP socket in the network namespace of the task, or in
+  // the network namespace of the health checker if the network
+  // namespace is not supposed to be entered.
+  Try<process::network::Socket> createSocket();
 
   void scheduleNext(const Duration& duration);
 
@@ -138,15 +149,19 @@ private:
   Duration checkGracePeriod;
   Duration checkTimeout;
 
-  // Contains a binary for TCP health checks.
   const std::string launcherDir;
 
   const lambda::function<void(const TaskHealthStatus&)> healthUpdateCallback;
   const TaskID taskId;
   const Option<pid_t> taskPid;
   const std::vector<std::string> namespaces;
+  const Option<process::Shared<CheckScheduler>> scheduler;
   Option<lambda::function<pid_t(const lambda::function<int()>&)>> clone;
 
+  // The file descriptor of the network namespace of the task, opened
+  // on the first HTTP or TCP health check that needs to enter it.
+  Option<int> netns;
+
   uint32_t consecutiveFailures;
   process::Time startTime;
   bool initializing;
@@ -646,6 +646,7 @@ protected:
 
         case Event::HEARTBEAT:
         case Event::INVERSE_OFFERS:
+        case Event::UPDATES:
         case Event::FAILURE:
         case Event::RESCIND:
         case Event::RESCIND_INVERSE_OFFER:
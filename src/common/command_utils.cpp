@@ -41,12 +41,13 @@ namespace command {
 
 static Future<string> launch(
     const string& path,
-    const vector<string>& argv)
+    const vector<string>& argv,
+    const Subprocess::IO& in = Subprocess::PATH("/dev/null"))
 {
   Try<Subprocess> s = subprocess(
       path,
       argv,
-      Subprocess::PATH("/dev/null"),
+      in,
       Subprocess::PIPE(),
       Subprocess::PIPE());
 
@@ -103,6 +104,22 @@ static Future<string> launch(
 }
 
 
+// Returns the `tar` flag for the given compression type.
+static string compressionFlag(Compression compression)
+{
+  switch (compression) {
+    case Compression::GZIP:
+      return "-z";
+    case Compression::BZIP2:
+      return "-j";
+    case Compression::XZ:
+      return "-J";
+  }
+
+  UNREACHABLE();
+}
+
+
 Future<Nothing> tar(
     const Path& input,
     const Path& output,
@@ -123,19 +140,7 @@ Future<Nothing> tar(
   }
 
   if (compression.isSome()) {
-    switch (compression.get()) {
-      case Compression::GZIP:
-        argv.emplace_back("-z");
-        break;
-      case Compression::BZIP2:
-        argv.emplace_back("-j");
-        break;
-      case Compression::XZ:
-        argv.emplace_back("-J");
-        break;
-      default:
-        UNREACHABLE();
-    }
+    argv.emplace_back(compressionFlag(compression.get()));
   }
 
   argv.emplace_back(input);
@@ -167,6 +172,35 @@ Future<Nothing> untar(
 }
 
 
+Future<Nothing> untar(
+    int input,
+    const Option<Path>& directory,
+    const Option<Compression>& compression)
+{
+  vector<string> argv = {
+    "tar",
+    "-x",  // Extract/unarchive.
+    "-f",  // Read the archive from stdin.
+    "-"
+  };
+
+  // Add additional flags.
+  if (directory.isSome()) {
+    argv.emplace_back("-C");
+    argv.emplace_back(directory.get());
+  }
+
+  // NOTE: Unlike for a file, `tar` can not detect the compression of
+  // an archive read from a pipe, so it has to be given explicitly.
+  if (compression.isSome()) {
+    argv.emplace_back(compressionFlag(compression.get()));
+  }
+
+  return launch("tar", argv, Subprocess::FD(input, Subprocess::IO::OWNED))
+    .then([]() { return Nothing(); });
+}
+
+
 Future<string> sha512(const Path& input)
 {
 #ifdef __linux__
@@ -59,6 +59,20 @@ process::Future<Nothing> untar(
     const Path& input,
     const Option<Path>& directory = None());
 
+
+/**
+ * Untar(unarchive) the archive read from the given file descriptor
+ * (e.g., the read end of a pipe), which is closed by this call.
+ *
+ * @param input file descriptor the archive will be read from.
+ * @param directory change to this directory before unarchiving.
+ * @param compression compression type if the archive is compressed.
+ */
+process::Future<Nothing> untar(
+    int input,
+    const Option<Path>& directory = None(),
+    const Option<Compression>& compression = None());
+
 // TODO(Jojy): Add more overloads/options for untar (eg., keep existing files)
 
 
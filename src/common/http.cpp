@@ -17,6 +17,7 @@
 #include <map>
 #include <ostream>
 #include <set>
+#include <streambuf>
 #include <string>
 #include <utility>
 #include <vector>
@@ -39,6 +40,7 @@
 #include <stout/protobuf.hpp>
 #include <stout/recordio.hpp>
 #include <stout/stringify.hpp>
+#include <stout/strings.hpp>
 #include <stout/unreachable.hpp>
 
 #include <stout/os/permissions.hpp>
@@ -57,6 +59,9 @@ using std::vector;
 using process::Failure;
 using process::Owned;
 
+using process::http::OK;
+using process::http::Pipe;
+
 using process::http::authentication::Authenticator;
 using process::http::authorization::AuthorizationCallbacks;
 
@@ -133,6 +138,104 @@ bool streamingMediaType(ContentType contentType)
 }
 
 
+// Size of the chunks written to the pipe of a streamed JSON response.
+constexpr size_t JSON_CHUNK_SIZE = 64 * 1024;
+
+
+// A stream buffer which writes its contents to a pipe in chunks of
+// `JSON_CHUNK_SIZE` bytes, so that at most one chunk is buffered by the
+// stream itself.
+class PipeStreamBuffer : public std::streambuf
+{
+public:
+  explicit PipeStreamBuffer(const Pipe::Writer& _writer)
+    : writer(_writer), buffer(JSON_CHUNK_SIZE)
+  {
+    setp(buffer.data(), buffer.data() + buffer.size());
+  }
+
+protected:
+  virtual int_type overflow(int_type c) override
+  {
+    if (!flush()) {
+      return traits_type::eof();
+    }
+
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+      *pptr() = traits_type::to_char_type(c);
+      pbump(1);
+    }
+
+    return traits_type::not_eof(c);
+  }
+
+  virtual int sync() override
+  {
+    return flush() ? 0 : -1;
+  }
+
+private:
+  // Returns false once the reader closed the pipe, which puts the
+  // stream into a failed state so that the rest of the JSON is not
+  // written.
+  bool flush()
+  {
+    const size_t size = pptr() - pbase();
+
+    setp(buffer.data(), buffer.data() + buffer.size());
+
+    return size == 0 || writer.write(string(buffer.data(), size));
+  }
+
+  Pipe::Writer writer;
+  vector<char> buffer;
+};
+
+
+process::http::Response jsonResponse(
+    const process::http::Request& request,
+    JSON::Proxy&& value)
+{
+  const Option<string> jsonp = request.url.query.get("jsonp");
+
+  if (request.acceptsEncoding("gzip")) {
+    return OK(std::move(value), jsonp);
+  }
+
+  Pipe pipe;
+  OK ok;
+
+  ok.type = process::http::Response::PIPE;
+  ok.reader = pipe.reader();
+
+  Pipe::Writer writer = pipe.writer();
+
+  {
+    PipeStreamBuffer buffer(writer);
+    std::ostream stream(&buffer);
+
+    if (jsonp.isSome()) {
+      stream << jsonp.get() << "(";
+    }
+
+    stream << std::move(value);
+
+    if (jsonp.isSome()) {
+      stream << ");";
+      ok.headers["Content-Type"] = "text/javascript";
+    } else {
+      ok.headers["Content-Type"] = "application/json";
+    }
+
+    stream.flush();
+  }
+
+  writer.close();
+
+  return ok;
+}
+
+
 // TODO(bmahler): Kill these in favor of automatic Proto->JSON
 // Conversion (when it becomes available).
 
@@ -483,6 +586,48 @@ JSON::Object model(const FileInfo& fileInfo)
   return file;
 }
 
+
+const FieldProjection& FieldProjection::all()
+{
+  static FieldProjection* projection = new FieldProjection();
+  return *projection;
+}
+
+
+FieldProjection FieldProjection::parse(const string& fields)
+{
+  FieldProjection projection;
+
+  foreach (const string& path, strings::tokenize(fields, ",")) {
+    FieldProjection* current = &projection;
+
+    foreach (const string& field, strings::tokenize(path, ".")) {
+      if (!current->children.contains(field)) {
+        current->children[field] =
+          Owned<FieldProjection>(new FieldProjection());
+      }
+
+      current = current->children.at(field).get();
+    }
+
+    if (current != &projection) {
+      current->everything = true;
+    }
+  }
+
+  return projection;
+}
+
+
+const FieldProjection& FieldProjection::at(const string& field) const
+{
+  if (selectsAll() || !children.contains(field)) {
+    return all();
+  }
+
+  return *children.at(field);
+}
+
 }  // namespace internal {
 
 void json(JSON::ObjectWriter* writer, const Attributes& attributes)
@@ -634,30 +779,7 @@ void json(JSON::ObjectWriter* writer, const Resources& resources)
 
 void json(JSON::ObjectWriter* writer, const Task& task)
 {
-  writer->field("id", task.task_id().value());
-  writer->field("name", task.name());
-  writer->field("framework_id", task.framework_id().value());
-  writer->field("executor_id", task.executor_id().value());
-  writer->field("slave_id", task.slave_id().value());
-  writer->field("state", TaskState_Name(task.state()));
-  writer->field("resources", Resources(task.resources()));
-  writer->field("statuses", task.statuses());
-
-  if (task.has_user()) {
-    writer->field("user", task.user());
-  }
-
-  if (task.has_labels()) {
-    writer->field("labels", task.labels());
-  }
-
-  if (task.has_discovery()) {
-    writer->field("discovery", JSON::Protobuf(task.discovery()));
-  }
-
-  if (task.has_container()) {
-    writer->field("container", JSON::Protobuf(task.container()));
-  }
+  internal::writeTask(writer, task);
 }
 
 
@@ -21,6 +21,7 @@
 
 #include <mesos/http.hpp>
 #include <mesos/mesos.hpp>
+#include <mesos/resources.hpp>
 
 #include <mesos/authorizer/authorizer.hpp>
 
@@ -107,6 +108,17 @@ Try<Message> deserialize(
 bool streamingMediaType(ContentType contentType);
 
 
+// Returns the JSON as an `OK` response to the request, honoring the
+// `jsonp` query parameter. Unless the client accepts a gzip compressed
+// body, which has to be buffered in order to be compressed, the JSON is
+// written to a chunked `PIPE` response while it is serialized, so that
+// the full document never needs to be held in a single string. The
+// serialization stops early if the client closes the connection.
+process::http::Response jsonResponse(
+    const process::http::Request& request,
+    JSON::Proxy&& value);
+
+
 JSON::Object model(const Resources& resources);
 JSON::Object model(const hashmap<std::string, Resources>& roleResources);
 JSON::Object model(const Attributes& attributes);
@@ -118,6 +130,98 @@ JSON::Object model(const FileInfo& fileInfo);
 
 void json(JSON::ObjectWriter* writer, const Task& task);
 
+
+// The fields of a JSON document selected by the `fields` query
+// parameter of an endpoint, e.g., `fields=slaves.hostname,tasks.id`.
+// Selecting a field selects everything below it, and the empty
+// projection selects all fields.
+class FieldProjection
+{
+public:
+  FieldProjection() : everything(false) {}
+
+  // Returns the projection which selects all fields.
+  static const FieldProjection& all();
+
+  // Parses a comma separated list of dot separated field paths.
+  static FieldProjection parse(const std::string& fields);
+
+  bool selectsAll() const { return everything || children.empty(); }
+
+  bool selects(const std::string& field) const
+  {
+    return selectsAll() || children.contains(field);
+  }
+
+  // Returns the projection of the fields below `field`, which must be
+  // selected.
+  const FieldProjection& at(const std::string& field) const;
+
+private:
+  bool everything;
+  hashmap<std::string, process::Owned<FieldProjection>> children;
+};
+
+
+// Wraps a `JSON::ObjectWriter` so that only the fields selected by the
+// projection are written. Since the values of the fields which are not
+// selected are never written, subtrees written by a callback are not
+// visited at all.
+class ProjectedObjectWriter
+{
+public:
+  ProjectedObjectWriter(
+      JSON::ObjectWriter* _writer,
+      const FieldProjection& _projection)
+    : writer(_writer), projection_(_projection) {}
+
+  template <typename T>
+  void field(const std::string& key, const T& value)
+  {
+    if (projection_.selects(key)) {
+      writer->field(key, value);
+    }
+  }
+
+  const FieldProjection& projection() const { return projection_; }
+
+private:
+  JSON::ObjectWriter* writer;
+  const FieldProjection& projection_;
+};
+
+
+// Writes the fields of the task, where `Writer` is either a
+// `JSON::ObjectWriter` or a `ProjectedObjectWriter`.
+template <typename Writer>
+void writeTask(Writer* writer, const Task& task)
+{
+  writer->field("id", task.task_id().value());
+  writer->field("name", task.name());
+  writer->field("framework_id", task.framework_id().value());
+  writer->field("executor_id", task.executor_id().value());
+  writer->field("slave_id", task.slave_id().value());
+  writer->field("state", TaskState_Name(task.state()));
+  writer->field("resources", Resources(task.resources()));
+  writer->field("statuses", task.statuses());
+
+  if (task.has_user()) {
+    writer->field("user", task.user());
+  }
+
+  if (task.has_labels()) {
+    writer->field("labels", task.labels());
+  }
+
+  if (task.has_discovery()) {
+    writer->field("discovery", JSON::Protobuf(task.discovery()));
+  }
+
+  if (task.has_container()) {
+    writer->field("container", JSON::Protobuf(task.container()));
+  }
+}
+
 } // namespace internal {
 
 void json(JSON::ObjectWriter* writer, const Attributes& attributes);
@@ -527,6 +527,60 @@ ContainerState createContainerState(
   return state;
 }
 
+
+// Folds the string, followed by a separator, into the 64-bit FNV-1a
+// hash, which (unlike `std::hash`) is the same for all builds.
+static uint64_t fnv1a(uint64_t hash, const string& s)
+{
+  const uint64_t PRIME = 1099511628211ULL;
+
+  foreach (char c, s) {
+    hash = (hash ^ static_cast<unsigned char>(c)) * PRIME;
+  }
+
+  return (hash ^ 0xff) * PRIME;
+}
+
+
+static const uint64_t FNV1A_OFFSET = 14695981039346656037ULL;
+
+
+uint64_t stateDigest(
+    const RepeatedPtrField<ExecutorInfo>& executors,
+    const RepeatedPtrField<Task>& tasks)
+{
+  uint64_t digest = 0;
+
+  foreach (const ExecutorInfo& executor, executors) {
+    digest += stateDigest(executor.framework_id(), executor.executor_id());
+  }
+
+  foreach (const Task& task, tasks) {
+    digest += stateDigest(task);
+  }
+
+  return digest;
+}
+
+
+uint64_t stateDigest(
+    const FrameworkID& frameworkId,
+    const ExecutorID& executorId)
+{
+  uint64_t hash = fnv1a(FNV1A_OFFSET, "executor");
+  hash = fnv1a(hash, frameworkId.value());
+  return fnv1a(hash, executorId.value());
+}
+
+
+uint64_t stateDigest(const Task& task)
+{
+  uint64_t hash = fnv1a(FNV1A_OFFSET, "task");
+  hash = fnv1a(hash, task.framework_id().value());
+  hash = fnv1a(hash, task.task_id().value());
+  return fnv1a(hash, TaskState_Name(task.state()));
+}
+
 } // namespace slave {
 
 namespace maintenance {
@@ -682,6 +736,98 @@ mesos::master::Event createAgentRemoved(const SlaveID& slaveId)
 } // namespace event {
 } // namespace master {
 
+namespace slave {
+namespace event {
+
+mesos::agent::Event createTaskUpdated(
+    const Task& task,
+    const TaskStatus& status)
+{
+  mesos::agent::Event event;
+  event.set_type(mesos::agent::Event::TASK_UPDATED);
+
+  mesos::agent::Event::TaskUpdated* taskUpdated = event.mutable_task_updated();
+
+  taskUpdated->mutable_framework_id()->CopyFrom(task.framework_id());
+  taskUpdated->mutable_status()->CopyFrom(status);
+  taskUpdated->set_state(task.state());
+
+  return event;
+}
+
+
+mesos::agent::Event createTaskAdded(const Task& task)
+{
+  mesos::agent::Event event;
+  event.set_type(mesos::agent::Event::TASK_ADDED);
+
+  event.mutable_task_added()->mutable_task()->CopyFrom(task);
+
+  return event;
+}
+
+
+mesos::agent::Event createContainerAdded(
+    const FrameworkID& frameworkId,
+    const ExecutorID& executorId,
+    const ContainerID& containerId)
+{
+  mesos::agent::Event event;
+  event.set_type(mesos::agent::Event::CONTAINER_ADDED);
+
+  mesos::agent::Event::ContainerAdded* containerAdded =
+    event.mutable_container_added();
+
+  containerAdded->mutable_framework_id()->CopyFrom(frameworkId);
+  containerAdded->mutable_executor_id()->CopyFrom(executorId);
+  containerAdded->mutable_container_id()->CopyFrom(containerId);
+
+  return event;
+}
+
+
+mesos::agent::Event createContainerRemoved(
+    const FrameworkID& frameworkId,
+    const ExecutorID& executorId,
+    const ContainerID& containerId)
+{
+  mesos::agent::Event event;
+  event.set_type(mesos::agent::Event::CONTAINER_REMOVED);
+
+  mesos::agent::Event::ContainerRemoved* containerRemoved =
+    event.mutable_container_removed();
+
+  containerRemoved->mutable_framework_id()->CopyFrom(frameworkId);
+  containerRemoved->mutable_executor_id()->CopyFrom(executorId);
+  containerRemoved->mutable_container_id()->CopyFrom(containerId);
+
+  return event;
+}
+
+
+mesos::agent::Event createContainerUsage(
+    const FrameworkID& frameworkId,
+    const ExecutorID& executorId,
+    const ContainerID& containerId,
+    const ResourceStatistics& statistics)
+{
+  mesos::agent::Event event;
+  event.set_type(mesos::agent::Event::CONTAINER_USAGE);
+
+  mesos::agent::Event::ContainerUsage* containerUsage =
+    event.mutable_container_usage();
+
+  containerUsage->mutable_framework_id()->CopyFrom(frameworkId);
+  containerUsage->mutable_executor_id()->CopyFrom(executorId);
+  containerUsage->mutable_container_id()->CopyFrom(containerId);
+  containerUsage->mutable_statistics()->CopyFrom(statistics);
+
+  return event;
+}
+
+} // namespace event {
+} // namespace slave {
+
 namespace framework {
 
 set<string> getRoles(const FrameworkInfo& frameworkInfo)
@@ -21,10 +21,14 @@
 #include <set>
 #include <string>
 
+#include <stdint.h>
+
 #include <sys/stat.h>
 
 #include <mesos/mesos.hpp>
 
+#include <mesos/agent/agent.hpp>
+
 #include <mesos/maintenance/maintenance.hpp>
 
 #include <mesos/master/master.hpp>
@@ -153,12 +157,16 @@ struct Capabilities
         case SlaveInfo::Capability::MULTI_ROLE:
           multiRole = true;
           break;
+        case SlaveInfo::Capability::STATUS_UPDATE_ACKNOWLEDGEMENTS:
+          statusUpdateAcknowledgements = true;
+          break;
       }
     }
   }
 
   // See mesos.proto for the meaning of agent capabilities.
   bool multiRole = false;
+  bool statusUpdateAcknowledgements = false;
 };
 
 
@@ -174,6 +182,25 @@ mesos::slave::ContainerState createContainerState(
     pid_t pid,
     const std::string& directory);
 
+
+// Returns the digest of the executors and tasks of an agent, which the
+// agent sends instead of them when it re-registers with the master it
+// was registered with (see `ReregisterSlaveMessage.state_digest`).
+//
+// The digest only covers the IDs of the executors and the IDs and the
+// states of the tasks. It is the sum of the digests of each executor
+// and task so that the agent and the master can compute it from their
+// own views, in any order.
+uint64_t stateDigest(
+    const google::protobuf::RepeatedPtrField<ExecutorInfo>& executors,
+    const google::protobuf::RepeatedPtrField<Task>& tasks);
+
+uint64_t stateDigest(
+    const FrameworkID& frameworkId,
+    const ExecutorID& executorId);
+
+uint64_t stateDigest(const Task& task);
+
 } // namespace slave {
 
 namespace maintenance {
@@ -243,6 +270,44 @@ mesos::master::Event createAgentRemoved(const SlaveID& slaveId);
 } // namespace event {
 } // namespace master {
 
+namespace slave {
+namespace event {
+
+// Helper for creating a `TASK_UPDATED` event from a `Task` and its
+// latest status.
+mesos::agent::Event createTaskUpdated(
+    const Task& task,
+    const TaskStatus& status);
+
+
+// Helper for creating a `TASK_ADDED` event from a `Task`.
+mesos::agent::Event createTaskAdded(const Task& task);
+
+
+// Helper for creating a `CONTAINER_ADDED` event.
+mesos::agent::Event createContainerAdded(
+    const FrameworkID& frameworkId,
+    const ExecutorID& executorId,
+    const ContainerID& containerId);
+
+
+// Helper for creating a `CONTAINER_REMOVED` event.
+mesos::agent::Event createContainerRemoved(
+    const FrameworkID& frameworkId,
+    const ExecutorID& executorId,
+    const ContainerID& containerId);
+
+
+// Helper for creating a `CONTAINER_USAGE` event.
+mesos::agent::Event createContainerUsage(
+    const FrameworkID& frameworkId,
+    const ExecutorID& executorId,
+    const ContainerID& containerId,
+    const ResourceStatistics& statistics);
+
+} // namespace event {
+} // namespace slave {
+
 namespace framework {
 
 struct Capabilities
@@ -274,6 +339,12 @@ struct Capabilities
         case FrameworkInfo::Capability::MULTI_ROLE:
           multiRole = true;
           break;
+        case FrameworkInfo::Capability::COALESCED_OFFERS:
+          coalescedOffers = true;
+          break;
+        case FrameworkInfo::Capability::BATCHED_RECONCILIATION:
+          batchedReconciliation = true;
+          break;
       }
     }
   }
@@ -285,6 +356,8 @@ struct Capabilities
   bool sharedResources = false;
   bool partitionAware = false;
   bool multiRole = false;
+  bool coalescedOffers = false;
+  bool batchedReconciliation = false;
 };
 
 
@@ -20,6 +20,7 @@
 #include <queue>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include <mesos/mesos.hpp>
 
@@ -92,6 +93,17 @@ public:
     return process::dispatch(process, &internal::ReaderProcess<T>::read);
   }
 
+  /**
+   * Returns all the pieces of decoded data that are available from
+   * the pipe, or waits for the next one if none are available. This
+   * has the same semantics as `read()` for each piece of data, but
+   * avoids a round trip per piece of data when many are available.
+   */
+  process::Future<std::vector<Result<T>>> readAll()
+  {
+    return process::dispatch(process, &internal::ReaderProcess<T>::readAll);
+  }
+
 private:
   process::PID<internal::ReaderProcess<T>> process;
 };
@@ -180,6 +192,26 @@ public:
     return waiters.back()->future();
   }
 
+  process::Future<std::vector<Result<T>>> readAll()
+  {
+    if (!records.empty()) {
+      std::vector<Result<T>> result;
+      result.reserve(records.size());
+
+      while (!records.empty()) {
+        result.push_back(std::move(records.front()));
+        records.pop();
+      }
+
+      return result;
+    }
+
+    return read()
+      .then([](const Result<T>& record) {
+        return std::vector<Result<T>>({record});
+      });
+  }
+
 protected:
   virtual void initialize() override
   {
@@ -240,7 +272,7 @@ private:
       return;
     }
 
-    foreach (const Try<T>& record, decode.get()) {
+    foreach (Try<T>& record, decode.get()) {
       if (!waiters.empty()) {
         waiters.front()->set(Result<T>(std::move(record)));
         waiters.pop();
@@ -920,6 +920,15 @@ bool Resources::Resource_::isEmpty() const
 
 bool Resources::Resource_::contains(const Resource_& that) const
 {
+  if (scalar.isSome() || that.scalar.isSome()) {
+    return subtractable(that) && that.scalar.get() <= scalar.get();
+  }
+
+  if (ranges.isSome() && that.ranges.isSome()) {
+    return internal::subtractable(resource, that.resource) &&
+           ranges->contains(that.ranges.get());
+  }
+
   // Both Resource_ objects should have the same sharedness.
   if (isShared() != that.isShared()) {
     return false;
@@ -938,11 +947,53 @@ bool Resources::Resource_::contains(const Resource_& that) const
 }
 
 
+bool Resources::Resource_::addable(const Resource_& that) const
+{
+  // A plain scalar resource can only be added to another plain scalar
+  // resource, as the two would otherwise differ in type or in one of
+  // the fields that make a resource not plain.
+  if (scalar.isSome() || that.scalar.isSome()) {
+    return scalar.isSome() &&
+           that.scalar.isSome() &&
+           resource.name() == that.resource.name() &&
+           resource.role() == that.resource.role();
+  }
+
+  return internal::addable(resource, that.resource);
+}
+
+
+bool Resources::Resource_::subtractable(const Resource_& that) const
+{
+  // See comment in `addable` above.
+  if (scalar.isSome() || that.scalar.isSome()) {
+    return scalar.isSome() &&
+           that.scalar.isSome() &&
+           resource.name() == that.resource.name() &&
+           resource.role() == that.resource.role();
+  }
+
+  return internal::subtractable(resource, that.resource);
+}
+
+
 Resources::Resource_& Resources::Resource_::operator+=(const Resource_& that)
 {
   // This function assumes that the 'resource' fields are addable.
 
-  if (!isShared()) {
+  if (scalar.isSome()) {
+    CHECK_SOME(that.scalar);
+
+    scalar = scalar.get() + that.scalar.get();
+    resource.mutable_scalar()->set_value(
+        internal::values::convertToFloating(scalar.get()));
+  } else if (ranges.isSome()) {
+    CHECK_SOME(that.ranges);
+
+    ranges.get() += that.ranges.get();
+    *resource.mutable_ranges() =
+      internal::values::intervalSetToRanges(ranges.get());
+  } else if (!isShared()) {
     resource += that.resource;
   } else {
     // 'addable' makes sure both 'resource' fields are shared and
@@ -961,7 +1012,19 @@ Resources::Resource_& Resources::Resource_::operator-=(const Resource_& that)
 {
   // This function assumes that the 'resource' fields are subtractable.
 
-  if (!isShared()) {
+  if (scalar.isSome()) {
+    CHECK_SOME(that.scalar);
+
+    scalar = scalar.get() - that.scalar.get();
+    resource.mutable_scalar()->set_value(
+        internal::values::convertToFloating(scalar.get()));
+  } else if (ranges.isSome()) {
+    CHECK_SOME(that.ranges);
+
+    ranges.get() -= that.ranges.get();
+    *resource.mutable_ranges() =
+      internal::values::intervalSetToRanges(ranges.get());
+  } else if (!isShared()) {
     resource -= that.resource;
   } else {
     // 'subtractable' makes sure both 'resource' fields are shared and
@@ -978,6 +1041,17 @@ Resources::Resource_& Resources::Resource_::operator-=(const Resource_& that)
 
 bool Resources::Resource_::operator==(const Resource_& that) const
 {
+  if (scalar.isSome() || that.scalar.isSome()) {
+    return addable(that) && scalar.get() == that.scalar.get();
+  }
+
+  // NOTE: For non-shared resources, being subtractable implies that
+  // all the fields other than the value are equal.
+  if (ranges.isSome() && that.ranges.isSome()) {
+    return internal::subtractable(resource, that.resource) &&
+           ranges.get() == that.ranges.get();
+  }
+
   // Both Resource_ objects should have the same sharedness.
   if (isShared() != that.isShared()) {
     return false;
@@ -998,6 +1072,27 @@ bool Resources::Resource_::operator!=(const Resource_& that) const
 }
 
 
+void Resources::Resource_::updateValue()
+{
+  if (resource.type() == Value::SCALAR &&
+      !resource.has_allocation_info() &&
+      !resource.has_reservation() &&
+      !resource.has_disk() &&
+      !resource.has_revocable() &&
+      !resource.has_shared()) {
+    scalar = internal::values::convertToFixed(resource.scalar().value());
+  } else {
+    scalar = None();
+  }
+
+  if (resource.type() == Value::RANGES && !resource.has_shared()) {
+    ranges = internal::values::rangesToIntervalSet(resource.ranges());
+  } else {
+    ranges = None();
+  }
+}
+
+
 Resources::Resources(const Resource& resource)
 {
   // NOTE: Invalid and zero Resource object will be ignored.
@@ -1071,6 +1166,7 @@ void Resources::allocate(const string& role)
 {
   foreach (Resource_& resource_, resources) {
     resource_.resource.mutable_allocation_info()->set_role(role);
+    resource_.updateValue();
   }
 }
 
@@ -1080,6 +1176,7 @@ void Resources::unallocate()
   foreach (Resource_& resource_, resources) {
     if (resource_.resource.has_allocation_info()) {
       resource_.resource.clear_allocation_info();
+      resource_.updateValue();
     }
   }
 }
@@ -1199,6 +1296,7 @@ Try<Resources> Resources::flatten(
     } else {
       resource_.resource.mutable_reservation()->CopyFrom(reservation.get());
     }
+    resource_.updateValue();
     flattened.add(resource_);
   }
 
@@ -1783,7 +1881,7 @@ void Resources::add(const Resource_& that)
 
   bool found = false;
   foreach (Resource_& resource_, resources) {
-    if (internal::addable(resource_.resource, that)) {
+    if (resource_.addable(that)) {
       resource_ += that;
       found = true;
       break;
@@ -1858,7 +1956,7 @@ void Resources::subtract(const Resource_& that)
   for (size_t i = 0; i < resources.size(); i++) {
     Resource_& resource_ = resources[i];
 
-    if (internal::subtractable(resource_.resource, that)) {
+    if (resource_.subtractable(that)) {
       resource_ -= that;
 
       // Remove the resource if it has become negative or empty.
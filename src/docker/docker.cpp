@@ -14,11 +14,13 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <map>
 #include <vector>
 
 #include <stout/error.hpp>
 #include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
 #include <stout/json.hpp>
 #include <stout/lambda.hpp>
 #include <stout/os.hpp>
@@ -31,9 +33,16 @@
 #include <stout/os/read.hpp>
 #include <stout/os/write.hpp>
 
+#include <process/address.hpp>
 #include <process/check.hpp>
 #include <process/collect.hpp>
+#include <process/defer.hpp>
+#include <process/dispatch.hpp>
+#include <process/http.hpp>
+#include <process/id.hpp>
 #include <process/io.hpp>
+#include <process/process.hpp>
+#include <process/socket.hpp>
 
 #include "common/status_utils.hpp"
 
@@ -98,6 +107,240 @@ static Future<Nothing> checkError(const string& cmd, const Subprocess& s)
 }
 
 
+// A client of the Docker Engine API, i.e., of the REST API that the
+// Docker daemon serves on its unix socket. Requests are sent on
+// keep-alive connections, which are kept around for reuse once the
+// response has been received (except for requests whose responses
+// are streamed, e.g., events, which get a connection of their own).
+class DockerEngineProcess : public Process<DockerEngineProcess>
+{
+public:
+  explicit DockerEngineProcess(const string& _socket)
+    : ProcessBase(process::ID::generate("docker-engine")),
+      socket(_socket) {}
+
+  virtual ~DockerEngineProcess() {}
+
+  Future<http::Response> send(const http::Request& request, bool streamed)
+  {
+    VLOG(1) << "Sending '" << request.method << " " << request.url.path
+            << "' to the Docker daemon at '" << socket << "'";
+
+    if (streamed) {
+      http::Request _request = request;
+      _request.keepAlive = false;
+
+      return connect()
+        .then([_request](http::Connection connection) {
+          Future<http::Response> response = connection.send(_request, true);
+
+          // This is a non Keep-Alive request which means the connection
+          // will be closed when the response is received. Since the
+          // 'Connection' is reference-counted, we must maintain a copy
+          // until the disconnection occurs.
+          connection.disconnected()
+            .onAny([connection]() {});
+
+          return response;
+        });
+    }
+
+    if (idle.empty()) {
+      return connect()
+        .then(defer(self(), &Self::_send, lambda::_1, request));
+    }
+
+    http::Connection connection = idle.front();
+    idle.pop_front();
+
+    Future<http::Response> response = _send(connection, request);
+
+    // The daemon may have closed the (idle) connection before it
+    // received the request, so we retry requests that are safe to
+    // retry once on a new connection.
+    if (request.method == "GET") {
+      return response
+        .repair(defer(self(), [=](const Future<http::Response>&) {
+          return connect()
+            .then(defer(self(), &Self::_send, lambda::_1, request));
+        }));
+    }
+
+    return response;
+  }
+
+protected:
+  virtual void finalize()
+  {
+    foreach (http::Connection& connection, idle) {
+      connection.disconnect();
+    }
+
+    idle.clear();
+  }
+
+private:
+  Future<http::Connection> connect()
+  {
+    Try<network::unix::Address> address =
+      network::unix::Address::create(socket);
+
+    if (address.isError()) {
+      return Failure(
+          "Invalid Docker socket path '" + socket + "': " + address.error());
+    }
+
+    Try<network::Socket> s = network::Socket::create(
+        network::Address::Family::UNIX,
+        network::internal::SocketImpl::Kind::POLL);
+
+    if (s.isError()) {
+      return Failure("Failed to create socket: " + s.error());
+    }
+
+    return http::connect(s.get(), address.get())
+      .then(defer(self(), [=](http::Connection connection) {
+        // Stop reusing the connection once the daemon closes it.
+        connection.disconnected()
+          .onAny(defer(self(), &Self::disconnected, connection));
+
+        return connection;
+      }));
+  }
+
+  Future<http::Response> _send(
+      http::Connection connection,
+      const http::Request& request)
+  {
+    http::Request _request = request;
+    _request.keepAlive = true;
+
+    return connection.send(_request)
+      .onAny(defer(self(), &Self::completed, connection, lambda::_1));
+  }
+
+  void completed(
+      http::Connection connection,
+      const Future<http::Response>& response)
+  {
+    // The connection can not be reused after a failure or if the
+    // daemon is closing it.
+    if (!response.isReady() ||
+        response->headers.get("Connection") == string("close") ||
+        idle.size() >= DOCKER_MAX_IDLE_CONNECTIONS) {
+      connection.disconnect();
+      return;
+    }
+
+    idle.push_back(connection);
+  }
+
+  void disconnected(const http::Connection& connection)
+  {
+    idle.remove(connection);
+  }
+
+  const string socket;
+
+  list<http::Connection> idle;
+};
+
+
+class Docker::Engine
+{
+public:
+  explicit Engine(const string& socket)
+    : process(spawn(new DockerEngineProcess(socket), true)) {}
+
+  ~Engine()
+  {
+    // NOTE: The process is managed, i.e., it gets deleted once it
+    // has terminated, since this may run in the context of the
+    // process (i.e., when it releases the last copy of `Engine`).
+    terminate(process);
+  }
+
+  Future<http::Response> send(
+      const http::Request& request,
+      bool streamed = false) const
+  {
+    return dispatch(process, &DockerEngineProcess::send, request, streamed);
+  }
+
+private:
+  const PID<DockerEngineProcess> process;
+};
+
+
+// Returns a request for the given endpoint of the Docker Engine API.
+static http::Request engineRequest(
+    const string& method,
+    const string& path,
+    const hashmap<string, string>& query = hashmap<string, string>())
+{
+  http::Request request;
+  request.method = method;
+
+  // NOTE: The Docker daemon ignores the host, but the 'Host' header
+  // needs to be set.
+  request.url = http::URL("http", "docker", 80, path, query);
+
+  return request;
+}
+
+
+// Returns true if the Docker daemon succeeded to perform the request,
+// i.e., if the response has one of the given codes, which are those
+// that the Docker Engine API documents for a successful request to
+// the endpoint.
+static bool succeeded(
+    const http::Response& response,
+    const vector<uint16_t>& codes)
+{
+  return std::find(codes.begin(), codes.end(), response.code) != codes.end();
+}
+
+
+// Returns the error reported by the Docker daemon in the response.
+static string error(const http::Response& response)
+{
+  Try<JSON::Object> json = JSON::parse<JSON::Object>(response.body);
+  if (json.isSome()) {
+    Result<JSON::String> message = json->find<JSON::String>("message");
+    if (message.isSome()) {
+      return response.status + ": " + message->value;
+    }
+  }
+
+  return response.status + ": " + strings::trim(response.body);
+}
+
+
+// Returns a failure if the Docker daemon failed to perform the
+// request.
+static Future<Nothing> checkResponse(
+    const string& operation,
+    const vector<uint16_t>& codes,
+    const http::Response& response)
+{
+  if (!succeeded(response, codes)) {
+    return Failure("Failed to " + operation + ": " + error(response));
+  }
+
+  return Nothing();
+}
+
+
+Docker::Docker(
+    const string& _path,
+    const string& _socket,
+    const Option<JSON::Object>& _config)
+  : path(_path),
+    socket("unix://" + _socket),
+    config(_config),
+    engine(new Engine(_socket)) {}
+
+
 Try<Owned<Docker>> Docker::create(
     const string& path,
     const string& socket,
@@ -902,46 +1145,46 @@ Future<Nothing> Docker::stop(
                    stringify(timeoutSecs));
   }
 
-  string cmd = path + " -H " + socket + " stop -t " + stringify(timeoutSecs) +
-               " " + containerName;
+  hashmap<string, string> query;
+  query["t"] = stringify(timeoutSecs);
 
-  VLOG(1) << "Running " << cmd;
+  Owned<Promise<Nothing>> promise(new Promise<Nothing>());
 
-  Try<Subprocess> s = subprocess(
-      cmd,
-      Subprocess::PATH("/dev/null"),
-      Subprocess::PATH("/dev/null"),
-      Subprocess::PIPE());
+  const Docker docker = *this;
 
-  if (s.isError()) {
-    return Failure("Failed to create subprocess '" + cmd + "': " + s.error());
-  }
+  engine->send(engineRequest(
+      "POST", "/containers/" + http::encode(containerName) + "/stop", query))
+    .onAny([=](const Future<http::Response>& response) {
+      promise->associate(_stop(docker, containerName, response, remove));
+    });
 
-  return s.get().status()
-    .then(lambda::bind(
-        &Docker::_stop,
-        *this,
-        containerName,
-        cmd,
-        s.get(),
-        remove));
+  return promise->future();
 }
 
 Future<Nothing> Docker::_stop(
     const Docker& docker,
     const string& containerName,
-    const string& cmd,
-    const Subprocess& s,
+    const Future<http::Response>& response,
     bool remove)
 {
-  Option<int> status = s.status().get();
+  // NOTE: The daemon responds with 304 (Not Modified) if the container
+  // was not running.
+  const vector<uint16_t> codes =
+    {http::Status::NO_CONTENT, http::Status::NOT_MODIFIED};
 
   if (remove) {
-    bool force = !status.isSome() || status.get() != 0;
+    bool force = !response.isReady() || !succeeded(response.get(), codes);
     return docker.rm(containerName, force);
   }
 
-  return checkError(cmd, s);
+  if (!response.isReady()) {
+    return Failure(
+        "Failed to stop container '" + containerName + "': " +
+        (response.isFailed() ? response.failure() : "discarded"));
+  }
+
+  return checkResponse(
+      "stop container '" + containerName + "'", codes, response.get());
 }
 
 
@@ -949,23 +1192,16 @@ Future<Nothing> Docker::kill(
     const string& containerName,
     int signal) const
 {
-  const string cmd =
-    path + " -H " + socket +
-    " kill --signal=" + stringify(signal) + " " + containerName;
-
-  VLOG(1) << "Running " << cmd;
-
-  Try<Subprocess> s = subprocess(
-      cmd,
-      Subprocess::PATH("/dev/null"),
-      Subprocess::PATH("/dev/null"),
-      Subprocess::PIPE());
-
-  if (s.isError()) {
-    return Failure("Failed to create subprocess '" + cmd + "': " + s.error());
-  }
+  hashmap<string, string> query;
+  query["signal"] = stringify(signal);
 
-  return checkError(cmd, s.get());
+  return engine->send(engineRequest(
+      "POST", "/containers/" + http::encode(containerName) + "/kill", query))
+    .then(lambda::bind(
+        &checkResponse,
+        "kill container '" + containerName + "'",
+        vector<uint16_t>({http::Status::NO_CONTENT}),
+        lambda::_1));
 }
 
 
@@ -973,24 +1209,21 @@ Future<Nothing> Docker::rm(
     const string& containerName,
     bool force) const
 {
-  // The `-v` flag removes Docker volumes that may be present.
-  const string cmd =
-    path + " -H " + socket +
-    (force ? " rm -f -v " : " rm -v ") + containerName;
-
-  VLOG(1) << "Running " << cmd;
+  // The `v` parameter removes Docker volumes that may be present.
+  hashmap<string, string> query;
+  query["v"] = "1";
 
-  Try<Subprocess> s = subprocess(
-      cmd,
-      Subprocess::PATH("/dev/null"),
-      Subprocess::PATH("/dev/null"),
-      Subprocess::PIPE());
-
-  if (s.isError()) {
-    return Failure("Failed to create subprocess '" + cmd + "': " + s.error());
+  if (force) {
+    query["force"] = "1";
   }
 
-  return checkError(cmd, s.get());
+  return engine->send(engineRequest(
+      "DELETE", "/containers/" + http::encode(containerName), query))
+    .then(lambda::bind(
+        &checkResponse,
+        "remove container '" + containerName + "'",
+        vector<uint16_t>({http::Status::NO_CONTENT}),
+        lambda::_1));
 }
 
 
@@ -1000,129 +1233,168 @@ Future<Docker::Container> Docker::inspect(
 {
   Owned<Promise<Docker::Container>> promise(new Promise<Docker::Container>());
 
-  const string cmd =  path + " -H " + socket + " inspect " + containerName;
-  _inspect(cmd, promise, retryInterval);
+  if (retryInterval.isNone()) {
+    _inspect(engine, containerName, promise, retryInterval, None());
+    return promise->future();
+  }
+
+  // Subscribe to the events of the container, so that we retry the
+  // inspect whenever the state of the container changes rather than
+  // polling the daemon. We subscribe before the first inspect so
+  // that we do not miss any events.
+  JSON::Array containers;
+  containers.values.push_back(containerName);
+
+  JSON::Object filters;
+  filters.values["container"] = containers;
+
+  hashmap<string, string> query;
+  query["filters"] = http::encode(stringify(filters));
+
+  const std::shared_ptr<Engine> engine = this->engine;
+
+  engine->send(engineRequest("GET", "/events", query), true)
+    .onAny([=](const Future<http::Response>& response) {
+      Option<http::Pipe::Reader> events;
+
+      if (response.isReady() &&
+          response->code == http::Status::OK &&
+          response->type == http::Response::PIPE) {
+        CHECK_SOME(response->reader);
+        events = response->reader.get();
+
+        // Stop waiting for events once the inspect is discarded.
+        promise->future()
+          .onDiscard([events]() mutable { events->close(); });
+      } else {
+        const string message = response.isReady()
+          ? error(response.get())
+          : (response.isFailed() ? response.failure() : "discarded");
+
+        LOG(WARNING) << "Failed to subscribe to the events of container '"
+                     << containerName << "': " << message
+                     << "; retrying inspect every " << retryInterval.get();
+      }
+
+      _inspect(engine, containerName, promise, retryInterval, events);
+    });
 
   return promise->future();
 }
 
 
 void Docker::_inspect(
-    const string& cmd,
+    const std::shared_ptr<Engine>& engine,
+    const string& containerName,
     const Owned<Promise<Docker::Container>>& promise,
-    const Option<Duration>& retryInterval)
+    const Option<Duration>& retryInterval,
+    Option<http::Pipe::Reader> events)
 {
   if (promise->future().hasDiscard()) {
-    promise->discard();
-    return;
-  }
-
-  VLOG(1) << "Running " << cmd;
-
-  Try<Subprocess> s = subprocess(
-      cmd,
-      Subprocess::PATH("/dev/null"),
-      Subprocess::PIPE(),
-      Subprocess::PIPE());
+    if (events.isSome()) {
+      events->close();
+    }
 
-  if (s.isError()) {
-    promise->fail("Failed to create subprocess '" + cmd + "': " + s.error());
+    promise->discard();
     return;
   }
 
-  // Start reading from stdout so writing to the pipe won't block
-  // to handle cases where the output is larger than the pipe
-  // capacity.
-  const Future<string> output = io::read(s.get().out().get());
-
-  s.get().status()
-    .onAny([=]() { __inspect(cmd, promise, retryInterval, output, s.get()); });
+  engine->send(engineRequest(
+      "GET", "/containers/" + http::encode(containerName) + "/json"))
+    .onAny([=](const Future<http::Response>& response) {
+      __inspect(
+          engine, containerName, promise, retryInterval, events, response);
+    });
 }
 
 
 void Docker::__inspect(
-    const string& cmd,
+    const std::shared_ptr<Engine>& engine,
+    const string& containerName,
     const Owned<Promise<Docker::Container>>& promise,
     const Option<Duration>& retryInterval,
-    Future<string> output,
-    const Subprocess& s)
+    Option<http::Pipe::Reader> events,
+    const Future<http::Response>& response)
 {
   if (promise->future().hasDiscard()) {
+    if (events.isSome()) {
+      events->close();
+    }
+
     promise->discard();
-    output.discard();
     return;
   }
 
-  // Check the exit status of 'docker inspect'.
-  CHECK_READY(s.status());
+  Try<Docker::Container> container = Error("Not inspected");
+  bool retry = false;
 
-  Option<int> status = s.status().get();
+  if (!response.isReady()) {
+    container = Error(response.isFailed() ? response.failure() : "discarded");
+  } else if (!succeeded(response.get(), {http::Status::OK})) {
+    container = Error(error(response.get()));
 
-  if (!status.isSome()) {
-    promise->fail("No status found from '" + cmd + "'");
-  } else if (status.get() != 0) {
-    output.discard();
+    // The container may not have been created yet.
+    retry = response->code == http::Status::NOT_FOUND;
+  } else {
+    // NOTE: We keep the output in the format of 'docker inspect',
+    // i.e., an array of the inspected objects, since it is exposed
+    // to frameworks (e.g., in the data of status updates).
+    container = Docker::Container::create("[" + response->body + "]");
 
-    if (retryInterval.isSome()) {
-      VLOG(1) << "Retrying inspect with non-zero status code. cmd: '"
-              << cmd << "', interval: " << stringify(retryInterval.get());
-      Clock::timer(retryInterval.get(),
-                   [=]() { _inspect(cmd, promise, retryInterval); } );
-      return;
+    if (container.isSome()) {
+      retry = !container->started;
     }
-
-    CHECK_SOME(s.err());
-    io::read(s.err().get())
-      .then(lambda::bind(
-                failure<Nothing>,
-                cmd,
-                status.get(),
-                lambda::_1))
-      .onAny([=](const Future<Nothing>& future) {
-          CHECK_FAILED(future);
-          promise->fail(future.failure());
-      });
-    return;
   }
 
-  // Read to EOF.
-  CHECK_SOME(s.out());
-  output
-    .onAny([=](const Future<string>& output) {
-      ___inspect(cmd, promise, retryInterval, output);
-    });
-}
+  if (retry && retryInterval.isSome()) {
+    if (events.isSome()) {
+      VLOG(1) << "Retrying inspect of container '" << containerName
+              << "' on its next event";
 
+      // NOTE: We re-inspect on any data read, which contains at
+      // least one (possibly partial) event of the container.
+      events->read()
+        .onAny([=](const Future<string>& event) mutable {
+          if (event.isReady() && !event->empty()) {
+            _inspect(engine, containerName, promise, retryInterval, events);
+            return;
+          }
 
-void Docker::___inspect(
-    const string& cmd,
-    const Owned<Promise<Docker::Container>>& promise,
-    const Option<Duration>& retryInterval,
-    const Future<string>& output)
-{
-  if (promise->future().hasDiscard()) {
-    promise->discard();
-    return;
-  }
+          events->close();
 
-  if (!output.isReady()) {
-    promise->fail(output.isFailed() ? output.failure() : "future discarded");
-    return;
-  }
+          if (promise->future().hasDiscard()) {
+            promise->discard();
+            return;
+          }
 
-  Try<Docker::Container> container = Docker::Container::create(
-      output.get());
+          LOG(WARNING) << "Events of container '" << containerName
+                       << "' ended; retrying inspect every "
+                       << retryInterval.get();
 
-  if (container.isError()) {
-    promise->fail("Unable to create container: " + container.error());
+          Clock::timer(retryInterval.get(), [=]() {
+            _inspect(engine, containerName, promise, retryInterval, None());
+          });
+        });
+      return;
+    }
+
+    VLOG(1) << "Retrying inspect of container '" << containerName
+            << "', interval: " << stringify(retryInterval.get());
+
+    Clock::timer(retryInterval.get(), [=]() {
+      _inspect(engine, containerName, promise, retryInterval, None());
+    });
     return;
   }
 
-  if (retryInterval.isSome() && !container.get().started) {
-    VLOG(1) << "Retrying inspect since container not yet started. cmd: '"
-            << cmd << "', interval: " << stringify(retryInterval.get());
-    Clock::timer(retryInterval.get(),
-                 [=]() { _inspect(cmd, promise, retryInterval); } );
+  if (events.isSome()) {
+    events->close();
+  }
+
+  if (container.isError()) {
+    promise->fail(
+        "Failed to inspect container '" + containerName + "': " +
+        container.error());
     return;
   }
 
@@ -1134,69 +1406,63 @@ Future<list<Docker::Container>> Docker::ps(
     bool all,
     const Option<string>& prefix) const
 {
-  string cmd = path + " -H " + socket + (all ? " ps -a" : " ps");
-
-  VLOG(1) << "Running " << cmd;
-
-  Try<Subprocess> s = subprocess(
-      cmd,
-      Subprocess::PATH("/dev/null"),
-      Subprocess::PIPE(),
-      Subprocess::PIPE());
-
-  if (s.isError()) {
-    return Failure("Failed to create subprocess '" + cmd + "': " + s.error());
+  hashmap<string, string> query;
+  if (all) {
+    query["all"] = "1";
   }
 
-  // Start reading from stdout so writing to the pipe won't block
-  // to handle cases where the output is larger than the pipe
-  // capacity.
-  const Future<string>& output = io::read(s.get().out().get());
-
-  return s.get().status()
-    .then(lambda::bind(&Docker::_ps, *this, cmd, s.get(), prefix, output));
+  return engine->send(engineRequest("GET", "/containers/json", query))
+    .then(lambda::bind(&Docker::_ps, *this, prefix, lambda::_1));
 }
 
 
 Future<list<Docker::Container>> Docker::_ps(
     const Docker& docker,
-    const string& cmd,
-    const Subprocess& s,
     const Option<string>& prefix,
-    Future<string> output)
+    const http::Response& response)
 {
-  Option<int> status = s.status().get();
+  if (!succeeded(response, {http::Status::OK})) {
+    return Failure("Failed to list containers: " + error(response));
+  }
 
-  if (!status.isSome()) {
-    output.discard();
-    return Failure("No status found from '" + cmd + "'");
-  } else if (status.get() != 0) {
-    output.discard();
-    CHECK_SOME(s.err());
-    return io::read(s.err().get())
-      .then(lambda::bind(
-                failure<list<Docker::Container>>,
-                cmd,
-                status.get(),
-                lambda::_1));
+  Try<JSON::Array> parse = JSON::parse<JSON::Array>(response.body);
+  if (parse.isError()) {
+    return Failure("Failed to parse JSON: " + parse.error());
   }
 
-  // Read to EOF.
-  return output.then(lambda::bind(&Docker::__ps, docker, prefix, lambda::_1));
-}
+  Owned<vector<string>> names(new vector<string>());
 
+  foreach (const JSON::Value& value, parse->values) {
+    if (!value.is<JSON::Object>()) {
+      return Failure("Unexpected container: " + stringify(value));
+    }
 
-Future<list<Docker::Container>> Docker::__ps(
-    const Docker& docker,
-    const Option<string>& prefix,
-    const string& output)
-{
-  Owned<vector<string>> lines(new vector<string>());
-  *lines = strings::tokenize(output, "\n");
+    Result<JSON::Array> _names =
+      value.as<JSON::Object>().find<JSON::Array>("Names");
+
+    if (!_names.isSome()) {
+      return Failure("Failed to find the names of container: " +
+                     stringify(value));
+    }
 
-  // Skip the header.
-  CHECK(!lines->empty());
-  lines->erase(lines->begin());
+    // The names are prefixed by '/'. Names of linked containers
+    // (i.e., '/linking/alias') are not the name of the container.
+    Option<string> name;
+    foreach (const JSON::Value& _name, _names->values) {
+      if (_name.is<JSON::String>()) {
+        const string& s = _name.as<JSON::String>().value;
+        if (strings::startsWith(s, "/") &&
+            !strings::contains(s.substr(1), "/")) {
+          name = s.substr(1);
+          break;
+        }
+      }
+    }
+
+    if (name.isSome()) {
+      names->push_back(name.get());
+    }
+  }
 
   Owned<list<Docker::Container>> containers(new list<Docker::Container>());
 
@@ -1205,7 +1471,7 @@ Future<list<Docker::Container>> Docker::__ps(
 
   // Limit number of parallel calls to docker inspect at once to prevent
   // reaching system's open file descriptor limit.
-  inspectBatches(containers, lines, promise, docker, prefix);
+  inspectBatches(containers, names, promise, docker, prefix);
 
   return promise->future();
 }
@@ -1214,24 +1480,24 @@ Future<list<Docker::Container>> Docker::__ps(
 // within libprocess.
 void Docker::inspectBatches(
     Owned<list<Docker::Container>> containers,
-    Owned<vector<string>> lines,
+    Owned<vector<string>> names,
     Owned<Promise<list<Docker::Container>>> promise,
     const Docker& docker,
     const Option<string>& prefix)
 {
   list<Future<Docker::Container>> batch =
-    createInspectBatch(lines, docker, prefix);
+    createInspectBatch(names, docker, prefix);
 
   collect(batch).onAny([=](const Future<list<Docker::Container>>& c) {
     if (c.isReady()) {
       foreach (const Docker::Container& container, c.get()) {
         containers->push_back(container);
       }
-      if (lines->empty()) {
+      if (names->empty()) {
         promise->set(*containers);
       }
       else {
-        inspectBatches(containers, lines, promise, docker, prefix);
+        inspectBatches(containers, names, promise, docker, prefix);
       }
     } else {
       if (c.isFailed()) {
@@ -1246,22 +1512,18 @@ void Docker::inspectBatches(
 
 
 list<Future<Docker::Container>> Docker::createInspectBatch(
-    Owned<vector<string>> lines,
+    Owned<vector<string>> names,
     const Docker& docker,
     const Option<string>& prefix)
 {
   list<Future<Docker::Container>> batch;
 
-  while (!lines->empty() && batch.size() < DOCKER_PS_MAX_INSPECT_CALLS) {
-    string line = lines->back();
-    lines->pop_back();
+  while (!names->empty() && batch.size() < DOCKER_PS_MAX_INSPECT_CALLS) {
+    string name = names->back();
+    names->pop_back();
 
     // Inspect the containers that we are interested in depending on
     // whether or not a 'prefix' was specified.
-    vector<string> columns = strings::split(strings::trim(line), " ");
-
-    // We expect the name column to be the last column from ps.
-    string name = columns[columns.size() - 1];
     if (prefix.isNone() || strings::startsWith(name, prefix.get())) {
       batch.push_back(docker.inspect(name));
     }
@@ -1276,8 +1538,6 @@ Future<Docker::Image> Docker::pull(
     const string& image,
     bool force) const
 {
-  vector<string> argv;
-
   string dockerImage = image;
 
   // Check if the specified image has a tag. Also split on "/" in case
@@ -1296,67 +1556,35 @@ Future<Docker::Image> Docker::pull(
     return Docker::__pull(*this, directory, image, path, socket, config);
   }
 
-  argv.push_back(path);
-  argv.push_back("-H");
-  argv.push_back(socket);
-  argv.push_back("inspect");
-  argv.push_back(dockerImage);
-
-  string cmd = strings::join(" ", argv);
-
-  VLOG(1) << "Running " << cmd;
-
-  Try<Subprocess> s = subprocess(
-      path,
-      argv,
-      Subprocess::PATH("/dev/null"),
-      Subprocess::PIPE(),
-      Subprocess::PIPE(),
-      nullptr);
-
-  if (s.isError()) {
-    return Failure("Failed to create subprocess '" + cmd + "': " + s.error());
-  }
-
-  // Start reading from stdout so writing to the pipe won't block
-  // to handle cases where the output is larger than the pipe
-  // capacity.
-  const Future<string> output = io::read(s.get().out().get());
-
-  // We assume docker inspect to exit quickly and do not need to be
-  // discarded.
-  return s.get().status()
+  // NOTE: Image names are not percent-encoded, since the Docker
+  // daemon expects the '/' and ':' of a name as they are.
+  return engine->send(engineRequest(
+      "GET", "/images/" + dockerImage + "/json"))
     .then(lambda::bind(
         &Docker::_pull,
         *this,
-        s.get(),
         directory,
         dockerImage,
         path,
         socket,
         config,
-        output));
+        lambda::_1));
 }
 
 
 Future<Docker::Image> Docker::_pull(
     const Docker& docker,
-    const Subprocess& s,
     const string& directory,
     const string& image,
     const string& path,
     const string& socket,
     const Option<JSON::Object>& config,
-    Future<string> output)
+    const http::Response& response)
 {
-  Option<int> status = s.status().get();
-  if (status.isSome() && status.get() == 0) {
-    return output
-      .then(lambda::bind(&Docker::____pull, lambda::_1));
+  if (succeeded(response, {http::Status::OK})) {
+    return ____pull(response);
   }
 
-  output.discard();
-
   return Docker::__pull(docker, directory, image, path, socket, config);
 }
 
@@ -1506,32 +1734,19 @@ Future<Docker::Image> Docker::___pull(
 
 
 Future<Docker::Image> Docker::____pull(
-    const string& output)
+    const http::Response& response)
 {
-  Try<JSON::Array> parse = JSON::parse<JSON::Array>(output);
+  Try<JSON::Object> parse = JSON::parse<JSON::Object>(response.body);
 
   if (parse.isError()) {
     return Failure("Failed to parse JSON: " + parse.error());
   }
 
-  JSON::Array array = parse.get();
-
-  // Only return if only one image identified with name.
-  if (array.values.size() == 1) {
-    CHECK(array.values.front().is<JSON::Object>());
+  Try<Docker::Image> image = Docker::Image::create(parse.get());
 
-    Try<Docker::Image> image =
-      Docker::Image::create(array.values.front().as<JSON::Object>());
-
-    if (image.isError()) {
-      return Failure("Unable to create image: " + image.error());
-    }
-
-    return image.get();
+  if (image.isError()) {
+    return Failure("Unable to create image: " + image.error());
   }
 
-  // TODO(tnachen): Handle the case where the short image ID was
-  // not sufficiently unique and 'array.values.size() > 1'.
-
-  return Failure("Failed to find image");
+  return image.get();
 }
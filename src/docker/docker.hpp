@@ -19,9 +19,11 @@
 
 #include <list>
 #include <map>
+#include <memory>
 #include <string>
 
 #include <process/future.hpp>
+#include <process/http.hpp>
 #include <process/owned.hpp>
 #include <process/subprocess.hpp>
 
@@ -40,6 +42,10 @@
 
 // Abstraction for working with Docker (modeled on CLI).
 //
+// Containers are run and images are pulled using the Docker CLI, while
+// all other operations use the Docker Engine API (i.e., the REST API
+// the Docker daemon serves on its socket) directly.
+//
 // TODO(benh): Make futures returned by functions be discardable.
 class Docker
 {
@@ -183,7 +189,9 @@ public:
 
   // Performs 'docker inspect CONTAINER'. If retryInterval is set,
   // we will keep retrying inspect until the container is started or
-  // the future is discarded.
+  // the future is discarded. Rather than every 'retryInterval', the
+  // inspect is retried whenever the Docker daemon reports an event
+  // of the container, unless the daemon fails to report events.
   virtual process::Future<Container> inspect(
       const std::string& containerName,
       const Option<Duration>& retryInterval = None()) const;
@@ -210,12 +218,12 @@ protected:
   // Uses the specified path to the Docker CLI tool.
   Docker(const std::string& _path,
          const std::string& _socket,
-         const Option<JSON::Object>& _config)
-       : path(_path),
-         socket("unix://" + _socket),
-         config(_config) {}
+         const Option<JSON::Object>& _config);
 
 private:
+  // Forward declaration of the Docker Engine API client.
+  class Engine;
+
   static process::Future<Version> _version(
       const std::string& cmd,
       const process::Subprocess& s);
@@ -226,61 +234,49 @@ private:
   static process::Future<Nothing> _stop(
       const Docker& docker,
       const std::string& containerName,
-      const std::string& cmd,
-      const process::Subprocess& s,
+      const process::Future<process::http::Response>& response,
       bool remove);
 
   static void _inspect(
-      const std::string& cmd,
-      const process::Owned<process::Promise<Container>>& promise,
-      const Option<Duration>& retryInterval);
-
-  static void __inspect(
-      const std::string& cmd,
+      const std::shared_ptr<Engine>& engine,
+      const std::string& containerName,
       const process::Owned<process::Promise<Container>>& promise,
       const Option<Duration>& retryInterval,
-      process::Future<std::string> output,
-      const process::Subprocess& s);
+      Option<process::http::Pipe::Reader> events);
 
-  static void ___inspect(
-      const std::string& cmd,
+  static void __inspect(
+      const std::shared_ptr<Engine>& engine,
+      const std::string& containerName,
       const process::Owned<process::Promise<Container>>& promise,
       const Option<Duration>& retryInterval,
-      const process::Future<std::string>& output);
+      Option<process::http::Pipe::Reader> events,
+      const process::Future<process::http::Response>& response);
 
   static process::Future<std::list<Container>> _ps(
       const Docker& docker,
-      const std::string& cmd,
-      const process::Subprocess& s,
       const Option<std::string>& prefix,
-      process::Future<std::string> output);
-
-  static process::Future<std::list<Container>> __ps(
-      const Docker& docker,
-      const Option<std::string>& prefix,
-      const std::string& output);
+      const process::http::Response& response);
 
   static void inspectBatches(
       process::Owned<std::list<Docker::Container>> containers,
-      process::Owned<std::vector<std::string>> lines,
+      process::Owned<std::vector<std::string>> names,
       process::Owned<process::Promise<std::list<Docker::Container>>> promise,
       const Docker& docker,
       const Option<std::string>& prefix);
 
   static std::list<process::Future<Docker::Container>> createInspectBatch(
-      process::Owned<std::vector<std::string>> lines,
+      process::Owned<std::vector<std::string>> names,
       const Docker& docker,
       const Option<std::string>& prefix);
 
   static process::Future<Image> _pull(
       const Docker& docker,
-      const process::Subprocess& s,
       const std::string& directory,
       const std::string& image,
       const std::string& path,
       const std::string& socket,
       const Option<JSON::Object>& config,
-      process::Future<std::string> output);
+      const process::http::Response& response);
 
   static process::Future<Image> __pull(
       const Docker& docker,
@@ -298,7 +294,7 @@ private:
       const std::string& image);
 
   static process::Future<Image> ____pull(
-      const std::string& output);
+      const process::http::Response& response);
 
   static void pullDiscarded(
       const process::Subprocess& s,
@@ -307,6 +303,9 @@ private:
   const std::string path;
   const std::string socket;
   const Option<JSON::Object> config;
+
+  // Shared by all copies of this object.
+  std::shared_ptr<Engine> engine;
 };
 
 #endif // __DOCKER_HPP__
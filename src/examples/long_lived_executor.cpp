@@ -130,6 +130,9 @@ protected:
           break;
         }
 
+        // This executor does not send batches of status updates, so
+        // it never receives ACKNOWLEDGEMENTS.
+        case Event::ACKNOWLEDGEMENTS:
         case Event::KILL:
         case Event::MESSAGE:
         case Event::SHUTDOWN: {
@@ -219,6 +219,7 @@ protected:
 
         case Event::HEARTBEAT:
         case Event::INVERSE_OFFERS:
+        case Event::UPDATES:
         case Event::RESCIND:
         case Event::RESCIND_INVERSE_OFFER:
         case Event::MESSAGE: {
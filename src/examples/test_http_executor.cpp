@@ -180,6 +180,12 @@ public:
           break;
         }
 
+        case Event::ACKNOWLEDGEMENTS: {
+          // This executor does not send batches of status updates.
+          cout << "Received an unexpected ACKNOWLEDGEMENTS event" << endl;
+          break;
+        }
+
         case Event::MESSAGE: {
           cout << "Received a MESSAGE event" << endl;
           break;
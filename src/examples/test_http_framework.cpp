@@ -192,6 +192,12 @@ public:
           break;
         }
 
+        // Only sent to frameworks with the BATCHED_RECONCILIATION
+        // capability.
+        case Event::UPDATES: {
+          break;
+        }
+
         case Event::UNKNOWN: {
           LOG(WARNING) << "Received an UNKNOWN event and ignored";
           break;
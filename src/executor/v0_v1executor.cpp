@@ -24,6 +24,7 @@
 
 #include <stout/check.hpp>
 #include <stout/exit.hpp>
+#include <stout/foreach.hpp>
 
 #include "executor/v0_v1executor.hpp"
 
@@ -186,6 +187,13 @@ public:
         break;
       }
 
+      case Call::UPDATES: {
+        foreach (const Call::Update& update, call.updates().updates()) {
+          driver->sendStatusUpdate(devolve(update.status()));
+        }
+        break;
+      }
+
       case Call::MESSAGE: {
         driver->sendFrameworkMessage(call.message().data());
         break;
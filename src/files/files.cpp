@@ -18,10 +18,18 @@
 #include <unistd.h>
 #endif // __WINDOWS__
 
+#include <dirent.h>
+
 #include <sys/stat.h>
 
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif // __linux__
+
 #include <algorithm>
-#include <map>
+#include <iterator>
+#include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -34,6 +42,7 @@
 #include <process/help.hpp>
 #include <process/http.hpp>
 #include <process/io.hpp>
+#include <process/loop.hpp>
 #include <process/mime.hpp>
 #include <process/process.hpp>
 
@@ -74,6 +83,9 @@ using mesos::Authorizer;
 
 using process::AUTHENTICATION;
 using process::AUTHORIZATION;
+using process::Break;
+using process::Continue;
+using process::ControlFlow;
 using process::defer;
 using process::DESCRIPTION;
 using process::Failure;
@@ -84,7 +96,7 @@ using process::TLDR;
 using process::wait; // Necessary on some OS's to disambiguate.
 
 using std::list;
-using std::map;
+using std::set;
 using std::string;
 using std::tuple;
 using std::vector;
@@ -109,7 +121,9 @@ public:
 
   Future<Try<list<FileInfo>, FilesError>> browse(
       const string& path,
-      const Option<string>& principal);
+      const Option<string>& principal,
+      const Option<string>& after,
+      const Option<size_t>& limit);
 
   Future<Try<tuple<size_t, string>, FilesError>> read(
       const size_t offset,
@@ -135,12 +149,20 @@ private:
   // Returns a file listing for a directory.
   // Requests have the following parameters:
   //   path: The directory to browse. Required.
+  //   after: Only list the entries whose names sort after this one.
+  //   limit: The maximum number of entries to list.
+  //   stream: If `true`, the listing is streamed. Optional.
   // The response will contain a list of JSON files and directories contained
   // in the path (see `FileInfo` model override for the format).
   Future<http::Response> _browse(
       const http::Request& request,
       const Option<string>& principal);
 
+  // Streams the listing of a directory in batches of entries, in
+  // directory order, so that neither the listing nor the response have
+  // to be kept in memory at once.
+  Future<http::Response> __browse(const string& path);
+
   // Continuation of `read()`.
   Future<Try<tuple<size_t, string>, FilesError>> _read(
       size_t offset,
@@ -162,6 +184,17 @@ private:
 
   Future<http::Response> _download(const string& path);
 
+  // Streams the raw file contents for a given path, including any
+  // data appended after the request was made (i.e., `tail -f`).
+  // Requests have the following parameters:
+  //   path: The file to follow. Required.
+  //   offset: The offset to start streaming from. Defaults to 0.
+  Future<http::Response> follow(
+      const http::Request& request,
+      const Option<string>& principal);
+
+  Future<http::Response> _follow(const string& path, off_t offset);
+
   // Returns the internal virtual path mapping.
   Future<http::Response> debug(
       const http::Request& request,
@@ -170,6 +203,7 @@ private:
   const static string BROWSE_HELP;
   const static string READ_HELP;
   const static string DOWNLOAD_HELP;
+  const static string FOLLOW_HELP;
   const static string DEBUG_HELP;
 
   hashmap<string, string> paths;
@@ -232,6 +266,10 @@ void FilesProcess::initialize()
           authenticationRealm.get(),
           FilesProcess::DOWNLOAD_HELP,
           &FilesProcess::download);
+    route("/follow",
+          authenticationRealm.get(),
+          FilesProcess::FOLLOW_HELP,
+          &FilesProcess::follow);
     route("/debug",
           authenticationRealm.get(),
           FilesProcess::DEBUG_HELP,
@@ -261,6 +299,9 @@ void FilesProcess::initialize()
     route("/download",
           FilesProcess::DOWNLOAD_HELP,
           lambda::bind(&FilesProcess::download, this, lambda::_1, None()));
+    route("/follow",
+          FilesProcess::FOLLOW_HELP,
+          lambda::bind(&FilesProcess::follow, this, lambda::_1, None()));
     route("/debug",
           FilesProcess::DEBUG_HELP,
           lambda::bind(&FilesProcess::debug, this, lambda::_1, None()));
@@ -320,9 +361,19 @@ const string FilesProcess::BROWSE_HELP = HELP(
         "Lists files and directories contained in the path as",
         "a JSON object.",
         "",
+        "The listing is sorted by path. Large directories can be listed",
+        "page by page: `limit` bounds the number of entries returned, and",
+        "passing the name of the last entry of a page as `after` returns",
+        "the next page. Alternatively, `stream=true` streams the listing",
+        "of the whole directory, unsorted.",
+        "",
         "Query parameters:",
         "",
-        ">        path=VALUE          The path of directory to browse."),
+        ">        path=VALUE          The path of directory to browse.",
+        ">        after=VALUE         Only list entries whose names sort after",
+        ">                            this one.",
+        ">        limit=VALUE         Maximum number of entries to list.",
+        ">        stream=(true|false) Whether to stream the listing."),
     AUTHENTICATION(true),
     AUTHORIZATION(
         "Browsing files requires that the request principal is",
@@ -373,8 +424,38 @@ Future<http::Response> FilesProcess::_browse(
 
   string requestedPath = path.get();
   Option<string> jsonp = request.url.query.get("jsonp");
+  Option<string> after = request.url.query.get("after");
+
+  Option<size_t> limit;
+
+  if (request.url.query.get("limit").isSome()) {
+    Try<size_t> result = numify<size_t>(request.url.query.get("limit").get());
+
+    if (result.isError()) {
+      return BadRequest("Failed to parse limit: " + result.error() + ".\n");
+    }
+
+    limit = result.get();
+  }
+
+  if (request.url.query.get("stream") == Option<string>("true")) {
+    if (after.isSome() || limit.isSome() || jsonp.isSome()) {
+      return BadRequest(
+          "Streaming does not support 'after', 'limit' or 'jsonp'.\n");
+    }
+
+    return authorize(requestedPath, principal)
+      .then(defer(self(),
+          [this, requestedPath](bool authorized) -> Future<http::Response> {
+        if (!authorized) {
+          return Forbidden();
+        }
 
-  return browse(requestedPath, principal)
+        return __browse(requestedPath);
+      }));
+  }
+
+  return browse(requestedPath, principal, after, limit)
     .then([jsonp](const Try<list<FileInfo>, FilesError>& result)
       -> Future<http::Response> {
       if (result.isError()) {
@@ -407,13 +488,228 @@ Future<http::Response> FilesProcess::_browse(
 }
 
 
+// Returns the `FileInfo` of the entry `name` of the directory `dir`
+// (at `directory`, and at the virtual path `path`), or none if the
+// entry cannot be `stat`ed, e.g., because it has been removed since.
+static Option<FileInfo> statEntry(
+    DIR* dir,
+    const string& directory,
+    const string& path,
+    const string& name)
+{
+  struct stat s;
+
+#ifdef __WINDOWS__
+  const int result = ::stat(path::join(directory, name).c_str(), &s);
+#else
+  // We `stat` the entry relative to the directory so that the path of
+  // the directory is not resolved again for every entry.
+  const int result = ::fstatat(::dirfd(dir), name.c_str(), &s, 0);
+#endif // __WINDOWS__
+
+  if (result < 0) {
+    PLOG(WARNING) << "Found " << path::join(directory, name)
+                  << " in ls but stat failed";
+    return None();
+  }
+
+  return protobuf::createFileInfo(path::join(path, name), s);
+}
+
+
+// Reads the name of the next entry of the directory `dir`, skipping
+// `.` and `..`. Returns none once all entries have been read.
+static Result<string> readEntry(DIR* dir)
+{
+  while (true) {
+    errno = 0;
+
+    struct dirent* entry = ::readdir(dir);
+
+    if (entry == nullptr) {
+      if (errno != 0) {
+        return ErrnoError("Failed to read directory");
+      }
+
+      return None();
+    }
+
+    const string name = entry->d_name;
+
+    if (name != "." && name != "..") {
+      return name;
+    }
+  }
+}
+
+
+// Lists the entries of the directory at `directory` (at the virtual
+// path `path`) whose names sort after `after`, sorted by name, and at
+// most `limit` of them. Only the entries that are listed are `stat`ed
+// and kept in memory, so that listing a page of a large directory is
+// cheap.
+static Try<list<FileInfo>> ls(
+    const string& directory,
+    const string& path,
+    const Option<string>& after,
+    const Option<size_t>& limit)
+{
+  if (limit.isSome() && limit.get() == 0) {
+    return list<FileInfo>();
+  }
+
+  std::shared_ptr<DIR> dir(::opendir(directory.c_str()), ::closedir);
+
+  if (dir == nullptr) {
+    return ErrnoError("Failed to open directory");
+  }
+
+  // The smallest names (after `after`) seen so far.
+  set<string> names;
+
+  while (true) {
+    Result<string> name = readEntry(dir.get());
+
+    if (name.isError()) {
+      return Error(name.error());
+    } else if (name.isNone()) {
+      break;
+    }
+
+    if (after.isSome() && name.get() <= after.get()) {
+      continue;
+    }
+
+    if (limit.isSome() && names.size() == limit.get()) {
+      if (name.get() >= *names.rbegin()) {
+        continue;
+      }
+
+      names.erase(std::prev(names.end()));
+    }
+
+    names.insert(name.get());
+  }
+
+  list<FileInfo> listing;
+
+  foreach (const string& name, names) {
+    Option<FileInfo> fileInfo = statEntry(dir.get(), directory, path, name);
+
+    if (fileInfo.isSome()) {
+      listing.push_back(fileInfo.get());
+    }
+  }
+
+  return listing;
+}
+
+
+Future<http::Response> FilesProcess::__browse(const string& path)
+{
+  Result<string> resolvedPath = resolve(path);
+
+  if (resolvedPath.isError()) {
+    return BadRequest(resolvedPath.error() + ".\n");
+  } else if (resolvedPath.isNone()) {
+    return NotFound();
+  }
+
+  const string directory = resolvedPath.get();
+
+  std::shared_ptr<DIR> dir(::opendir(directory.c_str()), ::closedir);
+
+  if (dir == nullptr) {
+    string error = strings::format(
+        "Failed to open directory at '%s': %s",
+        directory,
+        os::strerror(errno)).get();
+    LOG(WARNING) << error;
+    return InternalServerError(error + ".\n");
+  }
+
+  // The number of entries that are read and `stat`ed at a time. The
+  // process handles other requests between the batches.
+  const size_t batch = 1024;
+
+  // The number of entries written so far.
+  std::shared_ptr<size_t> count(new size_t(0));
+
+  http::Pipe pipe;
+  http::Pipe::Writer writer = pipe.writer();
+
+  writer.write("[");
+
+  process::loop(
+      self(),
+      [=]() -> Future<Option<string>> {
+        string chunk;
+
+        for (size_t i = 0; i < batch; i++) {
+          Result<string> name = readEntry(dir.get());
+
+          if (name.isError()) {
+            return Failure(name.error());
+          } else if (name.isNone()) {
+            break;
+          }
+
+          Option<FileInfo> fileInfo =
+            statEntry(dir.get(), directory, path, name.get());
+
+          if (fileInfo.isSome()) {
+            if ((*count)++ > 0) {
+              chunk += ",";
+            }
+
+            chunk += stringify(model(fileInfo.get()));
+          }
+        }
+
+        if (chunk.empty()) {
+          return None(); // All entries have been written.
+        }
+
+        return chunk;
+      },
+      [=](const Option<string>& chunk) mutable -> ControlFlow<Nothing> {
+        if (chunk.isNone()) {
+          return Break();
+        }
+
+        if (!writer.write(chunk.get())) {
+          return Break(); // The client closed the connection.
+        }
+
+        return Continue();
+      })
+    .onAny([=](const Future<Nothing>& future) mutable {
+      if (future.isFailed()) {
+        writer.fail(future.failure());
+      } else {
+        writer.write("]");
+        writer.close();
+      }
+    });
+
+  OK response;
+  response.type = response.PIPE;
+  response.reader = pipe.reader();
+  response.headers["Content-Type"] = "application/json";
+
+  return response;
+}
+
+
 Future<Try<list<FileInfo>, FilesError>> FilesProcess::browse(
     const string& path,
-    const Option<string>& principal)
+    const Option<string>& principal,
+    const Option<string>& after,
+    const Option<size_t>& limit)
 {
   return authorize(path, principal)
     .then(defer(self(),
-        [this, path](bool authorized)
+        [this, path, after, limit](bool authorized)
           -> Future<Try<list<FileInfo>, FilesError>> {
       if (!authorized) {
         return FilesError(FilesError::Type::UNAUTHORIZED);
@@ -430,29 +726,18 @@ Future<Try<list<FileInfo>, FilesError>> FilesProcess::browse(
       }
 
       // The result will be a sorted (on path) list of files and dirs.
-      map<string, FileInfo> files;
-      Try<list<string>> entries = os::ls(resolvedPath.get());
-      if (entries.isSome()) {
-        foreach (const string& entry, entries.get()) {
-          struct stat s;
-          string fullPath = path::join(resolvedPath.get(), entry);
-
-          if (stat(fullPath.c_str(), &s) < 0) {
-            PLOG(WARNING) << "Found " << fullPath << " in ls but stat failed";
-            continue;
-          }
-
-          files[fullPath] =
-            protobuf::createFileInfo(path::join(path, entry), s);
-        }
-      }
-
-      list<FileInfo> listing;
-      foreachvalue (const FileInfo& fileInfo, files) {
-        listing.push_back(fileInfo);
+      // As before, a path that can not be listed (e.g., a file) has an
+      // empty listing.
+      Try<list<FileInfo>> listing =
+        ls(resolvedPath.get(), path, after, limit);
+
+      if (listing.isError()) {
+        VLOG(1) << "Failed to list '" << resolvedPath.get() << "': "
+                << listing.error();
+        return list<FileInfo>();
       }
 
-      return listing;
+      return listing.get();
     }));
 }
 
@@ -703,7 +988,11 @@ const string FilesProcess::DOWNLOAD_HELP = HELP(
         "",
         "Query parameters:",
         "",
-        ">        path=VALUE          The path of directory to browse."),
+        ">        path=VALUE          The path of directory to browse.",
+        "",
+        "A single byte range of the file can be requested through the",
+        "'Range' header (e.g., 'Range: bytes=1024-2047'), in which",
+        "case only that range is returned (206 Partial Content)."),
     AUTHENTICATION(true),
     AUTHORIZATION(
         "Downloading files requires that the request principal is",
@@ -775,6 +1064,200 @@ Future<http::Response> FilesProcess::_download(const string& path)
 }
 
 
+const string FilesProcess::FOLLOW_HELP = HELP(
+    TLDR(
+        "Streams the raw file contents for a given path."),
+    DESCRIPTION(
+        "This endpoint streams the raw file contents for the given",
+        "path, starting at the given offset. Unlike 'download', the",
+        "response does not end once the end of the file is reached,",
+        "but continues to stream any data that is appended to the",
+        "file until the client closes the connection.",
+        "",
+        "Query parameters:",
+        "",
+        ">        path=VALUE          The path of the file to follow.",
+        ">        offset=VALUE        Offset to start streaming from."),
+    AUTHENTICATION(true),
+    AUTHORIZATION(
+        "Following files requires that the request principal is",
+        "authorized to download the target virtual file path.",
+        "",
+        "See authorization documentation for details."));
+
+
+Future<http::Response> FilesProcess::follow(
+    const http::Request& request,
+    const Option<string>& principal)
+{
+  Option<string> path = request.url.query.get("path");
+
+  if (!path.isSome() || path.get().empty()) {
+    return BadRequest("Expecting 'path=value' in query.\n");
+  }
+
+  off_t offset = 0;
+
+  if (request.url.query.get("offset").isSome()) {
+    Try<off_t> result = numify<off_t>(request.url.query.get("offset").get());
+
+    if (result.isError() || result.get() < 0) {
+      return BadRequest(
+          "Failed to parse offset: " +
+          (result.isError() ? result.error()
+                            : "Offset must be non-negative") + ".\n");
+    }
+
+    offset = result.get();
+  }
+
+  string requestedPath = path.get();
+
+  return authorize(requestedPath, principal)
+    .then(defer(self(),
+        [this, path, offset](bool authorized) -> Future<http::Response> {
+      if (authorized) {
+        return _follow(path.get(), offset);
+      }
+
+      return Forbidden();
+    }));
+}
+
+
+Future<http::Response> FilesProcess::_follow(const string& path, off_t offset)
+{
+  Result<string> resolvedPath = resolve(path);
+
+  if (resolvedPath.isError()) {
+    return BadRequest(resolvedPath.error() + ".\n");
+  } else if (!resolvedPath.isSome()) {
+    return NotFound();
+  }
+
+  // Don't follow directories.
+  if (os::stat::isdir(resolvedPath.get())) {
+    return BadRequest("Cannot follow a directory.\n");
+  }
+
+  Try<int> fd = os::open(resolvedPath.get(), O_RDONLY | O_CLOEXEC);
+
+  if (fd.isError()) {
+    string error = strings::format(
+        "Failed to open file at '%s': %s",
+        resolvedPath.get(),
+        fd.error()).get();
+    LOG(WARNING) << error;
+    return InternalServerError(error + ".\n");
+  }
+
+  if (lseek(fd.get(), offset, SEEK_SET) == -1) {
+    string error = strings::format(
+        "Failed to seek file at '%s': %s",
+        resolvedPath.get(),
+        os::strerror(errno)).get();
+    LOG(WARNING) << error;
+    os::close(fd.get());
+    return InternalServerError(error + ".\n");
+  }
+
+  Try<Nothing> nonblock = os::nonblock(fd.get());
+  if (nonblock.isError()) {
+    string error =
+        "Failed to set file descriptor nonblocking: " + nonblock.error();
+    LOG(WARNING) << error;
+    os::close(fd.get());
+    return InternalServerError(error + ".\n");
+  }
+
+  // Once the end of the file is reached we wait for the file to be
+  // modified before reading again. On Linux we are notified of the
+  // modification through inotify, elsewhere (or if the watch can not
+  // be set up) we simply poll the file. We always wait at most one
+  // interval so that we notice when the client goes away.
+  const Duration interval = Seconds(1);
+
+  Option<int> watch = None();
+
+#ifdef __linux__
+  int inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (inotify == -1) {
+    LOG(WARNING) << "Failed to initialize inotify, polling '"
+                 << resolvedPath.get() << "' instead: "
+                 << os::strerror(errno);
+  } else if (inotify_add_watch(
+                 inotify, resolvedPath.get().c_str(), IN_MODIFY) == -1) {
+    LOG(WARNING) << "Failed to watch '" << resolvedPath.get()
+                 << "', polling instead: " << os::strerror(errno);
+    os::close(inotify);
+  } else {
+    watch = inotify;
+  }
+#endif // __linux__
+
+  const size_t length = os::pagesize() * 16;
+
+  boost::shared_array<char> data(new char[length]);
+  boost::shared_array<char> events(new char[length]);
+
+  http::Pipe pipe;
+  http::Pipe::Writer writer = pipe.writer();
+
+  process::loop(
+      self(),
+      [=]() {
+        return io::read(fd.get(), data.get(), length);
+      },
+      [=](size_t size) mutable -> Future<ControlFlow<Nothing>> {
+        if (size > 0) {
+          if (!writer.write(string(data.get(), size))) {
+            return Break(); // The client closed the connection.
+          }
+
+          return Continue();
+        }
+
+        if (writer.readerClosed().isReady()) {
+          return Break();
+        }
+
+        // NOTE: A default constructed future stays pending, so without
+        // a watch this just waits for the interval to elapse.
+        Future<Nothing> modified = watch.isSome()
+          ? io::read(watch.get(), events.get(), length)
+              .then([](size_t) { return Nothing(); })
+          : Future<Nothing>();
+
+        return modified
+          .after(interval, [](Future<Nothing> modified) {
+            modified.discard();
+            return Nothing();
+          })
+          .then([]() -> ControlFlow<Nothing> { return Continue(); });
+      })
+    .onAny([=](const Future<Nothing>& future) mutable {
+      if (future.isFailed()) {
+        writer.fail(future.failure());
+      } else {
+        writer.close();
+      }
+
+      os::close(fd.get());
+
+      if (watch.isSome()) {
+        os::close(watch.get());
+      }
+    });
+
+  OK response;
+  response.type = response.PIPE;
+  response.reader = pipe.reader();
+  response.headers["Content-Type"] = "application/octet-stream";
+
+  return response;
+}
+
+
 const string FilesProcess::DEBUG_HELP = HELP(
     TLDR(
         "Returns the internal virtual path mapping."),
@@ -916,9 +1399,12 @@ void Files::detach(const string& name)
 
 Future<Try<list<FileInfo>, FilesError>> Files::browse(
     const string& path,
-    const Option<string>& principal)
+    const Option<string>& principal,
+    const Option<string>& after,
+    const Option<size_t>& limit)
 {
-  return dispatch(process, &FilesProcess::browse, path, principal);
+  return dispatch(
+      process, &FilesProcess::browse, path, principal, after, limit);
 }
 
 
@@ -89,10 +89,15 @@ public:
   // Removes the specified name.
   void detach(const std::string& name);
 
-  // Returns a file listing for a directory similar to `ls -l`.
+  // Returns a file listing for a directory similar to `ls -l`, sorted
+  // by path. Optionally only lists (at most `limit` of) the entries
+  // whose names sort after `after`, e.g., to list a large directory
+  // page by page.
   process::Future<Try<std::list<FileInfo>, FilesError>> browse(
       const std::string& path,
-      const Option<std::string>& principal);
+      const Option<std::string>& principal,
+      const Option<std::string>& after = None(),
+      const Option<size_t>& limit = None());
 
   // Returns the size and data of file.
   process::Future<Try<std::tuple<size_t, std::string>, FilesError>> read(
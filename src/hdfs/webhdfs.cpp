@@ -0,0 +1,497 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <list>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <process/collect.hpp>
+#include <process/defer.hpp>
+#include <process/dispatch.hpp>
+#include <process/http.hpp>
+#include <process/id.hpp>
+#include <process/loop.hpp>
+#include <process/process.hpp>
+
+#include <stout/error.hpp>
+#include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/json.hpp>
+#include <stout/os.hpp>
+#include <stout/path.hpp>
+#include <stout/stringify.hpp>
+#include <stout/strings.hpp>
+
+#include <stout/os/close.hpp>
+#include <stout/os/open.hpp>
+#include <stout/os/write.hpp>
+
+#include "hdfs/webhdfs.hpp"
+
+namespace http = process::http;
+
+using std::list;
+using std::pair;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+using process::Break;
+using process::Continue;
+using process::ControlFlow;
+using process::Failure;
+using process::Future;
+using process::Owned;
+using process::Process;
+
+using process::defer;
+using process::loop;
+
+
+class WebHDFSProcess : public Process<WebHDFSProcess>
+{
+public:
+  WebHDFSProcess(
+      const http::URL& _url,
+      const Option<string>& _user,
+      size_t _parallelism)
+    : ProcessBase(process::ID::generate("webhdfs")),
+      url(_url),
+      user(_user),
+      parallelism(_parallelism) {}
+
+  virtual ~WebHDFSProcess() {}
+
+  Future<bool> exists(const string& path);
+  Future<Bytes> du(const string& path);
+  Future<Nothing> copyToLocal(const string& from, const string& to);
+
+private:
+  // The parts of a `FileStatus` of the WebHDFS API that we use.
+  struct FileStatus
+  {
+    bool directory;
+    Bytes length;
+    Bytes blockSize;
+  };
+
+  // Returns the URL of the operation on the given path.
+  http::URL operation(
+      const string& path,
+      const string& op,
+      const hashmap<string, string>& parameters = {}) const;
+
+  Future<Option<FileStatus>> status(const string& path);
+
+  // Copies `length` bytes at `offset` of the file to the same position
+  // in the local file, which must exist.
+  Future<Nothing> copyRange(
+      const string& from,
+      const string& to,
+      size_t offset,
+      size_t length);
+
+  // Writes the body of the response to the local file at `offset`,
+  // as it is received.
+  Future<Nothing> write(
+      const http::Response& response,
+      const string& to,
+      size_t offset,
+      size_t length);
+
+  const http::URL url;
+  const Option<string> user;
+  const size_t parallelism;
+};
+
+
+static string failure(const http::Response& response)
+{
+  string message = "Unexpected response '" + response.status + "'";
+
+  if (response.type == http::Response::BODY && !response.body.empty()) {
+    message += ": " + response.body;
+  }
+
+  return message;
+}
+
+
+http::URL WebHDFSProcess::operation(
+    const string& path,
+    const string& op,
+    const hashmap<string, string>& parameters) const
+{
+  vector<string> segments;
+  foreach (const string& segment, strings::tokenize(path, "/")) {
+    segments.push_back(http::encode(segment));
+  }
+
+  http::URL result = url;
+  result.path = path::join(
+      url.path, "webhdfs", "v1", strings::join("/", segments));
+
+  result.query = parameters;
+  result.query["op"] = op;
+
+  if (user.isSome()) {
+    result.query["user.name"] = user.get();
+  }
+
+  return result;
+}
+
+
+Future<Option<WebHDFSProcess::FileStatus>> WebHDFSProcess::status(
+    const string& path)
+{
+  return http::get(operation(path, "GETFILESTATUS"))
+    .then([](const http::Response& response) -> Future<Option<FileStatus>> {
+      if (response.code == http::Status::NOT_FOUND) {
+        return None();
+      }
+
+      if (response.code != http::Status::OK) {
+        return Failure(failure(response));
+      }
+
+      Try<JSON::Object> object = JSON::parse<JSON::Object>(response.body);
+      if (object.isError()) {
+        return Failure("Failed to parse the file status: " + object.error());
+      }
+
+      Result<JSON::String> type =
+        object->find<JSON::String>("FileStatus.type");
+      Result<JSON::Number> length =
+        object->find<JSON::Number>("FileStatus.length");
+      Result<JSON::Number> blockSize =
+        object->find<JSON::Number>("FileStatus.blockSize");
+
+      if (!type.isSome() || !length.isSome()) {
+        return Failure("Unexpected file status: " + response.body);
+      }
+
+      FileStatus status;
+      status.directory = type->value == "DIRECTORY";
+      status.length = Bytes(length->as<uint64_t>());
+      status.blockSize =
+        Bytes(blockSize.isSome() ? blockSize->as<uint64_t>() : 0);
+
+      return status;
+    });
+}
+
+
+Future<bool> WebHDFSProcess::exists(const string& path)
+{
+  return status(path)
+    .then([](const Option<FileStatus>& status) {
+      return status.isSome();
+    });
+}
+
+
+Future<Bytes> WebHDFSProcess::du(const string& path)
+{
+  return http::get(operation(path, "GETCONTENTSUMMARY"))
+    .then([](const http::Response& response) -> Future<Bytes> {
+      if (response.code != http::Status::OK) {
+        return Failure(failure(response));
+      }
+
+      Try<JSON::Object> object = JSON::parse<JSON::Object>(response.body);
+      if (object.isError()) {
+        return Failure(
+            "Failed to parse the content summary: " + object.error());
+      }
+
+      Result<JSON::Number> length =
+        object->find<JSON::Number>("ContentSummary.length");
+
+      if (!length.isSome()) {
+        return Failure("Unexpected content summary: " + response.body);
+      }
+
+      return Bytes(length->as<uint64_t>());
+    });
+}
+
+
+Future<Nothing> WebHDFSProcess::copyToLocal(
+    const string& from,
+    const string& to)
+{
+  return status(from)
+    .then(defer(self(), [=](const Option<FileStatus>& status)
+        -> Future<Nothing> {
+      if (status.isNone()) {
+        return Failure("Failed to find '" + from + "'");
+      }
+
+      if (status->directory) {
+        return Failure("'" + from + "' is a directory");
+      }
+
+      // Create the local file, so that the blocks can be written to it
+      // in any order.
+      Try<int> fd = os::open(
+          to,
+          O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+          S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+
+      if (fd.isError()) {
+        return Failure("Failed to create '" + to + "': " + fd.error());
+      }
+
+      os::close(fd.get());
+
+      // Read the file one block at a time, so that the reads of the
+      // blocks are spread over the DataNodes that store them.
+      const uint64_t length = status->length.bytes();
+      const uint64_t blockSize = status->blockSize.bytes() > 0
+        ? status->blockSize.bytes()
+        : std::max<uint64_t>(length, 1);
+
+      shared_ptr<vector<pair<size_t, size_t>>> blocks(
+          new vector<pair<size_t, size_t>>());
+
+      for (uint64_t offset = 0; offset < length; offset += blockSize) {
+        blocks->push_back({offset, std::min(blockSize, length - offset)});
+      }
+
+      // The index of the next block to read, shared by the readers.
+      shared_ptr<size_t> next(new size_t(0));
+
+      list<Future<Nothing>> readers;
+      for (size_t i = 0; i < std::min(parallelism, blocks->size()); i++) {
+        readers.push_back(loop(
+            self(),
+            [=]() -> Option<pair<size_t, size_t>> {
+              if (*next == blocks->size()) {
+                return None();
+              }
+
+              return blocks->at((*next)++);
+            },
+            [=](const Option<pair<size_t, size_t>>& block)
+                -> Future<ControlFlow<Nothing>> {
+              if (block.isNone()) {
+                return Break();
+              }
+
+              return copyRange(from, to, block->first, block->second)
+                .then([]() -> ControlFlow<Nothing> { return Continue(); });
+            }));
+      }
+
+      return process::collect(readers)
+        .then([]() { return Nothing(); });
+    }));
+}
+
+
+Future<Nothing> WebHDFSProcess::copyRange(
+    const string& from,
+    const string& to,
+    size_t offset,
+    size_t length)
+{
+  const http::URL url = operation(
+      from,
+      "OPEN",
+      {{"offset", stringify(offset)}, {"length", stringify(length)}});
+
+  return http::streaming::get(url)
+    .then(defer(self(), [=](const http::Response& response)
+        -> Future<Nothing> {
+      if (response.code == http::Status::OK) {
+        return write(response, to, offset, length);
+      }
+
+      // The NameNode redirects reads to a DataNode that stores the
+      // block, whereas HttpFS serves them directly.
+      if (response.code != http::Status::TEMPORARY_REDIRECT) {
+        if (response.reader.isSome()) {
+          http::Pipe::Reader reader = response.reader.get();
+          reader.close();
+        }
+
+        return Failure(failure(response));
+      }
+
+      if (response.reader.isSome()) {
+        http::Pipe::Reader reader = response.reader.get();
+        reader.close();
+      }
+
+      Option<string> location = response.headers.get("Location");
+      if (location.isNone()) {
+        return Failure("Missing 'Location' header in the redirect");
+      }
+
+      // NOTE: `URL::parse()` does not parse the query.
+      const vector<string> parts = strings::split(location.get(), "?", 2);
+
+      Try<http::URL> redirect = http::URL::parse(parts[0]);
+      if (redirect.isError()) {
+        return Failure(
+            "Failed to parse the redirect to '" + location.get() + "': " +
+            redirect.error());
+      }
+
+      if (parts.size() == 2) {
+        Try<hashmap<string, string>> query = http::query::decode(parts[1]);
+        if (query.isError()) {
+          return Failure(
+              "Failed to parse the redirect to '" + location.get() + "': " +
+              query.error());
+        }
+
+        redirect->query = query.get();
+      }
+
+      return http::streaming::get(redirect.get())
+        .then(defer(self(), [=](const http::Response& response)
+            -> Future<Nothing> {
+          if (response.code != http::Status::OK) {
+            if (response.reader.isSome()) {
+              http::Pipe::Reader reader = response.reader.get();
+              reader.close();
+            }
+
+            return Failure(failure(response));
+          }
+
+          return write(response, to, offset, length);
+        }));
+    }));
+}
+
+
+Future<Nothing> WebHDFSProcess::write(
+    const http::Response& response,
+    const string& to,
+    size_t offset,
+    size_t length)
+{
+  CHECK_SOME(response.reader);
+
+  http::Pipe::Reader reader = response.reader.get();
+
+  Try<int> fd = os::open(to, O_WRONLY | O_CLOEXEC);
+  if (fd.isError()) {
+    reader.close();
+    return Failure("Failed to open '" + to + "': " + fd.error());
+  }
+
+  if (::lseek(fd.get(), offset, SEEK_SET) < 0) {
+    ErrnoError error("Failed to seek in '" + to + "'");
+    os::close(fd.get());
+    reader.close();
+    return Failure(error);
+  }
+
+  shared_ptr<size_t> written(new size_t(0));
+
+  return loop(
+      self(),
+      [=]() mutable {
+        return reader.read();
+      },
+      [=](const string& data) mutable -> Future<ControlFlow<Nothing>> {
+        if (data.empty()) {
+          if (*written != length) {
+            return Failure(
+                "Expected " + stringify(length) + " bytes at offset " +
+                stringify(offset) + " but received " + stringify(*written));
+          }
+
+          return Break();
+        }
+
+        Try<Nothing> write = os::write(fd.get(), data);
+        if (write.isError()) {
+          return Failure(
+              "Failed to write to '" + to + "': " + write.error());
+        }
+
+        *written += data.size();
+
+        return Continue();
+      })
+    .onAny([=](const Future<Nothing>&) mutable {
+      reader.close();
+      os::close(fd.get());
+    });
+}
+
+
+Try<Owned<WebHDFS>> WebHDFS::create(
+    const string& url,
+    const Option<string>& user,
+    size_t parallelism)
+{
+  Try<http::URL> _url = http::URL::parse(url);
+  if (_url.isError()) {
+    return Error("Failed to parse '" + url + "': " + _url.error());
+  }
+
+  if (parallelism == 0) {
+    return Error("The parallelism must be positive");
+  }
+
+  return Owned<WebHDFS>(new WebHDFS(
+      Owned<WebHDFSProcess>(
+          new WebHDFSProcess(_url.get(), user, parallelism))));
+}
+
+
+WebHDFS::WebHDFS(Owned<WebHDFSProcess> _process)
+  : process(_process)
+{
+  spawn(process.get());
+}
+
+
+WebHDFS::~WebHDFS()
+{
+  terminate(process.get());
+  wait(process.get());
+}
+
+
+Future<bool> WebHDFS::exists(const string& path)
+{
+  return dispatch(process.get(), &WebHDFSProcess::exists, path);
+}
+
+
+Future<Bytes> WebHDFS::du(const string& path)
+{
+  return dispatch(process.get(), &WebHDFSProcess::du, path);
+}
+
+
+Future<Nothing> WebHDFS::copyToLocal(const string& from, const string& to)
+{
+  return dispatch(process.get(), &WebHDFSProcess::copyToLocal, from, to);
+}
@@ -0,0 +1,75 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __WEBHDFS_HPP__
+#define __WEBHDFS_HPP__
+
+#include <string>
+
+#include <process/future.hpp>
+#include <process/owned.hpp>
+
+#include <stout/bytes.hpp>
+#include <stout/none.hpp>
+#include <stout/nothing.hpp>
+#include <stout/option.hpp>
+#include <stout/try.hpp>
+
+// Forward declaration.
+class WebHDFSProcess;
+
+
+// A client for the REST API of HDFS, as served by the NameNode
+// (WebHDFS) or by an HttpFS gateway. Unlike `HDFS`, this does not start
+// a hadoop client (and thus a JVM) for every operation.
+//
+// Files are copied by reading their blocks in parallel, each of them
+// from the DataNode the NameNode redirects to, and writing each block
+// to its position in the local file as it is received.
+//
+// NOTE: Only "simple" authentication is supported, i.e., the user is
+// passed as the `user.name` parameter. Clusters secured by Kerberos
+// without HTTP SPNEGO need to be accessed using `HDFS`.
+class WebHDFS
+{
+public:
+  // Creates a client for the given URL of the WebHDFS or HttpFS server
+  // (e.g., `http://namenode:9870`), which reads up to `parallelism`
+  // blocks of a file at a time when copying it.
+  static Try<process::Owned<WebHDFS>> create(
+      const std::string& url,
+      const Option<std::string>& user = None(),
+      size_t parallelism = 4);
+
+  ~WebHDFS();
+
+  process::Future<bool> exists(const std::string& path);
+  process::Future<Bytes> du(const std::string& path);
+
+  process::Future<Nothing> copyToLocal(
+      const std::string& from,
+      const std::string& to);
+
+private:
+  explicit WebHDFS(process::Owned<WebHDFSProcess> process);
+
+  WebHDFS(const WebHDFS&) = delete;
+  WebHDFS& operator=(const WebHDFS&) = delete;
+
+  process::Owned<WebHDFSProcess> process;
+};
+
+#endif // __WEBHDFS_HPP__
@@ -23,13 +23,23 @@
 
 #include <mesos/module/hook.hpp>
 
+#include <process/async.hpp>
 #include <process/collect.hpp>
 #include <process/future.hpp>
+#include <process/owned.hpp>
+
+#include <process/metrics/counter.hpp>
+#include <process/metrics/metrics.hpp>
+#include <process/metrics/timer.hpp>
 
 #include <stout/check.hpp>
+#include <stout/duration.hpp>
 #include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/lambda.hpp>
 #include <stout/linkedhashmap.hpp>
 #include <stout/nothing.hpp>
+#include <stout/stringify.hpp>
 #include <stout/strings.hpp>
 #include <stout/try.hpp>
 
@@ -41,21 +51,141 @@ using std::map;
 using std::string;
 using std::vector;
 
+using process::await;
 using process::collect;
 using process::Future;
+using process::Owned;
+
+using process::metrics::Counter;
+using process::metrics::Timer;
 
 using mesos::modules::ModuleManager;
 
 namespace mesos {
 namespace internal {
 
+// The latency and the timeouts of the asynchronous hooks of a module.
+struct HookMetrics
+{
+  explicit HookMetrics(const string& name)
+    : master_launch_task_label_decorator(
+          "hooks/" + name + "/master_launch_task_label_decorator"),
+      slave_run_task_label_decorator(
+          "hooks/" + name + "/slave_run_task_label_decorator"),
+      slave_executor_environment_decorator(
+          "hooks/" + name + "/slave_executor_environment_decorator"),
+      timeouts("hooks/" + name + "/timeouts")
+  {
+    process::metrics::add(master_launch_task_label_decorator);
+    process::metrics::add(slave_run_task_label_decorator);
+    process::metrics::add(slave_executor_environment_decorator);
+    process::metrics::add(timeouts);
+  }
+
+  ~HookMetrics()
+  {
+    process::metrics::remove(master_launch_task_label_decorator);
+    process::metrics::remove(slave_run_task_label_decorator);
+    process::metrics::remove(slave_executor_environment_decorator);
+    process::metrics::remove(timeouts);
+  }
+
+  Timer<Milliseconds> master_launch_task_label_decorator;
+  Timer<Milliseconds> slave_run_task_label_decorator;
+  Timer<Milliseconds> slave_executor_environment_decorator;
+
+  Counter timeouts;
+};
+
+
 static std::mutex mutex;
 static LinkedHashMap<string, Hook*> availableHooks;
+static Duration hookTimeout = DEFAULT_HOOK_TIMEOUT;
+
+// NOTE: This is intentionally leaked so that the metrics are not
+// removed during static destruction, when libprocess might already
+// have been finalized.
+static hashmap<string, Owned<HookMetrics>>* hookMetrics =
+  new hashmap<string, Owned<HookMetrics>>();
+
+
+// Invokes `f` with every hook module concurrently, each on its own
+// thread, and returns the successful results in the order in which
+// the modules were loaded. Errors and timeouts are logged using
+// `description` and yield `None()`.
+template <typename T>
+static Future<list<Option<T>>> invokeAsync(
+    const string& description,
+    Timer<Milliseconds> HookMetrics::*timer,
+    const lambda::function<Result<T>(Hook*)>& f)
+{
+  vector<string> names;
+  list<Future<Result<T>>> futures;
+
+  synchronized (mutex) {
+    const Duration timeout = hookTimeout;
+
+    foreachpair (const string& name, Hook* hook, availableHooks) {
+      Owned<HookMetrics> metrics = hookMetrics->at(name);
+
+      // NOTE: We time the invocation itself rather than the future
+      // returned below, so that the latency of modules which time out
+      // is still recorded once they return.
+      Future<Result<T>> invocation =
+        ((*metrics).*timer).time(process::async(f, hook));
+
+      names.push_back(name);
+      futures.push_back(invocation.after(
+          timeout,
+          [=](Future<Result<T>> future) -> Future<Result<T>> {
+            // NOTE: This does not interrupt the module, which keeps
+            // running on its thread; we merely stop waiting for it.
+            future.discard();
+            ++metrics->timeouts;
+
+            return Result<T>(Error("Timed out after " + stringify(timeout)));
+          }));
+    }
+  }
 
+  return await(futures)
+    .then([=](const list<Future<Result<T>>>& invocations) {
+      list<Option<T>> results;
 
-Try<Nothing> HookManager::initialize(const string& hookList)
+      auto name = names.begin();
+      foreach (const Future<Result<T>>& future, invocations) {
+        Result<T> result = None();
+
+        if (future.isReady()) {
+          result = future.get();
+        } else {
+          result = Error(
+              future.isFailed() ? future.failure() : "Discarded");
+        }
+
+        if (result.isError()) {
+          LOG(WARNING) << description << " hook failed for module '"
+                       << *name << "': " << result.error();
+        }
+
+        results.push_back(
+            result.isSome() ? Option<T>(result.get()) : Option<T>::none());
+
+        ++name;
+      }
+
+      return results;
+    });
+}
+
+
+Try<Nothing> HookManager::initialize(
+    const string& hookList,
+    const Duration& timeout)
 {
   synchronized (mutex) {
+    hookTimeout = timeout;
+
     const vector<string> hooks = strings::split(hookList, ",");
     foreach (const string& hook, hooks) {
       if (availableHooks.contains(hook)) {
@@ -76,6 +206,7 @@ Try<Nothing> HookManager::initialize(const string& hookList)
 
       // Add the hook module to the list of available hooks.
       availableHooks[hook] = module.get();
+      hookMetrics->put(hook, Owned<HookMetrics>(new HookMetrics(hook)));
     }
   }
 
@@ -93,6 +224,7 @@ Try<Nothing> HookManager::unload(const string& hookName)
 
     // Now remove the hook from the list of available hooks.
     availableHooks.erase(hookName);
+    hookMetrics->erase(hookName);
   }
 
   return Nothing();
@@ -204,6 +336,88 @@ Environment HookManager::slaveExecutorEnvironmentDecorator(
 }
 
 
+Future<Labels> HookManager::masterLaunchTaskLabelDecoratorAsync(
+    const TaskInfo& taskInfo,
+    const FrameworkInfo& frameworkInfo,
+    const SlaveInfo& slaveInfo)
+{
+  return invokeAsync<Labels>(
+      "Master label decorator",
+      &HookMetrics::master_launch_task_label_decorator,
+      [=](Hook* hook) {
+        return hook->masterLaunchTaskLabelDecorator(
+            taskInfo, frameworkInfo, slaveInfo);
+      })
+    .then([=](const list<Option<Labels>>& results) {
+      // NOTE: If every hook returns None(), the task labels won't be
+      // changed. Otherwise the module loaded last takes priority.
+      Labels labels = taskInfo.labels();
+
+      foreach (const Option<Labels>& result, results) {
+        if (result.isSome()) {
+          labels = result.get();
+        }
+      }
+
+      return labels;
+    });
+}
+
+
+Future<Labels> HookManager::slaveRunTaskLabelDecoratorAsync(
+    const TaskInfo& taskInfo,
+    const ExecutorInfo& executorInfo,
+    const FrameworkInfo& frameworkInfo,
+    const SlaveInfo& slaveInfo)
+{
+  return invokeAsync<Labels>(
+      "Agent label decorator",
+      &HookMetrics::slave_run_task_label_decorator,
+      [=](Hook* hook) {
+        return hook->slaveRunTaskLabelDecorator(
+            taskInfo, executorInfo, frameworkInfo, slaveInfo);
+      })
+    .then([=](const list<Option<Labels>>& results) {
+      // NOTE: If every hook returns None(), the task labels won't be
+      // changed. Otherwise the module loaded last takes priority.
+      Labels labels = taskInfo.labels();
+
+      foreach (const Option<Labels>& result, results) {
+        if (result.isSome()) {
+          labels = result.get();
+        }
+      }
+
+      return labels;
+    });
+}
+
+
+Future<Environment> HookManager::slaveExecutorEnvironmentDecoratorAsync(
+    const ExecutorInfo& executorInfo)
+{
+  return invokeAsync<Environment>(
+      "Agent environment decorator",
+      &HookMetrics::slave_executor_environment_decorator,
+      [=](Hook* hook) {
+        return hook->slaveExecutorEnvironmentDecorator(executorInfo);
+      })
+    .then([=](const list<Option<Environment>>& results) {
+      // NOTE: If every hook returns None(), the environment won't be
+      // changed. Otherwise the module loaded last takes priority.
+      Environment environment = executorInfo.command().environment();
+
+      foreach (const Option<Environment>& result, results) {
+        if (result.isSome()) {
+          environment = result.get();
+        }
+      }
+
+      return environment;
+    });
+}
+
+
 Future<DockerTaskExecutorPrepareInfo>
   HookManager::slavePreLaunchDockerTaskExecutorDecorator(
       const Option<TaskInfo>& taskInfo,
@@ -24,15 +24,26 @@
 
 #include <process/future.hpp>
 
+#include <stout/duration.hpp>
 #include <stout/try.hpp>
 
 namespace mesos {
 namespace internal {
 
+// How long the asynchronous hooks of a single module may take before
+// their result is ignored, see `HookManager::initialize`.
+constexpr Duration DEFAULT_HOOK_TIMEOUT = Seconds(30);
+
+
 class HookManager
 {
 public:
-  static Try<Nothing> initialize(const std::string& hookList);
+  // Loads the comma separated list of hook modules. The `timeout`
+  // bounds each module's invocation of an asynchronous hook (see
+  // below); the synchronous hooks are not bounded.
+  static Try<Nothing> initialize(
+      const std::string& hookList,
+      const Duration& timeout = DEFAULT_HOOK_TIMEOUT);
 
   // Exposed just for testing so that we can unload a given
   // hook and remove it from the list of available hooks.
@@ -56,6 +67,37 @@ public:
   static Environment slaveExecutorEnvironmentDecorator(
       ExecutorInfo executorInfo);
 
+  // Asynchronous variants of the decorators above. Rather than
+  // chaining the modules within the calling actor, each module is
+  // invoked on its own thread (see `process::async`) and all of them
+  // run concurrently, so a slow module (e.g., one calling out to an
+  // external service) neither blocks the caller nor the other modules.
+  //
+  // Since the modules run concurrently, each of them sees the original
+  // arguments rather than the output of the previously loaded module;
+  // if several modules return a decoration, the module loaded last
+  // takes priority. A module which returns an error, or which does not
+  // return within the timeout passed to `initialize`, leaves the
+  // decoration unchanged. The latency of every module is exported as
+  // `hooks/<module>/<hook>_ms` and the number of timed out invocations
+  // as `hooks/<module>/timeouts`.
+  //
+  // NOTE: Modules must support being invoked concurrently with
+  // themselves when the asynchronous variants are used.
+  static process::Future<Labels> masterLaunchTaskLabelDecoratorAsync(
+      const TaskInfo& taskInfo,
+      const FrameworkInfo& frameworkInfo,
+      const SlaveInfo& slaveInfo);
+
+  static process::Future<Labels> slaveRunTaskLabelDecoratorAsync(
+      const TaskInfo& taskInfo,
+      const ExecutorInfo& executorInfo,
+      const FrameworkInfo& frameworkInfo,
+      const SlaveInfo& slaveInfo);
+
+  static process::Future<Environment> slaveExecutorEnvironmentDecoratorAsync(
+      const ExecutorInfo& executorInfo);
+
   static process::Future<DockerTaskExecutorPrepareInfo>
     slavePreLaunchDockerTaskExecutorDecorator(
         const Option<TaskInfo>& taskInfo,
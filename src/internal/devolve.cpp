@@ -70,13 +70,21 @@ Credential devolve(const v1::Credential& credential)
 
 ExecutorID devolve(const v1::ExecutorID& executorId)
 {
-  return devolve<ExecutorID>(executorId);
+  // NOTE: Converted directly for performance, see
+  // 'devolve(const v1::AgentID&)'.
+  ExecutorID id;
+  id.set_value(executorId.value());
+  return id;
 }
 
 
 FrameworkID devolve(const v1::FrameworkID& frameworkId)
 {
-  return devolve<FrameworkID>(frameworkId);
+  // NOTE: Converted directly for performance, see
+  // 'devolve(const v1::AgentID&)'.
+  FrameworkID id;
+  id.set_value(frameworkId.value());
+  return id;
 }
 
 
@@ -144,7 +152,11 @@ SlaveInfo devolve(const v1::AgentInfo& agentInfo)
 
 TaskID devolve(const v1::TaskID& taskId)
 {
-  return devolve<TaskID>(taskId);
+  // NOTE: Converted directly for performance, see
+  // 'devolve(const v1::AgentID&)'.
+  TaskID id;
+  id.set_value(taskId.value());
+  return id;
 }
 
 
@@ -76,12 +76,14 @@ mesos::master::Call devolve(const v1::master::Call& call);
 // Helper for repeated field devolving to 'T1' from 'T2'.
 template <typename T1, typename T2>
 google::protobuf::RepeatedPtrField<T1> devolve(
-    google::protobuf::RepeatedPtrField<T2> t2s)
+    const google::protobuf::RepeatedPtrField<T2>& t2s)
 {
   google::protobuf::RepeatedPtrField<T1> t1s;
+  t1s.Reserve(t2s.size());
 
   foreach (const T2& t2, t2s) {
-    t1s.Add()->CopyFrom(devolve(t2));
+    T1 t1 = devolve(t2);
+    t1s.Add()->Swap(&t1);
   }
 
   return t1s;
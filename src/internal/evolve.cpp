@@ -25,6 +25,7 @@
 #include <process/pid.hpp>
 
 #include <stout/check.hpp>
+#include <stout/foreach.hpp>
 #include <stout/json.hpp>
 #include <stout/protobuf.hpp>
 
@@ -42,12 +43,13 @@ namespace mesos {
 namespace internal {
 
 // Helper for evolving a type by serializing/parsing when the types
-// have not changed across versions.
-template <typename T>
-static T evolve(const google::protobuf::Message& message)
+// have not changed across versions. Parsing directly into `t` lets
+// callers evolve into a field of a larger message without copying a
+// temporary into it.
+static void evolve(
+    const google::protobuf::Message& message,
+    google::protobuf::Message* t)
 {
-  T t;
-
   string data;
 
   // NOTE: We need to use 'SerializePartialToString' instead of
@@ -55,15 +57,22 @@ static T evolve(const google::protobuf::Message& message)
   // and we don't want an exception to get thrown.
   CHECK(message.SerializePartialToString(&data))
     << "Failed to serialize " << message.GetTypeName()
-    << " while evolving to " << t.GetTypeName();
+    << " while evolving to " << t->GetTypeName();
 
   // NOTE: We need to use 'ParsePartialFromString' instead of
   // 'ParseFromString' because some required fields might not
   // be set and we don't want an exception to get thrown.
-  CHECK(t.ParsePartialFromString(data))
-    << "Failed to parse " << t.GetTypeName()
+  CHECK(t->ParsePartialFromString(data))
+    << "Failed to parse " << t->GetTypeName()
     << " while evolving from " << message.GetTypeName();
+}
+
 
+template <typename T>
+static T evolve(const google::protobuf::Message& message)
+{
+  T t;
+  evolve(message, &t);
   return t;
 }
 
@@ -88,7 +97,11 @@ v1::AgentInfo evolve(const SlaveInfo& slaveInfo)
 
 v1::ExecutorID evolve(const ExecutorID& executorId)
 {
-  return evolve<v1::ExecutorID>(executorId);
+  // NOTE: Converted directly for performance, see
+  // 'evolve(const SlaveID&)'.
+  v1::ExecutorID id;
+  id.set_value(executorId.value());
+  return id;
 }
 
 
@@ -106,7 +119,11 @@ v1::FileInfo evolve(const FileInfo& fileInfo)
 
 v1::FrameworkID evolve(const FrameworkID& frameworkId)
 {
-  return evolve<v1::FrameworkID>(frameworkId);
+  // NOTE: Converted directly for performance, see
+  // 'evolve(const SlaveID&)'.
+  v1::FrameworkID id;
+  id.set_value(frameworkId.value());
+  return id;
 }
 
 
@@ -148,7 +165,11 @@ v1::Offer evolve(const Offer& offer)
 
 v1::OfferID evolve(const OfferID& offerId)
 {
-  return evolve<v1::OfferID>(offerId);
+  // NOTE: Converted directly for performance, see
+  // 'evolve(const SlaveID&)'.
+  v1::OfferID id;
+  id.set_value(offerId.value());
+  return id;
 }
 
 
@@ -173,7 +194,11 @@ v1::Task evolve(const Task& task)
 
 v1::TaskID evolve(const TaskID& taskId)
 {
-  return evolve<v1::TaskID>(taskId);
+  // NOTE: Converted directly for performance, see
+  // 'evolve(const SlaveID&)'.
+  v1::TaskID id;
+  id.set_value(taskId.value());
+  return id;
 }
 
 
@@ -207,6 +232,12 @@ v1::agent::Response evolve(const mesos::agent::Response& response)
 }
 
 
+v1::agent::Event evolve(const mesos::agent::Event& event)
+{
+  return evolve<v1::agent::Event>(event);
+}
+
+
 v1::maintenance::ClusterStatus evolve(const maintenance::ClusterStatus& status)
 {
   return evolve<v1::maintenance::ClusterStatus>(status);
@@ -323,8 +354,12 @@ v1::scheduler::Event evolve(const InverseOffersMessage& message)
   v1::scheduler::Event::InverseOffers* inverse_offers =
     event.mutable_inverse_offers();
 
-  inverse_offers->mutable_inverse_offers()->CopyFrom(evolve<v1::InverseOffer>(
-      message.inverse_offers()));
+  inverse_offers->mutable_inverse_offers()->Reserve(
+      message.inverse_offers().size());
+
+  foreach (const InverseOffer& inverseOffer, message.inverse_offers()) {
+    evolve(inverseOffer, inverse_offers->add_inverse_offers());
+  }
 
   return event;
 }
@@ -348,7 +383,11 @@ v1::scheduler::Event evolve(const ResourceOffersMessage& message)
   event.set_type(v1::scheduler::Event::OFFERS);
 
   v1::scheduler::Event::Offers* offers = event.mutable_offers();
-  offers->mutable_offers()->CopyFrom(evolve<v1::Offer>(message.offers()));
+  offers->mutable_offers()->Reserve(message.offers().size());
+
+  foreach (const Offer& offer, message.offers()) {
+    evolve(offer, offers->add_offers());
+  }
 
   return event;
 }
@@ -389,7 +428,7 @@ v1::scheduler::Event evolve(const StatusUpdateMessage& message)
 
   v1::scheduler::Event::Update* update = event.mutable_update();
 
-  update->mutable_status()->CopyFrom(evolve(message.update().status()));
+  evolve(message.update().status(), update->mutable_status());
 
   if (message.update().has_slave_id()) {
     update->mutable_status()->mutable_agent_id()->CopyFrom(
@@ -423,6 +462,27 @@ v1::scheduler::Event evolve(const StatusUpdateMessage& message)
 }
 
 
+v1::scheduler::Event evolve(const StatusUpdatesMessage& message)
+{
+  v1::scheduler::Event event;
+  event.set_type(v1::scheduler::Event::UPDATES);
+
+  v1::scheduler::Event::Updates* updates = event.mutable_updates();
+
+  // Each status is evolved as it would be for a `StatusUpdateMessage`
+  // with the same 'pid'.
+  foreach (const StatusUpdate& update, message.updates()) {
+    StatusUpdateMessage message_;
+    message_.mutable_update()->CopyFrom(update);
+    message_.set_pid(message.pid());
+
+    updates->add_statuses()->CopyFrom(evolve(message_).update().status());
+  }
+
+  return event;
+}
+
+
 v1::executor::Call evolve(const executor::Call& call)
 {
   return evolve<v1::executor::Call>(call);
@@ -492,7 +552,7 @@ v1::executor::Event evolve(const RunTaskMessage& message)
 
   v1::executor::Event::Launch* launch = event.mutable_launch();
 
-  launch->mutable_task()->CopyFrom(evolve(message.task()));
+  evolve(message.task(), launch->mutable_task());
 
   return event;
 }
@@ -523,6 +583,29 @@ v1::executor::Event evolve(
 }
 
 
+v1::executor::Event evolve(
+    const StatusUpdateAcknowledgementsMessage& message)
+{
+  v1::executor::Event event;
+  event.set_type(v1::executor::Event::ACKNOWLEDGEMENTS);
+
+  v1::executor::Event::Acknowledgements* acknowledgements =
+    event.mutable_acknowledgements();
+
+  foreach (const StatusUpdateAcknowledgementMessage& acknowledgement,
+           message.acknowledgements()) {
+    v1::executor::Event::Acknowledged* acknowledged =
+      acknowledgements->add_acknowledgements();
+
+    acknowledged->mutable_task_id()->CopyFrom(
+        evolve(acknowledgement.task_id()));
+    acknowledged->set_uuid(acknowledgement.uuid());
+  }
+
+  return event;
+}
+
+
 v1::master::Event evolve(const mesos::master::Event& event)
 {
   return evolve<v1::master::Event>(event);
@@ -79,6 +79,7 @@ v1::TaskStatus evolve(const TaskStatus& status);
 v1::agent::Call evolve(const mesos::agent::Call& call);
 v1::agent::ProcessIO evolve(const mesos::agent::ProcessIO& processIO);
 v1::agent::Response evolve(const mesos::agent::Response& response);
+v1::agent::Event evolve(const mesos::agent::Event& event);
 
 v1::maintenance::ClusterStatus evolve(
     const maintenance::ClusterStatus& cluster);
@@ -92,12 +93,14 @@ v1::scheduler::Call evolve(const scheduler::Call& call);
 // Helper for repeated field evolving to 'T1' from 'T2'.
 template <typename T1, typename T2>
 google::protobuf::RepeatedPtrField<T1> evolve(
-    google::protobuf::RepeatedPtrField<T2> t2s)
+    const google::protobuf::RepeatedPtrField<T2>& t2s)
 {
   google::protobuf::RepeatedPtrField<T1> t1s;
+  t1s.Reserve(t2s.size());
 
   foreach (const T2& t2, t2s) {
-    t1s.Add()->CopyFrom(evolve(t2));
+    T1 t1 = evolve(t2);
+    t1s.Add()->Swap(&t1);
   }
 
   return t1s;
@@ -120,6 +123,7 @@ v1::scheduler::Event evolve(const ResourceOffersMessage& message);
 v1::scheduler::Event evolve(const RescindInverseOfferMessage& message);
 v1::scheduler::Event evolve(const RescindResourceOfferMessage& message);
 v1::scheduler::Event evolve(const StatusUpdateMessage& message);
+v1::scheduler::Event evolve(const StatusUpdatesMessage& message);
 
 v1::executor::Call evolve(const executor::Call& call);
 v1::executor::Event evolve(const executor::Event& event);
@@ -133,6 +137,7 @@ v1::executor::Event evolve(const KillTaskMessage& message);
 v1::executor::Event evolve(const RunTaskMessage& message);
 v1::executor::Event evolve(const ShutdownExecutorMessage& message);
 v1::executor::Event evolve(const StatusUpdateAcknowledgementMessage& message);
+v1::executor::Event evolve(const StatusUpdateAcknowledgementsMessage& message);
 
 
 v1::master::Event evolve(const mesos::master::Event& event);
@@ -16,15 +16,23 @@
 
 #include <jni.h>
 
+#include <mutex>
 #include <string>
+#include <vector>
 #include <assert.h>
 
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+
 #include <mesos/mesos.hpp>
 
 #include <mesos/v1/scheduler/scheduler.hpp>
 
+#include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
 #include <stout/result.hpp>
 #include <stout/strings.hpp>
+#include <stout/synchronized.hpp>
 
 #include "construct.hpp"
 #include "convert.hpp"
@@ -36,6 +44,7 @@
 using namespace mesos;
 
 using std::string;
+using std::vector;
 
 // Facilities for loading Mesos-related classes with the correct
 // ClassLoader. Unfortunately, JNI's FindClass uses the system
@@ -54,7 +63,48 @@ namespace {
 
 jweak mesosClassLoader = nullptr; // Initialized in JNI_OnLoad later in this file.
 
+// Global references to the classes found by FindMesosClass(), keyed
+// by class name. Loading a class through the ClassLoader calls into
+// Java, which is too expensive to do for every converted protobuf.
+// The classes are released in JNI_OnUnLoad.
+std::mutex mesosClassesMutex;
+hashmap<string, jclass>* mesosClasses = new hashmap<string, jclass>();
+
+
+jclass _FindMesosClass(JNIEnv* env, const char* className);
+
+
 jclass FindMesosClass(JNIEnv* env, const char* className)
+{
+  synchronized (mesosClassesMutex) {
+    if (mesosClasses->contains(className)) {
+      return mesosClasses->at(className);
+    }
+  }
+
+  jclass clazz = _FindMesosClass(env, className);
+  if (clazz == nullptr) {
+    return nullptr;
+  }
+
+  jclass global = (jclass) env->NewGlobalRef(clazz);
+  env->DeleteLocalRef(clazz);
+
+  synchronized (mesosClassesMutex) {
+    // Another thread may have found the class in the meantime.
+    if (mesosClasses->contains(className)) {
+      env->DeleteGlobalRef(global);
+      return mesosClasses->at(className);
+    }
+
+    mesosClasses->put(className, global);
+  }
+
+  return global;
+}
+
+
+jclass _FindMesosClass(JNIEnv* env, const char* className)
 {
   if (env->ExceptionCheck()) {
       fprintf(stderr, "ERROR: exception pending on entry to "
@@ -169,6 +219,14 @@ JNIEXPORT void JNICALL JNI_OnUnLoad(JavaVM* jvm, void* reserved)
     env->DeleteWeakGlobalRef(mesosClassLoader);
     mesosClassLoader = nullptr;
   }
+
+  synchronized (mesosClassesMutex) {
+    foreachvalue (jclass clazz, *mesosClasses) {
+      env->DeleteGlobalRef(clazz);
+    }
+
+    mesosClasses->clear();
+  }
 }
 
 
@@ -423,6 +481,10 @@ jobject convert(JNIEnv* env, const TaskStatus& status)
 
   jobject jstatus = env->CallStaticObjectMethod(clazz, parseFrom, jdata);
 
+  // Release the local reference, since statuses may be converted in
+  // large batches (see 'JNIScheduler::statusUpdates').
+  env->DeleteLocalRef(jdata);
+
   return jstatus;
 }
 
@@ -514,6 +576,76 @@ jobject convert(JNIEnv* env, const v1::scheduler::Event& event)
 }
 
 
+namespace {
+
+// Converts the messages into a Java list with a single call into Java,
+// rather than one call per message: the messages are serialized into
+// one buffer of length-delimited messages, which Java parses with the
+// 'PARSER' of the class of the messages (see
+// 'MesosSchedulerDriver.parseDelimited').
+template <typename T>
+jobject convertDelimited(
+    JNIEnv* env,
+    const char* className,
+    const vector<T>& messages)
+{
+  string data;
+
+  {
+    google::protobuf::io::StringOutputStream stream(&data);
+    google::protobuf::io::CodedOutputStream output(&stream);
+
+    foreach (const T& message, messages) {
+      output.WriteVarint32(message.ByteSize());
+      message.SerializeWithCachedSizes(&output);
+    }
+  }
+
+  // byte[] data = ..;
+  jbyteArray jdata = env->NewByteArray(data.size());
+  env->SetByteArrayRegion(jdata, 0, data.size(), (jbyte*) data.data());
+
+  // Parser parser = T.PARSER;
+  jclass clazz = FindMesosClass(env, className);
+
+  jfieldID PARSER =
+    env->GetStaticFieldID(clazz, "PARSER", "Lcom/google/protobuf/Parser;");
+
+  jobject jparser = env->GetStaticObjectField(clazz, PARSER);
+
+  // List messages = MesosSchedulerDriver.parseDelimited(parser, data);
+  clazz = FindMesosClass(env, "org/apache/mesos/MesosSchedulerDriver");
+
+  jmethodID parseDelimited =
+    env->GetStaticMethodID(clazz, "parseDelimited",
+                           "(Lcom/google/protobuf/Parser;[B)Ljava/util/List;");
+
+  jobject jmessages =
+    env->CallStaticObjectMethod(clazz, parseDelimited, jparser, jdata);
+
+  env->DeleteLocalRef(jparser);
+  env->DeleteLocalRef(jdata);
+
+  return jmessages;
+}
+
+} // namespace {
+
+
+template <>
+jobject convert(JNIEnv* env, const vector<Offer>& offers)
+{
+  return convertDelimited(env, "org/apache/mesos/Protos$Offer", offers);
+}
+
+
+template <>
+jobject convert(JNIEnv* env, const vector<TaskStatus>& statuses)
+{
+  return convertDelimited(env, "org/apache/mesos/Protos$TaskStatus", statuses);
+}
+
+
 // Helper to safely return the 'jfieldID' of the given 'name'
 // and 'signature'. If the field doesn't exist 'None' is
 // returned. If any other JVM Exception is encountered an 'Error'
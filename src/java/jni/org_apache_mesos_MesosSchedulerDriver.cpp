@@ -57,6 +57,8 @@ public:
                               const vector<Offer>& offers);
   virtual void offerRescinded(SchedulerDriver* driver, const OfferID& offerId);
   virtual void statusUpdate(SchedulerDriver* driver, const TaskStatus& status);
+  virtual void statusUpdates(SchedulerDriver* driver,
+                             const vector<TaskStatus>& statuses);
   virtual void frameworkMessage(SchedulerDriver* driver,
                                 const ExecutorID& executorId,
                                 const SlaveID& slaveId,
@@ -200,19 +202,9 @@ void JNIScheduler::resourceOffers(SchedulerDriver* driver,
 		     "(Lorg/apache/mesos/SchedulerDriver;"
 		     "Ljava/util/List;)V");
 
-  // List offers = new ArrayList();
-  clazz = env->FindClass("java/util/ArrayList");
-
-  jmethodID _init_ = env->GetMethodID(clazz, "<init>", "()V");
-  jobject joffers = env->NewObject(clazz, _init_);
-
-  jmethodID add = env->GetMethodID(clazz, "add", "(Ljava/lang/Object;)Z");
-
-  // Loop through C++ vector and add each offer to the Java list.
-  foreach (const Offer& offer, offers) {
-    jobject joffer = convert<Offer>(env, offer);
-    env->CallBooleanMethod(joffers, add, joffer);
-  }
+  // The offers are converted with a single call into Java, rather
+  // than one call per offer.
+  jobject joffers = convert<vector<Offer>>(env, offers);
 
   env->ExceptionClear();
 
@@ -302,6 +294,82 @@ void JNIScheduler::statusUpdate(SchedulerDriver* driver,
 }
 
 
+void JNIScheduler::statusUpdates(SchedulerDriver* driver,
+                                 const vector<TaskStatus>& statuses)
+{
+  jvm->AttachCurrentThread(JNIENV_CAST(&env), nullptr);
+
+  jclass clazz = env->GetObjectClass(jdriver);
+
+  jfieldID scheduler = env->GetFieldID(clazz, "scheduler", "Lorg/apache/mesos/Scheduler;");
+  jobject jscheduler = env->GetObjectField(jdriver, scheduler);
+
+  clazz = env->GetObjectClass(jscheduler);
+
+  // The 'org.apache.mesos.Scheduler' interface does not include
+  // 'statusUpdates', so schedulers may opt in by implementing it.
+  // Otherwise we invoke 'statusUpdate' for each status update, which
+  // still saves attaching the thread to the JVM for each of them.
+  //
+  // scheduler.statusUpdates(driver, statuses);
+  jmethodID statusUpdates =
+    env->GetMethodID(clazz, "statusUpdates",
+                     "(Lorg/apache/mesos/SchedulerDriver;"
+                     "Ljava/util/List;)V");
+
+  if (statusUpdates != nullptr) {
+    // The statuses are converted with a single call into Java, rather
+    // than one call per status.
+    jobject jstatuses = convert<vector<TaskStatus>>(env, statuses);
+
+    env->ExceptionClear();
+
+    env->CallVoidMethod(jscheduler, statusUpdates, jdriver, jstatuses);
+
+    if (env->ExceptionCheck()) {
+      env->ExceptionDescribe();
+      env->ExceptionClear();
+      jvm->DetachCurrentThread();
+      driver->abort();
+      return;
+    }
+
+    jvm->DetachCurrentThread();
+    return;
+  }
+
+  // Clear the 'NoSuchMethodError' thrown by 'GetMethodID'.
+  env->ExceptionClear();
+
+  // scheduler.statusUpdate(driver, status);
+  jmethodID statusUpdate =
+    env->GetMethodID(clazz, "statusUpdate",
+                     "(Lorg/apache/mesos/SchedulerDriver;"
+                     "Lorg/apache/mesos/Protos$TaskStatus;)V");
+
+  foreach (const TaskStatus& status, statuses) {
+    jobject jstatus = convert<TaskStatus>(env, status);
+
+    env->ExceptionClear();
+
+    env->CallVoidMethod(jscheduler, statusUpdate, jdriver, jstatus);
+
+    if (env->ExceptionCheck()) {
+      env->ExceptionDescribe();
+      env->ExceptionClear();
+      jvm->DetachCurrentThread();
+      driver->abort();
+      return;
+    }
+
+    // Release the local reference, the batch may be large.
+    env->DeleteLocalRef(jstatus);
+  }
+
+  jvm->DetachCurrentThread();
+}
+
+
 void JNIScheduler::frameworkMessage(SchedulerDriver* driver,
                                     const ExecutorID& executorId,
                                     const SlaveID& slaveId,
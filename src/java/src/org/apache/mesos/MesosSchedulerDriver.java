@@ -18,8 +18,13 @@
 
 package org.apache.mesos;
 
+import com.google.protobuf.InvalidProtocolBufferException;
+import com.google.protobuf.Parser;
+
 import org.apache.mesos.Protos.*;
 
+import java.io.ByteArrayInputStream;
+import java.io.InputStream;
 import java.util.ArrayList;
 import java.util.Collection;
 import java.util.Collections;
@@ -301,6 +306,25 @@ public class MesosSchedulerDriver implements SchedulerDriver {
   protected native void initialize();
   protected native void finalize();
 
+  /**
+   * Parses a buffer of length-delimited messages. This is used by the
+   * native library to pass a batch of messages (e.g., offers) to Java
+   * with a single call, rather than one call per message.
+   */
+  private static <T> List<T> parseDelimited(Parser<T> parser, byte[] data)
+      throws InvalidProtocolBufferException {
+    InputStream input = new ByteArrayInputStream(data);
+
+    List<T> messages = new ArrayList<T>();
+    for (T message = parser.parseDelimitedFrom(input);
+         message != null;
+         message = parser.parseDelimitedFrom(input)) {
+      messages.add(message);
+    }
+
+    return messages;
+  }
+
   private final Scheduler scheduler;
   private final FrameworkInfo framework;
   private final String master;
@@ -122,6 +122,14 @@ public interface Scheduler {
    * acknowledgements are in use, the scheduler must acknowledge this
    * status on the driver.
    *
+   * If the driver batches status updates (see the
+   * 'callback_batch_interval' flag of the scheduler driver), a
+   * scheduler can get all the status updates of a batch at once by
+   * implementing a
+   * <code>void statusUpdates(SchedulerDriver driver,
+   * List&lt;TaskStatus&gt; statuses)</code> method. Otherwise this
+   * callback is invoked for each status update of the batch.
+   *
    * @param driver The driver that was used to run this scheduler.
    * @param status The status update, which includes the task ID and status.
    *
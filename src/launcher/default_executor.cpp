@@ -34,6 +34,7 @@
 #include <process/owned.hpp>
 #include <process/process.hpp>
 #include <process/protobuf.hpp>
+#include <process/shared.hpp>
 
 #include <stout/flags.hpp>
 #include <stout/fs.hpp>
@@ -43,6 +44,7 @@
 #include <stout/os.hpp>
 #include <stout/uuid.hpp>
 
+#include "checks/check_scheduler.hpp"
 #include "checks/health_checker.hpp"
 
 #include "common/http.hpp"
@@ -59,6 +61,7 @@ using mesos::v1::executor::Mesos;
 using process::Clock;
 using process::Future;
 using process::Owned;
+using process::Shared;
 using process::UPID;
 
 using process::http::Connection;
@@ -98,7 +101,8 @@ public:
       executorId(_executorId),
       agent(_agent),
       sandboxDirectory(_sandboxDirectory),
-      launcherDirectory(_launcherDirectory) {}
+      launcherDirectory(_launcherDirectory),
+      checkScheduler(new checks::CheckScheduler()) {}
 
   virtual ~DefaultExecutor() = default;
 
@@ -178,6 +182,18 @@ public:
         break;
       }
 
+      case Event::ACKNOWLEDGEMENTS: {
+        foreach (const Event::Acknowledged& acknowledged,
+                 event.acknowledgements().acknowledgements()) {
+          // Remove the corresponding update.
+          updates.erase(UUID::fromBytes(acknowledged.uuid()).get());
+
+          // Remove the corresponding task.
+          tasks.erase(acknowledged.task_id());
+        }
+        break;
+      }
+
       case Event::SHUTDOWN: {
         shutdown();
         break;
@@ -253,13 +269,16 @@ protected:
       LOG(WARNING) << "Ignoring the launch operation since a task group "
                    << "has been already launched";
 
+      vector<TaskID> taskIds;
       foreach (const TaskInfo& task, taskGroup.tasks()) {
-        update(
-            task.task_id(),
-            TASK_FAILED,
-            "Attempted to run multiple task groups using a "
-            "\"default\" executor");
+        taskIds.push_back(task.task_id());
       }
+
+      update(
+          taskIds,
+          TASK_FAILED,
+          "Attempted to run multiple task groups using a "
+          "\"default\" executor");
       return;
     }
 
@@ -405,7 +424,8 @@ protected:
               defer(self(), &Self::taskHealthUpdated, lambda::_1),
               taskId,
               None(),
-              vector<string>());
+              vector<string>(),
+              checkScheduler);
 
         if (_checker.isError()) {
           // TODO(anand): Should we send a TASK_FAILED instead?
@@ -443,12 +463,15 @@ protected:
       }
     }
 
-    // Send a TASK_RUNNING status update now that the task group has
-    // been successfully launched.
+    // Send the TASK_RUNNING status updates (with a single call) now
+    // that the task group has been successfully launched.
+    vector<TaskID> taskIds;
     foreach (const TaskInfo& task, taskGroup.tasks()) {
-      update(task.task_id(), TASK_RUNNING);
+      taskIds.push_back(task.task_id());
     }
 
+    update(taskIds, TASK_RUNNING);
+
     LOG(INFO)
       << "Successfully launched child containers "
       << stringify(containers.keys()) << " for tasks "
@@ -859,6 +882,45 @@ private:
       const TaskState& state,
       const Option<string>& message = None(),
       const Option<bool>& healthy = None())
+  {
+    Call call;
+    call.set_type(Call::UPDATE);
+
+    call.mutable_framework_id()->CopyFrom(frameworkId);
+    call.mutable_executor_id()->CopyFrom(executorId);
+
+    call.mutable_update()->CopyFrom(
+        createUpdate(taskId, state, message, healthy));
+
+    mesos->send(evolve(call));
+  }
+
+  // Sends the status updates of the tasks, which transition to the
+  // same state, with a single call.
+  void update(
+      const vector<TaskID>& taskIds,
+      const TaskState& state,
+      const Option<string>& message = None())
+  {
+    Call call;
+    call.set_type(Call::UPDATES);
+
+    call.mutable_framework_id()->CopyFrom(frameworkId);
+    call.mutable_executor_id()->CopyFrom(executorId);
+
+    foreach (const TaskID& taskId, taskIds) {
+      call.mutable_updates()->add_updates()->CopyFrom(
+          createUpdate(taskId, state, message, None()));
+    }
+
+    mesos->send(evolve(call));
+  }
+
+  Call::Update createUpdate(
+      const TaskID& taskId,
+      const TaskState& state,
+      const Option<string>& message,
+      const Option<bool>& healthy)
   {
     UUID uuid = UUID::random();
 
@@ -892,18 +954,13 @@ private:
       }
     }
 
-    Call call;
-    call.set_type(Call::UPDATE);
-
-    call.mutable_framework_id()->CopyFrom(frameworkId);
-    call.mutable_executor_id()->CopyFrom(executorId);
-
-    call.mutable_update()->mutable_status()->CopyFrom(status);
+    Call::Update update;
+    update.mutable_status()->CopyFrom(status);
 
     // Capture the status update.
-    updates[uuid] = call.update();
+    updates[uuid] = update;
 
-    mesos->send(evolve(call));
+    return update;
   }
 
   Future<Response> post(Connection connection, const agent::Call& call)
@@ -1035,6 +1092,10 @@ private:
   Option<UUID> connectionId;
 
   hashmap<TaskID, Owned<checks::HealthChecker>> checkers; // Health checkers.
+
+  // Shared by the health checkers of all tasks, so that their health
+  // checks are spread out rather than performed all at once.
+  Shared<checks::CheckScheduler> checkScheduler;
 };
 
 } // namespace internal {
@@ -41,6 +41,7 @@
 #include <process/protobuf.hpp>
 #include <process/subprocess.hpp>
 #include <process/reap.hpp>
+#include <process/shared.hpp>
 #include <process/time.hpp>
 #include <process/timer.hpp>
 
@@ -61,6 +62,7 @@
 #include <stout/os/kill.hpp>
 #include <stout/os/killtree.hpp>
 
+#include "checks/check_scheduler.hpp"
 #include "checks/health_checker.hpp"
 
 #include "common/http.hpp"
@@ -91,6 +93,7 @@ using std::vector;
 using process::Clock;
 using process::Future;
 using process::Owned;
+using process::Shared;
 using process::Subprocess;
 using process::Time;
 using process::Timer;
@@ -138,7 +141,8 @@ public:
       capabilities(_capabilities),
       frameworkId(_frameworkId),
       executorId(_executorId),
-      task(None())
+      task(None()),
+      checkScheduler(new checks::CheckScheduler())
   {
 #ifdef __WINDOWS__
     processHandle = INVALID_HANDLE_VALUE;
@@ -227,6 +231,12 @@ public:
         break;
       }
 
+      case Event::ACKNOWLEDGEMENTS: {
+        // The command executor does not send batches of status updates.
+        LOG(WARNING) << "Received an unexpected ACKNOWLEDGEMENTS event";
+        break;
+      }
+
       case Event::MESSAGE: {
         break;
       }
@@ -435,7 +445,8 @@ protected:
             defer(self(), &Self::taskHealthUpdated, lambda::_1),
             task->task_id(),
             pid,
-            namespaces);
+            namespaces,
+            checkScheduler);
 
       if (_checker.isError()) {
         // TODO(gilbert): Consider ABORT and return a TASK_FAILED here.
@@ -798,6 +809,7 @@ private:
   LinkedHashMap<UUID, Call::Update> updates; // Unacknowledged updates.
   Option<TaskInfo> task; // Unacknowledged task.
   Owned<checks::HealthChecker> checker;
+  Shared<checks::CheckScheduler> checkScheduler;
 };
 
 } // namespace internal {
@@ -14,24 +14,31 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <atomic>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include <process/owned.hpp>
 #include <process/subprocess.hpp>
 
+#include <stout/hashmap.hpp>
 #include <stout/json.hpp>
 #include <stout/net.hpp>
 #include <stout/option.hpp>
 #include <stout/os.hpp>
 #include <stout/path.hpp>
 #include <stout/protobuf.hpp>
+#include <stout/stopwatch.hpp>
 #include <stout/strings.hpp>
 
 #include <mesos/mesos.hpp>
 
 #include <mesos/fetcher/fetcher.hpp>
 
+#include "common/command_utils.hpp"
 #include "common/status_utils.hpp"
 
 #include "hdfs/hdfs.hpp"
@@ -273,6 +280,37 @@ static Try<string> chmodExecutable(const string& filePath)
 }
 
 
+// Verifies that the downloaded file has the checksum of the URI (if
+// any), deleting the file otherwise.
+static Try<Nothing> verify(const CommandInfo::URI& uri, const string& path)
+{
+  if (!uri.has_sha512()) {
+    return Nothing();
+  }
+
+  Future<string> checksum = command::sha512(Path(path));
+  checksum.await();
+
+  Option<string> error;
+  if (!checksum.isReady()) {
+    error = "Failed to compute the checksum of '" + path + "': " +
+            (checksum.isFailed() ? checksum.failure() : "discarded");
+  } else if (strings::lower(checksum.get()) != strings::lower(uri.sha512())) {
+    error = "Checksum mismatch for '" + path + "': expected SHA-512 '" +
+            uri.sha512() + "' but got '" + checksum.get() + "'";
+  }
+
+  if (error.isSome()) {
+    os::rm(path);
+    return Error(error.get());
+  }
+
+  LOG(INFO) << "Verified the checksum of '" << path << "'";
+
+  return Nothing();
+}
+
+
 // Returns the resulting file or in case of extraction the destination
 // directory (for logging).
 static Try<string> fetchBypassingCache(
@@ -312,6 +350,11 @@ static Try<string> fetchBypassingCache(
     return Error(downloaded.error());
   }
 
+  Try<Nothing> verified = verify(uri, downloaded.get());
+  if (verified.isError()) {
+    return Error(verified.error());
+  }
+
   if (uri.executable()) {
     return chmodExecutable(downloaded.get());
   } else if (uri.extract()) {
@@ -425,6 +468,14 @@ static Try<string> fetchThroughCache(
     if (downloaded.isError()) {
       return Error(downloaded.error());
     }
+
+    // NOTE: A cache file is only verified when it is downloaded, since
+    // the fetcher cache makes sure it stays intact (see
+    // `FetcherProcess::recover()`).
+    Try<Nothing> verified = verify(item.uri(), downloaded.get());
+    if (verified.isError()) {
+      return Error(verified.error());
+    }
   }
 
   return fetchFromCache(item, cacheDirectory.get(), sandboxDirectory);
@@ -456,6 +507,20 @@ static Try<string> fetch(
 }
 
 
+// Returns the file in the sandbox directory that fetching the item
+// results in (before any extraction).
+static string destination(const FetcherInfo::Item& item)
+{
+  if (item.uri().has_output_file()) {
+    return item.uri().output_file();
+  }
+
+  Try<string> basename = Fetcher::basename(item.uri().value());
+
+  return basename.isSome() ? basename.get() : item.uri().value();
+}
+
+
 // Checks to see if it's necessary to create a fetcher cache directory for this
 // user, and creates it if so.
 static Try<Nothing> createCacheDirectory(const FetcherInfo& fetcherInfo)
@@ -569,17 +634,80 @@ int main(int argc, char* argv[])
       Option<string>::some(fetcherInfo.get().frameworks_home()) :
         Option<string>::none();
 
-  // Fetch each URI to a local file and chmod if necessary.
+  // The items that are fetched to the same file are fetched in order
+  // (as if all items were fetched one after another), so we group them
+  // into "lanes" which are fetched concurrently.
+  vector<vector<FetcherInfo::Item>> lanes;
+  hashmap<string, size_t> laneIndex;
+
   foreach (const FetcherInfo::Item& item, fetcherInfo.get().items()) {
-    Try<string> fetched =
-      fetch(item, cacheDirectory, sandboxDirectory, frameworksHome);
-    if (fetched.isError()) {
-      EXIT(EXIT_FAILURE)
-        << "Failed to fetch '" << item.uri().value() << "': " + fetched.error();
-    } else {
-      LOG(INFO) << "Fetched '" << item.uri().value()
-                << "' to '" << fetched.get() << "'";
+    const string file = destination(item);
+
+    if (!laneIndex.contains(file)) {
+      laneIndex[file] = lanes.size();
+      lanes.emplace_back();
+    }
+
+    lanes[laneIndex[file]].push_back(item);
+  }
+
+  const size_t concurrency = std::min<size_t>(
+      lanes.size(),
+      std::max(1u, fetcherInfo.get().max_concurrent_downloads()));
+
+  std::atomic<size_t> next(0);
+
+  // The first failure, which stops the fetching of further items.
+  std::mutex mutex;
+  Option<string> failure;
+
+  // Fetch each URI to a local file and chmod if necessary.
+  auto work = [&]() {
+    for (size_t i = next++; i < lanes.size(); i = next++) {
+      foreach (const FetcherInfo::Item& item, lanes[i]) {
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          if (failure.isSome()) {
+            return;
+          }
+        }
+
+        Stopwatch stopwatch;
+        stopwatch.start();
+
+        Try<string> fetched =
+          fetch(item, cacheDirectory, sandboxDirectory, frameworksHome);
+
+        if (fetched.isError()) {
+          std::lock_guard<std::mutex> lock(mutex);
+          if (failure.isNone()) {
+            failure = "Failed to fetch '" + item.uri().value() + "': " +
+                      fetched.error();
+          }
+
+          return;
+        }
+
+        LOG(INFO) << "Fetched '" << item.uri().value()
+                  << "' to '" << fetched.get() << "' in "
+                  << stopwatch.elapsed();
+      }
     }
+  };
+
+  vector<std::thread> threads;
+  for (size_t i = 1; i < concurrency; ++i) {
+    threads.emplace_back(work);
+  }
+
+  work();
+
+  foreach (std::thread& thread, threads) {
+    thread.join();
+  }
+
+  if (failure.isSome()) {
+    EXIT(EXIT_FAILURE) << failure.get();
   }
 
   return 0;
@@ -14,11 +14,13 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <ctype.h>
 #include <errno.h>
 #include <fts.h>
 #include <signal.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
 #include <sys/syscall.h>
@@ -32,8 +34,10 @@
 #include <set>
 #include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include <process/clock.hpp>
 #include <process/collect.hpp>
 #include <process/defer.hpp>
 #include <process/delay.hpp>
@@ -41,6 +45,7 @@
 #include <process/io.hpp>
 #include <process/process.hpp>
 #include <process/reap.hpp>
+#include <process/time.hpp>
 
 #include <stout/duration.hpp>
 #include <stout/error.hpp>
@@ -48,6 +53,7 @@
 #include <stout/hashset.hpp>
 #include <stout/lambda.hpp>
 #include <stout/none.hpp>
+#include <stout/numify.hpp>
 #include <stout/option.hpp>
 #include <stout/os.hpp>
 #include <stout/path.hpp>
@@ -58,6 +64,7 @@
 
 #include "linux/cgroups.hpp"
 #include "linux/fs.hpp"
+#include "linux/ns.hpp"
 
 using namespace process;
 
@@ -351,24 +358,109 @@ static Try<string> read(
 {
   string path = path::join(hierarchy, cgroup, control);
 
-  // TODO(benh): Use os::read. Note that we do not use os::read
-  // currently because it cannot correctly read /proc or cgroups
-  // control files since lseek (in os::read) will return error.
-  ifstream file(path.c_str());
+  // NOTE: We do not use os::read because it cannot correctly read
+  // /proc or cgroups control files since lseek (in os::read) will
+  // return error.
+  Try<int> fd = os::open(path, O_RDONLY | O_CLOEXEC);
 
-  if (!file.is_open()) {
-    return Error("Failed to open file " + path);
+  if (fd.isError()) {
+    return Error("Failed to open file " + path + ": " + fd.error());
   }
 
-  ostringstream ss;
-  ss << file.rdbuf();
+  string result;
+  char buffer[4096];
 
-  if (file.fail()) {
-    // TODO(jieyu): Does ifstream actually set errno?
-    return ErrnoError();
+  while (true) {
+    ssize_t length = ::read(fd.get(), buffer, sizeof(buffer));
+
+    if (length < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+
+      ErrnoError error("Failed to read file " + path);
+      os::close(fd.get());
+      return error;
+    }
+
+    if (length == 0) {
+      break;
+    }
+
+    result.append(buffer, length);
   }
 
-  return ss.str();
+  os::close(fd.get());
+
+  return result;
+}
+
+
+// Parses the contents of a stat file, i.e., lines of the form
+// "<name> <value>". The contents are scanned in place rather than
+// split into lines, as this is on the path of every usage request.
+// @param   file        Name of the stat file, used for error messages.
+// @param   contents    Contents of the stat file.
+// @return  The stat information parsed from the contents.
+//          Error if a line is not of the expected form.
+static Try<hashmap<string, uint64_t>> stat(
+    const string& file,
+    const string& contents)
+{
+  hashmap<string, uint64_t> result;
+
+  const char* line = contents.c_str();
+  const char* end = line + contents.size();
+
+  while (line < end) {
+    const char* eol =
+      static_cast<const char*>(::memchr(line, '\n', end - line));
+
+    if (eol == nullptr) {
+      eol = end;
+    }
+
+    const char* name = line;
+    while (name < eol && ::isspace(*name)) {
+      name++;
+    }
+
+    // Skip empty lines.
+    if (name == eol) {
+      line = eol + 1;
+      continue;
+    }
+
+    const char* separator = name;
+    while (separator < eol && !::isspace(*separator)) {
+      separator++;
+    }
+
+    const char* digits = separator;
+    while (digits < eol && ::isspace(*digits)) {
+      digits++;
+    }
+
+    // Expected line format: "%s %llu".
+    if (digits == eol || !::isdigit(*digits)) {
+      return Error(
+          "Unexpected line format in " + file + ": " + string(line, eol));
+    }
+
+    errno = 0;
+    uint64_t value = ::strtoull(digits, nullptr, 10);
+
+    if (errno != 0) {
+      return ErrnoError(
+          "Failed to parse line in " + file + ": " + string(line, eol));
+    }
+
+    result[string(name, separator)] = value;
+
+    line = eol + 1;
+  }
+
+  return result;
 }
 
 
@@ -1659,14 +1751,147 @@ private:
 };
 
 
+// Returns whether the process is the init process of its pid
+// namespace, based on the 'NSpid' field of its status (Linux 4.1+).
+static Try<bool> init(pid_t pid)
+{
+  Try<string> status = os::read(path::join("/proc", stringify(pid), "status"));
+  if (status.isError()) {
+    return Error(status.error());
+  }
+
+  foreach (const string& line, strings::tokenize(status.get(), "\n")) {
+    if (strings::startsWith(line, "NSpid:")) {
+      vector<string> pids = strings::tokenize(line.substr(6), " \t");
+      return !pids.empty() && pids.back() == "1";
+    }
+  }
+
+  return Error("Unknown pid namespace of process " + stringify(pid));
+}
+
+
+// Kills all processes in the given cgroups without the freezer, if
+// that can be done atomically, and returns the exit statuses of the
+// killed processes. Returns None otherwise.
+//
+// The freezer is needed to keep a process from forking while the
+// processes of its cgroup are killed one by one, which is slow (see
+// 'TasksKiller'). No process can be forked in the cgroups if they are
+// killed by the kernel through 'cgroup.kill' (Linux 5.14+, cgroups
+// v2), or if every process in the cgroups belongs to a pid namespace
+// whose init process is in the cgroups as well: once the init process
+// of a pid namespace is killed, the kernel kills all other processes
+// in the namespace and prevents new ones from being forked.
+static Option<list<Future<Option<int>>>> kill(
+    const string& hierarchy,
+    const vector<string>& cgroups)
+{
+  set<pid_t> pids;
+  bool kernel = true;
+
+  foreach (const string& cgroup, cgroups) {
+    Try<set<pid_t>> processes = cgroups::processes(hierarchy, cgroup);
+    if (processes.isError()) {
+      return None();
+    }
+
+    pids.insert(processes->begin(), processes->end());
+
+    if (!os::exists(path::join(hierarchy, cgroup, "cgroup.kill"))) {
+      kernel = false;
+    }
+  }
+
+  // The init processes of the pid namespaces of the processes.
+  hashmap<ino_t, Option<pid_t>> inits;
+
+  if (!kernel) {
+    Try<ino_t> own = ns::getns(::getpid(), "pid");
+    if (own.isError()) {
+      return None();
+    }
+
+    foreach (pid_t pid, pids) {
+      Try<ino_t> ns = ns::getns(pid, "pid");
+      if (ns.isError()) {
+        // Ignore the process if it is already gone.
+        if (!os::exists(path::join("/proc", stringify(pid)))) {
+          continue;
+        }
+
+        return None();
+      }
+
+      if (ns.get() == own.get()) {
+        return None();
+      }
+
+      Try<bool> init = internal::init(pid);
+      if (init.isError()) {
+        return None();
+      }
+
+      if (init.get()) {
+        inits[ns.get()] = pid;
+      } else if (!inits.contains(ns.get())) {
+        inits[ns.get()] = None();
+      }
+    }
+
+    foreachvalue (const Option<pid_t>& init, inits) {
+      if (init.isNone()) {
+        return None();
+      }
+    }
+  }
+
+  // Reaping the pids before we kill them ensures we reap the correct
+  // pids.
+  list<Future<Option<int>>> statuses;
+  foreach (pid_t pid, pids) {
+    statuses.push_back(process::reap(pid));
+  }
+
+  if (kernel) {
+    foreach (const string& cgroup, cgroups) {
+      Try<Nothing> write =
+        internal::write(hierarchy, cgroup, "cgroup.kill", "1");
+
+      if (write.isError() && os::exists(path::join(hierarchy, cgroup))) {
+        return None();
+      }
+    }
+  } else {
+    foreachvalue (const Option<pid_t>& init, inits) {
+      if (::kill(init.get(), SIGKILL) == -1 && errno != ESRCH) {
+        return None();
+      }
+    }
+  }
+
+  return statuses;
+}
+
+
+// A cgroup which is still busy right after its processes exited is
+// removed again after this interval, up to this many times.
+static const Duration REMOVE_RETRY_INTERVAL = Milliseconds(20);
+static const size_t REMOVE_RETRIES = 50;
+
+
 // The process used to destroy a cgroup.
 class Destroyer : public Process<Destroyer>
 {
 public:
-  Destroyer(const string& _hierarchy, const vector<string>& _cgroups)
+  Destroyer(
+      const string& _hierarchy,
+      const vector<string>& _cgroups,
+      bool _freezer)
     : ProcessBase(ID::generate("cgroups-destroyer")),
       hierarchy(_hierarchy),
-      cgroups(_cgroups) {}
+      cgroups(_cgroups),
+      freezer(_freezer) {}
 
   virtual ~Destroyer() {}
 
@@ -1681,6 +1906,54 @@ protected:
     promise.future().onDiscard(lambda::bind(
         static_cast<void (*)(const UPID&, bool)>(terminate), self(), true));
 
+    Option<list<Future<Option<int>>>> statuses =
+      internal::kill(hierarchy, cgroups);
+
+    if (statuses.isSome()) {
+      reaping = collect(statuses.get());
+      reaping.onAny(defer(self(), &Destroyer::reaped));
+    } else if (freezer) {
+      freeze();
+    } else {
+      // Without the freezer, only empty cgroups can be removed.
+      remove();
+    }
+  }
+
+  virtual void finalize()
+  {
+    reaping.discard();
+    discard(killers);
+    promise.discard();
+  }
+
+private:
+  void reaped()
+  {
+    // Verify the cgroups are now empty: a process may have been added
+    // to them by a process outside of the cgroups.
+    foreach (const string& cgroup, cgroups) {
+      Try<set<pid_t>> processes = cgroups::processes(hierarchy, cgroup);
+
+      if ((processes.isError() || !processes->empty()) &&
+          os::exists(path::join(hierarchy, cgroup))) {
+        if (freezer) {
+          freeze();
+        } else {
+          promise.fail(
+              "Failed to kill all processes in cgroup '" + cgroup + "': " +
+              (processes.isError() ? processes.error() : "processes remain"));
+          terminate(self());
+        }
+        return;
+      }
+    }
+
+    remove();
+  }
+
+  void freeze()
+  {
     // Kill tasks in the given cgroups in parallel. Use collect mechanism to
     // wait until all kill processes finish.
     foreach (const string& cgroup, cgroups) {
@@ -1694,13 +1967,6 @@ protected:
       .onAny(defer(self(), &Destroyer::killed, lambda::_1));
   }
 
-  virtual void finalize()
-  {
-    discard(killers);
-    promise.discard();
-  }
-
-private:
   void killed(const Future<list<Nothing>>& kill)
   {
     if (kill.isReady()) {
@@ -1715,33 +1981,90 @@ private:
     }
   }
 
+  // Removes the cgroups bottom-up, each one as soon as its nested
+  // cgroups are removed, so that a cgroup which is still busy right
+  // after its processes are killed only holds up its ancestors.
   void remove()
   {
     foreach (const string& cgroup, cgroups) {
-      Try<Nothing> remove = internal::remove(hierarchy, cgroup);
-      if (remove.isError()) {
-        // If the `cgroup` still exists in the hierarchy, treat this as
-        // an error; otherwise, treat this as a success since the `cgroup`
-        // has actually been cleaned up.
-        if (os::exists(path::join(hierarchy, cgroup))) {
-          promise.fail(
-              "Failed to remove cgroup '" + cgroup + "': " + remove.error());
-          terminate(self());
-          return;
-        }
+      nested[cgroup] = 0;
+    }
+
+    foreach (const string& cgroup, cgroups) {
+      string parent = Path(cgroup).dirname();
+      if (nested.contains(parent)) {
+        nested[parent]++;
       }
     }
 
-    promise.set(Nothing());
-    terminate(self());
+    if (cgroups.empty()) {
+      promise.set(Nothing());
+      terminate(self());
+      return;
+    }
+
+    vector<string> leaves;
+    foreach (const string& cgroup, cgroups) {
+      if (nested.at(cgroup) == 0) {
+        leaves.push_back(cgroup);
+      }
+    }
+
+    foreach (const string& cgroup, leaves) {
+      _remove(cgroup, 0);
+    }
+  }
+
+  void _remove(const string& cgroup, size_t attempts)
+  {
+    const string path = path::join(hierarchy, cgroup);
+
+    if (::rmdir(path.c_str()) == -1 && errno != ENOENT) {
+      // A cgroup may stay busy for a little while after its last
+      // process exits.
+      if (errno == EBUSY && attempts < REMOVE_RETRIES) {
+        delay(REMOVE_RETRY_INTERVAL,
+              self(),
+              &Destroyer::_remove,
+              cgroup,
+              attempts + 1);
+        return;
+      }
+
+      promise.fail(
+          ErrnoError("Failed to remove cgroup '" + path + "'").message);
+      terminate(self());
+      return;
+    }
+
+    removed++;
+
+    if (removed == cgroups.size()) {
+      promise.set(Nothing());
+      terminate(self());
+      return;
+    }
+
+    string parent = Path(cgroup).dirname();
+    if (nested.contains(parent) && --nested[parent] == 0) {
+      _remove(parent, 0);
+    }
   }
 
   const string hierarchy;
   const vector<string> cgroups;
+  const bool freezer;
   Promise<Nothing> promise;
 
+  // The exit statuses of the processes killed without the freezer.
+  Future<list<Option<int>>> reaping;
+
   // The killer processes used to atomically kill tasks in each cgroup.
   list<Future<Nothing>> killers;
+
+  // The number of nested cgroups left to remove, by cgroup.
+  hashmap<string, size_t> nested;
+  size_t removed = 0;
 };
 
 } // namespace internal {
@@ -1765,30 +2088,15 @@ Future<Nothing> destroy(const string& hierarchy, const string& cgroup)
     return Nothing();
   }
 
-  // If the freezer subsystem is available, destroy the cgroups.
-  Option<Error> error = verify(hierarchy, cgroup, "freezer.state");
-  if (error.isNone()) {
-    internal::Destroyer* destroyer =
-      new internal::Destroyer(hierarchy, candidates);
-    Future<Nothing> future = destroyer->future();
-    spawn(destroyer, true);
-    return future;
-  } else {
-    // Otherwise, attempt to remove the cgroups in bottom-up fashion.
-    foreach (const string& cgroup, candidates) {
-      Try<Nothing> remove = cgroups::remove(hierarchy, cgroup);
-      if (remove.isError()) {
-        // If the `cgroup` still exists in the hierarchy, treat this as
-        // an error; otherwise, treat this as a success since the `cgroup`
-        // has actually been cleaned up.
-        if (os::exists(path::join(hierarchy, cgroup))) {
-          return Failure(remove.error());
-        }
-      }
-    }
-  }
+  // The tasks are killed with the freezer if needed and if the
+  // freezer subsystem is available.
+  bool freezer = verify(hierarchy, cgroup, "freezer.state").isNone();
 
-  return Nothing();
+  internal::Destroyer* destroyer =
+    new internal::Destroyer(hierarchy, candidates, freezer);
+  Future<Nothing> future = destroyer->future();
+  spawn(destroyer, true);
+  return future;
 }
 
 
@@ -1891,29 +2199,109 @@ Try<hashmap<string, uint64_t>> stat(
     return Error(contents.error());
   }
 
-  hashmap<string, uint64_t> result;
+  return internal::stat(file, contents.get());
+}
 
-  foreach (const string& line, strings::split(contents.get(), "\n")) {
-    // Skip empty lines.
-    if (strings::trim(line).empty()) {
-      continue;
+
+Reader::Reader(const string& _hierarchy, const string& _cgroup)
+  : hierarchy(_hierarchy),
+    cgroup(_cgroup) {}
+
+
+Reader::~Reader()
+{
+  foreachvalue (int fd, fds) {
+    os::close(fd);
+  }
+}
+
+
+Try<string> Reader::read(const string& control)
+{
+  string path = path::join(hierarchy, cgroup, control);
+
+  if (!fds.contains(control)) {
+    Option<Error> error = verify(hierarchy, cgroup, control);
+    if (error.isSome()) {
+      return error.get();
     }
 
-    string name;
-    uint64_t value;
+    Try<int> fd = os::open(path, O_RDONLY | O_CLOEXEC);
 
-    // Expected line format: "%s %llu".
-    istringstream stream(line);
-    stream >> name >> value;
+    if (fd.isError()) {
+      return Error("Failed to open file " + path + ": " + fd.error());
+    }
 
-    if (stream.fail()) {
-      return Error("Unexpected line format in " + file + ": " + line);
+    fds[control] = fd.get();
+  }
+
+  // NOTE: Control files regenerate their contents when read from the
+  // start, hence we always read from offset 0 with 'pread' rather
+  // than seeking back (see the note in 'internal::read').
+  const int fd = fds.at(control);
+
+  buffer.clear();
+
+  char data[4096];
+  off_t offset = 0;
+
+  while (true) {
+    ssize_t length = ::pread(fd, data, sizeof(data), offset);
+
+    if (length < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+
+      ErrnoError error("Failed to read file " + path);
+
+      // Reopen the control file on the next read, in case the error is
+      // specific to this file descriptor.
+      os::close(fd);
+      fds.erase(control);
+
+      return error;
+    }
+
+    if (length == 0) {
+      break;
     }
 
-    result[name] = value;
+    buffer.append(data, length);
+    offset += length;
   }
 
-  return result;
+  return buffer;
+}
+
+
+Try<uint64_t> Reader::value(const string& control)
+{
+  Try<string> contents = read(control);
+
+  if (contents.isError()) {
+    return Error(contents.error());
+  }
+
+  Try<uint64_t> value = numify<uint64_t>(strings::trim(contents.get()));
+
+  if (value.isError()) {
+    return Error("Failed to parse " + control + ": " + value.error());
+  }
+
+  return value.get();
+}
+
+
+Try<hashmap<string, uint64_t>> Reader::stat(const string& file)
+{
+  Try<string> contents = read(file);
+
+  if (contents.isError()) {
+    return Error(contents.error());
+  }
+
+  return internal::stat(file, contents.get());
 }
 
 
@@ -2367,10 +2755,14 @@ class CounterProcess : public Process<CounterProcess>
 public:
   CounterProcess(const string& hierarchy,
                  const string& cgroup,
-                 Level level)
+                 Level level,
+                 bool _sample)
     : ProcessBase(ID::generate("cgroups-counter")),
       value_(0),
       error(None()),
+      hierarchy_(hierarchy),
+      cgroup_(cgroup),
+      sample_(_sample),
       process(new event::Listener(
           hierarchy,
           cgroup,
@@ -2388,6 +2780,15 @@ public:
     return value_;
   }
 
+  Future<Option<Delta>> delta()
+  {
+    if (error.isSome()) {
+      return Failure(error.get());
+    }
+
+    return delta_;
+  }
+
 protected:
   virtual void initialize()
   {
@@ -2414,6 +2815,11 @@ private:
 
     if (future.isReady()) {
       value_ += future.get();
+
+      if (sample_) {
+        sample();
+      }
+
       listen();
     } else if (future.isFailed()) {
       error = Error(future.failure());
@@ -2422,8 +2828,48 @@ private:
     }
   }
 
+  // Reads 'memory.stat' and updates the delta to the previous event.
+  // NOTE: The sampling is best-effort, i.e., a failure to read the
+  // statistics does not stop the counting.
+  void sample()
+  {
+    Try<hashmap<string, uint64_t>> stat =
+      cgroups::stat(hierarchy_, cgroup_, "memory.stat");
+
+    if (stat.isError()) {
+      LOG(WARNING) << "Failed to sample 'memory.stat' of cgroup '"
+                   << cgroup_ << "' on a memory pressure event: "
+                   << stat.error();
+      return;
+    }
+
+    const Time now = Clock::now();
+
+    if (previous.isSome()) {
+      Delta delta;
+      delta.elapsed = now - previous->first;
+
+      foreachpair (const string& key, uint64_t value, stat.get()) {
+        Option<uint64_t> before = previous->second.get(key);
+        if (before.isSome()) {
+          delta.stat[key] =
+            static_cast<int64_t>(value) - static_cast<int64_t>(before.get());
+        }
+      }
+
+      delta_ = delta;
+    }
+
+    previous = std::make_pair(now, stat.get());
+  }
+
   uint64_t value_;
   Option<Error> error;
+  const string hierarchy_;
+  const string cgroup_;
+  const bool sample_;
+  Option<std::pair<Time, hashmap<string, uint64_t>>> previous;
+  Option<Delta> delta_;
   process::Owned<event::Listener> process;
 };
 
@@ -2431,21 +2877,23 @@ private:
 Try<Owned<Counter>> Counter::create(
     const string& hierarchy,
     const string& cgroup,
-    Level level)
+    Level level,
+    bool sample)
 {
   Option<Error> error = verify(hierarchy, cgroup);
   if (error.isSome()) {
     return Error(error.get());
   }
 
-  return Owned<Counter>(new Counter(hierarchy, cgroup, level));
+  return Owned<Counter>(new Counter(hierarchy, cgroup, level, sample));
 }
 
 
 Counter::Counter(const string& hierarchy,
                  const string& cgroup,
-                 Level level)
-  : process(new CounterProcess(hierarchy, cgroup, level))
+                 Level level,
+                 bool sample)
+  : process(new CounterProcess(hierarchy, cgroup, level, sample))
 {
   spawn(CHECK_NOTNULL(process.get()));
 }
@@ -2463,6 +2911,12 @@ Future<uint64_t> Counter::value() const
   return dispatch(process.get(), &CounterProcess::value);
 }
 
+
+Future<Option<Delta>> Counter::delta() const
+{
+  return dispatch(process.get(), &CounterProcess::delta);
+}
+
 } // namespace pressure {
 
 } // namespace memory {
@@ -350,16 +350,18 @@ process::Future<uint64_t> listen(
 
 
 // Destroy a cgroup under a given hierarchy. It will also recursively
-// destroy any sub-cgroups. If the freezer subsystem is attached to
-// the hierarchy, we attempt to kill all tasks in a given cgroup,
-// before removing it. Otherwise, we just attempt to remove the
-// cgroup. This function will return an error if the given hierarchy
-// or the given cgroup does not exist or if we failed to destroy any
-// of the cgroups.
+// destroy any sub-cgroups. All tasks in the cgroups are killed before
+// removing them: through 'cgroup.kill' where available, by killing
+// the init processes of their pid namespaces if all tasks are in pid
+// namespaces whose init process is in the cgroups, or otherwise with
+// the freezer if the freezer subsystem is attached to the hierarchy.
+// If none of these is possible, we just attempt to remove the
+// cgroups. Nested cgroups are removed independently of each other.
+// This function will return an error if the given hierarchy or the
+// given cgroup does not exist or if we failed to destroy any of the
+// cgroups.
 // NOTE: If cgroup is "/" (default), all cgroups under the
 // hierarchy are destroyed.
-// TODO(vinod): Add support for killing tasks when freezer subsystem
-// is not present.
 // @param   hierarchy Path to the hierarchy root.
 // @param   cgroup      Path to the cgroup relative to the hierarchy root.
 // @return  A future which will become ready when the operation is done.
@@ -401,6 +403,45 @@ Try<hashmap<std::string, uint64_t>> stat(
     const std::string& file);
 
 
+// Reads the control files of a cgroup, keeping each file open once it
+// has been read so that it can be read again (e.g., to periodically
+// sample the statistics of a container) without verifying the cgroup
+// and opening and closing the file each time as `cgroups::read` does.
+// A reader is meant to be kept for the lifetime of the cgroup.
+class Reader
+{
+public:
+  // @param   hierarchy   Path to the hierarchy root.
+  // @param   cgroup      Path to the cgroup relative to the hierarchy root.
+  Reader(const std::string& hierarchy, const std::string& cgroup);
+  ~Reader();
+
+  // Returns the contents of the control file.
+  Try<std::string> read(const std::string& control);
+
+  // Returns the value of a control file holding a single integer
+  // (Ex: "memory.usage_in_bytes").
+  Try<uint64_t> value(const std::string& control);
+
+  // Returns the stat information from the given file, see
+  // `cgroups::stat` above.
+  Try<hashmap<std::string, uint64_t>> stat(const std::string& file);
+
+private:
+  Reader(const Reader&) = delete;
+  Reader& operator=(const Reader&) = delete;
+
+  const std::string hierarchy;
+  const std::string cgroup;
+
+  // The open control files, by name.
+  hashmap<std::string, int> fds;
+
+  // Reused across reads to avoid reallocating.
+  std::string buffer;
+};
+
+
 // Cpu controls.
 namespace cpu {
 
@@ -597,6 +638,17 @@ enum Level
 std::ostream& operator<<(std::ostream& stream, Level level);
 
 
+// The change of the memory statistics (i.e., 'memory.stat') of a
+// cgroup between two consecutive pressure events. The statistics
+// which are not counters (e.g., 'total_rss') can decrease, hence the
+// signed values.
+struct Delta
+{
+  Duration elapsed;
+  hashmap<std::string, int64_t> stat;
+};
+
+
 // Forward declaration.
 class CounterProcess;
 
@@ -609,11 +661,15 @@ class Counter
 {
 public:
   // Create a memory pressure counter for the given cgroup on the
-  // specified level.
+  // specified level. If 'sample' is true, the counter reads
+  // 'memory.stat' of the cgroup whenever a pressure event occurs,
+  // see 'delta'. This should be avoided for the 'LOW' level since
+  // its events occur on every reclaim.
   static Try<process::Owned<Counter>> create(
       const std::string& hierarchy,
       const std::string& cgroup,
-      Level level);
+      Level level,
+      bool sample = false);
 
   virtual ~Counter();
 
@@ -624,10 +680,16 @@ public:
   // should consider creating a new Counter.
   process::Future<uint64_t> value() const;
 
+  // Returns the change of 'memory.stat' between the two most recent
+  // pressure events, or none if the counter does not sample or less
+  // than two events have occurred.
+  process::Future<Option<Delta>> delta() const;
+
 private:
   Counter(const std::string& hierarchy,
           const std::string& cgroup,
-          Level level);
+          Level level,
+          bool sample);
 
   process::Owned<CounterProcess> process;
 };
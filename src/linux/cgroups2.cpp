@@ -0,0 +1,825 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <list>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <process/collect.hpp>
+#include <process/defer.hpp>
+#include <process/delay.hpp>
+#include <process/id.hpp>
+#include <process/process.hpp>
+#include <process/reap.hpp>
+
+#include <stout/error.hpp>
+#include <stout/foreach.hpp>
+#include <stout/lambda.hpp>
+#include <stout/none.hpp>
+#include <stout/numify.hpp>
+#include <stout/os.hpp>
+#include <stout/path.hpp>
+#include <stout/stringify.hpp>
+#include <stout/strings.hpp>
+
+#include <stout/os/ls.hpp>
+#include <stout/os/read.hpp>
+#include <stout/os/realpath.hpp>
+#include <stout/os/stat.hpp>
+#include <stout/os/write.hpp>
+
+#include "linux/cgroups2.hpp"
+#include "linux/fs.hpp"
+
+using namespace process;
+
+using namespace mesos::internal;
+
+using std::list;
+using std::set;
+using std::string;
+using std::vector;
+
+namespace cgroups2 {
+
+bool enabled()
+{
+  Try<string> filesystems = os::read("/proc/filesystems");
+  if (filesystems.isError()) {
+    return false;
+  }
+
+  foreach (const string& line, strings::tokenize(filesystems.get(), "\n")) {
+    vector<string> tokens = strings::tokenize(line, " \t");
+    if (!tokens.empty() && tokens.back() == FILE_SYSTEM) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
+Try<bool> mounted(const string& root)
+{
+  if (!os::exists(root)) {
+    return false;
+  }
+
+  // We compare canonicalized absolute paths.
+  Result<string> realpath = os::realpath(root);
+  if (!realpath.isSome()) {
+    return Error(
+        "Failed to determine canonical path of '" + root + "': " +
+        (realpath.isError()
+         ? realpath.error()
+         : "No such file or directory"));
+  }
+
+  Try<fs::MountTable> table = fs::MountTable::read("/proc/mounts");
+  if (table.isError()) {
+    return Error(table.error());
+  }
+
+  foreach (const fs::MountTable::Entry& entry, table->entries) {
+    if (entry.type == FILE_SYSTEM) {
+      Result<string> dir = os::realpath(entry.dir);
+      if (dir.isSome() && dir.get() == realpath.get()) {
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+
+Try<set<string>> controllers(const string& root, const string& cgroup)
+{
+  Try<string> read = cgroups2::read(root, cgroup, "cgroup.controllers");
+  if (read.isError()) {
+    return Error(read.error());
+  }
+
+  vector<string> tokens = strings::tokenize(read.get(), " \n");
+  return set<string>(tokens.begin(), tokens.end());
+}
+
+
+Try<Nothing> enable(
+    const string& root,
+    const string& cgroup,
+    const set<string>& controllers)
+{
+  vector<string> tokens;
+  foreach (const string& controller, controllers) {
+    tokens.push_back("+" + controller);
+  }
+
+  return write(
+      root,
+      cgroup,
+      "cgroup.subtree_control",
+      strings::join(" ", tokens));
+}
+
+
+Try<Nothing> create(const string& root, const string& cgroup, bool recursive)
+{
+  Try<Nothing> mkdir = os::mkdir(path::join(root, cgroup), recursive);
+  if (mkdir.isError()) {
+    return Error(
+        "Failed to create cgroup '" + cgroup + "': " + mkdir.error());
+  }
+
+  return Nothing();
+}
+
+
+static Try<Nothing> get(
+    const string& root,
+    const string& cgroup,
+    vector<string>* cgroups)
+{
+  Try<list<string>> entries = os::ls(path::join(root, cgroup));
+  if (entries.isError()) {
+    return Error(entries.error());
+  }
+
+  foreach (const string& entry, entries.get()) {
+    const string nested = strings::trim(path::join(cgroup, entry), "/");
+
+    if (os::stat::isdir(path::join(root, nested))) {
+      Try<Nothing> get = cgroups2::get(root, nested, cgroups);
+      if (get.isError()) {
+        return get;
+      }
+
+      cgroups->push_back(nested);
+    }
+  }
+
+  return Nothing();
+}
+
+
+Try<vector<string>> get(const string& root, const string& cgroup)
+{
+  vector<string> cgroups;
+
+  Try<Nothing> get = cgroups2::get(root, cgroup, &cgroups);
+  if (get.isError()) {
+    return Error(
+        "Failed to get the nested cgroups of '" + cgroup + "': " +
+        get.error());
+  }
+
+  return cgroups;
+}
+
+
+Try<Nothing> assign(const string& root, const string& cgroup, pid_t pid)
+{
+  return write(root, cgroup, "cgroup.procs", stringify(pid));
+}
+
+
+Try<set<pid_t>> processes(const string& root, const string& cgroup)
+{
+  Try<string> read = cgroups2::read(root, cgroup, "cgroup.procs");
+  if (read.isError()) {
+    return Error(read.error());
+  }
+
+  set<pid_t> pids;
+  foreach (const string& token, strings::tokenize(read.get(), "\n")) {
+    Try<pid_t> pid = numify<pid_t>(strings::trim(token));
+    if (pid.isError()) {
+      return Error("Failed to parse '" + token + "': " + pid.error());
+    }
+
+    pids.insert(pid.get());
+  }
+
+  return pids;
+}
+
+
+namespace internal {
+
+// The interval at which the destroyer checks whether a cgroup got
+// frozen, whether processes are left after the kill and whether a
+// busy cgroup can be removed.
+static const Duration DESTROY_RETRY_INTERVAL = Milliseconds(10);
+
+// A cgroup which is still busy right after its processes exited is
+// removed up to this many times.
+static const size_t REMOVE_RETRIES = 100;
+
+
+// The process used to destroy a cgroup and its nested cgroups.
+class Destroyer : public Process<Destroyer>
+{
+public:
+  Destroyer(
+      const string& _root,
+      const string& _cgroup,
+      const vector<string>& _cgroups)
+    : ProcessBase(ID::generate("cgroups2-destroyer")),
+      root(_root),
+      cgroup(_cgroup),
+      cgroups(_cgroups) {}
+
+  virtual ~Destroyer() {}
+
+  Future<Nothing> future() { return promise.future(); }
+
+protected:
+  virtual void initialize()
+  {
+    // Stop when no one cares.
+    promise.future().onDiscard(lambda::bind(
+        static_cast<void (*)(const UPID&, bool)>(terminate), self(), true));
+
+    // The kernel kills the processes of the cgroups atomically through
+    // 'cgroup.kill'. Otherwise the cgroups are frozen first (which is
+    // recursive) so that no process can fork while they are killed.
+    // Frozen processes are still killed by SIGKILL.
+    if (os::exists(path::join(root, cgroup, "cgroup.kill"))) {
+      Try<Nothing> write = cgroups2::write(root, cgroup, "cgroup.kill", "1");
+      if (write.isError()) {
+        fail("Failed to kill the processes: " + write.error());
+        return;
+      }
+
+      kill();
+    } else if (os::exists(path::join(root, cgroup, "cgroup.freeze"))) {
+      Try<Nothing> write =
+        cgroups2::write(root, cgroup, "cgroup.freeze", "1");
+
+      if (write.isError()) {
+        fail("Failed to freeze the processes: " + write.error());
+        return;
+      }
+
+      frozen();
+    } else {
+      kill();
+    }
+  }
+
+  virtual void finalize()
+  {
+    reaping.discard();
+    promise.discard();
+  }
+
+private:
+  void fail(const string& message)
+  {
+    promise.fail(
+        "Failed to destroy cgroup '" + path::join(root, cgroup) + "': " +
+        message);
+
+    terminate(self());
+  }
+
+  void frozen()
+  {
+    Try<hashmap<string, uint64_t>> events =
+      stat(root, cgroup, "cgroup.events");
+
+    if (events.isError()) {
+      fail(events.error());
+      return;
+    }
+
+    if (events->get("frozen") != 1u) {
+      delay(DESTROY_RETRY_INTERVAL, self(), &Destroyer::frozen);
+      return;
+    }
+
+    kill();
+  }
+
+  // Kills and reaps the processes left in the cgroups.
+  void kill()
+  {
+    list<Future<Option<int>>> statuses;
+
+    foreach (const string& nested, cgroups) {
+      Try<set<pid_t>> pids = processes(root, nested);
+      if (pids.isError()) {
+        // The cgroup may already have been removed.
+        if (os::exists(path::join(root, nested))) {
+          fail(pids.error());
+          return;
+        }
+
+        continue;
+      }
+
+      // Reaping the pids before we kill them ensures we reap the
+      // correct pids.
+      foreach (pid_t pid, pids.get()) {
+        statuses.push_back(process::reap(pid));
+
+        if (::kill(pid, SIGKILL) == -1 && errno != ESRCH) {
+          fail(ErrnoError("Failed to kill process " + stringify(pid))
+                 .message);
+          return;
+        }
+      }
+    }
+
+    reaping = collect(statuses);
+    reaping.onAny(defer(self(), &Destroyer::killed));
+  }
+
+  void killed()
+  {
+    // Without the freezer, processes may have been forked while the
+    // others were killed.
+    foreach (const string& nested, cgroups) {
+      Try<set<pid_t>> pids = processes(root, nested);
+      if (pids.isSome() && !pids->empty()) {
+        delay(DESTROY_RETRY_INTERVAL, self(), &Destroyer::kill);
+        return;
+      }
+    }
+
+    remove(0, 0);
+  }
+
+  // Removes the cgroups bottom-up, from the given index on.
+  void remove(size_t index, size_t attempts)
+  {
+    for (; index < cgroups.size(); index++, attempts = 0) {
+      const string path = path::join(root, cgroups[index]);
+
+      if (::rmdir(path.c_str()) == -1 && errno != ENOENT) {
+        // A cgroup may stay busy for a little while after its last
+        // process exits.
+        if (errno == EBUSY && attempts < REMOVE_RETRIES) {
+          delay(DESTROY_RETRY_INTERVAL,
+                self(),
+                &Destroyer::remove,
+                index,
+                attempts + 1);
+          return;
+        }
+
+        fail(ErrnoError("Failed to remove '" + path + "'").message);
+        return;
+      }
+    }
+
+    promise.set(Nothing());
+    terminate(self());
+  }
+
+  const string root;
+  const string cgroup;
+
+  // The cgroup and its nested cgroups, in post-order.
+  const vector<string> cgroups;
+
+  Promise<Nothing> promise;
+  Future<list<Option<int>>> reaping;
+};
+
+} // namespace internal {
+
+
+Future<Nothing> destroy(const string& root, const string& cgroup)
+{
+  if (strings::trim(cgroup, "/").empty()) {
+    return Failure("The root cgroup cannot be destroyed");
+  }
+
+  if (!os::exists(path::join(root, cgroup))) {
+    return Failure("'" + cgroup + "' is not a valid cgroup");
+  }
+
+  Try<vector<string>> cgroups = get(root, cgroup);
+  if (cgroups.isError()) {
+    return Failure(cgroups.error());
+  }
+
+  vector<string> candidates = cgroups.get();
+  candidates.push_back(cgroup);
+
+  internal::Destroyer* destroyer =
+    new internal::Destroyer(root, cgroup, candidates);
+
+  Future<Nothing> future = destroyer->future();
+  spawn(destroyer, true);
+  return future;
+}
+
+
+Future<Nothing> destroy(
+    const string& root,
+    const string& cgroup,
+    const Duration& timeout)
+{
+  return destroy(root, cgroup)
+    .after(timeout, [timeout](Future<Nothing> future) -> Future<Nothing> {
+      future.discard();
+      return Failure("Timed out after " + stringify(timeout));
+    });
+}
+
+
+Try<string> read(
+    const string& root,
+    const string& cgroup,
+    const string& control)
+{
+  const string path = path::join(root, cgroup, control);
+
+  Try<string> read = os::read(path);
+  if (read.isError()) {
+    return Error("Failed to read '" + path + "': " + read.error());
+  }
+
+  return read.get();
+}
+
+
+Try<Nothing> write(
+    const string& root,
+    const string& cgroup,
+    const string& control,
+    const string& value)
+{
+  const string path = path::join(root, cgroup, control);
+
+  Try<Nothing> write = os::write(path, value);
+  if (write.isError()) {
+    return Error(
+        "Failed to write '" + value + "' to '" + path + "': " +
+        write.error());
+  }
+
+  return Nothing();
+}
+
+
+Try<hashmap<string, uint64_t>> stat(
+    const string& root,
+    const string& cgroup,
+    const string& control)
+{
+  Try<string> read = cgroups2::read(root, cgroup, control);
+  if (read.isError()) {
+    return Error(read.error());
+  }
+
+  hashmap<string, uint64_t> result;
+
+  // Stat files are read on every usage request, so they are parsed
+  // through views rather than by copying each line and token.
+  const strings::View contents(read.get());
+
+  foreach (const strings::View& line, strings::tokenize(contents, "\n")) {
+    vector<strings::View> tokens = strings::tokenize(line, " ");
+    if (tokens.size() != 2) {
+      return Error(
+          "Unexpected line '" + line.str() + "' in '" + control + "'");
+    }
+
+    Try<uint64_t> value = numify<uint64_t>(tokens[1]);
+    if (value.isError()) {
+      return Error(
+          "Failed to parse '" + line.str() + "' in '" + control + "': " +
+          value.error());
+    }
+
+    result[tokens[0].str()] = value.get();
+  }
+
+  return result;
+}
+
+
+namespace cpu {
+
+Try<Nothing> weight(const string& root, const string& cgroup, uint64_t weight)
+{
+  return write(root, cgroup, "cpu.weight", stringify(weight));
+}
+
+
+Try<Nothing> max(
+    const string& root,
+    const string& cgroup,
+    const Option<Duration>& quota,
+    const Duration& period)
+{
+  return write(
+      root,
+      cgroup,
+      "cpu.max",
+      (quota.isSome()
+         ? stringify(static_cast<uint64_t>(quota->us()))
+         : "max") +
+      " " + stringify(static_cast<uint64_t>(period.us())));
+}
+
+
+Try<Stats> stats(const string& root, const string& cgroup)
+{
+  Try<hashmap<string, uint64_t>> stat =
+    cgroups2::stat(root, cgroup, "cpu.stat");
+
+  if (stat.isError()) {
+    return Error(stat.error());
+  }
+
+  if (!stat->contains("usage_usec") ||
+      !stat->contains("user_usec") ||
+      !stat->contains("system_usec")) {
+    return Error("Missing the usage in 'cpu.stat'");
+  }
+
+  Stats stats;
+  stats.usage = Microseconds(stat->at("usage_usec"));
+  stats.user = Microseconds(stat->at("user_usec"));
+  stats.system = Microseconds(stat->at("system_usec"));
+
+  stats.periods = stat->get("nr_periods");
+  stats.throttled = stat->get("nr_throttled");
+
+  if (stat->contains("throttled_usec")) {
+    stats.throttledTime = Microseconds(stat->at("throttled_usec"));
+  }
+
+  return stats;
+}
+
+} // namespace cpu {
+
+
+namespace memory {
+
+// Parses a control file holding a number of bytes, or "max".
+static Try<Option<Bytes>> bytes(
+    const string& root,
+    const string& cgroup,
+    const string& control)
+{
+  Try<string> read = cgroups2::read(root, cgroup, control);
+  if (read.isError()) {
+    return Error(read.error());
+  }
+
+  const string value = strings::trim(read.get());
+  if (value == "max") {
+    return None();
+  }
+
+  Try<uint64_t> bytes = numify<uint64_t>(value);
+  if (bytes.isError()) {
+    return Error(
+        "Failed to parse '" + value + "' in '" + control + "': " +
+        bytes.error());
+  }
+
+  return Bytes(bytes.get());
+}
+
+
+Try<Bytes> usage(const string& root, const string& cgroup)
+{
+  Try<Option<Bytes>> usage = bytes(root, cgroup, "memory.current");
+  if (usage.isError()) {
+    return Error(usage.error());
+  } else if (usage->isNone()) {
+    return Error("Unexpected value in 'memory.current'");
+  }
+
+  return usage->get();
+}
+
+
+Try<Nothing> max(
+    const string& root,
+    const string& cgroup,
+    const Option<Bytes>& limit)
+{
+  return write(
+      root,
+      cgroup,
+      "memory.max",
+      limit.isSome() ? stringify(limit->bytes()) : "max");
+}
+
+
+Try<Option<Bytes>> max(const string& root, const string& cgroup)
+{
+  return bytes(root, cgroup, "memory.max");
+}
+
+
+Try<Nothing> low(
+    const string& root,
+    const string& cgroup,
+    const Bytes& protection)
+{
+  return write(root, cgroup, "memory.low", stringify(protection.bytes()));
+}
+
+
+Try<Nothing> swap_max(
+    const string& root,
+    const string& cgroup,
+    const Bytes& limit)
+{
+  return write(root, cgroup, "memory.swap.max", stringify(limit.bytes()));
+}
+
+
+Try<hashmap<string, uint64_t>> stats(const string& root, const string& cgroup)
+{
+  return stat(root, cgroup, "memory.stat");
+}
+
+
+Try<hashmap<string, uint64_t>> events(const string& root, const string& cgroup)
+{
+  return stat(root, cgroup, "memory.events");
+}
+
+} // namespace memory {
+
+
+namespace io {
+
+Try<hashmap<string, Stats>> stats(const string& root, const string& cgroup)
+{
+  Try<string> read = cgroups2::read(root, cgroup, "io.stat");
+  if (read.isError()) {
+    return Error(read.error());
+  }
+
+  hashmap<string, Stats> result;
+
+  const strings::View contents(read.get());
+
+  // Each line holds the statistics of a device, e.g.:
+  //   8:0 rbytes=90112 wbytes=0 rios=3 wios=0 dbytes=0 dios=0
+  foreach (const strings::View& line, strings::tokenize(contents, "\n")) {
+    vector<strings::View> tokens = strings::tokenize(line, " ");
+    if (tokens.empty()) {
+      continue;
+    }
+
+    Stats stats;
+
+    for (size_t i = 1; i < tokens.size(); i++) {
+      vector<strings::View> pair = strings::split(tokens[i], "=", 2);
+      if (pair.size() != 2) {
+        return Error("Unexpected line '" + line.str() + "' in 'io.stat'");
+      }
+
+      Try<uint64_t> value = numify<uint64_t>(pair[1]);
+      if (value.isError()) {
+        return Error(
+            "Failed to parse '" + tokens[i].str() + "' in 'io.stat': " +
+            value.error());
+      }
+
+      if (pair[0] == "rbytes") {
+        stats.readBytes = value.get();
+      } else if (pair[0] == "wbytes") {
+        stats.writeBytes = value.get();
+      } else if (pair[0] == "rios") {
+        stats.readOps = value.get();
+      } else if (pair[0] == "wios") {
+        stats.writeOps = value.get();
+      }
+    }
+
+    result[tokens[0].str()] = stats;
+  }
+
+  return result;
+}
+
+} // namespace io {
+
+
+namespace pressure {
+
+// Parses a line of a pressure file, e.g.:
+//   some avg10=0.12 avg60=0.05 avg300=0.01 total=123456
+static Try<Stall> parse(const vector<strings::View>& tokens)
+{
+  Stall stall;
+
+  for (size_t i = 1; i < tokens.size(); i++) {
+    vector<strings::View> pair = strings::split(tokens[i], "=", 2);
+    if (pair.size() != 2) {
+      return Error("Unexpected field '" + tokens[i].str() + "'");
+    }
+
+    if (pair[0] == "total") {
+      Try<uint64_t> total = numify<uint64_t>(pair[1]);
+      if (total.isError()) {
+        return Error(
+            "Failed to parse '" + tokens[i].str() + "': " + total.error());
+      }
+
+      stall.total = Microseconds(total.get());
+    } else {
+      Try<double> average = numify<double>(pair[1]);
+      if (average.isError()) {
+        return Error(
+            "Failed to parse '" + tokens[i].str() + "': " + average.error());
+      }
+
+      if (pair[0] == "avg10") {
+        stall.avg10 = average.get();
+      } else if (pair[0] == "avg60") {
+        stall.avg60 = average.get();
+      } else if (pair[0] == "avg300") {
+        stall.avg300 = average.get();
+      }
+    }
+  }
+
+  return stall;
+}
+
+
+Try<Pressure> read(
+    const string& root,
+    const string& cgroup,
+    const string& resource)
+{
+  const string control = resource + ".pressure";
+
+  Try<string> read = cgroups2::read(root, cgroup, control);
+  if (read.isError()) {
+    return Error(read.error());
+  }
+
+  Option<Stall> some;
+  Option<Stall> full;
+
+  const strings::View contents(read.get());
+
+  foreach (const strings::View& line, strings::tokenize(contents, "\n")) {
+    vector<strings::View> tokens = strings::tokenize(line, " ");
+    if (tokens.empty()) {
+      continue;
+    }
+
+    Try<Stall> stall = parse(tokens);
+    if (stall.isError()) {
+      return Error(
+          "Failed to parse '" + line.str() + "' in '" + control + "': " +
+          stall.error());
+    }
+
+    if (tokens[0] == "some") {
+      some = stall.get();
+    } else if (tokens[0] == "full") {
+      full = stall.get();
+    }
+  }
+
+  if (some.isNone()) {
+    return Error("Missing the 'some' line in '" + control + "'");
+  }
+
+  Pressure pressure;
+  pressure.some = some.get();
+  pressure.full = full;
+
+  return pressure;
+}
+
+} // namespace pressure {
+
+} // namespace cgroups2 {
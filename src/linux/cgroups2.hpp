@@ -0,0 +1,297 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef __CGROUPS2_HPP__
+#define __CGROUPS2_HPP__
+
+#include <stdint.h>
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+
+#include <process/future.hpp>
+
+#include <stout/bytes.hpp>
+#include <stout/duration.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/nothing.hpp>
+#include <stout/option.hpp>
+#include <stout/try.hpp>
+
+// Helpers for the cgroups v2 unified hierarchy, in which all the
+// controllers (the v2 name of the subsystems) are attached to a single
+// hierarchy. Unlike with the v1 hierarchies in `cgroups`, a process is
+// then a member of one cgroup, in which all of its controllers are
+// configured and read. See
+// https://www.kernel.org/doc/Documentation/cgroup-v2.txt.
+//
+// NOTE: A controller is only available in a cgroup once it is enabled
+// in the 'cgroup.subtree_control' file of all of its ancestors, and
+// only cgroups without processes (except for the root cgroup) can
+// enable controllers for their children.
+namespace cgroups2 {
+
+// The file system type of the unified hierarchy.
+const std::string FILE_SYSTEM = "cgroup2";
+
+
+// Returns whether the kernel supports the unified hierarchy.
+bool enabled();
+
+
+// Returns whether the unified hierarchy is mounted at the given root.
+Try<bool> mounted(const std::string& root);
+
+
+// Returns the controllers available in a cgroup, which are those
+// enabled for it by its parent.
+// @param   root      Path to the root of the unified hierarchy.
+// @param   cgroup    Path to the cgroup relative to the root.
+Try<std::set<std::string>> controllers(
+    const std::string& root,
+    const std::string& cgroup = "");
+
+
+// Enables the controllers for the children of a cgroup in its
+// 'cgroup.subtree_control' file.
+Try<Nothing> enable(
+    const std::string& root,
+    const std::string& cgroup,
+    const std::set<std::string>& controllers);
+
+
+// Creates a cgroup, and its missing ancestors if 'recursive' is true.
+Try<Nothing> create(
+    const std::string& root,
+    const std::string& cgroup,
+    bool recursive = false);
+
+
+// Returns the nested cgroups of a cgroup, in post-order.
+Try<std::vector<std::string>> get(
+    const std::string& root,
+    const std::string& cgroup = "");
+
+
+// Moves a process into a cgroup.
+Try<Nothing> assign(
+    const std::string& root,
+    const std::string& cgroup,
+    pid_t pid);
+
+
+// Returns the processes in a cgroup.
+Try<std::set<pid_t>> processes(
+    const std::string& root,
+    const std::string& cgroup);
+
+
+// Kills all processes in a cgroup and its nested cgroups and removes
+// them. The processes are killed by the kernel through 'cgroup.kill'
+// (Linux 5.14+), or are frozen through 'cgroup.freeze' (Linux 5.2+),
+// if available, before being killed.
+process::Future<Nothing> destroy(
+    const std::string& root,
+    const std::string& cgroup);
+
+
+// Like `destroy` above, failing if the cgroup is not destroyed before
+// the timeout.
+process::Future<Nothing> destroy(
+    const std::string& root,
+    const std::string& cgroup,
+    const Duration& timeout);
+
+
+// Reads or writes a control file of a cgroup.
+Try<std::string> read(
+    const std::string& root,
+    const std::string& cgroup,
+    const std::string& control);
+
+
+Try<Nothing> write(
+    const std::string& root,
+    const std::string& cgroup,
+    const std::string& control,
+    const std::string& value);
+
+
+// Returns the values of a "flat keyed" control file, which has one
+// "<key> <value>" pair per line (e.g., 'cpu.stat' or 'memory.stat').
+Try<hashmap<std::string, uint64_t>> stat(
+    const std::string& root,
+    const std::string& cgroup,
+    const std::string& control);
+
+
+namespace cpu {
+
+// The weight of a cgroup in 'cpu.weight' ranges from 1 to 10000, and
+// is 100 by default.
+const uint64_t MIN_WEIGHT = 1;
+const uint64_t MAX_WEIGHT = 10000;
+
+
+// Sets the cpu weight using 'cpu.weight'.
+Try<Nothing> weight(
+    const std::string& root,
+    const std::string& cgroup,
+    uint64_t weight);
+
+
+// Sets the bandwidth limit using 'cpu.max': the processes of the
+// cgroup can run for 'quota' in each 'period', or without limit if
+// 'quota' is None.
+Try<Nothing> max(
+    const std::string& root,
+    const std::string& cgroup,
+    const Option<Duration>& quota,
+    const Duration& period);
+
+
+// The cpu usage of a cgroup, from 'cpu.stat'. The throttling
+// statistics are only set if the cpu controller is enabled.
+struct Stats
+{
+  Duration usage;
+  Duration user;
+  Duration system;
+
+  Option<uint64_t> periods;
+  Option<uint64_t> throttled;
+  Option<Duration> throttledTime;
+};
+
+
+Try<Stats> stats(const std::string& root, const std::string& cgroup);
+
+} // namespace cpu {
+
+
+namespace memory {
+
+// Returns the memory usage from 'memory.current'.
+Try<Bytes> usage(const std::string& root, const std::string& cgroup);
+
+
+// Sets the hard limit using 'memory.max', which is unlimited if
+// 'limit' is None. Processes of the cgroup are OOM killed if its
+// usage cannot be reclaimed below the limit.
+Try<Nothing> max(
+    const std::string& root,
+    const std::string& cgroup,
+    const Option<Bytes>& limit);
+
+
+// Returns the hard limit from 'memory.max', or None if unlimited.
+Try<Option<Bytes>> max(const std::string& root, const std::string& cgroup);
+
+
+// Sets the protection using 'memory.low': memory of the cgroup below
+// it is only reclaimed if no unprotected memory is reclaimable.
+Try<Nothing> low(
+    const std::string& root,
+    const std::string& cgroup,
+    const Bytes& protection);
+
+
+// Sets the swap limit using 'memory.swap.max'.
+Try<Nothing> swap_max(
+    const std::string& root,
+    const std::string& cgroup,
+    const Bytes& limit);
+
+
+// Returns the statistics from 'memory.stat'.
+Try<hashmap<std::string, uint64_t>> stats(
+    const std::string& root,
+    const std::string& cgroup);
+
+
+// Returns the number of memory events of each type (e.g.,
+// 'oom_kill') from 'memory.events'.
+Try<hashmap<std::string, uint64_t>> events(
+    const std::string& root,
+    const std::string& cgroup);
+
+} // namespace memory {
+
+
+namespace io {
+
+// The io usage of a cgroup on a device, from 'io.stat'.
+struct Stats
+{
+  uint64_t readBytes = 0;
+  uint64_t writeBytes = 0;
+  uint64_t readOps = 0;
+  uint64_t writeOps = 0;
+};
+
+
+// Returns the io usage by device ("<major>:<minor>").
+Try<hashmap<std::string, Stats>> stats(
+    const std::string& root,
+    const std::string& cgroup);
+
+} // namespace io {
+
+
+// Pressure stall information (PSI, Linux 4.20+): the share of time in
+// which some (or, for 'full', all) of the non-idle processes of a
+// cgroup were stalled waiting for a resource. See
+// https://www.kernel.org/doc/Documentation/accounting/psi.txt.
+namespace pressure {
+
+struct Stall
+{
+  // The percentages of time stalled over the last 10, 60 and 300
+  // seconds.
+  double avg10 = 0;
+  double avg60 = 0;
+  double avg300 = 0;
+
+  // The total time stalled.
+  Duration total;
+};
+
+
+struct Pressure
+{
+  Stall some;
+
+  // Not reported for the cpu before Linux 5.13.
+  Option<Stall> full;
+};
+
+
+// Returns the pressure of the given resource ("cpu", "memory" or
+// "io") from '<resource>.pressure'.
+Try<Pressure> read(
+    const std::string& root,
+    const std::string& cgroup,
+    const std::string& resource);
+
+} // namespace pressure {
+
+} // namespace cgroups2 {
+
+#endif // __CGROUPS2_HPP__
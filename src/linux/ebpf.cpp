@@ -0,0 +1,155 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sys/syscall.h>
+
+#include <string>
+#include <vector>
+
+#include <stout/error.hpp>
+#include <stout/os.hpp>
+
+#include "linux/ebpf.hpp"
+
+using std::string;
+using std::vector;
+
+namespace ebpf {
+
+// The license the programs are loaded under. Note that this only
+// determines whether a program may call GPL-only helper functions.
+static const char LICENSE[] = "Apache-2.0";
+
+// The size of the buffer for the log of the kernel's verifier.
+static const size_t LOG_SIZE = 64 * 1024;
+
+
+static int bpf(enum bpf_cmd cmd, union bpf_attr* attr)
+{
+  return ::syscall(__NR_bpf, cmd, attr, sizeof(*attr));
+}
+
+
+static uint64_t pointer(const void* p)
+{
+  return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(p));
+}
+
+
+bool supported()
+{
+  // An invalid command is rejected with EINVAL if the system call
+  // exists, and with ENOSYS otherwise.
+  union bpf_attr attr;
+  memset(&attr, 0, sizeof(attr));
+
+  return bpf(static_cast<enum bpf_cmd>(-1), &attr) != -1 || errno != ENOSYS;
+}
+
+
+Try<int> createMap(
+    enum bpf_map_type type,
+    uint32_t keySize,
+    uint32_t valueSize,
+    uint32_t maxEntries)
+{
+  union bpf_attr attr;
+  memset(&attr, 0, sizeof(attr));
+
+  attr.map_type = type;
+  attr.key_size = keySize;
+  attr.value_size = valueSize;
+  attr.max_entries = maxEntries;
+
+  int fd = bpf(BPF_MAP_CREATE, &attr);
+  if (fd < 0) {
+    return ErrnoError("Failed to create BPF map");
+  }
+
+  Try<Nothing> cloexec = os::cloexec(fd);
+  if (cloexec.isError()) {
+    os::close(fd);
+    return Error("Failed to set cloexec on BPF map: " + cloexec.error());
+  }
+
+  return fd;
+}
+
+
+Try<Nothing> updateElement(int fd, const void* key, const void* value)
+{
+  union bpf_attr attr;
+  memset(&attr, 0, sizeof(attr));
+
+  attr.map_fd = fd;
+  attr.key = pointer(key);
+  attr.value = pointer(value);
+  attr.flags = BPF_ANY;
+
+  if (bpf(BPF_MAP_UPDATE_ELEM, &attr) < 0) {
+    return ErrnoError("Failed to update BPF map element");
+  }
+
+  return Nothing();
+}
+
+
+Try<int> load(enum bpf_prog_type type, const Program& program)
+{
+  union bpf_attr attr;
+  memset(&attr, 0, sizeof(attr));
+
+  attr.prog_type = type;
+  attr.insns = pointer(program.data());
+  attr.insn_cnt = program.size();
+  attr.license = pointer(LICENSE);
+
+  int fd = bpf(BPF_PROG_LOAD, &attr);
+
+  if (fd < 0 && errno == EACCES) {
+    // The program got rejected by the verifier, load it once more
+    // to get the log of the verifier. We do not ask for the log in
+    // the first place since that slows down the verification.
+    vector<char> log(LOG_SIZE, '\0');
+
+    attr.log_buf = pointer(log.data());
+    attr.log_size = log.size();
+    attr.log_level = 1;
+
+    fd = bpf(BPF_PROG_LOAD, &attr);
+    if (fd < 0) {
+      return Error(
+          "The BPF program was rejected by the verifier: " +
+          string(log.data()));
+    }
+  } else if (fd < 0) {
+    return ErrnoError("Failed to load BPF program");
+  }
+
+  Try<Nothing> cloexec = os::cloexec(fd);
+  if (cloexec.isError()) {
+    os::close(fd);
+    return Error("Failed to set cloexec on BPF program: " + cloexec.error());
+  }
+
+  return fd;
+}
+
+} // namespace ebpf {
@@ -0,0 +1,187 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __LINUX_EBPF_HPP__
+#define __LINUX_EBPF_HPP__
+
+#include <stdint.h>
+
+#include <linux/bpf.h>
+
+#include <vector>
+
+#include <stout/nothing.hpp>
+#include <stout/try.hpp>
+
+// Helpers for loading extended BPF (eBPF) programs into the kernel
+// and for managing the BPF maps they use. The programs are assembled
+// from the instructions built by the helpers below, which mirror the
+// macros in the kernel's 'include/linux/filter.h'.
+namespace ebpf {
+
+// An eBPF program, i.e., the sequence of its instructions.
+typedef std::vector<struct bpf_insn> Program;
+
+
+// Returns true if the kernel supports the bpf system call.
+bool supported();
+
+
+// Creates a BPF map of the given type and returns its file
+// descriptor. The caller is responsible for closing it.
+Try<int> createMap(
+    enum bpf_map_type type,
+    uint32_t keySize,
+    uint32_t valueSize,
+    uint32_t maxEntries);
+
+
+// Creates or updates the element with the given key in the BPF map.
+Try<Nothing> updateElement(int fd, const void* key, const void* value);
+
+
+// Loads the program into the kernel and returns the file descriptor
+// of the loaded program. The caller is responsible for closing it.
+// The error includes the log of the kernel's verifier if the program
+// got rejected.
+Try<int> load(enum bpf_prog_type type, const Program& program);
+
+
+/////////////////////////////////////////////////
+// Instructions.
+/////////////////////////////////////////////////
+
+inline struct bpf_insn insn(
+    uint8_t code,
+    uint8_t dst,
+    uint8_t src,
+    int16_t off,
+    int32_t imm)
+{
+  struct bpf_insn result;
+  result.code = code;
+  result.dst_reg = dst;
+  result.src_reg = src;
+  result.off = off;
+  result.imm = imm;
+  return result;
+}
+
+
+// dst = src
+inline struct bpf_insn mov64(uint8_t dst, uint8_t src)
+{
+  return insn(BPF_ALU64 | BPF_MOV | BPF_X, dst, src, 0, 0);
+}
+
+
+// dst = imm
+inline struct bpf_insn mov64Imm(uint8_t dst, int32_t imm)
+{
+  return insn(BPF_ALU64 | BPF_MOV | BPF_K, dst, 0, 0, imm);
+}
+
+
+// dst = (uint32_t) imm, i.e., the upper 32 bits of dst are zeroed.
+inline struct bpf_insn mov32Imm(uint8_t dst, int32_t imm)
+{
+  return insn(BPF_ALU | BPF_MOV | BPF_K, dst, 0, 0, imm);
+}
+
+
+// dst = dst <op> imm
+inline struct bpf_insn alu64Imm(uint8_t op, uint8_t dst, int32_t imm)
+{
+  return insn(BPF_ALU64 | BPF_OP(op) | BPF_K, dst, 0, 0, imm);
+}
+
+
+// r0 = ntoh(*(size *) (skb->data + imm)), where 'r6' must hold the
+// context (i.e., the 'struct __sk_buff') of the program. The program
+// exits (returning 0) if the packet is too short.
+inline struct bpf_insn loadAbsolute(uint8_t size, int32_t imm)
+{
+  return insn(BPF_LD | BPF_SIZE(size) | BPF_ABS, 0, 0, 0, imm);
+}
+
+
+// dst = *(size *) (src + off)
+inline struct bpf_insn loadMemory(
+    uint8_t size,
+    uint8_t dst,
+    uint8_t src,
+    int16_t off)
+{
+  return insn(BPF_LDX | BPF_SIZE(size) | BPF_MEM, dst, src, off, 0);
+}
+
+
+// *(size *) (dst + off) = src
+inline struct bpf_insn storeMemory(
+    uint8_t size,
+    uint8_t dst,
+    uint8_t src,
+    int16_t off)
+{
+  return insn(BPF_STX | BPF_SIZE(size) | BPF_MEM, dst, src, off, 0);
+}
+
+
+// if (dst <op> imm) goto pc + off
+// NOTE: 'imm' is sign extended to 64 bits.
+inline struct bpf_insn jumpImm(
+    uint8_t op,
+    uint8_t dst,
+    int32_t imm,
+    int16_t off)
+{
+  return insn(BPF_JMP | BPF_OP(op) | BPF_K, dst, 0, off, imm);
+}
+
+
+// if (dst <op> src) goto pc + off
+inline struct bpf_insn jump(uint8_t op, uint8_t dst, uint8_t src, int16_t off)
+{
+  return insn(BPF_JMP | BPF_OP(op) | BPF_X, dst, src, off, 0);
+}
+
+
+// r0 = function(r1, r2, r3, r4, r5)
+inline struct bpf_insn call(int32_t function)
+{
+  return insn(BPF_JMP | BPF_CALL, 0, 0, 0, function);
+}
+
+
+inline struct bpf_insn exitProgram()
+{
+  return insn(BPF_JMP | BPF_EXIT, 0, 0, 0, 0);
+}
+
+
+// dst = map, i.e., the BPF map with the given file descriptor. Note
+// that this takes up two instructions.
+inline Program loadMap(uint8_t dst, int fd)
+{
+  return {
+    insn(BPF_LD | BPF_DW | BPF_IMM, dst, BPF_PSEUDO_MAP_FD, 0, fd),
+    insn(0, 0, 0, 0, 0)
+  };
+}
+
+} // namespace ebpf {
+
+#endif // __LINUX_EBPF_HPP__
@@ -18,7 +18,12 @@
 #include <stdlib.h>
 #include <unistd.h>
 
+#include <string.h>
+
+#include <linux/perf_event.h>
+
 #include <sys/prctl.h>
+#include <sys/syscall.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 
@@ -26,6 +31,7 @@
 #include <sstream>
 #include <string>
 #include <tuple>
+#include <utility>
 #include <vector>
 
 #include <process/clock.hpp>
@@ -36,7 +42,13 @@
 #include <process/process.hpp>
 #include <process/subprocess.hpp>
 
+#include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/none.hpp>
+#include <stout/numify.hpp>
+#include <stout/option.hpp>
 #include <stout/os.hpp>
+#include <stout/path.hpp>
 #include <stout/strings.hpp>
 
 #include <stout/os/signals.hpp>
@@ -44,6 +56,7 @@
 #include "common/status_utils.hpp"
 
 #include "linux/perf.hpp"
+#include "linux/topology.hpp"
 
 using namespace process;
 
@@ -346,6 +359,278 @@ bool valid(const set<string>& events)
 }
 
 
+namespace internal {
+
+// Returns the type and config of the `perf_event_open` attribute of
+// the (normalized) event, or none if the event is not one that
+// `Counters` knows about.
+Option<std::pair<uint32_t, uint64_t>> attribute(const string& event)
+{
+  static const hashmap<string, std::pair<uint32_t, uint64_t>> events = {
+    // Hardware events.
+    {"cycles", {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES}},
+    {"instructions", {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS}},
+    {"cache_references",
+     {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES}},
+    {"cache_misses", {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES}},
+    {"branches", {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS}},
+    {"branch_misses", {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES}},
+    {"bus_cycles", {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BUS_CYCLES}},
+    {"stalled_cycles_frontend",
+     {PERF_TYPE_HARDWARE, PERF_COUNT_HW_STALLED_CYCLES_FRONTEND}},
+    {"stalled_cycles_backend",
+     {PERF_TYPE_HARDWARE, PERF_COUNT_HW_STALLED_CYCLES_BACKEND}},
+    {"ref_cycles", {PERF_TYPE_HARDWARE, PERF_COUNT_HW_REF_CPU_CYCLES}},
+
+    // Software events.
+    {"cpu_clock", {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_CLOCK}},
+    {"task_clock", {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK}},
+    {"page_faults", {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS}},
+    {"minor_faults", {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS_MIN}},
+    {"major_faults", {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS_MAJ}},
+    {"context_switches",
+     {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES}},
+    {"cpu_migrations", {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_MIGRATIONS}},
+    {"alignment_faults",
+     {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_ALIGNMENT_FAULTS}},
+    {"emulation_faults",
+     {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_EMULATION_FAULTS}},
+  };
+
+  if (events.contains(event)) {
+    return events.at(event);
+  }
+
+  // Hardware cache events are named '<cache>_<operation>[_misses]',
+  // e.g., 'l1_dcache_load_misses'.
+  static const vector<std::pair<string, uint64_t>> caches = {
+    {"l1_dcache_", PERF_COUNT_HW_CACHE_L1D},
+    {"l1_icache_", PERF_COUNT_HW_CACHE_L1I},
+    {"llc_", PERF_COUNT_HW_CACHE_LL},
+    {"dtlb_", PERF_COUNT_HW_CACHE_DTLB},
+    {"itlb_", PERF_COUNT_HW_CACHE_ITLB},
+    {"branch_", PERF_COUNT_HW_CACHE_BPU},
+    {"node_", PERF_COUNT_HW_CACHE_NODE},
+  };
+
+  static const hashmap<string, std::pair<uint64_t, uint64_t>> operations = {
+    {"loads", {PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_ACCESS}},
+    {"load_misses",
+     {PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS}},
+    {"stores",
+     {PERF_COUNT_HW_CACHE_OP_WRITE, PERF_COUNT_HW_CACHE_RESULT_ACCESS}},
+    {"store_misses",
+     {PERF_COUNT_HW_CACHE_OP_WRITE, PERF_COUNT_HW_CACHE_RESULT_MISS}},
+    {"prefetches",
+     {PERF_COUNT_HW_CACHE_OP_PREFETCH, PERF_COUNT_HW_CACHE_RESULT_ACCESS}},
+    {"prefetch_misses",
+     {PERF_COUNT_HW_CACHE_OP_PREFETCH, PERF_COUNT_HW_CACHE_RESULT_MISS}},
+  };
+
+  foreach (const auto& cache, caches) {
+    if (!strings::startsWith(event, cache.first)) {
+      continue;
+    }
+
+    string operation = event.substr(cache.first.size());
+    if (!operations.contains(operation)) {
+      return None();
+    }
+
+    return std::pair<uint32_t, uint64_t>(
+        PERF_TYPE_HW_CACHE,
+        cache.second |
+        (operations.at(operation).first << 8) |
+        (operations.at(operation).second << 16));
+  }
+
+  return None();
+}
+
+} // namespace internal {
+
+
+bool Counters::supported(const set<string>& events)
+{
+  foreach (const string& event, events) {
+    if (internal::attribute(internal::normalize(event)).isNone()) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+
+Try<Owned<Counters>> Counters::create(
+    const set<string>& events,
+    const string& hierarchy,
+    const string& cgroup)
+{
+  Try<set<int>> cpus = topology::cpus();
+  if (cpus.isError()) {
+    return Error(cpus.error());
+  }
+
+  // The counters of a cgroup are opened with the file descriptor of
+  // the cgroup directory. The kernel only supports counting a cgroup
+  // per CPU, hence a counter per event and CPU is opened.
+  string path = path::join(hierarchy, cgroup);
+
+  Try<int> directory = os::open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (directory.isError()) {
+    return Error(
+        "Failed to open cgroup '" + path + "': " + directory.error());
+  }
+
+  vector<Counter> counters;
+
+  auto close = [&counters]() {
+    foreach (const Counter& counter, counters) {
+      os::close(counter.fd);
+    }
+  };
+
+  foreach (const string& event, events) {
+    string normalized = internal::normalize(event);
+
+    Option<std::pair<uint32_t, uint64_t>> attribute =
+      internal::attribute(normalized);
+
+    if (attribute.isNone()) {
+      close();
+      os::close(directory.get());
+      return Error("Unsupported perf event '" + event + "'");
+    }
+
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = attribute->first;
+    attr.size = sizeof(attr);
+    attr.config = attribute->second;
+    attr.read_format =
+      PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    foreach (int cpu, cpus.get()) {
+      int fd = ::syscall(
+          __NR_perf_event_open,
+          &attr,
+          directory.get(),
+          cpu,
+          -1,
+          PERF_FLAG_PID_CGROUP);
+
+      if (fd < 0) {
+        ErrnoError error(
+            "Failed to open a counter for perf event '" + event + "'"
+            " on CPU " + stringify(cpu));
+
+        close();
+        os::close(directory.get());
+        return error;
+      }
+
+      Try<Nothing> cloexec = os::cloexec(fd);
+      if (cloexec.isError()) {
+        os::close(fd);
+        close();
+        os::close(directory.get());
+        return Error(
+            "Failed to set cloexec on a perf event counter: " +
+            cloexec.error());
+      }
+
+      counters.push_back({normalized, fd, 0, 0, 0});
+    }
+  }
+
+  // The counters keep a reference to the cgroup.
+  os::close(directory.get());
+
+  return Owned<Counters>(new Counters(counters));
+}
+
+
+Counters::~Counters()
+{
+  foreach (const Counter& counter, counters) {
+    os::close(counter.fd);
+  }
+}
+
+
+Try<mesos::PerfStatistics> Counters::read()
+{
+  Time now = Clock::now();
+
+  mesos::PerfStatistics statistics;
+  statistics.set_timestamp(start.secs());
+  statistics.set_duration((now - start).secs());
+
+  const google::protobuf::Reflection* reflection =
+    statistics.GetReflection();
+
+  foreach (Counter& counter, counters) {
+    // The value, time enabled and time running of the counter, see
+    // PERF_FORMAT_TOTAL_TIME_ENABLED and PERF_FORMAT_TOTAL_TIME_RUNNING.
+    uint64_t values[3];
+
+    ssize_t length = ::read(counter.fd, values, sizeof(values));
+    if (length != sizeof(values)) {
+      return ErrnoError(
+          "Failed to read the counter of perf event '" + counter.event + "'");
+    }
+
+    uint64_t value = values[0] - counter.value;
+    uint64_t enabled = values[1] - counter.enabled;
+    uint64_t running = values[2] - counter.running;
+
+    counter.value = values[0];
+    counter.enabled = values[1];
+    counter.running = values[2];
+
+    // The kernel multiplexes the counters if there are more counters
+    // than hardware counters, in which case the count is scaled to
+    // the time the counter was enabled.
+    double count = 0;
+    if (running > 0) {
+      count = static_cast<double>(value) * enabled / running;
+    }
+
+    const google::protobuf::FieldDescriptor* field =
+      statistics.GetDescriptor()->FindFieldByName(counter.event);
+
+    if (field == nullptr) {
+      return Error("Unexpected perf event '" + counter.event + "'");
+    }
+
+    // The counts of the different CPUs are summed up. The clocks are
+    // counted in nanoseconds while `perf stat` reports milliseconds.
+    switch (field->type()) {
+      case google::protobuf::FieldDescriptor::TYPE_DOUBLE:
+        reflection->SetDouble(
+            &statistics,
+            field,
+            reflection->GetDouble(statistics, field) + count / 1000000);
+        break;
+      case google::protobuf::FieldDescriptor::TYPE_UINT64:
+        reflection->SetUInt64(
+            &statistics,
+            field,
+            reflection->GetUInt64(statistics, field) +
+              static_cast<uint64_t>(count));
+        break;
+      default:
+        return Error("Unsupported perf field type for '" + counter.event + "'");
+    }
+  }
+
+  start = now;
+
+  return statistics;
+}
+
+
 struct Sample
 {
   const string value;
@@ -354,11 +639,13 @@ struct Sample
 
   // Convert a single line of perf output in CSV format (using
   // PERF_DELIMITER as a separator) to a sample.
-  static Try<Sample> parse(const string& line, const Version& version)
+  static Try<Sample> parse(
+      const strings::View& line,
+      const Version& version)
   {
     // We use strings::split to separate the tokens
     // because the unit field can be empty.
-    vector<string> tokens = strings::split(line, PERF_DELIMITER);
+    vector<strings::View> tokens = strings::split(line, PERF_DELIMITER);
 
     // The following formats are possible:
     //   (1) value,event,cgroup (since Linux v2.6.39)
@@ -370,11 +657,17 @@ struct Sample
     // into older kernel versions.
 
     if (tokens.size() == 3) {
-      return Sample({tokens[0], internal::normalize(tokens[1]), tokens[2]});
+      return Sample({
+          tokens[0].str(),
+          internal::normalize(tokens[1].str()),
+          tokens[2].str()});
     }
 
     if (tokens.size() == 4 || tokens.size() == 6) {
-      return Sample({tokens[0], internal::normalize(tokens[2]), tokens[3]});
+      return Sample({
+          tokens[0].str(),
+          internal::normalize(tokens[2].str()),
+          tokens[3].str()});
     }
 
     // Bail out if the format is not recognized.
@@ -389,11 +682,15 @@ Try<hashmap<string, mesos::PerfStatistics>> parse(
 {
   hashmap<string, mesos::PerfStatistics> statistics;
 
-  foreach (const string& line, strings::tokenize(output, "\n")) {
+  // Lines are only copied to report errors, the output can be large
+  // when sampling many cgroups.
+  const strings::View contents(output);
+
+  foreach (const strings::View& line, strings::tokenize(contents, "\n")) {
     Try<Sample> sample = Sample::parse(line, version);
 
     if (sample.isError()) {
-      return Error("Failed to parse perf sample line '" + line + "': " +
+      return Error("Failed to parse perf sample line '" + line.str() + "': " +
                    sample.error());
     }
 
@@ -409,7 +706,7 @@ Try<hashmap<string, mesos::PerfStatistics>> parse(
 
     if (field == nullptr) {
       return Error("Unexpected event '" + sample->event + "'"
-                   " in perf output at line: " + line);
+                   " in perf output at line: " + line.str());
     }
 
     if (sample->value == "<not supported>") {
@@ -424,7 +721,7 @@ Try<hashmap<string, mesos::PerfStatistics>> parse(
             : numify<double>(sample->value);
 
         if (number.isError()) {
-          return Error("Unable to parse perf value at line: " + line);
+          return Error("Unable to parse perf value at line: " + line.str());
         }
 
         reflection->SetDouble(&(
@@ -437,7 +734,7 @@ Try<hashmap<string, mesos::PerfStatistics>> parse(
             : numify<uint64_t>(sample->value);
 
         if (number.isError()) {
-          return Error("Unable to parse perf value at line: " + line);
+          return Error("Unable to parse perf value at line: " + line.str());
         }
 
         reflection->SetUInt64(&(
@@ -445,7 +742,7 @@ Try<hashmap<string, mesos::PerfStatistics>> parse(
         break;
       }
       default:
-        return Error("Unsupported perf field type at line: " + line);
+        return Error("Unsupported perf field type at line: " + line.str());
       }
   }
 
@@ -21,11 +21,16 @@
 
 #include <set>
 #include <string>
+#include <vector>
 
+#include <process/clock.hpp>
 #include <process/future.hpp>
+#include <process/owned.hpp>
+#include <process/time.hpp>
 
 #include <stout/duration.hpp>
 #include <stout/hashmap.hpp>
+#include <stout/try.hpp>
 #include <stout/version.hpp>
 
 // For PerfStatistics protobuf.
@@ -43,6 +48,58 @@ process::Future<hashmap<std::string, mesos::PerfStatistics>> sample(
     const Duration& duration);
 
 
+// Counts the perf events for the process(es) in a perf_event cgroup
+// using counters that are opened (with `perf_event_open`) once, one
+// per event and CPU, and are then read continuously. Unlike `sample`
+// this doesn't fork `perf stat` and the counts are not limited to
+// sampled windows.
+// NOTE: Only the hardware, software and hardware cache events that
+// have a field in the PerfStatistics protobuf can be counted.
+class Counters
+{
+public:
+  // Returns whether all of the events can be counted by `Counters`.
+  static bool supported(const std::set<std::string>& events);
+
+  // Opens the counters for the events of the process(es) in the
+  // cgroup. The cgroup is relative to the perf_event hierarchy.
+  static Try<process::Owned<Counters>> create(
+      const std::set<std::string>& events,
+      const std::string& hierarchy,
+      const std::string& cgroup);
+
+  ~Counters();
+
+  // Returns the counts since the previous read (or since the counters
+  // were opened), which is the interval covered by the timestamp and
+  // duration of the returned statistics. Counts of counters that got
+  // multiplexed by the kernel are scaled like `perf stat` does.
+  Try<mesos::PerfStatistics> read();
+
+private:
+  struct Counter
+  {
+    std::string event;
+    int fd;
+
+    // The (cumulative) value, time enabled and time running of the
+    // counter at the previous read.
+    uint64_t value;
+    uint64_t enabled;
+    uint64_t running;
+  };
+
+  Counters(const std::vector<Counter>& _counters)
+    : counters(_counters), start(process::Clock::now()) {}
+
+  Counters(const Counters&) = delete;
+  Counters& operator=(const Counters&) = delete;
+
+  std::vector<Counter> counters;
+  process::Time start;
+};
+
+
 // Validate a set of events are accepted by `perf stat`.
 bool valid(const std::set<std::string>& events);
 
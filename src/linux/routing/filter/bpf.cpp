@@ -0,0 +1,237 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <linux/pkt_cls.h>
+
+#include <netlink/attr.h>
+#include <netlink/errno.h>
+#include <netlink/msg.h>
+#include <netlink/netlink.h>
+
+#include <netlink/route/classifier.h>
+#include <netlink/route/tc.h>
+
+#include <string>
+#include <vector>
+
+#include <stout/error.hpp>
+#include <stout/foreach.hpp>
+#include <stout/none.hpp>
+
+#include "linux/routing/handle.hpp"
+#include "linux/routing/internal.hpp"
+
+#include "linux/routing/filter/bpf.hpp"
+#include "linux/routing/filter/internal.hpp"
+#include "linux/routing/filter/priority.hpp"
+
+#include "linux/routing/link/internal.hpp"
+
+// These are only defined in newer kernel headers.
+#ifndef TCA_BPF_FLAG_ACT_DIRECT
+#define TCA_BPF_FLAG_ACT_DIRECT (1 << 0)
+#endif
+
+#ifndef ETH_P_IP
+#define ETH_P_IP 0x0800
+#endif
+
+using std::string;
+using std::vector;
+
+namespace routing {
+
+template <>
+inline void cleanup(struct nl_msg* msg)
+{
+  nlmsg_free(msg);
+}
+
+namespace filter {
+namespace bpf {
+
+// The handle of the BPF filters. Since there is only one BPF filter
+// for a given priority, we use the same handle for all of them so
+// that an existing BPF filter gets replaced when it is created.
+static const uint32_t HANDLE = 1;
+
+
+// Returns the libnl filter (rtnl_cls) of the BPF filter with the
+// given priority attached to the given parent on the link. Returns
+// None if no such filter exists.
+static Result<Netlink<struct rtnl_cls>> getCls(
+    const Netlink<struct rtnl_link>& link,
+    const Handle& parent,
+    const Priority& priority)
+{
+  Try<vector<Netlink<struct rtnl_cls>>> clses =
+    internal::getClses(link, parent);
+
+  if (clses.isError()) {
+    return Error(clses.error());
+  }
+
+  foreach (const Netlink<struct rtnl_cls>& cls, clses.get()) {
+    // NOTE: libnl does not know about the BPF classifier, but it
+    // still decodes the kind and the priority of the filter.
+    const char* kind = rtnl_tc_get_kind(TC_CAST(cls.get()));
+
+    if (kind != nullptr &&
+        string(kind) == "bpf" &&
+        rtnl_cls_get_prio(cls.get()) == priority.get()) {
+      return cls;
+    }
+  }
+
+  return None();
+}
+
+
+Try<bool> exists(
+    const string& _link,
+    const Handle& parent,
+    const Priority& priority)
+{
+  Result<Netlink<struct rtnl_link>> link = link::internal::get(_link);
+  if (link.isError()) {
+    return Error(link.error());
+  } else if (link.isNone()) {
+    return false;
+  }
+
+  Result<Netlink<struct rtnl_cls>> cls = getCls(link.get(), parent, priority);
+  if (cls.isError()) {
+    return Error(cls.error());
+  }
+
+  return cls.isSome();
+}
+
+
+Try<Nothing> create(
+    const string& _link,
+    const Handle& parent,
+    const Priority& priority,
+    int fd,
+    const string& name)
+{
+  Result<Netlink<struct rtnl_link>> link = link::internal::get(_link);
+  if (link.isError()) {
+    return Error(link.error());
+  } else if (link.isNone()) {
+    return Error("Link '" + _link + "' is not found");
+  }
+
+  struct rtnl_cls* c = rtnl_cls_alloc();
+  if (c == nullptr) {
+    return Error("Failed to allocate a libnl filter (rtnl_cls)");
+  }
+
+  Netlink<struct rtnl_cls> cls(c);
+
+  rtnl_tc_set_link(TC_CAST(cls.get()), link.get().get());
+  rtnl_tc_set_parent(TC_CAST(cls.get()), parent.get());
+  rtnl_tc_set_handle(TC_CAST(cls.get()), HANDLE);
+  rtnl_cls_set_prio(cls.get(), priority.get());
+  rtnl_cls_set_protocol(cls.get(), ETH_P_IP);
+
+  int error = rtnl_tc_set_kind(TC_CAST(cls.get()), "bpf");
+  if (error != 0) {
+    return Error(
+        "Failed to set the kind of the classifier: " +
+        string(nl_geterror(error)));
+  }
+
+  // Since libnl does not support the BPF classifier, we encode its
+  // options into the netlink message ourselves.
+  struct nl_msg* m = nullptr;
+  error = rtnl_cls_build_add_request(
+      cls.get(),
+      NLM_F_CREATE | NLM_F_REPLACE,
+      &m);
+
+  if (error != 0) {
+    return Error(
+        "Failed to build the netlink message: " +
+        string(nl_geterror(error)));
+  }
+
+  Netlink<struct nl_msg> msg(m);
+
+  struct nlattr* options = nla_nest_start(msg.get(), TCA_OPTIONS);
+  if (options == nullptr ||
+      nla_put_u32(msg.get(), TCA_BPF_FD, fd) != 0 ||
+      nla_put_string(msg.get(), TCA_BPF_NAME, name.c_str()) != 0 ||
+      nla_put_u32(msg.get(), TCA_BPF_FLAGS, TCA_BPF_FLAG_ACT_DIRECT) != 0) {
+    return Error("Failed to encode the options of the BPF classifier");
+  }
+
+  nla_nest_end(msg.get(), options);
+
+  Try<Netlink<struct nl_sock>> socket = routing::socket();
+  if (socket.isError()) {
+    return Error(socket.error());
+  }
+
+  error = nl_send_auto(socket.get().get(), msg.get());
+  if (error < 0) {
+    return Error(string(nl_geterror(error)));
+  }
+
+  error = nl_wait_for_ack(socket.get().get());
+  if (error != 0) {
+    return Error(string(nl_geterror(error)));
+  }
+
+  return Nothing();
+}
+
+
+Try<bool> remove(
+    const string& _link,
+    const Handle& parent,
+    const Priority& priority)
+{
+  Result<Netlink<struct rtnl_link>> link = link::internal::get(_link);
+  if (link.isError()) {
+    return Error(link.error());
+  } else if (link.isNone()) {
+    return false;
+  }
+
+  Result<Netlink<struct rtnl_cls>> cls = getCls(link.get(), parent, priority);
+  if (cls.isError()) {
+    return Error(cls.error());
+  } else if (cls.isNone()) {
+    return false;
+  }
+
+  Try<Netlink<struct nl_sock>> socket = routing::socket();
+  if (socket.isError()) {
+    return Error(socket.error());
+  }
+
+  int error = rtnl_cls_delete(socket.get().get(), cls.get().get(), 0);
+  if (error != 0) {
+    return Error(string(nl_geterror(error)));
+  }
+
+  return true;
+}
+
+} // namespace bpf {
+} // namespace filter {
+} // namespace routing {
@@ -0,0 +1,74 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __LINUX_ROUTING_FILTER_BPF_HPP__
+#define __LINUX_ROUTING_FILTER_BPF_HPP__
+
+#include <string>
+
+#include <stout/nothing.hpp>
+#include <stout/try.hpp>
+
+#include "linux/routing/handle.hpp"
+
+#include "linux/routing/filter/priority.hpp"
+
+namespace routing {
+namespace filter {
+namespace bpf {
+
+// NOTE: Unlike the other filters, a BPF filter (i.e., a 'cls_bpf'
+// classifier) has no classifier of its own to match packets against.
+// Instead, it runs an eBPF program (of type BPF_PROG_TYPE_SCHED_CLS)
+// on each IP packet, in direct action mode: the program classifies
+// the packet and returns the action to take on it, e.g.,
+// TC_ACT_REDIRECT or TC_ACT_UNSPEC to continue with the next
+// filter. We identify a BPF filter by its parent and its priority.
+
+
+// Returns true if there exists a BPF filter with the given priority
+// attached to the given parent on the link.
+Try<bool> exists(
+    const std::string& link,
+    const Handle& parent,
+    const Priority& priority);
+
+
+// Attaches the loaded eBPF program with the given file descriptor
+// to the given parent on the link, replacing the BPF filter with the
+// given priority if one exists already. The name of the program is
+// only used for debugging purposes (e.g., 'tc filter show').
+Try<Nothing> create(
+    const std::string& link,
+    const Handle& parent,
+    const Priority& priority,
+    int fd,
+    const std::string& name);
+
+
+// Removes the BPF filter with the given priority attached to the
+// given parent from the link. Returns false if such a filter is not
+// found.
+Try<bool> remove(
+    const std::string& link,
+    const Handle& parent,
+    const Priority& priority);
+
+} // namespace bpf {
+} // namespace filter {
+} // namespace routing {
+
+#endif // __LINUX_ROUTING_FILTER_BPF_HPP__
@@ -0,0 +1,188 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <iterator>
+#include <tuple>
+
+#include <stout/foreach.hpp>
+#include <stout/numify.hpp>
+#include <stout/os.hpp>
+#include <stout/path.hpp>
+#include <stout/stringify.hpp>
+#include <stout/strings.hpp>
+
+#include "linux/topology.hpp"
+
+using std::map;
+using std::set;
+using std::string;
+using std::tuple;
+using std::vector;
+
+namespace topology {
+
+static const char SYSFS_CPU[] = "/sys/devices/system/cpu";
+static const char SYSFS_NODE[] = "/sys/devices/system/node";
+
+
+Try<set<int>> parse(const string& list)
+{
+  set<int> result;
+
+  foreach (const string& range, strings::tokenize(list, ",\n")) {
+    vector<string> bounds = strings::split(strings::trim(range), "-");
+
+    Try<int> first = numify<int>(bounds.front());
+    Try<int> last = numify<int>(bounds.back());
+
+    if (bounds.size() > 2 ||
+        first.isError() ||
+        last.isError() ||
+        first.get() > last.get()) {
+      return Error("Failed to parse '" + list + "'");
+    }
+
+    for (int id = first.get(); id <= last.get(); id++) {
+      result.insert(id);
+    }
+  }
+
+  return result;
+}
+
+
+string format(const set<int>& list)
+{
+  vector<string> ranges;
+
+  for (auto it = list.begin(); it != list.end();) {
+    int first = *it;
+    int last = first;
+
+    // Extend the range for as long as the IDs are consecutive.
+    for (++it; it != list.end() && *it == last + 1; ++it) {
+      last = *it;
+    }
+
+    ranges.push_back(
+        first == last
+          ? stringify(first)
+          : stringify(first) + "-" + stringify(last));
+  }
+
+  return strings::join(",", ranges);
+}
+
+
+Try<set<int>> cpus()
+{
+  Try<string> online = os::read(path::join(SYSFS_CPU, "online"));
+  if (online.isError()) {
+    return Error("Failed to read the online CPUs: " + online.error());
+  }
+
+  return parse(online.get());
+}
+
+
+// Returns the given topology value of the CPU, or 0 if the kernel
+// doesn't expose it.
+static int topologyValue(int cpu, const string& name)
+{
+  Try<string> read = os::read(
+      path::join(SYSFS_CPU, "cpu" + stringify(cpu), "topology", name));
+
+  if (read.isError()) {
+    return 0;
+  }
+
+  Try<int> value = numify<int>(strings::trim(read.get()));
+  return value.isSome() ? value.get() : 0;
+}
+
+
+Try<map<int, vector<int>>> nodes()
+{
+  Try<set<int>> online = cpus();
+  if (online.isError()) {
+    return Error(online.error());
+  }
+
+  map<int, set<int>> cpusets;
+
+  if (!os::exists(path::join(SYSFS_NODE, "online"))) {
+    cpusets[0] = online.get();
+  } else {
+    Try<string> read = os::read(path::join(SYSFS_NODE, "online"));
+    if (read.isError()) {
+      return Error("Failed to read the online NUMA nodes: " + read.error());
+    }
+
+    Try<set<int>> nodes = parse(read.get());
+    if (nodes.isError()) {
+      return Error(nodes.error());
+    }
+
+    foreach (int node, nodes.get()) {
+      Try<string> list = os::read(
+          path::join(SYSFS_NODE, "node" + stringify(node), "cpulist"));
+
+      if (list.isError()) {
+        return Error(
+            "Failed to read the CPUs of NUMA node " + stringify(node) +
+            ": " + list.error());
+      }
+
+      Try<set<int>> cpus = parse(list.get());
+      if (cpus.isError()) {
+        return Error(cpus.error());
+      }
+
+      // Nodes without online CPUs (e.g., memory only nodes) are still
+      // included since their memory can be used.
+      std::set_intersection(
+          cpus->begin(), cpus->end(),
+          online->begin(), online->end(),
+          std::inserter(cpusets[node], cpusets[node].begin()));
+    }
+  }
+
+  map<int, vector<int>> result;
+
+  foreach (const auto& cpuset, cpusets) {
+    // Order the CPUs by package and core so that the hardware threads
+    // of a core follow each other.
+    vector<tuple<int, int, int>> cpus;
+    foreach (int cpu, cpuset.second) {
+      cpus.push_back(std::make_tuple(
+          topologyValue(cpu, "physical_package_id"),
+          topologyValue(cpu, "core_id"),
+          cpu));
+    }
+
+    std::sort(cpus.begin(), cpus.end());
+
+    vector<int>& node = result[cpuset.first];
+    foreach (const auto& cpu, cpus) {
+      node.push_back(std::get<2>(cpu));
+    }
+  }
+
+  return result;
+}
+
+} // namespace topology {
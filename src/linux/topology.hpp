@@ -0,0 +1,54 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __LINUX_TOPOLOGY_HPP__
+#define __LINUX_TOPOLOGY_HPP__
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <stout/try.hpp>
+
+// Helpers for discovering the CPU and NUMA topology of the host, see
+// 'Documentation/cputopology.txt' and 'Documentation/ABI/stable/
+// sysfs-devices-node' in the kernel.
+namespace topology {
+
+// Parses a list of CPUs or memory nodes in the format used by sysfs
+// and cpusets, e.g., "0-3,8,10-11".
+Try<std::set<int>> parse(const std::string& list);
+
+
+// Formats the CPUs or memory nodes in the format used by sysfs and
+// cpusets. This is the inverse of `parse`.
+std::string format(const std::set<int>& list);
+
+
+// Returns the online CPUs.
+Try<std::set<int>> cpus();
+
+
+// Returns the online CPUs of each (online) NUMA node. The CPUs of a
+// node are ordered such that the hardware threads of a core follow
+// each other. A host without NUMA support has a single node (node 0)
+// with all online CPUs.
+Try<std::map<int, std::vector<int>>> nodes();
+
+} // namespace topology {
+
+#endif // __LINUX_TOPOLOGY_HPP__
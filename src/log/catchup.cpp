@@ -16,13 +16,22 @@
 
 #include <stdint.h>
 
+#include <algorithm>
 #include <list>
+#include <map>
+#include <set>
 
 #include <process/collect.hpp>
+#include <process/delay.hpp>
 #include <process/id.hpp>
 #include <process/process.hpp>
 #include <process/timer.hpp>
 
+#include <process/metrics/counter.hpp>
+#include <process/metrics/metrics.hpp>
+#include <process/metrics/push_gauge.hpp>
+
+#include <stout/foreach.hpp>
 #include <stout/lambda.hpp>
 #include <stout/stringify.hpp>
 
@@ -34,11 +43,54 @@
 using namespace process;
 
 using std::list;
+using std::map;
+using std::set;
 
 namespace mesos {
 namespace internal {
 namespace log {
 
+// The catch-up metrics, shared by all the catch-up operations in
+// this (libprocess) process.
+struct Metrics
+{
+  Metrics()
+    : transferred("log/catchup/transferred_positions"),
+      truncated("log/catchup/truncated_positions"),
+      filled("log/catchup/filled_positions"),
+      remaining("log/catchup/remaining_positions")
+  {
+    process::metrics::add(transferred);
+    process::metrics::add(truncated);
+    process::metrics::add(filled);
+    process::metrics::add(remaining);
+  }
+
+  // The number of positions caught up by transferring the learned
+  // actions from other replicas.
+  process::metrics::Counter transferred;
+
+  // The number of positions skipped because other replicas have
+  // truncated them.
+  process::metrics::Counter truncated;
+
+  // The number of positions caught up by running Paxos.
+  process::metrics::Counter filled;
+
+  // The number of positions that the ongoing catch-up operations
+  // still need to catch up.
+  process::metrics::PushGauge remaining;
+};
+
+
+static Metrics* metrics()
+{
+  // NOTE: The metrics are never removed.
+  static Metrics* metrics = new Metrics();
+  return metrics;
+}
+
+
 class CatchUpProcess : public Process<CatchUpProcess>
 {
 public:
@@ -165,6 +217,360 @@ static Future<uint64_t> catchup(
 }
 
 
+// Transfers the actions of the missing positions that other replicas
+// have already learned to the local replica, in chunks of up to
+// 'CHUNK' positions, and skips the missing positions that other
+// replicas have already truncated (by learning no-ops for them, as
+// a replica does when it is asked to promise a truncated position).
+// Returns the positions that are still missing, e.g., because no
+// replica that replied has learned them, which need to be caught up
+// using Paxos.
+class TransferProcess : public Process<TransferProcess>
+{
+public:
+  TransferProcess(
+      size_t _quorum,
+      const Shared<Replica>& _replica,
+      const Shared<Network>& _network,
+      const IntervalSet<uint64_t>& _positions,
+      const Duration& _timeout)
+    : ProcessBase(ID::generate("log-transfer")),
+      quorum(_quorum),
+      replica(_replica),
+      network(_network),
+      positions(_positions),
+      timeout(_timeout),
+      current(0),
+      begin(0),
+      chunk(0) {}
+
+  virtual ~TransferProcess() {}
+
+  Future<IntervalSet<uint64_t>> future() { return promise.future(); }
+
+protected:
+  virtual void initialize()
+  {
+    // Stop when no one cares.
+    promise.future().onDiscard(lambda::bind(
+        static_cast<void(*)(const UPID&, bool)>(terminate), self(), true));
+
+    if (positions.empty()) {
+      promise.set(positions);
+      terminate(self());
+      return;
+    }
+
+    checking = replica->missing(
+        positions.begin()->lower(),
+        positions.rbegin()->upper() - 1);
+
+    checking.onAny(defer(self(), &Self::checked));
+  }
+
+  virtual void finalize()
+  {
+    checking.discard();
+    learning.discard();
+
+    metrics()->remaining -= missing.size();
+
+    // TODO(benh): Discard our promise only after 'checking' and
+    // 'learning' have completed (ready, failed, or discarded).
+    promise.discard();
+  }
+
+private:
+  static const uint64_t CHUNK = 1024;
+
+  void checked()
+  {
+    // The future 'checking' can only be discarded in 'finalize'.
+    CHECK(!checking.isDiscarded());
+
+    if (checking.isFailed()) {
+      promise.fail("Failed to get missing positions: " + checking.failure());
+      terminate(self());
+      return;
+    }
+
+    missing = checking.get();
+    missing &= positions;
+
+    metrics()->remaining += missing.size();
+
+    LOG(INFO) << "Transferring " << missing.size()
+              << " missing positions from other replicas";
+
+    transfer();
+  }
+
+  void transfer()
+  {
+    // Find the first missing position at or after 'current' and
+    // request the chunk starting at it.
+    IntervalSet<uint64_t> next = missing;
+    next -= (Bound<uint64_t>::closed(0), Bound<uint64_t>::open(current));
+
+    if (next.empty()) {
+      truncate();
+      return;
+    }
+
+    const uint64_t from = next.begin()->lower();
+    const uint64_t to = std::min(next.begin()->upper(), from + CHUNK) - 1;
+
+    chunk++;
+    responses.clear();
+    received = 0;
+    okays = 0;
+    covered = None();
+    actions.clear();
+
+    TransferRequest request;
+    request.set_from(from);
+    request.set_to(to);
+
+    network->broadcast(protocol::transfer, request)
+      .onAny(defer(self(), &Self::broadcasted, chunk, from, to, lambda::_1));
+
+    timer = delay(timeout, self(), &Self::transferred, chunk, from, to);
+  }
+
+  void broadcasted(
+      uint64_t _chunk,
+      uint64_t from,
+      uint64_t to,
+      const Future<set<Future<TransferResponse>>>& future)
+  {
+    if (_chunk != chunk) {
+      return;
+    }
+
+    if (!future.isReady()) {
+      promise.fail(
+          future.isFailed() ?
+          "Failed to broadcast transfer request: " + future.failure() :
+          "Not expecting discarded future");
+      terminate(self());
+      return;
+    }
+
+    responses = future.get();
+    foreach (const Future<TransferResponse>& response, responses) {
+      response.onAny(defer(
+          self(), &Self::_received, _chunk, from, to, lambda::_1));
+    }
+  }
+
+  void _received(
+      uint64_t _chunk,
+      uint64_t from,
+      uint64_t to,
+      const Future<TransferResponse>& future)
+  {
+    if (_chunk != chunk) {
+      return;
+    }
+
+    received++;
+
+    if (future.isReady() && future->okay()) {
+      const TransferResponse& response = future.get();
+
+      okays++;
+
+      begin = std::max(begin, response.begin());
+
+      const uint64_t last = response.has_to() ? response.to() : to;
+      covered = std::max(covered.getOrElse(from), std::min(last, to));
+
+      // The learned actions of a position are the same in all the
+      // replicas (they have been agreed upon), so we can take the
+      // action of a position from any replica.
+      foreach (const Action& action, response.actions()) {
+        if (action.has_learned() && action.learned() &&
+            action.position() >= from && action.position() <= to &&
+            missing.contains(action.position())) {
+          actions[action.position()] = action;
+        }
+      }
+    }
+
+    // We don't wait for the replicas that are down (or are running
+    // an old version which doesn't reply to transfer requests) once
+    // a quorum of replicas have replied.
+    if (okays >= quorum || received == responses.size()) {
+      transferred(_chunk, from, to);
+    }
+  }
+
+  void transferred(uint64_t _chunk, uint64_t from, uint64_t to)
+  {
+    if (_chunk != chunk) {
+      return;
+    }
+
+    chunk++; // Ignore the rest of the responses.
+
+    Clock::cancel(timer);
+
+    if (okays == 0) {
+      LOG(INFO) << "No replica replied to the transfer request for "
+                << "positions " << from << " -> " << to
+                << ", catching up the missing positions using Paxos";
+
+      truncate();
+      return;
+    }
+
+    // Continue after the positions covered by the responses, or at
+    // the beginning of the log if other replicas have truncated those
+    // positions already.
+    CHECK_SOME(covered);
+    current = std::max(covered.get() + 1, begin);
+
+    if (actions.empty()) {
+      transfer();
+      return;
+    }
+
+    list<Action> batch;
+    foreach (const auto& action, actions) {
+      batch.push_back(action.second);
+    }
+
+    learn(batch, false);
+  }
+
+  void truncate()
+  {
+    // Learn no-ops for (up to a chunk of) the missing positions that
+    // other replicas have truncated.
+    IntervalSet<uint64_t> truncated = missing;
+    truncated &= (Bound<uint64_t>::closed(0), Bound<uint64_t>::open(begin));
+
+    if (truncated.empty()) {
+      promise.set(missing);
+      terminate(self());
+      return;
+    }
+
+    list<Action> nops;
+    foreach (const Interval<uint64_t>& interval, truncated) {
+      for (uint64_t position = interval.lower();
+           position < interval.upper() && nops.size() < CHUNK;
+           position++) {
+        Action action;
+        action.set_position(position);
+        action.set_promised(0);
+        action.set_performed(0);
+        action.set_learned(true);
+        action.set_type(Action::NOP);
+        action.mutable_nop()->MergeFrom(Action::Nop());
+
+        nops.push_back(action);
+      }
+    }
+
+    learn(nops, true);
+  }
+
+  // Persists the actions in the local replica and continues with
+  // 'truncate' if they are no-ops for truncated positions, or with
+  // 'transfer' otherwise.
+  void learn(const list<Action>& actions, bool truncated)
+  {
+    learning = replica->learn(actions);
+    learning.onAny(defer(self(), &Self::learned, actions, truncated));
+  }
+
+  void learned(const list<Action>& actions, bool truncated)
+  {
+    // The future 'learning' can only be discarded in 'finalize'.
+    CHECK(!learning.isDiscarded());
+
+    if (learning.isFailed()) {
+      promise.fail("Failed to persist actions: " + learning.failure());
+      terminate(self());
+      return;
+    } else if (!learning.get()) {
+      promise.fail("Failed to persist actions");
+      terminate(self());
+      return;
+    }
+
+    foreach (const Action& action, actions) {
+      missing -= action.position();
+    }
+
+    if (truncated) {
+      metrics()->truncated += actions.size();
+    } else {
+      metrics()->transferred += actions.size();
+    }
+
+    metrics()->remaining -= actions.size();
+
+    if (truncated) {
+      truncate();
+    } else {
+      transfer();
+    }
+  }
+
+  const size_t quorum;
+  const Shared<Replica> replica;
+  const Shared<Network> network;
+  const IntervalSet<uint64_t> positions;
+  const Duration timeout;
+
+  // The positions that are still missing in the local replica.
+  IntervalSet<uint64_t> missing;
+
+  // The position from which to transfer the next chunk.
+  uint64_t current;
+
+  // The highest beginning position of the log seen in the responses.
+  uint64_t begin;
+
+  // The state of the transfer of the current chunk. The responses to
+  // the transfer of an earlier chunk are ignored.
+  uint64_t chunk;
+  set<Future<TransferResponse>> responses;
+  size_t received;
+  size_t okays;
+  Option<uint64_t> covered;
+  map<uint64_t, Action> actions;
+  Timer timer;
+
+  process::Promise<IntervalSet<uint64_t>> promise;
+  Future<IntervalSet<uint64_t>> checking;
+  Future<bool> learning;
+};
+
+
+static Future<IntervalSet<uint64_t>> transfer(
+    size_t quorum,
+    const Shared<Replica>& replica,
+    const Shared<Network>& network,
+    const IntervalSet<uint64_t>& positions,
+    const Duration& timeout)
+{
+  TransferProcess* process =
+    new TransferProcess(
+        quorum,
+        replica,
+        network,
+        positions,
+        timeout);
+
+  Future<IntervalSet<uint64_t>> future = process->future();
+  spawn(process, true);
+  return future;
+}
+
+
 // TODO(jieyu): Our current implementation catches-up each position in
 // the set sequentially. In the future, we may want to parallelize it
 // to improve the performance. Also, we may want to implement rate
@@ -201,6 +607,8 @@ protected:
     // Catch-up sequentially.
     current = positions.lower();
 
+    metrics()->remaining += positions.upper() - positions.lower();
+
     catchup();
   }
 
@@ -208,6 +616,8 @@ protected:
   {
     catching.discard();
 
+    metrics()->remaining -= positions.upper() - current;
+
     // TODO(benh): Discard our promise only after 'catching' has
     // completed (ready, failed, or discarded).
     promise.discard();
@@ -261,6 +671,9 @@ private:
   {
     ++current;
 
+    ++metrics()->filled;
+    --metrics()->remaining;
+
     // The single position catch-up function: 'log::catchup' will
     // return the highest proposal number seen so far. We use this
     // proposal number for the next 'catchup' as it is highly likely
@@ -308,12 +721,9 @@ static Future<Nothing> catchup(
 }
 
 
-/////////////////////////////////////////////////
-// Public interfaces below.
-/////////////////////////////////////////////////
-
-
-Future<Nothing> catchup(
+// Catches-up the positions that could not be transferred using
+// Paxos, one interval at a time.
+static Future<Nothing> _catchup(
     size_t quorum,
     const Shared<Replica>& replica,
     const Shared<Network>& network,
@@ -347,6 +757,31 @@ Future<Nothing> catchup(
   return future;
 }
 
+
+/////////////////////////////////////////////////
+// Public interfaces below.
+/////////////////////////////////////////////////
+
+
+Future<Nothing> catchup(
+    size_t quorum,
+    const Shared<Replica>& replica,
+    const Shared<Network>& network,
+    const Option<uint64_t>& proposal,
+    const IntervalSet<uint64_t>& positions,
+    const Duration& timeout)
+{
+  return transfer(quorum, replica, network, positions, timeout)
+    .then(lambda::bind(
+        &_catchup,
+        quorum,
+        replica,
+        network,
+        proposal,
+        lambda::_1,
+        timeout));
+}
+
 } // namespace log {
 } // namespace internal {
 } // namespace mesos {
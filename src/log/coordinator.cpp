@@ -17,14 +17,17 @@
 #include <stdint.h>
 
 #include <algorithm>
+#include <deque>
 
 #include <mesos/type_utils.hpp>
 
 #include <process/defer.hpp>
 #include <process/dispatch.hpp>
 #include <process/id.hpp>
+#include <process/owned.hpp>
 #include <process/process.hpp>
 
+#include <stout/foreach.hpp>
 #include <stout/none.hpp>
 
 #include "log/catchup.hpp"
@@ -35,6 +38,7 @@
 
 using namespace process;
 
+using std::deque;
 using std::string;
 
 namespace mesos {
@@ -68,7 +72,11 @@ protected:
   virtual void finalize()
   {
     electing.discard();
-    writing.discard();
+
+    foreach (const Owned<Write>& write, writes) {
+      write->future.discard();
+      write->promise.discard();
+    }
   }
 
 private:
@@ -99,10 +107,9 @@ private:
       const WriteResponse& response);
   Future<Nothing> runLearnPhase(const Action& action);
   Future<bool> checkLearnPhase(const Action& action);
-  Future<Option<uint64_t>> updateIndexAfterWritten(bool missing);
-  void writingFinished();
-  void writingFailed();
-  void writingAborted();
+  Future<Option<uint64_t>> checkLearned(const Action& action, bool missing);
+  void written();
+  void discardWrite(uint64_t position);
 
   const size_t quorum;
   const Shared<Replica> replica;
@@ -115,7 +122,8 @@ private:
   // coordinator does not declare itself as elected until it wins the
   // election and has filled all existing positions. A coordinator is
   // put in electing state after it decides to go for an election and
-  // before it is elected.
+  // before it is elected. An elected coordinator is in writing state
+  // while any of its writes are in progress.
   enum
   {
     INITIAL,
@@ -131,7 +139,24 @@ private:
   uint64_t index;
 
   Future<Option<uint64_t>> electing;
-  Future<Option<uint64_t>> writing;
+
+  // A write to a position, which can be in progress at the same time
+  // as the writes to the positions before and after it. Its result is
+  // returned once all the writes to earlier positions have completed,
+  // so that writes complete in the order they were started.
+  struct Write
+  {
+    uint64_t position;
+
+    // The write (and learn) phases of the write.
+    Future<Option<uint64_t>> future;
+
+    // Completed with the result of 'future', in order.
+    process::Promise<Option<uint64_t>> promise;
+  };
+
+  // The writes in progress, in the order of their positions.
+  deque<Owned<Write>> writes;
 };
 
 
@@ -307,8 +332,6 @@ Future<Option<uint64_t>> CoordinatorProcess::append(const string& bytes)
 {
   if (state == INITIAL || state == ELECTING) {
     return None();
-  } else if (state == WRITING) {
-    return Failure("Coordinator is currently writing");
   }
 
   Action action;
@@ -327,8 +350,6 @@ Future<Option<uint64_t>> CoordinatorProcess::truncate(uint64_t to)
 {
   if (state == INITIAL || state == ELECTING) {
     return None();
-  } else if (state == WRITING) {
-    return Failure("Coordinator is currently writing");
   }
 
   Action action;
@@ -348,18 +369,32 @@ Future<Option<uint64_t>> CoordinatorProcess::write(const Action& action)
   LOG(INFO) << "Coordinator attempting to write " << action.type()
             << " action at position " << action.position();
 
-  CHECK_EQ(state, ELECTED);
+  CHECK(state == ELECTED || state == WRITING);
   CHECK(action.has_performed() && action.has_type());
+  CHECK_EQ(action.position(), index);
 
   state = WRITING;
 
-  writing = runWritePhase(action)
-    .then(defer(self(), &Self::checkWritePhase, action, lambda::_1))
-    .onReady(defer(self(), &Self::writingFinished))
-    .onFailed(defer(self(), &Self::writingFailed))
-    .onDiscarded(defer(self(), &Self::writingAborted));
+  // The position is taken when the write is started rather than when
+  // it completes, so that the next write can be started right away.
+  index++;
+
+  Owned<Write> pending(new Write());
+  pending->position = action.position();
+  pending->future = runWritePhase(action)
+    .then(defer(self(), &Self::checkWritePhase, action, lambda::_1));
+
+  pending->future
+    .onAny(defer(self(), &Self::written));
+
+  Future<Option<uint64_t>> future = pending->promise.future();
 
-  return writing;
+  future
+    .onDiscard(defer(self(), &Self::discardWrite, action.position()));
+
+  writes.push_back(pending);
+
+  return future;
 }
 
 
@@ -383,7 +418,7 @@ Future<Option<uint64_t>> CoordinatorProcess::checkWritePhase(
 
   return runLearnPhase(action)
     .then(defer(self(), &Self::checkLearnPhase, action))
-    .then(defer(self(), &Self::updateIndexAfterWritten, lambda::_1));
+    .then(defer(self(), &Self::checkLearned, action, lambda::_1));
 }
 
 
@@ -402,39 +437,69 @@ Future<bool> CoordinatorProcess::checkLearnPhase(const Action& action)
 }
 
 
-Future<Option<uint64_t>> CoordinatorProcess::updateIndexAfterWritten(
+Future<Option<uint64_t>> CoordinatorProcess::checkLearned(
+    const Action& action,
     bool missing)
 {
   CHECK(!missing) << "Not expecting local replica to be missing position "
-                  << index << " after the writing is done";
+                  << action.position() << " after the writing is done";
 
-  return index++;
+  return action.position();
 }
 
 
-void CoordinatorProcess::writingFinished()
+void CoordinatorProcess::written()
 {
-  CHECK_EQ(state, WRITING);
-  state = ELECTED;
-}
+  // Return the results of the writes in the order of their positions.
+  while (!writes.empty() && !writes.front()->future.isPending()) {
+    Owned<Write> write = writes.front();
+    writes.pop_front();
+
+    const Future<Option<uint64_t>>& future = write->future;
+
+    if (future.isReady() && future->isSome()) {
+      write->promise.set(future.get());
+      continue;
+    }
+
+    if (future.isReady()) {
+      // Received a NACK, i.e., another coordinator has been elected.
+      write->promise.set(Option<uint64_t>::none());
+    } else if (future.isFailed()) {
+      write->promise.fail(future.failure());
+    } else {
+      write->promise.discard();
+    }
+
+    // Demote the coordinator since we don't actually know whether the
+    // write was successful and we need to "catch-up" that position
+    // before we try and do another write (see MESOS-1038 for more
+    // details). The writes to later positions are not returned as
+    // successful, even if they completed, since that would leave a
+    // gap before them.
+    state = INITIAL;
 
+    while (!writes.empty()) {
+      writes.front()->future.discard();
+      writes.front()->promise.set(Option<uint64_t>::none());
+      writes.pop_front();
+    }
+  }
 
-void CoordinatorProcess::writingFailed()
-{
-  CHECK_EQ(state, WRITING);
-  state = INITIAL;
+  if (state == WRITING && writes.empty()) {
+    state = ELECTED;
+  }
 }
 
 
-void CoordinatorProcess::writingAborted()
+void CoordinatorProcess::discardWrite(uint64_t position)
 {
-  CHECK_EQ(state, WRITING);
-
-  // Demote the coordinator if a write operation is discarded since we
-  // don't actually know the write was successful or not and we really
-  // need to "catch-up" that position before we try and do another
-  // write (see MESOS-1038 for more details).
-  state = INITIAL;
+  foreach (const Owned<Write>& write, writes) {
+    if (write->position == position) {
+      write->future.discard();
+      break;
+    }
+  }
 }
 
 
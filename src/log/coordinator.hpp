@@ -61,6 +61,13 @@ public:
   // Appends the specified bytes to the end of the log. Returns the
   // position of the appended entry if the operation succeeds or none
   // if the coordinator was demoted.
+  //
+  // An append (or truncate) can be started while earlier ones are
+  // still in progress, in which case their writes to the replicas
+  // are pipelined. The operations take consecutive positions in the
+  // order they were started and complete in that order. If one of
+  // them does not succeed, the coordinator is demoted and the later
+  // ones return none.
   process::Future<Option<uint64_t>> append(const std::string& bytes);
 
   // Removes all log entries preceding the log entry at the given
@@ -277,13 +277,13 @@ Try<Storage::State> LevelDBStorage::restore(const string& path)
 }
 
 
-Try<Nothing> LevelDBStorage::persist(const Metadata& metadata)
+Try<Nothing> LevelDBStorage::persist(const Metadata& metadata, bool sync)
 {
   Stopwatch stopwatch;
   stopwatch.start();
 
   leveldb::WriteOptions options;
-  options.sync = true;
+  options.sync = sync;
 
   Record record;
   record.set_type(Record::METADATA);
@@ -308,7 +308,7 @@ Try<Nothing> LevelDBStorage::persist(const Metadata& metadata)
 }
 
 
-Try<Nothing> LevelDBStorage::persist(const Action& action)
+Try<Nothing> LevelDBStorage::persist(const Action& action, bool sync)
 {
   Stopwatch stopwatch;
   stopwatch.start();
@@ -324,7 +324,7 @@ Try<Nothing> LevelDBStorage::persist(const Action& action)
   }
 
   leveldb::WriteOptions options;
-  options.sync = true;
+  options.sync = sync;
 
   leveldb::Status status = db->Put(options, encode(action.position()), value);
 
@@ -406,6 +406,31 @@ Try<Nothing> LevelDBStorage::persist(const Action& action)
 }
 
 
+Try<Nothing> LevelDBStorage::sync()
+{
+  Stopwatch stopwatch;
+  stopwatch.start();
+
+  // Writing an empty batch with 'sync' set flushes the leveldb log,
+  // which makes all the records written before it durable too (the
+  // log is replayed in order on recovery).
+  leveldb::WriteBatch batch;
+
+  leveldb::WriteOptions options;
+  options.sync = true;
+
+  leveldb::Status status = db->Write(options, &batch);
+
+  if (!status.ok()) {
+    return Error(status.ToString());
+  }
+
+  VLOG(1) << "Syncing leveldb took " << stopwatch.elapsed();
+
+  return Nothing();
+}
+
+
 Try<Action> LevelDBStorage::read(uint64_t position)
 {
   Stopwatch stopwatch;
@@ -37,8 +37,9 @@ public:
   virtual ~LevelDBStorage();
 
   virtual Try<State> restore(const std::string& path);
-  virtual Try<Nothing> persist(const Metadata& metadata);
-  virtual Try<Nothing> persist(const Action& action);
+  virtual Try<Nothing> persist(const Metadata& metadata, bool sync);
+  virtual Try<Nothing> persist(const Action& action, bool sync);
+  virtual Try<Nothing> sync();
   virtual Try<Action> read(uint64_t position);
 
 private:
@@ -18,6 +18,8 @@
 
 #include <stdint.h>
 
+#include <algorithm>
+
 #include <mesos/log/log.hpp>
 
 #include <process/defer.hpp>
@@ -51,6 +53,7 @@ using mesos::log::Log;
 
 using mesos::internal::log::LogProcess;
 using mesos::internal::log::LogReaderProcess;
+using mesos::internal::log::LogStreamProcess;
 using mesos::internal::log::LogWriterProcess;
 
 namespace mesos {
@@ -399,6 +402,21 @@ Future<Log::Position> LogReaderProcess::_ending()
 }
 
 
+Future<Log::Position> LogReaderProcess::follow(const Log::Position& from)
+{
+  return recover().then(defer(self(), &Self::_follow, from));
+}
+
+
+Future<Log::Position> LogReaderProcess::_follow(const Log::Position& from)
+{
+  CHECK_READY(recovering);
+
+  return recovering.get()->follow(from.value)
+    .then(lambda::bind(&Self::position, lambda::_1));
+}
+
+
 Future<list<Log::Entry>> LogReaderProcess::read(
     const Log::Position& from,
     const Log::Position& to)
@@ -454,6 +472,98 @@ Log::Position LogReaderProcess::position(uint64_t value)
 }
 
 
+/////////////////////////////////////////////////
+// Implementation of LogStreamProcess.
+/////////////////////////////////////////////////
+
+
+LogStreamProcess::LogStreamProcess(
+    Log* log,
+    const Log::Position& from,
+    size_t _chunk,
+    bool _follow)
+  : ProcessBase(ID::generate("log-stream")),
+    reader(log),
+    chunk(_chunk),
+    follow(_follow),
+    next(from.value)
+{
+  CHECK_GT(chunk, 0u);
+}
+
+
+void LogStreamProcess::finalize()
+{
+  // Stop waiting for new entries, if following.
+  if (prefetched.isSome()) {
+    prefetched->discard();
+  }
+}
+
+
+Future<list<Log::Entry>> LogStreamProcess::read()
+{
+  Future<list<Log::Entry>> entries =
+    prefetched.isSome() ? prefetched.get() : fetch();
+
+  prefetched = None();
+
+  return entries.then(defer(self(), &Self::_read, lambda::_1));
+}
+
+
+list<Log::Entry> LogStreamProcess::_read(const list<Log::Entry>& entries)
+{
+  // Prefetch the next chunk while the caller processes this one. We
+  // never read further ahead, so at most two chunks are in memory.
+  if (!entries.empty()) {
+    prefetched = fetch();
+  }
+
+  return entries;
+}
+
+
+Future<list<Log::Entry>> LogStreamProcess::fetch()
+{
+  // When following, wait for the next position to be learned rather
+  // than reading up to the last written (possibly unlearned) one.
+  Future<Log::Position> ending =
+    follow ? reader.follow(Log::Position(next)) : reader.ending();
+
+  return ending.then(defer(self(), &Self::_fetch, lambda::_1));
+}
+
+
+Future<list<Log::Entry>> LogStreamProcess::_fetch(const Log::Position& ending)
+{
+  if (ending.value < next) {
+    CHECK(!follow);
+    return list<Log::Entry>();
+  }
+
+  uint64_t to = std::min(ending.value, next + chunk - 1);
+
+  return reader.read(Log::Position(next), Log::Position(to))
+    .then(defer(self(), &Self::__fetch, to, lambda::_1));
+}
+
+
+Future<list<Log::Entry>> LogStreamProcess::__fetch(
+    uint64_t to,
+    const list<Log::Entry>& entries)
+{
+  next = to + 1;
+
+  // An empty chunk is only returned at the end of the log.
+  if (entries.empty()) {
+    return fetch();
+  }
+
+  return entries;
+}
+
+
 /////////////////////////////////////////////////
 // Implementation of LogWriterProcess.
 /////////////////////////////////////////////////
@@ -731,6 +841,42 @@ Future<Log::Position> Log::Reader::ending()
 }
 
 
+Future<Log::Position> Log::Reader::follow(const Log::Position& from)
+{
+  return dispatch(process, &LogReaderProcess::follow, from);
+}
+
+
+/////////////////////////////////////////////////
+// Public interfaces for Log::Stream.
+/////////////////////////////////////////////////
+
+
+Log::Stream::Stream(
+    Log* log,
+    const Log::Position& from,
+    size_t chunk,
+    bool follow)
+{
+  process = new LogStreamProcess(log, from, chunk, follow);
+  spawn(process);
+}
+
+
+Log::Stream::~Stream()
+{
+  terminate(process);
+  process::wait(process);
+  delete process;
+}
+
+
+Future<list<Log::Entry>> Log::Stream::read()
+{
+  return dispatch(process, &LogStreamProcess::read);
+}
+
+
 /////////////////////////////////////////////////
 // Public interfaces for Log::Writer.
 /////////////////////////////////////////////////
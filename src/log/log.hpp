@@ -19,6 +19,8 @@
 
 #include <stdint.h>
 
+#include <list>
+
 #include <mesos/log/log.hpp>
 
 #include <process/future.hpp>
@@ -29,6 +31,7 @@
 #include <process/metrics/gauge.hpp>
 
 #include <stout/nothing.hpp>
+#include <stout/option.hpp>
 
 #include "log/coordinator.hpp"
 #include "log/network.hpp"
@@ -125,6 +128,9 @@ public:
       const mesos::log::Log::Position& from,
       const mesos::log::Log::Position& to);
 
+  process::Future<mesos::log::Log::Position> follow(
+      const mesos::log::Log::Position& from);
+
 protected:
   virtual void initialize();
   virtual void finalize();
@@ -142,6 +148,8 @@ private:
 
   process::Future<mesos::log::Log::Position> _beginning();
   process::Future<mesos::log::Log::Position> _ending();
+  process::Future<mesos::log::Log::Position> _follow(
+      const mesos::log::Log::Position& from);
 
   process::Future<std::list<mesos::log::Log::Entry>> _read(
       const mesos::log::Log::Position& from,
@@ -157,6 +165,48 @@ private:
 };
 
 
+class LogStreamProcess : public process::Process<LogStreamProcess>
+{
+public:
+  LogStreamProcess(
+      mesos::log::Log* log,
+      const mesos::log::Log::Position& from,
+      size_t _chunk,
+      bool _follow);
+
+  process::Future<std::list<mesos::log::Log::Entry>> read();
+
+protected:
+  virtual void finalize();
+
+private:
+  // Reads the chunk starting at the next position, skipping the
+  // chunks that contain no entries (e.g., only truncations).
+  process::Future<std::list<mesos::log::Log::Entry>> fetch();
+
+  // Continuations.
+  std::list<mesos::log::Log::Entry> _read(
+      const std::list<mesos::log::Log::Entry>& entries);
+
+  process::Future<std::list<mesos::log::Log::Entry>> _fetch(
+      const mesos::log::Log::Position& ending);
+
+  process::Future<std::list<mesos::log::Log::Entry>> __fetch(
+      uint64_t to,
+      const std::list<mesos::log::Log::Entry>& entries);
+
+  mesos::log::Log::Reader reader;
+  const size_t chunk;
+  const bool follow;
+
+  // The position from which the next chunk is read.
+  uint64_t next;
+
+  // The next chunk, read while the caller processes the last one.
+  Option<process::Future<std::list<mesos::log::Log::Entry>>> prefetched;
+};
+
+
 class LogWriterProcess : public process::Process<LogWriterProcess>
 {
 public:
@@ -17,24 +17,29 @@
 #include <stdint.h>
 
 #include <algorithm>
+#include <utility>
 
 #include <mesos/type_utils.hpp>
 
 #include <process/dispatch.hpp>
 #include <process/id.hpp>
+#include <process/owned.hpp>
 
+#include <stout/bytes.hpp>
 #include <stout/check.hpp>
 #include <stout/error.hpp>
 #include <stout/exit.hpp>
 #include <stout/foreach.hpp>
 #include <stout/none.hpp>
 #include <stout/nothing.hpp>
+#include <stout/option.hpp>
 #include <stout/result.hpp>
 #include <stout/try.hpp>
 #include <stout/utils.hpp>
 
 #ifndef __WINDOWS__
 #include "log/leveldb.hpp"
+#include "log/segmented.hpp"
 #endif // __WINDOWS__
 #include "log/replica.hpp"
 #include "log/storage.hpp"
@@ -42,6 +47,7 @@
 using namespace process;
 
 using std::list;
+using std::pair;
 using std::string;
 
 namespace mesos {
@@ -54,6 +60,7 @@ namespace protocol {
 Protocol<PromiseRequest, PromiseResponse> promise;
 Protocol<WriteRequest, WriteResponse> write;
 Protocol<RecoverRequest, RecoverResponse> recover;
+Protocol<TransferRequest, TransferResponse> transfer;
 
 } // namespace protocol {
 
@@ -93,6 +100,10 @@ public:
   // Returns the last written position in the log.
   uint64_t ending();
 
+  // Returns the last position up to which the log can be read from
+  // the specified position, once the specified position is learned.
+  Future<uint64_t> follow(uint64_t position);
+
   // Returns the current status of this replica.
   Metadata::Status status();
 
@@ -103,6 +114,13 @@ public:
   // to storage. Returns true on success and false otherwise.
   bool update(const Metadata::Status& status);
 
+  // Persists the specified learned actions and syncs the storage.
+  // Returns true on success and false otherwise.
+  bool learn(const list<Action>& actions);
+
+protected:
+  virtual void finalize();
+
 private:
   // Handles a request from a proposer to promise not to accept writes
   // from any other proposer with lower proposal number.
@@ -117,15 +135,40 @@ private:
   // Handles a message notifying of a learned action.
   void learned(const UPID& from, const Action& action);
 
+  // Handles a request from a catching-up replica to transfer the
+  // actions learned by this replica.
+  void transfer(const UPID& from, const TransferRequest& request);
+
   // Persists the specified action to storage. Returns true on success
-  // and false otherwise.
+  // and false otherwise. The action is only durable once it has been
+  // committed (see 'commit').
   bool persist(const Action& action);
 
   // Updates the highest promise this replica has given. The update
-  // will be persisted to storage. Returns true on success and false
-  // otherwise.
+  // will be persisted to storage (see 'persist'). Returns true on
+  // success and false otherwise.
   bool updatePromised(uint64_t promised);
 
+  // Sends the response once everything persisted so far has been
+  // committed, since a response must not be sent for an action (or
+  // a promise) that could still be lost.
+  void respond(const UPID& to, const google::protobuf::Message& response);
+
+  // Makes everything persisted since the last commit durable with a
+  // single sync of the storage and then sends the pending responses.
+  // A commit is dispatched when the first record is persisted after
+  // the last commit, so all the requests already queued (e.g., while
+  // the previous sync was blocking this process) are committed
+  // together.
+  void commit();
+
+  // Returns the last position up to which the log can be read from
+  // the specified position, or none if that position is missing.
+  Option<uint64_t> readable(uint64_t position);
+
+  // Satisfies the followers whose positions have been learned.
+  void notify();
+
   // Helper routine to restore log (e.g., on restart).
   void restore(const string& path);
 
@@ -147,16 +190,30 @@ private:
 
   // Unlearned positions in the log.
   IntervalSet<uint64_t> unlearned;
+
+  // Whether a commit has been dispatched but not yet run.
+  bool committing;
+
+  // The responses to send on the next commit.
+  list<pair<UPID, Owned<google::protobuf::Message>>> responses;
+
+  // The followers waiting for a position to be learned.
+  list<pair<uint64_t, Owned<process::Promise<uint64_t>>>> followers;
 };
 
 
 ReplicaProcess::ReplicaProcess(const string& path)
   : ProcessBase(ID::generate("log-replica")),
     begin(0),
-    end(0)
+    end(0),
+    committing(false)
 {
   // TODO(benh): Factor out and expose storage.
-  storage = new LevelDBStorage();
+  if (SegmentedStorage::exists(path)) {
+    storage = new SegmentedStorage();
+  } else {
+    storage = new LevelDBStorage();
+  }
 
   restore(path);
 
@@ -173,6 +230,9 @@ ReplicaProcess::ReplicaProcess(const string& path)
   install<LearnedMessage>(
       &ReplicaProcess::learned,
       &LearnedMessage::action);
+
+  install<TransferRequest>(
+      &ReplicaProcess::transfer);
 }
 
 
@@ -182,6 +242,15 @@ ReplicaProcess::~ReplicaProcess()
 }
 
 
+void ReplicaProcess::finalize()
+{
+  foreach (const auto& follower, followers) {
+    follower.second->fail("Replica is being deleted");
+  }
+  followers.clear();
+}
+
+
 Result<Action> ReplicaProcess::read(uint64_t position)
 {
   if (position < begin) {
@@ -294,6 +363,24 @@ uint64_t ReplicaProcess::ending()
 }
 
 
+Future<uint64_t> ReplicaProcess::follow(uint64_t position)
+{
+  if (position < begin) {
+    return Failure("Attempted to follow truncated position");
+  }
+
+  Option<uint64_t> to = readable(position);
+  if (to.isSome()) {
+    return to.get();
+  }
+
+  Owned<process::Promise<uint64_t>> promise(new process::Promise<uint64_t>());
+  followers.push_back(std::make_pair(position, promise));
+
+  return promise->future();
+}
+
+
 Metadata::Status ReplicaProcess::status()
 {
   return metadata.status();
@@ -312,7 +399,7 @@ bool ReplicaProcess::update(const Metadata::Status& status)
   metadata_.set_status(status);
   metadata_.set_promised(promised());
 
-  Try<Nothing> persisted = storage->persist(metadata_);
+  Try<Nothing> persisted = storage->persist(metadata_, true);
 
   if (persisted.isError()) {
     LOG(ERROR) << "Error writing to log: " << persisted.error();
@@ -328,19 +415,47 @@ bool ReplicaProcess::update(const Metadata::Status& status)
 }
 
 
+bool ReplicaProcess::learn(const list<Action>& actions)
+{
+  foreach (const Action& action, actions) {
+    CHECK(action.has_learned() && action.learned());
+
+    if (!persist(action)) {
+      return false;
+    }
+  }
+
+  Try<Nothing> synced = storage->sync();
+
+  if (synced.isError()) {
+    LOG(ERROR) << "Error syncing log: " << synced.error();
+    return false;
+  }
+
+  VLOG(1) << "Persisted " << actions.size() << " learned actions";
+
+  return true;
+}
+
+
 bool ReplicaProcess::updatePromised(uint64_t promised)
 {
   Metadata metadata_;
   metadata_.set_status(status());
   metadata_.set_promised(promised);
 
-  Try<Nothing> persisted = storage->persist(metadata_);
+  Try<Nothing> persisted = storage->persist(metadata_, false);
 
   if (persisted.isError()) {
     LOG(ERROR) << "Error writing to log: " << persisted.error();
     return false;
   }
 
+  if (!committing) {
+    committing = true;
+    dispatch(self(), &ReplicaProcess::commit);
+  }
+
   LOG(INFO) << "Persisted promised to " << promised;
 
   // Update the cached metadata.
@@ -463,7 +578,7 @@ void ReplicaProcess::promise(const UPID& from, const PromiseRequest& request)
           response.set_okay(true);
           response.set_proposal(request.proposal());
           response.set_position(request.position());
-          reply(response);
+          respond(from, response);
         }
       }
     } else {
@@ -487,7 +602,7 @@ void ReplicaProcess::promise(const UPID& from, const PromiseRequest& request)
           response.set_okay(true);
           response.set_proposal(request.proposal());
           response.mutable_action()->MergeFrom(original);
-          reply(response);
+          respond(from, response);
         }
       }
     }
@@ -512,7 +627,7 @@ void ReplicaProcess::promise(const UPID& from, const PromiseRequest& request)
         response.set_okay(true);
         response.set_proposal(request.proposal());
         response.set_position(end);
-        reply(response);
+        respond(from, response);
       }
     }
   }
@@ -583,7 +698,7 @@ void ReplicaProcess::write(const UPID& from, const WriteRequest& request)
         response.set_okay(true);
         response.set_proposal(request.proposal());
         response.set_position(request.position());
-        reply(response);
+        respond(from, response);
       }
     }
   } else if (result.isSome()) {
@@ -662,7 +777,7 @@ void ReplicaProcess::write(const UPID& from, const WriteRequest& request)
           response.set_okay(true);
           response.set_proposal(request.proposal());
           response.set_position(request.position());
-          reply(response);
+          respond(from, response);
         }
       }
     }
@@ -698,15 +813,80 @@ void ReplicaProcess::learned(const UPID& from, const Action& action)
 }
 
 
+void ReplicaProcess::transfer(
+    const UPID& from,
+    const TransferRequest& request)
+{
+  TransferResponse response;
+
+  // Only a VOTING replica knows which of its actions have been
+  // learned (e.g., a RECOVERING replica may have lost some of them).
+  if (status() != Metadata::VOTING) {
+    LOG(INFO) << "Replica ignoring transfer request from " << from
+              << " as it is in " << status() << " status";
+
+    response.set_okay(false);
+    reply(response);
+    return;
+  }
+
+  LOG(INFO) << "Replica received transfer request for positions "
+            << request.from() << " -> " << request.to() << " from " << from;
+
+  // Bound the size of the response, the catching-up replica will
+  // request the rest of the range again.
+  static const Bytes MAX_SIZE = Megabytes(4);
+
+  response.set_okay(true);
+  response.set_begin(begin);
+  response.set_to(request.to());
+
+  size_t size = 0;
+
+  for (uint64_t position = std::max(request.from(), begin);
+       position <= std::min(request.to(), end);
+       position++) {
+    // Only the learned actions can be transferred, since the others
+    // may not have been agreed upon.
+    if (missing(position)) {
+      continue;
+    }
+
+    if (size >= MAX_SIZE.bytes()) {
+      response.set_to(position - 1);
+      break;
+    }
+
+    Result<Action> action = read(position);
+
+    if (action.isError()) {
+      LOG(ERROR) << "Error getting log record at " << position
+                 << ": " << action.error();
+      return;
+    } else if (action.isSome()) {
+      size += action->ByteSize();
+      response.add_actions()->CopyFrom(action.get());
+    }
+  }
+
+  reply(response);
+}
+
+
 bool ReplicaProcess::persist(const Action& action)
 {
-  Try<Nothing> persisted = storage->persist(action);
+  Try<Nothing> persisted = storage->persist(action, false);
 
   if (persisted.isError()) {
     LOG(ERROR) << "Error writing to log: " << persisted.error();
     return false;
   }
 
+  if (!committing) {
+    committing = true;
+    dispatch(self(), &ReplicaProcess::commit);
+  }
+
   VLOG(1) << "Persisted action " << action.type()
           << " at position " << action.position();
 
@@ -749,6 +929,90 @@ bool ReplicaProcess::persist(const Action& action)
 }
 
 
+void ReplicaProcess::respond(
+    const UPID& to,
+    const google::protobuf::Message& response)
+{
+  CHECK(committing);
+
+  Owned<google::protobuf::Message> message(response.New());
+  message->CopyFrom(response);
+
+  responses.push_back(std::make_pair(to, message));
+}
+
+
+void ReplicaProcess::commit()
+{
+  CHECK(committing);
+  committing = false;
+
+  Try<Nothing> synced = storage->sync();
+
+  if (synced.isError()) {
+    // As with any other error writing to the log, we silently ignore
+    // the requests (see the comment above 'ReplicaProcess::promise').
+    LOG(ERROR) << "Error syncing log: " << synced.error();
+    responses.clear();
+    return;
+  }
+
+  VLOG(1) << "Committed log with " << responses.size()
+          << " pending responses";
+
+  foreach (const auto& response, responses) {
+    send(response.first, *response.second);
+  }
+
+  responses.clear();
+
+  // Only notify the followers once the newly learned actions have
+  // been committed, and only once per commit rather than per action.
+  notify();
+}
+
+
+Option<uint64_t> ReplicaProcess::readable(uint64_t position)
+{
+  if (position < begin || missing(position)) {
+    return None();
+  }
+
+  IntervalSet<uint64_t> positions = missing(position, end);
+  if (positions.empty()) {
+    return end;
+  }
+
+  return positions.begin()->lower() - 1;
+}
+
+
+void ReplicaProcess::notify()
+{
+  auto follower = followers.begin();
+  while (follower != followers.end()) {
+    const uint64_t position = follower->first;
+    const Owned<process::Promise<uint64_t>>& promise = follower->second;
+
+    if (promise->future().hasDiscard()) {
+      promise->discard();
+    } else if (position < begin) {
+      promise->fail("Followed position has been truncated");
+    } else {
+      Option<uint64_t> to = readable(position);
+      if (to.isNone()) {
+        ++follower;
+        continue;
+      }
+
+      promise->set(to.get());
+    }
+
+    follower = followers.erase(follower);
+  }
+}
+
+
 void ReplicaProcess::restore(const string& path)
 {
   Try<Storage::State> state = storage->restore(path);
@@ -828,6 +1092,12 @@ Future<uint64_t> Replica::ending() const
 }
 
 
+Future<uint64_t> Replica::follow(uint64_t position) const
+{
+  return dispatch(process, &ReplicaProcess::follow, position);
+}
+
+
 Future<Metadata::Status> Replica::status() const
 {
   return dispatch(process, &ReplicaProcess::status);
@@ -846,6 +1116,12 @@ Future<bool> Replica::update(const Metadata::Status& status)
 }
 
 
+Future<bool> Replica::learn(const list<Action>& actions) const
+{
+  return dispatch(process, &ReplicaProcess::learn, actions);
+}
+
+
 PID<ReplicaProcess> Replica::pid() const
 {
   return process->self();
@@ -40,6 +40,7 @@ namespace protocol {
 extern Protocol<PromiseRequest, PromiseResponse> promise;
 extern Protocol<WriteRequest, WriteResponse> write;
 extern Protocol<RecoverRequest, RecoverResponse> recover;
+extern Protocol<TransferRequest, TransferResponse> transfer;
 
 } // namespace protocol {
 
@@ -83,6 +84,12 @@ public:
   // Returns the last written position in the log.
   process::Future<uint64_t> ending() const;
 
+  // Returns the last position up to which the log can be read from
+  // the specified position (i.e., the positions in between have all
+  // been learned), once the specified position itself is learned.
+  // This lets a reader wait for new writes rather than poll.
+  process::Future<uint64_t> follow(uint64_t position) const;
+
   // Returns the current status of this replica.
   process::Future<Metadata::Status> status() const;
 
@@ -94,6 +101,13 @@ public:
   // mocking in tests.
   virtual process::Future<bool> update(const Metadata::Status& status);
 
+  // Persists the specified learned actions (e.g., transferred from
+  // another replica during catch-up). Returns true if all the actions
+  // were persisted durably, false otherwise. This is "const" so that
+  // catch-up can use it through a shared replica, since learned
+  // actions can never conflict with the Paxos state of the replica.
+  process::Future<bool> learn(const std::list<Action>& actions) const;
+
   // Returns the PID associated with this replica.
   process::PID<ReplicaProcess> pid() const;
 
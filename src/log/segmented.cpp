@@ -0,0 +1,791 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <zlib.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <iterator>
+#include <list>
+#include <string>
+
+#include <glog/logging.h>
+
+#include <stout/check.hpp>
+#include <stout/error.hpp>
+#include <stout/foreach.hpp>
+#include <stout/numify.hpp>
+#include <stout/os.hpp>
+#include <stout/path.hpp>
+#include <stout/stopwatch.hpp>
+#include <stout/stringify.hpp>
+#include <stout/strings.hpp>
+
+#include <stout/os/close.hpp>
+#include <stout/os/fsync.hpp>
+#include <stout/os/ftruncate.hpp>
+#include <stout/os/open.hpp>
+#include <stout/os/write.hpp>
+
+#include "log/segmented.hpp"
+
+using std::list;
+using std::string;
+
+namespace mesos {
+namespace internal {
+namespace log {
+
+const Bytes SegmentedStorage::MAX_SEGMENT_SIZE = Megabytes(64);
+
+
+// The name of the file that marks a directory as a segmented log.
+static const char FORMAT[] = "FORMAT";
+
+
+// The extension of the segment files, which are named after their
+// (increasing) identifiers.
+static const char EXTENSION[] = ".segment";
+
+
+// Each record is stored as its length and the CRC32 of its bytes
+// (both as 32 bit integers in host byte order), followed by the bytes
+// of the serialized record.
+static const size_t HEADER_SIZE = 2 * sizeof(uint32_t);
+
+
+// Decodes the record at the beginning of the data, returning the
+// record and setting 'length' to the number of bytes it spans.
+static Try<Record> decode(const char* data, size_t size, size_t* length)
+{
+  if (size < HEADER_SIZE) {
+    return Error("Incomplete record header");
+  }
+
+  uint32_t bytes;
+  uint32_t checksum;
+  memcpy(&bytes, data, sizeof(bytes));
+  memcpy(&checksum, data + sizeof(bytes), sizeof(checksum));
+
+  if (size - HEADER_SIZE < bytes) {
+    return Error("Incomplete record");
+  }
+
+  data += HEADER_SIZE;
+
+  if (crc32(0L, reinterpret_cast<const Bytef*>(data), bytes) != checksum) {
+    return Error("Record checksum mismatch");
+  }
+
+  Record record;
+
+  if (!record.ParseFromArray(data, bytes)) {
+    return Error("Failed to deserialize record");
+  }
+
+  *length = HEADER_SIZE + bytes;
+
+  return record;
+}
+
+
+// Syncs the directory so that the creation (or deletion) of the files
+// in it is durable.
+static Try<Nothing> fsync(const string& directory)
+{
+  Try<int> fd = os::open(directory, O_RDONLY | O_CLOEXEC);
+
+  if (fd.isError()) {
+    return Error(fd.error());
+  }
+
+  Try<Nothing> fsync = os::fsync(fd.get());
+
+  os::close(fd.get());
+
+  return fsync;
+}
+
+
+Try<Nothing> SegmentedStorage::create(const string& path)
+{
+  if (os::exists(path)) {
+    Try<list<string>> entries = os::ls(path);
+
+    if (entries.isError()) {
+      return Error("Failed to list '" + path + "': " + entries.error());
+    } else if (!entries->empty()) {
+      return Error("'" + path + "' is not empty");
+    }
+  } else {
+    Try<Nothing> mkdir = os::mkdir(path);
+
+    if (mkdir.isError()) {
+      return Error("Failed to create '" + path + "': " + mkdir.error());
+    }
+  }
+
+  Try<Nothing> write = os::write(path::join(path, FORMAT), "segmented\n");
+
+  if (write.isError()) {
+    return Error("Failed to write format file: " + write.error());
+  }
+
+  return fsync(path);
+}
+
+
+bool SegmentedStorage::exists(const string& path)
+{
+  return os::exists(path::join(path, FORMAT));
+}
+
+
+SegmentedStorage::SegmentedStorage()
+  : begin(0)
+{
+  // Nothing to see here.
+}
+
+
+SegmentedStorage::~SegmentedStorage()
+{
+  foreachvalue (Segment& segment, segments) {
+    unmap(&segment);
+  }
+
+  if (fd.isSome()) {
+    os::close(fd.get());
+  }
+}
+
+
+Try<Storage::State> SegmentedStorage::restore(const string& path)
+{
+  if (!exists(path)) {
+    Try<Nothing> created = create(path);
+
+    if (created.isError()) {
+      return Error(created.error());
+    }
+  }
+
+  directory = path;
+
+  Stopwatch stopwatch;
+  stopwatch.start();
+
+  Try<list<string>> entries = os::ls(directory);
+
+  if (entries.isError()) {
+    return Error("Failed to list '" + directory + "': " + entries.error());
+  }
+
+  foreach (const string& entry, entries.get()) {
+    if (!strings::endsWith(entry, EXTENSION)) {
+      continue;
+    }
+
+    Try<uint64_t> id =
+      numify<uint64_t>(strings::remove(entry, EXTENSION, strings::SUFFIX));
+
+    if (id.isError()) {
+      return Error("Unexpected segment file '" + entry + "'");
+    }
+
+    segments[id.get()].path = path::join(directory, entry);
+  }
+
+  uint64_t records = 0;
+
+  for (auto it = segments.begin(); it != segments.end(); ++it) {
+    const uint64_t id = it->first;
+    Segment& segment = it->second;
+
+    Try<Bytes> size = os::stat::size(segment.path);
+
+    if (size.isError()) {
+      return Error(
+          "Failed to get the size of '" + segment.path + "': " + size.error());
+    }
+
+    segment.size = size->bytes();
+
+    Try<Nothing> mapped = map(&segment);
+
+    if (mapped.isError()) {
+      return Error(mapped.error());
+    }
+
+    size_t offset = 0;
+
+    while (offset < segment.size) {
+      size_t length = 0;
+
+      Try<Record> record =
+        decode(segment.data + offset, segment.size - offset, &length);
+
+      if (record.isError()) {
+        // Only the last record of the last segment can be incomplete
+        // (i.e., if we crashed while appending it). We drop it, since
+        // it was never synced and thus never acknowledged.
+        if (std::next(it) != segments.end()) {
+          return Error(
+              "Failed to read '" + segment.path + "' at offset " +
+              stringify(offset) + ": " + record.error());
+        }
+
+        LOG(WARNING) << "Truncating '" << segment.path << "' at offset "
+                     << offset << ": " << record.error();
+
+        Try<int> fd = os::open(segment.path, O_WRONLY | O_CLOEXEC);
+
+        if (fd.isError()) {
+          return Error(
+              "Failed to open '" + segment.path + "': " + fd.error());
+        }
+
+        Try<Nothing> truncated = os::ftruncate(fd.get(), offset);
+
+        os::close(fd.get());
+
+        if (truncated.isError()) {
+          return Error(
+              "Failed to truncate '" + segment.path + "': " +
+              truncated.error());
+        }
+
+        segment.size = offset;
+        unmap(&segment);
+        break;
+      }
+
+      records++;
+
+      Location location;
+      location.segment = id;
+      location.offset = offset;
+      location.learned = false;
+
+      switch (record->type()) {
+        case Record::METADATA: {
+          CHECK(record->has_metadata());
+          supersede(metadataLocation, location);
+          metadataLocation = location;
+          metadata = record->metadata();
+          break;
+        }
+
+        case Record::ACTION: {
+          CHECK(record->has_action());
+          const Action& action = record->action();
+
+          location.learned = action.has_learned() && action.learned();
+
+          if (location.learned &&
+              action.has_type() && action.type() == Action::TRUNCATE) {
+            location.truncate = action.truncate().to();
+          }
+
+          auto previous = index.find(action.position());
+          supersede(
+              previous == index.end()
+                ? Option<Location>::none()
+                : Option<Location>(previous->second),
+              location);
+
+          index[action.position()] = location;
+          break;
+        }
+
+        default: {
+          return Error("Bad record");
+        }
+      }
+
+      offset += length;
+    }
+  }
+
+  VLOG(1) << "Read " << records << " records from " << segments.size()
+          << " segments in " << stopwatch.elapsed();
+
+  State state;
+  state.begin = 0;
+  state.end = 0;
+
+  if (metadata.isSome()) {
+    state.metadata = metadata.get();
+  }
+
+  foreachvalue (const Location& location, index) {
+    if (location.truncate.isSome()) {
+      begin = std::max(begin, location.truncate.get());
+    }
+  }
+
+  foreachpair (uint64_t position, const Location& location, index) {
+    state.end = std::max(state.end, position);
+
+    if (position < begin) {
+      continue;
+    } else if (location.learned) {
+      state.learned.insert(position);
+    } else {
+      state.unlearned.insert(position);
+    }
+  }
+
+  state.begin = begin;
+
+  // Continue appending to the last segment, if any.
+  if (segments.empty()) {
+    Try<Nothing> rolled = roll();
+
+    if (rolled.isError()) {
+      return Error(rolled.error());
+    }
+  } else {
+    const string& path = segments.rbegin()->second.path;
+
+    Try<int> open = os::open(path, O_WRONLY | O_APPEND | O_CLOEXEC);
+
+    if (open.isError()) {
+      return Error("Failed to open '" + path + "': " + open.error());
+    }
+
+    fd = open.get();
+  }
+
+  // Now that we know the beginning of the log, we can delete the
+  // segments that only have truncated positions.
+  Try<Nothing> collected = gc();
+
+  if (collected.isError()) {
+    return Error(collected.error());
+  }
+
+  return state;
+}
+
+
+Try<Nothing> SegmentedStorage::persist(const Metadata& metadata, bool sync)
+{
+  Stopwatch stopwatch;
+  stopwatch.start();
+
+  Record record;
+  record.set_type(Record::METADATA);
+  record.mutable_metadata()->CopyFrom(metadata);
+
+  Try<Location> appended = append(record, sync);
+
+  if (appended.isError()) {
+    return Error(appended.error());
+  }
+
+  supersede(metadataLocation, appended.get());
+  metadataLocation = appended.get();
+
+  this->metadata = metadata;
+
+  VLOG(1) << "Persisting metadata to segment " << appended->segment
+          << " took " << stopwatch.elapsed();
+
+  return Nothing();
+}
+
+
+Try<Nothing> SegmentedStorage::persist(const Action& action, bool sync)
+{
+  Stopwatch stopwatch;
+  stopwatch.start();
+
+  Record record;
+  record.set_type(Record::ACTION);
+  record.mutable_action()->MergeFrom(action);
+
+  Try<Location> appended = append(record, sync);
+
+  if (appended.isError()) {
+    return Error(appended.error());
+  }
+
+  Location location = appended.get();
+  location.learned = action.has_learned() && action.learned();
+
+  auto previous = index.find(action.position());
+  supersede(
+      previous == index.end()
+        ? Option<Location>::none()
+        : Option<Location>(previous->second),
+      location);
+
+  index[action.position()] = location;
+
+  VLOG(1) << "Persisting action to segment " << location.segment
+          << " took " << stopwatch.elapsed();
+
+  // Delete the truncated positions (and the segments that no longer
+  // have any records we need) once a truncate action has been
+  // *learned*. As with leveldb, we do this in a best-effort fashion,
+  // since we can always try again on the next truncation.
+  if (location.learned &&
+      action.has_type() && action.type() == Action::TRUNCATE) {
+    CHECK(action.has_truncate());
+
+    begin = std::max(begin, action.truncate().to());
+
+    Try<Nothing> collected = gc();
+
+    if (collected.isError()) {
+      LOG(WARNING) << "Ignoring failure to delete truncated segments: "
+                   << collected.error();
+    }
+  }
+
+  return Nothing();
+}
+
+
+Try<Nothing> SegmentedStorage::sync()
+{
+  CHECK_SOME(fd);
+
+  Stopwatch stopwatch;
+  stopwatch.start();
+
+  Try<Nothing> fsync = os::fsync(fd.get());
+
+  if (fsync.isError()) {
+    return Error("Failed to sync segment: " + fsync.error());
+  }
+
+  VLOG(1) << "Syncing segment took " << stopwatch.elapsed();
+
+  return Nothing();
+}
+
+
+Try<Action> SegmentedStorage::read(uint64_t position)
+{
+  Stopwatch stopwatch;
+  stopwatch.start();
+
+  auto it = index.find(position);
+
+  if (it == index.end()) {
+    return Error("Position " + stringify(position) + " not found");
+  }
+
+  Try<Record> record = load(it->second);
+
+  if (record.isError()) {
+    return Error(record.error());
+  }
+
+  if (record->type() != Record::ACTION) {
+    return Error("Bad record");
+  }
+
+  VLOG(1) << "Reading position from segment took " << stopwatch.elapsed();
+
+  return record->action();
+}
+
+
+Try<SegmentedStorage::Location> SegmentedStorage::append(
+    const Record& record,
+    bool sync)
+{
+  CHECK(!segments.empty());
+  CHECK_SOME(fd);
+
+  string value;
+
+  if (!record.SerializeToString(&value)) {
+    return Error("Failed to serialize record");
+  }
+
+  const uint32_t bytes = value.size();
+  const uint32_t checksum =
+    crc32(0L, reinterpret_cast<const Bytef*>(value.data()), value.size());
+
+  string data;
+  data.reserve(HEADER_SIZE + value.size());
+  data.append(reinterpret_cast<const char*>(&bytes), sizeof(bytes));
+  data.append(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+  data.append(value);
+
+  if (segments.rbegin()->second.size > 0 &&
+      segments.rbegin()->second.size + data.size() >
+        MAX_SEGMENT_SIZE.bytes()) {
+    Try<Nothing> rolled = roll();
+
+    if (rolled.isError()) {
+      return Error(rolled.error());
+    }
+  }
+
+  const uint64_t id = segments.rbegin()->first;
+  Segment& segment = segments.rbegin()->second;
+
+  Try<Nothing> write = os::write(fd.get(), data);
+
+  if (write.isError()) {
+    // Drop whatever part of the record was written, so that the
+    // segment stays readable.
+    os::ftruncate(fd.get(), segment.size);
+
+    return Error(
+        "Failed to write to '" + segment.path + "': " + write.error());
+  }
+
+  Location location;
+  location.segment = id;
+  location.offset = segment.size;
+  location.learned = false;
+
+  segment.size += data.size();
+
+  if (sync) {
+    Try<Nothing> fsync = os::fsync(fd.get());
+
+    if (fsync.isError()) {
+      return Error(
+          "Failed to sync '" + segment.path + "': " + fsync.error());
+    }
+  }
+
+  return location;
+}
+
+
+Try<Nothing> SegmentedStorage::roll()
+{
+  const uint64_t id = segments.empty() ? 1 : segments.rbegin()->first + 1;
+  const string path = path::join(directory, stringify(id) + EXTENSION);
+
+  // The records in the current segment must be durable before any
+  // records are appended to the new one, since 'sync' only syncs the
+  // last segment.
+  if (fd.isSome()) {
+    Try<Nothing> fsync = os::fsync(fd.get());
+
+    if (fsync.isError()) {
+      return Error("Failed to sync segment: " + fsync.error());
+    }
+  }
+
+  Try<int> open = os::open(
+      path,
+      O_WRONLY | O_CREAT | O_EXCL | O_APPEND | O_CLOEXEC,
+      S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+
+  if (open.isError()) {
+    return Error("Failed to create '" + path + "': " + open.error());
+  }
+
+  Try<Nothing> fsync = log::fsync(directory);
+
+  if (fsync.isError()) {
+    os::close(open.get());
+    return Error("Failed to sync '" + directory + "': " + fsync.error());
+  }
+
+  if (fd.isSome()) {
+    os::close(fd.get());
+  }
+
+  fd = open.get();
+  segments[id].path = path;
+
+  VLOG(1) << "Started segment " << path;
+
+  return Nothing();
+}
+
+
+void SegmentedStorage::supersede(
+    const Option<Location>& previous,
+    const Location& latest)
+{
+  if (previous.isSome()) {
+    CHECK(segments.count(previous->segment) > 0);
+    CHECK_GT(segments[previous->segment].live, 0u);
+    segments[previous->segment].live--;
+  }
+
+  CHECK(segments.count(latest.segment) > 0);
+  segments[latest.segment].live++;
+}
+
+
+Try<Nothing> SegmentedStorage::gc()
+{
+  CHECK(!segments.empty());
+
+  // Remove the truncated positions from the index.
+  auto truncated = index.lower_bound(begin);
+
+  for (auto it = index.begin(); it != truncated; ++it) {
+    CHECK(segments.count(it->second.segment) > 0);
+    segments[it->second.segment].live--;
+  }
+
+  index.erase(index.begin(), truncated);
+
+  const uint64_t last = segments.rbegin()->first;
+
+  // If the metadata is the only record left in an earlier segment,
+  // append it again so that the segment can be deleted.
+  if (metadataLocation.isSome() &&
+      metadataLocation->segment != last &&
+      segments[metadataLocation->segment].live == 1) {
+    CHECK_SOME(metadata);
+
+    Try<Nothing> persisted = persist(metadata.get(), false);
+
+    if (persisted.isError()) {
+      return Error(persisted.error());
+    }
+  }
+
+  list<uint64_t> unused;
+
+  foreachpair (uint64_t id, const Segment& segment, segments) {
+    if (id != segments.rbegin()->first && segment.live == 0) {
+      unused.push_back(id);
+    }
+  }
+
+  if (unused.empty()) {
+    return Nothing();
+  }
+
+  // The records that superseded the records in the unused segments
+  // must be durable before we delete them.
+  Try<Nothing> synced = sync();
+
+  if (synced.isError()) {
+    return Error(synced.error());
+  }
+
+  foreach (uint64_t id, unused) {
+    Segment& segment = segments[id];
+
+    unmap(&segment);
+
+    Try<Nothing> rm = os::rm(segment.path);
+
+    if (rm.isError()) {
+      return Error("Failed to delete '" + segment.path + "': " + rm.error());
+    }
+
+    VLOG(1) << "Deleted segment " << segment.path;
+
+    segments.erase(id);
+  }
+
+  return Nothing();
+}
+
+
+Try<Record> SegmentedStorage::load(const Location& location)
+{
+  CHECK(segments.count(location.segment) > 0);
+
+  Segment& segment = segments[location.segment];
+
+  CHECK_LT(location.offset, segment.size);
+
+  // Map the segment again if the record was appended after the
+  // segment was mapped (or if it was never mapped).
+  size_t length = 0;
+
+  if (location.offset + HEADER_SIZE <= segment.mapped) {
+    Try<Record> record = decode(
+        segment.data + location.offset,
+        segment.mapped - location.offset,
+        &length);
+
+    if (record.isSome()) {
+      return record;
+    }
+  }
+
+  Try<Nothing> mapped = map(&segment);
+
+  if (mapped.isError()) {
+    return Error(mapped.error());
+  }
+
+  return decode(
+      segment.data + location.offset,
+      segment.mapped - location.offset,
+      &length);
+}
+
+
+Try<Nothing> SegmentedStorage::map(Segment* segment)
+{
+  unmap(segment);
+
+  if (segment->size == 0) {
+    return Nothing();
+  }
+
+  Try<int> fd = os::open(segment->path, O_RDONLY | O_CLOEXEC);
+
+  if (fd.isError()) {
+    return Error("Failed to open '" + segment->path + "': " + fd.error());
+  }
+
+  void* data =
+    ::mmap(nullptr, segment->size, PROT_READ, MAP_SHARED, fd.get(), 0);
+
+  // The mapping stays valid after the file descriptor is closed.
+  os::close(fd.get());
+
+  if (data == MAP_FAILED) {
+    return ErrnoError("Failed to map '" + segment->path + "'");
+  }
+
+  segment->data = static_cast<char*>(data);
+  segment->mapped = segment->size;
+
+  return Nothing();
+}
+
+
+void SegmentedStorage::unmap(Segment* segment)
+{
+  if (segment->data != nullptr) {
+    ::munmap(segment->data, segment->mapped);
+
+    segment->data = nullptr;
+    segment->mapped = 0;
+  }
+}
+
+} // namespace log {
+} // namespace internal {
+} // namespace mesos {
@@ -0,0 +1,145 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __LOG_SEGMENTED_HPP__
+#define __LOG_SEGMENTED_HPP__
+
+#include <stdint.h>
+
+#include <map>
+#include <string>
+
+#include <stout/bytes.hpp>
+#include <stout/nothing.hpp>
+#include <stout/option.hpp>
+#include <stout/try.hpp>
+
+#include "log/storage.hpp"
+
+namespace mesos {
+namespace internal {
+namespace log {
+
+// Concrete implementation of the storage interface using append-only
+// segment files. Every record (an action or the metadata) is appended
+// to the last segment, and an in-memory index maps each position (and
+// the metadata) to the segment and the offset of its latest record.
+// Records are read back by mapping the segments into memory, and a
+// segment is deleted once all its records have been superseded or
+// truncated. Unlike leveldb, there is no compaction, and restoring
+// the log is a sequential scan of the segments.
+//
+// The directory of a segmented log contains a 'FORMAT' file, which
+// is how a replica tells it apart from a leveldb log.
+class SegmentedStorage : public Storage
+{
+public:
+  // The size after which the last segment is closed and a new one is
+  // started.
+  static const Bytes MAX_SEGMENT_SIZE;
+
+  // Creates an empty segmented log at the specified path, which must
+  // either not exist or be an empty directory.
+  static Try<Nothing> create(const std::string& path);
+
+  // Returns true if the path contains a segmented log.
+  static bool exists(const std::string& path);
+
+  SegmentedStorage();
+  virtual ~SegmentedStorage();
+
+  virtual Try<State> restore(const std::string& path);
+  virtual Try<Nothing> persist(const Metadata& metadata, bool sync);
+  virtual Try<Nothing> persist(const Action& action, bool sync);
+  virtual Try<Nothing> sync();
+  virtual Try<Action> read(uint64_t position);
+
+private:
+  struct Segment
+  {
+    Segment() : size(0), data(nullptr), mapped(0), live(0) {}
+
+    std::string path;
+    size_t size;
+
+    // The part of the segment that is mapped into memory (if any).
+    char* data;
+    size_t mapped;
+
+    // The number of records in the segment that are the latest record
+    // of their position (or of the metadata).
+    size_t live;
+  };
+
+  struct Location
+  {
+    uint64_t segment;
+    size_t offset;
+
+    // Whether the record is a learned action and, if it is a learned
+    // truncation, up to which position, which we need to restore the
+    // state of the log.
+    bool learned;
+    Option<uint64_t> truncate;
+  };
+
+  // Appends the record to the last segment (starting a new segment
+  // first if the last one is full), returning its location.
+  Try<Location> append(const Record& record, bool sync);
+
+  // Closes the last segment and starts a new one.
+  Try<Nothing> roll();
+
+  // Marks the location as the latest record of its position (or of
+  // the metadata), superseding the 'previous' one, if any.
+  void supersede(const Option<Location>& previous, const Location& latest);
+
+  // Removes the positions before 'begin' from the index and deletes
+  // the segments without any live records.
+  Try<Nothing> gc();
+
+  // Reads the record at the location, mapping (or re-mapping) the
+  // segment as needed.
+  Try<Record> load(const Location& location);
+
+  static Try<Nothing> map(Segment* segment);
+  static void unmap(Segment* segment);
+
+  std::string directory;
+
+  // The segments, by increasing identifier. The last segment is the
+  // one being appended to.
+  std::map<uint64_t, Segment> segments;
+
+  // The file descriptor of the last segment.
+  Option<int> fd;
+
+  // The location of the latest record of each position in the log.
+  std::map<uint64_t, Location> index;
+
+  // The latest metadata and the location of its record.
+  Option<Metadata> metadata;
+  Option<Location> metadataLocation;
+
+  // Beginning position of the log (after *learned* truncations).
+  uint64_t begin;
+};
+
+} // namespace log {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __LOG_SEGMENTED_HPP__
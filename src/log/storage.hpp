@@ -51,8 +51,17 @@ public:
   virtual ~Storage() {}
 
   virtual Try<State> restore(const std::string& path) = 0;
-  virtual Try<Nothing> persist(const Metadata& metadata) = 0;
-  virtual Try<Nothing> persist(const Action& action) = 0;
+
+  // Persists the metadata or the action. If 'sync' is false, the
+  // record can be read back right away but is only guaranteed to be
+  // durable after a subsequent call to 'sync' (or after a subsequent
+  // record has been persisted with 'sync' set).
+  virtual Try<Nothing> persist(const Metadata& metadata, bool sync) = 0;
+  virtual Try<Nothing> persist(const Action& action, bool sync) = 0;
+
+  // Makes all the records persisted so far durable.
+  virtual Try<Nothing> sync() = 0;
+
   virtual Try<Action> read(uint64_t position) = 0;
 };
 
@@ -17,9 +17,12 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include <algorithm>
+#include <deque>
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <utility>
 
 #include <mesos/log/log.hpp>
 
@@ -44,9 +47,12 @@
 using namespace process;
 
 using std::cout;
+using std::deque;
 using std::endl;
 using std::ifstream;
+using std::list;
 using std::ofstream;
+using std::pair;
 using std::string;
 using std::vector;
 
@@ -57,6 +63,31 @@ namespace internal {
 namespace log {
 namespace tool {
 
+// Prints the latency percentiles of the specified operations.
+static void report(const string& operation, vector<Duration> durations)
+{
+  if (durations.empty()) {
+    return;
+  }
+
+  std::sort(durations.begin(), durations.end());
+
+  // Returns the nearest-rank percentile.
+  auto percentile = [&durations](double p) {
+    size_t rank = static_cast<size_t>(p * durations.size());
+    return durations[std::min(rank, durations.size() - 1)];
+  };
+
+  cout << operation << " latency:"
+       << " min " << durations.front()
+       << ", p50 " << percentile(0.5)
+       << ", p90 " << percentile(0.9)
+       << ", p99 " << percentile(0.99)
+       << ", p99.9 " << percentile(0.999)
+       << ", max " << durations.back() << endl;
+}
+
+
 Benchmark::Flags::Flags()
 {
   add(&Flags::quorum,
@@ -92,6 +123,30 @@ Benchmark::Flags::Flags()
       "  random: all bits are randomly chosen\n",
       "random");
 
+  add(&Flags::pipeline,
+      "pipeline",
+      "Maximum number of appends outstanding at once. Appends are\n"
+      "pipelined by the coordinator, so values above 1 measure the\n"
+      "throughput of concurrent writes",
+      1);
+
+  add(&Flags::batch,
+      "batch",
+      "Number of consecutive writes of the trace file combined into a\n"
+      "single append (e.g., like the registrar batches its operations)",
+      1);
+
+  add(&Flags::read,
+      "read",
+      "Whether to read back each entry once appended, to measure the\n"
+      "latency of reads while writing",
+      false);
+
+  add(&Flags::catchup_path,
+      "catchup_path",
+      "Path to an empty replica which joins the log once all appends\n"
+      "are done, to measure how long it takes to catch up");
+
   add(&Flags::initialize,
       "initialize",
       "Whether to initialize the log",
@@ -108,7 +163,10 @@ Try<Nothing> Benchmark::execute(int argc, char** argv)
       "replicated log. It takes a trace file of write sizes\n"
       "and replay that trace to measure the latency of each\n"
       "write. The data to be written for each write can be\n"
-      "specified using the --type flag.\n"
+      "specified using the --type flag. Writes can also be\n"
+      "pipelined (--pipeline), batched (--batch) and read back\n"
+      "(--read), and the catch-up of a new replica can be\n"
+      "measured (--catchup_path).\n"
       "\n");
 
   // Configure the tool by parsing command line arguments.
@@ -155,6 +213,14 @@ Try<Nothing> Benchmark::execute(int argc, char** argv)
     return Error(flags.usage("Missing required option --output"));
   }
 
+  if (flags.pipeline == 0) {
+    return Error(flags.usage("Expecting --pipeline to be positive"));
+  }
+
+  if (flags.batch == 0) {
+    return Error(flags.usage("Expecting --batch to be positive"));
+  }
+
   // Initialize the log.
   if (flags.initialize) {
     Initialize initialize;
@@ -191,6 +257,7 @@ Try<Nothing> Benchmark::execute(int argc, char** argv)
   // Statistics to output.
   vector<Bytes> sizes;
   vector<Duration> durations;
+  vector<Duration> reads;
   vector<Time> timestamps;
 
   // Read sizes from the input trace file.
@@ -211,26 +278,48 @@ Try<Nothing> Benchmark::execute(int argc, char** argv)
 
   input.close();
 
-  // Generate the data to be written.
+  // Generate the data to be appended, combining the writes of each
+  // batch into a single append.
   vector<string> data;
+  vector<Bytes> appends;
   for (size_t i = 0; i < sizes.size(); i++) {
+    string bytes;
     if (flags.type == "one") {
-      data.push_back(string(sizes[i].bytes(), static_cast<char>(0xff)));
+      bytes = string(sizes[i].bytes(), static_cast<char>(0xff));
     } else if (flags.type == "random") {
-      data.push_back(string(sizes[i].bytes(), os::random() % 256));
+      bytes = string(sizes[i].bytes(), os::random() % 256);
     } else {
-      data.push_back(string(sizes[i].bytes(), 0));
+      bytes = string(sizes[i].bytes(), 0);
+    }
+
+    if (i % flags.batch == 0) {
+      data.push_back(bytes);
+      appends.push_back(sizes[i]);
+    } else {
+      data.back() += bytes;
+      appends.back() += sizes[i];
     }
   }
 
+  Log::Reader reader(&log);
+
+  // The appends in flight along with their start times, in the order
+  // of their positions (which is also the order they complete in).
+  deque<pair<Time, Future<Option<Log::Position>>>> pending;
+
   Stopwatch stopwatch;
   stopwatch.start();
 
-  for (size_t i = 0; i < sizes.size(); i++) {
-    Stopwatch stopwatch;
-    stopwatch.start();
+  size_t started = 0;
+  while (started < data.size() || !pending.empty()) {
+    while (started < data.size() && pending.size() < flags.pipeline) {
+      pending.push_back(
+          std::make_pair(Clock::now(), writer.append(data[started++])));
+    }
 
-    position = writer.append(data[i]);
+    const Time start = pending.front().first;
+    position = pending.front().second;
+    pending.pop_front();
 
     if (!position.await(Seconds(10))) {
       return Error("Failed to append: timed out");
@@ -243,23 +332,80 @@ Try<Nothing> Benchmark::execute(int argc, char** argv)
       return Error("Failed to append: exclusive write promise lost");
     }
 
-    durations.push_back(stopwatch.elapsed());
     timestamps.push_back(Clock::now());
+    durations.push_back(timestamps.back() - start);
+
+    if (flags.read) {
+      Stopwatch stopwatch;
+      stopwatch.start();
+
+      Future<list<Log::Entry>> entries =
+        reader.read(position->get(), position->get());
+
+      if (!entries.await(Seconds(10))) {
+        return Error("Failed to read: timed out");
+      } else if (!entries.isReady()) {
+        return Error("Failed to read: " +
+                     (entries.isFailed()
+                      ? entries.failure()
+                      : "Discarded future"));
+      }
+
+      reads.push_back(stopwatch.elapsed());
+    }
   }
 
-  cout << "Total number of appends: " << sizes.size() << endl;
+  cout << "Total number of appends: " << data.size() << endl;
   cout << "Total time used: " << stopwatch.elapsed() << endl;
 
+  report("Append", durations);
+  report("Read", reads);
+
+  if (flags.catchup_path.isSome()) {
+    Stopwatch stopwatch;
+    stopwatch.start();
+
+    // A new (empty) replica catches up on the whole log while it
+    // recovers, which the reader waits for.
+    Log catchup(
+        flags.quorum.get(),
+        flags.catchup_path.get(),
+        flags.servers.get(),
+        Seconds(10),
+        flags.znode.get());
+
+    Log::Reader catchupReader(&catchup);
+
+    Future<Log::Position> ending = catchupReader.ending();
+
+    if (!ending.await(Minutes(10))) {
+      return Error("Failed to catch up: timed out");
+    } else if (!ending.isReady()) {
+      return Error("Failed to catch up: " +
+                   (ending.isFailed()
+                    ? ending.failure()
+                    : "Discarded future"));
+    }
+
+    cout << "Catch-up time: " << stopwatch.elapsed() << endl;
+  }
+
   // Ouput statistics.
   ofstream output(flags.output.get().c_str());
   if (!output.is_open()) {
     return Error("Failed to open the output file " + flags.output.get());
   }
 
-  for (size_t i = 0; i < sizes.size(); i++) {
+  for (size_t i = 0; i < appends.size(); i++) {
     output << timestamps[i]
-           << " Appended " << sizes[i].bytes() << " bytes"
-           << " in " << durations[i].ms() << " ms" << endl;
+           << " Appended " << appends[i].bytes() << " bytes"
+           << " in " << durations[i].ms() << " ms";
+
+    if (flags.read) {
+      output << ", read in " << reads[i].ms() << " ms";
+    }
+
+    output << endl;
   }
 
   return Nothing();
@@ -44,6 +44,10 @@ public:
     Option<std::string> input;
     Option<std::string> output;
     std::string type;
+    size_t pipeline;
+    size_t batch;
+    bool read;
+    Option<std::string> catchup_path;
     bool initialize;
     bool help;
   };
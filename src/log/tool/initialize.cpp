@@ -20,6 +20,7 @@
 #include <stout/error.hpp>
 
 #include "log/replica.hpp"
+#include "log/segmented.hpp"
 #include "log/tool/initialize.hpp"
 
 #include "logging/logging.hpp"
@@ -37,6 +38,11 @@ Initialize::Flags::Flags()
       "path",
       "Path to the log");
 
+  add(&Flags::storage,
+      "storage",
+      "Storage to use for a new log: 'leveldb' or 'segmented'",
+      "leveldb");
+
   add(&Flags::timeout,
       "timeout",
       "Maximum time allowed for the command to finish\n"
@@ -82,6 +88,17 @@ Try<Nothing> Initialize::execute(int argc, char** argv)
     timeout = Timeout::in(flags.timeout.get());
   }
 
+  if (flags.storage == "segmented") {
+    if (!SegmentedStorage::exists(flags.path.get())) {
+      Try<Nothing> create = SegmentedStorage::create(flags.path.get());
+      if (create.isError()) {
+        return Error("Failed to create the log: " + create.error());
+      }
+    }
+  } else if (flags.storage != "leveldb") {
+    return Error(flags.usage("Unknown storage '" + flags.storage + "'"));
+  }
+
   Replica replica(flags.path.get());
 
   // Get the current status of the replica.
@@ -39,6 +39,7 @@ public:
     Flags();
 
     Option<std::string> path;
+    std::string storage;
     Option<Duration> timeout;
     bool help;
   };
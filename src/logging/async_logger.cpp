@@ -0,0 +1,182 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <utility>
+
+#include <stout/foreach.hpp>
+
+#include "logging/async_logger.hpp"
+
+namespace mesos {
+namespace internal {
+namespace logging {
+
+AsyncLogger::AsyncLogger(
+    google::base::Logger* _logger,
+    const Bytes& _capacity,
+    Overflow _overflow,
+    const process::metrics::Counter& _dropped)
+  : logger(_logger),
+    capacity(_capacity.bytes()),
+    overflow(_overflow),
+    dropped(_dropped),
+    thread(&AsyncLogger::run, this) {}
+
+
+AsyncLogger::~AsyncLogger()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+
+  wake.notify_one();
+  thread.join();
+}
+
+
+void AsyncLogger::Write(
+    bool forceFlush,
+    time_t timestamp,
+    const char* message,
+    int length)
+{
+  // glog writes an empty message to flush the logs before aborting on
+  // a fatal message, in which case we must not return before the
+  // buffered messages are written.
+  if (length <= 0) {
+    if (forceFlush) {
+      Flush();
+    }
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock(mutex);
+
+  // NOTE: A message is always buffered if the buffer is empty, so that
+  // messages larger than the buffer are not dropped or blocked forever.
+  auto fits = [this, length]() {
+    return buffer.messages.empty() ||
+           buffer.data.size() + size_t(length) <= capacity;
+  };
+
+  if (!fits()) {
+    if (overflow == Overflow::DROP) {
+      ++dropped;
+      return;
+    }
+
+    written.wait(lock, fits);
+  }
+
+  // The background thread only waits while there are no buffered
+  // messages, so we only need to wake it up for the first one. A
+  // message that asks for a flush is written out right away.
+  const bool notify = buffer.messages.empty() || forceFlush;
+
+  buffer.messages.push_back({timestamp, buffer.data.size(), size_t(length)});
+  buffer.data.append(message, length);
+  buffer.flush = buffer.flush || forceFlush;
+
+  lock.unlock();
+
+  if (notify) {
+    wake.notify_one();
+  }
+}
+
+
+void AsyncLogger::Flush()
+{
+  std::unique_lock<std::mutex> lock(mutex);
+
+  const uint64_t request = ++flushesRequested;
+
+  wake.notify_one();
+
+  written.wait(lock, [this, request]() {
+    return flushesCompleted >= request;
+  });
+}
+
+
+google::uint32 AsyncLogger::LogSize()
+{
+  return logger->LogSize();
+}
+
+
+void AsyncLogger::run()
+{
+  Buffer writing;
+
+  std::unique_lock<std::mutex> lock(mutex);
+
+  while (true) {
+    wake.wait(lock, [this]() {
+      return stopping ||
+             !buffer.messages.empty() ||
+             flushesRequested > flushesCompleted;
+    });
+
+    if (stopping &&
+        buffer.messages.empty() &&
+        flushesRequested == flushesCompleted) {
+      break;
+    }
+
+    // Take over the buffer, so that the writers can keep buffering
+    // messages while we write these out.
+    std::swap(writing, buffer);
+
+    const bool flush =
+      writing.flush || flushesRequested > flushesCompleted;
+
+    const uint64_t requested = flushesRequested;
+
+    lock.unlock();
+
+    written.notify_all();
+
+    foreach (const Buffer::Message& message, writing.messages) {
+      logger->Write(
+          false,
+          message.timestamp,
+          writing.data.data() + message.offset,
+          message.length);
+    }
+
+    if (flush) {
+      logger->Flush();
+    }
+
+    writing.clear();
+
+    lock.lock();
+
+    flushesCompleted = requested;
+
+    written.notify_all();
+  }
+
+  lock.unlock();
+
+  logger->Flush();
+}
+
+} // namespace logging {
+} // namespace internal {
+} // namespace mesos {
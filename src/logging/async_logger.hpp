@@ -0,0 +1,142 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __LOGGING_ASYNC_LOGGER_HPP__
+#define __LOGGING_ASYNC_LOGGER_HPP__
+
+#include <stdint.h>
+#include <time.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <glog/logging.h>
+
+#include <process/metrics/counter.hpp>
+
+#include <stout/bytes.hpp>
+
+namespace mesos {
+namespace internal {
+namespace logging {
+
+// A glog logger that buffers the messages written to it in memory and
+// writes them to another logger (e.g., the log file of a severity)
+// from a background thread, so that logging does not wait for the log
+// file to be written (see `--async_logging`).
+//
+// NOTE: glog writes to the loggers while holding its own lock, which
+// serializes the writers; with this logger the lock is only held for
+// as long as it takes to copy the message into the buffer.
+class AsyncLogger : public google::base::Logger
+{
+public:
+  // What to do with a message that does not fit into the buffer.
+  enum class Overflow
+  {
+    // Wait for the buffered messages to be written.
+    BLOCK,
+
+    // Drop the message, counting it in `dropped`.
+    DROP,
+  };
+
+  // NOTE: The logger is not owned, as the loggers of glog are owned by
+  // glog and are never deleted.
+  AsyncLogger(
+      google::base::Logger* logger,
+      const Bytes& capacity,
+      Overflow overflow,
+      const process::metrics::Counter& dropped);
+
+  virtual ~AsyncLogger();
+
+  virtual void Write(
+      bool forceFlush,
+      time_t timestamp,
+      const char* message,
+      int length);
+
+  // Waits for the buffered messages to be written, and flushes them.
+  virtual void Flush();
+
+  virtual google::uint32 LogSize();
+
+private:
+  AsyncLogger(const AsyncLogger&) = delete;
+  AsyncLogger& operator=(const AsyncLogger&) = delete;
+
+  struct Buffer
+  {
+    struct Message
+    {
+      time_t timestamp;
+      size_t offset;
+      size_t length;
+    };
+
+    void clear()
+    {
+      messages.clear();
+      data.clear();
+      flush = false;
+    }
+
+    std::vector<Message> messages;
+    std::string data;
+
+    // Whether a message asked for the log to be flushed.
+    bool flush = false;
+  };
+
+  // Writes out the buffered messages until the logger is destroyed.
+  void run();
+
+  google::base::Logger* const logger;
+  const size_t capacity;
+  const Overflow overflow;
+  process::metrics::Counter dropped;
+
+  // Protects the variables below.
+  std::mutex mutex;
+
+  // Notifies the background thread that there are buffered messages, a
+  // flush was requested, or the logger is being destroyed.
+  std::condition_variable wake;
+
+  // Notifies the writers that the buffer has been taken over by the
+  // background thread, or that a flush has completed.
+  std::condition_variable written;
+
+  Buffer buffer;
+
+  // The number of flushes that were requested and have completed.
+  uint64_t flushesRequested = 0;
+  uint64_t flushesCompleted = 0;
+
+  bool stopping = false;
+
+  std::thread thread;
+};
+
+} // namespace logging {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __LOGGING_ASYNC_LOGGER_HPP__
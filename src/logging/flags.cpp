@@ -46,6 +46,31 @@ mesos::internal::logging::Flags::Flags()
       "By default, logs are flushed immediately.",
       0);
 
+  add(&Flags::async_logging,
+      "async_logging",
+      "Whether to write the log files in `--log_dir` from a background\n"
+      "thread, so that logging does not wait for the log files to be\n"
+      "written. Log messages are buffered in memory until they are\n"
+      "written, so the last messages may be lost if the process crashes.\n"
+      "Does not affect logging to stderr.",
+      false);
+
+  add(&Flags::async_logging_buffer_size,
+      "async_logging_buffer_size",
+      "The amount of log messages to buffer for each log file when\n"
+      "`--async_logging` is enabled, before `--async_logging_overflow`\n"
+      "applies.",
+      Megabytes(8));
+
+  add(&Flags::async_logging_overflow,
+      "async_logging_overflow",
+      "What to do with a log message when the buffer of a log file is\n"
+      "full and `--async_logging` is enabled.\n"
+      "Possible values: `block` to wait for the buffered messages to be\n"
+      "written, `drop` to drop the message (see the\n"
+      "`logging/dropped_lines` metric).",
+      "block");
+
   add(&Flags::initialize_driver_logging,
       "initialize_driver_logging",
       "Whether the master/agent should initialize Google logging for the\n"
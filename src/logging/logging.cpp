@@ -20,12 +20,19 @@
 #include <glog/logging.h>
 #include <glog/raw_logging.h>
 
+#include <stdlib.h> // For atexit().
+
 #include <string>
+#include <vector>
 
 #include <process/once.hpp>
 
+#include <process/metrics/counter.hpp>
+#include <process/metrics/metrics.hpp>
+
 #include <stout/error.hpp>
 #include <stout/exit.hpp>
+#include <stout/foreach.hpp>
 #include <stout/os.hpp>
 #include <stout/path.hpp>
 #include <stout/stringify.hpp>
@@ -35,6 +42,7 @@
 #include <stout/os/signals.hpp>
 #endif // __WINDOWS__
 
+#include "logging/async_logger.hpp"
 #include "logging/logging.hpp"
 
 #ifdef __linux__
@@ -49,6 +57,7 @@ using fLB::FLAGS_drop_log_memory;
 using process::Once;
 
 using std::string;
+using std::vector;
 
 // Captures the stack trace and exits when a pure virtual method is
 // called.
@@ -76,6 +85,19 @@ namespace logging {
 string argv0;
 
 
+// The loggers installed for `--async_logging`, which are flushed when
+// the process exits so that no buffered messages are lost.
+static vector<AsyncLogger*>* asyncLoggers = new vector<AsyncLogger*>();
+
+
+static void flushAsyncLoggers()
+{
+  foreach (AsyncLogger* logger, *asyncLoggers) {
+    logger->Flush();
+  }
+}
+
+
 // NOTE: We use RAW_LOG instead of LOG because RAW_LOG doesn't
 // allocate any memory or grab locks. And according to
 // https://code.google.com/p/google-glog/issues/detail?id=161
@@ -141,6 +163,14 @@ void initialize(
       << " 'logging_level' flag are: 'INFO', 'WARNING', 'ERROR'.";
   }
 
+  if (flags.async_logging_overflow != "block" &&
+      flags.async_logging_overflow != "drop") {
+    EXIT(EXIT_FAILURE)
+      << "'" << flags.async_logging_overflow
+      << "' is not a valid overflow policy. Possible values for"
+      << " 'async_logging_overflow' flag are: 'block', 'drop'.";
+  }
+
   FLAGS_minloglevel = getLogSeverity(flags.logging_level);
 
   if (flags.log_dir.isSome()) {
@@ -196,6 +226,35 @@ void initialize(
       << " level logging started!";
   }
 
+  // Write the log files from a background thread. We do not buffer
+  // the log of fatal messages, since the process aborts right after
+  // logging them.
+  //
+  // NOTE: This is done after the log files have been created above,
+  // so that failing to create them is still reported synchronously.
+  if (flags.log_dir.isSome() && flags.async_logging) {
+    process::metrics::Counter dropped("logging/dropped_lines");
+    process::metrics::add(dropped);
+
+    const AsyncLogger::Overflow overflow =
+      flags.async_logging_overflow == "drop"
+        ? AsyncLogger::Overflow::DROP
+        : AsyncLogger::Overflow::BLOCK;
+
+    for (int severity = google::INFO; severity < google::FATAL; severity++) {
+      AsyncLogger* logger = new AsyncLogger(
+          google::base::GetLogger(severity),
+          flags.async_logging_buffer_size,
+          overflow,
+          dropped);
+
+      google::base::SetLogger(severity, logger);
+      asyncLoggers->push_back(logger);
+    }
+
+    atexit(flushAsyncLoggers);
+  }
+
   VLOG(1) << "Logging to " <<
     (flags.log_dir.isSome() ? flags.log_dir.get() : "STDERR");
 
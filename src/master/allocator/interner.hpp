@@ -0,0 +1,176 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __MASTER_ALLOCATOR_INTERNER_HPP__
+#define __MASTER_ALLOCATOR_INTERNER_HPP__
+
+#include <stdint.h>
+
+#include <vector>
+
+#include <stout/check.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/none.hpp>
+#include <stout/option.hpp>
+
+namespace mesos {
+namespace internal {
+namespace master {
+namespace allocator {
+
+// Assigns dense integer handles to values (e.g., role or resource
+// names), so that the state kept for them can be stored in vectors
+// indexed by handle and the allocator's inner loops can compare and
+// look up integers rather than hashing and comparing the values.
+//
+// NOTE: Handles are stable and never reused, as values are never
+// removed. This makes the interner suitable for values drawn from a
+// small set (like roles), but not for values that churn (like agent
+// or framework IDs).
+template <typename T>
+class Interner
+{
+public:
+  typedef size_t Handle;
+
+  // Returns the handle of the value, assigning a new one if this is
+  // the first time the value is seen.
+  Handle intern(const T& value)
+  {
+    Option<Handle> handle = handles.get(value);
+    if (handle.isSome()) {
+      return handle.get();
+    }
+
+    values.push_back(value);
+    handles[value] = values.size() - 1;
+
+    return values.size() - 1;
+  }
+
+  // Returns the handle of the value, if it has been interned.
+  Option<Handle> lookup(const T& value) const
+  {
+    return handles.get(value);
+  }
+
+  const T& value(Handle handle) const
+  {
+    return values.at(handle);
+  }
+
+  // Returns the number of interned values, i.e., one more than the
+  // largest handle assigned so far.
+  size_t size() const
+  {
+    return values.size();
+  }
+
+private:
+  hashmap<T, Handle> handles;
+  std::vector<T> values;
+};
+
+
+// Like `Interner`, but for values that churn (like agent IDs): each
+// user of a value acquires a reference to its handle and releases it
+// when done, and the handle of a value without references is reused
+// for the next new value. This keeps the handles dense, so that they
+// can be stored in 32 bits in place of the (much larger) values.
+template <typename T>
+class ReferenceCountingInterner
+{
+public:
+  typedef uint32_t Handle;
+
+  // Returns the handle of the value, assigning one if the value has
+  // no references yet, and adds a reference to it.
+  Handle acquire(const T& value)
+  {
+    Option<Handle> handle = handles.get(value);
+    if (handle.isSome()) {
+      entries[handle.get()].references++;
+      return handle.get();
+    }
+
+    Handle result;
+
+    if (!unused.empty()) {
+      result = unused.back();
+      unused.pop_back();
+
+      entries[result] = Entry(value);
+    } else {
+      result = entries.size();
+      entries.push_back(Entry(value));
+    }
+
+    handles[value] = result;
+
+    return result;
+  }
+
+  // Removes a reference to the handle, which is reused once it has
+  // no references left.
+  void release(Handle handle)
+  {
+    Entry& entry = entries.at(handle);
+    CHECK_GT(entry.references, 0u);
+
+    if (--entry.references == 0) {
+      handles.erase(entry.value.get());
+      entry.value = None();
+      unused.push_back(handle);
+    }
+  }
+
+  // Returns the handle of the value, if it has references.
+  Option<Handle> lookup(const T& value) const
+  {
+    return handles.get(value);
+  }
+
+  const T& value(Handle handle) const
+  {
+    return entries.at(handle).value.get();
+  }
+
+  // Returns the number of values with references.
+  size_t size() const
+  {
+    return handles.size();
+  }
+
+private:
+  struct Entry
+  {
+    explicit Entry(const T& _value) : value(_value), references(1) {}
+
+    Option<T> value;
+    size_t references;
+  };
+
+  hashmap<T, Handle> handles;
+  std::vector<Entry> entries;
+  std::vector<Handle> unused;
+};
+
+} // namespace allocator {
+} // namespace master {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __MASTER_ALLOCATOR_INTERNER_HPP__
@@ -0,0 +1,241 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "master/allocator/mesos/agent_ordering.hpp"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <mesos/values.hpp>
+
+#include <stout/check.hpp>
+#include <stout/error.hpp>
+#include <stout/foreach.hpp>
+#include <stout/hashset.hpp>
+#include <stout/stringify.hpp>
+#include <stout/strings.hpp>
+
+using std::string;
+using std::vector;
+
+namespace mesos {
+namespace internal {
+namespace master {
+namespace allocator {
+namespace internal {
+
+static const string LOCALITY_PREFIX = "locality:";
+
+
+Try<AgentOrdering*> AgentOrdering::create(const string& name)
+{
+  if (name == "random") {
+    return new RandomAgentOrdering();
+  } else if (name == "bin_packing") {
+    return new UtilizationAgentOrdering(true);
+  } else if (name == "spread") {
+    return new UtilizationAgentOrdering(false);
+  } else if (strings::startsWith(name, LOCALITY_PREFIX)) {
+    const string attribute = name.substr(LOCALITY_PREFIX.size());
+    if (attribute.empty()) {
+      return Error(
+          "Expected an attribute name after '" + LOCALITY_PREFIX + "'");
+    }
+
+    return new UtilizationAgentOrdering(true, attribute);
+  }
+
+  return Error("Unknown agent ordering '" + name + "'");
+}
+
+
+vector<SlaveID> RandomAgentOrdering::order(
+    const vector<SlaveID>& slaveIds) const
+{
+  vector<SlaveID> result = slaveIds;
+  std::random_shuffle(result.begin(), result.end());
+  return result;
+}
+
+
+bool UtilizationAgentOrdering::Entry::operator<(const Entry& that) const
+{
+  if (group != that.group) {
+    // Agents without the attribute go last.
+    if (group.isNone() || that.group.isNone()) {
+      return that.group.isNone();
+    }
+
+    return group.get() < that.group.get();
+  }
+
+  if (priority != that.priority) {
+    return priority < that.priority;
+  }
+
+  return slaveId.value() < that.slaveId.value();
+}
+
+
+void UtilizationAgentOrdering::add(
+    const SlaveID& slaveId,
+    const SlaveInfo& slaveInfo,
+    const Resources& total,
+    const Resources& allocated)
+{
+  CHECK(!agents.contains(slaveId));
+
+  Entry entry;
+  entry.priority = priority(total, allocated);
+  entry.slaveId = slaveId;
+
+  if (groupBy.isSome()) {
+    foreach (const Attribute& attribute, slaveInfo.attributes()) {
+      if (attribute.name() == groupBy.get()) {
+        switch (attribute.type()) {
+          case Value::SCALAR:
+            entry.group = stringify(attribute.scalar().value());
+            break;
+          case Value::RANGES:
+            entry.group = stringify(attribute.ranges());
+            break;
+          case Value::SET:
+            entry.group = stringify(attribute.set());
+            break;
+          case Value::TEXT:
+            entry.group = attribute.text().value();
+            break;
+        }
+        break;
+      }
+    }
+  }
+
+  agents[slaveId] = entries.insert(entry).first;
+}
+
+
+void UtilizationAgentOrdering::update(
+    const SlaveID& slaveId,
+    const Resources& total,
+    const Resources& allocated)
+{
+  CHECK(agents.contains(slaveId));
+
+  std::set<Entry>::iterator& it = agents.at(slaveId);
+
+  const double updated = priority(total, allocated);
+  if (it->priority == updated) {
+    return;
+  }
+
+  Entry entry = *it;
+  entry.priority = updated;
+
+  entries.erase(it);
+  it = entries.insert(entry).first;
+}
+
+
+void UtilizationAgentOrdering::remove(const SlaveID& slaveId)
+{
+  CHECK(agents.contains(slaveId));
+
+  entries.erase(agents.at(slaveId));
+  agents.erase(slaveId);
+}
+
+
+vector<SlaveID> UtilizationAgentOrdering::order(
+    const vector<SlaveID>& slaveIds) const
+{
+  vector<SlaveID> result;
+  result.reserve(slaveIds.size());
+
+  // When only a small subset of the agents is allocated (e.g., during
+  // event driven allocation), sorting the subset is cheaper than a
+  // walk over all of the agents.
+  if (slaveIds.size() * 8 < entries.size()) {
+    vector<const Entry*> subset;
+    subset.reserve(slaveIds.size());
+
+    foreach (const SlaveID& slaveId, slaveIds) {
+      CHECK(agents.contains(slaveId));
+      subset.push_back(&*agents.at(slaveId));
+    }
+
+    std::sort(
+        subset.begin(),
+        subset.end(),
+        [](const Entry* left, const Entry* right) {
+          return *left < *right;
+        });
+
+    foreach (const Entry* entry, subset) {
+      result.push_back(entry->slaveId);
+    }
+
+    return result;
+  }
+
+  hashset<SlaveID> candidates;
+  foreach (const SlaveID& slaveId, slaveIds) {
+    candidates.insert(slaveId);
+  }
+
+  foreach (const Entry& entry, entries) {
+    if (candidates.contains(entry.slaveId)) {
+      result.push_back(entry.slaveId);
+    }
+  }
+
+  return result;
+}
+
+
+double UtilizationAgentOrdering::priority(
+    const Resources& total,
+    const Resources& allocated) const
+{
+  double utilization = 0.0;
+
+  // NOTE: The allocation may include shared resources multiple times,
+  // so we only consider the non-shared ones.
+  const Resources scalars = total.nonShared().scalars();
+  const Resources used = allocated.nonShared().scalars();
+
+  foreach (const string& name, scalars.names()) {
+    const Option<Value::Scalar> capacity = scalars.get<Value::Scalar>(name);
+    if (capacity.isNone() || capacity->value() <= 0.0) {
+      continue;
+    }
+
+    const Option<Value::Scalar> usage = used.get<Value::Scalar>(name);
+    if (usage.isSome()) {
+      utilization =
+        std::max(utilization, usage->value() / capacity->value());
+    }
+  }
+
+  return mostAllocatedFirst ? -utilization : utilization;
+}
+
+} // namespace internal {
+} // namespace allocator {
+} // namespace master {
+} // namespace internal {
+} // namespace mesos {
@@ -0,0 +1,163 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __MASTER_ALLOCATOR_MESOS_AGENT_ORDERING_HPP__
+#define __MASTER_ALLOCATOR_MESOS_AGENT_ORDERING_HPP__
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include <mesos/mesos.hpp>
+#include <mesos/resources.hpp>
+#include <mesos/type_utils.hpp>
+
+#include <stout/hashmap.hpp>
+#include <stout/option.hpp>
+#include <stout/try.hpp>
+
+namespace mesos {
+namespace internal {
+namespace master {
+namespace allocator {
+namespace internal {
+
+// Determines the order in which the allocator visits agents when
+// allocating their resources. The allocator informs the ordering of
+// every agent it knows about and of every change to the total or
+// allocated resources of an agent, so that orderings can keep the
+// agents sorted incrementally rather than sorting them on every
+// allocation.
+class AgentOrdering
+{
+public:
+  // Creates the ordering named by `name`, which is one of:
+  //
+  //   random             Agents are visited in a random order.
+  //   bin_packing        Most allocated agents first.
+  //   spread             Least allocated agents first.
+  //   locality:<name>    Agents are grouped by the value of their
+  //                      attribute `<name>`, and bin packed within
+  //                      each group.
+  static Try<AgentOrdering*> create(const std::string& name);
+
+  virtual ~AgentOrdering() {}
+
+  virtual void add(
+      const SlaveID& slaveId,
+      const SlaveInfo& slaveInfo,
+      const Resources& total,
+      const Resources& allocated) = 0;
+
+  virtual void update(
+      const SlaveID& slaveId,
+      const Resources& total,
+      const Resources& allocated) = 0;
+
+  virtual void remove(const SlaveID& slaveId) = 0;
+
+  // Returns `slaveIds`, which must all have been added, in the order
+  // in which they should be allocated.
+  virtual std::vector<SlaveID> order(
+      const std::vector<SlaveID>& slaveIds) const = 0;
+};
+
+
+class RandomAgentOrdering : public AgentOrdering
+{
+public:
+  virtual void add(
+      const SlaveID& slaveId,
+      const SlaveInfo& slaveInfo,
+      const Resources& total,
+      const Resources& allocated) {}
+
+  virtual void update(
+      const SlaveID& slaveId,
+      const Resources& total,
+      const Resources& allocated) {}
+
+  virtual void remove(const SlaveID& slaveId) {}
+
+  virtual std::vector<SlaveID> order(
+      const std::vector<SlaveID>& slaveIds) const;
+};
+
+
+// Keeps the agents sorted by their utilization, which is the largest
+// fraction of any scalar resource on the agent that is allocated,
+// optionally grouping them by the value of an attribute first.
+class UtilizationAgentOrdering : public AgentOrdering
+{
+public:
+  // If `mostAllocatedFirst` is set, agents are bin packed, otherwise
+  // allocations are spread across agents. If `groupBy` is set, agents
+  // with the same value of the attribute are kept next to each other.
+  UtilizationAgentOrdering(
+      bool _mostAllocatedFirst,
+      const Option<std::string>& _groupBy = None())
+    : mostAllocatedFirst(_mostAllocatedFirst),
+      groupBy(_groupBy) {}
+
+  virtual void add(
+      const SlaveID& slaveId,
+      const SlaveInfo& slaveInfo,
+      const Resources& total,
+      const Resources& allocated);
+
+  virtual void update(
+      const SlaveID& slaveId,
+      const Resources& total,
+      const Resources& allocated);
+
+  virtual void remove(const SlaveID& slaveId);
+
+  virtual std::vector<SlaveID> order(
+      const std::vector<SlaveID>& slaveIds) const;
+
+private:
+  struct Entry
+  {
+    // The value of the `groupBy` attribute, if any. Agents that lack
+    // the attribute are ordered after all others.
+    Option<std::string> group;
+
+    // The utilization, negated when bin packing so that entries are
+    // always ordered by ascending priority.
+    double priority;
+
+    SlaveID slaveId;
+
+    bool operator<(const Entry& that) const;
+  };
+
+  double priority(const Resources& total, const Resources& allocated) const;
+
+  const bool mostAllocatedFirst;
+  const Option<std::string> groupBy;
+
+  std::set<Entry> entries;
+
+  hashmap<SlaveID, std::set<Entry>::iterator> agents;
+};
+
+} // namespace internal {
+} // namespace allocator {
+} // namespace master {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __MASTER_ALLOCATOR_MESOS_AGENT_ORDERING_HPP__
@@ -57,7 +57,9 @@ public:
         inverseOfferCallback,
       const hashmap<std::string, double>& weights,
       const Option<std::set<std::string>>&
-        fairnessExcludeResourceNames = None());
+        fairnessExcludeResourceNames = None(),
+      const mesos::allocator::Options& options =
+        mesos::allocator::Options());
 
   void recover(
       const int expectedAgentCount,
@@ -141,6 +143,11 @@ public:
       const Resources& resources,
       const Option<Filters>& filters);
 
+  void recoverResources(
+      const FrameworkID& frameworkId,
+      const hashmap<SlaveID, Resources>& resources,
+      const Option<Filters>& filters);
+
   void suppressOffers(
       const FrameworkID& frameworkId);
 
@@ -189,7 +196,9 @@ public:
         inverseOfferCallback,
       const hashmap<std::string, double>& weights,
       const Option<std::set<std::string>>&
-        fairnessExcludeResourceNames = None()) = 0;
+        fairnessExcludeResourceNames = None(),
+      const mesos::allocator::Options& options =
+        mesos::allocator::Options()) = 0;
 
   virtual void recover(
       const int expectedAgentCount,
@@ -273,6 +282,14 @@ public:
       const Resources& resources,
       const Option<Filters>& filters) = 0;
 
+  // NOTE: This is not an overload of `recoverResources()` so that
+  // either one can be named by a member pointer, e.g., in
+  // `FUTURE_DISPATCH`.
+  virtual void recoverResourcesOnAgents(
+      const FrameworkID& frameworkId,
+      const hashmap<SlaveID, Resources>& resources,
+      const Option<Filters>& filters) = 0;
+
   virtual void suppressOffers(
       const FrameworkID& frameworkId) = 0;
 
@@ -328,7 +345,8 @@ inline void MesosAllocator<AllocatorProcess>::initialize(
               const hashmap<SlaveID, UnavailableResources>&)>&
       inverseOfferCallback,
     const hashmap<std::string, double>& weights,
-    const Option<std::set<std::string>>& fairnessExcludeResourceNames)
+    const Option<std::set<std::string>>& fairnessExcludeResourceNames,
+    const mesos::allocator::Options& options)
 {
   process::dispatch(
       process,
@@ -337,7 +355,8 @@ inline void MesosAllocator<AllocatorProcess>::initialize(
       offerCallback,
       inverseOfferCallback,
       weights,
-      fairnessExcludeResourceNames);
+      fairnessExcludeResourceNames,
+      options);
 }
 
 
@@ -598,6 +617,21 @@ inline void MesosAllocator<AllocatorProcess>::recoverResources(
 }
 
 
+template <typename AllocatorProcess>
+inline void MesosAllocator<AllocatorProcess>::recoverResources(
+    const FrameworkID& frameworkId,
+    const hashmap<SlaveID, Resources>& resources,
+    const Option<Filters>& filters)
+{
+  process::dispatch(
+      process,
+      &MesosAllocatorProcess::recoverResourcesOnAgents,
+      frameworkId,
+      resources,
+      filters);
+}
+
+
 template <typename AllocatorProcess>
 inline void MesosAllocator<AllocatorProcess>::suppressOffers(
     const FrameworkID& frameworkId)
@@ -19,11 +19,13 @@
 #include <algorithm>
 #include <set>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include <mesos/resources.hpp>
 #include <mesos/type_utils.hpp>
 
+#include <process/clock.hpp>
 #include <process/delay.hpp>
 #include <process/dispatch.hpp>
 #include <process/event.hpp>
@@ -43,6 +45,7 @@ using std::vector;
 
 using mesos::allocator::InverseOfferStatus;
 
+using process::Clock;
 using process::Failure;
 using process::Future;
 using process::Owned;
@@ -56,36 +59,6 @@ namespace master {
 namespace allocator {
 namespace internal {
 
-// Used to represent "filters" for resources unused in offers.
-class OfferFilter
-{
-public:
-  virtual ~OfferFilter() {}
-
-  virtual bool filter(const Resources& resources) const = 0;
-};
-
-
-class RefusedOfferFilter : public OfferFilter
-{
-public:
-  RefusedOfferFilter(const Resources& _resources) : resources(_resources) {}
-
-  virtual bool filter(const Resources& _resources) const
-  {
-    // TODO(jieyu): Consider separating the superset check for regular
-    // and revocable resources. For example, frameworks might want
-    // more revocable resources only or non-revocable resources only,
-    // but currently the filter only expires if there is more of both
-    // revocable and non-revocable resources.
-    return resources.contains(_resources); // Refused resources are superset.
-  }
-
-private:
-  const Resources resources;
-};
-
-
 // Used to represent "filters" for inverse offers.
 //
 // NOTE: Since this specific allocator implementation only sends inverse offers
@@ -130,6 +103,31 @@ HierarchicalAllocatorProcess::Framework::Framework(
     capabilities(frameworkInfo.capabilities()) {}
 
 
+HierarchicalAllocatorProcess::OfferableResources::OfferableResources(
+    const Resources& resources)
+  : revocable(resources.revocable())
+{
+  const Resources nonRevocable = resources.nonRevocable();
+
+  unreserved = nonRevocable.unreserved();
+  reservations = nonRevocable.reservations();
+}
+
+
+const Resources& HierarchicalAllocatorProcess::OfferableResources::reserved(
+    const string& role) const
+{
+  static const Resources empty;
+
+  auto reservation = reservations.find(role);
+  if (reservation == reservations.end()) {
+    return empty;
+  }
+
+  return reservation->second;
+}
+
+
 void HierarchicalAllocatorProcess::initialize(
     const Duration& _allocationInterval,
     const lambda::function<
@@ -140,13 +138,23 @@ void HierarchicalAllocatorProcess::initialize(
              const hashmap<SlaveID, UnavailableResources>&)>&
       _inverseOfferCallback,
     const hashmap<string, double>& _weights,
-    const Option<set<string>>& _fairnessExcludeResourceNames)
+    const Option<set<string>>& _fairnessExcludeResourceNames,
+    const mesos::allocator::Options& options)
 {
   allocationInterval = _allocationInterval;
   offerCallback = _offerCallback;
   inverseOfferCallback = _inverseOfferCallback;
   weights = _weights;
   fairnessExcludeResourceNames = _fairnessExcludeResourceNames;
+  allocationPartitions = options.allocationPartitions;
+  allocationSweepInterval = options.allocationSweepInterval;
+
+  Try<AgentOrdering*> ordering =
+    AgentOrdering::create(options.agentOrdering.getOrElse("random"));
+
+  CHECK_SOME(ordering) << "Failed to create agent ordering";
+  agentOrdering.reset(ordering.get());
+
   initialized = true;
   paused = false;
 
@@ -156,6 +164,10 @@ void HierarchicalAllocatorProcess::initialize(
   roleSorter->initialize(fairnessExcludeResourceNames);
   quotaRoleSorter->initialize(fairnessExcludeResourceNames);
 
+  if (allocationSweepInterval.isSome()) {
+    nextSweep = Timeout::in(allocationSweepInterval.get());
+  }
+
   VLOG(1) << "Initialized hierarchical allocator process";
 
   delay(allocationInterval, self(), &Self::batch);
@@ -245,6 +257,7 @@ void HierarchicalAllocatorProcess::addFramework(
   // initialize state as necessary.
   if (!activeRoles.contains(role)) {
     activeRoles[role] = 1;
+    roleNames.intern(role);
     roleSorter->add(role, roleWeight(role));
     frameworkSorters.insert({role, Owned<Sorter>(frameworkSorterFactory())});
     frameworkSorters.at(role)->initialize(fairnessExcludeResourceNames);
@@ -269,7 +282,11 @@ void HierarchicalAllocatorProcess::addFramework(
 
       if (quotas.contains(role)) {
         // See comment at `quotaRoleSorter` declaration regarding non-revocable.
-        quotaRoleSorter->allocated(role, slaveId, allocated.nonRevocable());
+        quotaRoleAllocated(role, slaveId, allocated.nonRevocable());
+      }
+
+      if (slaves.at(slaveId).maintenance.isSome()) {
+        inverseOfferCandidates.insert(slaveId);
       }
     }
   }
@@ -277,7 +294,7 @@ void HierarchicalAllocatorProcess::addFramework(
   LOG(INFO) << "Added framework " << frameworkId;
 
   if (active) {
-    allocate();
+    allocateRoles({role});
   } else {
     deactivateFramework(frameworkId);
   }
@@ -307,7 +324,7 @@ void HierarchicalAllocatorProcess::removeFramework(
 
       if (quotas.contains(role)) {
         // See comment at `quotaRoleSorter` declaration regarding non-revocable.
-        quotaRoleSorter->unallocated(role, slaveId, allocated.nonRevocable());
+        quotaRoleUnallocated(role, slaveId, allocated.nonRevocable());
       }
     }
 
@@ -334,8 +351,10 @@ void HierarchicalAllocatorProcess::removeFramework(
     metrics.removeRole(role);
   }
 
+  offerFilters.remove(frameworkId);
+
   // Do not delete the filters contained in this
-  // framework's `offerFilters` hashset yet, see comments in
+  // framework's `inverseOfferFilters` hashset yet, see comments in
   // HierarchicalAllocatorProcess::reviveOffers and
   // HierarchicalAllocatorProcess::expire.
   frameworks.erase(frameworkId);
@@ -357,7 +376,7 @@ void HierarchicalAllocatorProcess::activateFramework(
 
   LOG(INFO) << "Activated framework " << frameworkId;
 
-  allocate();
+  allocateRoles({role});
 }
 
 
@@ -379,12 +398,13 @@ void HierarchicalAllocatorProcess::deactivateFramework(
   // of the resources that it is using. We might be able to collapse
   // the added/removed and activated/deactivated in the future.
 
+  offerFilters.remove(frameworkId);
+
   // Do not delete the filters contained in this
-  // framework's `offerFilters` hashset yet, see comments in
+  // framework's `inverseOfferFilters` hashset yet, see comments in
   // HierarchicalAllocatorProcess::reviveOffers and
   // HierarchicalAllocatorProcess::expire.
-  framework.offerFilters.clear();
-  framework.inverseOfferFilters.clear();
+  removeInverseOfferFilters(frameworkId);
 
   // Clear the suppressed flag to make sure the framework can be offered
   // resources immediately after getting activated.
@@ -447,7 +467,7 @@ void HierarchicalAllocatorProcess::addSlave(
 
       if (quotas.contains(role)) {
         // See comment at `quotaRoleSorter` declaration regarding non-revocable.
-        quotaRoleSorter->allocated(role, slaveId, allocated.nonRevocable());
+        quotaRoleAllocated(role, slaveId, allocated.nonRevocable());
       }
     }
   }
@@ -456,15 +476,19 @@ void HierarchicalAllocatorProcess::addSlave(
 
   Slave& slave = slaves.at(slaveId);
 
-  slave.total = total;
-  slave.allocated = Resources::sum(used);
+  slave.updateTotal(total);
+  slave.updateAllocated(Resources::sum(used));
   slave.activated = true;
   slave.hostname = slaveInfo.hostname();
 
+  agentOrdering->add(
+      slaveId, slaveInfo, slave.getTotal(), slave.getAllocated());
+
   // NOTE: We currently implement maintenance in the allocator to be able to
   // leverage state and features such as the FrameworkSorter and OfferFilter.
   if (unavailability.isSome()) {
     slave.maintenance = Slave::Maintenance(unavailability.get());
+    inverseOfferCandidates.insert(slaveId);
   }
 
   // If we have just a number of recovered agents, we cannot distinguish
@@ -486,8 +510,8 @@ void HierarchicalAllocatorProcess::addSlave(
   }
 
   LOG(INFO) << "Added agent " << slaveId << " (" << slave.hostname << ")"
-            << " with " << slave.total
-            << " (allocated: " << slave.allocated << ")";
+            << " with " << slave.getTotal()
+            << " (allocated: " << slave.getAllocated() << ")";
 
   allocate(slaveId);
 }
@@ -505,17 +529,21 @@ void HierarchicalAllocatorProcess::removeSlave(
   // all the resources. Fixing this would require more information
   // than what we currently track in the allocator.
 
-  roleSorter->remove(slaveId, slaves.at(slaveId).total);
+  roleSorter->remove(slaveId, slaves.at(slaveId).getTotal());
 
   // See comment at `quotaRoleSorter` declaration regarding non-revocable.
-  quotaRoleSorter->remove(slaveId, slaves.at(slaveId).total.nonRevocable());
+  quotaRoleSorter->remove(
+      slaveId, slaves.at(slaveId).getTotal().nonRevocable());
+
+  agentOrdering->remove(slaveId);
 
   slaves.erase(slaveId);
   allocationCandidates.erase(slaveId);
+  dirtySlaves.erase(slaveId);
+  inverseOfferCandidates.erase(slaveId);
 
   // Note that we DO NOT actually delete any filters associated with
-  // this slave, that will occur when the delayed
-  // HierarchicalAllocatorProcess::expire gets invoked (or the framework
+  // this slave, that will occur when they expire (or the framework
   // that applied the filters gets removed).
 
   LOG(INFO) << "Removed agent " << slaveId;
@@ -534,7 +562,7 @@ void HierarchicalAllocatorProcess::updateSlave(
 
   Slave& slave = slaves.at(slaveId);
 
-  const Resources oldRevocable = slave.total.revocable();
+  const Resources oldRevocable = slave.getTotal().revocable();
 
   // Update the total resources.
   //
@@ -546,7 +574,8 @@ void HierarchicalAllocatorProcess::updateSlave(
   //
   // TODO(alexr): Update this math once the source of revocable resources
   // is extended beyond oversubscription.
-  slave.total = slave.total.nonRevocable() + oversubscribed;
+  slave.updateTotal(slave.getTotal().nonRevocable() + oversubscribed);
+  agentOrdering->update(slaveId, slave.getTotal(), slave.getAllocated());
 
   // Update the total resources in the `roleSorter` by removing the
   // previous oversubscribed resources and adding the new
@@ -560,8 +589,8 @@ void HierarchicalAllocatorProcess::updateSlave(
 
   LOG(INFO) << "Agent " << slaveId << " (" << slave.hostname << ")"
             << " updated with oversubscribed resources " << oversubscribed
-            << " (total: " << slave.total
-            << ", allocated: " << slave.allocated << ")";
+            << " (total: " << slave.getTotal()
+            << ", allocated: " << slave.getAllocated() << ")";
 
   allocate(slaveId);
 }
@@ -575,6 +604,10 @@ void HierarchicalAllocatorProcess::activateSlave(
 
   slaves.at(slaveId).activated = true;
 
+  if (allocationSweepInterval.isSome()) {
+    dirtySlaves.insert(slaveId);
+  }
+
   LOG(INFO) << "Agent " << slaveId << " reactivated";
 }
 
@@ -598,6 +631,12 @@ void HierarchicalAllocatorProcess::updateWhitelist(
 
   whitelist = _whitelist;
 
+  // Any agent might have become allocatable, so do not wait for the
+  // next sweep to allocate all agents.
+  if (allocationSweepInterval.isSome()) {
+    nextSweep = Timeout::in(Duration::zero());
+  }
+
   if (whitelist.isSome()) {
     LOG(INFO) << "Updated agent whitelist: " << stringify(whitelist.get());
 
@@ -700,14 +739,15 @@ void HierarchicalAllocatorProcess::updateAllocation(
         // resources already allocated to the framework (validated by the
         // master, see the CHECK above), this doesn't have an impact on
         // the allocator's allocation algorithm.
-        slave.allocated += additional;
+        slave.allocate(additional);
+        agentOrdering->update(slaveId, slave.getTotal(), slave.getAllocated());
 
         frameworkSorter->add(slaveId, additional);
         frameworkSorter->allocated(frameworkId.value(), slaveId, additional);
         roleSorter->allocated(framework.role, slaveId, additional);
 
         if (quotas.contains(framework.role)) {
-          quotaRoleSorter->allocated(
+          quotaRoleAllocated(
               framework.role, slaveId, additional.nonRevocable());
         }
       }
@@ -720,17 +760,20 @@ void HierarchicalAllocatorProcess::updateAllocation(
     // resource quantities remain unchanged.
 
     // Update the per-slave allocation.
-    Try<Resources> updatedSlaveAllocation = slave.allocated.apply(operation);
+    Try<Resources> updatedSlaveAllocation =
+      slave.getAllocated().apply(operation);
 
     CHECK_SOME(updatedSlaveAllocation);
 
-    slave.allocated = updatedSlaveAllocation.get();
+    slave.updateAllocated(updatedSlaveAllocation.get());
 
     // Update the total resources.
-    Try<Resources> updatedTotal = slave.total.apply(operation);
+    Try<Resources> updatedTotal = slave.getTotal().apply(operation);
     CHECK_SOME(updatedTotal);
 
-    slave.total = updatedTotal.get();
+    slave.updateTotal(updatedTotal.get());
+
+    agentOrdering->update(slaveId, slave.getTotal(), slave.getAllocated());
 
     // Update the total and allocated resources in each sorter.
     Resources frameworkAllocation =
@@ -772,7 +815,7 @@ void HierarchicalAllocatorProcess::updateAllocation(
 
     if (quotas.contains(framework.role)) {
       // See comment at `quotaRoleSorter` declaration regarding non-revocable.
-      quotaRoleSorter->update(
+      quotaRoleUpdated(
           framework.role,
           slaveId,
           frameworkAllocation.nonRevocable(),
@@ -809,17 +852,18 @@ Future<Nothing> HierarchicalAllocatorProcess::updateAvailable(
   //                \___/ \___/
   //
   //   where A = allocate, R = reserve, U = updateAvailable
-  Try<Resources> updatedAvailable = slave.available().apply(operations);
+  Try<Resources> updatedAvailable = slave.getAvailable().apply(operations);
   if (updatedAvailable.isError()) {
     return Failure(updatedAvailable.error());
   }
 
   // Update the total resources.
-  Try<Resources> updatedTotal = slave.total.apply(operations);
+  Try<Resources> updatedTotal = slave.getTotal().apply(operations);
   CHECK_SOME(updatedTotal);
 
-  const Resources oldTotal = slave.total;
-  slave.total = updatedTotal.get();
+  const Resources oldTotal = slave.getTotal();
+  slave.updateTotal(updatedTotal.get());
+  agentOrdering->update(slaveId, slave.getTotal(), slave.getAllocated());
 
   // Now, update the total resources in the role sorters by removing
   // the previous resources at this slave and adding the new resources.
@@ -830,6 +874,10 @@ Future<Nothing> HierarchicalAllocatorProcess::updateAvailable(
   quotaRoleSorter->remove(slaveId, oldTotal.nonRevocable());
   quotaRoleSorter->add(slaveId, updatedTotal.get().nonRevocable());
 
+  if (allocationSweepInterval.isSome()) {
+    dirtySlaves.insert(slaveId);
+  }
+
   return Nothing();
 }
 
@@ -857,10 +905,12 @@ void HierarchicalAllocatorProcess::updateUnavailability(
 
   // Remove any old unavailability.
   slave.maintenance = None();
+  inverseOfferCandidates.erase(slaveId);
 
   // If we have a new unavailability.
   if (unavailability.isSome()) {
     slave.maintenance = Slave::Maintenance(unavailability.get());
+    inverseOfferCandidates.insert(slaveId);
   }
 
   allocate(slaveId);
@@ -896,6 +946,7 @@ void HierarchicalAllocatorProcess::updateInverseOffer(
     // We always remove the outstanding offer so that we will send a new offer
     // out the next time we schedule inverse offers.
     maintenance.offersOutstanding.erase(frameworkId);
+    inverseOfferCandidates.insert(slaveId);
 
     // If the response is `Some`, this means the framework responded. Otherwise
     // if it is `None` the inverse offer timed out or was rescinded.
@@ -1014,7 +1065,7 @@ void HierarchicalAllocatorProcess::recoverResources(
 
       if (quotas.contains(framework.role)) {
         // See comment at `quotaRoleSorter` declaration regarding non-revocable.
-        quotaRoleSorter->unallocated(
+        quotaRoleUnallocated(
             framework.role, slaveId, resources.nonRevocable());
       }
     }
@@ -1026,13 +1077,18 @@ void HierarchicalAllocatorProcess::recoverResources(
   if (slaves.contains(slaveId)) {
     Slave& slave = slaves.at(slaveId);
 
-    CHECK(slave.allocated.contains(resources));
+    CHECK(slave.getAllocated().contains(resources));
 
-    slave.allocated -= resources;
+    slave.unallocate(resources);
+    agentOrdering->update(slaveId, slave.getTotal(), slave.getAllocated());
+
+    if (allocationSweepInterval.isSome()) {
+      dirtySlaves.insert(slaveId);
+    }
 
     VLOG(1) << "Recovered " << resources
-            << " (total: " << slave.total
-            << ", allocated: " << slave.allocated << ")"
+            << " (total: " << slave.getTotal()
+            << ", allocated: " << slave.getAllocated() << ")"
             << " on agent " << slaveId
             << " from framework " << frameworkId;
   }
@@ -1071,36 +1127,41 @@ void HierarchicalAllocatorProcess::recoverResources(
             << " filtered agent " << slaveId
             << " for " << timeout.get();
 
-    // Create a new filter.
-    OfferFilter* offerFilter = new RefusedOfferFilter(resources);
-    frameworks.at(frameworkId).offerFilters[slaveId].insert(offerFilter);
-
     // Expire the filter after both an `allocationInterval` and the
     // `timeout` have elapsed. This ensures that the filter does not
     // expire before we perform the next allocation for this agent,
     // see MESOS-4302 for more information.
     //
     // Because the next batched allocation goes through a dispatch
-    // after `allocationInterval`, we do the same for `expire()`
-    // (with a hepler `_expire()`) to achieve the above.
+    // after `allocationInterval`, we do the same for
+    // `expireOfferFilters()` (with a helper `_expireOfferFilters()`)
+    // to achieve the above.
     //
     // TODO(alexr): If we allocated upon resource recovery
     // (MESOS-3078), we would not need to increase the timeout here.
     timeout = std::max(allocationInterval, timeout.get());
 
-    // We need to disambiguate the function call to pick the correct
-    // `expire()` overload.
-    void (Self::*expireOffer)(
-              const FrameworkID&,
-              const SlaveID&,
-              OfferFilter*) = &Self::expire;
-
-    delay(timeout.get(),
-          self(),
-          expireOffer,
-          frameworkId,
-          slaveId,
-          offerFilter);
+    offerFilters.add(
+        frameworks.at(frameworkId).role,
+        frameworkId,
+        slaveId,
+        resources,
+        Clock::now() + timeout.get());
+
+    scheduleOfferFilterExpiry();
+  }
+}
+
+
+void HierarchicalAllocatorProcess::recoverResourcesOnAgents(
+    const FrameworkID& frameworkId,
+    const hashmap<SlaveID, Resources>& resources,
+    const Option<Filters>& filters)
+{
+  foreachpair (const SlaveID& slaveId,
+               const Resources& recovered,
+               resources) {
+    recoverResources(frameworkId, slaveId, recovered, filters);
   }
 }
 
@@ -1134,8 +1195,8 @@ void HierarchicalAllocatorProcess::reviveOffers(
 
   Framework& framework = frameworks.at(frameworkId);
 
-  framework.offerFilters.clear();
-  framework.inverseOfferFilters.clear();
+  offerFilters.remove(frameworkId);
+  removeInverseOfferFilters(frameworkId);
 
   if (framework.suppressed) {
     framework.suppressed = false;
@@ -1148,16 +1209,16 @@ void HierarchicalAllocatorProcess::reviveOffers(
     frameworkSorters.at(framework.role)->activate(frameworkId.value());
   }
 
-  // We delete each actual `OfferFilter` when
+  // We delete each actual `InverseOfferFilter` when
   // `HierarchicalAllocatorProcess::expire` gets invoked. If we delete the
-  // `OfferFilter` here it's possible that the same `OfferFilter` (i.e., same
+  // `InverseOfferFilter` here it's possible that the same filter (i.e., same
   // address) could get reused and `HierarchicalAllocatorProcess::expire`
   // would expire that filter too soon. Note that this only works
   // right now because ALL Filter types "expire".
 
   LOG(INFO) << "Removed offer filters for framework " << frameworkId;
 
-  allocate();
+  allocateRoles({framework.role});
 }
 
 
@@ -1176,6 +1237,7 @@ void HierarchicalAllocatorProcess::setQuota(
   // Persist quota in memory and add the role into the corresponding
   // allocation group.
   quotas[role] = quota;
+  roleNames.intern(role);
   quotaRoleSorter->add(role, roleWeight(role));
 
   // Copy allocation information for the quota'ed role.
@@ -1188,13 +1250,17 @@ void HierarchicalAllocatorProcess::setQuota(
     }
   }
 
+  unallocatedQuota +=
+    quotaRoleUnallocatedResources(quotaRoleSorter.get(), role);
+
   metrics.setQuota(role, quota);
 
   // TODO(alexr): Print all quota info for the role.
   LOG(INFO) << "Set quota " << quota.info.guarantee() << " for role '" << role
             << "'";
 
-  allocate();
+  // Setting quota only reduces the resources available to other roles.
+  allocateRoles({role});
 }
 
 
@@ -1212,6 +1278,9 @@ void HierarchicalAllocatorProcess::removeQuota(
             << " for role '" << role << "'";
 
   // Remove the role from the quota'ed allocation group.
+  unallocatedQuota -=
+    quotaRoleUnallocatedResources(quotaRoleSorter.get(), role);
+
   quotas.erase(role);
   quotaRoleSorter->remove(role);
 
@@ -1226,7 +1295,7 @@ void HierarchicalAllocatorProcess::updateWeights(
 {
   CHECK(initialized);
 
-  bool rebalance = false;
+  hashset<string> rebalance;
 
   // Update the weight for each specified role.
   foreach (const WeightInfo& weightInfo, weightInfos) {
@@ -1243,15 +1312,15 @@ void HierarchicalAllocatorProcess::updateWeights(
     }
 
     if (roleSorter->contains(weightInfo.role())) {
-      rebalance = true;
+      rebalance.insert(weightInfo.role());
       roleSorter->update(weightInfo.role(), weightInfo.weight());
     }
   }
 
   // If at least one of the updated roles has registered
   // frameworks, then trigger the allocation.
-  if (rebalance) {
-    allocate();
+  if (!rebalance.empty()) {
+    allocateRoles(rebalance);
   }
 }
 
@@ -1280,7 +1349,30 @@ void HierarchicalAllocatorProcess::batch()
 {
   auto pid = self();
 
-  allocate()
+  Future<Nothing> allocation_ = Nothing();
+
+  if (allocationSweepInterval.isNone()) {
+    allocation_ = allocate();
+  } else if (nextSweep.expired()) {
+    nextSweep = Timeout::in(allocationSweepInterval.get());
+    dirtySlaves.clear();
+
+    allocation_ = allocate();
+  } else {
+    // Inverse offers must not wait for their agents to become dirty
+    // or for the next sweep, so every batch considers all the agents
+    // that may have inverse offers to send, not just the dirty ones.
+    if (!paused) {
+      deallocate(inverseOfferCandidates);
+    }
+
+    if (!dirtySlaves.empty()) {
+      allocation_ = allocate(dirtySlaves);
+      dirtySlaves.clear();
+    }
+  }
+
+  allocation_
     .onAny([pid, this]() {
       delay(allocationInterval, pid, &Self::batch);
     });
@@ -1320,6 +1412,25 @@ Future<Nothing> HierarchicalAllocatorProcess::allocate(
 }
 
 
+Future<Nothing> HierarchicalAllocatorProcess::allocateRoles(
+    const hashset<string>& roles)
+{
+  if (allocationSweepInterval.isNone()) {
+    return allocate();
+  }
+
+  if (paused) {
+    VLOG(1) << "Skipped allocation because the allocator is paused";
+
+    return Nothing();
+  }
+
+  allocationCandidateRoles |= roles;
+
+  return allocate(hashset<SlaveID>());
+}
+
+
 Nothing HierarchicalAllocatorProcess::_allocate() {
   if (paused) {
     VLOG(1) << "Skipped allocation because the allocator is paused";
@@ -1338,15 +1449,17 @@ Nothing HierarchicalAllocatorProcess::_allocate() {
   // NOTE: For now, we implement maintenance inverse offers within the
   // allocator. We leverage the existing timer/cycle of offers to also do any
   // "deallocation" (inverse offers) necessary to satisfy maintenance needs.
-  deallocate();
+  deallocate(allocationCandidates);
 
   metrics.allocation_run.stop();
 
   VLOG(1) << "Performed allocation for " << allocationCandidates.size()
-          << " agents in " << stopwatch.elapsed();
+          << " agents and " << allocationCandidateRoles.size()
+          << " roles in " << stopwatch.elapsed();
 
   // Clear the candidates on completion of the allocation run.
   allocationCandidates.clear();
+  allocationCandidateRoles.clear();
 
   return Nothing();
 }
@@ -1367,38 +1480,353 @@ void HierarchicalAllocatorProcess::__allocate()
   // assume cluster knowledge when summing resources from that set.
 
   vector<SlaveID> slaveIds;
-  slaveIds.reserve(allocationCandidates.size());
+
+  // The time spent in each part of the allocation, for the allocation
+  // run metrics.
+  Stopwatch stopwatch;
+  stopwatch.start();
+
+  size_t skipped = 0;
 
   // Filter out non-whitelisted, removed, and deactivated slaves
   // in order not to send offers for them.
-  foreach (const SlaveID& slaveId, allocationCandidates) {
+  auto candidate = [this, &slaveIds, &skipped](const SlaveID& slaveId) {
     if (isWhitelisted(slaveId) &&
         slaves.contains(slaveId) &&
         slaves.at(slaveId).activated) {
       slaveIds.push_back(slaveId);
+    } else {
+      ++skipped;
+    }
+  };
+
+  // If there are candidate roles, all agents are candidates for these
+  // roles; `computeOffers()` only considers the other roles on the
+  // agents in `allocationCandidates`.
+  if (allocationCandidateRoles.empty()) {
+    slaveIds.reserve(allocationCandidates.size());
+
+    foreach (const SlaveID& slaveId, allocationCandidates) {
+      candidate(slaveId);
+    }
+  } else {
+    slaveIds.reserve(slaves.size());
+
+    foreachkey (const SlaveID& slaveId, slaves) {
+      candidate(slaveId);
     }
   }
 
-  // Randomize the order in which slaves' resources are allocated.
-  //
-  // TODO(vinod): Implement a smarter sorting algorithm.
-  std::random_shuffle(slaveIds.begin(), slaveIds.end());
+  // Order the agents according to `--agent_ordering`.
+  slaveIds = agentOrdering->order(slaveIds);
 
-  // Returns the __quantity__ of resources allocated to a quota role. Since we
-  // account for reservations and persistent volumes toward quota, we strip
-  // reservation and persistent volume related information for comparability.
-  // The result is used to determine whether a role's quota is satisfied, and
-  // also to determine how many resources the role would need in order to meet
-  // its quota.
-  //
-  // NOTE: Revocable resources are excluded in `quotaRoleSorter`.
-  auto getQuotaRoleAllocatedResources = [this](const string& role) {
-    CHECK(quotas.contains(role));
+  const Duration candidates = stopwatch.elapsed();
+
+  AllocationStats stats;
+
+  const size_t partitions =
+    std::min(allocationPartitions.getOrElse(1), slaveIds.size());
+
+  if (partitions <= 1) {
+    AllocationSorters sorters;
+    sorters.roleSorter = roleSorter.get();
+    sorters.quotaRoleSorter = quotaRoleSorter.get();
+    sorters.unallocatedQuota = unallocatedQuota;
+    sorters.frameworkSorters = allocationFrameworkSorters();
+
+    // The allocation pass updates our sorters as it goes, along with
+    // the headroom it works with, so all that is left to do is to write
+    // the headroom back and to account for the offers on the agents.
+    const vector<OfferCandidate> offers =
+      computeOffers(slaveIds, sorters, stats);
+
+    unallocatedQuota = sorters.unallocatedQuota;
+
+    foreach (const OfferCandidate& offer, offers) {
+      offerable[offer.frameworkId][offer.slaveId] += offer.resources;
+
+      Slave& slave = slaves.at(offer.slaveId);
+      slave.allocate(offer.resources);
+      agentOrdering->update(
+          offer.slaveId, slave.getTotal(), slave.getAllocated());
+
+      if (slave.maintenance.isSome()) {
+        inverseOfferCandidates.insert(offer.slaveId);
+      }
+    }
+  } else {
+    // Split the (ordered) agents into contiguous partitions and run an
+    // allocation pass for each of them in parallel. Every pass operates
+    // on its own snapshot of the sorters, so that the passes do not
+    // need to synchronize with each other; the remaining allocator
+    // state is only read while the passes run.
+    //
+    // NOTE: Since each pass only sees the allocations made within its
+    // own partition, the passes can jointly allocate more than a role's
+    // quota or more than the second stage headroom. We reconcile this
+    // when merging below, at the cost of fairness across partitions
+    // only being approximate within a single allocation run.
+    vector<vector<SlaveID>> partitionSlaveIds(partitions);
+    for (size_t i = 0; i < slaveIds.size(); ++i) {
+      partitionSlaveIds[i * partitions / slaveIds.size()].push_back(
+          slaveIds[i]);
+    }
+
+    vector<Owned<Sorter>> snapshots;
+    vector<AllocationSorters> partitionSorters(partitions);
+
+    auto roleWeights = [this](const string& role) {
+      return roleWeight(role);
+    };
+
+    auto frameworkWeights = [](const string&) { return 1.0; };
+
+    foreach (AllocationSorters& sorters, partitionSorters) {
+      snapshots.push_back(
+          Owned<Sorter>(snapshot(
+              roleSorter.get(), roleSnapshotSorterFactory, roleWeights)));
+      sorters.roleSorter = snapshots.back().get();
+
+      snapshots.push_back(
+          Owned<Sorter>(snapshot(
+              quotaRoleSorter.get(), quotaRoleSorterFactory, roleWeights)));
+      sorters.quotaRoleSorter = snapshots.back().get();
+      sorters.unallocatedQuota = unallocatedQuota;
+
+      foreach (Sorter* frameworkSorter, allocationFrameworkSorters()) {
+        if (frameworkSorter != nullptr) {
+          snapshots.push_back(
+              Owned<Sorter>(snapshot(
+                  frameworkSorter, frameworkSorterFactory, frameworkWeights)));
+          frameworkSorter = snapshots.back().get();
+        }
+
+        sorters.frameworkSorters.push_back(frameworkSorter);
+      }
+    }
+
+    vector<vector<OfferCandidate>> offerCandidates(partitions);
+    vector<AllocationStats> partitionStats(partitions);
+
+    // NOTE: The first partition is allocated on the allocator's own
+    // thread, which waits for the other partitions before resuming.
+    vector<std::thread> threads;
+    for (size_t i = 1; i < partitions; ++i) {
+      threads.emplace_back([this, i, &partitionSlaveIds, &partitionSorters,
+                            &offerCandidates, &partitionStats]() {
+        offerCandidates[i] = computeOffers(
+            partitionSlaveIds[i], partitionSorters[i], partitionStats[i]);
+      });
+    }
+
+    offerCandidates[0] = computeOffers(
+        partitionSlaveIds[0], partitionSorters[0], partitionStats[0]);
+
+    foreach (std::thread& thread, threads) {
+      thread.join();
+    }
+
+    // NOTE: The time spent in the passes is summed up over the
+    // partitions, i.e., it exceeds the time the passes took when they
+    // ran in parallel.
+    foreach (const AllocationStats& _stats, partitionStats) {
+      stats.quotaStage += _stats.quotaStage;
+      stats.fairShareStage += _stats.fairShareStage;
+      stats.sort += _stats.sort;
+      stats.filters += _stats.filters;
+      stats.sorterClientsVisited += _stats.sorterClientsVisited;
+    }
+
+    // Apply an offer made by a partition to the allocator's state.
+    auto apply = [this, &offerable](const OfferCandidate& offer) {
+      offerable[offer.frameworkId][offer.slaveId] += offer.resources;
 
-    // NOTE: `allocationScalarQuantities` omits dynamic reservation
-    // and persistent volume info, but we additionally strip `role`
-    // here via `flatten()`.
-    return quotaRoleSorter->allocationScalarQuantities(role).flatten();
+      Slave& slave = slaves.at(offer.slaveId);
+      slave.allocate(offer.resources);
+      agentOrdering->update(
+          offer.slaveId, slave.getTotal(), slave.getAllocated());
+
+      if (slave.maintenance.isSome()) {
+        inverseOfferCandidates.insert(offer.slaveId);
+      }
+
+      const Owned<Sorter>& frameworkSorter = frameworkSorters.at(offer.role);
+
+      frameworkSorter->add(offer.slaveId, offer.resources);
+      frameworkSorter->allocated(
+          offer.frameworkId.value(), offer.slaveId, offer.resources);
+      roleSorter->allocated(offer.role, offer.slaveId, offer.resources);
+
+      if (quotas.contains(offer.role)) {
+        // See comment at `quotaRoleSorter` declaration regarding
+        // non-revocable.
+        quotaRoleAllocated(
+            offer.role, offer.slaveId, offer.resources.nonRevocable());
+      }
+    };
+
+    // Merge the offers in partition order so that the outcome does not
+    // depend on how the passes were scheduled. Quota allocations are
+    // merged first, skipping those for roles whose quota has already
+    // been satisfied by an earlier partition.
+    foreach (const vector<OfferCandidate>& offers, offerCandidates) {
+      foreach (const OfferCandidate& offer, offers) {
+        if (!offer.quota) {
+          continue;
+        }
+
+        if (quotaRoleAllocatedResources(quotaRoleSorter.get(), offer.role)
+              .contains(quotas.at(offer.role).info.guarantee())) {
+          VLOG(2) << "Dropping allocation of " << offer.resources
+                  << " on agent " << offer.slaveId << " to framework "
+                  << offer.frameworkId << " as the quota of role '"
+                  << offer.role << "' is already satisfied";
+          continue;
+        }
+
+        apply(offer);
+      }
+    }
+
+    // Then merge the fair share allocations, making sure that they do
+    // not use more than the headroom left after all quota allocations.
+    AllocationSorters sorters;
+    sorters.roleSorter = roleSorter.get();
+    sorters.quotaRoleSorter = quotaRoleSorter.get();
+    sorters.unallocatedQuota = unallocatedQuota;
+
+    const Resources remaining = remainingClusterResources(sorters);
+
+    Resources allocatedStage2;
+
+    foreach (const vector<OfferCandidate>& offers, offerCandidates) {
+      foreach (const OfferCandidate& offer, offers) {
+        if (offer.quota) {
+          continue;
+        }
+
+        const Resources scalarQuantity =
+          offer.resources.nonShared().createStrippedScalarQuantity();
+
+        if (!remaining.contains(allocatedStage2 + scalarQuantity)) {
+          VLOG(2) << "Dropping allocation of " << offer.resources
+                  << " on agent " << offer.slaveId << " to framework "
+                  << offer.frameworkId << " as it exceeds the resources"
+                  << " remaining for allocation";
+          continue;
+        }
+
+        allocatedStage2 += scalarQuantity;
+
+        apply(offer);
+      }
+    }
+  }
+
+  stopwatch.start();
+
+  if (offerable.empty()) {
+    VLOG(1) << "No allocations performed";
+  } else {
+    // Now offer the resources to each framework.
+    foreachkey (const FrameworkID& frameworkId, offerable) {
+      offerCallback(frameworkId, offerable[frameworkId]);
+    }
+  }
+
+  metrics.allocation_run_candidates.record(candidates);
+  metrics.allocation_run_quota_stage.record(stats.quotaStage);
+  metrics.allocation_run_fair_share_stage.record(stats.fairShareStage);
+  metrics.allocation_run_sort.record(stats.sort);
+  metrics.allocation_run_filters.record(stats.filters);
+  metrics.allocation_run_offer_callbacks.record(stopwatch.elapsed());
+
+  metrics.allocation_run_sorter_clients_visited += stats.sorterClientsVisited;
+  metrics.allocation_run_agents_skipped += skipped;
+}
+
+
+vector<HierarchicalAllocatorProcess::OfferCandidate>
+HierarchicalAllocatorProcess::computeOffers(
+    const vector<SlaveID>& slaveIds,
+    AllocationSorters& sorters,
+    AllocationStats& stats) const
+{
+  vector<OfferCandidate> offers;
+
+  // Sorts the clients of a sorter and evaluates the offer filters of a
+  // framework, accounting for the time spent doing so in `stats`.
+  auto sort = [&stats](Sorter* sorter) {
+    Stopwatch stopwatch;
+    stopwatch.start();
+
+    vector<string> clients = sorter->sort();
+
+    stats.sort += stopwatch.elapsed();
+
+    return clients;
+  };
+
+  auto filtered = [this, &stats](
+      const FrameworkID& frameworkId,
+      const SlaveID& slaveId,
+      const Resources& resources) {
+    Stopwatch stopwatch;
+    stopwatch.start();
+
+    const bool result = isFiltered(frameworkId, slaveId, resources);
+
+    stats.filters += stopwatch.elapsed();
+
+    return result;
+  };
+
+  // The quota and activeness of each role, indexed by role handle, so
+  // that the loops below look these up by handle rather than by name.
+  vector<const Quota*> roleQuotas(roleNames.size(), nullptr);
+  foreachpair (const string& role, const Quota& quota, quotas) {
+    Option<Interner<string>::Handle> handle = roleNames.lookup(role);
+    CHECK_SOME(handle);
+
+    roleQuotas[handle.get()] = &quota;
+  }
+
+  vector<bool> roleActive(roleNames.size(), false);
+  foreachkey (const string& role, activeRoles) {
+    Option<Interner<string>::Handle> handle = roleNames.lookup(role);
+    CHECK_SOME(handle);
+
+    roleActive[handle.get()] = true;
+  }
+
+  // Whether a role is allocated on all agents, rather than only on the
+  // agents in `allocationCandidates` (see `allocationCandidateRoles`).
+  vector<bool> roleCandidate(roleNames.size(), false);
+  foreach (const string& role, allocationCandidateRoles) {
+    Option<Interner<string>::Handle> handle = roleNames.lookup(role);
+    if (handle.isSome()) {
+      roleCandidate[handle.get()] = true;
+    }
+  }
+
+  // Resources allocated on each agent during this pass, indexed by the
+  // position of the agent in `slaveIds`. These are not yet reflected
+  // in `Slave::allocated`.
+  vector<Resources> allocated(slaveIds.size());
+
+  // The partitions of the resources that remain available on each agent
+  // after the allocations made during this pass, indexed like
+  // `allocated`. Until something is allocated on an agent, the
+  // partitions cached in its `Slave` are used instead.
+  vector<Option<OfferableResources>> remaining(slaveIds.size());
+
+  auto offerable = [this, &slaveIds, &remaining](size_t i)
+      -> const OfferableResources& {
+    if (remaining[i].isSome()) {
+      return remaining[i].get();
+    }
+
+    return slaves.at(slaveIds[i]).getOfferable();
   };
 
   // Due to the two stages in the allocation algorithm and the nature of
@@ -1409,25 +1837,48 @@ void HierarchicalAllocatorProcess::__allocate()
   // not depend on its implementation details. For now we make sure a
   // shared resource is only allocated once in one offer cycle. We use
   // `offeredSharedResources` to keep track of shared resources already
-  // allocated in the current cycle.
-  hashmap<SlaveID, Resources> offeredSharedResources;
+  // allocated in the current cycle, indexed like `allocated`.
+  vector<Resources> offeredSharedResources(slaveIds.size());
+
+  Stopwatch stopwatch;
+  stopwatch.start();
 
   // Quota comes first and fair share second. Here we process only those
   // roles, for which quota is set (quota'ed roles). Such roles form a
   // special allocation group with a dedicated sorter.
-  foreach (const SlaveID& slaveId, slaveIds) {
-    foreach (const string& role, quotaRoleSorter->sort()) {
-      CHECK(quotas.contains(role));
+  for (size_t i = 0; i < slaveIds.size(); i++) {
+    const SlaveID& slaveId = slaveIds[i];
+
+    CHECK(slaves.contains(slaveId));
+    const Slave& slave = slaves.at(slaveId);
+
+    const bool hasGpus = slave.getTotal().gpus().getOrElse(0) > 0;
+
+    const bool allRoles = allocationCandidates.contains(slaveId);
+
+    foreach (const string& role, sort(sorters.quotaRoleSorter)) {
+      ++stats.sorterClientsVisited;
+
+      Option<Interner<string>::Handle> handle = roleNames.lookup(role);
+      CHECK_SOME(handle);
+
+      if (!allRoles && !roleCandidate[handle.get()]) {
+        continue;
+      }
+
+      const Quota* quota = roleQuotas[handle.get()];
+      CHECK_NOTNULL(quota);
 
       // If there are no active frameworks in this role, we do not
       // need to do any allocations for this role.
-      if (!activeRoles.contains(role)) {
+      if (!roleActive[handle.get()]) {
         continue;
       }
 
       // Get the total quantity of resources allocated to a quota role. The
       // value omits role, reservation, and persistence info.
-      Resources roleConsumedResources = getQuotaRoleAllocatedResources(role);
+      Resources roleConsumedResources =
+        quotaRoleAllocatedResources(sorters.quotaRoleSorter, role);
 
       // If quota for the role is satisfied, we do not need to do any further
       // allocations for this role, at least at this stage.
@@ -1436,48 +1887,46 @@ void HierarchicalAllocatorProcess::__allocate()
       // alternatives are:
       //   * A custom sorter that is aware of quotas and sorts accordingly.
       //   * Removing satisfied roles from the sorter.
-      if (roleConsumedResources.contains(quotas[role].info.guarantee())) {
+      if (roleConsumedResources.contains(quota->info.guarantee())) {
         continue;
       }
 
       // Fetch frameworks according to their fair share.
       // NOTE: Suppressed frameworks are not included in the sort.
-      CHECK(frameworkSorters.contains(role));
-      const Owned<Sorter>& frameworkSorter = frameworkSorters.at(role);
+      Sorter* frameworkSorter = sorters.frameworkSorters.at(handle.get());
+      CHECK_NOTNULL(frameworkSorter);
+
+      foreach (const string& frameworkId_, sort(frameworkSorter)) {
+        ++stats.sorterClientsVisited;
 
-      foreach (const string& frameworkId_, frameworkSorter->sort()) {
         FrameworkID frameworkId;
         frameworkId.set_value(frameworkId_);
 
-        CHECK(slaves.contains(slaveId));
         CHECK(frameworks.contains(frameworkId));
 
         const Framework& framework = frameworks.at(frameworkId);
-        Slave& slave = slaves.at(slaveId);
 
         // Only offer resources from slaves that have GPUs to
         // frameworks that are capable of receiving GPUs.
         // See MESOS-5634.
-        if (!framework.capabilities.gpuResources &&
-            slave.total.gpus().getOrElse(0) > 0) {
+        if (!framework.capabilities.gpuResources && hasGpus) {
           continue;
         }
 
-        // Calculate the currently available resources on the slave, which
-        // is the difference in non-shared resources between total and
-        // allocated, plus all shared resources on the agent (if applicable).
-        // Since shared resources are offerable even when they are in use, we
-        // make one copy of the shared resources available regardless of the
-        // past allocations.
-        Resources available = slave.available().nonShared();
+        // The currently available resources on the slave are the
+        // difference in non-shared resources between total and allocated,
+        // plus all shared resources on the agent (if applicable). Since
+        // shared resources are offerable even when they are in use, we
+        // make one copy of the shared resources available regardless of
+        // the past allocations.
+        const OfferableResources& available = offerable(i);
 
         // Offer a shared resource only if it has not been offered in
         // this offer cycle to a framework.
-        if (framework.capabilities.sharedResources) {
-          available += slave.total.shared();
-          if (offeredSharedResources.contains(slaveId)) {
-            available -= offeredSharedResources[slaveId];
-          }
+        Resources shared;
+        if (framework.capabilities.sharedResources &&
+            !slave.getShared().empty()) {
+          shared = slave.getShared() - offeredSharedResources[i];
         }
 
         // The resources we offer are the unreserved resources as well as the
@@ -1493,8 +1942,12 @@ void HierarchicalAllocatorProcess::__allocate()
         // reserved resources are accounted towards the quota guarantee. If we
         // were to rely on stage 2 to offer them out, they would not be checked
         // against the quota guarantee.
-        Resources resources =
-          (available.unreserved() + available.reserved(role)).nonRevocable();
+        Resources resources = available.unreserved + available.reserved(role);
+
+        if (!shared.empty()) {
+          resources +=
+            (shared.unreserved() + shared.reserved(role)).nonRevocable();
+        }
 
         // It is safe to break here, because all frameworks under a role would
         // consider the same resources, so in case we don't have allocatable
@@ -1511,7 +1964,7 @@ void HierarchicalAllocatorProcess::__allocate()
 
         // If the framework filters these resources, ignore. The unallocated
         // part of the quota will not be allocated to other roles.
-        if (isFiltered(frameworkId, slaveId, resources)) {
+        if (filtered(frameworkId, slaveId, resources)) {
           continue;
         }
 
@@ -1522,10 +1975,12 @@ void HierarchicalAllocatorProcess::__allocate()
         // NOTE: We perform "coarse-grained" allocation for quota'ed
         // resources, which may lead to overcommitment of resources beyond
         // quota. This is fine since quota currently represents a guarantee.
-        offerable[frameworkId][slaveId] += resources;
-        offeredSharedResources[slaveId] += resources.shared();
+        offers.push_back({frameworkId, slaveId, role, resources, true});
+        offeredSharedResources[i] += resources.shared();
 
-        slave.allocated += resources;
+        allocated[i] += resources;
+        remaining[i] = OfferableResources(
+            slave.getAvailable().nonShared() - allocated[i].nonShared());
 
         // Resources allocated as part of the quota count towards the
         // role's and the framework's fair share.
@@ -1533,51 +1988,23 @@ void HierarchicalAllocatorProcess::__allocate()
         // NOTE: Revocable resources have already been excluded.
         frameworkSorter->add(slaveId, resources);
         frameworkSorter->allocated(frameworkId_, slaveId, resources);
-        roleSorter->allocated(role, slaveId, resources);
-        quotaRoleSorter->allocated(role, slaveId, resources);
+        sorters.roleSorter->allocated(role, slaveId, resources);
+
+        sorters.unallocatedQuota -=
+          quotaRoleUnallocatedResources(sorters.quotaRoleSorter, role);
+        sorters.quotaRoleSorter->allocated(role, slaveId, resources);
+        sorters.unallocatedQuota +=
+          quotaRoleUnallocatedResources(sorters.quotaRoleSorter, role);
       }
     }
   }
 
-  // Calculate the total quantity of scalar resources (including revocable
-  // and reserved) that are available for allocation in the next round. We
-  // need this in order to ensure we do not over-allocate resources during
-  // the second stage.
-  //
-  // For performance reasons (MESOS-4833), this omits information about
-  // dynamic reservations or persistent volumes in the resources.
-  //
-  // NOTE: We use total cluster resources, and not just those based on the
-  // agents participating in the current allocation (i.e. provided as an
-  // argument to the `allocate()` call) so that frameworks in roles without
-  // quota are not unnecessarily deprived of resources.
-  Resources remainingClusterResources = roleSorter->totalScalarQuantities();
-  foreachkey (const string& role, activeRoles) {
-    remainingClusterResources -= roleSorter->allocationScalarQuantities(role);
-  }
-
-  // Frameworks in a quota'ed role may temporarily reject resources by
-  // filtering or suppressing offers. Hence quotas may not be fully allocated.
-  Resources unallocatedQuotaResources;
-  foreachpair (const string& name, const Quota& quota, quotas) {
-    // Compute the amount of quota that the role does not have allocated.
-    //
-    // NOTE: Revocable resources are excluded in `quotaRoleSorter`.
-    // NOTE: Only scalars are considered for quota.
-    Resources allocated = getQuotaRoleAllocatedResources(name);
-    const Resources required = quota.info.guarantee();
-    unallocatedQuotaResources += (required - allocated);
-  }
+  stats.quotaStage += stopwatch.elapsed();
 
-  // Determine how many resources we may allocate during the next stage.
-  //
-  // NOTE: Resources for quota allocations are already accounted in
-  // `remainingClusterResources`.
-  remainingClusterResources -= unallocatedQuotaResources;
+  stopwatch.start();
 
-  // Shared resources are excluded in determination of over-allocation of
-  // available resources since shared resources are always allocatable.
-  remainingClusterResources = remainingClusterResources.nonShared();
+  const Resources remainingClusterResources =
+    this->remainingClusterResources(sorters);
 
   // To ensure we do not over-allocate resources during the second stage
   // with all frameworks, we use 2 stopping criteria:
@@ -1597,50 +2024,68 @@ void HierarchicalAllocatorProcess::__allocate()
 
   // At this point resources for quotas are allocated or accounted for.
   // Proceed with allocating the remaining free pool.
-  foreach (const SlaveID& slaveId, slaveIds) {
+  for (size_t i = 0; i < slaveIds.size(); i++) {
     // If there are no resources available for the second stage, stop.
     if (!allocatable(remainingClusterResources - allocatedStage2)) {
       break;
     }
 
-    foreach (const string& role, roleSorter->sort()) {
+    const SlaveID& slaveId = slaveIds[i];
+
+    CHECK(slaves.contains(slaveId));
+    const Slave& slave = slaves.at(slaveId);
+
+    const bool hasGpus = slave.getTotal().gpus().getOrElse(0) > 0;
+
+    const bool allRoles = allocationCandidates.contains(slaveId);
+
+    foreach (const string& role, sort(sorters.roleSorter)) {
+      ++stats.sorterClientsVisited;
+
+      Option<Interner<string>::Handle> handle = roleNames.lookup(role);
+      CHECK_SOME(handle);
+
+      if (!allRoles && !roleCandidate[handle.get()]) {
+        continue;
+      }
+
+      const bool hasQuota = roleQuotas[handle.get()] != nullptr;
+
       // NOTE: Suppressed frameworks are not included in the sort.
-      CHECK(frameworkSorters.contains(role));
-      const Owned<Sorter>& frameworkSorter = frameworkSorters.at(role);
+      Sorter* frameworkSorter = sorters.frameworkSorters.at(handle.get());
+      CHECK_NOTNULL(frameworkSorter);
+
+      foreach (const string& frameworkId_, sort(frameworkSorter)) {
+        ++stats.sorterClientsVisited;
 
-      foreach (const string& frameworkId_, frameworkSorter->sort()) {
         FrameworkID frameworkId;
         frameworkId.set_value(frameworkId_);
 
-        CHECK(slaves.contains(slaveId));
         CHECK(frameworks.contains(frameworkId));
 
         const Framework& framework = frameworks.at(frameworkId);
-        Slave& slave = slaves.at(slaveId);
 
         // Only offer resources from slaves that have GPUs to
         // frameworks that are capable of receiving GPUs.
         // See MESOS-5634.
-        if (!framework.capabilities.gpuResources &&
-            slave.total.gpus().getOrElse(0) > 0) {
+        if (!framework.capabilities.gpuResources && hasGpus) {
           continue;
         }
 
-        // Calculate the currently available resources on the slave, which
-        // is the difference in non-shared resources between total and
-        // allocated, plus all shared resources on the agent (if applicable).
-        // Since shared resources are offerable even when they are in use, we
-        // make one copy of the shared resources available regardless of the
-        // past allocations.
-        Resources available = slave.available().nonShared();
+        // The currently available resources on the slave are the
+        // difference in non-shared resources between total and allocated,
+        // plus all shared resources on the agent (if applicable). Since
+        // shared resources are offerable even when they are in use, we
+        // make one copy of the shared resources available regardless of
+        // the past allocations.
+        const OfferableResources& available = offerable(i);
 
         // Offer a shared resource only if it has not been offered in
         // this offer cycle to a framework.
-        if (framework.capabilities.sharedResources) {
-          available += slave.total.shared();
-          if (offeredSharedResources.contains(slaveId)) {
-            available -= offeredSharedResources[slaveId];
-          }
+        Resources shared;
+        if (framework.capabilities.sharedResources &&
+            !slave.getShared().empty()) {
+          shared = slave.getShared() - offeredSharedResources[i];
         }
 
         // The resources we offer are the unreserved resources as well as the
@@ -1658,8 +2103,26 @@ void HierarchicalAllocatorProcess::__allocate()
         //
         // TODO(mpark): Offer unreserved resources as revocable beyond quota.
         Resources resources = available.reserved(role);
-        if (!quotas.contains(role)) {
-          resources += available.unreserved();
+        if (!hasQuota) {
+          resources += available.unreserved;
+        }
+
+        Resources revocable;
+        if (!available.revocable.empty()) {
+          revocable = available.revocable.reserved(role);
+          if (!hasQuota) {
+            revocable += available.revocable.unreserved();
+          }
+        }
+
+        if (!shared.empty()) {
+          Resources offerableShared = shared.reserved(role);
+          if (!hasQuota) {
+            offerableShared += shared.unreserved();
+          }
+
+          resources += offerableShared.nonRevocable();
+          revocable += offerableShared.revocable();
         }
 
         // It is safe to break here, because all frameworks under a role would
@@ -1672,13 +2135,13 @@ void HierarchicalAllocatorProcess::__allocate()
         // check for revocable resources, which can be disabled on a per frame-
         // work basis, which requires us to go through all frameworks in case we
         // have allocatable revocable resources.
-        if (!allocatable(resources)) {
+        if (!allocatable(resources + revocable)) {
           break;
         }
 
-        // Remove revocable resources if the framework has not opted for them.
-        if (!framework.capabilities.revocableResources) {
-          resources = resources.nonRevocable();
+        // Only offer revocable resources if the framework has opted for them.
+        if (framework.capabilities.revocableResources) {
+          resources += revocable;
         }
 
         // If the resources are not allocatable, ignore. We cannot break
@@ -1689,7 +2152,7 @@ void HierarchicalAllocatorProcess::__allocate()
         }
 
         // If the framework filters these resources, ignore.
-        if (isFiltered(frameworkId, slaveId, resources)) {
+        if (filtered(frameworkId, slaveId, resources)) {
           continue;
         }
 
@@ -1716,37 +2179,191 @@ void HierarchicalAllocatorProcess::__allocate()
         //
         // NOTE: We may have already allocated some resources on the current
         // agent as part of quota.
-        offerable[frameworkId][slaveId] += resources;
-        offeredSharedResources[slaveId] += resources.shared();
+        offers.push_back({frameworkId, slaveId, role, resources, false});
+        offeredSharedResources[i] += resources.shared();
         allocatedStage2 += scalarQuantity;
 
-        slave.allocated += resources;
+        allocated[i] += resources;
+        remaining[i] = OfferableResources(
+            slave.getAvailable().nonShared() - allocated[i].nonShared());
 
         frameworkSorter->add(slaveId, resources);
         frameworkSorter->allocated(frameworkId_, slaveId, resources);
-        roleSorter->allocated(role, slaveId, resources);
+        sorters.roleSorter->allocated(role, slaveId, resources);
 
-        if (quotas.contains(role)) {
+        if (hasQuota) {
           // See comment at `quotaRoleSorter` declaration regarding
           // non-revocable.
-          quotaRoleSorter->allocated(role, slaveId, resources.nonRevocable());
+          sorters.unallocatedQuota -=
+            quotaRoleUnallocatedResources(sorters.quotaRoleSorter, role);
+          sorters.quotaRoleSorter->allocated(
+              role, slaveId, resources.nonRevocable());
+          sorters.unallocatedQuota +=
+            quotaRoleUnallocatedResources(sorters.quotaRoleSorter, role);
         }
       }
     }
   }
 
-  if (offerable.empty()) {
-    VLOG(1) << "No allocations performed";
-  } else {
-    // Now offer the resources to each framework.
-    foreachkey (const FrameworkID& frameworkId, offerable) {
-      offerCallback(frameworkId, offerable[frameworkId]);
-    }
+  stats.fairShareStage += stopwatch.elapsed();
+
+  return offers;
+}
+
+
+vector<Sorter*> HierarchicalAllocatorProcess::allocationFrameworkSorters() const
+{
+  vector<Sorter*> result(roleNames.size(), nullptr);
+
+  foreachpair (const string& role,
+               const Owned<Sorter>& frameworkSorter,
+               frameworkSorters) {
+    Option<Interner<string>::Handle> handle = roleNames.lookup(role);
+    CHECK_SOME(handle);
+
+    result[handle.get()] = frameworkSorter.get();
+  }
+
+  return result;
+}
+
+
+Resources HierarchicalAllocatorProcess::quotaRoleAllocatedResources(
+    Sorter* quotaRoleSorter,
+    const string& role) const
+{
+  // Returns the __quantity__ of resources allocated to a quota role. Since we
+  // account for reservations and persistent volumes toward quota, we strip
+  // reservation and persistent volume related information for comparability.
+  // The result is used to determine whether a role's quota is satisfied, and
+  // also to determine how many resources the role would need in order to meet
+  // its quota.
+  //
+  // NOTE: Revocable resources are excluded in `quotaRoleSorter`.
+  CHECK(quotas.contains(role));
+
+  // NOTE: `allocationScalarQuantities` omits dynamic reservation
+  // and persistent volume info, but we additionally strip `role`
+  // here via `flatten()`.
+  return quotaRoleSorter->allocationScalarQuantities(role).flatten();
+}
+
+
+Resources HierarchicalAllocatorProcess::quotaRoleUnallocatedResources(
+    Sorter* quotaRoleSorter,
+    const string& role) const
+{
+  CHECK(quotas.contains(role));
+
+  // NOTE: Only scalars are considered for quota.
+  return quotas.at(role).info.guarantee() -
+    quotaRoleAllocatedResources(quotaRoleSorter, role);
+}
+
+
+void HierarchicalAllocatorProcess::quotaRoleAllocated(
+    const string& role,
+    const SlaveID& slaveId,
+    const Resources& resources)
+{
+  unallocatedQuota -=
+    quotaRoleUnallocatedResources(quotaRoleSorter.get(), role);
+  quotaRoleSorter->allocated(role, slaveId, resources);
+  unallocatedQuota +=
+    quotaRoleUnallocatedResources(quotaRoleSorter.get(), role);
+}
+
+
+void HierarchicalAllocatorProcess::quotaRoleUnallocated(
+    const string& role,
+    const SlaveID& slaveId,
+    const Resources& resources)
+{
+  unallocatedQuota -=
+    quotaRoleUnallocatedResources(quotaRoleSorter.get(), role);
+  quotaRoleSorter->unallocated(role, slaveId, resources);
+  unallocatedQuota +=
+    quotaRoleUnallocatedResources(quotaRoleSorter.get(), role);
+}
+
+
+void HierarchicalAllocatorProcess::quotaRoleUpdated(
+    const string& role,
+    const SlaveID& slaveId,
+    const Resources& oldAllocation,
+    const Resources& newAllocation)
+{
+  unallocatedQuota -=
+    quotaRoleUnallocatedResources(quotaRoleSorter.get(), role);
+  quotaRoleSorter->update(role, slaveId, oldAllocation, newAllocation);
+  unallocatedQuota +=
+    quotaRoleUnallocatedResources(quotaRoleSorter.get(), role);
+}
+
+
+Resources HierarchicalAllocatorProcess::remainingClusterResources(
+    const AllocationSorters& sorters) const
+{
+  // Calculate the total quantity of scalar resources (including revocable
+  // and reserved) that are available for allocation in the next round. We
+  // need this in order to ensure we do not over-allocate resources during
+  // the second stage.
+  //
+  // For performance reasons (MESOS-4833), this omits information about
+  // dynamic reservations or persistent volumes in the resources.
+  //
+  // NOTE: We use total cluster resources, and not just those based on the
+  // agents participating in the current allocation (i.e. provided as an
+  // argument to the `allocate()` call) so that frameworks in roles without
+  // quota are not unnecessarily deprived of resources.
+  //
+  // NOTE: Both the allocated quantities and the unallocated quota are
+  // maintained incrementally, so this does not iterate over roles.
+  Resources remainingClusterResources =
+    sorters.roleSorter->totalScalarQuantities() -
+    sorters.roleSorter->allocationScalarQuantities();
+
+  // Determine how many resources we may allocate during the next stage.
+  //
+  // NOTE: Resources for quota allocations are already accounted in
+  // `remainingClusterResources`.
+  remainingClusterResources -= sorters.unallocatedQuota;
+
+  // Shared resources are excluded in determination of over-allocation of
+  // available resources since shared resources are always allocatable.
+  return remainingClusterResources.nonShared();
+}
+
+
+Sorter* HierarchicalAllocatorProcess::snapshot(
+    Sorter* sorter,
+    const std::function<Sorter*()>& factory,
+    const lambda::function<double(const string&)>& weight) const
+{
+  // NOTE: Sorters only expose aggregate quantities, hence the snapshot
+  // tracks the total and the allocations under a single pseudo agent.
+  // This is sufficient for sorting, which only depends on quantities.
+  // A hierarchical sorter aggregates the allocations of the subtrees
+  // of nested clients itself, so the client's own allocations are
+  // copied.
+  const SlaveID slaveId;
+
+  Sorter* snapshot = factory();
+  snapshot->initialize(fairnessExcludeResourceNames);
+  snapshot->add(slaveId, sorter->totalScalarQuantities());
+
+  foreach (const string& client, sorter->sort()) {
+    snapshot->add(client, weight(client));
+    snapshot->allocated(
+        client, slaveId, sorter->allocationScalarQuantities(client));
   }
+
+  return snapshot;
 }
 
 
-void HierarchicalAllocatorProcess::deallocate()
+void HierarchicalAllocatorProcess::deallocate(
+    const hashset<SlaveID>& slaveIds_)
 {
   // If no frameworks are currently registered, no work to do.
   if (activeRoles.empty()) {
@@ -1768,61 +2385,85 @@ void HierarchicalAllocatorProcess::deallocate()
   // regular offers. If we didn't keep track of outstanding offers then we would
   // keep generating new inverse offers even though the framework had not
   // responded yet.
+  //
+  // Only the agents that are both in `slaveIds_` and inverse offer
+  // candidates are considered. Once an agent has been looked at,
+  // every framework with resources on it either has an outstanding
+  // inverse offer or filters them, so the agent is no longer an
+  // inverse offer candidate until one of these changes.
+  vector<SlaveID> slaveIds;
 
-  foreachvalue (const Owned<Sorter>& frameworkSorter, frameworkSorters) {
-    foreach (const SlaveID& slaveId, allocationCandidates) {
-      CHECK(slaves.contains(slaveId));
+  if (inverseOfferCandidates.size() < slaveIds_.size()) {
+    foreach (const SlaveID& slaveId, inverseOfferCandidates) {
+      if (slaveIds_.contains(slaveId)) {
+        slaveIds.push_back(slaveId);
+      }
+    }
+  } else {
+    foreach (const SlaveID& slaveId, slaveIds_) {
+      if (inverseOfferCandidates.contains(slaveId)) {
+        slaveIds.push_back(slaveId);
+      }
+    }
+  }
 
-      Slave& slave = slaves.at(slaveId);
+  foreach (const SlaveID& slaveId, slaveIds) {
+    CHECK(slaves.contains(slaveId));
 
-      if (slave.maintenance.isSome()) {
-        // We use a reference by alias because we intend to modify the
-        // `maintenance` and to improve readability.
-        Slave::Maintenance& maintenance = slave.maintenance.get();
+    Slave& slave = slaves.at(slaveId);
+    CHECK_SOME(slave.maintenance);
 
-        hashmap<string, Resources> allocation =
-          frameworkSorter->allocation(slaveId);
+    // We use a reference by alias because we intend to modify the
+    // `maintenance` and to improve readability.
+    Slave::Maintenance& maintenance = slave.maintenance.get();
 
-        foreachkey (const string& frameworkId_, allocation) {
-          FrameworkID frameworkId;
-          frameworkId.set_value(frameworkId_);
+    // The roles with resources on the agent, whose framework sorters
+    // tell us which frameworks have resources on the agent.
+    hashmap<string, Resources> roles = roleSorter->allocation(slaveId);
 
-          // If this framework doesn't already have inverse offers for the
-          // specified slave.
-          if (!offerable[frameworkId].contains(slaveId)) {
-            // If there isn't already an outstanding inverse offer to this
-            // framework for the specified slave.
-            if (!maintenance.offersOutstanding.contains(frameworkId)) {
-              // Ignore in case the framework filters inverse offers for this
-              // slave.
-              //
-              // NOTE: Since this specific allocator implementation only sends
-              // inverse offers for maintenance primitives, and those are at the
-              // whole slave level, we only need to filter based on the
-              // time-out.
-              if (isFiltered(frameworkId, slaveId)) {
-                continue;
-              }
-
-              const UnavailableResources unavailableResources =
-                UnavailableResources{
-                    Resources(),
-                    maintenance.unavailability};
-
-              // For now we send inverse offers with empty resources when the
-              // inverse offer represents maintenance on the machine. In the
-              // future we could be more specific about the resources on the
-              // host, as we have the information available.
-              offerable[frameworkId][slaveId] = unavailableResources;
-
-              // Mark this framework as having an offer outstanding for the
-              // specified slave.
-              maintenance.offersOutstanding.insert(frameworkId);
-            }
+    foreachkey (const string& role, roles) {
+      CHECK(frameworkSorters.contains(role));
+
+      hashmap<string, Resources> allocation =
+        frameworkSorters.at(role)->allocation(slaveId);
+
+      foreachkey (const string& frameworkId_, allocation) {
+        FrameworkID frameworkId;
+        frameworkId.set_value(frameworkId_);
+
+        // If there isn't already an outstanding inverse offer to this
+        // framework for the specified slave.
+        if (!maintenance.offersOutstanding.contains(frameworkId)) {
+          // Ignore in case the framework filters inverse offers for this
+          // slave.
+          //
+          // NOTE: Since this specific allocator implementation only sends
+          // inverse offers for maintenance primitives, and those are at the
+          // whole slave level, we only need to filter based on the
+          // time-out.
+          if (isFiltered(frameworkId, slaveId)) {
+            continue;
           }
+
+          const UnavailableResources unavailableResources =
+            UnavailableResources{
+                Resources(),
+                maintenance.unavailability};
+
+          // For now we send inverse offers with empty resources when the
+          // inverse offer represents maintenance on the machine. In the
+          // future we could be more specific about the resources on the
+          // host, as we have the information available.
+          offerable[frameworkId][slaveId] = unavailableResources;
+
+          // Mark this framework as having an offer outstanding for the
+          // specified slave.
+          maintenance.offersOutstanding.insert(frameworkId);
         }
       }
     }
+
+    inverseOfferCandidates.erase(slaveId);
   }
 
   if (offerable.empty()) {
@@ -1836,48 +2477,51 @@ void HierarchicalAllocatorProcess::deallocate()
 }
 
 
-void HierarchicalAllocatorProcess::_expire(
-    const FrameworkID& frameworkId,
-    const SlaveID& slaveId,
-    OfferFilter* offerFilter)
+void HierarchicalAllocatorProcess::expireOfferFilters()
 {
-  // The filter might have already been removed (e.g., if the
-  // framework no longer exists or in `reviveOffers()`) but not
-  // yet deleted (to keep the address from getting reused
-  // possibly causing premature expiration).
-  //
-  // Since this is a performance-sensitive piece of code,
-  // we use find to avoid the doing any redundant lookups.
+  offerFilterTimer = None();
 
-  auto frameworkIterator = frameworks.find(frameworkId);
-  if (frameworkIterator != frameworks.end()) {
-    Framework& framework = frameworkIterator->second;
+  dispatch(self(), &Self::_expireOfferFilters);
+}
 
-    auto filters = framework.offerFilters.find(slaveId);
-    if (filters != framework.offerFilters.end()) {
-      filters->second.erase(offerFilter);
 
-      if (filters->second.empty()) {
-        framework.offerFilters.erase(slaveId);
+void HierarchicalAllocatorProcess::_expireOfferFilters()
+{
+  hashset<SlaveID> slaveIds = offerFilters.expire(Clock::now());
+
+  if (allocationSweepInterval.isSome()) {
+    foreach (const SlaveID& slaveId, slaveIds) {
+      if (slaves.contains(slaveId)) {
+        dirtySlaves.insert(slaveId);
       }
     }
   }
 
-  delete offerFilter;
+  scheduleOfferFilterExpiry();
 }
 
 
-void HierarchicalAllocatorProcess::expire(
-    const FrameworkID& frameworkId,
-    const SlaveID& slaveId,
-    OfferFilter* offerFilter)
+void HierarchicalAllocatorProcess::scheduleOfferFilterExpiry()
 {
-  dispatch(
+  Option<process::Time> deadline = offerFilters.deadline();
+
+  if (deadline.isNone()) {
+    return;
+  }
+
+  // Only reschedule if the pending timer fires too late.
+  if (offerFilterTimer.isSome()) {
+    if (offerFilterTimer->timeout().time() <= deadline.get()) {
+      return;
+    }
+
+    Clock::cancel(offerFilterTimer.get());
+  }
+
+  offerFilterTimer = delay(
+      std::max(Duration::zero(), deadline.get() - Clock::now()),
       self(),
-      &Self::_expire,
-      frameworkId,
-      slaveId,
-      offerFilter);
+      &Self::expireOfferFilters);
 }
 
 
@@ -1907,12 +2551,37 @@ void HierarchicalAllocatorProcess::expire(
         framework.inverseOfferFilters.erase(slaveId);
       }
     }
+
+    if (allocationSweepInterval.isSome() && slaves.contains(slaveId)) {
+      dirtySlaves.insert(slaveId);
+    }
+
+    if (slaves.contains(slaveId) && slaves.at(slaveId).maintenance.isSome()) {
+      inverseOfferCandidates.insert(slaveId);
+    }
   }
 
   delete inverseOfferFilter;
 }
 
 
+void HierarchicalAllocatorProcess::removeInverseOfferFilters(
+    const FrameworkID& frameworkId)
+{
+  CHECK(frameworks.contains(frameworkId));
+
+  Framework& framework = frameworks.at(frameworkId);
+
+  foreachkey (const SlaveID& slaveId, framework.inverseOfferFilters) {
+    if (slaves.contains(slaveId) && slaves.at(slaveId).maintenance.isSome()) {
+      inverseOfferCandidates.insert(slaveId);
+    }
+  }
+
+  framework.inverseOfferFilters.clear();
+}
+
+
 double HierarchicalAllocatorProcess::roleWeight(const string& name) const
 {
   if (weights.contains(name)) {
@@ -1942,18 +2611,12 @@ bool HierarchicalAllocatorProcess::isFiltered(
   CHECK(frameworks.contains(frameworkId));
   CHECK(slaves.contains(slaveId));
 
-  const Framework& framework = frameworks.at(frameworkId);
-
-  if (framework.offerFilters.contains(slaveId)) {
-    foreach (OfferFilter* offerFilter, framework.offerFilters.at(slaveId)) {
-      if (offerFilter->filter(resources)) {
-        VLOG(1) << "Filtered offer with " << resources
-                << " on agent " << slaveId
-                << " for framework " << frameworkId;
+  if (offerFilters.filtered(frameworkId, slaveId, resources)) {
+    VLOG(1) << "Filtered offer with " << resources
+            << " on agent " << slaveId
+            << " for framework " << frameworkId;
 
-        return true;
-      }
-    }
+    return true;
   }
 
   return false;
@@ -2003,7 +2666,7 @@ double HierarchicalAllocatorProcess::_resources_offered_or_allocated(
 
   foreachvalue (const Slave& slave, slaves) {
     Option<Value::Scalar> value =
-      slave.allocated.get<Value::Scalar>(resource);
+      slave.getAllocated().get<Value::Scalar>(resource);
 
     if (value.isSome()) {
       offered_or_allocated += value->value();
@@ -2040,19 +2703,7 @@ double HierarchicalAllocatorProcess::_quota_allocated(
 double HierarchicalAllocatorProcess::_offer_filters_active(
     const string& role)
 {
-  double result = 0;
-
-  foreachvalue (const Framework& framework, frameworks) {
-    if (framework.role != role) {
-      continue;
-    }
-
-    foreachkey (const SlaveID& slaveId, framework.offerFilters) {
-      result += framework.offerFilters.at(slaveId).size();
-    }
-  }
-
-  return result;
+  return static_cast<double>(offerFilters.count(role));
 }
 
 } // namespace internal {
@@ -19,12 +19,16 @@
 
 #include <set>
 #include <string>
+#include <vector>
 
 #include <mesos/mesos.hpp>
 
 #include <process/future.hpp>
 #include <process/id.hpp>
 #include <process/owned.hpp>
+#include <process/time.hpp>
+#include <process/timeout.hpp>
+#include <process/timer.hpp>
 
 #include <stout/duration.hpp>
 #include <stout/hashmap.hpp>
@@ -34,9 +38,14 @@
 
 #include "common/protobuf_utils.hpp"
 
+#include "master/allocator/interner.hpp"
+
+#include "master/allocator/mesos/agent_ordering.hpp"
 #include "master/allocator/mesos/allocator.hpp"
 #include "master/allocator/mesos/metrics.hpp"
+#include "master/allocator/mesos/offer_filters.hpp"
 
+#include "master/allocator/sorter/drf/hierarchical.hpp"
 #include "master/allocator/sorter/drf/sorter.hpp"
 
 #include "master/constants.hpp"
@@ -47,14 +56,19 @@ namespace master {
 namespace allocator {
 
 // We forward declare the hierarchical allocator process so that we
-// can typedef an instantiation of it with DRF sorters.
+// can typedef an instantiation of it with DRF sorters. The roles are
+// sorted hierarchically, i.e., a role with nested roles (e.g., "a/b")
+// is sorted by the allocation of its whole subtree.
 template <
     typename RoleSorter,
     typename FrameworkSorter,
     typename QuotaRoleSorter>
 class HierarchicalAllocatorProcess;
 
-typedef HierarchicalAllocatorProcess<DRFSorter, DRFSorter, DRFSorter>
+typedef HierarchicalAllocatorProcess<
+    HierarchicalDRFSorter,
+    DRFSorter,
+    DRFSorter>
 HierarchicalDRFAllocatorProcess;
 
 typedef MesosAllocator<HierarchicalDRFAllocatorProcess>
@@ -64,7 +78,6 @@ HierarchicalDRFAllocator;
 namespace internal {
 
 // Forward declarations.
-class OfferFilter;
 class InverseOfferFilter;
 
 
@@ -76,13 +89,16 @@ public:
   HierarchicalAllocatorProcess(
       const std::function<Sorter*()>& roleSorterFactory,
       const std::function<Sorter*()>& _frameworkSorterFactory,
-      const std::function<Sorter*()>& quotaRoleSorterFactory)
+      const std::function<Sorter*()>& _quotaRoleSorterFactory,
+      const std::function<Sorter*()>& _roleSnapshotSorterFactory)
     : initialized(false),
       paused(true),
       metrics(*this),
       roleSorter(roleSorterFactory()),
-      quotaRoleSorter(quotaRoleSorterFactory()),
-      frameworkSorterFactory(_frameworkSorterFactory) {}
+      quotaRoleSorter(_quotaRoleSorterFactory()),
+      frameworkSorterFactory(_frameworkSorterFactory),
+      quotaRoleSorterFactory(_quotaRoleSorterFactory),
+      roleSnapshotSorterFactory(_roleSnapshotSorterFactory) {}
 
   virtual ~HierarchicalAllocatorProcess() {}
 
@@ -102,7 +118,9 @@ public:
         inverseOfferCallback,
       const hashmap<std::string, double>& weights,
       const Option<std::set<std::string>>&
-        fairnessExcludeResourceNames = None());
+        fairnessExcludeResourceNames = None(),
+      const mesos::allocator::Options& options =
+        mesos::allocator::Options());
 
   void recover(
       const int _expectedAgentCount,
@@ -186,6 +204,11 @@ public:
       const Resources& resources,
       const Option<Filters>& filters);
 
+  void recoverResourcesOnAgents(
+      const FrameworkID& frameworkId,
+      const hashmap<SlaveID, Resources>& resources,
+      const Option<Filters>& filters);
+
   void suppressOffers(
       const FrameworkID& frameworkId);
 
@@ -224,25 +247,141 @@ protected:
   // is deferred and batched with other allocation requests.
   process::Future<Nothing> allocate(const hashset<SlaveID>& slaveIds);
 
+  // Allocate resources from all known agents to the specified roles
+  // only. This is used for events that only affect these roles when
+  // allocation is event driven (see `allocationSweepInterval`);
+  // otherwise, this allocates to all roles like `allocate()`.
+  process::Future<Nothing> allocateRoles(const hashset<std::string>& roles);
+
   // Method that performs allocation work.
   Nothing _allocate();
 
   // Helper for `_allocate()` that allocates resources for offers.
   void __allocate();
 
-  // Helper for `_allocate()` that deallocates resources for inverse offers.
-  void deallocate();
+  // The sorters that an allocation pass reads and updates as it makes
+  // offers. These are either the allocator's own sorters, or snapshots
+  // of them when allocating in partitions (see `allocationPartitions`).
+  struct AllocationSorters
+  {
+    Sorter* roleSorter;
+    Sorter* quotaRoleSorter;
+
+    // The framework sorter of each role, indexed by role handle (see
+    // `roleNames`), or null for roles without a framework sorter.
+    std::vector<Sorter*> frameworkSorters;
 
-  // Remove an offer filter for the specified framework.
-  void expire(
-      const FrameworkID& frameworkId,
+    // The quantity of the quota guarantees that is not allocated
+    // according to `quotaRoleSorter` (see `unallocatedQuota`). This is
+    // kept up to date as the first stage allocates to quota roles.
+    Resources unallocatedQuota;
+  };
+
+  // Returns the framework sorters for an allocation pass over the
+  // allocator's own sorters, indexed by role handle.
+  std::vector<Sorter*> allocationFrameworkSorters() const;
+
+  // Resources offered to a framework on an agent by an allocation pass.
+  struct OfferCandidate
+  {
+    FrameworkID frameworkId;
+    SlaveID slaveId;
+    std::string role;
+    Resources resources;
+
+    // Whether the resources were allocated as part of the role's quota
+    // (i.e., during the first stage of the allocation).
+    bool quota;
+  };
+
+  // The time spent in the parts of an allocation pass, and the number
+  // of sorter clients (roles and frameworks) the pass visited. These
+  // are exported through the allocation run metrics (see `Metrics`).
+  struct AllocationStats
+  {
+    // The time spent in each stage of the pass, including the time
+    // spent sorting and evaluating filters during the stage.
+    Duration quotaStage;
+    Duration fairShareStage;
+
+    Duration sort;
+    Duration filters;
+
+    size_t sorterClientsVisited = 0;
+  };
+
+  // Runs both stages of the allocation algorithm over the given agents
+  // and returns the offers made, in the order they were made. As offers
+  // are made, `sorters` are updated to reflect them, and `stats` is
+  // updated with the time spent in the pass.
+  //
+  // NOTE: No allocator state other than `sorters` is modified, so that
+  // multiple passes operating on disjoint agents and distinct sorters
+  // can run concurrently. It is the caller's responsibility to apply
+  // the returned offers to `Slave::allocated`.
+  std::vector<OfferCandidate> computeOffers(
+      const std::vector<SlaveID>& slaveIds,
+      AllocationSorters& sorters,
+      AllocationStats& stats) const;
+
+  // Returns the quantity of resources allocated to a quota role
+  // according to the given quota role sorter.
+  Resources quotaRoleAllocatedResources(
+      Sorter* quotaRoleSorter,
+      const std::string& role) const;
+
+  // Returns the quantity of the quota guarantee of a quota role that
+  // is not allocated according to the given quota role sorter.
+  Resources quotaRoleUnallocatedResources(
+      Sorter* quotaRoleSorter,
+      const std::string& role) const;
+
+  // Update the allocation of a quota role in `quotaRoleSorter`, keeping
+  // `unallocatedQuota` up to date.
+  void quotaRoleAllocated(
+      const std::string& role,
       const SlaveID& slaveId,
-      OfferFilter* offerFilter);
+      const Resources& resources);
 
-  void _expire(
-      const FrameworkID& frameworkId,
+  void quotaRoleUnallocated(
+      const std::string& role,
+      const SlaveID& slaveId,
+      const Resources& resources);
+
+  void quotaRoleUpdated(
+      const std::string& role,
       const SlaveID& slaveId,
-      OfferFilter* offerFilter);
+      const Resources& oldAllocation,
+      const Resources& newAllocation);
+
+  // Returns the total quantity of non-shared scalar resources that may
+  // be allocated during the second stage of the allocation, given that
+  // the first stage has been accounted for in `sorters`.
+  Resources remainingClusterResources(const AllocationSorters& sorters) const;
+
+  // Creates a sorter holding the active clients of `sorter` along with
+  // their weights and allocated quantities, for use by a partitioned
+  // allocation. The copy is created using `factory`, which must create
+  // sorters of the same type as `sorter` for the copy to sort the
+  // clients in the same order (e.g., nested roles by the allocations
+  // of their subtrees).
+  Sorter* snapshot(
+      Sorter* sorter,
+      const std::function<Sorter*()>& factory,
+      const lambda::function<double(const std::string&)>& weight) const;
+
+  // Helper for `_allocate()` and `batch()` that deallocates resources
+  // for inverse offers on those of `slaveIds` that are inverse offer
+  // candidates.
+  void deallocate(const hashset<SlaveID>& slaveIds);
+
+  // Remove the offer filters whose deadline has passed.
+  void expireOfferFilters();
+  void _expireOfferFilters();
+
+  // Ensures that `offerFilterTimer` fires at the earliest deadline of
+  // the offer filters, if any.
+  void scheduleOfferFilterExpiry();
 
   // Remove an inverse offer filter for the specified framework.
   void expire(
@@ -250,6 +389,11 @@ protected:
       const SlaveID& slaveId,
       InverseOfferFilter* inverseOfferFilter);
 
+  // Removes all inverse offer filters of the specified framework, and
+  // makes the agents under maintenance that they were filtering
+  // inverse offer candidates again.
+  void removeInverseOfferFilters(const FrameworkID& frameworkId);
+
   // Returns the weight of the specified role name.
   double roleWeight(const std::string& name) const;
 
@@ -279,6 +423,36 @@ protected:
 
   Duration allocationInterval;
 
+  // Handles for the roles known to the allocator, i.e., all roles that
+  // have had frameworks or quota. The allocation pass keeps its per
+  // role state in vectors indexed by these handles.
+  Interner<std::string> roleNames;
+
+  // Number of partitions the agents are split into during an allocation
+  // run. Offers for the agents in each partition are computed in
+  // parallel against a snapshot of the sorters, and then applied in a
+  // deterministic merge step. If none, all agents are allocated
+  // sequentially.
+  Option<size_t> allocationPartitions;
+
+  // If set, allocation is event driven: batch allocations only consider
+  // the agents in `dirtySlaves`, and all agents are only allocated once
+  // per sweep interval (see `nextSweep`).
+  Option<Duration> allocationSweepInterval;
+
+  // Expires when the next batch allocation should allocate all agents.
+  process::Timeout nextSweep;
+
+  // Agents whose resources may have become offerable since the last
+  // batch allocation, e.g., because resources were recovered on them
+  // or an offer filter for them expired. Only tracked when allocation
+  // is event driven.
+  hashset<SlaveID> dirtySlaves;
+
+  // The order in which agents are allocated, which is kept up to date
+  // as the total and allocated resources of agents change.
+  process::Owned<AgentOrdering> agentOrdering;
+
   lambda::function<
       void(const FrameworkID&,
            const hashmap<SlaveID, Resources>&)> offerCallback;
@@ -301,8 +475,8 @@ protected:
 
     protobuf::framework::Capabilities capabilities;
 
-    // Active offer and inverse offer filters for the framework.
-    hashmap<SlaveID, hashset<OfferFilter*>> offerFilters;
+    // Active inverse offer filters for the framework. Offer filters
+    // are kept in `HierarchicalAllocatorProcess::offerFilters`.
     hashmap<SlaveID, hashset<InverseOfferFilter*>> inverseOfferFilters;
   };
 
@@ -326,23 +500,45 @@ protected:
 
   hashmap<FrameworkID, Framework> frameworks;
 
-  struct Slave
+  // Active offer filters of all frameworks.
+  OfferFilters offerFilters;
+
+  // Timer for the earliest deadline in `offerFilters`, if any. A single
+  // timer is used for all offer filters.
+  Option<process::Timer> offerFilterTimer;
+
+  // Partitions of a set of non-shared resources by how they may be
+  // offered to a role, so that the resources offerable to a role can
+  // be assembled without filtering the whole set each time.
+  struct OfferableResources
+  {
+    OfferableResources() = default;
+
+    explicit OfferableResources(const Resources& resources);
+
+    // Returns the non-revocable resources reserved for `role`.
+    const Resources& reserved(const std::string& role) const;
+
+    // Non-revocable unreserved resources.
+    Resources unreserved;
+
+    // Non-revocable reserved resources, keyed by role.
+    hashmap<std::string, Resources> reservations;
+
+    // Revocable resources, whether reserved or not.
+    Resources revocable;
+  };
+
+  class Slave
   {
+  public:
+    Slave() : activated(false) {}
+
     // Total amount of regular *and* oversubscribed resources.
-    Resources total;
+    const Resources& getTotal() const { return total; }
 
     // Regular *and* oversubscribed resources that are allocated.
-    //
-    // NOTE: We maintain multiple copies of each shared resource allocated
-    // to a slave, where the number of copies represents the number of times
-    // this shared resource has been allocated to (and has not been recovered
-    // from) a specific framework.
-    //
-    // NOTE: We keep track of slave's allocated resources despite
-    // having that information in sorters. This is because the
-    // information in sorters is not accurate if some framework
-    // hasn't reregistered. See MESOS-2919 for details.
-    Resources allocated;
+    const Resources& getAllocated() const { return allocated; }
 
     // We track the total and allocated resources on the slave, the
     // available resources are computed as follows:
@@ -351,9 +547,43 @@ protected:
     //
     // Note that it's possible for the slave to be over-allocated!
     // In this case, allocated > total.
-    Resources available() const
+    const Resources& getAvailable() const { return available; }
+
+    // The non-shared available resources, partitioned by how they
+    // may be offered.
+    const OfferableResources& getOfferable() const { return offerable; }
+
+    // The shared resources on the agent, which are offerable even when
+    // they are in use.
+    const Resources& getShared() const { return shared; }
+
+    void updateTotal(const Resources& newTotal)
+    {
+      total = newTotal;
+      shared = total.shared();
+
+      updateAvailable();
+    }
+
+    void updateAllocated(const Resources& newAllocated)
+    {
+      allocated = newAllocated;
+
+      updateAvailable();
+    }
+
+    void allocate(const Resources& toAllocate)
+    {
+      allocated += toAllocate;
+
+      updateAvailable();
+    }
+
+    void unallocate(const Resources& toUnallocate)
     {
-      return total - allocated;
+      allocated -= toUnallocate;
+
+      updateAvailable();
     }
 
     bool activated;  // Whether to offer resources.
@@ -395,6 +625,33 @@ protected:
     // a given point in time, for an optional duration. This information is used
     // to send out `InverseOffers`.
     Option<Maintenance> maintenance;
+
+  private:
+    // The available resources and their partitions are recomputed
+    // whenever the total or allocated resources change, which is far
+    // less often than they are read during allocation.
+    void updateAvailable()
+    {
+      available = total - allocated;
+      offerable = OfferableResources(available.nonShared());
+    }
+
+    Resources total;
+
+    // NOTE: We maintain multiple copies of each shared resource allocated
+    // to a slave, where the number of copies represents the number of times
+    // this shared resource has been allocated to (and has not been recovered
+    // from) a specific framework.
+    //
+    // NOTE: We keep track of slave's allocated resources despite
+    // having that information in sorters. This is because the
+    // information in sorters is not accurate if some framework
+    // hasn't reregistered. See MESOS-2919 for details.
+    Resources allocated;
+
+    Resources available;
+    OfferableResources offerable;
+    Resources shared;
   };
 
   hashmap<SlaveID, Slave> slaves;
@@ -404,6 +661,21 @@ protected:
   // processed, the set of candidates is cleared.
   hashset<SlaveID> allocationCandidates;
 
+  // Agents scheduled for maintenance on which a framework may need an
+  // inverse offer, e.g., because the unavailability was just set, the
+  // framework was allocated resources on the agent, or an outstanding
+  // inverse offer or an inverse offer filter went away. Only these
+  // agents (among the allocation candidates) are considered when
+  // sending inverse offers, so that an allocation run does not need
+  // to look at every agent under maintenance.
+  hashset<SlaveID> inverseOfferCandidates;
+
+  // A set of roles that are kept as allocation candidates on all
+  // agents. Unlike for the agents in `allocationCandidates`, the
+  // resources of the other agents are only allocated to these roles.
+  // When an allocation is processed, the set of candidates is cleared.
+  hashset<std::string> allocationCandidateRoles;
+
   // Future for the dispatched allocation that becomes
   // ready after the allocation run is complete.
   Option<process::Future<Nothing>> allocation;
@@ -485,6 +757,17 @@ protected:
   // toward its quota, we choose to exclude them from the quota role sorter.
   process::Owned<Sorter> quotaRoleSorter;
 
+  // The sum over all quota roles of the quantity of their quota
+  // guarantee that is not allocated to them in `quotaRoleSorter`. This
+  // is maintained as quota role allocations change, so that the
+  // headroom to leave for quota can be determined without iterating
+  // over all quota roles in every allocation.
+  //
+  // NOTE: Frameworks in a quota'ed role may temporarily reject
+  // resources by filtering or suppressing offers, hence quotas may not
+  // be fully allocated.
+  Resources unallocatedQuota;
+
   // A collection of sorters, one per active role. Each sorter determines
   // the order in which frameworks that belong to the same role are allocated
   // resources inside the role's share. These sorters are used during Level 2
@@ -493,6 +776,12 @@ protected:
 
   // Factory function for framework sorters.
   const std::function<Sorter*()> frameworkSorterFactory;
+
+  // Factory functions for the snapshots of the quota role sorter and
+  // the role sorter (which, unlike the role sorter itself, do not
+  // expose metrics).
+  const std::function<Sorter*()> quotaRoleSorterFactory;
+  const std::function<Sorter*()> roleSnapshotSorterFactory;
 };
 
 
@@ -517,7 +806,8 @@ public:
             return new RoleSorter(this->self(), "allocator/mesos/roles/");
           },
           []() -> Sorter* { return new FrameworkSorter(); },
-          []() -> Sorter* { return new QuotaRoleSorter(); }) {}
+          []() -> Sorter* { return new QuotaRoleSorter(); },
+          []() -> Sorter* { return new RoleSorter(); }) {}
 };
 
 } // namespace allocator {
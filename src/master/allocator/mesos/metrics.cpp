@@ -27,6 +27,7 @@ using std::string;
 using std::vector;
 
 using process::metrics::Gauge;
+using process::metrics::PushGauge;
 
 namespace mesos {
 namespace internal {
@@ -45,12 +46,36 @@ Metrics::Metrics(const HierarchicalAllocatorProcess& _allocator)
         process::defer(
             allocator, &HierarchicalAllocatorProcess::_event_queue_dispatches)),
     allocation_runs("allocator/mesos/allocation_runs"),
-    allocation_run("allocator/mesos/allocation_run", Hours(1))
+    allocation_run("allocator/mesos/allocation_run", Hours(1)),
+    allocation_run_candidates(
+        "allocator/mesos/allocation_run/candidates", Hours(1)),
+    allocation_run_quota_stage(
+        "allocator/mesos/allocation_run/quota_stage", Hours(1)),
+    allocation_run_fair_share_stage(
+        "allocator/mesos/allocation_run/fair_share_stage", Hours(1)),
+    allocation_run_sort(
+        "allocator/mesos/allocation_run/sort", Hours(1)),
+    allocation_run_filters(
+        "allocator/mesos/allocation_run/filters", Hours(1)),
+    allocation_run_offer_callbacks(
+        "allocator/mesos/allocation_run/offer_callbacks", Hours(1)),
+    allocation_run_sorter_clients_visited(
+        "allocator/mesos/allocation_run/sorter_clients_visited"),
+    allocation_run_agents_skipped(
+        "allocator/mesos/allocation_run/agents_skipped")
 {
   process::metrics::add(event_queue_dispatches);
   process::metrics::add(event_queue_dispatches_);
   process::metrics::add(allocation_runs);
   process::metrics::add(allocation_run);
+  process::metrics::add(allocation_run_candidates);
+  process::metrics::add(allocation_run_quota_stage);
+  process::metrics::add(allocation_run_fair_share_stage);
+  process::metrics::add(allocation_run_sort);
+  process::metrics::add(allocation_run_filters);
+  process::metrics::add(allocation_run_offer_callbacks);
+  process::metrics::add(allocation_run_sorter_clients_visited);
+  process::metrics::add(allocation_run_agents_skipped);
 
   // Create and install gauges for the total and allocated
   // amount of standard scalar resources.
@@ -89,6 +114,14 @@ Metrics::~Metrics()
   process::metrics::remove(event_queue_dispatches_);
   process::metrics::remove(allocation_runs);
   process::metrics::remove(allocation_run);
+  process::metrics::remove(allocation_run_candidates);
+  process::metrics::remove(allocation_run_quota_stage);
+  process::metrics::remove(allocation_run_fair_share_stage);
+  process::metrics::remove(allocation_run_sort);
+  process::metrics::remove(allocation_run_filters);
+  process::metrics::remove(allocation_run_offer_callbacks);
+  process::metrics::remove(allocation_run_sorter_clients_visited);
+  process::metrics::remove(allocation_run_agents_skipped);
 
   foreach (const Gauge& gauge, resources_total) {
     process::metrics::remove(gauge);
@@ -105,7 +138,7 @@ Metrics::~Metrics()
   }
 
   foreachkey (const string& role, quota_guarantee) {
-    foreachvalue (const Gauge& gauge, quota_guarantee[role]) {
+    foreachvalue (const PushGauge& gauge, quota_guarantee[role]) {
       process::metrics::remove(gauge);
     }
   }
@@ -121,18 +154,17 @@ void Metrics::setQuota(const string& role, const Quota& quota)
   CHECK(!quota_allocated.contains(role));
 
   hashmap<string, Gauge> allocated;
-  hashmap<string, Gauge> guarantees;
+  hashmap<string, PushGauge> guarantees;
 
   foreach (const Resource& resource, quota.info.guarantee()) {
     CHECK_EQ(Value::SCALAR, resource.type());
-    double value = resource.scalar().value();
-
-    Gauge guarantee = Gauge(
+    PushGauge guarantee(
         "allocator/mesos/quota"
         "/roles/" + role +
         "/resources/" + resource.name() +
-        "/guarantee",
-        process::defer([value]() { return value; }));
+        "/guarantee");
+
+    guarantee = resource.scalar().value();
 
     Gauge offered_or_allocated(
         "allocator/mesos/quota"
@@ -22,6 +22,7 @@
 
 #include <process/metrics/counter.hpp>
 #include <process/metrics/gauge.hpp>
+#include <process/metrics/push_gauge.hpp>
 #include <process/metrics/timer.hpp>
 
 #include <process/pid.hpp>
@@ -67,6 +68,23 @@ struct Metrics
   // Latency of the allocation algorithm.
   process::metrics::Timer<Milliseconds> allocation_run;
 
+  // Time spent in each part of the allocation algorithm per run:
+  // selecting and ordering the candidate agents, the quota stage, and
+  // the fair share stage (which include the time spent sorting and
+  // evaluating offer filters), and invoking the offer callback.
+  process::metrics::Timer<Milliseconds> allocation_run_candidates;
+  process::metrics::Timer<Milliseconds> allocation_run_quota_stage;
+  process::metrics::Timer<Milliseconds> allocation_run_fair_share_stage;
+  process::metrics::Timer<Milliseconds> allocation_run_sort;
+  process::metrics::Timer<Milliseconds> allocation_run_filters;
+  process::metrics::Timer<Milliseconds> allocation_run_offer_callbacks;
+
+  // Number of roles and frameworks visited by the allocation algorithm,
+  // and number of candidate agents it skipped because they are not
+  // whitelisted, removed or deactivated.
+  process::metrics::Counter allocation_run_sorter_clients_visited;
+  process::metrics::Counter allocation_run_agents_skipped;
+
   // Gauges for the total amount of each resource in the cluster.
   std::vector<process::metrics::Gauge> resources_total;
 
@@ -77,8 +95,9 @@ struct Metrics
   hashmap<std::string, hashmap<std::string, process::metrics::Gauge>>
     quota_allocated;
 
-  // Gauges for the per-role quota guarantee for each resource.
-  hashmap<std::string, hashmap<std::string, process::metrics::Gauge>>
+  // Gauges for the per-role quota guarantee for each resource, which
+  // only change when the quota is updated.
+  hashmap<std::string, hashmap<std::string, process::metrics::PushGauge>>
     quota_guarantee;
 
   // Gauges for the per-role count of active offer filters.
@@ -0,0 +1,215 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "master/allocator/mesos/offer_filters.hpp"
+
+#include <algorithm>
+#include <string>
+
+#include <stout/check.hpp>
+#include <stout/foreach.hpp>
+
+using std::string;
+
+using process::Time;
+
+namespace mesos {
+namespace internal {
+namespace master {
+namespace allocator {
+namespace internal {
+
+static const size_t MASK_BITS = 64;
+
+
+static uint64_t bit(size_t handle)
+{
+  return uint64_t(1) << std::min(handle, MASK_BITS - 1);
+}
+
+
+void OfferFilters::add(
+    const string& role,
+    const FrameworkID& frameworkId,
+    const SlaveID& slaveId,
+    const Resources& resources,
+    const Time& deadline)
+{
+  const uint64_t id = nextId++;
+
+  Framework& framework = frameworks[frameworkId];
+  framework.role = role;
+
+  Filter filter;
+  filter.resources = resources;
+  filter.mask = mask(resources);
+  filter.deadline = deadlines.insert({deadline, {frameworkId, slaveId, id}});
+
+  framework.filters[slaveId][id] = filter;
+
+  counts[role]++;
+}
+
+
+void OfferFilters::remove(const FrameworkID& frameworkId)
+{
+  auto framework = frameworks.find(frameworkId);
+  if (framework == frameworks.end()) {
+    return;
+  }
+
+  size_t removed = 0;
+
+  foreachvalue (const Filters& filters, framework->second.filters) {
+    foreachvalue (const Filter& filter, filters) {
+      deadlines.erase(filter.deadline);
+      ++removed;
+    }
+  }
+
+  CHECK(counts.contains(framework->second.role));
+
+  size_t& count = counts.at(framework->second.role);
+  CHECK_GE(count, removed);
+
+  count -= removed;
+  if (count == 0) {
+    counts.erase(framework->second.role);
+  }
+
+  frameworks.erase(framework);
+}
+
+
+bool OfferFilters::filtered(
+    const FrameworkID& frameworkId,
+    const SlaveID& slaveId,
+    const Resources& resources) const
+{
+  auto framework = frameworks.find(frameworkId);
+  if (framework == frameworks.end()) {
+    return false;
+  }
+
+  auto filters = framework->second.filters.find(slaveId);
+  if (filters == framework->second.filters.end()) {
+    return false;
+  }
+
+  // NOTE: A resource name that has never been interned is not refused
+  // by any filter.
+  Mask required = 0;
+  foreach (const Resource& resource, resources) {
+    Option<Interner<string>::Handle> handle =
+      resourceNames.lookup(resource.name());
+
+    if (handle.isNone()) {
+      return false;
+    }
+
+    required |= bit(handle.get());
+  }
+
+  foreachvalue (const Filter& filter, filters->second) {
+    if ((required & ~filter.mask) != 0) {
+      continue;
+    }
+
+    // TODO(jieyu): Consider separating the superset check for regular
+    // and revocable resources. For example, frameworks might want
+    // more revocable resources only or non-revocable resources only,
+    // but currently the filter only expires if there is more of both
+    // revocable and non-revocable resources.
+    if (filter.resources.contains(resources)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
+hashset<SlaveID> OfferFilters::expire(const Time& now)
+{
+  hashset<SlaveID> slaveIds;
+
+  while (!deadlines.empty() && deadlines.begin()->first <= now) {
+    const Key key = deadlines.begin()->second;
+    deadlines.erase(deadlines.begin());
+
+    CHECK(frameworks.contains(key.frameworkId));
+    Framework& framework = frameworks.at(key.frameworkId);
+
+    CHECK(framework.filters.contains(key.slaveId));
+    Filters& filters = framework.filters.at(key.slaveId);
+
+    CHECK(filters.contains(key.id));
+    filters.erase(key.id);
+
+    if (filters.empty()) {
+      framework.filters.erase(key.slaveId);
+    }
+
+    const string role = framework.role;
+
+    if (framework.filters.empty()) {
+      frameworks.erase(key.frameworkId);
+    }
+
+    CHECK(counts.contains(role));
+    if (--counts.at(role) == 0) {
+      counts.erase(role);
+    }
+
+    slaveIds.insert(key.slaveId);
+  }
+
+  return slaveIds;
+}
+
+
+Option<Time> OfferFilters::deadline() const
+{
+  if (deadlines.empty()) {
+    return None();
+  }
+
+  return deadlines.begin()->first;
+}
+
+
+size_t OfferFilters::count(const string& role) const
+{
+  return counts.get(role).getOrElse(0);
+}
+
+
+OfferFilters::Mask OfferFilters::mask(const Resources& resources)
+{
+  Mask result = 0;
+
+  foreach (const Resource& resource, resources) {
+    result |= bit(resourceNames.intern(resource.name()));
+  }
+
+  return result;
+}
+
+} // namespace internal {
+} // namespace allocator {
+} // namespace master {
+} // namespace internal {
+} // namespace mesos {
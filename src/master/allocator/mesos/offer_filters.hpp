@@ -0,0 +1,139 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __MASTER_ALLOCATOR_MESOS_OFFER_FILTERS_HPP__
+#define __MASTER_ALLOCATOR_MESOS_OFFER_FILTERS_HPP__
+
+#include <stdint.h>
+
+#include <map>
+#include <string>
+
+#include <mesos/mesos.hpp>
+#include <mesos/resources.hpp>
+#include <mesos/type_utils.hpp>
+
+#include <process/time.hpp>
+
+#include <stout/hashmap.hpp>
+#include <stout/hashset.hpp>
+#include <stout/option.hpp>
+
+#include "master/allocator/interner.hpp"
+
+namespace mesos {
+namespace internal {
+namespace master {
+namespace allocator {
+namespace internal {
+
+// Index of the offer filters set by frameworks that refuse resources
+// on an agent, e.g., when declining an offer.
+//
+// Filters are indexed by framework and agent. Each filter carries a
+// bitmask of the resource names it refuses, so that most resources
+// which are not refused can be told apart without a `contains()` check.
+//
+// Rather than each filter owning a timer, the filters are also kept
+// ordered by deadline, so that the owner only needs a single timer for
+// the earliest deadline (see `deadline()` and `expire()`).
+class OfferFilters
+{
+public:
+  OfferFilters() : nextId(0) {}
+
+  // Adds a filter refusing `resources` on the agent to the framework,
+  // which is in `role`, until `deadline`.
+  void add(
+      const std::string& role,
+      const FrameworkID& frameworkId,
+      const SlaveID& slaveId,
+      const Resources& resources,
+      const process::Time& deadline);
+
+  // Removes all filters of the framework.
+  void remove(const FrameworkID& frameworkId);
+
+  // Returns true if a filter of the framework on the agent refuses
+  // all of `resources`.
+  bool filtered(
+      const FrameworkID& frameworkId,
+      const SlaveID& slaveId,
+      const Resources& resources) const;
+
+  // Removes the filters whose deadline is not after `now` and returns
+  // the agents they were set on.
+  hashset<SlaveID> expire(const process::Time& now);
+
+  // Returns the earliest deadline of any filter, if there are filters.
+  Option<process::Time> deadline() const;
+
+  // Returns the number of filters of the frameworks in `role`.
+  size_t count(const std::string& role) const;
+
+private:
+  // A bit per resource name; names with handles that do not fit share
+  // the last bit. A filter can only refuse resources whose mask is a
+  // subset of its own.
+  typedef uint64_t Mask;
+
+  Mask mask(const Resources& resources);
+
+  struct Key
+  {
+    FrameworkID frameworkId;
+    SlaveID slaveId;
+    uint64_t id;
+  };
+
+  typedef std::multimap<process::Time, Key> Deadlines;
+
+  struct Filter
+  {
+    Resources resources;
+    Mask mask;
+    Deadlines::iterator deadline;
+  };
+
+  typedef hashmap<uint64_t, Filter> Filters;
+
+  struct Framework
+  {
+    std::string role;
+    hashmap<SlaveID, Filters> filters;
+  };
+
+  hashmap<FrameworkID, Framework> frameworks;
+
+  // The filters of all frameworks, ordered by deadline.
+  Deadlines deadlines;
+
+  // Number of filters per role, for the `offer_filters/.../active`
+  // metrics.
+  hashmap<std::string, size_t> counts;
+
+  Interner<std::string> resourceNames;
+
+  uint64_t nextId;
+};
+
+} // namespace internal {
+} // namespace allocator {
+} // namespace master {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __MASTER_ALLOCATOR_MESOS_OFFER_FILTERS_HPP__
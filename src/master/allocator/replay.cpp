@@ -0,0 +1,928 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Replays an allocator trace, as recorded by the master with
+// `--allocator_trace`, against the hierarchical DRF allocator and
+// reports the duration of its allocation cycles, the offers that it
+// made, and how fairly it shared the cluster among the frameworks.
+//
+// The calls are replayed as fast as possible on a paused clock that
+// is advanced to the time of each call, so that the allocation cycles
+// (and the expiry of offer filters) happen at the same points of the
+// trace as they did in the master, regardless of how long the trace
+// spans.
+//
+// NOTE: The offers of the replayed allocator can differ from the
+// offers that the master's allocator made, e.g., due to the random
+// order in which agents are visited. Recorded calls that refer to
+// offered resources (i.e., recovering resources or updating an
+// allocation) are only replayed if the replayed allocator did
+// allocate these resources to the framework, and are counted as
+// diverged otherwise.
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <glog/logging.h>
+
+#include <mesos/allocator/allocator.hpp>
+
+#include <mesos/maintenance/maintenance.hpp>
+
+#include <mesos/quota/quota.hpp>
+
+#include <mesos/resources.hpp>
+
+#include <process/clock.hpp>
+#include <process/process.hpp>
+#include <process/time.hpp>
+
+#include <stout/duration.hpp>
+#include <stout/flags.hpp>
+#include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/hashset.hpp>
+#include <stout/option.hpp>
+#include <stout/os.hpp>
+#include <stout/protobuf.hpp>
+#include <stout/stopwatch.hpp>
+#include <stout/synchronized.hpp>
+#include <stout/try.hpp>
+
+#include <stout/os/close.hpp>
+#include <stout/os/open.hpp>
+
+#include "logging/flags.hpp"
+#include "logging/logging.hpp"
+
+#include "master/allocator/trace.pb.h"
+
+#include "master/allocator/mesos/hierarchical.hpp"
+
+using namespace mesos;
+using namespace mesos::internal;
+
+using mesos::allocator::Allocator;
+using mesos::allocator::InverseOfferStatus;
+
+using mesos::internal::master::allocator::HierarchicalDRFAllocator;
+
+using process::Clock;
+using process::Time;
+
+using std::cerr;
+using std::cout;
+using std::endl;
+using std::set;
+using std::string;
+using std::vector;
+
+
+class Flags : public virtual logging::Flags
+{
+public:
+  Flags()
+  {
+    add(&Flags::trace,
+        "trace",
+        "Path of the allocator trace to replay, as recorded by the\n"
+        "master with `--allocator_trace`.");
+
+    add(&Flags::offer_timeout,
+        "offer_timeout",
+        "Duration after which the resources that the replayed allocator\n"
+        "offered are recovered, unless the trace accepted or declined\n"
+        "them, like the master's `--offer_timeout`. Without a timeout,\n"
+        "resources whose offers diverged from the trace stay offered.");
+  }
+
+  Option<string> trace;
+  Option<Duration> offer_timeout;
+};
+
+
+// What the replayed allocator allocated to each framework, i.e., the
+// resources in outstanding offers and the resources in use.
+//
+// NOTE: The offer callback is invoked by the allocator's process
+// while the calls are being replayed, hence the mutex.
+struct Allocations
+{
+  Allocations() : offers(0) {}
+
+  void offer(
+      const FrameworkID& frameworkId,
+      const hashmap<SlaveID, Resources>& resources)
+  {
+    synchronized (mutex) {
+      const Time now = Clock::now();
+
+      foreachkey (const SlaveID& slaveId, resources) {
+        offered[frameworkId][slaveId] += resources.at(slaveId);
+        offerTimes[frameworkId][slaveId] = now;
+      }
+
+      offers += resources.size();
+    }
+  }
+
+  // Removes recovered resources of the framework on the agent,
+  // returning false if they were not allocated to the framework.
+  bool recover(
+      const FrameworkID& frameworkId,
+      const SlaveID& slaveId,
+      const Resources& resources)
+  {
+    synchronized (mutex) {
+      Resources& offered_ = offered[frameworkId][slaveId];
+      if (offered_.contains(resources)) {
+        offered_ -= resources;
+        return true;
+      }
+
+      Resources& used_ = used[frameworkId][slaveId];
+      if (used_.contains(resources)) {
+        used_ -= resources;
+        return true;
+      }
+
+      return false;
+    }
+  }
+
+  // Moves offered resources of the framework on the agent to the
+  // resources in use, after applying the operations to them. Returns
+  // false if the resources were not offered to the framework.
+  bool accept(
+      const FrameworkID& frameworkId,
+      const SlaveID& slaveId,
+      const Resources& resources,
+      const vector<Offer::Operation>& operations)
+  {
+    synchronized (mutex) {
+      Resources& offered_ = offered[frameworkId][slaveId];
+      if (!offered_.contains(resources)) {
+        return false;
+      }
+
+      Try<Resources> updated = resources.apply(operations);
+      if (updated.isError()) {
+        return false;
+      }
+
+      offered_ -= resources;
+      used[frameworkId][slaveId] += updated.get();
+
+      return true;
+    }
+  }
+
+  // Returns (and removes) the resources in offers that have been
+  // outstanding since before the given time.
+  hashmap<FrameworkID, hashmap<SlaveID, Resources>> expire(const Time& time)
+  {
+    hashmap<FrameworkID, hashmap<SlaveID, Resources>> expired;
+
+    synchronized (mutex) {
+      foreachkey (const FrameworkID& frameworkId, offerTimes) {
+        hashmap<SlaveID, Time>& times = offerTimes.at(frameworkId);
+
+        foreachkey (const SlaveID& slaveId, times) {
+          Resources& offered_ = offered[frameworkId][slaveId];
+          if (times.at(slaveId) <= time && !offered_.empty()) {
+            expired[frameworkId][slaveId] = offered_;
+            offered_ = Resources();
+          }
+        }
+      }
+    }
+
+    return expired;
+  }
+
+  void removeFramework(const FrameworkID& frameworkId)
+  {
+    synchronized (mutex) {
+      offered.erase(frameworkId);
+      offerTimes.erase(frameworkId);
+      used.erase(frameworkId);
+    }
+  }
+
+  void removeSlave(const SlaveID& slaveId)
+  {
+    synchronized (mutex) {
+      foreachkey (const FrameworkID& frameworkId, offered) {
+        offered.at(frameworkId).erase(slaveId);
+      }
+
+      foreachkey (const FrameworkID& frameworkId, offerTimes) {
+        offerTimes.at(frameworkId).erase(slaveId);
+      }
+
+      foreachkey (const FrameworkID& frameworkId, used) {
+        used.at(frameworkId).erase(slaveId);
+      }
+    }
+  }
+
+  void use(
+      const FrameworkID& frameworkId,
+      const SlaveID& slaveId,
+      const Resources& resources)
+  {
+    synchronized (mutex) {
+      used[frameworkId][slaveId] += resources;
+    }
+  }
+
+  // Returns the resources allocated to each framework in total.
+  hashmap<FrameworkID, Resources> totals()
+  {
+    hashmap<FrameworkID, Resources> result;
+
+    synchronized (mutex) {
+      foreachkey (const FrameworkID& frameworkId, offered) {
+        foreachvalue (const Resources& resources, offered.at(frameworkId)) {
+          result[frameworkId] += resources;
+        }
+      }
+
+      foreachkey (const FrameworkID& frameworkId, used) {
+        foreachvalue (const Resources& resources, used.at(frameworkId)) {
+          result[frameworkId] += resources;
+        }
+      }
+    }
+
+    return result;
+  }
+
+  size_t count()
+  {
+    synchronized (mutex) {
+      return offers;
+    }
+  }
+
+private:
+  std::mutex mutex;
+
+  hashmap<FrameworkID, hashmap<SlaveID, Resources>> offered;
+  hashmap<FrameworkID, hashmap<SlaveID, Time>> offerTimes;
+  hashmap<FrameworkID, hashmap<SlaveID, Resources>> used;
+
+  // The number of offers made, i.e., of resources offered to a
+  // framework on an agent.
+  size_t offers;
+};
+
+
+// The measurements of the replay.
+struct Statistics
+{
+  Statistics()
+    : calls(0),
+      diverged(0),
+      expired(0),
+      fairness(0.0),
+      minShare(1.0),
+      maxShare(0.0) {}
+
+  size_t calls;
+  size_t diverged;
+  size_t expired;
+
+  // The duration and the number of offers of each allocation cycle.
+  vector<Duration> cycles;
+  vector<size_t> offers;
+
+  // The sum of Jain's fairness index of the dominant shares of the
+  // frameworks after each cycle, and the extremes of the dominant
+  // shares.
+  double fairness;
+  double minShare;
+  double maxShare;
+};
+
+
+// Returns the largest share of the cluster's resources that are
+// allocated to the framework, ignoring the excluded resources.
+static double dominantShare(
+    const Resources& allocated,
+    const Resources& total,
+    const set<string>& excluded)
+{
+  double share = 0.0;
+
+  foreach (const string& name, total.names()) {
+    if (excluded.count(name) > 0) {
+      continue;
+    }
+
+    Option<Value::Scalar> capacity = total.get<Value::Scalar>(name);
+    Option<Value::Scalar> allocation = allocated.get<Value::Scalar>(name);
+
+    if (capacity.isNone() || allocation.isNone() ||
+        capacity->value() <= 0.0) {
+      continue;
+    }
+
+    share = std::max(share, allocation->value() / capacity->value());
+  }
+
+  return share;
+}
+
+
+static Duration percentile(vector<Duration> durations, double p)
+{
+  if (durations.empty()) {
+    return Duration::zero();
+  }
+
+  std::sort(durations.begin(), durations.end());
+
+  size_t index = static_cast<size_t>(p * durations.size());
+  return durations[std::min(index, durations.size() - 1)];
+}
+
+
+class Replay
+{
+public:
+  Replay(Allocator* _allocator, const Flags& _flags)
+    : allocator(_allocator),
+      flags(_flags),
+      start(Clock::now()) {}
+
+  Try<Nothing> replay(const AllocatorCall& call);
+
+  // Runs the allocation cycles that are due before the given time.
+  void advance(const Time& time);
+
+  const Statistics& statistics() const { return statistics_; }
+
+  // The number of offers made, including the offers made between the
+  // cycles (e.g., when an agent was added).
+  size_t offers() { return allocations.count(); }
+
+private:
+  // Returns the (replayed) time of the recorded call.
+  Time time(const AllocatorCall& call) const
+  {
+    return start + Nanoseconds(call.nanoseconds() - origin.get());
+  }
+
+  void cycle();
+
+  Allocator* allocator;
+  const Flags& flags;
+
+  Allocations allocations;
+
+  // The time at which the replay started, which corresponds to the
+  // time of the first call of the trace (the origin).
+  const Time start;
+  Option<int64_t> origin;
+
+  Option<Duration> allocationInterval;
+  Option<Time> nextCycle;
+
+  set<string> excluded;
+
+  hashset<FrameworkID> frameworks;
+
+  // The non-revocable resources of each agent.
+  hashmap<SlaveID, Resources> agents;
+
+  Statistics statistics_;
+};
+
+
+Try<Nothing> Replay::replay(const AllocatorCall& call)
+{
+  if (origin.isNone()) {
+    if (call.type() != AllocatorCall::INITIALIZE) {
+      return Error("The trace does not start with the initialization");
+    }
+
+    origin = call.nanoseconds();
+  }
+
+  advance(time(call));
+
+  statistics_.calls++;
+
+  switch (call.type()) {
+    case AllocatorCall::INITIALIZE: {
+      const AllocatorCall::Initialize& initialize = call.initialize();
+
+      allocationInterval = Seconds(initialize.allocation_interval_seconds());
+      nextCycle = Clock::now() + allocationInterval.get();
+
+      hashmap<string, double> weights;
+      foreach (const WeightInfo& weight, initialize.weights()) {
+        weights[weight.role()] = weight.weight();
+      }
+
+      Option<set<string>> fairnessExcludeResourceNames;
+      if (initialize.fairness_excluded_resource_names_size() > 0) {
+        excluded = set<string>(
+            initialize.fairness_excluded_resource_names().begin(),
+            initialize.fairness_excluded_resource_names().end());
+
+        fairnessExcludeResourceNames = excluded;
+      }
+
+      mesos::allocator::Options options;
+
+      if (initialize.has_allocation_partitions()) {
+        options.allocationPartitions = initialize.allocation_partitions();
+      }
+
+      if (initialize.has_allocation_sweep_interval_seconds()) {
+        options.allocationSweepInterval =
+          Seconds(initialize.allocation_sweep_interval_seconds());
+      }
+
+      if (initialize.has_agent_ordering()) {
+        options.agentOrdering = initialize.agent_ordering();
+      }
+
+      Allocations* allocations_ = &allocations;
+
+      allocator->initialize(
+          allocationInterval.get(),
+          [allocations_](
+              const FrameworkID& frameworkId,
+              const hashmap<SlaveID, Resources>& resources) {
+            allocations_->offer(frameworkId, resources);
+          },
+          [](const FrameworkID&,
+             const hashmap<SlaveID, UnavailableResources>&) {},
+          weights,
+          fairnessExcludeResourceNames,
+          options);
+      break;
+    }
+
+    case AllocatorCall::RECOVER: {
+      hashmap<string, Quota> quotas;
+      foreach (const quota::QuotaInfo& info, call.quotas()) {
+        Quota quota;
+        quota.info = info;
+        quotas[info.role()] = quota;
+      }
+
+      allocator->recover(call.expected_agent_count(), quotas);
+      break;
+    }
+
+    case AllocatorCall::ADD_FRAMEWORK: {
+      hashmap<SlaveID, Resources> used;
+      foreach (const AllocatorCall::Allocation& allocation,
+               call.allocations()) {
+        used[allocation.slave_id()] += allocation.resources();
+        allocations.use(
+            call.framework_id(),
+            allocation.slave_id(),
+            allocation.resources());
+      }
+
+      frameworks.insert(call.framework_id());
+
+      allocator->addFramework(
+          call.framework_id(), call.framework_info(), used, call.active());
+      break;
+    }
+
+    case AllocatorCall::REMOVE_FRAMEWORK:
+      frameworks.erase(call.framework_id());
+      allocations.removeFramework(call.framework_id());
+      allocator->removeFramework(call.framework_id());
+      break;
+
+    case AllocatorCall::ACTIVATE_FRAMEWORK:
+      allocator->activateFramework(call.framework_id());
+      break;
+
+    case AllocatorCall::DEACTIVATE_FRAMEWORK:
+      allocator->deactivateFramework(call.framework_id());
+      break;
+
+    case AllocatorCall::UPDATE_FRAMEWORK:
+      allocator->updateFramework(call.framework_id(), call.framework_info());
+      break;
+
+    case AllocatorCall::ADD_SLAVE: {
+      Option<Unavailability> unavailability;
+      if (call.has_unavailability()) {
+        unavailability = call.unavailability();
+      }
+
+      hashmap<FrameworkID, Resources> used;
+      foreach (const AllocatorCall::Allocation& allocation,
+               call.allocations()) {
+        used[allocation.framework_id()] += allocation.resources();
+        allocations.use(
+            allocation.framework_id(),
+            call.slave_id(),
+            allocation.resources());
+      }
+
+      const Resources total = call.resources();
+      agents[call.slave_id()] = total.nonRevocable();
+
+      allocator->addSlave(
+          call.slave_id(), call.slave_info(), unavailability, total, used);
+      break;
+    }
+
+    case AllocatorCall::REMOVE_SLAVE:
+      agents.erase(call.slave_id());
+      allocations.removeSlave(call.slave_id());
+      allocator->removeSlave(call.slave_id());
+      break;
+
+    case AllocatorCall::UPDATE_SLAVE:
+      allocator->updateSlave(call.slave_id(), call.resources());
+      break;
+
+    case AllocatorCall::ACTIVATE_SLAVE:
+      allocator->activateSlave(call.slave_id());
+      break;
+
+    case AllocatorCall::DEACTIVATE_SLAVE:
+      allocator->deactivateSlave(call.slave_id());
+      break;
+
+    case AllocatorCall::UPDATE_WHITELIST: {
+      Option<hashset<string>> whitelist;
+      if (call.has_whitelist()) {
+        whitelist = hashset<string>();
+        foreach (const string& hostname, call.whitelist()) {
+          whitelist->insert(hostname);
+        }
+      }
+
+      allocator->updateWhitelist(whitelist);
+      break;
+    }
+
+    case AllocatorCall::REQUEST_RESOURCES:
+      allocator->requestResources(
+          call.framework_id(),
+          vector<Request>(call.requests().begin(), call.requests().end()));
+      break;
+
+    case AllocatorCall::UPDATE_ALLOCATION: {
+      const vector<Offer::Operation> operations(
+          call.operations().begin(), call.operations().end());
+
+      if (!allocations.accept(
+              call.framework_id(),
+              call.slave_id(),
+              call.resources(),
+              operations)) {
+        statistics_.diverged++;
+        break;
+      }
+
+      allocator->updateAllocation(
+          call.framework_id(), call.slave_id(), call.resources(), operations);
+      break;
+    }
+
+    case AllocatorCall::UPDATE_AVAILABLE:
+      // NOTE: This fails if the resources are no longer available,
+      // e.g., if they are offered by the replayed allocator but were
+      // not offered by the master's allocator.
+      allocator->updateAvailable(
+          call.slave_id(),
+          vector<Offer::Operation>(
+              call.operations().begin(), call.operations().end()));
+      break;
+
+    case AllocatorCall::UPDATE_UNAVAILABILITY: {
+      Option<Unavailability> unavailability;
+      if (call.has_unavailability()) {
+        unavailability = call.unavailability();
+      }
+
+      allocator->updateUnavailability(call.slave_id(), unavailability);
+      break;
+    }
+
+    case AllocatorCall::UPDATE_INVERSE_OFFER: {
+      Option<UnavailableResources> unavailableResources;
+      if (call.has_unavailability()) {
+        unavailableResources = UnavailableResources{
+          call.unavailable_resources(), call.unavailability()};
+      }
+
+      Option<InverseOfferStatus> status;
+      if (call.has_inverse_offer_status()) {
+        status = call.inverse_offer_status();
+      }
+
+      Option<Filters> filters;
+      if (call.has_filters()) {
+        filters = call.filters();
+      }
+
+      allocator->updateInverseOffer(
+          call.slave_id(),
+          call.framework_id(),
+          unavailableResources,
+          status,
+          filters);
+      break;
+    }
+
+    case AllocatorCall::RECOVER_RESOURCES: {
+      Option<Filters> filters;
+      if (call.has_filters()) {
+        filters = call.filters();
+      }
+
+      if (call.has_slave_id()) {
+        if (!allocations.recover(
+                call.framework_id(), call.slave_id(), call.resources())) {
+          statistics_.diverged++;
+          break;
+        }
+
+        allocator->recoverResources(
+            call.framework_id(), call.slave_id(), call.resources(), filters);
+        break;
+      }
+
+      hashmap<SlaveID, Resources> resources;
+      foreach (const AllocatorCall::Allocation& allocation,
+               call.allocations()) {
+        if (!allocations.recover(
+                call.framework_id(),
+                allocation.slave_id(),
+                allocation.resources())) {
+          statistics_.diverged++;
+          continue;
+        }
+
+        resources[allocation.slave_id()] += allocation.resources();
+      }
+
+      if (!resources.empty()) {
+        allocator->recoverResources(call.framework_id(), resources, filters);
+      }
+      break;
+    }
+
+    case AllocatorCall::SUPPRESS_OFFERS:
+      allocator->suppressOffers(call.framework_id());
+      break;
+
+    case AllocatorCall::REVIVE_OFFERS:
+      allocator->reviveOffers(call.framework_id());
+      break;
+
+    case AllocatorCall::SET_QUOTA: {
+      if (call.quotas_size() != 1) {
+        return Error("Expected a single quota to be set");
+      }
+
+      Quota quota;
+      quota.info = call.quotas(0);
+
+      allocator->setQuota(call.role(), quota);
+      break;
+    }
+
+    case AllocatorCall::REMOVE_QUOTA:
+      allocator->removeQuota(call.role());
+      break;
+
+    case AllocatorCall::UPDATE_WEIGHTS:
+      allocator->updateWeights(
+          vector<WeightInfo>(call.weights().begin(), call.weights().end()));
+      break;
+
+    case AllocatorCall::UNKNOWN:
+      return Error("Unknown allocator call");
+  }
+
+  return Nothing();
+}
+
+
+void Replay::advance(const Time& time)
+{
+  while (nextCycle.isSome() && nextCycle.get() <= time) {
+    cycle();
+    nextCycle = nextCycle.get() + allocationInterval.get();
+  }
+
+  Clock::update(time);
+}
+
+
+void Replay::cycle()
+{
+  if (flags.offer_timeout.isSome()) {
+    hashmap<FrameworkID, hashmap<SlaveID, Resources>> expired =
+      allocations.expire(nextCycle.get() - flags.offer_timeout.get());
+
+    foreachkey (const FrameworkID& frameworkId, expired) {
+      statistics_.expired += expired.at(frameworkId).size();
+      allocator->recoverResources(
+          frameworkId, expired.at(frameworkId), None());
+    }
+  }
+
+  // Let the allocator process the calls so far, so that only the
+  // allocation itself is measured.
+  Clock::settle();
+
+  const size_t offers = allocations.count();
+
+  Stopwatch stopwatch;
+  stopwatch.start();
+
+  Clock::update(nextCycle.get());
+  Clock::settle();
+
+  statistics_.cycles.push_back(stopwatch.elapsed());
+  statistics_.offers.push_back(allocations.count() - offers);
+
+  Resources total;
+  foreachvalue (const Resources& resources, agents) {
+    total += resources;
+  }
+
+  // Jain's fairness index of the dominant shares `x` of the `n`
+  // frameworks, i.e., `(sum x)^2 / (n * sum x^2)`, which is 1 if all
+  // frameworks have the same share and `1/n` if one has it all.
+  const hashmap<FrameworkID, Resources> allocated = allocations.totals();
+
+  double sum = 0.0;
+  double squares = 0.0;
+
+  foreach (const FrameworkID& frameworkId, frameworks) {
+    const double share = dominantShare(
+        allocated.get(frameworkId).getOrElse(Resources()).nonRevocable(),
+        total,
+        excluded);
+
+    sum += share;
+    squares += share * share;
+
+    statistics_.minShare = std::min(statistics_.minShare, share);
+    statistics_.maxShare = std::max(statistics_.maxShare, share);
+  }
+
+  statistics_.fairness +=
+    squares > 0.0 ? (sum * sum) / (frameworks.size() * squares) : 1.0;
+}
+
+
+int main(int argc, char** argv)
+{
+  GOOGLE_PROTOBUF_VERIFY_VERSION;
+
+  Flags flags;
+
+  Try<flags::Warnings> load = flags.load(None(), argc, argv);
+
+  if (load.isError()) {
+    cerr << flags.usage(load.error()) << endl;
+    return EXIT_FAILURE;
+  }
+
+  if (flags.help) {
+    cout << flags.usage() << endl;
+    return EXIT_SUCCESS;
+  }
+
+  if (flags.trace.isNone()) {
+    cerr << flags.usage("Missing required option --trace") << endl;
+    return EXIT_FAILURE;
+  }
+
+  logging::initialize(argv[0], flags);
+
+  // Log any flag warnings (after logging is initialized).
+  foreach (const flags::Warning& warning, load->warnings) {
+    LOG(WARNING) << warning.message;
+  }
+
+  Try<int> fd = os::open(flags.trace.get(), O_RDONLY | O_CLOEXEC);
+  if (fd.isError()) {
+    cerr << "Failed to open '" << flags.trace.get() << "': "
+         << fd.error() << endl;
+    return EXIT_FAILURE;
+  }
+
+  Try<Allocator*> allocator = HierarchicalDRFAllocator::create();
+  if (allocator.isError()) {
+    cerr << "Failed to create the allocator: " << allocator.error() << endl;
+    return EXIT_FAILURE;
+  }
+
+  Clock::pause();
+
+  Replay replay(allocator.get(), flags);
+
+  Stopwatch stopwatch;
+  stopwatch.start();
+
+  // NOTE: The last call may be partially written if the master did
+  // not exit cleanly.
+  ::protobuf::Reader<AllocatorCall> reader(fd.get(), true);
+
+  while (true) {
+    Result<AllocatorCall> call = reader.read();
+
+    if (call.isError()) {
+      cerr << "Failed to read the trace: " << call.error() << endl;
+      return EXIT_FAILURE;
+    }
+
+    if (call.isNone()) {
+      break;
+    }
+
+    Try<Nothing> replayed = replay.replay(call.get());
+    if (replayed.isError()) {
+      cerr << "Failed to replay "
+           << AllocatorCall::Type_Name(call->type())
+           << ": " << replayed.error() << endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  Clock::settle();
+
+  const Duration elapsed = stopwatch.elapsed();
+
+  os::close(fd.get());
+  delete allocator.get();
+
+  const Statistics& statistics = replay.statistics();
+
+  size_t offers = 0;
+  foreach (size_t offers_, statistics.offers) {
+    offers += offers_;
+  }
+
+  Duration total = Duration::zero();
+  Duration max = Duration::zero();
+  foreach (const Duration& cycle, statistics.cycles) {
+    total += cycle;
+    max = std::max(max, cycle);
+  }
+
+  const size_t cycles = statistics.cycles.size();
+
+  cout << "Replayed " << statistics.calls << " calls in " << elapsed << endl
+       << "Diverged calls: " << statistics.diverged << endl
+       << "Expired offers: " << statistics.expired << endl
+       << "Allocation cycles: " << cycles << endl
+       << "Offers: " << replay.offers() << endl;
+
+  if (cycles > 0) {
+    cout << "Cycle duration:"
+         << " mean " << total / cycles
+         << ", p50 " << percentile(statistics.cycles, 0.5)
+         << ", p90 " << percentile(statistics.cycles, 0.9)
+         << ", p99 " << percentile(statistics.cycles, 0.99)
+         << ", max " << max << endl
+         << "Offers per cycle: " << static_cast<double>(offers) / cycles
+         << endl
+         << "Fairness (Jain's index of dominant shares): "
+         << std::setprecision(4) << statistics.fairness / cycles << endl
+         << "Dominant shares: min " << statistics.minShare
+         << ", max " << statistics.maxShare << endl;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,566 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <mesos/mesos.hpp>
+#include <mesos/resources.hpp>
+
+#include <process/owned.hpp>
+#include <process/pid.hpp>
+
+#include <stout/check.hpp>
+#include <stout/foreach.hpp>
+#include <stout/option.hpp>
+#include <stout/strings.hpp>
+
+#include "master/allocator/sorter/drf/hierarchical.hpp"
+
+using std::set;
+using std::string;
+using std::vector;
+
+using process::Owned;
+using process::UPID;
+
+namespace mesos {
+namespace internal {
+namespace master {
+namespace allocator {
+
+// NOTE: This is not a valid role (see `roles::validate`).
+const char HierarchicalDRFSorter::SELF[] = ".";
+
+
+HierarchicalDRFSorter::HierarchicalDRFSorter()
+  : agents(std::make_shared<DRFSorter::Agents>()),
+    root("", "", nullptr)
+{
+  root.sorter.reset(new DRFSorter(agents));
+}
+
+
+HierarchicalDRFSorter::HierarchicalDRFSorter(
+    const UPID& allocator,
+    const string& metricsPrefix)
+  : agents(std::make_shared<DRFSorter::Agents>()),
+    root("", "", nullptr),
+    metrics(Metrics(
+        allocator,
+        [this](const string& name) {
+          // The client may have been removed if the dispatch
+          // occurs after the client is removed but before the
+          // metric is removed.
+          if (contains(name)) {
+            return calculateShare(name);
+          }
+
+          return 0.0;
+        },
+        metricsPrefix))
+{
+  root.sorter.reset(new DRFSorter(agents));
+}
+
+
+void HierarchicalDRFSorter::initialize(
+    const Option<set<string>>& _fairnessExcludeResourceNames)
+{
+  fairnessExcludeResourceNames = _fairnessExcludeResourceNames;
+
+  foreachSorter([this](Node* node) {
+    node->sorter->initialize(fairnessExcludeResourceNames);
+  });
+}
+
+
+void HierarchicalDRFSorter::add(const string& name, double weight)
+{
+  CHECK(!contains(name));
+
+  const vector<string> names = strings::tokenize(name, "/");
+  CHECK(!names.empty());
+
+  // Find or create the nodes along the path of the client. The weight
+  // of the client applies to its own node, while the nodes which are
+  // only ancestors of clients have the default weight.
+  Node* node = &root;
+
+  for (size_t i = 0; i < names.size(); i++) {
+    if (node->children.contains(names[i])) {
+      node = node->children.at(names[i]).get();
+    } else {
+      node = create(node, names[i], i == names.size() - 1 ? weight : 1.0);
+    }
+  }
+
+  CHECK(!node->client);
+
+  node->client = true;
+  node->active = true;
+
+  // If the node already has children, the client is the virtual child
+  // of the node, and its weight applies to the subtree.
+  if (node->sorter.get() != nullptr) {
+    node->sorter->add(SELF);
+    node->parent->sorter->update(node->name, weight);
+  }
+
+  dirty(node);
+
+  clients[name] = node;
+
+  if (metrics.isSome()) {
+    metrics->add(name);
+  }
+}
+
+
+void HierarchicalDRFSorter::update(const string& name, double weight)
+{
+  Node* node = find(name);
+
+  node->parent->sorter->update(node->name, weight);
+
+  dirty(node);
+}
+
+
+void HierarchicalDRFSorter::remove(const string& name)
+{
+  Node* node = find(name);
+
+  // Remove the allocation of the client from the subtrees of its
+  // ancestors. The client's own entry is removed below.
+  string entry;
+  DRFSorter* sorter = this->sorter(node, &entry);
+
+  const hashmap<SlaveID, Resources> allocation = sorter->allocation(entry);
+
+  Node* subtree = node->sorter.get() != nullptr ? node : node->parent;
+
+  for (Node* n = subtree; n->parent != nullptr; n = n->parent) {
+    foreachkey (const SlaveID& slaveId, allocation) {
+      n->parent->sorter->unallocated(n->name, slaveId, allocation.at(slaveId));
+    }
+  }
+
+  if (node->sorter.get() != nullptr) {
+    node->sorter->remove(SELF);
+
+    // The subtree stays, with the default weight.
+    node->parent->sorter->update(node->name, 1.0);
+  }
+
+  node->client = false;
+  node->active = true;
+
+  dirty(node);
+
+  clients.erase(name);
+
+  if (metrics.isSome()) {
+    metrics->remove(name);
+  }
+
+  if (node->children.empty()) {
+    prune(node);
+  }
+}
+
+
+void HierarchicalDRFSorter::activate(const string& name)
+{
+  Node* node = find(name);
+
+  node->active = true;
+
+  string entry;
+  sorter(node, &entry)->activate(entry);
+
+  dirty(node);
+}
+
+
+void HierarchicalDRFSorter::deactivate(const string& name)
+{
+  Node* node = find(name);
+
+  node->active = false;
+
+  string entry;
+  sorter(node, &entry)->deactivate(entry);
+
+  dirty(node);
+}
+
+
+void HierarchicalDRFSorter::allocated(
+    const string& name,
+    const SlaveID& slaveId,
+    const Resources& resources)
+{
+  Node* node = find(name);
+
+  foreachAllocation(node, [&](DRFSorter* sorter, const string& entry) {
+    sorter->allocated(entry, slaveId, resources);
+  });
+
+  dirty(node);
+}
+
+
+void HierarchicalDRFSorter::update(
+    const string& name,
+    const SlaveID& slaveId,
+    const Resources& oldAllocation,
+    const Resources& newAllocation)
+{
+  Node* node = find(name);
+
+  foreachAllocation(node, [&](DRFSorter* sorter, const string& entry) {
+    sorter->update(entry, slaveId, oldAllocation, newAllocation);
+  });
+
+  dirty(node);
+}
+
+
+void HierarchicalDRFSorter::unallocated(
+    const string& name,
+    const SlaveID& slaveId,
+    const Resources& resources)
+{
+  Node* node = find(name);
+
+  foreachAllocation(node, [&](DRFSorter* sorter, const string& entry) {
+    sorter->unallocated(entry, slaveId, resources);
+  });
+
+  dirty(node);
+}
+
+
+const hashmap<SlaveID, Resources>& HierarchicalDRFSorter::allocation(
+    const string& name)
+{
+  string entry;
+  DRFSorter* sorter = this->sorter(find(name), &entry);
+
+  return sorter->allocation(entry);
+}
+
+
+const Resources& HierarchicalDRFSorter::allocationScalarQuantities(
+    const string& name)
+{
+  string entry;
+  DRFSorter* sorter = this->sorter(find(name), &entry);
+
+  return sorter->allocationScalarQuantities(entry);
+}
+
+
+const Resources& HierarchicalDRFSorter::allocationScalarQuantities() const
+{
+  // The top-level subtrees hold the allocations of all clients.
+  return root.sorter->allocationScalarQuantities();
+}
+
+
+hashmap<string, Resources> HierarchicalDRFSorter::allocation(
+    const SlaveID& slaveId)
+{
+  hashmap<string, Resources> result;
+
+  foreachkey (const string& name, clients) {
+    Resources resources = allocation(name, slaveId);
+
+    if (!resources.empty()) {
+      result.emplace(name, resources);
+    }
+  }
+
+  return result;
+}
+
+
+Resources HierarchicalDRFSorter::allocation(
+    const string& name,
+    const SlaveID& slaveId)
+{
+  string entry;
+  DRFSorter* sorter = this->sorter(find(name), &entry);
+
+  return sorter->allocation(entry, slaveId);
+}
+
+
+const Resources& HierarchicalDRFSorter::totalScalarQuantities() const
+{
+  return root.sorter->totalScalarQuantities();
+}
+
+
+void HierarchicalDRFSorter::add(
+    const SlaveID& slaveId,
+    const Resources& resources)
+{
+  if (!resources.empty()) {
+    total[slaveId] += resources;
+
+    // The shares are relative to the total resources at every level,
+    // so all subtrees need to be re-sorted.
+    foreachSorter([&](Node* node) {
+      node->sorter->add(slaveId, resources);
+      node->dirty = true;
+    });
+  }
+}
+
+
+void HierarchicalDRFSorter::remove(
+    const SlaveID& slaveId,
+    const Resources& resources)
+{
+  if (!resources.empty()) {
+    CHECK(total.contains(slaveId));
+    CHECK(total.at(slaveId).contains(resources))
+      << total.at(slaveId) << " does not contain " << resources;
+
+    total.at(slaveId) -= resources;
+
+    if (total.at(slaveId).empty()) {
+      total.erase(slaveId);
+    }
+
+    foreachSorter([&](Node* node) {
+      node->sorter->remove(slaveId, resources);
+      node->dirty = true;
+    });
+  }
+}
+
+
+vector<string> HierarchicalDRFSorter::sort()
+{
+  return sort(&root);
+}
+
+
+bool HierarchicalDRFSorter::contains(const string& name) const
+{
+  return clients.contains(name);
+}
+
+
+int HierarchicalDRFSorter::count()
+{
+  return clients.size();
+}
+
+
+HierarchicalDRFSorter::Node* HierarchicalDRFSorter::find(
+    const string& name) const
+{
+  CHECK(contains(name)) << name;
+
+  return clients.at(name);
+}
+
+
+DRFSorter* HierarchicalDRFSorter::sorter(Node* node, string* name) const
+{
+  if (node->sorter.get() != nullptr) {
+    *name = SELF;
+    return node->sorter.get();
+  }
+
+  *name = node->name;
+  return node->parent->sorter.get();
+}
+
+
+HierarchicalDRFSorter::Node* HierarchicalDRFSorter::create(
+    Node* parent,
+    const string& name,
+    double weight)
+{
+  if (parent->sorter.get() == nullptr) {
+    Owned<DRFSorter> sorter(new DRFSorter(agents));
+    sorter->initialize(fairnessExcludeResourceNames);
+
+    foreachkey (const SlaveID& slaveId, total) {
+      sorter->add(slaveId, total.at(slaveId));
+    }
+
+    // A client without children so far becomes the virtual child of
+    // its node; its allocation is already aggregated in the sorter of
+    // the parent of its node.
+    if (parent->client) {
+      sorter->add(SELF);
+
+      const hashmap<SlaveID, Resources>& allocation =
+        parent->parent->sorter->allocation(parent->name);
+
+      foreachkey (const SlaveID& slaveId, allocation) {
+        sorter->allocated(SELF, slaveId, allocation.at(slaveId));
+      }
+
+      // The subtree needs to be sorted even if the client is inactive.
+      if (!parent->active) {
+        sorter->deactivate(SELF);
+        parent->parent->sorter->activate(parent->name);
+      }
+    }
+
+    parent->sorter = sorter;
+  }
+
+  Owned<Node> node(new Node(
+      parent == &root ? name : parent->path + "/" + name,
+      name,
+      parent));
+
+  parent->sorter->add(name, weight);
+  parent->children[name] = node;
+
+  dirty(parent);
+
+  return node.get();
+}
+
+
+void HierarchicalDRFSorter::prune(Node* node)
+{
+  while (node != &root && node->children.empty()) {
+    Node* parent = node->parent;
+
+    if (node->client) {
+      // The allocation of the client is already aggregated in the
+      // sorter of the parent, which is all that is needed without
+      // children.
+      if (node->sorter.get() != nullptr) {
+        node->sorter.reset();
+
+        if (!node->active) {
+          parent->sorter->deactivate(node->name);
+        }
+
+        dirty(parent);
+      }
+
+      return;
+    }
+
+    parent->sorter->remove(node->name);
+    parent->children.erase(node->name);
+
+    dirty(parent);
+
+    node = parent;
+  }
+}
+
+
+void HierarchicalDRFSorter::dirty(Node* node)
+{
+  for (; node != nullptr; node = node->parent) {
+    node->dirty = true;
+  }
+}
+
+
+template <typename F>
+void HierarchicalDRFSorter::foreachSorter(F f)
+{
+  vector<Node*> nodes(1, &root);
+
+  while (!nodes.empty()) {
+    Node* node = nodes.back();
+    nodes.pop_back();
+
+    if (node->sorter.get() == nullptr) {
+      continue;
+    }
+
+    f(node);
+
+    foreachvalue (const Owned<Node>& child, node->children) {
+      nodes.push_back(child.get());
+    }
+  }
+}
+
+
+template <typename F>
+void HierarchicalDRFSorter::foreachAllocation(Node* node, F f)
+{
+  if (node->sorter.get() != nullptr) {
+    f(node->sorter.get(), SELF);
+  }
+
+  for (Node* n = node; n->parent != nullptr; n = n->parent) {
+    f(n->parent->sorter.get(), n->name);
+  }
+}
+
+
+const vector<string>& HierarchicalDRFSorter::sort(Node* node)
+{
+  if (!node->dirty) {
+    return node->sorted;
+  }
+
+  node->sorted.clear();
+
+  foreach (const string& name, node->sorter->sort()) {
+    if (name == SELF) {
+      node->sorted.push_back(node->path);
+      continue;
+    }
+
+    Node* child = node->children.at(name).get();
+
+    if (child->sorter.get() == nullptr) {
+      node->sorted.push_back(child->path);
+    } else {
+      const vector<string>& sorted = sort(child);
+      node->sorted.insert(node->sorted.end(), sorted.begin(), sorted.end());
+    }
+  }
+
+  node->dirty = false;
+
+  return node->sorted;
+}
+
+
+double HierarchicalDRFSorter::calculateShare(const string& name) const
+{
+  Node* node = find(name);
+
+  return node->parent->sorter->calculateShare(node->name);
+}
+
+} // namespace allocator {
+} // namespace master {
+} // namespace internal {
+} // namespace mesos {
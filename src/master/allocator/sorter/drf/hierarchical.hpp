@@ -0,0 +1,224 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef __MASTER_ALLOCATOR_SORTER_DRF_HIERARCHICAL_HPP__
+#define __MASTER_ALLOCATOR_SORTER_DRF_HIERARCHICAL_HPP__
+
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <mesos/mesos.hpp>
+#include <mesos/resources.hpp>
+
+#include <process/owned.hpp>
+#include <process/pid.hpp>
+
+#include <stout/hashmap.hpp>
+#include <stout/option.hpp>
+
+#include "master/allocator/sorter/drf/metrics.hpp"
+#include "master/allocator/sorter/drf/sorter.hpp"
+
+#include "master/allocator/sorter/sorter.hpp"
+
+
+namespace mesos {
+namespace internal {
+namespace master {
+namespace allocator {
+
+// A sorter for hierarchical client names (e.g., the role
+// "eng/search/indexing"), which is a tree of `DRFSorter`s mirroring
+// the hierarchy: each node of the tree sorts its children by the
+// dominant shares of their subtrees, i.e., the allocations of all the
+// clients in a subtree are aggregated, and the clients are sorted
+// depth-first in the order of the nodes.
+//
+// The weight of a client applies to its subtree. A client that has
+// nested clients (e.g., "eng" and "eng/search") competes with them
+// for the allocation of its subtree as a virtual child with weight 1.
+//
+// The order of the clients in each subtree is cached, so that `sort()`
+// only re-sorts the subtrees in which an allocation (or weight, or
+// client) has changed. Changing the total resources changes all of
+// the shares though, so it re-sorts all subtrees.
+//
+// With flat client names, this sorts the clients like a `DRFSorter`.
+class HierarchicalDRFSorter : public Sorter
+{
+public:
+  HierarchicalDRFSorter();
+
+  explicit HierarchicalDRFSorter(
+      const process::UPID& allocator,
+      const std::string& metricsPrefix);
+
+  virtual ~HierarchicalDRFSorter() {}
+
+  virtual void initialize(
+      const Option<std::set<std::string>>& fairnessExcludeResourceNames);
+
+  virtual void add(const std::string& name, double weight = 1);
+
+  virtual void update(const std::string& name, double weight);
+
+  virtual void remove(const std::string& name);
+
+  virtual void activate(const std::string& name);
+
+  virtual void deactivate(const std::string& name);
+
+  virtual void allocated(
+      const std::string& name,
+      const SlaveID& slaveId,
+      const Resources& resources);
+
+  virtual void update(
+      const std::string& name,
+      const SlaveID& slaveId,
+      const Resources& oldAllocation,
+      const Resources& newAllocation);
+
+  virtual void unallocated(
+      const std::string& name,
+      const SlaveID& slaveId,
+      const Resources& resources);
+
+  virtual const hashmap<SlaveID, Resources>& allocation(
+      const std::string& name);
+
+  virtual const Resources& allocationScalarQuantities(const std::string& name);
+
+  virtual const Resources& allocationScalarQuantities() const;
+
+  virtual hashmap<std::string, Resources> allocation(const SlaveID& slaveId);
+
+  virtual Resources allocation(const std::string& name, const SlaveID& slaveId);
+
+  virtual const Resources& totalScalarQuantities() const;
+
+  virtual void add(const SlaveID& slaveId, const Resources& resources);
+
+  virtual void remove(const SlaveID& slaveId, const Resources& resources);
+
+  virtual std::vector<std::string> sort();
+
+  virtual bool contains(const std::string& name) const;
+
+  virtual int count();
+
+private:
+  HierarchicalDRFSorter(const HierarchicalDRFSorter&) = delete;
+  HierarchicalDRFSorter& operator=(const HierarchicalDRFSorter&) = delete;
+
+  struct Node
+  {
+    Node(const std::string& _path, const std::string& _name, Node* _parent)
+      : path(_path), name(_name), parent(_parent) {}
+
+    // The full name, e.g., "eng/search", and the name of the node in
+    // the sorter of its parent, e.g., "search".
+    const std::string path;
+    const std::string name;
+
+    // This is null for the root.
+    Node* const parent;
+
+    // Whether the node is a client rather than only an ancestor of
+    // clients, and if so whether the client is active.
+    bool client = false;
+    bool active = true;
+
+    // The sorter of the children of the node, which also contains the
+    // virtual child `SELF` if the node is a client. Only nodes with
+    // children (and the root) have a sorter: the allocation of a
+    // client without children is only kept in the sorter of its
+    // parent, so that flat client names cost the same as with a
+    // single `DRFSorter`.
+    process::Owned<DRFSorter> sorter;
+
+    hashmap<std::string, process::Owned<Node>> children;
+
+    // The clients of the subtree in sorted order, unless `dirty`.
+    // NOTE: A node is dirty whenever any of its children is.
+    std::vector<std::string> sorted;
+    bool dirty = true;
+  };
+
+  // The name of the virtual child of a node for its own client.
+  static const char SELF[];
+
+  // Returns the node of a client.
+  Node* find(const std::string& name) const;
+
+  // Returns the sorter and the name in it which hold the allocation
+  // of the client of the node.
+  DRFSorter* sorter(Node* node, std::string* name) const;
+
+  // Creates a child of a node, adding a sorter to the node if it did
+  // not have children yet.
+  Node* create(Node* parent, const std::string& name, double weight);
+
+  // Removes the sorter of a node which has no children anymore.
+  void prune(Node* node);
+
+  // Marks a node and its ancestors as dirty.
+  void dirty(Node* node);
+
+  // Calls `f` with each node which has a sorter, i.e., the root and
+  // the nodes with children.
+  template <typename F>
+  void foreachSorter(F f);
+
+  // Returns the (cached) sorted clients of the subtree of a node with
+  // a sorter.
+  const std::vector<std::string>& sort(Node* node);
+
+  // Calls `f` with the sorter and the name in it for each of the
+  // entries which (also) hold the allocation of the client of the
+  // node, i.e., for the node and each of its ancestors.
+  template <typename F>
+  void foreachAllocation(Node* node, F f);
+
+  // Returns the weighted dominant share of the subtree of a client.
+  double calculateShare(const std::string& name) const;
+
+  Option<std::set<std::string>> fairnessExcludeResourceNames;
+
+  // The handles of the agents, shared by the sorters of all nodes.
+  // NOTE: This must be declared before `root`, whose sorter uses it.
+  std::shared_ptr<DRFSorter::Agents> agents;
+
+  // The total resources, which are added to the sorter of each node.
+  hashmap<SlaveID, Resources> total;
+
+  Node root;
+
+  hashmap<std::string, Node*> clients;
+
+  // Metrics are optionally exposed by the sorter.
+  Option<Metrics> metrics;
+};
+
+} // namespace allocator {
+} // namespace master {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __MASTER_ALLOCATOR_SORTER_DRF_HIERARCHICAL_HPP__
@@ -23,8 +23,6 @@
 #include <stout/foreach.hpp>
 #include <stout/path.hpp>
 
-#include "master/allocator/sorter/drf/sorter.hpp"
-
 using std::string;
 
 using process::UPID;
@@ -39,10 +37,10 @@ namespace allocator {
 
 Metrics::Metrics(
     const UPID& _context,
-    DRFSorter& _sorter,
+    const lambda::function<double(const string&)>& _share,
     const string& _prefix)
   : context(_context),
-    sorter(&_sorter),
+    share(_share),
     prefix(_prefix) {}
 
 
@@ -60,16 +58,7 @@ void Metrics::add(const string& client)
 
   Gauge gauge(
       path::join(prefix, client, "/shares/", "/dominant"),
-      defer(context, [this, client]() {
-        // The client may have been removed if the dispatch
-        // occurs after the client is removed but before the
-        // metric is removed.
-        if (sorter->contains(client)) {
-          return sorter->calculateShare(client);
-        }
-
-        return 0.0;
-      }));
+      defer(context, [this, client]() { return share(client); }));
 
   dominantShares.put(client, gauge);
   process::metrics::add(gauge);
@@ -24,19 +24,20 @@
 #include <process/metrics/gauge.hpp>
 
 #include <stout/hashmap.hpp>
+#include <stout/lambda.hpp>
 
 namespace mesos {
 namespace internal {
 namespace master {
 namespace allocator {
 
-class DRFSorter;
-
 struct Metrics
 {
+  // The dominant share of a client is obtained through `share`, which
+  // must return 0 for clients that are not in the sorter (anymore).
   explicit Metrics(
       const process::UPID& context,
-      DRFSorter& sorter,
+      const lambda::function<double(const std::string&)>& share,
       const std::string& prefix);
 
   ~Metrics();
@@ -46,7 +47,7 @@ struct Metrics
 
   const process::UPID context;
 
-  DRFSorter* sorter;
+  const lambda::function<double(const std::string&)> share;
 
   const std::string prefix;
 
@@ -15,8 +15,10 @@
 // limitations under the License.
 
 #include <algorithm>
+#include <memory>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <mesos/mesos.hpp>
@@ -27,6 +29,7 @@
 
 #include <stout/check.hpp>
 #include <stout/foreach.hpp>
+#include <stout/none.hpp>
 #include <stout/option.hpp>
 
 #include "logging/logging.hpp"
@@ -34,6 +37,7 @@
 #include "master/allocator/sorter/drf/sorter.hpp"
 
 using std::set;
+using std::shared_ptr;
 using std::string;
 using std::vector;
 
@@ -59,13 +63,51 @@ bool DRFComparator::operator()(const Client& client1, const Client& client2)
 DRFSorter::DRFSorter(
     const UPID& allocator,
     const string& metricsPrefix)
-  : metrics(Metrics(allocator, *this, metricsPrefix)) {}
+  : metrics(Metrics(
+        allocator,
+        [this](const string& name) {
+          // The client may have been removed if the dispatch
+          // occurs after the client is removed but before the
+          // metric is removed.
+          if (contains(name)) {
+            return calculateShare(name);
+          }
+
+          return 0.0;
+        },
+        metricsPrefix)) {}
+
+
+DRFSorter::DRFSorter(const shared_ptr<Agents>& _agents)
+  : agents(_agents) {}
+
+
+DRFSorter::~DRFSorter()
+{
+  // Release the handles of the agents, which may outlive this sorter
+  // if they are shared.
+  foreachvalue (const Allocation& allocation, allocations) {
+    foreachkey (Agents::Handle handle, allocation.resources) {
+      agents->release(handle);
+    }
+  }
+
+  foreachkey (Agents::Handle handle, total_.resources) {
+    agents->release(handle);
+  }
+}
 
 
 void DRFSorter::initialize(
     const Option<set<string>>& _fairnessExcludeResourceNames)
 {
   fairnessExcludeResourceNames = _fairnessExcludeResourceNames;
+
+  for (size_t i = 0; i < resourceNames.size(); i++) {
+    fairnessExcluded[i] =
+      fairnessExcludeResourceNames.isSome() &&
+      fairnessExcludeResourceNames->count(resourceNames.value(i)) > 0;
+  }
 }
 
 
@@ -74,7 +116,7 @@ void DRFSorter::add(const string& name, double weight)
   CHECK(!contains(name));
 
   Client client(name, 0, 0);
-  clients.insert(client);
+  active[name] = clients.insert(client).first;
 
   allocations[name] = Allocation();
   weights[name] = weight;
@@ -90,12 +132,7 @@ void DRFSorter::update(const string& name, double weight)
   CHECK(weights.contains(name));
   weights[name] = weight;
 
-  // If the total resources have changed, we're going to
-  // recalculate all the shares, so don't bother just
-  // updating this client.
-  if (!dirty) {
-    update(name);
-  }
+  dirtyClients.insert(name);
 }
 
 
@@ -105,10 +142,27 @@ void DRFSorter::remove(const string& name)
 
   if (it != clients.end()) {
     clients.erase(it);
+    active.erase(name);
+  }
+
+  if (allocations.contains(name)) {
+    for (size_t i = 0; i < allocations.at(name).totals.size(); i++) {
+      total_.clients[i].erase(name);
+    }
+
+    CHECK(total_.allocatedScalarQuantities.contains(
+        allocations.at(name).scalarQuantities));
+
+    total_.allocatedScalarQuantities -= allocations.at(name).scalarQuantities;
+
+    foreachkey (Agents::Handle handle, allocations.at(name).resources) {
+      agents->release(handle);
+    }
   }
 
   allocations.erase(name);
   weights.erase(name);
+  dirtyClients.erase(name);
 
   if (metrics.isSome()) {
     metrics->remove(name);
@@ -123,7 +177,7 @@ void DRFSorter::activate(const string& name)
   set<Client, DRFComparator>::iterator it = find(name);
   if (it == clients.end()) {
     Client client(name, calculateShare(name), 0);
-    clients.insert(client);
+    active[name] = clients.insert(client).first;
   }
 }
 
@@ -138,6 +192,7 @@ void DRFSorter::deactivate(const string& name)
     // for this client which means the fairness can be gamed by a
     // framework disconnecting and reconnecting.
     clients.erase(it);
+    active.erase(name);
   }
 }
 
@@ -158,32 +213,39 @@ void DRFSorter::allocated(
 
     // Remove and reinsert it to update the ordering appropriately.
     clients.erase(it);
-    clients.insert(client);
+    active[name] = clients.insert(client).first;
   }
 
+  Allocation& allocation = allocations[name];
+  Resources& allocated = acquire(allocation.resources, slaveId);
+  allocation.view = None();
+
   // Add shared resources to the allocated quantities when the same
   // resources don't already exist in the allocation.
   const Resources newShared = resources.shared()
-    .filter([this, name, slaveId](const Resource& resource) {
-      return !allocations[name].resources[slaveId].contains(resource);
+    .filter([&allocated](const Resource& resource) {
+      return !allocated.contains(resource);
     });
 
   const Resources scalarQuantities =
     (resources.nonShared() + newShared).createStrippedScalarQuantity();
 
-  allocations[name].resources[slaveId] += resources;
-  allocations[name].scalarQuantities += scalarQuantities;
+  allocated += resources;
+  allocation.scalarQuantities += scalarQuantities;
+  total_.allocatedScalarQuantities += scalarQuantities;
 
   foreach (const Resource& resource, scalarQuantities) {
-    allocations[name].totals[resource.name()] += resource.scalar();
-  }
+    Interner<string>::Handle handle = intern(resource.name());
 
-  // If the total resources have changed, we're going to
-  // recalculate all the shares, so don't bother just
-  // updating this client.
-  if (!dirty) {
-    update(name);
+    if (allocation.totals.size() <= handle) {
+      allocation.totals.resize(handle + 1);
+    }
+
+    allocation.totals[handle] += resource.scalar();
+    total_.clients[handle].insert(name);
   }
+
+  dirtyClients.insert(name);
 }
 
 
@@ -205,25 +267,41 @@ void DRFSorter::update(
   const Resources newAllocationQuantity =
     newAllocation.createStrippedScalarQuantity();
 
-  CHECK(allocations[name].resources[slaveId].contains(oldAllocation));
-  CHECK(allocations[name].scalarQuantities.contains(oldAllocationQuantity));
+  Allocation& allocation = allocations[name];
+  Resources& allocated = acquire(allocation.resources, slaveId);
+  allocation.view = None();
+
+  CHECK(allocated.contains(oldAllocation));
+  CHECK(allocation.scalarQuantities.contains(oldAllocationQuantity));
+
+  allocated -= oldAllocation;
+  allocated += newAllocation;
 
-  allocations[name].resources[slaveId] -= oldAllocation;
-  allocations[name].resources[slaveId] += newAllocation;
+  allocation.scalarQuantities -= oldAllocationQuantity;
+  allocation.scalarQuantities += newAllocationQuantity;
 
-  allocations[name].scalarQuantities -= oldAllocationQuantity;
-  allocations[name].scalarQuantities += newAllocationQuantity;
+  total_.allocatedScalarQuantities -= oldAllocationQuantity;
+  total_.allocatedScalarQuantities += newAllocationQuantity;
 
+  // NOTE: The old allocation is contained in the client's allocation,
+  // so its resource names have already been interned.
   foreach (const Resource& resource, oldAllocationQuantity) {
-    allocations[name].totals[resource.name()] -= resource.scalar();
+    allocation.totals[intern(resource.name())] -= resource.scalar();
   }
 
   foreach (const Resource& resource, newAllocationQuantity) {
-    allocations[name].totals[resource.name()] += resource.scalar();
+    Interner<string>::Handle handle = intern(resource.name());
+
+    if (allocation.totals.size() <= handle) {
+      allocation.totals.resize(handle + 1);
+    }
+
+    allocation.totals[handle] += resource.scalar();
+    total_.clients[handle].insert(name);
   }
 
-  // Just assume the total has changed, per the TODO above.
-  dirty = true;
+  // Just assume the share has changed, per the TODO above.
+  dirtyClients.insert(name);
 }
 
 
@@ -231,7 +309,21 @@ const hashmap<SlaveID, Resources>& DRFSorter::allocation(const string& name)
 {
   CHECK(contains(name));
 
-  return allocations[name].resources;
+  Allocation& allocation = allocations.at(name);
+
+  if (allocation.view.isNone()) {
+    hashmap<SlaveID, Resources> view;
+
+    foreachpair (Agents::Handle handle,
+                 const Resources& resources,
+                 allocation.resources) {
+      view.emplace(agents->value(handle), resources);
+    }
+
+    allocation.view = std::move(view);
+  }
+
+  return allocation.view.get();
 }
 
 
@@ -243,6 +335,12 @@ const Resources& DRFSorter::allocationScalarQuantities(const string& name)
 }
 
 
+const Resources& DRFSorter::allocationScalarQuantities() const
+{
+  return total_.allocatedScalarQuantities;
+}
+
+
 hashmap<string, Resources> DRFSorter::allocation(const SlaveID& slaveId)
 {
   // TODO(jmlvanre): We can index the allocation by slaveId to make this faster.
@@ -251,11 +349,16 @@ hashmap<string, Resources> DRFSorter::allocation(const SlaveID& slaveId)
 
   hashmap<string, Resources> result;
 
+  Option<Agents::Handle> handle = agents->lookup(slaveId);
+  if (handle.isNone()) {
+    return result;
+  }
+
   foreachpair (const string& name, const Allocation& allocation, allocations) {
-    if (allocation.resources.contains(slaveId)) {
+    if (allocation.resources.contains(handle.get())) {
       // It is safe to use `at()` here because we've just checked the existence
       // of the key. This avoid un-necessary copies.
-      result.emplace(name, allocation.resources.at(slaveId));
+      result.emplace(name, allocation.resources.at(handle.get()));
     }
   }
 
@@ -267,8 +370,10 @@ Resources DRFSorter::allocation(const string& name, const SlaveID& slaveId)
 {
   CHECK(contains(name));
 
-  if (allocations[name].resources.contains(slaveId)) {
-    return allocations[name].resources[slaveId];
+  Option<Agents::Handle> handle = agents->lookup(slaveId);
+
+  if (handle.isSome() && allocations[name].resources.contains(handle.get())) {
+    return allocations[name].resources.at(handle.get());
   }
 
   return Resources();
@@ -286,49 +391,67 @@ void DRFSorter::unallocated(
     const SlaveID& slaveId,
     const Resources& resources)
 {
-  CHECK(allocations[name].resources.contains(slaveId));
+  Allocation& allocation = allocations[name];
+
+  Option<Agents::Handle> agent = agents->lookup(slaveId);
+  CHECK_SOME(agent);
+  CHECK(allocation.resources.contains(agent.get()));
+
+  Resources& allocated = allocation.resources.at(agent.get());
+  allocation.view = None();
 
-  CHECK(allocations[name].resources[slaveId].contains(resources));
-  allocations[name].resources[slaveId] -= resources;
+  CHECK(allocated.contains(resources));
+  allocated -= resources;
 
   // Remove shared resources from the allocated quantities when there
   // are no instances of same resources left in the allocation.
   const Resources absentShared = resources.shared()
-    .filter([this, name, slaveId](const Resource& resource) {
-      return !allocations[name].resources[slaveId].contains(resource);
+    .filter([&allocated](const Resource& resource) {
+      return !allocated.contains(resource);
     });
 
   const Resources scalarQuantities =
     (resources.nonShared() + absentShared).createStrippedScalarQuantity();
 
   foreach (const Resource& resource, scalarQuantities) {
-    allocations[name].totals[resource.name()] -= resource.scalar();
-  }
+    Interner<string>::Handle handle = intern(resource.name());
 
-  CHECK(allocations[name].scalarQuantities.contains(scalarQuantities));
-  allocations[name].scalarQuantities -= scalarQuantities;
+    Value::Scalar& total = allocation.totals.at(handle);
+    total -= resource.scalar();
 
-  if (allocations[name].resources[slaveId].empty()) {
-    allocations[name].resources.erase(slaveId);
+    // Stop tracking this client against the resource kind once it no
+    // longer holds any of it, so that changes to the total of this
+    // resource kind do not needlessly mark the client as dirty.
+    if (total == Value::Scalar()) {
+      total_.clients[handle].erase(name);
+    }
   }
 
-  if (!dirty) {
-    update(name);
+  CHECK(allocation.scalarQuantities.contains(scalarQuantities));
+  allocation.scalarQuantities -= scalarQuantities;
+  total_.allocatedScalarQuantities -= scalarQuantities;
+
+  if (allocated.empty()) {
+    release(allocation.resources, agent.get());
   }
+
+  dirtyClients.insert(name);
 }
 
 
 void DRFSorter::add(const SlaveID& slaveId, const Resources& resources)
 {
   if (!resources.empty()) {
+    Resources& total = acquire(total_.resources, slaveId);
+
     // Add shared resources to the total quantities when the same
     // resources don't already exist in the total.
     const Resources newShared = resources.shared()
-      .filter([this, slaveId](const Resource& resource) {
-        return !total_.resources[slaveId].contains(resource);
+      .filter([&total](const Resource& resource) {
+        return !total.contains(resource);
       });
 
-    total_.resources[slaveId] += resources;
+    total += resources;
 
     const Resources scalarQuantities =
       (resources.nonShared() + newShared).createStrippedScalarQuantity();
@@ -336,14 +459,15 @@ void DRFSorter::add(const SlaveID& slaveId, const Resources& resources)
     total_.scalarQuantities += scalarQuantities;
 
     foreach (const Resource& resource, scalarQuantities) {
-      total_.totals[resource.name()] += resource.scalar();
+      total_.totals[intern(resource.name())] += resource.scalar();
     }
 
-    // We have to recalculate all shares when the total resources
-    // change, but we put it off until sort is called so that if
-    // something else changes before the next allocation we don't
-    // recalculate everything twice.
-    dirty = true;
+    // We have to recalculate the shares of the clients holding the
+    // changed resource kinds when the total resources change, but we
+    // put it off until sort is called so that if something else
+    // changes before the next allocation we don't recalculate the
+    // shares twice.
+    markDirty(scalarQuantities);
   }
 }
 
@@ -351,60 +475,53 @@ void DRFSorter::add(const SlaveID& slaveId, const Resources& resources)
 void DRFSorter::remove(const SlaveID& slaveId, const Resources& resources)
 {
   if (!resources.empty()) {
-    CHECK(total_.resources.contains(slaveId));
-    CHECK(total_.resources[slaveId].contains(resources))
-      << total_.resources[slaveId] << " does not contain " << resources;
+    Option<Agents::Handle> agent = agents->lookup(slaveId);
+    CHECK_SOME(agent);
+    CHECK(total_.resources.contains(agent.get()));
+
+    Resources& total = total_.resources.at(agent.get());
 
-    total_.resources[slaveId] -= resources;
+    CHECK(total.contains(resources))
+      << total << " does not contain " << resources;
+
+    total -= resources;
 
     // Remove shared resources from the total quantities when there
     // are no instances of same resources left in the total.
     const Resources absentShared = resources.shared()
-      .filter([this, slaveId](const Resource& resource) {
-        return !total_.resources[slaveId].contains(resource);
+      .filter([&total](const Resource& resource) {
+        return !total.contains(resource);
       });
 
     const Resources scalarQuantities =
       (resources.nonShared() + absentShared).createStrippedScalarQuantity();
 
     foreach (const Resource& resource, scalarQuantities) {
-      total_.totals[resource.name()] -= resource.scalar();
+      total_.totals[intern(resource.name())] -= resource.scalar();
     }
 
     CHECK(total_.scalarQuantities.contains(scalarQuantities));
     total_.scalarQuantities -= scalarQuantities;
 
-    if (total_.resources[slaveId].empty()) {
-      total_.resources.erase(slaveId);
+    if (total.empty()) {
+      release(total_.resources, agent.get());
     }
 
-    dirty = true;
+    markDirty(scalarQuantities);
   }
 }
 
 
 vector<string> DRFSorter::sort()
 {
-  if (dirty) {
-    set<Client, DRFComparator> temp;
-
-    set<Client, DRFComparator>::iterator it;
-    for (it = clients.begin(); it != clients.end(); it++) {
-      Client client(*it);
-
-      // Update the 'share' to get proper sorting.
-      client.share = calculateShare(client.name);
-
-      temp.insert(client);
-    }
-
-    clients = temp;
-
-    // Reset dirty to false so as not to re-calculate *all*
-    // shares unless another dirtying operation occurs.
-    dirty = false;
+  // Only the clients whose share may have changed are re-keyed; the
+  // shares of all other clients are still accurate.
+  foreach (const string& name, dirtyClients) {
+    update(name);
   }
 
+  dirtyClients.clear();
+
   vector<string> result;
   result.reserve(clients.size());
 
@@ -434,14 +551,38 @@ void DRFSorter::update(const string& name)
   set<Client, DRFComparator>::iterator it = find(name);
 
   if (it != clients.end()) {
+    const double share = calculateShare(name);
+
+    // Avoid re-keying the client when its share is unchanged.
+    if (share == it->share) {
+      return;
+    }
+
     Client client(*it);
 
     // Update the 'share' to get proper sorting.
-    client.share = calculateShare(client.name);
+    client.share = share;
 
     // Remove and reinsert it to update the ordering appropriately.
     clients.erase(it);
-    clients.insert(client);
+    active[name] = clients.insert(client).first;
+  }
+}
+
+
+void DRFSorter::markDirty(const Resources& scalarQuantities)
+{
+  foreach (const Resource& resource, scalarQuantities) {
+    Interner<string>::Handle handle = intern(resource.name());
+
+    // Resources excluded from fair sharing do not affect any share.
+    if (fairnessExcluded[handle]) {
+      continue;
+    }
+
+    foreach (const string& name, total_.clients[handle]) {
+      dirtyClients.insert(name);
+    }
   }
 }
 
@@ -456,21 +597,20 @@ double DRFSorter::calculateShare(const string& name) const
   // currently does not take into account resources that are not
   // scalars.
 
-  foreachpair (const string& resourceName,
-               const Value::Scalar& scalar,
-               total_.totals) {
+  const vector<Value::Scalar>& allocated = allocations.at(name).totals;
+
+  // NOTE: Resources the client has not been allocated do not affect
+  // its share, so we only need to look at those in `allocated`.
+  for (size_t i = 0; i < allocated.size(); i++) {
     // Filter out the resources excluded from fair sharing.
-    if (fairnessExcludeResourceNames.isSome() &&
-        fairnessExcludeResourceNames->count(resourceName) > 0) {
+    if (fairnessExcluded[i]) {
       continue;
     }
 
-    if (scalar.value() > 0.0 &&
-        allocations.at(name).totals.contains(resourceName)) {
-      const double allocation =
-        allocations.at(name).totals.at(resourceName).value();
+    const Value::Scalar& scalar = total_.totals[i];
 
-      share = std::max(share, allocation / scalar.value());
+    if (scalar.value() > 0.0) {
+      share = std::max(share, allocated[i].value() / scalar.value());
     }
   }
 
@@ -478,16 +618,54 @@ double DRFSorter::calculateShare(const string& name) const
 }
 
 
+Interner<string>::Handle DRFSorter::intern(const string& resourceName)
+{
+  Interner<string>::Handle handle = resourceNames.intern(resourceName);
+
+  if (handle == total_.totals.size()) {
+    total_.totals.resize(handle + 1);
+    total_.clients.resize(handle + 1);
+
+    fairnessExcluded.push_back(
+        fairnessExcludeResourceNames.isSome() &&
+        fairnessExcludeResourceNames->count(resourceName) > 0);
+  }
+
+  return handle;
+}
+
+
+Resources& DRFSorter::acquire(
+    flat_hashmap<Agents::Handle, Resources>& resources,
+    const SlaveID& slaveId)
+{
+  Option<Agents::Handle> handle = agents->lookup(slaveId);
+
+  if (handle.isSome() && resources.contains(handle.get())) {
+    return resources.at(handle.get());
+  }
+
+  return resources[agents->acquire(slaveId)];
+}
+
+
+void DRFSorter::release(
+    flat_hashmap<Agents::Handle, Resources>& resources,
+    Agents::Handle handle)
+{
+  CHECK_EQ(1u, resources.erase(handle));
+
+  agents->release(handle);
+}
+
+
 set<Client, DRFComparator>::iterator DRFSorter::find(const string& name)
 {
-  set<Client, DRFComparator>::iterator it;
-  for (it = clients.begin(); it != clients.end(); it++) {
-    if (name == (*it).name) {
-      break;
-    }
+  if (!active.contains(name)) {
+    return clients.end();
   }
 
-  return it;
+  return active.at(name);
 }
 
 } // namespace allocator {
@@ -17,6 +17,7 @@
 #ifndef __MASTER_ALLOCATOR_SORTER_DRF_SORTER_HPP__
 #define __MASTER_ALLOCATOR_SORTER_DRF_SORTER_HPP__
 
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
@@ -25,9 +26,13 @@
 #include <mesos/resources.hpp>
 #include <mesos/values.hpp>
 
+#include <stout/flat_hashmap.hpp>
 #include <stout/hashmap.hpp>
+#include <stout/hashset.hpp>
 #include <stout/option.hpp>
 
+#include "master/allocator/interner.hpp"
+
 #include "master/allocator/sorter/drf/metrics.hpp"
 
 #include "master/allocator/sorter/sorter.hpp"
@@ -67,13 +72,22 @@ struct DRFComparator
 class DRFSorter : public Sorter
 {
 public:
+  // The handles of the agents in the sorter, in place of which the
+  // allocations and the total are keyed.
+  typedef ReferenceCountingInterner<SlaveID> Agents;
+
   DRFSorter() = default;
 
   explicit DRFSorter(
       const process::UPID& allocator,
       const std::string& metricsPrefix);
 
-  virtual ~DRFSorter() {}
+  // Creates a sorter which shares the handles of the agents with other
+  // sorters (e.g., those of the nodes of a `HierarchicalDRFSorter`),
+  // so that each agent ID is only stored once for all of them.
+  explicit DRFSorter(const std::shared_ptr<Agents>& agents);
+
+  virtual ~DRFSorter();
 
   virtual void initialize(
       const Option<std::set<std::string>>& fairnessExcludeResourceNames);
@@ -109,6 +123,8 @@ public:
 
   virtual const Resources& allocationScalarQuantities(const std::string& name);
 
+  virtual const Resources& allocationScalarQuantities() const;
+
   virtual hashmap<std::string, Resources> allocation(const SlaveID& slaveId);
 
   virtual Resources allocation(const std::string& name, const SlaveID& slaveId);
@@ -126,28 +142,78 @@ public:
   virtual int count();
 
 private:
+  DRFSorter(const DRFSorter&) = delete;
+  DRFSorter& operator=(const DRFSorter&) = delete;
+
+  // Returns the resources of an agent in `resources` (the allocation
+  // of a client or the total), adding an entry for the agent, and
+  // thereby a reference to its handle, if there is none yet.
+  Resources& acquire(
+      flat_hashmap<Agents::Handle, Resources>& resources,
+      const SlaveID& slaveId);
+
+  // Removes the entry of an agent from `resources` along with its
+  // reference to the handle of the agent.
+  void release(
+      flat_hashmap<Agents::Handle, Resources>& resources,
+      Agents::Handle handle);
+
   // Recalculates the share for the client and moves
   // it in 'clients' accordingly.
   void update(const std::string& name);
 
+  // Marks every client that holds an allocation of one of the given
+  // resource kinds as dirty. This is used when the total changes,
+  // since only those clients can see their share change.
+  void markDirty(const Resources& scalarQuantities);
+
   // Returns the dominant resource share for the client.
   double calculateShare(const std::string& name) const;
 
+  // Returns the handle of the given resource name, interning it and
+  // growing the state indexed by resource name handles if needed.
+  Interner<std::string>::Handle intern(const std::string& resourceName);
+
   // Resources (by name) that will be excluded from fair sharing.
   Option<std::set<std::string>> fairnessExcludeResourceNames;
 
+  // Each entry of `Total::resources` and `Allocation::resources` holds
+  // a reference to the handle of its agent.
+  std::shared_ptr<Agents> agents = std::make_shared<Agents>();
+
+  // Handles for the names of the resources in the sorter. The state
+  // kept per resource name is indexed by these handles, so that share
+  // calculations do not need to hash or compare resource names.
+  Interner<std::string> resourceNames;
+
+  // Whether the resource name with a given handle is excluded from
+  // fair sharing (see `fairnessExcludeResourceNames`).
+  std::vector<bool> fairnessExcluded;
+
   // Returns an iterator to the specified client, if
   // it exists in this Sorter.
   std::set<Client, DRFComparator>::iterator find(const std::string& name);
 
-  // If true, sort() will recalculate all shares.
-  bool dirty = false;
+  // Clients whose share may have changed since the last call to
+  // `sort()`. Only these clients are re-keyed in `clients` when
+  // sorting, so that `sort()` costs O(k log n) for k dirty clients
+  // rather than recalculating the share of every client.
+  hashset<std::string> dirtyClients;
 
   // A set of Clients (names and shares) sorted by share.
   std::set<Client, DRFComparator> clients;
 
+  // Maps the names of active clients to their position in `clients`.
+  // NOTE: Iterators into a `std::set` remain valid until the element
+  // they point to is erased, so this must be kept up to date whenever
+  // a client is re-inserted into `clients`.
+  //
+  // NOTE: This and `weights` are `flat_hashmap`s since they are looked
+  // up for every client whenever the sorter updates or sorts them.
+  flat_hashmap<std::string, std::set<Client, DRFComparator>::iterator> active;
+
   // Maps client names to the weights that should be applied to their shares.
-  hashmap<std::string, double> weights;
+  flat_hashmap<std::string, double> weights;
 
   // Total resources.
   struct Total {
@@ -155,7 +221,7 @@ private:
     // to account for multiple copies of the same shared resources. We need to
     // ensure that we do not update the scalar quantities for shared resources
     // when the change is only in the number of copies in the sorter.
-    hashmap<SlaveID, Resources> resources;
+    flat_hashmap<Agents::Handle, Resources> resources;
 
     // NOTE: Scalars can be safely aggregated across slaves. We keep
     // that to speed up the calculation of shares. See MESOS-2891 for
@@ -170,14 +236,23 @@ private:
     // resources and not quantities.
     Resources scalarQuantities;
 
-    // We also store a map version of `scalarQuantities`, mapping
-    // the `Resource::name` to aggregated scalar. This improves the
-    // performance of calculating shares. See MESOS-4694.
+    // We also store a vector version of `scalarQuantities`, mapping
+    // the handle of each `Resource::name` to the aggregated scalar.
+    // This improves the performance of calculating shares. See
+    // MESOS-4694.
     //
     // TODO(bmahler): Ideally we do not store `scalarQuantities`
     // redundantly here, investigate performance improvements to
     // `Resources` to make this unnecessary.
-    hashmap<std::string, Value::Scalar> totals;
+    std::vector<Value::Scalar> totals;
+
+    // Maps the handle of each `Resource::name` to the clients currently
+    // holding a non-zero allocation of it. When the total of a resource
+    // kind changes, only these clients need their shares recalculated.
+    std::vector<hashset<std::string>> clients;
+
+    // The sum of the `Allocation::scalarQuantities` of all clients.
+    Resources allocatedScalarQuantities;
   } total_;
 
   // Allocation for a client.
@@ -186,28 +261,42 @@ private:
     // to a client, where the number of copies represents the number
     // of times this shared resource has been allocated to (and has
     // not been recovered from) a specific client.
-    hashmap<SlaveID, Resources> resources;
+    //
+    // NOTE: This is keyed by the handle of the agent rather than by
+    // its ID, since a client may be allocated resources on every
+    // agent, and the same agents appear in the allocations of many
+    // clients and sorters.
+    flat_hashmap<Agents::Handle, Resources> resources;
 
     // Similarly, we aggregate scalars across slaves and omit information
     // about dynamic reservations, persistent volumes and sharedness of
     // the corresponding resource. See notes above.
     Resources scalarQuantities;
 
-    // We also store a map version of `scalarQuantities`, mapping
-    // the `Resource::name` to aggregated scalar. This improves the
-    // performance of calculating shares. See MESOS-4694.
+    // We also store a vector version of `scalarQuantities`, indexed
+    // by resource name handle as in `Total::totals`. It may be shorter
+    // than `Total::totals`, in which case the missing entries are zero.
     //
     // TODO(bmahler): Ideally we do not store `scalarQuantities`
     // redundantly here, investigate performance improvements to
     // `Resources` to make this unnecessary.
-    hashmap<std::string, Value::Scalar> totals;
+    std::vector<Value::Scalar> totals;
+
+    // The allocation keyed by agent ID, as returned by `allocation()`.
+    // It is only built when asked for and reset whenever the
+    // allocation changes, so that the (rare) callers get a reference
+    // rather than a copy without the sorter keeping it for everyone.
+    Option<hashmap<SlaveID, Resources>> view;
   };
 
   // Maps client names to the resources they have been allocated.
   hashmap<std::string, Allocation> allocations;
 
+  // The hierarchical sorter reports the shares of its clients from
+  // the DRF sorters of its nodes.
+  friend class HierarchicalDRFSorter;
+
   // Metrics are optionally exposed by the sorter.
-  friend Metrics;
   Option<Metrics> metrics;
 };
 
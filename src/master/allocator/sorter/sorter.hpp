@@ -106,6 +106,10 @@ public:
   virtual const Resources& allocationScalarQuantities(
       const std::string& client) = 0;
 
+  // Returns the total scalar resource quantities that are allocated to
+  // all clients in this sorter, omitting the same metadata as above.
+  virtual const Resources& allocationScalarQuantities() const = 0;
+
   // Returns the clients that have allocations on this slave.
   virtual hashmap<std::string, Resources> allocation(
       const SlaveID& slaveId) = 0;
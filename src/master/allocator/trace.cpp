@@ -0,0 +1,610 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "master/allocator/trace.hpp"
+
+#include <stdint.h>
+
+#include <glog/logging.h>
+
+#include <process/clock.hpp>
+
+#include <stout/bytes.hpp>
+#include <stout/foreach.hpp>
+#include <stout/nothing.hpp>
+#include <stout/os.hpp>
+
+#include <stout/os/close.hpp>
+#include <stout/os/open.hpp>
+#include <stout/os/write.hpp>
+
+using std::set;
+using std::string;
+using std::vector;
+
+using mesos::allocator::InverseOfferStatus;
+
+using process::Clock;
+using process::Future;
+
+namespace mesos {
+namespace internal {
+namespace master {
+namespace allocator {
+
+// The calls are written out in blocks of about this size, so that
+// recording costs a system call every few hundred calls rather than
+// one per call.
+static const Bytes FLUSH_SIZE = Kilobytes(64);
+
+
+Try<mesos::allocator::Allocator*> TracingAllocator::create(
+    mesos::allocator::Allocator* allocator,
+    const string& path)
+{
+  Try<int> fd = os::open(
+      path,
+      O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+      S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+
+  if (fd.isError()) {
+    return Error(
+        "Failed to open allocator trace '" + path + "': " + fd.error());
+  }
+
+  return new TracingAllocator(allocator, fd.get());
+}
+
+
+TracingAllocator::~TracingAllocator()
+{
+  flush();
+
+  if (fd.isSome()) {
+    os::close(fd.get());
+  }
+
+  delete allocator;
+}
+
+
+void TracingAllocator::initialize(
+    const Duration& allocationInterval,
+    const lambda::function<
+        void(const FrameworkID&,
+             const hashmap<SlaveID, Resources>&)>& offerCallback,
+    const lambda::function<
+        void(const FrameworkID&,
+             const hashmap<SlaveID, UnavailableResources>&)>&
+      inverseOfferCallback,
+    const hashmap<string, double>& weights,
+    const Option<set<string>>& fairnessExcludeResourceNames,
+    const mesos::allocator::Options& options)
+{
+  AllocatorCall call_ = call(AllocatorCall::INITIALIZE);
+
+  AllocatorCall::Initialize* initialize = call_.mutable_initialize();
+  initialize->set_allocation_interval_seconds(allocationInterval.secs());
+
+  foreachpair (const string& role, double weight, weights) {
+    WeightInfo* weightInfo = initialize->add_weights();
+    weightInfo->set_role(role);
+    weightInfo->set_weight(weight);
+  }
+
+  if (fairnessExcludeResourceNames.isSome()) {
+    foreach (const string& name, fairnessExcludeResourceNames.get()) {
+      initialize->add_fairness_excluded_resource_names(name);
+    }
+  }
+
+  if (options.allocationPartitions.isSome()) {
+    initialize->set_allocation_partitions(options.allocationPartitions.get());
+  }
+
+  if (options.allocationSweepInterval.isSome()) {
+    initialize->set_allocation_sweep_interval_seconds(
+        options.allocationSweepInterval->secs());
+  }
+
+  if (options.agentOrdering.isSome()) {
+    initialize->set_agent_ordering(options.agentOrdering.get());
+  }
+
+  record(call_);
+
+  allocator->initialize(
+      allocationInterval,
+      offerCallback,
+      inverseOfferCallback,
+      weights,
+      fairnessExcludeResourceNames,
+      options);
+}
+
+
+void TracingAllocator::recover(
+    const int expectedAgentCount,
+    const hashmap<string, Quota>& quotas)
+{
+  AllocatorCall call_ = call(AllocatorCall::RECOVER);
+  call_.set_expected_agent_count(expectedAgentCount);
+
+  foreachvalue (const Quota& quota, quotas) {
+    call_.add_quotas()->CopyFrom(quota.info);
+  }
+
+  record(call_);
+
+  allocator->recover(expectedAgentCount, quotas);
+}
+
+
+void TracingAllocator::addFramework(
+    const FrameworkID& frameworkId,
+    const FrameworkInfo& frameworkInfo,
+    const hashmap<SlaveID, Resources>& used,
+    bool active)
+{
+  AllocatorCall call_ = call(AllocatorCall::ADD_FRAMEWORK);
+  call_.mutable_framework_id()->CopyFrom(frameworkId);
+  call_.mutable_framework_info()->CopyFrom(frameworkInfo);
+  call_.set_active(active);
+
+  foreachpair (const SlaveID& slaveId, const Resources& resources, used) {
+    AllocatorCall::Allocation* allocation = call_.add_allocations();
+    allocation->mutable_slave_id()->CopyFrom(slaveId);
+    allocation->mutable_resources()->CopyFrom(resources);
+  }
+
+  record(call_);
+
+  allocator->addFramework(frameworkId, frameworkInfo, used, active);
+}
+
+
+void TracingAllocator::removeFramework(
+    const FrameworkID& frameworkId)
+{
+  AllocatorCall call_ = call(AllocatorCall::REMOVE_FRAMEWORK);
+  call_.mutable_framework_id()->CopyFrom(frameworkId);
+
+  record(call_);
+
+  allocator->removeFramework(frameworkId);
+}
+
+
+void TracingAllocator::activateFramework(
+    const FrameworkID& frameworkId)
+{
+  AllocatorCall call_ = call(AllocatorCall::ACTIVATE_FRAMEWORK);
+  call_.mutable_framework_id()->CopyFrom(frameworkId);
+
+  record(call_);
+
+  allocator->activateFramework(frameworkId);
+}
+
+
+void TracingAllocator::deactivateFramework(
+    const FrameworkID& frameworkId)
+{
+  AllocatorCall call_ = call(AllocatorCall::DEACTIVATE_FRAMEWORK);
+  call_.mutable_framework_id()->CopyFrom(frameworkId);
+
+  record(call_);
+
+  allocator->deactivateFramework(frameworkId);
+}
+
+
+void TracingAllocator::updateFramework(
+    const FrameworkID& frameworkId,
+    const FrameworkInfo& frameworkInfo)
+{
+  AllocatorCall call_ = call(AllocatorCall::UPDATE_FRAMEWORK);
+  call_.mutable_framework_id()->CopyFrom(frameworkId);
+  call_.mutable_framework_info()->CopyFrom(frameworkInfo);
+
+  record(call_);
+
+  allocator->updateFramework(frameworkId, frameworkInfo);
+}
+
+
+void TracingAllocator::addSlave(
+    const SlaveID& slaveId,
+    const SlaveInfo& slaveInfo,
+    const Option<Unavailability>& unavailability,
+    const Resources& total,
+    const hashmap<FrameworkID, Resources>& used)
+{
+  AllocatorCall call_ = call(AllocatorCall::ADD_SLAVE);
+  call_.mutable_slave_id()->CopyFrom(slaveId);
+  call_.mutable_slave_info()->CopyFrom(slaveInfo);
+  call_.mutable_resources()->CopyFrom(total);
+
+  if (unavailability.isSome()) {
+    call_.mutable_unavailability()->CopyFrom(unavailability.get());
+  }
+
+  foreachpair (const FrameworkID& frameworkId,
+               const Resources& resources,
+               used) {
+    AllocatorCall::Allocation* allocation = call_.add_allocations();
+    allocation->mutable_framework_id()->CopyFrom(frameworkId);
+    allocation->mutable_resources()->CopyFrom(resources);
+  }
+
+  record(call_);
+
+  allocator->addSlave(slaveId, slaveInfo, unavailability, total, used);
+}
+
+
+void TracingAllocator::removeSlave(
+    const SlaveID& slaveId)
+{
+  AllocatorCall call_ = call(AllocatorCall::REMOVE_SLAVE);
+  call_.mutable_slave_id()->CopyFrom(slaveId);
+
+  record(call_);
+
+  allocator->removeSlave(slaveId);
+}
+
+
+void TracingAllocator::updateSlave(
+    const SlaveID& slaveId,
+    const Resources& oversubscribed)
+{
+  AllocatorCall call_ = call(AllocatorCall::UPDATE_SLAVE);
+  call_.mutable_slave_id()->CopyFrom(slaveId);
+  call_.mutable_resources()->CopyFrom(oversubscribed);
+
+  record(call_);
+
+  allocator->updateSlave(slaveId, oversubscribed);
+}
+
+
+void TracingAllocator::activateSlave(
+    const SlaveID& slaveId)
+{
+  AllocatorCall call_ = call(AllocatorCall::ACTIVATE_SLAVE);
+  call_.mutable_slave_id()->CopyFrom(slaveId);
+
+  record(call_);
+
+  allocator->activateSlave(slaveId);
+}
+
+
+void TracingAllocator::deactivateSlave(
+    const SlaveID& slaveId)
+{
+  AllocatorCall call_ = call(AllocatorCall::DEACTIVATE_SLAVE);
+  call_.mutable_slave_id()->CopyFrom(slaveId);
+
+  record(call_);
+
+  allocator->deactivateSlave(slaveId);
+}
+
+
+void TracingAllocator::updateWhitelist(
+    const Option<hashset<string>>& whitelist)
+{
+  AllocatorCall call_ = call(AllocatorCall::UPDATE_WHITELIST);
+  call_.set_has_whitelist(whitelist.isSome());
+
+  if (whitelist.isSome()) {
+    foreach (const string& hostname, whitelist.get()) {
+      call_.add_whitelist(hostname);
+    }
+  }
+
+  record(call_);
+
+  allocator->updateWhitelist(whitelist);
+}
+
+
+void TracingAllocator::requestResources(
+    const FrameworkID& frameworkId,
+    const vector<Request>& requests)
+{
+  AllocatorCall call_ = call(AllocatorCall::REQUEST_RESOURCES);
+  call_.mutable_framework_id()->CopyFrom(frameworkId);
+
+  foreach (const Request& request, requests) {
+    call_.add_requests()->CopyFrom(request);
+  }
+
+  record(call_);
+
+  allocator->requestResources(frameworkId, requests);
+}
+
+
+void TracingAllocator::updateAllocation(
+    const FrameworkID& frameworkId,
+    const SlaveID& slaveId,
+    const Resources& offeredResources,
+    const vector<Offer::Operation>& operations)
+{
+  AllocatorCall call_ = call(AllocatorCall::UPDATE_ALLOCATION);
+  call_.mutable_framework_id()->CopyFrom(frameworkId);
+  call_.mutable_slave_id()->CopyFrom(slaveId);
+  call_.mutable_resources()->CopyFrom(offeredResources);
+
+  foreach (const Offer::Operation& operation, operations) {
+    call_.add_operations()->CopyFrom(operation);
+  }
+
+  record(call_);
+
+  allocator->updateAllocation(
+      frameworkId, slaveId, offeredResources, operations);
+}
+
+
+Future<Nothing> TracingAllocator::updateAvailable(
+    const SlaveID& slaveId,
+    const vector<Offer::Operation>& operations)
+{
+  AllocatorCall call_ = call(AllocatorCall::UPDATE_AVAILABLE);
+  call_.mutable_slave_id()->CopyFrom(slaveId);
+
+  foreach (const Offer::Operation& operation, operations) {
+    call_.add_operations()->CopyFrom(operation);
+  }
+
+  record(call_);
+
+  return allocator->updateAvailable(slaveId, operations);
+}
+
+
+void TracingAllocator::updateUnavailability(
+    const SlaveID& slaveId,
+    const Option<Unavailability>& unavailability)
+{
+  AllocatorCall call_ = call(AllocatorCall::UPDATE_UNAVAILABILITY);
+  call_.mutable_slave_id()->CopyFrom(slaveId);
+
+  if (unavailability.isSome()) {
+    call_.mutable_unavailability()->CopyFrom(unavailability.get());
+  }
+
+  record(call_);
+
+  allocator->updateUnavailability(slaveId, unavailability);
+}
+
+
+void TracingAllocator::updateInverseOffer(
+    const SlaveID& slaveId,
+    const FrameworkID& frameworkId,
+    const Option<UnavailableResources>& unavailableResources,
+    const Option<InverseOfferStatus>& status,
+    const Option<Filters>& filters)
+{
+  AllocatorCall call_ = call(AllocatorCall::UPDATE_INVERSE_OFFER);
+  call_.mutable_slave_id()->CopyFrom(slaveId);
+  call_.mutable_framework_id()->CopyFrom(frameworkId);
+
+  if (unavailableResources.isSome()) {
+    call_.mutable_unavailable_resources()->CopyFrom(
+        unavailableResources->resources);
+    call_.mutable_unavailability()->CopyFrom(
+        unavailableResources->unavailability);
+  }
+
+  if (status.isSome()) {
+    call_.mutable_inverse_offer_status()->CopyFrom(status.get());
+  }
+
+  if (filters.isSome()) {
+    call_.mutable_filters()->CopyFrom(filters.get());
+  }
+
+  record(call_);
+
+  allocator->updateInverseOffer(
+      slaveId, frameworkId, unavailableResources, status, filters);
+}
+
+
+Future<hashmap<SlaveID, hashmap<FrameworkID, InverseOfferStatus>>>
+TracingAllocator::getInverseOfferStatuses()
+{
+  return allocator->getInverseOfferStatuses();
+}
+
+
+void TracingAllocator::recoverResources(
+    const FrameworkID& frameworkId,
+    const SlaveID& slaveId,
+    const Resources& resources,
+    const Option<Filters>& filters)
+{
+  AllocatorCall call_ = call(AllocatorCall::RECOVER_RESOURCES);
+  call_.mutable_framework_id()->CopyFrom(frameworkId);
+  call_.mutable_slave_id()->CopyFrom(slaveId);
+  call_.mutable_resources()->CopyFrom(resources);
+
+  if (filters.isSome()) {
+    call_.mutable_filters()->CopyFrom(filters.get());
+  }
+
+  record(call_);
+
+  allocator->recoverResources(frameworkId, slaveId, resources, filters);
+}
+
+
+void TracingAllocator::recoverResources(
+    const FrameworkID& frameworkId,
+    const hashmap<SlaveID, Resources>& resources,
+    const Option<Filters>& filters)
+{
+  // The resources recovered on many agents at once are recorded as a
+  // single call, so that the replay exercises the same code path.
+  AllocatorCall call_ = call(AllocatorCall::RECOVER_RESOURCES);
+  call_.mutable_framework_id()->CopyFrom(frameworkId);
+
+  foreachkey (const SlaveID& slaveId, resources) {
+    AllocatorCall::Allocation* allocation = call_.add_allocations();
+    allocation->mutable_slave_id()->CopyFrom(slaveId);
+    allocation->mutable_resources()->CopyFrom(resources.at(slaveId));
+  }
+
+  if (filters.isSome()) {
+    call_.mutable_filters()->CopyFrom(filters.get());
+  }
+
+  record(call_);
+
+  allocator->recoverResources(frameworkId, resources, filters);
+}
+
+
+void TracingAllocator::suppressOffers(
+    const FrameworkID& frameworkId)
+{
+  AllocatorCall call_ = call(AllocatorCall::SUPPRESS_OFFERS);
+  call_.mutable_framework_id()->CopyFrom(frameworkId);
+
+  record(call_);
+
+  allocator->suppressOffers(frameworkId);
+}
+
+
+void TracingAllocator::reviveOffers(
+    const FrameworkID& frameworkId)
+{
+  AllocatorCall call_ = call(AllocatorCall::REVIVE_OFFERS);
+  call_.mutable_framework_id()->CopyFrom(frameworkId);
+
+  record(call_);
+
+  allocator->reviveOffers(frameworkId);
+}
+
+
+void TracingAllocator::setQuota(
+    const string& role,
+    const Quota& quota)
+{
+  AllocatorCall call_ = call(AllocatorCall::SET_QUOTA);
+  call_.set_role(role);
+  call_.add_quotas()->CopyFrom(quota.info);
+
+  record(call_);
+
+  allocator->setQuota(role, quota);
+}
+
+
+void TracingAllocator::removeQuota(
+    const string& role)
+{
+  AllocatorCall call_ = call(AllocatorCall::REMOVE_QUOTA);
+  call_.set_role(role);
+
+  record(call_);
+
+  allocator->removeQuota(role);
+}
+
+
+void TracingAllocator::updateWeights(
+    const vector<WeightInfo>& weightInfos)
+{
+  AllocatorCall call_ = call(AllocatorCall::UPDATE_WEIGHTS);
+
+  foreach (const WeightInfo& weightInfo, weightInfos) {
+    call_.add_weights()->CopyFrom(weightInfo);
+  }
+
+  record(call_);
+
+  allocator->updateWeights(weightInfos);
+}
+
+
+AllocatorCall TracingAllocator::call(AllocatorCall::Type type)
+{
+  AllocatorCall call;
+  call.set_type(type);
+  call.set_nanoseconds(Clock::now().duration().ns());
+
+  return call;
+}
+
+
+void TracingAllocator::record(const AllocatorCall& call)
+{
+  if (fd.isNone()) {
+    return;
+  }
+
+  // Each call is prefixed by its size, like `protobuf::write` does,
+  // so that the trace can be read with `protobuf::Reader`.
+  const uint32_t size = call.ByteSize();
+  buffer.append((const char*) &size, sizeof(size));
+
+  if (!call.AppendToString(&buffer)) {
+    LOG(ERROR) << "Failed to serialize allocator call "
+               << AllocatorCall::Type_Name(call.type())
+               << ", no longer recording the allocator trace";
+
+    os::close(fd.get());
+    fd = None();
+    return;
+  }
+
+  if (buffer.size() >= FLUSH_SIZE.bytes()) {
+    flush();
+  }
+}
+
+
+void TracingAllocator::flush()
+{
+  if (fd.isNone() || buffer.empty()) {
+    return;
+  }
+
+  Try<Nothing> write = os::write(fd.get(), buffer);
+  buffer.clear();
+
+  if (write.isError()) {
+    LOG(ERROR) << "Failed to write the allocator trace: " << write.error()
+               << ", no longer recording the allocator trace";
+
+    os::close(fd.get());
+    fd = None();
+  }
+}
+
+} // namespace allocator {
+} // namespace master {
+} // namespace internal {
+} // namespace mesos {
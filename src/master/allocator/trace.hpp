@@ -0,0 +1,216 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __MASTER_ALLOCATOR_TRACE_HPP__
+#define __MASTER_ALLOCATOR_TRACE_HPP__
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include <mesos/allocator/allocator.hpp>
+
+#include <mesos/maintenance/maintenance.hpp>
+
+#include <mesos/quota/quota.hpp>
+
+#include <mesos/resources.hpp>
+
+#include <process/future.hpp>
+
+#include <stout/duration.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/hashset.hpp>
+#include <stout/lambda.hpp>
+#include <stout/option.hpp>
+#include <stout/try.hpp>
+
+#include "master/allocator/trace.pb.h"
+
+namespace mesos {
+namespace internal {
+namespace master {
+namespace allocator {
+
+// An allocator that records every call to a trace file before passing
+// it on to another allocator, so that the calls can be replayed
+// against an allocator offline (see `mesos-allocator-replay`), e.g.,
+// to measure the duration of allocation cycles under the load of a
+// production cluster.
+//
+// The calls are serialized into a buffer which is written to the file
+// once it is full, and when the allocator is destroyed. Errors while
+// writing the trace are logged and stop the recording, but never
+// affect the allocation.
+class TracingAllocator : public mesos::allocator::Allocator
+{
+public:
+  // Takes ownership of the allocator.
+  static Try<mesos::allocator::Allocator*> create(
+      mesos::allocator::Allocator* allocator,
+      const std::string& path);
+
+  ~TracingAllocator();
+
+  void initialize(
+      const Duration& allocationInterval,
+      const lambda::function<
+          void(const FrameworkID&,
+               const hashmap<SlaveID, Resources>&)>& offerCallback,
+      const lambda::function<
+          void(const FrameworkID&,
+               const hashmap<SlaveID, UnavailableResources>&)>&
+        inverseOfferCallback,
+      const hashmap<std::string, double>& weights,
+      const Option<std::set<std::string>>&
+        fairnessExcludeResourceNames = None(),
+      const mesos::allocator::Options& options =
+        mesos::allocator::Options());
+
+  void recover(
+      const int expectedAgentCount,
+      const hashmap<std::string, Quota>& quotas);
+
+  void addFramework(
+      const FrameworkID& frameworkId,
+      const FrameworkInfo& frameworkInfo,
+      const hashmap<SlaveID, Resources>& used,
+      bool active);
+
+  void removeFramework(
+      const FrameworkID& frameworkId);
+
+  void activateFramework(
+      const FrameworkID& frameworkId);
+
+  void deactivateFramework(
+      const FrameworkID& frameworkId);
+
+  void updateFramework(
+      const FrameworkID& frameworkId,
+      const FrameworkInfo& frameworkInfo);
+
+  void addSlave(
+      const SlaveID& slaveId,
+      const SlaveInfo& slaveInfo,
+      const Option<Unavailability>& unavailability,
+      const Resources& total,
+      const hashmap<FrameworkID, Resources>& used);
+
+  void removeSlave(
+      const SlaveID& slaveId);
+
+  void updateSlave(
+      const SlaveID& slaveId,
+      const Resources& oversubscribed);
+
+  void activateSlave(
+      const SlaveID& slaveId);
+
+  void deactivateSlave(
+      const SlaveID& slaveId);
+
+  void updateWhitelist(
+      const Option<hashset<std::string>>& whitelist);
+
+  void requestResources(
+      const FrameworkID& frameworkId,
+      const std::vector<Request>& requests);
+
+  void updateAllocation(
+      const FrameworkID& frameworkId,
+      const SlaveID& slaveId,
+      const Resources& offeredResources,
+      const std::vector<Offer::Operation>& operations);
+
+  process::Future<Nothing> updateAvailable(
+      const SlaveID& slaveId,
+      const std::vector<Offer::Operation>& operations);
+
+  void updateUnavailability(
+      const SlaveID& slaveId,
+      const Option<Unavailability>& unavailability);
+
+  void updateInverseOffer(
+      const SlaveID& slaveId,
+      const FrameworkID& frameworkId,
+      const Option<UnavailableResources>& unavailableResources,
+      const Option<mesos::allocator::InverseOfferStatus>& status,
+      const Option<Filters>& filters = None());
+
+  // NOTE: This is not recorded, as it does not change the allocation.
+  process::Future<
+      hashmap<SlaveID,
+              hashmap<FrameworkID, mesos::allocator::InverseOfferStatus>>>
+    getInverseOfferStatuses();
+
+  void recoverResources(
+      const FrameworkID& frameworkId,
+      const SlaveID& slaveId,
+      const Resources& resources,
+      const Option<Filters>& filters);
+
+  void recoverResources(
+      const FrameworkID& frameworkId,
+      const hashmap<SlaveID, Resources>& resources,
+      const Option<Filters>& filters);
+
+  void suppressOffers(
+      const FrameworkID& frameworkId);
+
+  void reviveOffers(
+      const FrameworkID& frameworkId);
+
+  void setQuota(
+      const std::string& role,
+      const Quota& quota);
+
+  void removeQuota(
+      const std::string& role);
+
+  void updateWeights(
+      const std::vector<WeightInfo>& weightInfos);
+
+private:
+  TracingAllocator(mesos::allocator::Allocator* _allocator, int _fd)
+    : allocator(_allocator), fd(_fd) {}
+
+  TracingAllocator(const TracingAllocator&) = delete;
+  TracingAllocator& operator=(const TracingAllocator&) = delete;
+
+  // Returns a call of the given type, stamped with the current time.
+  static AllocatorCall call(AllocatorCall::Type type);
+
+  // Appends the call to the buffer, writing out the buffer if it is
+  // full.
+  void record(const AllocatorCall& call);
+
+  void flush();
+
+  mesos::allocator::Allocator* allocator;
+
+  // The trace file, or None once writing to it failed.
+  Option<int> fd;
+
+  std::string buffer;
+};
+
+} // namespace allocator {
+} // namespace master {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __MASTER_ALLOCATOR_TRACE_HPP__
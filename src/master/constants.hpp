@@ -80,9 +80,18 @@ constexpr double RECOVERY_AGENT_REMOVAL_PERCENT_LIMIT = 1.0; // 100%.
 // Maximum number of removed slaves to store in the cache.
 constexpr size_t MAX_REMOVED_SLAVES = 100000;
 
+// Maximum number of removed agents, and of removed frameworks, that
+// are remembered to report the changes to the `/state-summary` since a
+// state generation.
+constexpr size_t MAX_STATE_SUMMARY_REMOVALS = 10000;
+
 // Default maximum number of completed frameworks to store in the cache.
 constexpr size_t DEFAULT_MAX_COMPLETED_FRAMEWORKS = 50;
 
+// Default maximum number of operator API events to store for resuming
+// subscriptions.
+constexpr size_t DEFAULT_MAX_OPERATOR_EVENT_HISTORY = 0;
+
 // Default maximum number of completed tasks per framework
 // to store in the cache.
 constexpr size_t DEFAULT_MAX_COMPLETED_TASKS_PER_FRAMEWORK = 1000;
@@ -97,6 +106,11 @@ constexpr Duration WHITELIST_WATCH_INTERVAL = Seconds(5);
 // Default number of tasks (limit) for /master/tasks endpoint.
 constexpr size_t TASK_LIMIT = 100;
 
+// Number of statuses sent in each batch of an implicit reconciliation
+// to a framework with the BATCHED_RECONCILIATION capability. The
+// master handles other events between the batches.
+constexpr size_t RECONCILIATION_BATCH_SIZE = 1000;
+
 constexpr Duration DEFAULT_REGISTRY_GC_INTERVAL = Minutes(15);
 
 constexpr Duration DEFAULT_REGISTRY_MAX_AGENT_AGE = Weeks(2);
@@ -130,9 +144,16 @@ constexpr char DEFAULT_ALLOCATOR[] = "HierarchicalDRF";
 // The default interval between allocations.
 constexpr Duration DEFAULT_ALLOCATION_INTERVAL = Seconds(1);
 
+// The default number of agent partitions allocated in parallel.
+constexpr size_t DEFAULT_ALLOCATION_PARTITIONS = 1;
+
 // Name of the default, local authorizer.
 constexpr char DEFAULT_AUTHORIZER[] = "local";
 
+// The default maximum number of cached authorization decisions, see
+// the `--authorization_cache_ttl` flag.
+constexpr size_t DEFAULT_AUTHORIZATION_CACHE_CAPACITY = 10000;
+
 // Name of the master HTTP authentication realm for read-only endpoints.
 constexpr char READONLY_HTTP_AUTHENTICATION_REALM[] =
   "mesos-master-readonly";
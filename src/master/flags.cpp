@@ -24,8 +24,12 @@
 #include "master/constants.hpp"
 #include "master/flags.hpp"
 
+#include "master/allocator/mesos/agent_ordering.hpp"
+
 using std::string;
 
+using mesos::internal::master::allocator::internal::AgentOrdering;
+
 mesos::internal::master::Flags::Flags()
 {
   add(&Flags::version,
@@ -114,6 +118,22 @@ mesos::internal::master::Flags::Flags()
       "after which the operation is considered a failure.",
       Seconds(20));
 
+  add(&Flags::registry_batch_interval,
+      "registry_batch_interval",
+      "Amount of time to wait for more operations before storing the\n"
+      "registry, so that operations arriving in bursts (e.g., agents\n"
+      "re-registering after a master failover) are stored together.\n"
+      "Operations that arrive while a store is in progress are always\n"
+      "stored together once it completes. A zero interval stores the\n"
+      "registry as soon as an operation arrives.",
+      Seconds(0));
+
+  add(&Flags::registry_max_batch_size,
+      "registry_max_batch_size",
+      "Number of queued operations after which the registry is stored\n"
+      "without waiting for the rest of `--registry_batch_interval`.",
+      1000);
+
   add(&Flags::log_auto_initialize,
       "log_auto_initialize",
       "Whether to automatically initialize the replicated log used for the\n"
@@ -196,6 +216,64 @@ mesos::internal::master::Flags::Flags()
       " (batch) allocations (e.g., 500ms, 1sec, etc).",
       DEFAULT_ALLOCATION_INTERVAL);
 
+  add(&Flags::allocation_partitions,
+      "allocation_partitions",
+      "Number of partitions the agents are split into when performing\n"
+      "an allocation. Offers for each partition are computed in parallel\n"
+      "and then merged, which shortens allocation runs in large clusters\n"
+      "at the cost of fairness being only approximate across partitions\n"
+      "within a single allocation run. With the default of 1, all agents\n"
+      "are allocated sequentially.",
+      DEFAULT_ALLOCATION_PARTITIONS,
+      [](size_t value) -> Option<Error> {
+        if (value < 1) {
+          return Error("Expected `--allocation_partitions` to be at least 1");
+        }
+        return None();
+      });
+
+  add(&Flags::allocation_sweep_interval,
+      "allocation_sweep_interval",
+      "If set, enables event driven allocation: instead of allocating all\n"
+      "agents every `--allocation_interval`, each batch allocation only\n"
+      "considers the agents whose resources were recovered or whose offer\n"
+      "filters expired since the previous one, and events such as reviving\n"
+      "offers or setting quota only allocate to the affected roles. A full\n"
+      "allocation of all agents is still performed once every sweep\n"
+      "interval (e.g., 30secs, 1mins, etc). Inverse offers for maintenance\n"
+      "are still sent by every batch allocation.");
+
+  add(&Flags::agent_ordering,
+      "agent_ordering",
+      "The order in which the allocator visits agents when allocating\n"
+      "their resources. May be one of:\n"
+      "  random: agents are visited in a random order.\n"
+      "  bin_packing: most allocated agents first, which leaves whole\n"
+      "    agents free for large tasks and lets idle agents be drained.\n"
+      "  spread: least allocated agents first.\n"
+      "  locality:<name>: agents are grouped by the value of their\n"
+      "    attribute <name> (e.g., `locality:rack`) and bin packed within\n"
+      "    each group.",
+      "random",
+      [](const string& value) -> Option<Error> {
+        Try<AgentOrdering*> ordering = AgentOrdering::create(value);
+        if (ordering.isError()) {
+          return Error(
+              "Invalid `--agent_ordering`: " + ordering.error());
+        }
+
+        delete ordering.get();
+        return None();
+      });
+
+  add(&Flags::coalesce_agent_updates,
+      "coalesce_agent_updates",
+      "If true, the updates of the agents' total oversubscribed resources\n"
+      "are coalesced: only the latest update of each agent is applied, and\n"
+      "the updates of all agents are applied together once per\n"
+      "`--allocation_interval`, rather than each triggering an allocation.",
+      false);
+
   add(&Flags::cluster,
       "cluster",
       "Human readable name for the cluster, displayed in the webui.");
@@ -443,6 +521,21 @@ mesos::internal::master::Flags::Flags()
       "or load an alternate authenticator module using `--modules`.",
       DEFAULT_AUTHENTICATOR);
 
+  add(&Flags::max_concurrent_authentications,
+      "max_concurrent_authentications",
+      "If set, the maximum number of authentications of frameworks and\n"
+      "agents the master performs at once. Further authentication\n"
+      "requests are queued up and served in the order they arrived. This\n"
+      "bounds the work of the authenticator when many agents reconnect at\n"
+      "once, e.g., after a master failover.",
+      [](const Option<size_t>& value) -> Option<Error> {
+        if (value.isSome() && value.get() < 1) {
+          return Error(
+              "Expected `--max_concurrent_authentications` to be at least 1");
+        }
+        return None();
+      });
+
   add(&Flags::allocator,
       "allocator",
       "Allocator to use for resource allocation to frameworks.\n"
@@ -450,6 +543,14 @@ mesos::internal::master::Flags::Flags()
       "load an alternate allocator module using `--modules`.",
       DEFAULT_ALLOCATOR);
 
+  add(&Flags::allocator_trace,
+      "allocator_trace",
+      "Path of a file to record every call to the allocator to, e.g., to\n"
+      "replay the calls against the allocator with\n"
+      "`mesos-allocator-replay` and measure its allocation cycles. The\n"
+      "calls are buffered, so the most recent ones are only written out\n"
+      "when the master exits. The file is truncated on startup.");
+
   add(&Flags::fair_sharing_excluded_resource_names,
       "fair_sharing_excluded_resource_names",
       "A comma-separated list of the resource names (e.g. 'gpus')\n"
@@ -512,6 +613,36 @@ mesos::internal::master::Flags::Flags()
       "Currently there's no support for multiple authorizers.",
       DEFAULT_AUTHORIZER);
 
+  add(&Flags::authorization_cache_ttl,
+      "authorization_cache_ttl",
+      "If set, the decisions of the authorizer are cached for this long\n"
+      "(e.g., `10secs`). A decision is only reused for an identical\n"
+      "request, i.e., the same subject, action and object. This avoids\n"
+      "repeated round trips to authorizer modules backed by a remote\n"
+      "service, at the cost of policy changes taking effect only once the\n"
+      "cached decisions expired.",
+      [](const Option<Duration>& value) -> Option<Error> {
+        if (value.isSome() && value.get() <= Duration::zero()) {
+          return Error(
+              "Expected `--authorization_cache_ttl` to be positive");
+        }
+        return None();
+      });
+
+  add(&Flags::authorization_cache_capacity,
+      "authorization_cache_capacity",
+      "The maximum number of authorization decisions cached when\n"
+      "`--authorization_cache_ttl` is set. The least recently used\n"
+      "decisions are evicted first.",
+      DEFAULT_AUTHORIZATION_CACHE_CAPACITY,
+      [](size_t value) -> Option<Error> {
+        if (value < 1) {
+          return Error(
+              "Expected `--authorization_cache_capacity` to be at least 1");
+        }
+        return None();
+      });
+
   add(&Flags::http_authenticators,
       "http_authenticators",
       "HTTP authenticator implementation to use when handling requests to\n"
@@ -543,6 +674,25 @@ mesos::internal::master::Flags::Flags()
       "Maximum number of completed tasks per framework to store in memory.",
       DEFAULT_MAX_COMPLETED_TASKS_PER_FRAMEWORK);
 
+  add(&Flags::max_completed_task_bytes_per_framework,
+      "max_completed_task_bytes_per_framework",
+      "If set, the maximum size of the completed tasks per framework to\n"
+      "store in memory (e.g., `10MB`), in addition to\n"
+      "`--max_completed_tasks_per_framework`. The oldest completed tasks\n"
+      "are dropped first. Unlike the number of tasks, this bounds the\n"
+      "memory of frameworks whose tasks are large (e.g., due to many\n"
+      "labels).");
+
+  add(&Flags::max_operator_event_history,
+      "max_operator_event_history",
+      "Maximum number of the most recent events of the operator API to\n"
+      "store in memory. Operator API subscribers that reconnect to the\n"
+      "same master can resume from any of these events (see\n"
+      "`Call.Subscribe.resume`) instead of starting with a snapshot of the\n"
+      "state. If 0, the events are only created while there are\n"
+      "subscribers and subscriptions cannot be resumed.",
+      DEFAULT_MAX_OPERATOR_EVENT_HISTORY);
+
   add(&Flags::max_unreachable_tasks_per_framework,
       "max_unreachable_tasks_per_framework",
       "Maximum number of unreachable tasks per framework to store in memory.",
@@ -19,6 +19,7 @@
 
 #include <string>
 
+#include <stout/bytes.hpp>
 #include <stout/duration.hpp>
 #include <stout/option.hpp>
 #include <stout/path.hpp>
@@ -52,6 +53,8 @@ public:
   bool registry_strict;
   Duration registry_fetch_timeout;
   Duration registry_store_timeout;
+  Duration registry_batch_interval;
+  size_t registry_max_batch_size;
   bool log_auto_initialize;
   Duration agent_reregister_timeout;
   std::string recovery_agent_removal_limit;
@@ -61,6 +64,10 @@ public:
   std::string user_sorter;
   std::string framework_sorter;
   Duration allocation_interval;
+  size_t allocation_partitions;
+  Option<Duration> allocation_sweep_interval;
+  std::string agent_ordering;
+  bool coalesce_agent_updates;
   Option<std::string> cluster;
   Option<std::string> roles;
   Option<std::string> weights;
@@ -78,15 +85,21 @@ public:
   Option<std::string> modulesDir;
   std::string authenticators;
   std::string allocator;
+  Option<std::string> allocator_trace;
   Option<std::set<std::string>> fair_sharing_excluded_resource_names;
   Option<std::string> hooks;
   Duration agent_ping_timeout;
   size_t max_agent_ping_timeouts;
+  Option<size_t> max_concurrent_authentications;
   std::string authorizers;
+  Option<Duration> authorization_cache_ttl;
+  size_t authorization_cache_capacity;
   std::string http_authenticators;
   Option<std::string> http_framework_authenticators;
   size_t max_completed_frameworks;
   size_t max_completed_tasks_per_framework;
+  Option<Bytes> max_completed_task_bytes_per_framework;
+  size_t max_operator_event_history;
   size_t max_unreachable_tasks_per_framework;
   Option<std::string> master_contender;
   Option<std::string> master_detector;
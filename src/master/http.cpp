@@ -36,6 +36,7 @@
 
 #include <mesos/v1/master/master.hpp>
 
+#include <process/async.hpp>
 #include <process/collect.hpp>
 #include <process/defer.hpp>
 #include <process/help.hpp>
@@ -46,6 +47,8 @@
 #include <stout/base64.hpp>
 #include <stout/errorbase.hpp>
 #include <stout/foreach.hpp>
+#include <stout/format.hpp>
+#include <stout/gzip.hpp>
 #include <stout/hashmap.hpp>
 #include <stout/hashset.hpp>
 #include <stout/json.hpp>
@@ -151,7 +154,8 @@ static void json(JSON::ObjectWriter* writer, const MasterInfo& info)
 }
 
 
-static void json(JSON::ObjectWriter* writer, const SlaveInfo& slaveInfo)
+template <typename Writer>
+static void writeSlaveInfo(Writer* writer, const SlaveInfo& slaveInfo)
 {
   writer->field("id", slaveInfo.id().value());
   writer->field("hostname", slaveInfo.hostname());
@@ -159,6 +163,12 @@ static void json(JSON::ObjectWriter* writer, const SlaveInfo& slaveInfo)
   writer->field("attributes", Attributes(slaveInfo.attributes()));
 }
 
+
+static void json(JSON::ObjectWriter* writer, const SlaveInfo& slaveInfo)
+{
+  writeSlaveInfo(writer, slaveInfo);
+}
+
 namespace internal {
 namespace master {
 
@@ -169,6 +179,24 @@ using mesos::internal::model;
 using process::http::Response;
 using process::http::Request;
 using process::Owned;
+using process::Shared;
+
+
+// Serializes the unversioned response as a `v1::master::Response` based
+// on the HTTP content type. Since the unversioned and `v1` protobufs are
+// wire compatible, protobuf responses are serialized directly instead
+// of materializing a `v1` copy of the response via `evolve()`; only the
+// JSON serialization needs the `v1` field names.
+static string serializeV1(
+    ContentType contentType,
+    const mesos::master::Response& response)
+{
+  if (contentType == ContentType::PROTOBUF) {
+    return response.SerializeAsString();
+  }
+
+  return serializeV1(contentType, response);
+}
 
 
 // The summary representation of `T` to support the `/state-summary` endpoint.
@@ -190,24 +218,126 @@ struct Full : Representation<T>
 
 
 // Forward declaration for `FullFrameworkWriter`.
-static void json(JSON::ObjectWriter* writer, const Summary<Framework>& summary);
+template <typename Writer>
+static void writeSummary(Writer* writer, const Framework& framework);
+
+
+// The query parameters of the `/state` and `/tasks` endpoints which
+// select the fields and the frameworks and tasks to serialize.
+struct StateQuery
+{
+  static Try<StateQuery> parse(const Request& request);
+
+  // Returns true if the query selects everything.
+  bool empty() const
+  {
+    return fields.selectsAll() &&
+           frameworkId.isNone() &&
+           role.isNone() &&
+           state.isNone();
+  }
+
+  bool selects(const Framework& framework) const;
+
+  bool selects(TaskState taskState) const
+  {
+    return state.isNone() || state.get() == taskState;
+  }
+
+  FieldProjection fields;
+  Option<FrameworkID> frameworkId;
+  Option<string> role;
+  Option<TaskState> state;
+};
+
+
+Try<StateQuery> StateQuery::parse(const Request& request)
+{
+  StateQuery query;
+
+  Option<string> fields = request.url.query.get("fields");
+  if (fields.isSome()) {
+    query.fields = FieldProjection::parse(fields.get());
+  }
+
+  Option<string> frameworkId = request.url.query.get("framework_id");
+  if (frameworkId.isSome()) {
+    query.frameworkId = FrameworkID();
+    query.frameworkId->set_value(frameworkId.get());
+  }
+
+  query.role = request.url.query.get("role");
+
+  Option<string> state = request.url.query.get("state");
+  if (state.isSome()) {
+    TaskState taskState;
+    if (!TaskState_Parse(state.get(), &taskState)) {
+      return Error("Unknown task state '" + state.get() + "'");
+    }
+
+    query.state = taskState;
+  }
+
+  return query;
+}
+
+
+bool StateQuery::selects(const Framework& framework) const
+{
+  if (frameworkId.isSome() && frameworkId.get() != framework.id()) {
+    return false;
+  }
+
+  if (role.isSome() &&
+      protobuf::framework::getRoles(framework.info).count(role.get()) == 0) {
+    return false;
+  }
+
+  return true;
+}
+
+
+// Writes the task as an element of the array, with only the fields
+// selected by the projection.
+static void writeTaskElement(
+    JSON::ArrayWriter* writer,
+    const Task& task,
+    const FieldProjection& fields)
+{
+  if (fields.selectsAll()) {
+    writer->element(task);
+    return;
+  }
+
+  writer->element([&task, &fields](JSON::ObjectWriter* writer) {
+    ProjectedObjectWriter projected(writer, fields);
+    writeTask(&projected, task);
+  });
+}
 
 
 // Filtered representation of Full<Framework>.
 // Executors and Tasks are filtered based on whether the
-// user is authorized to view them.
+// user is authorized to view them, and on the `query`.
 struct FullFrameworkWriter {
   FullFrameworkWriter(
       const Owned<ObjectApprover>& taskApprover,
       const Owned<ObjectApprover>& executorApprover,
-      const Framework* framework)
+      const Framework* framework,
+      const FieldProjection& fields = FieldProjection::all(),
+      const Option<TaskState>& state = None())
     : taskApprover_(taskApprover),
       executorApprover_(executorApprover),
-      framework_(framework) {}
+      framework_(framework),
+      fields_(fields),
+      state_(state) {}
 
-  void operator()(JSON::ObjectWriter* writer) const
+  void operator()(JSON::ObjectWriter* objectWriter) const
   {
-    json(writer, Summary<Framework>(*framework_));
+    ProjectedObjectWriter projected(objectWriter, fields_);
+    ProjectedObjectWriter* writer = &projected;
+
+    writeSummary(writer, *framework_);
 
     // Add additional fields to those generated by the
     // `Summary<Framework>` overload.
@@ -245,69 +375,87 @@ struct FullFrameworkWriter {
 
     // Model all of the tasks associated with a framework.
     writer->field("tasks", [this](JSON::ArrayWriter* writer) {
-      foreachvalue (const TaskInfo& taskInfo, framework_->pendingTasks) {
-        // Skip unauthorized tasks.
-        if (!approveViewTaskInfo(taskApprover_, taskInfo, framework_->info)) {
-          continue;
-        }
+      const FieldProjection& fields = fields_.at("tasks");
 
-        writer->element([this, &taskInfo](JSON::ObjectWriter* writer) {
-          writer->field("id", taskInfo.task_id().value());
-          writer->field("name", taskInfo.name());
-          writer->field("framework_id", framework_->id().value());
+      if (state_.isNone() || state_.get() == TASK_STAGING) {
+        foreachvalue (const TaskInfo& taskInfo, framework_->pendingTasks) {
+          // Skip unauthorized tasks.
+          if (!approveViewTaskInfo(
+                  taskApprover_, taskInfo, framework_->info)) {
+            continue;
+          }
 
-          writer->field(
-            "executor_id",
-            taskInfo.executor().executor_id().value());
+          writer->element([this, &taskInfo, &fields](
+              JSON::ObjectWriter* objectWriter) {
+            ProjectedObjectWriter projected(objectWriter, fields);
+            ProjectedObjectWriter* writer = &projected;
 
-          writer->field("slave_id", taskInfo.slave_id().value());
-          writer->field("state", TaskState_Name(TASK_STAGING));
-          writer->field("resources", Resources(taskInfo.resources()));
-          writer->field("statuses", std::initializer_list<TaskStatus>{});
+            writer->field("id", taskInfo.task_id().value());
+            writer->field("name", taskInfo.name());
+            writer->field("framework_id", framework_->id().value());
 
-          if (taskInfo.has_labels()) {
-            writer->field("labels", taskInfo.labels());
-          }
+            writer->field(
+              "executor_id",
+              taskInfo.executor().executor_id().value());
 
-          if (taskInfo.has_discovery()) {
-            writer->field("discovery", JSON::Protobuf(taskInfo.discovery()));
-          }
+            writer->field("slave_id", taskInfo.slave_id().value());
+            writer->field("state", TaskState_Name(TASK_STAGING));
+            writer->field("resources", Resources(taskInfo.resources()));
+            writer->field("statuses", std::initializer_list<TaskStatus>{});
 
-          if (taskInfo.has_container()) {
-            writer->field("container", JSON::Protobuf(taskInfo.container()));
-          }
-        });
+            if (taskInfo.has_labels()) {
+              writer->field("labels", taskInfo.labels());
+            }
+
+            if (taskInfo.has_discovery()) {
+              writer->field(
+                  "discovery", JSON::Protobuf(taskInfo.discovery()));
+            }
+
+            if (taskInfo.has_container()) {
+              writer->field(
+                  "container", JSON::Protobuf(taskInfo.container()));
+            }
+          });
+        }
       }
 
       foreachvalue (Task* task, framework_->tasks) {
         // Skip unauthorized tasks.
-        if (!approveViewTask(taskApprover_, *task, framework_->info)) {
+        if (!selects(*task) ||
+            !approveViewTask(taskApprover_, *task, framework_->info)) {
           continue;
         }
 
-        writer->element(*task);
+        writeTaskElement(writer, *task, fields);
       }
     });
 
     writer->field("unreachable_tasks", [this](JSON::ArrayWriter* writer) {
+      const FieldProjection& fields = fields_.at("unreachable_tasks");
+
       foreachvalue (const Owned<Task>& task, framework_->unreachableTasks) {
         // Skip unauthorized tasks.
-        if (!approveViewTask(taskApprover_, *task.get(), framework_->info)) {
+        if (!selects(*task) ||
+            !approveViewTask(taskApprover_, *task.get(), framework_->info)) {
           continue;
         }
 
-        writer->element(*task.get());
+        writeTaskElement(writer, *task.get(), fields);
       }
     });
 
     writer->field("completed_tasks", [this](JSON::ArrayWriter* writer) {
+      const FieldProjection& fields = fields_.at("completed_tasks");
+
       foreach (const Owned<Task>& task, framework_->completedTasks) {
         // Skip unauthorized tasks.
-        if (!approveViewTask(taskApprover_, *task.get(), framework_->info)) {
+        if (!selects(*task) ||
+            !approveViewTask(taskApprover_, *task.get(), framework_->info)) {
           continue;
         }
 
-        writer->element(*task.get());
+        writeTaskElement(writer, *task.get(), fields);
       }
     });
 
@@ -349,17 +497,23 @@ struct FullFrameworkWriter {
     }
   }
 
+  bool selects(const Task& task) const
+  {
+    return state_.isNone() || state_.get() == task.state();
+  }
+
   const Owned<ObjectApprover>& taskApprover_;
   const Owned<ObjectApprover>& executorApprover_;
   const Framework* framework_;
+  const FieldProjection& fields_;
+  const Option<TaskState> state_;
 };
 
 
-static void json(JSON::ObjectWriter* writer, const Summary<Slave>& summary)
+template <typename Writer>
+static void writeSummary(Writer* writer, const Slave& slave)
 {
-  const Slave& slave = summary;
-
-  json(writer, slave.info);
+  writeSlaveInfo(writer, slave.info);
 
   writer->field("pid", string(slave.pid));
   writer->field("registered_time", slave.registeredTime.secs());
@@ -380,6 +534,12 @@ static void json(JSON::ObjectWriter* writer, const Summary<Slave>& summary)
 }
 
 
+static void json(JSON::ObjectWriter* writer, const Summary<Slave>& summary)
+{
+  writeSummary(writer, summary.get());
+}
+
+
 static void json(JSON::ObjectWriter* writer, const Full<Slave>& full)
 {
   const Slave& slave = full;
@@ -388,10 +548,9 @@ static void json(JSON::ObjectWriter* writer, const Full<Slave>& full)
 }
 
 
-static void json(JSON::ObjectWriter* writer, const Summary<Framework>& summary)
+template <typename Writer>
+static void writeSummary(Writer* writer, const Framework& framework)
 {
-  const Framework& framework = summary;
-
   writer->field("id", framework.id().value());
   writer->field("name", framework.info.name());
 
@@ -412,6 +571,12 @@ static void json(JSON::ObjectWriter* writer, const Summary<Framework>& summary)
 }
 
 
+static void json(JSON::ObjectWriter* writer, const Summary<Framework>& summary)
+{
+  writeSummary(writer, summary.get());
+}
+
+
 void Master::Http::log(const Request& request)
 {
   Option<string> userAgent = request.headers.get("User-Agent");
@@ -686,18 +851,56 @@ Future<Response> Master::Http::subscribe(
       ok.type = Response::PIPE;
       ok.reader = pipe.reader();
 
+      const mesos::master::Call::Subscribe& subscribe = call.subscribe();
+      const Master::Subscribers& subscribers = master->subscribers;
+
+      // The subscription can be resumed if this master still retains
+      // every event that followed the one it is resumed after.
+      bool resumed = false;
+      if (subscribe.has_resume() &&
+          subscribe.resume().master_id() == master->info().id() &&
+          subscribe.resume().sequence() <= subscribers.sequence) {
+        resumed = subscribe.resume().sequence() >=
+          subscribers.sequence - subscribers.history.size();
+      }
+
       HttpConnection http {pipe.writer(), contentType, UUID::random()};
-      master->subscribe(http);
+      master->subscribe(http, subscribe);
 
       mesos::master::Event event;
       event.set_type(mesos::master::Event::SUBSCRIBED);
-      event.mutable_subscribed()->mutable_get_state()->CopyFrom(
-        _getState(frameworksApprover,
-                  tasksApprover,
-                  executorsApprover));
+
+      mesos::master::Event::Subscribed* subscribed =
+        event.mutable_subscribed();
+
+      subscribed->set_master_id(master->info().id());
+      subscribed->set_resumed(resumed);
+
+      if (resumed) {
+        subscribed->set_sequence(subscribe.resume().sequence());
+      } else {
+        subscribed->set_sequence(subscribers.sequence);
+        subscribed->mutable_get_state()->CopyFrom(
+          _getState(frameworksApprover,
+                    tasksApprover,
+                    executorsApprover));
+      }
 
       http.send<mesos::master::Event, v1::master::Event>(event);
 
+      if (resumed) {
+        const Owned<Master::Subscribers::Subscriber>& subscriber =
+          subscribers.subscribed.at(http.streamId);
+
+        foreach (const Master::Subscribers::Record& record,
+                 subscribers.history) {
+          if (record.event.sequence() > subscribe.resume().sequence() &&
+              subscriber->accepts(record)) {
+            http.send<mesos::master::Event, v1::master::Event>(record.event);
+          }
+        }
+      }
+
       return ok;
     }));
 }
@@ -933,6 +1136,10 @@ Future<Response> Master::Http::scheduler(
       master->acknowledge(framework, call.acknowledge());
       return Accepted();
 
+    case scheduler::Call::ACKNOWLEDGE_BATCH:
+      master->acknowledge(framework, call.acknowledge_batch());
+      return Accepted();
+
     case scheduler::Call::RECONCILE:
       master->reconcile(framework, call.reconcile());
       return Accepted();
@@ -1400,7 +1607,7 @@ Future<Response> Master::Http::frameworks(
         });
       };
 
-      return OK(jsonify(frameworks), request.url.query.get("jsonp"));
+      return jsonResponse(request, jsonify(frameworks));
   }));
 }
 
@@ -1480,10 +1687,13 @@ Future<Response> Master::Http::getFrameworks(
           -> Future<Response> {
       mesos::master::Response response;
       response.set_type(mesos::master::Response::GET_FRAMEWORKS);
-      response.mutable_get_frameworks()->CopyFrom(
-          _getFrameworks(frameworksApprover));
 
-      return OK(serialize(contentType, evolve(response)),
+      mesos::master::Response::GetFrameworks frameworks =
+        _getFrameworks(frameworksApprover);
+
+      response.mutable_get_frameworks()->Swap(&frameworks);
+
+      return OK(serializeV1(contentType, response),
                 stringify(contentType));
     }));
 }
@@ -1559,7 +1769,7 @@ Future<Response> Master::Http::getExecutors(
       response.mutable_get_executors()->CopyFrom(
           _getExecutors(frameworksApprover, executorsApprover));
 
-      return OK(serialize(contentType, evolve(response)),
+      return OK(serializeV1(contentType, response),
                 stringify(contentType));
     }));
 }
@@ -1692,12 +1902,14 @@ Future<Response> Master::Http::getState(
 
       mesos::master::Response response;
       response.set_type(mesos::master::Response::GET_STATE);
-      response.mutable_get_state()->CopyFrom(
-          _getState(frameworksApprover,
-                    tasksApprover,
-                    executorsApprover));
 
-      return OK(serialize(contentType, evolve(response)),
+      // The state is swapped into the response rather than copied.
+      mesos::master::Response::GetState state =
+        _getState(frameworksApprover, tasksApprover, executorsApprover);
+
+      response.mutable_get_state()->Swap(&state);
+
+      return OK(serializeV1(contentType, response),
                 stringify(contentType));
     }));
 }
@@ -1715,16 +1927,22 @@ mesos::master::Response::GetState Master::Http::_getState(
 
   mesos::master::Response::GetState getState;
 
-  getState.mutable_get_tasks()->CopyFrom(
-    _getTasks(frameworksApprover, tasksApprover));
+  // The parts of the state are swapped in rather than copied, since
+  // they can be large.
+  mesos::master::Response::GetTasks tasks =
+    _getTasks(frameworksApprover, tasksApprover);
+  getState.mutable_get_tasks()->Swap(&tasks);
 
-  getState.mutable_get_executors()->CopyFrom(
-    _getExecutors(frameworksApprover, executorsApprover));
+  mesos::master::Response::GetExecutors executors =
+    _getExecutors(frameworksApprover, executorsApprover);
+  getState.mutable_get_executors()->Swap(&executors);
 
-  getState.mutable_get_frameworks()->CopyFrom(
-    _getFrameworks(frameworksApprover));
+  mesos::master::Response::GetFrameworks frameworks =
+    _getFrameworks(frameworksApprover);
+  getState.mutable_get_frameworks()->Swap(&frameworks);
 
-  getState.mutable_get_agents()->CopyFrom(_getAgents());
+  mesos::master::Response::GetAgents agents = _getAgents();
+  getState.mutable_get_agents()->Swap(&agents);
 
   return getState;
 }
@@ -1894,7 +2112,7 @@ Future<Response> Master::Http::getHealth(
   response.set_type(mesos::master::Response::GET_HEALTH);
   response.mutable_get_health()->set_healthy(true);
 
-  return OK(serialize(contentType, evolve(response)),
+  return OK(serializeV1(contentType, response),
             stringify(contentType));
 }
 
@@ -1938,7 +2156,7 @@ Future<Response> Master::Http::getMetrics(
           metric->set_value(value);
         }
 
-        return OK(serialize(contentType, evolve(response)),
+        return OK(serializeV1(contentType, response),
                   stringify(contentType));
       });
 }
@@ -1955,7 +2173,7 @@ Future<Response> Master::Http::getLoggingLevel(
   response.set_type(mesos::master::Response::GET_LOGGING_LEVEL);
   response.mutable_get_logging_level()->set_level(FLAGS_v);
 
-  return OK(serialize(contentType, evolve(response)),
+  return OK(serializeV1(contentType, response),
             stringify(contentType));
 }
 
@@ -1995,7 +2213,7 @@ Future<Response> Master::Http::getMaster(
   response.mutable_get_master()->mutable_master_info()->CopyFrom(
       master->info());
 
-  return OK(serialize(contentType, evolve(response)),
+  return OK(serializeV1(contentType, response),
             stringify(contentType));
 }
 
@@ -2316,7 +2534,7 @@ Future<Response> Master::Http::slaves(
     });
   };
 
-  return OK(jsonify(slaves), request.url.query.get("jsonp"));
+  return jsonResponse(request, jsonify(slaves));
 }
 
 
@@ -2331,7 +2549,7 @@ Future<process::http::Response> Master::Http::getAgents(
   response.set_type(mesos::master::Response::GET_AGENTS);
   response.mutable_get_agents()->CopyFrom(_getAgents());
 
-  return OK(serialize(contentType, evolve(response)),
+  return OK(serializeV1(contentType, response),
             stringify(contentType));
 }
 
@@ -2463,6 +2681,8 @@ string Master::Http::STATE_HELP()
         "Information about state of master."),
     DESCRIPTION(
         "Returns 200 OK when the state of the master was queried successfully.",
+        "Returns 304 NOT_MODIFIED when the `If-None-Match` header of the",
+        "request matches the `ETag` of the current state.",
         "Returns 307 TEMPORARY_REDIRECT redirect to the leading master when",
         "current master is not the leader.",
         "Returns 503 SERVICE_UNAVAILABLE if the leading master cannot be",
@@ -2472,6 +2692,25 @@ string Master::Http::STATE_HELP()
         "The information shown might be filtered based on the user",
         "accessing the endpoint.",
         "",
+        "Each response carries an `ETag` header which changes whenever",
+        "the frameworks, tasks, executors or agents change, so that",
+        "clients polling this endpoint can avoid transferring a state",
+        "they already have.",
+        "",
+        "Query parameters:",
+        "",
+        ">        fields=VALUE         Comma separated list of the fields "
+        "to return, e.g., `frameworks.id,frameworks.tasks.state`.",
+        ">        framework_id=VALUE   Only returns this framework.",
+        ">        role=VALUE           Only returns the frameworks "
+        "subscribed to this role.",
+        ">        state=VALUE          Only returns the tasks in this state, "
+        "e.g., `TASK_RUNNING`.",
+        "",
+        "Selecting a field selects all of the fields below it. The",
+        "fields and tasks which are not selected are not serialized,",
+        "which makes these queries much cheaper than the full state.",
+        "",
         "Example (**Note**: this is not exhaustive):",
         "",
         "```",
@@ -2559,6 +2798,39 @@ Future<Response> Master::Http::state(
     return redirect(request);
   }
 
+  Try<StateQuery> query = StateQuery::parse(request);
+  if (query.isError()) {
+    return BadRequest(query.error());
+  }
+
+  if (stateNotModified(request)) {
+    Response response(process::http::Status::NOT_MODIFIED);
+    response.headers["ETag"] = stateETag();
+    return response;
+  }
+
+  // Without an authorizer the state is the same for every principal,
+  // so a snapshot of the full state can be reused until it changes.
+  if (master->authorizer.isNone() && query->empty()) {
+    if (master->cachedState.isNone() ||
+        master->cachedState->generation != master->stateGeneration) {
+      Master::CachedState cachedState;
+      cachedState.generation = master->stateGeneration;
+      cachedState.body = snapshotState();
+
+      master->cachedState = cachedState;
+    }
+
+    const string etag = stateETag();
+    const Option<string> jsonp = request.url.query.get("jsonp");
+    const bool acceptsGzip = request.acceptsEncoding("gzip");
+
+    return master->cachedState->body
+      .then([=](const Shared<Master::StateBody>& body) -> Response {
+        return stateResponse(*body, etag, jsonp, acceptsGzip);
+      });
+  }
+
   // Retrieve `ObjectApprover`s for authorizing frameworks and tasks.
   Future<Owned<ObjectApprover>> frameworksApprover;
   Future<Owned<ObjectApprover>> tasksApprover;
@@ -2596,14 +2868,18 @@ Future<Response> Master::Http::state(
       flagsApprover)
     .then(defer(
         master->self(),
-        [this, request](const tuple<Owned<ObjectApprover>,
-                                    Owned<ObjectApprover>,
-                                    Owned<ObjectApprover>,
-                                    Owned<ObjectApprover>>& approvers)
+        [this, request, query](const tuple<Owned<ObjectApprover>,
+                                           Owned<ObjectApprover>,
+                                           Owned<ObjectApprover>,
+                                           Owned<ObjectApprover>>& approvers)
           -> Response {
       // This lambda is consumed before the outer lambda
       // returns, hence capture by reference is fine here.
-      auto state = [this, &approvers](JSON::ObjectWriter* writer) {
+      auto state = [this, &approvers, &query](
+          JSON::ObjectWriter* objectWriter) {
+        ProjectedObjectWriter projected(objectWriter, query->fields);
+        ProjectedObjectWriter* writer = &projected;
+
         // Get approver from tuple.
         Owned<ObjectApprover> frameworksApprover;
         Owned<ObjectApprover> tasksApprover;
@@ -2614,83 +2890,21 @@ Future<Response> Master::Http::state(
             executorsApprover,
             flagsApprover) = approvers;
 
-        writer->field("version", MESOS_VERSION);
-
-        if (build::GIT_SHA.isSome()) {
-          writer->field("git_sha", build::GIT_SHA.get());
-        }
-
-        if (build::GIT_BRANCH.isSome()) {
-          writer->field("git_branch", build::GIT_BRANCH.get());
-        }
-
-        if (build::GIT_TAG.isSome()) {
-          writer->field("git_tag", build::GIT_TAG.get());
-        }
-
-        writer->field("build_date", build::DATE);
-        writer->field("build_time", build::TIME);
-        writer->field("build_user", build::USER);
-        writer->field("start_time", master->startTime.secs());
-
-        if (master->electedTime.isSome()) {
-          writer->field("elected_time", master->electedTime.get().secs());
-        }
-
-        writer->field("id", master->info().id());
-        writer->field("pid", string(master->self()));
-        writer->field("hostname", master->info().hostname());
-        writer->field("activated_slaves", master->_slaves_active());
-        writer->field("deactivated_slaves", master->_slaves_inactive());
-        writer->field("unreachable_slaves", master->_slaves_unreachable());
-
-        // TODO(haosdent): Deprecated this in favor of `leader_info` below.
-        if (master->leader.isSome()) {
-          writer->field("leader", master->leader.get().pid());
-        }
-
-        if (master->leader.isSome()) {
-          writer->field("leader_info", [this](JSON::ObjectWriter* writer) {
-            json(writer, master->leader.get());
-          });
-        }
-
-        if (approveViewFlags(flagsApprover)) {
-          if (master->flags.cluster.isSome()) {
-            writer->field("cluster", master->flags.cluster.get());
-          }
-
-          if (master->flags.log_dir.isSome()) {
-            writer->field("log_dir", master->flags.log_dir.get());
-          }
-
-          if (master->flags.external_log_file.isSome()) {
-            writer->field("external_log_file",
-                          master->flags.external_log_file.get());
-          }
-
-          writer->field("flags", [this](JSON::ObjectWriter* writer) {
-              foreachvalue (const flags::Flag& flag, master->flags) {
-                Option<string> value = flag.stringify(master->flags);
-                if (value.isSome()) {
-                  writer->field(flag.effective_name().value, value.get());
-                }
-              }
-            });
-        }
+        writeStateFields(objectWriter, flagsApprover, query->fields);
 
         // Model all of the registered slaves.
-        writer->field("slaves", [this](JSON::ArrayWriter* writer) {
+        writer->field("slaves", [this, &query](JSON::ArrayWriter* writer) {
+          const FieldProjection& fields = query->fields.at("slaves");
+
           foreachvalue (Slave* slave, master->slaves.registered) {
-            writer->element(Full<Slave>(*slave));
-          }
-        });
+            if (fields.selectsAll()) {
+              writer->element(Full<Slave>(*slave));
+              continue;
+            }
 
-        // Model all of the recovered slaves.
-        writer->field("recovered_slaves", [this](JSON::ArrayWriter* writer) {
-          foreachvalue (const SlaveInfo& slaveInfo, master->slaves.recovered) {
-            writer->element([&slaveInfo](JSON::ObjectWriter* writer) {
-              json(writer, slaveInfo);
+            writer->element([slave, &fields](JSON::ObjectWriter* writer) {
+              ProjectedObjectWriter projected(writer, fields);
+              writeSummary(&projected, *slave);
             });
           }
         });
@@ -2698,19 +2912,27 @@ Future<Response> Master::Http::state(
         // Model all of the frameworks.
         writer->field(
             "frameworks",
-            [this, &frameworksApprover, &executorsApprover, &tasksApprover](
-                JSON::ArrayWriter* writer) {
+            [this,
+             &frameworksApprover,
+             &executorsApprover,
+             &tasksApprover,
+             &query](JSON::ArrayWriter* writer) {
               foreachvalue (
                   Framework* framework,
                   master->frameworks.registered) {
-                // Skip unauthorized frameworks.
-                if (!approveViewFrameworkInfo(
+                // Skip unauthorized and unselected frameworks.
+                if (!query->selects(*framework) ||
+                    !approveViewFrameworkInfo(
                         frameworksApprover, framework->info)) {
                   continue;
                 }
 
                 auto frameworkWriter = FullFrameworkWriter(
-                    tasksApprover, executorsApprover, framework);
+                    tasksApprover,
+                    executorsApprover,
+                    framework,
+                    query->fields.at("frameworks"),
+                    query->state);
 
                 writer->element(frameworkWriter);
               }
@@ -2719,77 +2941,356 @@ Future<Response> Master::Http::state(
         // Model all of the completed frameworks.
         writer->field(
             "completed_frameworks",
-            [this, &frameworksApprover, &executorsApprover, &tasksApprover](
-                JSON::ArrayWriter* writer) {
+            [this,
+             &frameworksApprover,
+             &executorsApprover,
+             &tasksApprover,
+             &query](JSON::ArrayWriter* writer) {
               foreachvalue (const Owned<Framework>& framework,
                             master->frameworks.completed) {
-                // Skip unauthorized frameworks.
-                if (!approveViewFrameworkInfo(
-                    frameworksApprover, framework->info)) {
+                // Skip unauthorized and unselected frameworks.
+                if (!query->selects(*framework) ||
+                    !approveViewFrameworkInfo(
+                        frameworksApprover, framework->info)) {
                   continue;
                 }
 
                 auto frameworkWriter = FullFrameworkWriter(
-                    tasksApprover, executorsApprover, framework.get());
+                    tasksApprover,
+                    executorsApprover,
+                    framework.get(),
+                    query->fields.at("completed_frameworks"),
+                    query->state);
 
                 writer->element(frameworkWriter);
               }
             });
+      };
 
-        // Model all of the orphan tasks. Such tasks are only possible
-        // if the cluster contains pre-1.0 agents.
-        //
-        // TODO(neilc): Remove this once we break compatibility with
-        // pre-1.0 agents.
-        writer->field("orphan_tasks", [this, &tasksApprover](
-            JSON::ArrayWriter* writer) {
-          foreachvalue (const Slave* slave, master->slaves.registered) {
-            typedef hashmap<TaskID, Task*> TaskMap;
-            foreachvalue (const TaskMap& tasks, slave->tasks) {
-              foreachvalue (const Task* task, tasks) {
-                const FrameworkID& frameworkId = task->framework_id();
-                if (!master->frameworks.registered.contains(frameworkId)) {
-                  // If authorization is enabled, do not show any
-                  // orphan tasks. We need the task's FrameworkInfo to
-                  // authorize it, but if we had its FrameworkInfo, it
-                  // would not be an orphan.
-                  if (master->authorizer.isSome()) {
-                    continue;
-                  }
-
-                  writer->element(*task);
-                }
-              }
-            }
+      Response response = jsonResponse(request, jsonify(state));
+      response.headers["ETag"] = stateETag();
+      return response;
+    }));
+}
+
+
+void Master::Http::writeStateFields(
+    JSON::ObjectWriter* objectWriter,
+    const Owned<ObjectApprover>& flagsApprover,
+    const FieldProjection& fields) const
+{
+  ProjectedObjectWriter projected(objectWriter, fields);
+  ProjectedObjectWriter* writer = &projected;
+
+  writer->field("version", MESOS_VERSION);
+
+  if (build::GIT_SHA.isSome()) {
+    writer->field("git_sha", build::GIT_SHA.get());
+  }
+
+  if (build::GIT_BRANCH.isSome()) {
+    writer->field("git_branch", build::GIT_BRANCH.get());
+  }
+
+  if (build::GIT_TAG.isSome()) {
+    writer->field("git_tag", build::GIT_TAG.get());
+  }
+
+  writer->field("build_date", build::DATE);
+  writer->field("build_time", build::TIME);
+  writer->field("build_user", build::USER);
+  writer->field("start_time", master->startTime.secs());
+
+  if (master->electedTime.isSome()) {
+    writer->field("elected_time", master->electedTime.get().secs());
+  }
+
+  writer->field("id", master->info().id());
+  writer->field("pid", string(master->self()));
+  writer->field("hostname", master->info().hostname());
+  writer->field("activated_slaves", master->_slaves_active());
+  writer->field("deactivated_slaves", master->_slaves_inactive());
+  writer->field("unreachable_slaves", master->_slaves_unreachable());
+
+  // TODO(haosdent): Deprecated this in favor of `leader_info` below.
+  if (master->leader.isSome()) {
+    writer->field("leader", master->leader.get().pid());
+  }
+
+  if (master->leader.isSome()) {
+    writer->field("leader_info", [this](JSON::ObjectWriter* writer) {
+      json(writer, master->leader.get());
+    });
+  }
+
+  if (approveViewFlags(flagsApprover)) {
+    if (master->flags.cluster.isSome()) {
+      writer->field("cluster", master->flags.cluster.get());
+    }
+
+    if (master->flags.log_dir.isSome()) {
+      writer->field("log_dir", master->flags.log_dir.get());
+    }
+
+    if (master->flags.external_log_file.isSome()) {
+      writer->field("external_log_file",
+                    master->flags.external_log_file.get());
+    }
+
+    writer->field("flags", [this](JSON::ObjectWriter* writer) {
+        foreachvalue (const flags::Flag& flag, master->flags) {
+          Option<string> value = flag.stringify(master->flags);
+          if (value.isSome()) {
+            writer->field(flag.effective_name().value, value.get());
           }
-        });
+        }
+      });
+  }
 
-        // Model all unregistered frameworks. Such frameworks are only
-        // possible if the cluster contains pre-1.0 agents.
-        //
-        // TODO(neilc): Remove this once we break compatibility with
-        // pre-1.0 agents.
-        //
-        // TODO(vinod): Need to filter these frameworks based on authorization!
-        // See the TODO above for "orphan_tasks" for further details.
-        writer->field("unregistered_frameworks", [this](
-            JSON::ArrayWriter* writer) {
-          // Find unregistered frameworks.
-          hashset<FrameworkID> frameworkIds;
-          foreachvalue (const Slave* slave, master->slaves.registered) {
-            foreachkey (const FrameworkID& frameworkId, slave->tasks) {
-              if (!master->frameworks.registered.contains(frameworkId) &&
-                  !frameworkIds.contains(frameworkId)) {
-                writer->element(frameworkId.value());
-                frameworkIds.insert(frameworkId);
-              }
+  // Model all of the recovered slaves.
+  writer->field("recovered_slaves", [this](JSON::ArrayWriter* writer) {
+    foreachvalue (const SlaveInfo& slaveInfo, master->slaves.recovered) {
+      writer->element([&slaveInfo](JSON::ObjectWriter* writer) {
+        json(writer, slaveInfo);
+      });
+    }
+  });
+
+  // Model all of the orphan tasks. Such tasks are only possible
+  // if the cluster contains pre-1.0 agents.
+  //
+  // TODO(neilc): Remove this once we break compatibility with
+  // pre-1.0 agents.
+  writer->field("orphan_tasks", [this](
+      JSON::ArrayWriter* writer) {
+    foreachvalue (const Slave* slave, master->slaves.registered) {
+      typedef hashmap<TaskID, Task*> TaskMap;
+      foreachvalue (const TaskMap& tasks, slave->tasks) {
+        foreachvalue (const Task* task, tasks) {
+          const FrameworkID& frameworkId = task->framework_id();
+          if (!master->frameworks.registered.contains(frameworkId)) {
+            // If authorization is enabled, do not show any
+            // orphan tasks. We need the task's FrameworkInfo to
+            // authorize it, but if we had its FrameworkInfo, it
+            // would not be an orphan.
+            if (master->authorizer.isSome()) {
+              continue;
             }
+
+            writer->element(*task);
           }
-        });
-      };
+        }
+      }
+    }
+  });
 
-      return OK(jsonify(state), request.url.query.get("jsonp"));
-    }));
+  // Model all unregistered frameworks. Such frameworks are only
+  // possible if the cluster contains pre-1.0 agents.
+  //
+  // TODO(neilc): Remove this once we break compatibility with
+  // pre-1.0 agents.
+  //
+  // TODO(vinod): Need to filter these frameworks based on authorization!
+  // See the TODO above for "orphan_tasks" for further details.
+  writer->field("unregistered_frameworks", [this](
+      JSON::ArrayWriter* writer) {
+    // Find unregistered frameworks.
+    hashset<FrameworkID> frameworkIds;
+    foreachvalue (const Slave* slave, master->slaves.registered) {
+      foreachkey (const FrameworkID& frameworkId, slave->tasks) {
+        if (!master->frameworks.registered.contains(frameworkId) &&
+            !frameworkIds.contains(frameworkId)) {
+          writer->element(frameworkId.value());
+          frameworkIds.insert(frameworkId);
+        }
+      }
+    }
+  });
+}
+
+
+Future<Shared<Master::StateBody>> Master::Http::snapshotState() const
+{
+  const Owned<ObjectApprover> acceptingApprover(new AcceptingObjectApprover());
+
+  // The fields are serialized as an object, whose closing brace is
+  // dropped so that the agents and frameworks can be appended.
+  string fields = jsonify([this, &acceptingApprover](
+      JSON::ObjectWriter* writer) {
+    writeStateFields(writer, acceptingApprover);
+  });
+
+  CHECK(strings::endsWith(fields, "}"));
+  fields.pop_back();
+
+  // Only the agents and frameworks that changed since the last
+  // snapshot are serialized again; the fragments of those that did not
+  // change are shared with the previous snapshot. The fragments of the
+  // agents and frameworks that were removed are dropped.
+  Master::StateFragments fragments;
+
+  vector<Shared<string>> slaves;
+  foreachpair (const SlaveID& slaveId,
+               Slave* slave,
+               master->slaves.registered) {
+    Option<Master::StateFragment> fragment =
+      master->stateFragments.slaves.get(slaveId);
+
+    if (fragment.isNone() || fragment->generation != slave->stateGeneration) {
+      fragment = Master::StateFragment{
+          slave->stateGeneration,
+          Shared<string>(new string(jsonify(Full<Slave>(*slave))))};
+    }
+
+    fragments.slaves[slaveId] = fragment.get();
+    slaves.push_back(fragment->json);
+  }
+
+  auto frameworkFragment = [&acceptingApprover](
+      const hashmap<FrameworkID, Master::StateFragment>& previous,
+      const Framework* framework) {
+    Option<Master::StateFragment> fragment = previous.get(framework->id());
+
+    if (fragment.isNone() ||
+        fragment->generation != framework->stateGeneration) {
+      auto frameworkWriter = FullFrameworkWriter(
+          acceptingApprover, acceptingApprover, framework);
+
+      fragment = Master::StateFragment{
+          framework->stateGeneration,
+          Shared<string>(new string(jsonify(frameworkWriter)))};
+    }
+
+    return fragment.get();
+  };
+
+  vector<Shared<string>> frameworks;
+  foreachvalue (Framework* framework, master->frameworks.registered) {
+    Master::StateFragment fragment =
+      frameworkFragment(master->stateFragments.frameworks, framework);
+
+    fragments.frameworks[framework->id()] = fragment;
+    frameworks.push_back(fragment.json);
+  }
+
+  vector<Shared<string>> completedFrameworks;
+  foreachvalue (const Owned<Framework>& framework,
+                master->frameworks.completed) {
+    Master::StateFragment fragment = frameworkFragment(
+        master->stateFragments.completedFrameworks, framework.get());
+
+    fragments.completedFrameworks[framework->id()] = fragment;
+    completedFrameworks.push_back(fragment.json);
+  }
+
+  master->stateFragments = fragments;
+
+  return process::async(
+      [fields, slaves, frameworks, completedFrameworks]() {
+        return Shared<Master::StateBody>(new Master::StateBody(
+            assembleState(fields, slaves, frameworks, completedFrameworks)));
+      });
+}
+
+
+Master::StateBody Master::Http::assembleState(
+    const string& fields,
+    const vector<Shared<string>>& slaves,
+    const vector<Shared<string>>& frameworks,
+    const vector<Shared<string>>& completedFrameworks)
+{
+  auto append = [](
+      string* json,
+      const string& name,
+      const vector<Shared<string>>& elements) {
+    json->append(",\"" + name + "\":[");
+
+    for (size_t i = 0; i < elements.size(); ++i) {
+      if (i > 0) {
+        json->push_back(',');
+      }
+      json->append(*elements[i]);
+    }
+
+    json->push_back(']');
+  };
+
+  Master::StateBody body;
+  body.json = fields;
+
+  append(&body.json, "slaves", slaves);
+  append(&body.json, "frameworks", frameworks);
+  append(&body.json, "completed_frameworks", completedFrameworks);
+
+  body.json.push_back('}');
+
+  // Compress the body once per snapshot rather than letting libprocess
+  // compress it for every request.
+  Try<string> compressed = gzip::compress(body.json);
+  if (compressed.isError()) {
+    LOG(WARNING) << "Failed to gzip the state: " << compressed.error();
+  } else {
+    body.gzipped = std::move(compressed).get();
+  }
+
+  return body;
+}
+
+
+string Master::Http::stateETag() const
+{
+  return "\"" + master->info().id() + "-" +
+         stringify(master->stateGeneration) + "\"";
+}
+
+
+bool Master::Http::stateNotModified(const Request& request) const
+{
+  Option<string> ifNoneMatch = request.headers.get("If-None-Match");
+  if (ifNoneMatch.isNone()) {
+    return false;
+  }
+
+  const string etag = stateETag();
+
+  foreach (string tag, strings::tokenize(ifNoneMatch.get(), ",")) {
+    tag = strings::trim(tag);
+
+    // The state is not meant to be byte-for-byte identical between
+    // different encodings, so we accept weak validators as well.
+    if (strings::startsWith(tag, "W/")) {
+      tag = tag.substr(2);
+    }
+
+    if (tag == "*" || tag == etag) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
+Response Master::Http::stateResponse(
+    const Master::StateBody& body,
+    const string& etag,
+    const Option<string>& jsonp,
+    bool acceptsGzip)
+{
+  Response response;
+
+  if (jsonp.isSome()) {
+    response = OK(jsonp.get() + "(" + body.json + ");", "text/javascript");
+  } else if (acceptsGzip && body.gzipped.isSome()) {
+    response = OK(body.gzipped.get(), "application/json");
+    response.headers["Content-Encoding"] = "gzip";
+  } else {
+    response = OK(body.json, "application/json");
+  }
+
+  response.headers["ETag"] = etag;
+
+  return response;
 }
 
 
@@ -2837,7 +3338,7 @@ Future<Response> Master::Http::readFile(
       response.mutable_read_file()->set_size(std::get<0>(result.get()));
       response.mutable_read_file()->set_data(std::get<1>(result.get()));
 
-      return OK(serialize(contentType, evolve(response)),
+      return OK(serializeV1(contentType, response),
                 stringify(contentType));
     });
 }
@@ -3033,7 +3534,24 @@ string Master::Http::STATESUMMARY_HELP()
         "This endpoint gives a summary of the state of all tasks and",
         "registered frameworks in the cluster as a JSON object.",
         "The information shown might be filtered based on the user",
-        "accessing the endpoint."),
+        "accessing the endpoint.",
+        "",
+        "Each summary carries the `generation` of the master's state it",
+        "reflects, as well as the `master_id`. Passing a generation back",
+        "returns only the changes since then, which is cheap when",
+        "nothing changed:",
+        "",
+        ">        since=VALUE          Only returns the agents and "
+        "frameworks that changed after this generation, along with the "
+        "`removed_slave_ids` and `removed_framework_ids`.",
+        "",
+        "Such a delta carries the `since` generation. Agents and frameworks",
+        "that were removed and then added back appear in both lists.",
+        "If the changes are no longer known, e.g., because the generation",
+        "is too old, the full summary is returned instead (without",
+        "`since`). Generations are only meaningful to the master that",
+        "returned them, i.e., clients must request the full summary again",
+        "when the `master_id` changes."),
     AUTHENTICATION(true),
     AUTHORIZATION(
         "This endpoint might be filtered based on the user accessing it.",
@@ -3052,6 +3570,14 @@ Future<Response> Master::Http::stateSummary(
     return redirect(request);
   }
 
+  Result<uint64_t> since =
+    numify<uint64_t>(request.url.query.get("since"));
+
+  if (since.isError()) {
+    return BadRequest(
+        "Failed to parse query parameter 'since': " + since.error());
+  }
+
   Future<Owned<ObjectApprover>> frameworksApprover;
 
   if (master->authorizer.isSome()) {
@@ -3069,16 +3595,38 @@ Future<Response> Master::Http::stateSummary(
   return frameworksApprover
     .then(defer(
         master->self(),
-        [this, request](const Owned<ObjectApprover>& frameworksApprover)
-          -> Response {
+        [this, request, since](
+            const Owned<ObjectApprover>& frameworksApprover) -> Response {
+      // Only the changes after `delta` are returned, if they are known.
+      // Removals before the `horizon` have been dropped, and a generation
+      // ahead of ours was not returned by this master.
+      Option<uint64_t> delta;
+      if (since.isSome() &&
+          since.get() >= master->summaryRemovals.horizon &&
+          since.get() <= master->stateGeneration) {
+        delta = since.get();
+      }
+
+      auto changed = [&delta](uint64_t generation) {
+        return delta.isNone() || generation > delta.get();
+      };
+
       auto stateSummary =
-          [this, &frameworksApprover](JSON::ObjectWriter* writer) {
+          [this, &frameworksApprover, &delta, &changed](
+              JSON::ObjectWriter* writer) {
         writer->field("hostname", master->info().hostname());
 
         if (master->flags.cluster.isSome()) {
           writer->field("cluster", master->flags.cluster.get());
         }
 
+        writer->field("master_id", master->info().id());
+        writer->field("generation", master->stateGeneration);
+
+        if (delta.isSome()) {
+          writer->field("since", delta.get());
+        }
+
         // We use the tasks in the 'Frameworks' struct to compute summaries
         // for this endpoint. This is done 1) for consistency between the
         // 'slaves' and 'frameworks' subsections below 2) because we want to
@@ -3087,19 +3635,31 @@ Future<Response> Master::Http::stateSummary(
         // tasks that we can use to keep a limited view on the history of
         // recent completed / failed tasks.
 
+        // When nothing changed since `delta` there is nothing to
+        // summarize, so we do not need to walk the tasks. This keeps
+        // polling an idle cluster cheap.
+        const hashmap<FrameworkID, Framework*> unchanged;
+        const hashmap<FrameworkID, Framework*>& frameworks =
+          (delta.isSome() && delta.get() == master->stateGeneration)
+            ? unchanged
+            : master->frameworks.registered;
+
         // Generate mappings from 'slave' to 'framework' and reverse.
-        SlaveFrameworkMapping slaveFrameworkMapping(
-            master->frameworks.registered);
+        SlaveFrameworkMapping slaveFrameworkMapping(frameworks);
 
         // Generate 'TaskState' summaries for all framework and slave ids.
-        TaskStateSummaries taskStateSummaries(master->frameworks.registered);
+        TaskStateSummaries taskStateSummaries(frameworks);
 
         // Model all of the slaves.
         writer->field(
             "slaves",
-            [this, &slaveFrameworkMapping, &taskStateSummaries](
+            [this, &slaveFrameworkMapping, &taskStateSummaries, &changed](
                 JSON::ArrayWriter* writer) {
           foreachvalue (Slave* slave, master->slaves.registered) {
+            if (!changed(slave->stateGeneration)) {
+              continue;
+            }
+
             writer->element(
                 [&slave, &slaveFrameworkMapping, &taskStateSummaries](
                     JSON::ObjectWriter* writer) {
@@ -3146,10 +3706,15 @@ Future<Response> Master::Http::stateSummary(
             [this,
              &slaveFrameworkMapping,
              &taskStateSummaries,
-             &frameworksApprover](JSON::ArrayWriter* writer) {
+             &frameworksApprover,
+             &changed](JSON::ArrayWriter* writer) {
           foreachpair (const FrameworkID& frameworkId,
                        Framework* framework,
                        master->frameworks.registered) {
+            if (!changed(framework->stateGeneration)) {
+              continue;
+            }
+
             // Skip unauthorized frameworks.
             if (!approveViewFrameworkInfo(
                     frameworksApprover,
@@ -3192,9 +3757,34 @@ Future<Response> Master::Http::stateSummary(
             });
           }
         });
+
+        if (delta.isNone()) {
+          return;
+        }
+
+        writer->field(
+            "removed_slave_ids",
+            [this, &changed](JSON::ArrayWriter* writer) {
+          foreach (const auto& removal, master->summaryRemovals.slaves) {
+            if (changed(removal.first)) {
+              writer->element(removal.second.value());
+            }
+          }
+        });
+
+        writer->field(
+            "removed_framework_ids",
+            [this, &frameworksApprover, &changed](JSON::ArrayWriter* writer) {
+          foreach (const auto& removal, master->summaryRemovals.frameworks) {
+            if (changed(removal.first) &&
+                approveViewFrameworkInfo(frameworksApprover, removal.second)) {
+              writer->element(removal.second.id().value());
+            }
+          }
+        });
       };
 
-      return OK(jsonify(stateSummary), request.url.query.get("jsonp"));
+      return jsonResponse(request, jsonify(stateSummary));
     }));
 }
 
@@ -3404,7 +3994,7 @@ Future<Response> Master::Http::listFiles(
         listFiles->add_file_infos()->CopyFrom(fileInfo);
       }
 
-      return OK(serialize(contentType, evolve(response)),
+      return OK(serializeV1(contentType, response),
                 stringify(contentType));
     });
 }
@@ -3455,7 +4045,7 @@ Future<Response> Master::Http::getRoles(
         getRoles->add_roles()->CopyFrom(role);
       }
 
-      return OK(serialize(contentType, evolve(response)),
+      return OK(serializeV1(contentType, response),
                 stringify(contentType));
     }));
 }
@@ -3566,48 +4156,133 @@ Future<Response> Master::Http::_teardown(const FrameworkID& id) const
 }
 
 
-struct TaskComparator
+// The position of a task in the order of `/tasks` and `GET_TASKS`,
+// i.e., by the timestamp of the earliest status of the task (tasks
+// without any status come first), then by framework ID and task ID.
+// The cursor of the last task of a page is where the next page
+// starts.
+struct TaskCursor
 {
-  static bool ascending(const Task* lhs, const Task* rhs)
+  typedef tuple<bool, double, const string&, const string&> Key;
+
+  static Key key(const Task& task)
   {
-    size_t lhsSize = lhs->statuses().size();
-    size_t rhsSize = rhs->statuses().size();
+    const bool hasTimestamp = task.statuses_size() > 0;
 
-    if ((lhsSize == 0) && (rhsSize == 0)) {
-      return false;
-    }
+    return Key(
+        hasTimestamp,
+        hasTimestamp ? task.statuses(0).timestamp() : 0.0,
+        task.framework_id().value(),
+        task.task_id().value());
+  }
 
-    if (lhsSize == 0) {
-      return true;
+  static TaskCursor create(const Task& task)
+  {
+    TaskCursor cursor;
+    cursor.hasTimestamp = task.statuses_size() > 0;
+    cursor.timestamp =
+      cursor.hasTimestamp ? task.statuses(0).timestamp() : 0.0;
+    cursor.frameworkId = task.framework_id().value();
+    cursor.taskId = task.task_id().value();
+    return cursor;
+  }
+
+  // Parses a cursor of the form `timestamp/framework_id/task_id`,
+  // where the timestamp is empty for a task without statuses. Note
+  // that IDs cannot contain slashes.
+  static Try<TaskCursor> parse(const string& value)
+  {
+    const vector<string> tokens = strings::split(value, "/");
+    if (tokens.size() != 3) {
+      return Error("Invalid cursor '" + value + "'");
     }
 
-    if (rhsSize == 0) {
-      return false;
+    TaskCursor cursor;
+    cursor.hasTimestamp = !tokens[0].empty();
+    cursor.timestamp = 0.0;
+
+    if (cursor.hasTimestamp) {
+      Try<double> timestamp = numify<double>(tokens[0]);
+      if (timestamp.isError()) {
+        return Error("Invalid cursor '" + value + "': " + timestamp.error());
+      }
+
+      cursor.timestamp = timestamp.get();
     }
 
-    return (lhs->statuses(0).timestamp() < rhs->statuses(0).timestamp());
+    cursor.frameworkId = tokens[1];
+    cursor.taskId = tokens[2];
+
+    return cursor;
   }
 
-  static bool descending(const Task* lhs, const Task* rhs)
+  string encode() const
   {
-    size_t lhsSize = lhs->statuses().size();
-    size_t rhsSize = rhs->statuses().size();
+    // NOTE: We print all significant digits of the timestamp so that
+    // it parses back to the same value.
+    return (hasTimestamp ? strings::format("%.17g", timestamp).get() : "") +
+           "/" + frameworkId + "/" + taskId;
+  }
 
-    if ((lhsSize == 0) && (rhsSize == 0)) {
-      return false;
-    }
+  Key key() const
+  {
+    return Key(hasTimestamp, timestamp, frameworkId, taskId);
+  }
 
-    if (rhsSize == 0) {
-      return true;
-    }
+  bool hasTimestamp;
+  double timestamp;
+  string frameworkId;
+  string taskId;
+};
 
-    if (lhsSize == 0) {
-      return false;
-    }
 
-    return (lhs->statuses(0).timestamp() > rhs->statuses(0).timestamp());
+// Returns the page of (at most) `limit` tasks that starts `offset`
+// tasks after the `cursor` (or at the first task if not set), in
+// ascending or descending order. Sets `next` to the cursor of the
+// last task of the page if more tasks follow. Only the tasks up to
+// the end of the page are sorted, rather than all tasks.
+static vector<const Task*> paginate(
+    vector<const Task*> tasks,
+    bool ascending,
+    const Option<TaskCursor>& cursor,
+    size_t offset,
+    size_t limit,
+    Option<string>* next)
+{
+  if (cursor.isSome()) {
+    const TaskCursor::Key key = cursor->key();
+
+    tasks.erase(
+        std::remove_if(
+            tasks.begin(),
+            tasks.end(),
+            [&key, ascending](const Task* task) {
+              return ascending
+                ? !(key < TaskCursor::key(*task))
+                : !(TaskCursor::key(*task) < key);
+            }),
+        tasks.end());
+  }
+
+  const size_t begin = std::min(offset, tasks.size());
+  const size_t end = begin + std::min(limit, tasks.size() - begin);
+
+  std::partial_sort(
+      tasks.begin(),
+      tasks.begin() + end,
+      tasks.end(),
+      [ascending](const Task* lhs, const Task* rhs) {
+        return ascending
+          ? TaskCursor::key(*lhs) < TaskCursor::key(*rhs)
+          : TaskCursor::key(*rhs) < TaskCursor::key(*lhs);
+      });
+
+  if (end > begin && end < tasks.size()) {
+    *next = TaskCursor::create(*tasks[end - 1]).encode();
   }
-};
+
+  return vector<const Task*>(tasks.begin() + begin, tasks.begin() + end);
+}
 
 
 string Master::Http::TASKS_HELP()
@@ -3631,8 +4306,20 @@ string Master::Http::TASKS_HELP()
         "(default is " + stringify(TASK_LIMIT) + ").",
         ">        offset=VALUE         Starts task list at offset.",
         ">        order=(asc|desc)     Ascending or descending sort order "
-        "(default is descending)."
-        ""),
+        "(default is descending).",
+        ">        cursor=VALUE         Starts task list after the task of "
+        "this cursor, i.e., the `next_cursor` of the previous page.",
+        ">        fields=VALUE         Comma separated list of the fields "
+        "to return, e.g., `tasks.id,tasks.state`.",
+        ">        framework_id=VALUE   Only returns the tasks of this "
+        "framework.",
+        ">        role=VALUE           Only returns the tasks of frameworks "
+        "subscribed to this role.",
+        ">        state=VALUE          Only returns the tasks in this state, "
+        "e.g., `TASK_RUNNING`.",
+        "",
+        "The response includes a `next_cursor` if more tasks follow the",
+        "returned ones."),
     AUTHENTICATION(true),
     AUTHORIZATION(
         "This endpoint might be filtered based on the user accessing it.",
@@ -3661,6 +4348,23 @@ Future<Response> Master::Http::tasks(
   Option<string> order = request.url.query.get("order");
   string _order = order.isSome() && (order.get() == "asc") ? "asc" : "des";
 
+  Option<TaskCursor> cursor;
+  if (request.url.query.contains("cursor")) {
+    Try<TaskCursor> parse =
+      TaskCursor::parse(request.url.query.at("cursor"));
+
+    if (parse.isError()) {
+      return BadRequest(parse.error());
+    }
+
+    cursor = parse.get();
+  }
+
+  Try<StateQuery> query = StateQuery::parse(request);
+  if (query.isError()) {
+    return BadRequest(query.error());
+  }
+
   // Retrieve Approvers for authorizing frameworks and tasks.
   Future<Owned<ObjectApprover>> frameworksApprover;
   Future<Owned<ObjectApprover>> tasksApprover;
@@ -3693,8 +4397,9 @@ Future<Response> Master::Http::tasks(
       // Construct framework list with both active and completed frameworks.
       vector<const Framework*> frameworks;
       foreachvalue (Framework* framework, master->frameworks.registered) {
-        // Skip unauthorized frameworks.
-        if (!approveViewFrameworkInfo(frameworksApprover, framework->info)) {
+        // Skip unauthorized and unselected frameworks.
+        if (!query->selects(*framework) ||
+            !approveViewFrameworkInfo(frameworksApprover, framework->info)) {
           continue;
         }
 
@@ -3703,8 +4408,9 @@ Future<Response> Master::Http::tasks(
 
       foreachvalue (const Owned<Framework>& framework,
                     master->frameworks.completed) {
-        // Skip unauthorized frameworks.
-        if (!approveViewFrameworkInfo(frameworksApprover, framework->info)) {
+        // Skip unauthorized and unselected frameworks.
+        if (!query->selects(*framework) ||
+            !approveViewFrameworkInfo(frameworksApprover, framework->info)) {
           continue;
         }
 
@@ -3716,8 +4422,9 @@ Future<Response> Master::Http::tasks(
       foreach (const Framework* framework, frameworks) {
         foreachvalue (Task* task, framework->tasks) {
           CHECK_NOTNULL(task);
-          // Skip unauthorized tasks.
-          if (!approveViewTask(tasksApprover, *task, framework->info)) {
+          // Skip unauthorized and unselected tasks.
+          if (!query->selects(task->state()) ||
+              !approveViewTask(tasksApprover, *task, framework->info)) {
             continue;
           }
 
@@ -3725,8 +4432,9 @@ Future<Response> Master::Http::tasks(
         }
 
         foreachvalue (const Owned<Task>& task, framework->unreachableTasks) {
-          // Skip unauthorized tasks.
-          if (!approveViewTask(tasksApprover, *task.get(), framework->info)) {
+          // Skip unauthorized and unselected tasks.
+          if (!query->selects(task->state()) ||
+              !approveViewTask(tasksApprover, *task.get(), framework->info)) {
             continue;
           }
 
@@ -3734,8 +4442,9 @@ Future<Response> Master::Http::tasks(
         }
 
         foreach (const Owned<Task>& task, framework->completedTasks) {
-          // Skip unauthorized tasks.
-          if (!approveViewTask(tasksApprover, *task.get(), framework->info)) {
+          // Skip unauthorized and unselected tasks.
+          if (!query->selects(task->state()) ||
+              !approveViewTask(tasksApprover, *task.get(), framework->info)) {
             continue;
           }
 
@@ -3746,24 +4455,31 @@ Future<Response> Master::Http::tasks(
       // Sort tasks by task status timestamp. Default order is descending.
       // The earliest timestamp is chosen for comparison when
       // multiple are present.
-      if (_order == "asc") {
-        sort(tasks.begin(), tasks.end(), TaskComparator::ascending);
-      } else {
-        sort(tasks.begin(), tasks.end(), TaskComparator::descending);
-      }
+      Option<string> next;
+      const vector<const Task*> page =
+        paginate(tasks, _order == "asc", cursor, offset, limit, &next);
+
+      const FieldProjection& fields = query->fields;
 
-      auto tasksWriter = [&tasks, limit, offset](JSON::ObjectWriter* writer) {
-        writer->field("tasks",
-                      [&tasks, limit, offset](JSON::ArrayWriter* writer) {
-          // Collect 'limit' number of tasks starting from 'offset'.
-          size_t end = std::min(offset + limit, tasks.size());
-          for (size_t i = offset; i < end; i++) {
-            writer->element(*tasks[i]);
+      auto tasksWriter = [&page, &next, &fields](
+          JSON::ObjectWriter* objectWriter) {
+        ProjectedObjectWriter writer(objectWriter, fields);
+
+        writer.field("tasks",
+                     [&page, &fields](JSON::ArrayWriter* writer) {
+          const FieldProjection& taskFields = fields.at("tasks");
+
+          foreach (const Task* task, page) {
+            writeTaskElement(writer, *task, taskFields);
           }
         });
+
+        if (next.isSome()) {
+          writer.field("next_cursor", next.get());
+        }
       };
 
-      return OK(jsonify(tasksWriter), request.url.query.get("jsonp"));
+      return jsonResponse(request, jsonify(tasksWriter));
   }));
 }
 
@@ -3775,6 +4491,13 @@ Future<Response> Master::Http::getTasks(
 {
   CHECK_EQ(mesos::master::Call::GET_TASKS, call.type());
 
+  if (call.get_tasks().has_cursor()) {
+    Try<TaskCursor> cursor = TaskCursor::parse(call.get_tasks().cursor());
+    if (cursor.isError()) {
+      return BadRequest(cursor.error());
+    }
+  }
+
   // Retrieve Approvers for authorizing frameworks and tasks.
   Future<Owned<ObjectApprover>> frameworksApprover;
   Future<Owned<ObjectApprover>> tasksApprover;
@@ -3808,11 +4531,12 @@ Future<Response> Master::Http::getTasks(
       mesos::master::Response response;
       response.set_type(mesos::master::Response::GET_TASKS);
 
-      response.mutable_get_tasks()->CopyFrom(
-          _getTasks(frameworksApprover,
-                    tasksApprover));
+      mesos::master::Response::GetTasks tasks =
+        _getTasks(frameworksApprover, tasksApprover, call.get_tasks());
+
+      response.mutable_get_tasks()->Swap(&tasks);
 
-      return OK(serialize(contentType, evolve(response)),
+      return OK(serializeV1(contentType, response),
                 stringify(contentType));
   }));
 }
@@ -3820,8 +4544,18 @@ Future<Response> Master::Http::getTasks(
 
 mesos::master::Response::GetTasks Master::Http::_getTasks(
     const Owned<ObjectApprover>& frameworksApprover,
-    const Owned<ObjectApprover>& tasksApprover) const
+    const Owned<ObjectApprover>& tasksApprover,
+    const mesos::master::Call::GetTasks& options) const
 {
+  const bool paginated = options.has_limit() || options.has_cursor();
+
+  Option<TaskCursor> cursor;
+  if (options.has_cursor()) {
+    Try<TaskCursor> parse = TaskCursor::parse(options.cursor());
+    CHECK_SOME(parse); // Validated in `getTasks()`.
+    cursor = parse.get();
+  }
+
   // Construct framework list with both active and completed frameworks.
   vector<const Framework*> frameworks;
   foreachvalue (Framework* framework, master->frameworks.registered) {
@@ -3846,9 +4580,17 @@ mesos::master::Response::GetTasks Master::Http::_getTasks(
   mesos::master::Response::GetTasks getTasks;
 
   vector<const Task*> tasks;
+  vector<const Task*> unreachableTasks;
+  vector<const Task*> completedTasks;
+
   foreach (const Framework* framework, frameworks) {
     // Pending tasks.
     foreachvalue (const TaskInfo& taskInfo, framework->pendingTasks) {
+      // Pending tasks are only part of the first page.
+      if (cursor.isSome()) {
+        break;
+      }
+
       // Skip unauthorized tasks.
       if (!approveViewTaskInfo(tasksApprover, taskInfo, framework->info)) {
         continue;
@@ -3868,7 +4610,7 @@ mesos::master::Response::GetTasks Master::Http::_getTasks(
         continue;
       }
 
-      getTasks.add_tasks()->CopyFrom(*task);
+      tasks.push_back(task);
     }
 
     // Unreachable tasks.
@@ -3878,7 +4620,7 @@ mesos::master::Response::GetTasks Master::Http::_getTasks(
         continue;
       }
 
-      getTasks.add_unreachable_tasks()->CopyFrom(*task);
+      unreachableTasks.push_back(task.get());
     }
 
     // Completed tasks.
@@ -3888,16 +4630,73 @@ mesos::master::Response::GetTasks Master::Http::_getTasks(
         continue;
       }
 
-      getTasks.add_completed_tasks()->CopyFrom(*task);
+      completedTasks.push_back(task.get());
     }
   }
 
+  if (paginated) {
+    vector<const Task*> all;
+    all.reserve(
+        tasks.size() + unreachableTasks.size() + completedTasks.size());
+
+    all.insert(all.end(), tasks.begin(), tasks.end());
+    all.insert(all.end(), unreachableTasks.begin(), unreachableTasks.end());
+    all.insert(all.end(), completedTasks.begin(), completedTasks.end());
+
+    const size_t limit = options.has_limit() ? options.limit() : all.size();
+
+    Option<string> next;
+    const vector<const Task*> page =
+      paginate(all, true, cursor, 0, limit, &next);
+
+    hashset<const Task*> selected;
+    foreach (const Task* task, page) {
+      selected.insert(task);
+    }
+
+    auto select = [&selected](vector<const Task*>* tasks) {
+      tasks->erase(
+          std::remove_if(
+              tasks->begin(),
+              tasks->end(),
+              [&selected](const Task* task) {
+                return !selected.contains(task);
+              }),
+          tasks->end());
+    };
+
+    select(&tasks);
+    select(&unreachableTasks);
+    select(&completedTasks);
+
+    if (next.isSome()) {
+      getTasks.set_next_cursor(next.get());
+    }
+  }
+
+  foreach (const Task* task, tasks) {
+    getTasks.add_tasks()->CopyFrom(*task);
+  }
+
+  foreach (const Task* task, unreachableTasks) {
+    getTasks.add_unreachable_tasks()->CopyFrom(*task);
+  }
+
+  foreach (const Task* task, completedTasks) {
+    getTasks.add_completed_tasks()->CopyFrom(*task);
+  }
+
   // Orphan tasks. Such tasks are only possible if the cluster
   // contains pre-1.0 agents.
   //
   // TODO(neilc): Remove this once we break compatibility with pre-1.0
   // agents.
   foreachvalue (const Slave* slave, master->slaves.registered) {
+    // Orphan tasks are only part of the first page.
+    if (cursor.isSome()) {
+      break;
+    }
+
     typedef hashmap<TaskID, Task*> TaskMap;
     foreachvalue (const TaskMap& tasks, slave->tasks) {
       foreachvalue (const Task* task, tasks) {
@@ -4094,7 +4893,7 @@ Future<Response> Master::Http::getMaintenanceSchedule(
   response.mutable_get_maintenance_schedule()->mutable_schedule()->CopyFrom(
       _getMaintenanceSchedule());
 
-  return OK(serialize(contentType, evolve(response)),
+  return OK(serializeV1(contentType, response),
             stringify(contentType));
 }
 
@@ -4500,7 +5299,7 @@ Future<Response> Master::Http::getMaintenanceStatus(
       response.mutable_get_maintenance_status()->mutable_status()
         ->CopyFrom(status);
 
-      return OK(serialize(contentType, evolve(response)),
+      return OK(serializeV1(contentType, response),
                 stringify(contentType));
     });
 }
@@ -58,6 +58,8 @@
 #include <stout/strings.hpp>
 #include <stout/try.hpp>
 
+#include "authorizer/caching/authorizer.hpp"
+
 #include "common/build.hpp"
 #include "common/http.hpp"
 #include "common/protobuf_utils.hpp"
@@ -70,6 +72,8 @@
 #include "master/master.hpp"
 #include "master/registrar.hpp"
 
+#include "master/allocator/trace.hpp"
+
 #include "master/allocator/mesos/hierarchical.hpp"
 
 #include "master/detector/standalone.hpp"
@@ -96,6 +100,8 @@ using mesos::log::Log;
 
 using mesos::allocator::Allocator;
 
+using mesos::internal::master::allocator::TracingAllocator;
+
 using mesos::master::contender::MasterContender;
 
 using mesos::master::detector::MasterDetector;
@@ -384,6 +390,19 @@ int main(int argc, char** argv)
   CHECK_NOTNULL(allocator.get());
   LOG(INFO) << "Using '" << allocatorName << "' allocator";
 
+  if (flags.allocator_trace.isSome()) {
+    allocator = TracingAllocator::create(
+        allocator.get(), flags.allocator_trace.get());
+
+    if (allocator.isError()) {
+      EXIT(EXIT_FAILURE)
+        << "Failed to record the allocator trace: " << allocator.error();
+    }
+
+    LOG(INFO) << "Recording the allocator calls to '"
+              << flags.allocator_trace.get() << "'";
+  }
+
   Storage* storage = nullptr;
 #ifndef __WINDOWS__
   Log* log = nullptr;
@@ -512,6 +531,16 @@ int main(int argc, char** argv)
   } else if (authorizer.isSome()) {
     authorizer_ = authorizer.get();
 
+    if (flags.authorization_cache_ttl.isSome()) {
+      LOG(INFO) << "Caching authorization decisions for "
+                << flags.authorization_cache_ttl.get();
+
+      authorizer_ = new CachingAuthorizer(
+          authorizer_.get(),
+          flags.authorization_cache_ttl.get(),
+          flags.authorization_cache_capacity);
+    }
+
     // Set the authorization callbacks for libprocess HTTP endpoints.
     // Note that these callbacks capture `authorizer_.get()`, but the master
     // creates a copy of the authorizer during construction. Thus, if in the
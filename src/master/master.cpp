@@ -18,9 +18,11 @@
 
 #include <algorithm>
 #include <cctype>
+#include <deque>
 #include <fstream>
 #include <iomanip>
 #include <list>
+#include <map>
 #include <memory>
 #include <set>
 #include <sstream>
@@ -50,6 +52,7 @@
 #include <process/owned.hpp>
 #include <process/run.hpp>
 #include <process/shared.hpp>
+#include <process/timeout.hpp>
 
 #include <process/metrics/metrics.hpp>
 
@@ -94,6 +97,7 @@
 using google::protobuf::RepeatedPtrField;
 
 using std::list;
+using std::map;
 using std::set;
 using std::shared_ptr;
 using std::string;
@@ -102,6 +106,7 @@ using std::vector;
 using process::await;
 using process::wait; // Necessary on some OS's to disambiguate.
 using process::Clock;
+using process::Event;
 using process::ExitedEvent;
 using process::Failure;
 using process::Future;
@@ -113,6 +118,7 @@ using process::Promise;
 using process::RateLimiter;
 using process::Shared;
 using process::Time;
+using process::Timeout;
 using process::Timer;
 using process::UPID;
 
@@ -132,87 +138,179 @@ using mesos::master::detector::MasterDetector;
 
 static bool isValidFailoverTimeout(const FrameworkInfo& frameworkInfo);
 
+
+// Returns the resources of a slave that count towards the capacity
+// available to quota, see `Master::Slaves::activeUnreserved`. Only
+// scalars are summed, since adding overlapping ranges (e.g., ports)
+// of different slaves could not be undone by subtracting them.
+static Resources unreservedScalars(const Slave* slave)
+{
+  return Resources(slave->info.resources()).unreserved().scalars();
+}
+
+// Health checks the registered slaves: each slave is pinged every
+// `slavePingTimeout`, and is marked unreachable once it did not answer
+// `maxSlavePingTimeouts` pings in a row. A single process observes all
+// the slaves, sending the pings that are due in batches, rather than
+// one process (and one timer) per slave.
 class SlaveObserver : public ProtobufProcess<SlaveObserver>
 {
 public:
-  SlaveObserver(const UPID& _slave,
-                const SlaveInfo& _slaveInfo,
-                const SlaveID& _slaveId,
-                const PID<Master>& _master,
+  SlaveObserver(const PID<Master>& _master,
                 const Option<shared_ptr<RateLimiter>>& _limiter,
                 const shared_ptr<Metrics> _metrics,
                 const Duration& _slavePingTimeout,
                 const size_t _maxSlavePingTimeouts)
     : ProcessBase(process::ID::generate("slave-observer")),
-      slave(_slave),
-      slaveInfo(_slaveInfo),
-      slaveId(_slaveId),
       master(_master),
       limiter(_limiter),
       metrics(_metrics),
-      slavePingTimeout(_slavePingTimeout),
       maxSlavePingTimeouts(_maxSlavePingTimeouts),
-      timeouts(0),
-      pinged(false),
-      connected(true)
+      deadlines(_slavePingTimeout),
+      scheduled(false)
   {
     install<PongSlaveMessage>(&SlaveObserver::pong);
   }
 
-  void reconnect()
+  // Starts observing the slave, i.e., pings it now and then every
+  // `slavePingTimeout`.
+  void add(const UPID& pid, const SlaveID& slaveId)
+  {
+    CHECK(!slaves.contains(slaveId));
+
+    slaves.emplace(slaveId, Observed(pid));
+    pids[pid] = slaveId;
+
+    ping(slaveId);
+
+    deadlines.add(slaveId);
+    schedule();
+  }
+
+  void remove(const SlaveID& slaveId)
   {
-    connected = true;
+    Option<Observed> slave = slaves.get(slaveId);
+    if (slave.isNone()) {
+      return;
+    }
+
+    // Pinging the slave stops, and so does any pending transition of
+    // the slave to UNREACHABLE (see `_markUnreachable`).
+    pids.erase(slave->pid);
+    slaves.erase(slaveId);
+    deadlines.remove(slaveId);
   }
 
-  void disconnect()
+  void reconnect(const SlaveID& slaveId)
   {
-    connected = false;
+    if (slaves.contains(slaveId)) {
+      slaves.at(slaveId).connected = true;
+    }
   }
 
-protected:
-  virtual void initialize()
+  void disconnect(const SlaveID& slaveId)
   {
-    ping();
+    if (slaves.contains(slaveId)) {
+      slaves.at(slaveId).connected = false;
+    }
   }
 
-  void ping()
+private:
+  struct Observed
   {
+    explicit Observed(const UPID& _pid)
+      : pid(_pid), timeouts(0), pinged(false), connected(true) {}
+
+    UPID pid;
+    Option<Future<Nothing>> markingUnreachable;
+    uint32_t timeouts;
+    bool pinged;
+    bool connected;
+  };
+
+  // The largest number of slaves that are pinged at once, so that the
+  // pongs do not have to wait for the pings of all the slaves when
+  // many of them are due at the same time (e.g., right after the
+  // slaves reregistered with a new leading master).
+  static constexpr size_t BATCH = 1000;
+
+  void ping(const SlaveID& slaveId)
+  {
+    Observed& slave = slaves.at(slaveId);
+
     PingSlaveMessage message;
-    message.set_connected(connected);
-    send(slave, message);
+    message.set_connected(slave.connected);
+    send(slave.pid, message);
 
-    pinged = true;
-    delay(slavePingTimeout, self(), &SlaveObserver::timeout);
+    slave.pinged = true;
   }
 
-  void pong()
+  void pong(const UPID& from, const PongSlaveMessage&)
   {
-    timeouts = 0;
-    pinged = false;
+    Option<SlaveID> slaveId = pids.get(from);
+    if (slaveId.isNone()) {
+      return;
+    }
+
+    Observed& slave = slaves.at(slaveId.get());
+
+    slave.timeouts = 0;
+    slave.pinged = false;
 
     // Cancel any pending unreachable transitions.
-    if (markingUnreachable.isSome()) {
+    if (slave.markingUnreachable.isSome()) {
       // Need a copy for non-const access.
-      Future<Nothing> future = markingUnreachable.get();
+      Future<Nothing> future = slave.markingUnreachable.get();
       future.discard();
     }
   }
 
+  // Triggers `timeout` at the next deadline, unless it is already
+  // triggered.
+  void schedule()
+  {
+    if (scheduled) {
+      return;
+    }
+
+    Option<Time> next = deadlines.next();
+    if (next.isNone()) {
+      return;
+    }
+
+    scheduled = true;
+
+    const Time now = Clock::now();
+    if (next.get() <= now) {
+      dispatch(self(), &SlaveObserver::timeout);
+    } else {
+      delay(next.get() - now, self(), &SlaveObserver::timeout);
+    }
+  }
+
   void timeout()
   {
-    if (pinged) {
-      timeouts++; // No pong has been received before the timeout.
-      if (timeouts >= maxSlavePingTimeouts) {
-        // No pong has been received for the last
-        // 'maxSlavePingTimeouts' pings.
-        markUnreachable();
+    scheduled = false;
+
+    foreach (const SlaveID& slaveId, deadlines.expire(BATCH)) {
+      Observed& slave = slaves.at(slaveId);
+
+      if (slave.pinged) {
+        slave.timeouts++; // No pong has been received before the timeout.
+        if (slave.timeouts >= maxSlavePingTimeouts) {
+          // No pong has been received for the last
+          // 'maxSlavePingTimeouts' pings.
+          markUnreachable(slaveId);
+        }
       }
+
+      // NOTE: We keep pinging even if we schedule a transition to
+      // UNREACHABLE. This is because if the slave eventually responds
+      // to a ping, we can cancel the UNREACHABLE transition.
+      ping(slaveId);
     }
 
-    // NOTE: We keep pinging even if we schedule a transition to
-    // UNREACHABLE. This is because if the slave eventually responds
-    // to a ping, we can cancel the UNREACHABLE transition.
-    ping();
+    schedule();
   }
 
   // Marking slaves unreachable is rate-limited and can be canceled if
@@ -224,9 +322,11 @@ protected:
   // agent reregisters, so a rate-limit is a useful safety
   // precaution. Once all frameworks are PARTITION_AWARE, we can
   // likely remove the rate-limit (MESOS-5948).
-  void markUnreachable()
+  void markUnreachable(const SlaveID& slaveId)
   {
-    if (markingUnreachable.isSome()) {
+    Observed& slave = slaves.at(slaveId);
+
+    if (slave.markingUnreachable.isSome()) {
       return; // Unreachable transition is already in progress.
     }
 
@@ -239,15 +339,22 @@ protected:
       acquire = limiter.get()->acquire();
     }
 
-    markingUnreachable = acquire.onAny(defer(self(), &Self::_markUnreachable));
+    slave.markingUnreachable = acquire.onAny(
+        defer(self(), &Self::_markUnreachable, slaveId, lambda::_1));
+
     ++metrics->slave_unreachable_scheduled;
   }
 
-  void _markUnreachable()
+  void _markUnreachable(
+      const SlaveID& slaveId,
+      const Future<Nothing>& future)
   {
-    CHECK_SOME(markingUnreachable);
-
-    const Future<Nothing>& future = markingUnreachable.get();
+    // The slave may have been removed (and even added again) in the
+    // meantime, in which case the transition no longer applies.
+    if (!slaves.contains(slaveId) ||
+        slaves.at(slaveId).markingUnreachable != future) {
+      return;
+    }
 
     CHECK(!future.isFailed());
 
@@ -265,22 +372,21 @@ protected:
       ++metrics->slave_unreachable_canceled;
     }
 
-    markingUnreachable = None();
+    slaves.at(slaveId).markingUnreachable = None();
   }
 
-private:
-  const UPID slave;
-  const SlaveInfo slaveInfo;
-  const SlaveID slaveId;
   const PID<Master> master;
   const Option<shared_ptr<RateLimiter>> limiter;
   shared_ptr<Metrics> metrics;
-  Option<Future<Nothing>> markingUnreachable;
-  const Duration slavePingTimeout;
   const size_t maxSlavePingTimeouts;
-  uint32_t timeouts;
-  bool pinged;
-  bool connected;
+
+  hashmap<SlaveID, Observed> slaves;
+  hashmap<UPID, SlaveID> pids;
+
+  Deadlines<SlaveID> deadlines;
+
+  // Whether `timeout` is triggered already.
+  bool scheduled;
 };
 
 
@@ -303,6 +409,8 @@ Master::Master(
     detector(_detector),
     authorizer(_authorizer),
     frameworks(flags),
+    heartbeater(nullptr),
+    subscribers(flags),
     authenticator(None()),
     metrics(new Metrics(*this)),
     electedTime(None())
@@ -359,22 +467,45 @@ Master::Master(
 Master::~Master() {}
 
 
-// TODO(vinod): Update this interface to return failed futures when
-// capacity is reached.
+// A rate limiter with the semantics of `process::RateLimiter` (i.e.,
+// one permit per interval, without bursts) that is evaluated inline
+// by the master, so that an event within the rate is processed right
+// away rather than after a dispatch to (and a timer in) the limiter's
+// process. Only the events exceeding the rate are queued.
 struct BoundedRateLimiter
 {
   BoundedRateLimiter(double qps, Option<uint64_t> _capacity)
-    : limiter(new process::RateLimiter(qps)),
+    : interval(Seconds(1) / qps),
       capacity(_capacity),
       messages(0) {}
 
-  process::Owned<process::RateLimiter> limiter;
+  // Takes a permit if one is available without waiting, i.e., if the
+  // interval has elapsed since the last permit was taken and no event
+  // is queued (so that the events from a framework are kept in order).
+  bool acquire()
+  {
+    if (!events.empty() || timeout.remaining() > Duration::zero()) {
+      return false;
+    }
+
+    timeout = Timeout::in(interval);
+    return true;
+  }
+
+  const Duration interval;
   const Option<uint64_t> capacity;
 
-  // Number of outstanding messages for this RateLimiter.
+  // Number of queued messages for this limiter.
   // NOTE: ExitedEvents are throttled but not counted towards
   // the capacity here.
   uint64_t messages;
+
+  // When the next permit is available.
+  Timeout timeout;
+
+  // The events waiting for a permit, in the order they were received.
+  // A timer to process the front event is pending if this is not empty.
+  std::deque<Owned<Event>> events;
 };
 
 
@@ -703,13 +834,19 @@ void Master::initialize()
       << " for --offer_timeout: Must be greater than zero";
   }
 
+  mesos::allocator::Options options;
+  options.allocationPartitions = flags.allocation_partitions;
+  options.allocationSweepInterval = flags.allocation_sweep_interval;
+  options.agentOrdering = flags.agent_ordering;
+
   // Initialize the allocator.
   allocator->initialize(
       flags.allocation_interval,
       defer(self(), &Master::offer, lambda::_1, lambda::_2),
       defer(self(), &Master::inverseOffer, lambda::_1, lambda::_2),
       weights,
-      flags.fair_sharing_excluded_resource_names);
+      flags.fair_sharing_excluded_resource_names,
+      options);
 
   // Parse the whitelist. Passing Allocator::updateWhitelist()
   // callback is safe because we shut down the whitelistWatcher in
@@ -724,6 +861,22 @@ void Master::initialize()
       });
   spawn(whitelistWatcher);
 
+  slaves.observer = new SlaveObserver(
+      self(),
+      slaves.limiter,
+      metrics,
+      flags.agent_ping_timeout,
+      flags.max_agent_ping_timeouts);
+
+  spawn(slaves.observer);
+
+  // TODO(vinod): Make heartbeat interval configurable and include
+  // this information in the SUBSCRIBED response.
+  heartbeater = new Heartbeater(DEFAULT_HEARTBEAT_INTERVAL);
+  spawn(heartbeater);
+
+  stateGeneration = 0;
+  recoveryBatches = 0;
   nextFrameworkId = 0;
   nextSlaveId = 0;
   nextOfferId = 0;
@@ -796,16 +949,7 @@ void Master::initialize()
       &RegisterSlaveMessage::version,
       &RegisterSlaveMessage::agent_capabilities);
 
-  install<ReregisterSlaveMessage>(
-      &Master::reregisterSlave,
-      &ReregisterSlaveMessage::slave,
-      &ReregisterSlaveMessage::checkpointed_resources,
-      &ReregisterSlaveMessage::executor_infos,
-      &ReregisterSlaveMessage::tasks,
-      &ReregisterSlaveMessage::frameworks,
-      &ReregisterSlaveMessage::completed_frameworks,
-      &ReregisterSlaveMessage::version,
-      &ReregisterSlaveMessage::agent_capabilities);
+  install<ReregisterSlaveMessage>(&Master::reregisterSlaveMessage);
 
   install<UnregisterSlaveMessage>(
       &Master::unregisterSlave,
@@ -816,6 +960,8 @@ void Master::initialize()
       &StatusUpdateMessage::update,
       &StatusUpdateMessage::pid);
 
+  install<StatusUpdatesMessage>(&Master::statusUpdates);
+
   // Added in 0.24.0 to support HTTP schedulers. Since
   // these do not have a pid, the slave must forward
   // messages through the master.
@@ -1145,11 +1291,6 @@ void Master::finalize()
     // recovering the resources in the allocator.
     slave->pendingTasks.clear();
 
-    // Terminate the slave observer.
-    terminate(slave->observer);
-    wait(slave->observer);
-
-    delete slave->observer;
     delete slave;
   }
   slaves.registered.clear();
@@ -1214,6 +1355,16 @@ void Master::finalize()
   wait(whitelistWatcher);
   delete whitelistWatcher;
 
+  terminate(slaves.observer);
+  wait(slaves.observer);
+  delete slaves.observer;
+  slaves.observer = nullptr;
+
+  terminate(heartbeater);
+  wait(heartbeater);
+  delete heartbeater;
+  heartbeater = nullptr;
+
   if (authenticator.isSome()) {
     delete authenticator.get();
   }
@@ -1491,11 +1642,12 @@ void Master::visit(const MessageEvent& event)
     const Owned<BoundedRateLimiter>& limiter =
       frameworks.limiters[principal.get()].get();
 
-    if (limiter->capacity.isNone() ||
-        limiter->messages < limiter->capacity.get()) {
+    if (limiter->acquire()) {
+      _visit(event);
+    } else if (limiter->capacity.isNone() ||
+               limiter->messages < limiter->capacity.get()) {
       limiter->messages++;
-      limiter->limiter->acquire()
-        .onReady(defer(self(), &Self::throttled, event, principal));
+      throttle(limiter.get(), principal, new MessageEvent(event));
     } else {
       exceededCapacity(
           event,
@@ -1506,17 +1658,19 @@ void Master::visit(const MessageEvent& event)
               !frameworks.limiters.contains(principal.get())) &&
              isRegisteredFramework &&
              frameworks.defaultLimiter.isSome()) {
-    if (frameworks.defaultLimiter.get()->capacity.isNone() ||
-        frameworks.defaultLimiter.get()->messages <
-          frameworks.defaultLimiter.get()->capacity.get()) {
-      frameworks.defaultLimiter.get()->messages++;
-      frameworks.defaultLimiter.get()->limiter->acquire()
-        .onReady(defer(self(), &Self::throttled, event, None()));
+    const Owned<BoundedRateLimiter>& limiter = frameworks.defaultLimiter.get();
+
+    if (limiter->acquire()) {
+      _visit(event);
+    } else if (limiter->capacity.isNone() ||
+               limiter->messages < limiter->capacity.get()) {
+      limiter->messages++;
+      throttle(limiter.get(), None(), new MessageEvent(event));
     } else {
       exceededCapacity(
           event,
           principal,
-          frameworks.defaultLimiter.get()->capacity.get());
+          limiter->capacity.get());
     }
   } else {
     _visit(event);
@@ -1537,41 +1691,74 @@ void Master::visit(const ExitedEvent& event)
     ? frameworks.principals[event.pid]
     : Option<string>::none();
 
-  // Necessary to disambiguate below.
-  typedef void(Self::*F)(const ExitedEvent&);
+  Option<string> key = None();
+  BoundedRateLimiter* limiter = nullptr;
 
   if (principal.isSome() &&
       frameworks.limiters.contains(principal.get()) &&
       frameworks.limiters[principal.get()].isSome()) {
-    frameworks.limiters[principal.get()].get()->limiter->acquire()
-      .onReady(defer(self(), static_cast<F>(&Self::_visit), event));
+    key = principal;
+    limiter = frameworks.limiters[principal.get()].get().get();
   } else if ((principal.isNone() ||
               !frameworks.limiters.contains(principal.get())) &&
              isRegisteredFramework &&
              frameworks.defaultLimiter.isSome()) {
-    frameworks.defaultLimiter.get()->limiter->acquire()
-      .onReady(defer(self(), static_cast<F>(&Self::_visit), event));
-  } else {
+    limiter = frameworks.defaultLimiter.get().get();
+  }
+
+  if (limiter == nullptr || limiter->acquire()) {
     _visit(event);
+  } else {
+    throttle(limiter, key, new ExitedEvent(event));
   }
 }
 
 
-void Master::throttled(
-    const MessageEvent& event,
-    const Option<string>& principal)
+void Master::throttle(
+    BoundedRateLimiter* limiter,
+    const Option<string>& principal,
+    Event* event)
 {
-  // We already know a RateLimiter is used to throttle this event so
+  if (limiter->events.empty()) {
+    delay(limiter->timeout.remaining(), self(), &Self::throttled, principal);
+  }
+
+  limiter->events.push_back(Owned<Event>(event));
+}
+
+
+void Master::throttled(const Option<string>& principal)
+{
+  // We already know a limiter is used to throttle this event so
   // here we only need to determine which.
+  BoundedRateLimiter* limiter = nullptr;
   if (principal.isSome()) {
     CHECK_SOME(frameworks.limiters[principal.get()]);
-    frameworks.limiters[principal.get()].get()->messages--;
+    limiter = frameworks.limiters[principal.get()].get().get();
   } else {
     CHECK_SOME(frameworks.defaultLimiter);
-    frameworks.defaultLimiter.get()->messages--;
+    limiter = frameworks.defaultLimiter.get().get();
+  }
+
+  CHECK(!limiter->events.empty());
+
+  Owned<Event> event = limiter->events.front();
+  limiter->events.pop_front();
+
+  // Take the permit for this event and wait for the next one, if
+  // another event is queued.
+  limiter->timeout = Timeout::in(limiter->interval);
+
+  if (!limiter->events.empty()) {
+    delay(limiter->interval, self(), &Self::throttled, principal);
   }
 
-  _visit(event);
+  if (event->is<MessageEvent>()) {
+    limiter->messages--;
+    _visit(event->as<MessageEvent>());
+  } else {
+    _visit(event->as<ExitedEvent>());
+  }
 }
 
 
@@ -1654,6 +1841,8 @@ Future<Nothing> Master::recover()
 
 Future<Nothing> Master::_recover(const Registry& registry)
 {
+  ++stateGeneration;
+
   foreach (const Registry::Slave& slave, registry.slaves().slaves()) {
     slaves.recovered.put(slave.info().id(), slave.info());
   }
@@ -1686,6 +1875,7 @@ Future<Nothing> Master::_recover(const Registry& registry)
   // Save the quotas for each role.
   foreach (const Registry::Quota& quota, registry.quotas()) {
     quotas[quota.info().role()] = Quota{quota.info()};
+    totalQuotaGuarantee += quota.info().guarantee();
   }
 
   // We notify the allocator via the `recover()` call. This has to be
@@ -1870,6 +2060,7 @@ void Master::_doRegistryGc(
     }
 
     slaves.unreachable.erase(slave);
+    ++stateGeneration;
     numRemoved++;
   }
 
@@ -2003,6 +2194,7 @@ void Master::_markUnreachableAfterFailover(
 
   CHECK(slaves.recovered.contains(slaveInfo.id()));
   slaves.recovered.erase(slaveInfo.id());
+  ++stateGeneration;
 
   if (registrarResult.isFailed()) {
     LOG(FATAL) << "Failed to mark agent " << slaveInfo.id()
@@ -2116,6 +2308,8 @@ void Master::detected(const Future<Option<MasterInfo>>& _leader)
   bool wasElected = elected();
   leader = _leader.get();
 
+  ++stateGeneration;
+
   if (elected()) {
     electedTime = Clock::now();
 
@@ -2331,6 +2525,20 @@ void Master::receive(
       break;
     }
 
+    case scheduler::Call::ACKNOWLEDGE_BATCH: {
+      foreach (const scheduler::Call::Acknowledge& acknowledge,
+               call.acknowledge_batch().acknowledgements()) {
+        Try<UUID> uuid = UUID::fromBytes(acknowledge.uuid());
+        if (uuid.isError()) {
+          drop(from, call, uuid.error());
+          return;
+        }
+      }
+
+      acknowledge(framework, call.acknowledge_batch());
+      break;
+    }
+
     case scheduler::Call::RECONCILE:
       reconcile(framework, call.reconcile());
       break;
@@ -2598,6 +2806,7 @@ void Master::_subscribe(
     allocator->updateFramework(framework->id(), framework->info);
 
     framework->reregisteredTime = Clock::now();
+    framework->stateChanged();
 
     // Always failover the old framework connection. See MESOS-4712 for details.
     failoverFramework(framework, http);
@@ -2905,6 +3114,7 @@ void Master::_subscribe(
     allocator->updateFramework(framework->id(), framework->info);
 
     framework->reregisteredTime = Clock::now();
+    framework->stateChanged();
 
     if (force) {
       // TODO(vinod): Now that the scheduler pid is unique we don't
@@ -2922,15 +3132,17 @@ void Master::_subscribe(
       // NOTE: We need to do this because the scheduler might have
       // replied to the offers but the driver might have dropped
       // those messages since it wasn't connected to the master.
+      // All offers of the framework are removed, hence we recover all of
+      // its offered resources.
+      const hashmap<SlaveID, Resources> recovered =
+        framework->offeredResources;
+
       foreach (Offer* offer, utils::copy(framework->offers)) {
-        allocator->recoverResources(
-            offer->framework_id(),
-            offer->slave_id(),
-            offer->resources(),
-            None());
         removeOffer(offer, true); // Rescind.
       }
 
+      allocator->recoverResources(framework->id(), recovered, None());
+
       // Also remove inverse offers.
       foreach (InverseOffer* inverseOffer,
                utils::copy(framework->inverseOffers)) {
@@ -2954,6 +3166,7 @@ void Master::_subscribe(
       // the allocator has the correct view of the framework's share.
       if (!framework->active()) {
         framework->state = Framework::State::ACTIVE;
+        framework->stateChanged();
         allocator->activateFramework(framework->id());
       }
 
@@ -3057,6 +3270,7 @@ void Master::disconnect(Framework* framework)
   LOG(INFO) << "Disconnecting framework " << *framework;
 
   framework->state = Framework::State::DISCONNECTED;
+  framework->stateChanged();
 
   if (framework->pid.isSome()) {
     // Remove the framework from authenticated. This is safe because
@@ -3080,21 +3294,23 @@ void Master::deactivate(Framework* framework, bool rescind)
   LOG(INFO) << "Deactivating framework " << *framework;
 
   framework->state = Framework::State::INACTIVE;
+  framework->stateChanged();
 
   // Tell the allocator to stop allocating resources to this framework.
   allocator->deactivateFramework(framework->id());
 
   // Remove the framework's offers.
-  foreach (Offer* offer, utils::copy(framework->offers)) {
-    allocator->recoverResources(
-        offer->framework_id(),
-        offer->slave_id(),
-        offer->resources(),
-        None());
+  // All offers of the framework are removed, hence we recover all of
+  // its offered resources.
+  const hashmap<SlaveID, Resources> recovered =
+    framework->offeredResources;
 
+  foreach (Offer* offer, utils::copy(framework->offers)) {
     removeOffer(offer, rescind);
   }
 
+  allocator->recoverResources(framework->id(), recovered, None());
+
   // Remove the framework's inverse offers.
   foreach (InverseOffer* inverseOffer, utils::copy(framework->inverseOffers)) {
     allocator->updateInverseOffer(
@@ -3117,9 +3333,10 @@ void Master::disconnect(Slave* slave)
   LOG(INFO) << "Disconnecting agent " << *slave;
 
   slave->connected = false;
+  slave->stateChanged();
 
   // Inform the slave observer.
-  dispatch(slave->observer, &SlaveObserver::disconnect);
+  dispatch(slaves.observer, &SlaveObserver::disconnect, slave->id);
 
   // Remove the slave from authenticated. This is safe because
   // a slave will always reauthenticate before (re-)registering.
@@ -3135,20 +3352,17 @@ void Master::deactivate(Slave* slave)
 
   LOG(INFO) << "Deactivating agent " << *slave;
 
+  if (slave->active) {
+    slaves.activeUnreserved -= unreservedScalars(slave);
+  }
+
   slave->active = false;
+  slave->stateChanged();
 
   allocator->deactivateSlave(slave->id);
 
   // Remove and rescind offers.
-  foreach (Offer* offer, utils::copy(slave->offers)) {
-    allocator->recoverResources(
-        offer->framework_id(),
-        slave->id,
-        offer->resources(),
-        None());
-
-    removeOffer(offer, true); // Rescind!
-  }
+  rescindOffers(slave);
 
   // Remove and rescind inverse offers.
   foreach (InverseOffer* inverseOffer, utils::copy(slave->inverseOffers)) {
@@ -3960,6 +4174,10 @@ void Master::_accept(
   // the LAUNCH case below.
   Resources offeredSharedResources = offeredResources.shared();
 
+  // Shared by the validations of all tasks launched by this call, so
+  // that e.g. an executor used by many tasks is only validated once.
+  validation::task::Context taskValidationContext;
+
   // Maintain a list of operations to pass to the allocator.
   // Note that this list could be different than `accept.operations()`
   // because:
@@ -4234,6 +4452,18 @@ void Master::_accept(
         Offer::Operation _operation;
         _operation.set_type(Offer::Operation::LAUNCH);
 
+        // We add back offered shared resources for validation even if they
+        // are already consumed by other tasks in the same ACCEPT call. This
+        // allows these tasks to use more copies of the same shared resource
+        // than those being offered. e.g., 2 tasks can be launched on 1 copy
+        // of a shared persistent volume from the offer; 3 tasks can be
+        // launched on 2 copies of a shared persistent volume from 2 offers.
+        //
+        // NOTE: This is updated as the tasks are launched rather than
+        // recomputed from `_offeredResources` for each task.
+        Resources available =
+          _offeredResources.nonShared() + offeredSharedResources;
+
         foreach (const TaskInfo& task, operation.launch().task_infos()) {
           Future<bool> authorization = authorizations.front();
           authorizations.pop_front();
@@ -4328,20 +4558,12 @@ void Master::_accept(
             }
           }
 
-          // We add back offered shared resources for validation even if they
-          // are already consumed by other tasks in the same ACCEPT call. This
-          // allows these tasks to use more copies of the same shared resource
-          // than those being offered. e.g., 2 tasks can be launched on 1 copy
-          // of a shared persistent volume from the offer; 3 tasks can be
-          // launched on 2 copies of a shared persistent volume from 2 offers.
-          Resources available =
-            _offeredResources.nonShared() + offeredSharedResources;
-
           const Option<Error>& validationError = validation::task::validate(
               task_,
               framework,
               slave,
-              available);
+              available,
+              &taskValidationContext);
 
           if (validationError.isSome()) {
             const StatusUpdate& update = protobuf::createStatusUpdate(
@@ -4374,6 +4596,7 @@ void Master::_accept(
               << available << " does not contain " << consumed;
 
             _offeredResources -= consumed;
+            available -= consumed.nonShared();
 
             // TODO(bmahler): Consider updating this log message to
             // indicate when the executor is also being launched.
@@ -4985,6 +5208,70 @@ void Master::statusUpdateAcknowledgement(
 void Master::acknowledge(
     Framework* framework,
     const scheduler::Call::Acknowledge& acknowledge)
+{
+  Slave* slave = _acknowledge(framework, acknowledge);
+
+  if (slave == nullptr) {
+    return;
+  }
+
+  StatusUpdateAcknowledgementMessage message;
+  message.mutable_slave_id()->CopyFrom(acknowledge.slave_id());
+  message.mutable_framework_id()->CopyFrom(framework->id());
+  message.mutable_task_id()->CopyFrom(acknowledge.task_id());
+  message.set_uuid(acknowledge.uuid());
+
+  send(slave->pid, message);
+
+  metrics->valid_status_update_acknowledgements++;
+}
+
+
+void Master::acknowledge(
+    Framework* framework,
+    const scheduler::Call::AcknowledgeBatch& acknowledgeBatch)
+{
+  // Group the acknowledgements by agent, so that we send a single
+  // message to each agent that supports it.
+  hashmap<SlaveID, StatusUpdateAcknowledgementsMessage> messages;
+
+  foreach (const scheduler::Call::Acknowledge& acknowledge,
+           acknowledgeBatch.acknowledgements()) {
+    Slave* slave = _acknowledge(framework, acknowledge);
+
+    if (slave == nullptr) {
+      continue;
+    }
+
+    StatusUpdateAcknowledgementMessage message;
+    message.mutable_slave_id()->CopyFrom(acknowledge.slave_id());
+    message.mutable_framework_id()->CopyFrom(framework->id());
+    message.mutable_task_id()->CopyFrom(acknowledge.task_id());
+    message.set_uuid(acknowledge.uuid());
+
+    if (slave->capabilities.statusUpdateAcknowledgements) {
+      messages[slave->id].add_acknowledgements()->CopyFrom(message);
+    } else {
+      send(slave->pid, message);
+    }
+
+    metrics->valid_status_update_acknowledgements++;
+  }
+
+  foreachpair (const SlaveID& slaveId,
+               const StatusUpdateAcknowledgementsMessage& message,
+               messages) {
+    Slave* slave = slaves.registered.get(slaveId);
+    CHECK_NOTNULL(slave);
+
+    send(slave->pid, message);
+  }
+}
+
+
+Slave* Master::_acknowledge(
+    Framework* framework,
+    const scheduler::Call::Acknowledge& acknowledge)
 {
   CHECK_NOTNULL(framework);
 
@@ -5002,7 +5289,7 @@ void Master::acknowledge(
       << " for task " << taskId << " of framework " << *framework
       << " to agent " << slaveId << " because agent is not registered";
     metrics->invalid_status_update_acknowledgements++;
-    return;
+    return nullptr;
   }
 
   if (!slave->connected) {
@@ -5011,7 +5298,7 @@ void Master::acknowledge(
       << " for task " << taskId << " of framework " << *framework
       << " to agent " << *slave << " because agent is disconnected";
     metrics->invalid_status_update_acknowledgements++;
-    return;
+    return nullptr;
   }
 
   LOG(INFO) << "Processing ACKNOWLEDGE call " << uuid << " for task " << taskId
@@ -5039,7 +5326,7 @@ void Master::acknowledge(
         << " to agent " << *slave << " because the update was not"
         << " sent by this master";
       metrics->invalid_status_update_acknowledgements++;
-      return;
+      return nullptr;
     }
 
     // Remove the task once the terminal update is acknowledged.
@@ -5049,15 +5336,7 @@ void Master::acknowledge(
      }
   }
 
-  StatusUpdateAcknowledgementMessage message;
-  message.mutable_slave_id()->CopyFrom(slaveId);
-  message.mutable_framework_id()->CopyFrom(framework->id());
-  message.mutable_task_id()->CopyFrom(taskId);
-  message.set_uuid(uuid.toBytes());
-
-  send(slave->pid, message);
-
-  metrics->valid_status_update_acknowledgements++;
+  return slave;
 }
 
 
@@ -5277,6 +5556,8 @@ void Master::registerSlave(
         flags.agent_ping_timeout * flags.max_agent_ping_timeouts;
       MasterSlaveConnection connection;
       connection.set_total_ping_timeout_seconds(pingTimeout.secs());
+      connection.set_batched_status_updates(true);
+      connection.set_state_digests(true);
 
       SlaveRegisteredMessage message;
       message.mutable_slave_id()->CopyFrom(slave->id);
@@ -5368,6 +5649,8 @@ void Master::_registerSlave(
     flags.agent_ping_timeout * flags.max_agent_ping_timeouts;
   MasterSlaveConnection connection;
   connection.set_total_ping_timeout_seconds(pingTimeout.secs());
+  connection.set_batched_status_updates(true);
+  connection.set_state_digests(true);
 
   SlaveRegisteredMessage message;
   message.mutable_slave_id()->CopyFrom(slave->id);
@@ -5379,6 +5662,100 @@ void Master::_registerSlave(
 }
 
 
+void Master::reregisterSlaveMessage(
+    const UPID& from,
+    const ReregisterSlaveMessage& message)
+{
+  using google::protobuf::convert;
+
+  if (!message.has_state_digest()) {
+    reregisterSlave(
+        from,
+        message.slave(),
+        convert(message.checkpointed_resources()),
+        convert(message.executor_infos()),
+        convert(message.tasks()),
+        convert(message.frameworks()),
+        convert(message.completed_frameworks()),
+        message.version(),
+        convert(message.agent_capabilities()));
+    return;
+  }
+
+  // The agent expects us to still know its executors and tasks. If
+  // our view of the agent differs, we ignore the message, and the
+  // agent retries with its full state.
+  //
+  // NOTE: We also ignore the message while the agent authenticates,
+  // since our view of the agent might change until then.
+  Slave* slave = slaves.registered.get(message.slave().id());
+
+  uint64_t digest = 0;
+  if (slave != nullptr) {
+    foreachkey (const FrameworkID& frameworkId, slave->executors) {
+      foreachkey (const ExecutorID& executorId,
+                  slave->executors.at(frameworkId)) {
+        digest += protobuf::slave::stateDigest(frameworkId, executorId);
+      }
+    }
+
+    foreachkey (const FrameworkID& frameworkId, slave->tasks) {
+      foreachvalue (const Task* task, slave->tasks.at(frameworkId)) {
+        digest += protobuf::slave::stateDigest(*task);
+      }
+    }
+  }
+
+  if (slave == nullptr ||
+      authenticating.contains(from) ||
+      digest != message.state_digest()) {
+    ++metrics->messages_reregister_slave;
+
+    LOG(INFO) << "Ignoring re-registration of agent " << message.slave().id()
+              << " at " << from << " (" << message.slave().hostname() << ")"
+              << " with a state digest that does not match the master's"
+              << " view of the agent; awaiting the full state";
+    return;
+  }
+
+  vector<ExecutorInfo> executorInfos;
+  vector<Task> tasks;
+  vector<FrameworkInfo> frameworks;
+
+  foreachkey (const FrameworkID& frameworkId, slave->executors) {
+    foreachvalue (const ExecutorInfo& executorInfo,
+                  slave->executors.at(frameworkId)) {
+      executorInfos.push_back(executorInfo);
+    }
+  }
+
+  foreachkey (const FrameworkID& frameworkId, slave->tasks) {
+    foreachvalue (const Task* task, slave->tasks.at(frameworkId)) {
+      tasks.push_back(*task);
+    }
+  }
+
+  foreach (const FrameworkID& frameworkId,
+           slave->tasks.keys() | slave->executors.keys()) {
+    Framework* framework = getFramework(frameworkId);
+    if (framework != nullptr) {
+      frameworks.push_back(framework->info);
+    }
+  }
+
+  reregisterSlave(
+      from,
+      message.slave(),
+      convert(message.checkpointed_resources()),
+      executorInfos,
+      tasks,
+      frameworks,
+      {},
+      message.version(),
+      convert(message.agent_capabilities()));
+}
+
+
 void Master::reregisterSlave(
     const UPID& from,
     const SlaveInfo& slaveInfo,
@@ -5490,6 +5867,8 @@ void Master::reregisterSlave(
     slave->reregisteredTime = Clock::now();
     slave->capabilities = agentCapabilities;
 
+    slave->stateChanged();
+
     // Reconcile tasks between master and slave, and send the
     // `SlaveReregisteredMessage`.
     reconcileKnownSlave(slave, executorInfos, tasks);
@@ -5503,9 +5882,10 @@ void Master::reregisterSlave(
       Clock::cancel(slave->reregistrationTimer.get());
 
       slave->connected = true;
-      dispatch(slave->observer, &SlaveObserver::reconnect);
+      dispatch(slaves.observer, &SlaveObserver::reconnect, slave->id);
 
       slave->active = true;
+      slaves.activeUnreserved += unreservedScalars(slave);
       allocator->activateSlave(slave->id);
     }
 
@@ -5540,7 +5920,14 @@ void Master::reregisterSlave(
   // readmit it. If the slave isn't in the unreachable list (which
   // might occur if the slave's entry in the unreachable list is
   // GC'd), we admit the slave anyway.
-  registrar->apply(Owned<Operation>(new MarkSlaveReachable(slaveInfo)))
+  //
+  // NOTE: After a master failover, all agents re-register at about
+  // the same time. The registrar stores their operations in batches
+  // (see `--registry_batch_interval`) and does not store the registry
+  // for agents that are already admitted, so each re-registration
+  // does not cost a store of the registry.
+  metrics->slave_readmission.time(
+      registrar->apply(Owned<Operation>(new MarkSlaveReachable(slaveInfo))))
     .onAny(defer(self(),
                  &Self::_reregisterSlave,
                  slaveInfo,
@@ -5586,6 +5973,7 @@ void Master::_reregisterSlave(
   // Ensure we don't remove the slave for not re-registering after
   // we've recovered it from the registry.
   slaves.recovered.erase(slaveInfo.id());
+  ++stateGeneration;
 
   MachineID machineId;
   machineId.set_hostname(slaveInfo.hostname());
@@ -5686,11 +6074,13 @@ void Master::_reregisterSlave(
       tasks_);
 
   slave->reregisteredTime = Clock::now();
+  slave->stateChanged();
 
   ++metrics->slave_reregistrations;
 
   slaves.removed.erase(slave->id);
   slaves.unreachable.erase(slave->id);
+  ++stateGeneration;
 
   addSlave(slave, completedFrameworks);
 
@@ -5698,6 +6088,8 @@ void Master::_reregisterSlave(
     flags.agent_ping_timeout * flags.max_agent_ping_timeouts;
   MasterSlaveConnection connection;
   connection.set_total_ping_timeout_seconds(pingTimeout.secs());
+  connection.set_batched_status_updates(true);
+  connection.set_state_digests(true);
 
   SlaveReregisteredMessage message;
   message.mutable_slave_id()->CopyFrom(slave->id);
@@ -5876,6 +6268,51 @@ void Master::updateSlave(
   LOG(INFO) << "Received update of agent " << *slave << " with total"
             << " oversubscribed resources " <<  oversubscribedResources;
 
+  // When coalescing, only the latest update of each agent is applied,
+  // together with those of the other agents, once per allocation
+  // interval.
+  if (flags.coalesce_agent_updates) {
+    if (pendingSlaveUpdates.empty()) {
+      delay(flags.allocation_interval, self(), &Self::applySlaveUpdates);
+    }
+
+    pendingSlaveUpdates[slaveId] = oversubscribedResources;
+    return;
+  }
+
+  _updateSlave(slave, oversubscribedResources);
+}
+
+
+void Master::applySlaveUpdates()
+{
+  hashmap<SlaveID, Resources> updates;
+  std::swap(updates, pendingSlaveUpdates);
+
+  VLOG(1) << "Applying coalesced updates of " << updates.size() << " agents";
+
+  foreachpair (const SlaveID& slaveId,
+               const Resources& oversubscribedResources,
+               updates) {
+    // The agent might have been removed since its update was received.
+    Slave* slave = slaves.registered.get(slaveId);
+    if (slave == nullptr) {
+      continue;
+    }
+
+    _updateSlave(slave, oversubscribedResources);
+  }
+}
+
+
+void Master::_updateSlave(
+    Slave* slave,
+    const Resources& oversubscribedResources)
+{
+  CHECK_NOTNULL(slave);
+
+  const SlaveID& slaveId = slave->id;
+
   // NOTE: We must *first* update the agent's resources before we
   // recover the resources. If we recovered the resources first,
   // an allocation could trigger between recovering resources and
@@ -5885,6 +6322,8 @@ void Master::updateSlave(
   slave->totalResources =
     slave->totalResources.nonRevocable() + oversubscribedResources.revocable();
 
+  slave->stateChanged();
+
   // First update the agent's resources in the allocator.
   allocator->updateSlave(slaveId, oversubscribedResources);
 
@@ -5944,12 +6383,7 @@ void Master::updateUnavailability(
 
       // Remove and rescind offers since we want to inform frameworks of the
       // unavailability change as soon as possible.
-      foreach (Offer* offer, utils::copy(slave->offers)) {
-        allocator->recoverResources(
-            offer->framework_id(), slave->id, offer->resources(), None());
-
-        removeOffer(offer, true); // Rescind!
-      }
+      rescindOffers(slave);
 
       // Remove and rescind inverse offers since the allocator will send new
       // inverse offers for the updated unavailability.
@@ -6073,6 +6507,18 @@ void Master::statusUpdate(StatusUpdate update, const UPID& pid)
 }
 
 
+void Master::statusUpdates(
+    const UPID& from,
+    const StatusUpdatesMessage& message)
+{
+  ++metrics->messages_status_updates;
+
+  foreach (const StatusUpdate& update, message.updates()) {
+    statusUpdate(update, message.pid());
+  }
+}
+
+
 void Master::forward(
     const StatusUpdate& update,
     const UPID& acknowledgee,
@@ -6306,9 +6752,15 @@ void Master::_markUnreachable(
   // resources in the allocator, because the "Sorters" are updated
   // only within recoverResources() (see MESOS-621). The calls to
   // recoverResources() below are therefore required, even though
-  // the slave is already removed.
+  // the slave is already removed. They are batched, so that there is
+  // one allocator call per framework on the slave.
   allocator->removeSlave(slave->id);
 
+  startRecoveries();
+
+  const string unreachable =
+    "Agent " + slave->info.hostname() + " is unreachable: " + message;
+
   // Transition tasks to TASK_UNREACHABLE / TASK_LOST and remove them.
   // We only use TASK_UNREACHABLE if the framework has opted in to the
   // PARTITION_AWARE capability.
@@ -6342,7 +6794,7 @@ void Master::_markUnreachable(
           newTaskState,
           TaskStatus::SOURCE_MASTER,
           None(),
-          "Agent " + slave->info.hostname() + " is unreachable: " + message,
+          unreachable,
           TaskStatus::REASON_SLAVE_REMOVED,
           (task->has_executor_id() ?
               Option<ExecutorID>(task->executor_id()) : None()),
@@ -6375,15 +6827,11 @@ void Master::_markUnreachable(
     }
   }
 
-  foreach (Offer* offer, utils::copy(slave->offers)) {
-    // TODO(vinod): We don't need to call 'Allocator::recoverResources'
-    // once MESOS-621 is fixed.
-    allocator->recoverResources(
-        offer->framework_id(), slave->id, offer->resources(), None());
+  // TODO(vinod): We don't need to call 'Allocator::recoverResources'
+  // once MESOS-621 is fixed.
+  rescindOffers(slave);
 
-    // Remove and rescind offers.
-    removeOffer(offer, true); // Rescind!
-  }
+  finishRecoveries();
 
   // Remove inverse offers because sending them for a slave that is
   // unreachable doesn't make sense.
@@ -6394,8 +6842,14 @@ void Master::_markUnreachable(
     removeInverseOffer(inverseOffer, true); // Rescind!
   }
 
+  if (slave->active) {
+    slaves.activeUnreserved -= unreservedScalars(slave);
+  }
+
   // Mark the slave as being unreachable.
   slaves.registered.remove(slave);
+  ++stateGeneration;
+  summaryRemovals.add(stateGeneration, slave->id);
   slaves.removed.put(slave->id, Nothing());
   slaves.unreachable[slave->id] = unreachableTime;
   authenticated.erase(slave->pid);
@@ -6405,10 +6859,8 @@ void Master::_markUnreachable(
   CHECK(machines[slave->machineId].slaves.contains(slave->id));
   machines[slave->machineId].slaves.erase(slave->id);
 
-  // Kill the slave observer.
-  terminate(slave->observer);
-  wait(slave->observer);
-  delete slave->observer;
+  // Stop observing the slave.
+  dispatch(slaves.observer, &SlaveObserver::remove, slave->id);
 
   // TODO(benh): unlink(slave->pid);
 
@@ -6477,6 +6929,23 @@ void Master::_reconcileTasks(
     LOG(INFO) << "Performing implicit task state reconciliation"
                  " for framework " << *framework;
 
+    if (framework->capabilities.batchedReconciliation) {
+      shared_ptr<vector<TaskID>> taskIds(new vector<TaskID>());
+      taskIds->reserve(framework->pendingTasks.size() +
+                       framework->tasks.size());
+
+      foreachkey (const TaskID& taskId, framework->pendingTasks) {
+        taskIds->push_back(taskId);
+      }
+
+      foreachkey (const TaskID& taskId, framework->tasks) {
+        taskIds->push_back(taskId);
+      }
+
+      sendReconciliationUpdates(framework->id(), taskIds, 0);
+      return;
+    }
+
     foreachvalue (const TaskInfo& task, framework->pendingTasks) {
       const StatusUpdate& update = protobuf::createStatusUpdate(
           framework->id(),
@@ -6687,6 +7156,88 @@ void Master::_reconcileTasks(
 }
 
 
+void Master::sendReconciliationUpdates(
+    const FrameworkID& frameworkId,
+    const shared_ptr<vector<TaskID>>& taskIds,
+    size_t offset)
+{
+  Framework* framework = getFramework(frameworkId);
+
+  // The framework may have been removed since the previous batch.
+  if (framework == nullptr) {
+    return;
+  }
+
+  // The statuses are created when their batch is sent, so they are
+  // not stale. Tasks that have been removed since the implicit
+  // reconciliation started are skipped: the framework has already
+  // received their terminal status.
+  StatusUpdatesMessage message;
+  message.set_pid(UPID());
+
+  const size_t end =
+    std::min(offset + RECONCILIATION_BATCH_SIZE, taskIds->size());
+
+  for (size_t i = offset; i < end; i++) {
+    const TaskID& taskId = taskIds->at(i);
+    Task* task = framework->getTask(taskId);
+
+    if (framework->pendingTasks.contains(taskId)) {
+      const TaskInfo& task_ = framework->pendingTasks[taskId];
+
+      message.add_updates()->CopyFrom(protobuf::createStatusUpdate(
+          framework->id(),
+          task_.slave_id(),
+          task_.task_id(),
+          TASK_STAGING,
+          TaskStatus::SOURCE_MASTER,
+          None(),
+          "Reconciliation: Latest task state",
+          TaskStatus::REASON_RECONCILIATION));
+    } else if (task != nullptr) {
+      const TaskState& state = task->has_status_update_state()
+          ? task->status_update_state()
+          : task->state();
+
+      const Option<ExecutorID> executorId = task->has_executor_id()
+          ? Option<ExecutorID>(task->executor_id())
+          : None();
+
+      message.add_updates()->CopyFrom(protobuf::createStatusUpdate(
+          framework->id(),
+          task->slave_id(),
+          task->task_id(),
+          state,
+          TaskStatus::SOURCE_MASTER,
+          None(),
+          "Reconciliation: Latest task state",
+          TaskStatus::REASON_RECONCILIATION,
+          executorId,
+          protobuf::getTaskHealth(*task),
+          protobuf::getTaskCheckStatus(*task),
+          None(),
+          protobuf::getTaskContainerStatus(*task)));
+    }
+  }
+
+  VLOG(1) << "Sending " << message.updates_size()
+          << " implicit reconciliation states to framework " << *framework;
+
+  if (message.updates_size() > 0) {
+    framework->send(message);
+  }
+
+  if (end < taskIds->size()) {
+    dispatch(
+        self(),
+        &Self::sendReconciliationUpdates,
+        frameworkId,
+        taskIds,
+        end);
+  }
+}
+
+
 void Master::frameworkFailoverTimeout(const FrameworkID& frameworkId,
                                       const Time& reregisteredTime)
 {
@@ -6713,9 +7264,7 @@ void Master::offer(const FrameworkID& frameworkId,
                  << frameworkId << " because the framework"
                  << " has terminated or is inactive";
 
-    foreachpair (const SlaveID& slaveId, const Resources& offered, resources) {
-      allocator->recoverResources(frameworkId, slaveId, offered, None());
-    }
+    allocator->recoverResources(frameworkId, resources, None());
     return;
   }
 
@@ -6723,7 +7272,7 @@ void Master::offer(const FrameworkID& frameworkId,
   ResourceOffersMessage message;
 
   Framework* framework = CHECK_NOTNULL(frameworks.registered[frameworkId]);
-  foreachpair (const SlaveID& slaveId, const Resources& offered, resources) {
+  foreachpair (const SlaveID& slaveId, Resources offered, resources) {
     if (!slaves.registered.contains(slaveId)) {
       LOG(WARNING)
         << "Master returning resources offered to framework " << *framework
@@ -6771,6 +7320,23 @@ void Master::offer(const FrameworkID& frameworkId,
     }
 #endif // WITH_NETWORK_ISOLATOR
 
+    // A framework with the COALESCED_OFFERS capability holds at most
+    // one offer per agent, so an outstanding offer is replaced by the
+    // new one, which also includes its resources. These resources are
+    // still allocated to the framework, hence they are not recovered.
+    if (framework->capabilities.coalescedOffers &&
+        slave->frameworkOffers.contains(framework->id())) {
+      foreach (Offer* outstanding,
+               utils::copy(slave->frameworkOffers.at(framework->id()))) {
+        LOG(INFO) << "Coalescing offer " << outstanding->id()
+                  << " of framework " << *framework
+                  << " on agent " << *slave << " into a new offer";
+
+        offered += outstanding->resources();
+        removeOffer(outstanding, true); // Rescind!
+      }
+    }
+
     // TODO(vinod): Split regular and revocable resources into
     // separate offers, so that rescinding offers with revocable
     // resources does not affect offers with regular resources.
@@ -7015,6 +7581,26 @@ void Master::authenticate(const UPID& from, const UPID& pid)
     return;
   }
 
+  if (pendingAuthentications.contains(pid) ||
+      (flags.max_concurrent_authentications.isSome() &&
+       authenticating.size() >= flags.max_concurrent_authentications.get())) {
+    LOG(INFO) << "Queuing up authentication request from " << pid
+              << " because " << authenticating.size()
+              << " authentications are in progress";
+
+    // A client that retries while its request is queued up keeps its
+    // place in the queue, we only reply to its latest authenticatee.
+    pendingAuthentications[pid] = from;
+
+    return;
+  }
+
+  startAuthentication(from, pid);
+}
+
+
+void Master::startAuthentication(const UPID& from, const UPID& pid)
+{
   LOG(INFO) << "Authenticating " << pid;
 
   // Start authentication.
@@ -7053,6 +7639,16 @@ void Master::_authenticate(
 
   CHECK(authenticating.contains(pid));
   authenticating.erase(pid);
+
+  // Start the oldest queued up authentication, if any.
+  if (!pendingAuthentications.empty()) {
+    const UPID next = pendingAuthentications.begin()->first;
+    const UPID from = pendingAuthentications.begin()->second;
+
+    pendingAuthentications.erase(next);
+
+    startAuthentication(from, next);
+  }
 }
 
 
@@ -7098,6 +7694,8 @@ void Master::reconcileKnownSlave(
     flags.agent_ping_timeout * flags.max_agent_ping_timeouts;
   MasterSlaveConnection connection;
   connection.set_total_ping_timeout_seconds(pingTimeout.secs());
+  connection.set_batched_status_updates(true);
+  connection.set_state_digests(true);
 
   SlaveReregisteredMessage reregistered;
   reregistered.mutable_slave_id()->CopyFrom(slave->id);
@@ -7243,6 +7841,7 @@ void Master::addFramework(Framework* framework)
     << "Framework " << *framework << " already exists!";
 
   frameworks.registered[framework->id()] = framework;
+  ++stateGeneration;
 
   if (framework->connected()) {
     if (framework->pid.isSome()) {
@@ -7383,6 +7982,7 @@ Try<Nothing> Master::activateRecoveredFramework(
 
   // Activate the framework.
   framework->state = Framework::State::ACTIVE;
+  framework->stateChanged();
   allocator->activateFramework(framework->id());
 
   // Export framework metrics if a principal is specified in `FrameworkInfo`.
@@ -7514,13 +8114,17 @@ void Master::failoverFramework(Framework* framework, const UPID& newPid)
 void Master::_failoverFramework(Framework* framework)
 {
   // Remove the framework's offers (if they weren't removed before).
-  foreach (Offer* offer, utils::copy(framework->offers)) {
-    allocator->recoverResources(
-        offer->framework_id(), offer->slave_id(), offer->resources(), None());
+  // All offers of the framework are removed, hence we recover all of
+  // its offered resources.
+  const hashmap<SlaveID, Resources> recovered =
+    framework->offeredResources;
 
+  foreach (Offer* offer, utils::copy(framework->offers)) {
     removeOffer(offer);
   }
 
+  allocator->recoverResources(framework->id(), recovered, None());
+
   // Also remove the inverse offers.
   foreach (InverseOffer* inverseOffer, utils::copy(framework->inverseOffers)) {
     allocator->updateInverseOffer(
@@ -7541,6 +8145,7 @@ void Master::_failoverFramework(Framework* framework)
   // the allocator has the correct view of the framework's share.
   if (!framework->active()) {
     framework->state = Framework::State::ACTIVE;
+    framework->stateChanged();
     allocator->activateFramework(framework->id());
   }
 
@@ -7582,19 +8187,26 @@ void Master::removeFramework(Framework* framework)
   CHECK(framework->offers.empty());
   CHECK(framework->inverseOffers.empty());
 
+  ShutdownFrameworkMessage shutdown;
+  shutdown.mutable_framework_id()->MergeFrom(framework->id());
+
   foreachvalue (Slave* slave, slaves.registered) {
     // Remove the pending tasks from the slave.
     slave->pendingTasks.erase(framework->id());
 
     // Tell slaves to shutdown the framework.
-    ShutdownFrameworkMessage message;
-    message.mutable_framework_id()->MergeFrom(framework->id());
-    send(slave->pid, message);
+    send(slave->pid, shutdown);
   }
 
   // Remove the pending tasks from the framework.
   framework->pendingTasks.clear();
 
+  // The resources of the tasks and executors are recovered at once,
+  // once all of them are removed.
+  startRecoveries();
+
+  const string message = "Framework " + framework->id().value() + " removed";
+
   // Remove pointers to the framework's tasks in slaves and mark those
   // tasks as completed.
   foreachvalue (Task* task, utils::copy(framework->tasks)) {
@@ -7630,7 +8242,7 @@ void Master::removeFramework(Framework* framework)
         TASK_KILLED,
         TaskStatus::SOURCE_MASTER,
         None(),
-        "Framework " + framework->id().value() + " removed",
+        message,
         TaskStatus::REASON_FRAMEWORK_REMOVED,
         (task->has_executor_id()
          ? Option<ExecutorID>(task->executor_id())
@@ -7655,7 +8267,7 @@ void Master::removeFramework(Framework* framework)
         TASK_KILLED,
         TaskStatus::SOURCE_MASTER,
         None(),
-        "Framework " + framework->id().value() + " removed",
+        message,
         TaskStatus::REASON_FRAMEWORK_REMOVED,
         (task->has_executor_id()
          ? Option<ExecutorID>(task->executor_id())
@@ -7684,6 +8296,8 @@ void Master::removeFramework(Framework* framework)
     }
   }
 
+  finishRecoveries();
+
   // TODO(benh): Similar code between removeFramework and
   // failoverFramework needs to be shared!
 
@@ -7695,6 +8309,7 @@ void Master::removeFramework(Framework* framework)
   }
 
   framework->unregisteredTime = Clock::now();
+  framework->stateChanged();
 
   auto removeFrameworkRole = [this](Framework* framework, const string& role) {
     CHECK(isWhitelistedRole(role))
@@ -7739,6 +8354,8 @@ void Master::removeFramework(Framework* framework)
 
   // Remove the framework.
   frameworks.registered.erase(framework->id());
+  ++stateGeneration;
+  summaryRemovals.add(stateGeneration, framework->info);
   allocator->removeFramework(framework->id());
 
   // The framework pointer is now owned by `frameworks.completed`.
@@ -7754,6 +8371,10 @@ void Master::removeFramework(Slave* slave, Framework* framework)
   LOG(INFO) << "Removing framework " << *framework
             << " from agent " << *slave;
 
+  startRecoveries();
+
+  const string message = "Agent " + slave->info.hostname() + " disconnected";
+
   // Remove pointers to framework's tasks in slaves, and send status
   // updates.
   // NOTE: A copy is needed because removeTask modifies slave->tasks.
@@ -7770,7 +8391,7 @@ void Master::removeFramework(Slave* slave, Framework* framework)
         TASK_LOST,
         TaskStatus::SOURCE_MASTER,
         None(),
-        "Agent " + slave->info.hostname() + " disconnected",
+        message,
         TaskStatus::REASON_SLAVE_DISCONNECTED,
         (task->has_executor_id()
             ? Option<ExecutorID>(task->executor_id()) : None()));
@@ -7792,6 +8413,8 @@ void Master::removeFramework(Slave* slave, Framework* framework)
       removeExecutor(slave, framework->id(), executorId);
     }
   }
+
+  finishRecoveries();
 }
 
 
@@ -7805,6 +8428,11 @@ void Master::addSlave(
   CHECK(slaves.removed.get(slave->id).isNone());
 
   slaves.registered.put(slave);
+  ++stateGeneration;
+
+  if (slave->active) {
+    slaves.activeUnreserved += unreservedScalars(slave);
+  }
 
   link(slave->pid);
 
@@ -7812,18 +8440,8 @@ void Master::addSlave(
   CHECK(!machines[slave->machineId].slaves.contains(slave->id));
   machines[slave->machineId].slaves.insert(slave->id);
 
-  // Set up an observer for the slave.
-  slave->observer = new SlaveObserver(
-      slave->pid,
-      slave->info,
-      slave->id,
-      self(),
-      slaves.limiter,
-      metrics,
-      flags.agent_ping_timeout,
-      flags.max_agent_ping_timeouts);
-
-  spawn(slave->observer);
+  // Start observing the slave.
+  dispatch(slaves.observer, &SlaveObserver::add, slave->pid, slave->id);
 
   // Add the slave's executors to the frameworks.
   foreachkey (const FrameworkID& frameworkId, slave->executors) {
@@ -7908,7 +8526,7 @@ void Master::addSlave(
       slave->totalResources,
       slave->usedResources);
 
-  if (!subscribers.subscribed.empty()) {
+  if (subscribers.enabled()) {
     subscribers.send(protobuf::master::event::createAgentAdded(*slave));
   }
 }
@@ -7995,9 +8613,15 @@ void Master::_removeSlave(
   // resources in the allocator, because the "Sorters" are updated
   // only within recoverResources() (see MESOS-621). The calls to
   // recoverResources() below are therefore required, even though
-  // the slave is already removed.
+  // the slave is already removed. They are batched, so that there is
+  // one allocator call per framework on the slave.
   allocator->removeSlave(slave->id);
 
+  startRecoveries();
+
+  const string message =
+    "Agent " + slave->info.hostname() + " removed: " + removalCause;
+
   // Transition the tasks to lost and remove them.
   foreachkey (const FrameworkID& frameworkId, utils::copy(slave->tasks)) {
     Framework* framework = getFramework(frameworkId);
@@ -8010,7 +8634,7 @@ void Master::_removeSlave(
           TASK_LOST,
           TaskStatus::SOURCE_MASTER,
           None(),
-          "Agent " + slave->info.hostname() + " removed: " + removalCause,
+          message,
           TaskStatus::REASON_SLAVE_REMOVED,
           (task->has_executor_id() ?
               Option<ExecutorID>(task->executor_id()) : None()));
@@ -8035,15 +8659,11 @@ void Master::_removeSlave(
     }
   }
 
-  foreach (Offer* offer, utils::copy(slave->offers)) {
-    // TODO(vinod): We don't need to call 'Allocator::recoverResources'
-    // once MESOS-621 is fixed.
-    allocator->recoverResources(
-        offer->framework_id(), slave->id, offer->resources(), None());
+  // TODO(vinod): We don't need to call 'Allocator::recoverResources'
+  // once MESOS-621 is fixed.
+  rescindOffers(slave);
 
-    // Remove and rescind offers.
-    removeOffer(offer, true); // Rescind!
-  }
+  finishRecoveries();
 
   // Remove inverse offers because sending them for a slave that is
   // gone doesn't make sense.
@@ -8057,8 +8677,14 @@ void Master::_removeSlave(
   // Remove the pending tasks from the slave.
   slave->pendingTasks.clear();
 
+  if (slave->active) {
+    slaves.activeUnreserved -= unreservedScalars(slave);
+  }
+
   // Mark the slave as being removed.
   slaves.registered.remove(slave);
+  ++stateGeneration;
+  summaryRemovals.add(stateGeneration, slave->id);
   slaves.removed.put(slave->id, Nothing());
   authenticated.erase(slave->pid);
 
@@ -8067,16 +8693,14 @@ void Master::_removeSlave(
   CHECK(machines[slave->machineId].slaves.contains(slave->id));
   machines[slave->machineId].slaves.erase(slave->id);
 
-  // Kill the slave observer.
-  terminate(slave->observer);
-  wait(slave->observer);
-  delete slave->observer;
+  // Stop observing the slave.
+  dispatch(slaves.observer, &SlaveObserver::remove, slave->id);
 
   // TODO(benh): unlink(slave->pid);
 
   sendSlaveLost(slave->info);
 
-  if (!subscribers.subscribed.empty()) {
+  if (subscribers.enabled()) {
     subscribers.send(protobuf::master::event::createAgentRemoved(slave->id));
   }
 
@@ -8088,6 +8712,19 @@ void Master::updateTask(Task* task, const StatusUpdate& update)
 {
   CHECK_NOTNULL(task);
 
+  // The task is part of the state of both its framework and its agent.
+  ++stateGeneration;
+
+  Framework* framework = getFramework(task->framework_id());
+  if (framework != nullptr) {
+    framework->stateChanged();
+  }
+
+  Slave* slave = slaves.registered.get(task->slave_id());
+  if (slave != nullptr) {
+    slave->stateChanged();
+  }
+
   // Get the unacknowledged status.
   const TaskStatus& status = update.status();
 
@@ -8149,9 +8786,12 @@ void Master::updateTask(Task* task, const StatusUpdate& update)
   // MESOS-1746.
   task->mutable_statuses(task->statuses_size() - 1)->clear_data();
 
-  if (sendSubscribersUpdate && !subscribers.subscribed.empty()) {
-    subscribers.send(protobuf::master::event::createTaskUpdated(
-        *task, task->state(), status));
+  if (sendSubscribersUpdate && subscribers.enabled()) {
+    subscribers.send(
+        protobuf::master::event::createTaskUpdated(
+            *task, task->state(), status),
+        task,
+        getFramework(task->framework_id()));
   }
 
   LOG(INFO) << "Updating the state of task " << task->task_id()
@@ -8161,19 +8801,13 @@ void Master::updateTask(Task* task, const StatusUpdate& update)
 
   // Once the task becomes removable, recover the resources.
   if (removable) {
-    allocator->recoverResources(
-        task->framework_id(),
-        task->slave_id(),
-        task->resources(),
-        None());
+    recoverResources(task->framework_id(), task->slave_id(), task->resources());
 
     // The slave owns the Task object and cannot be nullptr.
-    Slave* slave = slaves.registered.get(task->slave_id());
     CHECK_NOTNULL(slave);
 
     slave->recoverResources(task);
 
-    Framework* framework = getFramework(task->framework_id());
     if (framework != nullptr) {
       framework->recoverResources(task);
     }
@@ -8242,11 +8876,7 @@ void Master::removeTask(Task* task)
 
     // If the task is not removable, then the resources have
     // not yet been recovered.
-    allocator->recoverResources(
-        task->framework_id(),
-        task->slave_id(),
-        task->resources(),
-        None());
+    recoverResources(task->framework_id(), task->slave_id(), task->resources());
   } else {
     LOG(INFO) << "Removing task " << task->task_id()
               << " with resources " << task->resources()
@@ -8281,8 +8911,7 @@ void Master::removeExecutor(
             << "' with resources " << executor.resources()
             << " of framework " << frameworkId << " on agent " << *slave;
 
-  allocator->recoverResources(
-      frameworkId, slave->id, executor.resources(), None());
+  recoverResources(frameworkId, slave->id, executor.resources());
 
   Framework* framework = getFramework(frameworkId);
   if (framework != nullptr) { // The framework might not be re-registered yet.
@@ -8293,6 +8922,42 @@ void Master::removeExecutor(
 }
 
 
+void Master::recoverResources(
+    const FrameworkID& frameworkId,
+    const SlaveID& slaveId,
+    const Resources& resources)
+{
+  if (recoveryBatches == 0) {
+    allocator->recoverResources(frameworkId, slaveId, resources, None());
+  } else if (!resources.empty()) {
+    recoveries[frameworkId][slaveId] += resources;
+  }
+}
+
+
+void Master::startRecoveries()
+{
+  ++recoveryBatches;
+}
+
+
+void Master::finishRecoveries()
+{
+  CHECK_GT(recoveryBatches, 0u);
+
+  if (--recoveryBatches > 0) {
+    return;
+  }
+
+  foreachkey (const FrameworkID& frameworkId, recoveries) {
+    allocator->recoverResources(
+        frameworkId, recoveries.at(frameworkId), None());
+  }
+
+  recoveries.clear();
+}
+
+
 Future<Nothing> Master::apply(Slave* slave, const Offer::Operation& operation)
 {
   CHECK_NOTNULL(slave);
@@ -8369,6 +9034,34 @@ void Master::removeOffer(Offer* offer, bool rescind)
 }
 
 
+void Master::rescindOffers(Slave* slave)
+{
+  CHECK_NOTNULL(slave);
+
+  const hashmap<FrameworkID, hashset<Offer*>> offers = slave->frameworkOffers;
+
+  foreachpair (const FrameworkID& frameworkId,
+               const hashset<Offer*>& frameworkOffers,
+               offers) {
+    Framework* framework = getFramework(frameworkId);
+    CHECK(framework != nullptr)
+      << "Unknown framework " << frameworkId
+      << " with offers on agent " << *slave;
+
+    // All offers of the framework on the agent are removed, hence we
+    // recover all of its offered resources on the agent.
+    Option<Resources> offered = framework->offeredResources.get(slave->id);
+    if (offered.isSome()) {
+      recoverResources(frameworkId, slave->id, offered.get());
+    }
+
+    foreach (Offer* offer, frameworkOffers) {
+      removeOffer(offer, true); // Rescind!
+    }
+  }
+}
+
+
 void Master::inverseOfferTimeout(const OfferID& inverseOfferId)
 {
   InverseOffer* inverseOffer = getInverseOffer(inverseOfferId);
@@ -8780,14 +9473,113 @@ static bool isValidFailoverTimeout(const FrameworkInfo& frameworkInfo)
 }
 
 
-void Master::Subscribers::send(const mesos::master::Event& event)
+void Master::Subscribers::send(
+    mesos::master::Event event,
+    const Task* task,
+    const Framework* framework)
 {
   VLOG(1) << "Notifying all active subscribers about " << event.type() << " "
           << "event";
 
+  event.set_sequence(++sequence);
+
+  Record record;
+  record.event = std::move(event);
+
+  if (task != nullptr) {
+    record.frameworkId = task->framework_id();
+    record.labels = task->labels();
+  }
+
+  if (framework != nullptr) {
+    record.roles = protobuf::framework::getRoles(framework->info);
+  }
+
+  // The filters are applied before the event is evolved and
+  // serialized, which is done at most once per content type rather
+  // than once per subscriber.
+  map<ContentType, string> encoded;
+
   foreachvalue (const Owned<Subscriber>& subscriber, subscribed) {
-    subscriber->http.send<mesos::master::Event, v1::master::Event>(event);
+    if (!subscriber->accepts(record)) {
+      continue;
+    }
+
+    const ContentType contentType = subscriber->http.contentType;
+
+    if (!encoded.count(contentType)) {
+      ::recordio::Encoder<v1::master::Event> encoder(
+          lambda::bind(serialize, contentType, lambda::_1));
+
+      encoded[contentType] = encoder.encode(evolve(record.event));
+    }
+
+    subscriber->http.writer.write(encoded.at(contentType));
+  }
+
+  if (history.capacity() > 0) {
+    history.push_back(std::move(record));
+  }
+}
+
+
+bool Master::Subscribers::Subscriber::accepts(const Record& record) const
+{
+  const mesos::master::Event& event = record.event;
+
+  if (!subscribe.event_types().empty() &&
+      std::find(
+          subscribe.event_types().begin(),
+          subscribe.event_types().end(),
+          event.type()) == subscribe.event_types().end()) {
+    return false;
+  }
+
+  // The remaining filters only apply to task events.
+  if (event.type() != mesos::master::Event::TASK_ADDED &&
+      event.type() != mesos::master::Event::TASK_UPDATED) {
+    return true;
+  }
+
+  if (!subscribe.framework_ids().empty() &&
+      (record.frameworkId.isNone() ||
+       std::find(
+           subscribe.framework_ids().begin(),
+           subscribe.framework_ids().end(),
+           record.frameworkId.get()) == subscribe.framework_ids().end())) {
+    return false;
+  }
+
+  if (!subscribe.roles().empty()) {
+    bool matches = false;
+    foreach (const string& role, subscribe.roles()) {
+      if (record.roles.count(role) > 0) {
+        matches = true;
+        break;
+      }
+    }
+
+    if (!matches) {
+      return false;
+    }
   }
+
+  foreach (const Label& filter, subscribe.labels()) {
+    bool matches = false;
+    foreach (const Label& label, record.labels.labels()) {
+      if (label.key() == filter.key() &&
+          (!filter.has_value() || label.value() == filter.value())) {
+        matches = true;
+        break;
+      }
+    }
+
+    if (!matches) {
+      return false;
+    }
+  }
+
+  return true;
 }
 
 
@@ -8802,7 +9594,9 @@ void Master::exited(const UUID& id)
 }
 
 
-void Master::subscribe(const HttpConnection& http)
+void Master::subscribe(
+    const HttpConnection& http,
+    const mesos::master::Call::Subscribe& subscribe)
 {
   LOG(INFO) << "Added subscriber: " << http.streamId << " to the "
             << "list of active subscribers";
@@ -8815,7 +9609,8 @@ void Master::subscribe(const HttpConnection& http)
 
   subscribers.subscribed.put(
       http.streamId,
-      Owned<Subscribers::Subscriber>(new Subscribers::Subscriber{http}));
+      Owned<Subscribers::Subscriber>(
+          new Subscribers::Subscriber(http, subscribe)));
 }
 
 
@@ -8831,6 +9626,7 @@ Slave::Slave(
     const vector<ExecutorInfo> executorInfos,
     const vector<Task> tasks)
   : master(_master),
+    stateGeneration(++_master->stateGeneration),
     id(_info.id()),
     info(_info),
     machineId(_machineId),
@@ -8840,8 +9636,7 @@ Slave::Slave(
     registeredTime(_registeredTime),
     connected(true),
     active(true),
-    checkpointedResources(_checkpointedResources),
-    observer(nullptr)
+    checkpointedResources(_checkpointedResources)
 {
   CHECK(_info.has_id());
 
@@ -8883,6 +9678,8 @@ Task* Slave::getTask(const FrameworkID& frameworkId, const TaskID& taskId) const
 
 void Slave::addTask(Task* task)
 {
+  stateChanged();
+
   const TaskID& taskId = task->task_id();
   const FrameworkID& frameworkId = task->framework_id();
 
@@ -8895,8 +9692,11 @@ void Slave::addTask(Task* task)
     usedResources[frameworkId] += task->resources();
   }
 
-  if (!master->subscribers.subscribed.empty()) {
-    master->subscribers.send(protobuf::master::event::createTaskAdded(*task));
+  if (master->subscribers.enabled()) {
+    master->subscribers.send(
+        protobuf::master::event::createTaskAdded(*task),
+        task,
+        master->getFramework(task->framework_id()));
   }
 
   LOG(INFO) << "Adding task " << taskId
@@ -8907,6 +9707,8 @@ void Slave::addTask(Task* task)
 
 void Slave::recoverResources(Task* task)
 {
+  stateChanged();
+
   const TaskID& taskId = task->task_id();
   const FrameworkID& frameworkId = task->framework_id();
 
@@ -8923,6 +9725,8 @@ void Slave::recoverResources(Task* task)
 
 void Slave::removeTask(Task* task)
 {
+  stateChanged();
+
   const TaskID& taskId = task->task_id();
   const FrameworkID& frameworkId = task->framework_id();
 
@@ -8947,24 +9751,36 @@ void Slave::removeTask(Task* task)
 
 void Slave::addOffer(Offer* offer)
 {
+  stateChanged();
+
   CHECK(!offers.contains(offer)) << "Duplicate offer " << offer->id();
 
   offers.insert(offer);
+  frameworkOffers[offer->framework_id()].insert(offer);
   offeredResources += offer->resources();
 }
 
 
 void Slave::removeOffer(Offer* offer)
 {
+  stateChanged();
+
   CHECK(offers.contains(offer)) << "Unknown offer " << offer->id();
 
   offeredResources -= offer->resources();
   offers.erase(offer);
+
+  frameworkOffers[offer->framework_id()].erase(offer);
+  if (frameworkOffers[offer->framework_id()].empty()) {
+    frameworkOffers.erase(offer->framework_id());
+  }
 }
 
 
 void Slave::addInverseOffer(InverseOffer* inverseOffer)
 {
+  stateChanged();
+
   CHECK(!inverseOffers.contains(inverseOffer))
     << "Duplicate inverse offer " << inverseOffer->id();
 
@@ -8974,6 +9790,8 @@ void Slave::addInverseOffer(InverseOffer* inverseOffer)
 
 void Slave::removeInverseOffer(InverseOffer* inverseOffer)
 {
+  stateChanged();
+
   CHECK(inverseOffers.contains(inverseOffer))
     << "Unknown inverse offer " << inverseOffer->id();
 
@@ -8992,6 +9810,8 @@ bool Slave::hasExecutor(const FrameworkID& frameworkId,
 void Slave::addExecutor(const FrameworkID& frameworkId,
                         const ExecutorInfo& executorInfo)
 {
+  stateChanged();
+
   CHECK(!hasExecutor(frameworkId, executorInfo.executor_id()))
     << "Duplicate executor '" << executorInfo.executor_id()
     << "' of framework " << frameworkId;
@@ -9003,6 +9823,8 @@ void Slave::addExecutor(const FrameworkID& frameworkId,
 void Slave::removeExecutor(const FrameworkID& frameworkId,
                            const ExecutorID& executorId)
 {
+  stateChanged();
+
   CHECK(hasExecutor(frameworkId, executorId))
     << "Unknown executor '" << executorId << "' of framework " << frameworkId;
 
@@ -9019,8 +9841,16 @@ void Slave::removeExecutor(const FrameworkID& frameworkId,
 }
 
 
+void Slave::stateChanged()
+{
+  stateGeneration = ++master->stateGeneration;
+}
+
+
 void Slave::apply(const Offer::Operation& operation)
 {
+  stateChanged();
+
   Try<Resources> resources = totalResources.apply(operation);
   CHECK_SOME(resources);
 
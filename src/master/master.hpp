@@ -19,10 +19,13 @@
 
 #include <stdint.h>
 
+#include <algorithm>
+#include <deque>
 #include <list>
 #include <memory>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <boost/circular_buffer.hpp>
@@ -44,17 +47,24 @@
 
 #include <mesos/scheduler/scheduler.hpp>
 
+#include <process/clock.hpp>
+#include <process/delay.hpp>
+#include <process/dispatch.hpp>
 #include <process/limiter.hpp>
 #include <process/http.hpp>
 #include <process/owned.hpp>
 #include <process/process.hpp>
 #include <process/protobuf.hpp>
+#include <process/shared.hpp>
+#include <process/time.hpp>
 #include <process/timer.hpp>
 
 #include <process/metrics/counter.hpp>
 
 #include <stout/boundedhashmap.hpp>
+#include <stout/bytes.hpp>
 #include <stout/cache.hpp>
+#include <stout/flat_hashmap.hpp>
 #include <stout/foreach.hpp>
 #include <stout/hashmap.hpp>
 #include <stout/hashset.hpp>
@@ -104,6 +114,7 @@ class WhitelistWatcher;
 
 namespace master {
 
+class Heartbeater;
 class Master;
 class SlaveObserver;
 
@@ -167,7 +178,14 @@ struct Slave
 
   void apply(const Offer::Operation& operation);
 
+  // Records that the part of the `/state` describing this agent
+  // changed, see `Master::stateGeneration`.
+  void stateChanged();
+
   Master* const master;
+
+  // The `Master::stateGeneration` of the last change to this agent.
+  uint64_t stateGeneration;
   const SlaveID id;
   const SlaveInfo info;
 
@@ -230,6 +248,11 @@ struct Slave
   // Active offers on this slave.
   hashset<Offer*> offers;
 
+  // Active offers on this slave, by the framework they are made to.
+  // Together with `Framework::offeredResources`, this allows all
+  // offers of a framework on this slave to be handled at once.
+  hashmap<FrameworkID, hashset<Offer*>> frameworkOffers;
+
   // Active inverse offers on this slave.
   hashset<InverseOffer*> inverseOffers;
 
@@ -252,8 +275,6 @@ struct Slave
   // includes revocable resources as well.
   Resources totalResources;
 
-  SlaveObserver* observer;
-
 private:
   Slave(const Slave&);              // No copying.
   Slave& operator=(const Slave&); // No assigning.
@@ -391,6 +412,13 @@ public:
       const std::string& version,
       const std::vector<SlaveInfo::Capability>& agentCapabilities);
 
+  // Passes the message on to `reregisterSlave`. If the agent only
+  // sent the digest of its state, the master's view of the agent is
+  // used instead, provided that it matches the digest.
+  void reregisterSlaveMessage(
+      const process::UPID& from,
+      const ReregisterSlaveMessage& message);
+
   void reregisterSlave(
       const process::UPID& from,
       const SlaveInfo& slaveInfo,
@@ -410,6 +438,10 @@ public:
       StatusUpdate update,
       const process::UPID& pid);
 
+  void statusUpdates(
+      const process::UPID& from,
+      const StatusUpdatesMessage& message);
+
   void reconcileTasks(
       const process::UPID& from,
       const FrameworkID& frameworkId,
@@ -426,6 +458,14 @@ public:
       const SlaveID& slaveId,
       const Resources& oversubscribedResources);
 
+  // Applies the latest total oversubscribed resources of an agent.
+  void _updateSlave(
+      Slave* slave,
+      const Resources& oversubscribedResources);
+
+  // Applies the coalesced updates in `pendingSlaveUpdates`.
+  void applySlaveUpdates();
+
   void updateUnavailability(
       const MachineID& machineId,
       const Option<Unavailability>& unavailability);
@@ -487,13 +527,18 @@ protected:
   void agentReregisterTimeout(const SlaveID& slaveId);
   Nothing _agentReregisterTimeout(const SlaveID& slaveId);
 
-  // Invoked when the message is ready to be executed after
-  // being throttled.
+  // Queues an event that exceeded the rate of the limiter until a
+  // permit is available (see 'throttled').
   // 'principal' being None indicates it is throttled by
   // 'defaultLimiter'.
-  void throttled(
-      const process::MessageEvent& event,
-      const Option<std::string>& principal);
+  void throttle(
+      BoundedRateLimiter* limiter,
+      const Option<std::string>& principal,
+      process::Event* event);
+
+  // Invoked when the front event queued by the limiter of 'principal'
+  // is ready to be executed after being throttled.
+  void throttled(const Option<std::string>& principal);
 
   // Continuations of visit().
   void _visit(const process::MessageEvent& event);
@@ -535,6 +580,11 @@ protected:
       const std::vector<Task>& tasks,
       const std::vector<FrameworkInfo>& frameworks);
 
+  // Starts the authentication of 'pid', see `authenticate()`.
+  void startAuthentication(
+      const process::UPID& from,
+      const process::UPID& pid);
+
   // 'future' is the future returned by the authenticator.
   void _authenticate(
       const process::UPID& pid,
@@ -554,6 +604,15 @@ protected:
       Framework* framework,
       const std::vector<TaskStatus>& statuses);
 
+  // Sends the statuses of the specified tasks of a framework with the
+  // BATCHED_RECONCILIATION capability, starting at 'offset', in a
+  // single batch and then dispatches itself for the next batch, so
+  // that an implicit reconciliation of many tasks is paced.
+  void sendReconciliationUpdates(
+      const FrameworkID& frameworkId,
+      const std::shared_ptr<std::vector<TaskID>>& taskIds,
+      size_t offset);
+
   // When a slave that was previously registered with this master
   // re-registers, we need to reconcile the master's view of the
   // slave's tasks and executors.  This function also sends the
@@ -763,6 +822,26 @@ protected:
       const FrameworkID& frameworkId,
       const ExecutorID& executorId);
 
+  // Recovers the resources of the framework on the agent in the
+  // allocator, or adds them to the current batch of recoveries, if
+  // any (see `startRecoveries`).
+  void recoverResources(
+      const FrameworkID& frameworkId,
+      const SlaveID& slaveId,
+      const Resources& resources);
+
+  // Starts a batch of recoveries, e.g., while removing all the tasks
+  // and executors of a framework or of an agent. The resources are
+  // recovered once the (outermost) batch is finished, with one
+  // allocator call per framework rather than one per task, offer and
+  // executor. Batches nest.
+  //
+  // NOTE: The batch must be finished before the framework is removed
+  // from the allocator, since the allocator then considers all the
+  // resources of the framework to be recovered.
+  void startRecoveries();
+  void finishRecoveries();
+
   // Attempts to update the allocator by applying the given operation.
   // If successful, updates the slave's resources, sends a
   // 'CheckpointResourcesMessage' to the slave with the updated
@@ -784,6 +863,10 @@ protected:
   // Remove an offer and optionally rescind the offer as well.
   void removeOffer(Offer* offer, bool rescind = false);
 
+  // Removes and rescinds all offers on the agent, recovering their
+  // resources with a single call per framework.
+  void rescindOffers(Slave* slave);
+
   // Remove an inverse offer after specified timeout
   void inverseOfferTimeout(const OfferID& inverseOfferId);
 
@@ -842,7 +925,9 @@ private:
       const process::Future<bool>& authorized);
 
   // Subscribes a client to the 'api/vX' endpoint.
-  void subscribe(const HttpConnection& http);
+  void subscribe(
+      const HttpConnection& http,
+      const mesos::master::Call::Subscribe& subscribe);
 
   void teardown(Framework* framework);
 
@@ -883,6 +968,18 @@ private:
       Framework* framework,
       const scheduler::Call::Acknowledge& acknowledge);
 
+  // Forwards the acknowledgements for the same agent in a single
+  // `StatusUpdateAcknowledgementsMessage` if the agent supports it.
+  void acknowledge(
+      Framework* framework,
+      const scheduler::Call::AcknowledgeBatch& acknowledgeBatch);
+
+  // Helper for handling an acknowledgement. Returns the agent to
+  // forward the acknowledgement to, or nullptr if it is dropped.
+  Slave* _acknowledge(
+      Framework* framework,
+      const scheduler::Call::Acknowledge& acknowledge);
+
   void reconcile(
       Framework* framework,
       const scheduler::Call::Reconcile& reconcile);
@@ -1128,6 +1225,8 @@ private:
     Master* master;
   };
 
+  struct StateBody;
+
   // Inner class used to namespace HTTP route handlers (see
   // master/http.cpp for implementations).
   class Http
@@ -1289,6 +1388,42 @@ private:
     process::Future<process::http::Response> _teardown(
         const FrameworkID& id) const;
 
+    // Returns the entity tag of the current `/state`, which changes
+    // whenever `stateGeneration` does.
+    std::string stateETag() const;
+
+    // Returns true if the request is conditional on the current
+    // `/state` not matching its `If-None-Match` header, i.e., the
+    // client already has the current state.
+    bool stateNotModified(const process::http::Request& request) const;
+
+    // Writes the fields of `/state` which are selected by `fields`,
+    // other than the agents and frameworks, which are written by the
+    // caller.
+    void writeStateFields(
+        JSON::ObjectWriter* writer,
+        const process::Owned<ObjectApprover>& flagsApprover,
+        const FieldProjection& fields = FieldProjection::all()) const;
+
+    // Serializes the agents and frameworks that changed since the
+    // last snapshot and returns the unauthorized `/state`, which is
+    // assembled and compressed off the master actor.
+    process::Future<process::Shared<StateBody>> snapshotState() const;
+
+    static StateBody assembleState(
+        const std::string& fields,
+        const std::vector<process::Shared<std::string>>& slaves,
+        const std::vector<process::Shared<std::string>>& frameworks,
+        const std::vector<process::Shared<std::string>>& completedFrameworks);
+
+    // Returns the state as a response to a request with the given
+    // `jsonp` query and gzip acceptance.
+    static process::http::Response stateResponse(
+        const StateBody& body,
+        const std::string& etag,
+        const Option<std::string>& jsonp,
+        bool acceptsGzip);
+
     process::Future<process::http::Response> _updateMaintenanceSchedule(
         const mesos::maintenance::Schedule& schedule) const;
 
@@ -1434,9 +1569,12 @@ private:
         const Option<std::string>& principal,
         ContentType contentType) const;
 
+    // Returns all tasks unless `options` selects a page of tasks.
     mesos::master::Response::GetTasks _getTasks(
         const process::Owned<ObjectApprover>& frameworksApprover,
-        const process::Owned<ObjectApprover>& tasksApprover) const;
+        const process::Owned<ObjectApprover>& tasksApprover,
+        const mesos::master::Call::GetTasks& options =
+          mesos::master::Call::GetTasks()) const;
 
     process::Future<process::http::Response> createVolumes(
         const mesos::master::Call& call,
@@ -1563,7 +1701,7 @@ private:
 
   struct Slaves
   {
-    Slaves() : removed(MAX_REMOVED_SLAVES) {}
+    Slaves() : removed(MAX_REMOVED_SLAVES), observer(nullptr) {}
 
     // Imposes a time limit for slaves that we recover from the
     // registry to re-register with the master.
@@ -1648,6 +1786,12 @@ private:
       hashmap<process::UPID, Slave*> pids;
     } registered;
 
+    // The unreserved scalar resources in the `SlaveInfo` of the active
+    // registered slaves. This is maintained as slaves are added,
+    // (de)activated and removed so that the quota capacity heuristic
+    // need not sum them over all slaves on every request.
+    Resources activeUnreserved;
+
     // Slaves that are in the process of being removed from the
     // registrar.
     hashset<SlaveID> removing;
@@ -1681,6 +1825,9 @@ private:
     // a wrapper around libprocess process which is thread safe.
     Option<std::shared_ptr<process::RateLimiter>> limiter;
 
+    // Health checks the registered slaves, see `SlaveObserver`.
+    SlaveObserver* observer;
+
     bool transitioning(const Option<SlaveID>& slaveId)
     {
       if (slaveId.isSome()) {
@@ -1721,16 +1868,35 @@ private:
     Option<process::Owned<BoundedRateLimiter>> defaultLimiter;
   } frameworks;
 
+  // Sends the heartbeats to the HTTP frameworks, see `Heartbeater`.
+  Heartbeater* heartbeater;
+
   struct Subscribers
   {
+    Subscribers(const Flags& masterFlags)
+      : history(masterFlags.max_operator_event_history) {}
+
+    // An event along with what the filters of the subscribers depend
+    // on but the event itself does not carry, e.g., the roles of the
+    // framework of a task event.
+    struct Record
+    {
+      mesos::master::Event event;
+
+      // Only set for task events.
+      Option<FrameworkID> frameworkId;
+      std::set<std::string> roles;
+      Labels labels;
+    };
+
     // Represents a client subscribed to the 'api/vX' endpoint.
-    //
-    // TODO(anand): Add support for filtering. Some subscribers
-    // might only be interested in a subset of events.
     struct Subscriber
     {
-      Subscriber(const HttpConnection& _http)
-        : http(_http) {}
+      Subscriber(
+          const HttpConnection& _http,
+          const mesos::master::Call::Subscribe& _subscribe)
+        : http(_http),
+          subscribe(_subscribe) {}
 
       // Not copyable, not assignable.
       Subscriber(const Subscriber&) = delete;
@@ -1745,18 +1911,44 @@ private:
         http.close();
       }
 
+      // Returns true if the event passes the filters of the subscriber
+      // (see `mesos::master::Call::Subscribe`).
+      bool accepts(const Record& record) const;
+
       HttpConnection http;
+      const mesos::master::Call::Subscribe subscribe;
     };
 
-    // Sends the event to all subscribers connected to the 'api/vX' endpoint.
-    void send(const mesos::master::Event& event);
+    // Returns true if events need to be sent at all, i.e., if there
+    // are subscribers or if events are retained for resuming.
+    bool enabled() const
+    {
+      return !subscribed.empty() || history.capacity() > 0;
+    }
+
+    // Assigns the event the next sequence number, sends it to all
+    // subscribers connected to the 'api/vX' endpoint whose filters it
+    // passes, and retains it for resuming subscriptions. The task (and
+    // its framework, if known) must be passed for task events.
+    void send(
+        mesos::master::Event event,
+        const Task* task = nullptr,
+        const Framework* framework = nullptr);
 
     // Active subscribers to the 'api/vX' endpoint keyed by the stream
     // identifier.
     hashmap<UUID, process::Owned<Subscriber>> subscribed;
+
+    // The sequence number of the last event sent.
+    uint64_t sequence = 0;
+
+    // The most recent events, see `--max_operator_event_history`.
+    boost::circular_buffer<Record> history;
   } subscribers;
 
-  hashmap<OfferID, Offer*> offers;
+  // NOTE: This is a `flat_hashmap` since it is looked up for every
+  // offer that is accepted, declined or rescinded.
+  flat_hashmap<OfferID, Offer*> offers;
   hashmap<OfferID, process::Timer> offerTimers;
 
   hashmap<OfferID, InverseOffer*> inverseOffers;
@@ -1777,6 +1969,10 @@ private:
   // because we set them at the role level.
   hashmap<std::string, Quota> quotas;
 
+  // The sum of the guarantees of `quotas`, which is updated along with
+  // it, see `QuotaHandler::capacityHeuristic()`.
+  Resources totalQuotaGuarantee;
+
   // Authenticator names as supplied via flags.
   std::vector<std::string> authenticatorNames;
 
@@ -1788,9 +1984,112 @@ private:
   // The future is removed from the map when master completes authentication.
   hashmap<process::UPID, process::Future<Option<std::string>>> authenticating;
 
+  // Frameworks/slaves whose authentication has not been started yet
+  // because `--max_concurrent_authentications` authentications are
+  // in progress, in the order they asked to be authenticated. Keyed
+  // by the PID to be authenticated, the value is the PID of the
+  // authenticatee to reply to.
+  LinkedHashMap<process::UPID, process::UPID> pendingAuthentications;
+
   // Principals of authenticated frameworks/slaves keyed by PID.
   hashmap<process::UPID, std::string> authenticated;
 
+  // Incremented whenever the frameworks, agents, tasks or offers
+  // reported by the `/state` endpoint may have changed, see
+  // `Http::state()`.
+  uint64_t stateGeneration;
+
+  // The resources to be recovered once the current batch of
+  // recoveries is finished, and the nesting depth of the batches,
+  // see `startRecoveries`.
+  hashmap<FrameworkID, hashmap<SlaveID, Resources>> recoveries;
+  size_t recoveryBatches;
+
+  // The latest total oversubscribed resources of each agent that have
+  // not been applied yet, see `--coalesce_agent_updates`.
+  hashmap<SlaveID, Resources> pendingSlaveUpdates;
+
+  // The serialized `/state`, which is only used without an authorizer
+  // since otherwise the state depends on the principal.
+  struct StateBody
+  {
+    std::string json;
+
+    // The gzip compressed `json`, if compression succeeded.
+    Option<std::string> gzipped;
+  };
+
+  // The `/state` as of `generation`, which is reused by `Http::state()`
+  // while `stateGeneration` does not change. The body is assembled off
+  // the master actor, see `Http::snapshotState()`.
+  struct CachedState
+  {
+    uint64_t generation;
+    process::Future<process::Shared<StateBody>> body;
+  };
+
+  Option<CachedState> cachedState;
+
+  // The serialized JSON of an agent or framework in the `/state` as of
+  // its `stateGeneration`. Since the JSON is immutable once serialized,
+  // the fragments of the agents and frameworks that did not change are
+  // shared between subsequent snapshots of the state.
+  struct StateFragment
+  {
+    uint64_t generation;
+    process::Shared<std::string> json;
+  };
+
+  struct StateFragments
+  {
+    hashmap<SlaveID, StateFragment> slaves;
+    hashmap<FrameworkID, StateFragment> frameworks;
+    hashmap<FrameworkID, StateFragment> completedFrameworks;
+  } stateFragments;
+
+  // The agents and frameworks removed from the `/state-summary`, each
+  // along with the `stateGeneration` of its removal, to report the
+  // changes since a generation, see `Http::stateSummary()`. Only the
+  // latest `MAX_STATE_SUMMARY_REMOVALS` of each are kept, so the
+  // changes since a generation before `horizon` are not known.
+  struct SummaryRemovals
+  {
+    SummaryRemovals() : horizon(0) {}
+
+    void add(uint64_t generation, const SlaveID& slaveId)
+    {
+      add(&slaves, generation, slaveId);
+    }
+
+    void add(uint64_t generation, const FrameworkInfo& frameworkInfo)
+    {
+      add(&frameworks, generation, frameworkInfo);
+    }
+
+    // We keep the `FrameworkInfo` of the removed frameworks so that
+    // their removal is only reported to those who can view them.
+    std::deque<std::pair<uint64_t, SlaveID>> slaves;
+    std::deque<std::pair<uint64_t, FrameworkInfo>> frameworks;
+
+    // The generation of the latest removal that was dropped.
+    uint64_t horizon;
+
+  private:
+    template <typename T>
+    void add(
+        std::deque<std::pair<uint64_t, T>>* removals,
+        uint64_t generation,
+        const T& removed)
+    {
+      removals->push_back(std::make_pair(generation, removed));
+
+      if (removals->size() > MAX_STATE_SUMMARY_REMOVALS) {
+        horizon = std::max(horizon, removals->front().first);
+        removals->pop_front();
+      }
+    }
+  } summaryRemovals;
+
   int64_t nextFrameworkId; // Used to give each framework a unique ID.
   int64_t nextOfferId;     // Used to give each slot offer a unique ID.
   int64_t nextSlaveId;     // Used to give each slave a unique ID.
@@ -1818,6 +2117,11 @@ private:
   double _slaves_inactive();
   double _slaves_unreachable();
 
+  double _slave_readmissions_pending()
+  {
+    return slaves.reregistering.size();
+  }
+
   double _frameworks_connected();
   double _frameworks_disconnected();
   double _frameworks_active();
@@ -2087,27 +2391,128 @@ inline std::ostream& operator<<(
     const Framework& framework);
 
 
-// This process periodically sends heartbeats to a scheduler on the
-// given HTTP connection.
+// Keeps the recurring deadlines of a set of keys that all recur with
+// the same interval, so that a single timer serves all of them rather
+// than one timer per key. Since the interval is the same for all keys,
+// the deadlines expire in the order in which they were scheduled, so
+// they are kept in a queue rather than in a timer wheel or a heap.
+template <typename Key>
+class Deadlines
+{
+public:
+  explicit Deadlines(const Duration& _interval)
+    : interval(_interval), generation(0) {}
+
+  // Schedules the first deadline of the key, one interval from now,
+  // replacing the deadline of the key if it is already scheduled.
+  void add(const Key& key)
+  {
+    generations[key] = ++generation;
+    entries.push_back({process::Clock::now() + interval, key, generation});
+  }
+
+  // NOTE: The entry of the key is dropped lazily, i.e., when it
+  // reaches the front of the queue.
+  void remove(const Key& key) { generations.erase(key); }
+
+  bool contains(const Key& key) const { return generations.contains(key); }
+
+  bool empty() const { return generations.empty(); }
+
+  // Returns the keys whose deadlines have passed (at most 'limit'),
+  // in the order of their deadlines, and schedules their next
+  // deadlines one interval from now.
+  std::vector<Key> expire(size_t limit)
+  {
+    const process::Time now = process::Clock::now();
+
+    std::vector<Key> result;
+    while (result.size() < limit && next().isSome() && next().get() <= now) {
+      Entry entry = entries.front();
+      entries.pop_front();
+
+      entry.deadline = now + interval;
+      entries.push_back(entry);
+
+      result.push_back(entry.key);
+    }
+
+    return result;
+  }
+
+  // Returns the earliest deadline, if any.
+  Option<process::Time> next()
+  {
+    while (!entries.empty()) {
+      const Entry& entry = entries.front();
+
+      Option<uint64_t> current = generations.get(entry.key);
+      if (current.isSome() && current.get() == entry.generation) {
+        return entry.deadline;
+      }
+
+      entries.pop_front();
+    }
+
+    return None();
+  }
+
+private:
+  struct Entry
+  {
+    process::Time deadline;
+    Key key;
+
+    // Tells whether this is the current entry of the key, since a key
+    // that is removed and added again gets a new entry.
+    uint64_t generation;
+  };
+
+  const Duration interval;
+
+  std::deque<Entry> entries;
+  hashmap<Key, uint64_t> generations;
+  uint64_t generation;
+};
+
+
+// This process periodically sends heartbeats to the schedulers on
+// their HTTP connections. A single process serves all the schedulers,
+// sending the heartbeats that are due in batches.
 class Heartbeater : public process::Process<Heartbeater>
 {
 public:
-  Heartbeater(const FrameworkID& _frameworkId,
-              const HttpConnection& _http,
-              const Duration& _interval)
+  explicit Heartbeater(const Duration& interval)
     : process::ProcessBase(process::ID::generate("heartbeater")),
-      frameworkId(_frameworkId),
-      http(_http),
-      interval(_interval) {}
+      deadlines(interval),
+      scheduled(false) {}
 
-protected:
-  virtual void initialize() override
+  // Sends a heartbeat to the scheduler now and then every interval,
+  // replacing the connection of the framework if there is one.
+  void add(const FrameworkID& frameworkId, const HttpConnection& http)
+  {
+    connections.erase(frameworkId);
+    connections.emplace(frameworkId, http);
+
+    send(frameworkId, http);
+
+    deadlines.add(frameworkId);
+    schedule();
+  }
+
+  void remove(const FrameworkID& frameworkId)
   {
-    heartbeat();
+    connections.erase(frameworkId);
+    deadlines.remove(frameworkId);
   }
 
 private:
-  void heartbeat()
+  // The largest number of heartbeats sent at once, so that other
+  // events do not have to wait for the heartbeats of all the
+  // schedulers when they are due at the same time.
+  static constexpr size_t BATCH = 1000;
+
+  void send(const FrameworkID& frameworkId, HttpConnection http)
   {
     // Only send a heartbeat if the connection is not closed.
     if (http.closed().isPending()) {
@@ -2118,13 +2523,47 @@ private:
 
       http.send(event);
     }
+  }
+
+  // Triggers `heartbeat` at the next deadline, unless it is already
+  // triggered.
+  void schedule()
+  {
+    if (scheduled) {
+      return;
+    }
+
+    Option<process::Time> next = deadlines.next();
+    if (next.isNone()) {
+      return;
+    }
 
-    process::delay(interval, self(), &Self::heartbeat);
+    scheduled = true;
+
+    const process::Time now = process::Clock::now();
+    if (next.get() <= now) {
+      process::dispatch(self(), &Self::heartbeat);
+    } else {
+      process::delay(next.get() - now, self(), &Self::heartbeat);
+    }
   }
 
-  const FrameworkID frameworkId;
-  HttpConnection http;
-  const Duration interval;
+  void heartbeat()
+  {
+    scheduled = false;
+
+    foreach (const FrameworkID& frameworkId, deadlines.expire(BATCH)) {
+      send(frameworkId, connections.at(frameworkId));
+    }
+
+    schedule();
+  }
+
+  Deadlines<FrameworkID> deadlines;
+  hashmap<FrameworkID, HttpConnection> connections;
+
+  // Whether `heartbeat` is triggered already.
+  bool scheduled;
 };
 
 
@@ -2158,6 +2597,7 @@ struct Framework
             const process::UPID& _pid,
             const process::Time& time = process::Clock::now())
     : master(_master),
+      stateGeneration(++_master->stateGeneration),
       info(_info),
       capabilities(_info.capabilities()),
       pid(_pid),
@@ -2173,6 +2613,7 @@ struct Framework
             const HttpConnection& _http,
             const process::Time& time = process::Clock::now())
     : master(_master),
+      stateGeneration(++_master->stateGeneration),
       info(_info),
       capabilities(_info.capabilities()),
       http(_http),
@@ -2186,6 +2627,7 @@ struct Framework
             const Flags& masterFlags,
             const FrameworkInfo& _info)
     : master(_master),
+      stateGeneration(++_master->stateGeneration),
       info(_info),
       capabilities(_info.capabilities()),
       state(RECOVERED),
@@ -2210,6 +2652,8 @@ struct Framework
 
   void addTask(Task* task)
   {
+    stateChanged();
+
     CHECK(!tasks.contains(task->task_id()))
       << "Duplicate task " << task->task_id()
       << " of framework " << task->framework_id();
@@ -2230,6 +2674,8 @@ struct Framework
   // functionally for all tasks is expensive, for now.
   void recoverResources(Task* task)
   {
+    stateChanged();
+
     CHECK(Master::isRemovable(task->state()));
     CHECK(tasks.contains(task->task_id()))
       << "Unknown task " << task->task_id()
@@ -2264,25 +2710,78 @@ struct Framework
 
   void addCompletedTask(const Task& task)
   {
+    stateChanged();
+
     // TODO(neilc): We currently allow frameworks to reuse the task
     // IDs of completed tasks (although this is discouraged). This
     // means that there might be multiple completed tasks with the
     // same task ID. We should consider rejecting attempts to reuse
     // task IDs (MESOS-6779).
-    completedTasks.push_back(process::Owned<Task>(new Task(task)));
+    if (completedTasks.capacity() == 0) {
+      return;
+    }
+
+    // The circular buffer drops its oldest task when it is full.
+    if (completedTasks.full()) {
+      completedTasksBytes -= Bytes(completedTasks.front()->ByteSize());
+    }
+
+    completedTasks.push_back(compact(task));
+    completedTasksBytes += Bytes(completedTasks.back()->ByteSize());
+
+    const Option<Bytes>& maxBytes =
+      master->flags.max_completed_task_bytes_per_framework;
+
+    while (maxBytes.isSome() &&
+           completedTasksBytes > maxBytes.get() &&
+           !completedTasks.empty()) {
+      completedTasksBytes -= Bytes(completedTasks.front()->ByteSize());
+      completedTasks.pop_front();
+    }
   }
 
   void addUnreachableTask(const Task& task)
   {
+    stateChanged();
+
     CHECK(protobuf::frameworkHasCapability(
               info, FrameworkInfo::Capability::PARTITION_AWARE));
 
     // TODO(adam-mesos): Check if unreachable task already exists.
-    unreachableTasks.set(task.task_id(), process::Owned<Task>(new Task(task)));
+    unreachableTasks.set(task.task_id(), compact(task));
+  }
+
+  // Returns a copy of the (removed) task in which all but the latest
+  // status are trimmed to their state and timestamp. The master keeps
+  // up to `--max_completed_tasks_per_framework` completed and
+  // `--max_unreachable_tasks_per_framework` unreachable tasks of each
+  // framework, and most of their memory is taken up by the history
+  // of statuses (with their labels, container statuses, messages,
+  // etc.), of which usually only the latest status is of interest.
+  static process::Owned<Task> compact(const Task& task)
+  {
+    process::Owned<Task> result(new Task(task));
+
+    for (int i = 0; i < result->statuses_size() - 1; i++) {
+      TaskStatus* status = result->mutable_statuses(i);
+
+      TaskStatus trimmed;
+      trimmed.mutable_task_id()->Swap(status->mutable_task_id());
+      trimmed.set_state(status->state());
+      if (status->has_timestamp()) {
+        trimmed.set_timestamp(status->timestamp());
+      }
+
+      status->Swap(&trimmed);
+    }
+
+    return result;
   }
 
   void removeTask(Task* task)
   {
+    stateChanged();
+
     CHECK(tasks.contains(task->task_id()))
       << "Unknown task " << task->task_id()
       << " of framework " << task->framework_id();
@@ -2306,6 +2805,8 @@ struct Framework
 
   void addOffer(Offer* offer)
   {
+    stateChanged();
+
     CHECK(!offers.contains(offer)) << "Duplicate offer " << offer->id();
     offers.insert(offer);
     totalOfferedResources += offer->resources();
@@ -2314,6 +2815,8 @@ struct Framework
 
   void removeOffer(Offer* offer)
   {
+    stateChanged();
+
     CHECK(offers.find(offer) != offers.end())
       << "Unknown offer " << offer->id();
 
@@ -2328,6 +2831,8 @@ struct Framework
 
   void addInverseOffer(InverseOffer* inverseOffer)
   {
+    stateChanged();
+
     CHECK(!inverseOffers.contains(inverseOffer))
       << "Duplicate inverse offer " << inverseOffer->id();
     inverseOffers.insert(inverseOffer);
@@ -2335,6 +2840,8 @@ struct Framework
 
   void removeInverseOffer(InverseOffer* inverseOffer)
   {
+    stateChanged();
+
     CHECK(inverseOffers.contains(inverseOffer))
       << "Unknown inverse offer " << inverseOffer->id();
 
@@ -2351,6 +2858,8 @@ struct Framework
   void addExecutor(const SlaveID& slaveId,
                    const ExecutorInfo& executorInfo)
   {
+    stateChanged();
+
     CHECK(!hasExecutor(slaveId, executorInfo.executor_id()))
       << "Duplicate executor '" << executorInfo.executor_id()
       << "' on agent " << slaveId;
@@ -2363,6 +2872,8 @@ struct Framework
   void removeExecutor(const SlaveID& slaveId,
                       const ExecutorID& executorId)
   {
+    stateChanged();
+
     CHECK(hasExecutor(slaveId, executorId))
       << "Unknown executor '" << executorId
       << "' of framework " << id()
@@ -2387,6 +2898,8 @@ struct Framework
   // 'capabilities', and 'labels'.
   Try<Nothing> updateFrameworkInfo(const FrameworkInfo& source)
   {
+    stateChanged();
+
     // We only merge 'info' from the same framework 'id'.
     CHECK_EQ(info.id(), source.id());
 
@@ -2487,6 +3000,8 @@ struct Framework
 
   void updateConnection(const process::UPID& newPid)
   {
+    stateChanged();
+
     // Cleanup the HTTP connnection if this is a downgrade from HTTP
     // to PID. Note that the connection may already be closed.
     if (http.isSome()) {
@@ -2499,6 +3014,8 @@ struct Framework
 
   void updateConnection(const HttpConnection& newHttp)
   {
+    stateChanged();
+
     if (pid.isSome()) {
       // Wipe the PID if this is an upgrade from PID to HTTP.
       // TODO(benh): unlink(oldPid);
@@ -2530,33 +3047,34 @@ struct Framework
 
     http = None();
 
-    CHECK_SOME(heartbeater);
-
-    terminate(heartbeater.get().get());
-    wait(heartbeater.get().get());
-
-    heartbeater = None();
+    process::dispatch(
+        master->heartbeater, &Heartbeater::remove, info.id());
   }
 
   void heartbeat()
   {
-    CHECK_NONE(heartbeater);
     CHECK_SOME(http);
 
-    // TODO(vinod): Make heartbeat interval configurable and include
-    // this information in the SUBSCRIBED response.
-    heartbeater =
-      new Heartbeater(info.id(), http.get(), DEFAULT_HEARTBEAT_INTERVAL);
-
-    process::spawn(heartbeater.get().get());
+    process::dispatch(
+        master->heartbeater, &Heartbeater::add, info.id(), http.get());
   }
 
   bool active() const    { return state == ACTIVE; }
   bool connected() const { return state == ACTIVE || state == INACTIVE; }
   bool recovered() const { return state == RECOVERED; }
 
+  // Records that the part of the `/state` describing this framework
+  // changed, see `Master::stateGeneration`.
+  void stateChanged()
+  {
+    stateGeneration = ++master->stateGeneration;
+  }
+
   Master* const master;
 
+  // The `Master::stateGeneration` of the last change to this framework.
+  uint64_t stateGeneration;
+
   FrameworkInfo info;
 
   protobuf::framework::Capabilities capabilities;
@@ -2580,7 +3098,11 @@ struct Framework
 
   // TODO(bmahler): Make this private to enforce that `addTask()` and
   // `removeTask()` are used, and provide a const view into the tasks.
-  hashmap<TaskID, Task*> tasks;
+  //
+  // NOTE: This is a `flat_hashmap` since it is looked up for every
+  // status update; it only holds pointers, so that entries moving
+  // around on insertion and erasure does not invalidate any task.
+  flat_hashmap<TaskID, Task*> tasks;
 
   // Tasks launched by this framework that have reached a terminal
   // state and have had all their updates acknowledged. We only keep a
@@ -2593,6 +3115,10 @@ struct Framework
   // are marked TASK_UNREACHABLE and stored in `unreachableTasks`.
   boost::circular_buffer<process::Owned<Task>> completedTasks;
 
+  // The (serialized) size of `completedTasks`, which is bounded by
+  // `--max_completed_task_bytes_per_framework` if set.
+  Bytes completedTasksBytes;
+
   // Partition-aware tasks running on agents that have been marked
   // unreachable. We only keep a fixed-size cache to avoid consuming
   // too much memory.
@@ -2640,9 +3166,6 @@ struct Framework
   Resources totalOfferedResources;
   hashmap<SlaveID, Resources> offeredResources;
 
-  // This is only set for HTTP frameworks.
-  Option<process::Owned<Heartbeater>> heartbeater;
-
 private:
   Framework(const Framework&);              // No copying.
   Framework& operator=(const Framework&); // No assigning.
@@ -19,6 +19,7 @@
 #include <process/metrics/counter.hpp>
 #include <process/metrics/gauge.hpp>
 #include <process/metrics/metrics.hpp>
+#include <process/metrics/timer.hpp>
 
 #include <stout/foreach.hpp>
 
@@ -143,6 +144,8 @@ Metrics::Metrics(const Master& master)
         "master/messages_unregister_slave"),
     messages_status_update(
         "master/messages_status_update"),
+    messages_status_updates(
+        "master/messages_status_updates"),
     messages_exited_executor(
         "master/messages_exited_executor"),
     messages_update_slave(
@@ -180,6 +183,12 @@ Metrics::Metrics(const Master& master)
         "master/slave_registrations"),
     slave_reregistrations(
         "master/slave_reregistrations"),
+    slave_readmissions_pending(
+        "master/slave_readmissions_pending",
+        defer(master, &Master::_slave_readmissions_pending)),
+    slave_readmission(
+        "master/slave_readmission",
+        Hours(1)),
     slave_removals(
         "master/slave_removals"),
     slave_removals_reason_unhealthy(
@@ -254,6 +263,7 @@ Metrics::Metrics(const Master& master)
   process::metrics::add(messages_reregister_slave);
   process::metrics::add(messages_unregister_slave);
   process::metrics::add(messages_status_update);
+  process::metrics::add(messages_status_updates);
   process::metrics::add(messages_exited_executor);
   process::metrics::add(messages_update_slave);
 
@@ -280,6 +290,8 @@ Metrics::Metrics(const Master& master)
 
   process::metrics::add(slave_registrations);
   process::metrics::add(slave_reregistrations);
+  process::metrics::add(slave_readmissions_pending);
+  process::metrics::add(slave_readmission);
   process::metrics::add(slave_removals);
   process::metrics::add(slave_removals_reason_unhealthy);
   process::metrics::add(slave_removals_reason_unregistered);
@@ -399,6 +411,7 @@ Metrics::~Metrics()
   process::metrics::remove(messages_reregister_slave);
   process::metrics::remove(messages_unregister_slave);
   process::metrics::remove(messages_status_update);
+  process::metrics::remove(messages_status_updates);
   process::metrics::remove(messages_exited_executor);
   process::metrics::remove(messages_update_slave);
 
@@ -425,6 +438,8 @@ Metrics::~Metrics()
 
   process::metrics::remove(slave_registrations);
   process::metrics::remove(slave_reregistrations);
+  process::metrics::remove(slave_readmissions_pending);
+  process::metrics::remove(slave_readmission);
   process::metrics::remove(slave_removals);
   process::metrics::remove(slave_removals_reason_unhealthy);
   process::metrics::remove(slave_removals_reason_unregistered);
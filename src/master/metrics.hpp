@@ -23,6 +23,7 @@
 #include <process/metrics/counter.hpp>
 #include <process/metrics/gauge.hpp>
 #include <process/metrics/metrics.hpp>
+#include <process/metrics/timer.hpp>
 
 #include <stout/hashmap.hpp>
 
@@ -146,6 +147,7 @@ struct Metrics
   process::metrics::Counter messages_reregister_slave;
   process::metrics::Counter messages_unregister_slave;
   process::metrics::Counter messages_status_update;
+  process::metrics::Counter messages_status_updates;
   process::metrics::Counter messages_exited_executor;
   process::metrics::Counter messages_update_slave;
 
@@ -174,6 +176,11 @@ struct Metrics
   // Successful registry operations.
   process::metrics::Counter slave_registrations;
   process::metrics::Counter slave_reregistrations;
+
+  // Agents that are waiting for the registrar to readmit them when
+  // re-registering, and how long the readmission takes.
+  process::metrics::Gauge slave_readmissions_pending;
+  process::metrics::Timer<Milliseconds> slave_readmission;
   process::metrics::Counter slave_removals;
   process::metrics::Counter slave_removals_reason_unhealthy;
   process::metrics::Counter slave_removals_reason_unregistered;
@@ -31,6 +31,8 @@
 #include <process/http.hpp>
 #include <process/owned.hpp>
 
+#include <stout/foreach.hpp>
+#include <stout/hashset.hpp>
 #include <stout/json.hpp>
 #include <stout/protobuf.hpp>
 #include <stout/stringify.hpp>
@@ -80,39 +82,21 @@ Option<Error> Master::QuotaHandler::capacityHeuristic(
   // request does not exist, hence `master->quotas` is guaranteed not to
   // contain the request role's quota yet.
   // TODO(alexr): Relax this constraint once we allow updating quotas.
-  Resources totalQuota = request.guarantee();
-  foreachvalue (const Quota& quota, master->quotas) {
-    totalQuota += quota.info.guarantee();
-  }
+  Resources totalQuota = master->totalQuotaGuarantee + request.guarantee();
 
   // Determine whether the total quota, including the new request, does
-  // not exceed the sum of non-static cluster resources.
-  // NOTE: We do not necessarily calculate the full sum of non-static
-  // cluster resources. We apply the early termination logic as it can
-  // reduce the cost of the function significantly. This early exit does
-  // not influence the declared inequality check.
-  Resources nonStaticClusterResources;
-  foreachvalue (Slave* slave, master->slaves.registered) {
-    // We do not consider disconnected or inactive agents, because they
-    // do not participate in resource allocation.
-    if (!slave->connected || !slave->active) {
-      continue;
-    }
-
-    // NOTE: Dynamic reservations are not excluded here because they do
-    // not show up in `SlaveInfo` resources. In contrast to static
-    // reservations, dynamic reservations may be unreserved at any time,
-    // hence making resources available for quota'ed frameworks.
-    Resources nonStaticAgentResources =
-      Resources(slave->info.resources()).unreserved();
-
-    nonStaticClusterResources += nonStaticAgentResources;
-
-    // If we have found enough resources to satisfy the inequality, then
-    // we can return early.
-    if (nonStaticClusterResources.contains(totalQuota)) {
-      return None();
-    }
+  // not exceed the sum of non-static cluster resources. The master
+  // maintains this sum as agents come and go, so that we do not need to
+  // iterate over all agents here.
+  //
+  // NOTE: Disconnected or inactive agents are not included, because
+  // they do not participate in resource allocation. Dynamic reservations
+  // are not excluded because they do not show up in `SlaveInfo`
+  // resources. In contrast to static reservations, dynamic reservations
+  // may be unreserved at any time, hence making resources available for
+  // quota'ed frameworks.
+  if (master->slaves.activeUnreserved.contains(totalQuota)) {
+    return None();
   }
 
   // If we reached this point, there are not enough available resources
@@ -169,23 +153,52 @@ void Master::QuotaHandler::rescindOffers(const QuotaInfo& request) const
   //     rescind all outstanding offers from `a`;
   //     update `rescinded`, inc(numVA);
   //   end.
-  foreachvalue (const Slave* slave, master->slaves.registered) {
-    // If we have rescinded offers with at least as many resources as the
-    // quota request resources, then we are done.
-    if (rescinded.contains(request.guarantee()) &&
-        (visitedAgents >= frameworksInRole)) {
-      break;
+  //
+  // Only the agents with outstanding offers that contain at least one
+  // resource relevant to the quota request are considered. These are
+  // found through the outstanding offers rather than by iterating over
+  // all registered agents, most of which may have no offers at all.
+  hashset<string> names;
+  foreach (const Resource& resource, request.guarantee()) {
+    names.insert(resource.name());
+  }
+
+  hashset<SlaveID> candidates;
+  vector<Slave*> agents;
+  foreachvalue (const Offer* offer, master->offers) {
+    if (candidates.contains(offer->slave_id())) {
+      continue;
+    }
+
+    bool relevant = false;
+    foreach (const Resource& resource, offer->resources()) {
+      if (names.contains(resource.name())) {
+        relevant = true;
+        break;
+      }
     }
 
+    Slave* slave = master->slaves.registered.get(offer->slave_id());
+
     // As in the capacity heuristic, we do not consider disconnected or
     // inactive agents, because they do not participate in resource
     // allocation.
-    if (!slave->connected || !slave->active) {
-      continue;
+    if (relevant &&
+        slave != nullptr &&
+        slave->connected &&
+        slave->active) {
+      candidates.insert(offer->slave_id());
+      agents.push_back(slave);
     }
+  }
 
-    // TODO(alexr): Consider only rescinding from agents that have at least
-    // one resource relevant to the quota request.
+  foreach (Slave* slave, agents) {
+    // If we have rescinded offers with at least as many resources as the
+    // quota request resources, then we are done.
+    if (rescinded.contains(request.guarantee()) &&
+        (visitedAgents >= frameworksInRole)) {
+      break;
+    }
 
     // Rescind all outstanding offers from the given agent.
     bool agentVisited = false;
@@ -404,6 +417,7 @@ Future<http::Response> Master::QuotaHandler::__set(
   // NOTE: We do not need to remove quota for the role if the registry update
   // fails because in this case the master fails as well.
   master->quotas[quotaInfo.role()] = quota;
+  master->totalQuotaGuarantee += quotaInfo.guarantee();
 
   // Update the registry with the new quota and acknowledge the request.
   return master->registrar->apply(Owned<Operation>(
@@ -508,7 +522,10 @@ Future<http::Response> Master::QuotaHandler::__remove(const string& role) const
   // NOTE: We do not need to restore quota for the role if the registry
   // update fails because in this case the master fails as well and quota
   // will be restored automatically during the recovery.
-  master->quotas.erase(role);
+  if (master->quotas.contains(role)) {
+    master->totalQuotaGuarantee -= master->quotas.at(role).info.guarantee();
+    master->quotas.erase(role);
+  }
 
   // Update the registry with the removed quota and acknowledge the request.
   return master->registrar->apply(Owned<Operation>(
@@ -21,7 +21,9 @@
 
 #include <mesos/state/protobuf.hpp>
 
+#include <process/clock.hpp>
 #include <process/defer.hpp>
+#include <process/delay.hpp>
 #include <process/dispatch.hpp>
 #include <process/future.hpp>
 #include <process/help.hpp>
@@ -30,8 +32,10 @@
 #include <process/owned.hpp>
 #include <process/process.hpp>
 
+#include <process/metrics/counter.hpp>
 #include <process/metrics/gauge.hpp>
 #include <process/metrics/metrics.hpp>
+#include <process/metrics/push_gauge.hpp>
 #include <process/metrics/timer.hpp>
 
 #include <stout/lambda.hpp>
@@ -47,12 +51,14 @@
 using mesos::state::protobuf::State;
 using mesos::state::protobuf::Variable;
 
+using process::delay;
 using process::dispatch;
 using process::spawn;
 using process::terminate;
 using process::wait; // Necessary on some OS's to disambiguate.
 
 using process::AUTHENTICATION;
+using process::Clock;
 using process::DESCRIPTION;
 using process::Failure;
 using process::Future;
@@ -65,7 +71,8 @@ using process::TLDR;
 
 using process::http::OK;
 
-using process::metrics::Gauge;
+using process::metrics::Counter;
+using process::metrics::PushGauge;
 using process::metrics::Timer;
 
 using std::deque;
@@ -86,7 +93,6 @@ public:
       State* _state,
       const Option<string>& _authenticationRealm)
     : ProcessBase(process::ID::generate("registrar")),
-      metrics(*this),
       updating(false),
       flags(_flags),
       state(_state),
@@ -141,23 +147,28 @@ private:
   };
 
   // Metrics.
+  //
+  // NOTE: The gauges are updated by the registrar so that observing
+  // them doesn't require dispatching to it (or serializing the
+  // registry to compute its size).
   struct Metrics
   {
-    explicit Metrics(const RegistrarProcess& process)
-      : queued_operations(
-            "registrar/queued_operations",
-            defer(process, &RegistrarProcess::_queued_operations)),
-        registry_size_bytes(
-            "registrar/registry_size_bytes",
-            defer(process, &RegistrarProcess::_registry_size_bytes)),
+    Metrics()
+      : queued_operations("registrar/queued_operations"),
+        registry_size_bytes("registrar/registry_size_bytes"),
         state_fetch("registrar/state_fetch"),
-        state_store("registrar/state_store", Days(1))
+        state_store("registrar/state_store", Days(1)),
+        state_stores("registrar/state_stores"),
+        stored_operations("registrar/stored_operations")
     {
       process::metrics::add(queued_operations);
       process::metrics::add(registry_size_bytes);
 
       process::metrics::add(state_fetch);
       process::metrics::add(state_store);
+
+      process::metrics::add(state_stores);
+      process::metrics::add(stored_operations);
     }
 
     ~Metrics()
@@ -167,29 +178,22 @@ private:
 
       process::metrics::remove(state_fetch);
       process::metrics::remove(state_store);
+
+      process::metrics::remove(state_stores);
+      process::metrics::remove(stored_operations);
     }
 
-    Gauge queued_operations;
-    Gauge registry_size_bytes;
+    PushGauge queued_operations;
+    PushGauge registry_size_bytes;
 
     Timer<Milliseconds> state_fetch;
     Timer<Milliseconds> state_store;
-  } metrics;
-
-  // Gauge handlers.
-  double _queued_operations()
-  {
-    return operations.size();
-  }
-
-  Future<double> _registry_size_bytes()
-  {
-    if (variable.isSome()) {
-      return variable.get().get().ByteSize();
-    }
 
-    return Failure("Not recovered yet");
-  }
+    // The number of stores and the number of operations they stored,
+    // the ratio of which is the average number of operations per store.
+    Counter state_stores;
+    Counter stored_operations;
+  } metrics;
 
   // Continuations.
   void _recover(
@@ -200,9 +204,13 @@ private:
 
   // Helper for updating state (performing store).
   void update();
+  void batch();
   void _update(
       const Future<Option<Variable<Registry>>>& store,
       deque<Owned<Operation>> operations);
+  void _check(
+      const Future<bool>& latest,
+      deque<Owned<Operation>> operations);
 
   // Fails all pending operations and transitions the Registrar
   // into an error state in which all subsequent operations will fail.
@@ -214,6 +222,15 @@ private:
   deque<Owned<Operation>> operations;
   bool updating; // Used to signify fetching (recovering) or storing.
 
+  // The timer for `--registry_batch_interval`, if operations are
+  // waiting for more operations to be stored with.
+  Option<process::Timer> batchTimer;
+
+  // The IDs of the agents in the registry, which the operations use
+  // to check for admitted agents. This is kept up to date across
+  // updates rather than rebuilt from the registry for every store.
+  hashset<SlaveID> slaveIDs;
+
   const Flags flags;
   State* state;
 
@@ -359,16 +376,25 @@ void RegistrarProcess::_recover(
   } else {
     Duration elapsed = metrics.state_fetch.stop();
 
+    const int size = recovery.get().get().ByteSize();
+
     LOG(INFO) << "Successfully fetched the registry"
-              << " (" << Bytes(recovery.get().get().ByteSize()) << ")"
+              << " (" << Bytes(size) << ")"
               << " in " << elapsed;
 
     // Save the registry.
     variable = recovery.get();
+    metrics.registry_size_bytes = size;
+
+    foreach (const Registry::Slave& slave,
+             variable.get().get().slaves().slaves()) {
+      slaveIDs.insert(slave.info().id());
+    }
 
     // Perform the Recover operation to add the new MasterInfo.
     Owned<Operation> operation(new Recover(info));
     operations.push_back(operation);
+    metrics.queued_operations = operations.size();
     operation->future()
       .onAny(defer(self(), &Self::__recover, lambda::_1));
 
@@ -420,14 +446,36 @@ Future<bool> RegistrarProcess::_apply(Owned<Operation> operation)
   CHECK_SOME(variable);
 
   operations.push_back(operation);
+  metrics.queued_operations = operations.size();
   Future<bool> future = operation->future();
-  if (!updating) {
+  if (updating) {
+    return future; // The operation is stored once the store completes.
+  }
+
+  if (flags.registry_batch_interval == Duration::zero() ||
+      operations.size() >= flags.registry_max_batch_size) {
     update();
+  } else if (batchTimer.isNone()) {
+    batchTimer = delay(
+        flags.registry_batch_interval,
+        self(),
+        &Self::batch);
   }
+
   return future;
 }
 
 
+void RegistrarProcess::batch()
+{
+  batchTimer = None();
+
+  if (!updating && error.isNone()) {
+    update();
+  }
+}
+
+
 void RegistrarProcess::update()
 {
   if (operations.empty()) {
@@ -438,6 +486,11 @@ void RegistrarProcess::update()
   CHECK_NONE(error);
   CHECK_SOME(variable);
 
+  if (batchTimer.isSome()) {
+    Clock::cancel(batchTimer.get());
+    batchTimer = None();
+  }
+
   // Time how long it takes to apply the operations.
   Stopwatch stopwatch;
   stopwatch.start();
@@ -447,20 +500,48 @@ void RegistrarProcess::update()
   // Create a snapshot of the current registry.
   Registry registry = variable.get().get();
 
-  // Create the 'slaveIDs' accumulator.
-  hashset<SlaveID> slaveIDs;
-  foreach (const Registry::Slave& slave, registry.slaves().slaves()) {
-    slaveIDs.insert(slave.info().id());
+  // NOTE: The operations update 'slaveIDs' along with the snapshot.
+  // If the store fails the registrar aborts, so there is no need to
+  // restore 'slaveIDs' to match the stored registry.
+  bool mutated = false;
+  foreach (Owned<Operation>& operation, operations) {
+    Try<bool> result = (*operation)(&registry, &slaveIDs);
+    mutated = mutated || (result.isSome() && result.get());
   }
 
-  foreach (Owned<Operation>& operation, operations) {
-    // No need to process the result of the operation.
-    (*operation)(&registry, &slaveIDs);
+  // Storing the registry rewrites all of it, so skip the store when
+  // none of the operations changed it (e.g., agents that are already
+  // known re-registering after a master failover). We still check
+  // that nobody else has stored the registry since we did, just like
+  // the store would, so that a registrar that lost leadership of the
+  // log does not keep acknowledging operations.
+  if (!mutated) {
+    LOG(INFO) << "Applied " << operations.size() << " operations in "
+              << stopwatch.elapsed() << "; the registry was not changed,"
+              << " checking its version";
+
+    state->latest(variable.get())
+      .after(flags.registry_store_timeout,
+             lambda::bind(
+                 &timeout<bool>,
+                 "version check",
+                 flags.registry_store_timeout,
+                 lambda::_1))
+      .onAny(defer(self(), &Self::_check, lambda::_1, operations));
+
+    // Clear the operations, _check will transition the Promises!
+    operations.clear();
+    metrics.queued_operations = 0;
+
+    return;
   }
 
   LOG(INFO) << "Applied " << operations.size() << " operations in "
             << stopwatch.elapsed() << "; attempting to update the registry";
 
+  ++metrics.state_stores;
+  metrics.stored_operations += operations.size();
+
   // Perform the store, and time the operation.
   metrics.state_store.start();
   state->store(variable.get().mutate(registry))
@@ -474,6 +555,7 @@ void RegistrarProcess::update()
 
   // Clear the operations, _update will transition the Promises!
   operations.clear();
+  metrics.queued_operations = 0;
 }
 
 
@@ -506,6 +588,45 @@ void RegistrarProcess::_update(
   LOG(INFO) << "Successfully updated the registry in " << elapsed;
 
   variable = store.get().get();
+  metrics.registry_size_bytes = variable.get().get().ByteSize();
+
+  // Remove the operations.
+  while (!applied.empty()) {
+    Owned<Operation> operation = applied.front();
+    applied.pop_front();
+
+    operation->set();
+  }
+
+  if (!operations.empty()) {
+    update();
+  }
+}
+
+
+void RegistrarProcess::_check(
+    const Future<bool>& latest,
+    deque<Owned<Operation>> applied)
+{
+  updating = false;
+
+  // Abort if the registry has changed, as a store would have failed.
+  if (!latest.isReady() || !latest.get()) {
+    string message = "Failed to update registry: ";
+
+    if (latest.isFailed()) {
+      message += latest.failure();
+    } else if (latest.isDiscarded()) {
+      message += "discarded";
+    } else {
+      message += "version mismatch";
+    }
+
+    fail(&applied, message);
+    abort(message);
+
+    return;
+  }
 
   // Remove the operations.
   while (!applied.empty()) {
@@ -528,6 +649,7 @@ void RegistrarProcess::abort(const string& message)
   LOG(ERROR) << "Registrar aborting: " << message;
 
   fail(&operations, message);
+  metrics.queued_operations = 0;
 }
 
 
@@ -407,6 +407,21 @@ Option<Error> validate(
       return None();
     }
 
+    case mesos::scheduler::Call::ACKNOWLEDGE_BATCH: {
+      if (!call.has_acknowledge_batch()) {
+        return Error("Expecting 'acknowledge_batch' to be present");
+      }
+
+      foreach (const mesos::scheduler::Call::Acknowledge& acknowledge,
+               call.acknowledge_batch().acknowledgements()) {
+        Try<UUID> uuid = UUID::fromBytes(acknowledge.uuid());
+        if (uuid.isError()) {
+          return uuid.error();
+        }
+      }
+      return None();
+    }
+
     case mesos::scheduler::Call::RECONCILE:
       if (!call.has_reconcile()) {
         return Error("Expecting 'reconcile' to be present");
@@ -658,20 +673,22 @@ Option<Error> validateCompatibleExecutorInfo(
   CHECK_NOTNULL(slave);
 
   const ExecutorID& executorId = executor.executor_id();
-  Option<ExecutorInfo> executorInfo = None();
+
+  // NOTE: We avoid copying the existing `ExecutorInfo` since this is
+  // done for every task launched with an executor.
+  const ExecutorInfo* executorInfo = nullptr;
 
   if (slave->hasExecutor(framework->id(), executorId)) {
-    executorInfo =
-      slave->executors.at(framework->id()).at(executorId);
+    executorInfo = &slave->executors.at(framework->id()).at(executorId);
   }
 
-  if (executorInfo.isSome() && !(executor == executorInfo.get())) {
+  if (executorInfo != nullptr && !(executor == *executorInfo)) {
     return Error(
         "ExecutorInfo is not compatible with existing ExecutorInfo"
         " with same ExecutorID).\n"
         "------------------------------------------------------------\n"
         "Existing ExecutorInfo:\n" +
-        stringify(executorInfo.get()) + "\n"
+        stringify(*executorInfo) + "\n"
         "------------------------------------------------------------\n"
         "ExecutorInfo:\n" +
         stringify(executor) + "\n"
@@ -768,14 +785,16 @@ Option<Error> validate(
   CHECK_NOTNULL(slave);
 
   vector<lambda::function<Option<Error>()>> validators = {
-    lambda::bind(internal::validateType, executor),
-    lambda::bind(internal::validateExecutorID, executor),
-    lambda::bind(internal::validateFrameworkID, executor, framework),
-    lambda::bind(internal::validateShutdownGracePeriod, executor),
-    lambda::bind(internal::validateResources, executor),
-    lambda::bind(
-        internal::validateCompatibleExecutorInfo, executor, framework, slave),
-    lambda::bind(internal::validateCommandInfo, executor)
+    [&]() { return internal::validateType(executor); },
+    [&]() { return internal::validateExecutorID(executor); },
+    [&]() { return internal::validateFrameworkID(executor, framework); },
+    [&]() { return internal::validateShutdownGracePeriod(executor); },
+    [&]() { return internal::validateResources(executor); },
+    [&]() {
+      return internal::validateCompatibleExecutorInfo(
+          executor, framework, slave);
+    },
+    [&]() { return internal::validateCommandInfo(executor); }
   };
 
   foreach (const lambda::function<Option<Error>()>& validator, validators) {
@@ -962,14 +981,14 @@ Option<Error> validateTask(
   // NOTE: The order in which the following validate functions are
   // executed does matter!
   vector<lambda::function<Option<Error>()>> validators = {
-    lambda::bind(internal::validateTaskID, task),
-    lambda::bind(internal::validateUniqueTaskID, task, framework),
-    lambda::bind(internal::validateSlaveID, task, slave),
-    lambda::bind(internal::validateKillPolicy, task),
-    lambda::bind(internal::validateCheck, task),
-    lambda::bind(internal::validateHealthCheck, task),
-    lambda::bind(internal::validateResources, task),
-    lambda::bind(internal::validateCommandInfo, task)
+    [&]() { return internal::validateTaskID(task); },
+    [&]() { return internal::validateUniqueTaskID(task, framework); },
+    [&]() { return internal::validateSlaveID(task, slave); },
+    [&]() { return internal::validateKillPolicy(task); },
+    [&]() { return internal::validateCheck(task); },
+    [&]() { return internal::validateHealthCheck(task); },
+    [&]() { return internal::validateResources(task); },
+    [&]() { return internal::validateCommandInfo(task); }
   };
 
   foreach (const lambda::function<Option<Error>()>& validator, validators) {
@@ -988,7 +1007,8 @@ Option<Error> validateExecutor(
     const TaskInfo& task,
     Framework* framework,
     Slave* slave,
-    const Resources& offered)
+    const Resources& offered,
+    Context* context)
 {
   CHECK_NOTNULL(framework);
   CHECK_NOTNULL(slave);
@@ -1003,7 +1023,18 @@ Option<Error> validateExecutor(
 
   Option<Error> error = None();
 
-  if (task.has_executor()) {
+  // An executor which is identical to the executor of an earlier task
+  // of the same call has already been validated (see `Context`).
+  bool validated = false;
+
+  if (task.has_executor() && context != nullptr) {
+    const ExecutorID& executorId = task.executor().executor_id();
+
+    validated = context->executors.contains(executorId) &&
+      context->executors.at(executorId) == task.executor();
+  }
+
+  if (task.has_executor() && !validated) {
     const ExecutorInfo& executor = task.executor();
 
     // Do the general validation first.
@@ -1067,11 +1098,16 @@ Option<Error> validateExecutor(
         << "in future releases.";
     }
 
-    if (!slave->hasExecutor(framework->id(), task.executor().executor_id())) {
-      total += executorResources;
+    if (context != nullptr) {
+      context->executors[executor.executor_id()] = executor;
     }
   }
 
+  if (task.has_executor() &&
+      !slave->hasExecutor(framework->id(), task.executor().executor_id())) {
+    total += task.executor().resources();
+  }
+
   // Now validate combined resources of task and executor.
 
   // NOTE: This is refactored into a separate function
@@ -1098,14 +1134,18 @@ Option<Error> validate(
     const TaskInfo& task,
     Framework* framework,
     Slave* slave,
-    const Resources& offered)
+    const Resources& offered,
+    Context* context)
 {
   CHECK_NOTNULL(framework);
   CHECK_NOTNULL(slave);
 
   vector<lambda::function<Option<Error>()>> validators = {
-    lambda::bind(internal::validateTask, task, framework, slave),
-    lambda::bind(internal::validateExecutor, task, framework, slave, offered)
+    [&]() { return internal::validateTask(task, framework, slave); },
+    [&]() {
+      return internal::validateExecutor(
+          task, framework, slave, offered, context);
+    }
   };
 
   foreach (const lambda::function<Option<Error>()>& validator, validators) {
@@ -1507,10 +1547,10 @@ Option<Error> validate(
   CHECK_NOTNULL(framework);
 
   vector<lambda::function<Option<Error>()>> validators = {
-    lambda::bind(validateUniqueOfferID, offerIds),
-    lambda::bind(validateOfferIds, offerIds, master),
-    lambda::bind(validateFramework, offerIds, master, framework),
-    lambda::bind(validateSlave, offerIds, master)
+    [&]() { return validateUniqueOfferID(offerIds); },
+    [&]() { return validateOfferIds(offerIds, master); },
+    [&]() { return validateFramework(offerIds, master, framework); },
+    [&]() { return validateSlave(offerIds, master); }
   };
 
   foreach (const lambda::function<Option<Error>()>& validator, validators) {
@@ -1533,10 +1573,10 @@ Option<Error> validateInverseOffers(
   CHECK_NOTNULL(framework);
 
   vector<lambda::function<Option<Error>()>> validators = {
-    lambda::bind(validateUniqueOfferID, offerIds),
-    lambda::bind(validateInverseOfferIds, offerIds, master),
-    lambda::bind(validateFramework, offerIds, master, framework),
-    lambda::bind(validateSlave, offerIds, master)
+    [&]() { return validateUniqueOfferID(offerIds); },
+    [&]() { return validateInverseOfferIds(offerIds, master); },
+    [&]() { return validateFramework(offerIds, master, framework); },
+    [&]() { return validateSlave(offerIds, master); }
   };
 
   foreach (const lambda::function<Option<Error>()>& validator, validators) {
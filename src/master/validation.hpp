@@ -27,6 +27,7 @@
 #include <mesos/master/master.hpp>
 
 #include <stout/error.hpp>
+#include <stout/hashmap.hpp>
 #include <stout/option.hpp>
 
 namespace mesos {
@@ -130,9 +131,24 @@ Option<Error> validateType(const ExecutorInfo& executor);
 
 namespace task {
 
+// State shared between the validations of the tasks that are launched
+// by a single call (e.g., an `ACCEPT` with thousands of `LAUNCH`ed
+// tasks), so that what all of these tasks have in common is only
+// validated once.
+struct Context
+{
+  // The executors that have been validated for earlier tasks, keyed
+  // by their IDs. A task whose executor is identical to one of these
+  // only needs to compare the two.
+  hashmap<ExecutorID, ExecutorInfo> executors;
+};
+
+
 // Validates a task that a framework attempts to launch within the
 // offered resources. Returns an optional error which will cause the
 // master to send a `TASK_ERROR` status update back to the framework.
+// The optional `context` must only be shared by the tasks of a single
+// call.
 //
 // NOTE: This function must be called sequentially for each task, and
 // each task needs to be launched before the next can be validated.
@@ -140,7 +156,8 @@ Option<Error> validate(
     const TaskInfo& task,
     Framework* framework,
     Slave* slave,
-    const Resources& offered);
+    const Resources& offered,
+    Context* context = nullptr);
 
 
 // Functions in this namespace are only exposed for testing.
@@ -100,6 +100,17 @@ class Scheduler(object):
       status on the driver.
     """
 
+  def statusUpdates(self, driver, statuses):
+    """
+      Invoked instead of statusUpdate when the driver batches status
+      updates (see the 'callback_batch_interval' flag of the scheduler
+      driver). The same semantics as for statusUpdate apply to each of
+      the status updates. By default, this invokes statusUpdate for each
+      status update in order.
+    """
+    for status in statuses:
+      self.statusUpdate(driver, status)
+
   def frameworkMessage(self, driver, executorId, slaveId, message):
     """
       Invoked when an executor sends a message. These messages are best
@@ -22,6 +22,8 @@
 #include <Python.h>
 
 #include <iostream>
+#include <string>
+#include <vector>
 
 #include <google/protobuf/io/zero_copy_stream_impl.h>
 
@@ -92,13 +94,87 @@ bool readPythonProtobuf(PyObject* obj, T* t)
 
 
 /**
- * Convert a C++ protocol buffer object into a Python one by serializing
- * it to a string and deserializing the result back in Python. Returns the
- * resulting PyObject* on success or raises a Python exception and returns
- * nullptr on failure.
+ * Convert a Python list of protocol buffer objects into C++ ones, like
+ * `readPythonProtobuf` does for each of them. The objects are serialized
+ * in Python first, and the GIL is released while all of them are
+ * deserialized in C++, so that other Python threads can run meanwhile.
+ * Returns true on success, or prints an error and returns false on
+ * failure.
  */
 template <typename T>
-PyObject* createPythonProtobuf(const T& t, const char* typeName)
+bool readPythonProtobufs(PyObject* list, std::vector<T>* ts)
+{
+  const Py_ssize_t len = PyList_Size(list);
+
+  // The serialized objects, which stay alive (and unchanged, since
+  // Python strings are immutable) while the GIL is released.
+  std::vector<PyObject*> strings;
+  strings.reserve(len);
+
+  bool success = true;
+
+  for (Py_ssize_t i = 0; i < len; i++) {
+    PyObject* obj = PyList_GetItem(list, i);
+    if (obj == Py_None) {
+      std::cerr << "None object given where protobuf expected" << std::endl;
+      success = false;
+      break;
+    }
+    PyObject* res = PyObject_CallMethod(obj,
+                                        (char*) "SerializeToString",
+                                        (char*) nullptr);
+    if (res == nullptr) {
+      std::cerr << "Failed to call Python object's SerializeToString "
+           << "(perhaps it is not a protobuf?)" << std::endl;
+      PyErr_Print();
+      success = false;
+      break;
+    }
+    if (!PyString_Check(res)) {
+      std::cerr << "SerializeToString did not return a string" << std::endl;
+      Py_DECREF(res);
+      success = false;
+      break;
+    }
+    strings.push_back(res);
+  }
+
+  if (success) {
+    const size_t offset = ts->size();
+    ts->resize(offset + strings.size());
+
+    Py_BEGIN_ALLOW_THREADS
+    for (size_t i = 0; i < strings.size(); i++) {
+      if (!(*ts)[offset + i].ParseFromArray(
+              PyString_AS_STRING(strings[i]),
+              PyString_GET_SIZE(strings[i]))) {
+        success = false;
+        break;
+      }
+    }
+    Py_END_ALLOW_THREADS
+
+    if (!success) {
+      std::cerr << "Could not deserialize protobuf as expected type"
+                << std::endl;
+      ts->resize(offset);
+    }
+  }
+
+  for (size_t i = 0; i < strings.size(); i++) {
+    Py_DECREF(strings[i]);
+  }
+
+  return success;
+}
+
+
+/**
+ * Returns the (borrowed) Python type of the protocol buffers with the
+ * given name in mesos_pb2, or raises a Python exception and returns
+ * nullptr on failure.
+ */
+inline PyObject* getPythonProtobufType(const char* typeName)
 {
   PyObject* dict = PyModule_GetDict(mesos_pb2);
   if (dict == nullptr) {
@@ -116,6 +192,24 @@ PyObject* createPythonProtobuf(const T& t, const char* typeName)
     return nullptr;
   }
 
+  return type;
+}
+
+
+/**
+ * Convert a C++ protocol buffer object into a Python one by serializing
+ * it to a string and deserializing the result back in Python. Returns the
+ * resulting PyObject* on success or raises a Python exception and returns
+ * nullptr on failure.
+ */
+template <typename T>
+PyObject* createPythonProtobuf(const T& t, const char* typeName)
+{
+  PyObject* type = getPythonProtobufType(typeName);
+  if (type == nullptr) {
+    return nullptr;
+  }
+
   std::string str;
   if (!t.SerializeToString(&str)) {
     PyErr_Format(PyExc_Exception, "C++ %s SerializeToString failed", typeName);
@@ -130,6 +224,80 @@ PyObject* createPythonProtobuf(const T& t, const char* typeName)
                              str.size());
 }
 
+
+/**
+ * Serialize C++ protocol buffer objects into `buffers`, reusing the
+ * memory of the buffers from previous calls. This does not need the
+ * GIL, so callbacks do it before acquiring the GIL to convert the
+ * results with `createPythonProtobufs`. Returns false on failure.
+ */
+template <typename T>
+bool serializeProtobufs(
+    const std::vector<T>& ts,
+    std::vector<std::string>* buffers)
+{
+  // NOTE: Shrinking would free the memory of the trailing buffers,
+  // so only the first `ts.size()` buffers are used.
+  if (buffers->size() < ts.size()) {
+    buffers->resize(ts.size());
+  }
+
+  for (size_t i = 0; i < ts.size(); i++) {
+    if (!ts[i].SerializeToString(&(*buffers)[i])) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+
+/**
+ * Convert the first `count` of the serialized protocol buffer objects in
+ * `buffers` into a Python list of objects of the given type. The type
+ * and its FromString method are only looked up once for the list.
+ * Returns the list on success or raises a Python exception and returns
+ * nullptr on failure.
+ */
+inline PyObject* createPythonProtobufs(
+    const std::vector<std::string>& buffers,
+    size_t count,
+    const char* typeName)
+{
+  PyObject* type = getPythonProtobufType(typeName);
+  if (type == nullptr) {
+    return nullptr;
+  }
+
+  PyObject* fromString = PyObject_GetAttrString(type, (char*) "FromString");
+  if (fromString == nullptr) {
+    return nullptr;
+  }
+
+  PyObject* list = PyList_New(count);
+  if (list == nullptr) {
+    Py_DECREF(fromString);
+    return nullptr;
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    // Propagates any exception that might happen in FromString.
+    PyObject* obj = PyObject_CallFunction(fromString,
+                                          (char*) "s#",
+                                          buffers[i].data(),
+                                          buffers[i].size());
+    if (obj == nullptr) {
+      Py_DECREF(list);
+      Py_DECREF(fromString);
+      return nullptr;
+    }
+    PyList_SET_ITEM(list, i, obj); // Steals the reference to obj.
+  }
+
+  Py_DECREF(fromString);
+  return list;
+}
+
 } // namespace python {
 } // namespace mesos {
 
@@ -412,18 +412,9 @@ PyObject* MesosSchedulerDriverImpl_requestResources(
                  "Parameter 2 to requestsResources is not a list");
     return nullptr;
   }
-  Py_ssize_t len = PyList_Size(requestsObj);
-  for (int i = 0; i < len; i++) {
-    PyObject* requestObj = PyList_GetItem(requestsObj, i);
-    if (requestObj == nullptr) {
-      return nullptr; // Exception will have been set by PyList_GetItem.
-    }
-    Request request;
-    if (!readPythonProtobuf(requestObj, &request)) {
-      PyErr_Format(PyExc_Exception, "Could not deserialize Python Request");
-      return nullptr;
-    }
-    requests.push_back(request);
+  if (!readPythonProtobufs(requestsObj, &requests)) {
+    PyErr_Format(PyExc_Exception, "Could not deserialize Python Request");
+    return nullptr;
   }
 
   Status status = self->driver->requestResources(requests);
@@ -460,19 +451,10 @@ PyObject* MesosSchedulerDriverImpl_launchTasks(MesosSchedulerDriverImpl* self,
     }
     offerIds.push_back(offerId);
   } else {
-    Py_ssize_t len = PyList_Size(offerIdsObj);
-    for (int i = 0; i < len; i++) {
-      PyObject* offerObj = PyList_GetItem(offerIdsObj, i);
-      if (offerObj == nullptr) {
-        return nullptr;
-      }
-      OfferID offerId;
-      if (!readPythonProtobuf(offerObj, &offerId)) {
-        PyErr_Format(PyExc_Exception,
-                     "Could not deserialize Python OfferID");
-        return nullptr;
-      }
-      offerIds.push_back(offerId);
+    if (!readPythonProtobufs(offerIdsObj, &offerIds)) {
+      PyErr_Format(PyExc_Exception,
+                   "Could not deserialize Python OfferID");
+      return nullptr;
     }
   }
 
@@ -480,19 +462,10 @@ PyObject* MesosSchedulerDriverImpl_launchTasks(MesosSchedulerDriverImpl* self,
     PyErr_Format(PyExc_Exception, "Parameter 2 to launchTasks is not a list");
     return nullptr;
   }
-  Py_ssize_t len = PyList_Size(tasksObj);
-  for (int i = 0; i < len; i++) {
-    PyObject* taskObj = PyList_GetItem(tasksObj, i);
-    if (taskObj == nullptr) {
-      return nullptr; // Exception will have been set by PyList_GetItem.
-    }
-    TaskInfo task;
-    if (!readPythonProtobuf(taskObj, &task)) {
-      PyErr_Format(PyExc_Exception,
-                   "Could not deserialize Python TaskInfo");
-      return nullptr;
-    }
-    tasks.push_back(task);
+  if (!readPythonProtobufs(tasksObj, &tasks)) {
+    PyErr_Format(PyExc_Exception,
+                 "Could not deserialize Python TaskInfo");
+    return nullptr;
   }
 
   if (filtersObj != nullptr) {
@@ -542,7 +515,6 @@ PyObject* MesosSchedulerDriverImpl_acceptOffers(MesosSchedulerDriverImpl* self,
   PyObject* offerIdsObj = nullptr;
   PyObject* operationsObj = nullptr;
   PyObject* filtersObj = nullptr;
-  Py_ssize_t len = 0;
   vector<OfferID> offerIds;
   vector<Offer::Operation> operations;
   Filters filters;
@@ -560,20 +532,10 @@ PyObject* MesosSchedulerDriverImpl_acceptOffers(MesosSchedulerDriverImpl* self,
     return nullptr;
   }
 
-  len = PyList_Size(offerIdsObj);
-  for (int i = 0; i < len; i++) {
-    PyObject* offerObj = PyList_GetItem(offerIdsObj, i);
-    if (offerObj == nullptr) {
-      return nullptr;
-    }
-
-    OfferID offerId;
-    if (!readPythonProtobuf(offerObj, &offerId)) {
-      PyErr_Format(PyExc_Exception,
-                   "Could not deserialize Python OfferID");
-      return nullptr;
-    }
-    offerIds.push_back(offerId);
+  if (!readPythonProtobufs(offerIdsObj, &offerIds)) {
+    PyErr_Format(PyExc_Exception,
+                 "Could not deserialize Python OfferID");
+    return nullptr;
   }
 
   if (!PyList_Check(operationsObj)) {
@@ -581,20 +543,10 @@ PyObject* MesosSchedulerDriverImpl_acceptOffers(MesosSchedulerDriverImpl* self,
     return nullptr;
   }
 
-  len = PyList_Size(operationsObj);
-  for (int i = 0; i < len; i++) {
-    PyObject* operationObj = PyList_GetItem(operationsObj, i);
-    if (operationObj == nullptr) {
-      return nullptr; // Exception will have been set by PyList_GetItem.
-    }
-
-    Offer::Operation operation;
-    if (!readPythonProtobuf(operationObj, &operation)) {
-      PyErr_Format(PyExc_Exception,
-                   "Could not deserialize Python Offer.Operation");
-      return nullptr;
-    }
-    operations.push_back(operation);
+  if (!readPythonProtobufs(operationsObj, &operations)) {
+    PyErr_Format(PyExc_Exception,
+                 "Could not deserialize Python Offer.Operation");
+    return nullptr;
   }
 
   if (filtersObj != nullptr) {
@@ -758,20 +710,10 @@ PyObject* MesosSchedulerDriverImpl_reconcileTasks(
     return nullptr;
   }
 
-  Py_ssize_t len = PyList_Size(statusesObj);
-  for (int i = 0; i < len; i++) {
-    PyObject* statusObj = PyList_GetItem(statusesObj, i);
-    if (statusObj == nullptr) {
-      return nullptr;
-    }
-
-    TaskStatus status;
-    if (!readPythonProtobuf(statusObj, &status)) {
-      PyErr_Format(PyExc_Exception,
-                   "Could not deserialize Python TaskStatus");
-      return nullptr;
-    }
-    statuses.push_back(status);
+  if (!readPythonProtobufs(statusesObj, &statuses)) {
+    PyErr_Format(PyExc_Exception,
+                 "Could not deserialize Python TaskStatus");
+    return nullptr;
   }
 
   Status status = self->driver->reconcileTasks(statuses);
@@ -137,21 +137,23 @@ cleanup:
 void ProxyScheduler::resourceOffers(SchedulerDriver* driver,
                                     const vector<Offer>& offers)
 {
+  // Serialize the offers before acquiring the GIL, so that Python
+  // threads are not blocked meanwhile.
+  const bool serialized = serializeProtobufs(offers, &buffers);
+
   InterpreterLock lock;
 
   PyObject* list = nullptr;
   PyObject* res = nullptr;
 
-  list = PyList_New(offers.size());
-  if (list == nullptr) {
+  if (!serialized) {
+    PyErr_Format(PyExc_Exception, "C++ Offer SerializeToString failed");
     goto cleanup;
   }
-  for (size_t i = 0; i < offers.size(); i++) {
-    PyObject* offer = createPythonProtobuf(offers[i], "Offer");
-    if (offer == nullptr) {
-      goto cleanup;
-    }
-    PyList_SetItem(list, i, offer); // Steals the reference to offer.
+
+  list = createPythonProtobufs(buffers, offers.size(), "Offer");
+  if (list == nullptr) {
+    goto cleanup; // createPythonProtobufs will have set an exception.
   }
 
   res = PyObject_CallMethod(impl->pythonScheduler,
@@ -241,6 +243,59 @@ cleanup:
 }
 
 
+void ProxyScheduler::statusUpdates(SchedulerDriver* driver,
+                                   const vector<TaskStatus>& statuses)
+{
+  // Serialize the status updates before acquiring the GIL, so that
+  // Python threads are not blocked meanwhile.
+  const bool serialized = serializeProtobufs(statuses, &buffers);
+
+  InterpreterLock lock;
+
+  // Schedulers that do not implement 'statusUpdates' (e.g., because
+  // they do not extend 'mesos.interface.Scheduler') get each status
+  // update through 'statusUpdate', while holding the lock only once.
+  if (!PyObject_HasAttrString(impl->pythonScheduler,
+                              (char*) "statusUpdates")) {
+    for (size_t i = 0; i < statuses.size(); i++) {
+      statusUpdate(driver, statuses[i]);
+    }
+    return;
+  }
+
+  PyObject* list = nullptr;
+  PyObject* res = nullptr;
+
+  if (!serialized) {
+    PyErr_Format(PyExc_Exception, "C++ TaskStatus SerializeToString failed");
+    goto cleanup;
+  }
+
+  list = createPythonProtobufs(buffers, statuses.size(), "TaskStatus");
+  if (list == nullptr) {
+    goto cleanup; // createPythonProtobufs will have set an exception.
+  }
+
+  res = PyObject_CallMethod(impl->pythonScheduler,
+                            (char*) "statusUpdates",
+                            (char*) "OO",
+                            impl,
+                            list);
+  if (res == nullptr) {
+    cerr << "Failed to call scheduler's statusUpdates" << endl;
+    goto cleanup;
+  }
+
+cleanup:
+  if (PyErr_Occurred()) {
+    PyErr_Print();
+    driver->abort();
+  }
+  Py_XDECREF(list);
+  Py_XDECREF(res);
+}
+
+
 void ProxyScheduler::frameworkMessage(SchedulerDriver* driver,
                                       const ExecutorID& executorId,
                                       const SlaveID& slaveId,
@@ -51,6 +51,8 @@ public:
                               const std::vector<Offer>& offers);
   virtual void offerRescinded(SchedulerDriver* driver, const OfferID& offerId);
   virtual void statusUpdate(SchedulerDriver* driver, const TaskStatus& status);
+  virtual void statusUpdates(SchedulerDriver* driver,
+                             const std::vector<TaskStatus>& statuses);
   virtual void frameworkMessage(SchedulerDriver* driver,
                                 const ExecutorID& executorId,
                                 const SlaveID& slaveId,
@@ -64,6 +66,10 @@ public:
 
 private:
   MesosSchedulerDriverImpl* impl;
+
+  // Buffers for serializing offers and status updates, which are
+  // reused across callbacks (the driver invokes them one at a time).
+  std::vector<std::string> buffers;
 };
 
 } // namespace python {
@@ -123,6 +123,23 @@ public:
         "authentication_timeout",
         "Timeout after which authentication will be retried.",
         DEFAULT_AUTHENTICATION_TIMEOUT);
+
+    add(&Flags::callback_batch_interval,
+        "callback_batch_interval",
+        "If set, the scheduler driver holds back the offers and status\n"
+        "updates it receives for up to this interval, and then passes\n"
+        "them to the scheduler with a single 'resourceOffers()' and a\n"
+        "single 'statusUpdates()' callback, respectively. This reduces the\n"
+        "number of callbacks, which is costly for schedulers that use the\n"
+        "Java or Python bindings, at the price of delaying the offers and\n"
+        "updates by up to the interval.",
+        [](const Option<Duration>& value) -> Option<Error> {
+          if (value.isSome() && value.get() <= Duration::zero()) {
+            return Error("Expected --callback_batch_interval to be positive");
+          }
+
+          return None();
+        });
   }
 
   Duration authentication_backoff_factor;
@@ -131,6 +148,7 @@ public:
   Option<std::string> modulesDir;
   std::string authenticatee;
   Duration authentication_timeout;
+  Option<Duration> callback_batch_interval;
 };
 
 } // namespace scheduler {
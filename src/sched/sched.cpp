@@ -268,6 +268,11 @@ protected:
         &StatusUpdateMessage::update,
         &StatusUpdateMessage::pid);
 
+    install<StatusUpdatesMessage>(
+        &SchedulerProcess::statusUpdates,
+        &StatusUpdatesMessage::updates,
+        &StatusUpdatesMessage::pid);
+
     install<LostSlaveMessage>(
         &SchedulerProcess::lostSlave,
         &LostSlaveMessage::slave_id);
@@ -332,6 +337,11 @@ protected:
 
     connected = false;
 
+    // Offers that have not been passed to the scheduler yet are not
+    // valid anymore, the (new) master will send new offers once the
+    // framework has re-registered.
+    pendingOffers.clear();
+
     if (master.isSome()) {
       LOG(INFO) << "New master detected at " << master.get().pid();
       link(master.get().pid());
@@ -637,33 +647,23 @@ protected:
           break;
         }
 
-        const TaskStatus& status = event.update().status();
-
-        // Create a StatusUpdate based on the TaskStatus.
-        StatusUpdate update;
-        update.mutable_framework_id()->CopyFrom(framework.id());
-        update.mutable_status()->CopyFrom(status);
-        update.set_timestamp(status.timestamp());
-
-        if (status.has_executor_id()) {
-          update.mutable_executor_id()->CopyFrom(status.executor_id());
-        }
-
-        if (status.has_slave_id()) {
-          update.mutable_slave_id()->CopyFrom(status.slave_id());
-        }
-
-        if (status.has_uuid()) {
-          update.set_uuid(status.uuid());
-        }
-
         // Note that we do not need to set the 'pid' now that
         // the driver uses 'uuid' absence to skip acknowledgement.
         //
         // TODO(bmahler): Implement an 'update' method to match
         // the Event naming scheme, and have 'statusUpdate' call
         // into it.
-        statusUpdate(from, update, UPID());
+        statusUpdate(from, toStatusUpdate(event.update().status()), UPID());
+        break;
+      }
+
+      case Event::UPDATES: {
+        vector<StatusUpdate> updates;
+        foreach (const TaskStatus& status, event.updates().statuses()) {
+          updates.push_back(toStatusUpdate(status));
+        }
+
+        statusUpdates(from, updates, UPID());
         break;
       }
 
@@ -923,6 +923,15 @@ protected:
       }
     }
 
+    if (flags.callback_batch_interval.isSome()) {
+      foreach (const Offer& offer, offers) {
+        pendingOffers.push_back(offer);
+      }
+
+      batch();
+      return;
+    }
+
     Stopwatch stopwatch;
     if (FLAGS_v >= 1) {
       stopwatch.start();
@@ -960,6 +969,17 @@ protected:
 
     savedOffers.erase(offerId);
 
+    // There is no need to tell the scheduler about an offer that has
+    // not been passed to it yet.
+    for (auto offer = pendingOffers.begin();
+         offer != pendingOffers.end();
+         ++offer) {
+      if (offer->id() == offerId) {
+        pendingOffers.erase(offer);
+        return;
+      }
+    }
+
     Stopwatch stopwatch;
     if (FLAGS_v >= 1) {
       stopwatch.start();
@@ -970,6 +990,41 @@ protected:
     VLOG(1) << "Scheduler::offerRescinded took " << stopwatch.elapsed();
   }
 
+  // A status update received by the driver, along with the status to
+  // pass to the scheduler (e.g., held back until the next batched
+  // callback, see `--callback_batch_interval`).
+  struct PendingUpdate
+  {
+    StatusUpdate update;
+    TaskStatus status;
+
+    // Whether the update needs to be acknowledged.
+    bool acknowledge;
+  };
+
+  // Creates a StatusUpdate based on the TaskStatus of an event.
+  StatusUpdate toStatusUpdate(const TaskStatus& status)
+  {
+    StatusUpdate update;
+    update.mutable_framework_id()->CopyFrom(framework.id());
+    update.mutable_status()->CopyFrom(status);
+    update.set_timestamp(status.timestamp());
+
+    if (status.has_executor_id()) {
+      update.mutable_executor_id()->CopyFrom(status.executor_id());
+    }
+
+    if (status.has_slave_id()) {
+      update.mutable_slave_id()->CopyFrom(status.slave_id());
+    }
+
+    if (status.has_uuid()) {
+      update.set_uuid(status.uuid());
+    }
+
+    return update;
+  }
+
   void statusUpdate(
       const UPID& from,
       const StatusUpdate& update,
@@ -1012,6 +1067,88 @@ protected:
     // multiple times (of course, if a scheduler re-uses a TaskID,
     // that could be bad.
 
+    const PendingUpdate pending = pendingUpdate(from, update, pid);
+
+    if (flags.callback_batch_interval.isSome()) {
+      pendingUpdates.push_back(pending);
+
+      batch();
+      return;
+    }
+
+    Stopwatch stopwatch;
+    if (FLAGS_v >= 1) {
+      stopwatch.start();
+    }
+
+    scheduler->statusUpdate(driver, pending.status);
+
+    VLOG(1) << "Scheduler::statusUpdate took " << stopwatch.elapsed();
+
+    if (implicitAcknowledgements && pending.acknowledge) {
+      _acknowledge(update);
+    }
+  }
+
+  // Handles a batch of status updates (e.g., the master's implicit
+  // reconciliation of a framework with the BATCHED_RECONCILIATION
+  // capability), which are passed to the scheduler in one callback.
+  void statusUpdates(
+      const UPID& from,
+      const vector<StatusUpdate>& updates,
+      const UPID& pid)
+  {
+    if (!running.load()) {
+      VLOG(1) << "Ignoring task status updates message because "
+              << "the driver is not running!";
+      return;
+    }
+
+    if (!connected) {
+      VLOG(1) << "Ignoring status updates message because the driver is "
+              << "disconnected!";
+      return;
+    }
+
+    CHECK_SOME(master);
+
+    if (from != master.get().pid()) {
+      VLOG(1) << "Ignoring status updates message because it was sent "
+              << "from '" << from << "' instead of the leading master '"
+              << master.get().pid() << "'";
+      return;
+    }
+
+    VLOG(2) << "Received " << updates.size() << " status updates from "
+            << pid;
+
+    vector<PendingUpdate> pending;
+    pending.reserve(updates.size());
+
+    foreach (const StatusUpdate& update, updates) {
+      CHECK(framework.id() == update.framework_id());
+
+      pending.push_back(pendingUpdate(from, update, pid));
+    }
+
+    if (flags.callback_batch_interval.isSome()) {
+      pendingUpdates.insert(
+          pendingUpdates.end(), pending.begin(), pending.end());
+
+      batch();
+      return;
+    }
+
+    deliver(pending);
+  }
+
+  // Returns the status to pass to the scheduler for the update and
+  // whether the update needs to be acknowledged.
+  PendingUpdate pendingUpdate(
+      const UPID& from,
+      const StatusUpdate& update,
+      const UPID& pid)
+  {
     TaskStatus status = update.status();
 
     // If the update does not have a 'uuid', it does not need
@@ -1031,50 +1168,139 @@ protected:
       status.set_uuid(update.uuid());
     }
 
+    // See above for when we don't need to acknowledge.
+    bool acknowledge = (update.has_uuid() && update.uuid() != "") ||
+                       (from != UPID() && pid != UPID());
+
+    return PendingUpdate{update, status, acknowledge};
+  }
+
+  // Sends an implicit acknowledgement for the status update.
+  void _acknowledge(const StatusUpdate& update)
+  {
+    // Note that we need to look at the atomic 'running' here
+    // so that we don't acknowledge the update if the driver was
+    // aborted during the processing of the update.
+    if (!running.load()) {
+      VLOG(1) << "Not sending status update acknowledgment message because "
+              << "the driver is not running!";
+      return;
+    }
+
+    // We drop updates while we're disconnected.
+    CHECK(connected);
+    CHECK_SOME(master);
+
+    VLOG(2) << "Sending ACK for status update " << update
+            << " to " << master.get().pid();
+
+    Call call;
+
+    CHECK(framework.has_id());
+    call.mutable_framework_id()->CopyFrom(framework.id());
+    call.set_type(Call::ACKNOWLEDGE);
+
+    Call::Acknowledge* acknowledge = call.mutable_acknowledge();
+    acknowledge->mutable_slave_id()->CopyFrom(update.slave_id());
+    acknowledge->mutable_task_id()->CopyFrom(update.status().task_id());
+    acknowledge->set_uuid(update.uuid());
+
+    send(master.get().pid(), call);
+  }
+
+  // Passes the status updates to the scheduler using a single
+  // callback, and then acknowledges them if needed.
+  void deliver(const vector<PendingUpdate>& updates)
+  {
+    vector<TaskStatus> statuses;
+    statuses.reserve(updates.size());
+
+    foreach (const PendingUpdate& update, updates) {
+      statuses.push_back(update.status);
+    }
+
     Stopwatch stopwatch;
     if (FLAGS_v >= 1) {
       stopwatch.start();
     }
 
-    scheduler->statusUpdate(driver, status);
+    scheduler->statusUpdates(driver, statuses);
 
-    VLOG(1) << "Scheduler::statusUpdate took " << stopwatch.elapsed();
+    VLOG(1) << "Scheduler::statusUpdates took " << stopwatch.elapsed()
+            << " for " << statuses.size() << " status updates";
 
     if (implicitAcknowledgements) {
-      // Note that we need to look at the atomic 'running' here
-      // so that we don't acknowledge the update if the driver was
-      // aborted during the processing of the update.
-      if (!running.load()) {
-        VLOG(1) << "Not sending status update acknowledgment message because "
-                << "the driver is not running!";
-        return;
+      foreach (const PendingUpdate& update, updates) {
+        if (!update.acknowledge) {
+          continue;
+        }
+
+        // The update will be retried if the driver got disconnected
+        // since the update was received.
+        if (!connected) {
+          VLOG(1) << "Not sending ACK for status update " << update.update
+                  << " because the driver is disconnected";
+          continue;
+        }
+
+        _acknowledge(update.update);
       }
+    }
+  }
+
+  // Schedules the delivery of the pending offers and status updates,
+  // unless it has been scheduled already.
+  void batch()
+  {
+    CHECK_SOME(flags.callback_batch_interval);
+
+    if (batchTimer.isNone()) {
+      batchTimer = process::delay(
+          flags.callback_batch_interval.get(), self(), &Self::flush);
+    }
+  }
 
-      // See above for when we don't need to acknowledge.
-      if ((update.has_uuid() && update.uuid() != "") ||
-          (from != UPID() && pid != UPID())) {
-        // We drop updates while we're disconnected.
-        CHECK(connected);
-        CHECK_SOME(master);
+  // Passes the pending status updates and offers to the scheduler,
+  // using a single callback for each.
+  void flush()
+  {
+    batchTimer = None();
 
-        VLOG(2) << "Sending ACK for status update " << update
-                << " to " << master.get().pid();
+    if (!running.load()) {
+      VLOG(1) << "Dropping " << pendingUpdates.size() << " status updates and "
+              << pendingOffers.size() << " offers because the driver is not "
+              << "running!";
 
-        Call call;
+      pendingUpdates.clear();
+      pendingOffers.clear();
+      return;
+    }
 
-        CHECK(framework.has_id());
-        call.mutable_framework_id()->CopyFrom(framework.id());
-        call.set_type(Call::ACKNOWLEDGE);
+    if (!pendingUpdates.empty()) {
+      vector<PendingUpdate> updates;
+      std::swap(updates, pendingUpdates);
 
-        Call::Acknowledge* acknowledge = call.mutable_acknowledge();
-        acknowledge->mutable_slave_id()->CopyFrom(update.slave_id());
-        acknowledge->mutable_task_id()->CopyFrom(update.status().task_id());
-        acknowledge->set_uuid(update.uuid());
+      deliver(updates);
+    }
 
-        CHECK_SOME(master);
-        send(master.get().pid(), call);
-      }
+    // The scheduler might have stopped (or aborted) the driver.
+    if (!running.load() || pendingOffers.empty()) {
+      pendingOffers.clear();
+      return;
+    }
+
+    vector<Offer> offers;
+    std::swap(offers, pendingOffers);
+
+    Stopwatch stopwatch;
+    if (FLAGS_v >= 1) {
+      stopwatch.start();
     }
+
+    scheduler->resourceOffers(driver, offers);
+
+    VLOG(1) << "Scheduler::resourceOffers took " << stopwatch.elapsed()
+            << " for " << offers.size() << " offers";
   }
 
   void lostSlave(const UPID& from, const SlaveID& slaveId)
@@ -1671,6 +1897,12 @@ private:
   hashmap<OfferID, hashmap<SlaveID, UPID>> savedOffers;
   hashmap<SlaveID, UPID> savedSlavePids;
 
+  // The offers and status updates that have been received since the
+  // last (batched) callback, and the timer for the next one.
+  vector<Offer> pendingOffers;
+  vector<PendingUpdate> pendingUpdates;
+  Option<process::Timer> batchTimer;
+
   // The driver optionally provides implicit acknowledgements
   // for frameworks. If disabled, the framework must send its
   // own acknowledgements through the driver, when the 'uuid'
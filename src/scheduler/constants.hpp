@@ -17,6 +17,8 @@
 #ifndef __SCHEDULER_CONSTANTS_HPP__
 #define __SCHEDULER_CONSTANTS_HPP__
 
+#include <stddef.h>
+
 #include <stout/duration.hpp>
 
 namespace mesos {
@@ -27,6 +29,10 @@ namespace scheduler {
 // before connecting with the master.
 constexpr Duration DEFAULT_CONNECTION_DELAY_MAX = Milliseconds(500);
 
+// Default maximum number of non-subscribe calls that the scheduler
+// sends to the master without having received their responses.
+constexpr size_t DEFAULT_MAX_INFLIGHT_CALLS = 1024;
+
 } // namespace scheduler {
 } // namespace v1 {
 } // namespace mesos {
@@ -37,9 +37,24 @@ public:
         "time between [0, b], where `b = connection_delay_max` before "
         "initiating a (re-)connection attempt with the master",
         DEFAULT_CONNECTION_DELAY_MAX);
+
+    add(&Flags::maxInflightCalls,
+        "max_inflight_calls",
+        "The maximum number of non-subscribe calls that are pipelined on the "
+        "connection with the master, i.e., that are sent without having "
+        "received their responses. Calls beyond this limit are queued by the "
+        "library and sent as responses for earlier calls arrive",
+        DEFAULT_MAX_INFLIGHT_CALLS,
+        [](size_t value) -> Option<Error> {
+          if (value < 1) {
+            return Error("Expected `max_inflight_calls` to be at least 1");
+          }
+          return None();
+        });
   }
 
   Duration connectionDelayMax;
+  size_t maxInflightCalls;
 };
 
 } // namespace scheduler {
@@ -35,6 +35,8 @@
 #include <string>
 #include <sstream>
 #include <tuple>
+#include <utility>
+#include <vector>
 
 #include <mesos/v1/mesos.hpp>
 #include <mesos/v1/scheduler.hpp>
@@ -50,6 +52,7 @@
 #include <process/http.hpp>
 #include <process/id.hpp>
 #include <process/mutex.hpp>
+#include <process/owned.hpp>
 #include <process/pid.hpp>
 #include <process/process.hpp>
 #include <process/protobuf.hpp>
@@ -63,6 +66,7 @@
 #include <stout/duration.hpp>
 #include <stout/error.hpp>
 #include <stout/flags.hpp>
+#include <stout/foreach.hpp>
 #include <stout/hashmap.hpp>
 #include <stout/ip.hpp>
 #include <stout/lambda.hpp>
@@ -157,7 +161,8 @@ public:
       callbacks {connected, disconnected, received},
       credential(_credential),
       local(false),
-      flags(_flags)
+      flags(_flags),
+      inflight(0)
   {
     GOOGLE_PROTOBUF_VERIFY_VERSION;
 
@@ -240,6 +245,54 @@ public:
       return;
     }
 
+    // Non-subscribe calls are pipelined on the non-subscribe connection,
+    // i.e., we send them without waiting for the responses of earlier
+    // calls. We bound the number of calls in flight so that a scheduler
+    // sending calls faster than the master handles them does not build
+    // up an unbounded pipeline, and queue up the calls beyond the bound.
+    if (call.type() != Call::SUBSCRIBE) {
+      if (inflight >= flags.maxInflightCalls) {
+        VLOG(2) << "Queuing " << call.type() << " call since "
+                << inflight << " calls are in flight";
+
+        pending.push(call);
+        return;
+      }
+
+      ++inflight;
+    }
+
+    post(call);
+  }
+
+  void reconnect()
+  {
+    // Ignore the reconnection request if we are currently disconnected
+    // from the master.
+    if (state == DISCONNECTED) {
+      VLOG(1) << "Ignoring reconnect request from scheduler since we are"
+              << " disconnected";
+
+      return;
+    }
+
+    CHECK_SOME(connectionId);
+
+    disconnected(connectionId.get(),
+                 "Received reconnect request from scheduler");
+  }
+
+protected:
+  virtual void initialize()
+  {
+    // Start detecting masters.
+    detection = detector->detect()
+      .onAny(defer(self(), &MesosProcess::detected, lambda::_1));
+  }
+
+  // Sends the (validated) call to the master.
+  void post(const Call& call)
+  {
     VLOG(1) << "Sending " << call.type() << " call to " << master.get();
 
     // TODO(vinod): Add support for sending MESSAGE calls directly
@@ -287,31 +340,6 @@ public:
                          lambda::_1));
   }
 
-  void reconnect()
-  {
-    // Ignore the reconnection request if we are currently disconnected
-    // from the master.
-    if (state == DISCONNECTED) {
-      VLOG(1) << "Ignoring reconnect request from scheduler since we are"
-              << " disconnected";
-
-      return;
-    }
-
-    CHECK_SOME(connectionId);
-
-    disconnected(connectionId.get(),
-                 "Received reconnect request from scheduler");
-  }
-
-protected:
-  virtual void initialize()
-  {
-    // Start detecting masters.
-    detection = detector->detect()
-      .onAny(defer(self(), &MesosProcess::detected, lambda::_1));
-  }
-
   void connect(const UUID& _connectionId)
   {
     // It is possible that a new master was detected while we were waiting
@@ -415,6 +443,14 @@ protected:
 
     state = DISCONNECTED;
 
+    if (!pending.empty()) {
+      LOG(WARNING) << "Dropping " << pending.size() << " queued calls"
+                   << " since we are disconnected";
+    }
+
+    inflight = 0;
+    pending = queue<Call>();
+
     connections = None();
     connectionId = None();
     subscribed = None();
@@ -489,9 +525,17 @@ protected:
 
   Future<Nothing> _receive()
   {
-    Future<Nothing> future = async(callbacks.received, events);
-    events = queue<Event>();
-    return future;
+    // Hand the queued events over to the 'received' callback without
+    // copying them, since there can be many of them (e.g., when the
+    // master sends a large number of offers or updates at once).
+    Owned<queue<Event>> batch(new queue<Event>());
+    std::swap(*batch, events);
+
+    lambda::function<void(const queue<Event>&)> received = callbacks.received;
+
+    return async([received, batch]() {
+      received(*batch);
+    });
   }
 
   // Helper for injecting an ERROR event.
@@ -527,6 +571,22 @@ protected:
     CHECK(!response.isDiscarded());
     CHECK(state == SUBSCRIBING || state == SUBSCRIBED) << state;
 
+    // Send the next queued call now that this call is no longer in
+    // flight. Note that the queued calls have already been validated,
+    // and are only queued while we are subscribed.
+    if (call.type() != Call::SUBSCRIBE) {
+      CHECK_GT(inflight, 0u);
+
+      if (pending.empty()) {
+        --inflight;
+      } else {
+        Call next = pending.front();
+        pending.pop();
+
+        post(next);
+      }
+    }
+
     // This can happen during a master failover or a network blip
     // causing the socket to timeout. Eventually, the scheduler would
     // detect the disconnection via ZK(disconnect()) or lack of heartbeats.
@@ -614,16 +674,21 @@ protected:
 
   void read()
   {
-    subscribed->decoder->read()
+    // We read all the events that have been decoded so far at once,
+    // rather than one at a time, to avoid a round trip with the
+    // reader for each event.
+    subscribed->decoder->readAll()
       .onAny(defer(self(),
                    &Self::_read,
                    subscribed->reader,
                    lambda::_1));
   }
 
-  void _read(const Pipe::Reader& reader, const Future<Result<Event>>& event)
+  void _read(
+      const Pipe::Reader& reader,
+      const Future<vector<Result<Event>>>& events)
   {
-    CHECK(!event.isDiscarded());
+    CHECK(!events.isDiscarded());
 
     // Ignore enqueued events from the previous Subscribe call reader.
     if (!subscribed.isSome() || subscribed->reader != reader) {
@@ -635,27 +700,30 @@ protected:
     CHECK_SOME(connectionId);
 
     // This could happen if the master failed over while sending a event.
-    if (event.isFailed()) {
+    if (events.isFailed()) {
       LOG(ERROR) << "Failed to decode the stream of events: "
-                 << event.failure();
-      disconnected(connectionId.get(), event.failure());
+                 << events.failure();
+      disconnected(connectionId.get(), events.failure());
       return;
     }
 
-    // This could happen if the master failed over after sending an event.
-    if (event->isNone()) {
-      const string error = "End-Of-File received from master. The master "
-                           "closed the event stream";
-      LOG(ERROR) << error;
+    foreach (const Result<Event>& event, events.get()) {
+      // This could happen if the master failed over after sending an
+      // event.
+      if (event.isNone()) {
+        const string error = "End-Of-File received from master. The master "
+                             "closed the event stream";
+        LOG(ERROR) << error;
 
-      disconnected(connectionId.get(), error);
-      return;
-    }
+        disconnected(connectionId.get(), error);
+        return;
+      }
 
-    if (event->isError()) {
-      error("Failed to de-serialize event: " + event->error());
-    } else {
-      receive(event.get().get(), false);
+      if (event.isError()) {
+        error("Failed to de-serialize event: " + event.error());
+      } else {
+        receive(event.get(), false);
+      }
     }
 
     read();
@@ -784,6 +852,12 @@ private:
   Option<UUID> streamId;
   const Flags flags;
 
+  // The number of non-subscribe calls sent on the current connection
+  // whose responses have not been received yet, and the calls queued
+  // up because `flags.maxInflightCalls` calls are in flight.
+  size_t inflight;
+  queue<Call> pending;
+
   // Master detection future.
   process::Future<Option<mesos::MasterInfo>> detection;
 };
@@ -28,6 +28,15 @@ Duration DEFAULT_MASTER_PING_TIMEOUT()
     master::DEFAULT_MAX_AGENT_PING_TIMEOUTS;
 }
 
+
+std::vector<SlaveInfo::Capability> AGENT_CAPABILITIES()
+{
+  SlaveInfo::Capability capability;
+  capability.set_type(SlaveInfo::Capability::STATUS_UPDATE_ACKNOWLEDGEMENTS);
+
+  return {capability};
+}
+
 } // namespace slave {
 } // namespace internal {
 } // namespace mesos {
@@ -19,6 +19,10 @@
 
 #include <stdint.h>
 
+#include <vector>
+
+#include <mesos/mesos.hpp>
+
 #include <stout/bytes.hpp>
 #include <stout/duration.hpp>
 
@@ -64,6 +68,9 @@ constexpr Duration DISK_WATCH_INTERVAL = Minutes(1);
 // Minimum free disk capacity enforced by the garbage collector.
 constexpr double GC_DISK_HEADROOM = 0.1;
 
+// Maximum number of paths the garbage collector removes concurrently.
+constexpr size_t GC_MAX_CONCURRENT_REMOVALS = 4;
+
 // Maximum number of completed frameworks to store in memory.
 constexpr size_t MAX_COMPLETED_FRAMEWORKS = 50;
 
@@ -92,6 +99,10 @@ constexpr double DEFAULT_EXECUTOR_CPUS = 0.1;
 // Default memory resource given to a command executor.
 constexpr Bytes DEFAULT_EXECUTOR_MEM = Megabytes(32);
 
+// Default duration to wait for the status and the resource statistics
+// of each container when streaming the `/containers` endpoint.
+constexpr Duration DEFAULT_CONTAINER_STREAM_TIMEOUT = Seconds(10);
+
 #ifdef WITH_NETWORK_ISOLATOR
 // Default number of ephemeral ports allocated to a container by the
 // network isolator.
@@ -109,6 +120,10 @@ constexpr Duration DOCKER_INSPECT_DELAY = Seconds(1);
 // in parallel to prevent hitting system's open file descriptor limit.
 constexpr size_t DOCKER_PS_MAX_INSPECT_CALLS = 100;
 
+// Maximum number of idle keep-alive connections to the Docker daemon
+// that are kept around for reuse by the Docker Engine API client.
+constexpr size_t DOCKER_MAX_IDLE_CONNECTIONS = 16;
+
 // Default duration that docker containerizer will wait to check
 // docker version.
 // TODO(tnachen): Make this a flag.
@@ -134,6 +149,14 @@ constexpr char READWRITE_HTTP_AUTHENTICATION_REALM[] = "mesos-agent-readwrite";
 // Default maximum storage space to be used by the fetcher cache.
 constexpr Bytes DEFAULT_FETCHER_CACHE_SIZE = Gigabytes(2);
 
+// Maximum amount of container output that the I/O switchboard
+// batches into a single `ProcessIO` message for attached clients.
+constexpr Bytes IO_SWITCHBOARD_OUTPUT_BATCH_SIZE = Kilobytes(64);
+
+// Maximum amount of time that the I/O switchboard holds back container
+// output from attached clients in order to batch it.
+constexpr Duration IO_SWITCHBOARD_OUTPUT_BATCH_LATENCY = Milliseconds(10);
+
 // If no pings received within this timeout, then the slave will
 // trigger a re-detection of the master to cause a re-registration.
 Duration DEFAULT_MASTER_PING_TIMEOUT();
@@ -141,6 +164,10 @@ Duration DEFAULT_MASTER_PING_TIMEOUT();
 // Name of the executable for default executor.
 constexpr char MESOS_DEFAULT_EXECUTOR[] = "mesos-default-executor";
 
+// The capabilities that the agent announces to the master when
+// (re-)registering.
+std::vector<SlaveInfo::Capability> AGENT_CAPABILITIES();
+
 } // namespace slave {
 } // namespace internal {
 } // namespace mesos {
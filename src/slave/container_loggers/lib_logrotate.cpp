@@ -108,6 +108,9 @@ public:
     overriddenFlags.logrotate_stdout_options = flags.logrotate_stdout_options;
     overriddenFlags.max_stderr_size = flags.max_stderr_size;
     overriddenFlags.logrotate_stderr_options = flags.logrotate_stderr_options;
+    overriddenFlags.max_stdout_files = flags.max_stdout_files;
+    overriddenFlags.max_stderr_files = flags.max_stderr_files;
+    overriddenFlags.compress_rotated_logs = flags.compress_rotated_logs;
 
     // Check for overrides of the rotation settings in the
     // `ExecutorInfo`s environment variables.
@@ -171,6 +174,8 @@ public:
     mesos::internal::logger::rotate::Flags outFlags;
     outFlags.max_size = overriddenFlags.max_stdout_size;
     outFlags.logrotate_options = overriddenFlags.logrotate_stdout_options;
+    outFlags.max_files = overriddenFlags.max_stdout_files;
+    outFlags.compress = overriddenFlags.compress_rotated_logs;
     outFlags.log_filename = path::join(sandboxDirectory, "stdout");
     outFlags.logrotate_path = flags.logrotate_path;
     outFlags.user = user;
@@ -229,6 +234,8 @@ public:
     mesos::internal::logger::rotate::Flags errFlags;
     errFlags.max_size = overriddenFlags.max_stderr_size;
     errFlags.logrotate_options = overriddenFlags.logrotate_stderr_options;
+    errFlags.max_files = overriddenFlags.max_stderr_files;
+    errFlags.compress = overriddenFlags.compress_rotated_logs;
     errFlags.log_filename = path::join(sandboxDirectory, "stderr");
     errFlags.logrotate_path = flags.logrotate_path;
     errFlags.user = user;
@@ -82,6 +82,39 @@ struct LoggerFlags : public virtual flags::FlagsBase
         "    size <max_stderr_size>\n"
         "  }\n"
         "NOTE: The 'size' option will be overridden by this module.");
+
+    add(&LoggerFlags::max_stdout_files,
+        "max_stdout_files",
+        "If specified, the stdout log files are rotated without forking\n"
+        "'logrotate', keeping at most this many rotated files\n"
+        "(i.e., 'stdout.1' to 'stdout.<max_stdout_files>').\n"
+        "NOTE: 'logrotate_stdout_options' is ignored in this case.",
+        &LoggerFlags::validateFiles);
+
+    add(&LoggerFlags::max_stderr_files,
+        "max_stderr_files",
+        "If specified, the stderr log files are rotated without forking\n"
+        "'logrotate', keeping at most this many rotated files\n"
+        "(i.e., 'stderr.1' to 'stderr.<max_stderr_files>').\n"
+        "NOTE: 'logrotate_stderr_options' is ignored in this case.",
+        &LoggerFlags::validateFiles);
+
+    add(&LoggerFlags::compress_rotated_logs,
+        "compress_rotated_logs",
+        "Whether to compress the rotated log files with gzip (in the\n"
+        "background).  Only used along with 'max_stdout_files' and\n"
+        "'max_stderr_files'.",
+        false);
+  }
+
+  static Option<Error> validateFiles(const Option<size_t>& value)
+  {
+    if (value.isSome() && value.get() == 0) {
+      return Error(
+          "Expected --max_stdout_files and --max_stderr_files of at least 1");
+    }
+
+    return None();
   }
 
   static Option<Error> validateSize(const Bytes& value)
@@ -100,6 +133,10 @@ struct LoggerFlags : public virtual flags::FlagsBase
 
   Bytes max_stderr_size;
   Option<std::string> logrotate_stderr_options;
+
+  Option<size_t> max_stdout_files;
+  Option<size_t> max_stderr_files;
+  bool compress_rotated_logs;
 };
 
 
@@ -111,12 +148,15 @@ struct Flags : public virtual LoggerFlags
         "environment_variable_prefix",
         "Prefix for environment variables meant to modify the behavior of\n"
         "the logrotate logger for the specific executor being launched.\n"
-        "The logger will look for four prefixed environment variables in the\n"
+        "The logger will look for these prefixed environment variables in the\n"
         "'ExecutorInfo's 'CommandInfo's 'Environment':\n"
         "  * MAX_STDOUT_SIZE\n"
         "  * LOGROTATE_STDOUT_OPTIONS\n"
         "  * MAX_STDERR_SIZE\n"
         "  * LOGROTATE_STDERR_OPTIONS\n"
+        "  * MAX_STDOUT_FILES\n"
+        "  * MAX_STDERR_FILES\n"
+        "  * COMPRESS_ROTATED_LOGS\n"
         "If present, these variables will overwrite the global values set\n"
         "via module parameters.",
         "CONTAINER_LOGGER_");
@@ -20,7 +20,9 @@
 
 #include <functional>
 #include <string>
+#include <vector>
 
+#include <process/async.hpp>
 #include <process/defer.hpp>
 #include <process/dispatch.hpp>
 #include <process/id.hpp>
@@ -30,12 +32,19 @@
 #include <stout/bytes.hpp>
 #include <stout/error.hpp>
 #include <stout/exit.hpp>
+#include <stout/foreach.hpp>
+#include <stout/gzip.hpp>
 #include <stout/nothing.hpp>
 #include <stout/path.hpp>
 #include <stout/stringify.hpp>
 #include <stout/try.hpp>
 
+#include <stout/os/close.hpp>
+#include <stout/os/exists.hpp>
+#include <stout/os/open.hpp>
 #include <stout/os/pagesize.hpp>
+#include <stout/os/rename.hpp>
+#include <stout/os/rm.hpp>
 #include <stout/os/shell.hpp>
 #include <stout/os/su.hpp>
 #include <stout/os/write.hpp>
@@ -54,7 +63,8 @@ public:
     : ProcessBase(process::ID::generate("logrotate-logger")),
       flags(_flags),
       leading(None()),
-      bytesWritten(0)
+      bytesWritten(0),
+      compressing(Nothing())
   {
     // Prepare a buffer for reading from the `incoming` pipe.
     length = os::pagesize();
@@ -77,23 +87,26 @@ public:
   // leading log file, and manages total log size.
   Future<Nothing> run()
   {
-    // Populate the `logrotate` configuration file.
-    // See `Flags::logrotate_options` for the format.
+    // Populate the `logrotate` configuration file, unless we rotate
+    // the logs ourselves. See `Flags::logrotate_options` for the format.
     //
     // NOTE: We specify a size of `--max_size - length` because `logrotate`
     // has slightly different size semantics.  `logrotate` will rotate when the
     // max size is *exceeded*.  We rotate to keep files *under* the max size.
-    const std::string config =
-      "\"" + flags.log_filename.get() + "\" {\n" +
-      flags.logrotate_options.getOrElse("") + "\n" +
-      "size " + stringify(flags.max_size.bytes() - length) + "\n" +
-      "}";
-
-    Try<Nothing> result = os::write(
-        flags.log_filename.get() + CONF_SUFFIX, config);
-
-    if (result.isError()) {
-      return Failure("Failed to write configuration file: " + result.error());
+    if (flags.max_files.isNone()) {
+      const std::string config =
+        "\"" + flags.log_filename.get() + "\" {\n" +
+        flags.logrotate_options.getOrElse("") + "\n" +
+        "size " + stringify(flags.max_size.bytes() - length) + "\n" +
+        "}";
+
+      Try<Nothing> result = os::write(
+          flags.log_filename.get() + CONF_SUFFIX, config);
+
+      if (result.isError()) {
+        return Failure(
+            "Failed to write configuration file: " + result.error());
+      }
     }
 
     // NOTE: This is a prerequisuite for `io::read`.
@@ -117,6 +130,9 @@ public:
         // This indicates that the container (whose logs are being
         // piped to this process) has exited.
         if (readSize <= 0) {
+          // Let the compression of the last rotated file finish.
+          compressing.await();
+
           promise.set(Nothing());
           return Nothing();
         }
@@ -188,20 +204,114 @@ public:
       leading = None();
     }
 
-    // Call `logrotate` to move around the files.
-    // NOTE: If `logrotate` fails for whatever reason, we will ignore
-    // the error and continue logging.  In case the leading log file
-    // is not renamed, we will continue appending to the existing
-    // leading log file.
-    os::shell(
-        flags.logrotate_path +
-        " --state \"" + flags.log_filename.get() + STATE_SUFFIX + "\" \"" +
-        flags.log_filename.get() + CONF_SUFFIX + "\"");
+    if (flags.max_files.isSome()) {
+      shift();
+    } else {
+      // Call `logrotate` to move around the files.
+      // NOTE: If `logrotate` fails for whatever reason, we will ignore
+      // the error and continue logging.  In case the leading log file
+      // is not renamed, we will continue appending to the existing
+      // leading log file.
+      os::shell(
+          flags.logrotate_path +
+          " --state \"" + flags.log_filename.get() + STATE_SUFFIX + "\" \"" +
+          flags.log_filename.get() + CONF_SUFFIX + "\"");
+    }
 
     // Reset the number of bytes written.
     bytesWritten = 0;
   }
 
+  // Rotates the log files without forking `logrotate`: drops the oldest
+  // rotated log file, renames '<log_filename>.N' to '<log_filename>.N+1'
+  // and the leading log file to '<log_filename>.1'.  Like with `logrotate`,
+  // errors are ignored and we continue logging to the leading log file.
+  void shift()
+  {
+    const std::string& filename = flags.log_filename.get();
+    const size_t files = flags.max_files.get();
+
+    // Wait for the previously rotated log file to be compressed, so
+    // that it is not renamed from under the compression.
+    compressing.await();
+
+    // NOTE: A rotated log file might not be compressed (e.g., if the
+    // compression failed or was turned off), so we look for both.
+    const std::vector<std::string> suffixes = {"", ".gz"};
+
+    foreach (const std::string& suffix, suffixes) {
+      const std::string oldest = filename + "." + stringify(files) + suffix;
+
+      if (os::exists(oldest)) {
+        os::rm(oldest);
+      }
+
+      for (size_t i = files - 1; i > 0; i--) {
+        const std::string from = filename + "." + stringify(i) + suffix;
+
+        if (os::exists(from)) {
+          os::rename(from, filename + "." + stringify(i + 1) + suffix);
+        }
+      }
+    }
+
+    const std::string rotated = filename + ".1";
+
+    Try<Nothing> rename = os::rename(filename, rotated);
+    if (rename.isError()) {
+      std::cerr << "Failed to rotate '" << filename << "': "
+                << rename.error() << std::endl;
+      return;
+    }
+
+    if (flags.compress) {
+      // NOTE: `async` runs the compression on another thread, so that we
+      // can keep on draining the STDIN pipe in the meantime.
+      compressing = async(&LogrotateLoggerProcess::compress, rotated);
+    }
+  }
+
+  // Replaces the file at 'path' with a gzip compressed '<path>.gz'.
+  // The file is compressed as it is read, since it can be as large
+  // as `--max_size` allows.
+  static Nothing compress(const std::string& path)
+  {
+    Try<int> in = os::open(path, O_RDONLY | O_CLOEXEC);
+    if (in.isError()) {
+      std::cerr << "Failed to open '" << path << "': "
+                << in.error() << std::endl;
+      return Nothing();
+    }
+
+    Try<int> out = os::open(
+        path + ".gz",
+        O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+        S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+
+    if (out.isError()) {
+      std::cerr << "Failed to open '" << path << ".gz': "
+                << out.error() << std::endl;
+      os::close(in.get());
+      return Nothing();
+    }
+
+    Try<Nothing> compressed = gzip::compress(in.get(), out.get());
+
+    os::close(in.get());
+    os::close(out.get());
+
+    if (compressed.isError()) {
+      std::cerr << "Failed to compress '" << path << "': "
+                << compressed.error() << std::endl;
+      os::rm(path + ".gz");
+      return Nothing();
+    }
+
+    os::rm(path);
+
+    return Nothing();
+  }
+
 private:
   Flags flags;
 
@@ -213,6 +323,9 @@ private:
   Option<int> leading;
   size_t bytesWritten;
 
+  // The compression of the most recently rotated log file, if any.
+  Future<Nothing> compressing;
+
   // Used to capture when log rotation has completed because the
   // underlying process/input has terminated.
   Promise<Nothing> promise;
@@ -48,7 +48,8 @@ struct Flags : public virtual flags::FlagsBase
       "This command pipes from STDIN to the given leading log file.\n"
       "When the leading log file reaches '--max_size', the command.\n"
       "uses 'logrotate' to rotate the logs.  All 'logrotate' options\n"
-      "are supported.  See '--logrotate_options'.\n"
+      "are supported.  See '--logrotate_options'.  If '--max_files' is\n"
+      "specified, the command rotates the logs itself instead.\n"
       "\n");
 
     add(&Flags::max_size,
@@ -76,6 +77,26 @@ struct Flags : public virtual flags::FlagsBase
         "  }\n"
         "NOTE: The 'size' option will be overridden by this command.");
 
+    add(&Flags::max_files,
+        "max_files",
+        "If specified, the logs are rotated by this command itself rather\n"
+        "than by forking 'logrotate', keeping at most this many rotated\n"
+        "log files ('<log_filename>.1' being the most recent one).\n"
+        "NOTE: '--logrotate_options' is ignored in this case.",
+        [](const Option<size_t>& value) -> Option<Error> {
+          if (value.isSome() && value.get() == 0) {
+            return Error("Expected --max_files of at least 1");
+          }
+
+          return None();
+        });
+
+    add(&Flags::compress,
+        "compress",
+        "Whether to compress the rotated log files with gzip (in the\n"
+        "background).  Only used if '--max_files' is specified.",
+        false);
+
     add(&Flags::log_filename,
         "log_filename",
         "Absolute path to the leading log file.\n"
@@ -120,6 +141,8 @@ struct Flags : public virtual flags::FlagsBase
 
   Bytes max_size;
   Option<std::string> logrotate_options;
+  Option<size_t> max_files;
+  bool compress;
   Option<std::string> log_filename;
   std::string logrotate_path;
   Option<std::string> user;
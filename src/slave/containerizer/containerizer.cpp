@@ -264,7 +264,15 @@ Try<Containerizer*> Containerizer::create(
         return Error("Failed to NvidiaVolume::create: " + volume.error());
       }
 
-      nvidia = NvidiaComponents(allocator.get(), volume.get());
+      Try<NvidiaGpuSampler> sampler =
+        NvidiaGpuSampler::create(allocator->total());
+
+      if (sampler.isError()) {
+        return Error("Failed to NvidiaGpuSampler::create: " +
+                     sampler.error());
+      }
+
+      nvidia = NvidiaComponents(allocator.get(), volume.get(), sampler.get());
     }
   }
 #endif
@@ -1798,8 +1798,7 @@ Future<ResourceStatistics> DockerContainerizerProcess::usage(
     return Failure("Container is being removed: " + stringify(containerId));
   }
 
-  auto collectUsage = [this, containerId](
-      pid_t pid) -> Future<ResourceStatistics> {
+  auto collectUsage = [this, containerId]() -> Future<ResourceStatistics> {
     // First make sure container is still there.
     if (!containers_.contains(containerId)) {
       return Failure("Container has been destroyed: " + stringify(containerId));
@@ -1811,7 +1810,7 @@ Future<ResourceStatistics> DockerContainerizerProcess::usage(
       return Failure("Container is being removed: " + stringify(containerId));
     }
 
-    const Try<ResourceStatistics> cgroupStats = cgroupsStatistics(pid);
+    const Try<ResourceStatistics> cgroupStats = cgroupsStatistics(container);
     if (cgroupStats.isError()) {
       return Failure("Failed to collect cgroup stats: " + cgroupStats.error());
     }
@@ -1835,7 +1834,7 @@ Future<ResourceStatistics> DockerContainerizerProcess::usage(
 
   // Skip inspecting the docker container if we already have the pid.
   if (container->pid.isSome()) {
-    return collectUsage(container->pid.get());
+    return collectUsage();
   }
 
   return docker->inspect(container->name())
@@ -1859,60 +1858,97 @@ Future<ResourceStatistics> DockerContainerizerProcess::usage(
         // a pid for the container.
         container->pid = pid;
 
-        return collectUsage(pid.get());
+        return collectUsage();
       }));
 #endif // __linux__
 }
 
 
-Try<ResourceStatistics> DockerContainerizerProcess::cgroupsStatistics(
-    pid_t pid) const
+#ifdef __linux__
+// Returns a reader of the given cgroup of a process in the hierarchy
+// of the subsystem.
+static Try<Owned<cgroups::Reader>> cgroupReader(
+    const string& subsystem,
+    const Result<string>& cgroup)
 {
-#ifndef __linux__
-  return Error("Does not support cgroups on non-linux platform");
-#else
-  const Result<string> cpuacctHierarchy = cgroups::hierarchy("cpuacct");
-  const Result<string> memHierarchy = cgroups::hierarchy("memory");
+  const Result<string> hierarchy = cgroups::hierarchy(subsystem);
 
-  if (cpuacctHierarchy.isError()) {
+  if (hierarchy.isError()) {
     return Error(
-        "Failed to determine the cgroup 'cpuacct' subsystem hierarchy: " +
-        cpuacctHierarchy.error());
+        "Failed to determine the cgroup '" + subsystem +
+        "' subsystem hierarchy: " + hierarchy.error());
+  } else if (hierarchy.isNone()) {
+    return Error(
+        "Unable to find the cgroup '" + subsystem + "' subsystem hierarchy");
   }
 
-  if (memHierarchy.isError()) {
+  if (cgroup.isError()) {
     return Error(
-        "Failed to determine the cgroup 'memory' subsystem hierarchy: " +
-        memHierarchy.error());
+        "Failed to determine cgroup for the '" + subsystem +
+        "' subsystem: " + cgroup.error());
+  } else if (cgroup.isNone()) {
+    return Error("Unable to find '" + subsystem + "' cgroup subsystem");
   }
 
-  const Result<string> cpuacctCgroup = cgroups::cpuacct::cgroup(pid);
-  if (cpuacctCgroup.isError()) {
-    return Error(
-        "Failed to determine cgroup for the 'cpuacct' subsystem: " +
-        cpuacctCgroup.error());
-  } else if (cpuacctCgroup.isNone()) {
-    return Error("Unable to find 'cpuacct' cgroup subsystem");
+  return Owned<cgroups::Reader>(
+      new cgroups::Reader(hierarchy.get(), cgroup.get()));
+}
+#endif // __linux__
+
+
+Try<ResourceStatistics> DockerContainerizerProcess::cgroupsStatistics(
+    Container* container)
+{
+#ifndef __linux__
+  return Error("Does not support cgroups on non-linux platform");
+#else
+  CHECK_SOME(container->pid);
+
+  const pid_t pid = container->pid.get();
+
+  if (container->cpuacctReader.get() == nullptr) {
+    Try<Owned<cgroups::Reader>> reader =
+      cgroupReader("cpuacct", cgroups::cpuacct::cgroup(pid));
+
+    if (reader.isError()) {
+      return Error(reader.error());
+    }
+
+    container->cpuacctReader = reader.get();
   }
 
-  const Result<string> memCgroup = cgroups::memory::cgroup(pid);
-  if (memCgroup.isError()) {
-    return Error(
-        "Failed to determine cgroup for the 'memory' subsystem: " +
-        memCgroup.error());
-  } else if (memCgroup.isNone()) {
-    return Error("Unable to find 'memory' cgroup subsystem");
+  if (container->memoryReader.get() == nullptr) {
+    Try<Owned<cgroups::Reader>> reader =
+      cgroupReader("memory", cgroups::memory::cgroup(pid));
+
+    if (reader.isError()) {
+      return Error(reader.error());
+    }
+
+    container->memoryReader = reader.get();
   }
 
-  const Try<cgroups::cpuacct::Stats> cpuAcctStat =
-    cgroups::cpuacct::stat(cpuacctHierarchy.get(), cpuacctCgroup.get());
+  // Get the number of clock ticks, used for cpu accounting.
+  static long ticks = sysconf(_SC_CLK_TCK);
+
+  PCHECK(ticks > 0) << "Failed to get sysconf(_SC_CLK_TCK)";
+
+  const Try<hashmap<string, uint64_t>> cpuAcctStat =
+    container->cpuacctReader->stat("cpuacct.stat");
 
   if (cpuAcctStat.isError()) {
-    return Error("Failed to get cpu.stat: " + cpuAcctStat.error());
+    return Error("Failed to get cpuacct.stat: " + cpuAcctStat.error());
+  }
+
+  Option<uint64_t> user = cpuAcctStat->get("user");
+  Option<uint64_t> system = cpuAcctStat->get("system");
+
+  if (user.isNone() || system.isNone()) {
+    return Error("cgroups cpuacct stats does not contain 'user' and 'system'");
   }
 
   const Try<hashmap<string, uint64_t>> memStats =
-    cgroups::stat(memHierarchy.get(), memCgroup.get(), "memory.stat");
+    container->memoryReader->stat("memory.stat");
 
   if (memStats.isError()) {
     return Error(
@@ -1926,31 +1962,25 @@ Try<ResourceStatistics> DockerContainerizerProcess::cgroupsStatistics(
 
   ResourceStatistics result;
   result.set_timestamp(Clock::now().secs());
-  result.set_cpus_system_time_secs(cpuAcctStat.get().system.secs());
-  result.set_cpus_user_time_secs(cpuAcctStat.get().user.secs());
+  result.set_cpus_system_time_secs((double) system.get() / (double) ticks);
+  result.set_cpus_user_time_secs((double) user.get() / (double) ticks);
   result.set_mem_rss_bytes(memStats.get().at("rss"));
 
   // Add the cpu.stat information only if CFS is enabled.
   if (flags.cgroups_enable_cfs) {
-    const Result<string> cpuHierarchy = cgroups::hierarchy("cpu");
+    if (container->cpuReader.get() == nullptr) {
+      Try<Owned<cgroups::Reader>> reader =
+        cgroupReader("cpu", cgroups::cpu::cgroup(pid));
 
-    if (cpuHierarchy.isError()) {
-      return Error(
-          "Failed to determine the cgroup 'cpu' subsystem hierarchy: " +
-          cpuHierarchy.error());
-    }
+      if (reader.isError()) {
+        return Error(reader.error());
+      }
 
-    const Result<string> cpuCgroup = cgroups::cpu::cgroup(pid);
-    if (cpuCgroup.isError()) {
-      return Error(
-          "Failed to determine cgroup for the 'cpu' subsystem: " +
-          cpuCgroup.error());
-    } else if (cpuCgroup.isNone()) {
-      return Error("Unable to find 'cpu' cgroup subsystem");
+      container->cpuReader = reader.get();
     }
 
     const Try<hashmap<string, uint64_t>> stat =
-      cgroups::stat(cpuHierarchy.get(), cpuCgroup.get(), "cpu.stat");
+      container->cpuReader->stat("cpu.stat");
 
     if (stat.isError()) {
       return Error("Failed to read cpu.stat: " + stat.error());
@@ -33,6 +33,10 @@
 #include "docker/docker.hpp"
 #include "docker/executor.hpp"
 
+#ifdef __linux__
+#include "linux/cgroups.hpp"
+#endif // __linux__
+
 #include "slave/containerizer/containerizer.hpp"
 
 #include "slave/containerizer/mesos/isolators/gpu/components.hpp"
@@ -281,7 +285,11 @@ private:
       const std::set<Gpu>& deallocated);
 #endif // __linux__
 
-  Try<ResourceStatistics> cgroupsStatistics(pid_t pid) const;
+  // Forward declaration.
+  struct Container;
+
+  // Collects the statistics of the running container from its cgroups.
+  Try<ResourceStatistics> cgroupsStatistics(Container* container);
 
   // Call back for when the executor exits. This will trigger
   // container destroy.
@@ -511,6 +519,14 @@ private:
 #ifdef __linux__
     // GPU resources allocated to the container.
     std::set<Gpu> gpus;
+
+    // The readers of the cgroups of the running container, which are
+    // determined (from the pid) on the first usage() call and then
+    // reused, so that collecting the usage of the container only
+    // reads the (open) control files.
+    process::Owned<cgroups::Reader> cpuacctReader;
+    process::Owned<cgroups::Reader> memoryReader;
+    process::Owned<cgroups::Reader> cpuReader;
 #endif // __linux__
 
     // Marks if this container launches an executor in a docker
@@ -22,8 +22,11 @@
 #include <process/dispatch.hpp>
 #include <process/owned.hpp>
 
+#include <stout/hashset.hpp>
 #include <stout/net.hpp>
+#include <stout/numify.hpp>
 #include <stout/path.hpp>
+#include <stout/protobuf.hpp>
 #ifdef __WINDOWS__
 #include <stout/windows.hpp>
 #endif // __WINDOWS__
@@ -32,9 +35,12 @@
 #include <stout/os/killtree.hpp>
 #include <stout/os/read.hpp>
 
+#include "common/command_utils.hpp"
+
 #include "hdfs/hdfs.hpp"
 
 #include "slave/slave.hpp"
+#include "slave/state.hpp"
 
 #include "slave/containerizer/fetcher.hpp"
 
@@ -42,7 +48,6 @@ using std::list;
 using std::map;
 using std::shared_ptr;
 using std::string;
-using std::transform;
 using std::vector;
 
 using mesos::fetcher::FetcherInfo;
@@ -63,6 +68,14 @@ static const string FILE_URI_LOCALHOST = "file://localhost";
 
 static const string CACHE_FILE_NAME_PREFIX = "c";
 
+static const string CACHE_INDEX_FILE_NAME = "index";
+
+
+static string getCacheIndexPath(const string& cacheDirectory)
+{
+  return path::join(cacheDirectory, CACHE_INDEX_FILE_NAME);
+}
+
 
 Fetcher::Fetcher() : process(new FetcherProcess())
 {
@@ -86,8 +99,7 @@ Fetcher::~Fetcher()
 
 Try<Nothing> Fetcher::recover(const SlaveID& slaveId, const Flags& flags)
 {
-  // Good enough for now, simple, least-effort recovery.
-  VLOG(1) << "Clearing fetcher cache";
+  VLOG(1) << "Recovering fetcher cache";
 
   string cacheDirectory = paths::getSlavePath(flags.fetcher_cache_dir, slaveId);
   Result<string> path = os::realpath(cacheDirectory);
@@ -98,16 +110,77 @@ Try<Nothing> Fetcher::recover(const SlaveID& slaveId, const Flags& flags)
     return Error(path.error());
   }
 
-  if (path.isSome() && os::exists(path.get())) {
-    Try<Nothing> rmdir = os::rmdir(path.get(), true);
-    if (rmdir.isError()) {
-      LOG(ERROR) << "Could not delete fetcher cache directory '"
-                 << cacheDirectory << "', error: " + rmdir.error();
+  if (path.isNone() || !os::exists(path.get())) {
+    return Nothing();
+  }
+
+  const string indexPath = getCacheIndexPath(path.get());
 
-      return rmdir;
+  FetcherCacheIndex index;
+  if (os::exists(indexPath)) {
+    Result<FetcherCacheIndex> read =
+      ::protobuf::read<FetcherCacheIndex>(indexPath);
+
+    if (read.isError()) {
+      LOG(WARNING) << "Clearing fetcher cache due to failure to read the "
+                   << "cache index '" << indexPath << "': " << read.error();
+    } else if (read.isSome()) {
+      index = read.get();
+    }
+  }
+
+  // Keep the cache files which still have the recorded size. Their
+  // checksums are verified by the fetcher process before they are
+  // reused, since this would delay the recovery of the agent.
+  FetcherCacheIndex recovered;
+  hashset<string> files = {indexPath};
+
+  foreach (const FetcherCacheIndex::Entry& entry, index.entries()) {
+    const string file =
+      path::join(path.get(), entry.directory(), entry.filename());
+
+    Try<Bytes> size = os::stat::size(file, os::stat::DO_NOT_FOLLOW_SYMLINK);
+    if (size.isSome() && size->bytes() == entry.size()) {
+      recovered.add_entries()->CopyFrom(entry);
+      files.insert(file);
+    } else {
+      VLOG(1) << "Discarding cache entry '" << entry.key()
+              << "' with file: " << file;
     }
   }
 
+  // Delete everything else (e.g., partial downloads).
+  Try<list<string>> find = os::find(path.get(), "");
+  if (find.isError()) {
+    LOG(ERROR) << "Could not access fetcher cache directory '"
+               << cacheDirectory << "', error: " << find.error();
+
+    return Error(find.error());
+  }
+
+  foreach (const string& file, find.get()) {
+    if (!files.contains(file)) {
+      Try<Nothing> rm = os::rm(file);
+      if (rm.isError()) {
+        LOG(ERROR) << "Could not delete fetcher cache file '" << file
+                   << "', error: " << rm.error();
+
+        return rm;
+      }
+    }
+  }
+
+  Try<Nothing> checkpoint = slave::state::checkpoint(indexPath, recovered);
+  if (checkpoint.isError()) {
+    LOG(ERROR) << "Could not write fetcher cache index '" << indexPath
+               << "', error: " << checkpoint.error();
+
+    return checkpoint;
+  }
+
+  VLOG(1) << "Recovered " << recovered.entries_size()
+          << " fetcher cache entries";
+
   return Nothing();
 }
 
@@ -190,6 +263,17 @@ static Try<Nothing> validateUris(const CommandInfo& commandInfo)
         return Error(outputFileValidation.error());
       }
     }
+
+    if (uri.has_sha512()) {
+      // A SHA-512 checksum has 512 bits, i.e., 128 hexadecimal digits.
+      if (uri.sha512().size() != 128 ||
+          uri.sha512().find_first_not_of("0123456789abcdefABCDEF") !=
+            string::npos) {
+        return Error(
+            "Invalid SHA-512 checksum '" + uri.sha512() + "' for URI '" +
+            uri.value() + "'");
+      }
+    }
   }
 
   return Nothing();
@@ -354,6 +438,11 @@ Future<Nothing> FetcherProcess::fetch(
   // always the exact same value.
   cache.setSpace(flags.fetcher_cache_size);
 
+  // NOTE: As with the cache space, the cache index is restored here
+  // rather than at creation time, since this is when we learn about
+  // the cache directory.
+  recover(paths::getSlavePath(flags.fetcher_cache_dir, slaveId));
+
   Try<Nothing> validated = validateUris(commandInfo);
   if (validated.isError()) {
     return Failure("Could not fetch: " + validated.error());
@@ -399,7 +488,7 @@ Future<Nothing> FetcherProcess::fetch(
     // Check if this is already in the cache (but not necessarily
     // downloaded).
     const Option<shared_ptr<Cache::Entry>> entry =
-      cache.get(commandUser, uri.value());
+      cache.get(commandUser, uri);
 
     if (entry.isSome()) {
       entry.get()->reference();
@@ -549,6 +638,8 @@ Future<Nothing> FetcherProcess::__fetch(
     info.set_frameworks_home(flags.frameworks_home);
   }
 
+  info.set_max_concurrent_downloads(flags.fetcher_max_concurrent_downloads);
+
   return run(containerId, sandboxDirectory, user, info, flags)
     .repair(defer(self(), [=](const Future<Nothing>& future) {
       LOG(ERROR) << "Failed to run mesos-fetcher: " << future.failure();
@@ -582,6 +673,8 @@ Future<Nothing> FetcherProcess::__fetch(
             Try<Nothing> adjust = cache.adjust(entry.get());
             if (adjust.isSome()) {
               entry.get()->complete();
+
+              checksum(entry.get());
             } else {
               LOG(WARNING) << "Failed to adjust the cache size for entry '"
                            << entry.get()->key << "' with error: "
@@ -596,11 +689,136 @@ Future<Nothing> FetcherProcess::__fetch(
         }
       }
 
+      // Record the order in which the entries have been used (as well
+      // as any evictions).
+      checkpoint();
+
       return Nothing();
     }));
 }
 
 
+void FetcherProcess::recover(const string& cacheDirectory)
+{
+  if (recoveredCacheDirectory.isSome()) {
+    // TODO(bernd-mesos): This will disappear once we inject flags at
+    // Fetcher/FetcherProcess creation time. For now we trust this is
+    // always the exact same value.
+    CHECK_EQ(recoveredCacheDirectory.get(), cacheDirectory);
+    return;
+  }
+
+  recoveredCacheDirectory = cacheDirectory;
+
+  const string indexPath = getCacheIndexPath(cacheDirectory);
+  if (!os::exists(indexPath)) {
+    return;
+  }
+
+  Result<FetcherCacheIndex> index =
+    ::protobuf::read<FetcherCacheIndex>(indexPath);
+
+  if (!index.isSome()) {
+    LOG(WARNING) << "Failed to read the fetcher cache index '" << indexPath
+                 << "': " << (index.isError() ? index.error() : "empty");
+    return;
+  }
+
+  foreach (const FetcherCacheIndex::Entry& _entry, index->entries()) {
+    const string directory = _entry.directory().empty()
+      ? cacheDirectory
+      : path::join(cacheDirectory, _entry.directory());
+
+    shared_ptr<Cache::Entry> entry = cache.restore(
+        directory,
+        _entry.key(),
+        _entry.filename(),
+        Bytes(_entry.size()));
+
+    entry->checksum = _entry.checksum();
+
+    // Fetch attempts wait for the completion of the entry (i.e., the
+    // verification of its checksum), while it cannot be evicted.
+    entry->reference();
+
+    command::sha512(entry->path())
+      .onAny(defer(self(), [=](const Future<string>& checksum) {
+        entry->unreference();
+
+        if (checksum.isReady() && entry->checksum == checksum.get()) {
+          VLOG(1) << "Recovered cache entry '" << entry->key
+                  << "' with file: " << entry->filename;
+
+          entry->complete();
+          return;
+        }
+
+        LOG(WARNING) << "Discarding fetcher cache file '" << entry->path()
+                     << "' for '" << entry->key << "': "
+                     << (checksum.isReady()
+                           ? "Checksum mismatch"
+                           : (checksum.isFailed()
+                                ? checksum.failure()
+                                : "discarded"));
+
+        entry->fail();
+
+        Try<Nothing> remove = cache.remove(entry);
+        if (remove.isError()) {
+          LOG(WARNING) << remove.error();
+        }
+
+        checkpoint();
+      }));
+  }
+}
+
+
+void FetcherProcess::checksum(const shared_ptr<Cache::Entry>& entry)
+{
+  command::sha512(entry->path())
+    .onAny(defer(self(), [=](const Future<string>& checksum) {
+      if (!checksum.isReady()) {
+        LOG(WARNING) << "Failed to compute the checksum of fetcher cache "
+                     << "file '" << entry->path() << "', which will not be "
+                     << "recovered: "
+                     << (checksum.isFailed()
+                           ? checksum.failure()
+                           : "discarded");
+        return;
+      }
+
+      // The entry might have been evicted in the meantime.
+      if (!cache.contains(entry)) {
+        return;
+      }
+
+      entry->checksum = checksum.get();
+
+      checkpoint();
+    }));
+}
+
+
+void FetcherProcess::checkpoint()
+{
+  if (recoveredCacheDirectory.isNone()) {
+    return;
+  }
+
+  const string indexPath = getCacheIndexPath(recoveredCacheDirectory.get());
+
+  Try<Nothing> checkpoint = slave::state::checkpoint(
+      indexPath,
+      cache.index(recoveredCacheDirectory.get()));
+
+  if (checkpoint.isError()) {
+    LOG(WARNING) << "Failed to write the fetcher cache index '" << indexPath
+                 << "': " << checkpoint.error();
+  }
+}
+
+
 static off_t delta(
     const Bytes& actualSize,
     const shared_ptr<FetcherProcess::Cache::Entry>& entry)
@@ -651,10 +869,12 @@ Try<list<Path>> FetcherProcess::cacheFiles(
                  cacheDirectory + "' with error: " + find.error());
   }
 
-  transform(find.get().begin(),
-            find.get().end(),
-            std::back_inserter(result),
-            [](const string& path) { return Path(path); });
+  // NOTE: This skips the cache index (and its temporary files).
+  foreach (const string& path, find.get()) {
+    if (strings::startsWith(Path(path).basename(), CACHE_FILE_NAME_PREFIX)) {
+      result.push_back(Path(path));
+    }
+  }
 
   return result;
 }
@@ -942,9 +1162,17 @@ string FetcherProcess::Cache::nextFilename(const CommandInfo::URI& uri)
 }
 
 
-static string cacheKey(const Option<string>& user, const string& uri)
+// Identifies the resource at the URI by its checksum if it is known,
+// so that different URIs for the same resource share the cache entry.
+static string cacheKey(
+    const Option<string>& user,
+    const CommandInfo::URI& uri)
 {
-  return user.isNone() ? uri : user.get() + "@" + uri;
+  const string resource = uri.has_sha512()
+    ? "sha512:" + strings::lower(uri.sha512())
+    : uri.value();
+
+  return user.isNone() ? resource : user.get() + "@" + resource;
 }
 
 
@@ -953,7 +1181,7 @@ shared_ptr<FetcherProcess::Cache::Entry> FetcherProcess::Cache::create(
     const Option<string>& user,
     const CommandInfo::URI& uri)
 {
-  const string key = cacheKey(user, uri.value());
+  const string key = cacheKey(user, uri);
   const string filename = nextFilename(uri);
 
   auto entry = shared_ptr<Cache::Entry>(
@@ -968,10 +1196,74 @@ shared_ptr<FetcherProcess::Cache::Entry> FetcherProcess::Cache::create(
 }
 
 
+shared_ptr<FetcherProcess::Cache::Entry> FetcherProcess::Cache::restore(
+    const string& directory,
+    const string& key,
+    const string& filename,
+    const Bytes& size)
+{
+  auto entry = shared_ptr<Cache::Entry>(
+      new Cache::Entry(key, directory, filename));
+
+  table.put(key, entry);
+  lruSortedEntries.push_back(entry);
+
+  // NOTE: See `reserveCacheSpace()` for claiming the space along with
+  // setting the entry size.
+  claimSpace(size);
+  entry->size = size;
+
+  // Make sure new cache files do not reuse the names of the restored
+  // ones, see `nextFilename()`.
+  const size_t separator = filename.find('-');
+  if (strings::startsWith(filename, CACHE_FILE_NAME_PREFIX) &&
+      separator != string::npos) {
+    Try<unsigned long> serial = numify<unsigned long>(filename.substr(
+        CACHE_FILE_NAME_PREFIX.size(),
+        separator - CACHE_FILE_NAME_PREFIX.size()));
+
+    if (serial.isSome() && serial.get() > filenameSerial) {
+      filenameSerial = serial.get();
+    }
+  }
+
+  VLOG(1) << "Restored cache entry '" << key << "' with file: " << filename;
+
+  return entry;
+}
+
+
+FetcherCacheIndex FetcherProcess::Cache::index(const string& cacheDirectory)
+{
+  FetcherCacheIndex index;
+
+  foreach (const shared_ptr<Cache::Entry>& entry, lruSortedEntries) {
+    if (entry->checksum.isNone() || entry->completion().isFailed()) {
+      continue;
+    }
+
+    FetcherCacheIndex::Entry* _entry = index.add_entries();
+    _entry->set_key(entry->key);
+    _entry->set_filename(entry->filename);
+    _entry->set_size(entry->size.bytes());
+    _entry->set_checksum(entry->checksum.get());
+
+    if (entry->directory != cacheDirectory) {
+      CHECK(strings::startsWith(entry->directory, cacheDirectory + "/"));
+
+      _entry->set_directory(
+          entry->directory.substr(cacheDirectory.size() + 1));
+    }
+  }
+
+  return index;
+}
+
+
 Option<shared_ptr<FetcherProcess::Cache::Entry>>
 FetcherProcess::Cache::get(
     const Option<string>& user,
-    const string& uri)
+    const CommandInfo::URI& uri)
 {
   const string key = cacheKey(user, uri);
 
@@ -988,7 +1280,7 @@ FetcherProcess::Cache::get(
 
 bool FetcherProcess::Cache::contains(
     const Option<string>& user,
-    const string& uri)
+    const CommandInfo::URI& uri)
 {
   const string key = cacheKey(user, uri);
   return table.get(key).isSome();
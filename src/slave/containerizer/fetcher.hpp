@@ -32,6 +32,8 @@
 
 #include <stout/hashmap.hpp>
 
+#include "messages/messages.hpp"
+
 #include "slave/flags.hpp"
 
 namespace mesos {
@@ -86,6 +88,12 @@ public:
 
   virtual ~Fetcher();
 
+  // Keeps the cache files of the given agent that are recorded in the
+  // cache index with their size, and deletes the rest of the cache
+  // directory (e.g., partial downloads). The kept files are reused
+  // once their checksums have been verified, see
+  // `FetcherProcess::recover()`.
+  //
   // TODO(bernd-mesos): Inject these parameters at Fetcher creation time.
   // Then also inject the fetcher into the slave at creation time. Then
   // it will be possible to make this an instance method instead of a
@@ -204,6 +212,11 @@ public:
       // different a warning is logged and the field's value adjusted.
       Bytes size;
 
+      // The SHA-512 checksum of the cache file, once it has been
+      // computed. Only entries with a checksum are recorded in the
+      // cache index.
+      Option<std::string> checksum;
+
     private:
       // Concurrent fetch attempts can reference the same entry multiple
       // times.
@@ -236,14 +249,30 @@ public:
         const Option<std::string>& user,
         const CommandInfo::URI& uri);
 
+    // Inserts an entry for a cache file recovered from the cache
+    // index as the most recently used entry, and claims its space.
+    // Returns the entry.
+    std::shared_ptr<Entry> restore(
+        const std::string& directory,
+        const std::string& key,
+        const std::string& filename,
+        const Bytes& size);
+
+    // Returns the cache index recording the entries with a checksum
+    // (that did not fail) in the given cache directory.
+    FetcherCacheIndex index(const std::string& cacheDirectory);
+
     // Retrieves the cache entry indexed by the parameters, without
-    // changing its reference count.
+    // changing its reference count. URIs with the same checksum (see
+    // `CommandInfo::URI::sha512`) share the entry.
     Option<std::shared_ptr<Entry>> get(
         const Option<std::string>& user,
-        const std::string& uri);
+        const CommandInfo::URI& uri);
 
     // Returns whether an entry for this user and URI is in the cache.
-    bool contains(const Option<std::string>& user, const std::string& uri);
+    bool contains(
+        const Option<std::string>& user,
+        const CommandInfo::URI& uri);
 
     // Returns whether this identical entry is in the cache.
     bool contains(const std::shared_ptr<Cache::Entry>& entry);
@@ -315,6 +344,18 @@ public:
   Bytes availableCacheSpace();
 
 private:
+  // Restores the entries recorded in the cache index of the given
+  // cache directory (once), see `Fetcher::recover()`. A restored
+  // entry is reused once the checksum of its file has been verified.
+  void recover(const std::string& cacheDirectory);
+
+  // Computes the checksum of the successfully downloaded entry, and
+  // records the entry in the cache index.
+  void checksum(const std::shared_ptr<Cache::Entry>& entry);
+
+  // Writes the cache index of the recovered cache directory.
+  void checkpoint();
+
   process::Future<Nothing> __fetch(
       const hashmap<CommandInfo::URI,
       Option<std::shared_ptr<Cache::Entry>>>& entries,
@@ -333,6 +374,10 @@ private:
 
   Cache cache;
 
+  // The cache directory of the agent, once its cache index has been
+  // restored.
+  Option<std::string> recoveredCacheDirectory;
+
   hashmap<ContainerID, pid_t> subprocessPids;
 };
 
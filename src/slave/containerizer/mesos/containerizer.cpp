@@ -259,9 +259,13 @@ Try<MesosContainerizer*> MesosContainerizer::create(
   //
   // Currently, the order of the entries in the --isolation flag
   // specifies the ordering of the isolators. Specifically, the
-  // `create` and `prepare` calls for each isolator are run serially
-  // in the order in which they appear in the --isolation flag, while
-  // the `cleanup` call is serialized in reverse order.
+  // `create` calls for each isolator are run serially in the order in
+  // which they appear in the --isolation flag, while the `cleanup`
+  // call is serialized in reverse order. The `prepare` calls of the
+  // built-in isolators are run concurrently once the filesystem
+  // isolator has been prepared, while those of the isolator modules
+  // are run serially after them (see
+  // `MesosContainerizerProcess::stages()`).
   //
   // It is the responsibility of each isolator to check its
   // dependency requirements (if any) during its `create`
@@ -302,6 +306,7 @@ Try<MesosContainerizer*> MesosContainerizer::create(
 
 #if ENABLE_XFS_DISK_ISOLATOR
     {"disk/xfs", &XfsDiskIsolatorProcess::create},
+    {"disk/ext4", &XfsDiskIsolatorProcess::createExt4},
 #endif // ENABLE_XFS_DISK_ISOLATOR
 #else
     {"windows/cpu", &WindowsCpuIsolatorProcess::create},
@@ -360,6 +365,7 @@ Try<MesosContainerizer*> MesosContainerizer::create(
   }
 
   vector<Owned<Isolator>> isolators;
+  vector<string> isolatorNames;
 
   // Note: For cgroups, we only create `CgroupsIsolatorProcess` once.
   // We use this flag to identify whether `CgroupsIsolatorProcess` has
@@ -395,8 +401,10 @@ Try<MesosContainerizer*> MesosContainerizer::create(
     // prepared filesystem (e.g., any volume mounts are performed).
     if (strings::contains(isolation, "filesystem/")) {
       isolators.insert(isolators.begin(), Owned<Isolator>(isolator.get()));
+      isolatorNames.insert(isolatorNames.begin(), isolation);
     } else {
       isolators.push_back(Owned<Isolator>(isolator.get()));
+      isolatorNames.push_back(isolation);
     }
   }
 
@@ -406,7 +414,8 @@ Try<MesosContainerizer*> MesosContainerizer::create(
       fetcher,
       Owned<Launcher>(launcher.get()),
       provisioner,
-      isolators);
+      isolators,
+      isolatorNames);
 }
 
 
@@ -416,7 +425,8 @@ Try<MesosContainerizer*> MesosContainerizer::create(
     Fetcher* fetcher,
     const Owned<Launcher>& launcher,
     const Shared<Provisioner>& provisioner,
-    const vector<Owned<Isolator>>& isolators)
+    const vector<Owned<Isolator>>& isolators,
+    const vector<string>& isolatorNames)
 {
   // Add I/O switchboard to the isolator list.
   //
@@ -434,6 +444,12 @@ Try<MesosContainerizer*> MesosContainerizer::create(
   _isolators.push_back(Owned<Isolator>(new MesosIsolator(
       Owned<MesosIsolatorProcess>(ioSwitchboard.get()))));
 
+  vector<string> _isolatorNames(isolatorNames);
+
+  if (!_isolatorNames.empty()) {
+    _isolatorNames.push_back("io/switchboard");
+  }
+
   return new MesosContainerizer(Owned<MesosContainerizerProcess>(
       new MesosContainerizerProcess(
           flags,
@@ -441,7 +457,8 @@ Try<MesosContainerizer*> MesosContainerizer::create(
           ioSwitchboard.get(),
           launcher,
           provisioner,
-          _isolators)));
+          _isolators,
+          _isolatorNames)));
 }
 
 
@@ -1103,9 +1120,10 @@ Future<bool> MesosContainerizerProcess::launch(
                   checkpoint));
   }
 
-  container->provisioning = provisioner->provision(
-      containerId,
-      containerConfig.container_info().mesos().image());
+  container->provisioning = metrics.launch_provisioning.time(
+      provisioner->provision(
+          containerId,
+          containerConfig.container_info().mesos().image()));
 
   return container->provisioning
     .then(defer(self(),
@@ -1170,32 +1188,79 @@ Future<Nothing> MesosContainerizerProcess::prepare(
   // Captured for lambdas below.
   ContainerConfig containerConfig = container->config;
 
-  // We prepare the isolators sequentially according to their ordering
-  // to permit basic dependency specification, e.g., preparing a
-  // filesystem isolator before other isolators.
-  Future<list<Option<ContainerLaunchInfo>>> f =
-    list<Option<ContainerLaunchInfo>>();
+  // We prepare the isolators in stages to permit basic dependency
+  // specification, e.g., preparing a filesystem isolator before other
+  // isolators (see `stages()`). The isolators of a stage are prepared
+  // concurrently, and we wait for all of them (even if one fails) so
+  // that destroy only starts calling cleanup after all isolators have
+  // finished preparing. The launch infos are kept in the order of the
+  // isolators regardless of the stages.
+  Owned<vector<Option<ContainerLaunchInfo>>> launchInfos(
+      new vector<Option<ContainerLaunchInfo>>(isolators.size()));
+
+  Future<Nothing> f = Nothing();
+
+  foreach (const vector<size_t>& stage, prepareStages) {
+    // Chain together preparing each stage.
+    f = f.then([=]() -> Future<Nothing> {
+      list<Future<Nothing>> futures;
+
+      foreach (size_t index, stage) {
+        const Owned<Isolator>& isolator = isolators[index];
+
+        // If this is a nested container, we need to skip isolators that
+        // do not support nesting.
+        if (containerId.has_parent() && !isolator->supportsNesting()) {
+          continue;
+        }
+
+        Future<Option<ContainerLaunchInfo>> prepare =
+          isolator->prepare(containerId, containerConfig);
 
-  foreach (const Owned<Isolator>& isolator, isolators) {
-    // If this is a nested container, we need to skip isolators that
-    // do not support nesting.
-    if (containerId.has_parent() && !isolator->supportsNesting()) {
-      continue;
-    }
+        if (!metrics.isolator_prepare.empty()) {
+          prepare = metrics.isolator_prepare[index].time(prepare);
+        }
+
+        futures.push_back(prepare
+          .then([=](const Option<ContainerLaunchInfo>& launchInfo) {
+            launchInfos->at(index) = launchInfo;
+            return Nothing();
+          }));
+      }
 
-    // Chain together preparing each isolator.
-    f = f.then([=](list<Option<ContainerLaunchInfo>> launchInfos) {
-      return isolator->prepare(containerId, containerConfig)
-        .then([=](const Option<ContainerLaunchInfo>& launchInfo) mutable {
-          launchInfos.push_back(launchInfo);
-          return launchInfos;
+      return await(futures)
+        .then([](const list<Future<Nothing>>& futures) -> Future<Nothing> {
+          foreach (const Future<Nothing>& future, futures) {
+            if (!future.isReady()) {
+              return Failure(
+                  future.isFailed() ? future.failure() : "discarded");
+            }
+          }
+
+          return Nothing();
         });
-      });
+    });
   }
 
-  container->launchInfos = f;
+  container->launchInfos = f
+    .then([=]() {
+      list<Option<ContainerLaunchInfo>> result;
+
+      for (size_t index = 0; index < isolators.size(); index++) {
+        if (containerId.has_parent() &&
+            !isolators[index]->supportsNesting()) {
+          continue;
+        }
+
+        result.push_back(launchInfos->at(index));
+      }
+
+      return result;
+    });
+
+  metrics.launch_preparing.time(container->launchInfos);
 
-  return f.then([]() { return Nothing(); });
+  return container->launchInfos.then([]() { return Nothing(); });
 }
 
 
@@ -1224,13 +1289,13 @@ Future<Nothing> MesosContainerizerProcess::fetch(
     user = container->config.user();
   }
 
-  return fetcher->fetch(
+  return metrics.launch_fetching.time(fetcher->fetch(
       containerId,
       container->config.command_info(),
       directory,
       user,
       slaveId,
-      flags)
+      flags))
     .then([=]() -> Future<Nothing> {
       if (HookManager::hooksAvailable()) {
         HookManager::slavePostFetchHook(containerId, directory);
@@ -1607,6 +1672,8 @@ Future<bool> MesosContainerizerProcess::_launch(
   argv[0] = path::join(flags.launcher_dir, MESOS_CONTAINERIZER);
   argv[1] = MesosContainerizerLaunch::NAME;
 
+  metrics.launch_forking.start();
+
   Try<pid_t> forked = launcher->fork(
       containerId,
       argv[0],
@@ -1621,6 +1688,8 @@ Future<bool> MesosContainerizerProcess::_launch(
       // 'cloneNamespaces' will be ignored by PosixLauncher.
       _cloneNamespaces);
 
+  metrics.launch_forking.stop();
+
   if (forked.isError()) {
     return Failure("Failed to fork: " + forked.error());
   }
@@ -1724,18 +1793,27 @@ Future<bool> MesosContainerizerProcess::isolate(
   // or destroy because we assume there are no dependencies in
   // isolation.
   list<Future<Nothing>> futures;
-  foreach (const Owned<Isolator>& isolator, isolators) {
+  for (size_t index = 0; index < isolators.size(); index++) {
+    const Owned<Isolator>& isolator = isolators[index];
+
     // If this is a nested container, we need to skip isolators that
     // do not support nesting.
     if (containerId.has_parent() && !isolator->supportsNesting()) {
       continue;
     }
 
-    futures.push_back(isolator->isolate(containerId, _pid));
+    Future<Nothing> isolate = isolator->isolate(containerId, _pid);
+
+    if (!metrics.isolator_isolate.empty()) {
+      isolate = metrics.isolator_isolate[index].time(isolate);
+    }
+
+    futures.push_back(isolate);
   }
 
   // Wait for all isolators to complete.
-  Future<list<Nothing>> future = collect(futures);
+  Future<list<Nothing>> future =
+    metrics.launch_isolating.time(collect(futures));
 
   containers_.at(containerId)->isolation = future;
 
@@ -1792,6 +1870,14 @@ Future<bool> MesosContainerizerProcess::launch(
         "Nested container " + stringify(containerId) + " already started");
   }
 
+  // The rootfs of a destroyed container with the same ID might still
+  // be being reclaimed, see `_____destroy()`.
+  if (reclaiming.contains(containerId)) {
+    return Failure(
+        "Nested container " + stringify(containerId) + " is still being "
+        "reclaimed");
+  }
+
   const ContainerID& parentContainerId = containerId.parent();
   if (!containers_.contains(parentContainerId)) {
     return Failure(
@@ -2236,7 +2322,7 @@ void MesosContainerizerProcess::__destroy(
   CHECK(containers_.contains(containerId));
 
   // Kill all processes then continue destruction.
-  launcher->destroy(containerId)
+  metrics.destroy_killing.time(launcher->destroy(containerId))
     .onAny(defer(self(), &Self::___destroy, containerId, lambda::_1));
 }
 
@@ -2279,7 +2365,7 @@ void MesosContainerizerProcess::____destroy(
 {
   CHECK(containers_.contains(containerId));
 
-  cleanupIsolators(containerId)
+  metrics.destroy_cleaning.time(cleanupIsolators(containerId))
     .onAny(defer(self(), &Self::_____destroy, containerId, lambda::_1));
 }
 
@@ -2315,27 +2401,43 @@ void MesosContainerizerProcess::_____destroy(
     return;
   }
 
-  provisioner->destroy(containerId)
-    .onAny(defer(self(), &Self::______destroy, containerId, lambda::_1));
+  // Removing the provisioned rootfs of the container (e.g., unmounting
+  // it and deleting its layers) can take a while, so it is reclaimed
+  // in the background rather than holding up the termination of the
+  // container. A rootfs left behind by an agent restart is removed by
+  // the provisioner during recovery, as is the case for any unknown
+  // container.
+  reclaiming.put(containerId, provisioner->destroy(containerId));
+
+  reclaiming.at(containerId)
+    .onAny(defer(self(), &Self::reclaimed, containerId, lambda::_1));
+
+  ______destroy(containerId);
 }
 
 
-void MesosContainerizerProcess::______destroy(
+void MesosContainerizerProcess::reclaimed(
     const ContainerID& containerId,
     const Future<bool>& destroy)
 {
-  CHECK(containers_.contains(containerId));
-
-  const Owned<Container>& container = containers_.at(containerId);
+  reclaiming.erase(containerId);
 
   if (!destroy.isReady()) {
-    container->termination.fail(
-        "Failed to destroy the provisioned rootfs when destroying container: " +
-        (destroy.isFailed() ? destroy.failure() : "discarded future"));
+    LOG(ERROR) << "Failed to destroy the provisioned rootfs of container "
+               << containerId << ": "
+               << (destroy.isFailed() ? destroy.failure() : "discarded future");
 
-    ++metrics.container_destroy_errors;
-    return;
+    ++metrics.rootfs_reclaim_errors;
   }
+}
+
+
+void MesosContainerizerProcess::______destroy(
+    const ContainerID& containerId)
+{
+  CHECK(containers_.contains(containerId));
+
+  const Owned<Container>& container = containers_.at(containerId);
 
   ContainerTermination termination;
 
@@ -2520,17 +2622,184 @@ Future<hashset<ContainerID>> MesosContainerizerProcess::containers()
 }
 
 
-MesosContainerizerProcess::Metrics::Metrics()
+double MesosContainerizerProcess::_containers_destroying()
+{
+  size_t count = 0;
+
+  foreachvalue (const Owned<Container>& container, containers_) {
+    if (container->state == DESTROYING) {
+      count++;
+    }
+  }
+
+  return count;
+}
+
+
+double MesosContainerizerProcess::_rootfs_reclaims_pending()
+{
+  return reclaiming.size();
+}
+
+
+vector<vector<size_t>> MesosContainerizerProcess::stages(
+    const vector<string>& names,
+    size_t size)
+{
+  vector<vector<size_t>> stages;
+
+  // Without the names of the isolators, we cannot tell their
+  // dependencies, hence we prepare them one at a time.
+  if (names.empty()) {
+    for (size_t index = 0; index < size; index++) {
+      stages.push_back({index});
+    }
+
+    return stages;
+  }
+
+  CHECK_EQ(size, names.size());
+
+  // The prefixes of the names of the built-in isolators that only
+  // depend on the filesystem isolators being prepared.
+  const vector<string> prefixes = {
+    "appc/",
+    "cgroups/",
+    "disk/",
+    "docker/",
+    "gpu/",
+    "io/",
+    "linux/",
+    "namespaces/",
+    "network/",
+    "posix/",
+    "volume/",
+    "windows/",
+  };
+
+  vector<size_t> filesystem;
+  vector<size_t> others;
+  vector<size_t> remaining;
+
+  for (size_t index = 0; index < size; index++) {
+    const string& name = names[index];
+
+    if (strings::startsWith(name, "filesystem/")) {
+      filesystem.push_back(index);
+      continue;
+    }
+
+    bool builtin = false;
+    foreach (const string& prefix, prefixes) {
+      if (strings::startsWith(name, prefix)) {
+        builtin = true;
+        break;
+      }
+    }
+
+    if (builtin) {
+      others.push_back(index);
+    } else {
+      remaining.push_back(index);
+    }
+  }
+
+  if (!filesystem.empty()) {
+    stages.push_back(filesystem);
+  }
+
+  if (!others.empty()) {
+    stages.push_back(others);
+  }
+
+  foreach (size_t index, remaining) {
+    stages.push_back({index});
+  }
+
+  return stages;
+}
+
+
+MesosContainerizerProcess::Metrics::Metrics(
+    const MesosContainerizerProcess& containerizer,
+    const vector<string>& isolators)
   : container_destroy_errors(
-        "containerizer/mesos/container_destroy_errors")
+        "containerizer/mesos/container_destroy_errors"),
+    containers_destroying(
+        "containerizer/mesos/containers_destroying",
+        defer(containerizer,
+              &MesosContainerizerProcess::_containers_destroying)),
+    rootfs_reclaims_pending(
+        "containerizer/mesos/rootfs_reclaims_pending",
+        defer(containerizer,
+              &MesosContainerizerProcess::_rootfs_reclaims_pending)),
+    rootfs_reclaim_errors(
+        "containerizer/mesos/rootfs_reclaim_errors"),
+    launch_provisioning(
+        "containerizer/mesos/launch/provisioning", Hours(1)),
+    launch_preparing(
+        "containerizer/mesos/launch/preparing", Hours(1)),
+    launch_forking(
+        "containerizer/mesos/launch/forking", Hours(1)),
+    launch_isolating(
+        "containerizer/mesos/launch/isolating", Hours(1)),
+    launch_fetching(
+        "containerizer/mesos/launch/fetching", Hours(1)),
+    destroy_killing(
+        "containerizer/mesos/destroy/killing", Hours(1)),
+    destroy_cleaning(
+        "containerizer/mesos/destroy/cleaning", Hours(1))
 {
   process::metrics::add(container_destroy_errors);
+  process::metrics::add(containers_destroying);
+  process::metrics::add(rootfs_reclaims_pending);
+  process::metrics::add(rootfs_reclaim_errors);
+  process::metrics::add(launch_provisioning);
+  process::metrics::add(launch_preparing);
+  process::metrics::add(launch_forking);
+  process::metrics::add(launch_isolating);
+  process::metrics::add(launch_fetching);
+  process::metrics::add(destroy_killing);
+  process::metrics::add(destroy_cleaning);
+
+  foreach (const string& isolator, isolators) {
+    isolator_prepare.push_back(process::metrics::Timer<Milliseconds>(
+        "containerizer/mesos/isolators/" + isolator + "/prepare",
+        Hours(1)));
+
+    isolator_isolate.push_back(process::metrics::Timer<Milliseconds>(
+        "containerizer/mesos/isolators/" + isolator + "/isolate",
+        Hours(1)));
+
+    process::metrics::add(isolator_prepare.back());
+    process::metrics::add(isolator_isolate.back());
+  }
 }
 
 
 MesosContainerizerProcess::Metrics::~Metrics()
 {
   process::metrics::remove(container_destroy_errors);
+  process::metrics::remove(containers_destroying);
+  process::metrics::remove(rootfs_reclaims_pending);
+  process::metrics::remove(rootfs_reclaim_errors);
+  process::metrics::remove(launch_provisioning);
+  process::metrics::remove(launch_preparing);
+  process::metrics::remove(launch_forking);
+  process::metrics::remove(launch_isolating);
+  process::metrics::remove(launch_fetching);
+  process::metrics::remove(destroy_killing);
+  process::metrics::remove(destroy_cleaning);
+
+  foreach (const process::metrics::Timer<Milliseconds>& timer,
+           isolator_prepare) {
+    process::metrics::remove(timer);
+  }
+
+  foreach (const process::metrics::Timer<Milliseconds>& timer,
+           isolator_isolate) {
+    process::metrics::remove(timer);
+  }
 }
 
 
@@ -2539,28 +2808,37 @@ Future<list<Future<Nothing>>> MesosContainerizerProcess::cleanupIsolators(
 {
   Future<list<Future<Nothing>>> f = list<Future<Nothing>>();
 
-  // NOTE: We clean up each isolator in the reverse order they were
-  // prepared (see comment in prepare()).
-  foreach (const Owned<Isolator>& isolator, adaptor::reverse(isolators)) {
-    // If this is a nested container, we need to skip isolators that
-    // do not support nesting.
-    if (containerId.has_parent() && !isolator->supportsNesting()) {
-      continue;
-    }
-
-    // We'll try to clean up all isolators, waiting for each to
+  // NOTE: We clean up the stages of isolators in the reverse order
+  // they were prepared (see comment in prepare()), and the isolators
+  // of a stage concurrently.
+  foreach (const vector<size_t>& stage, adaptor::reverse(prepareStages)) {
+    // We'll try to clean up all isolators, waiting for each stage to
     // complete and continuing if one fails.
     // TODO(jieyu): Technically, we cannot bind 'isolator' here
     // because the ownership will be transferred after the bind.
     f = f.then([=](list<Future<Nothing>> cleanups) {
-      // Accumulate but do not propagate any failure.
-      Future<Nothing> cleanup = isolator->cleanup(containerId);
-      cleanups.push_back(cleanup);
+      list<Future<Nothing>> stageCleanups;
+
+      foreach (size_t index, stage) {
+        const Owned<Isolator>& isolator = isolators[index];
+
+        // If this is a nested container, we need to skip isolators
+        // that do not support nesting.
+        if (containerId.has_parent() && !isolator->supportsNesting()) {
+          continue;
+        }
+
+        // Accumulate but do not propagate any failure.
+        stageCleanups.push_back(isolator->cleanup(containerId));
+      }
+
+      cleanups.insert(
+          cleanups.end(), stageCleanups.begin(), stageCleanups.end());
 
-      // Wait for the cleanup to complete/fail before returning the
+      // Wait for the cleanups to complete/fail before returning the
       // list. We use await here to asynchronously wait for the
-      // isolator to complete then return cleanups.
-      return await(list<Future<Nothing>>({cleanup}))
+      // isolators to complete then return cleanups.
+      return await(stageCleanups)
         .then([cleanups]() -> Future<list<Future<Nothing>>> {
           return cleanups;
         });
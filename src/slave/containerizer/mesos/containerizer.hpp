@@ -18,6 +18,7 @@
 #define __MESOS_CONTAINERIZER_HPP__
 
 #include <list>
+#include <string>
 #include <vector>
 
 #include <process/id.hpp>
@@ -26,6 +27,8 @@
 #include <process/shared.hpp>
 
 #include <process/metrics/counter.hpp>
+#include <process/metrics/gauge.hpp>
+#include <process/metrics/timer.hpp>
 
 #include <stout/hashmap.hpp>
 #include <stout/multihashmap.hpp>
@@ -67,7 +70,9 @@ public:
       Fetcher* fetcher,
       const process::Owned<Launcher>& launcher,
       const process::Shared<Provisioner>& provisioner,
-      const std::vector<process::Owned<mesos::slave::Isolator>>& isolators);
+      const std::vector<process::Owned<mesos::slave::Isolator>>& isolators,
+      const std::vector<std::string>& isolatorNames =
+        std::vector<std::string>());
 
   virtual ~MesosContainerizer();
 
@@ -131,14 +136,18 @@ public:
       IOSwitchboard* _ioSwitchboard,
       const process::Owned<Launcher>& _launcher,
       const process::Shared<Provisioner>& _provisioner,
-      const std::vector<process::Owned<mesos::slave::Isolator>>& _isolators)
+      const std::vector<process::Owned<mesos::slave::Isolator>>& _isolators,
+      const std::vector<std::string>& _isolatorNames =
+        std::vector<std::string>())
     : ProcessBase(process::ID::generate("mesos-containerizer")),
       flags(_flags),
       fetcher(_fetcher),
       ioSwitchboard(_ioSwitchboard),
       launcher(_launcher),
       provisioner(_provisioner),
-      isolators(_isolators) {}
+      isolators(_isolators),
+      prepareStages(stages(_isolatorNames, _isolators.size())),
+      metrics(*this, _isolatorNames) {}
 
   virtual ~MesosContainerizerProcess() {}
 
@@ -266,8 +275,13 @@ private:
       const ContainerID& containerId,
       const process::Future<std::list<process::Future<Nothing>>>& cleanups);
 
-  // Continues '_____destroy()' once provisioner have completed destroy.
-  void ______destroy(
+  // Continues '_____destroy()' once the provisioner has started to
+  // reclaim the rootfs of the container.
+  void ______destroy(const ContainerID& containerId);
+
+  // Invoked once the provisioner has reclaimed the rootfs of the
+  // container, see `_____destroy()`.
+  void reclaimed(
       const ContainerID& containerId,
       const process::Future<bool>& destroy);
 
@@ -298,6 +312,18 @@ private:
   const process::Shared<Provisioner> provisioner;
   const std::vector<process::Owned<mesos::slave::Isolator>> isolators;
 
+  // Groups the isolators (by their index in 'isolators') into the
+  // stages in which they are prepared, see `prepare()`. Only the
+  // isolators with a known name can be prepared concurrently: the
+  // filesystem isolators are prepared first, then the other built-in
+  // isolators concurrently, and then each of the remaining isolators
+  // (e.g., isolator modules) on its own, in order.
+  static std::vector<std::vector<size_t>> stages(
+      const std::vector<std::string>& names,
+      size_t size);
+
+  const std::vector<std::vector<size_t>> prepareStages;
+
   struct Container
   {
     Container() : sequence("mesos-container-status-updates") {}
@@ -365,12 +391,51 @@ private:
 
   hashmap<ContainerID, process::Owned<Container>> containers_;
 
+  // The destroyed containers whose rootfs is still being removed by
+  // the provisioner.
+  hashmap<ContainerID, process::Future<bool>> reclaiming;
+
+  double _containers_destroying();
+  double _rootfs_reclaims_pending();
+
   struct Metrics
   {
-    Metrics();
+    // The isolators are timed if their names are known.
+    Metrics(
+        const MesosContainerizerProcess& containerizer,
+        const std::vector<std::string>& isolators);
+
     ~Metrics();
 
     process::metrics::Counter container_destroy_errors;
+
+    // The backlog of the destroys: the containers being destroyed and
+    // the rootfses of the destroyed containers still being removed.
+    process::metrics::Gauge containers_destroying;
+    process::metrics::Gauge rootfs_reclaims_pending;
+    process::metrics::Counter rootfs_reclaim_errors;
+
+    // The durations of the phases of the launch of a container: the
+    // provisioning of its image, the preparation of the isolators,
+    // the forking of the `mesos-containerizer launch` helper, the
+    // isolation of the forked process and the fetching of its URIs.
+    process::metrics::Timer<Milliseconds> launch_provisioning;
+    process::metrics::Timer<Milliseconds> launch_preparing;
+    process::metrics::Timer<Milliseconds> launch_forking;
+    process::metrics::Timer<Milliseconds> launch_isolating;
+    process::metrics::Timer<Milliseconds> launch_fetching;
+
+    // The durations of the phases of the destroy of a container: the
+    // killing of its processes by the launcher (which removes its
+    // cgroups with the Linux launcher) and the cleanup of the
+    // isolators.
+    process::metrics::Timer<Milliseconds> destroy_killing;
+    process::metrics::Timer<Milliseconds> destroy_cleaning;
+
+    // The durations of the `prepare` and `isolate` calls of each
+    // isolator, by the index of the isolator.
+    std::vector<process::metrics::Timer<Milliseconds>> isolator_prepare;
+    std::vector<process::metrics::Timer<Milliseconds>> isolator_isolate;
   } metrics;
 };
 
@@ -0,0 +1,582 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include <algorithm>
+#include <iostream>
+#include <list>
+
+#include <glog/logging.h>
+
+#include <stout/foreach.hpp>
+#include <stout/lambda.hpp>
+#include <stout/numify.hpp>
+#include <stout/os.hpp>
+#include <stout/path.hpp>
+#include <stout/protobuf.hpp>
+
+#include "linux/ns.hpp"
+
+#include "slave/containerizer/mesos/constants.hpp"
+#include "slave/containerizer/mesos/fork_server.hpp"
+#include "slave/containerizer/mesos/fork_server.pb.h"
+
+using std::cerr;
+using std::endl;
+using std::list;
+using std::map;
+using std::string;
+using std::vector;
+
+using process::Owned;
+using process::Subprocess;
+
+namespace mesos {
+namespace internal {
+namespace slave {
+
+const string MesosContainerizerForkServer::NAME = "fork-server";
+
+
+// The maximum number of file descriptors that can be passed with a
+// single message (SCM_MAX_FD).
+constexpr size_t MAX_FDS = 253;
+
+
+// The maximum size of a response of the fork server.
+constexpr size_t MAX_RESPONSE_SIZE = 64 * 1024;
+
+
+// Helpers to read and write the whole buffer. These are used by the
+// child of the agent, so they need to be async signal safe.
+static bool readAll(int fd, char* data, size_t size)
+{
+  while (size > 0) {
+    ssize_t length = ::read(fd, data, size);
+    if (length < 0 && errno == EINTR) {
+      continue;
+    } else if (length <= 0) {
+      return false;
+    }
+
+    data += length;
+    size -= length;
+  }
+
+  return true;
+}
+
+
+static bool writeAll(int fd, const char* data, size_t size)
+{
+  while (size > 0) {
+    ssize_t length = ::send(fd, data, size, MSG_NOSIGNAL);
+    if (length < 0 && errno == EINTR) {
+      continue;
+    } else if (length < 0) {
+      return false;
+    }
+
+    data += length;
+    size -= length;
+  }
+
+  return true;
+}
+
+
+// Forks the requested process, assigning the passed file descriptors
+// to the requested file descriptor numbers in the process.
+static Try<pid_t> forkProcess(
+    const ForkRequest& request,
+    const vector<int>& fds)
+{
+  // NOTE: We construct these ahead of time, as the fork server is
+  // where we do all the allocations.
+  vector<char*> argv;
+  foreach (const string& arg, request.argv()) {
+    argv.push_back(const_cast<char*>(arg.c_str()));
+  }
+  argv.push_back(nullptr);
+
+  vector<char*> envp;
+  foreach (const string& entry, request.envp()) {
+    envp.push_back(const_cast<char*>(entry.c_str()));
+  }
+  envp.push_back(nullptr);
+
+  // The passed file descriptors are first moved above all the file
+  // descriptor numbers they are assigned to, so that assigning one
+  // does not clobber another one that is yet to be assigned.
+  int minimum = 0;
+  foreach (int fd, request.fds()) {
+    minimum = std::max(minimum, fd + 1);
+  }
+
+  vector<int> temporaries(fds.size(), -1);
+
+  lambda::function<int()> child = [&]() -> int {
+    for (size_t i = 0; i < fds.size(); i++) {
+      temporaries[i] = ::fcntl(fds[i], F_DUPFD_CLOEXEC, minimum);
+      if (temporaries[i] < 0) {
+        ::_exit(EXIT_FAILURE);
+      }
+    }
+
+    for (size_t i = 0; i < fds.size(); i++) {
+      while (::dup2(temporaries[i], request.fds(i)) == -1 && errno == EINTR);
+    }
+
+    // Restore the signal mask of the fork server, see `execute()`.
+    sigset_t mask;
+    ::sigemptyset(&mask);
+    ::sigaddset(&mask, SIGCHLD);
+    ::sigprocmask(SIG_UNBLOCK, &mask, nullptr);
+
+    // Put the process into its own session, like the Linux launcher
+    // does when forking the agent.
+    ::setsid();
+
+    ::execve(request.path().c_str(), argv.data(), envp.data());
+
+    ::_exit(EXIT_FAILURE);
+  };
+
+  int flags = request.clone_namespaces() | SIGCHLD;
+
+  if (request.has_target()) {
+    return ns::clone(
+        request.target(),
+        request.enter_namespaces(),
+        child,
+        flags);
+  }
+
+  pid_t pid = os::clone(child, flags);
+  if (pid < 0) {
+    return ErrnoError("Failed to clone");
+  }
+
+  return pid;
+}
+
+
+int MesosContainerizerForkServer::execute()
+{
+  if (flags.help) {
+    cerr << flags.usage();
+    return EXIT_SUCCESS;
+  }
+
+  // The agent's end of the socket is our stdin, which we need to keep
+  // from the processes we fork.
+  const int socket = STDIN_FILENO;
+
+  Try<Nothing> cloexec = os::cloexec(socket);
+  if (cloexec.isError()) {
+    cerr << "Failed to set close-on-exec on the socket: "
+         << cloexec.error() << endl;
+    return EXIT_FAILURE;
+  }
+
+  // We reap the processes we fork (those that are not forked in the
+  // namespaces of another process are our children) as soon as they
+  // exit, using a signalfd for SIGCHLD.
+  sigset_t mask;
+  ::sigemptyset(&mask);
+  ::sigaddset(&mask, SIGCHLD);
+
+  if (::sigprocmask(SIG_BLOCK, &mask, nullptr) != 0) {
+    cerr << "Failed to block SIGCHLD: " << os::strerror(errno) << endl;
+    return EXIT_FAILURE;
+  }
+
+  int signals = ::signalfd(-1, &mask, SFD_CLOEXEC);
+  if (signals < 0) {
+    cerr << "Failed to create signalfd: " << os::strerror(errno) << endl;
+    return EXIT_FAILURE;
+  }
+
+  while (true) {
+    pollfd fds[2] = {{socket, POLLIN, 0}, {signals, POLLIN, 0}};
+
+    if (::poll(fds, 2, -1) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+
+      cerr << "Failed to poll: " << os::strerror(errno) << endl;
+      return EXIT_FAILURE;
+    }
+
+    if (fds[1].revents & POLLIN) {
+      signalfd_siginfo info;
+      while (::read(signals, &info, sizeof(info)) < 0 && errno == EINTR);
+
+      while (::waitpid(-1, nullptr, WNOHANG) > 0);
+    }
+
+    if (fds[0].revents == 0) {
+      continue;
+    }
+
+    // Each request is preceded by a single byte that carries the file
+    // descriptors for the process.
+    char base[1];
+
+    iovec iov = {0};
+    iov.iov_base = base;
+    iov.iov_len = sizeof(base);
+
+    union {
+      struct cmsghdr cmessage;
+      char control[CMSG_SPACE(sizeof(int) * MAX_FDS)];
+    };
+
+    msghdr message = {0};
+    message.msg_iov = &iov;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+
+    ssize_t length = ::recvmsg(socket, &message, MSG_CMSG_CLOEXEC);
+    if (length < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+
+      cerr << "Failed to receive: " << os::strerror(errno) << endl;
+      return EXIT_FAILURE;
+    } else if (length == 0) {
+      // The agent has closed its end of the socket.
+      return EXIT_SUCCESS;
+    }
+
+    vector<int> passed;
+
+    for (cmsghdr* header = CMSG_FIRSTHDR(&message);
+         header != nullptr;
+         header = CMSG_NXTHDR(&message, header)) {
+      if (header->cmsg_level == SOL_SOCKET &&
+          header->cmsg_type == SCM_RIGHTS) {
+        const int* data = reinterpret_cast<const int*>(CMSG_DATA(header));
+        size_t count = (header->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        passed.insert(passed.end(), data, data + count);
+      }
+    }
+
+    Result<ForkRequest> request = ::protobuf::read<ForkRequest>(socket);
+
+    if (!request.isSome()) {
+      cerr << "Failed to read the request: "
+           << (request.isError() ? request.error() : "EOF") << endl;
+      return EXIT_FAILURE;
+    }
+
+    ForkResponse response;
+
+    if (message.msg_flags & MSG_CTRUNC) {
+      response.set_error("Too many file descriptors");
+    } else if (passed.size() != (size_t) request->fds_size()) {
+      response.set_error(
+          "Expected " + stringify(request->fds_size()) +
+          " file descriptors but received " + stringify(passed.size()));
+    } else {
+      Try<pid_t> pid = forkProcess(request.get(), passed);
+      if (pid.isError()) {
+        response.set_error(pid.error());
+      } else {
+        response.set_pid(pid.get());
+      }
+    }
+
+    foreach (int fd, passed) {
+      ::close(fd);
+    }
+
+    Try<Nothing> write = ::protobuf::write(socket, response);
+    if (write.isError()) {
+      cerr << "Failed to write the response: " << write.error() << endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  UNREACHABLE();
+}
+
+
+Try<Owned<ForkServer>> ForkServer::create(const string& launcherDir)
+{
+  int sockets[2];
+  if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sockets) != 0) {
+    return ErrnoError("Failed to create socket pair");
+  }
+
+  // The fork server's end of the socket becomes its stdin.
+  Try<Subprocess> server = process::subprocess(
+      path::join(launcherDir, MESOS_CONTAINERIZER),
+      {MESOS_CONTAINERIZER, MesosContainerizerForkServer::NAME},
+      Subprocess::FD(sockets[1], Subprocess::IO::OWNED),
+      Subprocess::FD(STDOUT_FILENO),
+      Subprocess::FD(STDERR_FILENO));
+
+  if (server.isError()) {
+    os::close(sockets[0]);
+    return Error("Failed to spawn the fork server: " + server.error());
+  }
+
+  LOG(INFO) << "Spawned the fork server with pid " << server->pid();
+
+  return Owned<ForkServer>(new ForkServer(server->pid(), sockets[0]));
+}
+
+
+ForkServer::ForkServer(pid_t _pid, int _socket)
+  : pid(_pid), socket(_socket) {}
+
+
+ForkServer::~ForkServer()
+{
+  // The fork server exits once we close our end of the socket.
+  VLOG(1) << "Stopping the fork server with pid " << pid;
+
+  os::close(socket);
+}
+
+
+Try<pid_t> ForkServer::fork(
+    const string& path,
+    const vector<string>& argv,
+    const Subprocess::IO& in,
+    const Subprocess::IO& out,
+    const Subprocess::IO& err,
+    const flags::FlagsBase* flags,
+    const Option<map<string, string>>& environment,
+    const Option<pid_t>& target,
+    int enterNamespaces,
+    int cloneNamespaces)
+{
+  ForkRequest request;
+  request.set_path(path);
+
+  foreach (const string& arg, argv) {
+    request.add_argv(arg);
+  }
+
+  // Stringify the flags like `subprocess` does.
+  if (flags != nullptr) {
+    foreachvalue (const flags::Flag& flag, *flags) {
+      Option<string> value = flag.stringify(*flags);
+      if (value.isSome()) {
+        request.add_argv(
+            "--" + flag.effective_name().value + "=" + value.get());
+      }
+    }
+  }
+
+  const map<string, string> envp =
+    environment.isSome() ? environment.get() : os::environment();
+
+  foreachpair (const string& key, const string& value, envp) {
+    request.add_envp(key + "=" + value);
+  }
+
+  // Besides its stdin, stdout and stderr, the process inherits the
+  // file descriptors of the agent that are not close-on-exec (e.g.,
+  // the pipe that the containerizer uses to synchronize with the
+  // launch helper), which the child of the agent passes along.
+  vector<int> fds = {STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO};
+
+  Try<list<string>> entries = os::ls("/proc/self/fd");
+  if (entries.isError()) {
+    return Error("Failed to list the file descriptors: " + entries.error());
+  }
+
+  foreach (const string& entry, entries.get()) {
+    Try<int> fd = numify<int>(entry);
+    if (fd.isError() || fd.get() <= STDERR_FILENO) {
+      continue;
+    }
+
+    int descriptorFlags = ::fcntl(fd.get(), F_GETFD);
+    if (descriptorFlags != -1 && !(descriptorFlags & FD_CLOEXEC)) {
+      fds.push_back(fd.get());
+    }
+  }
+
+  if (fds.size() > MAX_FDS) {
+    return Error("Too many file descriptors to pass to the fork server");
+  }
+
+  foreach (int fd, fds) {
+    request.add_fds(fd);
+  }
+
+  if (target.isSome()) {
+    request.set_target(target.get());
+    request.set_enter_namespaces(enterNamespaces);
+  }
+
+  request.set_clone_namespaces(cloneNamespaces);
+
+  // NOTE: Everything the child of the agent uses is prepared ahead of
+  // time, since it may not allocate memory (it shares the address
+  // space of the agent). The request is framed like `protobuf::write`
+  // does, so that the fork server can use `protobuf::read`.
+  const uint32_t size = request.ByteSize();
+
+  const string data =
+    string(reinterpret_cast<const char*>(&size), sizeof(size)) +
+    request.SerializeAsString();
+
+  char base[1] = {0};
+
+  iovec iov = {0};
+  iov.iov_base = base;
+  iov.iov_len = sizeof(base);
+
+  union {
+    struct cmsghdr cmessage;
+    char control[CMSG_SPACE(sizeof(int) * MAX_FDS)];
+  };
+
+  msghdr message = {0};
+  message.msg_iov = &iov;
+  message.msg_iovlen = 1;
+  message.msg_control = control;
+  message.msg_controllen = CMSG_SPACE(sizeof(int) * fds.size());
+
+  cmessage.cmsg_len = CMSG_LEN(sizeof(int) * fds.size());
+  cmessage.cmsg_level = SOL_SOCKET;
+  cmessage.cmsg_type = SCM_RIGHTS;
+
+  std::copy(
+      fds.begin(),
+      fds.end(),
+      reinterpret_cast<int*>(CMSG_DATA(&cmessage)));
+
+  vector<char> buffer(MAX_RESPONSE_SIZE);
+  ssize_t received = -1;
+
+  // Runs in the child of the agent, once its I/O has been set up.
+  Subprocess::ChildHook forward = Subprocess::ChildHook::CALL([&]() {
+    uint32_t length;
+
+    if (::sendmsg(socket, &message, MSG_NOSIGNAL) == 1 &&
+        writeAll(socket, data.data(), data.size()) &&
+        readAll(socket, reinterpret_cast<char*>(&length), sizeof(length)) &&
+        length <= buffer.size() &&
+        readAll(socket, buffer.data(), length)) {
+      received = length;
+    }
+
+    // NOTE: We exit rather than returning an error, since the child
+    // must not abort (it shares the address space of the agent).
+    ::_exit(received < 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+
+    return Try<Nothing>(Nothing());
+  });
+
+  Option<string> error;
+
+  // Clones the child of the agent, which exits once the fork server
+  // has responded, and returns the pid of the process that the fork
+  // server forked.
+  lambda::function<pid_t(const lambda::function<int()>&)> clone =
+    [&](const lambda::function<int()>& child) -> pid_t {
+      Try<os::Stack> stack = os::Stack::create(os::Stack::DEFAULT_SIZE);
+      if (stack.isError()) {
+        error = "Failed to allocate stack: " + stack.error();
+        return -1;
+      }
+
+      // Block all signals while the child runs, so that no signal
+      // handler of the agent runs in the child (like posix_spawn).
+      sigset_t all;
+      sigset_t mask;
+      ::sigfillset(&all);
+      ::pthread_sigmask(SIG_SETMASK, &all, &mask);
+
+      pid_t pid =
+        os::clone(child, CLONE_VM | CLONE_VFORK | SIGCHLD, stack.get());
+
+      ::pthread_sigmask(SIG_SETMASK, &mask, nullptr);
+
+      if (pid < 0) {
+        stack->deallocate();
+        return -1;
+      }
+
+      // With CLONE_VFORK the child has exited by now.
+      while (::waitpid(pid, nullptr, 0) == -1 && errno == EINTR);
+
+      stack->deallocate();
+
+      if (received < 0) {
+        error = "Failed to communicate with the fork server";
+        return -1;
+      }
+
+      ForkResponse response;
+      if (!response.ParseFromArray(buffer.data(), received)) {
+        error = "Failed to parse the response of the fork server";
+        return -1;
+      }
+
+      if (!response.has_pid()) {
+        error = response.has_error() ? response.error() : "Unknown error";
+        return -1;
+      }
+
+      return response.pid();
+    };
+
+  // NOTE: The arguments and the environment passed to `subprocess`
+  // are not used since the child of the agent does not exec.
+  Try<Subprocess> child = process::subprocess(
+      path,
+      argv,
+      in,
+      out,
+      err,
+      nullptr,
+      environment,
+      clone,
+      {},
+      {forward});
+
+  if (child.isError()) {
+    return Error(error.isSome() ? error.get() : child.error());
+  }
+
+  return child->pid();
+}
+
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
@@ -0,0 +1,116 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __MESOS_CONTAINERIZER_FORK_SERVER_HPP__
+#define __MESOS_CONTAINERIZER_FORK_SERVER_HPP__
+
+#include <sys/types.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <process/owned.hpp>
+#include <process/subprocess.hpp>
+
+#include <stout/flags.hpp>
+#include <stout/option.hpp>
+#include <stout/subcommand.hpp>
+#include <stout/try.hpp>
+
+namespace mesos {
+namespace internal {
+namespace slave {
+
+// The "fork-server" subcommand is a long-lived helper of the agent
+// that forks (and execs) processes on the agent's behalf, see
+// `ForkServer` below. It exits once the agent closes its end of the
+// socket (e.g., because the agent exited).
+class MesosContainerizerForkServer : public Subcommand
+{
+public:
+  static const std::string NAME;
+
+  struct Flags : public virtual flags::FlagsBase
+  {
+    Flags();
+
+    Option<int> socket;
+  };
+
+  MesosContainerizerForkServer() : Subcommand(NAME) {}
+
+  Flags flags;
+
+protected:
+  virtual int execute();
+  virtual flags::FlagsBase* getFlags() { return &flags; }
+};
+
+
+// Forks processes through a fork server rather than forking the
+// agent itself. Forking the agent copies the page tables of its
+// (large) address space, which makes forking the agent much more
+// expensive than forking the (small) fork server.
+//
+// The I/O of the process is set up by a short-lived child of the
+// agent that shares the address space of the agent (i.e., is cloned
+// with CLONE_VM | CLONE_VFORK, so that no page tables are copied),
+// which then passes its stdin, stdout and stderr, along with the
+// other file descriptors the process would have inherited from the
+// agent, to the fork server.
+//
+// NOTE: Unlike `subprocess`, the parent hooks (if any) need to be run
+// once the process has been forked, since the process is not blocked
+// until they have run.
+class ForkServer
+{
+public:
+  // Spawns the fork server, using the `mesos-containerizer` binary in
+  // the given directory.
+  static Try<process::Owned<ForkServer>> create(const std::string& launcherDir);
+
+  ~ForkServer();
+
+  // Forks the process, in the namespaces of 'target' if set. Returns
+  // the pid of the process.
+  Try<pid_t> fork(
+      const std::string& path,
+      const std::vector<std::string>& argv,
+      const process::Subprocess::IO& in,
+      const process::Subprocess::IO& out,
+      const process::Subprocess::IO& err,
+      const flags::FlagsBase* flags,
+      const Option<std::map<std::string, std::string>>& environment,
+      const Option<pid_t>& target,
+      int enterNamespaces,
+      int cloneNamespaces);
+
+private:
+  ForkServer(pid_t pid, int socket);
+
+  ForkServer(const ForkServer&) = delete;
+  ForkServer& operator=(const ForkServer&) = delete;
+
+  const pid_t pid;
+  const int socket;
+};
+
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __MESOS_CONTAINERIZER_FORK_SERVER_HPP__
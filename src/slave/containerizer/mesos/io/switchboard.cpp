@@ -17,15 +17,24 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#ifdef __linux__
+#include <fcntl.h>
+
+#include <sys/stat.h>
+#endif // __linux__
+
 #include <list>
 #include <map>
 #include <string>
 #include <vector>
 
+#include <boost/shared_array.hpp>
+
 #include <process/address.hpp>
 #include <process/clock.hpp>
 #include <process/collect.hpp>
 #include <process/defer.hpp>
+#include <process/delay.hpp>
 #include <process/dispatch.hpp>
 #include <process/future.hpp>
 #include <process/http.hpp>
@@ -38,6 +47,7 @@
 #include <process/shared.hpp>
 #include <process/socket.hpp>
 #include <process/subprocess.hpp>
+#include <process/timer.hpp>
 
 #include <stout/hashmap.hpp>
 #include <stout/option.hpp>
@@ -61,6 +71,7 @@
 #include "common/recordio.hpp"
 #include "common/status_utils.hpp"
 
+#include "slave/constants.hpp"
 #include "slave/flags.hpp"
 #include "slave/state.hpp"
 
@@ -95,6 +106,7 @@ using process::Promise;
 using process::RateLimiter;
 using process::Shared;
 using process::Subprocess;
+using process::Timer;
 
 using process::network::internal::SocketImpl;
 
@@ -973,12 +985,51 @@ private:
       ContentType acceptType,
       Option<ContentType> messageAcceptType);
 
+  // Redirects the output of the container read from `from` to `to`,
+  // and to the attached output connections (if any). Returns once
+  // EOF has been read from `from`.
+  Future<Nothing> redirect(
+      int from,
+      int to,
+      const agent::ProcessIO::Data::Type& type);
+
+  // Moves the output of the container from `from` to `to` without
+  // copying it through user space. Only used while no output
+  // connections are attached, since their `ProcessIO` messages
+  // need to be encoded in user space. Returns `false` on EOF.
+  Future<bool> splice(
+      int from,
+      int to,
+      const agent::ProcessIO::Data::Type& type);
+
   // Asynchronously receive data as we read it from our
-  // `stdoutFromFd` and `stdoutFromFd` file descriptors.
+  // `stdoutFromFd` and `stdoutFromFd` file descriptors. The data is
+  // batched into larger `ProcessIO` messages, which are sent once
+  // enough data has been batched or the batching latency passed.
   void outputHook(
       const string& data,
       const agent::ProcessIO::Data::Type& type);
 
+  // Sends the output batched for `type` to the output connections.
+  void flush(const agent::ProcessIO::Data::Type& type);
+
+  struct Output
+  {
+    Output() : splice(false), regular(false) {}
+
+    // Whether the output can be spliced, i.e., either end is a pipe
+    // and the kernel supports splicing from `from` to `to`.
+    bool splice;
+
+    // Whether `to` is a regular file, which cannot be polled (and
+    // never blocks on writes).
+    bool regular;
+
+    // The output that has not been sent to the output connections.
+    string batch;
+    Option<Timer> timer;
+  };
+
   bool tty;
   int stdinToFd;
   int stdoutFromFd;
@@ -995,6 +1046,7 @@ private:
   // The following must be a `std::list`
   // for proper erase semantics later on.
   list<HttpConnection> outputConnections;
+  map<agent::ProcessIO::Data::Type, Output> outputs;
   Option<Failure> failure;
 };
 
@@ -1120,14 +1172,10 @@ Future<Nothing> IOSwitchboardServerProcess::run()
 
   startRedirect.future()
     .then(defer(self(), [this]() {
-      Future<Nothing> stdoutRedirect = process::io::redirect(
+      Future<Nothing> stdoutRedirect = redirect(
           stdoutFromFd,
           stdoutToFd,
-          process::io::BUFFERED_READ_SIZE,
-          {defer(self(),
-                 &Self::outputHook,
-                 lambda::_1,
-                 agent::ProcessIO::Data::STDOUT)});
+          agent::ProcessIO::Data::STDOUT);
 
       // NOTE: We don't need to redirect stderr if TTY is enabled. If
       // TTY is enabled for the container, stdout and stderr for the
@@ -1138,14 +1186,10 @@ Future<Nothing> IOSwitchboardServerProcess::run()
       if (tty) {
         stderrRedirect = Nothing();
       } else {
-        stderrRedirect = process::io::redirect(
+        stderrRedirect = redirect(
             stderrFromFd,
             stderrToFd,
-            process::io::BUFFERED_READ_SIZE,
-            {defer(self(),
-                   &Self::outputHook,
-                   lambda::_1,
-                   agent::ProcessIO::Data::STDERR)});
+            agent::ProcessIO::Data::STDERR);
       }
 
       // Set the future once our IO redirects finish. On failure,
@@ -1226,6 +1270,10 @@ void IOSwitchboardServerProcess::finalize()
   // maintain a reference to the socket, which would cause a leak.
   accept.discard();
 
+  // Send any output that is still being batched.
+  flush(agent::ProcessIO::Data::STDOUT);
+  flush(agent::ProcessIO::Data::STDERR);
+
   foreach (HttpConnection& connection, outputConnections) {
     connection.close();
 
@@ -1705,6 +1753,133 @@ Future<http::Response> IOSwitchboardServerProcess::attachContainerOutput(
 }
 
 
+Future<Nothing> IOSwitchboardServerProcess::redirect(
+    int from,
+    int to,
+    const agent::ProcessIO::Data::Type& type)
+{
+  // Make the file descriptors non-blocking (no-op if already set).
+  Try<Nothing> nonblock = os::nonblock(from);
+  if (nonblock.isError()) {
+    return Failure("Failed to make 'from' non-blocking: " + nonblock.error());
+  }
+
+  nonblock = os::nonblock(to);
+  if (nonblock.isError()) {
+    return Failure("Failed to make 'to' non-blocking: " + nonblock.error());
+  }
+
+#ifdef __linux__
+  struct stat fromStat;
+  struct stat toStat;
+
+  if (::fstat(from, &fromStat) < 0) {
+    return ErrnoFailure("Failed to stat 'from'");
+  }
+
+  if (::fstat(to, &toStat) < 0) {
+    return ErrnoFailure("Failed to stat 'to'");
+  }
+
+  // NOTE: `splice` requires either end to be a pipe. Whether the
+  // kernel supports splicing from (e.g., a pseudo terminal) or to
+  // (e.g., a socket) the other end is only known once we try it.
+  outputs[type].splice =
+    S_ISFIFO(fromStat.st_mode) || S_ISFIFO(toStat.st_mode);
+
+  outputs[type].regular = S_ISREG(toStat.st_mode);
+#endif // __linux__
+
+  boost::shared_array<char> data(new char[process::io::BUFFERED_READ_SIZE]);
+
+  return loop(
+      self(),
+      [=]() -> Future<bool> {
+        if (outputConnections.empty() && outputs[type].splice) {
+          return splice(from, to, type);
+        }
+
+        return process::io::read(
+            from, data.get(), process::io::BUFFERED_READ_SIZE)
+          .then(defer(self(), [=](size_t length) -> Future<bool> {
+            if (length == 0) {
+              flush(type);
+              return false;
+            }
+
+            const string s(data.get(), length);
+
+            outputHook(s, type);
+
+            return process::io::write(to, s)
+              .then([]() { return true; });
+          }));
+      },
+      [](bool more) -> ControlFlow<Nothing> {
+        if (more) {
+          return Continue();
+        }
+
+        return Break();
+      });
+}
+
+
+Future<bool> IOSwitchboardServerProcess::splice(
+    int from,
+    int to,
+    const agent::ProcessIO::Data::Type& type)
+{
+#ifdef __linux__
+  // A regular file never blocks on writes (and cannot be polled).
+  Future<short> writable = outputs[type].regular
+    ? Future<short>(process::io::WRITE)
+    : process::io::poll(to, process::io::WRITE);
+
+  return writable
+    .then(defer(self(), [=]() {
+      return process::io::poll(from, process::io::READ);
+    }))
+    .then(defer(self(), [=]() -> Future<bool> {
+      // NOTE: We move at most a (default) pipe buffer's worth of data
+      // at a time so that we check for newly attached output
+      // connections frequently.
+      ssize_t length = ::splice(
+          from,
+          nullptr,
+          to,
+          nullptr,
+          Kilobytes(64).bytes(),
+          SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+
+      if (length < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+          return true;
+        }
+
+        if (errno == EINVAL) {
+          // The kernel does not support splicing between these file
+          // descriptors, fall back to copying through user space.
+          outputs[type].splice = false;
+          return true;
+        }
+
+        return ErrnoFailure("Failed to splice");
+      }
+
+      if (length == 0) {
+        return false;
+      }
+
+      return true;
+    }));
+#else
+  outputs[type].splice = false;
+  return true;
+#endif // __linux__
+}
+
+
 void IOSwitchboardServerProcess::outputHook(
     const string& data,
     const agent::ProcessIO::Data::Type& type)
@@ -1714,11 +1889,48 @@ void IOSwitchboardServerProcess::outputHook(
     return;
   }
 
+  // To preserve the order in which the output of the streams was
+  // read, the output batched for the other stream is sent first.
+  flush(type == agent::ProcessIO::Data::STDOUT
+          ? agent::ProcessIO::Data::STDERR
+          : agent::ProcessIO::Data::STDOUT);
+
+  Output& output = outputs[type];
+  output.batch += data;
+
+  if (output.batch.size() >= IO_SWITCHBOARD_OUTPUT_BATCH_SIZE.bytes()) {
+    flush(type);
+  } else if (output.timer.isNone()) {
+    output.timer = process::delay(
+        IO_SWITCHBOARD_OUTPUT_BATCH_LATENCY,
+        self(),
+        &Self::flush,
+        type);
+  }
+}
+
+
+void IOSwitchboardServerProcess::flush(
+    const agent::ProcessIO::Data::Type& type)
+{
+  Output& output = outputs[type];
+
+  if (output.timer.isSome()) {
+    Clock::cancel(output.timer.get());
+    output.timer = None();
+  }
+
+  if (output.batch.empty()) {
+    return;
+  }
+
   // Build a `ProcessIO` message from the data.
   agent::ProcessIO message;
   message.set_type(agent::ProcessIO::DATA);
   message.mutable_data()->set_type(type);
-  message.mutable_data()->set_data(data);
+  message.mutable_data()->set_data(output.batch);
+
+  output.batch.clear();
 
   // Walk through our list of connections and write the message to
   // them. It's possible that a write might fail if the writer has
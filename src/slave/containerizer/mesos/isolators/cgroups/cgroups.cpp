@@ -31,8 +31,10 @@
 #include "common/protobuf_utils.hpp"
 
 #include "linux/cgroups.hpp"
+#include "linux/cgroups2.hpp"
 
 #include "slave/containerizer/mesos/isolators/cgroups/cgroups.hpp"
+#include "slave/containerizer/mesos/isolators/cgroups/cgroups2.hpp"
 #include "slave/containerizer/mesos/isolators/cgroups/constants.hpp"
 
 using mesos::slave::ContainerConfig;
@@ -69,6 +71,13 @@ CgroupsIsolatorProcess::~CgroupsIsolatorProcess() {}
 
 Try<Isolator*> CgroupsIsolatorProcess::create(const Flags& flags)
 {
+  // With the cgroups v2 unified hierarchy, all controllers are in a
+  // single hierarchy with different interface files.
+  Try<bool> unified = cgroups2::mounted(flags.cgroups_hierarchy);
+  if (unified.isSome() && unified.get()) {
+    return Cgroups2IsolatorProcess::create(flags);
+  }
+
   // Subsystem name -> hierarchy path.
   hashmap<string, string> hierarchies;
 
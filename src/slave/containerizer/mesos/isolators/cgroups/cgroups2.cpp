@@ -0,0 +1,745 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <list>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <process/defer.hpp>
+#include <process/delay.hpp>
+#include <process/id.hpp>
+#include <process/pid.hpp>
+
+#include <stout/error.hpp>
+#include <stout/foreach.hpp>
+#include <stout/os.hpp>
+#include <stout/path.hpp>
+#include <stout/stringify.hpp>
+#include <stout/strings.hpp>
+
+#include <stout/os/ls.hpp>
+#include <stout/os/stat.hpp>
+
+#include "common/protobuf_utils.hpp"
+
+#include "linux/cgroups.hpp"
+#include "linux/cgroups2.hpp"
+
+#include "slave/containerizer/mesos/isolators/cgroups/cgroups2.hpp"
+#include "slave/containerizer/mesos/isolators/cgroups/constants.hpp"
+
+using mesos::slave::ContainerConfig;
+using mesos::slave::ContainerLaunchInfo;
+using mesos::slave::ContainerLimitation;
+using mesos::slave::ContainerState;
+using mesos::slave::Isolator;
+
+using process::Failure;
+using process::Future;
+using process::Owned;
+using process::PID;
+
+using std::list;
+using std::set;
+using std::string;
+using std::vector;
+
+namespace mesos {
+namespace internal {
+namespace slave {
+
+Cgroups2IsolatorProcess::Cgroups2IsolatorProcess(
+    const Flags& _flags,
+    const string& _hierarchy,
+    const set<string>& _controllers)
+  : ProcessBase(process::ID::generate("cgroups2-isolator")),
+    flags(_flags),
+    hierarchy(_hierarchy),
+    controllers(_controllers) {}
+
+
+Cgroups2IsolatorProcess::~Cgroups2IsolatorProcess() {}
+
+
+Try<Isolator*> Cgroups2IsolatorProcess::create(const Flags& flags)
+{
+  // Isolator name -> controller name.
+  hashmap<string, string> isolatorMap = {
+    {"blkio", "io"},
+    {"cpu", "cpu"},
+    {"mem", "memory"},
+    {"pids", "pids"},
+  };
+
+  set<string> controllers;
+
+  foreach (string isolator, strings::tokenize(flags.isolation, ",")) {
+    if (!strings::startsWith(isolator, "cgroups/")) {
+      // Skip when the isolator is not related to cgroups.
+      continue;
+    }
+
+    isolator = strings::remove(isolator, "cgroups/", strings::Mode::PREFIX);
+
+    if (!isolatorMap.contains(isolator)) {
+      return Error(
+          "Unknown or unsupported isolator 'cgroups/" + isolator + "'"
+          " with the cgroups v2 unified hierarchy");
+    }
+
+    controllers.insert(isolatorMap.at(isolator));
+  }
+
+  const string& hierarchy = flags.cgroups_hierarchy;
+
+  Try<set<string>> available = cgroups2::controllers(hierarchy);
+  if (available.isError()) {
+    return Error(
+        "Failed to determine the available controllers: " +
+        available.error());
+  }
+
+  foreach (const string& controller, controllers) {
+    if (available->count(controller) == 0) {
+      return Error(
+          "The '" + controller + "' controller is not available in the "
+          "cgroups v2 unified hierarchy at '" + hierarchy + "'");
+    }
+  }
+
+  // Enable the controllers for the cgroups of the containers, which
+  // requires enabling them for each ancestor of the cgroups as well.
+  Try<Nothing> create =
+    cgroups2::create(hierarchy, flags.cgroups_root, true);
+
+  if (create.isError()) {
+    return Error(create.error());
+  }
+
+  string cgroup;
+  vector<string> tokens = strings::tokenize(flags.cgroups_root, "/");
+  for (size_t i = 0; i <= tokens.size(); i++) {
+    Try<Nothing> enable = cgroups2::enable(hierarchy, cgroup, controllers);
+    if (enable.isError()) {
+      return Error(
+          "Failed to enable the controllers " + stringify(controllers) +
+          " in cgroup '" + cgroup + "': " + enable.error());
+    }
+
+    if (i < tokens.size()) {
+      cgroup = path::join(cgroup, tokens[i]);
+    }
+  }
+
+  Owned<MesosIsolatorProcess> process(
+      new Cgroups2IsolatorProcess(flags, hierarchy, controllers));
+
+  return new MesosIsolator(process);
+}
+
+
+bool Cgroups2IsolatorProcess::supportsNesting()
+{
+  return true;
+}
+
+
+Future<Nothing> Cgroups2IsolatorProcess::recover(
+    const list<ContainerState>& states,
+    const hashset<ContainerID>& orphans)
+{
+  foreach (const ContainerState& state, states) {
+    // If we are a nested container, we do not need to recover
+    // anything since only top-level containers will have cgroups
+    // created for them.
+    if (state.container_id().has_parent()) {
+      continue;
+    }
+
+    const ContainerID& containerId = state.container_id();
+
+    if (!os::exists(path::join(hierarchy, cgroup(containerId)))) {
+      // This may occur if the executor has exited and the isolator
+      // has destroyed the cgroup but the agent dies before noticing
+      // this. This will be detected when the containerizer tries to
+      // monitor the executor's pid.
+      LOG(WARNING) << "Couldn't find the cgroup '" << cgroup(containerId)
+                   << "' for container " << containerId;
+
+      continue;
+    }
+
+    infos[containerId] =
+      Owned<Info>(new Info(containerId, cgroup(containerId)));
+
+    oom(containerId);
+  }
+
+  Try<list<string>> entries =
+    os::ls(path::join(hierarchy, flags.cgroups_root));
+
+  if (entries.isError()) {
+    return Failure(
+        "Failed to list cgroups under '" + flags.cgroups_root + "': " +
+        entries.error());
+  }
+
+  foreach (const string& entry, entries.get()) {
+    // Ignore the slave cgroup (see the --slave_subsystems flag).
+    if (entry == "slave" ||
+        !os::stat::isdir(path::join(hierarchy, flags.cgroups_root, entry))) {
+      continue;
+    }
+
+    ContainerID containerId;
+    containerId.set_value(entry);
+
+    // Skip containerId which already have been recovered.
+    if (infos.contains(containerId)) {
+      continue;
+    }
+
+    infos[containerId] =
+      Owned<Info>(new Info(containerId, cgroup(containerId)));
+
+    // Known orphan cgroups will be destroyed by the containerizer
+    // using the normal cleanup path. See MESOS-2367 for details.
+    if (!orphans.contains(containerId)) {
+      LOG(INFO) << "Cleaning up unknown orphaned container " << containerId;
+      cleanup(containerId);
+    }
+  }
+
+  return Nothing();
+}
+
+
+Future<Option<ContainerLaunchInfo>> Cgroups2IsolatorProcess::prepare(
+    const ContainerID& containerId,
+    const ContainerConfig& containerConfig)
+{
+  // If we are a nested container, we do not need to prepare
+  // anything since only top-level containers should have cgroups
+  // created for them.
+  if (containerId.has_parent()) {
+    return None();
+  }
+
+  if (infos.contains(containerId)) {
+    return Failure("Container has already been prepared");
+  }
+
+  const string path = path::join(hierarchy, cgroup(containerId));
+
+  if (os::exists(path)) {
+    return Failure("The cgroup at '" + path + "' already exists");
+  }
+
+  // We save 'Info' into 'infos' first so that even if 'prepare'
+  // fails, we can properly cleanup the *side effects* created below.
+  infos[containerId] =
+    Owned<Info>(new Info(containerId, cgroup(containerId)));
+
+  VLOG(1) << "Creating cgroup at '" << path << "' "
+          << "for container " << containerId;
+
+  Try<Nothing> create = cgroups2::create(hierarchy, cgroup(containerId));
+  if (create.isError()) {
+    return Failure(create.error());
+  }
+
+  if (controllers.count("memory") > 0) {
+    // Kill all processes of the container on an OOM rather than some
+    // of them, as the container is destroyed on an OOM anyway.
+    if (os::exists(path::join(path, "memory.oom.group"))) {
+      Try<Nothing> write = cgroups2::write(
+          hierarchy,
+          cgroup(containerId),
+          "memory.oom.group",
+          "1");
+
+      if (write.isError()) {
+        return Failure(write.error());
+      }
+    }
+
+    oom(containerId);
+  }
+
+  // TODO(haosdent): Here we assume the command executor's resources
+  // include the task's resources. Revisit here if this semantics
+  // changes.
+  return update(containerId, containerConfig.executor_info().resources())
+    .then([]() { return Option<ContainerLaunchInfo>::none(); });
+}
+
+
+Future<Nothing> Cgroups2IsolatorProcess::isolate(
+    const ContainerID& containerId,
+    pid_t pid)
+{
+  // If we are a nested container, we inherit
+  // the cgroup from our root ancestor.
+  ContainerID rootContainerId = protobuf::getRootContainerId(containerId);
+
+  if (!infos.contains(rootContainerId)) {
+    return Failure("Failed to isolate the container: Unknown root container");
+  }
+
+  Try<Nothing> assign = cgroups2::assign(
+      hierarchy,
+      infos[rootContainerId]->cgroup,
+      pid);
+
+  if (assign.isError()) {
+    string message =
+      "Failed to assign pid " + stringify(pid) + ": " + assign.error();
+
+    LOG(ERROR) << message;
+
+    return Failure(message);
+  }
+
+  return Nothing();
+}
+
+
+Future<ContainerLimitation> Cgroups2IsolatorProcess::watch(
+    const ContainerID& containerId)
+{
+  // Since we do not maintain cgroups for nested containers
+  // directly, we simply return a pending future here, indicating
+  // that the limit for the nested container will never be reached.
+  if (containerId.has_parent()) {
+    return Future<ContainerLimitation>();
+  }
+
+  if (!infos.contains(containerId)) {
+    return Failure("Unknown container");
+  }
+
+  return infos[containerId]->limitation.future();
+}
+
+
+Future<Nothing> Cgroups2IsolatorProcess::update(
+    const ContainerID& containerId,
+    const Resources& resources)
+{
+  if (containerId.has_parent()) {
+    return Failure("Not supported for nested containers");
+  }
+
+  if (!infos.contains(containerId)) {
+    return Failure("Unknown container");
+  }
+
+  const string& cgroup = infos[containerId]->cgroup;
+
+  if (controllers.count("cpu") > 0) {
+    if (resources.cpus().isNone()) {
+      return Failure("No cpus resource given");
+    }
+
+    double cpus = resources.cpus().get();
+
+    // The weight is proportional to the shares of cgroups v1, so that
+    // 1 cpu has the default weight of 100.
+    uint64_t shares;
+
+    if (flags.revocable_cpu_low_priority &&
+        resources.revocable().cpus().isSome()) {
+      shares = std::max(
+          (uint64_t) (CPU_SHARES_PER_CPU_REVOCABLE * cpus),
+          MIN_CPU_SHARES);
+    } else {
+      shares = std::max(
+          (uint64_t) (CPU_SHARES_PER_CPU * cpus),
+          MIN_CPU_SHARES);
+    }
+
+    uint64_t weight = std::min(
+        std::max(shares * 100 / CPU_SHARES_PER_CPU, cgroups2::cpu::MIN_WEIGHT),
+        cgroups2::cpu::MAX_WEIGHT);
+
+    Try<Nothing> write = cgroups2::cpu::weight(hierarchy, cgroup, weight);
+    if (write.isError()) {
+      return Failure("Failed to update 'cpu.weight': " + write.error());
+    }
+
+    LOG(INFO) << "Updated 'cpu.weight' to " << weight
+              << " (cpus " << cpus << ")"
+              << " for container " << containerId;
+
+    // Set the bandwidth limit if cfs is enabled.
+    if (flags.cgroups_enable_cfs) {
+      Duration quota = std::max(CPU_CFS_PERIOD * cpus, MIN_CPU_CFS_QUOTA);
+
+      write = cgroups2::cpu::max(hierarchy, cgroup, quota, CPU_CFS_PERIOD);
+      if (write.isError()) {
+        return Failure("Failed to update 'cpu.max': " + write.error());
+      }
+
+      LOG(INFO) << "Updated 'cpu.max' to " << quota << " per "
+                << CPU_CFS_PERIOD << " (cpus " << cpus << ")"
+                << " for container " << containerId;
+    }
+  }
+
+  if (controllers.count("memory") > 0) {
+    if (resources.mem().isNone()) {
+      return Failure("No memory resource given");
+    }
+
+    Bytes limit = std::max(resources.mem().get(), MIN_MEMORY);
+
+    // Always protect the memory of the container up to its limit,
+    // which is what the soft limit is used for with cgroups v1.
+    Try<Nothing> write = cgroups2::memory::low(hierarchy, cgroup, limit);
+    if (write.isError()) {
+      return Failure("Failed to update 'memory.low': " + write.error());
+    }
+
+    Try<Option<Bytes>> currentLimit =
+      cgroups2::memory::max(hierarchy, cgroup);
+
+    if (currentLimit.isError()) {
+      return Failure("Failed to read 'memory.max': " + currentLimit.error());
+    }
+
+    // As with cgroups v1, we only update the hard limit if this is the
+    // first time or when we're raising the existing limit, since
+    // decreasing it may induce an OOM if too much memory is in use.
+    if (currentLimit->isNone() || limit > currentLimit->get()) {
+      write = cgroups2::memory::max(hierarchy, cgroup, limit);
+      if (write.isError()) {
+        return Failure("Failed to update 'memory.max': " + write.error());
+      }
+
+      LOG(INFO) << "Updated 'memory.max' to " << limit
+                << " for container " << containerId;
+
+      // With cgroups v1, the limit of memory and swap is set to the
+      // limit of memory, which means no swap can be used.
+      if (flags.cgroups_limit_swap) {
+        write = cgroups2::memory::swap_max(hierarchy, cgroup, Bytes(0));
+        if (write.isError()) {
+          return Failure(
+              "Failed to update 'memory.swap.max': " + write.error());
+        }
+      }
+    }
+  }
+
+  return Nothing();
+}
+
+
+Future<ResourceStatistics> Cgroups2IsolatorProcess::usage(
+    const ContainerID& containerId)
+{
+  if (containerId.has_parent()) {
+    return Failure("Not supported for nested containers");
+  }
+
+  if (!infos.contains(containerId)) {
+    return Failure("Unknown container");
+  }
+
+  const string& cgroup = infos[containerId]->cgroup;
+
+  ResourceStatistics result;
+
+  if (controllers.count("cpu") > 0) {
+    Try<cgroups2::cpu::Stats> stats =
+      cgroups2::cpu::stats(hierarchy, cgroup);
+
+    if (stats.isError()) {
+      return Failure("Failed to read 'cpu.stat': " + stats.error());
+    }
+
+    result.set_cpus_user_time_secs(stats->user.secs());
+    result.set_cpus_system_time_secs(stats->system.secs());
+
+    // Add the throttling statistics only if cfs is enabled.
+    if (flags.cgroups_enable_cfs) {
+      if (stats->periods.isSome()) {
+        result.set_cpus_nr_periods(stats->periods.get());
+      }
+
+      if (stats->throttled.isSome()) {
+        result.set_cpus_nr_throttled(stats->throttled.get());
+      }
+
+      if (stats->throttledTime.isSome()) {
+        result.set_cpus_throttled_time_secs(stats->throttledTime->secs());
+      }
+    }
+  }
+
+  if (controllers.count("memory") > 0) {
+    Try<Bytes> usage = cgroups2::memory::usage(hierarchy, cgroup);
+    if (usage.isError()) {
+      return Failure("Failed to read 'memory.current': " + usage.error());
+    }
+
+    result.set_mem_total_bytes(usage->bytes());
+
+    Try<Option<Bytes>> limit = cgroups2::memory::max(hierarchy, cgroup);
+    if (limit.isSome() && limit->isSome()) {
+      result.set_mem_limit_bytes(limit->get().bytes());
+    }
+
+    Try<hashmap<string, uint64_t>> stats =
+      cgroups2::memory::stats(hierarchy, cgroup);
+
+    if (stats.isError()) {
+      return Failure("Failed to read 'memory.stat': " + stats.error());
+    }
+
+    // Unlike with cgroups v1, the statistics include those of the
+    // nested cgroups.
+    Option<uint64_t> file = stats->get("file");
+    if (file.isSome()) {
+      result.set_mem_file_bytes(file.get());
+      result.set_mem_cache_bytes(file.get());
+    }
+
+    Option<uint64_t> anon = stats->get("anon");
+    if (anon.isSome()) {
+      result.set_mem_anon_bytes(anon.get());
+      result.set_mem_rss_bytes(anon.get());
+    }
+
+    Option<uint64_t> fileMapped = stats->get("file_mapped");
+    if (fileMapped.isSome()) {
+      result.set_mem_mapped_file_bytes(fileMapped.get());
+    }
+
+    Option<uint64_t> unevictable = stats->get("unevictable");
+    if (unevictable.isSome()) {
+      result.set_mem_unevictable_bytes(unevictable.get());
+    }
+  }
+
+  if (controllers.count("io") > 0) {
+    Try<hashmap<string, cgroups2::io::Stats>> stats =
+      cgroups2::io::stats(hierarchy, cgroup);
+
+    if (stats.isError()) {
+      return Failure("Failed to read 'io.stat': " + stats.error());
+    }
+
+    result.set_io_read_bytes(0);
+    result.set_io_write_bytes(0);
+    result.set_io_read_ops(0);
+    result.set_io_write_ops(0);
+
+    foreachvalue (const cgroups2::io::Stats& device, stats.get()) {
+      result.set_io_read_bytes(result.io_read_bytes() + device.readBytes);
+      result.set_io_write_bytes(result.io_write_bytes() + device.writeBytes);
+      result.set_io_read_ops(result.io_read_ops() + device.readOps);
+      result.set_io_write_ops(result.io_write_ops() + device.writeOps);
+    }
+  }
+
+  // The pressure files are only there if the kernel has PSI enabled.
+  if (os::exists(path::join(hierarchy, cgroup, "cpu.pressure"))) {
+    Try<cgroups2::pressure::Pressure> cpu =
+      cgroups2::pressure::read(hierarchy, cgroup, "cpu");
+
+    Try<cgroups2::pressure::Pressure> memory =
+      cgroups2::pressure::read(hierarchy, cgroup, "memory");
+
+    Try<cgroups2::pressure::Pressure> io =
+      cgroups2::pressure::read(hierarchy, cgroup, "io");
+
+    if (cpu.isError() || memory.isError() || io.isError()) {
+      return Failure(
+          "Failed to read the pressure: " +
+          (cpu.isError() ? cpu.error()
+                         : (memory.isError() ? memory.error()
+                                             : io.error())));
+    }
+
+    result.set_cpus_pressure_some_avg10(cpu->some.avg10);
+    result.set_cpus_pressure_some_total_secs(cpu->some.total.secs());
+
+    if (cpu->full.isSome()) {
+      result.set_cpus_pressure_full_avg10(cpu->full->avg10);
+      result.set_cpus_pressure_full_total_secs(cpu->full->total.secs());
+    }
+
+    result.set_mem_pressure_some_avg10(memory->some.avg10);
+    result.set_mem_pressure_some_total_secs(memory->some.total.secs());
+
+    if (memory->full.isSome()) {
+      result.set_mem_pressure_full_avg10(memory->full->avg10);
+      result.set_mem_pressure_full_total_secs(memory->full->total.secs());
+    }
+
+    result.set_io_pressure_some_avg10(io->some.avg10);
+    result.set_io_pressure_some_total_secs(io->some.total.secs());
+
+    if (io->full.isSome()) {
+      result.set_io_pressure_full_avg10(io->full->avg10);
+      result.set_io_pressure_full_total_secs(io->full->total.secs());
+    }
+  }
+
+  return result;
+}
+
+
+Future<Nothing> Cgroups2IsolatorProcess::cleanup(
+    const ContainerID& containerId)
+{
+  // If we are a nested container, we do not need to clean anything up
+  // since only top-level containers should have cgroups created for them.
+  if (containerId.has_parent()) {
+    return Nothing();
+  }
+
+  if (!infos.contains(containerId)) {
+    VLOG(1) << "Ignoring cleanup request for unknown container " << containerId;
+
+    return Nothing();
+  }
+
+  if (!os::exists(path::join(hierarchy, infos[containerId]->cgroup))) {
+    infos.erase(containerId);
+    return Nothing();
+  }
+
+  return cgroups2::destroy(
+      hierarchy,
+      infos[containerId]->cgroup,
+      cgroups::DESTROY_TIMEOUT)
+    .onAny(defer(
+        PID<Cgroups2IsolatorProcess>(this),
+        &Cgroups2IsolatorProcess::_cleanup,
+        containerId,
+        lambda::_1));
+}
+
+
+Future<Nothing> Cgroups2IsolatorProcess::_cleanup(
+    const ContainerID& containerId,
+    const Future<Nothing>& future)
+{
+  if (!infos.contains(containerId)) {
+    return Nothing();
+  }
+
+  if (!future.isReady()) {
+    return Failure(
+        "Failed to destroy cgroup: " +
+        (future.isFailed() ? future.failure() : "discarded"));
+  }
+
+  infos.erase(containerId);
+
+  return Nothing();
+}
+
+
+string Cgroups2IsolatorProcess::cgroup(const ContainerID& containerId) const
+{
+  return path::join(flags.cgroups_root, containerId.value());
+}
+
+
+void Cgroups2IsolatorProcess::oom(const ContainerID& containerId)
+{
+  if (!infos.contains(containerId)) {
+    return;
+  }
+
+  const Owned<Info>& info = infos[containerId];
+
+  Try<hashmap<string, uint64_t>> events =
+    cgroups2::memory::events(hierarchy, info->cgroup);
+
+  if (events.isError()) {
+    // The cgroup may be gone when the container is being destroyed.
+    LOG(ERROR) << "Failed to read 'memory.events' for container "
+               << containerId << ": " << events.error();
+    return;
+  }
+
+  uint64_t ooms = events->get("oom_kill").getOrElse(0);
+
+  if (info->ooms.isSome() && ooms > info->ooms.get()) {
+    LOG(INFO) << "OOM detected for container " << containerId;
+
+    // Construct a "message" string to describe why the isolator
+    // destroyed the container's cgroup (in order to assist debugging).
+    string message = "Memory limit exceeded: ";
+
+    Try<Option<Bytes>> limit = cgroups2::memory::max(hierarchy, info->cgroup);
+    if (limit.isSome() && limit->isSome()) {
+      message += "Requested: " + stringify(limit->get()) + " ";
+    }
+
+    Try<Bytes> usage = cgroups2::memory::usage(hierarchy, info->cgroup);
+    if (usage.isSome()) {
+      message += "Used: " + stringify(usage.get()) + "\n";
+    }
+
+    // Output 'memory.stat' of the cgroup to help with debugging.
+    Try<string> read =
+      cgroups2::read(hierarchy, info->cgroup, "memory.stat");
+
+    if (read.isSome()) {
+      message += "\nMEMORY STATISTICS: \n" + read.get() + "\n";
+    }
+
+    LOG(INFO) << strings::trim(message);
+
+    // TODO(jieyu): This is not accurate if the memory resource is from
+    // a non-star role or spans roles (e.g., "*" and "role"). Ideally,
+    // we should save the resources passed in and report it here.
+    Resources mem = Resources::parse(
+        "mem",
+        stringify(usage.isSome() ? usage->megabytes() : 0),
+        "*").get();
+
+    info->limitation.set(
+        protobuf::slave::createContainerLimitation(
+            mem,
+            message,
+            TaskStatus::REASON_CONTAINER_LIMITATION_MEMORY));
+
+    return;
+  }
+
+  info->ooms = ooms;
+
+  process::delay(
+      OOM_CHECK_INTERVAL,
+      PID<Cgroups2IsolatorProcess>(this),
+      &Cgroups2IsolatorProcess::oom,
+      containerId);
+}
+
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
@@ -0,0 +1,135 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef __CGROUPS2_ISOLATOR_HPP__
+#define __CGROUPS2_ISOLATOR_HPP__
+
+#include <list>
+#include <set>
+#include <string>
+
+#include <mesos/resources.hpp>
+
+#include <process/future.hpp>
+#include <process/owned.hpp>
+
+#include <stout/hashmap.hpp>
+#include <stout/hashset.hpp>
+#include <stout/nothing.hpp>
+#include <stout/option.hpp>
+#include <stout/try.hpp>
+
+#include "slave/flags.hpp"
+
+#include "slave/containerizer/mesos/isolator.hpp"
+
+namespace mesos {
+namespace internal {
+namespace slave {
+
+// The cgroups isolator on hosts with the cgroups v2 unified hierarchy
+// mounted at `--cgroups_hierarchy`, see `CgroupsIsolatorProcess`. A
+// container has a single cgroup, in which the controllers of the
+// `cgroups/` isolators given in `--isolation` are configured and read,
+// rather than a cgroup in each of the hierarchies of the subsystems.
+//
+// Supports `cgroups/cpu`, `cgroups/mem`, `cgroups/blkio` (the 'io'
+// controller) and `cgroups/pids`. As with cgroups v1, nested
+// containers share the cgroup of their root container.
+class Cgroups2IsolatorProcess : public MesosIsolatorProcess
+{
+public:
+  static Try<mesos::slave::Isolator*> create(const Flags& flags);
+
+  virtual ~Cgroups2IsolatorProcess();
+
+  virtual bool supportsNesting();
+
+  virtual process::Future<Nothing> recover(
+      const std::list<mesos::slave::ContainerState>& states,
+      const hashset<ContainerID>& orphans);
+
+  virtual process::Future<Option<mesos::slave::ContainerLaunchInfo>> prepare(
+      const ContainerID& containerId,
+      const mesos::slave::ContainerConfig& containerConfig);
+
+  virtual process::Future<Nothing> isolate(
+      const ContainerID& containerId,
+      pid_t pid);
+
+  virtual process::Future<mesos::slave::ContainerLimitation> watch(
+      const ContainerID& containerId);
+
+  virtual process::Future<Nothing> update(
+      const ContainerID& containerId,
+      const Resources& resources);
+
+  virtual process::Future<ResourceStatistics> usage(
+      const ContainerID& containerId);
+
+  virtual process::Future<Nothing> cleanup(
+      const ContainerID& containerId);
+
+private:
+  struct Info
+  {
+    Info(const ContainerID& _containerId, const std::string& _cgroup)
+      : containerId(_containerId), cgroup(_cgroup) {}
+
+    const ContainerID containerId;
+    const std::string cgroup;
+
+    // This promise will complete if a container is impacted by a resource
+    // limitation and should be terminated.
+    process::Promise<mesos::slave::ContainerLimitation> limitation;
+
+    // The number of OOM kills in the cgroup when it was last checked.
+    Option<uint64_t> ooms;
+  };
+
+  Cgroups2IsolatorProcess(
+      const Flags& _flags,
+      const std::string& _hierarchy,
+      const std::set<std::string>& _controllers);
+
+  // Returns the cgroup of a top-level container.
+  std::string cgroup(const ContainerID& containerId) const;
+
+  // Checks 'memory.events' for OOM kills of the container, again
+  // after `OOM_CHECK_INTERVAL`.
+  void oom(const ContainerID& containerId);
+
+  process::Future<Nothing> _cleanup(
+      const ContainerID& containerId,
+      const process::Future<Nothing>& future);
+
+  const Flags flags;
+
+  // The root of the unified hierarchy.
+  const std::string hierarchy;
+
+  // The controllers enabled for the cgroups of the containers.
+  const std::set<std::string> controllers;
+
+  hashmap<ContainerID, process::Owned<Info>> infos;
+};
+
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __CGROUPS2_ISOLATOR_HPP__
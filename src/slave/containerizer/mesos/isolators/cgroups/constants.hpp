@@ -37,6 +37,10 @@ const Duration MIN_CPU_CFS_QUOTA = Milliseconds(1);
 // Memory subsystem constants.
 const Bytes MIN_MEMORY = Megabytes(32);
 
+// The interval at which OOM kills are checked for with the cgroups v2
+// unified hierarchy, which has no OOM notifications.
+const Duration OOM_CHECK_INTERVAL = Seconds(1);
+
 
 // Subsystem names.
 const std::string CGROUP_SUBSYSTEM_BLKIO_NAME = "blkio";
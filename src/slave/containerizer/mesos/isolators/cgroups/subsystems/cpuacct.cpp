@@ -87,11 +87,15 @@ Future<ResourceStatistics> CpuacctSubsystem::usage(
 
   PCHECK(ticks > 0) << "Failed to get sysconf(_SC_CLK_TCK)";
 
+  if (!readers.contains(containerId)) {
+    readers.put(
+        containerId,
+        Owned<cgroups::Reader>(new cgroups::Reader(hierarchy, cgroup)));
+  }
+
   // Add the cpuacct.stat information.
-  Try<hashmap<string, uint64_t>> stat = cgroups::stat(
-      hierarchy,
-      cgroup,
-      "cpuacct.stat");
+  Try<hashmap<string, uint64_t>> stat =
+    readers.at(containerId)->stat("cpuacct.stat");
 
   if (stat.isError()) {
     return Failure("Failed to read 'cpuacct.stat': " + stat.error());
@@ -110,6 +114,16 @@ Future<ResourceStatistics> CpuacctSubsystem::usage(
   return result;
 }
 
+
+Future<Nothing> CpuacctSubsystem::cleanup(
+    const ContainerID& containerId,
+    const string& cgroup)
+{
+  readers.erase(containerId);
+
+  return Nothing();
+}
+
 } // namespace slave {
 } // namespace internal {
 } // namespace mesos {
@@ -19,10 +19,16 @@
 
 #include <string>
 
+#include <mesos/type_utils.hpp>
+
 #include <process/owned.hpp>
 
+#include <stout/hashmap.hpp>
+#include <stout/nothing.hpp>
 #include <stout/try.hpp>
 
+#include "linux/cgroups.hpp"
+
 #include "slave/flags.hpp"
 
 #include "slave/containerizer/mesos/isolators/cgroups/constants.hpp"
@@ -53,8 +59,16 @@ public:
       const ContainerID& containerId,
       const std::string& cgroup);
 
+  virtual process::Future<Nothing> cleanup(
+      const ContainerID& containerId,
+      const std::string& cgroup);
+
 private:
   CpuacctSubsystem(const Flags& flags, const std::string& hierarchy);
+
+  // Keeps the control files read by `usage` open for each container,
+  // created on the first `usage` of the container.
+  hashmap<ContainerID, process::Owned<cgroups::Reader>> readers;
 };
 
 } // namespace slave {
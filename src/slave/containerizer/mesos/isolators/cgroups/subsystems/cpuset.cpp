@@ -14,13 +14,34 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <cmath>
+
 #include <process/id.hpp>
 
+#include <stout/error.hpp>
+#include <stout/foreach.hpp>
+#include <stout/option.hpp>
+#include <stout/os.hpp>
+#include <stout/stringify.hpp>
+
+#include "linux/cgroups.hpp"
+#include "linux/topology.hpp"
+
+#include "slave/state.hpp"
+
+#include "slave/containerizer/mesos/paths.hpp"
+
 #include "slave/containerizer/mesos/isolators/cgroups/subsystems/cpuset.hpp"
 
+using process::Failure;
+using process::Future;
 using process::Owned;
 
+using std::map;
+using std::set;
 using std::string;
+using std::vector;
 
 namespace mesos {
 namespace internal {
@@ -30,15 +51,425 @@ Try<Owned<Subsystem>> CpusetSubsystem::create(
     const Flags& flags,
     const string& hierarchy)
 {
-  return Owned<Subsystem>(new CpusetSubsystem(flags, hierarchy));
+  if (!flags.cgroups_exclusive_cpus) {
+    return Owned<Subsystem>(new CpusetSubsystem(flags, hierarchy, {}));
+  }
+
+  Try<map<int, vector<int>>> nodes = topology::nodes();
+  if (nodes.isError()) {
+    return Error("Failed to get the NUMA topology: " + nodes.error());
+  }
+
+  // The cpusets of the containers must be subsets of the cpuset of
+  // the root cgroup.
+  Try<string> cpus =
+    cgroups::read(hierarchy, flags.cgroups_root, "cpuset.cpus");
+  if (cpus.isError()) {
+    return Error("Failed to read 'cpuset.cpus': " + cpus.error());
+  }
+
+  Try<string> mems =
+    cgroups::read(hierarchy, flags.cgroups_root, "cpuset.mems");
+  if (mems.isError()) {
+    return Error("Failed to read 'cpuset.mems': " + mems.error());
+  }
+
+  Try<set<int>> rootCpus = topology::parse(cpus.get());
+  if (rootCpus.isError()) {
+    return Error("Failed to parse 'cpuset.cpus': " + rootCpus.error());
+  }
+
+  Try<set<int>> rootMems = topology::parse(mems.get());
+  if (rootMems.isError()) {
+    return Error("Failed to parse 'cpuset.mems': " + rootMems.error());
+  }
+
+  map<int, vector<int>> available;
+  foreach (const auto& node, nodes.get()) {
+    if (rootMems->count(node.first) == 0) {
+      continue;
+    }
+
+    available[node.first];
+    foreach (int cpu, node.second) {
+      if (rootCpus->count(cpu) > 0) {
+        available[node.first].push_back(cpu);
+      }
+    }
+  }
+
+  if (available.empty()) {
+    return Error(
+        "None of the NUMA nodes is in 'cpuset.mems' of the root cgroup");
+  }
+
+  return Owned<Subsystem>(new CpusetSubsystem(flags, hierarchy, available));
 }
 
 
 CpusetSubsystem::CpusetSubsystem(
     const Flags& _flags,
-    const string& _hierarchy)
+    const string& _hierarchy,
+    const map<int, vector<int>>& _nodes)
   : ProcessBase(process::ID::generate("cgroups-cpuset-subsystem")),
-    Subsystem(_flags, _hierarchy) {}
+    Subsystem(_flags, _hierarchy),
+    nodes(_nodes) {}
+
+
+Future<Nothing> CpusetSubsystem::recover(
+    const ContainerID& containerId,
+    const string& cgroup)
+{
+  if (!flags.cgroups_exclusive_cpus) {
+    return Nothing();
+  }
+
+  if (infos.contains(containerId)) {
+    return Failure("The subsystem '" + name() + "' has already been recovered");
+  }
+
+  Owned<Info> info(new Info(cgroup));
+
+  // The exclusive CPUs of the container (if any) are checkpointed in
+  // the runtime directory of the container.
+  const string path = containerizer::paths::getContainerCpusetPath(
+      flags.runtime_dir, containerId);
+
+  if (os::exists(path)) {
+    Try<string> read = os::read(path);
+    if (read.isError()) {
+      return Failure(
+          "Failed to read the exclusive CPUs of container " +
+          stringify(containerId) + " from '" + path + "': " + read.error());
+    }
+
+    Try<set<int>> cpus = topology::parse(read.get());
+    if (cpus.isError()) {
+      return Failure(
+          "Failed to parse the exclusive CPUs of container " +
+          stringify(containerId) + ": " + cpus.error());
+    }
+
+    set<int> available = shared();
+    if (std::includes(
+            available.begin(), available.end(),
+            cpus->begin(), cpus->end())) {
+      info->cpus = cpus.get();
+    } else {
+      LOG(WARNING) << "The exclusive CPUs " << read.get() << " of container "
+                   << containerId << " are no longer available, the "
+                   << "container will share CPUs";
+    }
+  }
+
+  infos.put(containerId, info);
+
+  if (info->cpus.empty()) {
+    Try<Nothing> write = this->write(*info);
+    if (write.isError()) {
+      return Failure(write.error());
+    }
+  }
+
+  updateShared();
+
+  return Nothing();
+}
+
+
+Future<Nothing> CpusetSubsystem::prepare(
+    const ContainerID& containerId,
+    const string& cgroup)
+{
+  if (!flags.cgroups_exclusive_cpus) {
+    return Nothing();
+  }
+
+  if (infos.contains(containerId)) {
+    return Failure("The subsystem '" + name() + "' has already been prepared");
+  }
+
+  Owned<Info> info(new Info(cgroup));
+
+  // The container shares the CPUs that are not allocated exclusively
+  // until its resources are known.
+  Try<Nothing> write = this->write(*info);
+  if (write.isError()) {
+    return Failure(write.error());
+  }
+
+  infos.put(containerId, info);
+
+  return Nothing();
+}
+
+
+Future<Nothing> CpusetSubsystem::update(
+    const ContainerID& containerId,
+    const string& cgroup,
+    const Resources& resources)
+{
+  if (!flags.cgroups_exclusive_cpus) {
+    return Nothing();
+  }
+
+  if (!infos.contains(containerId)) {
+    return Failure(
+        "Failed to update subsystem '" + name() + "'"
+        ": Unknown container");
+  }
+
+  // Only containers with an integral number of (non-revocable) CPUs
+  // get exclusive CPUs.
+  size_t count = 0;
+
+  Option<double> cpus = resources.cpus();
+  if (cpus.isSome() &&
+      resources.revocable().cpus().isNone() &&
+      cpus.get() >= 1 &&
+      std::floor(cpus.get()) == cpus.get()) {
+    count = static_cast<size_t>(cpus.get());
+  }
+
+  const Owned<Info>& info = infos[containerId];
+
+  if (count == info->cpus.size()) {
+    return Nothing();
+  }
+
+  const set<int> previous = info->cpus;
+  info->cpus.clear();
+
+  if (count > 0) {
+    Try<set<int>> allocation = allocate(count);
+    if (allocation.isError()) {
+      LOG(WARNING) << "Failed to allocate " << count << " exclusive CPUs "
+                   << "for container " << containerId << ", the container "
+                   << "will share CPUs: " << allocation.error();
+    } else {
+      info->cpus = allocation.get();
+    }
+  }
+
+  if (info->cpus == previous) {
+    return Nothing();
+  }
+
+  const string path = containerizer::paths::getContainerCpusetPath(
+      flags.runtime_dir, containerId);
+
+  if (info->cpus.empty()) {
+    if (os::exists(path)) {
+      Try<Nothing> rm = os::rm(path);
+      if (rm.isError()) {
+        return Failure(
+            "Failed to remove '" + path + "': " + rm.error());
+      }
+    }
+  } else {
+    Try<Nothing> checkpoint =
+      state::checkpoint(path, topology::format(info->cpus));
+
+    if (checkpoint.isError()) {
+      return Failure(
+          "Failed to checkpoint the exclusive CPUs at '" + path + "': " +
+          checkpoint.error());
+    }
+  }
+
+  Try<Nothing> write = this->write(*info);
+  if (write.isError()) {
+    return Failure(write.error());
+  }
+
+  LOG(INFO) << "Updated the cpuset of container " << containerId << " to "
+            << (info->cpus.empty()
+                  ? "the shared CPUs"
+                  : "exclusive CPUs " + topology::format(info->cpus));
+
+  updateShared();
+
+  return Nothing();
+}
+
+
+Future<Nothing> CpusetSubsystem::cleanup(
+    const ContainerID& containerId,
+    const string& cgroup)
+{
+  if (!flags.cgroups_exclusive_cpus) {
+    return Nothing();
+  }
+
+  if (!infos.contains(containerId)) {
+    VLOG(1) << "Ignoring cleanup subsystem '" << name() << "' "
+            << "request for unknown container " << containerId;
+
+    return Nothing();
+  }
+
+  bool exclusive = !infos[containerId]->cpus.empty();
+
+  infos.erase(containerId);
+
+  // Give the released CPUs back to the containers sharing CPUs.
+  if (exclusive) {
+    updateShared();
+  }
+
+  return Nothing();
+}
+
+
+set<int> CpusetSubsystem::shared() const
+{
+  set<int> result;
+  foreachvalue (const vector<int>& cpus, nodes) {
+    result.insert(cpus.begin(), cpus.end());
+  }
+
+  foreachvalue (const Owned<Info>& info, infos) {
+    foreach (int cpu, info->cpus) {
+      result.erase(cpu);
+    }
+  }
+
+  return result;
+}
+
+
+Try<set<int>> CpusetSubsystem::allocate(size_t count) const
+{
+  const set<int> available = shared();
+
+  // We always leave a CPU for the containers sharing CPUs.
+  if (available.size() <= count) {
+    return Error(
+        "Only " + stringify(available.size()) + " CPUs are not allocated "
+        "exclusively");
+  }
+
+  map<int, vector<int>> free;
+  foreach (const auto& node, nodes) {
+    free[node.first];
+    foreach (int cpu, node.second) {
+      if (available.count(cpu) > 0) {
+        free[node.first].push_back(cpu);
+      }
+    }
+  }
+
+  // Use the node with the fewest free CPUs that fits the allocation,
+  // which leaves the nodes with more free CPUs for larger ones. The
+  // CPUs are taken in the order of the node so that the hardware
+  // threads of a core are allocated together.
+  Option<int> best;
+  foreach (const auto& node, free) {
+    if (node.second.size() >= count &&
+        (best.isNone() || node.second.size() < free[best.get()].size())) {
+      best = node.first;
+    }
+  }
+
+  set<int> result;
+
+  if (best.isSome()) {
+    const vector<int>& cpus = free[best.get()];
+    result.insert(cpus.begin(), cpus.begin() + count);
+    return result;
+  }
+
+  // Otherwise span the nodes, starting with the ones with the most
+  // free CPUs to span as few nodes as possible.
+  vector<int> order;
+  foreachkey (int node, free) {
+    order.push_back(node);
+  }
+
+  std::stable_sort(order.begin(), order.end(), [&free](int a, int b) {
+    return free[a].size() > free[b].size();
+  });
+
+  foreach (int node, order) {
+    foreach (int cpu, free[node]) {
+      if (result.size() == count) {
+        return result;
+      }
+
+      result.insert(cpu);
+    }
+  }
+
+  return result;
+}
+
+
+Try<Nothing> CpusetSubsystem::write(const Info& info)
+{
+  set<int> cpus = info.cpus.empty() ? shared() : info.cpus;
+
+  // The memory of the containers with exclusive CPUs is restricted to
+  // the NUMA nodes of those CPUs.
+  set<int> mems;
+  foreach (const auto& node, nodes) {
+    bool local = info.cpus.empty();
+    foreach (int cpu, node.second) {
+      local = local || info.cpus.count(cpu) > 0;
+    }
+
+    if (local) {
+      mems.insert(node.first);
+    }
+  }
+
+  Try<Nothing> write = cgroups::write(
+      hierarchy, info.cgroup, "cpuset.cpus", topology::format(cpus));
+
+  if (write.isError()) {
+    return Error("Failed to update 'cpuset.cpus': " + write.error());
+  }
+
+  // Migrate the memory that was already allocated (if any) to the
+  // NUMA nodes of the exclusive CPUs.
+  write = cgroups::write(
+      hierarchy,
+      info.cgroup,
+      "cpuset.memory_migrate",
+      info.cpus.empty() ? "0" : "1");
+
+  if (write.isError()) {
+    return Error("Failed to update 'cpuset.memory_migrate': " + write.error());
+  }
+
+  write = cgroups::write(
+      hierarchy, info.cgroup, "cpuset.mems", topology::format(mems));
+
+  if (write.isError()) {
+    return Error("Failed to update 'cpuset.mems': " + write.error());
+  }
+
+  return Nothing();
+}
+
+
+void CpusetSubsystem::updateShared()
+{
+  foreachpair (const ContainerID& containerId,
+               const Owned<Info>& info,
+               infos) {
+    if (!info->cpus.empty()) {
+      continue;
+    }
+
+    // Since the destruction of containers is asynchronous, the
+    // cgroup of the container might have been removed already.
+    Try<Nothing> write = this->write(*info);
+    if (write.isError()) {
+      LOG(WARNING) << "Failed to update the cpuset of container "
+                   << containerId << ": " << write.error();
+    }
+  }
+}
 
 } // namespace slave {
 } // namespace internal {
@@ -17,10 +17,18 @@
 #ifndef __CGROUPS_ISOLATOR_SUBSYSTEMS_CPUSET_HPP__
 #define __CGROUPS_ISOLATOR_SUBSYSTEMS_CPUSET_HPP__
 
+#include <map>
+#include <set>
 #include <string>
+#include <vector>
 
+#include <mesos/resources.hpp>
+
+#include <process/future.hpp>
 #include <process/owned.hpp>
 
+#include <stout/hashmap.hpp>
+#include <stout/nothing.hpp>
 #include <stout/try.hpp>
 
 #include "slave/flags.hpp"
@@ -34,6 +42,12 @@ namespace slave {
 
 /**
  * Represent cgroups cpuset subsystem.
+ *
+ * If `--cgroups_exclusive_cpus` is set, containers with an integral
+ * (and non-revocable) cpus resource get exclusive CPUs, on a single
+ * NUMA node where possible, and 'cpuset.mems' is set to the NUMA
+ * nodes of those CPUs. The other containers share the CPUs that are
+ * not allocated exclusively.
  */
 class CpusetSubsystem : public Subsystem
 {
@@ -49,8 +63,60 @@ public:
     return CGROUP_SUBSYSTEM_CPUSET_NAME;
   };
 
+  virtual process::Future<Nothing> recover(
+      const ContainerID& containerId,
+      const std::string& cgroup);
+
+  virtual process::Future<Nothing> prepare(
+      const ContainerID& containerId,
+      const std::string& cgroup);
+
+  virtual process::Future<Nothing> update(
+      const ContainerID& containerId,
+      const std::string& cgroup,
+      const Resources& resources);
+
+  virtual process::Future<Nothing> cleanup(
+      const ContainerID& containerId,
+      const std::string& cgroup);
+
 private:
-  CpusetSubsystem(const Flags& flags, const std::string& hierarchy);
+  CpusetSubsystem(
+      const Flags& flags,
+      const std::string& hierarchy,
+      const std::map<int, std::vector<int>>& nodes);
+
+  struct Info
+  {
+    Info(const std::string& _cgroup) : cgroup(_cgroup) {}
+
+    const std::string cgroup;
+
+    // The exclusive CPUs of the container, or empty if the container
+    // shares the CPUs that are not allocated exclusively.
+    std::set<int> cpus;
+  };
+
+  // Returns the CPUs that are not allocated exclusively.
+  std::set<int> shared() const;
+
+  // Allocates exclusive CPUs, on a single NUMA node if possible.
+  Try<std::set<int>> allocate(size_t count) const;
+
+  // Writes the 'cpuset.cpus' and 'cpuset.mems' of the container.
+  Try<Nothing> write(const Info& info);
+
+  // Writes the cpusets of the containers without exclusive CPUs,
+  // which is needed whenever the exclusive CPUs change.
+  void updateShared();
+
+  // The CPUs of each NUMA node that are available to the containers,
+  // ordered such that the hardware threads of a core follow each
+  // other.
+  const std::map<int, std::vector<int>> nodes;
+
+  // Stores cgroups associated information for container.
+  hashmap<ContainerID, process::Owned<Info>> infos;
 };
 
 } // namespace slave {
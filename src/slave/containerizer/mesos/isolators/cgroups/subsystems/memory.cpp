@@ -19,9 +19,11 @@
 #include <climits>
 #include <sstream>
 
+#include <process/clock.hpp>
 #include <process/collect.hpp>
 #include <process/defer.hpp>
 #include <process/id.hpp>
+#include <process/time.hpp>
 
 #include <stout/bytes.hpp>
 #include <stout/error.hpp>
@@ -34,14 +36,17 @@
 #include "slave/containerizer/mesos/isolators/cgroups/subsystems/memory.hpp"
 
 using cgroups::memory::pressure::Counter;
+using cgroups::memory::pressure::Delta;
 using cgroups::memory::pressure::Level;
 
 using mesos::slave::ContainerLimitation;
 
+using process::Clock;
 using process::Failure;
 using process::Future;
 using process::Owned;
 using process::PID;
+using process::Time;
 
 using std::list;
 using std::ostringstream;
@@ -284,36 +289,37 @@ Future<ResourceStatistics> MemorySubsystem::usage(
 
   const Owned<Info>& info = infos[containerId];
 
+  if (info->reader.get() == nullptr) {
+    info->reader.reset(new cgroups::Reader(hierarchy, cgroup));
+  }
+
   ResourceStatistics result;
 
   // The rss from memory.stat is wrong in two dimensions:
   //   1. It does not include child cgroups.
   //   2. It does not include any file backed pages.
-  Try<Bytes> usage = cgroups::memory::usage_in_bytes(hierarchy, cgroup);
+  Try<uint64_t> usage = info->reader->value("memory.usage_in_bytes");
 
   if (usage.isError()) {
     return Failure("Failed to parse 'memory.usage_in_bytes': " + usage.error());
   }
 
-  result.set_mem_total_bytes(usage.get().bytes());
+  result.set_mem_total_bytes(usage.get());
 
   if (flags.cgroups_limit_swap) {
-    Try<Bytes> usage = cgroups::memory::memsw_usage_in_bytes(hierarchy, cgroup);
+    Try<uint64_t> usage = info->reader->value("memory.memsw.usage_in_bytes");
 
     if (usage.isError()) {
       return Failure(
         "Failed to parse 'memory.memsw.usage_in_bytes': " + usage.error());
     }
 
-    result.set_mem_total_memsw_bytes(usage.get().bytes());
+    result.set_mem_total_memsw_bytes(usage.get());
   }
 
   // TODO(bmahler): Add namespacing to cgroups to enforce the expected
   // structure, e.g, cgroups::memory::stat.
-  Try<hashmap<string, uint64_t>> stat = cgroups::stat(
-      hierarchy,
-      cgroup,
-      "memory.stat");
+  Try<hashmap<string, uint64_t>> stat = info->reader->stat("memory.stat");
 
   if (stat.isError()) {
     return Failure("Failed to read 'memory.stat': " + stat.error());
@@ -350,23 +356,29 @@ Future<ResourceStatistics> MemorySubsystem::usage(
     result.set_mem_unevictable_bytes(total_unevictable.get());
   }
 
-  // Get pressure counter readings.
+  // Get pressure counter readings, along with the changes of the
+  // memory statistics sampled on the pressure events.
   list<Level> levels;
   list<Future<uint64_t>> values;
+  list<Future<Option<Delta>>> deltas;
   foreachpair (Level level,
                const Owned<Counter>& counter,
                info->pressureCounters) {
     levels.push_back(level);
     values.push_back(counter->value());
+    deltas.push_back(counter->delta());
   }
 
-  return await(values)
+  // NOTE: The futures are all completed once the `await` is, hence
+  // we pass them on directly.
+  return await(await(values), await(deltas))
     .then(defer(PID<MemorySubsystem>(this),
                 &MemorySubsystem::_usage,
                 containerId,
                 result,
                 levels,
-                lambda::_1));
+                values,
+                deltas));
 }
 
 
@@ -374,7 +386,8 @@ Future<ResourceStatistics> MemorySubsystem::_usage(
     const ContainerID& containerId,
     ResourceStatistics result,
     const list<Level>& levels,
-    const list<Future<uint64_t>>& values)
+    const list<Future<uint64_t>>& values,
+    const list<Future<Option<Delta>>>& deltas)
 {
   if (!infos.contains(containerId)) {
     return Failure(
@@ -382,27 +395,91 @@ Future<ResourceStatistics> MemorySubsystem::_usage(
         ": Unknown container");
   }
 
+  const Owned<Info>& info = infos[containerId];
+
+  const Time now = Clock::now();
+
+  // The elapsed time since the previous readings of the counters.
+  Option<double> elapsed;
+  if (info->pressureTime.isSome() && now > info->pressureTime.get()) {
+    elapsed = (now - info->pressureTime.get()).secs();
+  }
+
+  // The delta sampled on the events of the highest level.
+  Option<Level> deltaLevel;
+  Option<Delta> delta;
+
   list<Level>::const_iterator iterator = levels.begin();
+  list<Future<Option<Delta>>>::const_iterator sample = deltas.begin();
   foreach (const Future<uint64_t>& value, values) {
-    if (value.isReady()) {
-      switch (*iterator) {
-        case Level::LOW:
-          result.set_mem_low_pressure_counter(value.get());
-          break;
-        case Level::MEDIUM:
-          result.set_mem_medium_pressure_counter(value.get());
-          break;
-        case Level::CRITICAL:
-          result.set_mem_critical_pressure_counter(value.get());
-          break;
-      }
-    } else {
-      LOG(ERROR) << "Failed to listen on '" << stringify(*iterator)
+    const Level level = *iterator++;
+    const Future<Option<Delta>>& future = *sample++;
+
+    if (!value.isReady()) {
+      LOG(ERROR) << "Failed to listen on '" << stringify(level)
                  << "' pressure events for container " << containerId << ": "
                  << (value.isFailed() ? value.failure() : "discarded");
+      continue;
     }
 
-    ++iterator;
+    Option<double> rate;
+    if (elapsed.isSome() &&
+        info->pressureValues.contains(level) &&
+        value.get() >= info->pressureValues[level]) {
+      rate = (value.get() - info->pressureValues[level]) / elapsed.get();
+    }
+
+    info->pressureValues[level] = value.get();
+
+    switch (level) {
+      case Level::LOW:
+        result.set_mem_low_pressure_counter(value.get());
+        if (rate.isSome()) {
+          result.set_mem_low_pressure_rate(rate.get());
+        }
+        break;
+      case Level::MEDIUM:
+        result.set_mem_medium_pressure_counter(value.get());
+        if (rate.isSome()) {
+          result.set_mem_medium_pressure_rate(rate.get());
+        }
+        break;
+      case Level::CRITICAL:
+        result.set_mem_critical_pressure_counter(value.get());
+        if (rate.isSome()) {
+          result.set_mem_critical_pressure_rate(rate.get());
+        }
+        break;
+    }
+
+    // NOTE: The levels are declared in the order of their severity.
+    if (future.isReady() &&
+        future->isSome() &&
+        (deltaLevel.isNone() || level > deltaLevel.get())) {
+      deltaLevel = level;
+      delta = future->get();
+    }
+  }
+
+  info->pressureTime = now;
+
+  if (delta.isSome()) {
+    result.set_mem_pressure_interval_secs(delta->elapsed.secs());
+
+    Option<int64_t> rss = delta->stat.get("total_rss");
+    if (rss.isSome()) {
+      result.set_mem_pressure_rss_delta_bytes(rss.get());
+    }
+
+    Option<int64_t> cache = delta->stat.get("total_cache");
+    if (cache.isSome()) {
+      result.set_mem_pressure_cache_delta_bytes(cache.get());
+    }
+
+    Option<int64_t> faults = delta->stat.get("total_pgmajfault");
+    if (faults.isSome()) {
+      result.set_mem_pressure_major_faults(faults.get());
+    }
   }
 
   return result;
@@ -550,7 +627,11 @@ void MemorySubsystem::pressureListen(
   CHECK(infos.contains(containerId));
 
   foreach (const Level& level, levels()) {
-    Try<Owned<Counter>> counter = Counter::create(hierarchy, cgroup, level);
+    // The memory statistics are sampled on the events of the medium
+    // and critical levels only, since the low level events occur on
+    // every reclaim.
+    Try<Owned<Counter>> counter =
+      Counter::create(hierarchy, cgroup, level, level != Level::LOW);
 
     if (counter.isError()) {
       LOG(ERROR) << "Failed to listen on '" << level << "' memory pressure "
@@ -22,9 +22,11 @@
 
 #include <process/future.hpp>
 #include <process/owned.hpp>
+#include <process/time.hpp>
 
 #include <stout/hashmap.hpp>
 #include <stout/nothing.hpp>
+#include <stout/option.hpp>
 #include <stout/try.hpp>
 
 #include "linux/cgroups.hpp"
@@ -90,7 +92,16 @@ private:
         cgroups::memory::pressure::Level,
         process::Owned<cgroups::memory::pressure::Counter>> pressureCounters;
 
+    // The values of the pressure counters at the previous `usage`,
+    // used to calculate the pressure rates.
+    Option<process::Time> pressureTime;
+    hashmap<cgroups::memory::pressure::Level, uint64_t> pressureValues;
+
     process::Promise<mesos::slave::ContainerLimitation> limitation;
+
+    // Keeps the control files read by `usage` open, created on the
+    // first `usage` of the container.
+    process::Owned<cgroups::Reader> reader;
   };
 
   MemorySubsystem(const Flags& flags, const std::string& hierarchy);
@@ -99,7 +110,9 @@ private:
       const ContainerID& containerId,
       ResourceStatistics result,
       const std::list<cgroups::memory::pressure::Level>& levels,
-      const std::list<process::Future<uint64_t>>& values);
+      const std::list<process::Future<uint64_t>>& values,
+      const std::list<process::Future<
+          Option<cgroups::memory::pressure::Delta>>>& deltas);
 
   // Start listening on OOM events. This function will create an
   // eventfd and start polling on it.
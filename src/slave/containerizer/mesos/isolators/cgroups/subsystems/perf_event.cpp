@@ -44,16 +44,6 @@ Try<Owned<Subsystem>> PerfEventSubsystem::create(
     const Flags& flags,
     const string& hierarchy)
 {
-  if (!perf::supported()) {
-    return Error("Perf is not supported");
-  }
-
-  if (flags.perf_duration > flags.perf_interval) {
-    return Error(
-        "Sampling perf for duration (" + stringify(flags.perf_duration) + ") > "
-        "interval (" + stringify(flags.perf_interval) + ") is not supported.");
-  }
-
   if (!flags.perf_events.isSome()) {
     return Error("No perf events specified");
   }
@@ -64,6 +54,37 @@ Try<Owned<Subsystem>> PerfEventSubsystem::create(
     events.insert(event);
   }
 
+  // Count the events with `perf_event_open` counters if possible,
+  // which neither requires `perf` nor forks it every interval. We
+  // check that the kernel supports counting the events by opening
+  // the counters of the root cgroup of the hierarchy.
+  if (perf::Counters::supported(events)) {
+    Try<Owned<perf::Counters>> counters =
+      perf::Counters::create(events, hierarchy, "");
+
+    if (counters.isSome()) {
+      LOG(INFO) << "perf_event subsystem will count events "
+                << "every '" << flags.perf_interval << "' "
+                << "for events: " << stringify(events);
+
+      return Owned<Subsystem>(
+          new PerfEventSubsystem(flags, hierarchy, events, true));
+    }
+
+    LOG(WARNING) << "Failed to open perf event counters, falling back to "
+                 << "'perf stat': " << counters.error();
+  }
+
+  if (!perf::supported()) {
+    return Error("Perf is not supported");
+  }
+
+  if (flags.perf_duration > flags.perf_interval) {
+    return Error(
+        "Sampling perf for duration (" + stringify(flags.perf_duration) + ") > "
+        "interval (" + stringify(flags.perf_interval) + ") is not supported.");
+  }
+
   if (!perf::valid(events)) {
     return Error("Invalid perf events: " + stringify(events));
   }
@@ -73,17 +94,20 @@ Try<Owned<Subsystem>> PerfEventSubsystem::create(
             << "every '" << flags.perf_interval << "' "
             << "for events: " << stringify(events);
 
-  return Owned<Subsystem>(new PerfEventSubsystem(flags, hierarchy, events));
+  return Owned<Subsystem>(
+      new PerfEventSubsystem(flags, hierarchy, events, false));
 }
 
 
 PerfEventSubsystem::PerfEventSubsystem(
     const Flags& _flags,
     const string& _hierarchy,
-    const set<string>& _events)
+    const set<string>& _events,
+    bool _native)
   : ProcessBase(process::ID::generate("cgroups-perf-event-subsystem")),
     Subsystem(_flags, _hierarchy),
-    events(_events) {}
+    events(_events),
+    native(_native) {}
 
 
 void PerfEventSubsystem::initialize()
@@ -101,7 +125,12 @@ Future<Nothing> PerfEventSubsystem::recover(
     return Failure("The subsystem '" + name() + "' has already been recovered");
   }
 
-  infos.put(containerId, Owned<Info>(new Info(cgroup)));
+  Try<Owned<Info>> info = createInfo(cgroup);
+  if (info.isError()) {
+    return Failure(info.error());
+  }
+
+  infos.put(containerId, info.get());
 
   return Nothing();
 }
@@ -115,7 +144,12 @@ Future<Nothing> PerfEventSubsystem::prepare(
     return Failure("The subsystem '" + name() + "' has already been prepared");
   }
 
-  infos.put(containerId, Owned<Info>(new Info(cgroup)));
+  Try<Owned<Info>> info = createInfo(cgroup);
+  if (info.isError()) {
+    return Failure(info.error());
+  }
+
+  infos.put(containerId, info.get());
 
   return Nothing();
 }
@@ -155,8 +189,51 @@ Future<Nothing> PerfEventSubsystem::cleanup(
 }
 
 
+Try<Owned<PerfEventSubsystem::Info>> PerfEventSubsystem::createInfo(
+    const string& cgroup)
+{
+  Owned<Info> info(new Info(cgroup));
+
+  if (native) {
+    Try<Owned<perf::Counters>> counters =
+      perf::Counters::create(events, hierarchy, cgroup);
+
+    if (counters.isError()) {
+      return Error(
+          "Failed to open the perf event counters of cgroup '" + cgroup +
+          "': " + counters.error());
+    }
+
+    info->counters = counters.get();
+  }
+
+  return info;
+}
+
+
 void PerfEventSubsystem::sample()
 {
+  if (native) {
+    // The counters count continuously, hence the sample covers the
+    // whole interval since the previous one.
+    foreachvalue (const Owned<Info>& info, infos) {
+      Try<PerfStatistics> statistics = info->counters.get()->read();
+      if (statistics.isError()) {
+        LOG(ERROR) << "Failed to read the perf event counters of cgroup '"
+                   << info->cgroup << "': " << statistics.error();
+        continue;
+      }
+
+      info->statistics = statistics.get();
+    }
+
+    delay(flags.perf_interval,
+          PID<PerfEventSubsystem>(this),
+          &PerfEventSubsystem::sample);
+
+    return;
+  }
+
   // Collect a perf sample for all cgroups that are not being
   // destroyed. Since destroyal is asynchronous, 'perf stat' may
   // fail if the cgroup is destroyed before running perf.
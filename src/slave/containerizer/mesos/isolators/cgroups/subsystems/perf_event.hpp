@@ -28,6 +28,10 @@
 #include <process/time.hpp>
 
 #include <stout/hashmap.hpp>
+#include <stout/option.hpp>
+#include <stout/try.hpp>
+
+#include "linux/perf.hpp"
 
 #include "slave/flags.hpp"
 
@@ -78,7 +82,8 @@ private:
   PerfEventSubsystem(
       const Flags& flags,
       const std::string& hierarchy,
-      const std::set<std::string>& events);
+      const std::set<std::string>& events,
+      bool native);
 
   struct Info
   {
@@ -95,8 +100,13 @@ private:
 
     const std::string cgroup;
     PerfStatistics statistics;
+
+    // The counters of the cgroup if the events are counted natively.
+    Option<process::Owned<perf::Counters>> counters;
   };
 
+  Try<process::Owned<Info>> createInfo(const std::string& cgroup);
+
   void sample();
 
   void _sample(
@@ -106,6 +116,10 @@ private:
   // Set of events to sample.
   std::set<std::string> events;
 
+  // Whether the events are counted with `perf::Counters` rather than
+  // sampled with `perf stat`.
+  const bool native;
+
   // Stores cgroups associated information for container.
   hashmap<ContainerID, process::Owned<Info>> infos;
 };
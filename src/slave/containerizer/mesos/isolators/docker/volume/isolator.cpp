@@ -157,7 +157,13 @@ Future<Nothing> DockerVolumeIsolatorProcess::recover(
         rootDir + "': " + entries.error());
   }
 
+  const string mountsPath = paths::getMountsPath(rootDir);
+
   foreach (const string& entry, entries.get()) {
+    if (path::join(rootDir, entry) == mountsPath) {
+      continue;
+    }
+
     ContainerID containerId;
     containerId.set_value(Path(entry).basename());
 
@@ -185,6 +191,89 @@ Future<Nothing> DockerVolumeIsolatorProcess::recover(
     cleanup(containerId);
   }
 
+  // Recover the mount points of the volumes that are still in use, so
+  // that they are not mounted again for new containers. The number of
+  // containers using a volume is determined by the containers that
+  // were recovered above, since the agent might have failed after
+  // checkpointing a container's volumes but before checkpointing the
+  // reference counts.
+  if (os::exists(mountsPath)) {
+    Try<string> read = os::read(mountsPath);
+    if (read.isError()) {
+      return Failure(
+          "Failed to read docker volume mounts checkpoint file '" +
+          mountsPath + "': " + read.error());
+    }
+
+    Try<JSON::Object> json = JSON::parse<JSON::Object>(read.get());
+    if (json.isError()) {
+      return Failure("JSON parse failed: " + json.error());
+    }
+
+    Try<DockerVolumeMounts> parse =
+      ::protobuf::parse<DockerVolumeMounts>(json.get());
+
+    if (parse.isError()) {
+      return Failure("Protobuf parse failed: " + parse.error());
+    }
+
+    foreach (const DockerVolumeMounts::Mount& mount, parse->mounts()) {
+      const DockerVolume& volume = mount.volume();
+
+      if (!mountedVolumes.contains(volume)) {
+        continue;
+      }
+
+      MountedVolume& mounted = mountedVolumes.at(volume);
+
+      if (mounted.containers.size() != mount.references()) {
+        LOG(WARNING) << "Recovered " << mounted.containers.size()
+                     << " containers using the volume with driver '"
+                     << volume.driver() << "' and name '" << volume.name()
+                     << "' but checkpointed " << mount.references();
+      }
+
+      if (mounted.mountPoint.isNone()) {
+        mounted.mountPoint = Future<string>(mount.mount_point());
+      }
+    }
+  }
+
+  return Nothing();
+}
+
+
+Try<Nothing> DockerVolumeIsolatorProcess::checkpointMounts()
+{
+  DockerVolumeMounts state;
+
+  foreachpair (const DockerVolume& volume,
+               const MountedVolume& mounted,
+               mountedVolumes) {
+    if (mounted.containers.empty() ||
+        mounted.mountPoint.isNone() ||
+        !mounted.mountPoint->isReady()) {
+      continue;
+    }
+
+    DockerVolumeMounts::Mount* mount = state.add_mounts();
+    mount->mutable_volume()->CopyFrom(volume);
+    mount->set_mount_point(strings::trim(mounted.mountPoint->get()));
+    mount->set_references(mounted.containers.size());
+  }
+
+  const string mountsPath = paths::getMountsPath(rootDir);
+
+  Try<Nothing> checkpoint = state::checkpoint(
+      mountsPath,
+      stringify(JSON::protobuf(state)));
+
+  if (checkpoint.isError()) {
+    return Error(
+        "Failed to checkpoint docker volume mounts at '" +
+        mountsPath + "': " + checkpoint.error());
+  }
+
   return Nothing();
 }
 
@@ -251,6 +340,7 @@ Try<Nothing> DockerVolumeIsolatorProcess::_recover(
     }
 
     volumes.insert(volume);
+    mountedVolumes[volume].containers.insert(containerId);
   }
 
   infos.put(containerId, Owned<Info>(new Info(volumes)));
@@ -439,13 +529,31 @@ Future<Option<ContainerLaunchInfo>> DockerVolumeIsolatorProcess::prepare(
 
   infos.put(containerId, Owned<Info>(new Info(volumes)));
 
-  // Invoke driver client to create the mount.
+  // Invoke driver client to create the mounts, all at once. A volume
+  // that is already mounted (or being mounted) for another container
+  // is not mounted again, and its mount point is shared.
+  //
+  // NOTE: The options of a shared volume are the ones it was first
+  // mounted with.
   list<Future<string>> futures;
   foreach (const Mount& mount, mounts) {
-    futures.push_back(this->mount(
-        mount.volume.driver(),
-        mount.volume.name(),
-        mount.options));
+    MountedVolume& mounted = mountedVolumes[mount.volume];
+
+    if (mounted.mountPoint.isNone() ||
+        mounted.mountPoint->isFailed() ||
+        mounted.mountPoint->isDiscarded()) {
+      mounted.mountPoint = this->mount(
+          mount.volume.driver(),
+          mount.volume.name(),
+          mount.options);
+    } else {
+      VLOG(1) << "Reusing the mount of the volume with driver '"
+              << mount.volume.driver() << "' and name '"
+              << mount.volume.name() << "' for container " << containerId;
+    }
+
+    mounted.containers.insert(containerId);
+    futures.push_back(mounted.mountPoint.get());
   }
 
   // NOTE: Wait for all `mount()` to finish before returning to make
@@ -484,6 +592,11 @@ Future<Option<ContainerLaunchInfo>> DockerVolumeIsolatorProcess::_prepare(
     return Failure(strings::join("\n", messages));
   }
 
+  Try<Nothing> checkpoint = checkpointMounts();
+  if (checkpoint.isError()) {
+    LOG(WARNING) << checkpoint.error();
+  }
+
   CHECK_EQ(sources.size(), targets.size());
 
   for (size_t i = 0; i < sources.size(); i++) {
@@ -520,26 +633,26 @@ Future<Nothing> DockerVolumeIsolatorProcess::cleanup(
     return Nothing();
   }
 
-  hashmap<DockerVolume, int> references;
-  foreachvalue (const Owned<Info>& info, infos) {
-    foreach (const DockerVolume& volume, info->volumes) {
-      if (!references.contains(volume)) {
-        references[volume] = 1;
-      } else {
-        references[volume]++;
-      }
-    }
-  }
-
   list<Future<Nothing>> futures;
 
   foreach (const DockerVolume& volume, infos[containerId]->volumes) {
-    if (references.contains(volume) && references[volume] > 1) {
-      VLOG(1) << "Cannot unmount the volume with driver '"
-              << volume.driver() << "' and name '" << volume.name()
-              << "' for container " << containerId
-              << " since its reference count is " << references[volume];
-      continue;
+    // NOTE: If a previous cleanup of this container failed, the
+    // container might already have been removed from the containers
+    // of a volume that other containers still use.
+    if (mountedVolumes.contains(volume)) {
+      MountedVolume& mounted = mountedVolumes.at(volume);
+      mounted.containers.erase(containerId);
+
+      if (!mounted.containers.empty()) {
+        VLOG(1) << "Cannot unmount the volume with driver '"
+                << volume.driver() << "' and name '" << volume.name()
+                << "' for container " << containerId
+                << " since its reference count is "
+                << mounted.containers.size();
+        continue;
+      }
+
+      mountedVolumes.erase(volume);
     }
 
     LOG(INFO) << "Unmounting the volume with driver '"
@@ -589,6 +702,11 @@ Future<Nothing> DockerVolumeIsolatorProcess::_cleanup(
   LOG(INFO) << "Removed the checkpoint directory at '" << containerDir
             << "' for container " << containerId;
 
+  Try<Nothing> checkpoint = checkpointMounts();
+  if (checkpoint.isError()) {
+    LOG(WARNING) << checkpoint.error();
+  }
+
   // Remove all this container's docker volume information from infos.
   infos.erase(containerId);
 
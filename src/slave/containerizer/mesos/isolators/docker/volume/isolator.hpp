@@ -72,6 +72,18 @@ private:
     hashset<DockerVolume> volumes;
   };
 
+  // A docker volume that is mounted on the agent. A volume is only
+  // mounted once, and shared by all the containers that use it.
+  struct MountedVolume
+  {
+    // The mount point returned by the driver, if the volume has been
+    // (or is being) mounted.
+    Option<process::Future<std::string>> mountPoint;
+
+    // The containers that use the volume.
+    hashset<ContainerID> containers;
+  };
+
   DockerVolumeIsolatorProcess(
       const Flags& flags,
       const std::string& rootDir,
@@ -88,6 +100,10 @@ private:
 
   Try<Nothing> _recover(const ContainerID& containerId);
 
+  // Checkpoints the mount points and reference counts of the
+  // `mountedVolumes`.
+  Try<Nothing> checkpointMounts();
+
   process::Future<std::string> mount(
       const std::string& driver,
       const std::string& name,
@@ -112,6 +128,8 @@ private:
 
   hashmap<ContainerID, process::Owned<Info>> infos;
 
+  hashmap<DockerVolume, MountedVolume> mountedVolumes;
+
   // For a given volume, the docker volume isolator might be doing
   // mounting and unmounting simultaneously. The sequence can make
   // sure the order we issue them is the same order they are executed.
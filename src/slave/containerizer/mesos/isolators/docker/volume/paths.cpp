@@ -38,6 +38,12 @@ string getVolumesPath(const string& rootDir, const string& containerId)
   return path::join(getContainerDir(rootDir, containerId), "volumes");
 }
 
+
+string getMountsPath(const string& rootDir)
+{
+  return path::join(rootDir, "mounts");
+}
+
 } // namespace paths {
 } // namespace volume {
 } // namespace docker {
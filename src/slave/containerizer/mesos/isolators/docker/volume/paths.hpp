@@ -45,6 +45,9 @@ std::string getVolumesPath(
     const std::string& rootDir,
     const std::string& containerId);
 
+
+std::string getMountsPath(const std::string& rootDir);
+
 } // namespace paths {
 } // namespace volume {
 } // namespace docker {
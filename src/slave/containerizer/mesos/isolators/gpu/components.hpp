@@ -19,6 +19,7 @@
 
 #ifdef __linux__
 #include "slave/containerizer/mesos/isolators/gpu/allocator.hpp"
+#include "slave/containerizer/mesos/isolators/gpu/sampler.hpp"
 #include "slave/containerizer/mesos/isolators/gpu/volume.hpp"
 #endif
 
@@ -36,12 +37,15 @@ struct NvidiaComponents
 #ifdef __linux__
   NvidiaComponents(
     const NvidiaGpuAllocator& _allocator,
-    const NvidiaVolume& _volume)
+    const NvidiaVolume& _volume,
+    const NvidiaGpuSampler& _sampler)
     : allocator(_allocator),
-      volume(_volume) {}
+      volume(_volume),
+      sampler(_sampler) {}
 
   NvidiaGpuAllocator allocator;
   NvidiaVolume volume;
+  NvidiaGpuSampler sampler;
 #endif
 };
 
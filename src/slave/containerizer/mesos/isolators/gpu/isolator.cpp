@@ -80,12 +80,14 @@ NvidiaGpuIsolatorProcess::NvidiaGpuIsolatorProcess(
     const string& _hierarchy,
     const NvidiaGpuAllocator& _allocator,
     const NvidiaVolume& _volume,
+    const NvidiaGpuSampler& _sampler,
     const map<Path, cgroups::devices::Entry>& _controlDeviceEntries)
   : ProcessBase(process::ID::generate("mesos-nvidia-gpu-isolator")),
     flags(_flags),
     hierarchy(_hierarchy),
     allocator(_allocator),
     volume(_volume),
+    sampler(_sampler),
     controlDeviceEntries(_controlDeviceEntries) {}
 
 
@@ -190,6 +192,7 @@ Try<Isolator*> NvidiaGpuIsolatorProcess::create(
           hierarchy.get(),
           components.allocator,
           components.volume,
+          components.sampler,
           deviceEntries));
 
   return new MesosIsolator(process);
@@ -497,10 +500,57 @@ Future<ResourceStatistics> NvidiaGpuIsolatorProcess::usage(
     return Failure("Unknown container");
   }
 
-  // TODO(rtodd): Obtain usage information from NVML.
+  return sampler.sample(infos[containerId]->allocated)
+    .then([](const map<Gpu, GpuUsage>& usages) {
+      ResourceStatistics result;
 
-  ResourceStatistics result;
-  return result;
+      if (usages.empty()) {
+        return result;
+      }
+
+      // Only report the statistics that could be sampled for all of
+      // the GPUs, since a partial sum would be misleading.
+      Option<double> utilization = 0.0;
+      Option<Bytes> memoryUsed = Bytes(0);
+      Option<Bytes> memoryTotal = Bytes(0);
+      Option<double> power = 0.0;
+
+      foreachvalue (const GpuUsage& usage, usages) {
+        utilization = (utilization.isSome() && usage.utilization.isSome())
+          ? utilization.get() + usage.utilization.get()
+          : Option<double>::none();
+
+        memoryUsed = (memoryUsed.isSome() && usage.memoryUsed.isSome())
+          ? memoryUsed.get() + usage.memoryUsed.get()
+          : Option<Bytes>::none();
+
+        memoryTotal = (memoryTotal.isSome() && usage.memoryTotal.isSome())
+          ? memoryTotal.get() + usage.memoryTotal.get()
+          : Option<Bytes>::none();
+
+        power = (power.isSome() && usage.power.isSome())
+          ? power.get() + usage.power.get()
+          : Option<double>::none();
+      }
+
+      if (utilization.isSome()) {
+        result.set_gpus_utilization(utilization.get());
+      }
+
+      if (memoryUsed.isSome()) {
+        result.set_gpus_memory_used_bytes(memoryUsed->bytes());
+      }
+
+      if (memoryTotal.isSome()) {
+        result.set_gpus_memory_total_bytes(memoryTotal->bytes());
+      }
+
+      if (power.isSome()) {
+        result.set_gpus_power_watts(power.get());
+      }
+
+      return result;
+    });
 }
 
 
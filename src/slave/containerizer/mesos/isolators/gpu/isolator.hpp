@@ -36,6 +36,7 @@
 
 #include "slave/containerizer/mesos/isolators/gpu/allocator.hpp"
 #include "slave/containerizer/mesos/isolators/gpu/components.hpp"
+#include "slave/containerizer/mesos/isolators/gpu/sampler.hpp"
 #include "slave/containerizer/mesos/isolators/gpu/volume.hpp"
 
 namespace mesos {
@@ -110,6 +111,7 @@ private:
       const std::string& hierarchy,
       const NvidiaGpuAllocator& _allocator,
       const NvidiaVolume& _volume,
+      const NvidiaGpuSampler& _sampler,
       const std::map<Path, cgroups::devices::Entry>& _controlDeviceEntries);
 
   virtual process::Future<Option<mesos::slave::ContainerLaunchInfo>> _prepare(
@@ -139,6 +141,7 @@ private:
 
   NvidiaGpuAllocator allocator;
   NvidiaVolume volume;
+  NvidiaGpuSampler sampler;
 
   const std::map<Path, cgroups::devices::Entry> controlDeviceEntries;
 };
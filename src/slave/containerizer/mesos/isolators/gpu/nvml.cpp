@@ -55,17 +55,27 @@ struct NvidiaManagementLibrary
       nvmlReturn_t (*_deviceGetCount)(unsigned int*),
       nvmlReturn_t (*_deviceGetHandleByIndex)(unsigned int, nvmlDevice_t*),
       nvmlReturn_t (*_deviceGetMinorNumber)(nvmlDevice_t, unsigned int*),
+      nvmlReturn_t (*_deviceGetUtilizationRates)(
+          nvmlDevice_t, nvmlUtilization_t*),
+      nvmlReturn_t (*_deviceGetMemoryInfo)(nvmlDevice_t, nvmlMemory_t*),
+      nvmlReturn_t (*_deviceGetPowerUsage)(nvmlDevice_t, unsigned int*),
       const char* (*_errorString)(nvmlReturn_t))
     : systemGetDriverVersion(_systemGetDriverVersion),
       deviceGetCount(_deviceGetCount),
       deviceGetHandleByIndex(_deviceGetHandleByIndex),
       deviceGetMinorNumber(_deviceGetMinorNumber),
+      deviceGetUtilizationRates(_deviceGetUtilizationRates),
+      deviceGetMemoryInfo(_deviceGetMemoryInfo),
+      deviceGetPowerUsage(_deviceGetPowerUsage),
       errorString(_errorString) {}
 
   nvmlReturn_t (*systemGetDriverVersion)(char *, unsigned int);
   nvmlReturn_t (*deviceGetCount)(unsigned int*);
   nvmlReturn_t (*deviceGetHandleByIndex)(unsigned int, nvmlDevice_t*);
   nvmlReturn_t (*deviceGetMinorNumber)(nvmlDevice_t, unsigned int*);
+  nvmlReturn_t (*deviceGetUtilizationRates)(nvmlDevice_t, nvmlUtilization_t*);
+  nvmlReturn_t (*deviceGetMemoryInfo)(nvmlDevice_t, nvmlMemory_t*);
+  nvmlReturn_t (*deviceGetPowerUsage)(nvmlDevice_t, unsigned int*);
   const char* (*errorString)(nvmlReturn_t);
 };
 
@@ -107,6 +117,9 @@ Try<Nothing> initialize()
       { "nvmlDeviceGetCount", nullptr },
       { "nvmlDeviceGetHandleByIndex", nullptr },
       { "nvmlDeviceGetMinorNumber", nullptr },
+      { "nvmlDeviceGetUtilizationRates", nullptr },
+      { "nvmlDeviceGetMemoryInfo", nullptr },
+      { "nvmlDeviceGetPowerUsage", nullptr },
       { "nvmlErrorString", nullptr },
   };
 
@@ -142,6 +155,12 @@ Try<Nothing> initialize()
           symbols.at("nvmlDeviceGetHandleByIndex"),
       (nvmlReturn_t (*)(nvmlDevice_t, unsigned int*))
           symbols.at("nvmlDeviceGetMinorNumber"),
+      (nvmlReturn_t (*)(nvmlDevice_t, nvmlUtilization_t*))
+          symbols.at("nvmlDeviceGetUtilizationRates"),
+      (nvmlReturn_t (*)(nvmlDevice_t, nvmlMemory_t*))
+          symbols.at("nvmlDeviceGetMemoryInfo"),
+      (nvmlReturn_t (*)(nvmlDevice_t, unsigned int*))
+          symbols.at("nvmlDeviceGetPowerUsage"),
       (const char* (*)(nvmlReturn_t))
           symbols.at("nvmlErrorString"));
 
@@ -246,4 +265,49 @@ Try<unsigned int> deviceGetMinorNumber(nvmlDevice_t handle)
   return minor;
 }
 
+
+Try<nvmlUtilization_t> deviceGetUtilizationRates(nvmlDevice_t handle)
+{
+  if (nvml == nullptr) {
+    return Error("NVML has not been initialized");
+  }
+
+  nvmlUtilization_t utilization;
+  nvmlReturn_t result = nvml->deviceGetUtilizationRates(handle, &utilization);
+  if (result != NVML_SUCCESS) {
+    return Error(nvml->errorString(result));
+  }
+  return utilization;
+}
+
+
+Try<nvmlMemory_t> deviceGetMemoryInfo(nvmlDevice_t handle)
+{
+  if (nvml == nullptr) {
+    return Error("NVML has not been initialized");
+  }
+
+  nvmlMemory_t memory;
+  nvmlReturn_t result = nvml->deviceGetMemoryInfo(handle, &memory);
+  if (result != NVML_SUCCESS) {
+    return Error(nvml->errorString(result));
+  }
+  return memory;
+}
+
+
+Try<unsigned int> deviceGetPowerUsage(nvmlDevice_t handle)
+{
+  if (nvml == nullptr) {
+    return Error("NVML has not been initialized");
+  }
+
+  unsigned int power;
+  nvmlReturn_t result = nvml->deviceGetPowerUsage(handle, &power);
+  if (result != NVML_SUCCESS) {
+    return Error(nvml->errorString(result));
+  }
+  return power;
+}
+
 } // namespace nvml {
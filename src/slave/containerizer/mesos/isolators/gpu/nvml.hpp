@@ -51,6 +51,11 @@ Try<std::string> systemGetDriverVersion();
 Try<unsigned int> deviceGetCount();
 Try<nvmlDevice_t> deviceGetHandleByIndex(unsigned int index);
 Try<unsigned int> deviceGetMinorNumber(nvmlDevice_t handle);
+Try<nvmlUtilization_t> deviceGetUtilizationRates(nvmlDevice_t handle);
+Try<nvmlMemory_t> deviceGetMemoryInfo(nvmlDevice_t handle);
+
+// Returns the power draw in milliwatts.
+Try<unsigned int> deviceGetPowerUsage(nvmlDevice_t handle);
 
 } // namespace nvml {
 
@@ -0,0 +1,194 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <map>
+#include <set>
+#include <string>
+
+#include <glog/logging.h>
+
+#include <process/clock.hpp>
+#include <process/dispatch.hpp>
+#include <process/future.hpp>
+#include <process/process.hpp>
+
+#include <stout/foreach.hpp>
+#include <stout/nothing.hpp>
+#include <stout/option.hpp>
+#include <stout/try.hpp>
+
+#include "slave/containerizer/mesos/isolators/gpu/nvml.hpp"
+#include "slave/containerizer/mesos/isolators/gpu/sampler.hpp"
+
+using process::Clock;
+using process::Future;
+using process::PID;
+using process::Time;
+
+using std::map;
+using std::set;
+using std::string;
+
+namespace mesos {
+namespace internal {
+namespace slave {
+
+namespace {
+
+GpuUsage sampleGpu(const Gpu& gpu, nvmlDevice_t handle)
+{
+  GpuUsage usage;
+
+  Try<nvmlUtilization_t> utilization = nvml::deviceGetUtilizationRates(handle);
+  if (utilization.isSome()) {
+    usage.utilization = utilization->gpu / 100.0;
+  } else {
+    VLOG(1) << "Failed to sample the utilization of GPU " << gpu << ": "
+            << utilization.error();
+  }
+
+  Try<nvmlMemory_t> memory = nvml::deviceGetMemoryInfo(handle);
+  if (memory.isSome()) {
+    usage.memoryUsed = Bytes(memory->used);
+    usage.memoryTotal = Bytes(memory->total);
+  } else {
+    VLOG(1) << "Failed to sample the memory of GPU " << gpu << ": "
+            << memory.error();
+  }
+
+  Try<unsigned int> power = nvml::deviceGetPowerUsage(handle);
+  if (power.isSome()) {
+    usage.power = power.get() / 1000.0;
+  } else {
+    VLOG(1) << "Failed to sample the power of GPU " << gpu << ": "
+            << power.error();
+  }
+
+  return usage;
+}
+
+
+class NvidiaGpuSamplerProcess
+  : public process::Process<NvidiaGpuSamplerProcess>
+{
+public:
+  NvidiaGpuSamplerProcess(const map<Gpu, nvmlDevice_t>& _handles)
+    : handles(_handles) {}
+
+  Future<map<Gpu, GpuUsage>> sample(const set<Gpu>& gpus)
+  {
+    // Sample all of the GPUs at once, so that each of them is sampled
+    // at most once per interval regardless of the callers.
+    if (sampled.isNone() ||
+        Clock::now() - sampled.get() >= NVIDIA_GPU_SAMPLE_INTERVAL) {
+      samples.clear();
+
+      foreachkey (const Gpu& gpu, handles) {
+        samples[gpu] = sampleGpu(gpu, handles.at(gpu));
+      }
+
+      sampled = Clock::now();
+    }
+
+    map<Gpu, GpuUsage> result;
+
+    foreach (const Gpu& gpu, gpus) {
+      if (samples.count(gpu) > 0) {
+        result[gpu] = samples.at(gpu);
+      }
+    }
+
+    return result;
+  }
+
+private:
+  const map<Gpu, nvmlDevice_t> handles;
+
+  map<Gpu, GpuUsage> samples;
+  Option<Time> sampled;
+};
+
+} // namespace {
+
+
+struct NvidiaGpuSampler::Data
+{
+  Data(const map<Gpu, nvmlDevice_t>& handles)
+    : process(process::spawn(new NvidiaGpuSamplerProcess(handles), true)) {}
+
+  ~Data()
+  {
+    process::terminate(process);
+  }
+
+  PID<NvidiaGpuSamplerProcess> process;
+};
+
+
+Try<NvidiaGpuSampler> NvidiaGpuSampler::create(const set<Gpu>& gpus)
+{
+  Try<Nothing> initialized = nvml::initialize();
+  if (initialized.isError()) {
+    return Error(initialized.error());
+  }
+
+  Try<unsigned int> count = nvml::deviceGetCount();
+  if (count.isError()) {
+    return Error(count.error());
+  }
+
+  // Find the NVML handles of the GPUs by their minor numbers, which
+  // is how the GPUs are enumerated by the allocator.
+  map<Gpu, nvmlDevice_t> handles;
+
+  for (unsigned int i = 0; i < count.get(); i++) {
+    Try<nvmlDevice_t> handle = nvml::deviceGetHandleByIndex(i);
+    if (handle.isError()) {
+      return Error(handle.error());
+    }
+
+    Try<unsigned int> minor = nvml::deviceGetMinorNumber(handle.get());
+    if (minor.isError()) {
+      return Error(minor.error());
+    }
+
+    foreach (const Gpu& gpu, gpus) {
+      if (gpu.minor == minor.get()) {
+        handles[gpu] = handle.get();
+      }
+    }
+  }
+
+  return NvidiaGpuSampler(std::make_shared<Data>(handles));
+}
+
+
+NvidiaGpuSampler::NvidiaGpuSampler(const std::shared_ptr<Data>& _data)
+  : data(_data) {}
+
+
+Future<map<Gpu, GpuUsage>> NvidiaGpuSampler::sample(const set<Gpu>& gpus)
+{
+  return process::dispatch(
+      data->process,
+      &NvidiaGpuSamplerProcess::sample,
+      gpus);
+}
+
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
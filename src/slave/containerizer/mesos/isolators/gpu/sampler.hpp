@@ -0,0 +1,87 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef __NVIDIA_GPU_SAMPLER_HPP__
+#define __NVIDIA_GPU_SAMPLER_HPP__
+
+#include <map>
+#include <memory>
+#include <set>
+
+#include <process/future.hpp>
+
+#include <stout/bytes.hpp>
+#include <stout/duration.hpp>
+#include <stout/option.hpp>
+#include <stout/try.hpp>
+
+#include "slave/containerizer/mesos/isolators/gpu/allocator.hpp"
+
+namespace mesos {
+namespace internal {
+namespace slave {
+
+// The GPUs are sampled at most once per interval, no matter how many
+// callers ask for their usage.
+const Duration NVIDIA_GPU_SAMPLE_INTERVAL = Seconds(1);
+
+
+// The usage of a GPU. Any statistic that could not be sampled, e.g.,
+// because it is not supported by the GPU, is none.
+struct GpuUsage
+{
+  // The fraction of the sample period of NVML (between 1/6 second and
+  // 1 second depending on the GPU) during which a kernel was executing
+  // on the GPU.
+  Option<double> utilization;
+
+  Option<Bytes> memoryUsed;
+  Option<Bytes> memoryTotal;
+
+  // In watts.
+  Option<double> power;
+};
+
+
+// Samples the usage of GPU devices from NVML. This can be shared
+// across components (e.g. containerizers) so that each GPU is only
+// sampled once per `NVIDIA_GPU_SAMPLE_INTERVAL`; the samples are
+// cached for any caller in between.
+class NvidiaGpuSampler
+{
+public:
+  NvidiaGpuSampler() = delete;
+
+  static Try<NvidiaGpuSampler> create(const std::set<Gpu>& gpus);
+
+  // Returns the usage of those of the GPUs that could be sampled.
+  process::Future<std::map<Gpu, GpuUsage>> sample(const std::set<Gpu>& gpus);
+
+private:
+  // Forward declaration.
+  struct Data;
+
+  NvidiaGpuSampler(const std::shared_ptr<Data>& data);
+
+  std::shared_ptr<Data> data;
+};
+
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __NVIDIA_GPU_SAMPLER_HPP__
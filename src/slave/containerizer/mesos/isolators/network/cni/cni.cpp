@@ -14,6 +14,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <sys/inotify.h>
+
 #include <iostream>
 #include <list>
 #include <set>
@@ -330,6 +332,111 @@ Try<hashmap<string, string>> NetworkCniIsolatorProcess::loadNetworkConfigs(
 }
 
 
+void NetworkCniIsolatorProcess::initialize()
+{
+  // The network configurations are only loaded if the directory has
+  // been specified, see `create()`.
+  if (flags.network_cni_config_dir.isNone()) {
+    return;
+  }
+
+  // NOTE: Without the watch we just don't cache the parsed network
+  // configurations, i.e., they are read on every use as before.
+  int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (fd == -1) {
+    LOG(WARNING) << "Failed to initialize inotify, not caching CNI network "
+                 << "configurations: " << os::strerror(errno);
+    return;
+  }
+
+  int wd = inotify_add_watch(
+      fd,
+      flags.network_cni_config_dir->c_str(),
+      IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB |
+      IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF);
+
+  if (wd == -1) {
+    LOG(WARNING) << "Failed to watch the CNI network configuration directory '"
+                 << flags.network_cni_config_dir.get() << "', not caching "
+                 << "CNI network configurations: " << os::strerror(errno);
+    os::close(fd);
+    return;
+  }
+
+  inotify = fd;
+
+  watch();
+}
+
+
+void NetworkCniIsolatorProcess::finalize()
+{
+  if (inotify.isSome()) {
+    watching.discard();
+    os::close(inotify.get());
+    inotify = None();
+  }
+}
+
+
+void NetworkCniIsolatorProcess::watch()
+{
+  CHECK_SOME(inotify);
+
+  watching = io::poll(inotify.get(), io::READ);
+
+  watching
+    .onAny(defer(self(), [this](const Future<short>& poll) {
+      if (inotify.isNone()) {
+        return;
+      }
+
+      if (!poll.isReady()) {
+        LOG(ERROR) << "Failed to wait for changes of the CNI network "
+                   << "configuration directory, not caching CNI network "
+                   << "configurations anymore: "
+                   << (poll.isFailed() ? poll.failure() : "discarded");
+
+        networkConfigJSONs.clear();
+        os::close(inotify.get());
+        inotify = None();
+        return;
+      }
+
+      invalidate();
+      watch();
+    }));
+}
+
+
+void NetworkCniIsolatorProcess::invalidate()
+{
+  if (inotify.isNone()) {
+    return;
+  }
+
+  bool changed = false;
+
+  char buffer[4096]
+    __attribute__((aligned(__alignof__(struct inotify_event))));
+
+  // NOTE: We don't need to look at the events themselves since any
+  // change of the directory could affect any of the networks (e.g.,
+  // a file that got renamed to configure another network).
+  while (::read(inotify.get(), buffer, sizeof(buffer)) > 0) {
+    changed = true;
+  }
+
+  if (changed && !networkConfigJSONs.empty()) {
+    VLOG(1) << "Dropping the cached CNI network configurations since the "
+            << "configuration directory '"
+            << flags.network_cni_config_dir.get() << "' changed";
+
+    networkConfigJSONs.clear();
+  }
+}
+
+
 bool NetworkCniIsolatorProcess::supportsNesting()
 {
   return true;
@@ -1689,6 +1796,14 @@ Try<JSON::Object> NetworkCniIsolatorProcess::getNetworkConfigJSON(
 Try<JSON::Object> NetworkCniIsolatorProcess::getNetworkConfigJSON(
     const string& network)
 {
+  // Apply the pending changes of the configuration directory first,
+  // so that we never use a configuration known to be outdated.
+  invalidate();
+
+  if (networkConfigJSONs.contains(network)) {
+    return networkConfigJSONs[network];
+  }
+
   if (networkConfigs.contains(network)) {
     // Make sure the JSON is valid.
     Try<JSON::Object> config = getNetworkConfigJSON(
@@ -1704,6 +1819,10 @@ Try<JSON::Object> NetworkCniIsolatorProcess::getNetworkConfigJSON(
 
       // Fall-through and do a reload.
     } else {
+      if (inotify.isSome()) {
+        networkConfigJSONs[network] = config.get();
+      }
+
       return config;
     }
   }
@@ -1729,7 +1848,14 @@ Try<JSON::Object> NetworkCniIsolatorProcess::getNetworkConfigJSON(
     // trying to erase the network from cache. Deletion of the
     // network, in case of an error, will happen on its own in the
     // next attempt.
-    return getNetworkConfigJSON(network, networkConfigs[network]);
+    Try<JSON::Object> config =
+      getNetworkConfigJSON(network, networkConfigs[network]);
+
+    if (config.isSome() && inotify.isSome()) {
+      networkConfigJSONs[network] = config.get();
+    }
+
+    return config;
   }
 
   return Error("Unknown CNI network '" + network + "'");
@@ -71,6 +71,10 @@ public:
   virtual process::Future<Nothing> cleanup(
       const ContainerID& containerId);
 
+protected:
+  virtual void initialize();
+  virtual void finalize();
+
 private:
   struct ContainerNetwork
   {
@@ -180,9 +184,18 @@ private:
   // hashmap doesn't contain the network, will try to load all the CNI
   // configs from `flags.network_cni_config_dir`, and will then
   // perform another search of the `networkConfigs` hashmap to see if
-  // the missing network was present on disk.
+  // the missing network was present on disk. The parsed configuration
+  // is cached until the configuration directory changes.
   Try<JSON::Object> getNetworkConfigJSON(const std::string& network);
 
+  // Waits for changes of the CNI network configuration directory.
+  void watch();
+
+  // Drops the cached network configurations if the configuration
+  // directory changed since they got parsed, i.e., if there are any
+  // pending inotify events.
+  void invalidate();
+
   // Given a network name and the path for the CNI network
   // configuration file, reads the file, parses the JSON and
   // validates the name of the network to which this configuration
@@ -197,6 +210,19 @@ private:
   // on the network name.
   hashmap<std::string, std::string> networkConfigs;
 
+  // The parsed CNI network configurations keyed on the network name.
+  // These are only cached while the configuration directory is
+  // watched, see `inotify`.
+  hashmap<std::string, JSON::Object> networkConfigJSONs;
+
+  // The inotify file descriptor watching the CNI network
+  // configuration directory, which becomes readable once any of the
+  // configuration files got created, modified, moved or removed.
+  Option<int> inotify;
+
+  // The pending wait for changes of the configuration directory.
+  process::Future<short> watching;
+
   // CNI network information root directory.
   const Option<std::string> rootDir;
 
@@ -18,6 +18,8 @@
 #include <string.h>
 #include <unistd.h>
 
+#include <linux/pkt_cls.h>
+
 #include <iostream>
 #include <vector>
 
@@ -55,6 +57,7 @@
 
 #include "common/status_utils.hpp"
 
+#include "linux/ebpf.hpp"
 #include "linux/fs.hpp"
 #include "linux/ns.hpp"
 
@@ -64,6 +67,7 @@
 #include "linux/routing/diagnosis/diagnosis.hpp"
 
 #include "linux/routing/filter/basic.hpp"
+#include "linux/routing/filter/bpf.hpp"
 #include "linux/routing/filter/icmp.hpp"
 #include "linux/routing/filter/ip.hpp"
 
@@ -228,6 +232,17 @@ static const uint16_t ICMP_FLOWID = 2;
 static const uint16_t CONTAINER_MIN_FLOWID = 3;
 
 
+// The names of the BPF classifiers on host eth0 and host lo, which
+// show up in 'tc filter show'.
+static const char ETH0_CLASSIFIER_NAME[] = "mesos-port-mapping-eth0";
+static const char LO_CLASSIFIER_NAME[] = "mesos-port-mapping-lo";
+
+
+// The number of entries of the BPF map of the BPF classifier, i.e.,
+// one for each port.
+static const uint32_t CLASSIFIER_PORTS = 65536;
+
+
 // The well known ports. Used for sanity check.
 static Interval<uint16_t> WELL_KNOWN_PORTS()
 {
@@ -462,6 +477,114 @@ static Try<vector<PortRange>> parse(const JSON::Object& object)
 
 // Helper function to set up IP filters inside the container for a
 // given port range.
+// Returns the eBPF program of the BPF classifier that redirects an
+// IP packet to the veth its destination port is mapped to in the BPF
+// map 'ports' (if any). Like the u32 IP filters (see
+// 'linux/routing/filter/ip.cpp'), it only looks at IP packets that
+// do not contain IP options, and the packet also needs to have the
+// given destination MAC address and destination IP (if any). Any
+// other packet is left to the remaining filters.
+static Try<ebpf::Program> classifier(
+    int ports,
+    const Option<net::MAC>& destinationMAC,
+    const Option<net::IP>& destinationIP)
+{
+  // The offsets of the fields of a packet we look at. Note that the
+  // packet starts with the ethernet header.
+  const int32_t ETHERNET_TYPE = 12;
+  const int32_t IP_HEADER = 14;
+  const int32_t IP_DESTINATION = IP_HEADER + 16;
+  const int32_t DESTINATION_PORT = IP_HEADER + 22;
+
+  ebpf::Program program;
+
+  // The jumps to the end of the program, where we leave the packet
+  // to the remaining filters. Their offsets are set at the end.
+  vector<size_t> passes;
+
+  auto pass = [&](uint8_t op, uint8_t reg, int32_t imm) {
+    passes.push_back(program.size());
+    program.push_back(ebpf::jumpImm(op, reg, imm, 0));
+  };
+
+  // NOTE: A loaded word is zero extended but the immediate of a jump
+  // is sign extended, so we compare words through a register.
+  auto passUnlessWord = [&](uint32_t word) {
+    program.push_back(ebpf::mov32Imm(BPF_REG_2, word));
+    passes.push_back(program.size());
+    program.push_back(ebpf::jump(BPF_JNE, BPF_REG_0, BPF_REG_2, 0));
+  };
+
+  // Loading from the packet requires the context in r6.
+  program.push_back(ebpf::mov64(BPF_REG_6, BPF_REG_1));
+
+  program.push_back(ebpf::loadAbsolute(BPF_H, ETHERNET_TYPE));
+  pass(BPF_JNE, BPF_REG_0, ETH_P_IP);
+
+  if (destinationMAC.isSome()) {
+    const net::MAC& mac = destinationMAC.get();
+
+    program.push_back(ebpf::loadAbsolute(BPF_W, 0));
+    passUnlessWord(
+        (((uint32_t) mac[0]) << 24) +
+        (((uint32_t) mac[1]) << 16) +
+        (((uint32_t) mac[2]) << 8) +
+        ((uint32_t) mac[3]));
+
+    program.push_back(ebpf::loadAbsolute(BPF_H, 4));
+    pass(BPF_JNE, BPF_REG_0, (((int32_t) mac[4]) << 8) + mac[5]);
+  }
+
+  // Only look at IP packets with a header length of 5 words.
+  program.push_back(ebpf::loadAbsolute(BPF_B, IP_HEADER));
+  program.push_back(ebpf::alu64Imm(BPF_AND, BPF_REG_0, 0x0f));
+  pass(BPF_JNE, BPF_REG_0, 5);
+
+  if (destinationIP.isSome()) {
+    Try<struct in_addr> in = destinationIP->in();
+    if (in.isError()) {
+      return Error(in.error());
+    }
+
+    program.push_back(ebpf::loadAbsolute(BPF_W, IP_DESTINATION));
+    passUnlessWord(ntohl(in->s_addr));
+  }
+
+  // Look up the destination port (stored on the stack) in the map.
+  program.push_back(ebpf::loadAbsolute(BPF_H, DESTINATION_PORT));
+  program.push_back(ebpf::storeMemory(BPF_W, BPF_REG_10, BPF_REG_0, -4));
+
+  const ebpf::Program map = ebpf::loadMap(BPF_REG_1, ports);
+  program.insert(program.end(), map.begin(), map.end());
+
+  program.push_back(ebpf::mov64(BPF_REG_2, BPF_REG_10));
+  program.push_back(ebpf::alu64Imm(BPF_ADD, BPF_REG_2, -4));
+  program.push_back(ebpf::call(BPF_FUNC_map_lookup_elem));
+  pass(BPF_JEQ, BPF_REG_0, 0);
+
+  // The port is not allocated to any container if the index of the
+  // veth is 0.
+  program.push_back(ebpf::loadMemory(BPF_W, BPF_REG_1, BPF_REG_0, 0));
+  pass(BPF_JEQ, BPF_REG_1, 0);
+
+  // Redirect the packet to the egress of the veth, just like the
+  // 'mirred' action of the u32 IP filters. This returns
+  // TC_ACT_REDIRECT, which is the action taken on the packet.
+  program.push_back(ebpf::mov64Imm(BPF_REG_2, 0));
+  program.push_back(ebpf::call(BPF_FUNC_redirect));
+  program.push_back(ebpf::exitProgram());
+
+  foreach (size_t index, passes) {
+    program[index].off = program.size() - (index + 1);
+  }
+
+  program.push_back(ebpf::mov64Imm(BPF_REG_0, TC_ACT_UNSPEC));
+  program.push_back(ebpf::exitProgram());
+
+  return program;
+}
+
+
 static Try<Nothing> addContainerIPFilters(
     const PortRange& range,
     const string& eth0,
@@ -1295,7 +1418,9 @@ PortMappingIsolatorProcess::Metrics::Metrics()
     updating_eth0_arp_filters_do_not_exist(
         "port_mapping/updating_eth0_arp_filters_do_not_exist"),
     updating_container_ip_filters_errors(
-        "port_mapping/updating_container_ip_filters_errors")
+        "port_mapping/updating_container_ip_filters_errors"),
+    updating_bpf_classifier_errors(
+        "port_mapping/updating_bpf_classifier_errors")
 {
   process::metrics::add(adding_eth0_ip_filters_errors);
   process::metrics::add(adding_eth0_ip_filters_already_exist);
@@ -1328,6 +1453,7 @@ PortMappingIsolatorProcess::Metrics::Metrics()
   process::metrics::add(updating_eth0_arp_filters_already_exist);
   process::metrics::add(updating_eth0_arp_filters_do_not_exist);
   process::metrics::add(updating_container_ip_filters_errors);
+  process::metrics::add(updating_bpf_classifier_errors);
 }
 
 
@@ -1364,6 +1490,7 @@ PortMappingIsolatorProcess::Metrics::~Metrics()
   process::metrics::remove(updating_eth0_arp_filters_already_exist);
   process::metrics::remove(updating_eth0_arp_filters_do_not_exist);
   process::metrics::remove(updating_container_ip_filters_errors);
+  process::metrics::remove(updating_bpf_classifier_errors);
 }
 
 
@@ -1994,6 +2121,33 @@ Try<Isolator*> PortMappingIsolatorProcess::create(const Flags& flags)
         PORT_MAPPING_BIND_MOUNT_SYMLINK_ROOT() + ": " + mkdir.error());
   }
 
+  // Create the BPF map of the BPF classifier. The BPF classifier
+  // itself is attached to host eth0 and host lo during recovery, once
+  // the map has been populated with the ports of the recovered
+  // containers.
+  Option<int> classifierPorts;
+  if (flags.network_enable_bpf_classifier) {
+    if (!ebpf::supported()) {
+      return Error(
+          "The BPF classifier requires the bpf system call, "
+          "make sure your kernel is newer than 4.4");
+    }
+
+    Try<int> ports = ebpf::createMap(
+        BPF_MAP_TYPE_ARRAY,
+        sizeof(uint32_t),
+        sizeof(uint32_t),
+        CLASSIFIER_PORTS);
+
+    if (ports.isError()) {
+      return Error(
+          "Failed to create the BPF map for the BPF classifier: " +
+          ports.error());
+    }
+
+    classifierPorts = ports.get();
+  }
+
   return new MesosIsolator(Owned<MesosIsolatorProcess>(
       new PortMappingIsolatorProcess(
           flags,
@@ -2009,7 +2163,18 @@ Try<Isolator*> PortMappingIsolatorProcess::create(const Flags& flags)
           egressRateLimitPerContainer,
           nonEphemeralPorts,
           ephemeralPortsAllocator,
-          freeFlowIds)));
+          freeFlowIds,
+          classifierPorts)));
+}
+
+
+PortMappingIsolatorProcess::~PortMappingIsolatorProcess()
+{
+  // NOTE: The BPF classifier keeps the BPF map alive after it is
+  // closed here (e.g., while the agent restarts).
+  if (classifierPorts.isSome()) {
+    os::close(classifierPorts.get());
+  }
 }
 
 
@@ -2263,6 +2428,137 @@ Future<Nothing> PortMappingIsolatorProcess::recover(
     unknownOrphans.push_back(recover.get());
   }
 
+  if (classifierPorts.isSome()) {
+    // Populate the BPF map with the ports of the recovered containers
+    // before replacing the BPF classifier of the previous run (if
+    // any), so that no packets to the containers are missed.
+    vector<Info*> recovered = unknownOrphans;
+    foreachvalue (Info* info, infos) {
+      recovered.push_back(info);
+    }
+
+    foreach (Info* info, recovered) {
+      CHECK_SOME(info->pid);
+
+      IntervalSet<uint16_t> ports = info->nonEphemeralPorts;
+      ports += info->ephemeralPorts;
+
+      foreach (const PortRange& range, getPortRanges(ports)) {
+        Try<Nothing> classify = this->classify(range, veth(info->pid.get()));
+        if (classify.isError()) {
+          foreachvalue (Info* info, infos) {
+            delete info;
+          }
+          foreach (Info* info, unknownOrphans) {
+            delete info;
+          }
+
+          return Failure(
+              "Failed to recover the BPF classifier: " + classify.error());
+        }
+      }
+    }
+
+    Try<Nothing> attach = attachClassifier();
+    if (attach.isError()) {
+      foreachvalue (Info* info, infos) {
+        delete info;
+      }
+      foreach (Info* info, unknownOrphans) {
+        delete info;
+      }
+
+      return Failure("Failed to attach the BPF classifier: " + attach.error());
+    }
+
+    // Remove the u32 IP filters on host eth0 and host lo of the
+    // containers that were launched without the BPF classifier.
+    foreach (Info* info, recovered) {
+      IntervalSet<uint16_t> ports = info->nonEphemeralPorts;
+      ports += info->ephemeralPorts;
+
+      foreach (const PortRange& range, getPortRanges(ports)) {
+        Try<bool> hostEth0ToVeth = filter::ip::remove(
+            eth0,
+            ingress::HANDLE,
+            ip::Classifier(hostMAC, hostIPNetwork.address(), None(), range));
+
+        if (hostEth0ToVeth.isError()) {
+          LOG(WARNING) << "Failed to remove the IP packet filter from host "
+                       << eth0 << " for " << range << ": "
+                       << hostEth0ToVeth.error();
+        }
+
+        Try<bool> hostLoToVeth = filter::ip::remove(
+            lo,
+            ingress::HANDLE,
+            ip::Classifier(None(), None(), None(), range));
+
+        if (hostLoToVeth.isError()) {
+          LOG(WARNING) << "Failed to remove the IP packet filter from host "
+                       << lo << " for " << range << ": "
+                       << hostLoToVeth.error();
+        }
+      }
+    }
+  } else {
+    // The containers launched with the BPF classifier do not have u32
+    // IP filters on host eth0 and host lo, so the BPF classifier can
+    // only be removed once there are no such containers.
+    const vector<string> links = {eth0, lo};
+
+    foreach (const string& link, links) {
+      Try<bool> exists = filter::bpf::exists(
+          link,
+          ingress::HANDLE,
+          Priority(IP_FILTER_PRIORITY, HIGH));
+
+      if (exists.isError()) {
+        foreachvalue (Info* info, infos) {
+          delete info;
+        }
+        foreach (Info* info, unknownOrphans) {
+          delete info;
+        }
+
+        return Failure(
+            "Failed to check the existence of the BPF classifier on " +
+            link + ": " + exists.error());
+      } else if (!exists.get()) {
+        continue;
+      }
+
+      if (!infos.empty()) {
+        foreachvalue (Info* info, infos) {
+          delete info;
+        }
+        foreach (Info* info, unknownOrphans) {
+          delete info;
+        }
+
+        return Failure(
+            "The BPF classifier is attached to " + link + ": the flag "
+            "--network_enable_bpf_classifier cannot be disabled while "
+            "containers launched with it are running");
+      }
+
+      Try<bool> remove = filter::bpf::remove(
+          link,
+          ingress::HANDLE,
+          Priority(IP_FILTER_PRIORITY, HIGH));
+
+      if (remove.isError()) {
+        foreach (Info* info, unknownOrphans) {
+          delete info;
+        }
+
+        return Failure(
+            "Failed to remove the BPF classifier from " + link +
+            ": " + remove.error());
+      }
+    }
+  }
+
   foreach (Info* info, unknownOrphans) {
     CHECK_SOME(info->pid);
     pid_t pid = info->pid.get();
@@ -3683,53 +3979,64 @@ Try<Nothing> PortMappingIsolatorProcess::addHostIPFilters(
         veth + " to host " + lo + " already exists");
   }
 
-  // Add an IP packet filter from host eth0 to veth of the container
-  // such that any incoming IP packet will be properly redirected to
-  // the corresponding container based on its destination port.
-  Try<bool> hostEth0ToVeth = filter::ip::create(
-      eth0,
-      ingress::HANDLE,
-      ip::Classifier(hostMAC, hostIPNetwork.address(), None(), range),
-      Priority(IP_FILTER_PRIORITY, NORMAL),
-      action::Redirect(veth));
+  if (classifierPorts.isSome()) {
+    // Let the BPF classifier redirect the incoming IP packets on host
+    // eth0 and host lo to veth of the container.
+    Try<Nothing> classify = this->classify(range, veth);
+    if (classify.isError()) {
+      return Error(
+          "Failed to add " + stringify(range) + " to the BPF classifier: " +
+          classify.error());
+    }
+  } else {
+    // Add an IP packet filter from host eth0 to veth of the container
+    // such that any incoming IP packet will be properly redirected to
+    // the corresponding container based on its destination port.
+    Try<bool> hostEth0ToVeth = filter::ip::create(
+        eth0,
+        ingress::HANDLE,
+        ip::Classifier(hostMAC, hostIPNetwork.address(), None(), range),
+        Priority(IP_FILTER_PRIORITY, NORMAL),
+        action::Redirect(veth));
 
-  if (hostEth0ToVeth.isError()) {
-    ++metrics.adding_eth0_ip_filters_errors;
+    if (hostEth0ToVeth.isError()) {
+      ++metrics.adding_eth0_ip_filters_errors;
 
-    return Error(
-        "Failed to create an IP packet filter from host " +
-        eth0 + " to " + veth + ": " + hostEth0ToVeth.error());
-  } else if (!hostEth0ToVeth.get()) {
-    ++metrics.adding_eth0_ip_filters_already_exist;
+      return Error(
+          "Failed to create an IP packet filter from host " +
+          eth0 + " to " + veth + ": " + hostEth0ToVeth.error());
+    } else if (!hostEth0ToVeth.get()) {
+      ++metrics.adding_eth0_ip_filters_already_exist;
 
-    return Error(
-        "The IP packet filter from host " + eth0 + " to " +
-        veth + " already exists");
-  }
+      return Error(
+          "The IP packet filter from host " + eth0 + " to " +
+          veth + " already exists");
+    }
 
-  // Add an IP packet filter from host lo to veth of the container
-  // such that any internally generated IP packet will be properly
-  // redirected to the corresponding container based on its
-  // destination port.
-  Try<bool> hostLoToVeth = filter::ip::create(
-      lo,
-      ingress::HANDLE,
-      ip::Classifier(None(), None(), None(), range),
-      Priority(IP_FILTER_PRIORITY, NORMAL),
-      action::Redirect(veth));
+    // Add an IP packet filter from host lo to veth of the container
+    // such that any internally generated IP packet will be properly
+    // redirected to the corresponding container based on its
+    // destination port.
+    Try<bool> hostLoToVeth = filter::ip::create(
+        lo,
+        ingress::HANDLE,
+        ip::Classifier(None(), None(), None(), range),
+        Priority(IP_FILTER_PRIORITY, NORMAL),
+        action::Redirect(veth));
 
-  if (hostLoToVeth.isError()) {
-    ++metrics.adding_lo_ip_filters_errors;
+    if (hostLoToVeth.isError()) {
+      ++metrics.adding_lo_ip_filters_errors;
 
-    return Error(
-        "Failed to create an IP packet filter from host " +
-        lo + " to " + veth + ": " + hostLoToVeth.error());
-  } else if (!hostLoToVeth.get()) {
-    ++metrics.adding_lo_ip_filters_already_exist;
+      return Error(
+          "Failed to create an IP packet filter from host " +
+          lo + " to " + veth + ": " + hostLoToVeth.error());
+    } else if (!hostLoToVeth.get()) {
+      ++metrics.adding_lo_ip_filters_already_exist;
 
-    return Error(
-        "The IP packet filter from host " + lo + " to " +
-        veth + " already exists");
+      return Error(
+          "The IP packet filter from host " + lo + " to " +
+          veth + " already exists");
+    }
   }
 
   if (flowId.isSome()) {
@@ -3774,42 +4081,51 @@ Try<Nothing> PortMappingIsolatorProcess::removeHostIPFilters(
   // removed is important. We need to remove filters on host eth0 and
   // host lo first before we remove filters on veth.
 
-  // Remove the IP packet filter from host eth0 to veth of the container.
-  Try<bool> hostEth0ToVeth = filter::ip::remove(
-      eth0,
-      ingress::HANDLE,
-      ip::Classifier(hostMAC, hostIPNetwork.address(), None(), range));
+  if (classifierPorts.isSome()) {
+    Try<Nothing> classify = this->classify(range, None());
+    if (classify.isError()) {
+      return Error(
+          "Failed to remove " + stringify(range) + " from the BPF "
+          "classifier: " + classify.error());
+    }
+  } else {
+    // Remove the IP packet filter from host eth0 to veth of the container.
+    Try<bool> hostEth0ToVeth = filter::ip::remove(
+        eth0,
+        ingress::HANDLE,
+        ip::Classifier(hostMAC, hostIPNetwork.address(), None(), range));
 
-  if (hostEth0ToVeth.isError()) {
-    ++metrics.removing_eth0_ip_filters_errors;
+    if (hostEth0ToVeth.isError()) {
+      ++metrics.removing_eth0_ip_filters_errors;
 
-    return Error(
-        "Failed to remove the IP packet filter from host " +
-        eth0 + " to " + veth + ": " + hostEth0ToVeth.error());
-  } else if (!hostEth0ToVeth.get()) {
-    ++metrics.removing_eth0_ip_filters_do_not_exist;
+      return Error(
+          "Failed to remove the IP packet filter from host " +
+          eth0 + " to " + veth + ": " + hostEth0ToVeth.error());
+    } else if (!hostEth0ToVeth.get()) {
+      ++metrics.removing_eth0_ip_filters_do_not_exist;
 
-    LOG(ERROR) << "The IP packet filter from host " << eth0
-               << " to " << veth << " does not exist";
-  }
+      LOG(ERROR) << "The IP packet filter from host " << eth0
+                 << " to " << veth << " does not exist";
+    }
 
-  // Remove the IP packet filter from host lo to veth of the container.
-  Try<bool> hostLoToVeth = filter::ip::remove(
-      lo,
-      ingress::HANDLE,
-      ip::Classifier(None(), None(), None(), range));
+    // Remove the IP packet filter from host lo to veth of the container.
+    Try<bool> hostLoToVeth = filter::ip::remove(
+        lo,
+        ingress::HANDLE,
+        ip::Classifier(None(), None(), None(), range));
 
-  if (hostLoToVeth.isError()) {
-    ++metrics.removing_lo_ip_filters_errors;
+    if (hostLoToVeth.isError()) {
+      ++metrics.removing_lo_ip_filters_errors;
 
-    return Error(
-        "Failed to remove the IP packet filter from host " +
-        lo + " to " + veth + ": " + hostLoToVeth.error());
-  } else if (!hostLoToVeth.get()) {
-    ++metrics.removing_lo_ip_filters_do_not_exist;
+      return Error(
+          "Failed to remove the IP packet filter from host " +
+          lo + " to " + veth + ": " + hostLoToVeth.error());
+    } else if (!hostLoToVeth.get()) {
+      ++metrics.removing_lo_ip_filters_do_not_exist;
 
-    LOG(ERROR) << "The IP packet filter from host " << lo
-               << " to " << veth << " does not exist";
+      LOG(ERROR) << "The IP packet filter from host " << lo
+                 << " to " << veth << " does not exist";
+    }
   }
 
   if (flags.egress_unique_flow_per_container) {
@@ -3907,6 +4223,105 @@ Try<Nothing> PortMappingIsolatorProcess::removeHostIPFilters(
 }
 
 
+Try<Nothing> PortMappingIsolatorProcess::classify(
+    const PortRange& range,
+    const Option<string>& veth)
+{
+  CHECK_SOME(classifierPorts);
+
+  uint32_t index = 0;
+  if (veth.isSome()) {
+    Result<int> _index = link::index(veth.get());
+    if (_index.isError()) {
+      ++metrics.updating_bpf_classifier_errors;
+      return Error(
+          "Failed to get the index of " + veth.get() + ": " + _index.error());
+    } else if (_index.isNone()) {
+      ++metrics.updating_bpf_classifier_errors;
+      return Error("Link " + veth.get() + " is not found");
+    }
+
+    index = _index.get();
+  }
+
+  // NOTE: We use a 32-bit port here so that the loop terminates for
+  // port ranges ending at port 65535.
+  for (uint32_t port = range.begin(); port <= range.end(); port++) {
+    Try<Nothing> update =
+      ebpf::updateElement(classifierPorts.get(), &port, &index);
+
+    if (update.isError()) {
+      ++metrics.updating_bpf_classifier_errors;
+      return Error(
+          "Failed to map port " + stringify(port) + ": " + update.error());
+    }
+  }
+
+  return Nothing();
+}
+
+
+Try<Nothing> PortMappingIsolatorProcess::attachClassifier()
+{
+  CHECK_SOME(classifierPorts);
+
+  // The BPF classifier on host eth0 only looks at the packets sent
+  // to the host, while the one on host lo looks at all the packets,
+  // just like the u32 IP filters on host eth0 and host lo.
+  struct Classifier
+  {
+    string link;
+    string name;
+    Option<net::MAC> destinationMAC;
+    Option<net::IP> destinationIP;
+  };
+
+  const vector<Classifier> classifiers = {
+    {eth0, ETH0_CLASSIFIER_NAME, hostMAC, hostIPNetwork.address()},
+    {lo, LO_CLASSIFIER_NAME, None(), None()}
+  };
+
+  foreach (const Classifier& classifier, classifiers) {
+    Try<ebpf::Program> program = slave::classifier(
+        classifierPorts.get(),
+        classifier.destinationMAC,
+        classifier.destinationIP);
+
+    if (program.isError()) {
+      return Error(
+          "Failed to build the BPF classifier for " + classifier.link +
+          ": " + program.error());
+    }
+
+    Try<int> fd = ebpf::load(BPF_PROG_TYPE_SCHED_CLS, program.get());
+    if (fd.isError()) {
+      return Error(
+          "Failed to load the BPF classifier for " + classifier.link +
+          ": " + fd.error());
+    }
+
+    // NOTE: The filter holds a reference to the loaded program, so
+    // we can close the program once it is attached.
+    Try<Nothing> create = filter::bpf::create(
+        classifier.link,
+        ingress::HANDLE,
+        Priority(IP_FILTER_PRIORITY, HIGH),
+        fd.get(),
+        classifier.name);
+
+    os::close(fd.get());
+
+    if (create.isError()) {
+      return Error(
+          "Failed to attach the BPF classifier to " + classifier.link +
+          ": " + create.error());
+    }
+  }
+
+  return Nothing();
+}
+
+
 // This function returns the scripts that need to be run in child
 // context before child execs to complete network isolation.
 // TODO(jieyu): Use the Subcommand abstraction to remove most of the
@@ -149,7 +149,7 @@ class PortMappingIsolatorProcess : public MesosIsolatorProcess
 public:
   static Try<mesos::slave::Isolator*> create(const Flags& flags);
 
-  virtual ~PortMappingIsolatorProcess() {}
+  virtual ~PortMappingIsolatorProcess();
 
   virtual process::Future<Nothing> recover(
       const std::list<mesos::slave::ContainerState>& states,
@@ -244,6 +244,7 @@ private:
     process::metrics::Counter updating_eth0_arp_filters_already_exist;
     process::metrics::Counter updating_eth0_arp_filters_do_not_exist;
     process::metrics::Counter updating_container_ip_filters_errors;
+    process::metrics::Counter updating_bpf_classifier_errors;
   } metrics;
 
   PortMappingIsolatorProcess(
@@ -260,7 +261,8 @@ private:
       const Option<Bytes>& _egressRateLimitPerContainer,
       const IntervalSet<uint16_t>& _managedNonEphemeralPorts,
       const process::Owned<EphemeralPortsAllocator>& _ephemeralPortsAllocator,
-      const std::set<uint16_t>& _flowIDs)
+      const std::set<uint16_t>& _flowIDs,
+      const Option<int>& _classifierPorts)
     : ProcessBase(process::ID::generate("mesos-port-mapping-isolator")),
       flags(_flags),
       bindMountRoot(_bindMountRoot),
@@ -275,7 +277,8 @@ private:
       egressRateLimitPerContainer(_egressRateLimitPerContainer),
       managedNonEphemeralPorts(_managedNonEphemeralPorts),
       ephemeralPortsAllocator(_ephemeralPortsAllocator),
-      freeFlowIds(_flowIDs) {}
+      freeFlowIds(_flowIDs),
+      classifierPorts(_classifierPorts) {}
 
   // Continuations.
   Try<Nothing> _cleanup(Info* info, const Option<ContainerID>& containerId);
@@ -304,6 +307,16 @@ private:
       const std::string& veth,
       bool removeFiltersOnVeth = true);
 
+  // Points the given port range at the given veth (or at no veth if
+  // none) in the BPF classifier on host eth0 and host lo.
+  Try<Nothing> classify(
+      const routing::filter::ip::PortRange& range,
+      const Option<std::string>& veth);
+
+  // Loads the BPF classifier on host eth0 and host lo, replacing the
+  // one of the previous run of the agent (if any).
+  Try<Nothing> attachClassifier();
+
   // Return the scripts that will be executed in the child context.
   std::string scripts(Info* info);
 
@@ -337,6 +350,12 @@ private:
   // Store a set of unused flow ID's on this slave.
   std::set<uint16_t> freeFlowIds;
 
+  // The BPF map of the BPF classifier (if enabled) that maps the
+  // destination port of an incoming IP packet on host eth0 or host
+  // lo to the index of the veth of the container it is redirected to
+  // (or to 0 if the port is not allocated to any container).
+  const Option<int> classifierPorts;
+
   hashmap<ContainerID, Info*> infos;
 
   // Recovered containers from a previous run that weren't managed by
@@ -17,10 +17,12 @@
 #include <signal.h>
 
 #ifdef __linux__
+#include <sys/inotify.h>
 #include <sys/prctl.h>
 #endif
 #include <sys/types.h>
 
+#include <algorithm>
 #include <deque>
 #include <tuple>
 
@@ -36,6 +38,7 @@
 
 #include <stout/check.hpp>
 #include <stout/foreach.hpp>
+#include <stout/hashset.hpp>
 #include <stout/lambda.hpp>
 #include <stout/numify.hpp>
 #include <stout/strings.hpp>
@@ -43,6 +46,8 @@
 
 #include <stout/os/exists.hpp>
 #include <stout/os/killtree.hpp>
+#include <stout/os/ls.hpp>
+#include <stout/os/realpath.hpp>
 #include <stout/os/stat.hpp>
 
 #include "common/protobuf_utils.hpp"
@@ -100,7 +105,9 @@ PosixDiskIsolatorProcess::Info::PathInfo::~PathInfo()
 PosixDiskIsolatorProcess::PosixDiskIsolatorProcess(const Flags& _flags)
   : ProcessBase(process::ID::generate("posix-disk-isolator")),
     flags(_flags),
-    collector(flags.container_disk_watch_interval) {}
+    collector(
+        flags.container_disk_watch_interval,
+        flags.container_disk_usage_tracking == "inotify") {}
 
 
 PosixDiskIsolatorProcess::~PosixDiskIsolatorProcess() {}
@@ -422,13 +429,401 @@ Future<Nothing> PosixDiskIsolatorProcess::cleanup(
   return Nothing();
 }
 
+#ifdef __linux__
+// Tracks the disk usage of directory trees incrementally: each tree is
+// walked once when it is added, with an inotify watch on every
+// directory, after which only the entries that inotify reports as
+// changed are looked at again. Keeping the usage up to date therefore
+// costs O(changes) rather than O(files) like 'du'.
+//
+// NOTE: Like 'du', the usage of an entry is the number of blocks
+// allocated to it, but unlike 'du' hard links are not deduplicated.
+class DiskUsageTracker
+{
+public:
+  static Try<Owned<DiskUsageTracker>> create()
+  {
+    int inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify == -1) {
+      return ErrnoError("Failed to initialize inotify");
+    }
+
+    return Owned<DiskUsageTracker>(new DiskUsageTracker(inotify));
+  }
+
+  ~DiskUsageTracker()
+  {
+    os::close(inotify);
+  }
+
+  // The inotify file descriptor, which becomes readable whenever
+  // there are events to be processed by `update()`.
+  int fd() const { return inotify; }
+
+  bool contains(const string& path) const
+  {
+    return roots.contains(path);
+  }
+
+  bool contains(const string& path, const vector<string>& excludes) const
+  {
+    return roots.contains(path) && roots.at(path).excludes == excludes;
+  }
+
+  // Starts tracking the tree rooted at 'path', skipping 'excludes'.
+  Try<Nothing> add(const string& path, const vector<string>& excludes)
+  {
+    remove(path);
+
+    // NOTE: Like 'du', we do not follow a symbolic link unless the
+    // path has a trailing '/', but a link itself can not be watched.
+    if (os::stat::islink(path)) {
+      return Error("'" + path + "' is a symbolic link");
+    }
+
+    Result<string> realpath = os::realpath(path);
+    if (!realpath.isSome()) {
+      return Error(
+          "Failed to resolve '" + path + "': " +
+          (realpath.isError() ? realpath.error() : "No such directory"));
+    }
+
+    Root& root = roots[path];
+    root.path = realpath.get();
+    root.excludes = excludes;
+
+    // The entries of the tree are named by their real path, so the
+    // excludes need to be too.
+    foreach (const string& exclude, excludes) {
+      Result<string> skip = os::realpath(exclude);
+      root.skips.push_back(skip.isSome() ? skip.get() : exclude);
+    }
+
+    Try<Nothing> walk = this->walk(path, realpath.get());
+    if (walk.isError()) {
+      remove(path);
+      return walk;
+    }
+
+    return Nothing();
+  }
+
+  // Stops tracking the tree rooted at 'path'.
+  void remove(const string& path)
+  {
+    if (!roots.contains(path)) {
+      return;
+    }
+
+    if (watches.contains(roots[path].path)) {
+      unwalk(watches[roots[path].path]);
+    }
+
+    roots.erase(path);
+  }
+
+  // Returns the usage of the tree rooted at 'path', or an error if
+  // the tree could not be kept up to date.
+  Try<Bytes> usage(const string& path) const
+  {
+    CHECK(roots.contains(path));
+
+    const Root& root = roots.at(path);
+
+    if (root.error.isSome()) {
+      return Error(root.error.get());
+    }
+
+    return Bytes(root.usage);
+  }
+
+  // Applies all the pending inotify events.
+  void update()
+  {
+    // The (directory, name) pairs that changed, so that an entry is
+    // only looked at once no matter how many events it had.
+    vector<std::pair<int, string>> changes;
+    hashset<string> changed;
+
+    bool overflow = false;
+
+    char buffer[64 * 1024]
+      __attribute__((aligned(__alignof__(struct inotify_event))));
+
+    while (true) {
+      ssize_t length = ::read(inotify, buffer, sizeof(buffer));
+      if (length <= 0) {
+        // Either EAGAIN (no more events) or an error, in both cases
+        // there is nothing (left) to read for now.
+        break;
+      }
+
+      for (char* p = buffer; p < buffer + length;) {
+        const struct inotify_event* event = (struct inotify_event*) p;
+        p += sizeof(struct inotify_event) + event->len;
+
+        if (event->mask & IN_Q_OVERFLOW) {
+          overflow = true;
+        } else if (event->len > 0 && directories.contains(event->wd)) {
+          const string name = event->name;
+          const string key = stringify(event->wd) + "/" + name;
+
+          if (!changed.contains(key)) {
+            changed.insert(key);
+            changes.push_back(std::make_pair(event->wd, name));
+          }
+        }
+      }
+    }
+
+    if (overflow) {
+      // Events were lost, so the only way to get back to an accurate
+      // usage is to walk all the trees again.
+      LOG(WARNING) << "The inotify event queue overflowed, walking all"
+                   << " tracked directories again";
+
+      foreach (const string& path, roots.keys()) {
+        const vector<string> excludes = roots[path].excludes;
+
+        Try<Nothing> add = this->add(path, excludes);
+        if (add.isError()) {
+          roots[path].error = add.error();
+        }
+      }
+
+      return;
+    }
+
+    foreach (const auto& change, changes) {
+      refresh(change.first, change.second);
+    }
+  }
+
+private:
+  struct Directory
+  {
+    // The tracked path (i.e., key of `roots`) this directory is in.
+    string root;
+
+    string path;
+    uint64_t usage = 0;
+
+    // The usage of the files in this directory, and the names of its
+    // subdirectories (whose usage is tracked by their own entry).
+    hashmap<string, uint64_t> files;
+    hashset<string> subdirectories;
+  };
+
+  struct Root
+  {
+    string path; // The real path of the root directory.
+    vector<string> excludes;
+    vector<string> skips; // The real paths of the excludes.
+    uint64_t usage = 0;
+
+    // Set once the usage can no longer be tracked.
+    Option<string> error;
+  };
+
+  explicit DiskUsageTracker(int _inotify) : inotify(_inotify) {}
+
+  static uint64_t blocks(const struct stat& s)
+  {
+    // NOTE: 'st_blocks' is always in units of 512 bytes.
+    return static_cast<uint64_t>(s.st_blocks) * 512;
+  }
+
+  // Like the '--exclude' patterns of 'du', an exclude matches either
+  // the whole path or, if it has no '/', the name of an entry.
+  bool excluded(const Root& root, const string& path) const
+  {
+    if (std::find(root.skips.begin(), root.skips.end(), path) !=
+        root.skips.end()) {
+      return true;
+    }
+
+    const string name = Path(path).basename();
+
+    foreach (const string& exclude, root.excludes) {
+      if (!strings::contains(exclude, "/") && exclude == name) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  // Adds the directory at 'path' and everything below it to the tree
+  // rooted at 'root'.
+  Try<Nothing> walk(const string& root, const string& path)
+  {
+    struct stat s;
+    if (::lstat(path.c_str(), &s) < 0) {
+      return ErrnoError("Failed to stat '" + path + "'");
+    }
+
+    int wd = inotify_add_watch(
+        inotify,
+        path.c_str(),
+        IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_FROM |
+        IN_MOVED_TO | IN_ONLYDIR | IN_DONT_FOLLOW);
+
+    if (wd < 0) {
+      return ErrnoError("Failed to watch '" + path + "'");
+    }
+
+    if (directories.contains(wd)) {
+      // The same directory is reachable twice (e.g., through a bind
+      // mount), which would count its usage twice.
+      return Error("Directory '" + path + "' is already tracked");
+    }
+
+    Directory& directory = directories[wd];
+    directory.root = root;
+    directory.path = path;
+    directory.usage = blocks(s);
+
+    watches[path] = wd;
+    roots[root].usage += directory.usage;
+
+    Try<list<string>> entries = os::ls(path);
+    if (entries.isError()) {
+      return Error("Failed to list '" + path + "': " + entries.error());
+    }
+
+    foreach (const string& entry, entries.get()) {
+      Try<Nothing> refresh = this->refresh(wd, entry);
+      if (refresh.isError()) {
+        return refresh;
+      }
+    }
+
+    return Nothing();
+  }
+
+  // Removes the directory with the watch 'wd' and everything below it
+  // from its tree.
+  void unwalk(int wd)
+  {
+    CHECK(directories.contains(wd));
+
+    // Copy the directory as `unwalk()` below invalidates references.
+    const Directory directory = directories[wd];
+
+    foreach (const string& name, directory.subdirectories) {
+      const string path = path::join(directory.path, name);
+
+      if (watches.contains(path)) {
+        unwalk(watches[path]);
+      }
+    }
+
+    uint64_t usage = directory.usage;
+    foreachvalue (uint64_t file, directory.files) {
+      usage += file;
+    }
+
+    if (roots.contains(directory.root)) {
+      Root& root = roots[directory.root];
+      root.usage -= std::min(root.usage, usage);
+    }
+
+    // NOTE: This fails if the directory was removed, in which case
+    // inotify has already removed the watch.
+    inotify_rm_watch(inotify, wd);
+
+    watches.erase(directory.path);
+    directories.erase(wd);
+  }
+
+  // Brings the entry 'name' of the directory with the watch 'wd' up
+  // to date, e.g., after it was created, modified or removed.
+  Try<Nothing> refresh(int wd, const string& name)
+  {
+    if (!directories.contains(wd)) {
+      return Nothing(); // The directory was removed since.
+    }
+
+    const string root = directories[wd].root;
+    const string path = path::join(directories[wd].path, name);
+
+    if (!roots.contains(root) || roots[root].error.isSome()) {
+      return Nothing();
+    }
+
+    if (excluded(roots[root], path)) {
+      return Nothing();
+    }
+
+    // Forget what we knew about the entry, and then (re)add it below
+    // if it (still) exists.
+    if (directories[wd].files.contains(name)) {
+      uint64_t usage = directories[wd].files[name];
+      roots[root].usage -= std::min(roots[root].usage, usage);
+      directories[wd].files.erase(name);
+    }
+
+    struct stat s;
+    if (::lstat(path.c_str(), &s) < 0) {
+      if (directories[wd].subdirectories.contains(name)) {
+        directories[wd].subdirectories.erase(name);
+
+        if (watches.contains(path)) {
+          unwalk(watches[path]);
+        }
+      }
+
+      return Nothing();
+    }
+
+    if (S_ISDIR(s.st_mode)) {
+      if (!directories[wd].subdirectories.contains(name)) {
+        directories[wd].subdirectories.insert(name);
+
+        Try<Nothing> walk = this->walk(root, path);
+        if (walk.isError()) {
+          roots[root].error = walk.error();
+          return walk;
+        }
+      }
+
+      return Nothing();
+    }
+
+    if (directories[wd].subdirectories.contains(name)) {
+      // A directory got replaced by a file.
+      directories[wd].subdirectories.erase(name);
+
+      if (watches.contains(path)) {
+        unwalk(watches[path]);
+      }
+    }
+
+    directories[wd].files[name] = blocks(s);
+    roots[root].usage += blocks(s);
+
+    return Nothing();
+  }
+
+  const int inotify;
+
+  // The tracked trees, keyed by the path they were added with.
+  hashmap<string, Root> roots;
+
+  // All the watched directories, by watch and by path.
+  hashmap<int, Directory> directories;
+  hashmap<string, int> watches;
+};
+#endif // __linux__
+
 
 class DiskUsageCollectorProcess : public Process<DiskUsageCollectorProcess>
 {
 public:
-  DiskUsageCollectorProcess(const Duration& _interval)
+  DiskUsageCollectorProcess(const Duration& _interval, bool _inotify)
     : ProcessBase(process::ID::generate("posix-disk-usage-collector")),
-      interval(_interval) {}
+      interval(_interval),
+      inotify(_inotify) {}
   virtual ~DiskUsageCollectorProcess() {}
 
   Future<Bytes> usage(
@@ -439,6 +834,33 @@ public:
     // either return a Failure here, or does not allow 'excludes' to
     // be specified on OSX.
 
+#ifdef __linux__
+    if (tracker.isSome() && !untrackable.contains(path)) {
+      if (!tracker.get()->contains(path, excludes)) {
+        Try<Nothing> add = tracker.get()->add(path, excludes);
+        if (add.isError()) {
+          LOG(WARNING) << "Failed to track the disk usage of '" << path
+                       << "' through inotify, falling back to 'du': "
+                       << add.error();
+
+          untrackable.insert(path);
+          return usage(path, excludes);
+        }
+      }
+
+      // Report the usage once the interval has elapsed, so that the
+      // usage is polled at the same pace as with 'du'.
+      Owned<Promise<Bytes>> promise(new Promise<Bytes>());
+
+      Future<Bytes> future = promise->future();
+      future.onDiscard(defer(self(), &Self::discard, path));
+
+      delay(interval, self(), &Self::track, path, promise);
+
+      return future;
+    }
+#endif // __linux__
+
     foreach (const Owned<Entry>& entry, entries) {
       if (entry->path == path) {
         return entry->promise.future();
@@ -457,6 +879,19 @@ public:
 protected:
   void initialize()
   {
+#ifdef __linux__
+    if (inotify) {
+      Try<Owned<DiskUsageTracker>> create = DiskUsageTracker::create();
+      if (create.isError()) {
+        LOG(WARNING) << "Failed to create the inotify disk usage tracker,"
+                     << " falling back to 'du': " << create.error();
+      } else {
+        tracker = create.get();
+        watch();
+      }
+    }
+#endif // __linux__
+
     schedule();
   }
 
@@ -487,6 +922,15 @@ private:
 
   void discard(const string& path)
   {
+#ifdef __linux__
+    if (tracker.isSome()) {
+      // The path is no longer of interest (e.g., its container is
+      // destroyed), so release its watches.
+      tracker.get()->remove(path);
+      untrackable.erase(path);
+    }
+#endif // __linux__
+
     for (auto it = entries.begin(); it != entries.end(); ++it) {
       // We only cancel those checks whose 'du' haven't been launched.
       if ((*it)->path == path && (*it)->du.isNone()) {
@@ -626,16 +1070,82 @@ private:
     delay(interval, self(), &Self::schedule);
   }
 
+#ifdef __linux__
+  // Applies the inotify events as they come in, which keeps the
+  // tracked usage up to date (and the event queue from overflowing).
+  void watch()
+  {
+    CHECK_SOME(tracker);
+
+    io::poll(tracker.get()->fd(), io::READ)
+      .onAny(defer(self(), [this](const Future<short>& poll) {
+        if (!poll.isReady()) {
+          // The usage will then only be brought up to date when it is
+          // collected, see `track()`.
+          LOG(ERROR) << "Failed to wait for inotify events: "
+                     << (poll.isFailed() ? poll.failure() : "discarded");
+          return;
+        }
+
+        tracker.get()->update();
+        watch();
+      }));
+  }
+
+  void track(const string& path, const Owned<Promise<Bytes>>& promise)
+  {
+    CHECK_SOME(tracker);
+
+    if (promise->future().hasDiscard()) {
+      promise->discard();
+      return;
+    }
+
+    // Apply the recent changes before reporting.
+    tracker.get()->update();
+
+    if (!tracker.get()->contains(path)) {
+      promise->fail("Disk usage of '" + path + "' is no longer tracked");
+      return;
+    }
+
+    Try<Bytes> usage = tracker.get()->usage(path);
+    if (usage.isError()) {
+      // Fall back to 'du' for any subsequent collection.
+      LOG(WARNING) << "Failed to track the disk usage of '" << path
+                   << "' through inotify, falling back to 'du': "
+                   << usage.error();
+
+      tracker.get()->remove(path);
+      untrackable.insert(path);
+
+      promise->fail(usage.error());
+      return;
+    }
+
+    promise->set(usage.get());
+  }
+#endif // __linux__
+
   const Duration interval;
+  const bool inotify;
 
   // A queue of pending checks.
   deque<Owned<Entry>> entries;
+
+#ifdef __linux__
+  Option<Owned<DiskUsageTracker>> tracker;
+
+  // The paths that can not be tracked through inotify, which are
+  // collected with 'du' instead.
+  hashset<string> untrackable;
+#endif // __linux__
 };
 
 
-DiskUsageCollector::DiskUsageCollector(const Duration& interval)
+DiskUsageCollector::DiskUsageCollector(const Duration& interval, bool inotify)
 {
-  process = new DiskUsageCollectorProcess(interval);
+  process = new DiskUsageCollectorProcess(interval, inotify);
   spawn(process);
 }
 
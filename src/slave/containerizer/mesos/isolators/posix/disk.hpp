@@ -39,11 +39,13 @@ class DiskUsageCollectorProcess;
 
 
 // Responsible for collecting disk usage for paths, while ensuring
-// that an interval elapses between each collection.
+// that an interval elapses between each collection. If 'inotify' is
+// set (Linux only), the usage of the paths is tracked incrementally
+// through inotify instead of running 'du' for each collection.
 class DiskUsageCollector
 {
 public:
-  DiskUsageCollector(const Duration& interval);
+  DiskUsageCollector(const Duration& interval, bool inotify = false);
   ~DiskUsageCollector();
 
   // Returns the disk usage rooted at 'path'. The user can discard the
@@ -107,6 +107,29 @@ Try<Isolator*> XfsDiskIsolatorProcess::create(const Flags& flags)
     return Error("'" + flags.work_dir + "' is not an XFS filesystem");
   }
 
+  return _create(flags);
+}
+
+
+Try<Isolator*> XfsDiskIsolatorProcess::createExt4(const Flags& flags)
+{
+  if (!xfs::pathIsExt4(flags.work_dir)) {
+    return Error("'" + flags.work_dir + "' is not an ext4 filesystem");
+  }
+
+  Try<Nothing> quotas = xfs::checkProjectQuotas(flags.work_dir);
+  if (quotas.isError()) {
+    return Error(
+        "The ext4 disk isolator requires '" + flags.work_dir + "' to be"
+        " mounted with the 'prjquota' option: " + quotas.error());
+  }
+
+  return _create(flags);
+}
+
+
+Try<Isolator*> XfsDiskIsolatorProcess::_create(const Flags& flags)
+{
   Result<uid_t> uid = os::getuid();
   CHECK_SOME(uid) << "getuid(2) doesn't fail";
 
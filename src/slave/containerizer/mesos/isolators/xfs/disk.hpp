@@ -36,11 +36,19 @@ namespace mesos {
 namespace internal {
 namespace slave {
 
+// Tracks and enforces the disk usage of each sandbox through project
+// quotas. This backs both the `disk/xfs` isolator and, since ext4
+// supports the same project quota interface (Linux >= 4.5), the
+// `disk/ext4` isolator.
 class XfsDiskIsolatorProcess : public MesosIsolatorProcess
 {
 public:
   static Try<mesos::slave::Isolator*> create(const Flags& flags);
 
+  // Creates the `disk/ext4` isolator, which requires the work
+  // directory to be on ext4 mounted with the `prjquota` option.
+  static Try<mesos::slave::Isolator*> createExt4(const Flags& flags);
+
   virtual ~XfsDiskIsolatorProcess();
 
   process::PID<XfsDiskIsolatorProcess> self() const
@@ -71,6 +79,10 @@ public:
       const ContainerID& containerId);
 
 private:
+  // Continuation of `create()` and `createExt4()` once the
+  // filesystem of the work directory has been checked.
+  static Try<mesos::slave::Isolator*> _create(const Flags& flags);
+
   XfsDiskIsolatorProcess(
       const Flags& flags,
       const IntervalSet<prid_t>& projectIds);
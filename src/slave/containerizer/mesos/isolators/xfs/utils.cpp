@@ -34,8 +34,10 @@
 #include <fts.h>
 
 #include <blkid/blkid.h>
+#include <linux/magic.h>
 #include <linux/quota.h>
 #include <sys/quota.h>
+#include <sys/vfs.h>
 
 #include <stout/check.hpp>
 #include <stout/error.hpp>
@@ -395,6 +397,49 @@ bool pathIsXfs(const string& path)
   return ::platform_test_xfs_path(path.c_str()) == 1;
 }
 
+
+bool pathIsExt4(const string& path)
+{
+  struct statfs buf;
+
+  if (::statfs(path.c_str(), &buf) == -1) {
+    return false;
+  }
+
+  // NOTE: ext2 and ext3 share the magic number of ext4, but
+  // neither supports project quotas, which `checkProjectQuotas()`
+  // catches.
+  return buf.f_type == EXT4_SUPER_MAGIC;
+}
+
+
+Try<Nothing> checkProjectQuotas(const string& path)
+{
+  Try<string> devname = getDeviceForPath(path);
+  if (devname.isError()) {
+    return Error(devname.error());
+  }
+
+  fs_quota_stat_t state = {0};
+
+  if (::quotactl(QCMD(Q_XGETQSTAT, PRJQUOTA),
+                 devname.get().c_str(),
+                 0,
+                 reinterpret_cast<caddr_t>(&state)) == -1) {
+    return ErrnoError(
+        "Failed to get the quota state of '" + devname.get() + "'");
+  }
+
+  // NOTE: An ext4 filesystem with the `quota` feature always accounts
+  // project quotas, but only enforces them if mounted with `prjquota`.
+  if ((state.qs_flags & FS_QUOTA_PDQ_ENFD) == 0) {
+    return Error(
+        "Project quotas are not enforced on '" + devname.get() + "'");
+  }
+
+  return Nothing();
+}
+
 } // namespace xfs {
 } // namespace internal {
 } // namespace mesos {
@@ -49,6 +49,18 @@ Option<Error> validateProjectIds(const IntervalSet<prid_t>& projectRange);
 bool pathIsXfs(const std::string& path);
 
 
+// Returns true if the path is on an ext4 filesystem. Since Linux 4.5
+// ext4 supports the same project ID and quota interface as XFS, so
+// the functions here work on both (provided the filesystem has the
+// `project` feature and is mounted with the `prjquota` option).
+bool pathIsExt4(const std::string& path);
+
+
+// Returns an error if project quotas are not enforced on the
+// filesystem containing the given path.
+Try<Nothing> checkProjectQuotas(const std::string& path);
+
+
 Result<QuotaInfo> getProjectQuota(
     const std::string& path,
     prid_t projectId);
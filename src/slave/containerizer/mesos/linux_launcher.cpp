@@ -21,7 +21,9 @@
 
 #include <vector>
 
+#include <process/async.hpp>
 #include <process/collect.hpp>
+#include <process/defer.hpp>
 
 #include <stout/abort.hpp>
 #include <stout/check.hpp>
@@ -37,9 +39,12 @@
 
 #include "mesos/resources.hpp"
 
+#include "slave/containerizer/mesos/fork_server.hpp"
 #include "slave/containerizer/mesos/linux_launcher.hpp"
 #include "slave/containerizer/mesos/paths.hpp"
 
+#include "slave/state.hpp"
+
 using namespace process;
 
 using std::list;
@@ -65,7 +70,8 @@ public:
   LinuxLauncherProcess(
       const Flags& flags,
       const std::string& freezerHierarchy,
-      const Option<std::string>& systemdHierarchy);
+      const Option<std::string>& systemdHierarchy,
+      const Option<process::Owned<ForkServer>>& forkServer);
 
   virtual process::Future<hashset<ContainerID>> recover(
       const std::list<mesos::slave::ContainerState>& states);
@@ -115,11 +121,27 @@ private:
   // it belongs to.
   Option<ContainerID> parse(const string& cgroup);
 
+  // Checkpoints the cgroups of `containers` in the runtime directory
+  // (see `containerizer::paths::getLauncherCgroupsPath`).
+  Try<Nothing> checkpoint();
+
+  // Destroys the cgroups found by walking the freezer hierarchy after
+  // recovery which belong to containers that we have never known
+  // about, e.g., if the agent failed after creating the cgroup of a
+  // container but before checkpointing it.
+  void reconcile(const Future<Try<vector<string>>>& walk);
+
   static const std::string subsystem;
   const Flags flags;
   const std::string freezerHierarchy;
   const Option<std::string> systemdHierarchy;
+  const Option<process::Owned<ForkServer>> forkServer;
   hashmap<ContainerID, Container> containers;
+
+  // The containers that we have known about since recovery, until
+  // the freezer hierarchy has been reconciled; these are never
+  // destroyed by `reconcile`, even if they have been destroyed since.
+  Option<hashset<ContainerID>> known;
 };
 
 
@@ -150,6 +172,20 @@ Try<Launcher*> LinuxLauncher::create(const Flags& flags)
   LOG(INFO) << "Using " << freezerHierarchy.get()
             << " as the freezer hierarchy for the Linux launcher";
 
+  Option<Owned<ForkServer>> forkServer;
+
+  if (flags.launcher_fork_server) {
+    Try<Owned<ForkServer>> _forkServer =
+      ForkServer::create(flags.launcher_dir);
+
+    if (_forkServer.isError()) {
+      return Error(
+          "Failed to create Linux launcher: " + _forkServer.error());
+    }
+
+    forkServer = _forkServer.get();
+  }
+
   // On systemd environments we currently migrate executor pids into a separate
   // executor slice. This allows the life-time of the executor to be extended
   // past the life-time of the slave. See MESOS-3352.
@@ -164,7 +200,8 @@ Try<Launcher*> LinuxLauncher::create(const Flags& flags)
       freezerHierarchy.get(),
       systemd::enabled() ?
         Some(systemd::hierarchy()) :
-        Option<string>::none());
+        Option<string>::none(),
+      forkServer);
 }
 
 
@@ -181,8 +218,13 @@ bool LinuxLauncher::available()
 LinuxLauncher::LinuxLauncher(
     const Flags& flags,
     const string& freezerHierarchy,
-    const Option<string>& systemdHierarchy)
-  : process(new LinuxLauncherProcess(flags, freezerHierarchy, systemdHierarchy))
+    const Option<string>& systemdHierarchy,
+    const Option<Owned<ForkServer>>& forkServer)
+  : process(new LinuxLauncherProcess(
+        flags,
+        freezerHierarchy,
+        systemdHierarchy,
+        forkServer))
 {
   process::spawn(process.get());
 }
@@ -247,28 +289,76 @@ Future<ContainerStatus> LinuxLauncher::status(
 LinuxLauncherProcess::LinuxLauncherProcess(
     const Flags& _flags,
     const string& _freezerHierarchy,
-    const Option<string>& _systemdHierarchy)
+    const Option<string>& _systemdHierarchy,
+    const Option<Owned<ForkServer>>& _forkServer)
   : flags(_flags),
     freezerHierarchy(_freezerHierarchy),
-    systemdHierarchy(_systemdHierarchy) {}
+    systemdHierarchy(_systemdHierarchy),
+    forkServer(_forkServer) {}
 
 
 Future<hashset<ContainerID>> LinuxLauncherProcess::recover(
     const list<ContainerState>& states)
 {
   // Recover all of the "containers" we know about based on the
-  // existing cgroups.
-  Try<vector<string>> cgroups =
-    cgroups::get(freezerHierarchy, flags.cgroups_root);
+  // existing cgroups. Walking the freezer hierarchy can take a long
+  // time with many (nested or orphaned) containers, so we only check
+  // the cgroups that we have checkpointed and those of the expected
+  // containers, and walk the hierarchy after recovery instead (see
+  // `reconcile`). We do walk the hierarchy here if nothing has been
+  // checkpointed yet, e.g., after upgrading the agent.
+  const string index =
+    containerizer::paths::getLauncherCgroupsPath(flags.runtime_dir);
+
+  const bool indexed = os::exists(index);
+
+  vector<string> recovered;
+
+  if (indexed) {
+    Try<string> read = os::read(index);
+    if (read.isError()) {
+      return Failure(
+          "Failed to read the checkpointed cgroups from '" + index + "': " +
+          read.error());
+    }
 
-  if (cgroups.isError()) {
-    return Failure(
-        "Failed to get cgroups from " +
-        path::join(freezerHierarchy, flags.cgroups_root) +
-        ": "+ cgroups.error());
+    hashset<string> candidates;
+
+    foreach (const string& cgroup, strings::tokenize(read.get(), "\n")) {
+      candidates.insert(cgroup);
+    }
+
+    foreach (const ContainerState& state, states) {
+      candidates.insert(cgroup(state.container_id()));
+    }
+
+    foreach (const string& cgroup, candidates) {
+      Try<bool> exists = cgroups::exists(freezerHierarchy, cgroup);
+      if (exists.isError()) {
+        return Failure(
+            "Failed to determine if cgroup " + cgroup + " exists: " +
+            exists.error());
+      }
+
+      if (exists.get()) {
+        recovered.push_back(cgroup);
+      }
+    }
+  } else {
+    Try<vector<string>> cgroups =
+      cgroups::get(freezerHierarchy, flags.cgroups_root);
+
+    if (cgroups.isError()) {
+      return Failure(
+          "Failed to get cgroups from " +
+          path::join(freezerHierarchy, flags.cgroups_root) +
+          ": "+ cgroups.error());
+    }
+
+    recovered = cgroups.get();
   }
 
-  foreach (const string& cgroup, cgroups.get()) {
+  foreach (const string& cgroup, recovered) {
     // Need to parse the cgroup to see if it's one we created (i.e.,
     // matches our separator structure) or one that someone else
     // created (e.g., in the future we might have nested containers
@@ -375,6 +465,27 @@ Future<hashset<ContainerID>> LinuxLauncherProcess::recover(
     }
   }
 
+  Try<Nothing> checkpointed = checkpoint();
+  if (checkpointed.isError()) {
+    return Failure(
+        "Failed to checkpoint the cgroups of the containers: " +
+        checkpointed.error());
+  }
+
+  if (indexed) {
+    known = hashset<ContainerID>();
+
+    foreachkey (const ContainerID& containerId, containers) {
+      known->insert(containerId);
+    }
+
+    const string hierarchy = freezerHierarchy;
+    const string root = flags.cgroups_root;
+
+    async([hierarchy, root]() { return cgroups::get(hierarchy, root); })
+      .onAny(defer(self(), &Self::reconcile, lambda::_1));
+  }
+
   return orphans;
 }
 
@@ -458,6 +569,57 @@ Try<pid_t> LinuxLauncherProcess::fork(
         child);
   }));
 
+  if (forkServer.isSome()) {
+    Try<pid_t> pid = forkServer.get()->fork(
+        path,
+        argv,
+        in,
+        out,
+        err,
+        flags,
+        environment,
+        target,
+        enterFlags,
+        cloneFlags);
+
+    if (pid.isError()) {
+      return Error("Failed to fork through the fork server: " + pid.error());
+    }
+
+    // The child is not blocked until the parent hooks have run, so we
+    // run them once it has been forked. This is safe as the launch
+    // helper blocks until the containerizer signals it to continue,
+    // which happens once the container has been isolated.
+    foreach (const Subprocess::ParentHook& hook, parentHooks) {
+      Try<Nothing> setup = hook.parent_setup(pid.get());
+      if (setup.isError()) {
+        ::kill(pid.get(), SIGKILL);
+
+        return Error(
+            "Failed to execute parent hook for child '" +
+            stringify(pid.get()) + "': " + setup.error());
+      }
+    }
+
+    Container container;
+    container.id = containerId;
+    container.pid = pid.get();
+
+    containers.put(container.id, container);
+
+    if (known.isSome()) {
+      known->insert(container.id);
+    }
+
+    Try<Nothing> checkpointed = checkpoint();
+    if (checkpointed.isError()) {
+      LOG(WARNING) << "Failed to checkpoint the cgroups of the containers: "
+                   << checkpointed.error();
+    }
+
+    return container.pid.get();
+  }
+
   Try<Subprocess> child = subprocess(
       path,
       argv,
@@ -496,6 +658,16 @@ Try<pid_t> LinuxLauncherProcess::fork(
 
   containers.put(container.id, container);
 
+  if (known.isSome()) {
+    known->insert(container.id);
+  }
+
+  Try<Nothing> checkpointed = checkpoint();
+  if (checkpointed.isError()) {
+    LOG(WARNING) << "Failed to checkpoint the cgroups of the containers: "
+                 << checkpointed.error();
+  }
+
   return container.pid.get();
 }
 
@@ -530,6 +702,14 @@ Future<Nothing> LinuxLauncherProcess::destroy(const ContainerID& containerId)
   // a copy of the Container that we're about to delete.
   containers.erase(container->id);
 
+  // NOTE: If the agent fails before the cgroup has been destroyed, it
+  // will be destroyed by `reconcile` after recovery.
+  Try<Nothing> checkpointed = checkpoint();
+  if (checkpointed.isError()) {
+    LOG(WARNING) << "Failed to checkpoint the cgroups of the containers: "
+                 << checkpointed.error();
+  }
+
   // Determine if this is a partially destroyed container. A container
   // is considered partially destroyed if we have recovered it from
   // ContainerState but we don't have a freezer cgroup for it. If this
@@ -589,6 +769,69 @@ string LinuxLauncherProcess::cgroup(const ContainerID& containerId)
 }
 
 
+Try<Nothing> LinuxLauncherProcess::checkpoint()
+{
+  vector<string> cgroups;
+
+  foreachkey (const ContainerID& containerId, containers) {
+    cgroups.push_back(cgroup(containerId));
+  }
+
+  return slave::state::checkpoint(
+      containerizer::paths::getLauncherCgroupsPath(flags.runtime_dir),
+      strings::join("\n", cgroups));
+}
+
+
+void LinuxLauncherProcess::reconcile(const Future<Try<vector<string>>>& walk)
+{
+  CHECK_SOME(known);
+
+  if (!walk.isReady() || walk->isError()) {
+    LOG(WARNING) << "Failed to get cgroups from "
+                 << path::join(freezerHierarchy, flags.cgroups_root) << ": "
+                 << (walk.isFailed()
+                       ? walk.failure()
+                       : (walk.isReady() ? walk->error() : "discarded"));
+
+    known = None();
+    return;
+  }
+
+  hashset<ContainerID> unknown;
+
+  foreach (const string& cgroup, walk->get()) {
+    Option<ContainerID> containerId = parse(cgroup);
+    if (containerId.isSome() &&
+        !known->contains(containerId.get()) &&
+        !containers.contains(containerId.get())) {
+      unknown.insert(containerId.get());
+    }
+  }
+
+  known = None();
+
+  foreach (const ContainerID& containerId, unknown) {
+    // Destroying the cgroup of a container also destroys those of
+    // its nested containers.
+    if (containerId.has_parent() && unknown.contains(containerId.parent())) {
+      continue;
+    }
+
+    LOG(INFO) << "Destroying unknown orphaned container " << containerId;
+
+    cgroups::destroy(
+        freezerHierarchy,
+        cgroup(containerId),
+        cgroups::DESTROY_TIMEOUT)
+      .onFailed([containerId](const string& failure) {
+        LOG(ERROR) << "Failed to destroy unknown orphaned container "
+                   << containerId << ": " << failure;
+      });
+  }
+}
+
+
 Option<ContainerID> LinuxLauncherProcess::parse(const string& cgroup)
 {
   Option<ContainerID> current;
@@ -25,6 +25,7 @@ namespace mesos {
 namespace internal {
 namespace slave {
 
+class ForkServer;
 class LinuxLauncherProcess;
 
 // Launcher for Linux systems with cgroups. Uses a freezer cgroup to
@@ -63,7 +64,8 @@ private:
   LinuxLauncher(
       const Flags& flags,
       const std::string& freezerHierarchy,
-      const Option<std::string>& systemdHierarchy);
+      const Option<std::string>& systemdHierarchy,
+      const Option<process::Owned<ForkServer>>& forkServer);
 
   process::Owned<LinuxLauncherProcess> process;
 };
@@ -23,6 +23,8 @@
 #include "slave/containerizer/mesos/mount.hpp"
 
 #ifdef __linux__
+#include "slave/containerizer/mesos/fork_server.hpp"
+
 #include "slave/containerizer/mesos/isolators/network/cni/cni.hpp"
 #endif
 
@@ -45,6 +47,7 @@ int main(int argc, char** argv)
       argv,
       new MesosContainerizerLaunch(),
       new MesosContainerizerMount(),
+      new MesosContainerizerForkServer(),
       new NetworkCniIsolatorSetup());
 #else
   int success = Subcommand::dispatch(
@@ -255,6 +255,20 @@ bool getContainerForceDestroyOnRecovery(
 }
 
 
+string getContainerCpusetPath(
+    const string& runtimeDir,
+    const ContainerID& containerId)
+{
+  return path::join(getRuntimePath(runtimeDir, containerId), CPUSET_FILE);
+}
+
+
+string getLauncherCgroupsPath(const string& runtimeDir)
+{
+  return path::join(runtimeDir, LAUNCHER_CGROUPS_FILE);
+}
+
+
 Result<ContainerTermination> getContainerTermination(
     const string& runtimeDir,
     const ContainerID& containerId)
@@ -44,6 +44,8 @@ constexpr char SOCKET_FILE[] = "socket";
 constexpr char FORCE_DESTROY_ON_RECOVERY_FILE[] = "force_destroy_on_recovery";
 constexpr char IO_SWITCHBOARD_DIRECTORY[] = "io_switchboard";
 constexpr char CONTAINER_DIRECTORY[] = "containers";
+constexpr char CPUSET_FILE[] = "cpuset";
+constexpr char LAUNCHER_CGROUPS_FILE[] = "launcher_cgroups";
 
 
 enum Mode
@@ -143,6 +145,19 @@ bool getContainerForceDestroyOnRecovery(
     const ContainerID& containerId);
 
 
+// The helper method to get the path of the file with the exclusive
+// CPUs of the container (if any), see the cpuset cgroups subsystem.
+std::string getContainerCpusetPath(
+    const std::string& runtimeDir,
+    const ContainerID& containerId);
+
+
+// The Linux launcher checkpoints the freezer cgroups of all of its
+// containers (one per line) in this file, so that it doesn't need to
+// walk the freezer hierarchy in order to recover them.
+std::string getLauncherCgroupsPath(const std::string& runtimeDir);
+
+
 // The helper method to read the container termination state.
 Result<mesos::slave::ContainerTermination> getContainerTermination(
     const std::string& runtimeDir,
@@ -14,6 +14,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <functional>
 #include <list>
 
 #include <mesos/docker/spec.hpp>
@@ -27,10 +28,18 @@
 #include <process/subprocess.hpp>
 
 #include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/hashset.hpp>
 #include <stout/os.hpp>
 
 #include "common/status_utils.hpp"
 
+#ifdef __linux__
+#include "linux/fs.hpp"
+#endif // __linux__
+
+#include "slave/paths.hpp"
+
 #include "slave/containerizer/mesos/provisioner/backends/copy.hpp"
 
 using namespace process;
@@ -46,22 +55,88 @@ namespace slave {
 class CopyBackendProcess : public Process<CopyBackendProcess>
 {
 public:
-  CopyBackendProcess()
-    : ProcessBase(process::ID::generate("copy-provisioner-backend")) {}
+  CopyBackendProcess(
+      bool _shared,
+      const Option<Bytes>& _upperSize,
+      const string& _sharedDir)
+    : ProcessBase(process::ID::generate("copy-provisioner-backend")),
+      shared(_shared),
+      upperSize(_upperSize),
+      sharedDir(_sharedDir) {}
+
+  Future<Nothing> provision(
+      const vector<string>& layers,
+      const string& rootfs,
+      const string& backendDir);
 
-  Future<Nothing> provision(const vector<string>& layers, const string& rootfs);
+  Future<bool> destroy(const string& rootfs, const string& backendDir);
 
-  Future<bool> destroy(const string& rootfs);
+protected:
+  virtual void initialize();
 
 private:
+  // Copies the layers to the rootfs.
+  Future<Nothing> copy(const vector<string>& layers, const string& rootfs);
+
   Future<Nothing> _provision(string layer, const string& rootfs);
+
+#ifdef __linux__
+  // Provisions the rootfs as an overlay of the shared rootfs of the
+  // layers, which is copied first if it does not exist yet.
+  Future<Nothing> provisionShared(
+      const vector<string>& layers,
+      const string& rootfs,
+      const string& backendDir);
+
+  Future<Nothing> mount(
+      const string& id,
+      const string& rootfs,
+      const string& backendDir);
+
+  Future<bool> destroyShared(
+      const fs::MountInfoTable& table,
+      const fs::MountInfoTable::Entry& entry,
+      const string& backendDir);
+
+  // Returns the ids of the shared rootfses that are mounted.
+  Try<hashset<string>> mounted();
+
+  // Removes the shared rootfs if no container uses it.
+  void cleanup(const string& id);
+#endif // __linux__
+
+  const bool shared;
+  const Option<Bytes> upperSize;
+  const string sharedDir;
+
+  // The shared rootfses that are being copied, and the number of
+  // rootfses that are being provisioned from each shared rootfs.
+  hashmap<string, Future<Nothing>> copying;
+  hashmap<string, size_t> provisioning;
 };
 
 
-Try<Owned<Backend>> CopyBackend::create(const Flags&)
+Try<Owned<Backend>> CopyBackend::create(const Flags& flags)
 {
+#ifndef __linux__
+  if (flags.image_provisioner_shared_rootfs) {
+    return Error(
+        "'--image_provisioner_shared_rootfs' is only supported on Linux");
+  }
+#endif // __linux__
+
+  if (flags.image_provisioner_shared_rootfs && geteuid() != 0) {
+    return Error(
+        "'--image_provisioner_shared_rootfs' requires root privileges");
+  }
+
   return Owned<Backend>(new CopyBackend(
-      Owned<CopyBackendProcess>(new CopyBackendProcess())));
+      Owned<CopyBackendProcess>(new CopyBackendProcess(
+          flags.image_provisioner_shared_rootfs,
+          flags.image_provisioner_shared_rootfs_upper_size,
+          path::join(
+              slave::paths::getProvisionerDir(flags.work_dir),
+              "shared_rootfses")))));
 }
 
 
@@ -85,7 +160,11 @@ Future<Nothing> CopyBackend::provision(
     const string& backendDir)
 {
   return dispatch(
-      process.get(), &CopyBackendProcess::provision, layers, rootfs);
+      process.get(),
+      &CopyBackendProcess::provision,
+      layers,
+      rootfs,
+      backendDir);
 }
 
 
@@ -93,18 +172,83 @@ Future<bool> CopyBackend::destroy(
     const string& rootfs,
     const string& backendDir)
 {
-  return dispatch(process.get(), &CopyBackendProcess::destroy, rootfs);
+  return dispatch(
+      process.get(),
+      &CopyBackendProcess::destroy,
+      rootfs,
+      backendDir);
+}
+
+
+// Returns the id of the shared rootfs of the layers.
+static string chainId(const vector<string>& layers)
+{
+  return stringify(std::hash<string>()(strings::join("\n", layers)));
+}
+
+
+void CopyBackendProcess::initialize()
+{
+#ifdef __linux__
+  if (!shared) {
+    return;
+  }
+
+  Try<Nothing> mkdir = os::mkdir(sharedDir);
+  if (mkdir.isError()) {
+    LOG(ERROR) << "Failed to create the directory of shared rootfses '"
+               << sharedDir << "': " << mkdir.error();
+    return;
+  }
+
+  Try<list<string>> entries = os::ls(sharedDir);
+  if (entries.isError()) {
+    LOG(ERROR) << "Failed to list the shared rootfses in '" << sharedDir
+               << "': " << entries.error();
+    return;
+  }
+
+  // Remove the shared rootfses that were being copied (or removed)
+  // when the agent stopped, and those that are not used anymore.
+  foreach (const string& entry, entries.get()) {
+    if (strings::endsWith(entry, ".tmp")) {
+      const string dir = path::join(sharedDir, entry);
+
+      Try<Nothing> rmdir = os::rmdir(dir);
+      if (rmdir.isError()) {
+        LOG(WARNING) << "Failed to remove '" << dir << "': " << rmdir.error();
+      }
+    } else {
+      cleanup(entry);
+    }
+  }
+#endif // __linux__
 }
 
 
 Future<Nothing> CopyBackendProcess::provision(
     const vector<string>& layers,
-    const string& rootfs)
+    const string& rootfs,
+    const string& backendDir)
 {
   if (layers.size() == 0) {
     return Failure("No filesystem layers provided");
   }
 
+#ifdef __linux__
+  if (shared) {
+    return provisionShared(layers, rootfs, backendDir);
+  }
+#endif // __linux__
+
+  return copy(layers, rootfs);
+}
+
+
+Future<Nothing> CopyBackendProcess::copy(
+    const vector<string>& layers,
+    const string& rootfs)
+{
   if (os::exists(rootfs)) {
     return Failure("Rootfs is already provisioned");
   }
@@ -227,7 +371,11 @@ Future<Nothing> CopyBackendProcess::_provision(
   // slash so we only copy the content but not the folder.
   vector<string> args{"cp", "-a", layer, rootfs};
 #else
-  vector<string> args{"cp", "-aT", layer, rootfs};
+  // NOTE: With `--reflink=auto`, the files are cloned (i.e., share
+  // their data with the layer until either of them is written to) on
+  // filesystems supporting it (e.g., XFS, btrfs). This avoids copying
+  // the data of the layer. Otherwise, `cp` falls back to copying.
+  vector<string> args{"cp", "-aT", "--reflink=auto", layer, rootfs};
 #endif // __APPLE__ || __FreeBSD__
 
   Try<Subprocess> s = subprocess(
@@ -273,8 +421,360 @@ Future<Nothing> CopyBackendProcess::_provision(
 }
 
 
-Future<bool> CopyBackendProcess::destroy(const string& rootfs)
+#ifdef __linux__
+Future<Nothing> CopyBackendProcess::provisionShared(
+    const vector<string>& layers,
+    const string& rootfs,
+    const string& backendDir)
+{
+  if (os::exists(rootfs)) {
+    return Failure("Rootfs is already provisioned");
+  }
+
+  const string id = chainId(layers);
+  const string dir = path::join(sharedDir, id);
+
+  Future<Nothing> copied;
+
+  if (os::exists(dir)) {
+    Try<string> read = os::read(path::join(dir, "layers"));
+    if (read.isError()) {
+      return Failure(
+          "Failed to read the layers of the shared rootfs '" + dir + "': " +
+          read.error());
+    }
+
+    // NOTE: If another image has the same id, its containers do not
+    // share their rootfs.
+    if (read.get() != strings::join("\n", layers)) {
+      return copy(layers, rootfs);
+    }
+
+    copied = Nothing();
+  } else if (copying.contains(id)) {
+    copied = copying.at(id);
+  } else {
+    const string tempDir = dir + ".tmp";
+
+    if (os::exists(tempDir)) {
+      Try<Nothing> rmdir = os::rmdir(tempDir);
+      if (rmdir.isError()) {
+        return Failure(
+            "Failed to remove '" + tempDir + "': " + rmdir.error());
+      }
+    }
+
+    VLOG(1) << "Copying the shared rootfs '" << dir << "' of "
+            << layers.size() << " layers";
+
+    copied = copy(layers, path::join(tempDir, "rootfs"))
+      .then(defer(self(), [=]() -> Future<Nothing> {
+        Try<Nothing> write = os::write(
+            path::join(tempDir, "layers"),
+            strings::join("\n", layers));
+
+        if (write.isError()) {
+          return Failure(
+              "Failed to write the layers of the shared rootfs: " +
+              write.error());
+        }
+
+        Try<Nothing> rename = os::rename(tempDir, dir);
+        if (rename.isError()) {
+          return Failure(
+              "Failed to move the shared rootfs to '" + dir + "': " +
+              rename.error());
+        }
+
+        return Nothing();
+      }));
+
+    copying[id] = copied;
+
+    copied
+      .onAny(defer(self(), [=](const Future<Nothing>& future) {
+        copying.erase(id);
+
+        if (!future.isReady() && os::exists(tempDir)) {
+          os::rmdir(tempDir);
+        }
+      }));
+  }
+
+  provisioning[id]++;
+
+  return copied
+    .then(defer(self(), &Self::mount, id, rootfs, backendDir))
+    .onAny(defer(self(), [=](const Future<Nothing>& future) {
+      if (--provisioning[id] == 0) {
+        provisioning.erase(id);
+      }
+
+      if (!future.isReady()) {
+        cleanup(id);
+      }
+    }));
+}
+
+
+Future<Nothing> CopyBackendProcess::mount(
+    const string& id,
+    const string& rootfs,
+    const string& backendDir)
 {
+  const string lowerdir = path::join(sharedDir, id, "rootfs");
+  const string scratchDir =
+    path::join(backendDir, "scratch", Path(rootfs).basename());
+
+  Try<Nothing> mkdir = os::mkdir(scratchDir);
+  if (mkdir.isError()) {
+    return Failure(
+        "Failed to create the scratch directory '" + scratchDir + "': " +
+        mkdir.error());
+  }
+
+  // The writable layer of the container is kept in memory, if its
+  // size is limited.
+  if (upperSize.isSome()) {
+    Try<Nothing> mount = fs::mount(
+        "tmpfs",
+        scratchDir,
+        "tmpfs",
+        0,
+        "size=" + stringify(upperSize->bytes()));
+
+    if (mount.isError()) {
+      return Failure(
+          "Failed to mount tmpfs at '" + scratchDir + "': " + mount.error());
+    }
+  }
+
+  const string upperdir = path::join(scratchDir, "upperdir");
+  const string workdir = path::join(scratchDir, "workdir");
+
+  const vector<string> dirs = {upperdir, workdir, rootfs};
+
+  foreach (const string& dir, dirs) {
+    Try<Nothing> mkdir = os::mkdir(dir);
+    if (mkdir.isError()) {
+      return Failure("Failed to create '" + dir + "': " + mkdir.error());
+    }
+  }
+
+  const string options =
+    "lowerdir=" + lowerdir +
+    ",upperdir=" + upperdir +
+    ",workdir=" + workdir;
+
+  VLOG(1) << "Provisioning rootfs '" << rootfs << "' with overlayfs: '"
+          << options << "'";
+
+  Try<Nothing> mount = fs::mount("overlay", rootfs, "overlay", 0, options);
+  if (mount.isError()) {
+    if (upperSize.isSome()) {
+      fs::unmount(scratchDir);
+    }
+
+    return Failure(
+        "Failed to mount rootfs '" + rootfs + "' with overlayfs: " +
+        mount.error());
+  }
+
+  // Mark the mount as shared+slave, as the overlay backend does.
+  mount = fs::mount(None(), rootfs, None(), MS_SLAVE, nullptr);
+  if (mount.isError()) {
+    return Failure(
+        "Failed to mark mount '" + rootfs + "' as a slave mount: " +
+        mount.error());
+  }
+
+  mount = fs::mount(None(), rootfs, None(), MS_SHARED, nullptr);
+  if (mount.isError()) {
+    return Failure(
+        "Failed to mark mount '" + rootfs + "' as a shared mount: " +
+        mount.error());
+  }
+
+  return Nothing();
+}
+
+
+// Returns the lower directories of the overlay mount.
+static vector<string> lowerdirs(const fs::MountInfoTable::Entry& entry)
+{
+  foreach (const string& option, strings::tokenize(entry.fsOptions, ",")) {
+    if (strings::startsWith(option, "lowerdir=")) {
+      return strings::tokenize(option.substr(strlen("lowerdir=")), ":");
+    }
+  }
+
+  return {};
+}
+
+
+Try<hashset<string>> CopyBackendProcess::mounted()
+{
+  Try<fs::MountInfoTable> table = fs::MountInfoTable::read();
+  if (table.isError()) {
+    return Error("Failed to read mount table: " + table.error());
+  }
+
+  Result<string> realpath = os::realpath(sharedDir);
+  if (!realpath.isSome()) {
+    return Error(
+        "Failed to resolve '" + sharedDir + "': " +
+        (realpath.isError() ? realpath.error() : "not found"));
+  }
+
+  hashset<string> ids;
+
+  foreach (const fs::MountInfoTable::Entry& entry, table->entries) {
+    if (entry.type != "overlay") {
+      continue;
+    }
+
+    foreach (const string& lowerdir, lowerdirs(entry)) {
+      if (strings::startsWith(lowerdir, realpath.get() + "/")) {
+        ids.insert(strings::tokenize(
+            lowerdir.substr(realpath->size()), "/").front());
+      }
+    }
+  }
+
+  return ids;
+}
+
+
+void CopyBackendProcess::cleanup(const string& id)
+{
+  if (copying.contains(id) || provisioning.contains(id)) {
+    return;
+  }
+
+  const string dir = path::join(sharedDir, id);
+  if (!os::exists(dir)) {
+    return;
+  }
+
+  Try<hashset<string>> ids = mounted();
+  if (ids.isError()) {
+    LOG(WARNING) << "Failed to check whether the shared rootfs '" << dir
+                 << "' is used: " << ids.error();
+    return;
+  }
+
+  if (ids->contains(id)) {
+    return;
+  }
+
+  // We rename the shared rootfs before removing it, so that it is not
+  // used if the agent fails while removing it.
+  const string tempDir = dir + ".tmp";
+
+  Try<Nothing> rename = os::rename(dir, tempDir);
+  if (rename.isError()) {
+    LOG(WARNING) << "Failed to move '" << dir << "' to '" << tempDir
+                 << "': " << rename.error();
+    return;
+  }
+
+  Try<Nothing> rmdir = os::rmdir(tempDir);
+  if (rmdir.isError()) {
+    LOG(WARNING) << "Failed to remove '" << tempDir << "': "
+                 << rmdir.error();
+    return;
+  }
+
+  VLOG(1) << "Removed the shared rootfs '" << dir << "'";
+}
+
+
+Future<bool> CopyBackendProcess::destroyShared(
+    const fs::MountInfoTable& table,
+    const fs::MountInfoTable::Entry& entry,
+    const string& backendDir)
+{
+  const string rootfs = entry.target;
+
+  Option<string> id;
+
+  Result<string> realpath = os::realpath(sharedDir);
+  if (realpath.isSome()) {
+    foreach (const string& lowerdir, lowerdirs(entry)) {
+      if (strings::startsWith(lowerdir, realpath.get() + "/")) {
+        id = strings::tokenize(
+            lowerdir.substr(realpath->size()), "/").front();
+      }
+    }
+  }
+
+  // NOTE: This would fail if the rootfs is still in use.
+  Try<Nothing> unmount = fs::unmount(rootfs);
+  if (unmount.isError()) {
+    return Failure(
+        "Failed to destroy overlay-mounted rootfs '" + rootfs + "': " +
+        unmount.error());
+  }
+
+  Try<Nothing> rmdir = os::rmdir(rootfs);
+  if (rmdir.isError()) {
+    return Failure(
+        "Failed to remove rootfs mount point '" + rootfs + "': " +
+        rmdir.error());
+  }
+
+  const string scratchDir =
+    path::join(backendDir, "scratch", Path(rootfs).basename());
+
+  foreach (const fs::MountInfoTable::Entry& entry, table.entries) {
+    if (entry.target == scratchDir) {
+      Try<Nothing> unmount = fs::unmount(scratchDir);
+      if (unmount.isError()) {
+        return Failure(
+            "Failed to unmount '" + scratchDir + "': " + unmount.error());
+      }
+
+      break;
+    }
+  }
+
+  if (os::exists(scratchDir)) {
+    Try<Nothing> rmdir = os::rmdir(scratchDir);
+    if (rmdir.isError()) {
+      return Failure(
+          "Failed to remove the scratch directory '" + scratchDir + "': " +
+          rmdir.error());
+    }
+  }
+
+  if (id.isSome()) {
+    cleanup(id.get());
+  }
+
+  return true;
+}
+#endif // __linux__
+
+
+Future<bool> CopyBackendProcess::destroy(
+    const string& rootfs,
+    const string& backendDir)
+{
+#ifdef __linux__
+  // The rootfses provisioned from a shared rootfs are overlay mounts,
+  // which we check for even if the rootfses are not shared anymore.
+  Try<fs::MountInfoTable> table = fs::MountInfoTable::read();
+  if (table.isError()) {
+    return Failure("Failed to read mount table: " + table.error());
+  }
+
+  foreach (const fs::MountInfoTable::Entry& entry, table->entries) {
+    if (entry.target == rootfs && entry.type == "overlay") {
+      return destroyShared(table.get(), entry, backendDir);
+    }
+  }
+#endif // __linux__
+
   vector<string> argv{"rm", "-rf", rootfs};
 
   Try<Subprocess> s = subprocess(
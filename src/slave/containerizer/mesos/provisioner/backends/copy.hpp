@@ -35,12 +35,33 @@ class CopyBackendProcess;
 //    allocation.
 // 2) The task can write unrestrictedly into the provisioned rootfs
 //    which is not accounted for (in terms of disk usage) either.
+//
+// With `--image_provisioner_shared_rootfs`, the layers of an image are
+// copied once to a rootfs shared by the containers of the image, which
+// is mounted read-only under a writable layer in each container using
+// the overlay file system. The shared rootfses are removed once they
+// are not used by any container anymore:
+// <work_dir> ('--work_dir' flag)
+// |-- provisioner
+//     |-- shared_rootfses
+//         |-- <chain_id>
+//             |-- layers (the paths of the layers, one per line)
+//             |-- rootfs (the shared rootfs)
+//     |-- containers
+//         |-- <container-id>
+//             |-- backends
+//                 |-- copy
+//                    |-- rootfses
+//                        |-- <rootfs_id> (the overlay mount)
+//                    |-- scratch
+//                        |-- <rootfs_id> (a tmpfs if the size is limited)
+//                            |-- upperdir
+//                            |-- workdir
 class CopyBackend : public Backend
 {
 public:
   virtual ~CopyBackend();
 
-  // CopyBackend doesn't use any flag.
   static Try<process::Owned<Backend>> create(const Flags&);
 
   // Provisions a rootfs given the layers' paths and target rootfs
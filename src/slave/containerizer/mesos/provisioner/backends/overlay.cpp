@@ -14,29 +14,49 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <functional>
+#include <list>
+
+#include <process/clock.hpp>
+#include <process/defer.hpp>
 #include <process/dispatch.hpp>
 #include <process/id.hpp>
+#include <process/io.hpp>
 #include <process/process.hpp>
+#include <process/subprocess.hpp>
+#include <process/time.hpp>
 
 #include <stout/adaptor.hpp>
 #include <stout/foreach.hpp>
 #include <stout/fs.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/hashset.hpp>
 #include <stout/os.hpp>
 
 #include "linux/fs.hpp"
 
+#include "slave/paths.hpp"
+
 #include "slave/containerizer/mesos/provisioner/backends/overlay.hpp"
 
+namespace io = process::io;
+
+using process::Clock;
 using process::Failure;
 using process::Future;
 using process::Owned;
 using process::Process;
 using process::Shared;
+using process::Subprocess;
+using process::Time;
 
+using process::defer;
 using process::dispatch;
 using process::spawn;
+using process::subprocess;
 using process::wait;
 
+using std::list;
 using std::string;
 using std::vector;
 
@@ -47,8 +67,14 @@ namespace slave {
 class OverlayBackendProcess : public Process<OverlayBackendProcess>
 {
 public:
-  OverlayBackendProcess()
-    : ProcessBase(process::ID::generate("overlay-provisioner-backend")) {}
+  OverlayBackendProcess(
+      const Option<size_t>& _squashThreshold,
+      size_t _squashCacheSize,
+      const string& _squashDir)
+    : ProcessBase(process::ID::generate("overlay-provisioner-backend")),
+      squashThreshold(_squashThreshold),
+      squashCacheSize(_squashCacheSize),
+      squashDir(_squashDir) {}
 
   Future<Nothing> provision(
       const vector<string>& layers,
@@ -58,17 +84,65 @@ public:
   Future<bool> destroy(
       const string& rootfs,
       const string& backendDir);
+
+protected:
+  virtual void initialize();
+
+private:
+  // A chain of layers that is flattened once it is used again.
+  struct Chain
+  {
+    Chain() : uses(0), building(false), squashed(false) {}
+
+    vector<string> layers;
+    size_t uses;
+    Time lastUsed;
+
+    bool building;
+    bool squashed;
+  };
+
+  static string chainId(const vector<string>& layers);
+
+  // Returns the lower directories to mount for the layers, i.e., the
+  // flattened layer if the chain has been flattened, and the layers
+  // otherwise. Starts flattening the chain if it is used again.
+  vector<string> lowerdirs(const vector<string>& layers);
+
+  Future<Nothing> squash(const string& id, const vector<string>& layers);
+  void _squash(const string& id, const Future<Nothing>& future);
+
+  // Removes the least recently used flattened layers that are not
+  // mounted, until at most `squashCacheSize` of them are left.
+  void evict();
+
+  const Option<size_t> squashThreshold;
+  const size_t squashCacheSize;
+  const string squashDir;
+
+  hashmap<string, Chain> chains;
 };
 
 
-Try<Owned<Backend>> OverlayBackend::create(const Flags&)
+Try<Owned<Backend>> OverlayBackend::create(const Flags& flags)
 {
   if (geteuid() != 0) {
     return Error("OverlayBackend requires root privileges");
   }
 
+  if (flags.image_provisioner_overlay_squash_threshold.isSome() &&
+      flags.image_provisioner_overlay_squash_threshold.get() < 2) {
+    return Error(
+        "'--image_provisioner_overlay_squash_threshold' must be at least 2");
+  }
+
   return Owned<Backend>(new OverlayBackend(
-      Owned<OverlayBackendProcess>(new OverlayBackendProcess())));
+      Owned<OverlayBackendProcess>(new OverlayBackendProcess(
+          flags.image_provisioner_overlay_squash_threshold,
+          flags.image_provisioner_overlay_squash_cache_size,
+          path::join(
+              slave::paths::getProvisionerDir(flags.work_dir),
+              "squashed_layers")))));
 }
 
 
@@ -111,15 +185,359 @@ Future<bool> OverlayBackend::destroy(
 }
 
 
+void OverlayBackendProcess::initialize()
+{
+  if (squashThreshold.isNone()) {
+    return;
+  }
+
+  Try<Nothing> mkdir = os::mkdir(squashDir);
+  if (mkdir.isError()) {
+    LOG(ERROR) << "Failed to create the directory of flattened layers '"
+               << squashDir << "': " << mkdir.error();
+    return;
+  }
+
+  Try<list<string>> entries = os::ls(squashDir);
+  if (entries.isError()) {
+    LOG(ERROR) << "Failed to list the flattened layers in '" << squashDir
+               << "': " << entries.error();
+    return;
+  }
+
+  // Recover the flattened layers, and remove the ones that were being
+  // built (or removed) when the agent stopped.
+  foreach (const string& entry, entries.get()) {
+    const string dir = path::join(squashDir, entry);
+
+    Try<string> layers = os::read(path::join(dir, "layers"));
+
+    if (strings::endsWith(entry, ".tmp") || layers.isError()) {
+      Try<Nothing> rmdir = os::rmdir(dir);
+      if (rmdir.isError()) {
+        LOG(WARNING) << "Failed to remove '" << dir << "': " << rmdir.error();
+      }
+
+      continue;
+    }
+
+    Chain& chain = chains[entry];
+    chain.layers = strings::split(layers.get(), "\n");
+    chain.squashed = true;
+  }
+}
+
+
+string OverlayBackendProcess::chainId(const vector<string>& layers)
+{
+  return stringify(std::hash<string>()(strings::join("\n", layers)));
+}
+
+
+vector<string> OverlayBackendProcess::lowerdirs(const vector<string>& layers)
+{
+  if (squashThreshold.isNone() || layers.size() < squashThreshold.get()) {
+    return layers;
+  }
+
+  const string id = chainId(layers);
+
+  Chain& chain = chains[id];
+
+  if (chain.layers.empty()) {
+    chain.layers = layers;
+  } else if (chain.layers != layers) {
+    // Another chain has the same id, which we do not flatten.
+    return layers;
+  }
+
+  chain.uses++;
+  chain.lastUsed = Clock::now();
+
+  if (chain.squashed) {
+    VLOG(1) << "Provisioning with the flattened layer of chain '" << id
+            << "' of " << layers.size() << " layers";
+
+    return {path::join(squashDir, id, "rootfs")};
+  }
+
+  // NOTE: We only flatten the chains that are used more than once,
+  // and in the background, so that this does not delay provisioning.
+  if (chain.uses > 1 && !chain.building) {
+    chain.building = true;
+
+    squash(id, layers)
+      .onAny(defer(self(), &Self::_squash, id, lambda::_1));
+  }
+
+  return layers;
+}
+
+
+Future<Nothing> OverlayBackendProcess::squash(
+    const string& id,
+    const vector<string>& layers)
+{
+  const string tempDir = path::join(squashDir, id + ".tmp");
+  const string target = path::join(tempDir, "mnt");
+  const string rootfs = path::join(tempDir, "rootfs");
+
+  VLOG(1) << "Flattening chain '" << id << "' of " << layers.size()
+          << " layers into '" << rootfs << "'";
+
+  if (os::exists(tempDir)) {
+    Try<Nothing> rmdir = os::rmdir(tempDir);
+    if (rmdir.isError()) {
+      return Failure(
+          "Failed to remove '" + tempDir + "': " + rmdir.error());
+    }
+  }
+
+  const vector<string> dirs = {target, rootfs};
+
+  foreach (const string& dir, dirs) {
+    Try<Nothing> mkdir = os::mkdir(dir);
+    if (mkdir.isError()) {
+      return Failure("Failed to create '" + dir + "': " + mkdir.error());
+    }
+  }
+
+  // As in `provision`, we mount the layers using short symlinks.
+  Try<string> linksDir = os::mkdtemp();
+  if (linksDir.isError()) {
+    return Failure(
+        "Failed to create temporary directory for symlinks to layers: " +
+        linksDir.error());
+  }
+
+  vector<string> links;
+  links.reserve(layers.size());
+
+  foreach (const string& layer, layers) {
+    const string link = path::join(linksDir.get(), stringify(links.size()));
+
+    Try<Nothing> symlink = ::fs::symlink(layer, link);
+    if (symlink.isError()) {
+      os::rmdir(linksDir.get());
+      return Failure(
+          "Failed to create symlink at '" + link +
+          "' -> '" + layer + "': " + symlink.error());
+    }
+
+    links.push_back(link);
+  }
+
+  // A read-only overlay of the layers (without an upperdir) shows the
+  // merged layers, which we copy to get the flattened layer.
+  Try<Nothing> mount = fs::mount(
+      "overlay",
+      target,
+      "overlay",
+      MS_RDONLY,
+      "lowerdir=" + strings::join(":", adaptor::reverse(links)));
+
+  if (mount.isError()) {
+    os::rmdir(linksDir.get());
+    return Failure(
+        "Failed to mount the layers at '" + target + "': " + mount.error());
+  }
+
+  const vector<string> argv = {"cp", "-aT", "--reflink=auto", target, rootfs};
+
+  Try<Subprocess> s = subprocess(
+      "cp",
+      argv,
+      Subprocess::PATH("/dev/null"),
+      Subprocess::PATH("/dev/null"),
+      Subprocess::PIPE());
+
+  if (s.isError()) {
+    fs::unmount(target);
+    os::rmdir(linksDir.get());
+    return Failure("Failed to create 'cp' subprocess: " + s.error());
+  }
+
+  Subprocess cp = s.get();
+
+  return cp.status()
+    .then([=](const Option<int>& status) -> Future<Nothing> {
+      Try<Nothing> unmount = fs::unmount(target);
+      os::rmdir(linksDir.get());
+
+      if (status.isNone()) {
+        return Failure("Failed to reap the 'cp' subprocess");
+      } else if (status.get() != 0) {
+        return io::read(cp.err().get())
+          .then([](const string& err) -> Future<Nothing> {
+            return Failure("Failed to copy the layers: " + err);
+          });
+      }
+
+      if (unmount.isError()) {
+        return Failure(
+            "Failed to unmount '" + target + "': " + unmount.error());
+      }
+
+      Try<Nothing> rmdir = os::rmdir(target);
+      if (rmdir.isError()) {
+        return Failure(
+            "Failed to remove '" + target + "': " + rmdir.error());
+      }
+
+      Try<Nothing> write = os::write(
+          path::join(tempDir, "layers"),
+          strings::join("\n", layers));
+
+      if (write.isError()) {
+        return Failure("Failed to write the layers: " + write.error());
+      }
+
+      Try<Nothing> rename = os::rename(tempDir, path::join(squashDir, id));
+      if (rename.isError()) {
+        return Failure(
+            "Failed to move the flattened layer: " + rename.error());
+      }
+
+      return Nothing();
+    });
+}
+
+
+void OverlayBackendProcess::_squash(
+    const string& id,
+    const Future<Nothing>& future)
+{
+  Chain& chain = chains[id];
+  chain.building = false;
+
+  if (!future.isReady()) {
+    LOG(WARNING) << "Failed to flatten chain '" << id << "' of "
+                 << chain.layers.size() << " layers: "
+                 << (future.isFailed() ? future.failure() : "discarded");
+
+    const string tempDir = path::join(squashDir, id + ".tmp");
+    if (os::exists(tempDir)) {
+      os::rmdir(tempDir);
+    }
+
+    return;
+  }
+
+  LOG(INFO) << "Flattened chain '" << id << "' of " << chain.layers.size()
+            << " layers";
+
+  chain.squashed = true;
+
+  evict();
+}
+
+
+void OverlayBackendProcess::evict()
+{
+  size_t squashed = 0;
+  foreachvalue (const Chain& chain, chains) {
+    if (chain.squashed) {
+      squashed++;
+    }
+  }
+
+  if (squashed <= squashCacheSize) {
+    return;
+  }
+
+  Try<fs::MountInfoTable> table = fs::MountInfoTable::read();
+  if (table.isError()) {
+    LOG(WARNING) << "Failed to read the mount table to evict flattened"
+                 << " layers: " << table.error();
+    return;
+  }
+
+  Result<string> realpath = os::realpath(squashDir);
+  if (!realpath.isSome()) {
+    LOG(WARNING) << "Failed to resolve '" << squashDir << "': "
+                 << (realpath.isError() ? realpath.error() : "not found");
+    return;
+  }
+
+  // The flattened layers that are lower directories of overlay mounts,
+  // which we must not remove. These are mounted through symlinks.
+  hashset<string> mounted;
+
+  foreach (const fs::MountInfoTable::Entry& entry, table->entries) {
+    if (entry.type != "overlay") {
+      continue;
+    }
+
+    foreach (const string& option, strings::tokenize(entry.fsOptions, ",")) {
+      if (!strings::startsWith(option, "lowerdir=")) {
+        continue;
+      }
+
+      foreach (const string& lowerdir,
+               strings::tokenize(option.substr(strlen("lowerdir=")), ":")) {
+        Result<string> layer = os::realpath(lowerdir);
+        if (layer.isSome() &&
+            strings::startsWith(layer.get(), realpath.get() + "/")) {
+          mounted.insert(strings::tokenize(
+              layer->substr(realpath->size()), "/").front());
+        }
+      }
+    }
+  }
+
+  while (squashed > squashCacheSize) {
+    Option<string> lru;
+
+    foreachkey (const string& id, chains) {
+      const Chain& chain = chains.at(id);
+
+      if (chain.squashed && !mounted.contains(id) &&
+          (lru.isNone() || chain.lastUsed < chains.at(lru.get()).lastUsed)) {
+        lru = id;
+      }
+    }
+
+    if (lru.isNone()) {
+      return;
+    }
+
+    // We rename the flattened layer before removing it, so that it is
+    // not considered flattened if the agent fails while removing it.
+    const string dir = path::join(squashDir, lru.get());
+    const string tempDir = dir + ".tmp";
+
+    Try<Nothing> rename = os::rename(dir, tempDir);
+    if (rename.isError()) {
+      LOG(WARNING) << "Failed to move '" << dir << "' to '" << tempDir
+                   << "': " << rename.error();
+      return;
+    }
+
+    Try<Nothing> rmdir = os::rmdir(tempDir);
+    if (rmdir.isError()) {
+      LOG(WARNING) << "Failed to remove '" << tempDir << "': "
+                   << rmdir.error();
+    }
+
+    VLOG(1) << "Evicted the flattened layer of chain '" << lru.get() << "'";
+
+    chains.erase(lru.get());
+    squashed--;
+  }
+}
+
+
 Future<Nothing> OverlayBackendProcess::provision(
-    const vector<string>& layers,
+    const vector<string>& _layers,
     const string& rootfs,
     const string& backendDir)
 {
-  if (layers.size() == 0) {
+  if (_layers.size() == 0) {
     return Failure("No filesystem layer provided");
   }
 
+  const vector<string> layers = lowerdirs(_layers);
+
   Try<Nothing> mkdir = os::mkdir(rootfs);
   if (mkdir.isError()) {
     return Failure(
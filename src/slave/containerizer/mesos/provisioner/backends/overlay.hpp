@@ -42,6 +42,18 @@ class OverlayBackendProcess;
 //                            |-- upperdir
 //                            |-- workdir
 //                            |-- links (symlink to temp dir with links to layers) // NOLINT(whitespace/line_length)
+//
+// If `--image_provisioner_overlay_squash_threshold` is set, the chains
+// of layers of deep images are flattened into a single layer once they
+// are provisioned a second time, so that later containers mount one
+// lower directory instead of many. The flattened layers are cached as
+// follows, and built in a temporary '<chain_id>.tmp' directory:
+// <work_dir> ('--work_dir' flag)
+// |-- provisioner
+//     |-- squashed_layers
+//         |-- <chain_id>
+//             |-- layers (the paths of the layers, one per line)
+//             |-- rootfs (the flattened layer)
 class OverlayBackend : public Backend
 {
 public:
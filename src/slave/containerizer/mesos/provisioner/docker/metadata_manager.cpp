@@ -24,6 +24,7 @@
 #include <stout/os.hpp>
 #include <stout/protobuf.hpp>
 
+#include <process/clock.hpp>
 #include <process/defer.hpp>
 #include <process/dispatch.hpp>
 #include <process/owned.hpp>
@@ -41,6 +42,7 @@ namespace spec = docker::spec;
 using std::string;
 using std::vector;
 
+using process::Clock;
 using process::Failure;
 using process::Future;
 using process::Owned;
@@ -67,7 +69,9 @@ public:
       const spec::ImageReference& reference,
       bool cached);
 
-  // TODO(chenlily): Implement removal of unreferenced images.
+  Future<vector<Image>> images();
+
+  Future<Nothing> remove(const vector<spec::ImageReference>& references);
 
 private:
   // Write out metadata manager state to persistent store.
@@ -134,6 +138,22 @@ Future<Option<Image>> MetadataManager::get(
 }
 
 
+Future<vector<Image>> MetadataManager::images()
+{
+  return dispatch(process.get(), &MetadataManagerProcess::images);
+}
+
+
+Future<Nothing> MetadataManager::remove(
+    const vector<spec::ImageReference>& references)
+{
+  return dispatch(
+      process.get(),
+      &MetadataManagerProcess::remove,
+      references);
+}
+
+
 Future<Image> MetadataManagerProcess::put(
     const spec::ImageReference& reference,
     const vector<string>& layerIds)
@@ -146,6 +166,8 @@ Future<Image> MetadataManagerProcess::put(
     dockerImage.add_layer_ids(layerId);
   }
 
+  dockerImage.set_last_used(Clock::now().secs());
+
   storedImages[imageReference] = dockerImage;
 
   Try<Nothing> status = persist();
@@ -176,10 +198,48 @@ Future<Option<Image>> MetadataManagerProcess::get(
     return None();
   }
 
+  storedImages[imageReference].set_last_used(Clock::now().secs());
+
+  // NOTE: Failing to persist when the image was last used only
+  // affects the order in which images are evicted after a restart,
+  // hence we do not fail here.
+  Try<Nothing> status = persist();
+  if (status.isError()) {
+    LOG(WARNING) << "Failed to save state of Docker images: "
+                 << status.error();
+  }
+
   return storedImages[imageReference];
 }
 
 
+Future<vector<Image>> MetadataManagerProcess::images()
+{
+  vector<Image> images;
+  foreachvalue (const Image& image, storedImages) {
+    images.push_back(image);
+  }
+
+  return images;
+}
+
+
+Future<Nothing> MetadataManagerProcess::remove(
+    const vector<spec::ImageReference>& references)
+{
+  foreach (const spec::ImageReference& reference, references) {
+    storedImages.erase(stringify(reference));
+  }
+
+  Try<Nothing> status = persist();
+  if (status.isError()) {
+    return Failure("Failed to save state of Docker images: " + status.error());
+  }
+
+  return Nothing();
+}
+
+
 Try<Nothing> MetadataManagerProcess::persist()
 {
   Images images;
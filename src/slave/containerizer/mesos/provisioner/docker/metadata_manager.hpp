@@ -19,6 +19,7 @@
 
 #include <list>
 #include <string>
+#include <vector>
 
 #include <stout/hashmap.hpp>
 #include <stout/json.hpp>
@@ -51,8 +52,8 @@ class MetadataManagerProcess;
  * provisioner that are stored on disk. It keeps track of the layers
  * that Docker images are composed of and recovers Image objects
  * upon initialization by checking for dependent layers stored on disk.
- * Currently, image layers are stored indefinitely, with no garbage
- * collection of unreferenced image layers.
+ * It also tracks when each image was last used, so that the store can
+ * evict the least recently used images (see `Store::prune`).
  */
 class MetadataManager
 {
@@ -92,6 +93,20 @@ public:
       const ::docker::spec::ImageReference& reference,
       bool cached);
 
+  /**
+   * Retrieve all the Images stored in memory.
+   */
+  process::Future<std::vector<Image>> images();
+
+  /**
+   * Remove the Images with the given references from the metadata
+   * manager and persist the reference store state to disk.
+   *
+   * @param references the references of the Docker images to remove.
+   */
+  process::Future<Nothing> remove(
+      const std::vector<::docker::spec::ImageReference>& references);
+
 private:
   explicit MetadataManager(process::Owned<MetadataManagerProcess> process);
 
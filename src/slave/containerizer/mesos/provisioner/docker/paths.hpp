@@ -39,6 +39,8 @@ namespace paths {
  *           |-- rootfs
  *           |-- json(manifest)
  *           |-- VERSION
+ *    |--gc
+ *       |--<layer_id> (evicted layers being removed)
  *    |--storedImages (file holding on cached images)
  */
 
@@ -49,6 +51,9 @@ std::string getStagingDir(const std::string& storeDir);
 std::string getStagingTempDir(const std::string& storeDir);
 
 
+std::string getImageLayersDir(const std::string& storeDir);
+
+
 std::string getImageLayerPath(
     const std::string& storeDir,
     const std::string& layerId);
@@ -90,6 +95,9 @@ std::string getImageArchiveTarPath(
 
 std::string getStoredImagesPath(const std::string& storeDir);
 
+
+std::string getGcDir(const std::string& storeDir);
+
 } // namespace paths {
 } // namespace docker {
 } // namespace slave {
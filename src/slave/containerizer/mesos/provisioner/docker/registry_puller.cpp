@@ -14,41 +14,74 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <fcntl.h>
+
+#include <sys/stat.h>
+
+#include <functional>
+#include <queue>
+#include <tuple>
+
 #include <glog/logging.h>
 
 #include <process/collect.hpp>
 #include <process/defer.hpp>
 #include <process/dispatch.hpp>
 #include <process/http.hpp>
+#include <process/io.hpp>
+#include <process/loop.hpp>
+#include <process/subprocess.hpp>
 
+#include <process/metrics/counter.hpp>
+#include <process/metrics/metrics.hpp>
+
+#include <stout/net.hpp>
+#include <stout/numify.hpp>
+#include <stout/strings.hpp>
+
+#include <stout/os/close.hpp>
 #include <stout/os/exists.hpp>
 #include <stout/os/mkdir.hpp>
+#include <stout/os/open.hpp>
 #include <stout/os/rm.hpp>
 #include <stout/os/write.hpp>
 
 #include "common/command_utils.hpp"
 
 #include "uri/schemes/docker.hpp"
+#include "uri/schemes/http.hpp"
+
+#include "slave/containerizer/mesos/provisioner/constants.hpp"
 
 #include "slave/containerizer/mesos/provisioner/docker/paths.hpp"
 #include "slave/containerizer/mesos/provisioner/docker/registry_puller.hpp"
+#include "slave/containerizer/mesos/provisioner/docker/store.hpp"
 
 namespace http = process::http;
 namespace spec = docker::spec;
 
 using std::list;
+using std::queue;
 using std::string;
+using std::tuple;
 using std::vector;
 
+using process::Break;
+using process::Continue;
+using process::ControlFlow;
 using process::Failure;
 using process::Future;
 using process::Owned;
 using process::Process;
+using process::Promise;
 using process::Shared;
+using process::Subprocess;
 
 using process::defer;
 using process::dispatch;
+using process::loop;
 using process::spawn;
+using process::subprocess;
 using process::wait;
 
 namespace mesos {
@@ -56,12 +89,31 @@ namespace internal {
 namespace slave {
 namespace docker {
 
+// The ID of the registry puller process if the layers in the store
+// are served to the peers (see `--docker_layer_peers`), which use it
+// to construct the URIs of the layers.
+static const char PEER_PROCESS_ID[] = "docker-provisioner-registry-puller";
+
+
+// An agent that shares the layers in its store with this agent.
+struct Peer
+{
+  string host;
+  int port;
+
+  // Whether the peer is this agent.
+  bool self;
+};
+
+
 class RegistryPullerProcess : public Process<RegistryPullerProcess>
 {
 public:
   RegistryPullerProcess(
       const string& _storeDir,
       const http::URL& _defaultRegistryUrl,
+      size_t _maxConcurrentLayerPulls,
+      const Option<vector<Peer>>& _peers,
       const Shared<uri::Fetcher>& _fetcher);
 
   Future<vector<string>> pull(
@@ -69,7 +121,16 @@ public:
       const string& directory,
       const string& backend);
 
+protected:
+  virtual void initialize();
+
 private:
+  // Serves the layer (in the store) at '/layers/<layer id>' as an
+  // uncompressed tarball of its rootfs for the given `backend` query
+  // parameter (the copy backend by default).
+  Future<http::Response> layers(const http::Request& request);
+  Future<http::Response> _layers(const string& rootfs);
+
   Future<vector<string>> _pull(
       const spec::ImageReference& reference,
       const string& directory,
@@ -79,14 +140,49 @@ private:
     const spec::ImageReference& reference,
     const string& directory,
     const spec::v2::ImageManifest& manifest,
-    const hashset<string>& blobSums,
     const string& backend);
 
-  Future<hashset<string>> fetchBlobs(
-    const spec::ImageReference& reference,
-    const string& directory,
-    const spec::v2::ImageManifest& manifest,
-    const string& backend);
+  // Pulls a layer into its rootfs once one of the
+  // `maxConcurrentLayerPulls` slots is available, from the peer of the
+  // layer if there is one, falling back to the blob in the registry.
+  Future<Nothing> pullLayer(
+      const URI& blobUri,
+      const string& layerId,
+      const string& layerPath,
+      const string& rootfs,
+      const string& backend);
+
+  Future<Nothing> _pullLayer(
+      const URI& blobUri,
+      const string& layerId,
+      const string& layerPath,
+      const string& rootfs,
+      const string& backend);
+
+  // Extracts the tarball at the given URI into the rootfs.
+  Future<Nothing> extractLayer(
+      const URI& uri,
+      const string& layerPath,
+      const string& rootfs,
+      const Option<command::Compression>& compression);
+
+  // Moves the pulled layer from the staging directory into the store.
+  Future<Nothing> moveLayer(
+      const string& directory,
+      const string& layerId,
+      const string& backend);
+
+  Future<Nothing> acquire();
+  void release();
+
+  Try<URI> getBlobUri(
+      const spec::ImageReference& reference,
+      const string& blobSum);
+
+  // Returns the URI of the layer on its peer, unless the layer is not
+  // pulled from a peer (i.e., no peers are configured or this agent is
+  // the peer of the layer, which pulls it from the registry).
+  Option<URI> getPeerUri(const string& layerId, const string& backend);
 
   RegistryPullerProcess(const RegistryPullerProcess&) = delete;
   RegistryPullerProcess& operator=(const RegistryPullerProcess&) = delete;
@@ -97,7 +193,36 @@ private:
   // reference, this registry url will be used as the default.
   const http::URL defaultRegistryUrl;
 
+  const size_t maxConcurrentLayerPulls;
+
+  // The peers sharing the layers with this agent (including this
+  // agent, if it is one of them), if any.
+  const Option<vector<Peer>> peers;
+
   Shared<uri::Fetcher> fetcher;
+
+  // The number of layers being pulled, and the layer pulls waiting
+  // for a slot (in the order they were requested).
+  size_t layerPulls;
+  queue<Owned<Promise<Nothing>>> pendingLayerPulls;
+
+  // The layers being pulled into the store, keyed by the rootfs of
+  // the layer in the store (i.e., by the layer id and the backend).
+  // An image pull that needs a layer which is already being pulled
+  // (e.g., a common base layer of another image) waits for that pull
+  // instead of pulling the layer again.
+  hashmap<string, Future<Nothing>> pulling;
+
+  struct Metrics
+  {
+    Metrics();
+    ~Metrics();
+
+    process::metrics::Counter layer_pulls;
+    process::metrics::Counter layer_pulls_deduplicated;
+    process::metrics::Counter layer_pulls_from_peers;
+    process::metrics::Counter layer_peer_misses;
+  } metrics;
 };
 
 
@@ -112,6 +237,43 @@ Try<Owned<Puller>> RegistryPuller::create(
         defaultRegistryUrl.error());
   }
 
+  Option<vector<Peer>> peers;
+
+  if (flags.docker_layer_peers.isSome()) {
+    peers = vector<Peer>();
+
+    const process::network::inet::Address address = process::address();
+
+    foreach (const string& peer,
+             strings::tokenize(flags.docker_layer_peers.get(), ",")) {
+      vector<string> tokens = strings::split(strings::trim(peer), ":");
+      if (tokens.size() != 2) {
+        return Error("Invalid Docker layer peer '" + peer + "'");
+      }
+
+      Try<uint16_t> port = numify<uint16_t>(tokens[1]);
+      if (port.isError()) {
+        return Error(
+            "Invalid port of Docker layer peer '" + peer + "': " +
+            port.error());
+      }
+
+      // NOTE: This agent does not pull layers from itself, since it
+      // would wait for the pull of the layer it is serving.
+      Try<net::IP> ip = net::getIP(tokens[0], AF_INET);
+      if (ip.isError()) {
+        return Error(
+            "Failed to resolve Docker layer peer '" + peer + "': " +
+            ip.error());
+      }
+
+      peers->push_back(Peer{
+          tokens[0],
+          port.get(),
+          ip.get() == address.ip && port.get() == address.port});
+    }
+  }
+
   VLOG(1) << "Creating registry puller with docker registry '"
           << flags.docker_registry << "'";
 
@@ -119,6 +281,8 @@ Try<Owned<Puller>> RegistryPuller::create(
       new RegistryPullerProcess(
           flags.docker_store_dir,
           defaultRegistryUrl.get(),
+          flags.docker_max_concurrent_layer_pulls,
+          peers,
           fetcher));
 
   return Owned<Puller>(new RegistryPuller(process));
@@ -156,11 +320,54 @@ Future<vector<string>> RegistryPuller::pull(
 RegistryPullerProcess::RegistryPullerProcess(
     const string& _storeDir,
     const http::URL& _defaultRegistryUrl,
+    size_t _maxConcurrentLayerPulls,
+    const Option<vector<Peer>>& _peers,
     const Shared<uri::Fetcher>& _fetcher)
-  : ProcessBase(process::ID::generate("docker-provisioner-registry-puller")),
+  : ProcessBase(_peers.isSome()
+      ? PEER_PROCESS_ID
+      : process::ID::generate("docker-provisioner-registry-puller")),
     storeDir(_storeDir),
     defaultRegistryUrl(_defaultRegistryUrl),
-    fetcher(_fetcher) {}
+    maxConcurrentLayerPulls(_maxConcurrentLayerPulls),
+    peers(_peers),
+    fetcher(_fetcher),
+    layerPulls(0) {}
+
+
+void RegistryPullerProcess::initialize()
+{
+  if (peers.isSome()) {
+    route("/layers", None(), &Self::layers);
+  }
+}
+
+
+RegistryPullerProcess::Metrics::Metrics()
+  : layer_pulls(
+        "containerizer/mesos/provisioner/docker_store/layer_pulls"),
+    layer_pulls_deduplicated(
+        "containerizer/mesos/provisioner/docker_store/"
+        "layer_pulls_deduplicated"),
+    layer_pulls_from_peers(
+        "containerizer/mesos/provisioner/docker_store/"
+        "layer_pulls_from_peers"),
+    layer_peer_misses(
+        "containerizer/mesos/provisioner/docker_store/layer_peer_misses")
+{
+  process::metrics::add(layer_pulls);
+  process::metrics::add(layer_pulls_deduplicated);
+  process::metrics::add(layer_pulls_from_peers);
+  process::metrics::add(layer_peer_misses);
+}
+
+
+RegistryPullerProcess::Metrics::~Metrics()
+{
+  process::metrics::remove(layer_pulls);
+  process::metrics::remove(layer_pulls_deduplicated);
+  process::metrics::remove(layer_pulls_from_peers);
+  process::metrics::remove(layer_peer_misses);
+}
 
 
 static spec::ImageReference normalize(
@@ -277,14 +484,7 @@ Future<vector<string>> RegistryPullerProcess::_pull(
     return Failure("'fsLayers' and 'history' have different size in manifest");
   }
 
-  return fetchBlobs(reference, directory, manifest.get(), backend)
-    .then(defer(self(),
-                &Self::__pull,
-                reference,
-                directory,
-                manifest.get(),
-                lambda::_1,
-                backend));
+  return __pull(reference, directory, manifest.get(), backend);
 }
 
 
@@ -292,7 +492,6 @@ Future<vector<string>> RegistryPullerProcess::__pull(
     const spec::ImageReference& reference,
     const string& directory,
     const spec::v2::ImageManifest& manifest,
-    const hashset<string>& blobSums,
     const string& backend)
 {
   // Docker reads the layer ids from the disk:
@@ -338,17 +537,34 @@ Future<vector<string>> RegistryPullerProcess::__pull(
     uniqueIds.insert(v1.id());
 
     // Skip if the layer is already in the store.
-    if (os::exists(
-        paths::getImageLayerRootfsPath(storeDir, v1.id(), backend))) {
+    const string storeRootfs =
+      paths::getImageLayerRootfsPath(storeDir, v1.id(), backend);
+
+    if (os::exists(storeRootfs)) {
+      continue;
+    }
+
+    // Wait for the layer if it is already being pulled.
+    if (pulling.contains(storeRootfs)) {
+      VLOG(1) << "Waiting for the pull of layer '" << v1.id() << "' "
+              << "of image '" << reference << "' already in progress";
+
+      futures.push_back(pulling.at(storeRootfs));
+      ++metrics.layer_pulls_deduplicated;
       continue;
     }
 
+    Try<URI> blobUri = getBlobUri(reference, blobSum);
+    if (blobUri.isError()) {
+      return Failure(blobUri.error());
+    }
+
     const string layerPath = path::join(directory, v1.id());
-    const string tar = path::join(directory, blobSum);
     const string rootfs = paths::getImageLayerRootfsPath(layerPath, backend);
     const string json = paths::getImageLayerManifestPath(layerPath);
 
-    VLOG(1) << "Extracting layer tar ball '" << tar
+    VLOG(1) << "Pulling blob '" << blobSum << "' for layer '"
+            << v1.id() << "' of image '" << reference << "'"
             << " to rootfs '" << rootfs << "'";
 
     // NOTE: This will create 'layerPath' as well.
@@ -366,107 +582,416 @@ Future<vector<string>> RegistryPullerProcess::__pull(
           v1.id() + "': " + write.error());
     }
 
-    futures.push_back(command::untar(Path(tar), Path(rootfs)));
+    // NOTE: The layer is moved into the store as soon as it has been
+    // pulled (rather than along with the rest of the image by the
+    // store), so that other image pulls waiting for the layer can
+    // find it in the store.
+    Future<Nothing> future =
+      pullLayer(blobUri.get(), v1.id(), layerPath, rootfs, backend)
+      .then(defer(self(), &Self::moveLayer, directory, v1.id(), backend))
+      .onAny(defer(self(), [=](const Future<Nothing>&) {
+        pulling.erase(storeRootfs);
+      }));
+
+    ++metrics.layer_pulls;
+
+    // NOTE: The future might already be completed (e.g., if the layer
+    // failed to be fetched synchronously), in which case it is not
+    // entered into the table, since `onAny` has already been called.
+    if (future.isPending()) {
+      pulling.put(storeRootfs, future);
+    }
+
+    futures.push_back(future);
   }
 
   return collect(futures)
-    .then([=]() -> Future<vector<string>> {
-      // Remove the tarballs after the extraction.
-      foreach (const string& blobSum, blobSums) {
-        const string tar = path::join(directory, blobSum);
-
-        Try<Nothing> rm = os::rm(tar);
-        if (rm.isError()) {
-          return Failure(
-              "Failed to remove '" + tar + "' "
-              "after extraction: " + rm.error());
-        }
+    .then([layerIds]() { return layerIds; });
+}
+
+
+Future<Nothing> RegistryPullerProcess::pullLayer(
+    const URI& blobUri,
+    const string& layerId,
+    const string& layerPath,
+    const string& rootfs,
+    const string& backend)
+{
+  return acquire()
+    .then(defer(self(),
+                &Self::_pullLayer,
+                blobUri,
+                layerId,
+                layerPath,
+                rootfs,
+                backend))
+    .onAny(defer(self(), [=](const Future<Nothing>&) { release(); }));
+}
+
+
+Future<Nothing> RegistryPullerProcess::_pullLayer(
+    const URI& blobUri,
+    const string& layerId,
+    const string& layerPath,
+    const string& rootfs,
+    const string& backend)
+{
+  // NOTE: Docker registry (v2, schema 1) layers are gzipped tarballs.
+  Option<URI> peerUri = getPeerUri(layerId, backend);
+  if (peerUri.isNone()) {
+    return extractLayer(
+        blobUri, layerPath, rootfs, command::Compression::GZIP);
+  }
+
+  VLOG(1) << "Pulling layer '" << layerId << "' from '" << peerUri.get()
+          << "'";
+
+  // NOTE: Peers serve the extracted layers as uncompressed tarballs.
+  return extractLayer(peerUri.get(), layerPath, rootfs, None())
+    .onReady(defer(self(), [=](const Nothing&) {
+      ++metrics.layer_pulls_from_peers;
+    }))
+    .repair(defer(self(), [=](const Future<Nothing>& future)
+        -> Future<Nothing> {
+      // The layer is expected to be missing on the peer at times
+      // (e.g., if no image with the layer was provisioned there yet,
+      // or if the peer is down), so this is not a warning.
+      VLOG(1) << "Falling back to the registry for layer '" << layerId
+              << "': " << future.failure();
+
+      ++metrics.layer_peer_misses;
+
+      // Start over with an empty rootfs, since the layer might have
+      // been partially extracted.
+      Try<Nothing> rmdir = os::rmdir(rootfs);
+      if (rmdir.isError()) {
+        return Failure(
+            "Failed to remove rootfs '" + rootfs + "': " + rmdir.error());
       }
 
-      return layerIds;
+      Try<Nothing> mkdir = os::mkdir(rootfs);
+      if (mkdir.isError()) {
+        return Failure(
+            "Failed to create rootfs '" + rootfs + "': " + mkdir.error());
+      }
+
+      return extractLayer(
+          blobUri, layerPath, rootfs, command::Compression::GZIP);
+    }));
+}
+
+
+Future<Nothing> RegistryPullerProcess::extractLayer(
+    const URI& uri,
+    const string& layerPath,
+    const string& rootfs,
+    const Option<command::Compression>& compression)
+{
+  // The tarball is streamed from the fetcher into `tar` through a
+  // FIFO, which the fetcher writes to as if it was the tarball (i.e.,
+  // the basename of the URI in the given directory). This way, the
+  // layer is extracted while it is being downloaded and the tarball
+  // never hits the disk.
+  const string fifo = path::join(layerPath, Path(uri.path()).basename());
+
+  if (::mkfifo(fifo.c_str(), 0600) != 0) {
+    return Failure(ErrnoError("Failed to create FIFO '" + fifo + "'").message);
+  }
+
+  // NOTE: We open the FIFO for reading (for `tar`) as well as for
+  // writing before the fetcher opens it. Opening the read end first
+  // allows us to open the write end without blocking, and holding the
+  // write end until the fetch completes makes sure that `tar` does
+  // not see EOF before the fetcher opened the FIFO (or at all, in
+  // case the fetch fails before that).
+  Try<int> reader = os::open(fifo, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+  if (reader.isError()) {
+    os::rm(fifo);
+    return Failure(
+        "Failed to open FIFO '" + fifo + "' for reading: " + reader.error());
+  }
+
+  Try<int> writer = os::open(fifo, O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+  if (writer.isError()) {
+    os::close(reader.get());
+    os::rm(fifo);
+    return Failure(
+        "Failed to open FIFO '" + fifo + "' for writing: " + writer.error());
+  }
+
+  // `tar` expects blocking reads.
+  int flags = ::fcntl(reader.get(), F_GETFL);
+  if (flags == -1 ||
+      ::fcntl(reader.get(), F_SETFL, flags & ~O_NONBLOCK) == -1) {
+    ErrnoError error("Failed to make FIFO '" + fifo + "' blocking");
+    os::close(reader.get());
+    os::close(writer.get());
+    os::rm(fifo);
+    return Failure(error.message);
+  }
+
+  Future<Nothing> extract =
+    command::untar(reader.get(), Path(rootfs), compression);
+
+  const int _writer = writer.get();
+
+  Future<Nothing> fetch = fetcher->fetch(uri, layerPath)
+    .onAny([_writer]() { os::close(_writer); });
+
+  return await(fetch, extract)
+    .then([=](const tuple<Future<Nothing>, Future<Nothing>>& t)
+        -> Future<Nothing> {
+      os::rm(fifo);
+
+      const Future<Nothing>& fetch = std::get<0>(t);
+      const Future<Nothing>& extract = std::get<1>(t);
+
+      // NOTE: A failed fetch usually fails the extraction too (e.g.,
+      // due to a truncated archive), so it is the more relevant one.
+      if (!fetch.isReady()) {
+        return Failure(
+            "Failed to fetch '" + stringify(uri) + "': " +
+            (fetch.isFailed() ? fetch.failure() : "discarded"));
+      }
+
+      if (!extract.isReady()) {
+        return Failure(
+            "Failed to extract '" + stringify(uri) + "' to '" +
+            rootfs + "': " +
+            (extract.isFailed() ? extract.failure() : "discarded"));
+      }
+
+      return Nothing();
     });
 }
 
 
-Future<hashset<string>> RegistryPullerProcess::fetchBlobs(
-    const spec::ImageReference& reference,
+Future<Nothing> RegistryPullerProcess::moveLayer(
     const string& directory,
-    const spec::v2::ImageManifest& manifest,
+    const string& layerId,
     const string& backend)
 {
-  // First, find all the blobs that need to be fetched.
-  //
-  // NOTE: There might exist duplicated blob sums in 'fsLayers'. We
-  // just need to fetch one of them.
-  hashset<string> blobSums;
+  Try<Nothing> move =
+    docker::moveLayer(storeDir, directory, layerId, backend);
 
-  for (int i = 0; i < manifest.fslayers_size(); i++) {
-    CHECK(manifest.history(i).has_v1());
-    const spec::v1::ImageManifest& v1 = manifest.history(i).v1();
+  if (move.isError()) {
+    return Failure(move.error());
+  }
 
-    // Check if the layer is in the store or not. If yes, skip the
-    // unnecessary fetching.
-    if (os::exists(
-        paths::getImageLayerRootfsPath(storeDir, v1.id(), backend))) {
-      continue;
+  return Nothing();
+}
+
+
+Future<Nothing> RegistryPullerProcess::acquire()
+{
+  if (layerPulls < maxConcurrentLayerPulls) {
+    layerPulls++;
+    return Nothing();
+  }
+
+  Owned<Promise<Nothing>> promise(new Promise<Nothing>());
+  pendingLayerPulls.push(promise);
+
+  return promise->future();
+}
+
+
+void RegistryPullerProcess::release()
+{
+  // Hand the slot over to the next pending layer pull, if any.
+  if (!pendingLayerPulls.empty()) {
+    Owned<Promise<Nothing>> promise = pendingLayerPulls.front();
+    pendingLayerPulls.pop();
+
+    promise->set(Nothing());
+    return;
+  }
+
+  CHECK_GT(layerPulls, 0u);
+  layerPulls--;
+}
+
+
+Try<URI> RegistryPullerProcess::getBlobUri(
+    const spec::ImageReference& reference,
+    const string& blobSum)
+{
+  if (reference.has_registry()) {
+    Result<int> port = spec::getRegistryPort(reference.registry());
+    if (port.isError()) {
+      return Error("Failed to get registry port: " + port.error());
     }
 
-    const string& blobSum = manifest.fslayers(i).blobsum();
+    Try<string> scheme = spec::getRegistryScheme(reference.registry());
+    if (scheme.isError()) {
+      return Error("Failed to get registry scheme: " + scheme.error());
+    }
 
-    VLOG(1) << "Fetching blob '" << blobSum << "' for layer '"
-            << v1.id() << "' of image '" << reference << "'";
+    // If users want to use the registry specified in '--docker_image',
+    // an URL scheme must be specified in '--docker_registry', because
+    // there is no scheme allowed in docker image name.
+    return uri::docker::blob(
+        reference.repository(),
+        blobSum,
+        spec::getRegistryHost(reference.registry()),
+        scheme.get(),
+        port.isSome() ? port.get() : Option<int>());
+  }
+
+  const string registry = defaultRegistryUrl.domain.isSome()
+    ? defaultRegistryUrl.domain.get()
+    : stringify(defaultRegistryUrl.ip.get());
+
+  const Option<int> port = defaultRegistryUrl.port.isSome()
+    ? static_cast<int>(defaultRegistryUrl.port.get())
+    : Option<int>();
 
-    blobSums.insert(blobSum);
+  return uri::docker::blob(
+      reference.repository(),
+      blobSum,
+      registry,
+      defaultRegistryUrl.scheme,
+      port);
+}
+
+
+Option<URI> RegistryPullerProcess::getPeerUri(
+    const string& layerId,
+    const string& backend)
+{
+  if (peers.isNone() || peers->empty()) {
+    return None();
   }
 
-  // Now, actually fetch the blobs.
-  list<Future<Nothing>> futures;
+  // The peer of a layer is chosen by rendezvous hashing, so that all
+  // agents pull the layer from the same peer (which pulls it from the
+  // registry), and only the layers of a peer are pulled from another
+  // peer when the peer is removed from (or added to) the peers.
+  Option<Peer> peer;
+  size_t max = 0;
 
-  foreach (const string& blobSum, blobSums) {
-    URI blobUri;
+  foreach (const Peer& candidate, peers.get()) {
+    const size_t hash = std::hash<string>()(
+        candidate.host + ":" + stringify(candidate.port) + "/" + layerId);
 
-    if (reference.has_registry()) {
-      Result<int> port = spec::getRegistryPort(reference.registry());
-      if (port.isError()) {
-        return Failure("Failed to get registry port: " + port.error());
-      }
+    if (peer.isNone() || hash > max) {
+      peer = candidate;
+      max = hash;
+    }
+  }
 
-      Try<string> scheme = spec::getRegistryScheme(reference.registry());
-      if (scheme.isError()) {
-        return Failure("Failed to get registry scheme: " + scheme.error());
-      }
+  if (peer->self) {
+    return None();
+  }
+
+  return uri::http(
+      peer->host,
+      path::join("/", PEER_PROCESS_ID, "layers", layerId),
+      peer->port,
+      "backend=" + backend);
+}
+
+
+Future<http::Response> RegistryPullerProcess::layers(
+    const http::Request& request)
+{
+  // The path is '/docker-provisioner-registry-puller/layers/<layer id>'.
+  vector<string> tokens = strings::tokenize(request.url.path, "/");
+  if (tokens.size() != 3) {
+    return http::NotFound();
+  }
+
+  const string& layerId = tokens[2];
+  const string backend =
+    request.url.query.get("backend").getOrElse(COPY_BACKEND);
 
-      // If users want to use the registry specified in '--docker_image',
-      // an URL scheme must be specified in '--docker_registry', because
-      // there is no scheme allowed in docker image name.
-      blobUri = uri::docker::blob(
-          reference.repository(),
-          blobSum,
-          spec::getRegistryHost(reference.registry()),
-          scheme.get(),
-          port.isSome() ? port.get() : Option<int>());
-    } else {
-      const string registry = defaultRegistryUrl.domain.isSome()
-        ? defaultRegistryUrl.domain.get()
-        : stringify(defaultRegistryUrl.ip.get());
-
-      const Option<int> port = defaultRegistryUrl.port.isSome()
-        ? static_cast<int>(defaultRegistryUrl.port.get())
-        : Option<int>();
-
-      blobUri = uri::docker::blob(
-          reference.repository(),
-          blobSum,
-          registry,
-          defaultRegistryUrl.scheme,
-          port);
+  // Make sure the layer id and the backend are not paths.
+  foreach (const string& token, vector<string>({layerId, backend})) {
+    foreach (char c, token) {
+      if (!isalnum(c)) {
+        return http::BadRequest(
+            "Invalid layer '" + layerId + "' or backend '" + backend + "'");
+      }
     }
+  }
+
+  const string rootfs =
+    paths::getImageLayerRootfsPath(storeDir, layerId, backend);
 
-    futures.push_back(fetcher->fetch(blobUri, directory));
+  // Serve the layer once it has been pulled if it is being pulled,
+  // since this agent is likely the peer of the layer.
+  if (pulling.contains(rootfs)) {
+    return pulling.at(rootfs)
+      .then(defer(self(), &Self::_layers, rootfs));
   }
 
-  return collect(futures)
-    .then([blobSums]() -> hashset<string> { return blobSums; });
+  return _layers(rootfs);
+}
+
+
+Future<http::Response> RegistryPullerProcess::_layers(const string& rootfs)
+{
+  if (!os::exists(rootfs)) {
+    return http::NotFound();
+  }
+
+  Try<Subprocess> s = subprocess(
+      "tar",
+      {"tar", "-c", "-C", rootfs, "."},
+      Subprocess::PATH("/dev/null"),
+      Subprocess::PIPE(),
+      Subprocess::PATH("/dev/null"));
+
+  if (s.isError()) {
+    return http::InternalServerError(
+        "Failed to archive '" + rootfs + "': " + s.error());
+  }
+
+  http::Pipe pipe;
+  http::OK ok;
+
+  ok.headers["Content-Type"] = "application/x-tar";
+  ok.type = http::Response::PIPE;
+  ok.reader = pipe.reader();
+
+  http::Pipe::Writer writer = pipe.writer();
+  const Subprocess tar = s.get();
+
+  // NOTE: The tarball is streamed to the peer while it is being
+  // created. If the peer goes away, `tar` is killed by SIGPIPE once
+  // the subprocess (and thus its stdout) goes away.
+  loop(
+      self(),
+      [=]() {
+        return process::io::read(tar.out().get());
+      },
+      [=](const string& data) mutable -> Future<ControlFlow<Nothing>> {
+        if (data.empty()) {
+          return Break();
+        }
+
+        if (!writer.write(data)) {
+          return Failure("The peer closed the connection");
+        }
+
+        return Continue();
+      })
+    .then([=]() { return tar.status(); })
+    .onAny([=](const Future<Option<int>>& status) mutable {
+      if (status.isReady() &&
+          status->isSome() &&
+          WIFEXITED(status->get()) &&
+          WEXITSTATUS(status->get()) == 0) {
+        writer.close();
+        return;
+      }
+
+      // Fail the response (i.e., close the connection), so that the
+      // peer does not mistake the truncated tarball for the layer.
+      writer.fail("Failed to archive '" + rootfs + "'");
+    });
+
+  return ok;
 }
 
 } // namespace docker {
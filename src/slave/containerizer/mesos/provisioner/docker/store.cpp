@@ -14,20 +14,33 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#ifndef __WINDOWS__
+#include <fts.h>
+#endif // __WINDOWS__
+
+#include <algorithm>
 #include <string>
 #include <vector>
 
 #include <glog/logging.h>
 
+#include <stout/bytes.hpp>
 #include <stout/hashmap.hpp>
+#include <stout/hashset.hpp>
 #include <stout/json.hpp>
 #include <stout/os.hpp>
+#include <stout/uuid.hpp>
 
+#include <process/async.hpp>
 #include <process/collect.hpp>
 #include <process/defer.hpp>
 #include <process/dispatch.hpp>
 #include <process/id.hpp>
 
+#include <process/metrics/counter.hpp>
+#include <process/metrics/gauge.hpp>
+#include <process/metrics/metrics.hpp>
+
 #include <mesos/docker/spec.hpp>
 
 #include "slave/containerizer/mesos/provisioner/constants.hpp"
@@ -63,7 +76,8 @@ public:
     : ProcessBase(process::ID::generate("docker-provisioner-store")),
       flags(_flags),
       metadataManager(_metadataManager),
-      puller(_puller) {}
+      puller(_puller),
+      metrics(*this) {}
 
   ~StoreProcess() {}
 
@@ -73,6 +87,8 @@ public:
       const mesos::Image& image,
       const string& backend);
 
+  Future<Nothing> prune(const hashset<string>& activeLayerPaths);
+
 private:
   Future<Image> _get(
       const spec::ImageReference& reference,
@@ -93,14 +109,129 @@ private:
       const string& layerId,
       const string& backend);
 
+  Future<Nothing> _prune(
+      const hashset<string>& activeLayerPaths,
+      const vector<Image>& images);
+
+  // Moves the given layers out of the store and removes them in the
+  // background.
+  void removeLayers(const vector<string>& layerIds);
+
+  // Returns the disk usage of the layer, which is cached since the
+  // layers in the store are immutable.
+  Try<Bytes> layerSize(const string& layerId);
+
+  double _size_bytes() { return static_cast<double>(size.bytes()); }
+
   const Flags flags;
 
   Owned<MetadataManager> metadataManager;
   Owned<Puller> puller;
   hashmap<string, Owned<Promise<Image>>> pulling;
+
+  // The pending prune, if any. Retrieving an image waits for it, so
+  // that the image can not be pruned from under the caller.
+  Option<Future<Nothing>> pruning;
+
+  hashmap<string, Bytes> layerSizes;
+
+  // The size of the store as of the last prune.
+  Bytes size;
+
+  struct Metrics
+  {
+    explicit Metrics(const StoreProcess& store);
+    ~Metrics();
+
+    process::metrics::Gauge size_bytes;
+    process::metrics::Counter images_evicted;
+    process::metrics::Counter layers_evicted;
+    process::metrics::Counter evicted_bytes;
+  } metrics;
 };
 
 
+StoreProcess::Metrics::Metrics(const StoreProcess& store)
+  : size_bytes(
+        "containerizer/mesos/provisioner/docker_store/size_bytes",
+        defer(store, &StoreProcess::_size_bytes)),
+    images_evicted(
+        "containerizer/mesos/provisioner/docker_store/images_evicted"),
+    layers_evicted(
+        "containerizer/mesos/provisioner/docker_store/layers_evicted"),
+    evicted_bytes(
+        "containerizer/mesos/provisioner/docker_store/evicted_bytes")
+{
+  process::metrics::add(size_bytes);
+  process::metrics::add(images_evicted);
+  process::metrics::add(layers_evicted);
+  process::metrics::add(evicted_bytes);
+}
+
+
+StoreProcess::Metrics::~Metrics()
+{
+  process::metrics::remove(size_bytes);
+  process::metrics::remove(images_evicted);
+  process::metrics::remove(layers_evicted);
+  process::metrics::remove(evicted_bytes);
+}
+
+
+// Returns the disk usage of the files and directories under the given
+// directory (like `du -s` does).
+//
+// NOTE: Files with multiple hard links in the directory are counted
+// more than once.
+static Try<Bytes> du(const string& directory)
+{
+#ifdef __WINDOWS__
+  return Error("Disk usage is not supported on Windows");
+#else
+  char* source[] = {const_cast<char*>(directory.c_str()), nullptr};
+
+  FTS* tree = ::fts_open(source, FTS_NOCHDIR | FTS_PHYSICAL, nullptr);
+  if (tree == nullptr) {
+    return ErrnoError("Failed to open '" + directory + "'");
+  }
+
+  Bytes usage;
+  Option<Error> error;
+
+  for (FTSENT *node = ::fts_read(tree);
+       node != nullptr; node = ::fts_read(tree)) {
+    switch (node->fts_info) {
+      case FTS_DP:
+        // Directories are counted in preorder.
+        break;
+      case FTS_DNR:
+      case FTS_ERR:
+      case FTS_NS:
+        error = Error(
+            "Failed to stat '" + string(node->fts_path) + "': " +
+            os::strerror(node->fts_errno));
+        break;
+      default:
+        usage += Bytes(node->fts_statp->st_blocks * 512);
+        break;
+    }
+
+    if (error.isSome()) {
+      break;
+    }
+  }
+
+  ::fts_close(tree);
+
+  if (error.isSome()) {
+    return error.get();
+  }
+
+  return usage;
+#endif // __WINDOWS__
+}
+
+
 Try<Owned<slave::Store>> Store::create(const Flags& flags)
 {
   // TODO(jieyu): We should inject URI fetcher from top level, instead
@@ -110,6 +241,8 @@ Try<Owned<slave::Store>> Store::create(const Flags& flags)
   // TODO(dpravat): Remove after resolving MESOS-5473.
 #ifndef __WINDOWS__
   _flags.docker_config = flags.docker_config;
+  _flags.docker_blob_range_size = flags.docker_blob_range_size;
+  _flags.docker_blob_parallelism = flags.docker_blob_parallelism;
 #endif
 
   Try<Owned<uri::Fetcher>> fetcher = uri::fetcher::create(_flags);
@@ -141,6 +274,12 @@ Try<Owned<slave::Store>> Store::create(
                  mkdir.error());
   }
 
+  mkdir = os::mkdir(paths::getGcDir(flags.docker_store_dir));
+  if (mkdir.isError()) {
+    return Error("Failed to create Docker store gc directory: " +
+                 mkdir.error());
+  }
+
   mkdir = os::mkdir(paths::getStagingDir(flags.docker_store_dir));
   if (mkdir.isError()) {
     return Error("Failed to create Docker store staging directory: " +
@@ -186,8 +325,36 @@ Future<ImageInfo> Store::get(
 }
 
 
+Future<Nothing> Store::prune(const hashset<string>& activeLayerPaths)
+{
+  return dispatch(process.get(), &StoreProcess::prune, activeLayerPaths);
+}
+
+
 Future<Nothing> StoreProcess::recover()
 {
+  // Remove the layers which were evicted but not yet (completely)
+  // removed before the agent restarted.
+  const string gcDir = paths::getGcDir(flags.docker_store_dir);
+
+  Try<list<string>> entries = os::ls(gcDir);
+  if (entries.isError()) {
+    return Failure(
+        "Failed to list the gc directory '" + gcDir + "': " +
+        entries.error());
+  }
+
+  foreach (const string& entry, entries.get()) {
+    const string path = path::join(gcDir, entry);
+
+    async([path]() { return os::rmdir(path); })
+      .onAny([path](const Future<Try<Nothing>>& rmdir) {
+        if (!rmdir.isReady() || rmdir->isError()) {
+          LOG(WARNING) << "Failed to remove evicted layer '" << path << "'";
+        }
+      });
+  }
+
   return metadataManager->recover();
 }
 
@@ -200,6 +367,11 @@ Future<ImageInfo> StoreProcess::get(
     return Failure("Docker provisioner store only supports Docker images");
   }
 
+  if (pruning.isSome() && pruning->isPending()) {
+    return pruning->repair([](const Future<Nothing>&) { return Nothing(); })
+      .then(defer(self(), &Self::get, image, backend));
+  }
+
   Try<spec::ImageReference> reference =
     spec::parseImageReference(image.docker().name());
 
@@ -328,6 +500,231 @@ Future<ImageInfo> StoreProcess::__get(
 }
 
 
+Future<Nothing> StoreProcess::prune(const hashset<string>& activeLayerPaths)
+{
+  // NOTE: Pruning while an image is being pulled could remove layers
+  // the pull relies on (e.g., layers the puller skipped because they
+  // are already in the store), hence we skip it. The store is pruned
+  // again the next time a container is provisioned or destroyed.
+  if (!pulling.empty()) {
+    VLOG(1) << "Skipping pruning the Docker store while pulling images";
+    return Nothing();
+  }
+
+  if (pruning.isSome() && pruning->isPending()) {
+    return pruning.get();
+  }
+
+  pruning = metadataManager->images()
+    .then(defer(self(), &Self::_prune, activeLayerPaths, lambda::_1));
+
+  return pruning.get();
+}
+
+
+Future<Nothing> StoreProcess::_prune(
+    const hashset<string>& activeLayerPaths,
+    const vector<Image>& images)
+{
+  const string layersDir = paths::getImageLayersDir(flags.docker_store_dir);
+
+  Try<list<string>> layerIds = os::exists(layersDir)
+    ? os::ls(layersDir)
+    : Try<list<string>>(list<string>());
+
+  if (layerIds.isError()) {
+    return Failure(
+        "Failed to list the layers in '" + layersDir + "': " +
+        layerIds.error());
+  }
+
+  size = Bytes(0);
+  foreach (const string& layerId, layerIds.get()) {
+    Try<Bytes> usage = layerSize(layerId);
+    if (usage.isError()) {
+      return Failure(
+          "Failed to get the size of layer '" + layerId + "': " +
+          usage.error());
+    }
+
+    size += usage.get();
+  }
+
+  if (flags.docker_store_max_size.isNone() ||
+      size <= flags.docker_store_max_size.get()) {
+    return Nothing();
+  }
+
+  const Bytes maxSize = flags.docker_store_max_size.get();
+
+  // A layer is in use if a container's rootfs is provisioned from
+  // it, with any backend.
+  auto active = [&](const string& layerId) {
+    return
+      activeLayerPaths.contains(paths::getImageLayerRootfsPath(
+          flags.docker_store_dir, layerId, COPY_BACKEND)) ||
+      activeLayerPaths.contains(paths::getImageLayerRootfsPath(
+          flags.docker_store_dir, layerId, OVERLAY_BACKEND));
+  };
+
+  // The (unique) layers of each image.
+  auto getLayerIds = [](const Image& image) {
+    hashset<string> layerIds;
+    foreach (const string& layerId, image.layer_ids()) {
+      layerIds.insert(layerId);
+    }
+
+    return layerIds;
+  };
+
+  // The number of images each layer belongs to.
+  hashmap<string, size_t> references;
+  foreach (const Image& image, images) {
+    foreach (const string& layerId, getLayerIds(image)) {
+      references[layerId]++;
+    }
+  }
+
+  vector<string> evictedLayers;
+
+  auto evict = [&](const string& layerId) {
+    if (layerSizes.contains(layerId)) {
+      size -= std::min(size, layerSizes.at(layerId));
+    }
+
+    evictedLayers.push_back(layerId);
+  };
+
+  // First, evict the layers that do not belong to any image (e.g.,
+  // layers of an image that failed to be pulled).
+  foreach (const string& layerId, layerIds.get()) {
+    if (!references.contains(layerId) && !active(layerId)) {
+      evict(layerId);
+    }
+  }
+
+  // Then, evict the least recently used images not in use until the
+  // store fits in its budget, along with the layers that do not
+  // belong to any other image.
+  vector<Image> candidates = images;
+  std::sort(
+      candidates.begin(),
+      candidates.end(),
+      [](const Image& left, const Image& right) {
+        return left.last_used() < right.last_used();
+      });
+
+  hashset<string> stored;
+  foreach (const string& layerId, layerIds.get()) {
+    stored.insert(layerId);
+  }
+
+  vector<spec::ImageReference> evictedImages;
+
+  foreach (const Image& image, candidates) {
+    if (size <= maxSize) {
+      break;
+    }
+
+    const hashset<string> imageLayerIds = getLayerIds(image);
+
+    bool inUse = false;
+    foreach (const string& layerId, imageLayerIds) {
+      if (active(layerId)) {
+        inUse = true;
+        break;
+      }
+    }
+
+    if (inUse) {
+      continue;
+    }
+
+    evictedImages.push_back(image.reference());
+
+    foreach (const string& layerId, imageLayerIds) {
+      if (--references[layerId] == 0 && stored.contains(layerId)) {
+        evict(layerId);
+      }
+    }
+  }
+
+  if (size > maxSize) {
+    LOG(WARNING) << "The Docker store (" << size << ") exceeds its size "
+                 << "budget of " << maxSize << " with all the images not "
+                 << "in use evicted";
+  }
+
+  LOG(INFO) << "Evicting " << evictedImages.size() << " images and "
+            << evictedLayers.size() << " layers from the Docker store";
+
+  metrics.images_evicted += evictedImages.size();
+
+  // NOTE: The images are removed from the metadata manager before
+  // their layers are removed, so that an image is never returned
+  // without its layers (even if the agent fails in between).
+  return metadataManager->remove(evictedImages)
+    .then(defer(self(), [=]() {
+      removeLayers(evictedLayers);
+      return Nothing();
+    }));
+}
+
+
+void StoreProcess::removeLayers(const vector<string>& layerIds)
+{
+  foreach (const string& layerId, layerIds) {
+    const string layerPath =
+      paths::getImageLayerPath(flags.docker_store_dir, layerId);
+
+    // NOTE: The layer is renamed (which is atomic) into the gc
+    // directory first, so that a partially removed layer is never
+    // found in the store.
+    const string gcPath = path::join(
+        paths::getGcDir(flags.docker_store_dir),
+        layerId + "." + UUID::random().toString());
+
+    Try<Nothing> rename = os::rename(layerPath, gcPath);
+    if (rename.isError()) {
+      LOG(WARNING) << "Failed to move evicted layer '" << layerPath
+                   << "' to '" << gcPath << "': " << rename.error();
+      continue;
+    }
+
+    ++metrics.layers_evicted;
+
+    if (layerSizes.contains(layerId)) {
+      metrics.evicted_bytes += layerSizes.at(layerId).bytes();
+      layerSizes.erase(layerId);
+    }
+
+    async([gcPath]() { return os::rmdir(gcPath); })
+      .onAny([gcPath](const Future<Try<Nothing>>& rmdir) {
+        if (!rmdir.isReady() || rmdir->isError()) {
+          LOG(WARNING) << "Failed to remove evicted layer '" << gcPath << "'";
+        }
+      });
+  }
+}
+
+
+Try<Bytes> StoreProcess::layerSize(const string& layerId)
+{
+  if (!layerSizes.contains(layerId)) {
+    Try<Bytes> usage =
+      du(paths::getImageLayerPath(flags.docker_store_dir, layerId));
+
+    if (usage.isError()) {
+      return Error(usage.error());
+    }
+
+    layerSizes.put(layerId, usage.get());
+  }
+
+  return layerSizes.at(layerId);
+}
+
+
 Future<vector<string>> StoreProcess::moveLayers(
     const string& staging,
     const vector<string>& layerIds,
@@ -347,11 +744,32 @@ Future<Nothing> StoreProcess::moveLayer(
     const string& staging,
     const string& layerId,
     const string& backend)
+{
+  Try<Nothing> move = docker::moveLayer(
+      flags.docker_store_dir,
+      staging,
+      layerId,
+      backend);
+
+  if (move.isError()) {
+    return Failure(move.error());
+  }
+
+  return Nothing();
+}
+
+
+Try<Nothing> moveLayer(
+    const string& storeDir,
+    const string& staging,
+    const string& layerId,
+    const string& backend)
 {
   const string source = path::join(staging, layerId);
 
   // This is the case where the puller skips the pulling of the layer
-  // because the layer already exists in the store.
+  // because the layer already exists in the store (or the puller
+  // already moved the layer into the store itself).
   //
   // TODO(jieyu): Verify that the layer is actually in the store.
   if (!os::exists(source)) {
@@ -359,7 +777,7 @@ Future<Nothing> StoreProcess::moveLayer(
   }
 
   const string targetRootfs = paths::getImageLayerRootfsPath(
-      flags.docker_store_dir,
+      storeDir,
       layerId,
       backend);
 
@@ -371,9 +789,7 @@ Future<Nothing> StoreProcess::moveLayer(
   }
 
   const string sourceRootfs = paths::getImageLayerRootfsPath(source, backend);
-  const string target = paths::getImageLayerPath(
-      flags.docker_store_dir,
-      layerId);
+  const string target = paths::getImageLayerPath(storeDir, layerId);
 
 #ifdef __linux__
   // If the backend is "overlay", we need to convert
@@ -381,7 +797,7 @@ Future<Nothing> StoreProcess::moveLayer(
   if (backend == OVERLAY_BACKEND) {
     Try<Nothing> convert = convertWhiteouts(sourceRootfs);
     if (convert.isError()) {
-      return Failure(
+      return Error(
           "Failed to convert the whiteout files under '" +
           sourceRootfs + "': " + convert.error());
     }
@@ -392,14 +808,14 @@ Future<Nothing> StoreProcess::moveLayer(
     // This is the case that we pull the layer for the first time.
     Try<Nothing> mkdir = os::mkdir(target);
     if (mkdir.isError()) {
-      return Failure(
+      return Error(
           "Failed to create directory in store for layer '" +
           layerId + "': " + mkdir.error());
     }
 
     Try<Nothing> rename = os::rename(source, target);
     if (rename.isError()) {
-      return Failure(
+      return Error(
           "Failed to move layer from '" + source +
           "' to '" + target + "': " + rename.error());
     }
@@ -408,7 +824,7 @@ Future<Nothing> StoreProcess::moveLayer(
     // different backend.
     Try<Nothing> rename = os::rename(sourceRootfs, targetRootfs);
     if (rename.isError()) {
-      return Failure(
+      return Error(
           "Failed to move rootfs from '" + sourceRootfs +
           "' to '" + targetRootfs + "': " + rename.error());
     }
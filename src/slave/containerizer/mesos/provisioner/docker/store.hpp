@@ -17,8 +17,12 @@
 #ifndef __PROVISIONER_DOCKER_STORE_HPP__
 #define __PROVISIONER_DOCKER_STORE_HPP__
 
+#include <string>
+
 #include <process/owned.hpp>
 
+#include <stout/hashset.hpp>
+#include <stout/nothing.hpp>
 #include <stout/try.hpp>
 
 #include "slave/flags.hpp"
@@ -54,6 +58,9 @@ public:
       const mesos::Image& image,
       const std::string& backend);
 
+  virtual process::Future<Nothing> prune(
+      const hashset<std::string>& activeLayerPaths);
+
 private:
   explicit Store(process::Owned<StoreProcess> process);
 
@@ -63,6 +70,17 @@ private:
   process::Owned<StoreProcess> process;
 };
 
+
+// Moves the layer pulled into the staging directory into the store,
+// unless the layer is not in the staging directory (e.g., because it
+// was already in the store). This is a no-op if the layer is already
+// in the store for the given backend.
+Try<Nothing> moveLayer(
+    const std::string& storeDir,
+    const std::string& staging,
+    const std::string& layerId,
+    const std::string& backend);
+
 } // namespace docker {
 } // namespace slave {
 } // namespace internal {
@@ -40,6 +40,7 @@ namespace paths {
 //                 |-- <backend> (copy, bind, etc.)
 //                     |-- rootfses
 //                         |-- <rootfs_id> (the rootfs)
+//             |-- layers (the image layers the rootfses are made of)
 //             |-- containers (nested containers)
 //                 |-- <container_id>
 //                     |-- backends
@@ -82,6 +83,11 @@ std::string getBackendDir(
     const ContainerID& containerId,
     const std::string& backend);
 
+
+std::string getContainerLayersPath(
+    const std::string& provisionerDir,
+    const ContainerID& containerId);
+
 } // namespace paths {
 } // namespace provisioner {
 } // namespace slave {
@@ -39,6 +39,7 @@
 #endif
 
 #include "slave/paths.hpp"
+#include "slave/state.hpp"
 
 #include "slave/containerizer/mesos/provisioner/constants.hpp"
 #include "slave/containerizer/mesos/provisioner/backend.hpp"
@@ -313,7 +314,8 @@ ProvisionerProcess::ProvisionerProcess(
     rootDir(_rootDir),
     defaultBackend(_defaultBackend),
     stores(_stores),
-    backends(_backends) {}
+    backends(_backends),
+    provisioning(0) {}
 
 
 Future<Nothing> ProvisionerProcess::recover(
@@ -360,6 +362,22 @@ Future<Nothing> ProvisionerProcess::recover(
       info->rootfses.put(backend, rootfses.get()[backend]);
     }
 
+    const string layersPath =
+      provisioner::paths::getContainerLayersPath(rootDir, containerId);
+
+    if (os::exists(layersPath)) {
+      Try<string> layers = os::read(layersPath);
+      if (layers.isError()) {
+        return Failure(
+            "Failed to read the layers of container " +
+            stringify(containerId) + ": " + layers.error());
+      }
+
+      foreach (const string& layer, strings::tokenize(layers.get(), "\n")) {
+        info->layers.insert(layer);
+      }
+    }
+
     infos.put(containerId, info);
 
     if (knownContainerIds.contains(containerId)) {
@@ -406,10 +424,13 @@ Future<Nothing> ProvisionerProcess::recover(
   // in 'store', which might fail if there still exist unknown
   // containers holding references to them.
   return collect(cleanup, recover)
-    .then([=]() -> Future<Nothing> {
+    .then(defer(self(), [=]() -> Future<Nothing> {
       LOG(INFO) << "Provisioner recovery complete";
+
+      prune();
+
       return Nothing();
-    });
+    }));
 }
 
 
@@ -423,6 +444,10 @@ Future<ProvisionInfo> ProvisionerProcess::provision(
         stringify(image.type()));
   }
 
+  // NOTE: The stores are not pruned while an image is provisioned,
+  // since its layers are not known to be in use until `_provision`.
+  provisioning++;
+
   // Get and then provision image layers from the store.
   return stores.get(image.type()).get()->get(image, defaultBackend)
     .then(defer(self(),
@@ -430,7 +455,13 @@ Future<ProvisionInfo> ProvisionerProcess::provision(
                 containerId,
                 image,
                 defaultBackend,
-                lambda::_1));
+                lambda::_1))
+    .onAny(defer(self(), [=](const Future<ProvisionInfo>&) {
+      CHECK_GT(provisioning, 0u);
+      provisioning--;
+
+      prune();
+    }));
 }
 
 
@@ -462,6 +493,22 @@ Future<ProvisionInfo> ProvisionerProcess::_provision(
 
   infos[containerId]->rootfses[backend].insert(rootfsId);
 
+  // Checkpoint the layers in use by the container, so that they are
+  // not pruned from the store after the agent restarts.
+  infos[containerId]->layers.insert(
+      imageInfo.layers.begin(),
+      imageInfo.layers.end());
+
+  Try<Nothing> checkpoint = slave::state::checkpoint(
+      provisioner::paths::getContainerLayersPath(rootDir, containerId),
+      strings::join("\n", infos[containerId]->layers));
+
+  if (checkpoint.isError()) {
+    return Failure(
+        "Failed to checkpoint the layers of container " +
+        stringify(containerId) + ": " + checkpoint.error());
+  }
+
   string backendDir = provisioner::paths::getBackendDir(
       rootDir,
       containerId,
@@ -566,10 +613,33 @@ Future<bool> ProvisionerProcess::_destroy(const ContainerID& containerId)
     ++metrics.remove_container_errors;
   }
 
+  prune();
+
   return true;
 }
 
 
+void ProvisionerProcess::prune()
+{
+  if (provisioning > 0) {
+    return;
+  }
+
+  hashset<string> activeLayerPaths;
+  foreachvalue (const Owned<Info>& info, infos) {
+    activeLayerPaths.insert(info->layers.begin(), info->layers.end());
+  }
+
+  foreachpair (Image::Type type, const Owned<Store>& store, stores) {
+    store->prune(activeLayerPaths)
+      .onFailed([type](const string& failure) {
+        LOG(WARNING) << "Failed to prune the " << Image::Type_Name(type)
+                     << " image store: " << failure;
+      });
+  }
+}
+
+
 ProvisionerProcess::Metrics::Metrics()
   : remove_container_errors(
       "containerizer/mesos/provisioner/remove_container_errors")
@@ -137,6 +137,9 @@ private:
 
   process::Future<bool> _destroy(const ContainerID& containerId);
 
+  // Prunes the stores, unless an image is being provisioned.
+  void prune();
+
   // Absolute path to the provisioner root directory. It can be
   // derived from '--work_dir' but we keep a separate copy here
   // because we converted it into an absolute path so managed rootfs
@@ -158,10 +161,17 @@ private:
   {
     // Mappings: backend -> {rootfsId, ...}
     hashmap<std::string, hashset<std::string>> rootfses;
+
+    // The image layers the rootfses are provisioned from, which are
+    // therefore not pruned from the stores.
+    hashset<std::string> layers;
   };
 
   hashmap<ContainerID, process::Owned<Info>> infos;
 
+  // The number of images being provisioned.
+  size_t provisioning;
+
   struct Metrics
   {
     Metrics();
@@ -29,6 +29,8 @@
 #include <process/future.hpp>
 #include <process/owned.hpp>
 
+#include <stout/hashset.hpp>
+#include <stout/nothing.hpp>
 #include <stout/try.hpp>
 
 #include "slave/flags.hpp"
@@ -84,6 +86,19 @@ public:
   virtual process::Future<ImageInfo> get(
       const Image& image,
       const std::string& backend) = 0;
+
+  // Prune the images (and layers) of the store that are not used by
+  // any container, i.e., whose layers are not in 'activeLayerPaths',
+  // if the store exceeds its size budget (if any).
+  //
+  // NOTE: The caller must make sure no image is being retrieved from
+  // the store (i.e., `get` is pending) while the images in use are
+  // collected, otherwise the image might be pruned right away.
+  virtual process::Future<Nothing> prune(
+      const hashset<std::string>& activeLayerPaths)
+  {
+    return Nothing();
+  }
 };
 
 } // namespace slave {
@@ -137,6 +137,41 @@ mesos::internal::slave::Flags::Flags()
       "Strategy for provisioning container rootfs from images,\n"
       "e.g., `aufs`, `bind`, `copy`, `overlay`.");
 
+  add(&Flags::image_provisioner_overlay_squash_threshold,
+      "image_provisioner_overlay_squash_threshold",
+      "If set, the overlay backend flattens each chain of at least this\n"
+      "many image layers into a single layer the second time the chain is\n"
+      "provisioned, and mounts the flattened layer as the only lower\n"
+      "directory of the containers provisioned afterwards. This speeds up\n"
+      "path lookups in the containers of deep images. The flattened layers\n"
+      "are built in the background, and cached in the provisioner\n"
+      "directory of `--work_dir`. Must be at least 2.");
+
+  add(&Flags::image_provisioner_overlay_squash_cache_size,
+      "image_provisioner_overlay_squash_cache_size",
+      "The maximum number of flattened layers cached by the overlay\n"
+      "backend (see `--image_provisioner_overlay_squash_threshold`).\n"
+      "The least recently used flattened layers that are not mounted are\n"
+      "removed first.",
+      8);
+
+  add(&Flags::image_provisioner_shared_rootfs,
+      "image_provisioner_shared_rootfs",
+      "If set, the copy backend copies the layers of an image once to a\n"
+      "rootfs shared by all the containers of the image, which is mounted\n"
+      "read-only under a writable layer in each container using overlayfs.\n"
+      "This makes provisioning the containers of an image that is in use\n"
+      "instant, and shares the page cache of the files of the image. The\n"
+      "shared rootfs is removed once no container uses it anymore.\n"
+      "Requires overlayfs support on Linux.",
+      false);
+
+  add(&Flags::image_provisioner_shared_rootfs_upper_size,
+      "image_provisioner_shared_rootfs_upper_size",
+      "If set, the writable layer of each container whose rootfs is shared\n"
+      "(see `--image_provisioner_shared_rootfs`) is a tmpfs of this size.\n"
+      "Otherwise, it is kept in the provisioner directory of the container.");
+
   add(&Flags::appc_simple_discovery_uri_prefix,
       "appc_simple_discovery_uri_prefix",
       "URI prefix to be used for simple discovery of appc images,\n"
@@ -161,6 +196,38 @@ mesos::internal::slave::Flags::Flags()
       "Directory the Docker provisioner will store images in",
       path::join(os::temp(), "mesos", "store", "docker"));
 
+  add(&Flags::docker_store_max_size,
+      "docker_store_max_size",
+      "The maximum size of the Docker store (see `--docker_store_dir`).\n"
+      "If the store exceeds it, the least recently used images that are\n"
+      "not used by any container are evicted (along with their layers\n"
+      "that do not belong to any other image) until it fits. If not set,\n"
+      "images are never evicted.");
+
+  add(&Flags::docker_max_concurrent_layer_pulls,
+      "docker_max_concurrent_layer_pulls",
+      "The maximum number of image layers the Docker provisioner pulls\n"
+      "from a Docker registry concurrently (across all images). Each\n"
+      "layer is extracted while it is being downloaded.",
+      4,
+      [](const size_t& value) -> Option<Error> {
+        if (value == 0) {
+          return Error(
+              "Expected `--docker_max_concurrent_layer_pulls` to be positive");
+        }
+
+        return None();
+      });
+
+  add(&Flags::docker_layer_peers,
+      "docker_layer_peers",
+      "Comma-separated list of `host:port` addresses of agents (e.g.,\n"
+      "all agents of the cluster, including this one) that share the\n"
+      "Docker image layers in their stores. Each layer is pulled from one\n"
+      "of the peers (the same one on all agents) before falling back to\n"
+      "the Docker registry, and this agent serves the layers in its store\n"
+      "to the peers. NOTE: The layers are served without authentication.");
+
   add(&Flags::docker_volume_checkpoint_dir,
       "docker_volume_checkpoint_dir",
       "The root directory where we checkpoint the information about docker\n"
@@ -200,6 +267,21 @@ mesos::internal::slave::Flags::Flags()
       "(one subdirectory per agent).",
       path::join(os::temp(), "mesos", "fetch"));
 
+  add(&Flags::fetcher_max_concurrent_downloads,
+      "fetcher_max_concurrent_downloads",
+      "The maximum number of URIs the fetcher fetches concurrently for a\n"
+      "container. URIs that are fetched to the same file in the sandbox\n"
+      "are fetched in the order given.",
+      1,
+      [](const size_t& value) -> Option<Error> {
+        if (value == 0) {
+          return Error(
+              "Expected `--fetcher_max_concurrent_downloads` to be positive");
+        }
+
+        return None();
+      });
+
   add(&Flags::work_dir,
       "work_dir",
       "Path of the agent work directory. This is where executor sandboxes\n"
@@ -409,7 +491,10 @@ mesos::internal::slave::Flags::Flags()
 #ifdef __linux__
   add(&Flags::cgroups_hierarchy,
       "cgroups_hierarchy",
-      "The path to the cgroups hierarchy root\n", "/sys/fs/cgroup");
+      "The path to the cgroups hierarchy root. If this is a cgroups v2\n"
+      "unified hierarchy, the cgroups isolators use a single cgroup per\n"
+      "container.",
+      "/sys/fs/cgroup");
 
   add(&Flags::cgroups_root,
       "cgroups_root",
@@ -429,6 +514,17 @@ mesos::internal::slave::Flags::Flags()
       "swap instead of just memory.\n",
       false);
 
+  add(&Flags::cgroups_exclusive_cpus,
+      "cgroups_exclusive_cpus",
+      "Cgroups feature flag to give each container with an integral (and\n"
+      "non-revocable) `cpus` resource exclusive CPUs through the\n"
+      "`cgroups/cpuset` isolator, on a single NUMA node where\n"
+      "possible, and to set `cpuset.mems` to the NUMA nodes of those\n"
+      "CPUs. The other containers share the remaining CPUs. The NUMA\n"
+      "topology is reported in the `numa_nodes` and `cpus_per_numa_node`\n"
+      "agent attributes unless they are set through `--attributes`.\n",
+      false);
+
   add(&Flags::cgroups_cpu_enable_pids_and_tids_count,
       "cgroups_cpu_enable_pids_and_tids_count",
       "Cgroups feature flag to enable counting of processes and threads\n"
@@ -472,7 +568,10 @@ mesos::internal::slave::Flags::Flags()
       "Run command `perf list` to see all events. Event names are\n"
       "sanitized by downcasing and replacing hyphens with underscores\n"
       "when reported in the PerfStatistics protobuf, e.g., `cpu-cycles`\n"
-      "becomes `cpu_cycles`; see the PerfStatistics protobuf for all names.");
+      "becomes `cpu_cycles`; see the PerfStatistics protobuf for all names.\n"
+      "If all events are hardware, software or hardware cache events they\n"
+      "are counted with `perf_event_open` counters that are opened\n"
+      "once per container, otherwise `perf stat` is run to sample them.");
 
   add(&Flags::perf_interval,
       "perf_interval",
@@ -486,7 +585,9 @@ mesos::internal::slave::Flags::Flags()
   add(&Flags::perf_duration,
       "perf_duration",
       "Duration of a perf stat sample. The duration must be less\n"
-      "than the `perf_interval`.",
+      "than the `perf_interval`. Ignored if the events are counted\n"
+      "with `perf_event_open` counters, in which case a sample\n"
+      "covers the whole `perf_interval`.",
       Seconds(10));
 
   add(&Flags::revocable_cpu_low_priority,
@@ -536,6 +637,15 @@ mesos::internal::slave::Flags::Flags()
       "       \"SYS_ADMIN\"\n"
       "     ]\n"
       "}");
+
+  add(&Flags::launcher_fork_server,
+      "launcher_fork_server",
+      "Whether the Linux launcher should fork the processes of the\n"
+      "containers through a long-lived fork server spawned by the agent,\n"
+      "rather than by forking the agent itself. Forking the (small) fork\n"
+      "server is much cheaper than forking the agent, which increases\n"
+      "the rate at which the agent can launch containers.",
+      false);
 #endif
 
   add(&Flags::firewall_rules,
@@ -654,6 +764,22 @@ mesos::internal::slave::Flags::Flags()
       "  }\n"
       "}");
 
+  add(&Flags::docker_blob_range_size,
+      "docker_blob_range_size",
+      "The size of the ranges in which docker image blobs are downloaded,\n"
+      "if the registry supports range requests. Set to 0 to download each\n"
+      "blob in a single request. Ranges are only used if the blobs are\n"
+      "downloaded by the agent itself rather than by the curl command,\n"
+      "i.e., if no proxy is configured and the registry is accessed over\n"
+      "HTTP, or over HTTPS with SSL enabled and verifying certificates.",
+      Megabytes(32));
+
+  add(&Flags::docker_blob_parallelism,
+      "docker_blob_parallelism",
+      "The number of ranges of a docker image blob that are downloaded\n"
+      "at a time (see `--docker_blob_range_size`).",
+      4);
+
   add(&Flags::sandbox_directory,
       "sandbox_directory",
       "The absolute path for the directory in the container where the\n"
@@ -665,6 +791,18 @@ mesos::internal::slave::Flags::Flags()
 #endif // __WINDOWS__
       );
 
+  add(&Flags::sandbox_pool_size,
+      "sandbox_pool_size",
+      "The number of empty sandboxes that the agent keeps pre-created\n"
+      "(and owned by the user) for each user that executors are launched\n"
+      "as. Launching an executor then moves a pooled sandbox into place\n"
+      "rather than creating and chowning a new one, and the pool is\n"
+      "refilled in the background. This speeds up the launch of\n"
+      "executors on agents that run many short-lived tasks. The pool\n"
+      "is kept in the 'sandbox_pool' directory of the '--work_dir',\n"
+      "which is emptied whenever the agent starts.",
+      0);
+
   add(&Flags::default_container_info,
       "default_container_info",
       "JSON-formatted ContainerInfo that will be included into\n"
@@ -737,6 +875,16 @@ mesos::internal::slave::Flags::Flags()
       "root.",
       "root");
 
+  add(&Flags::network_enable_bpf_classifier,
+      "network_enable_bpf_classifier",
+      "Whether to redirect the incoming IP packets on host eth0 and host lo\n"
+      "to the containers with an eBPF classifier that looks up the\n"
+      "destination port of a packet in a BPF map, rather than with a u32\n"
+      "filter for each port range of each container. Requires Linux kernel\n"
+      "4.4 or newer. This flag is used for the `network/port_mapping`\n"
+      "isolator.",
+      false);
+
   add(&Flags::network_enable_socket_statistics_summary,
       "network_enable_socket_statistics_summary",
       "Whether to collect socket statistics summary for each container.\n"
@@ -779,6 +927,34 @@ mesos::internal::slave::Flags::Flags()
       "used for the `disk/du` isolator.",
       Seconds(15));
 
+  add(&Flags::container_disk_usage_tracking,
+      "container_disk_usage_tracking",
+      "How the `disk/du` isolator tracks the disk usage of containers.\n"
+      "`du` runs `du` on each sandbox (and volume) every\n"
+      "`--container_disk_watch_interval`, which reads every file and\n"
+      "directory of the sandbox each time. `inotify` (Linux only) walks\n"
+      "each sandbox once and then only looks at the files that change,\n"
+      "at the cost of an inotify watch per directory. Sandboxes that\n"
+      "can not be watched (e.g., because `fs.inotify.max_user_watches`\n"
+      "is reached) fall back to `du`.",
+      "du",
+      [](const string& value) -> Option<Error> {
+        if (value != "du" && value != "inotify") {
+          return Error(
+              "Expected 'du' or 'inotify' for"
+              " --container_disk_usage_tracking");
+        }
+
+#ifndef __linux__
+        if (value == "inotify") {
+          return Error("'inotify' disk usage tracking is only supported on"
+                       " Linux");
+        }
+#endif // __linux__
+
+        return None();
+      });
+
   // TODO(jieyu): Consider enabling this flag by default. Remember
   // to update the user doc if we decide to do so.
   add(&Flags::enforce_container_disk_quota,
@@ -787,6 +963,31 @@ mesos::internal::slave::Flags::Flags()
       "is used for the `disk/du` isolator.",
       false);
 
+  add(&Flags::container_usage_interval,
+      "container_usage_interval",
+      "The interval between the samples of the resource usage of all\n"
+      "the containers of the agent. The QoS controller, the resource\n"
+      "estimator and the `/monitor/statistics` and `/containers`\n"
+      "endpoints are served the most recent sample of a container rather\n"
+      "than sampling it on demand. A zero interval disables the sampling,\n"
+      "in which case the containers are sampled on demand.",
+      Seconds(0));
+
+  add(&Flags::container_usage_history,
+      "container_usage_history",
+      "The number of samples of the resource usage of each container\n"
+      "that the agent retains when `--container_usage_interval` is set.\n"
+      "The retained samples are returned by the `/containers` endpoint\n"
+      "when queried with `history=true`.",
+      60,
+      [](const size_t& value) -> Option<Error> {
+        if (value == 0) {
+          return Error("Expected `--container_usage_history` to be positive");
+        }
+
+        return None();
+      });
+
   // This help message for --modules flag is the same for
   // {master,slave,sched,tests}/flags.[ch]pp and should always be kept in
   // sync.
@@ -931,6 +1132,24 @@ mesos::internal::slave::Flags::Flags()
       "flag.",
       Seconds(15));
 
+  add(&Flags::oversubscribed_resources_threshold,
+      "oversubscribed_resources_threshold",
+      "The smallest relative change of an oversubscribed resource, compared\n"
+      "to the estimate last sent to the master, for which the agent sends a\n"
+      "new estimate (e.g., 0.1 for 10%). Smaller changes are not sent unless\n"
+      "resources appear or disappear, so that small fluctuations of the\n"
+      "estimate do not cause updates. By default every change is sent.",
+      0.0,
+      [](const double& value) -> Option<Error> {
+        if (value < 0.0) {
+          return Error(
+              "Expected `--oversubscribed_resources_threshold` to be "
+              "non-negative");
+        }
+
+        return None();
+      });
+
   add(&Flags::master_detector,
       "master_detector",
       "The symbol name of the master detector to use. This symbol\n"
@@ -940,7 +1159,8 @@ mesos::internal::slave::Flags::Flags()
 #if ENABLE_XFS_DISK_ISOLATOR
   add(&Flags::xfs_project_range,
       "xfs_project_range",
-      "The ranges of XFS project IDs to use for tracking directory quotas",
+      "The ranges of XFS project IDs to use for tracking directory quotas.\n"
+      "This flag is also used by the `disk/ext4` isolator.",
       "[5000-10000]");
 #endif
 
@@ -953,4 +1173,26 @@ mesos::internal::slave::Flags::Flags()
       "NOTE: This flag is *experimental* and should not be used in\n"
       "production yet.",
       false);
+
+  add(&Flags::batch_status_updates,
+      "batch_status_updates",
+      "Whether status updates that are ready to be forwarded to the master\n"
+      "at the same time (e.g., when many tasks terminate at once) are sent\n"
+      "to the master in a single message. Only applies to masters that\n"
+      "accept batched status updates.",
+      false);
+
+  add(&Flags::agent_managed_command_tasks,
+      "agent_managed_command_tasks",
+      "Whether command tasks (i.e., tasks without an executor) are launched\n"
+      "by the agent directly instead of through a `mesos-executor` per task.\n"
+      "The container then runs the task's command itself, and the agent\n"
+      "generates the task's status updates from the container's lifecycle:\n"
+      "`TASK_RUNNING` once the container is launched and `TASK_FINISHED`,\n"
+      "`TASK_FAILED` or `TASK_KILLED` once it terminates. Tasks with health\n"
+      "checks, checks, a kill policy, a container image or a Docker container\n"
+      "are still launched with the command executor, since the agent does\n"
+      "not implement those.\n"
+      "NOTE: This flag is *experimental*.",
+      false);
 }
@@ -49,18 +49,26 @@ public:
 
   Option<std::string> image_providers;
   Option<std::string> image_provisioner_backend;
+  Option<size_t> image_provisioner_overlay_squash_threshold;
+  size_t image_provisioner_overlay_squash_cache_size;
+  bool image_provisioner_shared_rootfs;
+  Option<Bytes> image_provisioner_shared_rootfs_upper_size;
 
   std::string appc_simple_discovery_uri_prefix;
   std::string appc_store_dir;
 
   std::string docker_registry;
   std::string docker_store_dir;
+  Option<Bytes> docker_store_max_size;
+  size_t docker_max_concurrent_layer_pulls;
+  Option<std::string> docker_layer_peers;
   std::string docker_volume_checkpoint_dir;
 
   std::string default_role;
   Option<std::string> attributes;
   Bytes fetcher_cache_size;
   std::string fetcher_cache_dir;
+  size_t fetcher_max_concurrent_downloads;
   std::string work_dir;
   std::string runtime_dir;
   std::string launcher_dir;
@@ -92,6 +100,7 @@ public:
   std::string cgroups_root;
   bool cgroups_enable_cfs;
   bool cgroups_limit_swap;
+  bool cgroups_exclusive_cpus;
   bool cgroups_cpu_enable_pids_and_tids_count;
   Option<std::string> cgroups_net_cls_primary_handle;
   Option<std::string> cgroups_net_cls_secondary_handles;
@@ -104,6 +113,7 @@ public:
   bool systemd_enable_support;
   std::string systemd_runtime_directory;
   Option<CapabilityInfo> allowed_capabilities;
+  bool launcher_fork_server;
 #endif
   Option<Firewall> firewall_rules;
   Option<Path> credential;
@@ -113,6 +123,7 @@ public:
   Option<std::string> docker_mesos_image;
   Duration docker_remove_delay;
   std::string sandbox_directory;
+  size_t sandbox_pool_size;
   Option<ContainerInfo> default_container_info;
 
   // TODO(alexr): Remove this after the deprecation cycle (started in 1.0).
@@ -121,6 +132,8 @@ public:
   bool docker_kill_orphans;
   std::string docker_socket;
   Option<JSON::Object> docker_config;
+  Bytes docker_blob_range_size;
+  size_t docker_blob_parallelism;
 
 #ifdef WITH_NETWORK_ISOLATOR
   uint16_t ephemeral_ports_per_container;
@@ -129,6 +142,7 @@ public:
   Option<Bytes> egress_rate_limit_per_container;
   bool egress_unique_flow_per_container;
   std::string egress_flow_classifier_parent;
+  bool network_enable_bpf_classifier;
   bool network_enable_socket_statistics_summary;
   bool network_enable_socket_statistics_details;
   bool network_enable_snmp_statistics;
@@ -136,7 +150,10 @@ public:
   Option<std::string> network_cni_plugins_dir;
   Option<std::string> network_cni_config_dir;
   Duration container_disk_watch_interval;
+  std::string container_disk_usage_tracking;
   bool enforce_container_disk_quota;
+  Duration container_usage_interval;
+  size_t container_usage_history;
   Option<Modules> modules;
   Option<std::string> modulesDir;
   std::string authenticatee;
@@ -150,11 +167,14 @@ public:
   Option<std::string> qos_controller;
   Duration qos_correction_interval_min;
   Duration oversubscribed_resources_interval;
+  double oversubscribed_resources_threshold;
   Option<std::string> master_detector;
 #if ENABLE_XFS_DISK_ISOLATOR
   std::string xfs_project_range;
 #endif
   bool http_command_executor;
+  bool batch_status_updates;
+  bool agent_managed_command_tasks;
 };
 
 } // namespace slave {
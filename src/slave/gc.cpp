@@ -16,15 +16,20 @@
 
 #include <list>
 
+#include <process/async.hpp>
+#include <process/defer.hpp>
 #include <process/delay.hpp>
 #include <process/dispatch.hpp>
 
+#include <process/metrics/metrics.hpp>
+
 #include <stout/foreach.hpp>
 
 #include <stout/os/rmdir.hpp>
 
 #include "logging/logging.hpp"
 
+#include "slave/constants.hpp"
 #include "slave/gc.hpp"
 
 using namespace process;
@@ -45,6 +50,10 @@ GarbageCollectorProcess::~GarbageCollectorProcess()
   foreachvalue (const PathInfo& info, paths) {
     info.promise->discard();
   }
+
+  foreach (const PathInfo& info, backlog) {
+    info.promise->discard();
+  }
 }
 
 
@@ -56,7 +65,7 @@ Future<Nothing> GarbageCollectorProcess::schedule(
 
   // If there's an existing schedule for this path, we must remove
   // it here in order to reschedule.
-  if (timeouts.contains(path)) {
+  if (timeouts.contains(path) || queued.contains(path)) {
     CHECK(unschedule(path));
   }
 
@@ -64,8 +73,7 @@ Future<Nothing> GarbageCollectorProcess::schedule(
 
   Timeout removalTime = Timeout::in(d);
 
-  timeouts[path] = removalTime;
-  paths.put(removalTime, PathInfo(path, promise));
+  timeouts[path] = paths.emplace(removalTime, PathInfo(path, promise));
 
   // If the timer is not yet initialized or the timeout is sooner than
   // the currently active timer, update it.
@@ -82,28 +90,31 @@ bool GarbageCollectorProcess::unschedule(const string& path)
 {
   LOG(INFO) << "Unscheduling '" << path << "' from gc";
 
-  if (!timeouts.contains(path)) {
-    return false;
-  }
+  if (timeouts.contains(path)) {
+    Schedule::iterator iterator = timeouts[path];
+    CHECK(iterator->second.path == path)
+      << "Inconsistent state across 'paths' and 'timeouts'";
 
-  Timeout timeout = timeouts[path]; // Make a copy, as we erase() below.
-  CHECK(paths.contains(timeout));
+    // Discard the promise and clean up the maps.
+    iterator->second.promise->discard();
+    paths.erase(iterator);
+    timeouts.erase(path);
 
-  // Locate the path.
-  foreach (const PathInfo& info, paths.get(timeout)) {
-    if (info.path == path) {
-      // Discard the promise.
-      info.promise->discard();
+    return true;
+  }
+
+  if (queued.contains(path)) {
+    Backlog::iterator iterator = queued[path];
+    CHECK(iterator->path == path)
+      << "Inconsistent state across 'backlog' and 'queued'";
 
-      // Clean up the maps.
-      CHECK(paths.remove(timeout, info));
-      CHECK(timeouts.erase(path) > 0);
+    iterator->promise->discard();
+    backlog.erase(iterator);
+    queued.erase(path);
 
-      return true;
-    }
+    return true;
   }
 
-  LOG(FATAL) << "Inconsistent state across 'paths' and 'timeouts'";
   return false;
 }
 
@@ -125,33 +136,12 @@ void GarbageCollectorProcess::reset()
 
 void GarbageCollectorProcess::remove(const Timeout& removalTime)
 {
-  // TODO(bmahler): Other dispatches can block waiting for a removal
-  // operation. To fix this, the removal operation can be done
-  // asynchronously in another thread.
-  if (paths.count(removalTime) > 0) {
-    foreach (const PathInfo& info, paths.get(removalTime)) {
-      LOG(INFO) << "Deleting " << info.path;
-
-      // Run rmdir with 'continueOnError = true'. It's possible for
-      // tasks and isolators to lay down files that are not deletable by
-      // GC. In the face of such errors GC needs to free up disk space
-      // wherever it can because it's already re-offered to frameworks.
-      Try<Nothing> rmdir = os::rmdir(info.path, true, true, true);
-
-      if (rmdir.isError()) {
-        LOG(WARNING) << "Failed to delete '" << info.path << "': "
-                     << rmdir.error();
-        info.promise->fail(rmdir.error());
-      } else {
-        LOG(INFO) << "Deleted '" << info.path << "'";
-        info.promise->set(rmdir.get());
-      }
-
-      timeouts.erase(info.path);
-    }
-
-    paths.remove(removalTime);
-  } else {
+  // NOTE: The paths are only moved to the backlog here, the removal
+  // itself is done by the workers started in `drain()`, so that other
+  // dispatches are not blocked while (many) large paths are removed.
+  Schedule::iterator end = paths.upper_bound(removalTime);
+
+  if (paths.begin() == end) {
     // This occurs when either:
     //   1. The path(s) has already been removed (e.g. by prune()).
     //   2. All paths under the removal time were unscheduled.
@@ -159,22 +149,111 @@ void GarbageCollectorProcess::remove(const Timeout& removalTime)
               << " as the paths were already removed, or were unscheduled";
   }
 
+  for (Schedule::iterator iterator = paths.begin(); iterator != end;) {
+    const PathInfo& info = iterator->second;
+
+    queued[info.path] = backlog.insert(backlog.end(), info);
+    timeouts.erase(info.path);
+
+    iterator = paths.erase(iterator);
+  }
+
   reset(); // Schedule the timer for next event.
+
+  drain();
+}
+
+
+void GarbageCollectorProcess::drain()
+{
+  while (inflight < GC_MAX_CONCURRENT_REMOVALS && !backlog.empty()) {
+    const PathInfo info = backlog.front();
+
+    backlog.pop_front();
+    queued.erase(info.path);
+
+    ++inflight;
+
+    LOG(INFO) << "Deleting " << info.path;
+
+    // Run rmdir with 'continueOnError = true'. It's possible for
+    // tasks and isolators to lay down files that are not deletable by
+    // GC. In the face of such errors GC needs to free up disk space
+    // wherever it can because it's already re-offered to frameworks.
+    const string path = info.path;
+
+    async([path]() { return os::rmdir(path, true, true, true); })
+      .onAny(defer(self(), &Self::_drain, info, lambda::_1));
+  }
+}
+
+
+void GarbageCollectorProcess::_drain(
+    const PathInfo& info,
+    const Future<Try<Nothing>>& rmdir)
+{
+  CHECK_GT(inflight, 0u);
+  --inflight;
+
+  if (!rmdir.isReady() || rmdir->isError()) {
+    const string error = !rmdir.isReady()
+      ? (rmdir.isFailed() ? rmdir.failure() : "discarded")
+      : rmdir->error();
+
+    LOG(WARNING) << "Failed to delete '" << info.path << "': " << error;
+    info.promise->fail(error);
+  } else {
+    LOG(INFO) << "Deleted '" << info.path << "'";
+    info.promise->set(Nothing());
+  }
+
+  drain();
 }
 
 
 void GarbageCollectorProcess::prune(const Duration& d)
 {
-  foreach (const Timeout& removalTime, paths.keys()) {
-    if (removalTime.remaining() <= d) {
-      LOG(INFO) << "Pruning directories with remaining removal time "
-                << removalTime.remaining();
-      dispatch(self(), &GarbageCollectorProcess::remove, removalTime);
-    }
+  if (!paths.empty() && paths.begin()->first.remaining() <= d) {
+    LOG(INFO) << "Pruning directories with remaining removal time "
+              << "within " << d;
+
+    remove(Timeout::in(d));
   }
 }
 
 
+double GarbageCollectorProcess::_path_removals_inflight()
+{
+  return inflight;
+}
+
+
+double GarbageCollectorProcess::_path_removals_pending()
+{
+  return backlog.size();
+}
+
+
+GarbageCollectorProcess::Metrics::Metrics(const GarbageCollectorProcess& gc)
+  : path_removals_inflight(
+        "gc/path_removals_inflight",
+        defer(gc, &GarbageCollectorProcess::_path_removals_inflight)),
+    path_removals_pending(
+        "gc/path_removals_pending",
+        defer(gc, &GarbageCollectorProcess::_path_removals_pending))
+{
+  process::metrics::add(path_removals_inflight);
+  process::metrics::add(path_removals_pending);
+}
+
+
+GarbageCollectorProcess::Metrics::~Metrics()
+{
+  process::metrics::remove(path_removals_inflight);
+  process::metrics::remove(path_removals_pending);
+}
+
+
 GarbageCollector::GarbageCollector()
 {
   process = new GarbageCollectorProcess();
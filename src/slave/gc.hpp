@@ -17,6 +17,8 @@
 #ifndef __SLAVE_GC_HPP__
 #define __SLAVE_GC_HPP__
 
+#include <list>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -27,9 +29,10 @@
 #include <process/timeout.hpp>
 #include <process/timer.hpp>
 
+#include <process/metrics/gauge.hpp>
+
 #include <stout/duration.hpp>
 #include <stout/hashmap.hpp>
-#include <stout/multimap.hpp>
 #include <stout/nothing.hpp>
 #include <stout/try.hpp>
 
@@ -76,6 +79,8 @@ public:
 
   // Deletes all the directories, whose scheduled garbage collection time
   // is within the next 'd' duration of time.
+  // Note that the directories are removed asynchronously, the futures
+  // returned by `schedule` become ready once they have been removed.
   virtual void prune(const Duration& d);
 
 private:
@@ -88,7 +93,8 @@ class GarbageCollectorProcess :
 {
 public:
   GarbageCollectorProcess()
-    : ProcessBase(process::ID::generate("agent-garbage-collector")) {}
+    : ProcessBase(process::ID::generate("agent-garbage-collector")),
+      metrics(*this) {}
 
   virtual ~GarbageCollectorProcess();
 
@@ -101,10 +107,24 @@ public:
   void prune(const Duration& d);
 
 private:
+  struct PathInfo;
+
   void reset();
 
+  // Moves all the paths scheduled for removal at or before the given
+  // removal time to the backlog of the removal workers.
   void remove(const process::Timeout& removalTime);
 
+  // Starts removing paths from the backlog, as long as there are
+  // fewer than `GC_MAX_CONCURRENT_REMOVALS` removals in flight.
+  void drain();
+
+  // Continuation of `drain()`, invoked once a path has been removed.
+  void _drain(const PathInfo& info, const process::Future<Try<Nothing>>& rmdir);
+
+  double _path_removals_inflight();
+  double _path_removals_pending();
+
   struct PathInfo
   {
     PathInfo(const std::string& _path,
@@ -120,16 +140,40 @@ private:
     const process::Owned<process::Promise<Nothing>> promise;
   };
 
+  typedef std::multimap<process::Timeout, PathInfo> Schedule;
+  typedef std::list<PathInfo> Backlog;
+
   // Store all the timeouts and corresponding paths to delete.
-  // NOTE: We are using Multimap here instead of Multihashmap, because
-  // we need the keys of the map (deletion time) to be sorted.
-  Multimap<process::Timeout, PathInfo> paths;
+  // NOTE: We are using a multimap here instead of a Multihashmap,
+  // because we need the keys of the map (deletion time) to be sorted.
+  Schedule paths;
 
   // We also need efficient lookup for a path, to determine whether
-  // it exists in our paths mapping.
-  hashmap<std::string, process::Timeout> timeouts;
+  // it exists in our paths mapping. We keep the position of the path
+  // in the mapping so that it can be unscheduled in constant time.
+  hashmap<std::string, Schedule::iterator> timeouts;
+
+  // The paths whose removal time has passed (or that were pruned) and
+  // that are waiting for a removal worker, oldest first. These can
+  // still be unscheduled until their removal starts.
+  Backlog backlog;
+  hashmap<std::string, Backlog::iterator> queued;
+
+  // Number of paths that are currently being removed.
+  size_t inflight = 0;
 
   process::Timer timer;
+
+  struct Metrics
+  {
+    explicit Metrics(const GarbageCollectorProcess& gc);
+    ~Metrics();
+
+    process::metrics::Gauge path_removals_inflight;
+    process::metrics::Gauge path_removals_pending;
+  };
+
+  Metrics metrics;
 };
 
 } // namespace slave {
@@ -48,6 +48,7 @@
 #include <process/metrics/metrics.hpp>
 
 #include <stout/foreach.hpp>
+#include <stout/gzip.hpp>
 #include <stout/json.hpp>
 #include <stout/jsonify.hpp>
 #include <stout/lambda.hpp>
@@ -578,6 +579,9 @@ Future<Response> Slave::Http::_api(
 
     case mesos::agent::Call::ATTACH_CONTAINER_OUTPUT:
       return attachContainerOutput(call, mediaTypes, principal);
+
+    case mesos::agent::Call::SUBSCRIBE:
+      return subscribe(call, mediaTypes.accept, principal);
   }
 
   UNREACHABLE();
@@ -717,6 +721,20 @@ Future<Response> Slave::Http::executor(const Request& request) const
       return Accepted();
     }
 
+    case executor::Call::UPDATES: {
+      executor->batchedUpdates = true;
+
+      foreach (const executor::Call::Update& update, call.updates().updates()) {
+        slave->statusUpdate(protobuf::createStatusUpdate(
+            call.framework_id(),
+            update.status(),
+            slave->info.id()),
+            None());
+      }
+
+      return Accepted();
+    }
+
     case executor::Call::MESSAGE: {
       slave->executorMessage(
           slave->info.id(),
@@ -1041,6 +1059,11 @@ string Slave::Http::STATE_HELP() {
         "The information shown might be filtered based on the user",
         "accessing the endpoint.",
         "",
+        "Each response carries an `ETag` header which changes whenever",
+        "the frameworks, executors, tasks or resources of the agent change.",
+        "Returns 304 NOT_MODIFIED when the `If-None-Match` header of the",
+        "request matches the `ETag` of the current state.",
+        "",
         "Example (**Note**: this is not exhaustive):",
         "",
         "```",
@@ -1141,6 +1164,20 @@ Future<Response> Slave::Http::state(
     return ServiceUnavailable("Agent has not finished recovery");
   }
 
+  if (stateNotModified(request)) {
+    Response response(process::http::Status::NOT_MODIFIED);
+    response.headers["ETag"] = stateETag();
+    return response;
+  }
+
+  // Without an authorizer the state is the same for every principal,
+  // so the serialized state can be reused until it changes.
+  if (slave->authorizer.isNone() &&
+      slave->cachedState.isSome() &&
+      slave->cachedState->generation == slave->stateGeneration) {
+    return cachedStateResponse(request);
+  }
+
   // Retrieve `ObjectApprover`s for authorizing frameworks and tasks.
   Future<Owned<ObjectApprover>> frameworksApprover;
   Future<Owned<ObjectApprover>> tasksApprover;
@@ -1314,11 +1351,101 @@ Future<Response> Slave::Http::state(
         });
       };
 
-      return OK(jsonify(state), request.url.query.get("jsonp"));
+      if (slave->authorizer.isNone()) {
+        Slave::CachedState cachedState;
+        cachedState.generation = slave->stateGeneration;
+        cachedState.body = jsonify(state);
+
+        slave->cachedState = cachedState;
+
+        return cachedStateResponse(request);
+      }
+
+      Response response = jsonResponse(request, jsonify(state));
+      response.headers["ETag"] = stateETag();
+      return response;
     }));
 }
 
 
+string Slave::Http::stateETag() const
+{
+  // The start time distinguishes the generations of different runs of
+  // the agent, which keep the agent ID across restarts.
+  return "\"" + slave->info.id().value() + "-" +
+         stringify(slave->startTime.duration().ns()) + "-" +
+         stringify(slave->stateGeneration) + "\"";
+}
+
+
+bool Slave::Http::stateNotModified(const Request& request) const
+{
+  Option<string> ifNoneMatch = request.headers.get("If-None-Match");
+  if (ifNoneMatch.isNone()) {
+    return false;
+  }
+
+  const string etag = stateETag();
+
+  foreach (string tag, strings::tokenize(ifNoneMatch.get(), ",")) {
+    tag = strings::trim(tag);
+
+    // The state is not meant to be byte-for-byte identical between
+    // different encodings, so we accept weak validators as well.
+    if (strings::startsWith(tag, "W/")) {
+      tag = tag.substr(2);
+    }
+
+    if (tag == "*" || tag == etag) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
+Response Slave::Http::cachedStateResponse(const Request& request) const
+{
+  CHECK_SOME(slave->cachedState);
+
+  Slave::CachedState& cachedState = slave->cachedState.get();
+
+  const Option<string> jsonp = request.url.query.get("jsonp");
+
+  Response response;
+
+  if (jsonp.isSome()) {
+    response = OK(jsonp.get() + "(" + cachedState.body + ");",
+                  "text/javascript");
+  } else if (request.acceptsEncoding("gzip")) {
+    // Compress the body once per generation rather than letting
+    // libprocess compress it for every request.
+    if (cachedState.gzipped.isNone()) {
+      Try<string> compressed = gzip::compress(cachedState.body);
+      if (compressed.isError()) {
+        LOG(WARNING) << "Failed to gzip the state: " << compressed.error();
+      } else {
+        cachedState.gzipped = compressed.get();
+      }
+    }
+
+    if (cachedState.gzipped.isSome()) {
+      response = OK(cachedState.gzipped.get(), "application/json");
+      response.headers["Content-Encoding"] = "gzip";
+    } else {
+      response = OK(cachedState.body, "application/json");
+    }
+  } else {
+    response = OK(cachedState.body, "application/json");
+  }
+
+  response.headers["ETag"] = stateETag();
+
+  return response;
+}
+
+
 Future<Response> Slave::Http::getFrameworks(
     const agent::Call& call,
     ContentType acceptType,
@@ -1746,6 +1873,75 @@ agent::Response::GetState Slave::Http::_getState(
 }
 
 
+Future<Response> Slave::Http::subscribe(
+    const agent::Call& call,
+    ContentType acceptType,
+    const Option<string>& principal) const
+{
+  CHECK_EQ(agent::Call::SUBSCRIBE, call.type());
+
+  // Retrieve Approvers for authorizing frameworks and tasks.
+  Future<Owned<ObjectApprover>> frameworksApprover;
+  Future<Owned<ObjectApprover>> tasksApprover;
+  Future<Owned<ObjectApprover>> executorsApprover;
+  if (slave->authorizer.isSome()) {
+    authorization::Subject subject;
+    if (principal.isSome()) {
+      subject.set_value(principal.get());
+    }
+
+    frameworksApprover = slave->authorizer.get()->getObjectApprover(
+        subject, authorization::VIEW_FRAMEWORK);
+
+    tasksApprover = slave->authorizer.get()->getObjectApprover(
+        subject, authorization::VIEW_TASK);
+
+    executorsApprover = slave->authorizer.get()->getObjectApprover(
+        subject, authorization::VIEW_EXECUTOR);
+  } else {
+    frameworksApprover = Owned<ObjectApprover>(new AcceptingObjectApprover());
+    tasksApprover = Owned<ObjectApprover>(new AcceptingObjectApprover());
+    executorsApprover = Owned<ObjectApprover>(new AcceptingObjectApprover());
+  }
+
+  return collect(frameworksApprover, tasksApprover, executorsApprover)
+    .then(defer(slave->self(),
+      [=](const tuple<Owned<ObjectApprover>,
+                      Owned<ObjectApprover>,
+                      Owned<ObjectApprover>>& approvers)
+        -> Future<Response> {
+      // Get approver from tuple.
+      Owned<ObjectApprover> frameworksApprover;
+      Owned<ObjectApprover> tasksApprover;
+      Owned<ObjectApprover> executorsApprover;
+      tie(frameworksApprover, tasksApprover, executorsApprover) = approvers;
+
+      Pipe pipe;
+      OK ok;
+
+      ok.headers["Content-Type"] = stringify(acceptType);
+      ok.type = Response::PIPE;
+      ok.reader = pipe.reader();
+
+      HttpConnection http {pipe.writer(), acceptType};
+      slave->subscribe(http, UUID::random());
+
+      // NOTE: Only the snapshot is filtered by the approvers, see
+      // `Slave::Subscribers`.
+      agent::Event event;
+      event.set_type(agent::Event::SUBSCRIBED);
+      event.mutable_subscribed()->mutable_get_state()->CopyFrom(
+          _getState(frameworksApprover,
+                    tasksApprover,
+                    executorsApprover));
+
+      http.send<agent::Event, v1::agent::Event>(event);
+
+      return ok;
+    }));
+}
+
+
 string Slave::Http::STATISTICS_HELP()
 {
   return HELP(
@@ -1888,7 +2084,25 @@ string Slave::Http::CONTAINERS_HELP()
           "        \"timestamp\":1388534400.0",
           "    }",
           "}]",
-          "```"),
+          "```",
+          "",
+          "If the `history` query parameter is set to `true` (i.e.,",
+          "`/containers?history=true`), each entry also includes the",
+          "`statistics_history` of the container, i.e., the samples of its",
+          "resource usage retained by the agent (see the",
+          "`--container_usage_interval` and `--container_usage_history`",
+          "flags), oldest first.",
+          "",
+          "If the `stream` query parameter is set to `true`, the entries are",
+          "streamed as soon as the status and statistics of each container",
+          "are available, in no particular order. A container that does not",
+          "respond within the `timeout` query parameter (default: 10secs) is",
+          "returned without its status and statistics.",
+          "",
+          "If the `trace` query parameter is set to `true`, each entry also",
+          "includes the `trace` of the launch of the executor, i.e., the",
+          "`start` and `end` times of its `launch` (of the container),",
+          "`registration` and `task_running` (of the first task) spans."),
       AUTHENTICATION(true),
       AUTHORIZATION(
           "The request principal should be authorized to query this endpoint.",
@@ -1991,9 +2205,37 @@ Future<Response> Slave::Http::_containers(
     approver = Owned<ObjectApprover>(new AcceptingObjectApprover());
   }
 
-  return approver.then(defer(slave->self(), [this](
+  const bool history =
+    request.url.query.get("history") == Option<string>("true");
+
+  const bool trace =
+    request.url.query.get("trace") == Option<string>("true");
+
+  if (request.url.query.get("stream") == Option<string>("true")) {
+    Duration timeout = DEFAULT_CONTAINER_STREAM_TIMEOUT;
+
+    if (request.url.query.contains("timeout")) {
+      Try<Duration> parse =
+        Duration::parse(request.url.query.at("timeout"));
+
+      if (parse.isError()) {
+        return BadRequest(
+            "Failed to parse 'timeout' query parameter: " + parse.error());
+      }
+
+      timeout = parse.get();
+    }
+
+    return approver.then(defer(slave->self(), [this, history, trace, timeout](
+      const Owned<ObjectApprover>& approver) -> Response {
+        return streamContainers(
+            ___containers(approver, history, trace, timeout));
+      }));
+  }
+
+  return approver.then(defer(slave->self(), [this, history, trace](
     const Owned<ObjectApprover>& approver) {
-      return __containers(approver);
+      return __containers(approver, history, trace);
      }))
      .then([request](const Future<JSON::Array>& result) -> Future<Response> {
        if (!result.isReady()) {
@@ -2014,11 +2256,62 @@ Future<Response> Slave::Http::_containers(
 
 
 Future<JSON::Array> Slave::Http::__containers(
-    Option<Owned<ObjectApprover>> approver) const
+    Option<Owned<ObjectApprover>> approver,
+    bool history,
+    bool trace) const
 {
-  Owned<list<JSON::Object>> metadata(new list<JSON::Object>());
-  list<Future<ContainerStatus>> statusFutures;
-  list<Future<ResourceStatistics>> statsFutures;
+  return collect(___containers(approver, history, trace, None()))
+    .then([](const list<JSON::Object>& entries) -> JSON::Array {
+      JSON::Array result;
+      foreach (const JSON::Object& entry, entries) {
+        result.values.push_back(entry);
+      }
+
+      return result;
+    });
+}
+
+
+// Returns the spans of the launch of the executor that have started,
+// see `Executor::Trace`. The `end` of a span is absent until it ends.
+static JSON::Array spans(const Executor::Trace& trace)
+{
+  JSON::Array result;
+
+  auto add = [&result](
+      const string& name,
+      const Option<process::Time>& start,
+      const Option<process::Time>& end) {
+    if (start.isNone()) {
+      return;
+    }
+
+    JSON::Object span;
+    span.values["name"] = name;
+    span.values["start"] = start->secs();
+
+    if (end.isSome()) {
+      span.values["end"] = end->secs();
+    }
+
+    result.values.push_back(span);
+  };
+
+  add("launch", trace.launching, trace.launched);
+  add("registration", trace.launched, trace.registered);
+  add("task_running", trace.registered, trace.running);
+
+  return result;
+}
+
+
+list<Future<JSON::Object>> Slave::Http::___containers(
+    Option<Owned<ObjectApprover>> approver,
+    bool history,
+    bool trace,
+    const Option<Duration>& timeout) const
+{
+  list<Future<JSON::Object>> entries;
 
   foreachvalue (const Framework* framework, slave->frameworks) {
     foreachvalue (const Executor* executor, framework->executors) {
@@ -2047,75 +2340,154 @@ Future<JSON::Array> Slave::Http::__containers(
         }
       }
 
-      if (authorized.get()) {
-        JSON::Object entry;
-        entry.values["framework_id"] = info.framework_id().value();
-        entry.values["executor_id"] = info.executor_id().value();
-        entry.values["executor_name"] = info.name();
-        entry.values["source"] = info.source();
-        entry.values["container_id"] = containerId.value();
-
-        metadata->push_back(entry);
-        statusFutures.push_back(slave->containerizer->status(containerId));
-        statsFutures.push_back(slave->containerizer->usage(containerId));
+      if (!authorized.get()) {
+        continue;
+      }
+
+      JSON::Object entry;
+      entry.values["framework_id"] = info.framework_id().value();
+      entry.values["executor_id"] = info.executor_id().value();
+      entry.values["executor_name"] = info.name();
+      entry.values["source"] = info.source();
+      entry.values["container_id"] = containerId.value();
+
+      if (trace) {
+        entry.values["trace"] = spans(executor->trace);
       }
+
+      Future<ContainerStatus> status =
+        slave->containerizer->status(containerId);
+
+      Future<list<ResourceStatistics>> statistics;
+
+      if (history) {
+        statistics = slave->usageCollector->history(containerId);
+      } else {
+        statistics = slave->usageCollector->usage(containerId)
+          .then([](const ResourceStatistics& statistics) {
+            return list<ResourceStatistics>({statistics});
+          });
+      }
+
+      // A container that does not respond in time is reported without
+      // its status or statistics rather than holding up the others.
+      if (timeout.isSome()) {
+        status = status.after(
+            timeout.get(),
+            [](Future<ContainerStatus> status) -> Future<ContainerStatus> {
+              status.discard();
+              return Failure("Timed out");
+            });
+
+        statistics = statistics.after(
+            timeout.get(),
+            [](Future<list<ResourceStatistics>> statistics)
+                -> Future<list<ResourceStatistics>> {
+              statistics.discard();
+              return Failure("Timed out");
+            });
+      }
+
+      entries.push_back(await(status, statistics).then(
+          [entry, history](const tuple<
+              Future<ContainerStatus>,
+              Future<list<ResourceStatistics>>>& t) mutable {
+            const Future<ContainerStatus>& status = std::get<0>(t);
+            const Future<list<ResourceStatistics>>& stats = std::get<1>(t);
+
+            if (status.isReady()) {
+              entry.values["status"] = JSON::protobuf(status.get());
+            } else {
+              LOG(WARNING) << "Failed to get container status for executor '"
+                           << entry.values["executor_id"] << "'"
+                           << " of framework "
+                           << entry.values["framework_id"] << ": "
+                           << (status.isFailed()
+                                ? status.failure()
+                                : "discarded");
+            }
+
+            if (stats.isReady()) {
+              // The collector never returns an empty history.
+              CHECK(!stats.get().empty());
+
+              entry.values["statistics"] =
+                JSON::protobuf(stats.get().back());
+
+              if (history) {
+                JSON::Array samples;
+                foreach (const ResourceStatistics& sample, stats.get()) {
+                  samples.values.push_back(JSON::protobuf(sample));
+                }
+
+                entry.values["statistics_history"] = samples;
+              }
+            } else {
+              LOG(WARNING) << "Failed to get resource statistics for executor '"
+                           << entry.values["executor_id"] << "'"
+                           << " of framework "
+                           << entry.values["framework_id"] << ": "
+                           << (stats.isFailed()
+                                ? stats.failure()
+                                : "discarded");
+            }
+
+            return entry;
+          }));
     }
   }
 
-  return await(await(statusFutures), await(statsFutures)).then(
-      [metadata](const tuple<
-          Future<list<Future<ContainerStatus>>>,
-          Future<list<Future<ResourceStatistics>>>>& t)
-          -> Future<JSON::Array> {
-        const list<Future<ContainerStatus>>& status = std::get<0>(t).get();
-        const list<Future<ResourceStatistics>>& stats = std::get<1>(t).get();
-        CHECK_EQ(status.size(), stats.size());
-        CHECK_EQ(status.size(), metadata->size());
-
-        JSON::Array result;
-
-        auto statusIter = status.begin();
-        auto statsIter = stats.begin();
-        auto metadataIter = metadata->begin();
-
-        while (statusIter != status.end() &&
-               statsIter != stats.end() &&
-               metadataIter != metadata->end()) {
-          JSON::Object& entry= *metadataIter;
-
-          if (statusIter->isReady()) {
-            entry.values["status"] = JSON::protobuf(statusIter->get());
-          } else {
-            LOG(WARNING) << "Failed to get container status for executor '"
-                         << entry.values["executor_id"] << "'"
-                         << " of framework "
-                         << entry.values["framework_id"] << ": "
-                         << (statusIter->isFailed()
-                              ? statusIter->failure()
-                              : "discarded");
-          }
+  return entries;
+}
 
-          if (statsIter->isReady()) {
-            entry.values["statistics"] = JSON::protobuf(statsIter->get());
-          } else {
-            LOG(WARNING) << "Failed to get resource statistics for executor '"
-                         << entry.values["executor_id"] << "'"
-                         << " of framework "
-                         << entry.values["framework_id"] << ": "
-                         << (statsIter->isFailed()
-                              ? statsIter->failure()
-                              : "discarded");
-          }
 
-          result.values.push_back(entry);
+Response Slave::Http::streamContainers(
+    const list<Future<JSON::Object>>& entries) const
+{
+  // The state of the stream, only accessed from the agent actor.
+  struct Stream
+  {
+    Pipe::Writer writer;
+    size_t pending;
+    bool empty;
+  };
 
-          statusIter++;
-          statsIter++;
-          metadataIter++;
-        }
+  Pipe pipe;
 
-        return result;
-      });
+  std::shared_ptr<Stream> stream(
+      new Stream{pipe.writer(), entries.size(), true});
+
+  stream->writer.write("[");
+
+  if (entries.empty()) {
+    stream->writer.write("]");
+    stream->writer.close();
+  }
+
+  // Each entry is written as soon as it is ready, hence the entries
+  // are in the order in which the containers responded.
+  foreach (const Future<JSON::Object>& entry, entries) {
+    entry.onAny(defer(slave->self(), [stream](
+        const Future<JSON::Object>& entry) {
+      if (entry.isReady()) {
+        stream->writer.write(
+            (stream->empty ? "" : ",") + stringify(entry.get()));
+        stream->empty = false;
+      }
+
+      if (--stream->pending == 0) {
+        stream->writer.write("]");
+        stream->writer.close();
+      }
+    }));
+  }
+
+  OK ok;
+  ok.type = Response::PIPE;
+  ok.reader = pipe.reader();
+  ok.headers["Content-Type"] = APPLICATION_JSON;
+
+  return ok;
 }
 
 
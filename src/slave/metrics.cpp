@@ -91,7 +91,8 @@ Metrics::Metrics(const Slave& slave)
         "slave/executor_directory_max_allowed_age_secs",
         defer(slave, &Slave::_executor_directory_max_allowed_age_secs)),
     container_launch_errors(
-        "slave/container_launch_errors")
+        "slave/container_launch_errors"),
+    executor_launch("slave/executor_launch", Hours(1))
 {
   // TODO(dhamon): Check return values for metric registration.
   process::metrics::add(uptime_secs);
@@ -126,6 +127,7 @@ Metrics::Metrics(const Slave& slave)
   process::metrics::add(executor_directory_max_allowed_age_secs);
 
   process::metrics::add(container_launch_errors);
+  process::metrics::add(executor_launch);
 
   // Create resource gauges.
   // TODO(dhamon): Set these up dynamically when creating a slave
@@ -213,6 +215,7 @@ Metrics::~Metrics()
   process::metrics::remove(executor_directory_max_allowed_age_secs);
 
   process::metrics::remove(container_launch_errors);
+  process::metrics::remove(executor_launch);
 
   foreach (const Gauge& gauge, resources_total) {
     process::metrics::remove(gauge);
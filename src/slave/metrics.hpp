@@ -21,6 +21,9 @@
 
 #include <process/metrics/counter.hpp>
 #include <process/metrics/gauge.hpp>
+#include <process/metrics/timer.hpp>
+
+#include <stout/duration.hpp>
 
 
 namespace mesos {
@@ -68,6 +71,10 @@ struct Metrics
 
   process::metrics::Counter container_launch_errors;
 
+  // The durations of the launches of the executor containers, see
+  // `Executor::Trace` for the breakdown of a launch.
+  process::metrics::Timer<Milliseconds> executor_launch;
+
   // Non-revocable resources.
   std::vector<process::metrics::Gauge> resources_total;
   std::vector<process::metrics::Gauge> resources_used;
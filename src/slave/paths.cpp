@@ -30,6 +30,7 @@
 #include <stout/strings.hpp>
 #include <stout/try.hpp>
 #include <stout/unreachable.hpp>
+#include <stout/uuid.hpp>
 
 #include "common/validation.hpp"
 
@@ -64,9 +65,11 @@ const char RESOURCES_TARGET_FILE[] = "resources.target";
 
 
 const char SLAVES_DIR[] = "slaves";
+const char STATUS_UPDATES_DIR[] = "status_updates";
 const char FRAMEWORKS_DIR[] = "frameworks";
 const char EXECUTORS_DIR[] = "executors";
 const char CONTAINERS_DIR[] = "runs";
+const char SANDBOX_POOL_DIR[] = "sandbox_pool";
 
 
 Try<ExecutorRunPath> parseExecutorRunPath(
@@ -160,6 +163,14 @@ string getSlaveInfoPath(
 }
 
 
+string getStatusUpdateJournalPath(
+    const string& rootDir,
+    const SlaveID& slaveId)
+{
+  return path::join(getSlavePath(rootDir, slaveId), STATUS_UPDATES_DIR);
+}
+
+
 Try<list<string>> getFrameworkPaths(
     const string& rootDir,
     const SlaveID& slaveId)
@@ -495,13 +506,52 @@ string getPersistentVolumePath(
 }
 
 
+string getSandboxPoolPath(const string& rootDir)
+{
+  return path::join(rootDir, SANDBOX_POOL_DIR);
+}
+
+
+Try<string> createPooledSandbox(
+    const string& rootDir,
+    const Option<string>& user)
+{
+  const string directory =
+    path::join(getSandboxPoolPath(rootDir), UUID::random().toString());
+
+  Try<Nothing> mkdir = os::mkdir(directory);
+  if (mkdir.isError()) {
+    return Error(
+        "Failed to create pooled sandbox '" + directory + "': " +
+        mkdir.error());
+  }
+
+// `os::chown()` is not available on Windows.
+#ifndef __WINDOWS__
+  if (user.isSome()) {
+    Try<Nothing> chown = os::chown(user.get(), directory);
+    if (chown.isError()) {
+      os::rmdir(directory);
+
+      return Error(
+          "Failed to chown pooled sandbox '" + directory + "' to user '" +
+          user.get() + "': " + chown.error());
+    }
+  }
+#endif // __WINDOWS__
+
+  return directory;
+}
+
+
 string createExecutorDirectory(
     const string& rootDir,
     const SlaveID& slaveId,
     const FrameworkID& frameworkId,
     const ExecutorID& executorId,
     const ContainerID& containerId,
-    const Option<string>& user)
+    const Option<string>& user,
+    const Option<string>& sandbox)
 {
   // These IDs should be valid as they are either assigned by the
   // master/agent or validated by the master but we do a sanity check
@@ -514,10 +564,33 @@ string createExecutorDirectory(
   const string directory =
     getExecutorRunPath(rootDir, slaveId, frameworkId, executorId, containerId);
 
-  Try<Nothing> mkdir = os::mkdir(directory);
+  // A pooled sandbox has been created (and chowned) already, so it
+  // only needs to be renamed into place, which is atomic.
+  bool pooled = false;
 
-  CHECK_SOME(mkdir)
-    << "Failed to create executor directory '" << directory << "'";
+  if (sandbox.isSome()) {
+    Try<Nothing> mkdir = os::mkdir(Path(directory).dirname());
+
+    CHECK_SOME(mkdir)
+      << "Failed to create executor directory '" << directory << "'";
+
+    Try<Nothing> rename = os::rename(sandbox.get(), directory);
+    if (rename.isError()) {
+      LOG(WARNING) << "Failed to move pooled sandbox '" << sandbox.get()
+                   << "' to '" << directory << "': " << rename.error();
+
+      os::rmdir(sandbox.get());
+    } else {
+      pooled = true;
+    }
+  }
+
+  if (!pooled) {
+    Try<Nothing> mkdir = os::mkdir(directory);
+
+    CHECK_SOME(mkdir)
+      << "Failed to create executor directory '" << directory << "'";
+  }
 
   // Remove the previous "latest" symlink.
   const string latest =
@@ -537,7 +610,7 @@ string createExecutorDirectory(
 
 // `os::chown()` is not available on Windows.
 #ifndef __WINDOWS__
-  if (user.isSome()) {
+  if (user.isSome() && !pooled) {
     // Per MESOS-2592, we need to set the ownership of the executor
     // directory during its creation. We should not rely on subsequent
     // phases of the executor creation to ensure the ownership as
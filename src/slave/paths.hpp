@@ -69,6 +69,9 @@ namespace paths {
 //   |       |-- latest (symlink)
 //   |       |-- <slave_id>
 //   |           |-- slave.info
+//   |           |-- status_updates
+//   |           |   |-- <id>.snapshot
+//   |           |   |-- <id>.segment
 //   |           |-- frameworks
 //   |               |-- <framework_id>
 //   |                   |-- framework.info
@@ -86,11 +89,13 @@ namespace paths {
 //   |                                   |-- tasks
 //   |                                       |-- <task_id>
 //   |                                           |-- task.info
-//   |                                           |-- task.updates
+//   |                                           |-- task.updates (legacy)
 //   |-- volumes
 //   |   |-- roles
 //   |       |-- <role>
 //   |           |-- <persistence_id> (persistent volume)
+//   |-- sandbox_pool ('--sandbox_pool_size' flag)
+//   |   |-- <uuid> (pre-created sandbox)
 //   |-- provisioner
 
 
@@ -132,6 +137,11 @@ std::string getSlaveInfoPath(
     const SlaveID& slaveId);
 
 
+std::string getStatusUpdateJournalPath(
+    const std::string& rootDir,
+    const SlaveID& slaveId);
+
+
 std::string getSlavePath(
     const std::string& rootDir,
     const SlaveID& slaveId);
@@ -296,13 +306,28 @@ std::string getPersistentVolumePath(
     const Resource& resource);
 
 
+std::string getSandboxPoolPath(const std::string& rootDir);
+
+
+// Creates an empty sandbox in the sandbox pool, owned by the user if
+// specified, which can then be moved into place when launching an
+// executor (see `createExecutorDirectory`).
+Try<std::string> createPooledSandbox(
+    const std::string& rootDir,
+    const Option<std::string>& user = None());
+
+
+// Creates the sandbox of an executor, owned by the user if specified.
+// If a pooled sandbox of the same user is given, it is renamed into
+// place rather than creating (and chowning) a new directory.
 std::string createExecutorDirectory(
     const std::string& rootDir,
     const SlaveID& slaveId,
     const FrameworkID& frameworkId,
     const ExecutorID& executorId,
     const ContainerID& containerId,
-    const Option<std::string>& user = None());
+    const Option<std::string>& user = None(),
+    const Option<std::string>& sandbox = None());
 
 
 std::string createSlaveDirectory(
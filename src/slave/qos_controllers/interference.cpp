@@ -0,0 +1,495 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <list>
+
+#include <mesos/module/qos_controller.hpp>
+
+#include <mesos/slave/qos_controller.hpp>
+
+#include <process/defer.hpp>
+#include <process/delay.hpp>
+#include <process/dispatch.hpp>
+#include <process/future.hpp>
+#include <process/id.hpp>
+#include <process/owned.hpp>
+#include <process/process.hpp>
+
+#include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/hashset.hpp>
+#include <stout/lambda.hpp>
+#include <stout/numify.hpp>
+#include <stout/option.hpp>
+
+#include "slave/qos_controllers/interference.hpp"
+
+using namespace mesos;
+using namespace process;
+
+using std::list;
+
+using mesos::modules::Module;
+
+using mesos::slave::QoSController;
+using mesos::slave::QoSCorrection;
+
+namespace mesos {
+namespace internal {
+namespace slave {
+
+// The size of a cache line, i.e., the number of bytes that a cache
+// miss transfers from memory.
+constexpr Bytes CACHE_LINE_SIZE = Bytes(64);
+
+
+class InterferenceQoSControllerProcess
+  : public Process<InterferenceQoSControllerProcess>
+{
+public:
+  InterferenceQoSControllerProcess(
+      const lambda::function<Future<ResourceUsage>()>& _usage,
+      const Option<double>& _cpiThreshold,
+      const Option<double>& _cacheMissesThreshold,
+      const Option<Bytes>& _memoryBandwidthThreshold,
+      const Duration& _interval,
+      double _minCpusFraction,
+      size_t _evictAfter,
+      const Option<Duration>& _oomHorizon,
+      double _minMemFraction)
+    : ProcessBase(process::ID::generate("qos-interference-controller")),
+      usage(_usage),
+      cpiThreshold(_cpiThreshold),
+      cacheMissesThreshold(_cacheMissesThreshold),
+      memoryBandwidthThreshold(_memoryBandwidthThreshold),
+      interval(_interval),
+      minCpusFraction(_minCpusFraction),
+      evictAfter(_evictAfter),
+      oomHorizon(_oomHorizon),
+      minMemFraction(_minMemFraction) {}
+
+  Future<list<QoSCorrection>> corrections()
+  {
+    // The agent asks for the next corrections as soon as it got the
+    // previous ones, hence we wait for the interval before evaluating.
+    Owned<Promise<Nothing>> promise(new Promise<Nothing>());
+    delay(interval, self(), &Self::elapsed, promise);
+
+    return promise->future()
+      .then(defer(self(), [this]() { return usage(); }))
+      .then(defer(self(), &Self::_corrections, lambda::_1));
+  }
+
+  void elapsed(Owned<Promise<Nothing>> promise)
+  {
+    promise->set(Nothing());
+  }
+
+  Future<list<QoSCorrection>> _corrections(const ResourceUsage& usage)
+  {
+    bool interference = false;
+    bool pressure = false;
+    double bandwidth = 0;
+
+    foreach (const ResourceUsage::Executor& executor, usage.executors()) {
+      if (oomHorizon.isSome() &&
+          executor.has_statistics() &&
+          Resources(executor.allocated()).revocable().empty() &&
+          oom(executor)) {
+        pressure = true;
+      }
+
+      if (!executor.has_statistics() || !executor.statistics().has_perf()) {
+        continue;
+      }
+
+      const PerfStatistics& perf = executor.statistics().perf();
+
+      // Skip the empty samples, i.e., before the first sample.
+      if (perf.duration() <= 0) {
+        continue;
+      }
+
+      if (perf.has_cache_misses()) {
+        bandwidth +=
+          perf.cache_misses() * CACHE_LINE_SIZE.bytes() / perf.duration();
+      }
+
+      // The revocable executors are the ones causing interference.
+      if (!Resources(executor.allocated()).revocable().empty() ||
+          !perf.has_instructions() ||
+          perf.instructions() == 0) {
+        continue;
+      }
+
+      const ExecutorID& executorId = executor.executor_info().executor_id();
+
+      if (cpiThreshold.isSome() && perf.has_cycles()) {
+        double cpi = static_cast<double>(perf.cycles()) / perf.instructions();
+        if (cpi > cpiThreshold.get()) {
+          LOG(INFO) << "CPI " << cpi << " of executor '" << executorId
+                    << "' exceeds threshold " << cpiThreshold.get();
+          interference = true;
+        }
+      }
+
+      if (cacheMissesThreshold.isSome() && perf.has_cache_misses()) {
+        double misses =
+          1000.0 * perf.cache_misses() / perf.instructions();
+        if (misses > cacheMissesThreshold.get()) {
+          LOG(INFO) << "Cache misses per thousand instructions " << misses
+                    << " of executor '" << executorId
+                    << "' exceed threshold " << cacheMissesThreshold.get();
+          interference = true;
+        }
+      }
+    }
+
+    if (memoryBandwidthThreshold.isSome() &&
+        bandwidth > memoryBandwidthThreshold->bytes()) {
+      LOG(INFO) << "Memory bandwidth " << Bytes(bandwidth) << "/s"
+                << " exceeds threshold " << memoryBandwidthThreshold.get()
+                << "/s";
+      interference = true;
+    }
+
+    list<QoSCorrection> corrections;
+    hashset<ContainerID> containers;
+
+    foreach (const ResourceUsage::Executor& executor, usage.executors()) {
+      if (Resources(executor.allocated()).revocable().empty()) {
+        continue;
+      }
+
+      const ContainerID& containerId = executor.container_id();
+      containers.insert(containerId);
+
+      Info& info = infos[containerId];
+
+      const double fraction = info.fraction;
+      const double memFraction = info.memFraction;
+
+      // Whether the container is throttled to the minimum but is
+      // still interfering.
+      bool exhausted = false;
+
+      if (interference) {
+        if (info.fraction > minCpusFraction) {
+          info.fraction = std::max(info.fraction / 2, minCpusFraction);
+        } else {
+          exhausted = true;
+        }
+      } else if (info.fraction < 1) {
+        info.fraction = std::min(info.fraction * 2, 1.0);
+      }
+
+      if (pressure) {
+        if (info.memFraction > minMemFraction) {
+          info.memFraction = std::max(info.memFraction / 2, minMemFraction);
+        } else {
+          exhausted = true;
+        }
+      } else if (info.memFraction < 1) {
+        info.memFraction = std::min(info.memFraction * 2, 1.0);
+      }
+
+      if (exhausted) {
+        if (++info.evaluations >= evictAfter) {
+          corrections.push_back(kill(executor));
+          infos.erase(containerId);
+          continue;
+        }
+      } else if (!interference && !pressure) {
+        info.evaluations = 0;
+      }
+
+      if (info.fraction != fraction || info.memFraction != memFraction) {
+        corrections.push_back(throttle(executor, info));
+      }
+    }
+
+    // Forget about the containers that are gone.
+    foreach (const ContainerID& containerId, infos.keys()) {
+      if (!containers.contains(containerId)) {
+        infos.erase(containerId);
+      }
+    }
+
+    return corrections;
+  }
+
+private:
+  static QoSCorrection kill(const ResourceUsage::Executor& executor)
+  {
+    QoSCorrection correction;
+
+    correction.set_type(mesos::slave::QoSCorrection_Type_KILL);
+    correction.mutable_kill()->mutable_framework_id()->CopyFrom(
+        executor.executor_info().framework_id());
+    correction.mutable_kill()->mutable_executor_id()->CopyFrom(
+        executor.executor_info().executor_id());
+    correction.mutable_kill()->mutable_container_id()->CopyFrom(
+        executor.container_id());
+
+    return correction;
+  }
+
+  // Returns true if an OOM of the (non-revocable) executor is
+  // predicted within the OOM horizon.
+  bool oom(const ResourceUsage::Executor& executor) const
+  {
+    const ResourceStatistics& statistics = executor.statistics();
+    const ExecutorID& executorId = executor.executor_info().executor_id();
+
+    if (statistics.mem_critical_pressure_rate() > 0) {
+      LOG(INFO) << "Executor '" << executorId << "' is under critical "
+                << "memory pressure";
+      return true;
+    }
+
+    // The rss sampled on the pressure events is only relevant while
+    // the executor is under pressure.
+    if (statistics.mem_medium_pressure_rate() <= 0 ||
+        statistics.mem_pressure_interval_secs() <= 0 ||
+        statistics.mem_pressure_rss_delta_bytes() <= 0 ||
+        !statistics.has_mem_limit_bytes() ||
+        !statistics.has_mem_total_bytes()) {
+      return false;
+    }
+
+    const double growth =
+      statistics.mem_pressure_rss_delta_bytes() /
+      statistics.mem_pressure_interval_secs();
+
+    const double headroom =
+      static_cast<double>(statistics.mem_limit_bytes()) -
+      static_cast<double>(statistics.mem_total_bytes());
+
+    if (headroom / growth < oomHorizon->secs()) {
+      LOG(INFO) << "Executor '" << executorId << "' is predicted to run "
+                << "out of memory in " << Seconds(headroom / growth)
+                << ": its rss grows by " << Bytes(growth) << "/s under "
+                << "memory pressure";
+      return true;
+    }
+
+    return false;
+  }
+
+  // The throttling of a revocable container.
+  struct Info
+  {
+    // The fraction of its allocated cpus the container may use.
+    double fraction = 1;
+
+    // The fraction of its allocated memory the container is shrunk to.
+    double memFraction = 1;
+
+    // The number of evaluations that detected interference while the
+    // container was throttled to the minimum fraction.
+    size_t evaluations = 0;
+  };
+
+  static QoSCorrection throttle(
+      const ResourceUsage::Executor& executor,
+      const Info& info)
+  {
+    QoSCorrection correction;
+
+    correction.set_type(mesos::slave::QoSCorrection_Type_THROTTLE);
+    correction.mutable_throttle()->mutable_framework_id()->CopyFrom(
+        executor.executor_info().framework_id());
+    correction.mutable_throttle()->mutable_executor_id()->CopyFrom(
+        executor.executor_info().executor_id());
+    correction.mutable_throttle()->mutable_container_id()->CopyFrom(
+        executor.container_id());
+    correction.mutable_throttle()->set_cpus_fraction(info.fraction);
+    correction.mutable_throttle()->set_mem_fraction(info.memFraction);
+
+    return correction;
+  }
+
+  const lambda::function<Future<ResourceUsage>()> usage;
+  const Option<double> cpiThreshold;
+  const Option<double> cacheMissesThreshold;
+  const Option<Bytes> memoryBandwidthThreshold;
+  const Duration interval;
+  const double minCpusFraction;
+  const size_t evictAfter;
+  const Option<Duration> oomHorizon;
+  const double minMemFraction;
+
+  hashmap<ContainerID, Info> infos;
+};
+
+
+InterferenceQoSController::~InterferenceQoSController()
+{
+  if (process.get() != nullptr) {
+    terminate(process.get());
+    wait(process.get());
+  }
+}
+
+
+Try<Nothing> InterferenceQoSController::initialize(
+  const lambda::function<Future<ResourceUsage>()>& usage)
+{
+  if (process.get() != nullptr) {
+    return Error("Interference QoS Controller has already been initialized");
+  }
+
+  process.reset(
+      new InterferenceQoSControllerProcess(
+          usage,
+          cpiThreshold,
+          cacheMissesThreshold,
+          memoryBandwidthThreshold,
+          interval,
+          minCpusFraction,
+          evictAfter,
+          oomHorizon,
+          minMemFraction));
+
+  spawn(process.get());
+
+  return Nothing();
+}
+
+
+process::Future<list<QoSCorrection>> InterferenceQoSController::corrections()
+{
+  if (process.get() == nullptr) {
+    return Failure("Interference QoS Controller is not initialized");
+  }
+
+  return dispatch(
+      process.get(),
+      &InterferenceQoSControllerProcess::corrections);
+}
+
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
+
+
+static QoSController* create(const Parameters& parameters)
+{
+  using mesos::internal::slave::InterferenceQoSController;
+
+  Option<double> cpiThreshold = None();
+  Option<double> cacheMissesThreshold = None();
+  Option<Bytes> memoryBandwidthThreshold = None();
+  Duration interval = Seconds(1);
+  double minCpusFraction = InterferenceQoSController::DEFAULT_MIN_CPUS_FRACTION;
+  size_t evictAfter = InterferenceQoSController::DEFAULT_EVICT_AFTER;
+  Option<Duration> oomHorizon = None();
+  double minMemFraction = InterferenceQoSController::DEFAULT_MIN_MEM_FRACTION;
+
+  foreach (const Parameter& parameter, parameters.parameter()) {
+    const std::string& key = parameter.key();
+    const std::string& value = parameter.value();
+
+    if (key == "cpi_threshold" ||
+        key == "cache_misses_threshold" ||
+        key == "min_cpus_fraction" ||
+        key == "min_mem_fraction") {
+      Try<double> number = numify<double>(value);
+      if (number.isError()) {
+        LOG(ERROR) << "Failed to parse '" << key << "': " << number.error();
+        return nullptr;
+      }
+
+      if (key == "cpi_threshold") {
+        cpiThreshold = number.get();
+      } else if (key == "cache_misses_threshold") {
+        cacheMissesThreshold = number.get();
+      } else if (key == "min_cpus_fraction") {
+        minCpusFraction = number.get();
+      } else {
+        minMemFraction = number.get();
+      }
+    } else if (key == "memory_bandwidth_threshold") {
+      // The threshold is the number of bytes per second, e.g., "10GB".
+      Try<Bytes> bytes = Bytes::parse(value);
+      if (bytes.isError()) {
+        LOG(ERROR) << "Failed to parse '" << key << "': " << bytes.error();
+        return nullptr;
+      }
+
+      memoryBandwidthThreshold = bytes.get();
+    } else if (key == "interval" || key == "oom_horizon") {
+      Try<Duration> duration = Duration::parse(value);
+      if (duration.isError()) {
+        LOG(ERROR) << "Failed to parse '" << key << "': " << duration.error();
+        return nullptr;
+      }
+
+      if (key == "interval") {
+        interval = duration.get();
+      } else {
+        oomHorizon = duration.get();
+      }
+    } else if (key == "evict_after") {
+      Try<size_t> number = numify<size_t>(value);
+      if (number.isError()) {
+        LOG(ERROR) << "Failed to parse '" << key << "': " << number.error();
+        return nullptr;
+      }
+
+      evictAfter = number.get();
+    }
+  }
+
+  if (cpiThreshold.isNone() &&
+      cacheMissesThreshold.isNone() &&
+      memoryBandwidthThreshold.isNone() &&
+      oomHorizon.isNone()) {
+    LOG(ERROR) << "No thresholds are configured for InterferenceQoSController";
+    return nullptr;
+  }
+
+  if (minCpusFraction <= 0 || minCpusFraction > 1) {
+    LOG(ERROR) << "The minimum cpus fraction must be in (0, 1]";
+    return nullptr;
+  }
+
+  if (minMemFraction <= 0 || minMemFraction > 1) {
+    LOG(ERROR) << "The minimum mem fraction must be in (0, 1]";
+    return nullptr;
+  }
+
+  return new InterferenceQoSController(
+      cpiThreshold,
+      cacheMissesThreshold,
+      memoryBandwidthThreshold,
+      interval,
+      minCpusFraction,
+      evictAfter,
+      oomHorizon,
+      minMemFraction);
+}
+
+
+Module<QoSController> org_apache_mesos_InterferenceQoSController(
+    MESOS_MODULE_API_VERSION,
+    MESOS_VERSION,
+    "Apache Mesos",
+    "modules@mesos.apache.org",
+    "Interference QoS Controller Module.",
+    nullptr,
+    create);
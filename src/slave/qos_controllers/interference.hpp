@@ -0,0 +1,116 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __SLAVE_QOS_CONTROLLERS_INTERFERENCE_HPP__
+#define __SLAVE_QOS_CONTROLLERS_INTERFERENCE_HPP__
+
+#include <list>
+
+#include <mesos/slave/qos_controller.hpp>
+
+#include <stout/bytes.hpp>
+#include <stout/duration.hpp>
+#include <stout/lambda.hpp>
+#include <stout/none.hpp>
+#include <stout/option.hpp>
+#include <stout/try.hpp>
+
+#include <process/future.hpp>
+#include <process/owned.hpp>
+
+namespace mesos {
+namespace internal {
+namespace slave {
+
+// Forward declaration.
+class InterferenceQoSControllerProcess;
+
+
+// The `InterferenceQoSController` protects the non-revocable
+// executors from interference by the revocable executors, based on
+// the perf statistics of the containers (see the perf_event isolator
+// and the `--perf_events` flag). Interference is detected when the
+// cycles per instruction (CPI) or the cache misses per thousand
+// instructions of a non-revocable executor, or the memory bandwidth
+// of all executors (estimated from their cache misses), exceed the
+// configured thresholds.
+//
+// The revocable executors are throttled first: their cpus are halved
+// on every evaluation that detects interference, down to a minimum
+// fraction of their allocated cpus. They are evicted if interference
+// is still detected after `evictAfter` evaluations at the minimum.
+// The throttling is lifted gradually (the cpus are doubled on every
+// evaluation) once interference is no longer detected.
+//
+// If an OOM horizon is configured, the memory pressure statistics of
+// the containers (see the cgroups memory subsystem) are used to
+// predict an OOM of a non-revocable executor: an OOM is predicted if
+// the executor is under critical memory pressure, or if it is under
+// medium memory pressure and its rss grows fast enough (as sampled on
+// the pressure events) to reach its memory limit within the horizon.
+// The memory of the revocable executors is then shrunk the same way
+// as their cpus, so that the kernel reclaims their memory first.
+class InterferenceQoSController : public mesos::slave::QoSController
+{
+public:
+  static constexpr double DEFAULT_MIN_CPUS_FRACTION = 0.1;
+  static constexpr size_t DEFAULT_EVICT_AFTER = 5;
+  static constexpr double DEFAULT_MIN_MEM_FRACTION = 0.1;
+
+  // NOTE: The interval is the time between two evaluations, which
+  // should be close to the `--perf_interval` of the agent.
+  InterferenceQoSController(
+      const Option<double>& _cpiThreshold,
+      const Option<double>& _cacheMissesThreshold,
+      const Option<Bytes>& _memoryBandwidthThreshold,
+      const Duration& _interval = Seconds(1),
+      double _minCpusFraction = DEFAULT_MIN_CPUS_FRACTION,
+      size_t _evictAfter = DEFAULT_EVICT_AFTER,
+      const Option<Duration>& _oomHorizon = None(),
+      double _minMemFraction = DEFAULT_MIN_MEM_FRACTION)
+    : cpiThreshold(_cpiThreshold),
+      cacheMissesThreshold(_cacheMissesThreshold),
+      memoryBandwidthThreshold(_memoryBandwidthThreshold),
+      interval(_interval),
+      minCpusFraction(_minCpusFraction),
+      evictAfter(_evictAfter),
+      oomHorizon(_oomHorizon),
+      minMemFraction(_minMemFraction) {}
+
+  virtual ~InterferenceQoSController();
+
+  virtual Try<Nothing> initialize(
+    const lambda::function<process::Future<ResourceUsage>()>& usage);
+
+  virtual process::Future<std::list<mesos::slave::QoSCorrection>> corrections();
+
+private:
+  const Option<double> cpiThreshold;
+  const Option<double> cacheMissesThreshold;
+  const Option<Bytes> memoryBandwidthThreshold;
+  const Duration interval;
+  const double minCpusFraction;
+  const size_t evictAfter;
+  const Option<Duration> oomHorizon;
+  const double minMemFraction;
+  process::Owned<InterferenceQoSControllerProcess> process;
+};
+
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __SLAVE_QOS_CONTROLLERS_INTERFERENCE_HPP__
@@ -0,0 +1,364 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <mesos/module/resource_estimator.hpp>
+
+#include <mesos/slave/resource_estimator.hpp>
+
+#include <process/clock.hpp>
+#include <process/defer.hpp>
+#include <process/dispatch.hpp>
+#include <process/id.hpp>
+#include <process/owned.hpp>
+#include <process/process.hpp>
+#include <process/time.hpp>
+
+#include <stout/bytes.hpp>
+#include <stout/duration.hpp>
+#include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/lambda.hpp>
+#include <stout/numify.hpp>
+#include <stout/strings.hpp>
+
+using namespace mesos;
+using namespace process;
+
+using std::deque;
+using std::string;
+using std::vector;
+
+using mesos::modules::Module;
+
+using mesos::slave::ResourceEstimator;
+
+
+// Estimates the resources that can be oversubscribed from the slack
+// between the resources allocated to the (non-revocable) executors
+// and their actual usage. Every estimate samples the slack, and the
+// estimate is a low percentile of the slack sampled over a sliding
+// window minus a safety margin (a fraction of the allocated
+// resources). The cpu usage is derived from the cpu time of the
+// executors between two estimates and the memory usage is their RSS.
+// Executors whose usage is not known (yet) are considered to use all
+// of their allocated resources.
+class UsageResourceEstimatorProcess
+  : public Process<UsageResourceEstimatorProcess>
+{
+public:
+  UsageResourceEstimatorProcess(
+      const lambda::function<Future<ResourceUsage>()>& _usage,
+      const Duration& _window,
+      double _percentile,
+      double _safetyMargin,
+      bool _mem)
+    : ProcessBase(process::ID::generate("usage-resource-estimator")),
+      usage(_usage),
+      window(_window),
+      percentile(_percentile),
+      safetyMargin(_safetyMargin),
+      mem(_mem) {}
+
+  Future<Resources> oversubscribable()
+  {
+    return usage().then(defer(self(), &Self::_oversubscribable, lambda::_1));
+  }
+
+  Future<Resources> _oversubscribable(const ResourceUsage& usage)
+  {
+    Resources allocatedRevocable;
+
+    double allocatedCpus = 0;
+    Bytes allocatedMem = 0;
+
+    Slack slack;
+    slack.time = Clock::now();
+
+    hashmap<ContainerID, CpuTime> cpuTimes;
+
+    foreach (const ResourceUsage::Executor& executor, usage.executors()) {
+      const Resources allocated = executor.allocated();
+      allocatedRevocable += allocated.revocable();
+
+      const Resources nonRevocable = allocated.nonRevocable();
+
+      const double cpus = nonRevocable.cpus().getOrElse(0);
+      const Bytes mem = nonRevocable.mem().getOrElse(Bytes(0));
+
+      allocatedCpus += cpus;
+      allocatedMem += mem;
+
+      if (!executor.has_statistics()) {
+        continue;
+      }
+
+      const ResourceStatistics& statistics = executor.statistics();
+      const ContainerID& containerId = executor.container_id();
+
+      if (statistics.has_cpus_user_time_secs() &&
+          statistics.has_cpus_system_time_secs()) {
+        CpuTime cpuTime;
+        cpuTime.timestamp = statistics.timestamp();
+        cpuTime.secs =
+          statistics.cpus_user_time_secs() +
+          statistics.cpus_system_time_secs();
+
+        if (previous.contains(containerId)) {
+          const CpuTime& last = previous.at(containerId);
+          double elapsed = cpuTime.timestamp - last.timestamp;
+
+          if (elapsed > 0) {
+            double used = (cpuTime.secs - last.secs) / elapsed;
+            slack.cpus += std::max(cpus - used, 0.0);
+          }
+        }
+
+        cpuTimes.put(containerId, cpuTime);
+      }
+
+      if (statistics.has_mem_rss_bytes() &&
+          Bytes(statistics.mem_rss_bytes()) < mem) {
+        slack.mem += mem - Bytes(statistics.mem_rss_bytes());
+      }
+    }
+
+    // Only keep the cpu times of the current executors.
+    previous = cpuTimes;
+
+    slacks.push_back(slack);
+    while (slacks.front().time < slack.time - window) {
+      slacks.pop_front();
+    }
+
+    vector<double> cpus;
+    vector<Bytes> mems;
+    foreach (const Slack& sample, slacks) {
+      cpus.push_back(sample.cpus);
+      mems.push_back(sample.mem);
+    }
+
+    // Round the estimate down (to tenths of cpus and to megabytes) so
+    // that it doesn't change, and hence not get forwarded to the
+    // master, for every little change of the usage.
+    double estimatedCpus =
+      std::floor(
+          std::max(
+              lowest(cpus) - safetyMargin * allocatedCpus, 0.0) * 10) / 10;
+
+    Resources estimate = revocable("cpus", estimatedCpus);
+
+    if (mem) {
+      double slackMem = static_cast<double>(lowest(mems).bytes());
+      double marginMem = safetyMargin * allocatedMem.bytes();
+
+      Bytes estimatedMem =
+        Bytes(static_cast<uint64_t>(std::max(slackMem - marginMem, 0.0)));
+
+      estimate += revocable("mem", std::floor(estimatedMem.megabytes()));
+    }
+
+    return estimate - allocatedRevocable;
+  }
+
+private:
+  // Returns the (100 - `percentile`)th percentile of the slack, which
+  // corresponds to the `percentile`th percentile of the usage.
+  template <typename T>
+  T lowest(vector<T> values) const
+  {
+    std::sort(values.begin(), values.end());
+
+    size_t index = static_cast<size_t>(
+        std::floor((1 - percentile / 100) * (values.size() - 1)));
+
+    return values[index];
+  }
+
+  static Resources revocable(const string& name, double value)
+  {
+    if (value <= 0) {
+      return Resources();
+    }
+
+    Try<Resource> resource = Resources::parse(name, stringify(value), "*");
+    CHECK_SOME(resource);
+
+    resource->mutable_revocable();
+
+    return resource.get();
+  }
+
+  struct CpuTime
+  {
+    double timestamp;
+    double secs;
+  };
+
+  struct Slack
+  {
+    Time time;
+    double cpus = 0;
+    Bytes mem = 0;
+  };
+
+  const lambda::function<Future<ResourceUsage>()> usage;
+  const Duration window;
+  const double percentile;
+  const double safetyMargin;
+  const bool mem;
+
+  // The cpu times of the executors at the previous estimate.
+  hashmap<ContainerID, CpuTime> previous;
+
+  // The slack sampled at every estimate within the window.
+  deque<Slack> slacks;
+};
+
+
+class UsageResourceEstimator : public ResourceEstimator
+{
+public:
+  UsageResourceEstimator(
+      const Duration& _window,
+      double _percentile,
+      double _safetyMargin,
+      bool _mem)
+    : window(_window),
+      percentile(_percentile),
+      safetyMargin(_safetyMargin),
+      mem(_mem) {}
+
+  virtual ~UsageResourceEstimator()
+  {
+    if (process.get() != nullptr) {
+      terminate(process.get());
+      wait(process.get());
+    }
+  }
+
+  virtual Try<Nothing> initialize(
+      const lambda::function<Future<ResourceUsage>()>& usage)
+  {
+    if (process.get() != nullptr) {
+      return Error("Usage resource estimator has already been initialized");
+    }
+
+    process.reset(new UsageResourceEstimatorProcess(
+        usage, window, percentile, safetyMargin, mem));
+
+    spawn(process.get());
+
+    return Nothing();
+  }
+
+  virtual Future<Resources> oversubscribable()
+  {
+    if (process.get() == nullptr) {
+      return Failure("Usage resource estimator is not initialized");
+    }
+
+    return dispatch(
+        process.get(),
+        &UsageResourceEstimatorProcess::oversubscribable);
+  }
+
+private:
+  const Duration window;
+  const double percentile;
+  const double safetyMargin;
+  const bool mem;
+  Owned<UsageResourceEstimatorProcess> process;
+};
+
+
+static bool compatible()
+{
+  // TODO(jieyu): Check compatibility.
+  return true;
+}
+
+
+static ResourceEstimator* create(const Parameters& parameters)
+{
+  Duration window = Minutes(5);
+  double percentile = 95;
+  double safetyMargin = 0.1;
+  bool mem = false;
+
+  foreach (const Parameter& parameter, parameters.parameter()) {
+    if (parameter.key() == "window") {
+      Try<Duration> duration = Duration::parse(parameter.value());
+      if (duration.isError()) {
+        LOG(ERROR) << "Failed to parse 'window': " << duration.error();
+        return nullptr;
+      }
+
+      window = duration.get();
+    } else if (parameter.key() == "percentile" ||
+               parameter.key() == "safety_margin") {
+      Try<double> number = numify<double>(parameter.value());
+      if (number.isError()) {
+        LOG(ERROR) << "Failed to parse '" << parameter.key() << "': "
+                   << number.error();
+        return nullptr;
+      }
+
+      if (parameter.key() == "percentile") {
+        percentile = number.get();
+      } else {
+        safetyMargin = number.get();
+      }
+    } else if (parameter.key() == "resources") {
+      foreach (const string& name,
+               strings::tokenize(parameter.value(), ",")) {
+        if (name == "mem") {
+          mem = true;
+        } else if (name != "cpus") {
+          LOG(ERROR) << "Unsupported resource '" << name << "'";
+          return nullptr;
+        }
+      }
+    }
+  }
+
+  if (percentile < 0 || percentile > 100) {
+    LOG(ERROR) << "The percentile must be in [0, 100]";
+    return nullptr;
+  }
+
+  if (safetyMargin < 0 || safetyMargin > 1) {
+    LOG(ERROR) << "The safety margin must be in [0, 1]";
+    return nullptr;
+  }
+
+  return new UsageResourceEstimator(window, percentile, safetyMargin, mem);
+}
+
+
+Module<ResourceEstimator> org_apache_mesos_UsageResourceEstimator(
+    MESOS_MODULE_API_VERSION,
+    MESOS_VERSION,
+    "Apache Mesos",
+    "modules@mesos.apache.org",
+    "Usage Resource Estimator Module.",
+    compatible,
+    create);
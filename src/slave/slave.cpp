@@ -27,6 +27,7 @@
 #include <set>
 #include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <mesos/type_utils.hpp>
@@ -68,6 +69,7 @@
 #ifdef __linux__
 #include "linux/cgroups.hpp"
 #include "linux/fs.hpp"
+#include "linux/topology.hpp"
 #endif // __linux__
 
 #include "authentication/cram_md5/authenticatee.hpp"
@@ -135,6 +137,11 @@ constexpr char MESOS_EXECUTOR[] = "mesos-executor.exe";
 constexpr char MESOS_EXECUTOR[] = "mesos-executor";
 #endif // __WINDOWS__
 
+// The name of the executors generated for agent-managed command tasks
+// starts with this prefix, which is how they are recognized, including
+// after recovery (see `Executor::isAgentManaged`).
+constexpr char AGENT_MANAGED_COMMAND_TASK[] = "Command Task ";
+
 namespace mesos {
 namespace internal {
 namespace slave {
@@ -156,6 +163,7 @@ Slave::Slave(const string& id,
     flags(_flags),
     http(this),
     completedFrameworks(MAX_COMPLETED_FRAMEWORKS),
+    stateGeneration(0),
     detector(_detector),
     containerizer(_containerizer),
     files(_files),
@@ -163,6 +171,7 @@ Slave::Slave(const string& id,
     gc(_gc),
     statusUpdateManager(_statusUpdateManager),
     masterPingTimeout(DEFAULT_MASTER_PING_TIMEOUT()),
+    masterBatchesStatusUpdates(false),
     metaDir(paths::getMetaRootDir(flags.work_dir)),
     recoveryErrors(0),
     credential(None()),
@@ -397,6 +406,12 @@ void Slave::initialize()
       << " for --gc_disk_headroom. Must be between 0.0 and 1.0";
   }
 
+  usageCollector.reset(new UsageCollector(
+      containerizer,
+      flags.container_usage_interval,
+      flags.container_usage_history,
+      defer(self(), &Self::containerUsage, lambda::_1, lambda::_2)));
+
   Try<Nothing> initialize =
     resourceEstimator->initialize(defer(self(), &Self::usage));
 
@@ -416,6 +431,18 @@ void Slave::initialize()
   CHECK_SOME(os::mkdir(flags.work_dir))
     << "Failed to create agent work directory '" << flags.work_dir << "'";
 
+  // The sandbox pool is not recovered, since it may hold sandboxes
+  // of users that executors are no longer launched as. It is refilled
+  // as executors are launched.
+  const string sandboxPoolPath = paths::getSandboxPoolPath(flags.work_dir);
+  if (os::exists(sandboxPoolPath)) {
+    Try<Nothing> rmdir = os::rmdir(sandboxPoolPath);
+    if (rmdir.isError()) {
+      LOG(WARNING) << "Failed to remove the sandbox pool '"
+                   << sandboxPoolPath << "': " << rmdir.error();
+    }
+  }
+
   Try<Resources> resources = Containerizer::resources(flags);
   if (resources.isError()) {
     EXIT(EXIT_FAILURE)
@@ -501,6 +528,40 @@ void Slave::initialize()
     attributes = Attributes::parse(flags.attributes.get());
   }
 
+#ifdef __linux__
+  // Report the NUMA topology so that frameworks can ask for agents
+  // where exclusive CPUs can be allocated on a single NUMA node. The
+  // attributes given by the operator take precedence.
+  if (flags.cgroups_exclusive_cpus) {
+    Try<map<int, vector<int>>> nodes = topology::nodes();
+    if (nodes.isError()) {
+      EXIT(EXIT_FAILURE)
+        << "Failed to get the NUMA topology: " << nodes.error();
+    }
+
+    size_t cpus = 0;
+    foreachvalue (const vector<int>& node, nodes.get()) {
+      cpus = std::max(cpus, node.size());
+    }
+
+    hashmap<string, string> values = {
+      {"numa_nodes", stringify(nodes->size())},
+      {"cpus_per_numa_node", stringify(cpus)}
+    };
+
+    foreachpair (const string& name, const string& value, values) {
+      bool found = false;
+      foreach (const Attribute& attribute, attributes) {
+        found = found || attribute.name() == name;
+      }
+
+      if (!found) {
+        attributes.add(Attributes::parse(name, value));
+      }
+    }
+  }
+#endif // __linux__
+
   // Determine our hostname or use the hostname provided.
   string hostname;
 
@@ -535,6 +596,7 @@ void Slave::initialize()
   // Initialize `totalResources` with `info.resources`, checkpointed
   // resources will be applied later during recovery.
   totalResources = resources.get();
+  ++stateGeneration;
 
   LOG(INFO) << "Agent resources: " << info.resources();
 
@@ -627,6 +689,9 @@ void Slave::initialize()
       &StatusUpdateAcknowledgementMessage::task_id,
       &StatusUpdateAcknowledgementMessage::uuid);
 
+  install<StatusUpdateAcknowledgementsMessage>(
+      &Slave::statusUpdateAcknowledgements);
+
   install<RegisterExecutorMessage>(
       &Slave::registerExecutor,
       &RegisterExecutorMessage::framework_id,
@@ -912,19 +977,25 @@ void Slave::detected(const Future<Option<MasterInfo>>& _master)
     EXIT(EXIT_FAILURE) << "Failed to detect a master: " << _master.failure();
   }
 
+  // The leading master is part of the `/state`.
+  ++stateGeneration;
+
   Option<MasterInfo> latest;
 
   if (_master.isDiscarded()) {
     LOG(INFO) << "Re-detecting master";
     latest = None();
     master = None();
+    masterId = None();
   } else if (_master.get().isNone()) {
     LOG(INFO) << "Lost leading master";
     latest = None();
     master = None();
+    masterId = None();
   } else {
     latest = _master.get();
     master = UPID(_master.get().get().pid());
+    masterId = _master.get().get().id();
 
     LOG(INFO) << "New master detected at " << master.get();
 
@@ -1127,6 +1198,13 @@ void Slave::registered(
     masterPingTimeout = DEFAULT_MASTER_PING_TIMEOUT();
   }
 
+  masterBatchesStatusUpdates = connection.batched_status_updates();
+
+  stateDigestMasterId = None();
+  if (connection.state_digests()) {
+    stateDigestMasterId = masterId;
+  }
+
   switch (state) {
     case DISCONNECTED: {
       LOG(INFO) << "Registered with master " << master.get()
@@ -1150,6 +1228,7 @@ void Slave::registered(
       statusUpdateManager->resume(); // Resume status updates.
 
       info.mutable_id()->CopyFrom(slaveId); // Store the slave id.
+      ++stateGeneration;
 
       // Create the slave meta directory.
       paths::createSlaveDirectory(metaDir, slaveId);
@@ -1235,6 +1314,13 @@ void Slave::reregistered(
     masterPingTimeout = DEFAULT_MASTER_PING_TIMEOUT();
   }
 
+  masterBatchesStatusUpdates = connection.batched_status_updates();
+
+  stateDigestMasterId = None();
+  if (connection.state_digests()) {
+    stateDigestMasterId = masterId;
+  }
+
   switch (state) {
     case DISCONNECTED:
       LOG(INFO) << "Re-registered with master " << master.get();
@@ -1388,6 +1474,10 @@ void Slave::doReliableRegistration(Duration maxBackoff)
     message.set_version(MESOS_VERSION);
     message.mutable_slave()->CopyFrom(info);
 
+    foreach (const SlaveInfo::Capability& capability, AGENT_CAPABILITIES()) {
+      message.add_agent_capabilities()->CopyFrom(capability);
+    }
+
     // Include checkpointed resources.
     message.mutable_checkpointed_resources()->CopyFrom(checkpointedResources);
 
@@ -1402,6 +1492,10 @@ void Slave::doReliableRegistration(Duration maxBackoff)
 
     message.mutable_slave()->CopyFrom(info);
 
+    foreach (const SlaveInfo::Capability& capability, AGENT_CAPABILITIES()) {
+      message.add_agent_capabilities()->CopyFrom(capability);
+    }
+
     foreachvalue (Framework* framework, frameworks) {
       message.add_frameworks()->CopyFrom(framework->info);
 
@@ -1494,6 +1588,24 @@ void Slave::doReliableRegistration(Duration maxBackoff)
       }
     }
 
+    // When re-registering with the master that the agent was last
+    // registered with, e.g., after their connection broke, the master
+    // most likely still knows the agent's executors and tasks, so only
+    // their digest is sent. This is done once: the master ignores the
+    // digest if its view of the agent differs, and the next attempt
+    // sends the full state.
+    if (masterId.isSome() && stateDigestMasterId == masterId) {
+      stateDigestMasterId = None();
+
+      message.set_state_digest(protobuf::slave::stateDigest(
+          message.executor_infos(), message.tasks()));
+
+      message.clear_executor_infos();
+      message.clear_tasks();
+      message.clear_frameworks();
+      message.clear_completed_frameworks();
+    }
+
     CHECK_SOME(master);
     send(master.get(), message);
   }
@@ -1634,6 +1746,7 @@ void Slave::run(
         frameworkPid);
 
     frameworks[frameworkId] = framework;
+    ++stateGeneration;
     if (frameworkInfo.checkpoint()) {
       framework->checkpointFramework();
     }
@@ -2048,6 +2161,7 @@ void Slave::_run(
 
         // Queue task if the executor has not yet registered.
         executor->queuedTasks[_task.task_id()] = _task;
+        ++stateGeneration;
       }
 
       if (taskGroup.isSome()) {
@@ -2069,6 +2183,7 @@ void Slave::_run(
         // Queue task until the containerizer is updated with new
         // resource limits (MESOS-998).
         executor->queuedTasks[_task.task_id()] = _task;
+        ++stateGeneration;
       }
 
       if (taskGroup.isSome()) {
@@ -2090,7 +2205,7 @@ void Slave::_run(
         resources += _task.resources();
       }
 
-      containerizer->update(executor->containerId, resources)
+      updateContainer(executor, resources)
         .onAny(defer(self(),
                      &Self::__run,
                      lambda::_1,
@@ -2321,6 +2436,19 @@ void Slave::__run(
 }
 
 
+Future<Nothing> Slave::updateContainer(
+    Executor* executor,
+    const Resources& resources)
+{
+  const ContainerID containerId = executor->containerId;
+
+  return executor->checkpointed
+    .then(defer(self(), [=]() {
+      return containerizer->update(containerId, resources);
+    }));
+}
+
+
 void Slave::runTaskGroup(
     const UPID& from,
     const FrameworkInfo& frameworkInfo,
@@ -2552,6 +2680,16 @@ void Slave::killTask(
           // a later point in time, it won't get this task.
           statusUpdate(update, UPID());
         }
+      } else if (executor->isAgentManaged()) {
+        // There is no executor to kill the task, so we destroy its
+        // container and send TASK_KILLED once it has terminated.
+        ContainerTermination termination;
+        termination.set_state(TASK_KILLED);
+        termination.set_message("Task killed by the agent");
+
+        executor->pendingTermination = termination;
+
+        _shutdownExecutor(framework, executor);
       } else {
         // Send a message to the executor and wait for
         // it to send us a status update.
@@ -2846,6 +2984,7 @@ void Slave::checkpointResources(const vector<Resource>& _checkpointedResources)
     << info.resources();
 
   totalResources = _totalResources.get();
+  ++stateGeneration;
 
   // Store the target checkpoint resources. We commit the checkpoint
   // only after all operations are successful. If any of the operations
@@ -3027,6 +3166,76 @@ void Slave::statusUpdateAcknowledgement(
 }
 
 
+void Slave::statusUpdateAcknowledgements(
+    const UPID& from,
+    const StatusUpdateAcknowledgementsMessage& message)
+{
+  // NOTE: Only the master sends batches of acknowledgements, see
+  // `statusUpdateAcknowledgement()` for why we must reject those
+  // from non-leading masters.
+  if (state != RUNNING) {
+    LOG(WARNING) << "Dropping " << message.acknowledgements_size()
+                 << " status update acknowledgements because the agent"
+                 << " is in " << state << " state";
+    return;
+  }
+
+  if (master != from) {
+    LOG(WARNING) << "Ignoring " << message.acknowledgements_size()
+                 << " status update acknowledgements from " << from
+                 << " because it is not the expected master: "
+                 << (master.isSome() ? stringify(master.get()) : "None");
+    return;
+  }
+
+  StatusUpdateAcknowledgementsMessage acknowledgements;
+
+  foreach (const StatusUpdateAcknowledgementMessage& acknowledgement,
+           message.acknowledgements()) {
+    if (UUID::fromBytes(acknowledgement.uuid()).isError()) {
+      LOG(WARNING) << "Ignoring status update acknowledgement for task "
+                   << acknowledgement.task_id() << " of framework "
+                   << acknowledgement.framework_id() << " with invalid UUID";
+      continue;
+    }
+
+    acknowledgements.add_acknowledgements()->CopyFrom(acknowledgement);
+  }
+
+  statusUpdateManager->acknowledgements(acknowledgements)
+    .onAny(defer(self(),
+                 &Slave::_statusUpdateAcknowledgements,
+                 lambda::_1,
+                 acknowledgements));
+}
+
+
+void Slave::_statusUpdateAcknowledgements(
+    const Future<vector<Future<bool>>>& future,
+    const StatusUpdateAcknowledgementsMessage& message)
+{
+  if (!future.isReady()) {
+    LOG(ERROR) << "Failed to handle " << message.acknowledgements_size()
+               << " status update acknowledgements: "
+               << (future.isFailed() ? future.failure() : "future discarded");
+    return;
+  }
+
+  CHECK_EQ(message.acknowledgements_size(), (int) future->size());
+
+  for (int i = 0; i < message.acknowledgements_size(); i++) {
+    const StatusUpdateAcknowledgementMessage& acknowledgement =
+      message.acknowledgements(i);
+
+    _statusUpdateAcknowledgement(
+        future->at(i),
+        acknowledgement.task_id(),
+        acknowledgement.framework_id(),
+        UUID::fromBytes(acknowledgement.uuid()).get());
+  }
+}
+
+
 void Slave::_statusUpdateAcknowledgement(
     const Future<bool>& future,
     const TaskID& taskId,
@@ -3155,6 +3364,10 @@ void Slave::subscribe(
 
       executor->state = Executor::RUNNING;
 
+      if (executor->trace.registered.isNone()) {
+        executor->trace.registered = Clock::now();
+      }
+
       // Save the connection for the executor.
       executor->http = http;
       executor->pid = None();
@@ -3251,7 +3464,7 @@ void Slave::subscribe(
         }
       }
 
-      containerizer->update(executor->containerId, resources)
+      updateContainer(executor, resources)
         .onAny(defer(self(),
                      &Self::__run,
                      lambda::_1,
@@ -3392,6 +3605,8 @@ void Slave::registerExecutor(
     case Executor::REGISTERING: {
       executor->state = Executor::RUNNING;
 
+      executor->trace.registered = Clock::now();
+
       // Save the pid for the executor.
       executor->pid = from;
       link(from);
@@ -3473,7 +3688,7 @@ void Slave::registerExecutor(
         }
       }
 
-      containerizer->update(executor->containerId, resources)
+      updateContainer(executor, resources)
         .onAny(defer(self(),
                      &Self::__run,
                      lambda::_1,
@@ -4125,8 +4340,42 @@ void Slave::___statusUpdate(
       return;
     }
 
-    executor->send(message);
+    if (!executor->batchedUpdates) {
+      executor->send(message);
+      return;
+    }
+
+    if (executor->pendingAcknowledgements.acknowledgements().empty()) {
+      dispatch(self(),
+               &Slave::sendAcknowledgements,
+               framework->id(),
+               executor->id);
+    }
+
+    executor->pendingAcknowledgements.add_acknowledgements()->CopyFrom(
+        message);
+  }
+}
+
+
+void Slave::sendAcknowledgements(
+    const FrameworkID& frameworkId,
+    const ExecutorID& executorId)
+{
+  Executor* executor = getExecutor(frameworkId, executorId);
+  if (executor == nullptr) {
+    LOG(WARNING) << "Ignoring sending acknowledgements to unknown executor '"
+                 << executorId << "' of framework " << frameworkId;
+    return;
   }
+
+  StatusUpdateAcknowledgementsMessage message;
+  message.Swap(&executor->pendingAcknowledgements);
+
+  LOG(INFO) << "Sending " << message.acknowledgements_size()
+            << " acknowledgements to executor " << *executor;
+
+  executor->send(message);
 }
 
 
@@ -4204,6 +4453,18 @@ void Slave::forward(StatusUpdate update)
   // re-registration can generate updates when framework/executor/task
   // are unknown.
 
+  if (flags.batch_status_updates) {
+    // Queue the update behind the events that are already waiting to
+    // be processed, so that the updates they forward are sent along
+    // with it.
+    pendingStatusUpdates.push_back(update);
+    if (pendingStatusUpdates.size() == 1) {
+      dispatch(self(), &Self::_forward);
+    }
+
+    return;
+  }
+
   // Forward the update to master.
   StatusUpdateMessage message;
   message.mutable_update()->MergeFrom(update);
@@ -4213,6 +4474,45 @@ void Slave::forward(StatusUpdate update)
 }
 
 
+void Slave::_forward()
+{
+  vector<StatusUpdate> updates;
+  std::swap(updates, pendingStatusUpdates);
+
+  // NOTE: The status update manager retries the updates that are
+  // dropped here until they are acknowledged.
+  if (state != RUNNING) {
+    LOG(WARNING) << "Dropping " << updates.size() << " status updates"
+                 << " because the agent is in " << state << " state";
+    return;
+  }
+
+  CHECK_SOME(master);
+
+  if (updates.size() == 1 || !masterBatchesStatusUpdates) {
+    foreach (const StatusUpdate& update, updates) {
+      StatusUpdateMessage message;
+      message.mutable_update()->CopyFrom(update);
+      message.set_pid(self()); // The ACK will be first received by the slave.
+
+      send(master.get(), message);
+    }
+
+    return;
+  }
+
+  StatusUpdatesMessage message;
+  message.mutable_updates()->Reserve(updates.size());
+  foreach (StatusUpdate& update, updates) {
+    message.add_updates()->Swap(&update);
+  }
+
+  message.set_pid(self()); // The ACKs will be first received by the slave.
+
+  send(master.get(), message);
+}
+
+
 void Slave::executorMessage(
     const SlaveID& slaveId,
     const FrameworkID& frameworkId,
@@ -4336,6 +4636,70 @@ void Slave::exited(const UPID& pid)
 }
 
 
+void Slave::subscribe(const HttpConnection& http, const UUID& streamId)
+{
+  LOG(INFO) << "Added subscriber: " << streamId << " to the "
+            << "list of active subscribers";
+
+  http.closed()
+    .onAny(defer(self(),
+           [this, streamId](const Future<Nothing>&) {
+             unsubscribe(streamId);
+           }));
+
+  subscribers.subscribed.put(
+      streamId,
+      Owned<Subscribers::Subscriber>(new Subscribers::Subscriber{http}));
+}
+
+
+void Slave::unsubscribe(const UUID& streamId)
+{
+  if (!subscribers.subscribed.contains(streamId)) {
+    LOG(WARNING) << "Unknown subscriber " << streamId << " disconnected";
+    return;
+  }
+
+  subscribers.subscribed.erase(streamId);
+}
+
+
+void Slave::Subscribers::send(const mesos::agent::Event& event)
+{
+  if (subscribed.empty()) {
+    return;
+  }
+
+  VLOG(1) << "Notifying all active subscribers about " << event.type() << " "
+          << "event";
+
+  foreachvalue (const Owned<Subscriber>& subscriber, subscribed) {
+    subscriber->http.send<mesos::agent::Event, v1::agent::Event>(event);
+  }
+}
+
+
+void Slave::containerUsage(
+    const ContainerID& containerId,
+    const ResourceStatistics& statistics)
+{
+  if (subscribers.subscribed.empty()) {
+    return;
+  }
+
+  // Only the containers of the executors are reported.
+  foreachvalue (Framework* framework, frameworks) {
+    foreachvalue (Executor* executor, framework->executors) {
+      if (executor->containerId == containerId) {
+        subscribers.send(protobuf::slave::event::createContainerUsage(
+            framework->id(), executor->id, containerId, statistics));
+        return;
+      }
+    }
+  }
+}
+
+
 Framework* Slave::getFramework(const FrameworkID& frameworkId)
 {
   if (frameworks.count(frameworkId) > 0) {
@@ -4408,6 +4772,18 @@ ExecutorInfo Slave::getExecutorInfo(
     executor.mutable_command()->set_user("root");
   }
 
+  // With `--agent_managed_command_tasks` the container runs the task's
+  // command itself and the agent takes the place of the command
+  // executor, which is only possible if the task does not need any of
+  // the features that the command executor implements.
+  bool agentManaged = flags.agent_managed_command_tasks &&
+                      !hasRootfs &&
+                      !task.has_health_check() &&
+                      !task.has_check() &&
+                      !task.has_kill_policy() &&
+                      (!task.has_container() ||
+                       task.container().type() == ContainerInfo::MESOS);
+
   // Prepare an executor name which includes information on the
   // command being launched.
   string name = "(Task: " + task.task_id().value() + ") ";
@@ -4439,7 +4815,10 @@ ExecutorInfo Slave::getExecutorInfo(
     }
   }
 
-  executor.set_name("Command Executor " + name);
+  executor.set_name(
+      (agentManaged ? AGENT_MANAGED_COMMAND_TASK : "Command Executor ") +
+      name);
+
   executor.set_source(task.task_id().value());
 
   // Copy the [uris, environment, container, user] fields from the
@@ -4467,6 +4846,14 @@ ExecutorInfo Slave::getExecutorInfo(
     executor.mutable_discovery()->MergeFrom(task.discovery());
   }
 
+  // There is neither an executor command to set up nor an allowance
+  // for the executor's resources if the container runs the task's
+  // command itself.
+  if (agentManaged) {
+    executor.mutable_command()->CopyFrom(task.command());
+    return executor;
+  }
+
   // Adjust the executor shutdown grace period if the kill policy is
   // set. We add a small buffer of time to avoid destroying the
   // container before `TASK_KILLED` is sent by the executor.
@@ -4643,6 +5030,15 @@ void Slave::executorLaunched(
       break;
     case Executor::REGISTERING:
     case Executor::RUNNING:
+      executor->trace.launched = Clock::now();
+
+      subscribers.send(protobuf::slave::event::createContainerAdded(
+          frameworkId, executorId, containerId));
+
+      if (executor->isAgentManaged() &&
+          executor->state == Executor::REGISTERING) {
+        runAgentManagedTask(framework, executor);
+      }
       break;
     case Executor::TERMINATED:
     default:
@@ -4654,6 +5050,55 @@ void Slave::executorLaunched(
 }
 
 
+void Slave::runAgentManagedTask(Framework* framework, Executor* executor)
+{
+  CHECK_NOTNULL(framework);
+  CHECK_NOTNULL(executor);
+  CHECK(executor->isAgentManaged());
+  CHECK_EQ(Executor::REGISTERING, executor->state);
+
+  // The container runs the task's command, so the "executor" is
+  // running as soon as the container has been launched.
+  executor->state = Executor::RUNNING;
+
+  // This is the case where the task was killed while the container
+  // was being launched. The TASK_KILLED update has already been sent
+  // by 'killTask'.
+  if (executor->queuedTasks.empty()) {
+    LOG(WARNING) << "Killing executor " << *executor
+                 << " because its task has been killed";
+
+    _shutdownExecutor(framework, executor);
+    return;
+  }
+
+  // NOTE: We need to remove the tasks from 'queuedTasks' before
+  // sending the updates, since non-terminal updates are rejected for
+  // queued tasks (see 'Executor::updateTaskState').
+  const list<TaskInfo> tasks = executor->queuedTasks.values();
+  executor->queuedTasks.clear();
+
+  foreach (const TaskInfo& task, tasks) {
+    executor->addTask(task);
+
+    LOG(INFO) << "Running task '" << task.task_id()
+              << "' in the container of executor " << *executor;
+
+    statusUpdate(protobuf::createStatusUpdate(
+        framework->id(),
+        info.id(),
+        task.task_id(),
+        TASK_RUNNING,
+        TaskStatus::SOURCE_SLAVE,
+        UUID::random(),
+        "Command launched by the agent",
+        None(),
+        executor->id),
+        UPID());
+  }
+}
+
+
 // Called by the isolator when an executor process terminates.
 void Slave::executorTerminated(
     const FrameworkID& frameworkId,
@@ -4721,6 +5166,9 @@ void Slave::executorTerminated(
 
       executor->state = Executor::TERMINATED;
 
+      subscribers.send(protobuf::slave::event::createContainerRemoved(
+          frameworkId, executorId, executor->containerId));
+
       // Transition all live tasks to TASK_GONE/TASK_FAILED.
       // If the containerizer killed the executor (e.g., due to OOM event)
       // or if this is a command executor, we send TASK_FAILED status updates
@@ -4910,6 +5358,7 @@ void Slave::removeFramework(Framework* framework)
   }
 
   frameworks.erase(framework->id());
+  ++stateGeneration;
 
   // Pass ownership of the framework pointer.
   completedFrameworks.set(framework->id(), Owned<Framework>(framework));
@@ -5014,6 +5463,13 @@ void Slave::_shutdownExecutor(Framework* framework, Executor* executor)
 
   executor->state = Executor::TERMINATING;
 
+  // There is no executor to ask to shut down gracefully if the
+  // container runs the task's command itself.
+  if (executor->isAgentManaged()) {
+    containerizer->destroy(executor->containerId);
+    return;
+  }
+
   // If the executor hasn't yet registered, this message
   // will be dropped to the floor!
   executor->send(ShutdownExecutorMessage());
@@ -5279,6 +5735,7 @@ Future<Nothing> Slave::recover(const Try<state::State>& state)
     }
 
     totalResources = _totalResources.get();
+    ++stateGeneration;
   }
 
   if (slaveState.isSome() && slaveState.get().info.isSome()) {
@@ -5288,6 +5745,7 @@ Future<Nothing> Slave::recover(const Try<state::State>& state)
     // as a hack to compare the info created from options/flags with
     // the recovered info.
     info.mutable_id()->CopyFrom(slaveState.get().id);
+    ++stateGeneration;
     if (flags.recover == "reconnect" &&
         !(info == slaveState.get().info.get())) {
       return Failure(strings::join(
@@ -5351,6 +5809,21 @@ Future<Nothing> Slave::_recover()
                      executor->id,
                      lambda::_1));
 
+      // There is no executor to reconnect with for agent-managed
+      // command tasks; the agent takes their container back over.
+      if (executor->isAgentManaged()) {
+        if (flags.recover == "reconnect") {
+          LOG(INFO) << "Recovered agent-managed command task of executor "
+                    << *executor;
+
+          executor->state = Executor::RUNNING;
+        } else {
+          _shutdownExecutor(framework, executor);
+        }
+
+        continue;
+      }
+
       if (flags.recover == "reconnect") {
         // We send a reconnect message for PID based executors
         // as we can initiate communication with them. Recovered
@@ -5552,6 +6025,7 @@ void Slave::recoverFramework(const FrameworkState& state)
       this, flags, frameworkInfo, pid);
 
   frameworks[framework->id()] = framework;
+  ++stateGeneration;
 
   if (recheckpoint) {
     framework->checkpointFramework();
@@ -5591,6 +6065,50 @@ Future<Nothing> Slave::garbageCollect(const string& path)
 }
 
 
+// Returns whether an estimate of the oversubscribed resources differs
+// from the previous one by at least `threshold` (relative to the
+// previous estimate) for any resource, or whether resources appeared
+// or disappeared.
+static bool changedSignificantly(
+    const Resources& previous,
+    const Resources& current,
+    double threshold)
+{
+  if (previous == current) {
+    return false;
+  }
+
+  if (threshold <= 0.0 || previous.names() != current.names()) {
+    return true;
+  }
+
+  foreach (const string& name, current.names()) {
+    const Option<Value::Scalar> before = previous.get<Value::Scalar>(name);
+    const Option<Value::Scalar> after = current.get<Value::Scalar>(name);
+
+    // Any change of a non-scalar resource is significant.
+    if (before.isNone() || after.isNone()) {
+      if (previous.get(name) != current.get(name)) {
+        return true;
+      }
+
+      continue;
+    }
+
+    if (before.get() == after.get()) {
+      continue;
+    }
+
+    if (std::abs(after->value() - before->value()) >=
+        threshold * before->value()) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
 void Slave::forwardOversubscribed()
 {
   VLOG(1) << "Querying resource estimator for oversubscribable resources";
@@ -5632,10 +6150,18 @@ void Slave::_forwardOversubscribed(const Future<Resources>& oversubscribable)
     // Add oversubscribable resources to the total.
     oversubscribed += oversubscribable.get();
 
-    // Only forward the estimate if it's different from the previous
-    // estimate. We also send this whenever we get (re-)registered
-    // (i.e. whenever we transition into the RUNNING state).
-    if (state == RUNNING && oversubscribedResources != oversubscribed) {
+    // Only forward the estimate if it's different enough from the
+    // previously forwarded estimate, see
+    // `--oversubscribed_resources_threshold`. We also send this
+    // whenever we get (re-)registered (i.e. whenever we transition
+    // into the RUNNING state).
+    if (state != RUNNING) {
+      oversubscribedResources = oversubscribed;
+    } else if (oversubscribedResources.isNone() ||
+               changedSignificantly(
+                   oversubscribedResources.get(),
+                   oversubscribed,
+                   flags.oversubscribed_resources_threshold)) {
       LOG(INFO) << "Forwarding total oversubscribed resources "
                 << oversubscribed;
 
@@ -5645,10 +6171,11 @@ void Slave::_forwardOversubscribed(const Future<Resources>& oversubscribable)
 
       CHECK_SOME(master);
       send(master.get(), message);
-    }
 
-    // Update the estimate.
-    oversubscribedResources = oversubscribed;
+      // Update the estimate. Estimates that are not forwarded are not
+      // kept, so that small changes add up until they are significant.
+      oversubscribedResources = oversubscribed;
+    }
   }
 
   delay(flags.oversubscribed_resources_interval,
@@ -5798,6 +6325,92 @@ void Slave::_qosCorrections(const Future<list<QoSCorrection>>& future)
                      << executor->state;
           break;
       }
+    } else if (correction.type() == QoSCorrection::THROTTLE) {
+      const QoSCorrection::Throttle& throttle = correction.throttle();
+
+      if (!throttle.has_framework_id() || !throttle.has_executor_id()) {
+        LOG(WARNING) << "Ignoring QoS correction THROTTLE: "
+                     << "framework id or executor id not specified";
+        continue;
+      }
+
+      const FrameworkID& frameworkId = throttle.framework_id();
+      const ExecutorID& executorId = throttle.executor_id();
+
+      if (throttle.cpus_fraction() <= 0 || throttle.cpus_fraction() > 1) {
+        LOG(WARNING) << "Ignoring QoS correction THROTTLE on executor '"
+                     << executorId << "' of framework " << frameworkId
+                     << ": invalid cpus fraction "
+                     << throttle.cpus_fraction();
+        continue;
+      }
+
+      if (throttle.mem_fraction() <= 0 || throttle.mem_fraction() > 1) {
+        LOG(WARNING) << "Ignoring QoS correction THROTTLE on executor '"
+                     << executorId << "' of framework " << frameworkId
+                     << ": invalid mem fraction "
+                     << throttle.mem_fraction();
+        continue;
+      }
+
+      Framework* framework = getFramework(frameworkId);
+      if (framework == nullptr ||
+          framework->state == Framework::TERMINATING) {
+        LOG(WARNING) << "Ignoring QoS correction THROTTLE on framework "
+                     << frameworkId << ": framework cannot be found "
+                     << "or is terminating";
+        continue;
+      }
+
+      Executor* executor = framework->getExecutor(executorId);
+      if (executor == nullptr ||
+          (executor->state != Executor::REGISTERING &&
+           executor->state != Executor::RUNNING)) {
+        LOG(WARNING) << "Ignoring QoS correction THROTTLE on executor '"
+                     << executorId << "' of framework " << frameworkId
+                     << ": executor cannot be found or is not running";
+        continue;
+      }
+
+      if (throttle.has_container_id() &&
+          throttle.container_id() != executor->containerId) {
+        LOG(WARNING) << "Ignoring QoS correction THROTTLE on container '"
+                     << throttle.container_id() << "' for executor "
+                     << *executor << ": container cannot be found";
+        continue;
+      }
+
+      // Scale the cpus and the memory of the executor, the other
+      // resources (and the resources known to the master) are left
+      // unchanged.
+      Resources resources;
+      foreach (Resource resource, executor->resources) {
+        if (resource.type() == Value::SCALAR) {
+          if (resource.name() == "cpus") {
+            resource.mutable_scalar()->set_value(
+                resource.scalar().value() * throttle.cpus_fraction());
+          } else if (resource.name() == "mem") {
+            resource.mutable_scalar()->set_value(
+                resource.scalar().value() * throttle.mem_fraction());
+          }
+        }
+
+        resources += resource;
+      }
+
+      LOG(INFO) << "Throttling container '" << executor->containerId
+                << "' for executor " << *executor << " to "
+                << throttle.cpus_fraction() << " of its cpus and "
+                << throttle.mem_fraction() << " of its memory"
+                << " as QoS correction";
+
+      const ContainerID containerId = executor->containerId;
+
+      containerizer->update(containerId, resources)
+        .onFailed([containerId](const string& failure) {
+          LOG(WARNING) << "Failed to throttle container '" << containerId
+                       << "' as QoS correction: " << failure;
+        });
     } else {
       LOG(WARNING) << "QoS correction type " << correction.type()
                    << " is not supported";
@@ -5840,7 +6453,7 @@ Future<ResourceUsage> Slave::usage()
         }
       }
 
-      futures.push_back(containerizer->usage(executor->containerId));
+      futures.push_back(usageCollector->usage(executor->containerId));
     }
   }
 
@@ -6060,6 +6673,61 @@ Future<bool> Slave::authorizeSandboxAccess(
 }
 
 
+Option<string> Slave::takePooledSandbox(const Option<string>& user)
+{
+  if (flags.sandbox_pool_size == 0) {
+    return None();
+  }
+
+  const string key = user.getOrElse("");
+
+  vector<string>& pool = sandboxPool[key];
+
+  Option<string> sandbox = None();
+  if (!pool.empty()) {
+    sandbox = pool.back();
+    pool.pop_back();
+  }
+
+  // The sandboxes are created (and chowned) off the launch path, so
+  // that the next executors of the user find them ready.
+  size_t& pending = pendingPooledSandboxes[key];
+
+  while (pool.size() + pending < flags.sandbox_pool_size) {
+    pending++;
+
+    async(&paths::createPooledSandbox, flags.work_dir, user)
+      .onAny(defer(self(), &Slave::_refillSandboxPool, user, lambda::_1));
+  }
+
+  return sandbox;
+}
+
+
+void Slave::_refillSandboxPool(
+    const Option<string>& user,
+    const Future<Try<string>>& sandbox)
+{
+  const string key = user.getOrElse("");
+
+  CHECK_GT(pendingPooledSandboxes[key], 0u);
+  pendingPooledSandboxes[key]--;
+
+  if (!sandbox.isReady()) {
+    LOG(WARNING) << "Failed to create pooled sandbox: "
+                 << (sandbox.isFailed() ? sandbox.failure() : "discarded");
+    return;
+  }
+
+  if (sandbox->isError()) {
+    LOG(WARNING) << sandbox->error();
+    return;
+  }
+
+  sandboxPool[key].push_back(sandbox->get());
+}
+
+
 void Slave::sendExecutorTerminatedStatusUpdate(
     const TaskID& taskId,
     const Future<Option<ContainerTermination>>& termination,
@@ -6069,9 +6737,17 @@ void Slave::sendExecutorTerminatedStatusUpdate(
   CHECK_NOTNULL(executor);
 
   mesos::TaskState state;
-  TaskStatus::Reason reason;
+  Option<TaskStatus::Reason> reason;
   string message;
 
+  // The exit status of an agent-managed command task is the exit
+  // status of the task's command (see `Executor::isAgentManaged`).
+  Option<int> status;
+  if (executor->isAgentManaged() && termination.isReady() &&
+      termination->isSome() && termination->get().has_status()) {
+    status = termination->get().status();
+  }
+
   // Determine the task state for the status update.
   if (termination.isReady() &&
       termination->isSome() && termination->get().has_state()) {
@@ -6079,6 +6755,8 @@ void Slave::sendExecutorTerminatedStatusUpdate(
   } else if (executor->pendingTermination.isSome() &&
              executor->pendingTermination->has_state()) {
     state = executor->pendingTermination->state();
+  } else if (status.isSome() && WSUCCEEDED(status.get())) {
+    state = TASK_FINISHED;
   } else {
     state = TASK_FAILED;
   }
@@ -6091,7 +6769,7 @@ void Slave::sendExecutorTerminatedStatusUpdate(
   } else if (executor->pendingTermination.isSome() &&
              executor->pendingTermination->reasons().size() > 0) {
     reason = executor->pendingTermination->reasons(0);
-  } else {
+  } else if (!executor->isAgentManaged()) {
     reason = TaskStatus::REASON_EXECUTOR_TERMINATED;
   }
 
@@ -6113,6 +6791,10 @@ void Slave::sendExecutorTerminatedStatusUpdate(
     messages.push_back(termination->get().message());
   }
 
+  if (status.isSome()) {
+    messages.push_back("Command " + WSTRINGIFY(status.get()));
+  }
+
   if (messages.empty()) {
     message = "Executor terminated";
   } else {
@@ -6275,6 +6957,8 @@ Executor* Framework::launchExecutor(
     const ExecutorInfo& executorInfo,
     const Option<TaskInfo>& taskInfo)
 {
+  ++slave->stateGeneration;
+
   // Generate an ID for the executor's container.
   // TODO(idownes) This should be done by the containerizer but we
   // need the ContainerID to create the executor's directory. Fix
@@ -6308,7 +6992,8 @@ Executor* Framework::launchExecutor(
       id(),
       executorInfo.executor_id(),
       containerId,
-      user);
+      user,
+      slave->takePooledSandbox(user));
 
   Executor* executor = new Executor(
       slave,
@@ -6422,6 +7107,10 @@ Executor* Framework::launchExecutor(
         info.checkpoint());
   }
 
+  executor->trace.launching = Clock::now();
+
+  launch = slave->metrics.executor_launch.time(launch);
+
   launch.onAny(defer(slave,
                      &Slave::executorLaunched,
                      id(),
@@ -6429,13 +7118,17 @@ Executor* Framework::launchExecutor(
                      containerId,
                      lambda::_1));
 
-  // Make sure the executor registers within the given timeout.
-  delay(slave->flags.executor_registration_timeout,
-        slave,
-        &Slave::registerExecutorTimeout,
-        id(),
-        executor->id,
-        containerId);
+  // Make sure the executor registers within the given timeout. There
+  // is no executor to register for agent-managed command tasks; they
+  // start running once the container is launched.
+  if (!executor->isAgentManaged()) {
+    delay(slave->flags.executor_registration_timeout,
+          slave,
+          &Slave::registerExecutorTimeout,
+          id(),
+          executor->id,
+          containerId);
+  }
 
   return executor;
 }
@@ -6443,6 +7136,8 @@ Executor* Framework::launchExecutor(
 
 void Framework::destroyExecutor(const ExecutorID& executorId)
 {
+  ++slave->stateGeneration;
+
   if (executors.contains(executorId)) {
     Executor* executor = executors[executorId];
     executors.erase(executorId);
@@ -6503,6 +7198,8 @@ void Framework::recoverExecutor(const ExecutorState& state)
 
   CHECK_NOTNULL(slave);
 
+  ++slave->stateGeneration;
+
   if (state.runs.empty() || state.latest.isNone() || state.info.isNone()) {
     LOG(WARNING) << "Skipping recovery of executor '" << state.id
                  << "' of framework " << id()
@@ -6666,10 +7363,14 @@ Executor::Executor(
     directory(_directory),
     user(_user),
     checkpoint(_checkpoint),
+    checkpointed(Nothing()),
     http(None()),
     pid(None()),
+    batchedUpdates(false),
     resources(_info.resources()),
-    completedTasks(MAX_COMPLETED_TASKS_PER_EXECUTOR)
+    completedTasks(MAX_COMPLETED_TASKS_PER_EXECUTOR),
+    commandExecutor(false),
+    agentManaged(false)
 {
   CHECK_NOTNULL(slave);
 
@@ -6680,6 +7381,11 @@ Executor::Executor(
     commandExecutor =
       strings::contains(info.command().value(), executorPath.get());
   }
+
+  // An agent-managed command task takes the place of a command
+  // executor, e.g., it is not known to the master either.
+  agentManaged = strings::startsWith(info.name(), AGENT_MANAGED_COMMAND_TASK);
+  commandExecutor = commandExecutor || agentManaged;
 }
 
 
@@ -6701,6 +7407,8 @@ Executor::~Executor()
 
 Task* Executor::addTask(const TaskInfo& task)
 {
+  ++slave->stateGeneration;
+
   // The master should enforce unique task IDs, but just in case
   // maybe we shouldn't make this a fatal error.
   CHECK(!launchedTasks.contains(task.task_id()))
@@ -6712,12 +7420,16 @@ Task* Executor::addTask(const TaskInfo& task)
 
   resources += task.resources();
 
+  slave->subscribers.send(protobuf::slave::event::createTaskAdded(*t));
+
   return t;
 }
 
 
 void Executor::completeTask(const TaskID& taskId)
 {
+  ++slave->stateGeneration;
+
   VLOG(1) << "Completing task " << taskId;
 
   CHECK(terminatedTasks.contains(taskId))
@@ -6763,12 +7475,21 @@ void Executor::checkpointTask(const TaskInfo& task)
       t.task_id());
 
   VLOG(1) << "Checkpointing TaskInfo to '" << path << "'";
-  CHECK_SOME(state::checkpoint(path, t));
+
+  // NOTE: The checkpoints are performed in order, hence the tasks
+  // checkpointed before this one are on disk once it is.
+  checkpointed = slave->checkpointer.checkpoint(path, t)
+    .onFailed([path](const string& failure) {
+      LOG(FATAL) << "Failed to checkpoint TaskInfo to '" << path
+                 << "': " << failure;
+    });
 }
 
 
 void Executor::recoverTask(const TaskState& state)
 {
+  ++slave->stateGeneration;
+
   if (state.info.isNone()) {
     LOG(WARNING) << "Skipping recovery of task " << state.id
                  << " because its info cannot be recovered";
@@ -6818,6 +7539,8 @@ void Executor::recoverTask(const TaskState& state)
 
 Try<Nothing> Executor::updateTaskState(const TaskStatus& status)
 {
+  ++slave->stateGeneration;
+
   bool terminal = protobuf::isTerminalState(status.state());
 
   const TaskID& taskId = status.task_id();
@@ -6892,6 +7615,13 @@ Try<Nothing> Executor::updateTaskState(const TaskStatus& status)
   task->add_statuses()->CopyFrom(status);
   task->set_state(status.state());
 
+  if (status.state() == TASK_RUNNING && trace.running.isNone()) {
+    trace.running = Clock::now();
+  }
+
+  slave->subscribers.send(
+      protobuf::slave::event::createTaskUpdated(*task, status));
+
   // TODO(bmahler): This only increments the state when the update
   // can be handled. Should we always increment the state?
   if (terminal) {
@@ -6927,6 +7657,12 @@ bool Executor::isCommandExecutor() const
 }
 
 
+bool Executor::isAgentManaged() const
+{
+  return agentManaged;
+}
+
+
 void Executor::closeHttpConnection()
 {
   CHECK_SOME(http);
@@ -80,6 +80,7 @@
 #include "slave/metrics.hpp"
 #include "slave/paths.hpp"
 #include "slave/state.hpp"
+#include "slave/usage_collector.hpp"
 
 // `REGISTERING` is used as an enum value, but it's actually defined as a
 // constant in the Windows SDK.
@@ -100,7 +101,41 @@ namespace slave {
 class StatusUpdateManager;
 struct Executor;
 struct Framework;
-struct HttpConnection;
+
+// Represents the streaming HTTP connection to an executor or to a
+// subscriber of the agent operator API.
+struct HttpConnection
+{
+  HttpConnection(const process::http::Pipe::Writer& _writer,
+                 ContentType _contentType)
+    : writer(_writer),
+      contentType(_contentType) {}
+
+  // We need to evolve the internal 'message' into a versioned event,
+  // e.g., `v1::executor::Event` or `v1::agent::Event`.
+  template <typename Message, typename Event = v1::executor::Event>
+  bool send(const Message& message)
+  {
+    ::recordio::Encoder<Event> encoder(lambda::bind(
+        serialize, contentType, lambda::_1));
+
+    return writer.write(encoder.encode(evolve(message)));
+  }
+
+  bool close()
+  {
+    return writer.close();
+  }
+
+  process::Future<Nothing> closed() const
+  {
+    return writer.readerClosed();
+  }
+
+  process::http::Pipe::Writer writer;
+  ContentType contentType;
+};
+
 
 class Slave : public ProtobufProcess<Slave>
 {
@@ -264,11 +299,23 @@ public:
       const StatusUpdate& update,
       const Option<process::UPID>& pid);
 
+  // Sends the pending acknowledgements of an executor that sends
+  // batches of status updates. The acknowledgements that become
+  // ready in the meantime (e.g., for the other status updates of
+  // the same batch) are coalesced into the same event.
+  void sendAcknowledgements(
+      const FrameworkID& frameworkId,
+      const ExecutorID& executorId);
+
   // This is called by status update manager to forward a status
   // update to the master. Note that the latest state of the task is
   // added to the update before forwarding.
   void forward(StatusUpdate update);
 
+  // Sends the status updates queued by `forward()` to the master, if
+  // status updates are batched (see `--batch_status_updates`).
+  void _forward();
+
   void statusUpdateAcknowledgement(
       const process::UPID& from,
       const SlaveID& slaveId,
@@ -282,12 +329,28 @@ public:
       const FrameworkID& frameworkId,
       const UUID& uuid);
 
+  // Handles a batch of acknowledgements from the master, which is
+  // equivalent to handling each of them through
+  // `statusUpdateAcknowledgement()`, but hands them to the status
+  // update manager at once.
+  void statusUpdateAcknowledgements(
+      const process::UPID& from,
+      const StatusUpdateAcknowledgementsMessage& message);
+
+  void _statusUpdateAcknowledgements(
+      const process::Future<std::vector<process::Future<bool>>>& future,
+      const StatusUpdateAcknowledgementsMessage& message);
+
   void executorLaunched(
       const FrameworkID& frameworkId,
       const ExecutorID& executorId,
       const ContainerID& containerId,
       const process::Future<bool>& future);
 
+  // Transitions the task of an agent-managed command task to
+  // TASK_RUNNING once its container has been launched.
+  void runAgentManagedTask(Framework* framework, Executor* executor);
+
   // Made 'virtual' for Slave mocking.
   virtual void executorTerminated(
       const FrameworkID& frameworkId,
@@ -337,6 +400,17 @@ public:
   virtual void finalize();
   virtual void exited(const process::UPID& pid);
 
+  // Adds a subscriber of the agent operator API, which is removed
+  // once its connection is closed.
+  void subscribe(const HttpConnection& http, const UUID& streamId);
+  void unsubscribe(const UUID& streamId);
+
+  // Invoked by the `UsageCollector` whenever it has sampled the
+  // resource usage of a container.
+  void containerUsage(
+      const ContainerID& containerId,
+      const ResourceStatistics& statistics);
+
   // This is called when the resource limits of the container have
   // been updated for the given tasks and task groups. If the update is
   // successful, we flush the given tasks to the executor by sending
@@ -349,6 +423,13 @@ public:
       const std::list<TaskInfo>& tasks,
       const std::list<TaskGroupInfo>& taskGroups);
 
+  // Updates the resource limits of the container of the executor
+  // once the tasks queued on the executor have been checkpointed, so
+  // that we never launch a task that is not on disk.
+  process::Future<Nothing> updateContainer(
+      Executor* executor,
+      const Resources& resources);
+
   void fileAttached(const process::Future<Nothing>& result,
                     const std::string& path);
 
@@ -469,6 +550,15 @@ private:
       const FrameworkID& frameworkId,
       const ExecutorID& executorId);
 
+  // Returns a pre-created sandbox of the user from the sandbox pool,
+  // if there is one, and refills the pool of the user in the
+  // background (see `--sandbox_pool_size`).
+  Option<std::string> takePooledSandbox(const Option<std::string>& user);
+
+  void _refillSandboxPool(
+      const Option<std::string>& user,
+      const process::Future<Try<std::string>>& sandbox);
+
   // Inner class used to namespace HTTP route handlers (see
   // slave/http.cpp for implementations).
   class Http
@@ -548,9 +638,41 @@ private:
         const process::http::Request& request,
         const Option<std::string>& principal) const;
 
-    // Helper function to collect containers status and resource statistics.
+    // Returns the entity tag of the current `/state`, which changes
+    // whenever `stateGeneration` does.
+    std::string stateETag() const;
+
+    // Returns true if the request is conditional on the current
+    // `/state` not matching its `If-None-Match` header, i.e., the
+    // client already has the current state.
+    bool stateNotModified(const process::http::Request& request) const;
+
+    // Returns the `cachedState` as a response to the request.
+    process::http::Response cachedStateResponse(
+        const process::http::Request& request) const;
+
+    // Helper function to collect containers status and resource statistics,
+    // including the retained history of the latter if 'history' is set,
+    // and the trace of the launch of the executor if 'trace' is set.
     process::Future<JSON::Array> __containers(
-        Option<process::Owned<ObjectApprover>> approver) const;
+        Option<process::Owned<ObjectApprover>> approver,
+        bool history = false,
+        bool trace = false) const;
+
+    // Starts collecting the status and resource statistics of each
+    // container, see `__containers`. The returned entries never fail;
+    // if 'timeout' is set, a container that does not respond within
+    // it is reported without its status or statistics.
+    std::list<process::Future<JSON::Object>> ___containers(
+        Option<process::Owned<ObjectApprover>> approver,
+        bool history,
+        bool trace,
+        const Option<Duration>& timeout) const;
+
+    // Streams a JSON array of the container entries, writing each
+    // entry as soon as it is ready.
+    process::http::Response streamContainers(
+        const std::list<process::Future<JSON::Object>>& entries) const;
 
     // Helper routines for endpoint authorization.
     Try<std::string> extractEndpoint(const process::http::URL& url) const;
@@ -639,6 +761,11 @@ private:
         const process::Owned<ObjectApprover>& taskApprover,
         const process::Owned<ObjectApprover>& executorsApprover) const;
 
+    process::Future<process::http::Response> subscribe(
+        const mesos::agent::Call& call,
+        ContentType acceptType,
+        const Option<std::string>& principal) const;
+
     process::Future<process::http::Response> launchNestedContainer(
         const mesos::agent::Call& call,
         ContentType acceptType,
@@ -758,6 +885,59 @@ private:
 
   BoundedHashMap<FrameworkID, process::Owned<Framework>> completedFrameworks;
 
+  // Incremented whenever the frameworks, executors, tasks or resources
+  // reported by the `/state` endpoint may have changed, see
+  // `Http::state()`.
+  uint64_t stateGeneration;
+
+  // The serialized `/state` as of `generation`, which is reused by
+  // `Http::state()` while `stateGeneration` does not change. This is
+  // only used without an authorizer, since otherwise the state depends
+  // on the principal.
+  struct CachedState
+  {
+    uint64_t generation;
+    std::string body;
+
+    // The gzip compressed `body`, computed on the first request that
+    // accepts it.
+    Option<std::string> gzipped;
+  };
+
+  Option<CachedState> cachedState;
+
+  struct Subscribers
+  {
+    // Represents a client subscribed to the 'api/vX' endpoint.
+    //
+    // NOTE: Like on the master, the events are sent to all the
+    // subscribers, i.e., they are neither filtered by the interests
+    // nor by the authorization of the subscriber.
+    struct Subscriber
+    {
+      Subscriber(const HttpConnection& _http)
+        : http(_http) {}
+
+      // Not copyable, not assignable.
+      Subscriber(const Subscriber&) = delete;
+      Subscriber& operator=(const Subscriber&) = delete;
+
+      ~Subscriber()
+      {
+        http.close();
+      }
+
+      HttpConnection http;
+    };
+
+    // Sends the event to all subscribers connected to the 'api/vX' endpoint.
+    void send(const mesos::agent::Event& event);
+
+    // Active subscribers to the 'api/vX' endpoint keyed by the stream
+    // identifier.
+    hashmap<UUID, process::Owned<Subscriber>> subscribed;
+  } subscribers;
+
   mesos::master::detector::MasterDetector* detector;
 
   Containerizer* containerizer;
@@ -780,12 +960,29 @@ private:
 
   StatusUpdateManager* statusUpdateManager;
 
+  // Used to checkpoint tasks, see `Executor::checkpointTask`.
+  state::Checkpointer checkpointer;
+
   // Master detection future.
   process::Future<Option<MasterInfo>> detection;
 
   // Master's ping timeout value, updated on reregistration.
   Duration masterPingTimeout;
 
+  // Whether the master accepts batched status updates, updated on
+  // reregistration.
+  bool masterBatchesStatusUpdates;
+
+  // The ID of the leading master, and the ID of the master that the
+  // agent last (re-)registered with if that master accepts a digest
+  // instead of the full state when the agent re-registers (see
+  // `ReregisterSlaveMessage.state_digest`).
+  Option<std::string> masterId;
+  Option<std::string> stateDigestMasterId;
+
+  // Status updates waiting to be sent to the master by `_forward()`.
+  std::vector<StatusUpdate> pendingStatusUpdates;
+
   // Timer for triggering re-detection when no ping is received from
   // the master.
   process::Timer pingTimer;
@@ -826,45 +1023,22 @@ private:
 
   mesos::slave::QoSController* qosController;
 
+  // Samples the resource usage of the containers, shared by the
+  // resource estimator, the QoS controller and the HTTP endpoints.
+  process::Owned<UsageCollector> usageCollector;
+
   const Option<Authorizer*> authorizer;
 
   // The most recent estimate of the total amount of oversubscribed
-  // (allocated and oversubscribable) resources.
+  // (allocated and oversubscribable) resources that was forwarded to
+  // the master, or that is forwarded once the agent (re-)registers.
   Option<Resources> oversubscribedResources;
-};
 
-
-// Represents the streaming HTTP connection to an executor.
-struct HttpConnection
-{
-  HttpConnection(const process::http::Pipe::Writer& _writer,
-                 ContentType _contentType)
-    : writer(_writer),
-      contentType(_contentType),
-      encoder(lambda::bind(serialize, contentType, lambda::_1)) {}
-
-  // Converts the message to an Event before sending.
-  template <typename Message>
-  bool send(const Message& message)
-  {
-    // We need to evolve the internal 'message' into a
-    // 'v1::executor::Event'.
-    return writer.write(encoder.encode(evolve(message)));
-  }
-
-  bool close()
-  {
-    return writer.close();
-  }
-
-  process::Future<Nothing> closed() const
-  {
-    return writer.readerClosed();
-  }
-
-  process::http::Pipe::Writer writer;
-  ContentType contentType;
-  ::recordio::Encoder<v1::executor::Event> encoder;
+  // The pre-created sandboxes of each user, keyed by the empty string
+  // for sandboxes owned by the agent user, and the number of those
+  // which are still being created.
+  hashmap<std::string, std::vector<std::string>> sandboxPool;
+  hashmap<std::string, size_t> pendingPooledSandboxes;
 };
 
 
@@ -920,6 +1094,13 @@ struct Executor
   // Returns true if this is a command executor.
   bool isCommandExecutor() const;
 
+  // Returns true if this executor stands for an agent-managed command
+  // task (see `--agent_managed_command_tasks`): its container runs the
+  // task's command rather than an executor, and the agent generates
+  // the task's status updates. Such executors are also command
+  // executors.
+  bool isAgentManaged() const;
+
   // Closes the HTTP connection.
   void closeHttpConnection();
 
@@ -969,6 +1150,24 @@ struct Executor
 
   const bool checkpoint;
 
+  // Satisfied once the last task checkpointed by `checkpointTask`
+  // has been flushed to disk.
+  process::Future<Nothing> checkpointed;
+
+  // The times at which the executor went through the phases of its
+  // launch, reported by `/containers?trace=true`. A launch breaks
+  // down into the launch of the container (i.e., fetching, image
+  // provisioning and isolation, see the `containerizer/mesos/launch/*`
+  // metrics), the registration of the executor, and the executor
+  // getting its first task to TASK_RUNNING.
+  struct Trace
+  {
+    Option<process::Time> launching;
+    Option<process::Time> launched;
+    Option<process::Time> registered;
+    Option<process::Time> running;
+  } trace;
+
   // An Executor can either be connected via HTTP or by libprocess
   // message passing. The following are the possible states:
   //
@@ -984,6 +1183,15 @@ struct Executor
   Option<HttpConnection> http;
   Option<process::UPID> pid;
 
+  // Whether the (HTTP) executor sends batches of status updates, in
+  // which case it also understands batched acknowledgements (see
+  // `Slave::sendAcknowledgements()`).
+  bool batchedUpdates;
+
+  // The acknowledgements that are about to be sent to the executor
+  // as one `ACKNOWLEDGEMENTS` event.
+  StatusUpdateAcknowledgementsMessage pendingAcknowledgements;
+
   // Currently consumed resources.
   Resources resources;
 
@@ -1023,6 +1231,7 @@ private:
   Executor& operator=(const Executor&); // No assigning.
 
   bool commandExecutor;
+  bool agentManaged;
 };
 
 
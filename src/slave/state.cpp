@@ -16,13 +16,29 @@
 
 #include <glog/logging.h>
 
-#include <iostream>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif // __linux__
 
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <list>
+#include <thread>
+#include <vector>
+
+#include <process/dispatch.hpp>
+#include <process/future.hpp>
+#include <process/id.hpp>
+#include <process/owned.hpp>
 #include <process/pid.hpp>
+#include <process/process.hpp>
 
 #include <stout/check.hpp>
 #include <stout/error.hpp>
 #include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/hashset.hpp>
 #include <stout/none.hpp>
 #include <stout/nothing.hpp>
 #include <stout/numify.hpp>
@@ -34,8 +50,10 @@
 #include <stout/os/bootid.hpp>
 #include <stout/os/close.hpp>
 #include <stout/os/exists.hpp>
+#include <stout/os/fsync.hpp>
 #include <stout/os/ftruncate.hpp>
 #include <stout/os/ls.hpp>
+#include <stout/os/open.hpp>
 #include <stout/os/read.hpp>
 #include <stout/os/realpath.hpp>
 #include <stout/os/stat.hpp>
@@ -44,6 +62,7 @@
 
 #include "slave/paths.hpp"
 #include "slave/state.hpp"
+#include "slave/status_update_journal.hpp"
 
 namespace mesos {
 namespace internal {
@@ -53,6 +72,43 @@ namespace state {
 using std::list;
 using std::max;
 using std::string;
+using std::vector;
+
+using process::dispatch;
+using process::Failure;
+using process::Future;
+using process::Owned;
+using process::Process;
+using process::Promise;
+
+
+// Calls 'f' with each index in [0, n), in parallel on up to as many
+// threads as there are cores (including the calling thread), and
+// returns once all the calls have returned.
+static void parallel(size_t n, const lambda::function<void(size_t)>& f)
+{
+  const size_t concurrency = std::min<size_t>(
+      n, max(1u, std::thread::hardware_concurrency()));
+
+  std::atomic<size_t> next(0);
+
+  auto work = [n, &f, &next]() {
+    for (size_t i = next++; i < n; i = next++) {
+      f(i);
+    }
+  };
+
+  vector<std::thread> threads;
+  for (size_t i = 1; i < concurrency; ++i) {
+    threads.emplace_back(work);
+  }
+
+  work();
+
+  foreach (std::thread& thread, threads) {
+    thread.join();
+  }
+}
 
 
 Try<State> recover(const string& rootDir, bool strict)
@@ -194,6 +250,73 @@ Try<SlaveState> SlaveState::recover(
     state.errors += framework.get().errors;
   }
 
+  // Read the status updates from the journal of the agent. The
+  // updates checkpointed by older agents to the 'task.updates' file
+  // of each task (if any) precede those in the journal.
+  Try<hashmap<FrameworkID, hashmap<TaskID, StatusUpdateJournal::Stream>>>
+    journal = StatusUpdateJournal::read(rootDir, slaveId);
+
+  if (journal.isError()) {
+    const string message =
+      "Failed to read the status update journal: " + journal.error();
+
+    if (strict) {
+      return Error(message);
+    } else {
+      LOG(WARNING) << message;
+      state.errors++;
+      return state;
+    }
+  }
+
+  foreachkey (const FrameworkID& frameworkId, journal.get()) {
+    if (!state.frameworks.contains(frameworkId)) {
+      continue;
+    }
+
+    FrameworkState& framework = state.frameworks.at(frameworkId);
+
+    foreachpair (const TaskID& taskId,
+                 const StatusUpdateJournal::Stream& stream,
+                 journal->at(frameworkId)) {
+      // The journal still contains the streams of the executor runs
+      // that have been garbage collected until it is compacted.
+      if (!framework.executors.contains(stream.executorId) ||
+          !framework.executors.at(stream.executorId).runs.contains(
+              stream.containerId)) {
+        continue;
+      }
+
+      RunState& run = framework.executors.at(stream.executorId)
+        .runs.at(stream.containerId);
+
+      if (!run.tasks.contains(taskId)) {
+        continue;
+      }
+
+      TaskState& task = run.tasks.at(taskId);
+
+      // The journal also contains (some of) the updates of the
+      // 'task.updates' file if the agent failed over while migrating
+      // the file to the journal, in which case they are only
+      // recovered once.
+      hashset<string> uuids;
+      foreach (const StatusUpdate& update, task.updates) {
+        uuids.insert(update.uuid());
+      }
+
+      foreach (const StatusUpdate& update, stream.updates) {
+        if (!uuids.contains(update.uuid())) {
+          task.updates.push_back(update);
+        }
+      }
+
+      foreach (const UUID& uuid, stream.acks) {
+        task.acks.insert(uuid);
+      }
+    }
+  }
+
   return state;
 }
 
@@ -286,13 +409,30 @@ Try<FrameworkState> FrameworkState::recover(
         ": " + executors.error());
   }
 
-  // Recover the executors.
+  vector<ExecutorID> executorIds;
   foreach (const string& path, executors.get()) {
     ExecutorID executorId;
     executorId.set_value(Path(path).basename());
+    executorIds.push_back(executorId);
+  }
+
+  // Recover the executors in parallel, since an agent can have
+  // thousands of them and recovering each of them mostly waits for
+  // its checkpoints to be read.
+  vector<Option<Try<ExecutorState>>> recovered(executorIds.size());
+
+  parallel(
+      executorIds.size(),
+      [&](size_t i) {
+        recovered[i] = ExecutorState::recover(
+            rootDir, slaveId, frameworkId, executorIds[i], strict);
+      });
 
-    Try<ExecutorState> executor =
-      ExecutorState::recover(rootDir, slaveId, frameworkId, executorId, strict);
+  for (size_t i = 0; i < executorIds.size(); ++i) {
+    CHECK_SOME(recovered[i]);
+
+    const ExecutorID& executorId = executorIds[i];
+    const Try<ExecutorState>& executor = recovered[i].get();
 
     if (executor.isError()) {
       return Error("Failed to recover executor '" + executorId.value() +
@@ -330,7 +470,8 @@ Try<ExecutorState> ExecutorState::recover(
                  "': " + runs.error());
   }
 
-  // Recover the runs.
+  // Find the latest run first, since it is the only run that we
+  // recover in full.
   foreach (const string& path, runs.get()) {
     if (Path(path).basename() == paths::LATEST_SYMLINK) {
       const Result<string>& latest = os::realpath(path);
@@ -347,10 +488,28 @@ Try<ExecutorState> ExecutorState::recover(
       ContainerID containerId;
       containerId.set_value(Path(latest.get()).basename());
       state.latest = containerId;
-    } else {
+    }
+  }
+
+  // Recover the runs.
+  foreach (const string& path, runs.get()) {
+    if (Path(path).basename() != paths::LATEST_SYMLINK) {
       ContainerID containerId;
       containerId.set_value(Path(path).basename());
 
+      // The agent only garbage collects the runs other than the
+      // latest one, so we skip reading their checkpoints (e.g., the
+      // tasks and their status updates).
+      if (state.latest.isNone() || state.latest.get() != containerId) {
+        RunState run;
+        run.id = containerId;
+        run.completed = os::exists(paths::getExecutorSentinelPath(
+            rootDir, slaveId, frameworkId, executorId, containerId));
+
+        state.runs[containerId] = run;
+        continue;
+      }
+
       Try<RunState> run = RunState::recover(
           rootDir, slaveId, frameworkId, executorId, containerId, strict);
 
@@ -606,9 +765,8 @@ Try<TaskState> TaskState::recover(
   path = paths::getTaskUpdatesPath(
       rootDir, slaveId, frameworkId, executorId, containerId, taskId);
   if (!os::exists(path)) {
-    // This could happen if the slave died before it checkpointed any
-    // status updates for this task.
-    LOG(WARNING) << "Failed to find status updates file '" << path << "'";
+    // The status updates are in the journal of the agent (if any),
+    // unless they were checkpointed by an older agent.
     return state;
   }
 
@@ -629,12 +787,14 @@ Try<TaskState> TaskState::recover(
     }
   }
 
-  // Now, read the updates.
+  // Now, read the updates. Errors due to a partial protobuf read are
+  // ignored and the reader reverts the seek position to the end of
+  // the last valid update once it is done.
+  ::protobuf::Reader<StatusUpdateRecord> reader(fd.get(), true);
+
   Result<StatusUpdateRecord> record = None();
   while (true) {
-    // Ignore errors due to partial protobuf read and enable undoing
-    // failed reads by reverting to the previous seek position.
-    record = ::protobuf::read<StatusUpdateRecord>(fd.get(), true, true);
+    record = reader.read();
 
     if (!record.isSome()) {
       break;
@@ -657,7 +817,7 @@ Try<TaskState> TaskState::recover(
   // Always truncate the file to contain only valid updates.
   // NOTE: This is safe even though we ignore partial protobuf read
   // errors above, because the 'fd' is properly set to the end of the
-  // last valid update by 'protobuf::read()'.
+  // last valid update by 'protobuf::Reader'.
   Try<Nothing> truncated = os::ftruncate(fd.get(), offset);
 
   if (truncated.isError()) {
@@ -754,11 +914,13 @@ Try<Resources> ResourcesState::recoverResources(
     }
   }
 
+  // Ignore errors due to partial protobuf read, see the updates in
+  // `TaskState::recover`.
+  ::protobuf::Reader<Resource> reader(fd.get(), true);
+
   Result<Resource> resource = None();
   while (true) {
-    // Ignore errors due to partial protobuf read and enable undoing
-    // failed reads by reverting to the previous seek position.
-    resource = ::protobuf::read<Resource>(fd.get(), true, true);
+    resource = reader.read();
     if (!resource.isSome()) {
       break;
     }
@@ -775,7 +937,7 @@ Try<Resources> ResourcesState::recoverResources(
   // Always truncate the file to contain only valid resources.
   // NOTE: This is safe even though we ignore partial protobuf read
   // errors above, because the 'fd' is properly set to the end of the
-  // last valid resource by 'protobuf::read()'.
+  // last valid resource by 'protobuf::Reader'.
   Try<Nothing> truncated = os::ftruncate(fd.get(), offset);
 
   if (truncated.isError()) {
@@ -807,6 +969,228 @@ Try<Resources> ResourcesState::recoverResources(
   return resources;
 }
 
+
+class CheckpointerProcess : public Process<CheckpointerProcess>
+{
+public:
+  CheckpointerProcess()
+    : ProcessBase(process::ID::generate("checkpointer")) {}
+
+  virtual ~CheckpointerProcess()
+  {
+    // The pending checkpoints have not been performed, and will not
+    // be, which we surface as a discard rather than as a failure.
+    foreach (const Checkpoint& checkpoint, pending) {
+      checkpoint.promise->discard();
+    }
+  }
+
+  Future<Nothing> checkpoint(
+      const string& path,
+      const lambda::function<Try<Nothing>(const string&)>& write)
+  {
+    // Any checkpoints that get issued before the 'flush' will be
+    // part of the same batch.
+    if (pending.empty()) {
+      dispatch(self(), &Self::flush);
+    }
+
+    Checkpoint checkpoint;
+    checkpoint.path = path;
+    checkpoint.write = write;
+    checkpoint.promise.reset(new Promise<Nothing>());
+
+    pending.push_back(checkpoint);
+
+    return checkpoint.promise->future();
+  }
+
+private:
+  struct Checkpoint
+  {
+    string path;
+    lambda::function<Try<Nothing>(const string&)> write;
+    Owned<Promise<Nothing>> promise;
+  };
+
+  void flush()
+  {
+    list<Checkpoint> checkpoints;
+    std::swap(checkpoints, pending);
+
+    // The temporary file of the last checkpoint of each path, or the
+    // error if the checkpoint failed.
+    hashmap<string, Try<string>> temps;
+    hashmap<string, const Checkpoint*> last;
+
+    foreach (const Checkpoint& checkpoint, checkpoints) {
+      last[checkpoint.path] = &checkpoint;
+    }
+
+    // Write the temporary files, as 'state::checkpoint' does.
+    foreach (const Checkpoint& checkpoint, checkpoints) {
+      if (last.at(checkpoint.path) == &checkpoint) {
+        temps.put(checkpoint.path, write(checkpoint));
+      }
+    }
+
+    hashset<string> files;
+    foreachvalue (const Try<string>& temp, temps) {
+      if (temp.isSome()) {
+        files.insert(temp.get());
+      }
+    }
+
+    // Flush the temporary files before renaming them, so that a
+    // checkpoint is never replaced by a file that is not on disk.
+    Try<Nothing> sync = this->sync(files);
+
+    hashset<string> directories;
+    foreachpair (const string& path, Try<string>& temp, temps) {
+      if (temp.isError()) {
+        continue;
+      }
+
+      if (sync.isError()) {
+        os::rm(temp.get());
+        temp = Error("Failed to sync '" + temp.get() + "': " + sync.error());
+        continue;
+      }
+
+      Try<Nothing> rename = os::rename(temp.get(), path);
+      if (rename.isError()) {
+        // Try removing the temporary file on error.
+        os::rm(temp.get());
+
+        temp = Error("Failed to rename '" + temp.get() + "' to '" +
+                     path + "': " + rename.error());
+        continue;
+      }
+
+      directories.insert(Path(path).dirname());
+    }
+
+    // Flush the renames.
+    sync = this->sync(directories);
+
+    foreach (const Checkpoint& checkpoint, checkpoints) {
+      const Try<string>& temp = temps.at(checkpoint.path);
+
+      if (temp.isError()) {
+        checkpoint.promise->fail(temp.error());
+      } else if (sync.isError()) {
+        checkpoint.promise->fail(
+            "Failed to sync '" + Path(checkpoint.path).dirname() +
+            "': " + sync.error());
+      } else {
+        checkpoint.promise->set(Nothing());
+      }
+    }
+  }
+
+  // Writes the checkpoint to a temporary file next to its path,
+  // returning the temporary file.
+  static Try<string> write(const Checkpoint& checkpoint)
+  {
+    const string base = Path(checkpoint.path).dirname();
+
+    Try<Nothing> mkdir = os::mkdir(base);
+    if (mkdir.isError()) {
+      return Error(
+          "Failed to create directory '" + base + "': " + mkdir.error());
+    }
+
+    Try<string> temp = os::mktemp(path::join(base, "XXXXXX"));
+    if (temp.isError()) {
+      return Error("Failed to create temporary file: " + temp.error());
+    }
+
+    Try<Nothing> write = checkpoint.write(temp.get());
+    if (write.isError()) {
+      // Try removing the temporary file on error.
+      os::rm(temp.get());
+
+      return Error("Failed to write temporary file '" + temp.get() +
+                   "': " + write.error());
+    }
+
+    return temp.get();
+  }
+
+  // Flushes the files (or directories) to disk. On Linux, we flush
+  // each filesystem that the files are on once with 'syncfs'.
+  static Try<Nothing> sync(const hashset<string>& paths)
+  {
+#ifdef __linux__
+    hashset<dev_t> devices;
+#endif // __linux__
+
+    foreach (const string& path, paths) {
+#ifdef __WINDOWS__
+      // Directories can not be opened (and flushed) on Windows.
+      if (os::stat::isdir(path)) {
+        continue;
+      }
+#endif // __WINDOWS__
+
+      Try<int> fd = os::open(path, O_RDONLY | O_CLOEXEC);
+      if (fd.isError()) {
+        return Error("Failed to open '" + path + "': " + fd.error());
+      }
+
+      Try<Nothing> sync = Nothing();
+
+#if defined(__linux__) && defined(SYS_syncfs)
+      struct stat s;
+      if (::fstat(fd.get(), &s) < 0) {
+        sync = ErrnoError("Failed to stat '" + path + "'");
+      } else if (!devices.contains(s.st_dev)) {
+        if (::syscall(SYS_syncfs, fd.get()) < 0) {
+          sync = ErrnoError("Failed to sync the filesystem of '" + path + "'");
+        } else {
+          devices.insert(s.st_dev);
+        }
+      }
+#else
+      sync = os::fsync(fd.get());
+#endif // __linux__ && SYS_syncfs
+
+      os::close(fd.get());
+
+      if (sync.isError()) {
+        return sync;
+      }
+    }
+
+    return Nothing();
+  }
+
+  list<Checkpoint> pending;
+};
+
+
+Checkpointer::Checkpointer()
+{
+  process = new CheckpointerProcess();
+  spawn(process);
+}
+
+
+Checkpointer::~Checkpointer()
+{
+  terminate(process);
+  wait(process);
+  delete process;
+}
+
+
+Future<Nothing> Checkpointer::checkpoint(
+    const string& path,
+    const lambda::function<Try<Nothing>(const string&)>& write)
+{
+  return dispatch(process, &CheckpointerProcess::checkpoint, path, write);
+}
+
 } // namespace state {
 } // namespace slave {
 } // namespace internal {
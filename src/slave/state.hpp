@@ -26,10 +26,13 @@
 #include <mesos/resources.hpp>
 #include <mesos/type_utils.hpp>
 
+#include <process/future.hpp>
 #include <process/pid.hpp>
 
 #include <stout/hashmap.hpp>
 #include <stout/hashset.hpp>
+#include <stout/lambda.hpp>
+#include <stout/nothing.hpp>
 #include <stout/path.hpp>
 #include <stout/protobuf.hpp>
 #include <stout/try.hpp>
@@ -168,6 +171,50 @@ Try<Nothing> checkpoint(const std::string& path, const T& t)
 }
 
 
+// Forward declaration.
+class CheckpointerProcess;
+
+
+// Checkpoints like 'checkpoint' above, but asynchronously and
+// durably, i.e., the returned future is only satisfied once the
+// checkpoint has been flushed to disk. Checkpoints are performed in
+// the order they are issued, in batches: the checkpoints issued while
+// a batch is being performed are all flushed to disk together (using
+// 'syncfs' on Linux), so that the cost of flushing is shared across
+// the checkpoints. Within a batch, only the last checkpoint of each
+// path is written. The checkpoints that are still pending when the
+// checkpointer is destroyed get discarded.
+class Checkpointer
+{
+public:
+  Checkpointer();
+  ~Checkpointer();
+
+  template <typename T>
+  process::Future<Nothing> checkpoint(const std::string& path, const T& t)
+  {
+    // NOTE: We copy 't' as it is only written once the batch that
+    // the checkpoint is part of is performed.
+    return checkpoint(
+        path,
+        lambda::function<Try<Nothing>(const std::string&)>(
+            [t](const std::string& path) {
+              return internal::checkpoint(path, t);
+            }));
+  }
+
+private:
+  Checkpointer(const Checkpointer&) = delete;
+  Checkpointer& operator=(const Checkpointer&) = delete;
+
+  process::Future<Nothing> checkpoint(
+      const std::string& path,
+      const lambda::function<Try<Nothing>(const std::string&)>& write);
+
+  CheckpointerProcess* process;
+};
+
+
 // NOTE: The *State structs (e.g., TaskState, RunState, etc) are
 // defined in reverse dependency order because many of them have
 // Option<*State> dependencies which means we need them declared in
@@ -223,6 +270,9 @@ struct RunState
 };
 
 
+// NOTE: Only the latest run of an executor is recovered in full. The
+// other runs are only garbage collected by the agent, hence we only
+// recover their 'id' and whether they are 'completed'.
 struct ExecutorState
 {
   ExecutorState() : errors(0) {}
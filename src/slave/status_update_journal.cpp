@@ -0,0 +1,748 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <glog/logging.h>
+
+#include <stout/check.hpp>
+#include <stout/error.hpp>
+#include <stout/foreach.hpp>
+#include <stout/numify.hpp>
+#include <stout/os.hpp>
+#include <stout/path.hpp>
+#include <stout/protobuf.hpp>
+#include <stout/stringify.hpp>
+#include <stout/strings.hpp>
+
+#include <stout/os/close.hpp>
+#include <stout/os/fsync.hpp>
+#include <stout/os/ftruncate.hpp>
+#include <stout/os/open.hpp>
+
+#include "slave/paths.hpp"
+#include "slave/status_update_journal.hpp"
+
+using std::list;
+using std::map;
+using std::string;
+using std::vector;
+
+using process::Owned;
+
+namespace mesos {
+namespace internal {
+namespace slave {
+
+const Bytes StatusUpdateJournal::MAX_SEGMENT_SIZE = Megabytes(16);
+const Bytes StatusUpdateJournal::MIN_COMPACTION_SIZE = Megabytes(4);
+
+
+// The suffixes of the files of the journal, which are named after
+// the identifier of the segment.
+static const char SEGMENT_SUFFIX[] = ".segment";
+static const char SNAPSHOT_SUFFIX[] = ".snapshot";
+
+
+// Returns the size of the record in the journal, i.e., including the
+// size that precedes it, see `::protobuf::write`.
+static size_t size(const StatusUpdateJournalRecord& record)
+{
+  return sizeof(uint32_t) + record.ByteSize();
+}
+
+
+Try<hashmap<FrameworkID, hashmap<TaskID, StatusUpdateJournal::Stream>>>
+StatusUpdateJournal::read(const string& rootDir, const SlaveID& slaveId)
+{
+  hashmap<FrameworkID, hashmap<TaskID, Stream>> streams;
+
+  const string directory =
+    paths::getStatusUpdateJournalPath(rootDir, slaveId);
+
+  if (!os::exists(directory)) {
+    return streams;
+  }
+
+  Try<map<uint64_t, string>> segments = replay(
+      directory,
+      false,
+      [&streams](const StatusUpdateJournalRecord& record, const Location&) {
+        // The stream of a task is re-opened if the task gets more
+        // updates after its stream has been closed, which is why we
+        // ignore the records that close a stream.
+        if (!record.has_record()) {
+          return;
+        }
+
+        Stream& stream = streams[record.framework_id()][record.task_id()];
+        stream.executorId = record.executor_id();
+        stream.containerId = record.container_id();
+
+        if (record.record().type() == StatusUpdateRecord::UPDATE) {
+          stream.updates.push_back(record.record().update());
+        } else {
+          stream.acks.insert(UUID::fromBytes(record.record().uuid()).get());
+        }
+      });
+
+  if (segments.isError()) {
+    return Error(segments.error());
+  }
+
+  return streams;
+}
+
+
+Try<Owned<StatusUpdateJournal>> StatusUpdateJournal::open(
+    const string& rootDir,
+    const SlaveID& slaveId)
+{
+  Owned<StatusUpdateJournal> journal(
+      new StatusUpdateJournal(rootDir, slaveId));
+
+  Try<Nothing> mkdir = os::mkdir(journal->directory);
+  if (mkdir.isError()) {
+    return Error(
+        "Failed to create status update journal directory '" +
+        journal->directory + "': " + mkdir.error());
+  }
+
+  StatusUpdateJournal* self = journal.get();
+
+  Try<map<uint64_t, string>> segments = replay(
+      journal->directory,
+      true,
+      [self](const StatusUpdateJournalRecord& record,
+             const Location& location) {
+        self->index(record, location);
+      });
+
+  if (segments.isError()) {
+    return Error(segments.error());
+  }
+
+  journal->segments = segments.get();
+
+  // Remove the files that precede the last snapshot, as well as any
+  // snapshot that we failed to write. We ignore the errors since
+  // these files are never read again.
+  Try<list<string>> entries = os::ls(journal->directory);
+  if (entries.isError()) {
+    return Error(
+        "Failed to list status update journal directory '" +
+        journal->directory + "': " + entries.error());
+  }
+
+  foreach (const string& entry, entries.get()) {
+    const string path = path::join(journal->directory, entry);
+
+    bool read = false;
+    foreachvalue (const string& segment, journal->segments) {
+      read = read || segment == path;
+    }
+
+    if (!read) {
+      VLOG(1) << "Removing stale status update journal file '" << path << "'";
+      os::rm(path);
+    }
+  }
+
+  // We only ever append to a segment, hence we start a new one if
+  // the journal is empty or ends with a snapshot.
+  if (journal->segments.empty() ||
+      strings::endsWith(journal->segments.rbegin()->second, SNAPSHOT_SUFFIX)) {
+    Try<Nothing> roll = journal->roll();
+    if (roll.isError()) {
+      return Error(roll.error());
+    }
+  } else {
+    const string& path = journal->segments.rbegin()->second;
+
+    Try<int> fd = os::open(
+        path,
+        O_WRONLY | O_APPEND | O_CLOEXEC,
+        S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+
+    if (fd.isError()) {
+      return Error("Failed to open '" + path + "': " + fd.error());
+    }
+
+    Try<Bytes> size = os::stat::size(path);
+    if (size.isError()) {
+      os::close(fd.get());
+      return Error("Failed to get the size of '" + path + "': " + size.error());
+    }
+
+    journal->fd = fd.get();
+    journal->size = size->bytes();
+  }
+
+  return journal;
+}
+
+
+StatusUpdateJournal::StatusUpdateJournal(
+    const string& _rootDir,
+    const SlaveID& _slaveId)
+  : rootDir(_rootDir),
+    slaveId_(_slaveId),
+    directory(paths::getStatusUpdateJournalPath(_rootDir, _slaveId)),
+    size(0),
+    total(0),
+    live(0) {}
+
+
+StatusUpdateJournal::~StatusUpdateJournal()
+{
+  if (fd.isSome()) {
+    os::close(fd.get());
+  }
+}
+
+
+Try<Nothing> StatusUpdateJournal::append(
+    const FrameworkID& frameworkId,
+    const TaskID& taskId,
+    const ExecutorID& executorId,
+    const ContainerID& containerId,
+    const StatusUpdateRecord& record)
+{
+  CHECK_SOME(fd);
+  CHECK(!segments.empty());
+
+  StatusUpdateJournalRecord journalRecord;
+  journalRecord.mutable_framework_id()->CopyFrom(frameworkId);
+  journalRecord.mutable_task_id()->CopyFrom(taskId);
+  journalRecord.mutable_executor_id()->CopyFrom(executorId);
+  journalRecord.mutable_container_id()->CopyFrom(containerId);
+  journalRecord.mutable_record()->CopyFrom(record);
+
+  Try<Nothing> write = ::protobuf::write(fd.get(), journalRecord);
+  if (write.isError()) {
+    return Error(
+        "Failed to write to '" + segments.rbegin()->second +
+        "': " + write.error());
+  }
+
+  Location location;
+  location.segment = segments.rbegin()->first;
+  location.offset = size;
+  location.size = slave::size(journalRecord);
+
+  size += location.size;
+
+  index(journalRecord, location);
+
+  if (size >= MAX_SEGMENT_SIZE.bytes()) {
+    Try<Nothing> roll = this->roll();
+    if (roll.isError()) {
+      return Error(roll.error());
+    }
+  }
+
+  if (total >= MIN_COMPACTION_SIZE.bytes() && total >= 2 * live) {
+    // The record has been journaled, hence we do not fail it if we
+    // fail to compact the journal; the next append retries.
+    Try<Nothing> compact = this->compact();
+    if (compact.isError()) {
+      LOG(ERROR) << "Failed to compact the status update journal: "
+                 << compact.error();
+    }
+  }
+
+  return Nothing();
+}
+
+
+void StatusUpdateJournal::close(
+    const FrameworkID& frameworkId,
+    const TaskID& taskId)
+{
+  CHECK_SOME(fd);
+
+  if (!streams.contains(frameworkId) ||
+      !streams.at(frameworkId).contains(taskId) ||
+      streams.at(frameworkId).at(taskId).closed.isSome()) {
+    return;
+  }
+
+  const Index& stream = streams.at(frameworkId).at(taskId);
+
+  StatusUpdateJournalRecord record;
+  record.mutable_framework_id()->CopyFrom(frameworkId);
+  record.mutable_task_id()->CopyFrom(taskId);
+  record.mutable_executor_id()->CopyFrom(stream.executorId);
+  record.mutable_container_id()->CopyFrom(stream.containerId);
+
+  // If we fail to journal that the stream is closed, it is retained
+  // in its entirety, which only delays reclaiming its records.
+  Try<Nothing> write = ::protobuf::write(fd.get(), record);
+  if (write.isError()) {
+    LOG(ERROR) << "Failed to write to '" << segments.rbegin()->second
+               << "': " << write.error();
+    return;
+  }
+
+  Location location;
+  location.segment = segments.rbegin()->first;
+  location.offset = size;
+  location.size = slave::size(record);
+
+  size += location.size;
+
+  index(record, location);
+}
+
+
+Try<Nothing> StatusUpdateJournal::migrate(
+    const FrameworkID& frameworkId,
+    const TaskID& taskId,
+    const ExecutorID& executorId,
+    const ContainerID& containerId,
+    const string& path)
+{
+  Try<int> input = os::open(path, O_RDONLY | O_CLOEXEC);
+  if (input.isError()) {
+    return Error("Failed to open '" + path + "': " + input.error());
+  }
+
+  // NOTE: A partially written record at the end of the file is
+  // ignored, like when recovering the task (see `TaskState::recover`).
+  ::protobuf::Reader<StatusUpdateRecord> reader(input.get(), true);
+
+  vector<StatusUpdateRecord> records;
+
+  while (true) {
+    Result<StatusUpdateRecord> record = reader.read();
+
+    if (record.isError()) {
+      os::close(input.get());
+      return Error("Failed to read '" + path + "': " + record.error());
+    } else if (record.isNone()) {
+      break;
+    }
+
+    records.push_back(record.get());
+  }
+
+  os::close(input.get());
+
+  // Until the file is removed, the records of the stream in the
+  // journal can only have been appended by a previous migration,
+  // since the stream is recovered (and migrated) before any updates
+  // are journaled for it. Hence they are a prefix of the records in
+  // the file.
+  size_t journaled = 0;
+
+  if (streams.contains(frameworkId) &&
+      streams.at(frameworkId).contains(taskId)) {
+    journaled = streams.at(frameworkId).at(taskId).records.size();
+  }
+
+  for (size_t i = journaled; i < records.size(); i++) {
+    Try<Nothing> append = this->append(
+        frameworkId, taskId, executorId, containerId, records[i]);
+
+    if (append.isError()) {
+      return Error(append.error());
+    }
+  }
+
+  // NOTE: Like the records themselves, the removal of the file does
+  // not need to be synced, since the agent does not recover its
+  // checkpoints after the host rebooted.
+  Try<Nothing> rm = os::rm(path);
+  if (rm.isError()) {
+    return Error("Failed to remove '" + path + "': " + rm.error());
+  }
+
+  VLOG(1) << "Migrated " << records.size() << " status update records of"
+          << " task " << taskId << " of framework " << frameworkId
+          << " from '" << path << "' to the journal";
+
+  return Nothing();
+}
+
+
+Try<Nothing> StatusUpdateJournal::compact()
+{
+  CHECK(!segments.empty());
+
+  const uint64_t id = segments.rbegin()->first + 1;
+  const string path =
+    path::join(directory, stringify(id) + SNAPSHOT_SUFFIX);
+  const string temp = path + ".tmp";
+
+  VLOG(1) << "Compacting the status update journal into '" << path << "'";
+
+  Try<int> output = os::open(
+      temp,
+      O_CREAT | O_WRONLY | O_TRUNC | O_CLOEXEC,
+      S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+
+  if (output.isError()) {
+    return Error("Failed to open '" + temp + "': " + output.error());
+  }
+
+  hashmap<uint64_t, int> inputs;
+
+  // Closes the files and removes the snapshot (on errors).
+  auto cleanup = [&](const string& message) -> Try<Nothing> {
+    foreachvalue (int fd, inputs) {
+      os::close(fd);
+    }
+
+    os::close(output.get());
+    os::rm(temp);
+
+    return Error(message);
+  };
+
+  foreachpair (uint64_t segment, const string& path, segments) {
+    Try<int> fd = os::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd.isError()) {
+      return cleanup("Failed to open '" + path + "': " + fd.error());
+    }
+
+    inputs[segment] = fd.get();
+  }
+
+  hashmap<FrameworkID, hashmap<TaskID, Index>> compacted;
+  size_t offset = 0;
+
+  foreachkey (const FrameworkID& frameworkId, streams) {
+    foreachpair (const TaskID& taskId,
+                 const Index& stream,
+                 streams.at(frameworkId)) {
+      vector<Location> locations;
+
+      if (stream.closed.isNone()) {
+        locations = stream.records;
+      } else {
+        const string run = paths::getExecutorRunPath(
+            rootDir,
+            slaveId_,
+            frameworkId,
+            stream.executorId,
+            stream.containerId);
+
+        // The executor run has been garbage collected, so the agent
+        // no longer recovers the task.
+        if (!os::exists(run)) {
+          continue;
+        }
+
+        foreach (const Option<Location>& location,
+                 vector<Option<Location>>({stream.last, stream.ack,
+                                           stream.closed})) {
+          if (location.isSome()) {
+            locations.push_back(location.get());
+          }
+        }
+      }
+
+      Index& index = compacted[frameworkId][taskId];
+      index.executorId = stream.executorId;
+      index.containerId = stream.containerId;
+
+      foreach (const Location& location, locations) {
+        const int fd = inputs.at(location.segment);
+
+        if (::lseek(fd, location.offset, SEEK_SET) < 0) {
+          return cleanup(
+              "Failed to seek in '" + segments.at(location.segment) + "': " +
+              os::strerror(errno));
+        }
+
+        Result<StatusUpdateJournalRecord> record =
+          ::protobuf::read<StatusUpdateJournalRecord>(fd);
+
+        if (!record.isSome()) {
+          return cleanup(
+              "Failed to read from '" + segments.at(location.segment) +
+              "': " + (record.isError() ? record.error() : "none"));
+        }
+
+        Try<Nothing> write = ::protobuf::write(output.get(), record.get());
+        if (write.isError()) {
+          return cleanup(
+              "Failed to write to '" + temp + "': " + write.error());
+        }
+
+        Location snapshot;
+        snapshot.segment = id;
+        snapshot.offset = offset;
+        snapshot.size = location.size;
+
+        offset += snapshot.size;
+
+        index.records.push_back(snapshot);
+
+        if (stream.last.isSome() && location.offset == stream.last->offset &&
+            location.segment == stream.last->segment) {
+          index.last = snapshot;
+          index.uuid = stream.uuid;
+        } else if (stream.ack.isSome() &&
+                   location.offset == stream.ack->offset &&
+                   location.segment == stream.ack->segment) {
+          index.ack = snapshot;
+        } else if (stream.closed.isSome() &&
+                   location.offset == stream.closed->offset &&
+                   location.segment == stream.closed->segment) {
+          index.closed = snapshot;
+        }
+      }
+    }
+  }
+
+  foreachvalue (int fd, inputs) {
+    os::close(fd);
+  }
+
+  // Make sure the snapshot is on disk before we delete the segments
+  // that it supersedes.
+  Try<Nothing> fsync = os::fsync(output.get());
+  os::close(output.get());
+
+  if (fsync.isError()) {
+    os::rm(temp);
+    return Error("Failed to sync '" + temp + "': " + fsync.error());
+  }
+
+  Try<Nothing> rename = os::rename(temp, path);
+  if (rename.isError()) {
+    os::rm(temp);
+    return Error(
+        "Failed to rename '" + temp + "' to '" + path + "': " +
+        rename.error());
+  }
+
+  // From now on the snapshot supersedes the segments, so any error
+  // in removing them is harmless: they get removed when the journal
+  // is opened again.
+  if (fd.isSome()) {
+    os::close(fd.get());
+    fd = None();
+  }
+
+  foreachvalue (const string& segment, segments) {
+    os::rm(segment);
+  }
+
+  segments.clear();
+  segments[id] = path;
+
+  streams = compacted;
+  total = offset;
+  live = offset;
+
+  VLOG(1) << "Compacted the status update journal to " << Bytes(offset);
+
+  // Start a new segment for the records that follow.
+  return roll();
+}
+
+
+Try<map<uint64_t, string>> StatusUpdateJournal::replay(
+    const string& directory,
+    bool truncate,
+    const lambda::function<void(
+        const StatusUpdateJournalRecord&, const Location&)>& f)
+{
+  Try<list<string>> entries = os::ls(directory);
+  if (entries.isError()) {
+    return Error(
+        "Failed to list status update journal directory '" + directory +
+        "': " + entries.error());
+  }
+
+  map<uint64_t, string> segments;
+  Option<uint64_t> snapshot;
+
+  foreach (const string& entry, entries.get()) {
+    const bool isSnapshot = strings::endsWith(entry, SNAPSHOT_SUFFIX);
+
+    if (!isSnapshot && !strings::endsWith(entry, SEGMENT_SUFFIX)) {
+      continue;
+    }
+
+    Try<uint64_t> id = numify<uint64_t>(
+        strings::remove(
+            entry,
+            isSnapshot ? SNAPSHOT_SUFFIX : SEGMENT_SUFFIX,
+            strings::SUFFIX));
+
+    if (id.isError()) {
+      continue;
+    }
+
+    segments[id.get()] = path::join(directory, entry);
+
+    if (isSnapshot && (snapshot.isNone() || id.get() > snapshot.get())) {
+      snapshot = id.get();
+    }
+  }
+
+  // The last snapshot supersedes the segments that precede it.
+  if (snapshot.isSome()) {
+    segments.erase(segments.begin(), segments.find(snapshot.get()));
+  }
+
+  foreachpair (uint64_t id, const string& path, segments) {
+    Try<int> fd = os::open(
+        path,
+        (truncate ? O_RDWR : O_RDONLY) | O_CLOEXEC);
+
+    if (fd.isError()) {
+      return Error("Failed to open '" + path + "': " + fd.error());
+    }
+
+    Location location;
+    location.segment = id;
+    location.offset = 0;
+
+    // Ignore errors due to partial protobuf read, the reader reverts
+    // the seek position to the end of the last valid record.
+    ::protobuf::Reader<StatusUpdateJournalRecord> reader(fd.get(), true);
+
+    Result<StatusUpdateJournalRecord> record = None();
+    while (true) {
+      record = reader.read();
+
+      if (!record.isSome()) {
+        break;
+      }
+
+      location.size = slave::size(record.get());
+
+      f(record.get(), location);
+
+      location.offset += location.size;
+    }
+
+    if (record.isError()) {
+      os::close(fd.get());
+      return Error("Failed to read '" + path + "': " + record.error());
+    }
+
+    // Truncate the segment to contain only valid records, see
+    // `TaskState::recover`.
+    if (truncate) {
+      Try<Nothing> truncated = os::ftruncate(fd.get(), location.offset);
+      if (truncated.isError()) {
+        os::close(fd.get());
+        return Error(
+            "Failed to truncate '" + path + "': " + truncated.error());
+      }
+    }
+
+    os::close(fd.get());
+  }
+
+  return segments;
+}
+
+
+void StatusUpdateJournal::index(
+    const StatusUpdateJournalRecord& record,
+    const Location& location)
+{
+  Index& stream = streams[record.framework_id()][record.task_id()];
+
+  live -= retained(stream);
+
+  stream.executorId = record.executor_id();
+  stream.containerId = record.container_id();
+  stream.records.push_back(location);
+
+  if (!record.has_record()) {
+    stream.closed = location;
+  } else {
+    // More updates re-open the stream.
+    stream.closed = None();
+
+    if (record.record().type() == StatusUpdateRecord::UPDATE) {
+      stream.last = location;
+      stream.uuid = record.record().update().uuid();
+      stream.ack = None();
+    } else if (stream.uuid == record.record().uuid()) {
+      stream.ack = location;
+    }
+  }
+
+  live += retained(stream);
+  total += location.size;
+}
+
+
+size_t StatusUpdateJournal::retained(const Index& stream)
+{
+  size_t size = 0;
+
+  if (stream.closed.isNone()) {
+    foreach (const Location& location, stream.records) {
+      size += location.size;
+    }
+  } else {
+    foreach (const Option<Location>& location,
+             vector<Option<Location>>({stream.last, stream.ack,
+                                       stream.closed})) {
+      if (location.isSome()) {
+        size += location->size;
+      }
+    }
+  }
+
+  return size;
+}
+
+
+Try<Nothing> StatusUpdateJournal::roll()
+{
+  const uint64_t id = segments.empty() ? 0 : segments.rbegin()->first + 1;
+  const string path = path::join(directory, stringify(id) + SEGMENT_SUFFIX);
+
+  Try<int> result = os::open(
+      path,
+      O_CREAT | O_WRONLY | O_APPEND | O_CLOEXEC,
+      S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+
+  if (result.isError()) {
+    return Error("Failed to open '" + path + "': " + result.error());
+  }
+
+  if (fd.isSome()) {
+    os::close(fd.get());
+  }
+
+  segments[id] = path;
+  fd = result.get();
+  size = 0;
+
+  return Nothing();
+}
+
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
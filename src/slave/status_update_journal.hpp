@@ -0,0 +1,201 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __SLAVE_STATUS_UPDATE_JOURNAL_HPP__
+#define __SLAVE_STATUS_UPDATE_JOURNAL_HPP__
+
+#include <stdint.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <mesos/mesos.hpp>
+#include <mesos/type_utils.hpp>
+
+#include <process/owned.hpp>
+
+#include <stout/bytes.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/hashset.hpp>
+#include <stout/lambda.hpp>
+#include <stout/nothing.hpp>
+#include <stout/option.hpp>
+#include <stout/try.hpp>
+#include <stout/uuid.hpp>
+
+#include "messages/messages.hpp"
+
+namespace mesos {
+namespace internal {
+namespace slave {
+
+// The journal of the (checkpointed) status update streams of an
+// agent. Rather than appending the updates and acknowledgements of
+// each task to its own 'task.updates' file, the status update manager
+// appends them to this journal, which multiplexes all the streams
+// into a sequence of segment files, so that recovering the streams
+// is a sequential scan of a few files.
+//
+// An in-memory index keeps track of the records of each stream, and
+// once the journal has grown to twice the size of the records that
+// need to be retained, it is compacted by writing those records to a
+// snapshot and deleting the preceding segments. A closed stream only
+// retains its last update (and its acknowledgement, if any), which is
+// all the agent needs to recover the state of the task, and it is
+// dropped altogether once the meta directory of its executor run has
+// been garbage collected.
+class StatusUpdateJournal
+{
+public:
+  // The size after which the last segment is closed and a new one
+  // is started.
+  static const Bytes MAX_SEGMENT_SIZE;
+
+  // The size below which the journal is never compacted.
+  static const Bytes MIN_COMPACTION_SIZE;
+
+  // The updates and acknowledgements of a stream, in the order in
+  // which they have been journaled.
+  struct Stream
+  {
+    ExecutorID executorId;
+    ContainerID containerId;
+    std::vector<StatusUpdate> updates;
+    hashset<UUID> acks;
+  };
+
+  // Reads the streams from the journal of the agent, without
+  // modifying the journal. Partially written records at the end of
+  // the journal are ignored.
+  static Try<hashmap<FrameworkID, hashmap<TaskID, Stream>>> read(
+      const std::string& rootDir,
+      const SlaveID& slaveId);
+
+  // Opens the journal of the agent (creating it if it does not exist
+  // yet), restoring the index and truncating any partially written
+  // record at the end of the journal.
+  static Try<process::Owned<StatusUpdateJournal>> open(
+      const std::string& rootDir,
+      const SlaveID& slaveId);
+
+  ~StatusUpdateJournal();
+
+  const SlaveID& slaveId() const { return slaveId_; }
+
+  // Appends the record to the stream of the task, (re-)opening the
+  // stream if needed. This compacts the journal if it has grown too
+  // large.
+  Try<Nothing> append(
+      const FrameworkID& frameworkId,
+      const TaskID& taskId,
+      const ExecutorID& executorId,
+      const ContainerID& containerId,
+      const StatusUpdateRecord& record);
+
+  // Closes the stream of the task, see above.
+  void close(const FrameworkID& frameworkId, const TaskID& taskId);
+
+  // Appends the records of the 'task.updates' file at 'path', as
+  // checkpointed by older agents, to the stream of the task and then
+  // removes the file. If migrating the file was interrupted before,
+  // the records that are in the journal already are not appended
+  // again.
+  Try<Nothing> migrate(
+      const FrameworkID& frameworkId,
+      const TaskID& taskId,
+      const ExecutorID& executorId,
+      const ContainerID& containerId,
+      const std::string& path);
+
+  // Writes the records that need to be retained to a snapshot and
+  // deletes the preceding segments.
+  Try<Nothing> compact();
+
+private:
+  struct Location
+  {
+    uint64_t segment;
+    off_t offset;
+    size_t size;
+  };
+
+  struct Index
+  {
+    ExecutorID executorId;
+    ContainerID containerId;
+
+    // The locations of the records of the stream. Once the stream has
+    // been closed and the journal compacted, this only contains the
+    // records that get retained.
+    std::vector<Location> records;
+
+    // The location (and the UUID) of the last update, the location of
+    // its acknowledgement, if any, and the location of the record
+    // that closed the stream, if it is closed.
+    Option<Location> last;
+    std::string uuid;
+    Option<Location> ack;
+    Option<Location> closed;
+  };
+
+  StatusUpdateJournal(const std::string& rootDir, const SlaveID& slaveId);
+
+  // Calls 'f' with each record in the journal at 'directory' and its
+  // location, starting from the last snapshot. Returns the segments
+  // that were read and, if 'truncate' is set, truncates a partially
+  // written record at the end of the last segment.
+  static Try<std::map<uint64_t, std::string>> replay(
+      const std::string& directory,
+      bool truncate,
+      const lambda::function<void(
+          const StatusUpdateJournalRecord&, const Location&)>& f);
+
+  // Adds the record to the index.
+  void index(const StatusUpdateJournalRecord& record, const Location& location);
+
+  // Returns the size of the records of the stream that need to be
+  // retained.
+  static size_t retained(const Index& index);
+
+  // Closes the last segment, if any, and starts a new one.
+  Try<Nothing> roll();
+
+  const std::string rootDir;
+  const SlaveID slaveId_;
+  const std::string directory;
+
+  // The segments (and the snapshot), by increasing identifier. The
+  // last segment is the one being appended to.
+  std::map<uint64_t, std::string> segments;
+
+  // The file descriptor and the size of the last segment.
+  Option<int> fd;
+  size_t size;
+
+  hashmap<FrameworkID, hashmap<TaskID, Index>> streams;
+
+  // The size of the journal and of the records that need to be
+  // retained.
+  size_t total;
+  size_t live;
+};
+
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __SLAVE_STATUS_UPDATE_JOURNAL_HPP__
@@ -14,8 +14,12 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <string>
+#include <vector>
+
 #include <process/delay.hpp>
 #include <process/id.hpp>
+#include <process/owned.hpp>
 #include <process/process.hpp>
 #include <process/timer.hpp>
 
@@ -40,15 +44,18 @@
 #include "slave/flags.hpp"
 #include "slave/slave.hpp"
 #include "slave/state.hpp"
+#include "slave/status_update_journal.hpp"
 #include "slave/status_update_manager.hpp"
 
 using lambda::function;
 
 using std::string;
+using std::vector;
 
 using process::wait; // Necessary on some OS's to disambiguate.
 using process::Failure;
 using process::Future;
+using process::Owned;
 using process::PID;
 using process::Timeout;
 using process::UPID;
@@ -92,6 +99,9 @@ public:
       const FrameworkID& frameworkId,
       const UUID& uuid);
 
+  vector<Future<bool>> acknowledgements(
+      const StatusUpdateAcknowledgementsMessage& message);
+
   Future<Nothing> recover(
       const string& rootDir,
       const Option<SlaveState>& state);
@@ -121,8 +131,12 @@ private:
 
   // Helper functions.
 
-  // Creates a new status update stream (opening the updates file, if path is
-  // present) and adds it to streams.
+  // Opens the status update journal of the agent, unless it is
+  // already open.
+  Try<Nothing> openJournal(const SlaveID& slaveId);
+
+  // Creates a new status update stream (checkpointing it to the
+  // journal, if 'checkpoint' is set) and adds it to streams.
   StatusUpdateStream* createStatusUpdateStream(
       const TaskID& taskId,
       const FrameworkID& frameworkId,
@@ -145,6 +159,9 @@ private:
   function<void(StatusUpdate)> forward_;
 
   hashmap<FrameworkID, hashmap<TaskID, StatusUpdateStream*>> streams;
+
+  // The journal that the checkpointed streams are written to.
+  Owned<StatusUpdateJournal> journal;
 };
 
 
@@ -206,6 +223,11 @@ Future<Nothing> StatusUpdateManagerProcess::recover(
     return Nothing();
   }
 
+  Try<Nothing> open = openJournal(state->id);
+  if (open.isError()) {
+    return Failure(open.error());
+  }
+
   foreachvalue (const FrameworkState& framework, state.get().frameworks) {
     foreachvalue (const ExecutorState& executor, framework.executors) {
       LOG(INFO) << "Recovering executor '" << executor.id
@@ -252,6 +274,23 @@ Future<Nothing> StatusUpdateManagerProcess::recover(
           continue;
         }
 
+        // Move the updates checkpointed by an older agent to the
+        // journal, which the stream is checkpointed to from now on.
+        const string path = paths::getTaskUpdatesPath(
+            rootDir, state->id, framework.id, executor.id, latest, task.id);
+
+        if (os::exists(path)) {
+          Try<Nothing> migrate = journal->migrate(
+              framework.id, task.id, executor.id, latest, path);
+
+          if (migrate.isError()) {
+            return Failure(
+                  "Failed to migrate status updates for task " +
+                stringify(task.id) + " of framework " +
+                stringify(framework.id) + ": " + migrate.error());
+          }
+        }
+
         // Create a new status update stream.
         StatusUpdateStream* stream = createStatusUpdateStream(
             task.id, framework.id, state.get().id, true, executor.id, latest);
@@ -326,6 +365,13 @@ Future<Nothing> StatusUpdateManagerProcess::_update(
   // Create/Get the status update stream for this task.
   StatusUpdateStream* stream = getStatusUpdateStream(taskId, frameworkId);
   if (stream == nullptr) {
+    if (checkpoint) {
+      Try<Nothing> open = openJournal(slaveId);
+      if (open.isError()) {
+        return Failure(open.error());
+      }
+    }
+
     stream = createStatusUpdateStream(
         taskId, frameworkId, slaveId, checkpoint, executorId, containerId);
   }
@@ -460,6 +506,24 @@ Future<bool> StatusUpdateManagerProcess::acknowledgement(
 }
 
 
+vector<Future<bool>> StatusUpdateManagerProcess::acknowledgements(
+    const StatusUpdateAcknowledgementsMessage& message)
+{
+  vector<Future<bool>> results;
+  results.reserve(message.acknowledgements_size());
+
+  foreach (const StatusUpdateAcknowledgementMessage& acknowledgement,
+           message.acknowledgements()) {
+    results.push_back(StatusUpdateManagerProcess::acknowledgement(
+        acknowledgement.task_id(),
+        acknowledgement.framework_id(),
+        UUID::fromBytes(acknowledgement.uuid()).get()));
+  }
+
+  return results;
+}
+
+
 // TODO(vinod): There should be a limit on the retries.
 void StatusUpdateManagerProcess::timeout(const Duration& duration)
 {
@@ -489,6 +553,26 @@ void StatusUpdateManagerProcess::timeout(const Duration& duration)
 }
 
 
+Try<Nothing> StatusUpdateManagerProcess::openJournal(const SlaveID& slaveId)
+{
+  if (journal.get() != nullptr && journal->slaveId() == slaveId) {
+    return Nothing();
+  }
+
+  Try<Owned<StatusUpdateJournal>> open =
+    StatusUpdateJournal::open(paths::getMetaRootDir(flags.work_dir), slaveId);
+
+  if (open.isError()) {
+    return Error(
+        "Failed to open the status update journal: " + open.error());
+  }
+
+  journal = open.get();
+
+  return Nothing();
+}
+
+
 StatusUpdateStream* StatusUpdateManagerProcess::createStatusUpdateStream(
     const TaskID& taskId,
     const FrameworkID& frameworkId,
@@ -500,8 +584,17 @@ StatusUpdateStream* StatusUpdateManagerProcess::createStatusUpdateStream(
   VLOG(1) << "Creating StatusUpdate stream for task " << taskId
           << " of framework " << frameworkId;
 
+  // NOTE: The journal is opened before creating a checkpointed stream.
+  CHECK(!checkpoint || journal.get() != nullptr);
+
   StatusUpdateStream* stream = new StatusUpdateStream(
-      taskId, frameworkId, slaveId, flags, checkpoint, executorId, containerId);
+      taskId,
+      frameworkId,
+      slaveId,
+      checkpoint ? journal.get() : nullptr,
+      checkpoint,
+      executorId,
+      containerId);
 
   streams[frameworkId][taskId] = stream;
   return stream;
@@ -540,6 +633,11 @@ void StatusUpdateManagerProcess::cleanupStatusUpdateStream(
 
   StatusUpdateStream* stream = streams[frameworkId][taskId];
 
+  if (stream->checkpoint) {
+    CHECK_NOTNULL(journal.get());
+    journal->close(frameworkId, taskId);
+  }
+
   streams[frameworkId].erase(taskId);
   if (streams[frameworkId].empty()) {
     streams.erase(frameworkId);
@@ -613,6 +711,16 @@ Future<bool> StatusUpdateManager::acknowledgement(
 }
 
 
+Future<vector<Future<bool>>> StatusUpdateManager::acknowledgements(
+    const StatusUpdateAcknowledgementsMessage& message)
+{
+  return dispatch(
+      process,
+      &StatusUpdateManagerProcess::acknowledgements,
+      message);
+}
+
+
 Future<Nothing> StatusUpdateManager::recover(
     const string& rootDir,
     const Option<SlaveState>& state)
@@ -644,68 +752,24 @@ StatusUpdateStream::StatusUpdateStream(
     const TaskID& _taskId,
     const FrameworkID& _frameworkId,
     const SlaveID& _slaveId,
-    const Flags& _flags,
+    StatusUpdateJournal* _journal,
     bool _checkpoint,
-    const Option<ExecutorID>& executorId,
-    const Option<ContainerID>& containerId)
+    const Option<ExecutorID>& _executorId,
+    const Option<ContainerID>& _containerId)
     : checkpoint(_checkpoint),
       terminated(false),
       taskId(_taskId),
       frameworkId(_frameworkId),
       slaveId(_slaveId),
-      flags(_flags),
+      journal(_journal),
+      executorId(_executorId),
+      containerId(_containerId),
       error(None())
 {
   if (checkpoint) {
+    CHECK_NOTNULL(journal);
     CHECK_SOME(executorId);
     CHECK_SOME(containerId);
-
-    path = paths::getTaskUpdatesPath(
-        paths::getMetaRootDir(flags.work_dir),
-        slaveId,
-        frameworkId,
-        executorId.get(),
-        containerId.get(),
-        taskId);
-
-    // Create the base updates directory, if it doesn't exist.
-    Try<Nothing> directory = os::mkdir(Path(path.get()).dirname());
-    if (directory.isError()) {
-      error = "Failed to create " + Path(path.get()).dirname();
-      return;
-    }
-
-    // Open the updates file.
-    // NOTE: We don't use `O_SYNC` here because we only read this file
-    // if the host did not crash. `os::write` success implies the kernel
-    // will have flushed our data to the page cache. This is sufficient
-    // for the recovery scenarios we use this data for.
-    Try<int> result = os::open(
-        path.get(),
-        O_CREAT | O_WRONLY | O_APPEND | O_CLOEXEC,
-        S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
-
-    if (result.isError()) {
-      error = "Failed to open '" + path.get() + "' for status updates";
-      return;
-    }
-
-    // We keep the file open through the lifetime of the task, because it
-    // makes it easy to append status update records to the file.
-    fd = result.get();
-  }
-}
-
-
-StatusUpdateStream::~StatusUpdateStream()
-{
-  if (fd.isSome()) {
-    Try<Nothing> close = os::close(fd.get());
-    if (close.isError()) {
-      CHECK_SOME(path);
-      LOG(ERROR) << "Failed to close file '" << path.get() << "': "
-                 << close.error();
-    }
   }
 }
 
@@ -831,8 +895,6 @@ Try<Nothing> StatusUpdateStream::handle(
   if (checkpoint) {
     LOG(INFO) << "Checkpointing " << type << " for status update " << update;
 
-    CHECK_SOME(fd);
-
     StatusUpdateRecord record;
     record.set_type(type);
 
@@ -842,10 +904,12 @@ Try<Nothing> StatusUpdateStream::handle(
       record.set_uuid(update.uuid());
     }
 
-    Try<Nothing> write = ::protobuf::write(fd.get(), record);
+    Try<Nothing> write = journal->append(
+        frameworkId, taskId, executorId.get(), containerId.get(), record);
+
     if (write.isError()) {
-      error = "Failed to write status update " + stringify(update) +
-              " to '" + path.get() + "': " + write.error();
+      error = "Failed to journal status update " + stringify(update) +
+              ": " + write.error();
       return Error(error.get());
     }
   }
@@ -19,6 +19,7 @@
 
 #include <queue>
 #include <string>
+#include <vector>
 
 #include <mesos/mesos.hpp>
 
@@ -46,6 +47,7 @@ namespace state {
 struct SlaveState;
 }
 
+class StatusUpdateJournal;
 class StatusUpdateManagerProcess;
 struct StatusUpdateStream;
 
@@ -98,6 +100,12 @@ public:
       const FrameworkID& frameworkId,
       const UUID& uuid);
 
+  // Handles many acknowledgements at once. Returns the result of
+  // each acknowledgement (see above), in the order of the
+  // acknowledgements in the message.
+  process::Future<std::vector<process::Future<bool>>> acknowledgements(
+      const StatusUpdateAcknowledgementsMessage& message);
+
   // Recover status updates.
   process::Future<Nothing> recover(
       const std::string& rootDir,
@@ -124,7 +132,8 @@ private:
 
 
 // StatusUpdateStream handles the status updates and acknowledgements
-// of a task, checkpointing them if necessary. It also holds the information
+// of a task, checkpointing them to the status update journal of the
+// agent if necessary. It also holds the information
 // about received, acknowledged and pending status updates.
 // NOTE: A task is expected to have a globally unique ID across the lifetime
 // of a framework. In other words the tuple (taskId, frameworkId) should be
@@ -134,12 +143,10 @@ struct StatusUpdateStream
   StatusUpdateStream(const TaskID& _taskId,
                      const FrameworkID& _frameworkId,
                      const SlaveID& _slaveId,
-                     const Flags& _flags,
+                     StatusUpdateJournal* _journal,
                      bool _checkpoint,
-                     const Option<ExecutorID>& executorId,
-                     const Option<ContainerID>& containerId);
-
-  ~StatusUpdateStream();
+                     const Option<ExecutorID>& _executorId,
+                     const Option<ContainerID>& _containerId);
 
   // This function handles the update, checkpointing if necessary.
   // @return   True if the update is successfully handled.
@@ -191,14 +198,15 @@ private:
   const FrameworkID frameworkId;
   const SlaveID slaveId;
 
-  const Flags flags;
+  // The journal that the stream is checkpointed to, if any.
+  StatusUpdateJournal* journal;
+
+  const Option<ExecutorID> executorId;
+  const Option<ContainerID> containerId;
 
   hashset<UUID> received;
   hashset<UUID> acknowledged;
 
-  Option<std::string> path; // File path of the update stream.
-  Option<int> fd; // File descriptor to the update stream.
-
   Option<std::string> error; // Potential non-retryable error.
 };
 
@@ -0,0 +1,215 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <list>
+
+#include <boost/circular_buffer.hpp>
+
+#include <glog/logging.h>
+
+#include <mesos/type_utils.hpp>
+
+#include <process/collect.hpp>
+#include <process/defer.hpp>
+#include <process/delay.hpp>
+#include <process/dispatch.hpp>
+#include <process/id.hpp>
+#include <process/process.hpp>
+
+#include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/hashset.hpp>
+#include <stout/lambda.hpp>
+#include <stout/nothing.hpp>
+
+#include "slave/usage_collector.hpp"
+
+#include "slave/containerizer/containerizer.hpp"
+
+using std::list;
+
+using process::Future;
+using process::Process;
+
+namespace mesos {
+namespace internal {
+namespace slave {
+
+class UsageCollectorProcess : public Process<UsageCollectorProcess>
+{
+public:
+  UsageCollectorProcess(
+      Containerizer* _containerizer,
+      const Duration& _interval,
+      size_t _history,
+      const lambda::function<void(
+          const ContainerID&, const ResourceStatistics&)>& _sampled)
+    : ProcessBase(process::ID::generate("usage-collector")),
+      containerizer(_containerizer),
+      interval(_interval),
+      history_(_history),
+      sampled(_sampled) {}
+
+  virtual ~UsageCollectorProcess() {}
+
+  Future<ResourceStatistics> usage(const ContainerID& containerId)
+  {
+    if (samples.contains(containerId)) {
+      return samples.at(containerId).back();
+    }
+
+    return containerizer->usage(containerId);
+  }
+
+  Future<list<ResourceStatistics>> history(const ContainerID& containerId)
+  {
+    if (samples.contains(containerId)) {
+      return list<ResourceStatistics>(
+          samples.at(containerId).begin(),
+          samples.at(containerId).end());
+    }
+
+    return containerizer->usage(containerId)
+      .then([](const ResourceStatistics& statistics) {
+        return list<ResourceStatistics>({statistics});
+      });
+  }
+
+protected:
+  virtual void initialize()
+  {
+    if (interval > Duration::zero()) {
+      collect();
+    }
+  }
+
+private:
+  void collect()
+  {
+    containerizer->containers()
+      .then(defer(self(), &Self::_collect, lambda::_1))
+      .onAny(defer(self(), &Self::__collect, lambda::_1));
+  }
+
+  Future<Nothing> _collect(const hashset<ContainerID>& containerIds)
+  {
+    // Forget the containers that are gone.
+    foreach (const ContainerID& containerId, samples.keys()) {
+      if (!containerIds.contains(containerId)) {
+        samples.erase(containerId);
+      }
+    }
+
+    list<ContainerID> ids;
+    list<Future<ResourceStatistics>> futures;
+
+    foreach (const ContainerID& containerId, containerIds) {
+      ids.push_back(containerId);
+      futures.push_back(containerizer->usage(containerId));
+    }
+
+    return await(futures)
+      .then(defer(self(), [=](const list<Future<ResourceStatistics>>& futures) {
+        auto id = ids.begin();
+
+        foreach (const Future<ResourceStatistics>& future, futures) {
+          // A container can terminate while it is being sampled, in
+          // which case it is forgotten the next time we sample.
+          if (future.isReady()) {
+            if (!samples.contains(*id)) {
+              samples.put(
+                  *id,
+                  boost::circular_buffer<ResourceStatistics>(history_));
+            }
+
+            samples.at(*id).push_back(future.get());
+
+            if (sampled) {
+              sampled(*id, future.get());
+            }
+          } else {
+            VLOG(1) << "Failed to sample the resource usage of container "
+                    << *id << ": "
+                    << (future.isFailed() ? future.failure() : "discarded");
+          }
+
+          ++id;
+        }
+
+        return Nothing();
+      }));
+  }
+
+  void __collect(const Future<Nothing>& future)
+  {
+    if (!future.isReady()) {
+      LOG(WARNING) << "Failed to sample the resource usage of the containers: "
+                   << (future.isFailed() ? future.failure() : "discarded");
+    }
+
+    delay(interval, self(), &Self::collect);
+  }
+
+  Containerizer* containerizer;
+
+  const Duration interval;
+  const size_t history_;
+
+  const lambda::function<void(
+      const ContainerID&, const ResourceStatistics&)> sampled;
+
+  // The retained samples of each container, oldest first.
+  hashmap<ContainerID, boost::circular_buffer<ResourceStatistics>> samples;
+};
+
+
+UsageCollector::UsageCollector(
+    Containerizer* containerizer,
+    const Duration& interval,
+    size_t history,
+    const lambda::function<void(
+        const ContainerID&, const ResourceStatistics&)>& sampled)
+{
+  process = new UsageCollectorProcess(
+      containerizer, interval, history, sampled);
+  spawn(process);
+}
+
+
+UsageCollector::~UsageCollector()
+{
+  terminate(process);
+  wait(process);
+  delete process;
+}
+
+
+Future<ResourceStatistics> UsageCollector::usage(
+    const ContainerID& containerId)
+{
+  return dispatch(process, &UsageCollectorProcess::usage, containerId);
+}
+
+
+Future<list<ResourceStatistics>> UsageCollector::history(
+    const ContainerID& containerId)
+{
+  return dispatch(process, &UsageCollectorProcess::history, containerId);
+}
+
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
@@ -0,0 +1,83 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __SLAVE_USAGE_COLLECTOR_HPP__
+#define __SLAVE_USAGE_COLLECTOR_HPP__
+
+#include <stddef.h>
+
+#include <list>
+
+#include <mesos/mesos.hpp>
+
+#include <process/future.hpp>
+
+#include <stout/duration.hpp>
+#include <stout/lambda.hpp>
+
+namespace mesos {
+namespace internal {
+namespace slave {
+
+// Forward declarations.
+class Containerizer;
+class UsageCollectorProcess;
+
+
+// Samples the resource usage of all the containers of the agent every
+// 'interval', retaining the last 'history' samples of each container,
+// so that the consumers of the resource usage (e.g., the QoS
+// controller, the resource estimator and the HTTP endpoints) share
+// the samples rather than each reading the usage of every container
+// from the containerizer. The containers are sampled on demand if the
+// interval is zero. If set, 'sampled' is invoked with each sample
+// taken in the background (but not with the on demand samples).
+class UsageCollector
+{
+public:
+  UsageCollector(
+      Containerizer* containerizer,
+      const Duration& interval,
+      size_t history,
+      const lambda::function<void(
+          const ContainerID&, const ResourceStatistics&)>& sampled =
+        lambda::function<void(
+            const ContainerID&, const ResourceStatistics&)>());
+
+  ~UsageCollector();
+
+  // Returns the most recent sample of the container, sampling the
+  // container on demand if there is no sample of it (e.g., because
+  // it was launched after the last samples were taken).
+  process::Future<ResourceStatistics> usage(const ContainerID& containerId);
+
+  // Returns the retained samples of the container, oldest first, or
+  // an on demand sample if there are none.
+  process::Future<std::list<ResourceStatistics>> history(
+      const ContainerID& containerId);
+
+private:
+  UsageCollector(const UsageCollector&) = delete;
+  UsageCollector& operator=(const UsageCollector&) = delete;
+
+  UsageCollectorProcess* process;
+};
+
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __SLAVE_USAGE_COLLECTOR_HPP__
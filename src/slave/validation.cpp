@@ -20,6 +20,7 @@
 
 #include <mesos/agent/agent.hpp>
 
+#include <stout/foreach.hpp>
 #include <stout/stringify.hpp>
 #include <stout/unreachable.hpp>
 #include <stout/uuid.hpp>
@@ -305,6 +306,9 @@ Option<Error> validate(
 
       return None();
     }
+
+    case mesos::agent::Call::SUBSCRIBE:
+      return None();
   }
 
   UNREACHABLE();
@@ -316,6 +320,66 @@ Option<Error> validate(
 namespace executor {
 namespace call {
 
+// Validates one of the status updates sent with the call.
+static Option<Error> validate(
+    const mesos::executor::Call& call,
+    const mesos::executor::Call::Update& update)
+{
+  const TaskStatus& status = update.status();
+
+  if (!status.has_uuid()) {
+    return Error("Expecting 'uuid' to be present");
+  }
+
+  Try<UUID> uuid = UUID::fromBytes(status.uuid());
+  if (uuid.isError()) {
+    return uuid.error();
+  }
+
+  if (status.has_executor_id() &&
+      status.executor_id().value()
+      != call.executor_id().value()) {
+    return Error("ExecutorID in Call: " +
+                 call.executor_id().value() +
+                 " does not match ExecutorID in TaskStatus: " +
+                 status.executor_id().value()
+                 );
+  }
+
+  if (status.source() != TaskStatus::SOURCE_EXECUTOR) {
+    return Error("Received Call from executor " +
+                 call.executor_id().value() +
+                 " of framework " +
+                 call.framework_id().value() +
+                 " with invalid source, expecting 'SOURCE_EXECUTOR'"
+                 );
+  }
+
+  if (status.state() == TASK_STAGING) {
+    return Error("Received TASK_STAGING from executor " +
+                 call.executor_id().value() +
+                 " of framework " +
+                 call.framework_id().value() +
+                 " which is not allowed"
+                 );
+  }
+
+  // TODO(alexr): Validate `check_status` is present if
+  // the corresponding `TaskInfo.check` has been defined.
+
+  if (status.has_check_status()) {
+    Option<Error> validate =
+      checks::validation::checkStatusInfo(status.check_status());
+
+    if (validate.isSome()) {
+      return validate.get();
+    }
+  }
+
+  return None();
+}
+
+
 Option<Error> validate(const mesos::executor::Call& call)
 {
   if (!call.IsInitialized()) {
@@ -349,54 +413,19 @@ Option<Error> validate(const mesos::executor::Call& call)
         return Error("Expecting 'update' to be present");
       }
 
-      const TaskStatus& status = call.update().status();
-
-      if (!status.has_uuid()) {
-        return Error("Expecting 'uuid' to be present");
-      }
-
-      Try<UUID> uuid = UUID::fromBytes(status.uuid());
-      if (uuid.isError()) {
-        return uuid.error();
-      }
-
-      if (status.has_executor_id() &&
-          status.executor_id().value()
-          != call.executor_id().value()) {
-        return Error("ExecutorID in Call: " +
-                     call.executor_id().value() +
-                     " does not match ExecutorID in TaskStatus: " +
-                     call.update().status().executor_id().value()
-                     );
-      }
-
-      if (status.source() != TaskStatus::SOURCE_EXECUTOR) {
-        return Error("Received Call from executor " +
-                     call.executor_id().value() +
-                     " of framework " +
-                     call.framework_id().value() +
-                     " with invalid source, expecting 'SOURCE_EXECUTOR'"
-                     );
-      }
+      return validate(call, call.update());
+    }
 
-      if (status.state() == TASK_STAGING) {
-        return Error("Received TASK_STAGING from executor " +
-                     call.executor_id().value() +
-                     " of framework " +
-                     call.framework_id().value() +
-                     " which is not allowed"
-                     );
+    case mesos::executor::Call::UPDATES: {
+      if (!call.has_updates()) {
+        return Error("Expecting 'updates' to be present");
       }
 
-      // TODO(alexr): Validate `check_status` is present if
-      // the corresponding `TaskInfo.check` has been defined.
-
-      if (status.has_check_status()) {
-        Option<Error> validate =
-          checks::validation::checkStatusInfo(status.check_status());
-
-        if (validate.isSome()) {
-          return validate.get();
+      foreach (const mesos::executor::Call::Update& update,
+               call.updates().updates()) {
+        Option<Error> error = validate(call, update);
+        if (error.isSome()) {
+          return error;
         }
       }
 
@@ -37,7 +37,10 @@
 
 #include <stout/duration.hpp>
 #include <stout/error.hpp>
+#include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
 #include <stout/none.hpp>
+#include <stout/nothing.hpp>
 #include <stout/option.hpp>
 #include <stout/result.hpp>
 #include <stout/some.hpp>
@@ -91,12 +94,35 @@ public:
   void deleted(int64_t sessionId, const string& path);
 
 private:
+  // The contents of an entry's znode ('entry' is none if the znode
+  // does not exist) along with the version of the znode.
+  struct Node
+  {
+    Node(const Option<Entry>& _entry, int _version)
+      : entry(_entry), version(_version) {}
+
+    Option<Entry> entry;
+    int version;
+  };
+
+  // Performs the sets in 'batch' together in a single transaction.
+  void flush();
+
+  // Removes the cached node of the path (if any).
+  void invalidate(int64_t sessionId, const string& path);
+
   // Helpers for getting the names, fetching, and swapping.
   Result<std::set<string>> doNames();
   Result<Option<Entry>> doGet(const string& name);
   Result<bool> doSet(const Entry& entry, const UUID& uuid);
   Result<bool> doExpunge(const Entry& entry);
 
+  // Returns the node of the entry, from the cache if possible.
+  Result<Node> doFetch(const string& name);
+
+  // Creates the directory path znodes of 'znode' as necessary.
+  Result<Nothing> doCreateDirectory();
+
   const string servers;
 
   // The session timeout requested by the client.
@@ -158,6 +184,17 @@ private:
     queue<Expunge*> expunges;
   } pending;
 
+  // The sets that have been dispatched to us while connected, which
+  // we perform together once we have handled the dispatches that
+  // were already queued (see 'flush').
+  queue<Set*> batch;
+
+  // The nodes we have read, each of which has a watch set on its
+  // znode so that we remove it from the cache as soon as the znode
+  // changes. A node is also removed when we change it ourselves, as
+  // the watch for the change may still be on its way to us.
+  hashmap<string, Node> cache;
+
   Option<string> error;
 };
 
@@ -199,6 +236,7 @@ ZooKeeperStorageProcess::~ZooKeeperStorageProcess()
   fail(&pending.names, "No longer managing storage");
   fail(&pending.gets, "No longer managing storage");
   fail(&pending.sets, "No longer managing storage");
+  fail(&batch, "No longer managing storage");
 
   delete zk;
   delete watcher;
@@ -216,6 +254,10 @@ void ZooKeeperStorageProcess::initialize()
 
 Future<std::set<string>> ZooKeeperStorageProcess::names()
 {
+  // Perform the outstanding sets first, so that the result reflects
+  // them like it would have before they were batched.
+  flush();
+
   if (error.isSome()) {
     return Failure(error.get());
   } else if (state != CONNECTED) {
@@ -240,6 +282,10 @@ Future<std::set<string>> ZooKeeperStorageProcess::names()
 
 Future<Option<Entry>> ZooKeeperStorageProcess::get(const string& name)
 {
+  // Perform the outstanding sets first, so that the result reflects
+  // them like it would have before they were batched.
+  flush();
+
   if (error.isSome()) {
     return Failure(error.get());
   } else if (state != CONNECTED) {
@@ -266,28 +312,252 @@ Future<bool> ZooKeeperStorageProcess::set(const Entry& entry, const UUID& uuid)
 {
   if (error.isSome()) {
     return Failure(error.get());
-  } else if (state != CONNECTED) {
-    Set* set = new Set(entry, uuid);
-    pending.sets.push(set);
-    return set->promise.future();
   }
 
-  Result<bool> result = doSet(entry, uuid);
+  Set* set = new Set(entry, uuid);
 
-  if (result.isNone()) { // Try again later.
-    Set* set = new Set(entry, uuid);
+  if (state != CONNECTED) {
     pending.sets.push(set);
     return set->promise.future();
-  } else if (result.isError()) {
-    return Failure(result.error());
   }
 
-  return result.get();
+  // Any sets that get dispatched to us before the 'flush' will be
+  // part of the same transaction.
+  if (batch.empty()) {
+    dispatch(self(), &Self::flush);
+  }
+
+  batch.push(set);
+
+  return set->promise.future();
+}
+
+
+void ZooKeeperStorageProcess::flush()
+{
+  if (batch.empty()) {
+    return;
+  } else if (error.isSome()) {
+    fail(&batch, error.get());
+    return;
+  } else if (state != CONNECTED) {
+    while (!batch.empty()) {
+      pending.sets.push(batch.front());
+      batch.pop();
+    }
+    return;
+  }
+
+  // The sets in the transaction, along with the path and serialized
+  // entry of their znodes, and the version of the znodes (none if
+  // the znode needs to be created).
+  vector<Set*> sets;
+  vector<string> paths;
+  vector<string> datas;
+  vector<Option<int>> versions;
+
+  // Returns the sets of the transaction and the rest of the batch
+  // to the pending sets, to be performed once we are connected.
+  auto requeue = [&]() {
+    foreach (Set* set, sets) {
+      pending.sets.push(set);
+    }
+
+    while (!batch.empty()) {
+      pending.sets.push(batch.front());
+      batch.pop();
+    }
+  };
+
+  std::set<string> names;
+  size_t size = 0;
+  bool create = false;
+
+  while (!batch.empty()) {
+    Set* set = batch.front();
+
+    string data;
+
+    if (!set->entry.SerializeToString(&data)) {
+      set->promise.fail("Failed to serialize Entry");
+      batch.pop();
+      delete set;
+      continue;
+    }
+
+    if (data.size() > 1024 * 1024) { // 1 MB
+      set->promise.fail("Serialized data is too big (> 1 MB)");
+      batch.pop();
+      delete set;
+      continue;
+    }
+
+    // Each set is a compare-and-swap against the current version of
+    // the znode, so a transaction can only include one set of each
+    // entry. A transaction is also subject to the 1 MB limit.
+    if (names.count(set->entry.name()) > 0 ||
+        (!sets.empty() && size + data.size() > 1024 * 1024)) {
+      break;
+    }
+
+    Result<Node> node = doFetch(set->entry.name());
+
+    if (node.isNone()) { // Try again later.
+      requeue();
+      return;
+    }
+
+    batch.pop();
+
+    if (node.isError()) {
+      set->promise.fail(node.error());
+      delete set;
+      continue;
+    }
+
+    Option<int> version;
+
+    if (node->entry.isSome()) {
+      if (UUID::fromBytes(node->entry->uuid()).get() != set->uuid) {
+        set->promise.set(false);
+        delete set;
+        continue;
+      }
+
+      version = node->version;
+    }
+
+    names.insert(set->entry.name());
+    size += data.size();
+    create = create || version.isNone();
+
+    sets.push_back(set);
+    paths.push_back(znode + "/" + set->entry.name());
+    datas.push_back(data);
+    versions.push_back(version);
+  }
+
+  if (sets.size() == 1) {
+    // No need for a transaction, 'doSet' will use the cached node.
+    Result<bool> result = doSet(sets[0]->entry, sets[0]->uuid);
+
+    if (result.isNone()) { // Try again later.
+      requeue();
+      return;
+    } else if (result.isError()) {
+      sets[0]->promise.fail(result.error());
+    } else {
+      sets[0]->promise.set(result.get());
+    }
+
+    delete sets[0];
+  } else if (sets.size() > 1) {
+    if (create) {
+      Result<Nothing> directory = doCreateDirectory();
+
+      if (directory.isNone()) { // Try again later.
+        requeue();
+        return;
+      } else if (directory.isError()) {
+        // NOTE: We fail the whole batch to keep the order of the sets.
+        fail(&batch, directory.error());
+
+        foreach (Set* set, sets) {
+          set->promise.fail(directory.error());
+          delete set;
+        }
+        return;
+      }
+    }
+
+    vector<zoo_op_t> ops(sets.size());
+
+    for (size_t i = 0; i < sets.size(); i++) {
+      if (versions[i].isNone()) {
+        zoo_create_op_init(
+            &ops[i],
+            paths[i].c_str(),
+            datas[i].data(),
+            datas[i].size(),
+            &acl,
+            0,
+            nullptr,
+            0);
+      } else {
+        zoo_set_op_init(
+            &ops[i],
+            paths[i].c_str(),
+            datas[i].data(),
+            datas[i].size(),
+            versions[i].get(),
+            nullptr);
+      }
+    }
+
+    vector<zoo_op_result_t> results;
+
+    int code = zk->multi(ops, &results);
+
+    if (code == ZINVALIDSTATE || (code != ZOK && zk->retryable(code))) {
+      CHECK(zk->getState() != ZOO_AUTH_FAILED_STATE);
+      requeue(); // Try again later.
+      return;
+    }
+
+    // The sets that were only rolled back because another set in the
+    // transaction failed are retried in the next transaction.
+    queue<Set*> retries;
+
+    for (size_t i = 0; i < sets.size(); i++) {
+      Set* set = sets[i];
+
+      // We either changed the znode or our node is stale.
+      cache.erase(set->entry.name());
+
+      if (code == ZOK) {
+        set->promise.set(true);
+      } else if (results[i].err == ZBADVERSION ||
+                 results[i].err == ZNODEEXISTS ||
+                 results[i].err == ZNONODE) {
+        set->promise.set(false); // Lost a race with someone else.
+      } else if (results[i].err == ZOK ||
+                 results[i].err == ZRUNTIMEINCONSISTENCY) {
+        retries.push(set);
+        continue;
+      } else {
+        set->promise.fail(
+            "Failed to set '" + paths[i] +
+            "' in ZooKeeper: " + zk->message(results[i].err));
+      }
+
+      delete set;
+    }
+
+    // Don't retry forever if none of the sets caused the failure.
+    if (retries.size() == sets.size()) {
+      fail(&retries, "Failed to set in ZooKeeper: " + zk->message(code));
+    }
+
+    while (!batch.empty()) {
+      retries.push(batch.front());
+      batch.pop();
+    }
+
+    batch = retries;
+  }
+
+  if (!batch.empty()) {
+    dispatch(self(), &Self::flush);
+  }
 }
 
 
 Future<bool> ZooKeeperStorageProcess::expunge(const Entry& entry)
 {
+  // Perform the outstanding sets first, so that the result reflects
+  // them like it would have before they were batched.
+  flush();
+
   if (error.isSome()) {
     return Failure(error.get());
   } else if (state != CONNECTED) {
@@ -384,6 +654,10 @@ void ZooKeeperStorageProcess::reconnecting(int64_t sessionId)
   }
 
   state = CONNECTING;
+
+  // We might miss changes to the znodes until the watches have been
+  // set again after reconnecting, so we can't trust the cache.
+  cache.clear();
 }
 
 
@@ -395,6 +669,9 @@ void ZooKeeperStorageProcess::expired(int64_t sessionId)
 
   state = DISCONNECTED;
 
+  // The watches of the expired session are gone.
+  cache.clear();
+
   delete zk;
   zk = new ZooKeeper(servers, timeout, watcher);
 
@@ -404,19 +681,33 @@ void ZooKeeperStorageProcess::expired(int64_t sessionId)
 
 void ZooKeeperStorageProcess::updated(int64_t sessionId, const string& path)
 {
-  LOG(FATAL) << "Unexpected ZooKeeper event";
+  invalidate(sessionId, path);
 }
 
 
 void ZooKeeperStorageProcess::created(int64_t sessionId, const string& path)
 {
-  LOG(FATAL) << "Unexpected ZooKeeper event";
+  invalidate(sessionId, path);
 }
 
 
 void ZooKeeperStorageProcess::deleted(int64_t sessionId, const string& path)
 {
-  LOG(FATAL) << "Unexpected ZooKeeper event";
+  invalidate(sessionId, path);
+}
+
+
+void ZooKeeperStorageProcess::invalidate(
+    int64_t sessionId,
+    const string& path)
+{
+  if (sessionId != zk->getSessionId()) {
+    return;
+  }
+
+  if (strings::startsWith(path, znode + "/")) {
+    cache.erase(path.substr(znode.size() + 1));
+  }
 }
 
 
@@ -444,23 +735,57 @@ Result<std::set<string>> ZooKeeperStorageProcess::doNames()
 
 
 Result<Option<Entry>> ZooKeeperStorageProcess::doGet(const string& name)
+{
+  Result<Node> node = doFetch(name);
+
+  if (node.isNone()) {
+    return None(); // Try again later.
+  } else if (node.isError()) {
+    return Error(node.error());
+  }
+
+  return node->entry;
+}
+
+
+Result<ZooKeeperStorageProcess::Node> ZooKeeperStorageProcess::doFetch(
+    const string& name)
 {
   CHECK_NONE(error) << ": " << error.get();
   CHECK(state == CONNECTED);
 
+  if (cache.contains(name)) {
+    return cache.at(name);
+  }
+
+  const string path = znode + "/" + name;
+
   string result;
   Stat stat;
 
-  int code = zk->get(znode + "/" + name, false, &result, &stat);
+  // Set a watch so that we know when the cached node becomes stale.
+  int code = zk->get(path, true, &result, &stat);
+
+  if (code == ZNONODE) {
+    // NOTE: A get does not leave a watch on a znode that does not
+    // exist, but 'exists' does.
+    code = zk->exists(path, true, &stat);
+
+    if (code == ZOK) {
+      return doFetch(name); // The znode was just created, get it.
+    }
+  }
 
   if (code == ZNONODE) {
-    return Option<Entry>::none();
+    Node node(None(), -1);
+    cache.put(name, node);
+    return node;
   } else if (code == ZINVALIDSTATE || (code != ZOK && zk->retryable(code))) {
     CHECK(zk->getState() != ZOO_AUTH_FAILED_STATE);
     return None(); // Try again later.
   } else if (code != ZOK) {
     return Error(
-        "Failed to get '" + znode + "/" + name +
+        "Failed to get '" + path +
         "' in ZooKeeper: " + zk->message(code));
   }
 
@@ -472,7 +797,36 @@ Result<Option<Entry>> ZooKeeperStorageProcess::doGet(const string& name)
     return Error("Failed to deserialize Entry");
   }
 
-  return Some(entry);
+  Node node(entry, stat.version);
+  cache.put(name, node);
+  return node;
+}
+
+
+Result<Nothing> ZooKeeperStorageProcess::doCreateDirectory()
+{
+  CHECK(znode.size() == 0 || znode.at(znode.size() - 1) != '/');
+  size_t index = znode.find('/', 0);
+
+  while (index < string::npos) {
+    // Get out the prefix to create.
+    index = znode.find('/', index + 1);
+    string prefix = znode.substr(0, index);
+
+    // Create the znode (even if it already exists).
+    int code = zk->create(prefix, "", acl, 0, nullptr);
+
+    if (code == ZINVALIDSTATE || (code != ZOK && zk->retryable(code))) {
+      CHECK(zk->getState() != ZOO_AUTH_FAILED_STATE);
+      return None(); // Try again later.
+    } else if (code != ZOK && code != ZNODEEXISTS) {
+      return Error(
+          "Failed to create '" + prefix +
+          "' in ZooKeeper: " + zk->message(code));
+    }
+  }
+
+  return Nothing();
 }
 
 
@@ -494,36 +848,31 @@ Result<bool> ZooKeeperStorageProcess::doSet(const Entry& entry,
     return Error("Serialized data is too big (> 1 MB)");
   }
 
-  string result;
-  Stat stat;
+  Result<Node> node = doFetch(entry.name());
 
-  int code = zk->get(znode + "/" + entry.name(), false, &result, &stat);
+  if (node.isNone()) {
+    return None(); // Try again later.
+  } else if (node.isError()) {
+    return Error(node.error());
+  }
 
-  if (code == ZNONODE) {
+  int code;
+
+  if (node->entry.isNone()) {
     // Create directory path znodes as necessary.
-    CHECK(znode.size() == 0 || znode.at(znode.size() - 1) != '/');
-    size_t index = znode.find('/', 0);
-
-    while (index < string::npos) {
-      // Get out the prefix to create.
-      index = znode.find('/', index + 1);
-      string prefix = znode.substr(0, index);
-
-      // Create the znode (even if it already exists).
-      code = zk->create(prefix, "", acl, 0, nullptr);
-
-      if (code == ZINVALIDSTATE || (code != ZOK && zk->retryable(code))) {
-        CHECK(zk->getState() != ZOO_AUTH_FAILED_STATE);
-        return None(); // Try again later.
-      } else if (code != ZOK && code != ZNODEEXISTS) {
-        return Error(
-            "Failed to create '" + prefix +
-            "' in ZooKeeper: " + zk->message(code));
-      }
+    Result<Nothing> directory = doCreateDirectory();
+
+    if (directory.isNone()) {
+      return None(); // Try again later.
+    } else if (directory.isError()) {
+      return Error(directory.error());
     }
 
     code = zk->create(znode + "/" + entry.name(), data, acl, 0, nullptr);
 
+    // We either created the znode or our node is stale.
+    cache.erase(entry.name());
+
     if (code == ZNODEEXISTS) {
       return false; // Lost a race with someone else.
     } else if (code == ZINVALIDSTATE || (code != ZOK && zk->retryable(code))) {
@@ -536,31 +885,19 @@ Result<bool> ZooKeeperStorageProcess::doSet(const Entry& entry,
     }
 
     return true;
-  } else if (code == ZINVALIDSTATE || (code != ZOK && zk->retryable(code))) {
-    CHECK(zk->getState() != ZOO_AUTH_FAILED_STATE);
-    return None(); // Try again later.
-  } else if (code != ZOK) {
-    return Error(
-        "Failed to get '" + znode + "/" + entry.name() +
-        "' in ZooKeeper: " + zk->message(code));
   }
 
-  google::protobuf::io::ArrayInputStream stream(result.data(), result.size());
-
-  Entry current;
-
-  if (!current.ParseFromZeroCopyStream(&stream)) {
-    return Error("Failed to deserialize Entry");
-  }
-
-  if (UUID::fromBytes(current.uuid()).get() != uuid) {
+  if (UUID::fromBytes(node->entry->uuid()).get() != uuid) {
     return false;
   }
 
-  // Okay, do the set, we get atomicity by requiring 'stat.version'.
-  code = zk->set(znode + "/" + entry.name(), data, stat.version);
+  // Okay, do the set, we get atomicity by requiring the version.
+  code = zk->set(znode + "/" + entry.name(), data, node->version);
+
+  // We either changed the znode or our node is stale.
+  cache.erase(entry.name());
 
-  if (code == ZBADVERSION) {
+  if (code == ZBADVERSION || code == ZNONODE) {
     return false;
   } else if (code == ZINVALIDSTATE || (code != ZOK && zk->retryable(code))) {
     CHECK(zk->getState() != ZOO_AUTH_FAILED_STATE);
@@ -580,39 +917,30 @@ Result<bool> ZooKeeperStorageProcess::doExpunge(const Entry& entry)
   CHECK_NONE(error) << ": " << error.get();
   CHECK(state == CONNECTED);
 
-  string result;
-  Stat stat;
-
-  int code = zk->get(znode + "/" + entry.name(), false, &result, &stat);
+  Result<Node> node = doFetch(entry.name());
 
-  if (code == ZNONODE) {
-    return false;
-  } else if (code == ZINVALIDSTATE || (code != ZOK && zk->retryable(code))) {
-    CHECK(zk->getState() != ZOO_AUTH_FAILED_STATE);
+  if (node.isNone()) {
     return None(); // Try again later.
-  } else if (code != ZOK) {
-    return Error(
-        "Failed to get '" + znode + "/" + entry.name() +
-        "' in ZooKeeper: " + zk->message(code));
+  } else if (node.isError()) {
+    return Error(node.error());
   }
 
-  google::protobuf::io::ArrayInputStream stream(result.data(), result.size());
-
-  Entry current;
-
-  if (!current.ParseFromZeroCopyStream(&stream)) {
-    return Error("Failed to deserialize Entry");
+  if (node->entry.isNone()) {
+    return false;
   }
 
-  if (UUID::fromBytes(current.uuid()).get() !=
+  if (UUID::fromBytes(node->entry->uuid()).get() !=
       UUID::fromBytes(entry.uuid()).get()) {
     return false;
   }
 
-  // Okay, do the remove, we get atomicity by requiring 'stat.version'.
-  code = zk->remove(znode + "/" + entry.name(), stat.version);
+  // Okay, do the remove, we get atomicity by requiring the version.
+  int code = zk->remove(znode + "/" + entry.name(), node->version);
+
+  // We either removed the znode or our node is stale.
+  cache.erase(entry.name());
 
-  if (code == ZBADVERSION) {
+  if (code == ZBADVERSION || code == ZNONODE) {
     return false;
   } else if (code == ZINVALIDSTATE || (code != ZOK && zk->retryable(code))) {
     CHECK(zk->getState() != ZOO_AUTH_FAILED_STATE);
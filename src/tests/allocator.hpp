@@ -45,7 +45,7 @@ namespace tests {
 
 ACTION_P(InvokeInitialize, allocator)
 {
-  allocator->real->initialize(arg0, arg1, arg2, arg3, arg4);
+  allocator->real->initialize(arg0, arg1, arg2, arg3, arg4, arg5);
 }
 
 
@@ -229,9 +229,9 @@ public:
     // to get the best of both worlds: the ability to use 'DoDefault'
     // and no warnings when expectations are not explicit.
 
-    ON_CALL(*this, initialize(_, _, _, _, _))
+    ON_CALL(*this, initialize(_, _, _, _, _, _))
       .WillByDefault(InvokeInitialize(this));
-    EXPECT_CALL(*this, initialize(_, _, _, _, _))
+    EXPECT_CALL(*this, initialize(_, _, _, _, _, _))
       .WillRepeatedly(DoDefault());
 
     ON_CALL(*this, recover(_, _))
@@ -357,7 +357,7 @@ public:
 
   virtual ~TestAllocator() {}
 
-  MOCK_METHOD5(initialize, void(
+  MOCK_METHOD6(initialize, void(
       const Duration&,
       const lambda::function<
           void(const FrameworkID&,
@@ -366,7 +366,8 @@ public:
           void(const FrameworkID&,
                const hashmap<SlaveID, UnavailableResources>&)>&,
       const hashmap<std::string, double>&,
-      const Option<std::set<std::string>>&));
+      const Option<std::set<std::string>>&,
+      const mesos::allocator::Options&));
 
   MOCK_METHOD2(recover, void(
       const int expectedAgentCount,
@@ -450,6 +451,11 @@ public:
       const Resources&,
       const Option<Filters>& filters));
 
+  // NOTE: Recovering the resources on many agents at once is not
+  // mocked; the default implementation recovers the resources on each
+  // agent through the mocked method above.
+  using mesos::allocator::Allocator::recoverResources;
+
   MOCK_METHOD1(suppressOffers, void(
       const FrameworkID&));
 
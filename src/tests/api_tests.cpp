@@ -14,6 +14,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <map>
 #include <string>
 #include <tuple>
 
@@ -88,6 +89,7 @@ using process::Promise;
 
 using recordio::Decoder;
 
+using std::map;
 using std::string;
 using std::tuple;
 using std::vector;
@@ -929,7 +931,7 @@ TEST_P(MasterAPITest, ReserveResources)
 {
   TestAllocator<> allocator;
 
-  EXPECT_CALL(allocator, initialize(_, _, _, _, _));
+  EXPECT_CALL(allocator, initialize(_, _, _, _, _, _));
 
   // Set a low allocation interval to speed up this test.
   master::Flags flags = MesosTest::CreateMasterFlags();
@@ -1019,7 +1021,7 @@ TEST_P(MasterAPITest, UnreserveResources)
 {
   TestAllocator<> allocator;
 
-  EXPECT_CALL(allocator, initialize(_, _, _, _, _));
+  EXPECT_CALL(allocator, initialize(_, _, _, _, _, _));
 
   // Set a low allocation interval to speed up this test.
   master::Flags flags = MesosTest::CreateMasterFlags();
@@ -1464,6 +1466,125 @@ TEST_P(MasterAPITest, SubscribeAgentEvents)
 }
 
 
+// This test verifies that the events sent to a subscriber of the
+// 'api/v1' endpoint are filtered, and that a subscription can be
+// resumed from a sequence number instead of starting with a snapshot.
+TEST_P(MasterAPITest, SubscribeFilteredAndResumed)
+{
+  ContentType contentType = GetParam();
+
+  master::Flags masterFlags = CreateMasterFlags();
+  masterFlags.max_operator_event_history = 10;
+
+  Try<Owned<cluster::Master>> master = this->StartMaster(masterFlags);
+  ASSERT_SOME(master);
+
+  auto subscribe = [&](const v1::master::Call::Subscribe& subscribe) {
+    v1::master::Call v1Call;
+    v1Call.set_type(v1::master::Call::SUBSCRIBE);
+    v1Call.mutable_subscribe()->CopyFrom(subscribe);
+
+    http::Headers headers = createBasicAuthHeaders(DEFAULT_CREDENTIAL);
+
+    headers["Accept"] = stringify(contentType);
+
+    return http::streaming::post(
+        master.get()->pid,
+        "api/v1",
+        headers,
+        serialize(contentType, v1Call),
+        stringify(contentType));
+  };
+
+  auto deserializer =
+    lambda::bind(deserialize<v1::master::Event>, contentType, lambda::_1);
+
+  // Subscribe to the removal of agents only.
+  v1::master::Call::Subscribe removals;
+  removals.add_event_types(v1::master::Event::AGENT_REMOVED);
+
+  Future<http::Response> response = subscribe(removals);
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(http::OK().status, response);
+  ASSERT_EQ(http::Response::PIPE, response->type);
+  ASSERT_SOME(response->reader);
+
+  Reader<v1::master::Event> removalsDecoder(
+      Decoder<v1::master::Event>(deserializer), response->reader.get());
+
+  Future<Result<v1::master::Event>> event = removalsDecoder.read();
+  AWAIT_READY(event);
+
+  ASSERT_EQ(v1::master::Event::SUBSCRIBED, event->get().type());
+  EXPECT_FALSE(event->get().subscribed().resumed());
+  EXPECT_TRUE(event->get().subscribed().has_get_state());
+  EXPECT_EQ(0u, event->get().subscribed().sequence());
+
+  const string masterId = event->get().subscribed().master_id();
+
+  Future<Result<v1::master::Event>> removal = removalsDecoder.read();
+
+  // Start one agent, which results in an `AGENT_ADDED` event that the
+  // first subscriber is not interested in.
+  Future<SlaveRegisteredMessage> agentRegisteredMessage =
+    FUTURE_PROTOBUF(SlaveRegisteredMessage(), master.get()->pid, _);
+
+  Owned<MasterDetector> detector = master.get()->createDetector();
+  Try<Owned<cluster::Slave>> slave = StartSlave(detector.get());
+  ASSERT_SOME(slave);
+
+  AWAIT_READY(agentRegisteredMessage);
+
+  // Resume a subscription to the addition of agents from before the
+  // agent was added.
+  v1::master::Call::Subscribe additions;
+  additions.add_event_types(v1::master::Event::AGENT_ADDED);
+  additions.mutable_resume()->set_master_id(masterId);
+  additions.mutable_resume()->set_sequence(0);
+
+  response = subscribe(additions);
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(http::OK().status, response);
+  ASSERT_EQ(http::Response::PIPE, response->type);
+  ASSERT_SOME(response->reader);
+
+  Reader<v1::master::Event> additionsDecoder(
+      Decoder<v1::master::Event>(deserializer), response->reader.get());
+
+  event = additionsDecoder.read();
+  AWAIT_READY(event);
+
+  ASSERT_EQ(v1::master::Event::SUBSCRIBED, event->get().type());
+  EXPECT_TRUE(event->get().subscribed().resumed());
+  EXPECT_FALSE(event->get().subscribed().has_get_state());
+  EXPECT_EQ(0u, event->get().subscribed().sequence());
+
+  event = additionsDecoder.read();
+  AWAIT_READY(event);
+
+  ASSERT_EQ(v1::master::Event::AGENT_ADDED, event->get().type());
+  EXPECT_EQ(1u, event->get().sequence());
+  EXPECT_EQ(
+      evolve(agentRegisteredMessage->slave_id()),
+      event->get().agent_added().agent().agent_info().id());
+
+  EXPECT_TRUE(removal.isPending());
+
+  // Forcefully trigger a shutdown on the agent so that the master
+  // removes it, which only the first subscriber is interested in.
+  slave.get()->shutdown();
+  slave->reset();
+
+  AWAIT_READY(removal);
+
+  ASSERT_EQ(v1::master::Event::AGENT_REMOVED, removal->get().type());
+  EXPECT_EQ(2u, removal->get().sequence());
+
+  event = additionsDecoder.read();
+  EXPECT_TRUE(event.isPending());
+}
+
+
 // This test verifies that recovered but yet to reregister agents are returned
 // in `recovered_agents` field of `GetAgents` response.
 TEST_P_TEMP_DISABLED_ON_WINDOWS(MasterAPITest, GetRecoveredAgents)
@@ -2787,6 +2908,141 @@ TEST_P(AgentAPITest, GetContainers)
 }
 
 
+// This test verifies that a client subscribed to the agent receives
+// the state of the agent, followed by the events of the containers and
+// the tasks launched afterwards.
+TEST_P(AgentAPITest, Subscribe)
+{
+  ContentType contentType = GetParam();
+
+  Try<Owned<cluster::Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  MockExecutor exec(DEFAULT_EXECUTOR_ID);
+  TestContainerizer containerizer(&exec);
+  StandaloneMasterDetector detector(master.get()->pid);
+
+  Try<Owned<cluster::Slave>> slave = StartSlave(&detector, &containerizer);
+  ASSERT_SOME(slave);
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+      &sched, DEFAULT_FRAMEWORK_INFO, master.get()->pid, DEFAULT_CREDENTIAL);
+
+  EXPECT_CALL(sched, registered(_, _, _));
+  EXPECT_CALL(exec, registered(_, _, _, _));
+
+  Future<vector<Offer>> offers;
+  EXPECT_CALL(sched, resourceOffers(&driver, _))
+    .WillOnce(FutureArg<1>(&offers))
+    .WillRepeatedly(Return()); // Ignore subsequent offers.
+
+  driver.start();
+
+  AWAIT_READY(offers);
+  EXPECT_NE(0u, offers.get().size());
+
+  v1::agent::Call v1Call;
+  v1Call.set_type(v1::agent::Call::SUBSCRIBE);
+
+  http::Headers headers = createBasicAuthHeaders(DEFAULT_CREDENTIAL);
+  headers["Accept"] = stringify(contentType);
+
+  Future<http::Response> response = http::streaming::post(
+      slave.get()->pid,
+      "api/v1",
+      headers,
+      serialize(contentType, v1Call),
+      stringify(contentType));
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(http::OK().status, response);
+  AWAIT_EXPECT_RESPONSE_HEADER_EQ("chunked", "Transfer-Encoding", response);
+  ASSERT_EQ(http::Response::PIPE, response.get().type);
+  ASSERT_SOME(response->reader);
+
+  http::Pipe::Reader reader = response->reader.get();
+
+  auto deserializer =
+    lambda::bind(deserialize<v1::agent::Event>, contentType, lambda::_1);
+
+  Reader<v1::agent::Event> decoder(
+      Decoder<v1::agent::Event>(deserializer), reader);
+
+  Future<Result<v1::agent::Event>> event = decoder.read();
+  AWAIT_READY(event);
+  ASSERT_SOME(event.get());
+
+  // No task has been launched yet, so the agent does not know about
+  // any framework, executor or task.
+  EXPECT_EQ(v1::agent::Event::SUBSCRIBED, event.get().get().type());
+  const v1::agent::Response::GetState& getState =
+    event.get().get().subscribed().get_state();
+
+  EXPECT_EQ(0, getState.get_frameworks().frameworks_size());
+  EXPECT_EQ(0, getState.get_executors().executors_size());
+  EXPECT_EQ(0, getState.get_tasks().launched_tasks_size());
+
+  event = decoder.read();
+  EXPECT_TRUE(event.isPending());
+
+  const Offer& offer = offers.get()[0];
+
+  TaskInfo task = createTask(
+      offer.slave_id(),
+      Resources::parse("cpus:0.1;mem:32").get(),
+      "sleep 1000",
+      exec.id);
+
+  EXPECT_CALL(exec, launchTask(_, _))
+    .WillOnce(SendStatusUpdateFromTask(TASK_RUNNING));
+
+  Future<TaskStatus> status;
+  EXPECT_CALL(sched, statusUpdate(&driver, _))
+    .WillOnce(FutureArg<1>(&status));
+
+  driver.launchTasks(offer.id(), {task});
+
+  AWAIT_READY(status);
+  EXPECT_EQ(TASK_RUNNING, status.get().state());
+
+  // The container is launched concurrently with the registration of
+  // the executor, so we do not rely on the order of the events.
+  map<v1::agent::Event::Type, v1::agent::Event> events;
+
+  for (int i = 0; i < 3; i++) {
+    AWAIT_READY(event);
+    ASSERT_SOME(event.get());
+
+    events[event.get().get().type()] = event.get().get();
+
+    event = decoder.read();
+  }
+
+  ASSERT_EQ(1u, events.count(v1::agent::Event::CONTAINER_ADDED));
+  EXPECT_EQ(evolve(exec.id),
+            events.at(v1::agent::Event::CONTAINER_ADDED)
+              .container_added().executor_id());
+
+  ASSERT_EQ(1u, events.count(v1::agent::Event::TASK_ADDED));
+  EXPECT_EQ(evolve(task.task_id()),
+            events.at(v1::agent::Event::TASK_ADDED)
+              .task_added().task().task_id());
+
+  ASSERT_EQ(1u, events.count(v1::agent::Event::TASK_UPDATED));
+  EXPECT_EQ(v1::TASK_RUNNING,
+            events.at(v1::agent::Event::TASK_UPDATED)
+              .task_updated().state());
+
+  EXPECT_TRUE(event.isPending());
+
+  EXPECT_CALL(exec, shutdown(_))
+    .Times(AtMost(1));
+
+  driver.stop();
+  driver.join();
+}
+
+
 // This test verifies if we can retrieve file data in the agent.
 TEST_P(AgentAPITest, ReadFile)
 {
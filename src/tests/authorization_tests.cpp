@@ -24,8 +24,11 @@
 
 #include <mesos/module/authorizer.hpp>
 
+#include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
 #include <stout/try.hpp>
 
+#include "authorizer/caching/authorizer.hpp"
 #include "authorizer/local/authorizer.hpp"
 
 #include "tests/mesos.hpp"
@@ -39,6 +42,9 @@ namespace tests {
 
 using std::string;
 
+using testing::_;
+using testing::Return;
+
 
 template <typename T>
 class AuthorizationTest : public MesosTest {};
@@ -4086,6 +4092,144 @@ TYPED_TEST(AuthorizationTest, ViewRole)
   }
 }
 
+
+// This tests that an object approver, which is used to authorize many
+// objects for the same subject, honors the order of the ACLs.
+TYPED_TEST(AuthorizationTest, ObjectApproverFirstMatch)
+{
+  // Setup ACLs.
+  ACLs acls;
+
+  {
+    // "foo" principal can view roles "a" and "b".
+    mesos::ACL::ViewRole* acl = acls.add_view_roles();
+    acl->mutable_principals()->add_values("foo");
+    acl->mutable_roles()->add_values("a");
+    acl->mutable_roles()->add_values("b");
+  }
+
+  {
+    // "foo" principal cannot view any other role.
+    mesos::ACL::ViewRole* acl = acls.add_view_roles();
+    acl->mutable_principals()->add_values("foo");
+    acl->mutable_roles()->set_type(mesos::ACL::Entity::NONE);
+  }
+
+  {
+    // This is shadowed by the previous ACL for "foo".
+    mesos::ACL::ViewRole* acl = acls.add_view_roles();
+    acl->mutable_principals()->add_values("foo");
+    acl->mutable_roles()->add_values("c");
+  }
+
+  {
+    // Everyone else can view role "c" only.
+    mesos::ACL::ViewRole* acl = acls.add_view_roles();
+    acl->mutable_principals()->set_type(mesos::ACL::Entity::ANY);
+    acl->mutable_roles()->add_values("c");
+  }
+
+  acls.set_permissive(false);
+
+  // Create an `Authorizer` with the ACLs.
+  Try<Authorizer*> create = TypeParam::create(parameterize(acls));
+  ASSERT_SOME(create);
+  Owned<Authorizer> authorizer(create.get());
+
+  authorization::Subject foo;
+  foo.set_value("foo");
+
+  authorization::Subject bar;
+  bar.set_value("bar");
+
+  Future<Owned<ObjectApprover>> fooApprover =
+    authorizer->getObjectApprover(foo, authorization::VIEW_ROLE);
+
+  Future<Owned<ObjectApprover>> barApprover =
+    authorizer->getObjectApprover(bar, authorization::VIEW_ROLE);
+
+  AWAIT_READY(fooApprover);
+  AWAIT_READY(barApprover);
+
+  hashmap<string, bool> fooExpected =
+    {{"a", true}, {"b", true}, {"c", false}, {"d", false}};
+
+  hashmap<string, bool> barExpected =
+    {{"a", false}, {"b", false}, {"c", true}, {"d", false}};
+
+  // Approve the roles twice through the same approvers to verify that
+  // the decisions don't change once made.
+  for (int i = 0; i < 2; i++) {
+    foreachpair (const string& role, bool expected, fooExpected) {
+      ObjectApprover::Object object;
+      object.value = &role;
+
+      Try<bool> approved = fooApprover.get()->approved(object);
+      ASSERT_SOME(approved);
+      EXPECT_EQ(expected, approved.get()) << role;
+    }
+
+    foreachpair (const string& role, bool expected, barExpected) {
+      ObjectApprover::Object object;
+      object.value = &role;
+
+      Try<bool> approved = barApprover.get()->approved(object);
+      ASSERT_SOME(approved);
+      EXPECT_EQ(expected, approved.get()) << role;
+    }
+  }
+}
+
+
+class CachingAuthorizerTest : public MesosTest {};
+
+
+// This tests that the caching authorizer reuses the decisions for
+// identical requests until they expire.
+TEST_F(CachingAuthorizerTest, CachedDecisions)
+{
+  MockAuthorizer* mock = new MockAuthorizer();
+
+  EXPECT_CALL(*mock, authorized(_))
+    .WillOnce(Return(true))
+    .WillOnce(Return(false))
+    .WillOnce(Return(true));
+
+  CachingAuthorizer authorizer(mock, Seconds(10), 10);
+
+  Clock::pause();
+
+  authorization::Request foo;
+  foo.set_action(authorization::VIEW_ROLE);
+  foo.mutable_subject()->set_value("principal");
+  foo.mutable_object()->set_value("foo");
+
+  authorization::Request bar = foo;
+  bar.mutable_object()->set_value("bar");
+
+  // The second authorization of role "foo" is served from the cache.
+  AWAIT_EXPECT_TRUE(authorizer.authorized(foo));
+  AWAIT_EXPECT_TRUE(authorizer.authorized(foo));
+
+  // A different object is not.
+  AWAIT_EXPECT_FALSE(authorizer.authorized(bar));
+
+  JSON::Object metrics = Metrics();
+  EXPECT_EQ(1u, metrics.values["authorizer/cache/hits"]);
+  EXPECT_EQ(2u, metrics.values["authorizer/cache/misses"]);
+
+  // The decision expires after the TTL, i.e., role "foo" is
+  // authorized again by the underlying authorizer.
+  Clock::advance(Seconds(10));
+
+  AWAIT_EXPECT_TRUE(authorizer.authorized(foo));
+
+  metrics = Metrics();
+  EXPECT_EQ(3u, metrics.values["authorizer/cache/misses"]);
+
+  Clock::resume();
+}
+
 } // namespace tests {
 } // namespace internal {
 } // namespace mesos {
@@ -223,6 +223,58 @@ TEST_F_TEMP_DISABLED_ON_WINDOWS(TarTest, GZIPChangeDirectory)
 }
 
 
+// Tests unarchiving a GZIP compressed archive read from a file
+// descriptor (i.e., the read end of a pipe the archive is streamed to).
+TEST_F_TEMP_DISABLED_ON_WINDOWS(TarTest, GZIPStream)
+{
+  // Create a test file.
+  const Path testFile("testfile");
+  ASSERT_SOME(createTestFile(testFile));
+
+  // Archive the test file.
+  const Path outputTarFile("test.tar.gz");
+  AWAIT_ASSERT_READY(command::tar(
+      testFile,
+      outputTarFile,
+      None(),
+      command::Compression::GZIP));
+
+  ASSERT_TRUE(os::exists(outputTarFile));
+
+  Try<string> archive = os::read(outputTarFile);
+  ASSERT_SOME(archive);
+
+  // Remove the test file to make sure untar process creates new test file.
+  ASSERT_SOME(os::rm(testFile));
+  ASSERT_FALSE(os::exists(testFile));
+
+  int pipes[2];
+  ASSERT_NE(-1, ::pipe(pipes));
+
+  // NOTE: The write end must not leak into `tar`, which would then
+  // never see EOF.
+  ASSERT_SOME(os::cloexec(pipes[0]));
+  ASSERT_SOME(os::cloexec(pipes[1]));
+  ASSERT_SOME(os::nonblock(pipes[1]));
+
+  const Path outputDir("output");
+  ASSERT_SOME(os::mkdir(outputDir));
+
+  Future<Nothing> untar = command::untar(
+      pipes[0],
+      outputDir,
+      command::Compression::GZIP);
+
+  // Stream the archive to `tar`.
+  AWAIT_ASSERT_READY(process::io::write(pipes[1], archive.get()));
+  ASSERT_SOME(os::close(pipes[1]));
+
+  // Verify that the original file is created in the output directory.
+  AWAIT_ASSERT_READY(untar);
+  EXPECT_SOME_EQ("test", os::read(path::join(outputDir, testFile)));
+}
+
+
 class ShasumTest : public TemporaryDirectoryTest {};
 
 
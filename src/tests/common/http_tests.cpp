@@ -21,8 +21,14 @@
 #include <mesos/mesos.hpp>
 #include <mesos/resources.hpp>
 
+#include <process/future.hpp>
+#include <process/gtest.hpp>
+#include <process/http.hpp>
+
+#include <stout/foreach.hpp>
 #include <stout/gtest.hpp>
 #include <stout/json.hpp>
+#include <stout/jsonify.hpp>
 
 #include "common/http.hpp"
 #include "common/protobuf_utils.hpp"
@@ -32,8 +38,11 @@
 using namespace mesos;
 using namespace mesos::internal;
 
+using std::string;
 using std::vector;
 
+using process::Future;
+
 using mesos::internal::protobuf::createLabel;
 using mesos::internal::protobuf::createTask;
 
@@ -260,3 +269,67 @@ TEST(HTTP, SerializeNetworkInfo)
   ASSERT_SOME(expected);
   EXPECT_EQ(expected.get(), object);
 }
+
+
+// Tests that JSON responses are streamed in chunks unless the client
+// accepts a gzip compressed body.
+TEST(HTTP, StreamedJSONResponse)
+{
+  // Large enough to span several chunks.
+  vector<string> values(100000, "value");
+
+  auto writer = [&values](JSON::ArrayWriter* writer) {
+    foreach (const string& value, values) {
+      writer->element(value);
+    }
+  };
+
+  Try<JSON::Array> expected =
+    JSON::parse<JSON::Array>(string(jsonify(writer)));
+
+  ASSERT_SOME(expected);
+
+  process::http::Request request;
+
+  process::http::Response response = jsonResponse(request, jsonify(writer));
+
+  ASSERT_EQ(process::http::Response::PIPE, response.type);
+  ASSERT_SOME(response.reader);
+  EXPECT_SOME_EQ("application/json", response.headers.get("Content-Type"));
+
+  Future<string> body = response.reader->readAll();
+  AWAIT_ASSERT_READY(body);
+
+  EXPECT_SOME_EQ(expected.get(), JSON::parse<JSON::Array>(body.get()));
+
+  request.headers["Accept-Encoding"] = "gzip";
+
+  response = jsonResponse(request, jsonify(writer));
+
+  ASSERT_EQ(process::http::Response::BODY, response.type);
+  EXPECT_SOME_EQ(expected.get(), JSON::parse<JSON::Array>(response.body));
+}
+
+
+TEST(HTTP, FieldProjection)
+{
+  FieldProjection projection =
+    FieldProjection::parse("id,tasks.id,tasks.state,slaves");
+
+  EXPECT_FALSE(projection.selectsAll());
+  EXPECT_TRUE(projection.selects("id"));
+  EXPECT_TRUE(projection.selects("tasks"));
+  EXPECT_TRUE(projection.selects("slaves"));
+  EXPECT_FALSE(projection.selects("frameworks"));
+
+  EXPECT_TRUE(projection.at("id").selectsAll());
+  EXPECT_TRUE(projection.at("slaves").selectsAll());
+
+  const FieldProjection& tasks = projection.at("tasks");
+  EXPECT_FALSE(tasks.selectsAll());
+  EXPECT_TRUE(tasks.selects("id"));
+  EXPECT_TRUE(tasks.selects("state"));
+  EXPECT_FALSE(tasks.selects("labels"));
+
+  EXPECT_TRUE(FieldProjection::parse("").selectsAll());
+}
@@ -14,22 +14,34 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <iostream>
 #include <ostream>
 #include <string>
+#include <vector>
 
 #include <gtest/gtest.h>
 
+#include <mesos/v1/resources.hpp>
+
+#include <mesos/v1/scheduler/scheduler.hpp>
+
 #include <process/gtest.hpp>
 
+#include <stout/foreach.hpp>
 #include <stout/recordio.hpp>
 #include <stout/result.hpp>
+#include <stout/stopwatch.hpp>
+#include <stout/stringify.hpp>
 #include <stout/strings.hpp>
 
 #include "common/recordio.hpp"
 
 using process::Future;
 
+using std::cout;
+using std::endl;
 using std::string;
+using std::vector;
 
 using namespace mesos;
 using namespace mesos::internal;
@@ -161,6 +173,165 @@ TEST(RecordIOReaderTest, PipeFailure)
 }
 
 
+TEST(RecordIOReaderTest, ReadAll)
+{
+  ::recordio::Encoder<string> encoder(strings::upper);
+
+  string data;
+
+  data += encoder.encode("hello");
+  data += encoder.encode("world!");
+  data += encoder.encode("foo");
+
+  process::http::Pipe pipe;
+  pipe.writer().write(data);
+
+  mesos::internal::recordio::Reader<string> reader(
+      ::recordio::Decoder<string>(strings::lower),
+      pipe.reader());
+
+  // All the records of a chunk are decoded at once, so that the
+  // remaining records are available once the first one is read.
+  AWAIT_EXPECT_EQ(Result<string>::some("hello"), reader.read());
+
+  Future<vector<Result<string>>> records = reader.readAll();
+  AWAIT_READY(records);
+  ASSERT_EQ(2u, records->size());
+  EXPECT_EQ(Result<string>::some("world!"), records->at(0));
+  EXPECT_EQ(Result<string>::some("foo"), records->at(1));
+
+  // Reading all the records waits for the next record if none
+  // are available.
+  records = reader.readAll();
+  EXPECT_TRUE(records.isPending());
+
+  pipe.writer().write(encoder.encode("goodbye"));
+
+  AWAIT_READY(records);
+  ASSERT_EQ(1u, records->size());
+  EXPECT_EQ(Result<string>::some("goodbye"), records->at(0));
+
+  pipe.writer().close();
+
+  records = reader.readAll();
+  AWAIT_READY(records);
+  ASSERT_EQ(1u, records->size());
+  EXPECT_EQ(Result<string>::none(), records->at(0));
+}
+
+
+// This benchmark measures the throughput of reading a large number of
+// scheduler events (e.g., when a master sends offers for many agents
+// at once), one at a time and in batches.
+TEST(RecordIOReader_BENCHMARK_Test, Events)
+{
+  using mesos::v1::Offer;
+  using mesos::v1::Resources;
+  using mesos::v1::scheduler::Event;
+
+  const size_t totalEvents = 10000;
+
+  Offer offer;
+  offer.mutable_id()->set_value("offer");
+  offer.mutable_framework_id()->set_value("framework");
+  offer.mutable_agent_id()->set_value("agent");
+  offer.set_hostname("hostname");
+  offer.mutable_resources()->CopyFrom(
+      Resources::parse("cpus:8;mem:16384;disk:65536;ports:[31000-32000]")
+        .get());
+
+  Event event;
+  event.set_type(Event::OFFERS);
+  event.mutable_offers()->add_offers()->CopyFrom(offer);
+
+  ::recordio::Encoder<Event> encoder(
+      [](const Event& event) { return event.SerializeAsString(); });
+
+  auto deserialize = [](const string& data) -> Try<Event> {
+    Event event;
+    if (!event.ParseFromString(data)) {
+      return Error("Failed to parse event");
+    }
+    return event;
+  };
+
+  string data;
+  for (size_t i = 0; i < totalEvents; i++) {
+    data += encoder.encode(event);
+  }
+
+  {
+    process::http::Pipe pipe;
+    pipe.writer().write(data);
+    pipe.writer().close();
+
+    mesos::internal::recordio::Reader<Event> reader(
+        ::recordio::Decoder<Event>(deserialize),
+        pipe.reader());
+
+    Stopwatch watch;
+    watch.start();
+
+    size_t count = 0;
+    while (true) {
+      Future<Result<Event>> record = reader.read();
+      AWAIT_READY(record);
+
+      if (record->isNone()) {
+        break;
+      }
+
+      ASSERT_SOME(record.get());
+      ++count;
+    }
+
+    watch.stop();
+
+    EXPECT_EQ(totalEvents, count);
+
+    cout << "Took " << watch.elapsed() << " to read " << count
+         << " events one at a time" << endl;
+  }
+
+  {
+    process::http::Pipe pipe;
+    pipe.writer().write(data);
+    pipe.writer().close();
+
+    mesos::internal::recordio::Reader<Event> reader(
+        ::recordio::Decoder<Event>(deserialize),
+        pipe.reader());
+
+    Stopwatch watch;
+    watch.start();
+
+    size_t count = 0;
+    bool done = false;
+    while (!done) {
+      Future<vector<Result<Event>>> records = reader.readAll();
+      AWAIT_READY(records);
+
+      foreach (const Result<Event>& record, records.get()) {
+        if (record.isNone()) {
+          done = true;
+          break;
+        }
+
+        ASSERT_SOME(record);
+        ++count;
+      }
+    }
+
+    watch.stop();
+
+    EXPECT_EQ(totalEvents, count);
+
+    cout << "Took " << watch.elapsed() << " to read " << count
+         << " events in batches" << endl;
+  }
+}
+
+
 // This test verifies that when an EOF is received by the `writer` used
 // in `transform`, the future returned to the caller is satisfied.
 TEST(RecordIOTransformTest, EndOfFile)
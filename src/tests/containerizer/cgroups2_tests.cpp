@@ -0,0 +1,155 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <signal.h>
+#include <unistd.h>
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+
+#include <process/gtest.hpp>
+#include <process/reap.hpp>
+
+#include <stout/bytes.hpp>
+#include <stout/gtest.hpp>
+#include <stout/os.hpp>
+#include <stout/path.hpp>
+
+#include "linux/cgroups2.hpp"
+
+#include "tests/mesos.hpp" // For TEST_CGROUPS(2_HIERARCHY|_ROOT).
+#include "tests/utils.hpp"
+
+using namespace process;
+
+using std::set;
+using std::string;
+using std::vector;
+
+namespace mesos {
+namespace internal {
+namespace tests {
+
+
+class Cgroups2Test : public TemporaryDirectoryTest
+{
+protected:
+  virtual void SetUp()
+  {
+    TemporaryDirectoryTest::SetUp();
+
+    // Clean up the testing cgroup, in case it wasn't cleaned up
+    // properly from previous tests.
+    if (os::exists(path::join(TEST_CGROUPS2_HIERARCHY, TEST_CGROUPS_ROOT))) {
+      AWAIT_READY(
+          cgroups2::destroy(TEST_CGROUPS2_HIERARCHY, TEST_CGROUPS_ROOT));
+    }
+  }
+
+  virtual void TearDown()
+  {
+    if (os::exists(path::join(TEST_CGROUPS2_HIERARCHY, TEST_CGROUPS_ROOT))) {
+      AWAIT_READY(
+          cgroups2::destroy(TEST_CGROUPS2_HIERARCHY, TEST_CGROUPS_ROOT));
+    }
+
+    TemporaryDirectoryTest::TearDown();
+  }
+};
+
+
+// Tests that the processes in a cgroup and its nested cgroups are
+// killed, and that the cgroups are removed.
+TEST_F(Cgroups2Test, ROOT_CGROUPS2_Destroy)
+{
+  const string cgroup = path::join(TEST_CGROUPS_ROOT, "nested");
+
+  ASSERT_SOME(cgroups2::create(TEST_CGROUPS2_HIERARCHY, cgroup, true));
+
+  pid_t pid = ::fork();
+  ASSERT_NE(-1, pid);
+
+  if (pid == 0) {
+    // In child process, wait for kill signal.
+    while (true) { sleep(1); }
+
+    // Should not reach here.
+    ABORT("Failure waiting to be killed");
+  }
+
+  Future<Option<int>> status = process::reap(pid);
+
+  ASSERT_SOME(cgroups2::assign(TEST_CGROUPS2_HIERARCHY, cgroup, pid));
+
+  Try<set<pid_t>> pids = cgroups2::processes(TEST_CGROUPS2_HIERARCHY, cgroup);
+  ASSERT_SOME(pids);
+  EXPECT_EQ(1u, pids->count(pid));
+
+  Try<vector<string>> cgroups =
+    cgroups2::get(TEST_CGROUPS2_HIERARCHY, TEST_CGROUPS_ROOT);
+
+  ASSERT_SOME(cgroups);
+  ASSERT_EQ(vector<string>({cgroup, TEST_CGROUPS_ROOT}), cgroups.get());
+
+  AWAIT_READY(cgroups2::destroy(TEST_CGROUPS2_HIERARCHY, TEST_CGROUPS_ROOT));
+
+  AWAIT_EXPECT_WTERMSIG_EQ(SIGKILL, status);
+
+  EXPECT_FALSE(
+      os::exists(path::join(TEST_CGROUPS2_HIERARCHY, TEST_CGROUPS_ROOT)));
+}
+
+
+TEST_F(Cgroups2Test, ROOT_CGROUPS2_MemoryMax)
+{
+  Try<set<string>> controllers =
+    cgroups2::controllers(TEST_CGROUPS2_HIERARCHY);
+
+  ASSERT_SOME(controllers);
+
+  if (controllers->count("memory") == 0) {
+    LOG(WARNING) << "Skipping test as the memory controller is not available";
+    return;
+  }
+
+  ASSERT_SOME(cgroups2::enable(TEST_CGROUPS2_HIERARCHY, "", {"memory"}));
+  ASSERT_SOME(cgroups2::create(TEST_CGROUPS2_HIERARCHY, TEST_CGROUPS_ROOT));
+
+  // There is no limit initially.
+  Try<Option<Bytes>> limit =
+    cgroups2::memory::max(TEST_CGROUPS2_HIERARCHY, TEST_CGROUPS_ROOT);
+
+  ASSERT_SOME(limit);
+  EXPECT_NONE(limit.get());
+
+  ASSERT_SOME(cgroups2::memory::max(
+      TEST_CGROUPS2_HIERARCHY,
+      TEST_CGROUPS_ROOT,
+      Megabytes(64)));
+
+  limit = cgroups2::memory::max(TEST_CGROUPS2_HIERARCHY, TEST_CGROUPS_ROOT);
+
+  ASSERT_SOME(limit);
+  EXPECT_SOME_EQ(Megabytes(64), limit.get());
+}
+
+} // namespace tests {
+} // namespace internal {
+} // namespace mesos {
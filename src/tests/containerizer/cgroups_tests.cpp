@@ -16,6 +16,7 @@
 
 #include <assert.h>
 #include <errno.h>
+#include <sched.h>
 #include <signal.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -46,6 +47,7 @@
 #include <stout/os.hpp>
 #include <stout/path.hpp>
 #include <stout/proc.hpp>
+#include <stout/stopwatch.hpp>
 #include <stout/stringify.hpp>
 #include <stout/strings.hpp>
 
@@ -552,6 +554,44 @@ TEST_F(CgroupsAnyHierarchyWithCpuAcctMemoryTest, ROOT_CGROUPS_Stat)
 }
 
 
+// Tests that a 'cgroups::Reader' reads the current contents of the
+// control files each time they are read, although they are kept open.
+TEST_F(CgroupsAnyHierarchyWithCpuAcctMemoryTest, ROOT_CGROUPS_Reader)
+{
+  cgroups::Reader reader(path::join(baseHierarchy, "cpuacct"), "/");
+
+  EXPECT_ERROR(reader.stat("invalid"));
+
+  Try<hashmap<string, uint64_t>> first = reader.stat("cpuacct.stat");
+  ASSERT_SOME(first);
+  EXPECT_TRUE(first->contains("user"));
+  EXPECT_TRUE(first->contains("system"));
+
+  // The root cgroup accumulates the cpu time of the whole system, so
+  // reading it again until it changes also burns the needed cpu time.
+  Try<uint64_t> usage = reader.value("cpuacct.usage");
+  ASSERT_SOME(usage);
+
+  Stopwatch stopwatch;
+  stopwatch.start();
+
+  Try<uint64_t> next = reader.value("cpuacct.usage");
+  while (next.isSome() &&
+         next.get() == usage.get() &&
+         stopwatch.elapsed() < Seconds(1)) {
+    next = reader.value("cpuacct.usage");
+  }
+
+  ASSERT_SOME(next);
+  EXPECT_GT(next.get(), usage.get());
+
+  Try<hashmap<string, uint64_t>> second = reader.stat("cpuacct.stat");
+  ASSERT_SOME(second);
+  EXPECT_GE(second->get("user").get(), first->get("user").get());
+  EXPECT_GE(second->get("system").get(), first->get("system").get());
+}
+
+
 TEST_F(CgroupsAnyHierarchyWithCpuMemoryTest, ROOT_CGROUPS_Listen)
 {
   string hierarchy = path::join(baseHierarchy, "memory");
@@ -814,6 +854,91 @@ TEST_F(CgroupsAnyHierarchyWithFreezerTest, ROOT_CGROUPS_Destroy)
 }
 
 
+// Tests that the processes of nested cgroups that are in their own pid
+// namespace are killed through the init process of the namespace.
+TEST_F(CgroupsAnyHierarchyWithFreezerTest, ROOT_CGROUPS_DestroyPidNamespace)
+{
+  int pipes[2];
+  int dummy;
+  ASSERT_NE(-1, ::pipe(pipes));
+
+  string hierarchy = path::join(baseHierarchy, "freezer");
+  string nested = path::join(TEST_CGROUPS_ROOT, "nested");
+  ASSERT_SOME(cgroups::create(hierarchy, nested, true));
+
+  pid_t pid = ::fork();
+  ASSERT_NE(-1, pid);
+
+  if (pid == 0) {
+    // In child process.
+    ::close(pipes[0]);
+
+    // The next child of this process is the init process of a new pid
+    // namespace. This process stays outside of the test cgroups until
+    // the init process is killed.
+    if (::unshare(CLONE_NEWPID) != 0) {
+      perror("Failed to create a pid namespace");
+      abort();
+    }
+
+    pid_t init = ::fork();
+    if (init == -1) {
+      perror("Failed to fork the init process");
+      abort();
+    } else if (init > 0) {
+      ::close(pipes[1]);
+      ::waitpid(init, nullptr, 0);
+      ::_exit(EXIT_SUCCESS);
+    }
+
+    // Put the init process into the test cgroup and another process
+    // of the namespace into the nested cgroup.
+    ::fork();
+
+    Try<Nothing> assign = cgroups::assign(
+        hierarchy,
+        ::getpid() == 1 ? TEST_CGROUPS_ROOT : nested,
+        ::getpid());
+
+    if (assign.isError()) {
+      std::cerr << "Failed to assign cgroup: " << assign.error() << std::endl;
+      abort();
+    }
+
+    // Notify the parent.
+    if (::write(pipes[1], &dummy, sizeof(dummy)) != sizeof(dummy)) {
+      perror("Failed to notify the parent");
+      abort();
+    }
+    ::close(pipes[1]);
+
+    // Wait kill signal from parent.
+    while (true) {}
+
+    // Should not reach here.
+    std::cerr << "Reach an unreachable statement!" << std::endl;
+    abort();
+  }
+
+  // In parent process.
+  ::close(pipes[1]);
+
+  // Wait until all processes of the namespace have assigned the cgroups.
+  ASSERT_LT(0, ::read(pipes[0], &dummy, sizeof(dummy)));
+  ASSERT_LT(0, ::read(pipes[0], &dummy, sizeof(dummy)));
+  ::close(pipes[0]);
+
+  AWAIT_READY(cgroups::destroy(hierarchy, TEST_CGROUPS_ROOT));
+
+  EXPECT_FALSE(os::exists(path::join(hierarchy, TEST_CGROUPS_ROOT)));
+
+  // The child exits once the init process of its namespace is gone.
+  int status;
+  EXPECT_EQ(pid, ::waitpid(pid, &status, 0));
+  EXPECT_WEXITSTATUS_EQ(EXIT_SUCCESS, status);
+}
+
+
 TEST_F(CgroupsAnyHierarchyWithFreezerTest, ROOT_CGROUPS_AssignThreads)
 {
   const size_t numThreads = 5;
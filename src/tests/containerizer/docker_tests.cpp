@@ -18,16 +18,26 @@
 #include <string>
 #include <vector>
 
+#include <gmock/gmock.h>
+
 #include <gtest/gtest.h>
 
+#include <process/defer.hpp>
+#include <process/dispatch.hpp>
 #include <process/future.hpp>
+#include <process/gmock.hpp>
 #include <process/gtest.hpp>
+#include <process/http.hpp>
 #include <process/owned.hpp>
+#include <process/process.hpp>
+#include <process/socket.hpp>
 #include <process/subprocess.hpp>
 
 #include <stout/duration.hpp>
 #include <stout/option.hpp>
 #include <stout/gtest.hpp>
+#include <stout/lambda.hpp>
+#include <stout/path.hpp>
 
 #include "docker/docker.hpp"
 
@@ -43,6 +53,10 @@ using std::list;
 using std::string;
 using std::vector;
 
+using testing::_;
+using testing::DoAll;
+using testing::Return;
+
 namespace mesos {
 namespace internal {
 namespace tests {
@@ -632,6 +646,242 @@ TEST_F(DockerTest, ROOT_DOCKER_MountRelativeHostPathRelativeContainerPath)
 }
 
 
+// A fake Docker daemon, which serves the requests sent to its unix
+// socket with the responses that the tests expect on `handle`.
+class MockDockerDaemon : public Process<MockDockerDaemon>
+{
+public:
+  explicit MockDockerDaemon(const network::unix::Socket& _server)
+    : server(_server) {}
+
+  MOCK_METHOD1(handle, Future<http::Response>(const http::Request&));
+
+protected:
+  virtual void initialize()
+  {
+    accept();
+  }
+
+private:
+  void accept()
+  {
+    server.accept()
+      .onAny(defer(self(), &Self::_accept, lambda::_1));
+  }
+
+  void _accept(const Future<network::unix::Socket>& socket)
+  {
+    if (!socket.isReady()) {
+      return;
+    }
+
+    const PID<MockDockerDaemon> pid = self();
+
+    http::serve(socket.get(), [pid](const http::Request& request) {
+      return dispatch(pid, &MockDockerDaemon::handle, request);
+    });
+
+    accept();
+  }
+
+  network::unix::Socket server;
+};
+
+
+// Tests the use of the Docker Engine API against a fake Docker daemon,
+// i.e., that the documented response codes of each endpoint (and only
+// those) are treated as a success.
+class DockerEngineTest : public MesosTest
+{
+protected:
+  virtual void SetUp()
+  {
+    MesosTest::SetUp();
+
+    const string socket = path::join(sandbox.get(), "docker.sock");
+
+    Try<network::unix::Address> address =
+      network::unix::Address::create(socket);
+
+    ASSERT_SOME(address);
+
+    Try<network::unix::Socket> server = network::unix::Socket::create();
+    ASSERT_SOME(server);
+    ASSERT_SOME(server->bind(address.get()));
+    ASSERT_SOME(server->listen(16));
+
+    daemon.reset(new MockDockerDaemon(server.get()));
+    spawn(daemon.get());
+
+    Try<Owned<Docker>> create = Docker::create("docker", socket, false);
+    ASSERT_SOME(create);
+
+    docker = create.get();
+  }
+
+  virtual void TearDown()
+  {
+    docker.reset();
+
+    terminate(daemon.get());
+    wait(daemon.get());
+    daemon.reset();
+
+    MesosTest::TearDown();
+  }
+
+  Owned<MockDockerDaemon> daemon;
+  Owned<Docker> docker;
+};
+
+
+// Returns a response of the Docker daemon with an error message.
+static http::Response engineError(uint16_t code, const string& message)
+{
+  return http::Response(
+      "{\"message\": \"" + message + "\"}", code, "application/json");
+}
+
+
+TEST_F(DockerEngineTest, Stop)
+{
+  Future<http::Request> request;
+
+  EXPECT_CALL(*daemon, handle(_))
+    .WillOnce(DoAll(FutureArg<0>(&request),
+                    Return(http::Response(http::Status::NO_CONTENT))))
+    .WillOnce(Return(http::Response(http::Status::NOT_MODIFIED)))
+    .WillOnce(Return(
+        engineError(http::Status::NOT_FOUND, "No such container")))
+    .WillOnce(Return(http::OK()));
+
+  AWAIT_READY(docker->stop("container", Seconds(10)));
+
+  AWAIT_READY(request);
+  EXPECT_EQ("POST", request->method);
+  EXPECT_EQ("/containers/container/stop", request->url.path);
+  EXPECT_SOME_EQ("10", request->url.query.get("t"));
+
+  // The container was not running.
+  AWAIT_READY(docker->stop("container", Seconds(10)));
+
+  AWAIT_FAILED(docker->stop("container", Seconds(10)));
+
+  // A response code that is not documented for the endpoint is not
+  // taken as a success.
+  AWAIT_FAILED(docker->stop("container", Seconds(10)));
+}
+
+
+TEST_F(DockerEngineTest, Kill)
+{
+  Future<http::Request> request;
+
+  EXPECT_CALL(*daemon, handle(_))
+    .WillOnce(DoAll(FutureArg<0>(&request),
+                    Return(http::Response(http::Status::NO_CONTENT))))
+    .WillOnce(Return(
+        engineError(http::Status::CONFLICT, "Container not running")))
+    .WillOnce(Return(http::Response(http::Status::NOT_MODIFIED)));
+
+  AWAIT_READY(docker->kill("container", SIGTERM));
+
+  AWAIT_READY(request);
+  EXPECT_EQ("POST", request->method);
+  EXPECT_EQ("/containers/container/kill", request->url.path);
+  EXPECT_SOME_EQ(stringify(SIGTERM), request->url.query.get("signal"));
+
+  AWAIT_FAILED(docker->kill("container", SIGTERM));
+  AWAIT_FAILED(docker->kill("container", SIGTERM));
+}
+
+
+TEST_F(DockerEngineTest, Remove)
+{
+  Future<http::Request> request;
+
+  EXPECT_CALL(*daemon, handle(_))
+    .WillOnce(DoAll(FutureArg<0>(&request),
+                    Return(http::Response(http::Status::NO_CONTENT))))
+    .WillOnce(Return(
+        engineError(http::Status::CONFLICT, "Container is running")))
+    .WillOnce(Return(http::OK()));
+
+  AWAIT_READY(docker->rm("container", true));
+
+  AWAIT_READY(request);
+  EXPECT_EQ("DELETE", request->method);
+  EXPECT_EQ("/containers/container", request->url.path);
+  EXPECT_SOME_EQ("1", request->url.query.get("force"));
+  EXPECT_SOME_EQ("1", request->url.query.get("v"));
+
+  AWAIT_FAILED(docker->rm("container", false));
+  AWAIT_FAILED(docker->rm("container", false));
+}
+
+
+TEST_F(DockerEngineTest, Inspect)
+{
+  const string container =
+    "{"
+    "  \"Id\": \"id\","
+    "  \"Name\": \"/container\","
+    "  \"State\": {"
+    "    \"Pid\": 1,"
+    "    \"StartedAt\": \"2016-01-01T00:00:00Z\""
+    "  },"
+    "  \"NetworkSettings\": {"
+    "    \"IPAddress\": \"\""
+    "  }"
+    "}";
+
+  Future<http::Request> request;
+
+  EXPECT_CALL(*daemon, handle(_))
+    .WillOnce(DoAll(FutureArg<0>(&request),
+                    Return(http::OK(container))))
+    .WillOnce(Return(
+        engineError(http::Status::NOT_FOUND, "No such container")))
+    .WillOnce(Return(http::Response(container, http::Status::CREATED)));
+
+  Future<Docker::Container> inspect = docker->inspect("container");
+
+  AWAIT_READY(inspect);
+  EXPECT_EQ("id", inspect->id);
+  EXPECT_SOME_EQ(1, inspect->pid);
+
+  AWAIT_READY(request);
+  EXPECT_EQ("GET", request->method);
+  EXPECT_EQ("/containers/container/json", request->url.path);
+
+  AWAIT_FAILED(docker->inspect("container"));
+  AWAIT_FAILED(docker->inspect("container"));
+}
+
+
+TEST_F(DockerEngineTest, List)
+{
+  Future<http::Request> request;
+
+  EXPECT_CALL(*daemon, handle(_))
+    .WillOnce(DoAll(FutureArg<0>(&request),
+                    Return(http::OK("[]"))))
+    .WillOnce(Return(http::Response(http::Status::NO_CONTENT)));
+
+  Future<list<Docker::Container>> containers = docker->ps(true);
+
+  AWAIT_READY(containers);
+  EXPECT_TRUE(containers->empty());
+
+  AWAIT_READY(request);
+  EXPECT_EQ("GET", request->method);
+  EXPECT_EQ("/containers/json", request->url.path);
+  EXPECT_SOME_EQ("1", request->url.query.get("all"));
+
+  AWAIT_FAILED(docker->ps(true));
+}
+
+
 class DockerImageTest : public MesosTest {};
 
 
@@ -669,7 +669,7 @@ TEST_F(DockerVolumeIsolatorTest, ROOT_CommandTaskNoRootfsSlaveRecovery)
 
 // This test verifies that a single docker volumes can be used by
 // multiple containers, and the docker volume isolator will mount
-// the single volume to multiple containers when running tasks and
+// the volume only once for all the containers when running tasks and
 // the docker volume isolator will call unmount only once when cleanup
 // the last container that is using the volume.
 TEST_F(DockerVolumeIsolatorTest,
@@ -757,10 +757,10 @@ TEST_F(DockerVolumeIsolatorTest,
 
   task2.mutable_container()->CopyFrom(containerInfo2);
 
-  // The mount operation will be called multiple times as there are
-  // two containers using the same volume.
+  // Expect the mount was called only once because two containers
+  // sharing one volume.
   EXPECT_CALL(*mockClient, mount(driver1, _, _))
-    .WillRepeatedly(Return(mountPoint1));
+    .WillOnce(Return(mountPoint1));
 
   // Expect the unmount was called only once because two containers
   // sharing one volume.
@@ -855,6 +855,180 @@ TEST_F(MesosContainerizerDestroyTest, DestroyWhilePreparing)
 }
 
 
+// The built-in isolators are prepared concurrently, and destroying a
+// mesos containerizer while it is preparing should wait until all of
+// them are finished preparing before destroying.
+TEST_F(MesosContainerizerDestroyTest, DestroyWhilePreparingConcurrently)
+{
+  slave::Flags flags = CreateSlaveFlags();
+  flags.launcher = "posix";
+
+  Try<Launcher*> launcher_ = PosixLauncher::create(flags);
+  ASSERT_SOME(launcher_);
+
+  Owned<Launcher> launcher(launcher_.get());
+
+  MockIsolator* isolator1 = new MockIsolator();
+  MockIsolator* isolator2 = new MockIsolator();
+
+  Future<Nothing> prepare1;
+  Future<Nothing> prepare2;
+  Promise<Option<ContainerLaunchInfo>> promise1;
+  Promise<Option<ContainerLaunchInfo>> promise2;
+
+  // Simulate long prepares from both isolators.
+  EXPECT_CALL(*isolator1, prepare(_, _))
+    .WillOnce(DoAll(FutureSatisfy(&prepare1),
+                    Return(promise1.future())));
+
+  EXPECT_CALL(*isolator2, prepare(_, _))
+    .WillOnce(DoAll(FutureSatisfy(&prepare2),
+                    Return(promise2.future())));
+
+  Fetcher fetcher;
+
+  Try<Owned<Provisioner>> provisioner = Provisioner::create(flags);
+  ASSERT_SOME(provisioner);
+
+  Try<MesosContainerizer*> _containerizer = MesosContainerizer::create(
+      flags,
+      true,
+      &fetcher,
+      launcher,
+      provisioner->share(),
+      {Owned<Isolator>(isolator1), Owned<Isolator>(isolator2)},
+      {"posix/cpu", "posix/mem"});
+
+  ASSERT_SOME(_containerizer);
+
+  Owned<MesosContainerizer> containerizer(_containerizer.get());
+
+  ContainerID containerId;
+  containerId.set_value(UUID::random().toString());
+
+  TaskInfo taskInfo;
+  CommandInfo commandInfo;
+  taskInfo.mutable_command()->MergeFrom(commandInfo);
+
+  containerizer->launch(
+      containerId,
+      taskInfo,
+      createExecutorInfo("executor", "exit 0"),
+      os::getcwd(),
+      None(),
+      SlaveID(),
+      map<string, string>(),
+      false);
+
+  Future<Option<ContainerTermination>> wait =
+    containerizer->wait(containerId);
+
+  // Both isolators are preparing at the same time.
+  AWAIT_READY(prepare1);
+  AWAIT_READY(prepare2);
+
+  containerizer->destroy(containerId);
+
+  // The container should not exit until both prepares are complete.
+  promise1.set(Option<ContainerLaunchInfo>::none());
+
+  ASSERT_TRUE(wait.isPending());
+
+  promise2.set(Option<ContainerLaunchInfo>::none());
+
+  AWAIT_READY(wait);
+  ASSERT_SOME(wait.get());
+
+  ContainerTermination termination = wait->get();
+
+  EXPECT_FALSE(termination.has_status());
+}
+
+
+// This test verifies that the built-in isolators of a container are
+// cleaned up concurrently when the container is destroyed.
+TEST_F(MesosContainerizerDestroyTest, CleanupIsolatorsConcurrently)
+{
+  slave::Flags flags = CreateSlaveFlags();
+  flags.launcher = "posix";
+
+  Try<Launcher*> launcher_ = PosixLauncher::create(flags);
+  ASSERT_SOME(launcher_);
+
+  Owned<Launcher> launcher(launcher_.get());
+
+  MockIsolator* isolator1 = new MockIsolator();
+  MockIsolator* isolator2 = new MockIsolator();
+
+  Future<Nothing> cleanup1;
+  Future<Nothing> cleanup2;
+  Promise<Nothing> promise1;
+  Promise<Nothing> promise2;
+
+  // Simulate long cleanups from both isolators.
+  EXPECT_CALL(*isolator1, cleanup(_))
+    .WillOnce(DoAll(FutureSatisfy(&cleanup1),
+                    Return(promise1.future())));
+
+  EXPECT_CALL(*isolator2, cleanup(_))
+    .WillOnce(DoAll(FutureSatisfy(&cleanup2),
+                    Return(promise2.future())));
+
+  Fetcher fetcher;
+
+  Try<Owned<Provisioner>> provisioner = Provisioner::create(flags);
+  ASSERT_SOME(provisioner);
+
+  Try<MesosContainerizer*> _containerizer = MesosContainerizer::create(
+      flags,
+      true,
+      &fetcher,
+      launcher,
+      provisioner->share(),
+      {Owned<Isolator>(isolator1), Owned<Isolator>(isolator2)},
+      {"posix/cpu", "posix/mem"});
+
+  ASSERT_SOME(_containerizer);
+
+  Owned<MesosContainerizer> containerizer(_containerizer.get());
+
+  ContainerID containerId;
+  containerId.set_value(UUID::random().toString());
+
+  Future<bool> launch = containerizer->launch(
+      containerId,
+      None(),
+      createExecutorInfo("executor", "sleep 1000"),
+      os::getcwd(),
+      None(),
+      SlaveID(),
+      map<string, string>(),
+      false);
+
+  AWAIT_ASSERT_TRUE(launch);
+
+  Future<Option<ContainerTermination>> wait =
+    containerizer->wait(containerId);
+
+  containerizer->destroy(containerId);
+
+  // Both isolators are cleaning up at the same time.
+  AWAIT_READY(cleanup1);
+  AWAIT_READY(cleanup2);
+
+  // The container should not terminate until both cleanups are
+  // complete.
+  promise1.set(Nothing());
+
+  ASSERT_TRUE(wait.isPending());
+
+  promise2.set(Nothing());
+
+  AWAIT_READY(wait);
+  ASSERT_SOME(wait.get());
+}
+
+
 // Ensures the containerizer responds correctly (false Future) to
 // a request to destroy an unknown container.
 TEST_F(MesosContainerizerDestroyTest, DestroyUnknownContainer)
@@ -43,6 +43,8 @@
 #include "slave/containerizer/mesos/linux_launcher.hpp"
 #include "slave/containerizer/mesos/paths.hpp"
 
+#include "slave/state.hpp"
+
 #include "tests/environment.hpp"
 #include "tests/mesos.hpp"
 
@@ -50,6 +52,7 @@ using mesos::internal::slave::Fetcher;
 using mesos::internal::slave::MesosContainerizer;
 
 using mesos::internal::slave::containerizer::paths::buildPath;
+using mesos::internal::slave::containerizer::paths::getLauncherCgroupsPath;
 using mesos::internal::slave::containerizer::paths::JOIN;
 using mesos::internal::slave::containerizer::paths::PREFIX;
 using mesos::internal::slave::containerizer::paths::SUFFIX;
@@ -237,6 +240,81 @@ TEST_F(NestedMesosContainerizerTest, ROOT_CGROUPS_LaunchNested)
 }
 
 
+// This test verifies that containers (and nested containers) can be
+// launched through the fork server.
+TEST_F(NestedMesosContainerizerTest, ROOT_CGROUPS_LaunchNestedForkServer)
+{
+  slave::Flags flags = CreateSlaveFlags();
+  flags.launcher = "linux";
+  flags.launcher_fork_server = true;
+  flags.isolation = "cgroups/cpu,filesystem/linux,namespaces/pid";
+
+  Fetcher fetcher;
+
+  Try<MesosContainerizer*> create = MesosContainerizer::create(
+      flags,
+      false,
+      &fetcher);
+
+  ASSERT_SOME(create);
+
+  Owned<MesosContainerizer> containerizer(create.get());
+
+  SlaveState state;
+  state.id = SlaveID();
+
+  AWAIT_READY(containerizer->recover(state));
+
+  ContainerID containerId;
+  containerId.set_value(UUID::random().toString());
+
+  Try<string> directory = environment->mkdtemp();
+  ASSERT_SOME(directory);
+
+  Future<bool> launch = containerizer->launch(
+      containerId,
+      None(),
+      createExecutorInfo("executor", "sleep 1000", "cpus:1"),
+      directory.get(),
+      None(),
+      state.id,
+      map<string, string>(),
+      true);
+
+  AWAIT_ASSERT_TRUE(launch);
+
+  ContainerID nestedContainerId;
+  nestedContainerId.mutable_parent()->CopyFrom(containerId);
+  nestedContainerId.set_value(UUID::random().toString());
+
+  launch = containerizer->launch(
+      nestedContainerId,
+      createCommandInfo("exit 42"),
+      None(),
+      None(),
+      state.id);
+
+  AWAIT_ASSERT_TRUE(launch);
+
+  Future<Option<ContainerTermination>> wait = containerizer->wait(
+      nestedContainerId);
+
+  AWAIT_READY(wait);
+  ASSERT_SOME(wait.get());
+  ASSERT_TRUE(wait.get()->has_status());
+  EXPECT_WEXITSTATUS_EQ(42, wait.get()->status());
+
+  wait = containerizer->wait(containerId);
+
+  containerizer->destroy(containerId);
+
+  AWAIT_READY(wait);
+  ASSERT_SOME(wait.get());
+  ASSERT_TRUE(wait.get()->has_status());
+  EXPECT_WTERMSIG_EQ(SIGKILL, wait.get()->status());
+}
+
+
 TEST_F(NestedMesosContainerizerTest,
        ROOT_CGROUPS_LaunchNestedDebugCheckPidNamespace)
 {
@@ -1135,6 +1213,70 @@ TEST_F(NestedMesosContainerizerTest, ROOT_CGROUPS_RecoverLauncherOrphans)
 }
 
 
+// This test verifies that the freezer cgroup of a container which the
+// LinuxLauncher has not checkpointed is destroyed after recovery.
+TEST_F(NestedMesosContainerizerTest, ROOT_CGROUPS_RecoverUnknownLauncherOrphans)
+{
+  slave::Flags flags = CreateSlaveFlags();
+  flags.launcher = "linux";
+  flags.isolation = "cgroups/cpu,filesystem/linux,namespaces/pid";
+
+  Fetcher fetcher;
+
+  Try<MesosContainerizer*> create = MesosContainerizer::create(
+      flags,
+      false,
+      &fetcher);
+
+  ASSERT_SOME(create);
+
+  Owned<MesosContainerizer> containerizer(create.get());
+
+  Result<string> freezerHierarchy = cgroups::hierarchy("freezer");
+  ASSERT_SOME(freezerHierarchy);
+
+  ContainerID containerId;
+  containerId.set_value(UUID::random().toString());
+
+  const string cgroup = path::join(
+      flags.cgroups_root,
+      buildPath(containerId, "mesos", JOIN));
+
+  ASSERT_SOME(cgroups::create(freezerHierarchy.get(), cgroup, true));
+
+  // Checkpoint no cgroups so that the LinuxLauncher does not walk the
+  // freezer hierarchy during recovery.
+  ASSERT_SOME(slave::state::checkpoint(
+      getLauncherCgroupsPath(flags.runtime_dir),
+      ""));
+
+  SlaveState state;
+  state.id = SlaveID();
+
+  AWAIT_READY(containerizer->recover(state));
+
+  Future<hashset<ContainerID>> containers = containerizer->containers();
+  AWAIT_READY(containers);
+  ASSERT_FALSE(containers->contains(containerId));
+
+  // The cgroup is destroyed once the hierarchy has been walked.
+  Duration waited = Duration::zero();
+  do {
+    Try<bool> exists = cgroups::exists(freezerHierarchy.get(), cgroup);
+    ASSERT_SOME(exists);
+
+    if (!exists.get()) {
+      break;
+    }
+
+    os::sleep(Milliseconds(100));
+    waited += Milliseconds(100);
+  } while (waited < Seconds(15));
+
+  EXPECT_FALSE(cgroups::exists(freezerHierarchy.get(), cgroup).get());
+}
+
+
 TEST_F(NestedMesosContainerizerTest, ROOT_CGROUPS_RecoverNestedLauncherOrphans)
 {
   slave::Flags flags = CreateSlaveFlags();
@@ -14,6 +14,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <map>
 #include <set>
 #include <string>
 #include <vector>
@@ -50,9 +51,11 @@ using mesos::internal::master::Master;
 using mesos::internal::slave::Containerizer;
 using mesos::internal::slave::Fetcher;
 using mesos::internal::slave::Gpu;
+using mesos::internal::slave::GpuUsage;
 using mesos::internal::slave::MesosContainerizer;
 using mesos::internal::slave::MesosContainerizerProcess;
 using mesos::internal::slave::NvidiaGpuAllocator;
+using mesos::internal::slave::NvidiaGpuSampler;
 using mesos::internal::slave::NvidiaVolume;
 using mesos::internal::slave::Slave;
 
@@ -584,6 +587,49 @@ TEST_F(NvidiaGpuTest, NVIDIA_GPU_Allocator)
 }
 
 
+// Test that the usage of the GPU devices is sampled.
+TEST_F(NvidiaGpuTest, NVIDIA_GPU_Sampler)
+{
+  ASSERT_TRUE(nvml::isAvailable());
+  ASSERT_SOME(nvml::initialize());
+
+  slave::Flags flags = CreateSlaveFlags();
+  flags.resources = "cpus:1"; // To override the default with gpus:0.
+  flags.isolation = "gpu/nvidia";
+
+  Try<Resources> resources = NvidiaGpuAllocator::resources(flags);
+  ASSERT_SOME(resources);
+
+  Try<NvidiaGpuAllocator> allocator =
+    NvidiaGpuAllocator::create(flags, resources.get());
+  ASSERT_SOME(allocator);
+
+  Try<NvidiaGpuSampler> sampler = NvidiaGpuSampler::create(allocator->total());
+  ASSERT_SOME(sampler);
+
+  Future<std::map<Gpu, GpuUsage>> usages =
+    sampler->sample(allocator->total());
+
+  AWAIT_READY(usages);
+  ASSERT_EQ(allocator->total().size(), usages->size());
+
+  foreachvalue (const GpuUsage& usage, usages.get()) {
+    ASSERT_SOME(usage.memoryTotal);
+    EXPECT_LT(Bytes(0), usage.memoryTotal.get());
+  }
+
+  // A bogus GPU is not sampled.
+  Gpu bogus;
+  bogus.major = 999;
+  bogus.minor = 999;
+
+  usages = sampler->sample({ bogus });
+
+  AWAIT_READY(usages);
+  EXPECT_TRUE(usages->empty());
+}
+
+
 // Tests that we can create the volume that consolidates
 // the Nvidia libraries and binaries.
 TEST_F(NvidiaGpuTest, ROOT_NVIDIA_GPU_VolumeCreation)
@@ -63,6 +63,17 @@ TEST_F(PerfTest, ROOT_PERF_Sample)
 }
 
 
+TEST_F(PerfTest, CountersSupported)
+{
+  EXPECT_TRUE(perf::Counters::supported(
+      {"cycles", "task-clock", "L1-dcache-load-misses", "LLC-stores"}));
+
+  // Events without a perf_event_open attribute known to the counters.
+  EXPECT_FALSE(perf::Counters::supported({"cycles", "invalid-event"}));
+  EXPECT_FALSE(perf::Counters::supported({"l1-dcache-invalid"}));
+}
+
+
 TEST_F(PerfTest, Parse)
 {
   // Parse multiple cgroups with uint64 and floats.
@@ -1013,6 +1013,131 @@ TEST_F(PortMappingIsolatorTest, ROOT_NC_HostToContainerTCP)
 }
 
 
+// Test the scenario where the BPF classifier (rather than u32 IP
+// filters for each port range) redirects the TCP traffic from the
+// host to a container.
+TEST_F(PortMappingIsolatorTest, ROOT_NC_HostToContainerTCPWithBPFClassifier)
+{
+  flags.network_enable_bpf_classifier = true;
+
+  Try<Isolator*> isolator = PortMappingIsolatorProcess::create(flags);
+  ASSERT_SOME(isolator);
+
+  // The BPF classifier is attached to host eth0 and host lo during
+  // recovery.
+  AWAIT_READY(isolator.get()->recover({}, {}));
+
+  Try<Launcher*> launcher = LinuxLauncher::create(flags);
+  ASSERT_SOME(launcher);
+
+  // Set the executor's resources.
+  ExecutorInfo executorInfo;
+  executorInfo.mutable_resources()->CopyFrom(
+      Resources::parse(container1Ports).get());
+
+  ContainerID containerId;
+  containerId.set_value(UUID::random().toString());
+
+  // Use a relative temporary directory so it gets cleaned up
+  // automatically with the test.
+  Try<string> dir = os::mkdtemp(path::join(os::getcwd(), "XXXXXX"));
+  ASSERT_SOME(dir);
+
+  ContainerConfig containerConfig;
+  containerConfig.mutable_executor_info()->CopyFrom(executorInfo);
+  containerConfig.set_directory(dir.get());
+
+  Future<Option<ContainerLaunchInfo>> launchInfo =
+    isolator.get()->prepare(
+        containerId,
+        containerConfig);
+
+  AWAIT_READY(launchInfo);
+  ASSERT_SOME(launchInfo.get());
+  ASSERT_EQ(1, launchInfo.get()->pre_exec_commands().size());
+
+  ostringstream command1;
+
+  // Listen to 'localhost' and 'Port'.
+  command1 << "nc -l localhost " << validPort << " > " << trafficViaLoopback
+           << "&";
+
+  // Listen to 'public IP' and 'Port'.
+  command1 << "nc -l " << hostIP << " " << validPort << " > "
+           << trafficViaPublic << "&";
+
+  // Listen to 'public IP' and 'invalidPort'. This should fail.
+  command1 << "nc -l " << invalidPort << " | tee " << trafficViaLoopback << " "
+           << trafficViaPublic << "&";
+
+  // Touch the guard file.
+  command1 << "touch " << container1Ready;
+
+  int pipes[2];
+  ASSERT_NE(-1, ::pipe(pipes));
+
+  Try<pid_t> pid = launchHelper(
+      launcher.get(),
+      pipes,
+      containerId,
+      command1.str(),
+      launchInfo.get());
+
+  ASSERT_SOME(pid);
+
+  // Reap the forked child.
+  Future<Option<int>> status = process::reap(pid.get());
+
+  // Continue in the parent.
+  ::close(pipes[0]);
+
+  // Isolate the forked child.
+  AWAIT_READY(isolator.get()->isolate(containerId, pid.get()));
+
+  // Now signal the child to continue.
+  char dummy;
+  ASSERT_LT(0, ::write(pipes[1], &dummy, sizeof(dummy)));
+  ::close(pipes[1]);
+
+  // Wait for the command to start.
+  ASSERT_TRUE(waitForFileCreation(container1Ready));
+
+  // Send to 'localhost' and 'port'.
+  ostringstream command2;
+  command2 << "printf hello1 | nc localhost " << validPort;
+  ASSERT_SOME(os::shell(command2.str()));
+
+  // Send to 'localhost' and 'invalidPort'. This should fail because TCP
+  // connection couldn't be established..
+  ostringstream command3;
+  command3 << "printf hello2 | nc localhost " << invalidPort;
+  ASSERT_ERROR(os::shell(command3.str()));
+
+  // Send to 'public IP' and 'port'.
+  ostringstream command4;
+  command4 << "printf hello3 | nc " << hostIP << " " << validPort;
+  ASSERT_SOME(os::shell(command4.str()));
+
+  // Send to 'public IP' and 'invalidPort'. This should fail because TCP
+  // connection couldn't be established.
+  ostringstream command5;
+  command5 << "printf hello4 | nc " << hostIP << " " << invalidPort;
+  ASSERT_ERROR(os::shell(command5.str()));
+
+  EXPECT_SOME_EQ("hello1", os::read(trafficViaLoopback));
+  EXPECT_SOME_EQ("hello3", os::read(trafficViaPublic));
+
+  // Ensure all processes are killed.
+  AWAIT_READY(launcher.get()->destroy(containerId));
+
+  // Let the isolator clean up.
+  AWAIT_READY(isolator.get()->cleanup(containerId));
+
+  delete isolator.get();
+  delete launcher.get();
+}
+
+
 // Test the scenario where a container issues ICMP requests to
 // external hosts.
 TEST_F(PortMappingIsolatorTest, ROOT_ContainerICMPExternal)
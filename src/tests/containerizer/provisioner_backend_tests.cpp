@@ -14,6 +14,13 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#ifdef __linux__
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#endif // __linux__
+
+#include <list>
+
 #include <process/gtest.hpp>
 
 #include <stout/foreach.hpp>
@@ -29,6 +36,8 @@
 #include "linux/fs.hpp"
 #endif // __linux__
 
+#include "slave/paths.hpp"
+
 #include "slave/containerizer/mesos/provisioner/backends/bind.hpp"
 #include "slave/containerizer/mesos/provisioner/backends/copy.hpp"
 #include "slave/containerizer/mesos/provisioner/backends/overlay.hpp"
@@ -46,6 +55,7 @@ using mesos::internal::slave::BIND_BACKEND;
 using mesos::internal::slave::COPY_BACKEND;
 using mesos::internal::slave::OVERLAY_BACKEND;
 
+using std::list;
 using std::string;
 using std::vector;
 
@@ -169,6 +179,102 @@ TEST_F(OverlayBackendTest, ROOT_OVERLAYFS_OverlayFSBackendWithManyLayers)
 }
 
 
+// Verify that the overlay backend flattens a chain of layers once it
+// is provisioned again, applying the whiteouts of the layers, and then
+// mounts the flattened layer as the only lower directory.
+TEST_F(OverlayBackendTest, ROOT_OVERLAYFS_OverlayFSBackendSquashLayers)
+{
+  string layer1 = path::join(sandbox.get(), "source1");
+  ASSERT_SOME(os::mkdir(path::join(layer1, "dir1")));
+  ASSERT_SOME(os::write(path::join(layer1, "dir1", "1"), "1"));
+  ASSERT_SOME(os::write(path::join(layer1, "file"), "test1"));
+
+  // The second layer removes 'dir1/1' with an overlayfs whiteout.
+  string layer2 = path::join(sandbox.get(), "source2");
+  ASSERT_SOME(os::mkdir(path::join(layer2, "dir1")));
+  ASSERT_SOME(os::mkdir(path::join(layer2, "dir2")));
+  ASSERT_SOME(os::write(path::join(layer2, "dir2", "2"), "2"));
+  ASSERT_SOME(os::write(path::join(layer2, "file"), "test2"));
+  ASSERT_EQ(0, ::mknod(
+      path::join(layer2, "dir1", "1").c_str(),
+      S_IFCHR,
+      makedev(0, 0)));
+
+  slave::Flags flags;
+  flags.work_dir = path::join(sandbox.get(), "work_dir");
+  flags.image_provisioner_overlay_squash_threshold = 2;
+
+  hashmap<string, Owned<Backend>> backends = Backend::create(flags);
+  ASSERT_TRUE(backends.contains(OVERLAY_BACKEND));
+
+  // The chain is flattened once it is provisioned the second time.
+  for (int i = 0; i < 2; i++) {
+    string rootfs = path::join(sandbox.get(), "rootfs" + stringify(i));
+
+    AWAIT_READY(backends[OVERLAY_BACKEND]->provision(
+        {layer1, layer2},
+        rootfs,
+        sandbox.get()));
+
+    EXPECT_FALSE(os::exists(path::join(rootfs, "dir1", "1")));
+
+    AWAIT_READY(backends[OVERLAY_BACKEND]->destroy(rootfs, sandbox.get()));
+  }
+
+  const string squashDir = path::join(
+      slave::paths::getProvisionerDir(flags.work_dir),
+      "squashed_layers");
+
+  // Wait for the flattened layer to be built, for up to 15 seconds.
+  Duration waited = Duration::zero();
+  do {
+    Try<list<string>> entries = os::ls(squashDir);
+    ASSERT_SOME(entries);
+
+    if (entries->size() == 1 && !strings::endsWith(entries->front(), ".tmp")) {
+      break;
+    }
+
+    os::sleep(Milliseconds(100));
+    waited += Milliseconds(100);
+  } while (waited < Seconds(15));
+
+  ASSERT_LT(waited, Seconds(15));
+
+  string rootfs = path::join(sandbox.get(), "rootfs");
+
+  AWAIT_READY(backends[OVERLAY_BACKEND]->provision(
+      {layer1, layer2},
+      rootfs,
+      sandbox.get()));
+
+  EXPECT_FALSE(os::exists(path::join(rootfs, "dir1", "1")));
+  EXPECT_SOME_EQ("2", os::read(path::join(rootfs, "dir2", "2")));
+  EXPECT_SOME_EQ("test2", os::read(path::join(rootfs, "file")));
+
+  // The rootfs is mounted with a single lower directory.
+  Try<fs::MountInfoTable> mountTable = fs::MountInfoTable::read();
+  ASSERT_SOME(mountTable);
+
+  Option<string> lowerdir;
+  foreach (const fs::MountInfoTable::Entry& entry, mountTable->entries) {
+    if (entry.target == rootfs) {
+      foreach (const string& option,
+               strings::tokenize(entry.fsOptions, ",")) {
+        if (strings::startsWith(option, "lowerdir=")) {
+          lowerdir = option;
+        }
+      }
+    }
+  }
+
+  ASSERT_SOME(lowerdir);
+  EXPECT_FALSE(strings::contains(lowerdir.get(), ":"));
+
+  AWAIT_READY(backends[OVERLAY_BACKEND]->destroy(rootfs, sandbox.get()));
+}
+
+
 class BindBackendTest : public MountBackendTest {};
 
 
@@ -344,6 +450,85 @@ TEST_F(CopyBackendTest, ROOT_CopyBackend)
   EXPECT_FALSE(os::exists(rootfs));
 }
 
+
+#ifdef __linux__
+class SharedCopyBackendTest : public MountBackendTest {};
+
+
+// Provision two rootfses from the same layers with the copy backend
+// sharing their rootfs, and verify that they are writable separately
+// and that the shared rootfs is removed with the last of them.
+TEST_F(SharedCopyBackendTest, ROOT_OVERLAYFS_CopyBackendSharedRootfs)
+{
+  string layer1 = path::join(sandbox.get(), "source1");
+  ASSERT_SOME(os::mkdir(path::join(layer1, "dir1")));
+  ASSERT_SOME(os::write(path::join(layer1, "dir1", "1"), "1"));
+  ASSERT_SOME(os::write(path::join(layer1, "file"), "test1"));
+
+  string layer2 = path::join(sandbox.get(), "source2");
+  ASSERT_SOME(os::mkdir(path::join(layer2, "dir2")));
+  ASSERT_SOME(os::write(path::join(layer2, "dir2", "2"), "2"));
+  ASSERT_SOME(os::write(path::join(layer2, "file"), "test2"));
+
+  slave::Flags flags;
+  flags.work_dir = path::join(sandbox.get(), "work_dir");
+  flags.image_provisioner_shared_rootfs = true;
+  flags.image_provisioner_shared_rootfs_upper_size = Megabytes(16);
+
+  hashmap<string, Owned<Backend>> backends = Backend::create(flags);
+  ASSERT_TRUE(backends.contains(COPY_BACKEND));
+
+  const string rootfs1 = path::join(sandbox.get(), "rootfs1");
+  const string rootfs2 = path::join(sandbox.get(), "rootfs2");
+
+  AWAIT_READY(backends[COPY_BACKEND]->provision(
+      {layer1, layer2},
+      rootfs1,
+      sandbox.get()));
+
+  AWAIT_READY(backends[COPY_BACKEND]->provision(
+      {layer1, layer2},
+      rootfs2,
+      sandbox.get()));
+
+  foreach (const string& rootfs, vector<string>({rootfs1, rootfs2})) {
+    EXPECT_SOME_EQ("1", os::read(path::join(rootfs, "dir1", "1")));
+    EXPECT_SOME_EQ("2", os::read(path::join(rootfs, "dir2", "2")));
+    EXPECT_SOME_EQ("test2", os::read(path::join(rootfs, "file")));
+  }
+
+  // The rootfses are copies on write of the shared rootfs.
+  ASSERT_SOME(os::write(path::join(rootfs1, "file"), "test3"));
+
+  EXPECT_SOME_EQ("test3", os::read(path::join(rootfs1, "file")));
+  EXPECT_SOME_EQ("test2", os::read(path::join(rootfs2, "file")));
+
+  const string sharedDir = path::join(
+      slave::paths::getProvisionerDir(flags.work_dir),
+      "shared_rootfses");
+
+  Try<list<string>> entries = os::ls(sharedDir);
+  ASSERT_SOME(entries);
+  EXPECT_EQ(1u, entries->size());
+
+  AWAIT_READY(backends[COPY_BACKEND]->destroy(rootfs1, sandbox.get()));
+
+  EXPECT_FALSE(os::exists(rootfs1));
+
+  entries = os::ls(sharedDir);
+  ASSERT_SOME(entries);
+  EXPECT_EQ(1u, entries->size());
+
+  AWAIT_READY(backends[COPY_BACKEND]->destroy(rootfs2, sandbox.get()));
+
+  EXPECT_FALSE(os::exists(rootfs2));
+
+  entries = os::ls(sharedDir);
+  ASSERT_SOME(entries);
+  EXPECT_TRUE(entries->empty());
+}
+#endif // __linux__
+
 } // namespace tests {
 } // namespace internal {
 } // namespace mesos {
@@ -16,6 +16,8 @@
 
 #include <gmock/gmock.h>
 
+#include <set>
+
 #include <stout/gtest.hpp>
 #include <stout/json.hpp>
 #include <stout/os.hpp>
@@ -28,10 +30,15 @@
 
 #include <mesos/docker/spec.hpp>
 
+#include <mesos/uri/fetcher.hpp>
+#include <mesos/uri/uri.hpp>
+
 #ifdef __linux__
 #include "linux/fs.hpp"
 #endif
 
+#include "common/command_utils.hpp"
+
 #include "slave/containerizer/mesos/provisioner/constants.hpp"
 
 #include "slave/containerizer/mesos/provisioner/docker/metadata_manager.hpp"
@@ -74,6 +81,7 @@ using slave::docker::Puller;
 using slave::docker::RegistryPuller;
 using slave::docker::Store;
 
+using testing::Return;
 using testing::WithParamInterface;
 
 namespace mesos {
@@ -340,7 +348,341 @@ TEST_F(ProvisionerDockerLocalStoreTest, PullingSameImageSimutanuously)
 }
 
 
+// This test verifies that the store evicts the least recently used
+// images which are not in use (along with their layers) once it
+// exceeds its size budget.
+TEST_F(ProvisionerDockerLocalStoreTest, PruneLeastRecentlyUsedImages)
+{
+  slave::Flags flags;
+  flags.docker_registry = path::join(os::getcwd(), "images");
+  flags.docker_store_dir = path::join(os::getcwd(), "store");
+  flags.docker_store_max_size = Bytes(1);
+
+  // Each image consists of a single layer named after the image.
+  MockPuller* puller = new MockPuller();
+  EXPECT_CALL(*puller, pull(_, _, _))
+    .WillRepeatedly(Invoke([](
+        const spec::ImageReference& reference,
+        const string& directory,
+        const string& backend) -> Future<vector<string>> {
+      const string layerPath = path::join(directory, reference.repository());
+
+      Try<Nothing> mkdir = os::mkdir(path::join(layerPath, "rootfs"));
+      if (mkdir.isError()) {
+        return Failure(mkdir.error());
+      }
+
+      Try<Nothing> write = os::write(
+          path::join(layerPath, "json"),
+          "{\"parent\": \"\"}");
+
+      if (write.isError()) {
+        return Failure(write.error());
+      }
+
+      return vector<string>{reference.repository()};
+    }));
+
+  Try<Owned<slave::Store>> store =
+      slave::docker::Store::create(flags, Owned<Puller>(puller));
+  ASSERT_SOME(store);
+
+  Image abc;
+  abc.set_type(Image::DOCKER);
+  abc.mutable_docker()->set_name("abc");
+
+  Image def;
+  def.set_type(Image::DOCKER);
+  def.mutable_docker()->set_name("def");
+
+  Future<slave::ImageInfo> abcInfo = store.get()->get(abc, COPY_BACKEND);
+  AWAIT_READY(abcInfo);
+
+  Future<slave::ImageInfo> defInfo = store.get()->get(def, COPY_BACKEND);
+  AWAIT_READY(defInfo);
+
+  const string abcLayer =
+    paths::getImageLayerPath(flags.docker_store_dir, "abc");
+
+  const string defLayer =
+    paths::getImageLayerPath(flags.docker_store_dir, "def");
+
+  ASSERT_TRUE(os::exists(abcLayer));
+  ASSERT_TRUE(os::exists(defLayer));
+
+  // The image 'def' is evicted since 'abc' is in use.
+  hashset<string> activeLayerPaths;
+  activeLayerPaths.insert(abcInfo->layers.begin(), abcInfo->layers.end());
+
+  AWAIT_READY(store.get()->prune(activeLayerPaths));
+
+  EXPECT_TRUE(os::exists(abcLayer));
+  EXPECT_FALSE(os::exists(defLayer));
+
+  // Once 'abc' is not in use anymore, it is evicted as well.
+  AWAIT_READY(store.get()->prune(hashset<string>()));
+
+  EXPECT_FALSE(os::exists(abcLayer));
+
+  // An evicted image is pulled again.
+  AWAIT_READY(store.get()->get(def, COPY_BACKEND));
+  EXPECT_TRUE(os::exists(defLayer));
+}
+
+
 #ifdef __linux__
+class MockFetcherPlugin : public uri::Fetcher::Plugin
+{
+public:
+  MOCK_CONST_METHOD0(schemes, std::set<string>());
+  MOCK_CONST_METHOD0(name, string());
+  MOCK_CONST_METHOD2(fetch, Future<Nothing>(const URI&, const string&));
+};
+
+
+// Tests the registry puller with a fake registry and peer, which are
+// served by a fetcher plugin for the URI schemes of the registry
+// (Docker manifests and blobs) and of the peers (HTTP). The image has
+// a single layer '123', whose rootfs contains the file 'temp'.
+class ProvisionerDockerRegistryPullerTest : public MesosTest
+{
+protected:
+  virtual void SetUp()
+  {
+    MesosTest::SetUp();
+
+    ASSERT_SOME(os::mkdir("layer"));
+    ASSERT_SOME(os::write(path::join("layer", "temp"), "foo 123"));
+
+    // The registry serves gzipped tarballs, and the peers serve
+    // uncompressed ones.
+    AWAIT_READY(command::tar(
+        Path("."),
+        Path("blob.tar.gz"),
+        Path("layer"),
+        command::Compression::GZIP));
+
+    AWAIT_READY(command::tar(Path("."), Path("peer.tar"), Path("layer")));
+
+    Try<string> read = os::read("blob.tar.gz");
+    ASSERT_SOME(read);
+    blob = read.get();
+
+    read = os::read("peer.tar");
+    ASSERT_SOME(read);
+    peer = read.get();
+
+    manifest =
+      "{"
+      "  \"name\": \"library/abc\","
+      "  \"tag\": \"latest\","
+      "  \"architecture\": \"amd64\","
+      "  \"fsLayers\": ["
+      "    {\"blobSum\": \"sha256:123\"}"
+      "  ],"
+      "  \"history\": ["
+      "    {\"v1Compatibility\": \"{\\\"id\\\": \\\"123\\\"}\"}"
+      "  ],"
+      "  \"schemaVersion\": 1,"
+      "  \"signatures\": ["
+      "    {"
+      "      \"header\": {\"jwk\": {\"kty\": \"EC\"}, \"alg\": \"ES256\"},"
+      "      \"signature\": \"signature\","
+      "      \"protected\": \"protected\""
+      "    }"
+      "  ]"
+      "}";
+
+    plugin = new MockFetcherPlugin();
+
+    EXPECT_CALL(*plugin, schemes())
+      .WillRepeatedly(Return(
+          std::set<string>({"docker-manifest", "docker-blob", "http"})));
+
+    EXPECT_CALL(*plugin, name())
+      .WillRepeatedly(Return("mock"));
+
+    fetcher.reset(new uri::Fetcher({Owned<uri::Fetcher::Plugin>(plugin)}));
+  }
+
+  slave::Flags CreateSlaveFlags()
+  {
+    slave::Flags flags = MesosTest::CreateSlaveFlags();
+
+    flags.docker_store_dir = path::join(sandbox.get(), "store");
+
+    // NOTE: There is no agent at this address, and this agent is not
+    // one of the peers, so it always pulls the layer from this peer.
+    flags.docker_layer_peers = "127.0.0.1:1";
+
+    return flags;
+  }
+
+  // Writes the given data to the file (i.e., the FIFO of the puller)
+  // that the URI is fetched to.
+  static Future<Nothing> serve(
+      const URI& uri,
+      const string& directory,
+      const string& data)
+  {
+    Try<Nothing> write =
+      os::write(path::join(directory, Path(uri.path()).basename()), data);
+
+    if (write.isError()) {
+      return Failure(write.error());
+    }
+
+    return Nothing();
+  }
+
+  string blob;
+  string peer;
+  string manifest;
+
+  // Owned by the fetcher.
+  MockFetcherPlugin* plugin;
+
+  process::Shared<uri::Fetcher> fetcher;
+};
+
+
+// This test verifies that the registry puller pulls the layer from
+// its peer if the peer has it, without fetching the blob of the layer
+// from the registry.
+TEST_F(ProvisionerDockerRegistryPullerTest, PullLayerFromPeer)
+{
+  slave::Flags flags = CreateSlaveFlags();
+
+  Future<URI> peerUri;
+
+  EXPECT_CALL(*plugin, fetch(_, _))
+    .WillOnce(Invoke([=](const URI& uri, const string& directory) {
+      EXPECT_EQ("docker-manifest", uri.scheme());
+      return os::write(path::join(directory, "manifest"), manifest);
+    }))
+    .WillOnce(DoAll(FutureArg<0>(&peerUri),
+                    Invoke([=](const URI& uri, const string& directory) {
+                      return serve(uri, directory, peer);
+                    })));
+
+  Try<Owned<Puller>> puller = RegistryPuller::create(flags, fetcher);
+  ASSERT_SOME(puller);
+
+  Try<spec::ImageReference> reference = spec::parseImageReference("abc");
+  ASSERT_SOME(reference);
+
+  const string directory = path::join(sandbox.get(), "staging");
+  ASSERT_SOME(os::mkdir(directory));
+
+  Future<vector<string>> layers =
+    puller.get()->pull(reference.get(), directory, COPY_BACKEND);
+
+  AWAIT_READY(layers);
+  EXPECT_EQ(vector<string>({"123"}), layers.get());
+
+  AWAIT_READY(peerUri);
+  EXPECT_EQ("http", peerUri->scheme());
+  EXPECT_EQ("127.0.0.1", peerUri->host());
+  EXPECT_EQ(1, peerUri->port());
+  EXPECT_EQ(
+      "/docker-provisioner-registry-puller/layers/123",
+      peerUri->path());
+
+  EXPECT_SOME_EQ(
+      "foo 123",
+      os::read(path::join(
+          paths::getImageLayerRootfsPath(
+              flags.docker_store_dir, "123", COPY_BACKEND),
+          "temp")));
+
+  JSON::Object metrics = Metrics();
+  EXPECT_EQ(
+      1u,
+      metrics.values[
+          "containerizer/mesos/provisioner/docker_store/"
+          "layer_pulls_from_peers"]);
+  EXPECT_EQ(
+      0u,
+      metrics.values[
+          "containerizer/mesos/provisioner/docker_store/layer_peer_misses"]);
+}
+
+
+// This test verifies that the registry puller falls back to pulling
+// the blob of a layer from the registry if pulling the layer from its
+// peer fails (e.g., since the peer does not have the layer either),
+// and that whatever the peer sent is not left in the layer.
+TEST_F(ProvisionerDockerRegistryPullerTest, PullLayerFromPeerFallback)
+{
+  slave::Flags flags = CreateSlaveFlags();
+
+  Future<URI> blobUri;
+
+  EXPECT_CALL(*plugin, fetch(_, _))
+    .WillOnce(Invoke([=](const URI& uri, const string& directory) {
+      EXPECT_EQ("docker-manifest", uri.scheme());
+      return os::write(path::join(directory, "manifest"), manifest);
+    }))
+    .WillOnce(Invoke([=](const URI& uri, const string& directory)
+        -> Future<Nothing> {
+      EXPECT_EQ("http", uri.scheme());
+
+      // Leave a file in the rootfs, as if the peer failed after
+      // sending part of a layer.
+      const string rootfs =
+        paths::getImageLayerRootfsPath(directory, COPY_BACKEND);
+
+      Try<Nothing> write = os::write(path::join(rootfs, "partial"), "");
+      if (write.isError()) {
+        return Failure(write.error());
+      }
+
+      return Failure("Not Found");
+    }))
+    .WillOnce(DoAll(FutureArg<0>(&blobUri),
+                    Invoke([=](const URI& uri, const string& directory) {
+                      return serve(uri, directory, blob);
+                    })));
+
+  Try<Owned<Puller>> puller = RegistryPuller::create(flags, fetcher);
+  ASSERT_SOME(puller);
+
+  Try<spec::ImageReference> reference = spec::parseImageReference("abc");
+  ASSERT_SOME(reference);
+
+  const string directory = path::join(sandbox.get(), "staging");
+  ASSERT_SOME(os::mkdir(directory));
+
+  Future<vector<string>> layers =
+    puller.get()->pull(reference.get(), directory, COPY_BACKEND);
+
+  AWAIT_READY(layers);
+  EXPECT_EQ(vector<string>({"123"}), layers.get());
+
+  AWAIT_READY(blobUri);
+  EXPECT_EQ("docker-blob", blobUri->scheme());
+  EXPECT_EQ("library/abc", blobUri->path());
+  EXPECT_EQ("sha256:123", blobUri->query());
+
+  const string rootfs = paths::getImageLayerRootfsPath(
+      flags.docker_store_dir, "123", COPY_BACKEND);
+
+  EXPECT_SOME_EQ("foo 123", os::read(path::join(rootfs, "temp")));
+  EXPECT_FALSE(os::exists(path::join(rootfs, "partial")));
+
+  JSON::Object metrics = Metrics();
+  EXPECT_EQ(
+      0u,
+      metrics.values[
+          "containerizer/mesos/provisioner/docker_store/"
+          "layer_pulls_from_peers"]);
+  EXPECT_EQ(
+      1u,
+      metrics.values[
+          "containerizer/mesos/provisioner/docker_store/layer_peer_misses"]);
+}
+
+
 class ProvisionerDockerPullerTest : public MesosTest {};
 
 
@@ -0,0 +1,80 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <map>
+#include <set>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <stout/foreach.hpp>
+#include <stout/gtest.hpp>
+
+#include "linux/topology.hpp"
+
+using std::map;
+using std::set;
+using std::vector;
+
+namespace mesos {
+namespace internal {
+namespace tests {
+
+TEST(TopologyTest, Parse)
+{
+  EXPECT_SOME_EQ(set<int>({0}), topology::parse("0"));
+  EXPECT_SOME_EQ(set<int>({0, 1, 2, 3}), topology::parse("0-3\n"));
+  EXPECT_SOME_EQ(set<int>({0, 1, 4, 6, 7}), topology::parse("0-1,4,6-7"));
+  EXPECT_SOME_EQ(set<int>(), topology::parse(""));
+
+  EXPECT_ERROR(topology::parse("a"));
+  EXPECT_ERROR(topology::parse("3-1"));
+  EXPECT_ERROR(topology::parse("0-1-2"));
+}
+
+
+TEST(TopologyTest, Format)
+{
+  EXPECT_EQ("", topology::format({}));
+  EXPECT_EQ("0", topology::format({0}));
+  EXPECT_EQ("0-3", topology::format({0, 1, 2, 3}));
+  EXPECT_EQ("0-1,4,6-7", topology::format({0, 1, 4, 6, 7}));
+}
+
+
+TEST(TopologyTest, Nodes)
+{
+  Try<set<int>> cpus = topology::cpus();
+  ASSERT_SOME(cpus);
+
+  Try<map<int, vector<int>>> nodes = topology::nodes();
+  ASSERT_SOME(nodes);
+  ASSERT_FALSE(nodes->empty());
+
+  // Every online CPU belongs to exactly one node.
+  set<int> all;
+  foreachvalue (const vector<int>& node, nodes.get()) {
+    foreach (int cpu, node) {
+      EXPECT_TRUE(all.insert(cpu).second);
+    }
+  }
+
+  EXPECT_EQ(cpus.get(), all);
+}
+
+} // namespace tests {
+} // namespace internal {
+} // namespace mesos {
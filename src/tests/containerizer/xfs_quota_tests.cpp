@@ -81,6 +81,21 @@ static QuotaInfo makeQuotaInfo(
 
 class ROOT_XFS_QuotaTest : public MesosTest
 {
+public:
+  ROOT_XFS_QuotaTest()
+    : ROOT_XFS_QuotaTest("xfs", "mkfs.xfs -f", "disk/xfs") {}
+
+protected:
+  // Runs the tests on a filesystem of the given type, made with the
+  // given `mkfs` command, and with the given disk isolator.
+  ROOT_XFS_QuotaTest(
+      const string& _filesystem,
+      const string& _mkfs,
+      const string& _isolation)
+    : filesystem(_filesystem),
+      mkfs(_mkfs),
+      isolation(_isolation) {}
+
 public:
   virtual void SetUp()
   {
@@ -111,20 +126,20 @@ public:
     loopDevice = loop.get();
     ASSERT_SOME(loopDevice);
 
-    // Make an XFS filesystem (using the force flag). The defaults
+    // Make the filesystem (using the force flag). The defaults
     // should be good enough for tests.
-    Try<Subprocess> mkfs = subprocess(
-        "mkfs.xfs -f " + loopDevice.get(),
+    Try<Subprocess> _mkfs = subprocess(
+        mkfs + " " + loopDevice.get(),
         Subprocess::PATH("/dev/null"));
 
-    ASSERT_SOME(mkfs);
-    AWAIT_READY(mkfs->status());
-    ASSERT_SOME_EQ(0, mkfs->status().get());
+    ASSERT_SOME(_mkfs);
+    AWAIT_READY(_mkfs->status());
+    ASSERT_SOME_EQ(0, _mkfs->status().get());
 
     ASSERT_SOME(fs::mount(
         loopDevice.get(),
         mntPath,
-        "xfs",
+        filesystem,
         0, // Flags.
         "prjquota"));
     mountPoint = mntPath;
@@ -162,7 +177,7 @@ public:
     // We only need an XFS-specific directory for the work directory. We
     // don't mind that other flags refer to a different temp directory.
     flags.work_dir = mountPoint.get();
-    flags.isolation = "disk/xfs";
+    flags.isolation = isolation;
     return flags;
   }
 
@@ -174,8 +189,8 @@ public:
       return Error(fd.error());
     }
 
-    // XFS supports posix_fallocate(3), and we depend on it actually
-    // allocating storage in the quota tests.
+    // XFS and ext4 support posix_fallocate(3), and we depend on it
+    // actually allocating storage in the quota tests.
     if (int error = ::posix_fallocate(fd.get(), 0, size.bytes())) {
       os::close(fd.get());
       return Error("posix_fallocate failed: " + os::strerror(error));
@@ -206,6 +221,10 @@ public:
     return string("/dev/loop") + stringify(devno);
   }
 
+  const string filesystem;
+  const string mkfs;
+  const string isolation;
+
   Option<string> loopDevice; // The loop device we attached.
   Option<string> mountPoint; // XFS filesystem mountpoint.
 };
@@ -878,6 +897,140 @@ TEST_F(ROOT_XFS_QuotaTest, IsolatorFlags)
   ASSERT_ERROR(StartSlave(detector.get(), flags));
 }
 
+
+// Runs the tests of the `disk/ext4` isolator, which uses the same
+// project quotas as the `disk/xfs` isolator, on an ext4 filesystem.
+// NOTE: Project quotas require inodes of at least 256 bytes, which
+// is not the default for small filesystems.
+class ROOT_EXT4_QuotaTest : public ROOT_XFS_QuotaTest
+{
+public:
+  ROOT_EXT4_QuotaTest()
+    : ROOT_XFS_QuotaTest(
+          "ext4",
+          "mkfs.ext4 -F -I 256 -O quota,project",
+          "disk/ext4") {}
+};
+
+
+// Verify that writes into a project directory on ext4 fail once they
+// exceed the quota of the project.
+TEST_F(ROOT_EXT4_QuotaTest, QuotaLimit)
+{
+  prid_t projectId = 55;
+  string root = "project";
+  Bytes limit = Megabytes(11);
+  Bytes used = Megabytes(10);
+
+  ASSERT_SOME(os::mkdir(root));
+
+  EXPECT_SOME(setProjectQuota(root, projectId, limit));
+  EXPECT_SOME(setProjectId(root, projectId));
+
+  EXPECT_SOME(mkfile(path::join(root, "file"), used));
+
+  EXPECT_SOME_EQ(
+      makeQuotaInfo(limit, used),
+      getProjectQuota(root, projectId));
+
+  // Files created in subdirectories inherit the project ID, and
+  // count towards (and are limited by) the same quota.
+  ASSERT_SOME(os::mkdir(path::join(root, "directory")));
+  EXPECT_ERROR(mkfile(path::join(root, "directory", "file"), Megabytes(2)));
+
+  EXPECT_SOME(clearProjectQuota(root, projectId));
+}
+
+
+// Verify that the `disk/ext4` isolator enforces the disk resources of
+// a task: dd is given 1MB but writes 2MB, and fails with a write error
+// rather than the task being killed by the isolator.
+TEST_F(ROOT_EXT4_QuotaTest, DiskUsageExceedsQuota)
+{
+  Try<Owned<cluster::Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  Owned<MasterDetector> detector = master.get()->createDetector();
+  Try<Owned<cluster::Slave>> slave =
+    StartSlave(detector.get(), CreateSlaveFlags());
+  ASSERT_SOME(slave);
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+      &sched, DEFAULT_FRAMEWORK_INFO, master.get()->pid, DEFAULT_CREDENTIAL);
+
+  EXPECT_CALL(sched, registered(&driver, _, _));
+
+  Future<vector<Offer>> offers;
+  EXPECT_CALL(sched, resourceOffers(&driver, _))
+    .WillOnce(FutureArg<1>(&offers))
+    .WillRepeatedly(Return()); // Ignore subsequent offers.
+
+  driver.start();
+
+  AWAIT_READY(offers);
+  EXPECT_FALSE(offers.get().empty());
+
+  const Offer& offer = offers.get()[0];
+
+  TaskInfo task = createTask(
+      offer.slave_id(),
+      Resources::parse("cpus:1;mem:128;disk:1").get(),
+      "dd if=/dev/zero of=file bs=1048576 count=2");
+
+  Future<TaskStatus> status1;
+  Future<TaskStatus> status2;
+  EXPECT_CALL(sched, statusUpdate(&driver, _))
+    .WillOnce(FutureArg<1>(&status1))
+    .WillOnce(FutureArg<1>(&status2));
+
+  driver.launchTasks(offer.id(), {task});
+
+  AWAIT_READY(status1);
+  EXPECT_EQ(task.task_id(), status1.get().task_id());
+  EXPECT_EQ(TASK_RUNNING, status1.get().state());
+
+  AWAIT_READY(status2);
+  EXPECT_EQ(task.task_id(), status2.get().task_id());
+  EXPECT_EQ(TASK_FAILED, status2.get().state());
+
+  EXPECT_EQ(TaskStatus::SOURCE_EXECUTOR, status2.get().source());
+  EXPECT_EQ("Command exited with status 1", status2.get().message());
+
+  driver.stop();
+  driver.join();
+}
+
+
+// Verify that the `disk/ext4` isolator can not be used if the work
+// directory is not on ext4, or if project quotas are not enforced.
+TEST_F(ROOT_EXT4_QuotaTest, IsolatorFlags)
+{
+  Try<Owned<cluster::Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  Owned<MasterDetector> detector = master.get()->createDetector();
+
+  // work_dir must be an ext4 filesystem.
+  slave::Flags flags = CreateSlaveFlags();
+  flags.work_dir = "/proc";
+  ASSERT_ERROR(StartSlave(detector.get(), flags));
+
+  // Project quotas must be enforced, which they are not when mounted
+  // without `prjquota`, even though ext4 still accounts for them.
+  ASSERT_SOME(os::chdir(sandbox.get()));
+  ASSERT_SOME(fs::unmount(mountPoint.get()));
+  ASSERT_SOME(fs::mount(
+      loopDevice.get(),
+      mountPoint.get(),
+      filesystem,
+      0, // Flags.
+      None()));
+
+  flags = CreateSlaveFlags();
+  ASSERT_ERROR(StartSlave(detector.get(), flags));
+}
+
 } // namespace tests {
 } // namespace internal {
 } // namespace mesos {
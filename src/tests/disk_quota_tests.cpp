@@ -169,6 +169,42 @@ TEST_F(DiskUsageCollectorTest, ExcludeRelativePath)
   Future<Bytes> usage2 = collector.usage(".", {file});
   EXPECT_GE(usage2.get(), Kilobytes(128));
 }
+
+
+// This test verifies that the usage tracked through inotify follows
+// the changes to the directory.
+TEST_F(DiskUsageCollectorTest, Inotify)
+{
+  string dir = path::join(os::getcwd(), "dir");
+  string file1 = path::join(os::getcwd(), "file1");
+  string file2 = path::join(dir, "file2");
+  string file3 = path::join(dir, "file3");
+
+  ASSERT_SOME(os::mkdir(dir));
+
+  ASSERT_SOME(os::write(file1, string(Kilobytes(8).bytes(), 'x')));
+  ASSERT_SOME(os::write(file2, string(Kilobytes(8).bytes(), 'y')));
+
+  DiskUsageCollector collector(Milliseconds(1), true);
+
+  Future<Bytes> usage1 = collector.usage(os::getcwd(), {});
+  AWAIT_READY(usage1);
+  EXPECT_GE(usage1.get(), Kilobytes(16));
+  EXPECT_LT(usage1.get(), Kilobytes(128));
+
+  ASSERT_SOME(os::write(file3, string(Kilobytes(128).bytes(), 'z')));
+
+  Future<Bytes> usage2 = collector.usage(os::getcwd(), {});
+  AWAIT_READY(usage2);
+  EXPECT_GE(usage2.get(), Kilobytes(144));
+
+  ASSERT_SOME(os::rmdir(dir));
+
+  Future<Bytes> usage3 = collector.usage(os::getcwd(), {});
+  AWAIT_READY(usage3);
+  EXPECT_GE(usage3.get(), Kilobytes(8));
+  EXPECT_LT(usage3.get(), Kilobytes(128));
+}
 #endif
 
 
@@ -53,6 +53,7 @@
 
 #ifdef __linux__
 #include "linux/cgroups.hpp"
+#include "linux/cgroups2.hpp"
 #include "linux/fs.hpp"
 #include "linux/perf.hpp"
 #endif
@@ -233,6 +234,49 @@ private:
 };
 
 
+// This filter enables the tests of the cgroups v2 unified hierarchy
+// if it is mounted at the default location (see `--cgroups_hierarchy`).
+class Cgroups2Filter : public TestFilter
+{
+public:
+  Cgroups2Filter()
+  {
+#ifdef __linux__
+    Try<bool> mounted = cgroups2::mounted("/sys/fs/cgroup");
+    if (mounted.isError() || !mounted.get()) {
+      std::cerr
+        << "-------------------------------------------------------------\n"
+        << "No cgroups v2 unified hierarchy is mounted at /sys/fs/cgroup,\n"
+        << "so no cgroups v2 tests will be run\n"
+        << "-------------------------------------------------------------"
+        << std::endl;
+
+      error = Error("No unified hierarchy");
+    }
+#endif // __linux__
+  }
+
+  bool disable(const ::testing::TestInfo* test) const
+  {
+    if (matches(test, "CGROUPS2_")) {
+#ifdef __linux__
+      Result<string> user = os::user();
+      CHECK_SOME(user);
+
+      return user.get() != "root" || error.isSome();
+#else
+      return true;
+#endif // __linux__
+    }
+
+    return false;
+  }
+
+private:
+  Option<Error> error;
+};
+
+
 class CurlFilter : public TestFilter
 {
 public:
@@ -756,6 +800,7 @@ Environment::Environment(const Flags& _flags) : flags(_flags)
   filters.push_back(Owned<TestFilter>(new BenchmarkFilter()));
   filters.push_back(Owned<TestFilter>(new CfsFilter()));
   filters.push_back(Owned<TestFilter>(new CgroupsFilter()));
+  filters.push_back(Owned<TestFilter>(new Cgroups2Filter()));
   filters.push_back(Owned<TestFilter>(new CurlFilter()));
   filters.push_back(Owned<TestFilter>(new DockerFilter()));
   filters.push_back(Owned<TestFilter>(new InternetFilter()));
@@ -1246,8 +1246,8 @@ TEST_F(FetcherCacheHttpTest, HttpMixed)
 }
 
 
-// Tests slave recovery of the fetcher cache. The cache must be
-// wiped clean on recovery, causing renewed downloads.
+// Tests slave recovery of the fetcher cache. The cache files must
+// be kept on recovery and reused, without renewed downloads.
 // TODO(bernd-mesos): Debug flaky behavior reported in MESOS-2871,
 // then reenable this test.
 TEST_F(FetcherCacheHttpTest, DISABLED_HttpCachedRecovery)
@@ -1312,10 +1312,12 @@ TEST_F(FetcherCacheHttpTest, DISABLED_HttpCachedRecovery)
   // Wait until the containerizer is updated.
   AWAIT_READY(update);
 
-  // Recovery must have cleaned the cache by now.
-  EXPECT_FALSE(os::exists(cacheDirectory));
+  // Recovery must have kept the cache file.
+  ASSERT_SOME(fetcherProcess->cacheFiles(slaveId, flags));
+  EXPECT_EQ(1u, fetcherProcess->cacheFiles(slaveId, flags).get().size());
 
-  // Repeat of the above to see if it works the same.
+  // Repeat of the above to see if it works the same, but from the
+  // recovered cache.
   for (size_t i = 0; i < 3; i++) {
     CommandInfo::URI uri;
     uri.set_value(httpServer->url() + COMMAND_NAME);
@@ -1340,9 +1342,9 @@ TEST_F(FetcherCacheHttpTest, DISABLED_HttpCachedRecovery)
     ASSERT_SOME(fetcherProcess->cacheFiles(slaveId, flags));
     EXPECT_EQ(1u, fetcherProcess->cacheFiles(slaveId, flags).get().size());
 
-    // content-length requests: 1
-    // downloads: 1
-    EXPECT_EQ(2u, httpServer->countCommandRequests);
+    // content-length requests: 0
+    // downloads: 0
+    EXPECT_EQ(0u, httpServer->countCommandRequests);
   }
 }
 
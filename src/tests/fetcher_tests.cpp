@@ -43,6 +43,8 @@
 #include <mesos/fetcher/fetcher.hpp>
 #include <mesos/type_utils.hpp>
 
+#include "common/command_utils.hpp"
+
 #include "slave/containerizer/fetcher.hpp"
 #include "slave/flags.hpp"
 
@@ -104,6 +106,94 @@ TEST_F_TEMP_DISABLED_ON_WINDOWS(FetcherTest, FileURI)
 }
 
 
+// Tests that URIs are fetched concurrently, except for the ones that
+// are fetched to the same file, which are fetched in order.
+TEST_F_TEMP_DISABLED_ON_WINDOWS(FetcherTest, ConcurrentFileURIs)
+{
+  string fromDir = path::join(os::getcwd(), "from");
+  ASSERT_SOME(os::mkdir(fromDir));
+
+  slave::Flags flags;
+  flags.launcher_dir = getLauncherDir();
+  flags.fetcher_max_concurrent_downloads = 3;
+
+  ContainerID containerId;
+  containerId.set_value(UUID::random().toString());
+
+  CommandInfo commandInfo;
+
+  for (int i = 0; i < 4; i++) {
+    string testFile = path::join(fromDir, "test" + stringify(i));
+    ASSERT_SOME(os::write(testFile, "data" + stringify(i)));
+
+    CommandInfo::URI* uri = commandInfo.add_uris();
+    uri->set_value("file://" + testFile);
+
+    // The last two URIs are fetched to the same file.
+    if (i >= 2) {
+      uri->set_output_file("test");
+    }
+  }
+
+  Fetcher fetcher;
+  SlaveID slaveId;
+
+  Future<Nothing> fetch = fetcher.fetch(
+      containerId, commandInfo, os::getcwd(), None(), slaveId, flags);
+  AWAIT_READY(fetch);
+
+  EXPECT_SOME_EQ("data0", os::read(path::join(os::getcwd(), "test0")));
+  EXPECT_SOME_EQ("data1", os::read(path::join(os::getcwd(), "test1")));
+  EXPECT_SOME_EQ("data3", os::read(path::join(os::getcwd(), "test")));
+}
+
+
+// Tests that a URI is fetched if the fetched file has the SHA-512
+// checksum of the URI, and that the file is deleted otherwise.
+TEST_F_TEMP_DISABLED_ON_WINDOWS(FetcherTest, FileURIChecksum)
+{
+  string fromDir = path::join(os::getcwd(), "from");
+  ASSERT_SOME(os::mkdir(fromDir));
+  string testFile = path::join(fromDir, "test");
+  EXPECT_SOME(os::write(testFile, "data"));
+
+  Future<string> checksum = command::sha512(Path(testFile));
+  AWAIT_READY(checksum);
+
+  string localFile = path::join(os::getcwd(), "test");
+  EXPECT_FALSE(os::exists(localFile));
+
+  slave::Flags flags;
+  flags.launcher_dir = getLauncherDir();
+
+  ContainerID containerId;
+  containerId.set_value(UUID::random().toString());
+
+  CommandInfo commandInfo;
+  CommandInfo::URI* uri = commandInfo.add_uris();
+  uri->set_value("file://" + testFile);
+  uri->set_sha512(checksum.get());
+
+  Fetcher fetcher;
+  SlaveID slaveId;
+
+  Future<Nothing> fetch = fetcher.fetch(
+      containerId, commandInfo, os::getcwd(), None(), slaveId, flags);
+  AWAIT_READY(fetch);
+
+  EXPECT_TRUE(os::exists(localFile));
+
+  ASSERT_SOME(os::rm(localFile));
+  EXPECT_SOME(os::write(testFile, "other data"));
+
+  fetch = fetcher.fetch(
+      containerId, commandInfo, os::getcwd(), None(), slaveId, flags);
+  AWAIT_FAILED(fetch);
+
+  EXPECT_FALSE(os::exists(localFile));
+}
+
+
 // TODO(hausdorff): `os::getuid` does not exist on Windows.
 #ifndef __WINDOWS__
 // Tests that non-root users are unable to fetch root-protected files on the
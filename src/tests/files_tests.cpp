@@ -15,6 +15,7 @@
 // limitations under the License.
 
 #include <string>
+#include <vector>
 
 #include <gmock/gmock.h>
 
@@ -53,6 +54,7 @@ using process::http::Response;
 using process::http::Unauthorized;
 
 using std::string;
+using std::vector;
 
 using mesos::http::authentication::BasicAuthenticatorFactory;
 
@@ -484,6 +486,143 @@ TEST_F(FilesTest, DownloadTest)
 }
 
 
+// Tests that a byte range of a file can be downloaded.
+TEST_F(FilesTest, DownloadRangeTest)
+{
+  Files files;
+  process::UPID upid("files", process::address());
+
+  ASSERT_SOME(os::write("file", "0123456789"));
+  AWAIT_EXPECT_READY(files.attach("file", "file"));
+
+  process::http::Headers headers;
+  headers["Range"] = "bytes=4-";
+
+  Future<Response> response =
+    process::http::get(upid, "download", "path=file", headers);
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(
+      process::http::Status::string(process::http::Status::PARTIAL_CONTENT),
+      response);
+  AWAIT_EXPECT_RESPONSE_HEADER_EQ("bytes 4-9/10", "Content-Range", response);
+  AWAIT_EXPECT_RESPONSE_BODY_EQ("456789", response);
+}
+
+
+// Tests that '/files/follow' streams data appended to a file.
+// Tests that a directory can be browsed page by page, and that its
+// listing can be streamed.
+TEST_F_TEMP_DISABLED_ON_WINDOWS(FilesTest, BrowsePaginationTest)
+{
+  Files files;
+  process::UPID upid("files", process::address());
+
+  ASSERT_SOME(os::mkdir("1"));
+  ASSERT_SOME(os::write("1/a", "a"));
+  ASSERT_SOME(os::write("1/b", "b"));
+  ASSERT_SOME(os::write("1/c", "c"));
+  ASSERT_SOME(os::mkdir("1/d"));
+
+  AWAIT_EXPECT_READY(files.attach("1", "one"));
+
+  const vector<string> names = {"a", "b", "c", "d"};
+
+  JSON::Array entries;
+  foreach (const string& name, names) {
+    struct stat s;
+    ASSERT_EQ(0, stat(path::join("1", name).c_str(), &s));
+    entries.values.push_back(
+        model(protobuf::createFileInfo(path::join("one", name), s)));
+  }
+
+  JSON::Array expected;
+  expected.values = {entries.values[0], entries.values[1]};
+
+  Future<Response> response =
+    process::http::get(upid, "browse", "path=one&limit=2");
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+  AWAIT_EXPECT_RESPONSE_BODY_EQ(stringify(expected), response);
+
+  expected.values = {entries.values[2], entries.values[3]};
+
+  response = process::http::get(upid, "browse", "path=one&after=b&limit=2");
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+  AWAIT_EXPECT_RESPONSE_BODY_EQ(stringify(expected), response);
+
+  response = process::http::get(upid, "browse", "path=one&after=d&limit=2");
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+  AWAIT_EXPECT_RESPONSE_BODY_EQ(stringify(JSON::Array()), response);
+
+  response = process::http::get(upid, "browse", "path=one&limit=-1");
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(BadRequest().status, response);
+
+  // The streamed listing is not sorted.
+  response = process::http::streaming::get(
+      upid, "browse", "path=one&stream=true");
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+  ASSERT_EQ(Response::PIPE, response->type);
+  ASSERT_SOME(response->reader);
+
+  process::http::Pipe::Reader reader = response->reader.get();
+
+  Future<string> body = reader.readAll();
+  AWAIT_READY(body);
+
+  Try<JSON::Array> listing = JSON::parse<JSON::Array>(body.get());
+  ASSERT_SOME(listing);
+  ASSERT_EQ(entries.values.size(), listing->values.size());
+
+  foreach (const JSON::Value& entry, entries.values) {
+    EXPECT_NE(
+        listing->values.end(),
+        std::find(listing->values.begin(), listing->values.end(), entry));
+  }
+
+  response = process::http::get(
+      upid, "browse", "path=one&stream=true&limit=2");
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(BadRequest().status, response);
+}
+
+
+TEST_F(FilesTest, FollowTest)
+{
+  Files files;
+  process::UPID upid("files", process::address());
+
+  ASSERT_SOME(os::write("file", "abc"));
+  AWAIT_EXPECT_READY(files.attach("file", "file"));
+
+  Future<Response> response = process::http::streaming::get(
+      upid, "follow", "path=file&offset=1");
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+  ASSERT_EQ(Response::PIPE, response->type);
+  ASSERT_SOME(response->reader);
+
+  process::http::Pipe::Reader reader = response->reader.get();
+
+  AWAIT_EXPECT_EQ("bc", reader.read());
+
+  Try<int> fd = os::open("file", O_WRONLY | O_APPEND | O_CLOEXEC);
+  ASSERT_SOME(fd);
+  ASSERT_SOME(os::write(fd.get(), "def"));
+  ASSERT_SOME(os::close(fd.get()));
+
+  AWAIT_EXPECT_EQ("def", reader.read());
+
+  EXPECT_TRUE(reader.close());
+
+  response = process::http::get(upid, "follow", "path=file&offset=-1");
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(BadRequest().status, response);
+}
+
+
 // Tests that the '/files/debug' endpoint works as expected.
 TEST_F(FilesTest, DebugTest)
 {
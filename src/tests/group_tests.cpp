@@ -153,6 +153,138 @@ TEST_F(GroupTest, GroupDataWithRemovedMembership)
 }
 
 
+// Verifies that the data of a membership is only read from ZooKeeper
+// once, since it never changes.
+TEST_F(GroupTest, GroupDataCached)
+{
+  Group group1(server->connectString(), NO_TIMEOUT, "/test/");
+  Group group2(server->connectString(), NO_TIMEOUT, "/test/");
+
+  Future<Group::Membership> membership = group1.join("hello world");
+
+  AWAIT_READY(membership);
+
+  Future<Option<string>> data = group2.data(membership.get());
+
+  AWAIT_READY(data);
+  EXPECT_SOME_EQ("hello world", data.get());
+
+  // Change the data behind the back of the groups, which the group
+  // API does not allow for.
+  ZooKeeperTest::TestWatcher watcher;
+
+  ZooKeeper zk(server->connectString(), NO_TIMEOUT, &watcher);
+  watcher.awaitSessionEvent(ZOO_CONNECTED_STATE);
+
+  const string path =
+    "/test/" + GroupProcess::zkBasename(membership.get());
+
+  ASSERT_EQ(ZOK, zk.set(path, "goodbye world", -1));
+  ASSERT_ZK_GET("goodbye world", &zk, path);
+
+  // The groups use their copy of the data, including after a
+  // reconnection to ZooKeeper.
+  data = group1.data(membership.get());
+
+  AWAIT_READY(data);
+  EXPECT_SOME_EQ("hello world", data.get());
+
+  server->shutdownNetwork();
+
+  data = group2.data(membership.get());
+
+  EXPECT_TRUE(data.isPending());
+
+  server->startNetwork();
+
+  AWAIT_READY(data);
+  EXPECT_SOME_EQ("hello world", data.get());
+
+  // A group that has not read the data yet gets it from ZooKeeper.
+  Group group3(server->connectString(), NO_TIMEOUT, "/test/");
+
+  data = group3.data(membership.get());
+
+  AWAIT_READY(data);
+  EXPECT_SOME_EQ("goodbye world", data.get());
+}
+
+
+// Verifies that the copy of the data of a membership is dropped once
+// the group has learned that the membership is gone.
+TEST_F(GroupTest, GroupDataCacheInvalidation)
+{
+  Group group1(server->connectString(), NO_TIMEOUT, "/test/");
+  Group group2(server->connectString(), NO_TIMEOUT, "/test/");
+
+  Future<Group::Membership> membership = group1.join("hello world");
+
+  AWAIT_READY(membership);
+
+  Future<set<Group::Membership>> memberships = group2.watch();
+
+  AWAIT_READY(memberships);
+
+  // NOTE: Since 'group1' joining doesn't guarantee that 'group2'
+  // knows about it synchronously, we have to wait until it does.
+  if (memberships.get().empty()) {
+    memberships = group2.watch(memberships.get());
+    AWAIT_READY(memberships);
+  }
+
+  ASSERT_EQ(1u, memberships.get().count(membership.get()));
+
+  Future<Option<string>> data = group2.data(membership.get());
+
+  AWAIT_READY(data);
+  EXPECT_SOME_EQ("hello world", data.get());
+
+  AWAIT_EXPECT_TRUE(group1.cancel(membership.get()));
+
+  memberships = group2.watch(memberships.get());
+
+  AWAIT_READY(memberships);
+  EXPECT_EQ(0u, memberships.get().count(membership.get()));
+
+  data = group2.data(membership.get());
+
+  AWAIT_READY(data);
+  EXPECT_NONE(data.get());
+
+  // A later membership of the same group is not confused with the
+  // one before it.
+  membership = group1.join("hello again");
+
+  AWAIT_READY(membership);
+
+  data = group2.data(membership.get());
+
+  AWAIT_READY(data);
+  EXPECT_SOME_EQ("hello again", data.get());
+}
+
+
+// Verifies that the delays between retries are randomized, and that
+// each is between the base delay and twice the base delay.
+TEST_F(GroupTest, RetryJitter)
+{
+  const Duration duration = GroupProcess::RETRY_INTERVAL;
+
+  set<Duration> delays;
+
+  for (int i = 0; i < 100; i++) {
+    Duration delay = GroupProcess::jitter(duration);
+
+    EXPECT_LE(duration, delay);
+    EXPECT_GE(duration * 2, delay);
+
+    delays.insert(delay);
+  }
+
+  EXPECT_LT(1u, delays.size());
+}
+
+
 TEST_F(GroupTest, GroupCancelWithDisconnect)
 {
   Group group(server->connectString(), NO_TIMEOUT, "/test/");
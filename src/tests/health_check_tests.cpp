@@ -21,6 +21,7 @@
 #include <process/owned.hpp>
 #include <process/pid.hpp>
 
+#include "checks/check_scheduler.hpp"
 #include "checks/health_checker.hpp"
 
 #include "docker/docker.hpp"
@@ -248,6 +249,52 @@ TEST_F(HealthCheckTest, HealthCheckProtobufValidation)
 }
 
 
+// Tests that the check scheduler limits the number of checks that are
+// performed at a time, and that it releases the permits held by
+// checkers that terminate.
+TEST_F(HealthCheckTest, CheckSchedulerLimitsConcurrentChecks)
+{
+  class Checker : public process::Process<Checker> {};
+
+  checks::CheckScheduler scheduler(1, 0.1);
+
+  for (int i = 0; i < 10; i++) {
+    Duration jittered = scheduler.jitter(Seconds(10));
+    EXPECT_LE(Seconds(9), jittered);
+    EXPECT_GE(Seconds(11), jittered);
+  }
+
+  Checker checker1;
+  Checker checker2;
+
+  spawn(checker1);
+  spawn(checker2);
+
+  AWAIT_READY(scheduler.acquire(checker1.self()));
+
+  Future<Nothing> acquire = scheduler.acquire(checker2.self());
+
+  Future<Nothing> acquire2 = scheduler.acquire(checker1.self());
+
+  // The first permit has not been released yet.
+  EXPECT_TRUE(acquire.isPending());
+
+  scheduler.release(checker1.self());
+
+  AWAIT_READY(acquire);
+  EXPECT_TRUE(acquire2.isPending());
+
+  // Terminating `checker2` releases the permit it holds.
+  terminate(checker2);
+  wait(checker2);
+
+  AWAIT_READY(acquire2);
+
+  terminate(checker1);
+  wait(checker1);
+}
+
+
 // This test creates a healthy task and verifies that the healthy
 // status is reflected in the status updates sent as reconciliation
 // answers, and in the state endpoint of both the master and the
@@ -1457,6 +1504,71 @@ TEST_F_TEMP_DISABLED_ON_WINDOWS(HealthCheckTest, HealthyTaskViaTCP)
 }
 
 
+// Tests an unhealthy non-contained task via TCP, i.e., that the TCP
+// health check fails if nothing listens on the port.
+TEST_F_TEMP_DISABLED_ON_WINDOWS(HealthCheckTest, UnhealthyTaskViaTCP)
+{
+  master::Flags masterFlags = CreateMasterFlags();
+  masterFlags.allocation_interval = Milliseconds(50);
+  Try<Owned<cluster::Master>> master = StartMaster(masterFlags);
+  ASSERT_SOME(master);
+
+  Owned<MasterDetector> detector = master.get()->createDetector();
+  Try<Owned<cluster::Slave>> agent = StartSlave(detector.get());
+  ASSERT_SOME(agent);
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+    &sched, DEFAULT_FRAMEWORK_INFO, master.get()->pid, DEFAULT_CREDENTIAL);
+
+  EXPECT_CALL(sched, registered(&driver, _, _));
+
+  Future<vector<Offer>> offers;
+  EXPECT_CALL(sched, resourceOffers(&driver, _))
+    .WillOnce(FutureArg<1>(&offers))
+    .WillRepeatedly(Return()); // Ignore subsequent offers.
+
+  driver.start();
+
+  AWAIT_READY(offers);
+  EXPECT_NE(0u, offers.get().size());
+
+  const uint16_t testPort = getFreePort().get();
+
+  TaskInfo task = createTask(offers.get()[0], "sleep 120");
+
+  HealthCheck healthCheck;
+  healthCheck.set_type(HealthCheck::TCP);
+  healthCheck.mutable_tcp()->set_port(testPort);
+  healthCheck.set_delay_seconds(0);
+  healthCheck.set_interval_seconds(0);
+  healthCheck.set_grace_period_seconds(0);
+
+  task.mutable_health_check()->CopyFrom(healthCheck);
+
+  Future<TaskStatus> statusRunning;
+  Future<TaskStatus> statusUnhealthy;
+
+  EXPECT_CALL(sched, statusUpdate(&driver, _))
+    .WillOnce(FutureArg<1>(&statusRunning))
+    .WillOnce(FutureArg<1>(&statusUnhealthy))
+    .WillRepeatedly(Return()); // Ignore subsequent updates.
+
+  driver.launchTasks(offers.get()[0].id(), {task});
+
+  AWAIT_READY(statusRunning);
+  EXPECT_EQ(TASK_RUNNING, statusRunning.get().state());
+
+  AWAIT_READY(statusUnhealthy);
+  EXPECT_EQ(TASK_RUNNING, statusUnhealthy.get().state());
+  EXPECT_TRUE(statusUnhealthy.get().has_healthy());
+  EXPECT_FALSE(statusUnhealthy.get().healthy());
+
+  driver.stop();
+  driver.join();
+}
+
+
 // Tests a healthy task via HTTP with a container image using mesos
 // containerizer. To emulate a task responsive to HTTP health checks,
 // starts Netcat in the docker "alpine" image.
@@ -23,6 +23,8 @@
 
 #include <gmock/gmock.h>
 
+#include <mesos/attributes.hpp>
+
 #include <mesos/allocator/allocator.hpp>
 
 #include <process/clock.hpp>
@@ -37,12 +39,16 @@
 #include <stout/hashset.hpp>
 #include <stout/json.hpp>
 #include <stout/os.hpp>
+#include <stout/path.hpp>
+#include <stout/protobuf.hpp>
 #include <stout/stopwatch.hpp>
 #include <stout/utils.hpp>
 
 #include "master/constants.hpp"
 #include "master/flags.hpp"
 
+#include "master/allocator/trace.hpp"
+
 #include "master/allocator/mesos/hierarchical.hpp"
 
 #include "tests/allocator.hpp"
@@ -54,6 +60,10 @@ using mesos::internal::master::MIN_CPUS;
 using mesos::internal::master::MIN_MEM;
 
 using mesos::internal::master::allocator::HierarchicalDRFAllocator;
+using mesos::internal::master::allocator::TracingAllocator;
+
+using mesos::internal::master::allocator::internal::AgentOrdering;
+using mesos::internal::master::allocator::internal::UtilizationAgentOrdering;
 
 using mesos::internal::protobuf::createLabel;
 
@@ -164,12 +174,18 @@ protected:
         };
     }
 
+    mesos::allocator::Options options;
+    options.allocationPartitions = flags.allocation_partitions;
+    options.allocationSweepInterval = flags.allocation_sweep_interval;
+    options.agentOrdering = flags.agent_ordering;
+
     allocator->initialize(
         flags.allocation_interval,
         offerCallback.get(),
         inverseOfferCallback.get(),
         {},
-        flags.fair_sharing_excluded_resource_names);
+        flags.fair_sharing_excluded_resource_names,
+        options);
   }
 
   SlaveInfo createSlaveInfo(const Resources& resources)
@@ -873,6 +889,71 @@ TEST_F(HierarchicalAllocatorTest, MaintenanceInverseOffers)
 }
 
 
+// This test ensures that a framework is sent an inverse offer once it
+// is allocated resources on an agent that is already scheduled for
+// maintenance, and that the inverse offer is only sent again once the
+// outstanding one has been answered.
+TEST_F(HierarchicalAllocatorTest, MaintenanceInverseOffersAfterAllocation)
+{
+  Clock::pause();
+
+  initialize();
+
+  const Unavailability unavailability =
+    protobuf::maintenance::createUnavailability(
+        Clock::now() + Seconds(60));
+
+  // Create an agent that is scheduled for maintenance.
+  SlaveInfo agent = createSlaveInfo("cpus:2;mem:1024;disk:0");
+  allocator->addSlave(
+      agent.id(), agent, unavailability, agent.resources(), {});
+
+  // This framework will be offered all of the resources, and is then
+  // sent an inverse offer for them.
+  FrameworkInfo framework = createFrameworkInfo("*");
+  allocator->addFramework(framework.id(), framework, {}, true);
+
+  Allocation expected = Allocation(
+      framework.id(),
+      {{agent.id(), agent.resources()}});
+
+  AWAIT_EXPECT_EQ(expected, allocations.get());
+
+  Future<Deallocation> deallocation = deallocations.get();
+  AWAIT_READY(deallocation);
+  EXPECT_EQ(framework.id(), deallocation->frameworkId);
+  EXPECT_TRUE(deallocation->resources.contains(agent.id()));
+
+  // No further inverse offer is sent while one is outstanding.
+  deallocation = deallocations.get();
+
+  Clock::advance(flags.allocation_interval);
+  Clock::settle();
+
+  EXPECT_TRUE(deallocation.isPending());
+
+  // Once the framework has answered the inverse offer, it is sent a
+  // new one on the next allocation.
+  mesos::allocator::InverseOfferStatus status;
+  status.set_status(mesos::allocator::InverseOfferStatus::ACCEPT);
+  status.mutable_framework_id()->CopyFrom(framework.id());
+  status.mutable_timestamp()->set_nanoseconds(Clock::now().duration().ns());
+
+  allocator->updateInverseOffer(
+      agent.id(),
+      framework.id(),
+      UnavailableResources{Resources(), unavailability},
+      status,
+      None());
+
+  Clock::advance(flags.allocation_interval);
+
+  AWAIT_READY(deallocation);
+  EXPECT_EQ(framework.id(), deallocation->frameworkId);
+  EXPECT_TRUE(deallocation->resources.contains(agent.id()));
+}
+
+
 // This test ensures that allocation is done per slave. This is done
 // by having 2 slaves and 2 frameworks and making sure each framework
 // gets only one slave's resources during an allocation.
@@ -946,6 +1027,59 @@ TEST_F(HierarchicalAllocatorTest, CoarseGrained)
 }
 
 
+// This test ensures that the resources of a framework on many agents
+// can be recovered at once, including any filters.
+TEST_F(HierarchicalAllocatorTest, RecoverResourcesOnManyAgents)
+{
+  // Pausing the clock ensures that the batch allocation does not
+  // influence this test.
+  Clock::pause();
+
+  initialize();
+
+  SlaveInfo slave1 = createSlaveInfo("cpus:2;mem:1024;disk:0");
+  allocator->addSlave(slave1.id(), slave1, None(), slave1.resources(), {});
+
+  SlaveInfo slave2 = createSlaveInfo("cpus:2;mem:1024;disk:0");
+  allocator->addSlave(slave2.id(), slave2, None(), slave2.resources(), {});
+
+  FrameworkInfo framework1 = createFrameworkInfo("role1");
+  allocator->addFramework(framework1.id(), framework1, {}, true);
+
+  Allocation expected = Allocation(
+      framework1.id(),
+      {
+          {slave1.id(), slave1.resources()},
+          {slave2.id(), slave2.resources()}
+      });
+
+  Future<Allocation> allocation = allocations.get();
+  AWAIT_EXPECT_EQ(expected, allocation);
+
+  // Recover the resources on both agents and refuse them for longer
+  // than the test runs.
+  Filters filters;
+  filters.set_refuse_seconds(Days(1).secs());
+
+  allocator->recoverResources(
+      framework1.id(), allocation->resources, filters);
+
+  // The second framework is allocated the resources of both agents,
+  // since the first framework refused them.
+  FrameworkInfo framework2 = createFrameworkInfo("role2");
+  allocator->addFramework(framework2.id(), framework2, {}, true);
+
+  expected = Allocation(
+      framework2.id(),
+      {
+          {slave1.id(), slave1.resources()},
+          {slave2.id(), slave2.resources()}
+      });
+
+  AWAIT_EXPECT_EQ(expected, allocations.get());
+}
+
+
 // This test ensures that frameworks that have the same share get an
 // equal number of allocations over time (rather than the same
 // framework getting all the allocations because its name is
@@ -2384,6 +2518,66 @@ TEST_F(HierarchicalAllocatorTest, QuotaAgainstStarvation)
 }
 
 
+// This test checks that the quota headroom reflects the allocations
+// made to a quota role over several allocation cycles, so that roles
+// without quota get offered the resources beyond the quota.
+TEST_F(HierarchicalAllocatorTest, QuotaHeadroomAcrossAllocations)
+{
+  // Pausing the clock is not necessary, but ensures that the test
+  // doesn't rely on the batch allocation in the allocator, which
+  // would slow down the test.
+  Clock::pause();
+
+  const string QUOTA_ROLE{"quota-role"};
+  const string NO_QUOTA_ROLE{"no-quota-role"};
+
+  initialize();
+
+  const Quota quota = createQuota(QUOTA_ROLE, "cpus:2;mem:1024");
+  allocator->setQuota(QUOTA_ROLE, quota);
+
+  FrameworkInfo framework1 = createFrameworkInfo(QUOTA_ROLE);
+  allocator->addFramework(framework1.id(), framework1, {}, true);
+
+  // The quota is allocated in two cycles, one per agent.
+  SlaveInfo agent1 = createSlaveInfo("cpus:1;mem:512;disk:0");
+  allocator->addSlave(agent1.id(), agent1, None(), agent1.resources(), {});
+
+  Allocation expected = Allocation(
+      framework1.id(),
+      {{agent1.id(), agent1.resources()}});
+
+  AWAIT_EXPECT_EQ(expected, allocations.get());
+
+  SlaveInfo agent2 = createSlaveInfo("cpus:1;mem:512;disk:0");
+  allocator->addSlave(agent2.id(), agent2, None(), agent2.resources(), {});
+
+  expected = Allocation(
+      framework1.id(),
+      {{agent2.id(), agent2.resources()}});
+
+  AWAIT_EXPECT_EQ(expected, allocations.get());
+
+  // Total cluster resources: cpus=2, mem=1024.
+  // QUOTA_ROLE share = 1 (cpus=2, mem=1024) [quota: cpus=2, mem=1024]
+  //   framework1 share = 1
+
+  FrameworkInfo framework2 = createFrameworkInfo(NO_QUOTA_ROLE);
+  allocator->addFramework(framework2.id(), framework2, {}, true);
+
+  // The quota is satisfied, so none of the resources of `agent3` are
+  // set aside for it and they are allocated to `framework2`.
+  SlaveInfo agent3 = createSlaveInfo("cpus:1;mem:512;disk:0");
+  allocator->addSlave(agent3.id(), agent3, None(), agent3.resources(), {});
+
+  expected = Allocation(
+      framework2.id(),
+      {{agent3.id(), agent3.resources()}});
+
+  AWAIT_EXPECT_EQ(expected, allocations.get());
+}
+
+
 // This test checks that quota is respected even for roles that do not
 // have any frameworks currently registered. It also ensures an event-
 // triggered allocation does not unnecessarily deprive non-quota'ed
@@ -3100,6 +3294,64 @@ TEST_F_TEMP_DISABLED_ON_WINDOWS(
 }
 
 
+// This test checks that the per-stage allocation run metrics are
+// reported, and that the agents skipped and the sorter clients visited
+// by the allocation algorithm are counted.
+TEST_F_TEMP_DISABLED_ON_WINDOWS(
+    HierarchicalAllocatorTest,
+    AllocationRunStageMetrics)
+{
+  Clock::pause();
+
+  initialize();
+
+  SlaveInfo agent1 = createSlaveInfo("cpus:2;mem:1024;disk:0");
+  allocator->addSlave(agent1.id(), agent1, None(), agent1.resources(), {});
+
+  SlaveInfo agent2 = createSlaveInfo("cpus:2;mem:1024;disk:0");
+  allocator->addSlave(agent2.id(), agent2, None(), agent2.resources(), {});
+
+  // Wait for the allocations triggered by `addSlave()` to complete, so
+  // that the second agent is only skipped by the allocation below.
+  Clock::settle();
+
+  allocator->deactivateSlave(agent2.id());
+
+  // The allocation triggered by `addFramework()` visits the role and
+  // the framework on the first agent, and skips the second agent.
+  FrameworkInfo framework = createFrameworkInfo("role1");
+  allocator->addFramework(framework.id(), framework, {}, true);
+
+  AWAIT_READY(allocations.get());
+
+  Clock::settle();
+
+  JSON::Object metrics = Metrics();
+
+  auto stages = {
+    "allocator/mesos/allocation_run/candidates_ms",
+    "allocator/mesos/allocation_run/quota_stage_ms",
+    "allocator/mesos/allocation_run/fair_share_stage_ms",
+    "allocator/mesos/allocation_run/sort_ms",
+    "allocator/mesos/allocation_run/filters_ms",
+    "allocator/mesos/allocation_run/offer_callbacks_ms",
+  };
+
+  foreach (const string& stage, stages) {
+    EXPECT_EQ(1u, metrics.values.count(stage))
+      << "Expected " << stage << " to be present";
+  }
+
+  JSON::Object expected;
+  expected.values = {
+    {"allocator/mesos/allocation_run/sorter_clients_visited", 2},
+    {"allocator/mesos/allocation_run/agents_skipped", 1},
+  };
+
+  EXPECT_TRUE(JSON::Value(metrics).contains(expected));
+}
+
+
 // This test checks that per-role active offer filter metrics
 // are correctly reported in the metrics endpoint.
 TEST_F_TEMP_DISABLED_ON_WINDOWS(
@@ -3715,6 +3967,386 @@ TEST_P(HierarchicalAllocatorTestWithParam, AllocateSharedResources)
 }
 
 
+// Tests that when agents are allocated in multiple partitions, the
+// quota allocations made by different partitions are reconciled so that
+// a role's quota is not allocated more than once, and that resources
+// dropped while reconciling are offered to other roles afterwards.
+TEST_F(HierarchicalAllocatorTest, AllocationPartitions)
+{
+  // Pausing the clock is not necessary, but ensures that the test
+  // doesn't rely on the batch allocation in the allocator, which
+  // would slow down the test.
+  Clock::pause();
+
+  const string QUOTA_ROLE{"quota-role"};
+  const string NO_QUOTA_ROLE{"no-quota-role"};
+
+  master::Flags flags_;
+  flags_.allocation_partitions = 2;
+
+  initialize(flags_);
+
+  SlaveInfo agent1 = createSlaveInfo("cpus:2;mem:1024;disk:0");
+  allocator->addSlave(agent1.id(), agent1, None(), agent1.resources(), {});
+
+  SlaveInfo agent2 = createSlaveInfo("cpus:2;mem:1024;disk:0");
+  allocator->addSlave(agent2.id(), agent2, None(), agent2.resources(), {});
+
+  const Quota quota = createQuota(QUOTA_ROLE, "cpus:2;mem:1024");
+  allocator->setQuota(QUOTA_ROLE, quota);
+
+  // Process all triggered allocation events.
+  //
+  // NOTE: No allocations happen because there are no frameworks.
+  Clock::settle();
+
+  // Each agent is in its own partition, so both partitions try to
+  // satisfy the quota of `framework1`'s role with their agent. Only
+  // one of these allocations is kept since either agent alone
+  // satisfies the quota.
+  FrameworkInfo framework1 = createFrameworkInfo(QUOTA_ROLE);
+  allocator->addFramework(framework1.id(), framework1, {}, true);
+
+  Future<Allocation> allocation = allocations.get();
+  AWAIT_READY(allocation);
+
+  EXPECT_EQ(framework1.id(), allocation->frameworkId);
+  ASSERT_EQ(1u, allocation->resources.size());
+
+  const SlaveID quotaAgentId = allocation->resources.begin()->first;
+  EXPECT_EQ(
+      Resources(agent1.resources()),
+      allocation->resources.begin()->second);
+
+  // Total cluster resources: cpus=4, mem=2048.
+  // QUOTA_ROLE share = 0.5 (cpus=2, mem=1024) [quota: cpus=2, mem=1024]
+  //   framework1 share = 1
+  // NO_QUOTA_ROLE share = 0
+
+  // `framework2` will be offered the other agent, which was left
+  // unallocated when reconciling the quota allocations.
+  FrameworkInfo framework2 = createFrameworkInfo(NO_QUOTA_ROLE);
+  allocator->addFramework(framework2.id(), framework2, {}, true);
+
+  const SlaveInfo& otherAgent =
+    quotaAgentId == agent1.id() ? agent2 : agent1;
+
+  Allocation expected = Allocation(
+      framework2.id(),
+      {{otherAgent.id(), otherAgent.resources()}});
+
+  AWAIT_EXPECT_EQ(expected, allocations.get());
+}
+
+
+// This test ensures that with event driven allocation, resources that
+// are recovered on an agent are offered again by the next batch
+// allocation, and that events affecting a role allocate all agents to
+// that role.
+TEST_F(HierarchicalAllocatorTest, EventDrivenAllocation)
+{
+  Clock::pause();
+
+  master::Flags flags_;
+  flags_.allocation_sweep_interval = flags_.allocation_interval * 10;
+
+  initialize(flags_);
+
+  FrameworkInfo framework1 = createFrameworkInfo("role1");
+  allocator->addFramework(framework1.id(), framework1, {}, true);
+
+  SlaveInfo agent = createSlaveInfo("cpus:1;mem:512;disk:0");
+  allocator->addSlave(agent.id(), agent, None(), agent.resources(), {});
+
+  Allocation expected = Allocation(
+      framework1.id(),
+      {{agent.id(), agent.resources()}});
+
+  AWAIT_EXPECT_EQ(expected, allocations.get());
+
+  // Recovering the resources marks the agent so that the next batch
+  // allocation offers them again, well before the next full sweep.
+  allocator->recoverResources(
+      framework1.id(),
+      agent.id(),
+      agent.resources(),
+      None());
+
+  Future<Allocation> allocation = allocations.get();
+  Clock::settle();
+  EXPECT_TRUE(allocation.isPending());
+
+  Clock::advance(flags_.allocation_interval);
+
+  AWAIT_EXPECT_EQ(expected, allocation);
+
+  // Decline the resources for longer than the sweep interval.
+  Filters filter1000s;
+  filter1000s.set_refuse_seconds(1000.);
+  allocator->recoverResources(
+      framework1.id(),
+      agent.id(),
+      agent.resources(),
+      filter1000s);
+
+  Clock::advance(flags_.allocation_interval);
+  Clock::settle();
+
+  allocation = allocations.get();
+  EXPECT_TRUE(allocation.isPending());
+
+  // Adding a framework in another role allocates all agents to it.
+  FrameworkInfo framework2 = createFrameworkInfo("role2");
+  allocator->addFramework(framework2.id(), framework2, {}, true);
+
+  expected = Allocation(
+      framework2.id(),
+      {{agent.id(), agent.resources()}});
+
+  AWAIT_EXPECT_EQ(expected, allocation);
+}
+
+
+// This test ensures that with event driven allocation, inverse offers
+// are sent by the next batch allocation rather than the next sweep,
+// even though the agent they are for does not need to be allocated.
+TEST_F(HierarchicalAllocatorTest, EventDrivenAllocationInverseOffers)
+{
+  Clock::pause();
+
+  master::Flags flags_;
+  flags_.allocation_sweep_interval = flags_.allocation_interval * 10;
+
+  initialize(flags_);
+
+  const Unavailability unavailability =
+    protobuf::maintenance::createUnavailability(
+        Clock::now() + Seconds(60));
+
+  SlaveInfo agent = createSlaveInfo("cpus:2;mem:1024;disk:0");
+  allocator->addSlave(
+      agent.id(), agent, unavailability, agent.resources(), {});
+
+  FrameworkInfo framework = createFrameworkInfo("*");
+  allocator->addFramework(framework.id(), framework, {}, true);
+
+  Allocation expected = Allocation(
+      framework.id(),
+      {{agent.id(), agent.resources()}});
+
+  AWAIT_EXPECT_EQ(expected, allocations.get());
+
+  Future<Deallocation> deallocation = deallocations.get();
+  AWAIT_READY(deallocation);
+  EXPECT_EQ(framework.id(), deallocation->frameworkId);
+
+  // Answering the inverse offer does not make the agent dirty, since
+  // no resources became offerable, but the new inverse offer is sent
+  // by the next batch allocation rather than the next sweep.
+  deallocation = deallocations.get();
+
+  mesos::allocator::InverseOfferStatus status;
+  status.set_status(mesos::allocator::InverseOfferStatus::ACCEPT);
+  status.mutable_framework_id()->CopyFrom(framework.id());
+  status.mutable_timestamp()->set_nanoseconds(Clock::now().duration().ns());
+
+  allocator->updateInverseOffer(
+      agent.id(),
+      framework.id(),
+      UnavailableResources{Resources(), unavailability},
+      status,
+      None());
+
+  Clock::settle();
+  EXPECT_TRUE(deallocation.isPending());
+
+  Clock::advance(flags_.allocation_interval);
+
+  AWAIT_READY(deallocation);
+  EXPECT_EQ(framework.id(), deallocation->frameworkId);
+  EXPECT_TRUE(deallocation->resources.contains(agent.id()));
+}
+
+
+// Tests that the tracing allocator records the calls to the allocator
+// that it wraps, in order, such that they can be read back.
+TEST_F(HierarchicalAllocatorTest, Trace)
+{
+  Clock::pause();
+
+  Try<string> trace = os::mktemp(path::join(os::getcwd(), "XXXXXX"));
+  ASSERT_SOME(trace);
+
+  Try<Allocator*> tracing = TracingAllocator::create(allocator, trace.get());
+  ASSERT_SOME(tracing);
+
+  // The tracing allocator owns the hierarchical allocator now, and
+  // is deleted by the test fixture.
+  allocator = tracing.get();
+
+  initialize();
+
+  SlaveInfo agent = createSlaveInfo("cpus:2;mem:1024;disk:0");
+  allocator->addSlave(agent.id(), agent, None(), agent.resources(), {});
+
+  FrameworkInfo framework = createFrameworkInfo("role1");
+  allocator->addFramework(framework.id(), framework, {}, true);
+
+  Allocation expected = Allocation(
+      framework.id(),
+      {{agent.id(), agent.resources()}});
+
+  AWAIT_EXPECT_EQ(expected, allocations.get());
+
+  allocator->recoverResources(
+      framework.id(), agent.id(), agent.resources(), None());
+
+  // Deleting the tracing allocator writes out the buffered calls.
+  delete allocator;
+  allocator = createAllocator<HierarchicalDRFAllocator>();
+
+  Result<google::protobuf::RepeatedPtrField<AllocatorCall>> calls =
+    ::protobuf::read<google::protobuf::RepeatedPtrField<AllocatorCall>>(
+        trace.get());
+
+  ASSERT_SOME(calls);
+  ASSERT_EQ(4, calls->size());
+
+  EXPECT_EQ(AllocatorCall::INITIALIZE, calls->Get(0).type());
+  EXPECT_EQ(flags.allocation_interval,
+            Seconds(calls->Get(0).initialize().allocation_interval_seconds()));
+
+  EXPECT_EQ(AllocatorCall::ADD_SLAVE, calls->Get(1).type());
+  EXPECT_EQ(agent.id(), calls->Get(1).slave_id());
+  EXPECT_EQ(agent.resources(), Resources(calls->Get(1).resources()));
+
+  EXPECT_EQ(AllocatorCall::ADD_FRAMEWORK, calls->Get(2).type());
+  EXPECT_EQ(framework.id(), calls->Get(2).framework_id());
+  EXPECT_TRUE(calls->Get(2).active());
+
+  EXPECT_EQ(AllocatorCall::RECOVER_RESOURCES, calls->Get(3).type());
+  EXPECT_EQ(framework.id(), calls->Get(3).framework_id());
+  EXPECT_EQ(agent.id(), calls->Get(3).slave_id());
+  EXPECT_EQ(agent.resources(), Resources(calls->Get(3).resources()));
+
+  ASSERT_SOME(os::rm(trace.get()));
+}
+
+
+static SlaveID createSlaveId(const string& value)
+{
+  SlaveID slaveId;
+  slaveId.set_value(value);
+  return slaveId;
+}
+
+
+TEST(AgentOrderingTest, Create)
+{
+  const vector<string> names =
+    {"random", "bin_packing", "spread", "locality:rack"};
+
+  foreach (const string& name, names) {
+    Try<AgentOrdering*> ordering = AgentOrdering::create(name);
+    ASSERT_SOME(ordering) << name;
+    delete ordering.get();
+  }
+
+  EXPECT_ERROR(AgentOrdering::create("locality:"));
+  EXPECT_ERROR(AgentOrdering::create("best_fit"));
+}
+
+
+// Tests that bin packing orders the most allocated agents first and
+// that the order follows changes to the allocations.
+TEST(AgentOrderingTest, BinPacking)
+{
+  UtilizationAgentOrdering ordering(true);
+
+  const Resources total = Resources::parse("cpus:4;mem:1024").get();
+
+  const SlaveID agent1 = createSlaveId("agent1");
+  const SlaveID agent2 = createSlaveId("agent2");
+  const SlaveID agent3 = createSlaveId("agent3");
+
+  ordering.add(agent1, SlaveInfo(), total, Resources());
+  ordering.add(
+      agent2, SlaveInfo(), total, Resources::parse("cpus:2;mem:128").get());
+  ordering.add(
+      agent3, SlaveInfo(), total, Resources::parse("cpus:1;mem:768").get());
+
+  // The utilization of an agent is that of its most allocated resource.
+  EXPECT_EQ(vector<SlaveID>({agent3, agent2, agent1}),
+            ordering.order({agent1, agent2, agent3}));
+
+  ordering.update(agent1, total, Resources::parse("cpus:4").get());
+
+  EXPECT_EQ(vector<SlaveID>({agent1, agent3, agent2}),
+            ordering.order({agent1, agent2, agent3}));
+
+  // Only the requested agents are returned.
+  EXPECT_EQ(vector<SlaveID>({agent1, agent2}),
+            ordering.order({agent2, agent1}));
+
+  ordering.remove(agent3);
+
+  EXPECT_EQ(vector<SlaveID>({agent1, agent2}),
+            ordering.order({agent1, agent2}));
+}
+
+
+TEST(AgentOrderingTest, Spread)
+{
+  UtilizationAgentOrdering ordering(false);
+
+  const Resources total = Resources::parse("cpus:4;mem:1024").get();
+
+  const SlaveID agent1 = createSlaveId("agent1");
+  const SlaveID agent2 = createSlaveId("agent2");
+
+  ordering.add(
+      agent1, SlaveInfo(), total, Resources::parse("cpus:2").get());
+  ordering.add(agent2, SlaveInfo(), total, Resources());
+
+  EXPECT_EQ(vector<SlaveID>({agent2, agent1}),
+            ordering.order({agent1, agent2}));
+
+  ordering.update(agent2, total, Resources::parse("cpus:3").get());
+
+  EXPECT_EQ(vector<SlaveID>({agent1, agent2}),
+            ordering.order({agent1, agent2}));
+}
+
+
+// Tests that the locality ordering keeps agents with the same value of
+// the attribute together, and orders agents lacking the attribute last.
+TEST(AgentOrderingTest, Locality)
+{
+  UtilizationAgentOrdering ordering(true, string("rack"));
+
+  const Resources total = Resources::parse("cpus:4;mem:1024").get();
+
+  const SlaveID agent1 = createSlaveId("agent1");
+  const SlaveID agent2 = createSlaveId("agent2");
+  const SlaveID agent3 = createSlaveId("agent3");
+  const SlaveID agent4 = createSlaveId("agent4");
+
+  SlaveInfo rack1;
+  rack1.mutable_attributes()->CopyFrom(Attributes::parse("rack:r1"));
+
+  SlaveInfo rack2;
+  rack2.mutable_attributes()->CopyFrom(Attributes::parse("rack:r2"));
+
+  ordering.add(agent1, SlaveInfo(), total, Resources::parse("cpus:4").get());
+  ordering.add(agent2, rack2, total, Resources::parse("cpus:3").get());
+  ordering.add(agent3, rack1, total, Resources());
+  ordering.add(agent4, rack2, total, Resources::parse("cpus:1").get());
+
+  EXPECT_EQ(vector<SlaveID>({agent3, agent2, agent4, agent1}),
+            ordering.order({agent1, agent2, agent3, agent4}));
+}
+
+
 class HierarchicalAllocator_BENCHMARK_Test
   : public HierarchicalAllocatorTestBase,
     public WithParamInterface<std::tr1::tuple<size_t, size_t>> {};
@@ -4466,6 +5098,117 @@ TEST_P(HierarchicalAllocator_BENCHMARK_Test, AllocatorBacklog)
        << " allocation runs" << endl;
 }
 
+
+class HierarchicalAllocatorPartitions_BENCHMARK_Test
+  : public HierarchicalAllocatorTestBase,
+    public WithParamInterface<std::tr1::tuple<size_t, size_t, size_t>> {};
+
+
+// These benchmark tests are parameterized by the number of agents, the
+// number of frameworks and the number of allocation partitions.
+INSTANTIATE_TEST_CASE_P(
+    SlaveFrameworkAndPartitionCount,
+    HierarchicalAllocatorPartitions_BENCHMARK_Test,
+    ::testing::Combine(
+      ::testing::Values(1000U, 5000U, 10000U, 20000U, 50000U),
+      ::testing::Values(1U, 100U, 1000U),
+      ::testing::Values(1U, 2U, 4U, 8U))
+    );
+
+
+// This benchmark measures the duration of batch allocations in which
+// all resources in the cluster are offered, when the agents are split
+// into the given number of allocation partitions.
+TEST_P(HierarchicalAllocatorPartitions_BENCHMARK_Test, Allocate)
+{
+  size_t agentCount = std::tr1::get<0>(GetParam());
+  size_t frameworkCount = std::tr1::get<1>(GetParam());
+  size_t partitionCount = std::tr1::get<2>(GetParam());
+
+  // Pause the clock because we want to manually drive the allocations.
+  Clock::pause();
+
+  struct OfferedResources
+  {
+    FrameworkID   frameworkId;
+    SlaveID       slaveId;
+    Resources     resources;
+  };
+
+  vector<OfferedResources> offers;
+
+  auto offerCallback = [&offers](
+      const FrameworkID& frameworkId,
+      const hashmap<SlaveID, Resources>& resources)
+  {
+    foreachpair (const SlaveID& slaveId, const Resources& r, resources) {
+      offers.push_back(OfferedResources{frameworkId, slaveId, r});
+    }
+  };
+
+  cout << "Using " << agentCount << " agents, "
+       << frameworkCount << " frameworks and "
+       << partitionCount << " allocation partitions" << endl;
+
+  master::Flags flags;
+  flags.allocation_partitions = partitionCount;
+
+  initialize(flags, offerCallback);
+
+  for (size_t i = 0; i < frameworkCount; i++) {
+    FrameworkInfo framework = createFrameworkInfo("*");
+    allocator->addFramework(framework.id(), framework, {}, true);
+  }
+
+  const Resources agentResources = Resources::parse(
+      "cpus:24;mem:4096;disk:4096;ports:[31000-32000]").get();
+
+  for (size_t i = 0; i < agentCount; i++) {
+    SlaveInfo agent = createSlaveInfo(agentResources);
+    allocator->addSlave(agent.id(), agent, None(), agent.resources(), {});
+  }
+
+  // Wait for all the `addFramework` and `addSlave` operations to be
+  // processed.
+  Clock::settle();
+
+  // To ensure the test can run in a timely manner, we always perform a
+  // fixed number of allocations.
+  size_t allocationsCount = 5;
+
+  Stopwatch watch;
+
+  for (size_t i = 0; i < allocationsCount; ++i) {
+    // Recover resources with no filters so that all resources in the
+    // cluster are offered by the next allocation.
+    foreach (const OfferedResources& offer, offers) {
+      allocator->recoverResources(
+          offer.frameworkId,
+          offer.slaveId,
+          offer.resources,
+          None());
+    }
+
+    // Wait for all declined offers to be processed.
+    Clock::settle();
+    offers.clear();
+
+    watch.start();
+
+    // Advance the clock and trigger a batch allocation.
+    Clock::advance(flags.allocation_interval);
+    Clock::settle();
+
+    watch.stop();
+
+    cout << "allocate() took " << watch.elapsed()
+         << " to make " << offers.size() << " offers with "
+         << partitionCount << " allocation partitions" << endl;
+  }
+
+  Clock::resume();
+}
+
 } // namespace tests {
 } // namespace internal {
 } // namespace mesos {
@@ -226,6 +226,50 @@ TEST_F_TEMP_DISABLED_ON_WINDOWS(HookTest, VerifyMasterLaunchTaskHook)
 }
 
 
+// Test that the asynchronous variant of the master label decorator
+// yields the same labels as the synchronous one and records the
+// latency of the hook module.
+TEST_F_TEMP_DISABLED_ON_WINDOWS(HookTest, VerifyMasterLaunchTaskHookAsync)
+{
+  TaskInfo task;
+  task.set_name("");
+  task.mutable_task_id()->set_value("1");
+  task.mutable_slave_id()->set_value("slave");
+  task.mutable_executor()->CopyFrom(DEFAULT_EXECUTOR_INFO);
+
+  // Add label which will be removed by the hook.
+  task.mutable_labels()->add_labels()->CopyFrom(createLabel(
+      testRemoveLabelKey, testRemoveLabelValue));
+
+  SlaveInfo slaveInfo;
+  slaveInfo.set_hostname("localhost");
+
+  Future<Labels> labels = HookManager::masterLaunchTaskLabelDecoratorAsync(
+      task, DEFAULT_FRAMEWORK_INFO, slaveInfo);
+
+  AWAIT_READY(labels);
+  ASSERT_EQ(1, labels->labels_size());
+
+  EXPECT_EQ(testLabelKey, labels->labels(0).key());
+  EXPECT_EQ(testLabelValue, labels->labels(0).value());
+
+  EXPECT_EQ(
+      HookManager::masterLaunchTaskLabelDecorator(
+          task, DEFAULT_FRAMEWORK_INFO, slaveInfo),
+      labels.get());
+
+  const string prefix = "hooks/" + string(HOOK_MODULE_NAME);
+
+  JSON::Object metrics = Metrics();
+
+  EXPECT_EQ(
+      1u,
+      metrics.values.count(prefix + "/master_launch_task_label_decorator_ms"));
+
+  EXPECT_EQ(0u, metrics.values[prefix + "/timeouts"]);
+}
+
+
 // This test forces a `SlaveLost` event. When this happens, we expect the
 // `masterSlaveLostHook` to be invoked and await an internal libprocess event
 // to trigger in the module code.
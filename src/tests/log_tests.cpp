@@ -16,6 +16,7 @@
 
 #include <stdint.h>
 
+#include <iostream>
 #include <list>
 #include <set>
 #include <string>
@@ -34,12 +35,14 @@
 #include <process/protobuf.hpp>
 #include <process/shared.hpp>
 
+#include <stout/foreach.hpp>
 #include <stout/gtest.hpp>
 #include <stout/none.hpp>
 #include <stout/option.hpp>
 #include <stout/os.hpp>
 #include <stout/path.hpp>
 #include <stout/stopwatch.hpp>
+#include <stout/stringify.hpp>
 #include <stout/try.hpp>
 
 #include <stout/tests/utils.hpp>
@@ -51,6 +54,7 @@
 #include "log/storage.hpp"
 #include "log/recover.hpp"
 #include "log/replica.hpp"
+#include "log/segmented.hpp"
 #include "log/tool/initialize.hpp"
 
 #include "tests/environment.hpp"
@@ -65,6 +69,8 @@ using namespace mesos::internal::log;
 
 using namespace process;
 
+using std::cout;
+using std::endl;
 using std::list;
 using std::set;
 using std::string;
@@ -133,7 +139,7 @@ template <typename T>
 class LogStorageTest : public TemporaryDirectoryTest {};
 
 
-typedef ::testing::Types<LevelDBStorage> LogStorageTypes;
+typedef ::testing::Types<LevelDBStorage, SegmentedStorage> LogStorageTypes;
 
 
 TYPED_TEST_CASE(LogStorageTest, LogStorageTypes);
@@ -161,7 +167,7 @@ TYPED_TEST(LogStorageTest, Truncate)
     action.set_type(Action::APPEND);
     action.mutable_append()->set_bytes(stringify(i));
 
-    ASSERT_SOME(storage.persist(action));
+    ASSERT_SOME(storage.persist(action, true));
   }
 
   for (uint64_t i = 0; i < 10; i++) {
@@ -186,7 +192,7 @@ TYPED_TEST(LogStorageTest, Truncate)
   truncate.set_type(Action::TRUNCATE);
   truncate.mutable_truncate()->set_to(3);
 
-  ASSERT_SOME(storage.persist(truncate));
+  ASSERT_SOME(storage.persist(truncate, true));
 
   for (uint64_t i = 0; i < 11; i++) {
     Try<Action> action = storage.read(i);
@@ -222,7 +228,7 @@ TYPED_TEST(LogStorageTest, Truncate)
   truncate.set_type(Action::TRUNCATE);
   truncate.mutable_truncate()->set_to(10);
 
-  ASSERT_SOME(storage.persist(truncate));
+  ASSERT_SOME(storage.persist(truncate, true));
 
   for (uint64_t i = 0; i < 12; i++) {
     Try<Action> action = storage.read(i);
@@ -268,7 +274,7 @@ TYPED_TEST(LogStorageTest, TruncateWithEmptyLog)
   truncate.set_type(Action::TRUNCATE);
   truncate.mutable_truncate()->set_to(0);
 
-  ASSERT_SOME(storage.persist(truncate));
+  ASSERT_SOME(storage.persist(truncate, true));
 
   Try<Action> action0 = storage.read(0);
   EXPECT_ERROR(action0);
@@ -303,7 +309,7 @@ TYPED_TEST(LogStorageTest, TruncateWithManyHoles)
   Stopwatch stopwatch;
   stopwatch.start();
 
-  ASSERT_SOME(storage.persist(truncate));
+  ASSERT_SOME(storage.persist(truncate, true));
 
   // This truncation should not take much time because no position is
   // actually being truncated.
@@ -321,6 +327,89 @@ TYPED_TEST(LogStorageTest, TruncateWithManyHoles)
 }
 
 
+// This test verifies that the state of the log is restored after
+// writes, overwrites and truncations.
+TYPED_TEST(LogStorageTest, Restore)
+{
+  const string path = os::getcwd() + "/.log";
+
+  {
+    TypeParam storage;
+
+    Try<Storage::State> state = storage.restore(path);
+    ASSERT_SOME(state);
+
+    Metadata metadata;
+    metadata.set_status(Metadata::VOTING);
+    metadata.set_promised(1);
+
+    ASSERT_SOME(storage.persist(metadata, true));
+
+    // Append from position 1 to position 10, only learning the even
+    // positions.
+    for (uint64_t i = 1; i <= 10; i++) {
+      Action action;
+      action.set_position(i);
+      action.set_promised(1);
+      action.set_performed(1);
+      action.set_learned(i % 2 == 0);
+      action.set_type(Action::APPEND);
+      action.mutable_append()->set_bytes(stringify(i));
+
+      ASSERT_SOME(storage.persist(action, false));
+    }
+
+    // Learn position 5 with a different value.
+    Action action;
+    action.set_position(5);
+    action.set_promised(2);
+    action.set_performed(2);
+    action.set_learned(true);
+    action.set_type(Action::APPEND);
+    action.mutable_append()->set_bytes("five");
+
+    ASSERT_SOME(storage.persist(action, false));
+
+    // Truncate to position 3 (at position 11).
+    Action truncate;
+    truncate.set_position(11);
+    truncate.set_promised(1);
+    truncate.set_performed(1);
+    truncate.set_learned(true);
+    truncate.set_type(Action::TRUNCATE);
+    truncate.mutable_truncate()->set_to(3);
+
+    ASSERT_SOME(storage.persist(truncate, false));
+
+    ASSERT_SOME(storage.sync());
+  }
+
+  TypeParam storage;
+
+  Try<Storage::State> state = storage.restore(path);
+  ASSERT_SOME(state);
+
+  EXPECT_EQ(Metadata::VOTING, state->metadata.status());
+  EXPECT_EQ(1u, state->metadata.promised());
+  EXPECT_EQ(3u, state->begin);
+  EXPECT_EQ(11u, state->end);
+
+  for (uint64_t i = 3; i <= 10; i++) {
+    EXPECT_EQ(i % 2 == 0 || i == 5, state->learned.contains(i));
+    EXPECT_EQ(i % 2 != 0 && i != 5, state->unlearned.contains(i));
+  }
+
+  Try<Action> action = storage.read(5);
+  ASSERT_SOME(action);
+  EXPECT_EQ(2u, action->performed());
+  EXPECT_EQ("five", action->append().bytes());
+
+  action = storage.read(10);
+  ASSERT_SOME(action);
+  EXPECT_EQ("10", action->append().bytes());
+}
+
+
 class ReplicaTest : public TemporaryDirectoryTest
 {
 protected:
@@ -534,6 +623,69 @@ TEST_F(ReplicaTest, Restore)
 }
 
 
+// This test verifies that concurrent write requests, which the
+// replica commits together, are all accepted and persisted.
+TEST_F(ReplicaTest, GroupCommit)
+{
+  const string path = os::getcwd() + "/.log";
+  initializer.flags.path = path;
+  ASSERT_SOME(initializer.execute());
+
+  const uint64_t proposal = 1;
+  const uint64_t writes = 10;
+
+  {
+    Replica replica1(path);
+
+    PromiseRequest request1;
+    request1.set_proposal(proposal);
+
+    Future<PromiseResponse> response1 =
+      protocol::promise(replica1.pid(), request1);
+
+    AWAIT_READY(response1);
+    EXPECT_EQ(PromiseResponse::ACCEPT, response1->type());
+
+    // Send all the write requests before waiting for any responses.
+    list<Future<WriteResponse>> responses;
+    for (uint64_t position = 1; position <= writes; position++) {
+      WriteRequest request;
+      request.set_proposal(proposal);
+      request.set_position(position);
+      request.set_type(Action::APPEND);
+      request.mutable_append()->set_bytes(stringify(position));
+
+      responses.push_back(protocol::write(replica1.pid(), request));
+    }
+
+    uint64_t position = 1;
+    foreach (const Future<WriteResponse>& response, responses) {
+      AWAIT_READY(response);
+      EXPECT_EQ(WriteResponse::ACCEPT, response->type());
+      EXPECT_TRUE(response->okay());
+      EXPECT_EQ(position++, response->position());
+    }
+  }
+
+  {
+    Replica replica2(path);
+
+    Future<list<Action>> actions = replica2.read(1, writes);
+
+    AWAIT_READY(actions);
+    ASSERT_EQ(writes, actions->size());
+
+    uint64_t position = 1;
+    foreach (const Action& action, actions.get()) {
+      EXPECT_EQ(position, action.position());
+      EXPECT_EQ(Action::APPEND, action.type());
+      EXPECT_EQ(stringify(position), action.append().bytes());
+      position++;
+    }
+  }
+}
+
+
 // This test verifies that a non-VOTING replica replies to promise and
 // write requests with an "ignored" response.
 TEST_F(ReplicaTest, NonVoting)
@@ -1205,6 +1357,120 @@ TEST_F(CoordinatorTest, MultipleAppends)
 }
 
 
+// Ensures that appends that are started while earlier appends are
+// still in progress get consecutive positions and complete in order.
+TEST_F(CoordinatorTest, PipelinedAppends)
+{
+  const string path1 = os::getcwd() + "/.log1";
+  initializer.flags.path = path1;
+  ASSERT_SOME(initializer.execute());
+
+  const string path2 = os::getcwd() + "/.log2";
+  initializer.flags.path = path2;
+  ASSERT_SOME(initializer.execute());
+
+  Shared<Replica> replica1(new Replica(path1));
+  Shared<Replica> replica2(new Replica(path2));
+
+  set<UPID> pids;
+  pids.insert(replica1->pid());
+  pids.insert(replica2->pid());
+
+  Shared<Network> network(new Network(pids));
+
+  Coordinator coord(2, replica1, network);
+
+  {
+    Future<Option<uint64_t>> electing = coord.elect();
+    AWAIT_READY(electing);
+    EXPECT_SOME_EQ(0u, electing.get());
+  }
+
+  list<Future<Option<uint64_t>>> appends;
+  for (uint64_t position = 1; position <= 10; position++) {
+    appends.push_back(coord.append(stringify(position)));
+  }
+
+  uint64_t position = 1;
+  foreach (const Future<Option<uint64_t>>& appending, appends) {
+    AWAIT_READY(appending);
+    EXPECT_SOME_EQ(position++, appending.get());
+  }
+
+  {
+    Future<list<Action>> actions = replica1->read(1, 10);
+    AWAIT_READY(actions);
+    EXPECT_EQ(10u, actions->size());
+    foreach (const Action& action, actions.get()) {
+      ASSERT_TRUE(action.has_type());
+      ASSERT_EQ(Action::APPEND, action.type());
+      EXPECT_EQ(stringify(action.position()), action.append().bytes());
+    }
+  }
+
+  // The coordinator is still elected once all appends have completed.
+  {
+    Future<Option<uint64_t>> appending = coord.append("hello world");
+    AWAIT_READY(appending);
+    EXPECT_SOME_EQ(11u, appending.get());
+  }
+}
+
+
+// Ensures that discarding an append demotes the coordinator, and that
+// the appends started after it return none.
+TEST_F(CoordinatorTest, PipelinedAppendDiscarded)
+{
+  const string path1 = os::getcwd() + "/.log1";
+  initializer.flags.path = path1;
+  ASSERT_SOME(initializer.execute());
+
+  const string path2 = os::getcwd() + "/.log2";
+  initializer.flags.path = path2;
+  ASSERT_SOME(initializer.execute());
+
+  Shared<Replica> replica1(new Replica(path1));
+  Shared<Replica> replica2(new Replica(path2));
+
+  set<UPID> pids;
+  pids.insert(replica1->pid());
+  pids.insert(replica2->pid());
+
+  Shared<Network> network(new Network(pids));
+
+  Coordinator coord(2, replica1, network);
+
+  {
+    Future<Option<uint64_t>> electing = coord.elect();
+    AWAIT_READY(electing);
+    EXPECT_SOME_EQ(0u, electing.get());
+  }
+
+  process::terminate(replica2->pid());
+  process::wait(replica2->pid());
+  replica2.reset();
+
+  Future<Option<uint64_t>> appending1 = coord.append("hello world");
+  Future<Option<uint64_t>> appending2 = coord.append("hello moto");
+
+  ASSERT_TRUE(appending1.isPending());
+  ASSERT_TRUE(appending2.isPending());
+
+  appending1.discard();
+
+  AWAIT_DISCARDED(appending1);
+
+  AWAIT_READY(appending2);
+  EXPECT_NONE(appending2.get());
+
+  {
+    Future<Option<uint64_t>> appending = coord.append("hello hello");
+    AWAIT_READY(appending);
+    EXPECT_NONE(appending.get());
+  }
+}
+
+
 TEST_F(CoordinatorTest, MultipleAppendsNotLearnedFill)
 {
   const string path1 = os::getcwd() + "/.log1";
@@ -1818,11 +2084,20 @@ TEST_F(RecoverTest, CatchupRetry)
   // promise phase even if replica1 reemerges later.
   DROP_PROTOBUF(PromiseRequest(), _, Eq(replica1->pid()));
 
+  // Drop the transfer requests so that the catch-up process has to
+  // use Paxos (rather than transferring the learned actions from
+  // replica1).
+  DROP_PROTOBUFS(TransferRequest(), _, _);
+
   Future<Nothing> catching =
     catchup(2, replica3, network2, None(), positions, Seconds(10));
 
   Clock::pause();
 
+  // Wait for the transfer to time out.
+  Clock::settle();
+  Clock::advance(Seconds(10));
+
   // Wait for the retry timer in 'catchup' to be setup.
   Clock::settle();
 
@@ -1844,6 +2119,72 @@ TEST_F(RecoverTest, CatchupRetry)
 }
 
 
+// This test verifies that the catch-up process transfers the actions
+// learned by other replicas rather than running Paxos for them.
+TEST_F(RecoverTest, CatchupTransfer)
+{
+  const string path1 = os::getcwd() + "/.log1";
+  initializer.flags.path = path1;
+  ASSERT_SOME(initializer.execute());
+
+  const string path2 = os::getcwd() + "/.log2";
+  initializer.flags.path = path2;
+  ASSERT_SOME(initializer.execute());
+
+  const string path3 = os::getcwd() + "/.log3";
+
+  Shared<Replica> replica1(new Replica(path1));
+  Shared<Replica> replica2(new Replica(path2));
+
+  set<UPID> pids;
+  pids.insert(replica1->pid());
+  pids.insert(replica2->pid());
+
+  Shared<Network> network1(new Network(pids));
+
+  Coordinator coord(2, replica1, network1);
+
+  {
+    Future<Option<uint64_t>> electing = coord.elect();
+    AWAIT_READY(electing);
+    EXPECT_SOME_EQ(0u, electing.get());
+  }
+
+  IntervalSet<uint64_t> positions;
+
+  for (uint64_t position = 1; position <= 10; position++) {
+    Future<Option<uint64_t>> appending = coord.append(stringify(position));
+    AWAIT_READY(appending);
+    EXPECT_SOME_EQ(position, appending.get());
+    positions += position;
+  }
+
+  Shared<Replica> replica3(new Replica(path3));
+
+  pids.insert(replica3->pid());
+
+  Shared<Network> network2(new Network(pids));
+
+  // The catch-up process should not need to run Paxos.
+  EXPECT_NO_FUTURE_PROTOBUFS(PromiseRequest(), _, _);
+
+  Future<Nothing> catching =
+    catchup(2, replica3, network2, None(), positions, Seconds(10));
+
+  AWAIT_READY(catching);
+
+  Future<list<Action>> actions = replica3->read(1, 10);
+  AWAIT_READY(actions);
+  ASSERT_EQ(10u, actions->size());
+
+  foreach (const Action& action, actions.get()) {
+    EXPECT_TRUE(action.learned());
+    ASSERT_EQ(Action::APPEND, action.type());
+    EXPECT_EQ(stringify(action.position()), action.append().bytes());
+  }
+}
+
+
 TEST_F(RecoverTest, AutoInitialization)
 {
   const string path1 = os::getcwd() + "/.log1";
@@ -2042,6 +2383,92 @@ TEST_F(LogTest, WriteRead)
 }
 
 
+TEST_F(LogTest, Stream)
+{
+  const string path1 = os::getcwd() + "/.log1";
+  initializer.flags.path = path1;
+  ASSERT_SOME(initializer.execute());
+
+  const string path2 = os::getcwd() + "/.log2";
+  initializer.flags.path = path2;
+  ASSERT_SOME(initializer.execute());
+
+  Replica replica1(path1);
+
+  set<UPID> pids;
+  pids.insert(replica1.pid());
+
+  Log log(2, path2, pids);
+
+  Log::Writer writer(&log);
+
+  Future<Option<Log::Position>> start = writer.start();
+
+  AWAIT_READY(start);
+  ASSERT_SOME(start.get());
+
+  list<Log::Position> positions;
+
+  const list<string> data = {"a", "b", "c"};
+
+  foreach (const string& bytes, data) {
+    Future<Option<Log::Position>> position = writer.append(bytes);
+
+    AWAIT_READY(position);
+    ASSERT_SOME(position.get());
+
+    positions.push_back(position->get());
+  }
+
+  {
+    Log::Stream stream(&log, positions.front(), 2);
+
+    Future<list<Log::Entry>> entries = stream.read();
+
+    AWAIT_READY(entries);
+    ASSERT_EQ(2u, entries->size());
+    EXPECT_EQ("a", entries->front().data);
+    EXPECT_EQ("b", entries->back().data);
+
+    entries = stream.read();
+
+    AWAIT_READY(entries);
+    ASSERT_EQ(1u, entries->size());
+    EXPECT_EQ(positions.back(), entries->front().position);
+    EXPECT_EQ("c", entries->front().data);
+
+    // The end of the log.
+    entries = stream.read();
+
+    AWAIT_READY(entries);
+    EXPECT_TRUE(entries->empty());
+  }
+
+  // When following, the stream waits for the next append.
+  Log::Stream stream(&log, positions.back(), 2, true);
+
+  Future<list<Log::Entry>> entries = stream.read();
+
+  AWAIT_READY(entries);
+  ASSERT_EQ(1u, entries->size());
+  EXPECT_EQ("c", entries->front().data);
+
+  entries = stream.read();
+
+  ASSERT_TRUE(entries.isPending());
+
+  Future<Option<Log::Position>> position = writer.append("d");
+
+  AWAIT_READY(position);
+  ASSERT_SOME(position.get());
+
+  AWAIT_READY(entries);
+  ASSERT_EQ(1u, entries->size());
+  EXPECT_EQ(position->get(), entries->front().position);
+  EXPECT_EQ("d", entries->front().data);
+}
+
+
 TEST_F(LogTest, Position)
 {
   const string path1 = os::getcwd() + "/.log1";
@@ -2231,6 +2658,79 @@ TEST_F(LogZooKeeperTest, LostZooKeeper)
 #endif // MESOS_HAS_JAVA
 
 
+class Coordinator_BENCHMARK_Test
+  : public TemporaryDirectoryTest,
+    public ::testing::WithParamInterface<size_t>
+{
+protected:
+  // Used to change the status of a replicated log from `EMPTY` to `VOTING`.
+  tool::Initialize initializer;
+};
+
+
+// The coordinator benchmark tests are parameterized by the number of
+// appends that are in progress at the same time.
+INSTANTIATE_TEST_CASE_P(
+    Pipelined,
+    Coordinator_BENCHMARK_Test,
+    ::testing::Values(1U, 8U, 64U));
+
+
+// Measures the throughput of appends to a log with three replicas.
+TEST_P(Coordinator_BENCHMARK_Test, Appends)
+{
+  const size_t pipelined = GetParam();
+  const size_t count = 1000;
+
+  set<UPID> pids;
+  list<Shared<Replica>> replicas;
+
+  for (int i = 0; i < 3; i++) {
+    const string path = os::getcwd() + "/.log" + stringify(i);
+    initializer.flags.path = path;
+    ASSERT_SOME(initializer.execute());
+
+    replicas.push_back(Shared<Replica>(new Replica(path)));
+    pids.insert(replicas.back()->pid());
+  }
+
+  Shared<Network> network(new Network(pids));
+
+  Coordinator coord(2, replicas.front(), network);
+
+  {
+    Future<Option<uint64_t>> electing = coord.elect();
+    AWAIT_READY(electing);
+    EXPECT_SOME_EQ(0u, electing.get());
+  }
+
+  const string bytes(1024, 'x');
+
+  Stopwatch stopwatch;
+  stopwatch.start();
+
+  list<Future<Option<uint64_t>>> appends;
+
+  for (size_t i = 0; i < count; i++) {
+    if (appends.size() >= pipelined) {
+      AWAIT_READY(appends.front());
+      ASSERT_SOME(appends.front().get());
+      appends.pop_front();
+    }
+
+    appends.push_back(coord.append(bytes));
+  }
+
+  foreach (const Future<Option<uint64_t>>& appending, appends) {
+    AWAIT_READY(appending);
+    ASSERT_SOME(appending.get());
+  }
+
+  cout << "Appended " << count << " entries with up to " << pipelined
+       << " in progress in " << stopwatch.elapsed() << endl;
+}
+
+
 TEST_F(CoordinatorTest, RacingElect) {}
 
 TEST_F(CoordinatorTest, FillNoQuorum) {}
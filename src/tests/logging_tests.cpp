@@ -14,6 +14,11 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
 #include <gmock/gmock.h>
 
 #include <mesos/authentication/http/basic_authenticator_factory.hpp>
@@ -26,8 +31,11 @@
 #include <process/pid.hpp>
 #include <process/process.hpp>
 
+#include <process/metrics/counter.hpp>
+
 #include "common/http.hpp"
 
+#include "logging/async_logger.hpp"
 #include "logging/logging.hpp"
 
 #include "tests/mesos.hpp"
@@ -36,6 +44,11 @@ namespace authentication = process::http::authentication;
 
 using mesos::http::authentication::BasicAuthenticatorFactory;
 
+using mesos::internal::logging::AsyncLogger;
+
+using process::Future;
+using process::Promise;
+
 using process::http::BadRequest;
 using process::http::Forbidden;
 using process::http::OK;
@@ -196,6 +209,118 @@ TEST_F(LoggingTest, ToggleAuthorizationEnabled)
   AWAIT_EXPECT_RESPONSE_STATUS_EQ(Forbidden().status, response);
 }
 
+// A logger that records the messages written to it, and that can be
+// blocked to simulate a stalled log disk.
+class RecordingLogger : public google::base::Logger
+{
+public:
+  virtual void Write(bool, time_t, const char* message, int length)
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    writing.set(Nothing());
+
+    unblocked.wait(lock, [this]() { return !blocked; });
+
+    messages.push_back(std::string(message, length));
+  }
+
+  virtual void Flush() {}
+
+  virtual google::uint32 LogSize()
+  {
+    return 0;
+  }
+
+  void block()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    blocked = true;
+  }
+
+  void unblock()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      blocked = false;
+    }
+
+    unblocked.notify_all();
+  }
+
+  std::vector<std::string> written()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    return messages;
+  }
+
+  // Satisfied once a message is being written.
+  Promise<Nothing> writing;
+
+private:
+  std::mutex mutex;
+  std::condition_variable unblocked;
+  bool blocked = false;
+  std::vector<std::string> messages;
+};
+
+
+// Tests that the asynchronous logger writes the messages in order,
+// and that flushing waits for them to be written.
+TEST(AsyncLoggerTest, Write)
+{
+  RecordingLogger recorder;
+  process::metrics::Counter dropped("test/dropped_lines");
+
+  AsyncLogger logger(
+      &recorder, Kilobytes(1), AsyncLogger::Overflow::BLOCK, dropped);
+
+  logger.Write(false, 0, "a\n", 2);
+  logger.Write(false, 0, "b\n", 2);
+  logger.Write(true, 0, "c\n", 2);
+
+  logger.Flush();
+
+  EXPECT_EQ(
+      std::vector<std::string>({"a\n", "b\n", "c\n"}),
+      recorder.written());
+}
+
+
+// Tests that the asynchronous logger drops the messages that do not
+// fit into its buffer while the log is stalled, when asked to.
+TEST(AsyncLoggerTest, Drop)
+{
+  RecordingLogger recorder;
+  process::metrics::Counter dropped("test/dropped_lines");
+
+  AsyncLogger logger(
+      &recorder, Bytes(4), AsyncLogger::Overflow::DROP, dropped);
+
+  recorder.block();
+
+  logger.Write(false, 0, "abc\n", 4);
+
+  // Wait for the first message to be taken out of the buffer, so that
+  // the log is stalled with an empty buffer.
+  AWAIT_READY(recorder.writing.future());
+
+  logger.Write(false, 0, "def\n", 4);
+  logger.Write(false, 0, "ghi\n", 4);
+
+  recorder.unblock();
+
+  logger.Flush();
+
+  EXPECT_EQ(
+      std::vector<std::string>({"abc\n", "def\n"}),
+      recorder.written());
+
+  Future<double> value = dropped.value();
+  AWAIT_READY(value);
+  EXPECT_EQ(1, value.get());
+}
+
 } // namespace tests {
 } // namespace internal {
 } // namespace mesos {
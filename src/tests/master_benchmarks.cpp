@@ -0,0 +1,522 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+
+#include <mesos/resources.hpp>
+#include <mesos/version.hpp>
+
+#include <process/delay.hpp>
+#include <process/future.hpp>
+#include <process/gtest.hpp>
+#include <process/id.hpp>
+#include <process/owned.hpp>
+#include <process/pid.hpp>
+#include <process/process.hpp>
+#include <process/protobuf.hpp>
+
+#include <stout/duration.hpp>
+#include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/nothing.hpp>
+#include <stout/option.hpp>
+#include <stout/stopwatch.hpp>
+#include <stout/stringify.hpp>
+#include <stout/uuid.hpp>
+
+#include "common/protobuf_utils.hpp"
+
+#include "master/flags.hpp"
+
+#include "messages/messages.hpp"
+
+#include "tests/mesos.hpp"
+
+using process::Future;
+using process::Owned;
+using process::Promise;
+using process::UPID;
+
+using std::cout;
+using std::endl;
+using std::shared_ptr;
+using std::vector;
+
+using testing::WithParamInterface;
+
+namespace mesos {
+namespace internal {
+namespace tests {
+
+// The simulated agents resend their registration at this interval
+// until they are registered, e.g., in case the master is still
+// recovering when they start.
+static const Duration REGISTRATION_RETRY_INTERVAL = Seconds(1);
+
+
+// Satisfies a future once an event has happened the given number of
+// times, counted across the simulated agents and frameworks.
+class Countdown
+{
+public:
+  explicit Countdown(size_t count) : remaining(count)
+  {
+    if (count == 0) {
+      promise.set(Nothing());
+    }
+  }
+
+  void decrement()
+  {
+    if (--remaining == 0) {
+      promise.set(Nothing());
+    }
+  }
+
+  Future<Nothing> future() { return promise.future(); }
+
+private:
+  std::atomic<size_t> remaining;
+  Promise<Nothing> promise;
+};
+
+
+// An agent that speaks the agent protocol to the master (i.e., it
+// registers, reregisters, answers pings and sends status updates for
+// the tasks it is asked to run) but does not run anything, so that
+// thousands of agents can be simulated in a single libprocess
+// instance to load test the master.
+class TestSlaveProcess : public ProtobufProcess<TestSlaveProcess>
+{
+public:
+  TestSlaveProcess(
+      const UPID& _master,
+      const SlaveInfo& _slaveInfo,
+      const shared_ptr<Countdown>& _registered)
+    : ProcessBase(process::ID::generate("test-slave")),
+      master(_master),
+      slaveInfo(_slaveInfo),
+      registered(_registered) {}
+
+  // Reregisters with the master, reporting the tasks that the agent
+  // runs.
+  void reregister(const shared_ptr<Countdown>& _reregistered)
+  {
+    CHECK(slaveInfo.has_id());
+
+    reregistered = _reregistered;
+
+    ReregisterSlaveMessage message;
+    message.mutable_slave()->CopyFrom(slaveInfo);
+    message.set_version(MESOS_VERSION);
+
+    foreachvalue (const Task& task, tasks) {
+      message.add_tasks()->CopyFrom(task);
+    }
+
+    foreachvalue (const FrameworkInfo& framework, frameworks) {
+      message.add_frameworks()->CopyFrom(framework);
+    }
+
+    send(master, message);
+  }
+
+  // Counts down on each status update acknowledgement.
+  void expectAcknowledgements(const shared_ptr<Countdown>& _acknowledged)
+  {
+    acknowledged = _acknowledged;
+  }
+
+protected:
+  virtual void initialize()
+  {
+    install<SlaveRegisteredMessage>(&TestSlaveProcess::_registered);
+    install<SlaveReregisteredMessage>(&TestSlaveProcess::_reregistered);
+    install<PingSlaveMessage>(&TestSlaveProcess::ping);
+    install<RunTaskMessage>(&TestSlaveProcess::runTask);
+    install<StatusUpdateAcknowledgementMessage>(
+        &TestSlaveProcess::acknowledgement);
+
+    doReliableRegistration();
+  }
+
+private:
+  void doReliableRegistration()
+  {
+    if (slaveInfo.has_id()) {
+      return;
+    }
+
+    RegisterSlaveMessage message;
+    message.mutable_slave()->CopyFrom(slaveInfo);
+    message.set_version(MESOS_VERSION);
+
+    send(master, message);
+
+    process::delay(
+        REGISTRATION_RETRY_INTERVAL,
+        self(),
+        &TestSlaveProcess::doReliableRegistration);
+  }
+
+  void _registered(const UPID& from, const SlaveRegisteredMessage& message)
+  {
+    if (slaveInfo.has_id()) {
+      return;
+    }
+
+    slaveInfo.mutable_id()->CopyFrom(message.slave_id());
+    registered->decrement();
+  }
+
+  void _reregistered(
+      const UPID& from,
+      const SlaveReregisteredMessage& message)
+  {
+    if (reregistered != nullptr) {
+      reregistered->decrement();
+      reregistered.reset();
+    }
+  }
+
+  void ping(const UPID& from, const PingSlaveMessage& message)
+  {
+    send(from, PongSlaveMessage());
+  }
+
+  void runTask(const UPID& from, const RunTaskMessage& message)
+  {
+    const FrameworkInfo& framework = message.framework();
+    const TaskInfo& task = message.task();
+
+    frameworks[framework.id()] = framework;
+    tasks[task.task_id()] =
+      protobuf::createTask(task, TASK_RUNNING, framework.id());
+
+    StatusUpdateMessage update;
+    update.mutable_update()->CopyFrom(protobuf::createStatusUpdate(
+        framework.id(),
+        slaveInfo.id(),
+        task.task_id(),
+        TASK_RUNNING,
+        TaskStatus::SOURCE_EXECUTOR,
+        UUID::random()));
+
+    update.set_pid(self());
+
+    send(master, update);
+  }
+
+  void acknowledgement(
+      const UPID& from,
+      const StatusUpdateAcknowledgementMessage& message)
+  {
+    if (acknowledged != nullptr) {
+      acknowledged->decrement();
+    }
+  }
+
+  const UPID master;
+  SlaveInfo slaveInfo;
+
+  hashmap<FrameworkID, FrameworkInfo> frameworks;
+  hashmap<TaskID, Task> tasks;
+
+  shared_ptr<Countdown> registered;
+  shared_ptr<Countdown> reregistered;
+  shared_ptr<Countdown> acknowledged;
+};
+
+
+// A framework that speaks the (pre-HTTP) scheduler protocol to the
+// master. It holds on to the offers it receives until it is asked to
+// launch a task with each of them.
+class TestFrameworkProcess : public ProtobufProcess<TestFrameworkProcess>
+{
+public:
+  TestFrameworkProcess(
+      const UPID& _master,
+      const FrameworkInfo& _frameworkInfo,
+      const shared_ptr<Countdown>& _registered)
+    : ProcessBase(process::ID::generate("test-framework")),
+      master(_master),
+      frameworkInfo(_frameworkInfo),
+      registered(_registered),
+      nextTaskId(0) {}
+
+  // Counts down on each offer received.
+  void expectOffers(const shared_ptr<Countdown>& _offered)
+  {
+    offered = _offered;
+  }
+
+  // Launches a task with the given resources on each of the held
+  // offers, counting down on each status update received.
+  void launch(
+      const Resources& resources,
+      const shared_ptr<Countdown>& _updated)
+  {
+    updated = _updated;
+
+    foreach (const Offer& offer, offers) {
+      TaskInfo task;
+      task.set_name("task");
+      task.mutable_task_id()->set_value(stringify(nextTaskId++));
+      task.mutable_slave_id()->CopyFrom(offer.slave_id());
+      task.mutable_resources()->CopyFrom(resources);
+      task.mutable_command()->set_value("sleep 1000");
+
+      LaunchTasksMessage message;
+      message.mutable_framework_id()->CopyFrom(frameworkInfo.id());
+      message.add_tasks()->CopyFrom(task);
+      message.mutable_filters();
+      message.add_offer_ids()->CopyFrom(offer.id());
+
+      send(master, message);
+    }
+
+    offers.clear();
+  }
+
+protected:
+  virtual void initialize()
+  {
+    install<FrameworkRegisteredMessage>(&TestFrameworkProcess::_registered);
+    install<ResourceOffersMessage>(&TestFrameworkProcess::resourceOffers);
+    install<StatusUpdateMessage>(&TestFrameworkProcess::statusUpdate);
+
+    RegisterFrameworkMessage message;
+    message.mutable_framework()->CopyFrom(frameworkInfo);
+
+    send(master, message);
+  }
+
+private:
+  void _registered(
+      const UPID& from,
+      const FrameworkRegisteredMessage& message)
+  {
+    if (frameworkInfo.has_id()) {
+      return;
+    }
+
+    frameworkInfo.mutable_id()->CopyFrom(message.framework_id());
+    registered->decrement();
+  }
+
+  void resourceOffers(
+      const UPID& from,
+      const ResourceOffersMessage& message)
+  {
+    foreach (const Offer& offer, message.offers()) {
+      offers.push_back(offer);
+
+      if (offered != nullptr) {
+        offered->decrement();
+      }
+    }
+  }
+
+  void statusUpdate(const UPID& from, const StatusUpdateMessage& message)
+  {
+    const StatusUpdate& update = message.update();
+
+    // Like the scheduler driver, only acknowledge the updates that
+    // were not generated by the master.
+    if (!message.pid().empty() && update.has_uuid()) {
+      StatusUpdateAcknowledgementMessage acknowledgement;
+      acknowledgement.mutable_slave_id()->CopyFrom(update.slave_id());
+      acknowledgement.mutable_framework_id()->CopyFrom(frameworkInfo.id());
+      acknowledgement.mutable_task_id()->CopyFrom(update.status().task_id());
+      acknowledgement.set_uuid(update.uuid());
+
+      send(master, acknowledgement);
+    }
+
+    if (updated != nullptr) {
+      updated->decrement();
+    }
+  }
+
+  const UPID master;
+  FrameworkInfo frameworkInfo;
+
+  vector<Offer> offers;
+
+  shared_ptr<Countdown> registered;
+  shared_ptr<Countdown> offered;
+  shared_ptr<Countdown> updated;
+
+  size_t nextTaskId;
+};
+
+
+class MasterSimulatedAgents_BENCHMARK_Test
+  : public MesosTest,
+    public WithParamInterface<std::tr1::tuple<size_t, size_t>> {};
+
+
+// The benchmark is parameterized by the number of agents and the
+// number of frameworks.
+INSTANTIATE_TEST_CASE_P(
+    AgentsAndFrameworks,
+    MasterSimulatedAgents_BENCHMARK_Test,
+    ::testing::Combine(
+      ::testing::Values(1000U, 5000U, 10000U, 30000U),
+      ::testing::Values(1U, 10U, 100U))
+    );
+
+
+// Load tests the master with simulated agents and frameworks, and
+// measures how long the master takes to register all agents, to offer
+// all of their resources, to forward a status update (and its
+// acknowledgement) for a task on each agent, and to reregister all
+// agents.
+TEST_P(MasterSimulatedAgents_BENCHMARK_Test, Scale)
+{
+  size_t agentCount = std::tr1::get<0>(GetParam());
+  size_t frameworkCount = std::tr1::get<1>(GetParam());
+
+  master::Flags masterFlags = CreateMasterFlags();
+  masterFlags.authenticate_agents = false;
+  masterFlags.authenticate_frameworks = false;
+
+  Try<Owned<cluster::Master>> master = StartMaster(masterFlags);
+  ASSERT_SOME(master);
+
+  const UPID pid = master.get()->pid;
+
+  const Resources agentResources =
+    Resources::parse("cpus:4;mem:4096;disk:4096").get();
+
+  // Registration.
+  vector<Owned<TestSlaveProcess>> agents;
+
+  shared_ptr<Countdown> registered(new Countdown(agentCount));
+
+  Stopwatch watch;
+  watch.start();
+
+  for (size_t i = 0; i < agentCount; i++) {
+    SlaveInfo slaveInfo;
+    slaveInfo.set_hostname("agent" + stringify(i));
+    slaveInfo.mutable_resources()->CopyFrom(agentResources);
+
+    Owned<TestSlaveProcess> agent(
+        new TestSlaveProcess(pid, slaveInfo, registered));
+
+    process::spawn(agent.get());
+    agents.push_back(agent);
+  }
+
+  AWAIT_READY_FOR(registered->future(), Minutes(10));
+
+  cout << "Registered " << agentCount << " agents in "
+       << watch.elapsed() << endl;
+
+  // Offer round.
+  vector<Owned<TestFrameworkProcess>> frameworks;
+
+  shared_ptr<Countdown> frameworksRegistered(new Countdown(frameworkCount));
+  shared_ptr<Countdown> offered(new Countdown(agentCount));
+
+  watch.start();
+
+  for (size_t i = 0; i < frameworkCount; i++) {
+    FrameworkInfo frameworkInfo = DEFAULT_FRAMEWORK_INFO;
+    frameworkInfo.set_name("framework" + stringify(i));
+
+    Owned<TestFrameworkProcess> framework(
+        new TestFrameworkProcess(pid, frameworkInfo, frameworksRegistered));
+
+    framework->expectOffers(offered);
+
+    process::spawn(framework.get());
+    frameworks.push_back(framework);
+  }
+
+  AWAIT_READY_FOR(frameworksRegistered->future(), Minutes(10));
+  AWAIT_READY_FOR(offered->future(), Minutes(10));
+
+  cout << "Offered the resources of " << agentCount << " agents to "
+       << frameworkCount << " frameworks in " << watch.elapsed() << endl;
+
+  // Status updates.
+  shared_ptr<Countdown> updated(new Countdown(agentCount));
+  shared_ptr<Countdown> acknowledged(new Countdown(agentCount));
+
+  foreach (const Owned<TestSlaveProcess>& agent, agents) {
+    process::dispatch(
+        agent.get(),
+        &TestSlaveProcess::expectAcknowledgements,
+        acknowledged);
+  }
+
+  const Resources taskResources = Resources::parse("cpus:1;mem:32").get();
+
+  watch.start();
+
+  foreach (const Owned<TestFrameworkProcess>& framework, frameworks) {
+    process::dispatch(
+        framework.get(),
+        &TestFrameworkProcess::launch,
+        taskResources,
+        updated);
+  }
+
+  AWAIT_READY_FOR(updated->future(), Minutes(10));
+  AWAIT_READY_FOR(acknowledged->future(), Minutes(10));
+
+  cout << "Launched and acknowledged " << agentCount << " tasks in "
+       << watch.elapsed() << endl;
+
+  // Reregistration.
+  shared_ptr<Countdown> reregistered(new Countdown(agentCount));
+
+  watch.start();
+
+  foreach (const Owned<TestSlaveProcess>& agent, agents) {
+    process::dispatch(
+        agent.get(),
+        &TestSlaveProcess::reregister,
+        reregistered);
+  }
+
+  AWAIT_READY_FOR(reregistered->future(), Minutes(10));
+
+  cout << "Reregistered " << agentCount << " agents in "
+       << watch.elapsed() << endl;
+
+  foreach (const Owned<TestFrameworkProcess>& framework, frameworks) {
+    process::terminate(framework.get());
+    process::wait(framework.get());
+  }
+
+  foreach (const Owned<TestSlaveProcess>& agent, agents) {
+    process::terminate(agent.get());
+    process::wait(agent.get());
+  }
+}
+
+} // namespace tests {
+} // namespace internal {
+} // namespace mesos {
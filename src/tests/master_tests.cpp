@@ -99,6 +99,7 @@ using process::Owned;
 using process::PID;
 using process::Promise;
 
+using process::http::BadRequest;
 using process::http::OK;
 using process::http::Response;
 using process::http::Unauthorized;
@@ -111,6 +112,7 @@ using testing::_;
 using testing::AtMost;
 using testing::DoAll;
 using testing::Eq;
+using testing::Invoke;
 using testing::Not;
 using testing::Return;
 using testing::SaveArg;
@@ -613,6 +615,57 @@ TEST_F(MasterTest, KillUnknownTaskSlaveInTransition)
 }
 
 
+// This test checks the metrics for agents that are waiting for the
+// registrar to readmit them after a master failover.
+TEST_F(MasterTest, SlaveReadmissionMetrics)
+{
+  master::Flags masterFlags = CreateMasterFlags();
+  masterFlags.registry = "replicated_log";
+
+  Try<Owned<cluster::Master>> master = StartMaster(masterFlags);
+  ASSERT_SOME(master);
+
+  Future<SlaveRegisteredMessage> slaveRegisteredMessage =
+    FUTURE_PROTOBUF(SlaveRegisteredMessage(), _, _);
+
+  StandaloneMasterDetector detector(master.get()->pid);
+  Try<Owned<cluster::Slave>> slave = StartSlave(&detector);
+  ASSERT_SOME(slave);
+
+  AWAIT_READY(slaveRegisteredMessage);
+
+  master->reset();
+
+  master = StartMaster(masterFlags);
+  ASSERT_SOME(master);
+
+  // Intercept the registry operation that readmits the agent.
+  Future<Owned<master::Operation>> reregister;
+  Promise<bool> promise;
+  EXPECT_CALL(*master.get()->registrar.get(), apply(_))
+    .WillOnce(DoAll(FutureArg<0>(&reregister),
+                    Return(promise.future())));
+
+  Future<SlaveReregisteredMessage> slaveReregisteredMessage =
+    FUTURE_PROTOBUF(SlaveReregisteredMessage(), _, _);
+
+  detector.appoint(master.get()->pid);
+
+  AWAIT_READY(reregister);
+
+  JSON::Object metrics = Metrics();
+  EXPECT_EQ(1, metrics.values["master/slave_readmissions_pending"]);
+
+  promise.set(true);
+
+  AWAIT_READY(slaveReregisteredMessage);
+
+  metrics = Metrics();
+  EXPECT_EQ(0, metrics.values["master/slave_readmissions_pending"]);
+  EXPECT_EQ(1, metrics.values["master/slave_readmission_ms/count"]);
+}
+
+
 // This test checks that the HTTP endpoints return the expected
 // information for agents that the master is in the process of marking
 // unreachable, but that have not yet been so marked (because the
@@ -932,6 +985,118 @@ TEST_F(MasterTest, RecoverResources)
 }
 
 
+// This test verifies that when resources on an agent are offered to
+// a framework with the COALESCED_OFFERS capability while it holds an
+// offer for the agent, the outstanding offer is rescinded and its
+// resources are included in the new offer.
+TEST_F(MasterTest, CoalescedOffers)
+{
+  Try<Owned<cluster::Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  MockExecutor exec(DEFAULT_EXECUTOR_ID);
+  TestContainerizer containerizer(&exec);
+
+  slave::Flags flags = CreateSlaveFlags();
+  flags.resources = Option<string>(
+      "cpus:2;gpus:0;mem:1024;disk:1024;ports:[1-10, 20-30]");
+
+  Owned<MasterDetector> detector = master.get()->createDetector();
+
+  Try<Owned<cluster::Slave>> slave =
+    StartSlave(detector.get(), &containerizer, flags);
+  ASSERT_SOME(slave);
+
+  FrameworkInfo frameworkInfo = DEFAULT_FRAMEWORK_INFO;
+  frameworkInfo.add_capabilities()->set_type(
+      FrameworkInfo::Capability::COALESCED_OFFERS);
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+      &sched, frameworkInfo, master.get()->pid, DEFAULT_CREDENTIAL);
+
+  EXPECT_CALL(sched, registered(&driver, _, _));
+
+  Future<vector<Offer>> offers1;
+  Future<vector<Offer>> offers2;
+  EXPECT_CALL(sched, resourceOffers(&driver, _))
+    .WillOnce(FutureArg<1>(&offers1))
+    .WillOnce(FutureArg<1>(&offers2));
+
+  driver.start();
+
+  AWAIT_READY(offers1);
+  ASSERT_EQ(1u, offers1->size());
+
+  TaskInfo task = createTask(
+      offers1->front().slave_id(),
+      Resources::parse("cpus:1;mem:512").get(),
+      "",
+      DEFAULT_EXECUTOR_ID);
+
+  EXPECT_CALL(exec, registered(_, _, _, _));
+
+  EXPECT_CALL(exec, launchTask(_, _))
+    .WillOnce(SendStatusUpdateFromTask(TASK_RUNNING));
+
+  Future<TaskStatus> status;
+  EXPECT_CALL(sched, statusUpdate(&driver, _))
+    .WillOnce(FutureArg<1>(&status));
+
+  // Do not filter the unused resources, so that they are offered again
+  // while the task is running.
+  Filters filters;
+  filters.set_refuse_seconds(0);
+
+  driver.launchTasks(offers1->front().id(), {task}, filters);
+
+  AWAIT_READY(status);
+  EXPECT_EQ(TASK_RUNNING, status->state());
+
+  AWAIT_READY(offers2);
+  ASSERT_EQ(1u, offers2->size());
+
+  // The framework holds on to the second offer while the resources of
+  // the task are freed.
+  Future<Nothing> offerRescinded;
+  EXPECT_CALL(sched, offerRescinded(&driver, offers2->front().id()))
+    .WillOnce(FutureSatisfy(&offerRescinded));
+
+  Future<vector<Offer>> offers3;
+  EXPECT_CALL(sched, resourceOffers(&driver, _))
+    .WillOnce(FutureArg<1>(&offers3))
+    .WillRepeatedly(Return()); // Ignore subsequent offers.
+
+  EXPECT_CALL(exec, killTask(_, _))
+    .WillOnce(SendStatusUpdateFromTaskID(TASK_KILLED));
+
+  EXPECT_CALL(sched, statusUpdate(&driver, _))
+    .WillOnce(FutureArg<1>(&status));
+
+  driver.killTask(task.task_id());
+
+  AWAIT_READY(status);
+  EXPECT_EQ(TASK_KILLED, status->state());
+
+  driver.reviveOffers(); // Don't wait till the next allocation.
+
+  AWAIT_READY(offerRescinded);
+
+  // The new offer includes the resources of the rescinded offer.
+  AWAIT_READY(offers3);
+  ASSERT_EQ(1u, offers3->size());
+  EXPECT_EQ(
+      Resources::parse(flags.resources.get()).get(),
+      offers3->front().resources());
+
+  EXPECT_CALL(exec, shutdown(_))
+    .Times(AtMost(1));
+
+  driver.stop();
+  driver.join();
+}
+
+
 TEST_F(MasterTest, FrameworkMessage)
 {
   Try<Owned<cluster::Master>> master = StartMaster();
@@ -3334,6 +3499,126 @@ TEST_F(MasterTest, TasksEndpoint)
 }
 
 
+// Verifies that the tasks endpoint returns a cursor when more tasks
+// follow the returned ones, from which the next page can be fetched.
+TEST_F(MasterTest, TasksEndpointCursor)
+{
+  Try<Owned<cluster::Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  MockExecutor exec(DEFAULT_EXECUTOR_ID);
+  TestContainerizer containerizer(&exec);
+  EXPECT_CALL(exec, registered(_, _, _, _));
+
+  Owned<MasterDetector> detector = master.get()->createDetector();
+  Try<Owned<cluster::Slave>> slave = StartSlave(detector.get(), &containerizer);
+  ASSERT_SOME(slave);
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+      &sched, DEFAULT_FRAMEWORK_INFO, master.get()->pid, DEFAULT_CREDENTIAL);
+
+  EXPECT_CALL(sched, registered(&driver, _, _));
+
+  process::Queue<Offer> offers;
+  EXPECT_CALL(sched, resourceOffers(&driver, _))
+    .WillRepeatedly(EnqueueOffers(&offers));
+
+  driver.start();
+
+  // Launch three tasks one after the other, which then complete.
+  for (size_t i = 0; i < 3; i++) {
+    Future<Offer> offer = offers.get();
+    AWAIT_READY(offer);
+
+    TaskInfo task;
+    task.set_name("");
+    task.mutable_task_id()->set_value(stringify(i));
+    task.mutable_slave_id()->MergeFrom(offer->slave_id());
+    task.mutable_resources()->MergeFrom(offer->resources());
+    task.mutable_executor()->MergeFrom(DEFAULT_EXECUTOR_INFO);
+
+    Future<TaskStatus> statusFinished;
+    EXPECT_CALL(exec, launchTask(_, _))
+      .WillOnce(SendStatusUpdateFromTask(TASK_FINISHED));
+    EXPECT_CALL(sched, statusUpdate(&driver, _))
+      .WillOnce(FutureArg<1>(&statusFinished));
+
+    driver.launchTasks(offer->id(), {task});
+
+    AWAIT_READY(statusFinished);
+    EXPECT_EQ(TASK_FINISHED, statusFinished->state());
+  }
+
+  // Make sure the master processed the acknowledgements, i.e., all
+  // tasks are completed.
+  Clock::pause();
+  Clock::settle();
+  Clock::resume();
+
+  hashmap<string, string> query;
+  query["limit"] = "2";
+  query["order"] = "asc";
+
+  Future<Response> response = process::http::get(
+      master.get()->pid,
+      "tasks",
+      process::http::query::encode(query),
+      createBasicAuthHeaders(DEFAULT_CREDENTIAL));
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+
+  Try<JSON::Object> parse = JSON::parse<JSON::Object>(response->body);
+  ASSERT_SOME(parse);
+
+  Result<JSON::Array> tasks = parse->find<JSON::Array>("tasks");
+  ASSERT_SOME(tasks);
+  ASSERT_EQ(2u, tasks->values.size());
+  EXPECT_SOME_EQ(JSON::String("0"), parse->find<JSON::String>("tasks[0].id"));
+  EXPECT_SOME_EQ(JSON::String("1"), parse->find<JSON::String>("tasks[1].id"));
+
+  Result<JSON::String> cursor = parse->find<JSON::String>("next_cursor");
+  ASSERT_SOME(cursor);
+
+  // The next page holds the last task and no cursor.
+  query["cursor"] = cursor->value;
+
+  response = process::http::get(
+      master.get()->pid,
+      "tasks",
+      process::http::query::encode(query),
+      createBasicAuthHeaders(DEFAULT_CREDENTIAL));
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+
+  parse = JSON::parse<JSON::Object>(response->body);
+  ASSERT_SOME(parse);
+
+  tasks = parse->find<JSON::Array>("tasks");
+  ASSERT_SOME(tasks);
+  ASSERT_EQ(1u, tasks->values.size());
+  EXPECT_SOME_EQ(JSON::String("2"), parse->find<JSON::String>("tasks[0].id"));
+
+  EXPECT_NONE(parse->find<JSON::String>("next_cursor"));
+
+  // An invalid cursor is rejected.
+  query["cursor"] = "invalid";
+
+  response = process::http::get(
+      master.get()->pid,
+      "tasks",
+      process::http::query::encode(query),
+      createBasicAuthHeaders(DEFAULT_CREDENTIAL));
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(BadRequest().status, response);
+
+  EXPECT_CALL(exec, shutdown(_))
+    .Times(AtMost(1));
+
+  driver.stop();
+  driver.join();
+}
+
 // This test verifies that the master will strip ephemeral ports
 // resource from offers so that frameworks cannot see it.
 TEST_F(MasterTest, IgnoreEphemeralPortsResource)
@@ -3943,61 +4228,167 @@ TEST_F(MasterTest, StateEndpointFrameworkInfo)
 }
 
 
-TEST_F(MasterTest, StateSummaryEndpoint)
+// This test verifies that the state endpoint returns an `ETag` which
+// changes when the state changes, and that a request carrying the
+// current `ETag` in `If-None-Match` gets a 304 without a body.
+TEST_F(MasterTest, StateEndpointETag)
 {
-  master::Flags flags = CreateMasterFlags();
-
-  flags.hostname = "localhost";
-  flags.cluster = "test-cluster";
-
-  Try<Owned<cluster::Master>> master = StartMaster(flags);
+  Try<Owned<cluster::Master>> master = StartMaster();
   ASSERT_SOME(master);
 
-  MockExecutor exec(DEFAULT_EXECUTOR_ID);
-  TestContainerizer containerizer(&exec);
+  Future<Response> response = process::http::get(
+      master.get()->pid,
+      "state",
+      None(),
+      createBasicAuthHeaders(DEFAULT_CREDENTIAL));
 
-  Owned<MasterDetector> detector = master.get()->createDetector();
-  Try<Owned<cluster::Slave>> slave = StartSlave(detector.get(), &containerizer);
-  ASSERT_SOME(slave);
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+  ASSERT_TRUE(response->headers.contains("ETag"));
 
-  MockScheduler sched;
-  MesosSchedulerDriver driver(
-      &sched, DEFAULT_FRAMEWORK_INFO, master.get()->pid, DEFAULT_CREDENTIAL);
+  const string etag = response->headers.at("ETag");
 
-  EXPECT_CALL(sched, registered(&driver, _, _))
-    .Times(1);
+  process::http::Headers headers = createBasicAuthHeaders(DEFAULT_CREDENTIAL);
+  headers["If-None-Match"] = etag;
 
-  Future<vector<Offer>> offers;
-  EXPECT_CALL(sched, resourceOffers(&driver, _))
-    .WillOnce(FutureArg<1>(&offers))
-    .WillRepeatedly(Return()); // Ignore subsequent offers.
+  response = process::http::get(master.get()->pid, "state", None(), headers);
 
-  driver.start();
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(
+      process::http::Status::string(process::http::Status::NOT_MODIFIED),
+      response);
+  EXPECT_TRUE(response->body.empty());
 
-  AWAIT_READY(offers);
-  EXPECT_NE(0u, offers.get().size());
+  // Registering an agent changes the state.
+  Future<SlaveRegisteredMessage> slaveRegisteredMessage =
+    FUTURE_PROTOBUF(SlaveRegisteredMessage(), _, _);
 
-  TaskID taskId;
-  taskId.set_value("1");
+  Owned<MasterDetector> detector = master.get()->createDetector();
+  Try<Owned<cluster::Slave>> slave = StartSlave(detector.get());
+  ASSERT_SOME(slave);
 
-  TaskInfo task;
-  task.set_name("");
-  task.mutable_task_id()->MergeFrom(taskId);
-  task.mutable_slave_id()->MergeFrom(offers.get()[0].slave_id());
-  task.mutable_resources()->MergeFrom(offers.get()[0].resources());
-  task.mutable_executor()->MergeFrom(DEFAULT_EXECUTOR_INFO);
+  AWAIT_READY(slaveRegisteredMessage);
 
-  EXPECT_CALL(exec, registered(_, _, _, _))
-    .Times(1);
+  response = process::http::get(master.get()->pid, "state", None(), headers);
 
-  EXPECT_CALL(exec, launchTask(_, _))
-    .WillOnce(SendStatusUpdateFromTask(TASK_RUNNING));
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+  ASSERT_TRUE(response->headers.contains("ETag"));
+  EXPECT_NE(etag, response->headers.at("ETag"));
 
-  Future<TaskStatus> status;
-  EXPECT_CALL(sched, statusUpdate(&driver, _))
-    .WillOnce(FutureArg<1>(&status));
+  Try<JSON::Object> parse = JSON::parse<JSON::Object>(response->body);
+  ASSERT_SOME(parse);
 
-  driver.launchTasks(offers.get()[0].id(), {task});
+  Result<JSON::Array> slaves = parse->find<JSON::Array>("slaves");
+  ASSERT_SOME(slaves);
+  EXPECT_EQ(1u, slaves->values.size());
+}
+
+
+// Tests that the `fields` query parameter of the '/state' endpoint
+// selects the fields to serialize, and that an unknown task state is
+// rejected.
+TEST_F(MasterTest, StateEndpointQuery)
+{
+  Try<Owned<cluster::Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  Future<SlaveRegisteredMessage> slaveRegisteredMessage =
+    FUTURE_PROTOBUF(SlaveRegisteredMessage(), _, _);
+
+  Owned<MasterDetector> detector = master.get()->createDetector();
+  Try<Owned<cluster::Slave>> slave = StartSlave(detector.get());
+  ASSERT_SOME(slave);
+
+  AWAIT_READY(slaveRegisteredMessage);
+
+  Future<Response> response = process::http::get(
+      master.get()->pid,
+      "state",
+      "fields=id,slaves.hostname",
+      createBasicAuthHeaders(DEFAULT_CREDENTIAL));
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+
+  Try<JSON::Object> parse = JSON::parse<JSON::Object>(response->body);
+  ASSERT_SOME(parse);
+
+  EXPECT_SOME(parse->find<JSON::String>("id"));
+  EXPECT_NONE(parse->find<JSON::String>("version"));
+  EXPECT_NONE(parse->find<JSON::Array>("frameworks"));
+
+  Result<JSON::Array> slaves = parse->find<JSON::Array>("slaves");
+  ASSERT_SOME(slaves);
+  ASSERT_EQ(1u, slaves->values.size());
+
+  ASSERT_TRUE(slaves->values[0].is<JSON::Object>());
+  const JSON::Object& agent = slaves->values[0].as<JSON::Object>();
+
+  EXPECT_EQ(1u, agent.values.size());
+  EXPECT_SOME(agent.find<JSON::String>("hostname"));
+
+  response = process::http::get(
+      master.get()->pid,
+      "state",
+      "state=TASK_UNKNOWN_STATE",
+      createBasicAuthHeaders(DEFAULT_CREDENTIAL));
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(BadRequest().status, response);
+}
+
+
+TEST_F(MasterTest, StateSummaryEndpoint)
+{
+  master::Flags flags = CreateMasterFlags();
+
+  flags.hostname = "localhost";
+  flags.cluster = "test-cluster";
+
+  Try<Owned<cluster::Master>> master = StartMaster(flags);
+  ASSERT_SOME(master);
+
+  MockExecutor exec(DEFAULT_EXECUTOR_ID);
+  TestContainerizer containerizer(&exec);
+
+  Owned<MasterDetector> detector = master.get()->createDetector();
+  Try<Owned<cluster::Slave>> slave = StartSlave(detector.get(), &containerizer);
+  ASSERT_SOME(slave);
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+      &sched, DEFAULT_FRAMEWORK_INFO, master.get()->pid, DEFAULT_CREDENTIAL);
+
+  EXPECT_CALL(sched, registered(&driver, _, _))
+    .Times(1);
+
+  Future<vector<Offer>> offers;
+  EXPECT_CALL(sched, resourceOffers(&driver, _))
+    .WillOnce(FutureArg<1>(&offers))
+    .WillRepeatedly(Return()); // Ignore subsequent offers.
+
+  driver.start();
+
+  AWAIT_READY(offers);
+  EXPECT_NE(0u, offers.get().size());
+
+  TaskID taskId;
+  taskId.set_value("1");
+
+  TaskInfo task;
+  task.set_name("");
+  task.mutable_task_id()->MergeFrom(taskId);
+  task.mutable_slave_id()->MergeFrom(offers.get()[0].slave_id());
+  task.mutable_resources()->MergeFrom(offers.get()[0].resources());
+  task.mutable_executor()->MergeFrom(DEFAULT_EXECUTOR_INFO);
+
+  EXPECT_CALL(exec, registered(_, _, _, _))
+    .Times(1);
+
+  EXPECT_CALL(exec, launchTask(_, _))
+    .WillOnce(SendStatusUpdateFromTask(TASK_RUNNING));
+
+  Future<TaskStatus> status;
+  EXPECT_CALL(sched, statusUpdate(&driver, _))
+    .WillOnce(FutureArg<1>(&status));
+
+  driver.launchTasks(offers.get()[0].id(), {task});
 
   AWAIT_READY(status);
   EXPECT_EQ(TASK_RUNNING, status.get().state());
@@ -4049,6 +4440,123 @@ TEST_F(MasterTest, StateSummaryEndpoint)
 }
 
 
+// Tests that `/state-summary?since=` only returns the agents and
+// frameworks that changed, and those that were removed, after the
+// given state generation.
+TEST_F(MasterTest, StateSummaryDelta)
+{
+  Clock::pause();
+
+  Try<Owned<cluster::Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  Future<SlaveRegisteredMessage> slaveRegisteredMessage =
+    FUTURE_PROTOBUF(SlaveRegisteredMessage(), _, _);
+
+  Owned<MasterDetector> detector = master.get()->createDetector();
+  Try<Owned<cluster::Slave>> slave = StartSlave(detector.get());
+  ASSERT_SOME(slave);
+
+  Clock::advance(slave::DEFAULT_REGISTRATION_BACKOFF_FACTOR);
+  AWAIT_READY(slaveRegisteredMessage);
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+      &sched, DEFAULT_FRAMEWORK_INFO, master.get()->pid, DEFAULT_CREDENTIAL);
+
+  Future<FrameworkID> frameworkId;
+  EXPECT_CALL(sched, registered(&driver, _, _))
+    .WillOnce(FutureArg<1>(&frameworkId));
+
+  EXPECT_CALL(sched, resourceOffers(&driver, _))
+    .WillRepeatedly(Return()); // Ignore offers.
+
+  driver.start();
+
+  AWAIT_READY(frameworkId);
+
+  Clock::settle();
+
+  auto stateSummary = [&master](const string& query) -> Try<JSON::Object> {
+    Future<Response> response = process::http::get(
+        master.get()->pid,
+        "state-summary",
+        query,
+        createBasicAuthHeaders(DEFAULT_CREDENTIAL));
+
+    AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+
+    return JSON::parse<JSON::Object>(response->body);
+  };
+
+  // The full summary carries the generation, but no `since`.
+  Try<JSON::Object> summary = stateSummary("");
+  ASSERT_SOME(summary);
+
+  Result<JSON::Number> generation =
+    summary->find<JSON::Number>("generation");
+  ASSERT_SOME(generation);
+
+  EXPECT_NONE(summary->find<JSON::Number>("since"));
+  EXPECT_EQ(1u, summary->values["slaves"].as<JSON::Array>().values.size());
+  EXPECT_EQ(
+      1u, summary->values["frameworks"].as<JSON::Array>().values.size());
+
+  const string since = "since=" + stringify(generation->as<uint64_t>());
+
+  // Nothing changed since that generation.
+  summary = stateSummary(since);
+  ASSERT_SOME(summary);
+
+  EXPECT_SOME_EQ(generation.get(), summary->find<JSON::Number>("generation"));
+  EXPECT_SOME_EQ(generation.get(), summary->find<JSON::Number>("since"));
+  EXPECT_TRUE(summary->values["slaves"].as<JSON::Array>().values.empty());
+  EXPECT_TRUE(summary->values["frameworks"].as<JSON::Array>().values.empty());
+  EXPECT_TRUE(
+      summary->values["removed_slave_ids"].as<JSON::Array>().values.empty());
+  EXPECT_TRUE(
+      summary->values["removed_framework_ids"]
+        .as<JSON::Array>().values.empty());
+
+  // Remove the framework.
+  Future<Nothing> removeFramework =
+    FUTURE_DISPATCH(_, &MesosAllocatorProcess::removeFramework);
+
+  driver.stop();
+  driver.join();
+
+  AWAIT_READY(removeFramework);
+
+  summary = stateSummary(since);
+  ASSERT_SOME(summary);
+
+  EXPECT_TRUE(summary->values["frameworks"].as<JSON::Array>().values.empty());
+
+  JSON::Array removed =
+    summary->values["removed_framework_ids"].as<JSON::Array>();
+  ASSERT_EQ(1u, removed.values.size());
+  EXPECT_EQ(JSON::String(frameworkId->value()), removed.values[0]);
+
+  // A generation that this master did not return yields the full
+  // summary.
+  summary = stateSummary(
+      "since=" + stringify(generation->as<uint64_t>() + 1000000));
+  ASSERT_SOME(summary);
+
+  EXPECT_NONE(summary->find<JSON::Number>("since"));
+  EXPECT_EQ(1u, summary->values["slaves"].as<JSON::Array>().values.size());
+
+  // A generation that is not a number is rejected.
+  Future<Response> response = process::http::get(
+      master.get()->pid,
+      "state-summary",
+      "since=foo",
+      createBasicAuthHeaders(DEFAULT_CREDENTIAL));
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(BadRequest().status, response);
+}
+
+
 // This test verifies that recovered but yet to reregister agents are returned
 // in `recovered_slaves` field of `/state` and `/slaves` endpoints.
 TEST_F(MasterTest, RecoveredSlaves)
@@ -5040,6 +5548,83 @@ TEST_F(MasterTest, DuplicatedSlaveIdWhenSlaveReregister)
 }
 
 
+// This test verifies that an agent that re-registers with the master
+// it was registered with only sends the digest of its state, which
+// the master accepts since it still knows the agent's executors and
+// tasks.
+TEST_F(MasterTest, SlaveReregisterWithStateDigest)
+{
+  Try<Owned<cluster::Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  MockExecutor exec(DEFAULT_EXECUTOR_ID);
+  TestContainerizer containerizer(&exec);
+
+  StandaloneMasterDetector detector(master.get()->pid);
+
+  Future<Option<MasterInfo>> leader = detector.detect();
+  AWAIT_READY(leader);
+  ASSERT_SOME(leader.get());
+
+  Try<Owned<cluster::Slave>> slave = StartSlave(&detector, &containerizer);
+  ASSERT_SOME(slave);
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+      &sched, DEFAULT_FRAMEWORK_INFO, master.get()->pid, DEFAULT_CREDENTIAL);
+
+  EXPECT_CALL(sched, registered(&driver, _, _));
+
+  EXPECT_CALL(sched, resourceOffers(&driver, _))
+    .WillOnce(LaunchTasks(DEFAULT_EXECUTOR_INFO, 1, 1, 64, "*"))
+    .WillRepeatedly(Return()); // Ignore subsequent offers.
+
+  EXPECT_CALL(exec, registered(_, _, _, _));
+
+  EXPECT_CALL(exec, launchTask(_, _))
+    .WillOnce(SendStatusUpdateFromTask(TASK_RUNNING));
+
+  Future<TaskStatus> status;
+  EXPECT_CALL(sched, statusUpdate(&driver, _))
+    .WillOnce(FutureArg<1>(&status));
+
+  Future<Nothing> _statusUpdateAcknowledgement =
+    FUTURE_DISPATCH(_, &Slave::_statusUpdateAcknowledgement);
+
+  driver.start();
+
+  AWAIT_READY(status);
+  EXPECT_EQ(TASK_RUNNING, status->state());
+
+  AWAIT_READY(_statusUpdateAcknowledgement);
+
+  Future<ReregisterSlaveMessage> reregisterSlaveMessage =
+    FUTURE_PROTOBUF(ReregisterSlaveMessage(), _, master.get()->pid);
+
+  Future<SlaveReregisteredMessage> slaveReregisteredMessage =
+    FUTURE_PROTOBUF(SlaveReregisteredMessage(), master.get()->pid, _);
+
+  // Make the agent lose and then detect the same master again.
+  detector.appoint(None());
+  detector.appoint(leader->get());
+
+  AWAIT_READY(reregisterSlaveMessage);
+  EXPECT_TRUE(reregisterSlaveMessage->has_state_digest());
+  EXPECT_EQ(0, reregisterSlaveMessage->tasks_size());
+  EXPECT_EQ(0, reregisterSlaveMessage->executor_infos_size());
+
+  // The master knows the task, so there is nothing to reconcile.
+  AWAIT_READY(slaveReregisteredMessage);
+  EXPECT_EQ(0, slaveReregisteredMessage->reconciliations_size());
+
+  EXPECT_CALL(exec, shutdown(_))
+    .Times(AtMost(1));
+
+  driver.stop();
+  driver.join();
+}
+
+
 // This test ensures that if a framework scheduler provides any
 // labels in its FrameworkInfo message, those labels are included
 // in the master's state endpoint.
@@ -5387,6 +5972,204 @@ TEST_F(MasterTest, MaxCompletedTasksPerFrameworkFlag)
 }
 
 
+// Verifies that the master drops the oldest completed tasks of a
+// framework once they exceed `max_completed_task_bytes_per_framework`.
+TEST_F(MasterTest, MaxCompletedTaskBytesPerFrameworkFlag)
+{
+  master::Flags masterFlags = CreateMasterFlags();
+  masterFlags.max_completed_task_bytes_per_framework = Kilobytes(15);
+
+  Try<Owned<cluster::Master>> master = StartMaster(masterFlags);
+  ASSERT_SOME(master);
+
+  MockExecutor exec(DEFAULT_EXECUTOR_ID);
+  TestContainerizer containerizer(&exec);
+  EXPECT_CALL(exec, registered(_, _, _, _));
+
+  Owned<MasterDetector> detector = master.get()->createDetector();
+  Try<Owned<cluster::Slave>> slave =
+    StartSlave(detector.get(), &containerizer);
+  ASSERT_SOME(slave);
+
+  MockScheduler sched;
+  MesosSchedulerDriver schedDriver(
+      &sched, DEFAULT_FRAMEWORK_INFO, master.get()->pid, DEFAULT_CREDENTIAL);
+
+  Future<Nothing> schedRegistered;
+  EXPECT_CALL(sched, registered(_, _, _))
+    .WillOnce(FutureSatisfy(&schedRegistered));
+
+  process::Queue<Offer> offers;
+  EXPECT_CALL(sched, resourceOffers(_, _))
+    .WillRepeatedly(EnqueueOffers(&offers));
+
+  schedDriver.start();
+
+  AWAIT_READY(schedRegistered);
+
+  // Each task takes up more than 10KB due to its label, hence only
+  // the latest completed task fits into 15KB.
+  for (size_t i = 0; i < 2; i++) {
+    Future<Offer> offer = offers.get();
+    AWAIT_READY(offer);
+
+    TaskInfo task;
+    task.set_name("");
+    task.mutable_task_id()->set_value(stringify(i));
+    task.mutable_slave_id()->MergeFrom(offer->slave_id());
+    task.mutable_resources()->MergeFrom(offer->resources());
+    task.mutable_executor()->MergeFrom(DEFAULT_EXECUTOR_INFO);
+
+    Label* label = task.mutable_labels()->add_labels();
+    label->set_key("key");
+    label->set_value(string(Kilobytes(10).bytes(), 'x'));
+
+    Future<TaskStatus> statusFinished;
+    EXPECT_CALL(exec, launchTask(_, _))
+      .WillOnce(SendStatusUpdateFromTask(TASK_FINISHED));
+    EXPECT_CALL(sched, statusUpdate(_, _))
+      .WillOnce(FutureArg<1>(&statusFinished));
+
+    schedDriver.launchTasks(offer->id(), {task});
+
+    AWAIT_READY(statusFinished);
+    EXPECT_EQ(TASK_FINISHED, statusFinished->state());
+  }
+
+  EXPECT_CALL(exec, shutdown(_))
+    .Times(AtMost(1));
+
+  schedDriver.stop();
+  schedDriver.join();
+
+  Future<Response> response = process::http::get(
+      master.get()->pid,
+      "state",
+      None(),
+      createBasicAuthHeaders(DEFAULT_CREDENTIAL));
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+
+  Try<JSON::Object> parse = JSON::parse<JSON::Object>(response->body);
+  ASSERT_SOME(parse);
+
+  Result<JSON::Array> completedTasks = parse->find<JSON::Array>(
+      "completed_frameworks[0].completed_tasks");
+  ASSERT_SOME(completedTasks);
+  ASSERT_EQ(1u, completedTasks->values.size());
+
+  JSON::Object completedTask = completedTasks->values[0].as<JSON::Object>();
+  EXPECT_EQ(JSON::String("1"), completedTask.values["id"]);
+}
+
+// Verifies that the master trims all but the latest status of a
+// completed task to its state and timestamp.
+TEST_F(MasterTest, CompletedTaskStatusesTrimmed)
+{
+  Try<Owned<cluster::Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  MockExecutor exec(DEFAULT_EXECUTOR_ID);
+  TestContainerizer containerizer(&exec);
+
+  Owned<MasterDetector> detector = master.get()->createDetector();
+
+  Try<Owned<cluster::Slave>> slave =
+    StartSlave(detector.get(), &containerizer);
+  ASSERT_SOME(slave);
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+      &sched, DEFAULT_FRAMEWORK_INFO, master.get()->pid, DEFAULT_CREDENTIAL);
+
+  EXPECT_CALL(sched, registered(&driver, _, _));
+
+  Future<vector<Offer>> offers;
+  EXPECT_CALL(sched, resourceOffers(&driver, _))
+    .WillOnce(FutureArg<1>(&offers))
+    .WillRepeatedly(Return()); // Ignore subsequent offers.
+
+  driver.start();
+
+  AWAIT_READY(offers);
+  ASSERT_FALSE(offers->empty());
+
+  TaskInfo task = createTask(offers->front(), "", DEFAULT_EXECUTOR_ID);
+
+  EXPECT_CALL(exec, registered(_, _, _, _));
+
+  // The TASK_RUNNING status carries labels, which the master should
+  // drop once the task completed.
+  EXPECT_CALL(exec, launchTask(_, _))
+    .WillOnce(Invoke([](ExecutorDriver* driver, const TaskInfo& task) {
+      TaskStatus status;
+      status.mutable_task_id()->CopyFrom(task.task_id());
+      status.set_state(TASK_RUNNING);
+
+      Label* label = status.mutable_labels()->add_labels();
+      label->set_key("key");
+      label->set_value("value");
+
+      driver->sendStatusUpdate(status);
+    }));
+
+  Future<TaskStatus> runningStatus;
+  Future<TaskStatus> killedStatus;
+  EXPECT_CALL(sched, statusUpdate(&driver, _))
+    .WillOnce(FutureArg<1>(&runningStatus))
+    .WillOnce(FutureArg<1>(&killedStatus));
+
+  driver.launchTasks(offers->front().id(), {task});
+
+  AWAIT_READY(runningStatus);
+  EXPECT_EQ(TASK_RUNNING, runningStatus->state());
+
+  EXPECT_CALL(exec, killTask(_, _))
+    .WillOnce(SendStatusUpdateFromTaskID(TASK_KILLED));
+
+  driver.killTask(task.task_id());
+
+  AWAIT_READY(killedStatus);
+  EXPECT_EQ(TASK_KILLED, killedStatus->state());
+
+  // Make sure the master processed the acknowledgement of the
+  // TASK_KILLED update, i.e., the task is completed.
+  Clock::pause();
+  Clock::settle();
+  Clock::resume();
+
+  Future<Response> response = process::http::get(
+      master.get()->pid,
+      "state",
+      None(),
+      createBasicAuthHeaders(DEFAULT_CREDENTIAL));
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+
+  Try<JSON::Object> parse = JSON::parse<JSON::Object>(response->body);
+  ASSERT_SOME(parse);
+
+  Result<JSON::Array> statuses = parse->find<JSON::Array>(
+      "frameworks[0].completed_tasks[0].statuses");
+  ASSERT_SOME(statuses);
+  ASSERT_EQ(2u, statuses->values.size());
+
+  JSON::Object running = statuses->values[0].as<JSON::Object>();
+  EXPECT_EQ(JSON::String("TASK_RUNNING"), running.values["state"]);
+  EXPECT_EQ(1u, running.values.count("timestamp"));
+  EXPECT_EQ(0u, running.values.count("labels"));
+
+  JSON::Object killed = statuses->values[1].as<JSON::Object>();
+  EXPECT_EQ(JSON::String("TASK_KILLED"), killed.values["state"]);
+
+  EXPECT_CALL(exec, shutdown(_))
+    .Times(AtMost(1));
+
+  driver.stop();
+  driver.join();
+}
+
+
 // Test GET requests on various endpoints without authentication and
 // with bad credentials.
 // Note that we have similar checks for the maintenance, roles, quota, teardown,
@@ -34,6 +34,8 @@
 
 #include <stout/gtest.hpp>
 #include <stout/none.hpp>
+#include <stout/os.hpp>
+#include <stout/stopwatch.hpp>
 #include <stout/strings.hpp>
 #include <stout/uuid.hpp>
 
@@ -66,6 +68,8 @@ using process::Message;
 using process::Owned;
 using process::PID;
 
+using std::cout;
+using std::endl;
 using std::string;
 using std::vector;
 
@@ -73,6 +77,7 @@ using testing::_;
 using testing::AtMost;
 using testing::Eq;
 using testing::Return;
+using testing::WithParamInterface;
 
 namespace mesos {
 namespace internal {
@@ -1933,6 +1938,91 @@ TEST_F(TaskValidationTest, TaskEnvironmentVariableWithoutValue)
 // aggregate resource usage.
 
 
+class TaskValidation_BENCHMARK_Test
+  : public MesosTest,
+    public WithParamInterface<size_t> {};
+
+
+// The benchmark is parameterized by the number of tasks.
+INSTANTIATE_TEST_CASE_P(
+    Tasks,
+    TaskValidation_BENCHMARK_Test,
+    ::testing::Values(100U, 1000U, 2000U, 5000U));
+
+
+// Measures how long the master takes to validate and add the tasks
+// of a single `ACCEPT` call, when all of the tasks use the same
+// executor.
+TEST_P(TaskValidation_BENCHMARK_Test, LaunchTasks)
+{
+  const size_t taskCount = GetParam();
+
+  Try<Owned<cluster::Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  // The tasks never reach the agent, so that only the master is
+  // measured.
+  DROP_PROTOBUFS(RunTaskMessage(), _, _);
+
+  slave::Flags agentFlags = CreateSlaveFlags();
+  agentFlags.resources =
+    "cpus:" + stringify(taskCount) + ";mem:" + stringify(taskCount * 32);
+
+  MockExecutor exec(DEFAULT_EXECUTOR_ID);
+  TestContainerizer containerizer(&exec);
+
+  Owned<MasterDetector> detector = master.get()->createDetector();
+  Try<Owned<cluster::Slave>> slave =
+    StartSlave(detector.get(), &containerizer, agentFlags);
+  ASSERT_SOME(slave);
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+      &sched, DEFAULT_FRAMEWORK_INFO, master.get()->pid, DEFAULT_CREDENTIAL);
+
+  EXPECT_CALL(sched, registered(&driver, _, _));
+
+  Future<vector<Offer>> offers;
+  EXPECT_CALL(sched, resourceOffers(&driver, _))
+    .WillOnce(FutureArg<1>(&offers))
+    .WillRepeatedly(Return()); // Ignore subsequent offers.
+
+  driver.start();
+
+  AWAIT_READY(offers);
+  ASSERT_FALSE(offers->empty());
+
+  vector<TaskInfo> tasks;
+  for (size_t i = 0; i < taskCount; i++) {
+    tasks.push_back(createTask(
+        offers->front().slave_id(),
+        Resources::parse("cpus:1;mem:32").get(),
+        "exit 1",
+        DEFAULT_EXECUTOR_ID,
+        "test-task",
+        stringify(i)));
+  }
+
+  Stopwatch watch;
+  watch.start();
+
+  driver.launchTasks(offers->front().id(), tasks);
+
+  // Wait until the master has added all of the tasks.
+  JSON::Object metrics;
+  do {
+    os::sleep(Milliseconds(1));
+    metrics = Metrics();
+  } while (metrics.values["master/tasks_staging"] != taskCount);
+
+  cout << "Launched " << taskCount << " tasks in a single ACCEPT"
+       << " in " << watch.elapsed() << endl;
+
+  driver.stop();
+  driver.join();
+}
+
+
 class ExecutorValidationTest : public MesosTest {};
 
 
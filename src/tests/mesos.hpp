@@ -242,6 +242,9 @@ const static std::string TEST_CGROUPS_HIERARCHY = "/tmp/mesos_test_cgroup";
 // Name of the root cgroup used by the cgroups related tests.
 const static std::string TEST_CGROUPS_ROOT = "mesos_test";
 
+// Cgroups v2 unified hierarchy used by the cgroups v2 related tests.
+const static std::string TEST_CGROUPS2_HIERARCHY = "/sys/fs/cgroup";
+
 
 template <>
 class ContainerizerTest<slave::MesosContainerizer> : public MesosTest
@@ -1730,6 +1733,7 @@ public:
       rescindInverseOffers,
       void(Mesos*, const typename Event::RescindInverseOffer&));
   MOCK_METHOD2_T(update, void(Mesos*, const typename Event::Update&));
+  MOCK_METHOD2_T(updates, void(Mesos*, const typename Event::Updates&));
   MOCK_METHOD2_T(message, void(Mesos*, const typename Event::Message&));
   MOCK_METHOD2_T(failure, void(Mesos*, const typename Event::Failure&));
   MOCK_METHOD2_T(error, void(Mesos*, const typename Event::Error&));
@@ -1755,6 +1759,9 @@ public:
       case Event::UPDATE:
         update(mesos, event.update());
         break;
+      case Event::UPDATES:
+        updates(mesos, event.updates());
+        break;
       case Event::MESSAGE:
         message(mesos, event.message());
         break;
@@ -1926,6 +1933,12 @@ public:
       case Event::ACKNOWLEDGED:
         acknowledged(mesos, event.acknowledged());
         break;
+      case Event::ACKNOWLEDGEMENTS:
+        foreach (const typename Event::Acknowledged& acknowledged_,
+                 event.acknowledgements().acknowledgements()) {
+          acknowledged(mesos, acknowledged_);
+        }
+        break;
       case Event::MESSAGE:
         message(mesos, event.message());
         break;
@@ -0,0 +1,242 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include <mesos/resources.hpp>
+
+#include <process/clock.hpp>
+#include <process/time.hpp>
+
+#include <stout/gtest.hpp>
+#include <stout/hashset.hpp>
+
+#include "master/allocator/mesos/offer_filters.hpp"
+
+using mesos::internal::master::allocator::internal::OfferFilters;
+
+using process::Clock;
+using process::Time;
+
+namespace mesos {
+namespace internal {
+namespace tests {
+
+static FrameworkID frameworkId(const std::string& value)
+{
+  FrameworkID id;
+  id.set_value(value);
+  return id;
+}
+
+
+static SlaveID slaveId(const std::string& value)
+{
+  SlaveID id;
+  id.set_value(value);
+  return id;
+}
+
+
+// Tests that a filter refuses the resources that it contains, only on
+// its own agent, and only for its own framework.
+TEST(OfferFiltersTest, Filtered)
+{
+  OfferFilters filters;
+
+  const Time deadline = Clock::now() + Seconds(5);
+
+  filters.add(
+      "role1",
+      frameworkId("framework1"),
+      slaveId("agent1"),
+      Resources::parse("cpus:2;mem:1024").get(),
+      deadline);
+
+  EXPECT_TRUE(filters.filtered(
+      frameworkId("framework1"),
+      slaveId("agent1"),
+      Resources::parse("cpus:2;mem:1024").get()));
+
+  EXPECT_TRUE(filters.filtered(
+      frameworkId("framework1"),
+      slaveId("agent1"),
+      Resources::parse("cpus:1").get()));
+
+  // More resources than refused are not filtered.
+  EXPECT_FALSE(filters.filtered(
+      frameworkId("framework1"),
+      slaveId("agent1"),
+      Resources::parse("cpus:3;mem:1024").get()));
+
+  // Resources with a name that the filter does not refuse are not
+  // filtered, including names that were never seen by any filter.
+  EXPECT_FALSE(filters.filtered(
+      frameworkId("framework1"),
+      slaveId("agent1"),
+      Resources::parse("cpus:1;disk:10").get()));
+
+  filters.add(
+      "role1",
+      frameworkId("framework2"),
+      slaveId("agent2"),
+      Resources::parse("disk:10").get(),
+      deadline);
+
+  EXPECT_FALSE(filters.filtered(
+      frameworkId("framework1"),
+      slaveId("agent1"),
+      Resources::parse("cpus:1;disk:10").get()));
+
+  EXPECT_FALSE(filters.filtered(
+      frameworkId("framework1"),
+      slaveId("agent2"),
+      Resources::parse("cpus:1").get()));
+
+  EXPECT_FALSE(filters.filtered(
+      frameworkId("framework2"),
+      slaveId("agent1"),
+      Resources::parse("cpus:1").get()));
+
+  EXPECT_TRUE(filters.filtered(
+      frameworkId("framework2"),
+      slaveId("agent2"),
+      Resources::parse("disk:5").get()));
+}
+
+
+// Tests that filters expire in deadline order, returning the agents
+// they were set on, and that expired filters no longer refuse
+// resources or count towards their role.
+TEST(OfferFiltersTest, Expire)
+{
+  OfferFilters filters;
+
+  EXPECT_NONE(filters.deadline());
+
+  const Time now = Clock::now();
+
+  const Resources cpus = Resources::parse("cpus:1").get();
+
+  filters.add(
+      "role1", frameworkId("framework1"), slaveId("agent1"),
+      cpus, now + Seconds(10));
+
+  filters.add(
+      "role1", frameworkId("framework1"), slaveId("agent2"),
+      cpus, now + Seconds(5));
+
+  filters.add(
+      "role2", frameworkId("framework2"), slaveId("agent1"),
+      cpus, now + Seconds(5));
+
+  EXPECT_SOME_EQ(now + Seconds(5), filters.deadline());
+  EXPECT_EQ(2u, filters.count("role1"));
+  EXPECT_EQ(1u, filters.count("role2"));
+
+  // Nothing has expired yet.
+  EXPECT_TRUE(filters.expire(now + Seconds(1)).empty());
+
+  // A filter expires once its deadline is reached.
+  EXPECT_EQ(hashset<SlaveID>({slaveId("agent1"), slaveId("agent2")}),
+            filters.expire(now + Seconds(5)));
+
+  EXPECT_SOME_EQ(now + Seconds(10), filters.deadline());
+  EXPECT_EQ(1u, filters.count("role1"));
+  EXPECT_EQ(0u, filters.count("role2"));
+
+  EXPECT_FALSE(filters.filtered(
+      frameworkId("framework1"), slaveId("agent2"), cpus));
+
+  EXPECT_FALSE(filters.filtered(
+      frameworkId("framework2"), slaveId("agent1"), cpus));
+
+  EXPECT_TRUE(filters.filtered(
+      frameworkId("framework1"), slaveId("agent1"), cpus));
+
+  EXPECT_EQ(hashset<SlaveID>({slaveId("agent1")}),
+            filters.expire(now + Seconds(20)));
+
+  EXPECT_NONE(filters.deadline());
+  EXPECT_EQ(0u, filters.count("role1"));
+
+  EXPECT_FALSE(filters.filtered(
+      frameworkId("framework1"), slaveId("agent1"), cpus));
+}
+
+
+// Tests that removing a framework removes all of its filters right
+// away, along with their deadlines, without affecting the filters of
+// other frameworks.
+TEST(OfferFiltersTest, Remove)
+{
+  OfferFilters filters;
+
+  const Time now = Clock::now();
+
+  const Resources cpus = Resources::parse("cpus:1").get();
+
+  filters.add(
+      "role1", frameworkId("framework1"), slaveId("agent1"),
+      cpus, now + Seconds(5));
+
+  filters.add(
+      "role1", frameworkId("framework1"), slaveId("agent2"),
+      cpus, now + Seconds(10));
+
+  filters.add(
+      "role1", frameworkId("framework2"), slaveId("agent1"),
+      cpus, now + Seconds(20));
+
+  EXPECT_EQ(3u, filters.count("role1"));
+
+  filters.remove(frameworkId("framework1"));
+
+  EXPECT_EQ(1u, filters.count("role1"));
+  EXPECT_SOME_EQ(now + Seconds(20), filters.deadline());
+
+  EXPECT_FALSE(filters.filtered(
+      frameworkId("framework1"), slaveId("agent1"), cpus));
+
+  EXPECT_FALSE(filters.filtered(
+      frameworkId("framework1"), slaveId("agent2"), cpus));
+
+  EXPECT_TRUE(filters.filtered(
+      frameworkId("framework2"), slaveId("agent1"), cpus));
+
+  // The deadlines of the removed filters are gone too, so expiring
+  // them returns no agents.
+  EXPECT_TRUE(filters.expire(now + Seconds(10)).empty());
+
+  // Removing an unknown framework, or one twice, is a no-op.
+  filters.remove(frameworkId("framework1"));
+  filters.remove(frameworkId("framework3"));
+
+  EXPECT_EQ(1u, filters.count("role1"));
+
+  // A framework can set filters again after being removed.
+  filters.add(
+      "role1", frameworkId("framework1"), slaveId("agent1"),
+      cpus, now + Seconds(30));
+
+  EXPECT_EQ(2u, filters.count("role1"));
+  EXPECT_TRUE(filters.filtered(
+      frameworkId("framework1"), slaveId("agent1"), cpus));
+}
+
+} // namespace tests {
+} // namespace internal {
+} // namespace mesos {
@@ -22,12 +22,15 @@
 
 #include <mesos/resources.hpp>
 
+#include <mesos/module/resource_estimator.hpp>
+
 #include <mesos/slave/qos_controller.hpp>
 
 #include <process/clock.hpp>
 #include <process/future.hpp>
 #include <process/gtest.hpp>
 
+#include <stout/bytes.hpp>
 #include <stout/gtest.hpp>
 #include <stout/os.hpp>
 #include <stout/path.hpp>
@@ -44,6 +47,7 @@
 
 #include "slave/flags.hpp"
 #include "slave/slave.hpp"
+#include "slave/qos_controllers/interference.hpp"
 #include "slave/qos_controllers/load.hpp"
 
 #include "tests/flags.hpp"
@@ -58,6 +62,7 @@ using mesos::internal::master::Master;
 
 using mesos::internal::protobuf::createLabel;
 
+using mesos::internal::slave::InterferenceQoSController;
 using mesos::internal::slave::LoadQoSController;
 using mesos::internal::slave::Slave;
 
@@ -65,6 +70,7 @@ using mesos::master::detector::MasterDetector;
 using mesos::master::detector::StandaloneMasterDetector;
 
 using mesos::slave::QoSCorrection;
+using mesos::slave::ResourceEstimator;
 
 using std::list;
 using std::string;
@@ -84,6 +90,9 @@ namespace tests {
 const char FIXED_RESOURCE_ESTIMATOR_NAME[] =
   "org_apache_mesos_FixedResourceEstimator";
 
+const char USAGE_RESOURCE_ESTIMATOR_NAME[] =
+  "org_apache_mesos_UsageResourceEstimator";
+
 
 class OversubscriptionTest : public MesosTest
 {
@@ -125,6 +134,26 @@ protected:
     ASSERT_SOME(modules::ModuleManager::load(modules));
   }
 
+  void loadUsageResourceEstimatorModule(const hashmap<string, string>& values)
+  {
+    string libraryPath = getModulePath("usage_resource_estimator");
+
+    Modules::Library* library = modules.add_libraries();
+    library->set_name("usage_resource_estimator");
+    library->set_file(libraryPath);
+
+    Modules::Library::Module* module = library->add_modules();
+    module->set_name(USAGE_RESOURCE_ESTIMATOR_NAME);
+
+    foreachpair (const string& key, const string& value, values) {
+      Parameter* parameter = module->add_parameters();
+      parameter->set_key(key);
+      parameter->set_value(value);
+    }
+
+    ASSERT_SOME(modules::ModuleManager::load(modules));
+  }
+
   // TODO(vinod): Make this a global helper that other tests (e.g.,
   // hierarchical allocator tests) can use.
   Resources createRevocableResources(
@@ -342,6 +371,134 @@ TEST_F(OversubscriptionTest, ForwardUpdateSlaveMessage)
 }
 
 
+// This test verifies that the agent does not forward estimates of the
+// oversubscribed resources that differ from the previously forwarded
+// one by less than `--oversubscribed_resources_threshold`.
+TEST_F(OversubscriptionTest, SuppressSmallEstimateChanges)
+{
+  Try<Owned<cluster::Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  Future<SlaveRegisteredMessage> slaveRegistered =
+    FUTURE_PROTOBUF(SlaveRegisteredMessage(), _, _);
+
+  MockResourceEstimator resourceEstimator;
+
+  EXPECT_CALL(resourceEstimator, initialize(_));
+
+  Queue<Resources> estimations;
+  EXPECT_CALL(resourceEstimator, oversubscribable())
+    .WillRepeatedly(InvokeWithoutArgs(&estimations, &Queue<Resources>::get));
+
+  slave::Flags flags = CreateSlaveFlags();
+  flags.oversubscribed_resources_threshold = 0.1;
+
+  Owned<MasterDetector> detector = master.get()->createDetector();
+
+  Try<Owned<cluster::Slave>> slave =
+    StartSlave(detector.get(), &resourceEstimator, flags);
+  ASSERT_SOME(slave);
+
+  AWAIT_READY(slaveRegistered);
+
+  Future<UpdateSlaveMessage> update =
+    FUTURE_PROTOBUF(UpdateSlaveMessage(), _, _);
+
+  Clock::pause();
+  Clock::advance(flags.oversubscribed_resources_interval);
+  Clock::settle();
+
+  // The first estimate is always forwarded.
+  estimations.put(createRevocableResources("cpus", "10"));
+
+  AWAIT_READY(update);
+  EXPECT_EQ(
+      createRevocableResources("cpus", "10"),
+      update->oversubscribed_resources());
+
+  update = FUTURE_PROTOBUF(UpdateSlaveMessage(), _, _);
+
+  // A change of 5% is not forwarded.
+  Clock::advance(flags.oversubscribed_resources_interval);
+  Clock::settle();
+
+  estimations.put(createRevocableResources("cpus", "10.5"));
+  Clock::settle();
+
+  EXPECT_TRUE(update.isPending());
+
+  // A change of 20% from the previously forwarded estimate is.
+  Clock::advance(flags.oversubscribed_resources_interval);
+  Clock::settle();
+
+  estimations.put(createRevocableResources("cpus", "12"));
+
+  AWAIT_READY(update);
+  EXPECT_EQ(
+      createRevocableResources("cpus", "12"),
+      update->oversubscribed_resources());
+}
+
+
+// This test verifies that with `--coalesce_agent_updates` the master
+// applies the updates of the oversubscribed resources of an agent once
+// per allocation interval.
+TEST_F(OversubscriptionTest, CoalesceUpdateSlaveMessages)
+{
+  master::Flags masterFlags = CreateMasterFlags();
+  masterFlags.coalesce_agent_updates = true;
+
+  Try<Owned<cluster::Master>> master = StartMaster(masterFlags);
+  ASSERT_SOME(master);
+
+  Future<SlaveRegisteredMessage> slaveRegistered =
+    FUTURE_PROTOBUF(SlaveRegisteredMessage(), _, _);
+
+  MockResourceEstimator resourceEstimator;
+
+  EXPECT_CALL(resourceEstimator, initialize(_));
+
+  Queue<Resources> estimations;
+  EXPECT_CALL(resourceEstimator, oversubscribable())
+    .WillOnce(InvokeWithoutArgs(&estimations, &Queue<Resources>::get));
+
+  slave::Flags flags = CreateSlaveFlags();
+
+  Owned<MasterDetector> detector = master.get()->createDetector();
+
+  Try<Owned<cluster::Slave>> slave =
+    StartSlave(detector.get(), &resourceEstimator, flags);
+  ASSERT_SOME(slave);
+
+  AWAIT_READY(slaveRegistered);
+
+  Future<UpdateSlaveMessage> update =
+    FUTURE_PROTOBUF(UpdateSlaveMessage(), _, _);
+
+  Clock::pause();
+  Clock::advance(flags.oversubscribed_resources_interval);
+  Clock::settle();
+
+  estimations.put(createRevocableResources("cpus", "1"));
+
+  AWAIT_READY(update);
+  Clock::settle();
+
+  // The update has been received but not applied yet.
+  JSON::Object metrics = Metrics();
+  ASSERT_EQ(1u, metrics.values.count("master/messages_update_slave"));
+  ASSERT_EQ(1u, metrics.values["master/messages_update_slave"]);
+  ASSERT_EQ(1u, metrics.values.count("master/cpus_revocable_total"));
+  ASSERT_EQ(0.0, metrics.values["master/cpus_revocable_total"]);
+
+  Clock::advance(masterFlags.allocation_interval);
+  Clock::settle();
+
+  metrics = Metrics();
+  ASSERT_EQ(1.0, metrics.values["master/cpus_revocable_total"]);
+}
+
+
 // This test verifies that a framework that accepts revocable
 // resources can launch a task with revocable resources.
 TEST_F(OversubscriptionTest, RevocableOffer)
@@ -1478,6 +1635,245 @@ TEST_F(OversubscriptionTest, LoadQoSController)
 }
 
 
+// This test verifies that the usage resource estimator estimates the
+// slack between the allocated and the used resources of the executors.
+TEST_F(OversubscriptionTest, UsageResourceEstimator)
+{
+  loadUsageResourceEstimatorModule({
+    {"window", "1secs"},
+    {"percentile", "95"},
+    {"safety_margin", "0.25"}});
+
+  Try<ResourceEstimator*> create =
+    modules::ModuleManager::create<ResourceEstimator>(
+        USAGE_RESOURCE_ESTIMATOR_NAME);
+
+  ASSERT_SOME(create);
+
+  Owned<ResourceEstimator> estimator(create.get());
+
+  // The cpu time of the executor at the time of the statistics.
+  double timestamp = 0;
+  double cpuTime = 0;
+
+  estimator->initialize([this, &timestamp, &cpuTime]() {
+    ResourceStatistics statistics = createResourceStatistics();
+    statistics.set_timestamp(timestamp);
+    statistics.set_cpus_user_time_secs(cpuTime);
+    statistics.set_cpus_system_time_secs(0);
+
+    ResourceUsage usage;
+
+    ResourceUsage::Executor* executor = usage.add_executors();
+    executor->mutable_executor_info()->CopyFrom(
+        createExecutorInfo("framework", "executor"));
+    executor->mutable_allocated()->CopyFrom(
+        Resources::parse("cpus:4;mem:1024").get());
+    executor->mutable_statistics()->CopyFrom(statistics);
+    executor->mutable_container_id()->set_value("container");
+
+    return Future<ResourceUsage>(usage);
+  });
+
+  Clock::pause();
+
+  // The cpu usage of the executor is not known yet, hence there is
+  // nothing to oversubscribe.
+  Future<Resources> estimate = estimator->oversubscribable();
+  AWAIT_READY(estimate);
+  EXPECT_NONE(estimate->revocable().cpus());
+
+  // The executor uses one cpu, hence the estimate is three cpus minus
+  // the safety margin (a quarter of the allocated cpus). Note that the
+  // previous sample has left the window.
+  Clock::advance(Seconds(2));
+  timestamp = 2;
+  cpuTime = 2;
+
+  estimate = estimator->oversubscribable();
+  AWAIT_READY(estimate);
+  EXPECT_SOME_EQ(2.0, estimate->revocable().cpus());
+
+  // The memory is not oversubscribed by default.
+  EXPECT_NONE(estimate->revocable().mem());
+
+  Clock::resume();
+}
+
+
+// This test verifies the functionality of the Interference QoS
+// Controller. If the CPI of a non-revocable executor exceeds the
+// configured threshold then the revocable executors should be
+// throttled before they get evicted.
+TEST_F(OversubscriptionTest, InterferenceQoSController)
+{
+  // Throttle down to a quarter of the cpus and evict after one more
+  // evaluation with interference at that point.
+  InterferenceQoSController controller(
+      2.0, None(), None(), Duration::zero(), 0.25, 1);
+
+  // The number of cycles of the non-revocable executor, which
+  // executes 1000 instructions.
+  uint64_t cycles = 1000;
+
+  controller.initialize([this, &cycles]() -> Future<ResourceUsage> {
+    ResourceUsage usage;
+
+    ResourceStatistics statistics = createResourceStatistics();
+    statistics.mutable_perf()->set_timestamp(0);
+    statistics.mutable_perf()->set_duration(1);
+    statistics.mutable_perf()->set_cycles(cycles);
+    statistics.mutable_perf()->set_instructions(1000);
+
+    ResourceUsage::Executor* executor = usage.add_executors();
+    executor->mutable_executor_info()->CopyFrom(
+        createExecutorInfo("framework", "executor1"));
+    executor->mutable_allocated()->CopyFrom(
+        Resources::parse("cpus:1;mem:128").get());
+    executor->mutable_statistics()->CopyFrom(statistics);
+    executor->mutable_container_id()->set_value("container1");
+
+    Resources resources = Resources::parse("mem:256").get();
+    resources += createRevocableResources("cpus", "4");
+
+    executor = usage.add_executors();
+    executor->mutable_executor_info()->CopyFrom(
+        createExecutorInfo("framework", "executor2"));
+    executor->mutable_allocated()->CopyFrom(resources);
+    executor->mutable_statistics()->CopyFrom(createResourceStatistics());
+    executor->mutable_container_id()->set_value("container2");
+
+    return usage;
+  });
+
+  // The CPI of 1 is below the threshold.
+  Future<list<QoSCorrection>> qosCorrections = controller.corrections();
+  AWAIT_READY(qosCorrections);
+  EXPECT_TRUE(qosCorrections->empty());
+
+  // The CPI of 3 exceeds the threshold, hence the revocable executor
+  // is throttled to half and then a quarter of its cpus.
+  cycles = 3000;
+
+  foreach (double fraction, vector<double>({0.5, 0.25})) {
+    qosCorrections = controller.corrections();
+    AWAIT_READY(qosCorrections);
+    ASSERT_EQ(1u, qosCorrections->size());
+
+    const QoSCorrection& correction = qosCorrections->front();
+    EXPECT_EQ(QoSCorrection::THROTTLE, correction.type());
+    EXPECT_EQ("executor2", correction.throttle().executor_id().value());
+    EXPECT_EQ(fraction, correction.throttle().cpus_fraction());
+  }
+
+  // It is evicted if the throttling doesn't help.
+  qosCorrections = controller.corrections();
+  AWAIT_READY(qosCorrections);
+  ASSERT_EQ(1u, qosCorrections->size());
+  EXPECT_EQ(QoSCorrection::KILL, qosCorrections->front().type());
+  EXPECT_EQ("container2",
+            qosCorrections->front().kill().container_id().value());
+}
+
+
+// This test verifies that the Interference QoS Controller shrinks the
+// memory of the revocable executors if a non-revocable executor is
+// predicted to run out of memory, and that the memory is restored
+// once the memory pressure is gone.
+TEST_F(OversubscriptionTest, InterferenceQoSControllerMemoryPressure)
+{
+  // Predict OOMs within 30 seconds and shrink the memory down to a
+  // quarter.
+  InterferenceQoSController controller(
+      None(),
+      None(),
+      None(),
+      Duration::zero(),
+      InterferenceQoSController::DEFAULT_MIN_CPUS_FRACTION,
+      InterferenceQoSController::DEFAULT_EVICT_AFTER,
+      Seconds(30),
+      0.25);
+
+  // The growth of the rss of the non-revocable executor between two
+  // medium memory pressure events one second apart.
+  Bytes growth = Bytes(0);
+
+  controller.initialize([this, &growth]() -> Future<ResourceUsage> {
+    ResourceUsage usage;
+
+    // The non-revocable executor is 10MB below its memory limit.
+    ResourceStatistics statistics = createResourceStatistics();
+    statistics.set_mem_limit_bytes(Megabytes(128).bytes());
+    statistics.set_mem_total_bytes(Megabytes(118).bytes());
+
+    if (growth > 0) {
+      statistics.set_mem_medium_pressure_rate(1);
+      statistics.set_mem_pressure_interval_secs(1);
+      statistics.set_mem_pressure_rss_delta_bytes(growth.bytes());
+    }
+
+    ResourceUsage::Executor* executor = usage.add_executors();
+    executor->mutable_executor_info()->CopyFrom(
+        createExecutorInfo("framework", "executor1"));
+    executor->mutable_allocated()->CopyFrom(
+        Resources::parse("cpus:1;mem:128").get());
+    executor->mutable_statistics()->CopyFrom(statistics);
+    executor->mutable_container_id()->set_value("container1");
+
+    Resources resources = Resources::parse("cpus:1").get();
+    resources += createRevocableResources("mem", "256");
+
+    executor = usage.add_executors();
+    executor->mutable_executor_info()->CopyFrom(
+        createExecutorInfo("framework", "executor2"));
+    executor->mutable_allocated()->CopyFrom(resources);
+    executor->mutable_statistics()->CopyFrom(createResourceStatistics());
+    executor->mutable_container_id()->set_value("container2");
+
+    return usage;
+  });
+
+  // The limit is reached in 100 seconds, beyond the horizon.
+  growth = Kilobytes(100);
+
+  Future<list<QoSCorrection>> qosCorrections = controller.corrections();
+  AWAIT_READY(qosCorrections);
+  EXPECT_TRUE(qosCorrections->empty());
+
+  // The limit is reached in 10 seconds, hence the memory of the
+  // revocable executor is shrunk to half and then a quarter.
+  growth = Megabytes(1);
+
+  foreach (double fraction, vector<double>({0.5, 0.25})) {
+    qosCorrections = controller.corrections();
+    AWAIT_READY(qosCorrections);
+    ASSERT_EQ(1u, qosCorrections->size());
+
+    const QoSCorrection& correction = qosCorrections->front();
+    EXPECT_EQ(QoSCorrection::THROTTLE, correction.type());
+    EXPECT_EQ("executor2", correction.throttle().executor_id().value());
+    EXPECT_EQ(1, correction.throttle().cpus_fraction());
+    EXPECT_EQ(fraction, correction.throttle().mem_fraction());
+  }
+
+  // The memory is restored once the pressure is gone.
+  growth = Bytes(0);
+
+  foreach (double fraction, vector<double>({0.5, 1})) {
+    qosCorrections = controller.corrections();
+    AWAIT_READY(qosCorrections);
+    ASSERT_EQ(1u, qosCorrections->size());
+
+    const QoSCorrection& correction = qosCorrections->front();
+    EXPECT_EQ(QoSCorrection::THROTTLE, correction.type());
+    EXPECT_EQ(fraction, correction.throttle().mem_fraction());
+  }
+
+  qosCorrections = controller.corrections();
+  AWAIT_READY(qosCorrections);
+  EXPECT_TRUE(qosCorrections->empty());
+}
+
 } // namespace tests {
 } // namespace internal {
 } // namespace mesos {
@@ -103,6 +103,37 @@ TEST_F(PathsTest, CreateExecutorDirectory)
 }
 
 
+// Verifies that a pooled sandbox is moved into place as the sandbox
+// of an executor.
+TEST_F(PathsTest, CreateExecutorDirectoryFromPool)
+{
+  Try<string> sandbox = paths::createPooledSandbox(rootDir);
+  ASSERT_SOME(sandbox);
+
+  EXPECT_EQ(paths::getSandboxPoolPath(rootDir), Path(sandbox.get()).dirname());
+  EXPECT_TRUE(os::exists(sandbox.get()));
+
+  const string result = paths::createExecutorDirectory(
+      rootDir, slaveId, frameworkId, executorId, containerId, None(), sandbox.get());
+
+  EXPECT_EQ(
+      paths::getExecutorRunPath(
+          rootDir, slaveId, frameworkId, executorId, containerId),
+      result);
+
+  EXPECT_TRUE(os::exists(result));
+  EXPECT_FALSE(os::exists(sandbox.get()));
+
+  // The latest symlink points to the new sandbox.
+  const string latest = paths::getExecutorLatestRunPath(
+      rootDir, slaveId, frameworkId, executorId);
+
+  Result<string> realpath = os::realpath(latest);
+  ASSERT_SOME(realpath);
+  EXPECT_EQ(os::realpath(result).get(), realpath.get());
+}
+
+
 TEST_F_TEMP_DISABLED_ON_WINDOWS(PathsTest, ParseExecutorRunPath)
 {
   string goodDir = paths::getExecutorRunPath(
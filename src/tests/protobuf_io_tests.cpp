@@ -161,6 +161,62 @@ TEST_F(ProtobufIOTest, RepeatedPtrField)
   }
 }
 
+
+
+TEST_F(ProtobufIOTest, Reader)
+{
+  const string file = ".protobuf_io_test_reader";
+
+  // Write enough messages for the reader to buffer several blocks.
+  const size_t writes = 10000;
+  for (size_t i = 0; i < writes; i++) {
+    FrameworkID frameworkId;
+    frameworkId.set_value(stringify(i));
+
+    Try<Nothing> result = ::protobuf::append(file, frameworkId);
+    ASSERT_SOME(result);
+  }
+
+  Try<Bytes> size = os::stat::size(file);
+  ASSERT_SOME(size);
+
+  Try<int> fd = os::open(file, O_RDWR | O_APPEND | O_CLOEXEC);
+  ASSERT_SOME(fd);
+
+  // Append a partial message, i.e., the size without the contents.
+  const uint32_t partial = 42;
+  ASSERT_SOME(os::write(fd.get(), string((char*) &partial, sizeof(partial))));
+
+  ASSERT_EQ(0, lseek(fd.get(), 0, SEEK_SET));
+
+  ::protobuf::Reader<FrameworkID> reader(fd.get(), true);
+
+  Result<FrameworkID> read = None();
+  size_t reads = 0;
+  while (true) {
+    read = reader.read();
+    if (!read.isSome()) {
+      break;
+    }
+
+    EXPECT_EQ(read.get().value(), stringify(reads++));
+  }
+
+  // The partial message is ignored and the file offset is set to
+  // right after the last message.
+  ASSERT_TRUE(read.isNone());
+  ASSERT_EQ(writes, reads);
+  EXPECT_EQ((off_t) size.get().bytes(), lseek(fd.get(), 0, SEEK_CUR));
+
+  // Without ignoring partial messages, the partial message is an
+  // error and the file offset is not changed.
+  ::protobuf::Reader<FrameworkID> strict(fd.get());
+  EXPECT_ERROR(strict.read());
+  EXPECT_EQ((off_t) size.get().bytes(), lseek(fd.get(), 0, SEEK_CUR));
+
+  os::close(fd.get());
+}
+
 } // namespace tests {
 } // namespace internal {
 } // namespace mesos {
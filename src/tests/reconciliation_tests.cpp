@@ -776,6 +776,94 @@ TEST_F(ReconciliationTest, ImplicitNonTerminalTask)
 }
 
 
+// This test ensures that a framework with the BATCHED_RECONCILIATION
+// capability receives the non-terminal tasks of an implicit
+// reconciliation request in a batch.
+TEST_F(ReconciliationTest, ImplicitBatchedReconciliation)
+{
+  Try<Owned<cluster::Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  MockExecutor exec(DEFAULT_EXECUTOR_ID);
+  TestContainerizer containerizer(&exec);
+
+  Owned<MasterDetector> detector = master.get()->createDetector();
+  Try<Owned<cluster::Slave>> slave = StartSlave(detector.get(), &containerizer);
+  ASSERT_SOME(slave);
+
+  FrameworkInfo frameworkInfo = DEFAULT_FRAMEWORK_INFO;
+  frameworkInfo.add_capabilities()->set_type(
+      FrameworkInfo::Capability::BATCHED_RECONCILIATION);
+
+  // Launch a framework and get two tasks running.
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+    &sched, frameworkInfo, master.get()->pid, DEFAULT_CREDENTIAL);
+
+  Future<FrameworkID> frameworkId;
+  EXPECT_CALL(sched, registered(&driver, _, _))
+    .WillOnce(FutureArg<1>(&frameworkId));
+
+  EXPECT_CALL(sched, resourceOffers(&driver, _))
+    .WillOnce(LaunchTasks(DEFAULT_EXECUTOR_INFO, 2, 1, 128, "*"))
+    .WillRepeatedly(Return()); // Ignore subsequent offers.
+
+  EXPECT_CALL(exec, registered(_, _, _, _));
+
+  EXPECT_CALL(exec, launchTask(_, _))
+    .WillRepeatedly(SendStatusUpdateFromTask(TASK_RUNNING));
+
+  Future<TaskStatus> update1;
+  Future<TaskStatus> update2;
+  EXPECT_CALL(sched, statusUpdate(&driver, _))
+    .WillOnce(FutureArg<1>(&update1))
+    .WillOnce(FutureArg<1>(&update2));
+
+  driver.start();
+
+  // Wait until the framework is registered.
+  AWAIT_READY(frameworkId);
+
+  AWAIT_READY(update1);
+  EXPECT_EQ(TASK_RUNNING, update1->state());
+
+  AWAIT_READY(update2);
+  EXPECT_EQ(TASK_RUNNING, update2->state());
+
+  // When making an implicit reconciliation request, both non-terminal
+  // tasks should be sent back in a single message.
+  Future<StatusUpdatesMessage> statusUpdatesMessage =
+    FUTURE_PROTOBUF(StatusUpdatesMessage(), master.get()->pid, _);
+
+  Future<TaskStatus> update3;
+  Future<TaskStatus> update4;
+  EXPECT_CALL(sched, statusUpdate(&driver, _))
+    .WillOnce(FutureArg<1>(&update3))
+    .WillOnce(FutureArg<1>(&update4));
+
+  driver.reconcileTasks({});
+
+  AWAIT_READY(statusUpdatesMessage);
+  EXPECT_EQ(2, statusUpdatesMessage->updates_size());
+
+  AWAIT_READY(update3);
+  EXPECT_EQ(TASK_RUNNING, update3->state());
+  EXPECT_EQ(TaskStatus::REASON_RECONCILIATION, update3->reason());
+
+  AWAIT_READY(update4);
+  EXPECT_EQ(TASK_RUNNING, update4->state());
+  EXPECT_EQ(TaskStatus::REASON_RECONCILIATION, update4->reason());
+
+  EXPECT_FALSE(update3->task_id() == update4->task_id());
+
+  EXPECT_CALL(exec, shutdown(_))
+    .Times(AtMost(1));
+
+  driver.stop();
+  driver.join();
+}
+
+
 // This test ensures that the master does not send updates for
 // terminal tasks during an implicit reconciliation request.
 // TODO(bmahler): Soon the master will keep non-acknowledged
@@ -115,6 +115,7 @@ using mesos::http::authentication::BasicAuthenticatorFactory;
 using mesos::state::LogStorage;
 using mesos::state::Storage;
 using mesos::state::protobuf::State;
+using mesos::state::protobuf::Variable;
 
 using state::Entry;
 
@@ -264,6 +265,94 @@ TEST_F(RegistrarTest, Admit)
 }
 
 
+// Tests that operations that arrive within `--registry_batch_interval`
+// of each other are stored together.
+TEST_F(RegistrarTest, BatchInterval)
+{
+  flags.registry_batch_interval = Seconds(10);
+
+  Registrar registrar(flags, state);
+  AWAIT_READY(registrar.recover(master));
+
+  SlaveInfo info2 = slave;
+  info2.mutable_id()->set_value("2");
+
+  Clock::pause();
+
+  Future<bool> admit1 =
+    registrar.apply(Owned<Operation>(new AdmitSlave(slave)));
+
+  Future<bool> admit2 =
+    registrar.apply(Owned<Operation>(new AdmitSlave(info2)));
+
+  Clock::settle();
+
+  // The operations wait for the rest of the batch interval.
+  EXPECT_TRUE(admit1.isPending());
+  EXPECT_TRUE(admit2.isPending());
+
+  Clock::advance(flags.registry_batch_interval);
+  Clock::resume();
+
+  AWAIT_TRUE(admit1);
+  AWAIT_TRUE(admit2);
+
+  // One store for the recovery and one for both of the operations.
+  JSON::Object metrics = Metrics();
+
+  EXPECT_EQ(2, metrics.values["registrar/state_stores"]);
+  EXPECT_EQ(3, metrics.values["registrar/stored_operations"]);
+}
+
+
+// Tests that the registry is not stored when the operations
+// do not change it.
+TEST_F(RegistrarTest, SkipStoreWithoutMutation)
+{
+  Registrar registrar(flags, state);
+  AWAIT_READY(registrar.recover(master));
+
+  AWAIT_TRUE(registrar.apply(Owned<Operation>(new AdmitSlave(slave))));
+
+  // The agent is already admitted and reachable.
+  AWAIT_FALSE(registrar.apply(Owned<Operation>(new AdmitSlave(slave))));
+  AWAIT_TRUE(registrar.apply(Owned<Operation>(new MarkSlaveReachable(slave))));
+
+  // One store for the recovery and one for admitting the agent.
+  JSON::Object metrics = Metrics();
+
+  EXPECT_EQ(2, metrics.values["registrar/state_stores"]);
+  EXPECT_EQ(2, metrics.values["registrar/stored_operations"]);
+}
+
+
+// Tests that the registrar aborts if somebody else stored the registry
+// since it did, even if the operations do not change the registry.
+TEST_F(RegistrarTest, SkipStoreVersionMismatch)
+{
+  Registrar registrar(flags, state);
+  AWAIT_READY(registrar.recover(master));
+
+  AWAIT_TRUE(registrar.apply(Owned<Operation>(new AdmitSlave(slave))));
+
+  // Another writer stores the registry, which changes its version.
+  Future<Variable<Registry>> variable = state->fetch<Registry>("registry");
+  AWAIT_READY(variable);
+
+  Future<Option<Variable<Registry>>> stored = state->store(variable.get());
+  AWAIT_READY(stored);
+  ASSERT_SOME(stored.get());
+
+  // The agent is already reachable, so this does not change the
+  // registry, but the version check fails.
+  AWAIT_FAILED(
+      registrar.apply(Owned<Operation>(new MarkSlaveReachable(slave))));
+
+  // The registrar should now be aborted!
+  AWAIT_FAILED(registrar.apply(Owned<Operation>(new AdmitSlave(slave))));
+}
+
+
 TEST_F(RegistrarTest, MarkReachable)
 {
   Registrar registrar(flags, state);
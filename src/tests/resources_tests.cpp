@@ -1138,6 +1138,57 @@ TEST(ResourcesTest, ScalarSubtraction2)
 }
 
 
+// This test verifies that scalar arithmetic does not combine plain
+// scalar resources with resources that only differ in additional
+// information (e.g., a reservation), including after this information
+// has been modified in place by allocating or flattening the resources.
+TEST(ResourcesTest, ScalarArithmeticWithResourceInfo)
+{
+  Resource cpus = Resources::parse("cpus", "4", "role1").get();
+
+  Resource reserved = createReservedResource(
+      "cpus", "2", "role1", createReservationInfo("principal"));
+
+  Resource revocable = cpus;
+  revocable.mutable_revocable();
+
+  Resources resources = Resources(cpus) + reserved + revocable;
+
+  EXPECT_EQ(3u, resources.size());
+  EXPECT_EQ(10, resources.cpus().get());
+
+  EXPECT_TRUE(resources.contains(cpus));
+  EXPECT_FALSE(Resources(cpus).contains(reserved));
+  EXPECT_FALSE(Resources(revocable).contains(cpus));
+
+  resources -= cpus;
+
+  EXPECT_EQ(2u, resources.size());
+  EXPECT_EQ(6, resources.cpus().get());
+
+  // Flattening drops the reservation, so that the resources
+  // can be combined.
+  Resources flattened = (resources.nonRevocable() + cpus).flatten();
+
+  EXPECT_EQ(1u, flattened.size());
+  EXPECT_EQ(Resources::parse("cpus:6").get(), flattened);
+
+  // Allocated resources can only be combined with unallocated
+  // resources once they are unallocated again.
+  Resources allocated = cpus;
+  allocated.allocate("role1");
+
+  EXPECT_EQ(2u, (allocated + cpus).size());
+  EXPECT_NE(allocated, Resources(cpus));
+
+  allocated.unallocate();
+
+  EXPECT_EQ(1u, (allocated + cpus).size());
+  EXPECT_EQ(8, (allocated + cpus).cpus().get());
+  EXPECT_EQ(allocated, Resources(cpus));
+}
+
+
 TEST(ResourcesTest, RangesEquals)
 {
   Resource ports1 = Resources::parse(
@@ -1413,6 +1464,55 @@ TEST(ResourcesTest, RangesSubtraction6)
 }
 
 
+// This test verifies that ranges arithmetic keeps the ranges of the
+// wrapped protobuf sorted and merged when the ranges get fragmented,
+// and that ranges are not combined with ranges that only differ in
+// additional information (e.g., a reservation).
+TEST(ResourcesTest, RangesFragmentation)
+{
+  Resources total = Resources::parse("ports:[1-1000]").get();
+  Resources available = total;
+
+  // Allocate every other port.
+  for (int port = 1; port <= 1000; port += 2) {
+    available -= Resources::parse(
+        "ports:[" + stringify(port) + "-" + stringify(port) + "]").get();
+  }
+
+  Option<Value::Ranges> ranges = available.get<Value::Ranges>("ports");
+  ASSERT_SOME(ranges);
+  ASSERT_EQ(500, ranges->range_size());
+  EXPECT_EQ(2u, ranges->range(0).begin());
+  EXPECT_EQ(1000u, ranges->range(499).end());
+
+  EXPECT_TRUE(total.contains(available));
+  EXPECT_FALSE(available.contains(total));
+
+  // Return the allocated ports in reverse order.
+  for (int port = 999; port >= 1; port -= 2) {
+    available += Resources::parse(
+        "ports:[" + stringify(port) + "-" + stringify(port) + "]").get();
+  }
+
+  EXPECT_EQ(total, available);
+  EXPECT_SOME_EQ(
+      values::parse("[1-1000]").get().ranges(),
+      available.get<Value::Ranges>("ports"));
+
+  Resource reserved = createReservedResource(
+      "ports", "[1-10]", "role1", createReservationInfo("principal"));
+
+  available += reserved;
+
+  EXPECT_EQ(2u, available.size());
+  EXPECT_FALSE(total.contains(reserved));
+
+  available -= total;
+
+  EXPECT_EQ(Resources(reserved), available);
+}
+
+
 TEST(ResourcesTest, SetEquals)
 {
   Resource disks = Resources::parse("disks", "{sda1}", "*").get();
@@ -3310,6 +3410,266 @@ TEST_P(Resources_Contains_BENCHMARK_Test, Contains)
        << endl;
 }
 
+
+struct AgentResourcesParameter
+{
+  // The total resources of the agent.
+  Resources total;
+
+  // The resources allocated to a single task on the agent, which
+  // are added to and subtracted from the total.
+  Resources allocation;
+
+  // An operation that can be applied to the total resources.
+  Offer::Operation operation;
+
+  size_t totalOperations;
+};
+
+
+class Resources_Agent_BENCHMARK_Test
+  : public ::testing::Test,
+    public ::testing::WithParamInterface<AgentResourcesParameter>
+{
+public:
+  // Returns the agent resources to run the benchmarks against. These
+  // cover the shapes of resources that are expensive to operate on in
+  // the master and the allocator: many dynamic reservations, many
+  // (shared) persistent volumes and fragmented port ranges.
+  static vector<AgentResourcesParameter> parameters()
+  {
+    vector<AgentResourcesParameter> parameters_;
+
+    Resources scalars =
+      Resources::parse("cpus:16;gpus:1;mem:65536;disk:1048576").get();
+
+    // Test an agent with a large amount of dynamic reservations
+    // for different roles, each with a unique label.
+    AgentResourcesParameter reservations;
+    reservations.total = scalars;
+
+    for (int i = 0; i < 500; ++i) {
+      Label label;
+      label.set_key("key_" + stringify(i));
+      label.set_value("value_" + stringify(i));
+
+      Resource::ReservationInfo reservation;
+      reservation.set_principal("principal_" + stringify(i));
+      reservation.mutable_labels()->add_labels()->CopyFrom(label);
+
+      Resources reserved = Resources::parse("cpus:1;mem:128;disk:256").get();
+
+      reservations.total +=
+        reserved.flatten("role_" + stringify(i), reservation).get();
+
+      if (i == 250) {
+        reservations.allocation = Resources::parse("cpus:1;mem:128").get()
+          .flatten("role_" + stringify(i), reservation).get();
+      }
+    }
+
+    Resource::ReservationInfo reservation = createReservationInfo("principal");
+
+    reservations.operation = RESERVE(
+        Resources::parse("cpus:1;mem:128").get()
+          .flatten("role", reservation).get());
+
+    reservations.totalOperations = 1000;
+
+    // Test an agent with a large amount of persistent volumes
+    // created on dynamically reserved disk.
+    Resource pool = createReservedResource(
+        "disk", "1048576", "role", reservation);
+
+    AgentResourcesParameter volumes;
+    volumes.total = Resources::parse("cpus:16;mem:65536").get() + pool;
+
+    for (int i = 0; i < 200; ++i) {
+      volumes.total -= createReservedResource(
+          "disk", "1024", "role", reservation);
+
+      volumes.total += createPersistentVolume(
+          Megabytes(1024),
+          "role",
+          "id" + stringify(i),
+          "path",
+          "principal");
+    }
+
+    volumes.allocation = createPersistentVolume(
+        Megabytes(1024), "role", "id100", "path", "principal");
+
+    volumes.operation = CREATE(createPersistentVolume(
+        Megabytes(1024), "role", "id200", "path", "principal"));
+
+    volumes.totalOperations = 1000;
+
+    // Test an agent with a large amount of shared persistent volumes,
+    // where each task uses one of the volumes.
+    AgentResourcesParameter shared;
+    shared.total = Resources::parse("cpus:16;mem:65536").get() + pool;
+
+    for (int i = 0; i < 200; ++i) {
+      shared.total -= createReservedResource(
+          "disk", "1024", "role", reservation);
+
+      shared.total += createPersistentVolume(
+          Megabytes(1024),
+          "role",
+          "id" + stringify(i),
+          "path",
+          "principal",
+          None(),
+          None(),
+          true);
+    }
+
+    shared.allocation = createPersistentVolume(
+        Megabytes(1024),
+        "role",
+        "id100",
+        "path",
+        "principal",
+        None(),
+        None(),
+        true);
+
+    shared.operation = CREATE(createPersistentVolume(
+        Megabytes(1024),
+        "role",
+        "id200",
+        "path",
+        "principal",
+        None(),
+        None(),
+        true));
+
+    shared.totalOperations = 1000;
+
+    // Test an agent whose ports are fragmented into 8000 ranges by the
+    // ports allocated to its tasks, where each task uses 10 ports.
+    Try<::mesos::Value::Ranges> ranges =
+      fragment(createRange(1, 64000), 8000);
+
+    AgentResourcesParameter ports;
+    ports.total = scalars + createPorts(ranges.get());
+    ports.allocation =
+      Resources::parse("cpus:1;mem:128;ports:[31000-31009]").get();
+
+    ports.operation = RESERVE(
+        Resources::parse("ports:[1-1,3-3,5-5,32000-32999]").get()
+          .flatten("role", reservation).get());
+
+    ports.totalOperations = 1000;
+
+    parameters_.push_back(std::move(reservations));
+    parameters_.push_back(std::move(volumes));
+    parameters_.push_back(std::move(shared));
+    parameters_.push_back(std::move(ports));
+
+    return parameters_;
+  }
+};
+
+
+// The Resources agent benchmark tests are parameterized by the
+// resources of an agent, the resources of a task on the agent and an
+// operation to apply to the agent resources.
+INSTANTIATE_TEST_CASE_P(
+    ResourcesAgent,
+    Resources_Agent_BENCHMARK_Test,
+    ::testing::ValuesIn(Resources_Agent_BENCHMARK_Test::parameters()));
+
+
+TEST_P(Resources_Agent_BENCHMARK_Test, Operations)
+{
+  const Resources& total = GetParam().total;
+  const Resources& allocation = GetParam().allocation;
+  const Offer::Operation& operation = GetParam().operation;
+  size_t totalOperations = GetParam().totalOperations;
+
+  ASSERT_TRUE(total.contains(allocation));
+  ASSERT_SOME(total.apply(operation));
+
+  cout << "Agent resources: " << abbreviate(stringify(total), 50)
+       << " (" << total.size() << " resource objects)" << endl;
+
+  Resources available = total;
+  Stopwatch watch;
+
+  watch.start();
+  for (size_t i = 0; i < totalOperations; i++) {
+    available -= allocation;
+  }
+  watch.stop();
+
+  cout << "Took " << watch.elapsed()
+       << " to perform " << totalOperations << " 'total -= r' operations"
+       << " on " << abbreviate(stringify(allocation), 50) << endl;
+
+  watch.start();
+  for (size_t i = 0; i < totalOperations; i++) {
+    available += allocation;
+  }
+  watch.stop();
+
+  cout << "Took " << watch.elapsed()
+       << " to perform " << totalOperations << " 'total += r' operations"
+       << " on " << abbreviate(stringify(allocation), 50) << endl;
+
+  watch.start();
+  for (size_t i = 0; i < totalOperations; i++) {
+    total.contains(allocation);
+  }
+  watch.stop();
+
+  cout << "Took " << watch.elapsed()
+       << " to perform " << totalOperations << " 'total.contains(r)' operations"
+       << " on " << abbreviate(stringify(allocation), 50) << endl;
+
+  watch.start();
+  for (size_t i = 0; i < totalOperations; i++) {
+    total.reserved();
+  }
+  watch.stop();
+
+  cout << "Took " << watch.elapsed()
+       << " to perform " << totalOperations << " 'total.reserved()' operations"
+       << endl;
+
+  watch.start();
+  for (size_t i = 0; i < totalOperations; i++) {
+    total.persistentVolumes();
+  }
+  watch.stop();
+
+  cout << "Took " << watch.elapsed()
+       << " to perform " << totalOperations
+       << " 'total.persistentVolumes()' operations" << endl;
+
+  watch.start();
+  for (size_t i = 0; i < totalOperations; i++) {
+    total.flatten();
+  }
+  watch.stop();
+
+  cout << "Took " << watch.elapsed()
+       << " to perform " << totalOperations << " 'total.flatten()' operations"
+       << endl;
+
+  watch.start();
+  for (size_t i = 0; i < totalOperations; i++) {
+    total.apply(operation);
+  }
+  watch.stop();
+
+  cout << "Took " << watch.elapsed()
+       << " to perform " << totalOperations
+       << " 'total.apply(operation)' operations on "
+       << Offer::Operation::Type_Name(operation.type()) << " operation"
+       << endl;
+}
+
 } // namespace tests {
 } // namespace internal {
 } // namespace mesos {
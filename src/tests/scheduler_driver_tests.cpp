@@ -182,6 +182,110 @@ TEST_F(MesosSchedulerDriverTest, DropAckIfStopCalledBeforeAbort)
 }
 
 
+// Ensures that the driver holds back offers and status updates for
+// the configured callback batch interval, and then passes them to
+// the scheduler at once.
+TEST_F(MesosSchedulerDriverTest, CallbackBatching)
+{
+  Try<Owned<cluster::Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  MockExecutor exec(DEFAULT_EXECUTOR_ID);
+  TestContainerizer containerizer(&exec);
+
+  Future<SlaveRegisteredMessage> slaveRegisteredMessage =
+    FUTURE_PROTOBUF(SlaveRegisteredMessage(), _, _);
+
+  Owned<MasterDetector> detector = master.get()->createDetector();
+  Try<Owned<cluster::Slave>> slave = StartSlave(detector.get(), &containerizer);
+  ASSERT_SOME(slave);
+
+  AWAIT_READY(slaveRegisteredMessage);
+
+  Clock::pause();
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+      &sched, DEFAULT_FRAMEWORK_INFO, master.get()->pid, DEFAULT_CREDENTIAL);
+
+  EXPECT_CALL(sched, registered(&driver, _, _));
+
+  Future<Nothing> offers;
+  EXPECT_CALL(sched, resourceOffers(&driver, _))
+    .WillOnce(DoAll(LaunchTasks(DEFAULT_EXECUTOR_INFO, 2, 1, 16, "*"),
+                    FutureSatisfy(&offers)))
+    .WillRepeatedly(Return()); // Ignore subsequent offers.
+
+  Future<ResourceOffersMessage> resourceOffersMessage =
+    FUTURE_PROTOBUF(ResourceOffersMessage(), _, _);
+
+  os::setenv("MESOS_CALLBACK_BATCH_INTERVAL", "5secs");
+
+  driver.start();
+
+  os::unsetenv("MESOS_CALLBACK_BATCH_INTERVAL");
+
+  AWAIT_READY(resourceOffersMessage);
+
+  // The offers must be held back until the batch interval elapses.
+  Clock::settle();
+  EXPECT_TRUE(offers.isPending());
+
+  EXPECT_CALL(exec, registered(_, _, _, _));
+
+  EXPECT_CALL(exec, launchTask(_, _))
+    .WillRepeatedly(SendStatusUpdateFromTask(TASK_RUNNING));
+
+  EXPECT_CALL(exec, shutdown(_))
+    .Times(AtMost(1));
+
+  Future<StatusUpdateMessage> statusUpdateMessage1 =
+    FUTURE_PROTOBUF(StatusUpdateMessage(), master.get()->pid, _);
+  Future<StatusUpdateMessage> statusUpdateMessage2 =
+    FUTURE_PROTOBUF(StatusUpdateMessage(), master.get()->pid, _);
+
+  Future<TaskStatus> status1;
+  Future<TaskStatus> status2;
+  EXPECT_CALL(sched, statusUpdate(&driver, _))
+    .WillOnce(FutureArg<1>(&status1))
+    .WillOnce(FutureArg<1>(&status2));
+
+  Clock::advance(Seconds(5));
+
+  AWAIT_READY(offers);
+
+  AWAIT_READY(statusUpdateMessage1);
+  AWAIT_READY(statusUpdateMessage2);
+
+  // Both status updates must be held back until the batch interval
+  // elapses, and then be passed to the scheduler (and acknowledged).
+  Clock::settle();
+  EXPECT_TRUE(status1.isPending());
+  EXPECT_TRUE(status2.isPending());
+
+  Future<mesos::scheduler::Call> acknowledgement = FUTURE_CALL(
+      mesos::scheduler::Call(),
+      mesos::scheduler::Call::ACKNOWLEDGE,
+      _,
+      master.get()->pid);
+
+  Clock::advance(Seconds(5));
+
+  AWAIT_READY(status1);
+  EXPECT_EQ(TASK_RUNNING, status1->state());
+
+  AWAIT_READY(status2);
+  EXPECT_EQ(TASK_RUNNING, status2->state());
+
+  AWAIT_READY(acknowledgement);
+
+  Clock::resume();
+
+  driver.stop();
+  driver.join();
+}
+
+
 // Ensures that when a scheduler enables explicit acknowledgements
 // on the driver, there are no implicit acknowledgements sent, and
 // the call to 'acknowledgeStatusUpdate' sends the ack to the master.
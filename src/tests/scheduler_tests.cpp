@@ -40,6 +40,9 @@
 
 #include <stout/lambda.hpp>
 #include <stout/try.hpp>
+#include <stout/uuid.hpp>
+
+#include "common/protobuf_utils.hpp"
 
 #include "internal/devolve.hpp"
 #include "internal/evolve.hpp"
@@ -57,6 +60,8 @@ using mesos::internal::master::allocator::MesosAllocatorProcess;
 
 using mesos::internal::master::Master;
 
+using mesos::internal::protobuf::createStatusUpdate;
+
 using mesos::internal::slave::Containerizer;
 using mesos::internal::slave::Slave;
 
@@ -527,6 +532,147 @@ TEST_P(SchedulerTest, TaskRunning)
 }
 
 
+// Ensures that the master forwards the acknowledgements of an
+// `ACKNOWLEDGE_BATCH` call to the agent as a single message, and
+// that the agent acknowledges the status updates.
+TEST_P(SchedulerTest, AcknowledgeBatch)
+{
+  Try<Owned<cluster::Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  auto scheduler = std::make_shared<v1::MockHTTPScheduler>();
+  auto executor = std::make_shared<v1::MockHTTPExecutor>();
+
+  ExecutorID executorId = DEFAULT_EXECUTOR_ID;
+  TestContainerizer containerizer(executorId, executor);
+
+  Owned<MasterDetector> detector = master.get()->createDetector();
+  Try<Owned<cluster::Slave>> slave = StartSlave(detector.get(), &containerizer);
+  ASSERT_SOME(slave);
+
+  Future<Nothing> connected;
+  EXPECT_CALL(*scheduler, connected(_))
+    .WillOnce(FutureSatisfy(&connected));
+
+  ContentType contentType = GetParam();
+
+  v1::scheduler::TestMesos mesos(
+      master.get()->pid,
+      contentType,
+      scheduler);
+
+  AWAIT_READY(connected);
+
+  Future<Event::Subscribed> subscribed;
+  EXPECT_CALL(*scheduler, subscribed(_, _))
+    .WillOnce(FutureArg<1>(&subscribed));
+
+  EXPECT_CALL(*scheduler, heartbeat(_))
+    .WillRepeatedly(Return()); // Ignore heartbeats.
+
+  Future<Event::Offers> offers;
+  EXPECT_CALL(*scheduler, offers(_, _))
+    .WillOnce(FutureArg<1>(&offers));
+
+  {
+    Call call;
+    call.set_type(Call::SUBSCRIBE);
+
+    Call::Subscribe* subscribe = call.mutable_subscribe();
+    subscribe->mutable_framework_info()->CopyFrom(v1::DEFAULT_FRAMEWORK_INFO);
+
+    mesos.send(call);
+  }
+
+  AWAIT_READY(subscribed);
+
+  v1::FrameworkID frameworkId(subscribed.get().framework_id());
+
+  AWAIT_READY(offers);
+  EXPECT_NE(0, offers->offers().size());
+
+  EXPECT_CALL(*executor, connected(_))
+    .WillOnce(v1::executor::SendSubscribe(frameworkId, evolve(executorId)));
+
+  EXPECT_CALL(*executor, subscribed(_, _));
+
+  EXPECT_CALL(*executor, launch(_, _))
+    .WillOnce(v1::executor::SendUpdateFromTask(
+        frameworkId, evolve(executorId), v1::TASK_RUNNING));
+
+  EXPECT_CALL(*executor, acknowledged(_, _));
+
+  Future<Event::Update> statusUpdate;
+  EXPECT_CALL(*scheduler, update(_, _))
+    .WillOnce(FutureArg<1>(&statusUpdate));
+
+  v1::TaskInfo taskInfo;
+  taskInfo.set_name("");
+  taskInfo.mutable_task_id()->set_value("1");
+  taskInfo.mutable_agent_id()->CopyFrom(
+      offers->offers(0).agent_id());
+  taskInfo.mutable_resources()->CopyFrom(
+      offers->offers(0).resources());
+  taskInfo.mutable_executor()->CopyFrom(v1::DEFAULT_EXECUTOR_INFO);
+
+  {
+    Call call;
+    call.mutable_framework_id()->CopyFrom(frameworkId);
+    call.set_type(Call::ACCEPT);
+
+    Call::Accept* accept = call.mutable_accept();
+    accept->add_offer_ids()->CopyFrom(offers->offers(0).id());
+
+    v1::Offer::Operation* operation = accept->add_operations();
+    operation->set_type(v1::Offer::Operation::LAUNCH);
+    operation->mutable_launch()->add_task_infos()->CopyFrom(taskInfo);
+
+    mesos.send(call);
+  }
+
+  AWAIT_READY(statusUpdate);
+  EXPECT_EQ(v1::TASK_RUNNING, statusUpdate->status().state());
+
+  Future<StatusUpdateAcknowledgementsMessage> acknowledgements =
+    FUTURE_PROTOBUF(
+        StatusUpdateAcknowledgementsMessage(),
+        master.get()->pid,
+        slave.get()->pid);
+
+  Future<Nothing> _statusUpdateAcknowledgement =
+    FUTURE_DISPATCH(slave.get()->pid, &Slave::_statusUpdateAcknowledgement);
+
+  {
+    Call call;
+    call.mutable_framework_id()->CopyFrom(frameworkId);
+    call.set_type(Call::ACKNOWLEDGE_BATCH);
+
+    Call::Acknowledge* acknowledge =
+      call.mutable_acknowledge_batch()->add_acknowledgements();
+
+    acknowledge->mutable_task_id()->CopyFrom(taskInfo.task_id());
+    acknowledge->mutable_agent_id()->CopyFrom(offers->offers(0).agent_id());
+    acknowledge->set_uuid(statusUpdate->status().uuid());
+
+    mesos.send(call);
+  }
+
+  AWAIT_READY(acknowledgements);
+  ASSERT_EQ(1, acknowledgements->acknowledgements_size());
+  EXPECT_EQ(
+      statusUpdate->status().uuid(),
+      acknowledgements->acknowledgements(0).uuid());
+
+  AWAIT_READY(_statusUpdateAcknowledgement);
+
+  EXPECT_CALL(*executor, shutdown(_))
+    .Times(AtMost(1));
+
+  EXPECT_CALL(*executor, disconnected(_))
+    .Times(AtMost(1));
+}
+
+
 // Ensures that a task group can be successfully launched
 // on the `DEFAULT` executor.
 //
@@ -1547,6 +1693,82 @@ TEST_P(SchedulerTest, Request)
 }
 
 
+// This test verifies that the scheduler library queues up the calls
+// beyond the maximum number of calls in flight, and sends all of them
+// as the responses for the earlier calls arrive.
+TEST_P(SchedulerTest, MaxInflightCalls)
+{
+  Try<Owned<cluster::Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  auto scheduler = std::make_shared<v1::MockHTTPScheduler>();
+
+  Future<Nothing> connected;
+  EXPECT_CALL(*scheduler, connected(_))
+    .WillOnce(FutureSatisfy(&connected));
+
+  ContentType contentType = GetParam();
+
+  // Only allow a single call to be in flight at a time.
+  os::setenv("MESOS_MAX_INFLIGHT_CALLS", "1");
+
+  v1::scheduler::TestMesos mesos(
+      master.get()->pid,
+      contentType,
+      scheduler);
+
+  os::unsetenv("MESOS_MAX_INFLIGHT_CALLS");
+
+  AWAIT_READY(connected);
+
+  Future<Event::Subscribed> subscribed;
+  EXPECT_CALL(*scheduler, subscribed(_, _))
+    .WillOnce(FutureArg<1>(&subscribed));
+
+  EXPECT_CALL(*scheduler, heartbeat(_))
+    .WillRepeatedly(Return()); // Ignore heartbeats.
+
+  {
+    Call call;
+    call.set_type(Call::SUBSCRIBE);
+
+    Call::Subscribe* subscribe = call.mutable_subscribe();
+    subscribe->mutable_framework_info()->CopyFrom(v1::DEFAULT_FRAMEWORK_INFO);
+
+    mesos.send(call);
+  }
+
+  AWAIT_READY(subscribed);
+
+  v1::FrameworkID frameworkId(subscribed->framework_id());
+
+  Future<Nothing> requestResources1 =
+    FUTURE_DISPATCH(_, &MesosAllocatorProcess::requestResources);
+  Future<Nothing> requestResources2 =
+    FUTURE_DISPATCH(_, &MesosAllocatorProcess::requestResources);
+  Future<Nothing> requestResources3 =
+    FUTURE_DISPATCH(_, &MesosAllocatorProcess::requestResources);
+
+  // Send the calls back to back, so that the second and third call
+  // are queued up by the library.
+  for (int i = 0; i < 3; i++) {
+    Call call;
+    call.mutable_framework_id()->CopyFrom(frameworkId);
+    call.set_type(Call::REQUEST);
+
+    // Create a dummy request.
+    Call::Request* request = call.mutable_request();
+    request->add_requests();
+
+    mesos.send(call);
+  }
+
+  AWAIT_READY(requestResources1);
+  AWAIT_READY(requestResources2);
+  AWAIT_READY(requestResources3);
+}
+
+
 // This test verifies that the scheduler is able to force a reconnection with
 // the master.
 TEST_P(SchedulerTest, SchedulerReconnect)
@@ -1938,6 +2160,105 @@ TEST_P(SchedulerSSLTest, RunTaskAndTeardown)
   AWAIT_READY(disconnected);
 }
 
+
+// Evolves `message` by serializing it and parsing the result, which is
+// how `evolve()` converts most types, for comparison with the direct
+// conversions below.
+template <typename T>
+static T reparse(const google::protobuf::Message& message)
+{
+  T t;
+  string data;
+
+  CHECK(message.SerializePartialToString(&data));
+  CHECK(t.ParsePartialFromString(data));
+
+  return t;
+}
+
+
+class Evolve_BENCHMARK_Test : public ::testing::Test {};
+
+
+// Compares evolving the IDs and status updates that are part of
+// nearly every scheduler event against serializing and parsing them.
+TEST_F(Evolve_BENCHMARK_Test, StatusUpdate)
+{
+  const size_t totalOperations = 100000u;
+
+  FrameworkID frameworkId;
+  frameworkId.set_value("framework");
+
+  SlaveID slaveId;
+  slaveId.set_value("agent");
+
+  TaskID taskId;
+  taskId.set_value("task");
+
+  ExecutorID executorId;
+  executorId.set_value("executor");
+
+  StatusUpdateMessage message;
+  message.mutable_update()->CopyFrom(createStatusUpdate(
+      frameworkId,
+      slaveId,
+      taskId,
+      TASK_RUNNING,
+      TaskStatus::SOURCE_EXECUTOR,
+      UUID::random(),
+      "message",
+      None(),
+      executorId));
+
+  EXPECT_EQ(reparse<v1::TaskID>(taskId), evolve(taskId));
+
+  Stopwatch watch;
+
+  watch.start();
+  for (size_t i = 0; i < totalOperations; i++) {
+    reparse<v1::TaskID>(taskId);
+  }
+  watch.stop();
+
+  cout << "Took " << watch.elapsed() << " to serialize and parse "
+       << totalOperations << " task IDs" << endl;
+
+  watch.start();
+  for (size_t i = 0; i < totalOperations; i++) {
+    evolve(taskId);
+  }
+  watch.stop();
+
+  cout << "Took " << watch.elapsed() << " to evolve "
+       << totalOperations << " task IDs" << endl;
+
+  watch.start();
+  for (size_t i = 0; i < totalOperations; i++) {
+    v1::scheduler::Event event;
+    event.set_type(v1::scheduler::Event::UPDATE);
+
+    v1::TaskStatus* status = event.mutable_update()->mutable_status();
+    status->CopyFrom(reparse<v1::TaskStatus>(message.update().status()));
+    status->mutable_agent_id()->CopyFrom(
+        reparse<v1::AgentID>(message.update().slave_id()));
+    status->mutable_executor_id()->CopyFrom(
+        reparse<v1::ExecutorID>(message.update().executor_id()));
+  }
+  watch.stop();
+
+  cout << "Took " << watch.elapsed() << " to serialize and parse "
+       << totalOperations << " status updates" << endl;
+
+  watch.start();
+  for (size_t i = 0; i < totalOperations; i++) {
+    evolve(message);
+  }
+  watch.stop();
+
+  cout << "Took " << watch.elapsed() << " to evolve "
+       << totalOperations << " status updates" << endl;
+}
+
 } // namespace tests {
 } // namespace internal {
 } // namespace mesos {
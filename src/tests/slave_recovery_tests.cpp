@@ -58,6 +58,7 @@
 #include "slave/paths.hpp"
 #include "slave/slave.hpp"
 #include "slave/state.hpp"
+#include "slave/status_update_journal.hpp"
 
 #include "slave/containerizer/containerizer.hpp"
 #include "slave/containerizer/fetcher.hpp"
@@ -88,6 +89,7 @@ using mesos::slave::ContainerTermination;
 
 using mesos::v1::executor::Call;
 
+using std::list;
 using std::map;
 using std::string;
 using std::vector;
@@ -150,6 +152,108 @@ TEST_F(SlaveStateTest, CheckpointRepeatedProtobufMessages)
 }
 
 
+// Ensures that the checkpoints of a batch are all performed, and that
+// only the last checkpoint of each path is written.
+TEST_F(SlaveStateTest, BatchedCheckpoints)
+{
+  slave::state::Checkpointer checkpointer;
+
+  const string file1 = path::join("meta", "file1");
+  const string file2 = path::join("meta", "file2");
+
+  SlaveID slaveId;
+  slaveId.set_value("agent1");
+
+  Future<Nothing> checkpoint1 = checkpointer.checkpoint(file1, "first");
+  Future<Nothing> checkpoint2 = checkpointer.checkpoint(file2, slaveId);
+  Future<Nothing> checkpoint3 = checkpointer.checkpoint(file1, "second");
+
+  AWAIT_READY(checkpoint1);
+  AWAIT_READY(checkpoint2);
+  AWAIT_READY(checkpoint3);
+
+  EXPECT_SOME_EQ("second", os::read(file1));
+
+  const Result<SlaveID> actual = ::protobuf::read<SlaveID>(file2);
+  EXPECT_SOME_EQ(slaveId, actual);
+
+  // The checkpointer does not leave any temporary files behind.
+  Try<list<string>> entries = os::ls("meta");
+  ASSERT_SOME(entries);
+  EXPECT_EQ(2u, entries->size());
+}
+
+
+// Ensures that only the latest run of an executor is recovered in
+// full, while the tasks of its other runs are not read.
+TEST_F(SlaveStateTest, RecoverLatestRun)
+{
+  const string rootDir = os::getcwd();
+
+  SlaveID slaveId;
+  slaveId.set_value("agent1");
+
+  FrameworkID frameworkId;
+  frameworkId.set_value("framework1");
+
+  const ExecutorInfo executorInfo = DEFAULT_EXECUTOR_INFO;
+  const ExecutorID& executorId = executorInfo.executor_id();
+
+  ASSERT_SOME(slave::state::checkpoint(
+      slave::paths::getExecutorInfoPath(
+          rootDir, slaveId, frameworkId, executorId),
+      executorInfo));
+
+  ContainerID previous;
+  previous.set_value(UUID::random().toString());
+
+  ContainerID latest;
+  latest.set_value(UUID::random().toString());
+
+  TaskInfo taskInfo;
+  taskInfo.set_name("test-task");
+  taskInfo.mutable_task_id()->set_value("task1");
+  taskInfo.mutable_slave_id()->CopyFrom(slaveId);
+  taskInfo.mutable_executor()->CopyFrom(executorInfo);
+
+  const Task task =
+    protobuf::createTask(taskInfo, TASK_STAGING, frameworkId);
+
+  // NOTE: This creates the 'latest' symlink to the run, hence we
+  // create the latest run last.
+  foreach (const ContainerID& containerId, vector<ContainerID>({
+               previous, latest})) {
+    slave::paths::createExecutorDirectory(
+        rootDir, slaveId, frameworkId, executorId, containerId);
+
+    ASSERT_SOME(slave::state::checkpoint(
+        slave::paths::getTaskInfoPath(
+            rootDir,
+            slaveId,
+            frameworkId,
+            executorId,
+            containerId,
+            task.task_id()),
+        task));
+  }
+
+  Try<slave::state::ExecutorState> state =
+    slave::state::ExecutorState::recover(
+        rootDir, slaveId, frameworkId, executorId, true);
+
+  ASSERT_SOME(state);
+  ASSERT_SOME_EQ(latest, state->latest);
+  ASSERT_EQ(2u, state->runs.size());
+
+  ASSERT_TRUE(state->runs.contains(latest));
+  EXPECT_EQ(1u, state->runs.at(latest).tasks.size());
+
+  ASSERT_TRUE(state->runs.contains(previous));
+  EXPECT_SOME_EQ(previous, state->runs.at(previous).id);
+  EXPECT_TRUE(state->runs.at(previous).tasks.empty());
+}
+
+
 template <typename T>
 class SlaveRecoveryTest : public ContainerizerTest<T>
 {
@@ -427,6 +531,147 @@ TYPED_TEST(SlaveRecoveryTest, RecoverStatusUpdateManager)
 }
 
 
+// The status updates of a task were checkpointed by an older agent,
+// i.e., to the 'task.updates' file of the task rather than to the
+// status update journal of the agent. When the agent comes back up it
+// resends the unacknowledged update, and migrates the updates to the
+// journal.
+TYPED_TEST(SlaveRecoveryTest, RecoverLegacyStatusUpdates)
+{
+  Try<Owned<cluster::Master>> master = this->StartMaster();
+  ASSERT_SOME(master);
+
+  slave::Flags flags = this->CreateSlaveFlags();
+
+  Fetcher fetcher;
+
+  Try<TypeParam*> _containerizer = TypeParam::create(flags, true, &fetcher);
+  ASSERT_SOME(_containerizer);
+  Owned<slave::Containerizer> containerizer(_containerizer.get());
+
+  Owned<MasterDetector> detector = master.get()->createDetector();
+
+  Try<Owned<cluster::Slave>> slave =
+    this->StartSlave(detector.get(), containerizer.get(), flags);
+  ASSERT_SOME(slave);
+
+  // Enable checkpointing for the framework.
+  FrameworkInfo frameworkInfo = DEFAULT_FRAMEWORK_INFO;
+  frameworkInfo.set_checkpoint(true);
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+      &sched, frameworkInfo, master.get()->pid, DEFAULT_CREDENTIAL);
+
+  Future<FrameworkID> frameworkId;
+  EXPECT_CALL(sched, registered(_, _, _))
+    .WillOnce(FutureArg<1>(&frameworkId));
+
+  Future<vector<Offer>> offers;
+  EXPECT_CALL(sched, resourceOffers(_, _))
+    .WillOnce(FutureArg<1>(&offers))
+    .WillRepeatedly(Return());      // Ignore subsequent offers.
+
+  driver.start();
+
+  AWAIT_READY(frameworkId);
+  AWAIT_READY(offers);
+  EXPECT_NE(0u, offers.get().size());
+
+  TaskInfo task = createTask(offers.get()[0], "sleep 1000");
+
+  // Drop the status update from the slave to the master.
+  Future<StatusUpdateMessage> update =
+    DROP_PROTOBUF(StatusUpdateMessage(), slave.get()->pid, master.get()->pid);
+
+  driver.launchTasks(offers.get()[0].id(), {task});
+
+  // Wait for the status update drop.
+  AWAIT_READY(update);
+
+  slave.get()->terminate();
+
+  // Move the checkpointed status update from the journal to the
+  // 'task.updates' file of the task, as older agents checkpointed it.
+  const string metaDir = paths::getMetaRootDir(flags.work_dir);
+  const SlaveID& slaveId = update->update().slave_id();
+
+  Result<slave::state::State> state = slave::state::recover(metaDir, true);
+
+  ASSERT_SOME(state);
+  ASSERT_SOME(state->slave);
+  ASSERT_TRUE(state->slave->frameworks.contains(frameworkId.get()));
+
+  const slave::state::FrameworkState& frameworkState =
+    state->slave->frameworks.at(frameworkId.get());
+
+  ASSERT_EQ(1u, frameworkState.executors.size());
+
+  const slave::state::ExecutorState& executorState =
+    frameworkState.executors.begin()->second;
+
+  ASSERT_SOME(executorState.latest);
+
+  const string path = paths::getTaskUpdatesPath(
+      metaDir,
+      slaveId,
+      frameworkId.get(),
+      executorState.id,
+      executorState.latest.get(),
+      task.task_id());
+
+  StatusUpdateRecord record;
+  record.set_type(StatusUpdateRecord::UPDATE);
+  record.mutable_update()->CopyFrom(update->update());
+
+  ASSERT_SOME(::protobuf::write(path, record));
+
+  ASSERT_SOME(os::rmdir(paths::getStatusUpdateJournalPath(metaDir, slaveId)));
+
+  Future<TaskStatus> status;
+  EXPECT_CALL(sched, statusUpdate(_, _))
+    .WillOnce(FutureArg<1>(&status))
+    .WillRepeatedly(Return());       // Ignore subsequent updates.
+
+  Future<Nothing> ack =
+    FUTURE_DISPATCH(_, &Slave::_statusUpdateAcknowledgement);
+
+  // Restart the slave (use same flags) with a new containerizer.
+  _containerizer = TypeParam::create(flags, true, &fetcher);
+  ASSERT_SOME(_containerizer);
+  containerizer.reset(_containerizer.get());
+
+  slave = this->StartSlave(detector.get(), containerizer.get(), flags);
+  ASSERT_SOME(slave);
+
+  AWAIT_READY(status);
+  EXPECT_EQ(TASK_RUNNING, status.get().state());
+
+  AWAIT_READY(ack);
+
+  // The update and its acknowledgement are now in the journal.
+  EXPECT_FALSE(os::exists(path));
+
+  Try<hashmap<FrameworkID, hashmap<TaskID, StatusUpdateJournal::Stream>>>
+    streams = StatusUpdateJournal::read(metaDir, slaveId);
+
+  ASSERT_SOME(streams);
+  ASSERT_TRUE(streams->contains(frameworkId.get()));
+  ASSERT_TRUE(streams->at(frameworkId.get()).contains(task.task_id()));
+
+  const StatusUpdateJournal::Stream& stream =
+    streams->at(frameworkId.get()).at(task.task_id());
+
+  ASSERT_EQ(1u, stream.updates.size());
+  EXPECT_EQ(update->update().uuid(), stream.updates[0].uuid());
+  EXPECT_TRUE(stream.acks.contains(
+      UUID::fromBytes(update->update().uuid()).get()));
+
+  driver.stop();
+  driver.join();
+}
+
+
 // The slave is stopped before the first update for a task is received from the
 // HTTP based command executor. When it comes back up with recovery=reconnect,
 // make sure the executor subscribes and the slave properly sends the update.
@@ -3105,7 +3350,7 @@ TYPED_TEST(SlaveRecoveryTest, ReconcileTasksMissingFromSlave)
 {
   TestAllocator<master::allocator::HierarchicalDRFAllocator> allocator;
 
-  EXPECT_CALL(allocator, initialize(_, _, _, _, _));
+  EXPECT_CALL(allocator, initialize(_, _, _, _, _, _));
 
   Try<Owned<cluster::Master>> master = this->StartMaster(&allocator);
   ASSERT_SOME(master);
@@ -760,6 +760,118 @@ TEST_F(SlaveTest, CommandTaskWithKillPolicy)
 }
 
 
+// Tests that with `--agent_managed_command_tasks` the agent runs a
+// command task without a command executor and generates its status
+// updates from the exit status of the task's command.
+TEST_F_TEMP_DISABLED_ON_WINDOWS(SlaveTest, AgentManagedCommandTask)
+{
+  Try<Owned<cluster::Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  slave::Flags flags = CreateSlaveFlags();
+  flags.agent_managed_command_tasks = true;
+
+  Owned<MasterDetector> detector = master.get()->createDetector();
+  Try<Owned<cluster::Slave>> slave = StartSlave(detector.get(), flags);
+  ASSERT_SOME(slave);
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+      &sched, DEFAULT_FRAMEWORK_INFO, master.get()->pid, DEFAULT_CREDENTIAL);
+
+  EXPECT_CALL(sched, registered(&driver, _, _));
+
+  Future<vector<Offer>> offers;
+  EXPECT_CALL(sched, resourceOffers(&driver, _))
+    .WillOnce(FutureArg<1>(&offers))
+    .WillRepeatedly(Return()); // Ignore subsequent offers.
+
+  driver.start();
+
+  AWAIT_READY(offers);
+  EXPECT_NE(0u, offers->size());
+
+  // The task's command must not be wrapped by a command executor,
+  // which would register with the agent.
+  EXPECT_NO_FUTURE_PROTOBUFS(RegisterExecutorMessage(), _, _);
+
+  TaskInfo task = createTask(offers.get()[0], "exit 0");
+
+  Future<TaskStatus> statusRunning;
+  Future<TaskStatus> statusFinished;
+  EXPECT_CALL(sched, statusUpdate(&driver, _))
+    .WillOnce(FutureArg<1>(&statusRunning))
+    .WillOnce(FutureArg<1>(&statusFinished));
+
+  driver.launchTasks(offers.get()[0].id(), {task});
+
+  AWAIT_READY(statusRunning);
+  EXPECT_EQ(TASK_RUNNING, statusRunning->state());
+  EXPECT_EQ(TaskStatus::SOURCE_SLAVE, statusRunning->source());
+
+  AWAIT_READY(statusFinished);
+  EXPECT_EQ(TASK_FINISHED, statusFinished->state());
+  EXPECT_EQ(TaskStatus::SOURCE_SLAVE, statusFinished->source());
+
+  driver.stop();
+  driver.join();
+}
+
+
+// Tests that killing an agent-managed command task destroys its
+// container and results in TASK_KILLED.
+TEST_F_TEMP_DISABLED_ON_WINDOWS(SlaveTest, KillAgentManagedCommandTask)
+{
+  Try<Owned<cluster::Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  slave::Flags flags = CreateSlaveFlags();
+  flags.agent_managed_command_tasks = true;
+
+  Owned<MasterDetector> detector = master.get()->createDetector();
+  Try<Owned<cluster::Slave>> slave = StartSlave(detector.get(), flags);
+  ASSERT_SOME(slave);
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+      &sched, DEFAULT_FRAMEWORK_INFO, master.get()->pid, DEFAULT_CREDENTIAL);
+
+  EXPECT_CALL(sched, registered(&driver, _, _));
+
+  Future<vector<Offer>> offers;
+  EXPECT_CALL(sched, resourceOffers(&driver, _))
+    .WillOnce(FutureArg<1>(&offers))
+    .WillRepeatedly(Return()); // Ignore subsequent offers.
+
+  driver.start();
+
+  AWAIT_READY(offers);
+  EXPECT_NE(0u, offers->size());
+
+  TaskInfo task = createTask(offers.get()[0], SLEEP_COMMAND(1000));
+
+  Future<TaskStatus> statusRunning;
+  Future<TaskStatus> statusKilled;
+  EXPECT_CALL(sched, statusUpdate(&driver, _))
+    .WillOnce(FutureArg<1>(&statusRunning))
+    .WillOnce(FutureArg<1>(&statusKilled));
+
+  driver.launchTasks(offers.get()[0].id(), {task});
+
+  AWAIT_READY(statusRunning);
+  EXPECT_EQ(TASK_RUNNING, statusRunning->state());
+
+  driver.killTask(task.task_id());
+
+  AWAIT_READY(statusKilled);
+  EXPECT_EQ(TASK_KILLED, statusKilled->state());
+  EXPECT_EQ(TaskStatus::SOURCE_SLAVE, statusKilled->source());
+
+  driver.stop();
+  driver.join();
+}
+
+
 // Don't let args from the CommandInfo struct bleed over into
 // mesos-executor forking. For more details of this see MESOS-1873.
 TEST_F_TEMP_DISABLED_ON_WINDOWS(SlaveTest, GetExecutorInfo)
@@ -1302,6 +1414,135 @@ TEST_F(SlaveTest, IgnoreNonLeaderStatusUpdateAcknowledgement)
 }
 
 
+// This test ensures that the agent sends the status updates that are
+// ready to be forwarded at the same time in a single message, and
+// that they are delivered to the scheduler.
+TEST_F(SlaveTest, BatchStatusUpdates)
+{
+  Try<Owned<cluster::Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  MockExecutor exec(DEFAULT_EXECUTOR_ID);
+  TestContainerizer containerizer(&exec);
+
+  slave::Flags flags = CreateSlaveFlags();
+  flags.batch_status_updates = true;
+
+  Owned<MasterDetector> detector = master.get()->createDetector();
+  Try<Owned<cluster::Slave>> slave =
+    StartSlave(detector.get(), &containerizer, flags);
+  ASSERT_SOME(slave);
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+      &sched, DEFAULT_FRAMEWORK_INFO, master.get()->pid, DEFAULT_CREDENTIAL);
+
+  EXPECT_CALL(sched, registered(&driver, _, _));
+
+  Future<vector<Offer>> offers;
+  EXPECT_CALL(sched, resourceOffers(&driver, _))
+    .WillOnce(FutureArg<1>(&offers))
+    .WillRepeatedly(Return()); // Ignore subsequent offers.
+
+  driver.start();
+
+  AWAIT_READY(offers);
+  EXPECT_NE(0u, offers.get().size());
+
+  Resources resources = Resources::parse("cpus:0.1;mem:32").get();
+
+  TaskInfo task1;
+  task1.set_name("");
+  task1.mutable_task_id()->set_value("1");
+  task1.mutable_slave_id()->MergeFrom(offers.get()[0].slave_id());
+  task1.mutable_resources()->MergeFrom(resources);
+  task1.mutable_executor()->MergeFrom(DEFAULT_EXECUTOR_INFO);
+
+  TaskInfo task2 = task1;
+  task2.mutable_task_id()->set_value("2");
+
+  // Pause the clock so that the status update manager does not retry
+  // the updates.
+  Clock::pause();
+
+  EXPECT_CALL(exec, registered(_, _, _, _));
+
+  EXPECT_CALL(exec, launchTask(_, _))
+    .WillRepeatedly(SendStatusUpdateFromTask(TASK_RUNNING));
+
+  // The status update manager forwards each update to the agent as
+  // soon as it has handled it, so the agent usually sends the first
+  // update on its own. To deterministically have both updates ready
+  // to be forwarded at the same time, we drop the forwards of the
+  // status update manager and forward the updates sent by the
+  // executor from within the agent instead.
+  Future<StatusUpdateMessage> update1 =
+    FUTURE_PROTOBUF(StatusUpdateMessage(), _, slave.get()->pid);
+  Future<StatusUpdateMessage> update2 =
+    FUTURE_PROTOBUF(StatusUpdateMessage(), _, slave.get()->pid);
+
+  Future<Nothing> forward1 = DROP_DISPATCH(_, &Slave::forward);
+  Future<Nothing> forward2 = DROP_DISPATCH(_, &Slave::forward);
+
+  Future<TaskStatus> status1;
+  Future<TaskStatus> status2;
+  EXPECT_CALL(sched, statusUpdate(&driver, _))
+    .WillOnce(FutureArg<1>(&status1))
+    .WillOnce(FutureArg<1>(&status2));
+
+  driver.launchTasks(offers.get()[0].id(), {task1, task2});
+
+  AWAIT_READY(update1);
+  AWAIT_READY(update2);
+
+  AWAIT_READY(forward1);
+  AWAIT_READY(forward2);
+
+  // Both updates must be sent to the master in a single message.
+  Future<StatusUpdatesMessage> updates =
+    FUTURE_PROTOBUF(StatusUpdatesMessage(), slave.get()->pid, _);
+
+  EXPECT_NO_FUTURE_PROTOBUFS(
+      StatusUpdateMessage(), slave.get()->pid, master.get()->pid);
+
+  // Both forwards are dispatched while the agent is still running
+  // this function, hence they are queued up at the agent together.
+  const PID<Slave> pid = slave.get()->pid;
+  const StatusUpdate u1 = update1->update();
+  const StatusUpdate u2 = update2->update();
+
+  process::dispatch(pid, [=]() {
+    process::dispatch(pid, &Slave::forward, u1);
+    process::dispatch(pid, &Slave::forward, u2);
+  });
+
+  AWAIT_READY(updates);
+  ASSERT_EQ(2, updates->updates_size());
+
+  EXPECT_NE(updates->updates(0).status().task_id().value(),
+            updates->updates(1).status().task_id().value());
+
+  AWAIT_READY(status1);
+  EXPECT_EQ(TASK_RUNNING, status1.get().state());
+
+  AWAIT_READY(status2);
+  EXPECT_EQ(TASK_RUNNING, status2.get().state());
+
+  EXPECT_NE(status1.get().task_id().value(),
+            status2.get().task_id().value());
+
+  // Wait for the acknowledgements of the updates before stopping.
+  Clock::settle();
+  Clock::resume();
+
+  EXPECT_CALL(exec, shutdown(_))
+    .Times(AtMost(1));
+
+  driver.stop();
+  driver.join();
+}
+
+
 TEST_F(SlaveTest, MetricsInMetricsEndpoint)
 {
   Try<Owned<cluster::Master>> master = StartMaster();
@@ -1641,6 +1882,91 @@ TEST_F(SlaveTest, StateEndpoint)
 }
 
 
+// This test verifies that the state endpoint returns an `ETag` which
+// changes when the state changes, and that a request carrying the
+// current `ETag` in `If-None-Match` gets a 304 without a body.
+TEST_F(SlaveTest, StateEndpointETag)
+{
+  Try<Owned<cluster::Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  Future<SlaveRegisteredMessage> slaveRegisteredMessage =
+    FUTURE_PROTOBUF(SlaveRegisteredMessage(), _, _);
+
+  Owned<MasterDetector> detector = master.get()->createDetector();
+  Try<Owned<cluster::Slave>> slave = StartSlave(detector.get());
+  ASSERT_SOME(slave);
+
+  AWAIT_READY(slaveRegisteredMessage);
+
+  Future<Response> response = process::http::get(
+      slave.get()->pid,
+      "state",
+      None(),
+      createBasicAuthHeaders(DEFAULT_CREDENTIAL));
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+  ASSERT_TRUE(response->headers.contains("ETag"));
+
+  const string etag = response->headers.at("ETag");
+
+  process::http::Headers headers = createBasicAuthHeaders(DEFAULT_CREDENTIAL);
+  headers["If-None-Match"] = etag;
+
+  response = process::http::get(slave.get()->pid, "state", None(), headers);
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(
+      process::http::Status::string(process::http::Status::NOT_MODIFIED),
+      response);
+  EXPECT_TRUE(response->body.empty());
+
+  // Launching a task changes the state.
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+      &sched, DEFAULT_FRAMEWORK_INFO, master.get()->pid, DEFAULT_CREDENTIAL);
+
+  EXPECT_CALL(sched, registered(&driver, _, _));
+
+  Future<vector<Offer>> offers;
+  EXPECT_CALL(sched, resourceOffers(&driver, _))
+    .WillOnce(FutureArg<1>(&offers))
+    .WillRepeatedly(Return()); // Ignore subsequent offers.
+
+  driver.start();
+
+  AWAIT_READY(offers);
+  ASSERT_FALSE(offers->empty());
+
+  Future<TaskStatus> status;
+  EXPECT_CALL(sched, statusUpdate(&driver, _))
+    .WillOnce(FutureArg<1>(&status))
+    .WillRepeatedly(Return()); // Ignore subsequent updates.
+
+  TaskInfo task = createTask(offers.get()[0], SLEEP_COMMAND(1000));
+
+  driver.launchTasks(offers.get()[0].id(), {task});
+
+  AWAIT_READY(status);
+  EXPECT_EQ(TASK_RUNNING, status->state());
+
+  response = process::http::get(slave.get()->pid, "state", None(), headers);
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+  ASSERT_TRUE(response->headers.contains("ETag"));
+  EXPECT_NE(etag, response->headers.at("ETag"));
+
+  Try<JSON::Object> parse = JSON::parse<JSON::Object>(response->body);
+  ASSERT_SOME(parse);
+
+  Result<JSON::Array> frameworks = parse->find<JSON::Array>("frameworks");
+  ASSERT_SOME(frameworks);
+  EXPECT_EQ(1u, frameworks->values.size());
+
+  driver.stop();
+  driver.join();
+}
+
+
 // This test checks that when a slave is in RECOVERING state it responds
 // to HTTP requests for "/state" endpoint with ServiceUnavailable.
 TEST_F_TEMP_DISABLED_ON_WINDOWS(
@@ -2244,6 +2570,306 @@ TEST_F(SlaveTest, ContainersEndpoint)
 }
 
 
+// This test verifies that the slave samples the resource usage of the
+// containers every '--container_usage_interval', and that the
+// '/containers' endpoint returns the retained samples if asked to.
+TEST_F(SlaveTest, ContainersEndpointHistory)
+{
+  Try<Owned<cluster::Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  MockExecutor exec(DEFAULT_EXECUTOR_ID);
+  TestContainerizer containerizer(&exec);
+  StandaloneMasterDetector detector(master.get()->pid);
+
+  slave::Flags flags = CreateSlaveFlags();
+  flags.container_usage_interval = Seconds(10);
+  flags.container_usage_history = 2;
+
+  Try<Owned<cluster::Slave>> slave =
+    StartSlave(&detector, &containerizer, flags);
+  ASSERT_SOME(slave);
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+      &sched, DEFAULT_FRAMEWORK_INFO, master.get()->pid, DEFAULT_CREDENTIAL);
+
+  EXPECT_CALL(sched, registered(_, _, _));
+  EXPECT_CALL(exec, registered(_, _, _, _));
+
+  Future<vector<Offer>> offers;
+
+  EXPECT_CALL(sched, resourceOffers(&driver, _))
+    .WillOnce(FutureArg<1>(&offers))
+    .WillRepeatedly(Return()); // Ignore subsequent offers.
+
+  driver.start();
+
+  AWAIT_READY(offers);
+  EXPECT_NE(0u, offers.get().size());
+
+  TaskInfo task = createTask(offers.get()[0], SLEEP_COMMAND(1000), exec.id);
+
+  EXPECT_CALL(exec, launchTask(_, _))
+    .WillOnce(SendStatusUpdateFromTask(TASK_RUNNING));
+
+  Future<TaskStatus> status;
+  EXPECT_CALL(sched, statusUpdate(&driver, _))
+    .WillOnce(FutureArg<1>(&status));
+
+  driver.launchTasks(offers.get()[0].id(), {task});
+
+  AWAIT_READY(status);
+  EXPECT_EQ(TASK_RUNNING, status.get().state());
+
+  ResourceStatistics statistics1;
+  statistics1.set_mem_limit_bytes(1024);
+
+  ResourceStatistics statistics2;
+  statistics2.set_mem_limit_bytes(2048);
+
+  ResourceStatistics statistics3;
+  statistics3.set_mem_limit_bytes(4096);
+
+  // The endpoint must be served from the samples, hence the container
+  // is expected to be sampled exactly three times.
+  EXPECT_CALL(containerizer, usage(_))
+    .WillOnce(Return(statistics1))
+    .WillOnce(Return(statistics2))
+    .WillOnce(Return(statistics3));
+
+  EXPECT_CALL(containerizer, status(_))
+    .WillOnce(Return(ContainerStatus()));
+
+  Clock::pause();
+
+  // Only the last two samples are retained.
+  for (int i = 0; i < 3; i++) {
+    Clock::advance(flags.container_usage_interval);
+    Clock::settle();
+  }
+
+  Future<Response> response = process::http::get(
+      slave.get()->pid,
+      "containers",
+      "history=true",
+      createBasicAuthHeaders(DEFAULT_CREDENTIAL));
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+
+  Try<JSON::Value> value = JSON::parse(response.get().body);
+  ASSERT_SOME(value);
+
+  Try<JSON::Value> expected = JSON::parse(
+      "[{"
+          "\"executor_id\":\"default\","
+          "\"statistics\":{\"mem_limit_bytes\":4096},"
+          "\"statistics_history\":["
+              "{\"mem_limit_bytes\":2048},"
+              "{\"mem_limit_bytes\":4096}"
+          "]"
+      "}]");
+
+  ASSERT_SOME(expected);
+  EXPECT_TRUE(value.get().contains(expected.get()));
+
+  Clock::resume();
+
+  EXPECT_CALL(exec, shutdown(_))
+    .Times(AtMost(1));
+
+  driver.stop();
+  driver.join();
+}
+
+
+// This test verifies that the '/containers' endpoint reports the
+// trace of the launch of the executor if requested.
+TEST_F(SlaveTest, ContainersEndpointTrace)
+{
+  Try<Owned<cluster::Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  MockExecutor exec(DEFAULT_EXECUTOR_ID);
+  TestContainerizer containerizer(&exec);
+  StandaloneMasterDetector detector(master.get()->pid);
+
+  Try<Owned<cluster::Slave>> slave = StartSlave(&detector, &containerizer);
+  ASSERT_SOME(slave);
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+      &sched, DEFAULT_FRAMEWORK_INFO, master.get()->pid, DEFAULT_CREDENTIAL);
+
+  EXPECT_CALL(sched, registered(_, _, _));
+  EXPECT_CALL(exec, registered(_, _, _, _));
+
+  Future<vector<Offer>> offers;
+
+  EXPECT_CALL(sched, resourceOffers(&driver, _))
+    .WillOnce(FutureArg<1>(&offers))
+    .WillRepeatedly(Return()); // Ignore subsequent offers.
+
+  driver.start();
+
+  AWAIT_READY(offers);
+  EXPECT_NE(0u, offers.get().size());
+
+  TaskInfo task = createTask(offers.get()[0], SLEEP_COMMAND(1000), exec.id);
+
+  EXPECT_CALL(exec, launchTask(_, _))
+    .WillOnce(SendStatusUpdateFromTask(TASK_RUNNING));
+
+  Future<TaskStatus> status;
+  EXPECT_CALL(sched, statusUpdate(&driver, _))
+    .WillOnce(FutureArg<1>(&status));
+
+  driver.launchTasks(offers.get()[0].id(), {task});
+
+  AWAIT_READY(status);
+  EXPECT_EQ(TASK_RUNNING, status.get().state());
+
+  EXPECT_CALL(containerizer, usage(_))
+    .WillOnce(Return(ResourceStatistics()));
+
+  EXPECT_CALL(containerizer, status(_))
+    .WillOnce(Return(ContainerStatus()));
+
+  Future<Response> response = process::http::get(
+      slave.get()->pid,
+      "containers",
+      "trace=true",
+      createBasicAuthHeaders(DEFAULT_CREDENTIAL));
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+
+  Try<JSON::Array> value = JSON::parse<JSON::Array>(response.get().body);
+  ASSERT_SOME(value);
+  ASSERT_EQ(1u, value->values.size());
+
+  Result<JSON::Array> trace =
+    value->values[0].as<JSON::Object>().find<JSON::Array>("trace");
+
+  ASSERT_SOME(trace);
+  ASSERT_EQ(3u, trace->values.size());
+
+  const vector<string> names = {"launch", "registration", "task_running"};
+
+  for (size_t i = 0; i < names.size(); i++) {
+    const JSON::Object& span = trace->values[i].as<JSON::Object>();
+
+    EXPECT_SOME_EQ(names[i], span.find<JSON::String>("name"));
+
+    Result<JSON::Number> start = span.find<JSON::Number>("start");
+    Result<JSON::Number> end = span.find<JSON::Number>("end");
+
+    ASSERT_SOME(start);
+    ASSERT_SOME(end);
+    EXPECT_LE(start->as<double>(), end->as<double>());
+  }
+
+  EXPECT_CALL(exec, shutdown(_))
+    .Times(AtMost(1));
+
+  driver.stop();
+  driver.join();
+}
+
+
+// This test verifies that when streaming the '/containers' endpoint,
+// a container whose resource statistics are not available in time is
+// returned without them rather than holding up the response.
+TEST_F(SlaveTest, ContainersEndpointStream)
+{
+  Try<Owned<cluster::Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  MockExecutor exec(DEFAULT_EXECUTOR_ID);
+  TestContainerizer containerizer(&exec);
+  StandaloneMasterDetector detector(master.get()->pid);
+
+  Try<Owned<cluster::Slave>> slave = StartSlave(&detector, &containerizer);
+  ASSERT_SOME(slave);
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+      &sched, DEFAULT_FRAMEWORK_INFO, master.get()->pid, DEFAULT_CREDENTIAL);
+
+  EXPECT_CALL(sched, registered(_, _, _));
+  EXPECT_CALL(exec, registered(_, _, _, _));
+
+  Future<vector<Offer>> offers;
+
+  EXPECT_CALL(sched, resourceOffers(&driver, _))
+    .WillOnce(FutureArg<1>(&offers))
+    .WillRepeatedly(Return()); // Ignore subsequent offers.
+
+  driver.start();
+
+  AWAIT_READY(offers);
+  EXPECT_NE(0u, offers.get().size());
+
+  TaskInfo task = createTask(offers.get()[0], SLEEP_COMMAND(1000), exec.id);
+
+  EXPECT_CALL(exec, launchTask(_, _))
+    .WillOnce(SendStatusUpdateFromTask(TASK_RUNNING));
+
+  Future<TaskStatus> status;
+  EXPECT_CALL(sched, statusUpdate(&driver, _))
+    .WillOnce(FutureArg<1>(&status));
+
+  driver.launchTasks(offers.get()[0].id(), {task});
+
+  AWAIT_READY(status);
+  EXPECT_EQ(TASK_RUNNING, status.get().state());
+
+  // The resource statistics never become available.
+  EXPECT_CALL(containerizer, usage(_))
+    .WillOnce(Return(Future<ResourceStatistics>()));
+
+  ContainerStatus containerStatus;
+  containerStatus.add_network_infos()->add_ip_addresses()->set_ip_address(
+      "192.168.1.20");
+
+  EXPECT_CALL(containerizer, status(_))
+    .WillOnce(Return(containerStatus));
+
+  Future<Response> response = process::http::get(
+      slave.get()->pid,
+      "containers",
+      "stream=true&timeout=10ms",
+      createBasicAuthHeaders(DEFAULT_CREDENTIAL));
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+  AWAIT_EXPECT_RESPONSE_HEADER_EQ(APPLICATION_JSON, "Content-Type", response);
+
+  Try<JSON::Array> value = JSON::parse<JSON::Array>(response.get().body);
+  ASSERT_SOME(value);
+  ASSERT_EQ(1u, value->values.size());
+
+  Try<JSON::Value> expected = JSON::parse(
+      "{"
+          "\"executor_id\":\"default\","
+          "\"status\":{"
+              "\"network_infos\":[{"
+                  "\"ip_addresses\":[{\"ip_address\":\"192.168.1.20\"}]"
+              "}]"
+          "}"
+      "}");
+
+  ASSERT_SOME(expected);
+  EXPECT_TRUE(value->values.front().contains(expected.get()));
+  EXPECT_FALSE(value->values.front().as<JSON::Object>()
+                 .values.count("statistics"));
+
+  EXPECT_CALL(exec, shutdown(_))
+    .Times(AtMost(1));
+
+  driver.stop();
+  driver.join();
+}
+
+
 // This test ensures that when a slave is shutting down, it will not
 // try to re-register with the master.
 TEST_F(SlaveTest, DISABLED_TerminatingSlaveDoesNotReregister)
@@ -17,6 +17,7 @@
 #include <stdarg.h>
 #include <stdint.h>
 
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -27,12 +28,20 @@
 
 #include <stout/gtest.hpp>
 
+#include "master/allocator/mesos/hierarchical.hpp"
+
+#include "master/allocator/sorter/drf/hierarchical.hpp"
 #include "master/allocator/sorter/drf/sorter.hpp"
 
 #include "tests/mesos.hpp"
 #include "tests/resources_utils.hpp"
 
 using mesos::internal::master::allocator::DRFSorter;
+using mesos::internal::master::allocator::HierarchicalDRFAllocatorProcess;
+using mesos::internal::master::allocator::HierarchicalDRFSorter;
+using mesos::internal::master::allocator::Sorter;
+
+using process::Owned;
 
 using ::testing::WithParamInterface;
 
@@ -310,6 +319,14 @@ TEST(SorterTest, MultipleSlaves)
   EXPECT_EQ(2u, sorter.allocation("framework").size());
   EXPECT_EQ(slaveResources, sorter.allocation("framework", slaveA));
   EXPECT_EQ(slaveResources, sorter.allocation("framework", slaveB));
+
+  // The allocation by agent reflects changes made after it was
+  // last returned.
+  sorter.unallocated("framework", slaveB, slaveResources);
+
+  hashmap<SlaveID, Resources> allocation = sorter.allocation("framework");
+  ASSERT_EQ(1u, allocation.size());
+  EXPECT_EQ(slaveResources, allocation.at(slaveA));
 }
 
 
@@ -444,6 +461,64 @@ TEST(SorterTest, MultipleSlavesUpdateTotal)
 }
 
 
+// This test verifies that when the total of a single resource kind
+// changes, the clients holding that resource kind are re-sorted while
+// clients that no longer hold it keep a zero share.
+TEST(SorterTest, UpdateTotalSingleResourceKind)
+{
+  DRFSorter sorter;
+
+  SlaveID slaveA;
+  slaveA.set_value("agentA");
+
+  SlaveID slaveB;
+  slaveB.set_value("agentB");
+
+  sorter.add("a");
+  sorter.add("b");
+  sorter.add("c");
+
+  sorter.add(slaveA, Resources::parse("cpus:100;mem:100").get());
+
+  // Dominant share of "a" is 0.1 (cpus).
+  sorter.allocated("a", slaveA, Resources::parse("cpus:10").get());
+
+  // Dominant share of "b" is 0.2 (mem).
+  sorter.allocated("b", slaveA, Resources::parse("mem:20").get());
+
+  // Dominant share of "c" is 0.3 (mem), until it is unallocated.
+  sorter.allocated("c", slaveA, Resources::parse("mem:30").get());
+
+  EXPECT_EQ(vector<string>({"a", "b", "c"}), sorter.sort());
+
+  sorter.unallocated("c", slaveA, Resources::parse("mem:30").get());
+
+  EXPECT_EQ(vector<string>({"c", "a", "b"}), sorter.sort());
+
+  // Adding memory only affects the share of "b", which is now 0.05
+  // (mem). The share of "c" stays at zero.
+  sorter.add(slaveB, Resources::parse("mem:300").get());
+
+  EXPECT_EQ(vector<string>({"c", "b", "a"}), sorter.sort());
+
+  // Removing the memory again restores the previous order.
+  sorter.remove(slaveB, Resources::parse("mem:300").get());
+
+  EXPECT_EQ(vector<string>({"c", "a", "b"}), sorter.sort());
+
+  // A deactivated client is re-sorted with an up to date share
+  // once it is activated again.
+  sorter.deactivate("b");
+  sorter.add(slaveB, Resources::parse("mem:300").get());
+
+  EXPECT_EQ(vector<string>({"c", "a"}), sorter.sort());
+
+  sorter.activate("b");
+
+  EXPECT_EQ(vector<string>({"c", "b", "a"}), sorter.sort());
+}
+
+
 // This test verifies that revocable resources are properly accounted
 // for in the DRF sorter.
 TEST(SorterTest, RevocableResources)
@@ -754,6 +829,258 @@ TEST(SorterTest, RemoveSharedResources)
 }
 
 
+// This test verifies that the hierarchical sorter sorts clients
+// without nesting in the same order as the flat sorter.
+TEST(SorterTest, HierarchicalDRFSorterFlat)
+{
+  DRFSorter flat;
+  HierarchicalDRFSorter hierarchical;
+
+  SlaveID slaveId;
+  slaveId.set_value("agentId");
+
+  Resources totalResources = Resources::parse("cpus:100;mem:100").get();
+  flat.add(slaveId, totalResources);
+  hierarchical.add(slaveId, totalResources);
+
+  vector<string> clients = {"a", "b", "c", "d"};
+  vector<string> allocations =
+    {"cpus:5;mem:5", "cpus:6;mem:6", "cpus:1;mem:1", "cpus:3;mem:1"};
+
+  for (size_t i = 0; i < clients.size(); i++) {
+    Resources resources = Resources::parse(allocations[i]).get();
+
+    flat.add(clients[i]);
+    flat.allocated(clients[i], slaveId, resources);
+
+    hierarchical.add(clients[i]);
+    hierarchical.allocated(clients[i], slaveId, resources);
+  }
+
+  // shares: a = .05, b = .06, c = .01, d = .03
+  EXPECT_EQ(vector<string>({"c", "d", "a", "b"}), hierarchical.sort());
+  EXPECT_EQ(flat.sort(), hierarchical.sort());
+
+  Resources bUnallocated = Resources::parse("cpus:4;mem:4").get();
+  flat.unallocated("b", slaveId, bUnallocated);
+  hierarchical.unallocated("b", slaveId, bUnallocated);
+
+  flat.update("d", 2);
+  hierarchical.update("d", 2);
+
+  // shares: a = .05, b = .02, c = .01, d = .015
+  EXPECT_EQ(flat.sort(), hierarchical.sort());
+
+  Resources removedResources = Resources::parse("cpus:50;mem:0").get();
+  flat.remove(slaveId, removedResources);
+  hierarchical.remove(slaveId, removedResources);
+
+  flat.deactivate("c");
+  hierarchical.deactivate("c");
+
+  EXPECT_EQ(flat.sort(), hierarchical.sort());
+
+  EXPECT_EQ(4, hierarchical.count());
+  EXPECT_EQ(
+      flat.allocationScalarQuantities(),
+      hierarchical.allocationScalarQuantities());
+}
+
+
+// This test verifies that the hierarchical sorter sorts nested
+// clients by the allocations of their subtrees first.
+TEST(SorterTest, HierarchicalDRFSorterNested)
+{
+  HierarchicalDRFSorter sorter;
+
+  SlaveID slaveId;
+  slaveId.set_value("agentId");
+
+  sorter.add(slaveId, Resources::parse("cpus:100;mem:100").get());
+
+  sorter.add("a/x");
+  sorter.allocated("a/x", slaveId, Resources::parse("cpus:10;mem:10").get());
+
+  sorter.add("a/y");
+  sorter.allocated("a/y", slaveId, Resources::parse("cpus:5;mem:5").get());
+
+  sorter.add("b");
+  sorter.allocated("b", slaveId, Resources::parse("cpus:12;mem:12").get());
+
+  // shares: a = .15 (a/x = .10, a/y = .05), b = .12
+  EXPECT_EQ(vector<string>({"b", "a/y", "a/x"}), sorter.sort());
+
+  // "a" is not a client, only the parent of clients.
+  EXPECT_FALSE(sorter.contains("a"));
+  EXPECT_EQ(3, sorter.count());
+
+  Resources aResources = Resources::parse("cpus:1;mem:1").get();
+  sorter.add("a");
+  sorter.allocated("a", slaveId, aResources);
+
+  sorter.allocated("b", slaveId, Resources::parse("cpus:10;mem:10").get());
+
+  // shares: a = .16 (a = .01, a/x = .10, a/y = .05), b = .22
+  EXPECT_EQ(vector<string>({"a", "a/y", "a/x", "b"}), sorter.sort());
+
+  // The allocation of a client does not include its subtree.
+  EXPECT_EQ(aResources, sorter.allocation("a", slaveId));
+
+  // An inactive client with nested clients is skipped, but its
+  // subtree is still sorted.
+  sorter.deactivate("a");
+  EXPECT_EQ(vector<string>({"a/y", "a/x", "b"}), sorter.sort());
+
+  sorter.remove("a/x");
+  EXPECT_EQ(vector<string>({"a/y", "b"}), sorter.sort());
+
+  // Once "a" has no more nested clients it is sorted as a leaf again.
+  sorter.remove("a/y");
+  EXPECT_EQ(vector<string>({"b"}), sorter.sort());
+
+  sorter.activate("a");
+  EXPECT_EQ(vector<string>({"a", "b"}), sorter.sort());
+
+  EXPECT_EQ(aResources, sorter.allocation("a", slaveId));
+  EXPECT_FALSE(sorter.contains("a/y"));
+  EXPECT_EQ(2, sorter.count());
+}
+
+
+// Verifies that the allocations are kept per agent while agents come
+// and go, in which case the sorters of the nodes of the hierarchical
+// sorter reuse the (shared) handles of the removed agents.
+TEST(SorterTest, HierarchicalDRFSorterAgentChurn)
+{
+  HierarchicalDRFSorter sorter;
+
+  SlaveID slaveA;
+  slaveA.set_value("agentA");
+
+  SlaveID slaveB;
+  slaveB.set_value("agentB");
+
+  SlaveID slaveC;
+  slaveC.set_value("agentC");
+
+  const Resources resources = Resources::parse("cpus:1;mem:10").get();
+
+  sorter.add("a/x");
+  sorter.add("b");
+
+  sorter.add(slaveA, resources);
+  sorter.add(slaveB, resources + resources);
+
+  sorter.allocated("a/x", slaveA, resources);
+  sorter.allocated("b", slaveB, resources);
+
+  // Remove agent A, whose handle is reused for agent C.
+  sorter.unallocated("a/x", slaveA, resources);
+  sorter.remove(slaveA, resources);
+
+  sorter.add(slaveC, resources);
+  sorter.allocated("a/x", slaveC, resources);
+  sorter.allocated("b", slaveB, resources);
+
+  EXPECT_EQ(
+      (hashmap<SlaveID, Resources>{{slaveC, resources}}),
+      sorter.allocation("a/x"));
+
+  EXPECT_EQ(
+      (hashmap<SlaveID, Resources>{{slaveB, resources + resources}}),
+      sorter.allocation("b"));
+
+  EXPECT_TRUE(sorter.allocation(slaveA).empty());
+  EXPECT_EQ(
+      (hashmap<string, Resources>{{"a/x", resources}}),
+      sorter.allocation(slaveC));
+
+  EXPECT_EQ(resources, sorter.allocation("a/x", slaveC));
+  EXPECT_EQ(Resources(), sorter.allocation("a/x", slaveA));
+
+  // shares: a = .33 (a/x = .33), b = .67
+  EXPECT_EQ(vector<string>({"a/x", "b"}), sorter.sort());
+
+  // Removing a client removes its allocation (and releases the handles
+  // of its agents) in the sorters of all its ancestors.
+  sorter.add("a/y");
+  sorter.remove("a/x");
+
+  EXPECT_TRUE(sorter.allocation(slaveC).empty());
+  EXPECT_EQ(vector<string>({"a/y", "b"}), sorter.sort());
+}
+
+
+// Exposes the snapshots of the sorters that are taken for partitioned
+// allocations.
+class SnapshotAllocatorProcess : public HierarchicalDRFAllocatorProcess
+{
+public:
+  using HierarchicalDRFAllocatorProcess::frameworkSorterFactory;
+  using HierarchicalDRFAllocatorProcess::roleSnapshotSorterFactory;
+  using HierarchicalDRFAllocatorProcess::snapshot;
+};
+
+
+// This test verifies that the snapshot of the role sorter sorts nested
+// roles like the role sorter, i.e., by the allocations of their
+// subtrees, which a flat copy would not.
+TEST(SorterTest, HierarchicalDRFSorterSnapshot)
+{
+  HierarchicalDRFSorter sorter;
+
+  SlaveID slaveId;
+  slaveId.set_value("agentId");
+
+  sorter.add(slaveId, Resources::parse("cpus:100;mem:100").get());
+
+  sorter.add("a", 2);
+  sorter.allocated("a", slaveId, Resources::parse("cpus:2;mem:2").get());
+
+  sorter.add("a/x");
+  sorter.allocated("a/x", slaveId, Resources::parse("cpus:10;mem:10").get());
+
+  sorter.add("a/y");
+  sorter.allocated("a/y", slaveId, Resources::parse("cpus:5;mem:5").get());
+
+  sorter.add("b");
+  sorter.allocated("b", slaveId, Resources::parse("cpus:6;mem:6").get());
+
+  // shares: a = .085 (a = .02, a/x = .10, a/y = .05, weight 2), b = .06
+  const vector<string> sorted = {"b", "a", "a/y", "a/x"};
+  EXPECT_EQ(sorted, sorter.sort());
+
+  SnapshotAllocatorProcess allocator;
+
+  auto weight = [](const string& client) {
+    return client == "a" ? 2.0 : 1.0;
+  };
+
+  Owned<Sorter> snapshot(allocator.snapshot(
+      &sorter, allocator.roleSnapshotSorterFactory, weight));
+
+  EXPECT_EQ(sorted, snapshot->sort());
+  EXPECT_EQ(sorter.count(), snapshot->count());
+
+  EXPECT_EQ(
+      sorter.allocationScalarQuantities(),
+      snapshot->allocationScalarQuantities());
+
+  foreach (const string& client, sorted) {
+    EXPECT_EQ(
+        sorter.allocationScalarQuantities(client),
+        snapshot->allocationScalarQuantities(client));
+  }
+
+  // A flat copy sorts the nested roles by their own allocations.
+  // shares: a = .01 (weight 2), a/y = .05, b = .06, a/x = .10
+  Owned<Sorter> flat(allocator.snapshot(
+      &sorter, allocator.frameworkSorterFactory, weight));
+
+  EXPECT_EQ(vector<string>({"a", "a/y", "b", "a/x"}), flat->sort());
+}
+
+
 class Sorter_BENCHMARK_Test
   : public ::testing::Test,
     public ::testing::WithParamInterface<std::tr1::tuple<size_t, size_t>> {};
@@ -902,6 +1229,256 @@ TEST_P(Sorter_BENCHMARK_Test, FullSort)
        << watch.elapsed() << endl;
 }
 
+
+class SorterOperations_BENCHMARK_Test
+  : public ::testing::Test,
+    public ::testing::WithParamInterface<
+        std::tr1::tuple<size_t, size_t, bool, bool>> {};
+
+
+// The sorter operations benchmark tests are parameterized by the number
+// of clients and agents, whether the client names are hierarchical
+// role names (e.g., "eng/team3/client17") rather than short names, and
+// whether the clients have different weights.
+INSTANTIATE_TEST_CASE_P(
+    ClientAndAgentCount,
+    SorterOperations_BENCHMARK_Test,
+    ::testing::Combine(
+      ::testing::Values(1000U, 10000U, 50000U, 100000U),
+      ::testing::Values(1000U, 10000U, 50000U),
+      ::testing::Bool(),
+      ::testing::Bool())
+    );
+
+
+// Prints the latency and throughput of `count` operations that took
+// `elapsed` in total.
+static void report(
+    const string& operation,
+    size_t count,
+    const Duration& elapsed)
+{
+  cout << operation << " x " << count << " took " << elapsed;
+
+  if (count > 0) {
+    cout << " (" << elapsed / count << " per operation";
+
+    if (elapsed > Duration::zero()) {
+      cout << ", " << static_cast<uint64_t>(count / elapsed.secs())
+           << " operations/sec";
+    }
+
+    cout << ")";
+  }
+
+  cout << endl;
+}
+
+
+// This benchmark measures each of the sorter operations used by the
+// allocator on their own, so that changes to the sorter can be
+// compared per operation rather than only by the cost of a full sort.
+TEST_P(SorterOperations_BENCHMARK_Test, Operations)
+{
+  size_t clientCount = std::tr1::get<0>(GetParam());
+  size_t agentCount = std::tr1::get<1>(GetParam());
+  bool hierarchical = std::tr1::get<2>(GetParam());
+  bool weighted = std::tr1::get<3>(GetParam());
+
+  cout << "Using " << clientCount << " clients and "
+       << agentCount << " agents"
+       << (hierarchical ? ", with hierarchical names" : "")
+       << (weighted ? ", with weights" : "") << endl;
+
+  vector<string> clients;
+  clients.reserve(clientCount);
+
+  for (size_t i = 0; i < clientCount; i++) {
+    if (hierarchical) {
+      clients.push_back(
+          "department" + stringify(i % 10) +
+          "/team" + stringify((i / 10) % 100) +
+          "/client" + stringify(i));
+    } else {
+      clients.push_back(stringify(i));
+    }
+  }
+
+  vector<SlaveID> agents;
+  agents.reserve(agentCount);
+
+  for (size_t i = 0; i < agentCount; i++) {
+    SlaveID slaveId;
+    slaveId.set_value("agent" + stringify(i));
+
+    agents.push_back(slaveId);
+  }
+
+  DRFSorter sorter;
+  Stopwatch watch;
+
+  watch.start();
+  {
+    for (size_t i = 0; i < clientCount; i++) {
+      sorter.add(clients[i], weighted ? 1.0 + (i % 5) : 1.0);
+    }
+  }
+  watch.stop();
+
+  report("add(client)", clientCount, watch.elapsed());
+
+  const Resources agentResources = Resources::parse(
+      "cpus:24;mem:4096;disk:4096;ports:[31000-32000]").get();
+
+  watch.start();
+  {
+    foreach (const SlaveID& slaveId, agents) {
+      sorter.add(slaveId, agentResources);
+    }
+  }
+  watch.stop();
+
+  report("add(agent)", agentCount, watch.elapsed());
+
+  // Allocate on every agent and to every client at least once, so
+  // that all clients have a non-zero share.
+  const size_t allocationCount = std::max(clientCount, agentCount);
+
+  const Resources allocated = Resources::parse(
+      "cpus:0.1;mem:16;disk:16;ports:[31000-31001]").get();
+
+  watch.start();
+  {
+    for (size_t i = 0; i < allocationCount; i++) {
+      const string& client = clients[i % clientCount];
+      const SlaveID& slaveId = agents[i % agentCount];
+
+      sorter.allocated(client, slaveId, allocated);
+    }
+  }
+  watch.stop();
+
+  report("allocated", allocationCount, watch.elapsed());
+
+  watch.start();
+  {
+    sorter.sort();
+  }
+  watch.stop();
+
+  report("sort (full)", 1, watch.elapsed());
+
+  watch.start();
+  {
+    sorter.sort();
+  }
+  watch.stop();
+
+  report("sort (no-op)", 1, watch.elapsed());
+
+  // Interleave a single allocation change with each sort, as happens
+  // when the allocator allocates to the first client in the order.
+  const size_t churnCount = 100;
+
+  watch.start();
+  {
+    for (size_t i = 0; i < churnCount; i++) {
+      const string& client = clients[i % clientCount];
+      const SlaveID& slaveId = agents[i % agentCount];
+
+      sorter.allocated(client, slaveId, allocated);
+      sorter.sort();
+    }
+  }
+  watch.stop();
+
+  report("allocated + sort", churnCount, watch.elapsed());
+
+  watch.start();
+  {
+    for (size_t i = 0; i < churnCount; i++) {
+      const string& client = clients[i % clientCount];
+      const SlaveID& slaveId = agents[i % agentCount];
+
+      sorter.unallocated(client, slaveId, allocated);
+    }
+  }
+  watch.stop();
+
+  report("unallocated (churn)", churnCount, watch.elapsed());
+
+  watch.start();
+  {
+    for (size_t i = 0; i < clientCount; i++) {
+      sorter.update(clients[i], weighted ? 1.0 + ((i + 1) % 5) : 2.0);
+    }
+  }
+  watch.stop();
+
+  report("update(weight)", clientCount, watch.elapsed());
+
+  watch.start();
+  {
+    foreach (const string& client, clients) {
+      sorter.deactivate(client);
+    }
+  }
+  watch.stop();
+
+  report("deactivate", clientCount, watch.elapsed());
+
+  watch.start();
+  {
+    foreach (const string& client, clients) {
+      sorter.activate(client);
+    }
+  }
+  watch.stop();
+
+  report("activate", clientCount, watch.elapsed());
+
+  watch.start();
+  {
+    sorter.sort();
+  }
+  watch.stop();
+
+  report("sort (after reactivation)", 1, watch.elapsed());
+
+  watch.start();
+  {
+    for (size_t i = 0; i < allocationCount; i++) {
+      const string& client = clients[i % clientCount];
+      const SlaveID& slaveId = agents[i % agentCount];
+
+      sorter.unallocated(client, slaveId, allocated);
+    }
+  }
+  watch.stop();
+
+  report("unallocated", allocationCount, watch.elapsed());
+
+  watch.start();
+  {
+    foreach (const SlaveID& slaveId, agents) {
+      sorter.remove(slaveId, agentResources);
+    }
+  }
+  watch.stop();
+
+  report("remove(agent)", agentCount, watch.elapsed());
+
+  watch.start();
+  {
+    foreach (const string& client, clients) {
+      sorter.remove(client);
+    }
+  }
+  watch.stop();
+
+  report("remove(client)", clientCount, watch.elapsed());
+}
+
 } // namespace tests {
 } // namespace internal {
 } // namespace mesos {
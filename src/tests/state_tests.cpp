@@ -38,9 +38,11 @@
 #include <process/protobuf.hpp>
 #include <process/pid.hpp>
 
+#include <stout/foreach.hpp>
 #include <stout/gtest.hpp>
 #include <stout/option.hpp>
 #include <stout/os.hpp>
+#include <stout/stringify.hpp>
 #include <stout/try.hpp>
 
 #include <stout/tests/utils.hpp>
@@ -394,6 +396,87 @@ TEST_F(InMemoryStateTest, Names)
 }
 
 
+// This test verifies that large values are stored in chunks and
+// that only the chunks that changed are written by a store.
+TEST_F(InMemoryStateTest, Chunks)
+{
+  mesos::state::State chunked(storage, Bytes(64));
+
+  Future<mesos::state::Variable> variable = chunked.fetch("value");
+  AWAIT_READY(variable);
+
+  string value1;
+  for (int i = 0; i < 1000; i++) {
+    value1 += stringify(i) + ",";
+  }
+
+  Future<Option<mesos::state::Variable>> stored =
+    chunked.store(variable->mutate(value1));
+  AWAIT_READY(stored);
+  ASSERT_SOME(stored.get());
+
+  Future<set<string>> names = storage->names();
+  AWAIT_READY(names);
+
+  set<string> chunks1 = names.get();
+  EXPECT_EQ(1u, chunks1.erase("value"));
+  EXPECT_LT(1u, chunks1.size());
+
+  // The chunks are not variables of the state.
+  AWAIT_EXPECT_EQ(set<string>({"value"}), chunked.names());
+
+  // A state that doesn't store values in chunks can still fetch them.
+  mesos::state::State unchunked(storage);
+
+  variable = unchunked.fetch("value");
+  AWAIT_READY(variable);
+  EXPECT_EQ(value1, variable->value());
+
+  // Changing the middle of the value should only replace the chunks
+  // around the change.
+  string value2 = value1;
+  value2.insert(value2.size() / 2, "changed");
+
+  stored = chunked.store(variable->mutate(value2));
+  AWAIT_READY(stored);
+  ASSERT_SOME(stored.get());
+
+  names = storage->names();
+  AWAIT_READY(names);
+
+  set<string> chunks2 = names.get();
+  EXPECT_EQ(1u, chunks2.erase("value"));
+
+  size_t kept = 0;
+  foreach (const string& chunk, chunks2) {
+    kept += chunks1.count(chunk);
+  }
+
+  EXPECT_LE(chunks1.size() - kept, 3u);
+
+  variable = chunked.fetch("value");
+  AWAIT_READY(variable);
+  EXPECT_EQ(value2, variable->value());
+
+  // A stale store fails and leaves the stored chunks alone.
+  stored = chunked.store(variable->mutate(value1));
+  AWAIT_READY(stored);
+  ASSERT_SOME(stored.get());
+
+  stored = chunked.store(variable->mutate(""));
+  AWAIT_READY(stored);
+  EXPECT_NONE(stored.get());
+
+  variable = chunked.fetch("value");
+  AWAIT_READY(variable);
+  EXPECT_EQ(value1, variable->value());
+
+  // Expunging the variable also expunges its chunks.
+  AWAIT_EXPECT_TRUE(chunked.expunge(variable.get()));
+  AWAIT_EXPECT_EQ(set<string>(), storage->names());
+}
+
+
 class LevelDBStateTest : public TemporaryDirectoryTest
 {
 public:
@@ -762,6 +845,63 @@ TEST_F(ZooKeeperStateTest, Names)
 {
   Names(state);
 }
+
+
+// This test verifies that stores that are issued together (and are
+// thus performed in a single ZooKeeper transaction) all succeed, and
+// that a stale store fails even if the variable was cached.
+TEST_F(ZooKeeperStateTest, BatchedStores)
+{
+  vector<Future<Option<Variable<Slaves>>>> futures;
+
+  for (int i = 0; i < 5; i++) {
+    Future<Variable<Slaves>> variable =
+      state->fetch<Slaves>("slaves" + stringify(i));
+    AWAIT_READY(variable);
+
+    Slaves slaves;
+    slaves.add_slaves()->mutable_info()->set_hostname("localhost");
+
+    futures.push_back(state->store(variable->mutate(slaves)));
+  }
+
+  foreach (const Future<Option<Variable<Slaves>>>& future, futures) {
+    AWAIT_READY(future);
+    EXPECT_SOME(future.get());
+  }
+
+  // Cache the variable and change it through another storage.
+  Future<Variable<Slaves>> future1 = state->fetch<Slaves>("slaves0");
+  AWAIT_READY(future1);
+
+  Variable<Slaves> variable = future1.get();
+
+  mesos::state::ZooKeeperStorage storage2(
+      server->connectString(),
+      NO_TIMEOUT,
+      "/state/");
+
+  State state2(&storage2);
+
+  Future<Variable<Slaves>> future2 = state2.fetch<Slaves>("slaves0");
+  AWAIT_READY(future2);
+
+  Slaves slaves = future2->get();
+  slaves.add_slaves()->mutable_info()->set_hostname("localhost2");
+
+  Future<Option<Variable<Slaves>>> store =
+    state2.store(future2->mutate(slaves));
+  AWAIT_READY(store);
+  ASSERT_SOME(store.get());
+
+  store = state->store(variable.mutate(Slaves()));
+  AWAIT_READY(store);
+  EXPECT_NONE(store.get());
+
+  future1 = state->fetch<Slaves>("slaves0");
+  AWAIT_READY(future1);
+  EXPECT_EQ(2, future1->get().slaves().size());
+}
 #endif // MESOS_HAS_JAVA
 
 } // namespace tests {
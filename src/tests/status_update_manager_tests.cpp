@@ -28,7 +28,10 @@
 #include <process/owned.hpp>
 #include <process/pid.hpp>
 
+#include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
 #include <stout/none.hpp>
+#include <stout/os.hpp>
 #include <stout/result.hpp>
 #include <stout/try.hpp>
 
@@ -38,6 +41,7 @@
 #include "slave/paths.hpp"
 #include "slave/slave.hpp"
 #include "slave/state.hpp"
+#include "slave/status_update_journal.hpp"
 
 #include "messages/messages.hpp"
 
@@ -55,6 +59,7 @@ using process::Future;
 using process::Owned;
 using process::PID;
 
+using std::list;
 using std::string;
 using std::vector;
 
@@ -849,6 +854,259 @@ TEST_F(StatusUpdateManagerTest, DuplicatedTerminalStatusUpdate)
   driver.join();
 }
 
+
+
+class StatusUpdateJournalTest : public TemporaryDirectoryTest
+{
+protected:
+  static StatusUpdateRecord createRecord(
+      const StatusUpdate& update,
+      const StatusUpdateRecord::Type& type)
+  {
+    StatusUpdateRecord record;
+    record.set_type(type);
+
+    if (type == StatusUpdateRecord::UPDATE) {
+      record.mutable_update()->CopyFrom(update);
+    } else {
+      record.set_uuid(update.uuid());
+    }
+
+    return record;
+  }
+};
+
+
+// This test verifies that compacting the journal only retains the
+// last update (and its acknowledgement) of the closed streams, drops
+// the closed streams whose executor run has been garbage collected,
+// and retains the streams that are still open in their entirety.
+TEST_F(StatusUpdateJournalTest, Compact)
+{
+  const string rootDir = os::getcwd();
+
+  SlaveID slaveId;
+  slaveId.set_value("agent");
+
+  FrameworkID frameworkId;
+  frameworkId.set_value("framework");
+
+  ExecutorID executorId;
+  executorId.set_value("executor");
+
+  ContainerID containerId1;
+  containerId1.set_value("container1");
+
+  // The executor run of 'containerId2' has been garbage collected,
+  // i.e., its meta directory does not exist.
+  ContainerID containerId2;
+  containerId2.set_value("container2");
+
+  ASSERT_SOME(os::mkdir(slave::paths::getExecutorRunPath(
+      rootDir, slaveId, frameworkId, executorId, containerId1)));
+
+  Try<Owned<slave::StatusUpdateJournal>> journal =
+    slave::StatusUpdateJournal::open(rootDir, slaveId);
+
+  ASSERT_SOME(journal);
+
+  TaskID taskId1;
+  taskId1.set_value("task1");
+
+  TaskID taskId2;
+  taskId2.set_value("task2");
+
+  TaskID taskId3;
+  taskId3.set_value("task3");
+
+  const StatusUpdate running1 = protobuf::createStatusUpdate(
+      frameworkId, slaveId, taskId1, TASK_RUNNING,
+      TaskStatus::SOURCE_EXECUTOR, UUID::random());
+
+  const StatusUpdate finished1 = protobuf::createStatusUpdate(
+      frameworkId, slaveId, taskId1, TASK_FINISHED,
+      TaskStatus::SOURCE_EXECUTOR, UUID::random());
+
+  const StatusUpdate running2 = protobuf::createStatusUpdate(
+      frameworkId, slaveId, taskId2, TASK_RUNNING,
+      TaskStatus::SOURCE_EXECUTOR, UUID::random());
+
+  const StatusUpdate finished3 = protobuf::createStatusUpdate(
+      frameworkId, slaveId, taskId3, TASK_FINISHED,
+      TaskStatus::SOURCE_EXECUTOR, UUID::random());
+
+  foreach (const StatusUpdate& update, vector<StatusUpdate>({
+               running1, finished1})) {
+    foreach (const StatusUpdateRecord::Type& type,
+             vector<StatusUpdateRecord::Type>({
+                 StatusUpdateRecord::UPDATE, StatusUpdateRecord::ACK})) {
+      ASSERT_SOME(journal.get()->append(
+          frameworkId,
+          taskId1,
+          executorId,
+          containerId1,
+          createRecord(update, type)));
+    }
+  }
+
+  journal.get()->close(frameworkId, taskId1);
+
+  ASSERT_SOME(journal.get()->append(
+      frameworkId,
+      taskId2,
+      executorId,
+      containerId1,
+      createRecord(running2, StatusUpdateRecord::UPDATE)));
+
+  ASSERT_SOME(journal.get()->append(
+      frameworkId,
+      taskId3,
+      executorId,
+      containerId2,
+      createRecord(finished3, StatusUpdateRecord::UPDATE)));
+
+  journal.get()->close(frameworkId, taskId3);
+
+  ASSERT_SOME(journal.get()->compact());
+
+  ASSERT_SOME(journal.get()->append(
+      frameworkId,
+      taskId2,
+      executorId,
+      containerId1,
+      createRecord(running2, StatusUpdateRecord::ACK)));
+
+  // Re-open the journal to make sure the snapshot and the segment
+  // that follows it are restored.
+  journal->reset();
+
+  journal = slave::StatusUpdateJournal::open(rootDir, slaveId);
+  ASSERT_SOME(journal);
+
+  Try<list<string>> files = os::ls(
+      slave::paths::getStatusUpdateJournalPath(rootDir, slaveId));
+
+  ASSERT_SOME(files);
+  EXPECT_EQ(2u, files->size());
+
+  Try<hashmap<FrameworkID, hashmap<TaskID, slave::StatusUpdateJournal::Stream>>>
+    streams = slave::StatusUpdateJournal::read(rootDir, slaveId);
+
+  ASSERT_SOME(streams);
+  ASSERT_TRUE(streams->contains(frameworkId));
+  ASSERT_EQ(2u, streams->at(frameworkId).size());
+
+  ASSERT_TRUE(streams->at(frameworkId).contains(taskId1));
+
+  const slave::StatusUpdateJournal::Stream& stream1 =
+    streams->at(frameworkId).at(taskId1);
+
+  ASSERT_EQ(1u, stream1.updates.size());
+  EXPECT_EQ(TASK_FINISHED, stream1.updates[0].status().state());
+  EXPECT_EQ(1u, stream1.acks.size());
+
+  ASSERT_TRUE(streams->at(frameworkId).contains(taskId2));
+
+  const slave::StatusUpdateJournal::Stream& stream2 =
+    streams->at(frameworkId).at(taskId2);
+
+  ASSERT_EQ(1u, stream2.updates.size());
+  EXPECT_EQ(TASK_RUNNING, stream2.updates[0].status().state());
+  EXPECT_EQ(1u, stream2.acks.size());
+}
+
+
+// This test verifies that the 'task.updates' file of a task, as
+// checkpointed by older agents, is migrated to the journal, and that
+// the records journaled by a previous migration which was interrupted
+// are not journaled again.
+TEST_F(StatusUpdateJournalTest, Migrate)
+{
+  const string rootDir = os::getcwd();
+
+  SlaveID slaveId;
+  slaveId.set_value("agent");
+
+  FrameworkID frameworkId;
+  frameworkId.set_value("framework");
+
+  ExecutorID executorId;
+  executorId.set_value("executor");
+
+  ContainerID containerId;
+  containerId.set_value("container");
+
+  TaskID taskId;
+  taskId.set_value("task");
+
+  const StatusUpdate running = protobuf::createStatusUpdate(
+      frameworkId, slaveId, taskId, TASK_RUNNING,
+      TaskStatus::SOURCE_EXECUTOR, UUID::random());
+
+  const StatusUpdate finished = protobuf::createStatusUpdate(
+      frameworkId, slaveId, taskId, TASK_FINISHED,
+      TaskStatus::SOURCE_EXECUTOR, UUID::random());
+
+  const vector<StatusUpdateRecord> records = {
+    createRecord(running, StatusUpdateRecord::UPDATE),
+    createRecord(running, StatusUpdateRecord::ACK),
+    createRecord(finished, StatusUpdateRecord::UPDATE)
+  };
+
+  const string path = slave::paths::getTaskUpdatesPath(
+      rootDir, slaveId, frameworkId, executorId, containerId, taskId);
+
+  ASSERT_SOME(os::mkdir(Path(path).dirname()));
+
+  Try<int> fd = os::open(
+      path,
+      O_CREAT | O_WRONLY | O_APPEND | O_CLOEXEC,
+      S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+
+  ASSERT_SOME(fd);
+
+  foreach (const StatusUpdateRecord& record, records) {
+    ASSERT_SOME(::protobuf::write(fd.get(), record));
+  }
+
+  ASSERT_SOME(os::close(fd.get()));
+
+  Try<Owned<slave::StatusUpdateJournal>> journal =
+    slave::StatusUpdateJournal::open(rootDir, slaveId);
+
+  ASSERT_SOME(journal);
+
+  // Journal the first two records, as if the agent failed over while
+  // migrating the file before.
+  for (size_t i = 0; i < 2; i++) {
+    ASSERT_SOME(journal.get()->append(
+        frameworkId, taskId, executorId, containerId, records[i]));
+  }
+
+  ASSERT_SOME(journal.get()->migrate(
+      frameworkId, taskId, executorId, containerId, path));
+
+  EXPECT_FALSE(os::exists(path));
+
+  Try<hashmap<FrameworkID, hashmap<TaskID, slave::StatusUpdateJournal::Stream>>>
+    streams = slave::StatusUpdateJournal::read(rootDir, slaveId);
+
+  ASSERT_SOME(streams);
+  ASSERT_TRUE(streams->contains(frameworkId));
+  ASSERT_TRUE(streams->at(frameworkId).contains(taskId));
+
+  const slave::StatusUpdateJournal::Stream& stream =
+    streams->at(frameworkId).at(taskId);
+
+  ASSERT_EQ(2u, stream.updates.size());
+  EXPECT_EQ(running.uuid(), stream.updates[0].uuid());
+  EXPECT_EQ(finished.uuid(), stream.updates[1].uuid());
+
+  EXPECT_EQ(
+      hashset<UUID>({UUID::fromBytes(running.uuid()).get()}),
+      stream.acks);
+}
+
 } // namespace tests {
 } // namespace internal {
 } // namespace mesos {
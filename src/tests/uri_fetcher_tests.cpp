@@ -19,13 +19,16 @@
 #include <process/future.hpp>
 #include <process/gtest.hpp>
 #include <process/http.hpp>
+#include <process/id.hpp>
 #include <process/process.hpp>
 
 #include <stout/check.hpp>
 #include <stout/duration.hpp>
 #include <stout/gtest.hpp>
+#include <stout/numify.hpp>
 #include <stout/os.hpp>
 #include <stout/path.hpp>
+#include <stout/strings.hpp>
 
 #include <stout/os/exists.hpp>
 #include <stout/os/getcwd.hpp>
@@ -47,6 +50,7 @@ namespace http = process::http;
 
 using std::list;
 using std::string;
+using std::vector;
 
 using process::Future;
 using process::Owned;
@@ -192,6 +196,56 @@ protected:
 };
 
 
+// A WebHDFS server which serves the same content for every file, in
+// blocks of 2 bytes. Files are read by offset and length as if the
+// server was a DataNode the NameNode redirected to.
+class TestWebHDFSServer : public Process<TestWebHDFSServer>
+{
+public:
+  explicit TestWebHDFSServer(const string& _content)
+    : ProcessBase(process::ID::generate("webhdfs")),
+      content(_content) {}
+
+  string url() const
+  {
+    return "http://" + stringify(self().address) + "/" + self().id;
+  }
+
+protected:
+  virtual void initialize()
+  {
+    route("/webhdfs/v1", None(), &TestWebHDFSServer::serve);
+  }
+
+private:
+  Future<http::Response> serve(const http::Request& request)
+  {
+    const string op = request.url.query.get("op").getOrElse("");
+
+    if (op == "GETFILESTATUS") {
+      return http::OK(
+          "{\"FileStatus\":{\"type\":\"FILE\",\"length\":" +
+          stringify(content.size()) + ",\"blockSize\":2}}");
+    }
+
+    if (op == "OPEN") {
+      Try<size_t> offset = numify<size_t>(request.url.query.at("offset"));
+      Try<size_t> length = numify<size_t>(request.url.query.at("length"));
+
+      if (offset.isError() || length.isError()) {
+        return http::BadRequest();
+      }
+
+      return http::OK(content.substr(offset.get(), length.get()));
+    }
+
+    return http::BadRequest();
+  }
+
+  const string content;
+};
+
+
 // TODO(hausdorff): Will not compile until HDFS is supported on Windows. See
 // MESOS-5460.
 #ifndef __WINDOWS__
@@ -265,6 +319,71 @@ TEST_F(HadoopFetcherPluginTest, InvokeFetchByName)
 #endif // __WINDOWS__
 
 
+// TODO(hausdorff): Will not compile until HDFS is supported on Windows. See
+// MESOS-5460.
+#ifndef __WINDOWS__
+// This test verifies that files are fetched through WebHDFS, block by
+// block, when the WebHDFS URL is specified.
+TEST_F(HadoopFetcherPluginTest, FetchThroughWebHDFS)
+{
+  TestWebHDFSServer server("abcde");
+  spawn(server);
+
+  // The file only exists on the WebHDFS server, so that the fetch
+  // fails if the hadoop client is used.
+  URI uri = uri::hdfs("/webhdfs/file");
+
+  uri::fetcher::Flags flags;
+  flags.hadoop_client = hadoop;
+  flags.hadoop_webhdfs_url = server.url();
+  flags.hadoop_webhdfs_parallelism = 2;
+
+  Try<Owned<uri::Fetcher>> fetcher = uri::fetcher::create(flags);
+  ASSERT_SOME(fetcher);
+
+  string dir = path::join(os::getcwd(), "dir");
+
+  AWAIT_READY(fetcher.get()->fetch(uri, dir));
+
+  EXPECT_SOME_EQ("abcde", os::read(path::join(dir, "file")));
+
+  terminate(server);
+  wait(server);
+}
+#endif // __WINDOWS__
+
+
+// TODO(hausdorff): Will not compile until HDFS is supported on Windows. See
+// MESOS-5460.
+#ifndef __WINDOWS__
+// This test verifies that the hadoop client is used if the fetch
+// through WebHDFS fails.
+TEST_F(HadoopFetcherPluginTest, FetchFallsBackToHadoopClient)
+{
+  string file = path::join(os::getcwd(), "file");
+
+  ASSERT_SOME(os::write(file, "abc"));
+
+  URI uri = uri::hdfs(file);
+
+  // There is no WebHDFS server at this URL.
+  uri::fetcher::Flags flags;
+  flags.hadoop_client = hadoop;
+  flags.hadoop_webhdfs_url =
+    "http://" + stringify(process::address()) + "/non-exist";
+
+  Try<Owned<uri::Fetcher>> fetcher = uri::fetcher::create(flags);
+  ASSERT_SOME(fetcher);
+
+  string dir = path::join(os::getcwd(), "dir");
+
+  AWAIT_READY(fetcher.get()->fetch(uri, dir));
+
+  EXPECT_SOME_EQ("abc", os::read(path::join(dir, "file")));
+}
+#endif // __WINDOWS__
+
+
 // TODO(jieyu): Expose this constant so that other docker related
 // tests can use this as well.
 static constexpr char DOCKER_REGISTRY_HOST[] = "registry-1.docker.io";
@@ -273,6 +392,103 @@ static constexpr char DOCKER_REGISTRY_HOST[] = "registry-1.docker.io";
 class DockerFetcherPluginTest : public TemporaryDirectoryTest {};
 
 
+// A docker registry serving the same blob for every digest of the
+// 'library' repositories, which supports range requests. As the paths
+// of the registry API start with '/v2', only one registry can be
+// spawned at a time.
+class TestDockerRegistry : public Process<TestDockerRegistry>
+{
+public:
+  explicit TestDockerRegistry(const string& _blob)
+    : ProcessBase("v2"),
+      requests(0),
+      blob(_blob) {}
+
+  // The number of requests for the blob.
+  size_t requests;
+
+protected:
+  virtual void initialize()
+  {
+    route("/library", None(), &TestDockerRegistry::serve);
+  }
+
+private:
+  Future<http::Response> serve(const http::Request& request)
+  {
+    requests++;
+
+    Option<string> range = request.headers.get("Range");
+    if (range.isNone()) {
+      return http::OK(blob);
+    }
+
+    // E.g., 'bytes=0-1'.
+    const vector<string> tokens = strings::tokenize(range.get(), "=-");
+    if (tokens.size() != 3 || tokens[0] != "bytes") {
+      return http::BadRequest();
+    }
+
+    Try<size_t> first = numify<size_t>(tokens[1]);
+    Try<size_t> last = numify<size_t>(tokens[2]);
+
+    if (first.isError() || last.isError() || first.get() >= blob.size()) {
+      return http::BadRequest();
+    }
+
+    last = std::min(last.get(), blob.size() - 1);
+
+    http::Response response(
+        blob.substr(first.get(), last.get() - first.get() + 1),
+        http::Status::PARTIAL_CONTENT);
+
+    response.headers["Content-Range"] =
+      "bytes " + stringify(first.get()) + "-" + stringify(last.get()) +
+      "/" + stringify(blob.size());
+
+    return response;
+  }
+
+  const string blob;
+};
+
+
+#ifndef __WINDOWS__
+// This test verifies that blobs are downloaded in ranges, if the
+// registry supports range requests.
+TEST_F(DockerFetcherPluginTest, FetchBlobInRanges)
+{
+  TestDockerRegistry registry("abcde");
+  spawn(registry);
+
+  URI uri = uri::docker::blob(
+      "library/busybox",
+      "digest",
+      stringify(registry.self().address.ip),
+      "http",
+      registry.self().address.port);
+
+  uri::fetcher::Flags flags;
+  flags.docker_blob_range_size = Bytes(2);
+  flags.docker_blob_parallelism = 2;
+
+  Try<Owned<uri::Fetcher>> fetcher = uri::fetcher::create(flags);
+  ASSERT_SOME(fetcher);
+
+  string dir = path::join(os::getcwd(), "dir");
+
+  AWAIT_READY(fetcher.get()->fetch(uri, dir));
+
+  EXPECT_SOME_EQ("abcde", os::read(path::join(dir, "digest")));
+
+  terminate(registry);
+  wait(registry);
+
+  EXPECT_EQ(3u, registry.requests);
+}
+#endif // __WINDOWS__
+
+
 TEST_F(DockerFetcherPluginTest, INTERNET_CURL_FetchManifest)
 {
   URI uri = uri::docker::manifest(
@@ -141,6 +141,43 @@ TEST_F(ZooKeeperTest, Create)
 }
 
 
+TEST_F(ZooKeeperTest, Multi)
+{
+  ZooKeeperTest::TestWatcher watcher;
+
+  ZooKeeper zk(server->connectString(), NO_TIMEOUT, &watcher);
+  watcher.awaitSessionEvent(ZOO_CONNECTED_STATE);
+
+  EXPECT_EQ(ZOK, zk.create("/foo", "", ZOO_OPEN_ACL_UNSAFE, 0, nullptr));
+
+  std::vector<zoo_op_t> ops(2);
+  zoo_create_op_init(
+      &ops[0], "/foo/bar", "42", 2, &ZOO_OPEN_ACL_UNSAFE, 0, nullptr, 0);
+  zoo_set_op_init(&ops[1], "/foo", "43", 2, 0, nullptr);
+
+  std::vector<zoo_op_result_t> results;
+  EXPECT_EQ(ZOK, zk.multi(ops, &results));
+  ASSERT_EQ(2u, results.size());
+  EXPECT_EQ(ZOK, results[0].err);
+  EXPECT_EQ(ZOK, results[1].err);
+
+  ASSERT_ZK_GET("42", &zk, "/foo/bar");
+  ASSERT_ZK_GET("43", &zk, "/foo");
+
+  // None of the operations are performed if one of them fails, here
+  // because the version of '/foo' is no longer 0.
+  zoo_set_op_init(&ops[0], "/foo/bar", "44", 2, 0, nullptr);
+  zoo_set_op_init(&ops[1], "/foo", "44", 2, 0, nullptr);
+
+  EXPECT_EQ(ZBADVERSION, zk.multi(ops, &results));
+  ASSERT_EQ(2u, results.size());
+  EXPECT_EQ(ZBADVERSION, results[1].err);
+
+  ASSERT_ZK_GET("42", &zk, "/foo/bar");
+  ASSERT_ZK_GET("43", &zk, "/foo");
+}
+
+
 TEST_F(ZooKeeperTest, LeaderDetector)
 {
   Group group(server->connectString(), NO_TIMEOUT, "/test/");
@@ -325,8 +362,9 @@ TEST_F(ZooKeeperTest, LeaderContender)
   server->expireSession(session.get().get());
 
   Clock::pause();
-  // The retry timeout.
-  Clock::advance(GroupProcess::RETRY_INTERVAL);
+  // The retry timeout, which is at most twice the retry interval
+  // because of its jitter.
+  Clock::advance(GroupProcess::RETRY_INTERVAL * 2);
   Clock::settle();
   Clock::resume();
 
@@ -22,6 +22,8 @@
 #include <tuple>
 #include <vector>
 
+#include <glog/logging.h>
+
 #include <process/check.hpp>
 #include <process/collect.hpp>
 #include <process/io.hpp>
@@ -32,6 +34,8 @@
 
 #include <stout/os/mkdir.hpp>
 
+#include "uri/http_client.hpp"
+
 #include "uri/fetchers/curl.hpp"
 
 namespace http = process::http;
@@ -53,49 +57,10 @@ using process::Subprocess;
 namespace mesos {
 namespace uri {
 
-const char CurlFetcherPlugin::NAME[] = "curl";
-
-
-Try<Owned<Fetcher::Plugin>> CurlFetcherPlugin::create(const Flags& flags)
-{
-  // TODO(jieyu): Make sure curl is available.
-
-  return Owned<Fetcher::Plugin>(new CurlFetcherPlugin());
-}
-
-
-set<string> CurlFetcherPlugin::schemes() const
-{
-  return {"http", "https", "ftp", "ftps"};
-}
-
-
-string CurlFetcherPlugin::name() const
-{
-  return NAME;
-}
-
-
-Future<Nothing> CurlFetcherPlugin::fetch(
-    const URI& uri,
-    const string& directory) const
+// Uses the curl command to download the URI to the output and returns
+// the HTTP response code.
+static Future<int> curl(const URI& uri, const string& output)
 {
-  // TODO(jieyu): Validate the given URI.
-
-  if (!uri.has_path()) {
-    return Failure("URI path is not specified");
-  }
-
-  Try<Nothing> mkdir = os::mkdir(directory);
-  if (mkdir.isError()) {
-    return Failure(
-        "Failed to create directory '" +
-        directory + "': " + mkdir.error());
-  }
-
-  // TODO(jieyu): Allow user to specify the name of the output file.
-  const string output = path::join(directory, Path(uri.path()).basename());
-
   const vector<string> argv = {
     "curl",
     "-s",                 // Don't show progress meter or error messages.
@@ -124,7 +89,7 @@ Future<Nothing> CurlFetcherPlugin::fetch(
     .then([](const tuple<
         Future<Option<int>>,
         Future<string>,
-        Future<string>>& t) -> Future<Nothing> {
+        Future<string>>& t) -> Future<int> {
       Future<Option<int>> status = std::get<0>(t);
       if (!status.isReady()) {
         return Failure(
@@ -160,10 +125,73 @@ Future<Nothing> CurlFetcherPlugin::fetch(
         return Failure("Unexpected output from 'curl': " + output.get());
       }
 
-      if (code.get() != http::Status::OK) {
+      return code.get();
+    });
+}
+
+
+const char CurlFetcherPlugin::NAME[] = "curl";
+
+
+Try<Owned<Fetcher::Plugin>> CurlFetcherPlugin::create(const Flags& flags)
+{
+  // TODO(jieyu): Make sure curl is available.
+
+  return Owned<Fetcher::Plugin>(new CurlFetcherPlugin());
+}
+
+
+set<string> CurlFetcherPlugin::schemes() const
+{
+  return {"http", "https", "ftp", "ftps"};
+}
+
+
+string CurlFetcherPlugin::name() const
+{
+  return NAME;
+}
+
+
+Future<Nothing> CurlFetcherPlugin::fetch(
+    const URI& uri,
+    const string& directory) const
+{
+  // TODO(jieyu): Validate the given URI.
+
+  if (!uri.has_path()) {
+    return Failure("URI path is not specified");
+  }
+
+  Try<Nothing> mkdir = os::mkdir(directory);
+  if (mkdir.isError()) {
+    return Failure(
+        "Failed to create directory '" +
+        directory + "': " + mkdir.error());
+  }
+
+  // TODO(jieyu): Allow user to specify the name of the output file.
+  const string output = path::join(directory, Path(uri.path()).basename());
+
+  // NOTE: The download is retried with curl if it fails in-process
+  // for any other reason than an HTTP error response (e.g., if the
+  // server redirects to a URL with a scheme that is not supported).
+  Future<int> code = http_client::supported(stringify(uri))
+    ? http_client::download(stringify(uri), output)
+        .repair([=](const Future<int>& future) {
+          LOG(WARNING) << "Failed to download '" << uri << "', retrying"
+                       << " with curl: " << future.failure();
+
+          return curl(uri, output);
+        })
+    : curl(uri, output);
+
+  return code
+    .then([](int code) -> Future<Nothing> {
+      if (code != http::Status::OK) {
         return Failure(
             "Unexpected HTTP response code: " +
-            http::Status::string(code.get()));
+            http::Status::string(code));
       }
 
       return Nothing();
@@ -19,6 +19,8 @@
 #include <tuple>
 #include <vector>
 
+#include <glog/logging.h>
+
 #include <process/collect.hpp>
 #include <process/dispatch.hpp>
 #include <process/http.hpp>
@@ -36,6 +38,7 @@
 
 #include <mesos/docker/spec.hpp>
 
+#include "uri/http_client.hpp"
 #include "uri/utils.hpp"
 
 #include "uri/fetchers/docker.hpp"
@@ -195,27 +198,52 @@ static Future<http::Response> curl(
 }
 
 
-static Future<http::Response> curl(
-    const URI& uri,
+// Sends an HTTP request to the given URL from within the process if
+// possible (see `http_client::supported`), and using the curl command
+// otherwise, or if the request fails for any other reason than an
+// HTTP error response.
+static Future<http::Response> get(
+    const string& uri,
     const http::Headers& headers = http::Headers())
 {
-  return curl(stringify(uri), headers);
+  if (!http_client::supported(uri)) {
+    return curl(uri, headers);
+  }
+
+  return http_client::get(uri, headers)
+    .repair([=](const Future<http::Response>& future) {
+      LOG(WARNING) << "Failed to GET '" << uri << "', retrying with curl: "
+                   << future.failure();
+
+      return curl(uri, headers);
+    });
 }
 
 
-// TODO(jieyu): Add a comment here.
-static Future<int> download(
+static Future<http::Response> get(
     const URI& uri,
-    const string& directory,
     const http::Headers& headers = http::Headers())
 {
-  const string output = path::join(directory, Path(uri.path()).basename());
+  return get(stringify(uri), headers);
+}
+
 
+// Uses the curl command to download the given URL to the output and
+// returns the HTTP response code. The body of an HTTP error response
+// (e.g., '401 Unauthorized') is not written to the output, so that the
+// output is not clobbered if it is, e.g., a FIFO that is being read
+// from.
+static Future<int> curl(
+    const URI& uri,
+    const string& output,
+    const http::Headers& headers)
+{
   vector<string> argv = {
     "curl",
     "-s",                 // Don't show progress meter or error messages.
     "-S",                 // Make curl show an error message if it fails.
     "-L",                 // Follow HTTP 3xx redirects.
+    "-f",                 // Don't output the body of HTTP errors.
     "-w", "%{http_code}", // Display HTTP response code on stdout.
     "-o", output          // Write output to the file.
   };
@@ -259,7 +287,12 @@ static Future<int> download(
         return Failure("Failed to reap the curl subprocess");
       }
 
-      if (status->get() != 0) {
+      // NOTE: curl exits with 22 on an HTTP error response due to
+      // '-f', in which case we still return the response code.
+      const bool httpError =
+        WIFEXITED(status->get()) && WEXITSTATUS(status->get()) == 22;
+
+      if (status->get() != 0 && !httpError) {
         Future<string> error = std::get<2>(t);
         if (!error.isReady()) {
           return Failure(
@@ -287,6 +320,39 @@ static Future<int> download(
     });
 }
 
+
+// Downloads the given URL into the given directory (as the basename of
+// the URL path) and returns the HTTP response code, like `curl` above.
+// The download happens within the process if possible, in ranges of
+// 'rangeSize' with up to 'parallelism' ranges in flight (see
+// `http_client::download`).
+static Future<int> download(
+    const URI& uri,
+    const string& directory,
+    const http::Headers& headers,
+    const Bytes& rangeSize,
+    size_t parallelism)
+{
+  const string output = path::join(directory, Path(uri.path()).basename());
+
+  if (!http_client::supported(stringify(uri))) {
+    return curl(uri, output, headers);
+  }
+
+  return http_client::download(
+      stringify(uri),
+      output,
+      headers,
+      rangeSize,
+      parallelism)
+    .repair([=](const Future<int>& future) {
+      LOG(WARNING) << "Failed to download '" << uri << "', retrying with"
+                   << " curl: " << future.failure();
+
+      return curl(uri, output, headers);
+    });
+}
+
 //-------------------------------------------------------------------
 // DockerFetcherPlugin implementation.
 //-------------------------------------------------------------------
@@ -295,9 +361,13 @@ class DockerFetcherPluginProcess : public Process<DockerFetcherPluginProcess>
 {
 public:
   DockerFetcherPluginProcess(
-      const hashmap<string, spec::Config::Auth>& _auths)
+      const hashmap<string, spec::Config::Auth>& _auths,
+      const Bytes& _blobRangeSize,
+      size_t _blobParallelism)
     : ProcessBase(process::ID::generate("docker-fetcher-plugin")),
-      auths(_auths) {}
+      auths(_auths),
+      blobRangeSize(_blobRangeSize),
+      blobParallelism(_blobParallelism) {}
 
   Future<Nothing> fetch(const URI& uri, const string& directory);
 
@@ -335,6 +405,11 @@ private:
   // keyed by registry URL.
   // For example, "https://index.docker.io/v1/" -> spec::Config::Auth
   hashmap<string, spec::Config::Auth> auths;
+
+  // The size of the ranges in which blobs are downloaded, and the
+  // number of ranges of a blob that are downloaded at a time.
+  const Bytes blobRangeSize;
+  const size_t blobParallelism;
 };
 
 
@@ -343,6 +418,22 @@ DockerFetcherPlugin::Flags::Flags()
   add(&Flags::docker_config,
       "docker_config",
       "The default docker config file.");
+
+  add(&Flags::docker_blob_range_size,
+      "docker_blob_range_size",
+      "The size of the ranges in which image blobs are downloaded, if the\n"
+      "registry supports range requests. Set to 0 to download blobs in a\n"
+      "single request. Ranges are only used when downloading from within\n"
+      "the process, i.e., when no proxy is configured and the registry\n"
+      "is accessed over HTTP (or HTTPS if SSL is enabled and verifies\n"
+      "certificates), as the curl command is used otherwise.",
+      Megabytes(32));
+
+  add(&Flags::docker_blob_parallelism,
+      "docker_blob_parallelism",
+      "The number of ranges of an image blob that are downloaded at a\n"
+      "time (see `--docker_blob_range_size`).",
+      4);
 }
 
 
@@ -365,8 +456,14 @@ Try<Owned<Fetcher::Plugin>> DockerFetcherPlugin::create(const Flags& flags)
     auths = cachedAuths.get();
   }
 
+  if (flags.docker_blob_parallelism == 0) {
+    return Error("'--docker_blob_parallelism' must be positive");
+  }
+
   Owned<DockerFetcherPluginProcess> process(new DockerFetcherPluginProcess(
-      hashmap<string, spec::Config::Auth>(auths)));
+      hashmap<string, spec::Config::Auth>(auths),
+      flags.docker_blob_range_size,
+      flags.docker_blob_parallelism));
 
   return Owned<Fetcher::Plugin>(new DockerFetcherPlugin(process));
 }
@@ -446,7 +543,7 @@ Future<Nothing> DockerFetcherPluginProcess::fetch(
 
   URI manifestUri = getManifestUri(uri);
 
-  return curl(manifestUri)
+  return get(manifestUri)
     .then(defer(self(),
                 &Self::_fetch,
                 uri,
@@ -466,7 +563,7 @@ Future<Nothing> DockerFetcherPluginProcess::_fetch(
     return getAuthHeader(manifestUri, response)
       .then(defer(self(), [=](
           const http::Headers& authHeaders) -> Future<Nothing> {
-        return curl(manifestUri, authHeaders)
+        return get(manifestUri, authHeaders)
           .then(defer(self(),
                       &Self::__fetch,
                       uri,
@@ -560,7 +657,12 @@ Future<Nothing> DockerFetcherPluginProcess::fetchBlob(
 {
   URI blobUri = getBlobUri(uri);
 
-  return download(blobUri, directory, authHeaders)
+  return download(
+      blobUri,
+      directory,
+      authHeaders,
+      blobRangeSize,
+      blobParallelism)
     .then(defer(self(), [=](int code) -> Future<Nothing> {
       if (code == http::Status::OK) {
         return Nothing();
@@ -585,11 +687,11 @@ Future<Nothing> DockerFetcherPluginProcess::_fetchBlob(
     const string& directory,
     const URI& blobUri)
 {
-  // TODO(jieyu): This extra 'curl' call can be avoided if we can get
+  // TODO(jieyu): This extra request can be avoided if we can get
   // HTTP headers from 'download'. Currently, 'download' only returns
   // the HTTP response code because we don't support parsing HTTP
   // headers alone. Revisit this once that's supported.
-  return curl(blobUri)
+  return get(blobUri)
     .then(defer(self(), [=](const http::Response& response) -> Future<Nothing> {
       // We expect a '401 Unauthorized' response here since the
       // 'download' with the same URI returns a '401 Unauthorized'.
@@ -758,7 +860,7 @@ Future<http::Headers> DockerFetcherPluginProcess::getAuthHeader(
       "service=" + authParam.at("service") + "&" +
       "scope=" + authParam.at("scope");
 
-    return curl(authServerUri, getAuthHeaderBasic(auth))
+    return get(authServerUri, getAuthHeaderBasic(auth))
       .then([authServerUri](
           const http::Response& response) -> Future<http::Headers> {
         if (response.code != http::Status::OK) {
@@ -19,6 +19,7 @@
 
 #include <process/owned.hpp>
 
+#include <stout/bytes.hpp>
 #include <stout/flags.hpp>
 #include <stout/try.hpp>
 
@@ -40,6 +41,8 @@ public:
     Flags();
 
     Option<JSON::Object> docker_config;
+    Bytes docker_blob_range_size;
+    size_t docker_blob_parallelism;
   };
 
   static const char NAME[];
@@ -14,6 +14,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <glog/logging.h>
+
 #include <stout/path.hpp>
 #include <stout/strings.hpp>
 
@@ -42,6 +44,23 @@ HadoopFetcherPlugin::Flags::Flags()
       "hadoop_client_supported_schemes",
       "A comma-separated list of the schemes supported by the hadoop client.\n",
       "hdfs,hftp,s3,s3n");
+
+  add(&Flags::hadoop_webhdfs_url,
+      "hadoop_webhdfs_url",
+      "The URL of the WebHDFS or HttpFS server (e.g.,\n"
+      "`http://namenode:9870`) used to fetch HDFS URIs without starting\n"
+      "the hadoop client. If the fetch fails, e.g., as the cluster\n"
+      "requires Kerberos authentication, the hadoop client is used\n"
+      "instead, if available.\n");
+
+  add(&Flags::hadoop_webhdfs_user,
+      "hadoop_webhdfs_user",
+      "The user to pass to WebHDFS for \"simple\" authentication.\n");
+
+  add(&Flags::hadoop_webhdfs_parallelism,
+      "hadoop_webhdfs_parallelism",
+      "The number of blocks of a file to read from WebHDFS at a time.\n",
+      4);
 }
 
 
@@ -50,16 +69,39 @@ const char HadoopFetcherPlugin::NAME[] = "hadoop";
 
 Try<Owned<Fetcher::Plugin>> HadoopFetcherPlugin::create(const Flags& flags)
 {
-  Try<Owned<HDFS>> hdfs = HDFS::create(flags.hadoop_client);
-  if (hdfs.isError()) {
-    return Error("Failed to create HDFS client: " + hdfs.error());
+  Option<Owned<WebHDFS>> webhdfs;
+  if (flags.hadoop_webhdfs_url.isSome()) {
+    Try<Owned<WebHDFS>> _webhdfs = WebHDFS::create(
+        flags.hadoop_webhdfs_url.get(),
+        flags.hadoop_webhdfs_user,
+        flags.hadoop_webhdfs_parallelism);
+
+    if (_webhdfs.isError()) {
+      return Error("Failed to create WebHDFS client: " + _webhdfs.error());
+    }
+
+    webhdfs = _webhdfs.get();
+  }
+
+  // The hadoop client is only required if WebHDFS is not used.
+  Option<Owned<HDFS>> hdfs;
+
+  Try<Owned<HDFS>> _hdfs = HDFS::create(flags.hadoop_client);
+  if (_hdfs.isSome()) {
+    hdfs = _hdfs.get();
+  } else if (webhdfs.isNone()) {
+    return Error("Failed to create HDFS client: " + _hdfs.error());
+  } else {
+    LOG(INFO) << "Fetching HDFS URIs through WebHDFS only, as the hadoop"
+              << " client is not available: " << _hdfs.error();
   }
 
   vector<string> schemes = strings::tokenize(
       flags.hadoop_client_supported_schemes, ",");
 
   return Owned<Fetcher::Plugin>(new HadoopFetcherPlugin(
-      hdfs.get(),
+      hdfs,
+      webhdfs,
       set<string>(schemes.begin(), schemes.end())));
 }
 
@@ -98,9 +140,31 @@ Future<Nothing> HadoopFetcherPlugin::fetch(
   // configuration file.
   //
   // TODO(jieyu): Allow user to specify the name of the output file.
-  return hdfs.get()->copyToLocal(
-      (uri.has_host() ? stringify(uri) : uri.path()),
-      path::join(directory, Path(uri.path()).basename()));
+  const string from = uri.has_host() ? stringify(uri) : uri.path();
+  const string to = path::join(directory, Path(uri.path()).basename());
+
+  if (webhdfs.isNone()) {
+    return hdfs.get()->copyToLocal(from, to);
+  }
+
+  // NOTE: WebHDFS reads from the configured server, whatever the host
+  // in the URI.
+  Future<Nothing> fetch = webhdfs.get()->copyToLocal(uri.path(), to);
+
+  if (hdfs.isNone()) {
+    return fetch;
+  }
+
+  Owned<HDFS> hdfs = this->hdfs.get();
+
+  return fetch
+    .repair([=](const Future<Nothing>& future) {
+      LOG(WARNING) << "Failed to fetch '" << uri << "' through WebHDFS: "
+                   << future.failure() << "; falling back to the hadoop"
+                   << " client";
+
+      return hdfs->copyToLocal(from, to);
+    });
 }
 
 } // namespace uri {
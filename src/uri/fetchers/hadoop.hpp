@@ -29,6 +29,7 @@
 #include <mesos/uri/fetcher.hpp>
 
 #include "hdfs/hdfs.hpp"
+#include "hdfs/webhdfs.hpp"
 
 namespace mesos {
 namespace uri {
@@ -43,6 +44,9 @@ public:
 
     Option<std::string> hadoop_client;
     std::string hadoop_client_supported_schemes;
+    Option<std::string> hadoop_webhdfs_url;
+    Option<std::string> hadoop_webhdfs_user;
+    size_t hadoop_webhdfs_parallelism;
   };
 
   static const char NAME[];
@@ -61,12 +65,16 @@ public:
 
 private:
   HadoopFetcherPlugin(
-      process::Owned<HDFS> _hdfs,
+      const Option<process::Owned<HDFS>>& _hdfs,
+      const Option<process::Owned<WebHDFS>>& _webhdfs,
       const std::set<std::string>& _schemes)
     : hdfs(_hdfs),
+      webhdfs(_webhdfs),
       schemes_(_schemes) {}
 
-  process::Owned<HDFS> hdfs;
+  // The hadoop client, which is optional if WebHDFS is used.
+  Option<process::Owned<HDFS>> hdfs;
+  Option<process::Owned<WebHDFS>> webhdfs;
   std::set<std::string> schemes_;
 };
 
@@ -0,0 +1,552 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fcntl.h>
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <process/collect.hpp>
+#include <process/http.hpp>
+#include <process/loop.hpp>
+
+#ifdef USE_SSL_SOCKET
+#include <process/ssl/flags.hpp>
+#endif // USE_SSL_SOCKET
+
+#include <stout/error.hpp>
+#include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/numify.hpp>
+#include <stout/option.hpp>
+#include <stout/os.hpp>
+#include <stout/stringify.hpp>
+#include <stout/strings.hpp>
+
+#include <stout/os/close.hpp>
+#include <stout/os/open.hpp>
+#include <stout/os/write.hpp>
+
+#include "uri/http_client.hpp"
+
+namespace http = process::http;
+
+using std::atomic;
+using std::list;
+using std::pair;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+using process::Break;
+using process::Continue;
+using process::ControlFlow;
+using process::Failure;
+using process::Future;
+
+using process::loop;
+
+namespace mesos {
+namespace uri {
+namespace http_client {
+
+// The maximum number of redirects that are followed for a request.
+static const size_t MAX_REDIRECTS = 10;
+
+
+bool supported(const string& url)
+{
+  const vector<string> proxies = {
+    "http_proxy", "HTTP_PROXY",
+    "https_proxy", "HTTPS_PROXY",
+    "all_proxy", "ALL_PROXY"
+  };
+
+  foreach (const string& proxy, proxies) {
+    if (os::getenv(proxy).isSome()) {
+      return false;
+    }
+  }
+
+  const string scheme = strings::lower(strings::split(strings::trim(url), ":", 2)[0]);
+
+  if (scheme == "http") {
+    return true;
+  }
+
+#ifdef USE_SSL_SOCKET
+  // NOTE: Unlike curl, libprocess does not verify the certificate of
+  // the server by default.
+  if (scheme == "https") {
+    return process::network::openssl::flags().enabled &&
+      process::network::openssl::flags().verify_cert;
+  }
+#endif // USE_SSL_SOCKET
+
+  return false;
+}
+
+
+// Parses the URL, which may be relative to the given URL if it is a
+// redirect. Unlike `http::URL::parse()`, this parses the query.
+static Try<http::URL> parse(
+    const string& url,
+    const Option<http::URL>& base = None())
+{
+  const string withoutFragment = strings::split(strings::trim(url), "#", 2)[0];
+  const vector<string> parts = strings::split(withoutFragment, "?", 2);
+
+  http::URL result;
+
+  if (base.isSome() && strings::startsWith(parts[0], "/")) {
+    result = base.get();
+    result.path = parts[0];
+    result.query.clear();
+    result.fragment = None();
+  } else {
+    Try<http::URL> _result = http::URL::parse(parts[0]);
+    if (_result.isError()) {
+      return Error("Failed to parse '" + url + "': " + _result.error());
+    }
+
+    result = _result.get();
+  }
+
+  if (parts.size() == 2) {
+    Try<hashmap<string, string>> query = http::query::decode(parts[1]);
+    if (query.isError()) {
+      return Error(
+          "Failed to parse the query of '" + url + "': " + query.error());
+    }
+
+    result.query = query.get();
+  }
+
+  return result;
+}
+
+
+static bool isRedirect(uint16_t code)
+{
+  return code == http::Status::MOVED_PERMANENTLY ||
+    code == http::Status::FOUND ||
+    code == http::Status::SEE_OTHER ||
+    code == http::Status::TEMPORARY_REDIRECT;
+}
+
+
+// Returns the URL the response redirects to.
+static Try<http::URL> redirect(
+    const http::URL& url,
+    const http::Response& response)
+{
+  Option<string> location = response.headers.get("Location");
+  if (location.isNone()) {
+    return Error("Missing 'Location' header in the redirect");
+  }
+
+  return parse(location.get(), url);
+}
+
+
+// Returns the headers to send to the URL of a redirect. Like curl, we
+// do not send the credentials to another host (e.g., to the storage
+// that a docker registry redirects the downloads of blobs to).
+static http::Headers forward(
+    const http::Headers& headers,
+    const http::URL& from,
+    const http::URL& to)
+{
+  if (from.domain == to.domain && from.ip == to.ip && from.port == to.port) {
+    return headers;
+  }
+
+  http::Headers result;
+
+  foreachpair (const string& key, const string& value, headers) {
+    if (strings::lower(key) != "authorization") {
+      result[key] = value;
+    }
+  }
+
+  return result;
+}
+
+
+static void close(const http::Response& response)
+{
+  if (response.reader.isSome()) {
+    http::Pipe::Reader reader = response.reader.get();
+    reader.close();
+  }
+}
+
+
+static Future<http::Response> _get(
+    const http::URL& url,
+    const http::Headers& headers,
+    size_t redirects)
+{
+  http::Request request;
+  request.method = "GET";
+  request.url = url;
+  request.headers = headers;
+  request.keepAlive = false;
+
+  return http::request(request)
+    .then([=](const http::Response& response) -> Future<http::Response> {
+      if (!isRedirect(response.code)) {
+        return response;
+      }
+
+      if (redirects == MAX_REDIRECTS) {
+        return Failure("Too many redirects");
+      }
+
+      Try<http::URL> next = redirect(url, response);
+      if (next.isError()) {
+        return Failure(next.error());
+      }
+
+      return _get(
+          next.get(),
+          forward(headers, url, next.get()),
+          redirects + 1);
+    });
+}
+
+
+Future<http::Response> get(const string& url, const http::Headers& headers)
+{
+  Try<http::URL> _url = parse(url);
+  if (_url.isError()) {
+    return Failure(_url.error());
+  }
+
+  return _get(_url.get(), headers, 0);
+}
+
+
+// The response of a streamed request, along with the URL and headers
+// of the request it responds to, after following the redirects.
+struct Opened
+{
+  http::URL url;
+  http::Headers headers;
+  http::Response response;
+};
+
+
+static Future<Opened> open(
+    const http::URL& url,
+    const http::Headers& headers,
+    const Option<string>& range,
+    size_t redirects)
+{
+  http::Headers _headers = headers;
+  if (range.isSome()) {
+    _headers["Range"] = range.get();
+  }
+
+  return http::streaming::get(url, _headers)
+    .then([=](const http::Response& response) -> Future<Opened> {
+      if (!isRedirect(response.code)) {
+        return Opened{url, headers, response};
+      }
+
+      close(response);
+
+      if (redirects == MAX_REDIRECTS) {
+        return Failure("Too many redirects");
+      }
+
+      Try<http::URL> next = redirect(url, response);
+      if (next.isError()) {
+        return Failure(next.error());
+      }
+
+      return open(
+          next.get(),
+          forward(headers, url, next.get()),
+          range,
+          redirects + 1);
+    });
+}
+
+
+// Writes the streamed body of the response to the output at the
+// offset, as it is received, and verifies its length if given.
+static Future<Nothing> write(
+    const http::Response& response,
+    const string& output,
+    int flags,
+    size_t offset,
+    const Option<size_t>& length)
+{
+  CHECK_SOME(response.reader);
+
+  http::Pipe::Reader reader = response.reader.get();
+
+  Try<int> fd = os::open(
+      output,
+      O_WRONLY | O_CLOEXEC | flags,
+      S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+
+  if (fd.isError()) {
+    reader.close();
+    return Failure("Failed to open '" + output + "': " + fd.error());
+  }
+
+  if (offset > 0 && ::lseek(fd.get(), offset, SEEK_SET) < 0) {
+    ErrnoError error("Failed to seek in '" + output + "'");
+    os::close(fd.get());
+    reader.close();
+    return Failure(error);
+  }
+
+  shared_ptr<size_t> written(new size_t(0));
+
+  return loop(
+      [=]() mutable {
+        return reader.read();
+      },
+      [=](const string& data) -> Future<ControlFlow<Nothing>> {
+        if (data.empty()) {
+          if (length.isSome() && *written != length.get()) {
+            return Failure(
+                "Expected " + stringify(length.get()) + " bytes at offset " +
+                stringify(offset) + " but received " + stringify(*written));
+          }
+
+          return Break();
+        }
+
+        Try<Nothing> write = os::write(fd.get(), data);
+        if (write.isError()) {
+          return Failure(
+              "Failed to write to '" + output + "': " + write.error());
+        }
+
+        *written += data.size();
+
+        return Continue();
+      })
+    .onAny([=](const Future<Nothing>&) mutable {
+      reader.close();
+      os::close(fd.get());
+    });
+}
+
+
+// Downloads the ranges that are left, one at a time, reusing the same
+// connection unless the server closes it.
+static Future<Nothing> download(
+    const http::URL& url,
+    const http::Headers& headers,
+    const string& output,
+    const shared_ptr<const vector<pair<size_t, size_t>>>& ranges,
+    const shared_ptr<atomic<size_t>>& next)
+{
+  shared_ptr<Option<http::Connection>> connection(
+      new Option<http::Connection>());
+
+  return loop(
+      [=]() -> Option<pair<size_t, size_t>> {
+        const size_t index = (*next)++;
+        if (index >= ranges->size()) {
+          return None();
+        }
+
+        return ranges->at(index);
+      },
+      [=](const Option<pair<size_t, size_t>>& range)
+          -> Future<ControlFlow<Nothing>> {
+        if (range.isNone()) {
+          return Break();
+        }
+
+        http::Request request;
+        request.method = "GET";
+        request.url = url;
+        request.headers = headers;
+        request.headers["Range"] =
+          "bytes=" + stringify(range->first) + "-" +
+          stringify(range->first + range->second - 1);
+        request.keepAlive = true;
+
+        Future<http::Connection> connected = connection->isSome()
+          ? Future<http::Connection>(connection->get())
+          : http::connect(url);
+
+        return connected
+          .then([=](http::Connection _connection) {
+            *connection = _connection;
+            return _connection.send(request, true);
+          })
+          .then([=](const http::Response& response)
+              -> Future<ControlFlow<Nothing>> {
+            if (response.code != http::Status::PARTIAL_CONTENT) {
+              close(response);
+              return Failure(
+                  "Unexpected HTTP response '" + response.status + "' "
+                  "when downloading a range");
+            }
+
+            // The connection is kept until the body has been received.
+            const http::Connection _connection = connection->get();
+
+            if (response.headers.get("Connection") == string("close")) {
+              *connection = None();
+            }
+
+            return write(response, output, 0, range->first, range->second)
+              .then([_connection]() -> ControlFlow<Nothing> {
+                return Continue();
+              });
+          });
+      })
+    .onAny([=](const Future<Nothing>&) {
+      if (connection->isSome()) {
+        http::Connection _connection = connection->get();
+        _connection.disconnect();
+      }
+    });
+}
+
+
+Future<int> download(
+    const string& url,
+    const string& output,
+    const http::Headers& headers,
+    const Bytes& rangeSize,
+    size_t parallelism)
+{
+  Try<http::URL> _url = parse(url);
+  if (_url.isError()) {
+    return Failure(_url.error());
+  }
+
+  Option<string> range;
+  if (rangeSize > 0) {
+    range = "bytes=0-" + stringify(rangeSize.bytes() - 1);
+  }
+
+  return open(_url.get(), headers, range, 0)
+    .then([=](const Opened& opened) -> Future<int> {
+      const http::Response& response = opened.response;
+
+      // An empty file can not be downloaded by range.
+      if (response.code == http::Status::REQUESTED_RANGE_NOT_SATISFIABLE &&
+          range.isSome()) {
+        close(response);
+        return download(url, output, headers);
+      }
+
+      if (response.code == http::Status::OK) {
+        return write(response, output, O_CREAT | O_TRUNC, 0, None())
+          .then([]() -> int { return http::Status::OK; });
+      }
+
+      if (response.code != http::Status::PARTIAL_CONTENT) {
+        close(response);
+        return response.code;
+      }
+
+      // The first range has been received, e.g., 'bytes 0-1023/4096'.
+      Option<string> contentRange = response.headers.get("Content-Range");
+      if (contentRange.isNone()) {
+        close(response);
+        return Failure("Missing 'Content-Range' header in the response");
+      }
+
+      const vector<string> tokens =
+        strings::tokenize(contentRange.get(), " -/");
+
+      Try<size_t> last = Error("Unexpected format");
+      Try<size_t> total = Error("Unexpected format");
+
+      if (tokens.size() == 4 && tokens[0] == "bytes" && tokens[1] == "0") {
+        last = numify<size_t>(tokens[2]);
+        total = numify<size_t>(tokens[3]);
+      }
+
+      if (last.isError() || total.isError() || last.get() >= total.get()) {
+        close(response);
+        return Failure(
+            "Unexpected 'Content-Range' header '" + contentRange.get() + "'");
+      }
+
+      shared_ptr<vector<pair<size_t, size_t>>> ranges(
+          new vector<pair<size_t, size_t>>());
+
+      for (size_t offset = last.get() + 1;
+           offset < total.get();
+           offset += rangeSize.bytes()) {
+        ranges->push_back({
+            offset,
+            std::min<size_t>(rangeSize.bytes(), total.get() - offset)});
+      }
+
+      shared_ptr<atomic<size_t>> next(new atomic<size_t>(0));
+
+      // NOTE: This creates the file before the other ranges are
+      // requested, as their writers do not create it.
+      Future<Nothing> first =
+        write(response, output, O_CREAT | O_TRUNC, 0, last.get() + 1);
+
+      // The ranges that are left are downloaded on other connections,
+      // since the connection of the first range is not kept alive.
+      if (ranges->empty() || parallelism <= 1) {
+        const http::URL url = opened.url;
+        const http::Headers headers = opened.headers;
+
+        return first
+          .then([=]() -> Future<Nothing> {
+            if (ranges->empty()) {
+              return Nothing();
+            }
+
+            return download(url, headers, output, ranges, next);
+          })
+          .then([]() -> int { return http::Status::OK; });
+      }
+
+      list<Future<Nothing>> futures = {first};
+
+      const size_t workers =
+        std::min<size_t>(parallelism - 1, ranges->size());
+
+      for (size_t i = 0; i < workers; i++) {
+        futures.push_back(download(
+            opened.url,
+            opened.headers,
+            output,
+            ranges,
+            next));
+      }
+
+      return process::collect(futures)
+        .then([]() -> int { return http::Status::OK; });
+    });
+}
+
+} // namespace http_client {
+} // namespace uri {
+} // namespace mesos {
@@ -0,0 +1,79 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __URI_HTTP_CLIENT_HPP__
+#define __URI_HTTP_CLIENT_HPP__
+
+#include <string>
+
+#include <process/future.hpp>
+#include <process/http.hpp>
+
+#include <stout/bytes.hpp>
+
+namespace mesos {
+namespace uri {
+namespace http_client {
+
+// Helpers for the URI fetcher plugins to send HTTP requests from
+// within the process (using libprocess) rather than by forking the
+// curl command for every request. Redirects are followed, but unlike
+// curl, proxies are not supported.
+
+
+/**
+ * Returns whether the helpers below can be used for the URL, i.e.,
+ * whether the scheme is 'http' (or 'https' if libprocess supports SSL)
+ * and no proxy is configured in the environment.
+ */
+bool supported(const std::string& url);
+
+
+/**
+ * Sends a GET request to the given URL and returns the response,
+ * following redirects. The returned response has the type 'BODY'.
+ * The request is sent on a pooled connection, if libprocess pools
+ * the connections of its HTTP client.
+ */
+process::Future<process::http::Response> get(
+    const std::string& url,
+    const process::http::Headers& headers = process::http::Headers());
+
+
+/**
+ * Downloads the given URL to the output file, following redirects,
+ * and returns the HTTP response code. The body is written to the file
+ * as it is received, and not at all for error responses, so that the
+ * output is not clobbered if it is, e.g., a FIFO that is being read
+ * from. Returns 200 if the file was downloaded.
+ *
+ * If 'rangeSize' is positive, the file is downloaded in ranges of
+ * that size, with up to 'parallelism' ranges in flight, if the server
+ * supports range requests. Each of the connections used for the
+ * ranges is reused for all the ranges it downloads.
+ */
+process::Future<int> download(
+    const std::string& url,
+    const std::string& output,
+    const process::http::Headers& headers = process::http::Headers(),
+    const Bytes& rangeSize = Bytes(0),
+    size_t parallelism = 1);
+
+} // namespace http_client {
+} // namespace uri {
+} // namespace mesos {
+
+#endif // __URI_HTTP_CLIENT_HPP__
@@ -51,13 +51,16 @@ namespace v1 {
 // ensures that client applications see predictable numerical behavior, at
 // the expense of sacrificing some precision.
 
-static long long convertToFixed(double floatValue)
+namespace internal {
+namespace values {
+
+long long convertToFixed(double floatValue)
 {
   return std::llround(floatValue * 1000);
 }
 
 
-static double convertToFloating(long long fixedValue)
+double convertToFloating(long long fixedValue)
 {
   // NOTE: We do the conversion from fixed point via integer division
   // and then modulus, rather than a single floating point division.
@@ -70,6 +73,43 @@ static double convertToFloating(long long fixedValue)
 }
 
 
+// Convert Ranges value to IntervalSet value.
+IntervalSet<uint64_t> rangesToIntervalSet(const Value::Ranges& ranges)
+{
+  IntervalSet<uint64_t> set;
+
+  foreach (const Value::Range& range, ranges.range()) {
+    set += (Bound<uint64_t>::closed(range.begin()),
+            Bound<uint64_t>::closed(range.end()));
+  }
+
+  return set;
+}
+
+
+// Convert IntervalSet value to Ranges value.
+Value::Ranges intervalSetToRanges(const IntervalSet<uint64_t>& set)
+{
+  Value::Ranges ranges;
+
+  foreach (const Interval<uint64_t>& interval, set) {
+    Value::Range* range = ranges.add_range();
+    range->set_begin(interval.lower());
+    range->set_end(interval.upper() - 1);
+  }
+
+  return ranges;
+}
+
+} // namespace values {
+} // namespace internal {
+
+using internal::values::convertToFixed;
+using internal::values::convertToFloating;
+using internal::values::intervalSetToRanges;
+using internal::values::rangesToIntervalSet;
+
+
 ostream& operator<<(ostream& stream, const Value::Scalar& scalar)
 {
   // Output the scalar's full significant digits and save the old
@@ -277,35 +317,6 @@ void coalesce(Value::Ranges* result, const Value::Range& addedRange)
 }
 
 
-// Convert Ranges value to IntervalSet value.
-IntervalSet<uint64_t> rangesToIntervalSet(const Value::Ranges& ranges)
-{
-  IntervalSet<uint64_t> set;
-
-  foreach (const Value::Range& range, ranges.range()) {
-    set += (Bound<uint64_t>::closed(range.begin()),
-            Bound<uint64_t>::closed(range.end()));
-  }
-
-  return set;
-}
-
-
-// Convert IntervalSet value to Ranges value.
-Value::Ranges intervalSetToRanges(const IntervalSet<uint64_t>& set)
-{
-  Value::Ranges ranges;
-
-  foreach (const Interval<uint64_t>& interval, set) {
-    Value::Range* range = ranges.add_range();
-    range->set_begin(interval.lower());
-    range->set_end(interval.upper() - 1);
-  }
-
-  return ranges;
-}
-
-
 ostream& operator<<(ostream& stream, const Value::Ranges& ranges)
 {
   stream << "[";
@@ -320,62 +331,15 @@ ostream& operator<<(ostream& stream, const Value::Ranges& ranges)
 }
 
 
-bool operator==(const Value::Ranges& _left, const Value::Ranges& _right)
+bool operator==(const Value::Ranges& left, const Value::Ranges& right)
 {
-  Value::Ranges left;
-  coalesce(&left, {_left});
-
-  Value::Ranges right;
-  coalesce(&right, {_right});
-
-  if (left.range_size() == right.range_size()) {
-    for (int i = 0; i < left.range_size(); i++) {
-      // Make sure this range is equal to a range in the right.
-      bool found = false;
-      for (int j = 0; j < right.range_size(); j++) {
-        if (left.range(i).begin() == right.range(j).begin() &&
-            left.range(i).end() == right.range(j).end()) {
-          found = true;
-          break;
-        }
-      }
-
-      if (!found) {
-        return false;
-      }
-    }
-
-    return true;
-  }
-
-  return false;
+  return rangesToIntervalSet(left) == rangesToIntervalSet(right);
 }
 
 
-bool operator<=(const Value::Ranges& _left, const Value::Ranges& _right)
+bool operator<=(const Value::Ranges& left, const Value::Ranges& right)
 {
-  Value::Ranges left;
-  coalesce(&left, {_left});
-
-  Value::Ranges right;
-  coalesce(&right, {_right});
-
-  for (int i = 0; i < left.range_size(); i++) {
-    // Make sure this range is a subset of a range in right.
-    bool matched = false;
-    for (int j = 0; j < right.range_size(); j++) {
-      if (left.range(i).begin() >= right.range(j).begin() &&
-          left.range(i).end() <= right.range(j).end()) {
-        matched = true;
-        break;
-      }
-    }
-    if (!matched) {
-      return false;
-    }
-  }
-
-  return true;
+  return rangesToIntervalSet(right).contains(rangesToIntervalSet(left));
 }
 
 
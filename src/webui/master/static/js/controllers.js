@@ -407,13 +407,21 @@
       countdown();
     };
 
-    var pollState = function() {
+    // The master and state generation of the last state we fetched, see
+    // `pollState`.
+    var stateMasterId = null;
+    var stateGeneration = null;
+
+    var fetchState = function(masterId, generation) {
       // When the current master is not the leader, the request is redirected to
       // the leading master automatically. This would cause a CORS error if we
       // use XMLHttpRequest here. To avoid the CORS error, we use JSONP as a
       // workaround. Please refer to MESOS-5911 for further details.
       $http.jsonp(leadingMasterURL('/master/state?jsonp=JSON_CALLBACK'))
         .success(function(response) {
+          stateMasterId = masterId;
+          stateGeneration = generation;
+
           if (updateState($scope, $timeout, response)) {
             $scope.delay = updateInterval(_.size($scope.agents));
             $timeout(pollState, $scope.delay);
@@ -426,6 +434,40 @@
         });
     };
 
+    // Polls the changes to the state summary since the last state we
+    // fetched, which is cheap for the master, and only fetches the full
+    // state again when something changed. This way idle dashboards cost
+    // the master almost nothing.
+    var pollState = function() {
+      var url = '/master/state-summary?jsonp=JSON_CALLBACK';
+      if (stateGeneration !== null) {
+        url += '&since=' + stateGeneration;
+      }
+
+      $http.jsonp(leadingMasterURL(url))
+        .success(function(response) {
+          if (response.master_id === stateMasterId &&
+              response.generation === stateGeneration) {
+            // Keep the relative dates current.
+            $scope.pollTime = new Date();
+
+            $scope.delay = updateInterval(_.size($scope.agents));
+            $timeout(pollState, $scope.delay);
+            return;
+          }
+
+          // The generation of the summary is not newer than the state
+          // fetched next, so we may fetch the same state twice but never
+          // miss a change.
+          fetchState(response.master_id, response.generation);
+        })
+        .error(function() {
+          if ($scope.isErrorModalOpen === false) {
+            popupErrorModal();
+          }
+        });
+    };
+
     var pollMetrics = function() {
       $http.jsonp(leadingMasterURL('/metrics/snapshot?jsonp=JSON_CALLBACK'))
         .success(function(response) {
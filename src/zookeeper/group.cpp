@@ -31,8 +31,10 @@
 #include <stout/check.hpp>
 #include <stout/duration.hpp>
 #include <stout/error.hpp>
+#include <stout/foreach.hpp>
 #include <stout/none.hpp>
 #include <stout/numify.hpp>
+#include <stout/os.hpp>
 #include <stout/path.hpp>
 #include <stout/result.hpp>
 #include <stout/some.hpp>
@@ -182,7 +184,10 @@ Future<Group::Membership> GroupProcess::join(
 
   if (membership.isNone()) { // Try again later.
     if (!retrying) {
-      delay(RETRY_INTERVAL, self(), &GroupProcess::retry, RETRY_INTERVAL);
+      delay(jitter(RETRY_INTERVAL),
+            self(),
+            &GroupProcess::retry,
+            RETRY_INTERVAL);
       retrying = true;
     }
     Join* join = new Join(data, label);
@@ -223,7 +228,10 @@ Future<bool> GroupProcess::cancel(const Group::Membership& membership)
 
   if (cancellation.isNone()) { // Try again later.
     if (!retrying) {
-      delay(RETRY_INTERVAL, self(), &GroupProcess::retry, RETRY_INTERVAL);
+      delay(jitter(RETRY_INTERVAL),
+            self(),
+            &GroupProcess::retry,
+            RETRY_INTERVAL);
       retrying = true;
     }
     Cancel* cancel = new Cancel(membership);
@@ -298,7 +306,10 @@ Future<set<Group::Membership>> GroupProcess::watch(
 
       // Try again later.
       if (!retrying) {
-        delay(RETRY_INTERVAL, self(), &GroupProcess::retry, RETRY_INTERVAL);
+        delay(jitter(RETRY_INTERVAL),
+              self(),
+              &GroupProcess::retry,
+              RETRY_INTERVAL);
         retrying = true;
       }
       Watch* watch = new Watch(expected);
@@ -378,7 +389,10 @@ void GroupProcess::connected(int64_t sessionId, bool reconnect)
   } else if (!synced.get()) {
     // Retryable error.
     if (!retrying) {
-      delay(RETRY_INTERVAL, self(), &GroupProcess::retry, RETRY_INTERVAL);
+      delay(jitter(RETRY_INTERVAL),
+            self(),
+            &GroupProcess::retry,
+            RETRY_INTERVAL);
       retrying = true;
     }
   }
@@ -572,7 +586,10 @@ void GroupProcess::updated(int64_t sessionId, const string& path)
 
     // Try again later.
     if (!retrying) {
-      delay(RETRY_INTERVAL, self(), &GroupProcess::retry, RETRY_INTERVAL);
+      delay(jitter(RETRY_INTERVAL),
+            self(),
+            &GroupProcess::retry,
+            RETRY_INTERVAL);
       retrying = true;
     }
   } else {
@@ -639,6 +656,7 @@ Result<Group::Membership> GroupProcess::doJoin(
 
   Promise<bool>* cancelled = new Promise<bool>();
   owned[sequence.get()] = cancelled;
+  datas[sequence.get()] = data;
 
   return Group::Membership(sequence.get(), label, cancelled->future());
 }
@@ -691,6 +709,10 @@ Result<Option<string>> GroupProcess::doData(
 {
   CHECK_EQ(state, READY);
 
+  if (datas.count(membership.id()) > 0) {
+    return Some(datas.at(membership.id()));
+  }
+
   string path = path::join(
       znode,
       zkBasename(membership),
@@ -714,6 +736,8 @@ Result<Option<string>> GroupProcess::doData(
         "' in ZooKeeper: " + zk->message(code));
   }
 
+  datas[membership.id()] = result;
+
   return Some(result);
 }
 
@@ -762,6 +786,13 @@ Try<bool> GroupProcess::cache()
     sequences[sequence.get()] = label;
   }
 
+  // Forget the data of the memberships that are gone.
+  foreachkey (int32_t sequence, utils::copy(datas)) {
+    if (!sequences.contains(sequence)) {
+      datas.erase(sequence); // Okay since iterating over a copy.
+    }
+  }
+
   // Cache current memberships, cancelling those that are now missing.
   set<Group::Membership> current;
 
@@ -947,7 +978,7 @@ void GroupProcess::retry(const Duration& duration)
     // Backoff and keep retrying.
     retrying = true;
     Seconds seconds = std::min(duration * 2, Duration(Seconds(60)));
-    delay(seconds, self(), &GroupProcess::retry, seconds);
+    delay(jitter(seconds), self(), &GroupProcess::retry, seconds);
   }
 }
 
@@ -984,6 +1015,12 @@ void GroupProcess::abort(const string& message)
 }
 
 
+Duration GroupProcess::jitter(const Duration& duration)
+{
+  return duration * (1.0 + (double) os::random() / RAND_MAX);
+}
+
+
 string GroupProcess::zkBasename(const Group::Membership& membership)
 {
   Try<string> sequence = strings::format("%.*d", 10, membership.sequence);
@@ -405,6 +405,37 @@ public:
     return future;
   }
 
+  Future<int> multi(
+      const vector<zoo_op_t>& ops,
+      vector<zoo_op_result_t>* results)
+  {
+    // NOTE: The operations are serialized by 'zoo_amulti', but the
+    // results are only filled in once the transaction completes.
+    results->resize(ops.size());
+
+    Promise<int>* promise = new Promise<int>();
+
+    Future<int> future = promise->future();
+
+    tuple<Promise<int>*>* args = new tuple<Promise<int>*>(promise);
+
+    int ret = zoo_amulti(
+        zh,
+        ops.size(),
+        ops.data(),
+        results->data(),
+        voidCompletion,
+        args);
+
+    if (ret != ZOK) {
+      delete promise;
+      delete args;
+      return ret;
+    }
+
+    return future;
+  }
+
 private:
   // This method is registered as a watcher callback function and is
   // invoked by a single ZooKeeper event thread.
@@ -664,6 +695,18 @@ int ZooKeeper::set(const string& path, const string& data, int version)
 }
 
 
+int ZooKeeper::multi(
+    const vector<zoo_op_t>& ops,
+    vector<zoo_op_result_t>* results)
+{
+  return dispatch(
+      process,
+      &ZooKeeperProcess::multi,
+      ops,
+      results).get();
+}
+
+
 string ZooKeeper::message(int code) const
 {
   return string(zerror(code));
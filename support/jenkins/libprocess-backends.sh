@@ -0,0 +1,56 @@
+#!/usr/bin/env bash
+
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Runs the libprocess tests once for each of the event loop backends
+# that are not covered by the default build.
+
+set -e
+set -o pipefail
+
+MESOS_DIR=$(git rev-parse --show-toplevel)
+
+cd "${MESOS_DIR}"
+
+./bootstrap
+
+# Builds libprocess in `build-<name>` with the given configure flags,
+# and runs its tests with the given environment (e.g., `FOO=bar`).
+function check {
+  local name=$1
+  local configuration=$2
+  local environment=$3
+
+  echo "Running the libprocess tests with '${name}'"
+
+  rm -rf "build-${name}"
+  mkdir "build-${name}"
+
+  pushd "build-${name}"
+
+  ../configure ${configuration}
+  env ${environment} make -j"$(nproc)" -C 3rdparty check
+
+  popd
+}
+
+check epoll "--enable-epoll"
+check epoll-threads "--enable-epoll" "LIBPROCESS_NUM_EVENT_LOOP_THREADS=4"
+
+check io-uring "--enable-io-uring"
+check io-uring-disabled "--enable-io-uring" "LIBPROCESS_IO_URING=false"
+check epoll-io-uring "--enable-epoll --enable-io-uring"